@@ -16,6 +16,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -102,7 +103,8 @@ absl::Status ValidateShapes(const Shape& input_shape, const Shape& kernel_shape,
 
 bool IsSupportedType(PrimitiveType primitive_type) {
   return primitive_type == PrimitiveType::F16 ||
-         primitive_type == PrimitiveType::F32;
+         primitive_type == PrimitiveType::F32 ||
+         primitive_type == PrimitiveType::S8;
 }
 
 bool CanUseACL(const ConvolutionThunk::Options& options,
@@ -133,6 +135,17 @@ absl::StatusOr<std::unique_ptr<ConvolutionThunk>> ConvolutionThunk::Create(
                            PrimitiveType_Name(primitive_type));
   }
 
+  // Int8 convolutions must accumulate into int32.
+  if (primitive_type == PrimitiveType::S8 &&
+      (kernel_shape.element_type() != PrimitiveType::S8 ||
+       output_shape.element_type() != PrimitiveType::S32)) {
+    return InvalidArgument(
+        "ConvolutionThunk: Int8 convolution requires s8 kernel and s32 output "
+        "(got %s kernel and %s output)",
+        PrimitiveType_Name(kernel_shape.element_type()),
+        PrimitiveType_Name(output_shape.element_type()));
+  }
+
   absl::InlinedVector<int64_t, 2> input_dims;
   absl::InlinedVector<int64_t, 2> kernel_dims;
   absl::InlinedVector<int64_t, 2> output_dims;
@@ -300,6 +313,10 @@ tsl::AsyncValueRef<Thunk::ExecuteEvent> ConvolutionThunk::Execute(
     return OkExecuteEvent();
   }
 
+  if (input_shape_.element_type() == PrimitiveType::S8) {
+    return HandleInt8Convolution(params, input_data, kernel_data, output_data);
+  }
+
   // Eigen convolution
   if (convolution_rank_ == 2) {
     return HandleEigen2DConvolution(params, input_data, kernel_data,
@@ -329,6 +346,48 @@ void ConvolutionThunk::HandleACLConvolution(const ExecuteParams& params,
       feature_group_count_);
 }
 
+tsl::AsyncValueRef<Thunk::ExecuteEvent>
+ConvolutionThunk::HandleInt8Convolution(const ExecuteParams& params,
+                                        se::DeviceMemoryBase input,
+                                        se::DeviceMemoryBase kernel,
+                                        se::DeviceMemoryBase output) {
+  // 2D convolutions (and 1D convolutions lowered to 2D) use a unit z
+  // dimension.
+  bool is_3d = convolution_rank_ == 3;
+  auto dims = [&](const Dims& d, int64_t unused) {
+    return std::array<Eigen::Index, 3>{d.x, d.y, is_3d ? d.z : unused};
+  };
+
+  internal::Int8ConvParams conv_params;
+  conv_params.input_batch = input_batch_;
+  conv_params.input_dims = dims(input_dims_, 1);
+  conv_params.input_channels = input_channels_;
+  conv_params.kernel_dims = dims(kernel_dims_, 1);
+  conv_params.kernel_channels = kernel_channels_;
+  conv_params.kernel_filters = kernel_filters_;
+  conv_params.output_dims = dims(output_dims_, 1);
+  conv_params.strides = dims(strides_, 1);
+  conv_params.padding_before = dims(padding_before_, 0);
+  conv_params.lhs_dilation = dims(base_dilation_, 1);
+  conv_params.rhs_dilation = dims(window_dilation_, 1);
+  conv_params.feature_group_count = feature_group_count_;
+
+  auto* out = static_cast<int32_t*>(output.opaque());
+  auto* lhs = static_cast<const int8_t*>(input.opaque());
+  auto* rhs = static_cast<const int8_t*>(kernel.opaque());
+
+  if (options_.multi_threaded) {
+    auto state = std::make_shared<ExecuteState>(1);
+    internal::Int8Conv(conv_params, out, lhs, rhs, params.intra_op_threadpool,
+                       [state] { state->Notify(); });
+    return state->event;
+  }
+
+  internal::Int8Conv(conv_params, out, lhs, rhs, /*device=*/nullptr,
+                     /*done_callback=*/nullptr);
+  return OkExecuteEvent();
+}
+
 tsl::AsyncValueRef<Thunk::ExecuteEvent>
 ConvolutionThunk::HandleEigen2DConvolution(const ExecuteParams& params,
                                            se::DeviceMemoryBase input,
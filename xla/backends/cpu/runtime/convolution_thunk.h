@@ -32,7 +32,8 @@ limitations under the License.
 
 namespace xla::cpu {
 
-// Performs 1D, 2D or 3D convolution.
+// Performs 1D, 2D or 3D convolution. F16 and F32 convolutions use Eigen, S8
+// convolutions accumulate into an S32 output.
 class ConvolutionThunk final : public Thunk {
  public:
   struct Options {
@@ -78,6 +79,10 @@ class ConvolutionThunk final : public Thunk {
                             se::DeviceMemoryBase kernel,
                             se::DeviceMemoryBase output);
 
+  tsl::AsyncValueRef<Thunk::ExecuteEvent> HandleInt8Convolution(
+      const ExecuteParams& params, se::DeviceMemoryBase input,
+      se::DeviceMemoryBase kernel, se::DeviceMemoryBase output);
+
   tsl::AsyncValueRef<Thunk::ExecuteEvent> HandleEigen2DConvolution(
       const ExecuteParams& params, se::DeviceMemoryBase input,
       se::DeviceMemoryBase kernel, se::DeviceMemoryBase output);
@@ -17,6 +17,7 @@ limitations under the License.
 #define XLA_BACKENDS_CPU_RUNTIME_CONVOLUTION_THUNK_INTERNAL_H_
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <functional>
 
@@ -244,6 +245,38 @@ void EigenConv3D(const EigenDevice& device, ScalarType* out, ScalarType* lhs,
   }
 }
 
+// Parameters of an int8 x int8 -> int32 convolution with input and output in
+// NHWC order and kernel in HWIO order. 1D and 2D convolutions set the sizes of
+// the unused trailing spatial dimensions to 1.
+struct Int8ConvParams {
+  Eigen::Index input_batch;
+  std::array<Eigen::Index, 3> input_dims;
+  Eigen::Index input_channels;
+  std::array<Eigen::Index, 3> kernel_dims;
+  Eigen::Index kernel_channels;
+  Eigen::Index kernel_filters;
+  std::array<Eigen::Index, 3> output_dims;
+  std::array<Eigen::Index, 3> strides;
+  std::array<Eigen::Index, 3> padding_before;
+  std::array<Eigen::Index, 3> lhs_dilation;
+  std::array<Eigen::Index, 3> rhs_dilation;
+  Eigen::Index feature_group_count;
+};
+
+// Int8 convolution accumulating into int32. Eigen contractions do not support
+// mixed input and output types, so instead of extracting image patches we
+// repack the kernel so that every (filter, kernel tap) pair is a contiguous
+// vector of input channels, and compute each output as a sum of int8 dot
+// products, which compilers lower to VNNI (x86) or SDOT (AArch64)
+// instructions when the target supports them.
+//
+// If `device` is not null, output rows are partitioned across its threads and
+// `done_callback` is called when all of them are done. Otherwise the
+// convolution runs in the caller thread and `done_callback` must be null.
+void Int8Conv(const Int8ConvParams& params, int32_t* out, const int8_t* lhs,
+              const int8_t* rhs, const Eigen::ThreadPoolDevice* device,
+              std::function<void()> done_callback);
+
 // Extern Conv2D template for all supported devices and data types.
 #define CONV2D_EXTERN_TEMPLATE(DEVICE, SCALAR_TYPE)                        \
   extern template void EigenConv2D<DEVICE, SCALAR_TYPE>(                   \
@@ -0,0 +1,183 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "xla/backends/cpu/runtime/concurrency.h"
+#include "xla/backends/cpu/runtime/convolution_thunk_internal.h"
+#include "tsl/platform/logging.h"
+
+namespace xla::cpu::internal {
+namespace {
+
+// Kernel repacked from HWIO into [group][tap][filter][channel] order, where
+// `tap` enumerates kernel spatial positions.
+std::vector<int8_t> PackKernel(const Int8ConvParams& p, const int8_t* rhs) {
+  Eigen::Index taps = p.kernel_dims[0] * p.kernel_dims[1] * p.kernel_dims[2];
+  Eigen::Index group_filters = p.kernel_filters / p.feature_group_count;
+  Eigen::Index channels = p.kernel_channels;
+
+  std::vector<int8_t> packed(taps * p.kernel_filters * channels);
+  for (Eigen::Index tap = 0; tap < taps; ++tap) {
+    const int8_t* tap_rhs = rhs + tap * channels * p.kernel_filters;
+    for (Eigen::Index c = 0; c < channels; ++c) {
+      for (Eigen::Index f = 0; f < p.kernel_filters; ++f) {
+        Eigen::Index g = f / group_filters;
+        Eigen::Index gf = f % group_filters;
+        packed[((g * taps + tap) * group_filters + gf) * channels + c] =
+            tap_rhs[c * p.kernel_filters + f];
+      }
+    }
+  }
+  return packed;
+}
+
+// Written as a plain reduction so that it is vectorized into widening
+// multiply-accumulate instructions.
+inline int32_t DotS8(const int8_t* a, const int8_t* b, Eigen::Index n) {
+  int32_t sum = 0;
+  for (Eigen::Index i = 0; i < n; ++i) {
+    sum += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+  }
+  return sum;
+}
+
+// Returns the index into the input dimension `d` read by the output position
+// `o` and the kernel position `k`, or -1 if it falls into padding or between
+// dilated input elements.
+inline Eigen::Index InputIndex(const Int8ConvParams& p, int d, Eigen::Index o,
+                               Eigen::Index k) {
+  Eigen::Index pos =
+      o * p.strides[d] + k * p.rhs_dilation[d] - p.padding_before[d];
+  if (pos < 0 || pos % p.lhs_dilation[d] != 0) return -1;
+  Eigen::Index i = pos / p.lhs_dilation[d];
+  return i < p.input_dims[d] ? i : -1;
+}
+
+// Computes output rows [start, end), where a row is a pair of batch and
+// output x indices.
+void ConvolveRows(const Int8ConvParams& p, int32_t* out, const int8_t* lhs,
+                  const int8_t* packed_rhs, Eigen::Index start,
+                  Eigen::Index end) {
+  const auto& [kx_size, ky_size, kz_size] = p.kernel_dims;
+  const auto& [ix_size, iy_size, iz_size] = p.input_dims;
+  const auto& [ox_size, oy_size, oz_size] = p.output_dims;
+
+  Eigen::Index taps = kx_size * ky_size * kz_size;
+  Eigen::Index groups = p.feature_group_count;
+  Eigen::Index group_filters = p.kernel_filters / groups;
+  Eigen::Index channels = p.kernel_channels;
+
+  std::vector<int32_t> acc(p.kernel_filters);
+
+  for (Eigen::Index row = start; row < end; ++row) {
+    Eigen::Index b = row / ox_size;
+    Eigen::Index ox = row % ox_size;
+
+    for (Eigen::Index oy = 0; oy < oy_size; ++oy) {
+      for (Eigen::Index oz = 0; oz < oz_size; ++oz) {
+        std::fill(acc.begin(), acc.end(), 0);
+
+        for (Eigen::Index kx = 0; kx < kx_size; ++kx) {
+          Eigen::Index ix = InputIndex(p, 0, ox, kx);
+          if (ix < 0) continue;
+          for (Eigen::Index ky = 0; ky < ky_size; ++ky) {
+            Eigen::Index iy = InputIndex(p, 1, oy, ky);
+            if (iy < 0) continue;
+            for (Eigen::Index kz = 0; kz < kz_size; ++kz) {
+              Eigen::Index iz = InputIndex(p, 2, oz, kz);
+              if (iz < 0) continue;
+
+              Eigen::Index tap = (kx * ky_size + ky) * kz_size + kz;
+              const int8_t* in =
+                  lhs + (((b * ix_size + ix) * iy_size + iy) * iz_size + iz) *
+                            p.input_channels;
+
+              for (Eigen::Index g = 0; g < groups; ++g) {
+                const int8_t* in_group = in + g * channels;
+                const int8_t* k =
+                    packed_rhs + (g * taps + tap) * group_filters * channels;
+                int32_t* acc_group = acc.data() + g * group_filters;
+                for (Eigen::Index f = 0; f < group_filters; ++f) {
+                  acc_group[f] += DotS8(in_group, k + f * channels, channels);
+                }
+              }
+            }
+          }
+        }
+
+        int32_t* out_pixel =
+            out + (((b * ox_size + ox) * oy_size + oy) * oz_size + oz) *
+                      p.kernel_filters;
+        std::copy(acc.begin(), acc.end(), out_pixel);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void Int8Conv(const Int8ConvParams& params, int32_t* out, const int8_t* lhs,
+              const int8_t* rhs, const Eigen::ThreadPoolDevice* device,
+              std::function<void()> done_callback) {
+  CHECK_EQ(device != nullptr, static_cast<bool>(done_callback));  // Crash OK
+  Eigen::Index rows = params.input_batch * params.output_dims[0];
+
+  if (device == nullptr) {
+    std::vector<int8_t> packed_rhs = PackKernel(params, rhs);
+    ConvolveRows(params, out, lhs, packed_rhs.data(), 0, rows);
+    return;
+  }
+
+  // Packed kernel and the completion counter shared by all tasks.
+  struct State {
+    std::vector<int8_t> packed_rhs;
+    std::atomic<int64_t> pending_tasks;
+    std::function<void()> done_callback;
+  };
+
+  Eigen::Index max_tasks = static_cast<Eigen::Index>(device->numThreads());
+  Eigen::Index task_size =
+      Eigen::numext::div_ceil(rows, std::max<Eigen::Index>(max_tasks, 1));
+  Eigen::Index num_tasks =
+      task_size == 0 ? 0 : Eigen::numext::div_ceil(rows, task_size);
+
+  if (num_tasks == 0) {
+    done_callback();
+    return;
+  }
+
+  auto state = std::make_shared<State>();
+  state->packed_rhs = PackKernel(params, rhs);
+  state->pending_tasks.store(num_tasks, std::memory_order_relaxed);
+  state->done_callback = std::move(done_callback);
+
+  ScheduleAll(device, num_tasks, [=](int64_t task_index) {
+    Eigen::Index start = task_index * task_size;
+    Eigen::Index end = std::min(start + task_size, rows);
+    ConvolveRows(params, out, lhs, state->packed_rhs.data(), start, end);
+    if (state->pending_tasks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      state->done_callback();
+    }
+  });
+}
+
+}  // namespace xla::cpu::internal
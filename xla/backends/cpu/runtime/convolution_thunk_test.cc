@@ -307,6 +307,63 @@ TEST(ConvolutionThunkTest, CreationErrorOnUnsupportedType) {
               ::testing::HasSubstr("Unsupported element type (S32)"));
 }
 
+TEST(ConvolutionThunkTest, Int8Convolution2D) {
+  // 1x3x3x2 input convolved with 2x2x2x1 kernel into 1x2x2x1 output.
+  std::vector<int8_t> input(3 * 3 * 2);
+  for (size_t i = 0; i < input.size(); i += 2) {
+    input[i] = 1;
+    input[i + 1] = -3;
+  }
+  std::vector<int8_t> kernel(2 * 2 * 2);
+  for (size_t i = 0; i < kernel.size(); i += 2) {
+    kernel[i] = 2;
+    kernel[i + 1] = 5;
+  }
+  std::vector<int32_t> output(2 * 2, 0);
+
+  std::vector<MaybeOwningDeviceMemory> buffers;
+  buffers.emplace_back(se::DeviceMemoryBase(input.data(), input.size()));
+  buffers.emplace_back(se::DeviceMemoryBase(kernel.data(), kernel.size()));
+  buffers.emplace_back(
+      se::DeviceMemoryBase(output.data(), output.size() * sizeof(int32_t)));
+  BufferAllocations allocations(buffers);
+
+  BufferAllocation input_alloc(0, input.size(), 0);
+  BufferAllocation kernel_alloc(1, kernel.size(), 0);
+  BufferAllocation output_alloc(2, output.size() * sizeof(int32_t), 0);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto thunk,
+      ConvolutionThunk::Create(
+          {"convolution"}, MakeConvolutionOptions(),
+          BufferAllocation::Slice(&input_alloc, 0, input_alloc.size()),
+          ShapeUtil::MakeShape(S8, {1, 3, 3, 2}),
+          BufferAllocation::Slice(&kernel_alloc, 0, kernel_alloc.size()),
+          ShapeUtil::MakeShape(S8, {2, 2, 2, 1}),
+          BufferAllocation::Slice(&output_alloc, 0, output_alloc.size()),
+          ShapeUtil::MakeShape(S32, {1, 2, 2, 1}),
+          MakeConvolutionDimensionNumbers(/*convolution_rank=*/2),
+          MakeWindow(/*convolution_rank=*/2), /*feature_group_count=*/1));
+
+  Thunk::ExecuteParams params = {nullptr, &allocations};
+  auto execute_event = thunk->Execute(params);
+  tsl::BlockUntilReady(execute_event);
+  ASSERT_FALSE(execute_event.IsError()) << execute_event.GetError();
+
+  // Every output sums 4 kernel taps of (1 * 2 + -3 * 5).
+  EXPECT_EQ(output, std::vector<int32_t>(4, -52));
+}
+
+TEST(ConvolutionThunkTest, CreationErrorOnInt8ConvolutionWithInt8Output) {
+  ConvolutionThunkBuilder<int8_t> builder;
+
+  auto status_or_thunk = builder.Build();
+  EXPECT_EQ(status_or_thunk.status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status_or_thunk.status().message(),
+              ::testing::HasSubstr("requires s8 kernel and s32 output"));
+}
+
 TEST(ConvolutionThunkTest, CreationErrorOnTooHighConvolutionRank) {
   ConvolutionThunkBuilder<float> builder;
 
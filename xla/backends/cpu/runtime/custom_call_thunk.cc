@@ -198,7 +198,9 @@ CustomCallThunk::CustomCallThunk(
       op_buffers_(std::move(op_buffers)),
       api_version_(api_version),
       backend_config_(std::move(backend_config)),
-      call_frame_(std::move(call_frame)),
+      call_frames_(call_frame ? std::make_unique<ffi::CallFramePool>(
+                                    *std::move(call_frame))
+                              : nullptr),
       execution_state_(std::move(execution_state)) {}
 
 tsl::AsyncValueRef<Thunk::ExecuteEvent> CustomCallThunk::Execute(
@@ -256,8 +258,8 @@ tsl::AsyncValueRef<Thunk::ExecuteEvent> CustomCallThunk::CallTypedFFI(
   }
 
   // Update the FFI call frame with the actual device memory addresses.
-  TF_ASSIGN_OR_RETURN(ffi::CallFrame call_frame,
-                      call_frame_->CopyWithBuffers(arguments, results));
+  TF_ASSIGN_OR_RETURN(ffi::CallFramePool::Ptr call_frame,
+                      call_frames_->BorrowCallFrame(arguments, results));
 
   // Forward ExecutableRunOptions to the FFI handlers via the call options.
   CustomCallExecuteParams* custom_call_params = params.custom_call_params;
@@ -267,7 +269,10 @@ tsl::AsyncValueRef<Thunk::ExecuteEvent> CustomCallThunk::CallTypedFFI(
       /*called_computation=*/nullptr, custom_call_params->ffi_execution_context,
       execution_state_.get()};
 
-  return ffi::CallAsync(handler->bundle.execute, call_frame, call_options);
+  // Call frame is decoded before the handler returns, and we can return it to
+  // the pool for the next execution even if the handler completes
+  // asynchronously.
+  return ffi::CallAsync(handler->bundle.execute, *call_frame, call_options);
 }
 
 tsl::AsyncValueRef<Thunk::ExecuteEvent> CustomCallThunk::CallUntypedAPI(
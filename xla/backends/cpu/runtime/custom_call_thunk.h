@@ -77,7 +77,10 @@ class CustomCallThunk final : public Thunk {
   OpBuffers op_buffers_;
   CustomCallApiVersion api_version_;
   std::string backend_config_;
-  std::optional<ffi::CallFrame> call_frame_;
+
+  // Pool of copies of the call frame prototype. Reusing them avoids heap
+  // allocations on every call of the custom call. Null for untyped API.
+  std::unique_ptr<ffi::CallFramePool> call_frames_;
 
   // Execution state bound to the FFI handler. Optional.
   std::unique_ptr<ffi::ExecutionState> execution_state_;
@@ -0,0 +1,124 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/dot_epilogue.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include "absl/types/span.h"
+
+namespace xla::cpu {
+
+using OpKind = DotEpilogue::OpKind;
+using Broadcast = DotEpilogue::Broadcast;
+
+// Maximum and minimum propagate NaNs, matching XLA semantics.
+static float Maximum(float a, float b) {
+  return (std::isnan(a) || a > b) ? a : b;
+}
+
+static float Minimum(float a, float b) {
+  return (std::isnan(a) || a < b) ? a : b;
+}
+
+template <typename F>
+static void ApplyUnary(float* row, int64_t col_begin, int64_t col_end, F f) {
+  for (int64_t j = col_begin; j < col_end; ++j) row[j] = f(row[j]);
+}
+
+// Applies `f(x, side)` to a row segment, where the side input for column `j`
+// is `side[j * side_stride]` (a zero stride broadcasts a single value).
+template <typename F>
+static void ApplyBinary(float* row, const float* side, int64_t side_stride,
+                        bool reversed, int64_t col_begin, int64_t col_end,
+                        F f) {
+  if (reversed) {
+    for (int64_t j = col_begin; j < col_end; ++j) {
+      row[j] = f(side[j * side_stride], row[j]);
+    }
+  } else {
+    for (int64_t j = col_begin; j < col_end; ++j) {
+      row[j] = f(row[j], side[j * side_stride]);
+    }
+  }
+}
+
+static void ApplyOp(const DotEpilogue::Op& op,
+                    absl::Span<const float* const> operands, float* row,
+                    int64_t i, int64_t col_begin, int64_t col_end) {
+  switch (op.kind) {
+    case OpKind::kNegate:
+      return ApplyUnary(row, col_begin, col_end, [](float x) { return -x; });
+    case OpKind::kExp:
+      return ApplyUnary(row, col_begin, col_end,
+                        [](float x) { return std::exp(x); });
+    case OpKind::kTanh:
+      return ApplyUnary(row, col_begin, col_end,
+                        [](float x) { return std::tanh(x); });
+    default:
+      break;
+  }
+
+  const float* side = operands[op.operand];
+  int64_t side_stride = 0;
+  switch (op.broadcast) {
+    case Broadcast::kScalar:
+      break;
+    case Broadcast::kPerRow:
+      side += i;
+      break;
+    case Broadcast::kPerColumn:
+      side_stride = 1;
+      break;
+  }
+
+  auto apply = [&](auto f) {
+    ApplyBinary(row, side, side_stride, op.reversed, col_begin, col_end, f);
+  };
+
+  switch (op.kind) {
+    case OpKind::kAdd:
+      return apply([](float a, float b) { return a + b; });
+    case OpKind::kSubtract:
+      return apply([](float a, float b) { return a - b; });
+    case OpKind::kMultiply:
+      return apply([](float a, float b) { return a * b; });
+    case OpKind::kDivide:
+      return apply([](float a, float b) { return a / b; });
+    case OpKind::kMaximum:
+      return apply(Maximum);
+    case OpKind::kMinimum:
+      return apply(Minimum);
+    default:
+      return;
+  }
+}
+
+void ApplyDotEpilogue(const DotEpilogue& epilogue,
+                      absl::Span<const float* const> operands, float* out,
+                      int64_t n, int64_t row_begin, int64_t row_end,
+                      int64_t col_begin, int64_t col_end) {
+  // Apply all operations to one row segment before moving to the next one, so
+  // that the segment stays in L1 for the whole chain.
+  for (int64_t i = row_begin; i < row_end; ++i) {
+    float* row = out + i * n;
+    for (const DotEpilogue::Op& op : epilogue.ops) {
+      ApplyOp(op, operands, row, i, col_begin, col_end);
+    }
+  }
+}
+
+}  // namespace xla::cpu
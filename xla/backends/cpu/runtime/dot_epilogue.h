@@ -0,0 +1,83 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_BACKENDS_CPU_RUNTIME_DOT_EPILOGUE_H_
+#define XLA_BACKENDS_CPU_RUNTIME_DOT_EPILOGUE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+
+namespace xla::cpu {
+
+// A chain of elementwise operations fused into a dot operation (e.g. bias-add
+// followed by an activation). The epilogue is applied in place to blocks of
+// the dot result right after they are computed, while they are still in cache,
+// instead of running as a separate loop fusion that re-reads the whole result.
+struct DotEpilogue {
+  enum class OpKind {
+    kAdd,
+    kSubtract,
+    kMultiply,
+    kDivide,
+    kMaximum,
+    kMinimum,
+    kNegate,
+    kExp,
+    kTanh,
+  };
+
+  // How a side input of a binary operation is broadcasted to the [m, n] dot
+  // result.
+  enum class Broadcast {
+    kScalar,     // a single value
+    kPerRow,     // a vector of `m` values, one for every row
+    kPerColumn,  // a vector of `n` values, one for every column
+  };
+
+  struct Op {
+    OpKind kind;
+
+    // Index of the side input of a binary operation in the epilogue operands.
+    int64_t operand = -1;
+    Broadcast broadcast = Broadcast::kScalar;
+
+    // If true, the dot result is the second operand of a binary operation,
+    // e.g. `side - x` instead of `x - side`.
+    bool reversed = false;
+  };
+
+  bool empty() const { return ops.empty(); }
+
+  static bool IsUnary(OpKind kind) {
+    return kind == OpKind::kNegate || kind == OpKind::kExp ||
+           kind == OpKind::kTanh;
+  }
+
+  std::vector<Op> ops;
+};
+
+// Applies `epilogue` in place to the block [row_begin, row_end) x
+// [col_begin, col_end) of `out`, a row-major F32 matrix with `n` columns.
+// `operands` are the side inputs of the epilogue operations.
+void ApplyDotEpilogue(const DotEpilogue& epilogue,
+                      absl::Span<const float* const> operands, float* out,
+                      int64_t n, int64_t row_begin, int64_t row_end,
+                      int64_t col_begin, int64_t col_end);
+
+}  // namespace xla::cpu
+
+#endif  // XLA_BACKENDS_CPU_RUNTIME_DOT_EPILOGUE_H_
@@ -0,0 +1,98 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/dot_epilogue.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tsl/platform/test.h"
+
+namespace xla::cpu {
+namespace {
+
+using OpKind = DotEpilogue::OpKind;
+using Broadcast = DotEpilogue::Broadcast;
+
+TEST(DotEpilogueTest, BiasAddRelu) {
+  // relu(x + bias) with a per-column bias.
+  DotEpilogue epilogue;
+  epilogue.ops.push_back({OpKind::kAdd, 0, Broadcast::kPerColumn});
+  epilogue.ops.push_back({OpKind::kMaximum, 1, Broadcast::kScalar});
+
+  std::vector<float> out = {1.0f, -2.0f, 3.0f, -4.0f, 5.0f, -6.0f};
+  std::vector<float> bias = {0.5f, 1.0f, -10.0f};
+  float zero = 0.0f;
+  std::vector<const float*> operands = {bias.data(), &zero};
+
+  ApplyDotEpilogue(epilogue, operands, out.data(), /*n=*/3, 0, 2, 0, 3);
+  EXPECT_EQ(out, std::vector<float>({1.5f, 0.0f, 0.0f, 0.0f, 6.0f, 0.0f}));
+}
+
+TEST(DotEpilogueTest, ReversedPerRowAndUnaryOps) {
+  // tanh(-(scale[i] - x)) with a per-row scale.
+  DotEpilogue epilogue;
+  epilogue.ops.push_back({OpKind::kSubtract, 0, Broadcast::kPerRow,
+                          /*reversed=*/true});
+  epilogue.ops.push_back({OpKind::kNegate});
+  epilogue.ops.push_back({OpKind::kTanh});
+
+  std::vector<float> out = {1.0f, 2.0f, 3.0f, 4.0f};
+  std::vector<float> scale = {1.0f, 2.0f};
+  std::vector<const float*> operands = {scale.data()};
+
+  ApplyDotEpilogue(epilogue, operands, out.data(), /*n=*/2, 0, 2, 0, 2);
+  EXPECT_FLOAT_EQ(out[0], std::tanh(0.0f));
+  EXPECT_FLOAT_EQ(out[1], std::tanh(1.0f));
+  EXPECT_FLOAT_EQ(out[2], std::tanh(1.0f));
+  EXPECT_FLOAT_EQ(out[3], std::tanh(2.0f));
+}
+
+TEST(DotEpilogueTest, AppliesOnlyToBlock) {
+  DotEpilogue epilogue;
+  epilogue.ops.push_back({OpKind::kMultiply, 0, Broadcast::kScalar});
+
+  std::vector<float> out(12, 1.0f);
+  float two = 2.0f;
+  std::vector<const float*> operands = {&two};
+
+  // Block [1, 3) x [2, 4) of a [3, 4] matrix.
+  ApplyDotEpilogue(epilogue, operands, out.data(), /*n=*/4, 1, 3, 2, 4);
+  for (int64_t i = 0; i < 3; ++i) {
+    for (int64_t j = 0; j < 4; ++j) {
+      EXPECT_EQ(out[i * 4 + j], (i >= 1 && j >= 2) ? 2.0f : 1.0f)
+          << "i=" << i << " j=" << j;
+    }
+  }
+}
+
+TEST(DotEpilogueTest, MaximumPropagatesNaN) {
+  DotEpilogue epilogue;
+  epilogue.ops.push_back({OpKind::kMaximum, 0, Broadcast::kScalar});
+
+  float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> out = {nan, 1.0f};
+  float zero = 0.0f;
+  std::vector<const float*> operands = {&zero};
+
+  ApplyDotEpilogue(epilogue, operands, out.data(), /*n=*/2, 0, 1, 0, 2);
+  EXPECT_TRUE(std::isnan(out[0]));
+  EXPECT_EQ(out[1], 1.0f);
+}
+
+}  // namespace
+}  // namespace xla::cpu
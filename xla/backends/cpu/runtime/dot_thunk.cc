@@ -15,21 +15,27 @@ limitations under the License.
 
 #include "xla/backends/cpu/runtime/dot_thunk.h"
 
+#include <algorithm>
 #include <atomic>
 #include <complex>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
+#include "xla/backends/cpu/runtime/concurrency.h"
+#include "xla/backends/cpu/runtime/dot_epilogue.h"
+#include "xla/backends/cpu/runtime/packed_matmul.h"
 #include "xla/backends/cpu/runtime/thunk.h"
 #include "xla/layout_util.h"
 #include "xla/primitive_util.h"
@@ -108,11 +114,28 @@ static MatMulDims GetMatMulDims(
       /*rhs_canonical=*/rhs_contracting_dims[0] == 0};
 }
 
+// Returns the quantized type of a dot RHS element type, if it has one.
+static std::optional<QuantizedType> GetQuantizedType(PrimitiveType type) {
+  switch (type) {
+    case S4:
+      return QuantizedType::kS4;
+    case U4:
+      return QuantizedType::kU4;
+    case F8E4M3FN:
+      return QuantizedType::kF8E4M3FN;
+    case F8E5M2:
+      return QuantizedType::kF8E5M2;
+    default:
+      return std::nullopt;
+  }
+}
+
 absl::StatusOr<std::unique_ptr<DotThunk>> DotThunk::Create(
     Info info, DotDimensionNumbers dot_dimensions,
     BufferAllocation::Slice lhs_buffer, Shape lhs_shape,
     BufferAllocation::Slice rhs_buffer, Shape rhs_shape,
-    BufferAllocation::Slice out_buffer, Shape out_shape) {
+    BufferAllocation::Slice out_buffer, Shape out_shape, DotEpilogue epilogue,
+    std::vector<BufferAllocation::Slice> epilogue_buffers) {
   // All shapes must be in dim0-major layout.
   if (!LayoutUtil::IsMonotonicWithDim0Major(lhs_shape.layout()) ||
       !LayoutUtil::IsMonotonicWithDim0Major(rhs_shape.layout()) ||
@@ -157,11 +180,45 @@ absl::StatusOr<std::unique_ptr<DotThunk>> DotThunk::Create(
         out_matmul_shape.ToString(true));
   }
 
+  if (!epilogue.empty()) {
+    if (batch_size != 1 || out_shape.element_type() != F32) {
+      return InvalidArgument(
+          "Dot epilogue is supported only for non-batched F32 dots: "
+          "out_shape=%s",
+          out_shape.ToString(true));
+    }
+    int64_t num_buffers = epilogue_buffers.size();
+    for (const DotEpilogue::Op& op : epilogue.ops) {
+      if (!DotEpilogue::IsUnary(op.kind) &&
+          (op.operand < 0 || op.operand >= num_buffers)) {
+        return InvalidArgument(
+            "Dot epilogue operand %d is out of range of %d epilogue buffers",
+            op.operand, num_buffers);
+      }
+    }
+  }
+
+  if (GetQuantizedType(rhs_shape.element_type()).has_value()) {
+    bool lhs_canonical =
+        lhs_shape.rank() <= 1 ||
+        (dot_dimensions.lhs_contracting_dimensions_size() == 1 &&
+         dot_dimensions.lhs_contracting_dimensions(0) == 1);
+    if (batch_size != 1 || lhs_shape.element_type() != F32 ||
+        out_shape.element_type() != F32 || !lhs_canonical) {
+      return InvalidArgument(
+          "Quantized dot RHS is supported only for non-batched F32 dots with "
+          "a [m, k] LHS: lhs_shape=%s, rhs_shape=%s, out_shape=%s",
+          lhs_shape.ToString(true), rhs_shape.ToString(true),
+          out_shape.ToString(true));
+    }
+  }
+
   return absl::WrapUnique(new DotThunk(
       info, std::move(dot_dimensions), lhs_buffer, std::move(lhs_shape),
       rhs_buffer, std::move(rhs_shape), out_buffer, std::move(out_shape),
       batch_size, std::move(lhs_matmul_shape), std::move(rhs_matmul_shape),
-      std::move(out_matmul_shape)));
+      std::move(out_matmul_shape), std::move(epilogue),
+      std::move(epilogue_buffers)));
 }
 
 DotThunk::DotThunk(Info info, DotDimensionNumbers dot_dimensions,
@@ -169,7 +226,9 @@ DotThunk::DotThunk(Info info, DotDimensionNumbers dot_dimensions,
                    BufferAllocation::Slice rhs_buffer, Shape rhs_shape,
                    BufferAllocation::Slice out_buffer, Shape out_shape,
                    int64_t batch_size, Shape lhs_matmul_shape,
-                   Shape rhs_matmul_shape, Shape out_matmul_shape)
+                   Shape rhs_matmul_shape, Shape out_matmul_shape,
+                   DotEpilogue epilogue,
+                   std::vector<BufferAllocation::Slice> epilogue_buffers)
     : Thunk(Kind::kDot, info),
       dot_dimensions_(dot_dimensions),
       lhs_buffer_(lhs_buffer),
@@ -181,7 +240,9 @@ DotThunk::DotThunk(Info info, DotDimensionNumbers dot_dimensions,
       batch_size_(batch_size),
       lhs_matmul_shape_(lhs_matmul_shape),
       rhs_matmul_shape_(rhs_matmul_shape),
-      out_matmul_shape_(out_matmul_shape) {
+      out_matmul_shape_(out_matmul_shape),
+      epilogue_(std::move(epilogue)),
+      epilogue_buffers_(std::move(epilogue_buffers)) {
   // Copy from the original dot dimension numbers.
   lhs_matmul_contracting_dims_.assign(
       dot_dimensions_.lhs_contracting_dimensions().begin(),
@@ -197,6 +258,13 @@ DotThunk::DotThunk(Info info, DotDimensionNumbers dot_dimensions,
     dim -= dot_dimensions_.rhs_batch_dimensions_size();
 }
 
+// Maximum number of LHS rows for which we use the packed matmul kernel. Above
+// that, Eigen amortizes packing over enough rows to be faster.
+static constexpr int64_t kMaxPackedMatMulRows = 16;
+
+// Minimum number of multiply-adds per packed matmul task.
+static constexpr int64_t kMinPackedMatMulTaskSize = 1 << 17;
+
 tsl::AsyncValueRef<DotThunk::ExecuteEvent> DotThunk::Execute(
     const ExecuteParams& params) {
   tsl::profiler::TraceMe trace([&] { return TraceMeEncode(); });
@@ -248,6 +316,51 @@ tsl::AsyncValueRef<DotThunk::ExecuteEvent> DotThunk::Execute(
     return InvalidArgument("Intra-op threadpool must be provided for DotThunk");
   }
 
+  std::vector<const float*> epilogue_operands;
+  epilogue_operands.reserve(epilogue_buffers_.size());
+  for (const BufferAllocation::Slice& buffer : epilogue_buffers_) {
+    TF_ASSIGN_OR_RETURN(se::DeviceMemoryBase data,
+                        params.buffer_allocations->GetDeviceAddress(buffer));
+    epilogue_operands.push_back(static_cast<const float*>(data.opaque()));
+  }
+
+  // Small dots with a quantized RHS dequantize it panel by panel. Large dots
+  // dequantize it once into a temporary F32 matrix and run as regular dots.
+  std::shared_ptr<std::vector<float>> dequantized_rhs;
+  if (IsDequantizingDot()) {
+    if (matmul_dims.m <= kMaxPackedMatMulRows) {
+      return ExecuteDequantizingMatMul(
+          params, static_cast<const float*>(lhs_data.opaque()),
+          rhs_data.opaque(), static_cast<float*>(out_data.opaque()),
+          matmul_dims.m, matmul_dims.k, matmul_dims.n,
+          !matmul_dims.rhs_canonical, std::move(epilogue_operands));
+    }
+
+    QuantizedMatrix matrix{*GetQuantizedType(rhs_shape_.element_type()),
+                           rhs_data.opaque(), matmul_dims.k, matmul_dims.n,
+                           !matmul_dims.rhs_canonical,
+                           rhs_shape_.layout().element_size_in_bits() == 4};
+    dequantized_rhs =
+        std::make_shared<std::vector<float>>(matmul_dims.k * matmul_dims.n);
+    Dequantize(matrix, dequantized_rhs->data());
+    rhs_data = se::DeviceMemoryBase(dequantized_rhs->data(),
+                                    dequantized_rhs->size() * sizeof(float));
+  }
+
+  if (CanUsePackedMatMul(matmul_dims.m, matmul_dims.lhs_column_major,
+                         matmul_dims.lhs_canonical)) {
+    return ExecutePackedMatMul(
+        params, static_cast<const float*>(lhs_data.opaque()),
+        static_cast<const float*>(rhs_data.opaque()),
+        static_cast<float*>(out_data.opaque()), matmul_dims.m, matmul_dims.k,
+        matmul_dims.n, !matmul_dims.rhs_canonical,
+        std::move(epilogue_operands));
+  }
+
+  // Row-major dimensions of the dot result, for applying the epilogue.
+  const int64_t out_rows = matmul_dims.m;
+  const int64_t out_cols = matmul_dims.n;
+
   // Eigen expects column-major layout. If the matrices are row major, then use
   // the following identity to compute the product:
   //
@@ -286,13 +399,30 @@ tsl::AsyncValueRef<DotThunk::ExecuteEvent> DotThunk::Execute(
 
   auto state = std::make_shared<ExecuteState>(batch_size_);
 
+  // The epilogue is applied to the whole result once the contraction is done,
+  // as Eigen doesn't expose its output tiles. It still runs in place and in
+  // the same thunk, instead of as a separate fusion writing a new buffer.
+  if (!epilogue_.empty()) {
+    TypedMatMul<float>(
+        params.intra_op_threadpool, out, lhs, rhs, matmul_dims.m,
+        matmul_dims.n, matmul_dims.k, transpose_lhs, transpose_rhs,
+        [this, device = params.intra_op_threadpool,
+         operands = std::move(epilogue_operands),
+         out = static_cast<float*>(out_data.opaque()), out_rows, out_cols,
+         state, dequantized_rhs]() mutable {
+          ApplyEpilogue(device, std::move(operands), out, out_rows, out_cols,
+                        [state] { state->Notify(); });
+        });
+    return state->event;
+  }
+
   auto dispatch = [&](auto type_tag) {
     for (int64_t i = 0; i < batch_size_; ++i) {
       TypedMatMul<decltype(type_tag)>(
           params.intra_op_threadpool, batch_ptr(out, out_stride, i),
           batch_ptr(lhs, lhs_stride, i), batch_ptr(rhs, rhs_stride, i),
           matmul_dims.m, matmul_dims.n, matmul_dims.k, transpose_lhs,
-          transpose_rhs, [state] { state->Notify(); });
+          transpose_rhs, [state, dequantized_rhs] { state->Notify(); });
     }
   };
 
@@ -324,4 +454,156 @@ tsl::AsyncValueRef<DotThunk::ExecuteEvent> DotThunk::Execute(
   return state->event;
 }
 
+// Minimum number of elements per epilogue task.
+static constexpr int64_t kMinEpilogueTaskSize = 1 << 15;
+
+void DotThunk::ApplyEpilogue(const Eigen::ThreadPoolDevice* device,
+                             std::vector<const float*> operands, float* out,
+                             int64_t m, int64_t n, DoneCallback done) const {
+  int64_t num_tasks = std::min<int64_t>(
+      {std::max<int64_t>(1, m), device->numThreadsInPool(),
+       std::max<int64_t>(1, m * n / kMinEpilogueTaskSize)});
+
+  if (num_tasks <= 1) {
+    ApplyDotEpilogue(epilogue_, operands, out, n, 0, m, 0, n);
+    done();
+    return;
+  }
+
+  int64_t rows_per_task = CeilOfRatio(m, num_tasks);
+  num_tasks = CeilOfRatio(m, rows_per_task);
+
+  auto pending = std::make_shared<std::atomic<int64_t>>(num_tasks);
+  auto shared_done = std::make_shared<DoneCallback>(std::move(done));
+  auto shared_operands =
+      std::make_shared<const std::vector<const float*>>(std::move(operands));
+
+  ScheduleAll(device, num_tasks, [=](int64_t task_index) {
+    int64_t row_begin = task_index * rows_per_task;
+    int64_t row_end = std::min(m, row_begin + rows_per_task);
+    ApplyDotEpilogue(epilogue_, *shared_operands, out, n, row_begin, row_end, 0,
+                     n);
+    if (pending->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      (*shared_done)();
+    }
+  });
+}
+
+bool DotThunk::CanUsePackedMatMul(int64_t m, bool lhs_column_major,
+                                  bool lhs_canonical) const {
+  return rhs_buffer_.allocation() != nullptr &&
+         rhs_buffer_.allocation()->is_constant() && batch_size_ == 1 &&
+         lhs_matmul_shape_.element_type() == F32 &&
+         out_matmul_shape_.rank() <= 2 && !lhs_column_major && lhs_canonical &&
+         m <= kMaxPackedMatMulRows;
+}
+
+std::shared_ptr<const PackedMatrix> DotThunk::GetPackedRhs(
+    const float* rhs, int64_t k, int64_t n, bool transpose_rhs) {
+  {
+    absl::ReaderMutexLock lock(&packed_rhs_mu_);
+    if (packed_rhs_source_ == rhs) return packed_rhs_;
+  }
+
+  // Pack outside of the lock, as it touches the whole matrix. If multiple
+  // threads race here, all of them produce the same packed matrix.
+  auto packed = std::make_shared<const PackedMatrix>(
+      PackedMatrix::Pack(rhs, k, n, transpose_rhs));
+
+  absl::MutexLock lock(&packed_rhs_mu_);
+  packed_rhs_source_ = rhs;
+  packed_rhs_ = packed;
+  return packed;
+}
+
+tsl::AsyncValueRef<DotThunk::ExecuteEvent> DotThunk::ExecutePanels(
+    const ExecuteParams& params, int64_t m, int64_t k, int64_t n,
+    int64_t num_panels, std::function<void(int64_t, int64_t)> compute_panels) {
+  if (m == 0 || num_panels == 0) return OkExecuteEvent();
+
+  int64_t max_tasks = std::min<int64_t>(
+      {num_panels, params.intra_op_threadpool->numThreadsInPool(),
+       std::max<int64_t>(1, m * k * n / kMinPackedMatMulTaskSize)});
+  int64_t panels_per_task = CeilOfRatio(num_panels, max_tasks);
+  int64_t num_tasks = CeilOfRatio(num_panels, panels_per_task);
+
+  if (num_tasks <= 1) {
+    compute_panels(0, num_panels);
+    return OkExecuteEvent();
+  }
+
+  auto state = std::make_shared<ExecuteState>(num_tasks);
+  ScheduleAll(params.intra_op_threadpool, num_tasks,
+              [=](int64_t task_index) {
+                int64_t panel_begin = task_index * panels_per_task;
+                int64_t panel_end =
+                    std::min(num_panels, panel_begin + panels_per_task);
+                compute_panels(panel_begin, panel_end);
+                state->Notify();
+              });
+  return state->event;
+}
+
+tsl::AsyncValueRef<DotThunk::ExecuteEvent> DotThunk::ExecutePackedMatMul(
+    const ExecuteParams& params, const float* lhs, const float* rhs, float* out,
+    int64_t m, int64_t k, int64_t n, bool transpose_rhs,
+    std::vector<const float*> epilogue_operands) {
+  std::shared_ptr<const PackedMatrix> packed_rhs =
+      GetPackedRhs(rhs, k, n, transpose_rhs);
+
+  // Computes a range of panels, and applies the epilogue to each panel of the
+  // result while it is still in cache.
+  auto compute_panels = [this, lhs, out, m, n, packed_rhs,
+                         operands = std::move(epilogue_operands)](
+                            int64_t panel_begin, int64_t panel_end) {
+    if (epilogue_.empty()) {
+      PackedMatMul(lhs, *packed_rhs, out, m, panel_begin, panel_end);
+      return;
+    }
+    for (int64_t p = panel_begin; p < panel_end; ++p) {
+      PackedMatMul(lhs, *packed_rhs, out, m, p, p + 1);
+      int64_t col_begin = p * PackedMatrix::kPanelCols;
+      int64_t col_end = std::min(n, col_begin + PackedMatrix::kPanelCols);
+      ApplyDotEpilogue(epilogue_, operands, out, n, 0, m, col_begin, col_end);
+    }
+  };
+
+  return ExecutePanels(params, m, k, n, packed_rhs->num_panels(),
+                       std::move(compute_panels));
+}
+
+bool DotThunk::IsDequantizingDot() const {
+  return GetQuantizedType(rhs_shape_.element_type()).has_value();
+}
+
+tsl::AsyncValueRef<DotThunk::ExecuteEvent> DotThunk::ExecuteDequantizingMatMul(
+    const ExecuteParams& params, const float* lhs, const void* rhs, float* out,
+    int64_t m, int64_t k, int64_t n, bool transpose_rhs,
+    std::vector<const float*> epilogue_operands) {
+  QuantizedMatrix matrix{*GetQuantizedType(rhs_shape_.element_type()), rhs, k,
+                         n, transpose_rhs,
+                         rhs_shape_.layout().element_size_in_bits() == 4};
+
+  // Every task dequantizes its panels one at a time into a scratch panel that
+  // stays in cache while all rows of the LHS are multiplied by it.
+  auto compute_panels = [this, lhs, out, m, k, n, matrix,
+                         operands = std::move(epilogue_operands)](
+                            int64_t panel_begin, int64_t panel_end) {
+    std::vector<float> panel(k * PackedMatrix::kPanelCols);
+    for (int64_t p = panel_begin; p < panel_end; ++p) {
+      DequantizePanel(matrix, p, panel.data());
+      PackedMatMulPanel(lhs, panel.data(), out, m, k, n, p);
+      if (!epilogue_.empty()) {
+        int64_t col_begin = p * PackedMatrix::kPanelCols;
+        int64_t col_end = std::min(n, col_begin + PackedMatrix::kPanelCols);
+        ApplyDotEpilogue(epilogue_, operands, out, n, 0, m, col_begin,
+                         col_end);
+      }
+    }
+  };
+
+  return ExecutePanels(params, m, k, n, matrix.num_panels(),
+                       std::move(compute_panels));
+}
+
 }  // namespace xla::cpu
@@ -20,15 +20,21 @@ limitations under the License.
 
 #include <array>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/base/optimization.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "Eigen/Core"
 #include "unsupported/Eigen/CXX11/Tensor"
+#include "xla/backends/cpu/runtime/dot_epilogue.h"
+#include "xla/backends/cpu/runtime/packed_matmul.h"
 #include "xla/backends/cpu/runtime/thunk.h"
 #include "xla/runtime/buffer_use.h"
 #include "xla/service/buffer_assignment.h"
@@ -40,29 +46,92 @@ namespace xla::cpu {
 
 class DotThunk final : public Thunk {
  public:
+  // If `epilogue` is not empty, it is applied in place to the dot result, and
+  // `epilogue_buffers` hold its side inputs. Epilogues are supported only for
+  // non-batched F32 dots.
+  //
+  // The RHS of a non-batched F32 dot can have a quantized S4, U4, F8E4M3FN or
+  // F8E5M2 type (weight-only quantization). It is dequantized one panel at a
+  // time right before the panel is multiplied, and is never materialized in
+  // F32.
   static absl::StatusOr<std::unique_ptr<DotThunk>> Create(
       Info info, DotDimensionNumbers dot_dimensions,
       BufferAllocation::Slice lhs_buffer, Shape lhs_shape,
       BufferAllocation::Slice rhs_buffer, Shape rhs_shape,
-      BufferAllocation::Slice out_buffer, Shape out_shape);
+      BufferAllocation::Slice out_buffer, Shape out_shape,
+      DotEpilogue epilogue = {},
+      std::vector<BufferAllocation::Slice> epilogue_buffers = {});
 
   tsl::AsyncValueRef<ExecuteEvent> Execute(const ExecuteParams& params) final;
 
   BufferUses buffer_uses() const final {
-    return {BufferUse::Read(lhs_buffer_), BufferUse::Read(rhs_buffer_),
-            BufferUse::Write(out_buffer_)};
+    BufferUses buffer_uses = {BufferUse::Read(lhs_buffer_),
+                              BufferUse::Read(rhs_buffer_),
+                              BufferUse::Write(out_buffer_)};
+    for (const BufferAllocation::Slice& buffer : epilogue_buffers_) {
+      buffer_uses.push_back(BufferUse::Read(buffer));
+    }
+    return buffer_uses;
   }
 
+  const DotEpilogue& epilogue() const { return epilogue_; }
+
  private:
   DotThunk(Info info, DotDimensionNumbers dot_dimensions,
            BufferAllocation::Slice lhs_buffer, Shape lhs_shape,
            BufferAllocation::Slice rhs_buffer, Shape rhs_shape,
            BufferAllocation::Slice out_buffer, Shape out_shape,
            int64_t batch_size, Shape lhs_matmul_shape, Shape rhs_matmul_shape,
-           Shape out_matmul_shape);
+           Shape out_matmul_shape, DotEpilogue epilogue,
+           std::vector<BufferAllocation::Slice> epilogue_buffers);
 
   using DoneCallback = absl::AnyInvocable<void()>;
 
+  // Applies the epilogue to the row-major [m, n] dot result, splitting rows
+  // between tasks, and calls `done` when all of them are finished.
+  void ApplyEpilogue(const Eigen::ThreadPoolDevice* device,
+                     std::vector<const float*> operands, float* out, int64_t m,
+                     int64_t n, DoneCallback done) const;
+
+  // Returns true if the dot can be computed with `PackedMatMul` from a
+  // prepacked copy of the RHS: the RHS is a constant, the LHS has few rows,
+  // and all operands are row-major F32 matrices.
+  bool CanUsePackedMatMul(int64_t m, bool lhs_column_major,
+                          bool lhs_canonical) const;
+
+  // Returns true if the RHS has a quantized element type.
+  bool IsDequantizingDot() const;
+
+  // Computes the dot with a quantized RHS, dequantizing it panel by panel.
+  // The epilogue is applied to every panel of the result right after it is
+  // computed.
+  tsl::AsyncValueRef<ExecuteEvent> ExecuteDequantizingMatMul(
+      const ExecuteParams& params, const float* lhs, const void* rhs,
+      float* out, int64_t m, int64_t k, int64_t n, bool transpose_rhs,
+      std::vector<const float*> epilogue_operands);
+
+  // Calls `compute_panels` for ranges of the `num_panels` panels of a
+  // [m, k] x [k, n] matmul, split between tasks so that each task does enough
+  // work to amortize the cost of scheduling it.
+  tsl::AsyncValueRef<ExecuteEvent> ExecutePanels(
+      const ExecuteParams& params, int64_t m, int64_t k, int64_t n,
+      int64_t num_panels,
+      std::function<void(int64_t, int64_t)> compute_panels);
+
+  // Computes the dot with `PackedMatMul`, packing the RHS on first execution.
+  // The epilogue is applied to every panel of the result right after it is
+  // computed.
+  tsl::AsyncValueRef<ExecuteEvent> ExecutePackedMatMul(
+      const ExecuteParams& params, const float* lhs, const float* rhs,
+      float* out, int64_t m, int64_t k, int64_t n, bool transpose_rhs,
+      std::vector<const float*> epilogue_operands);
+
+  // Returns the RHS packed into panels, packing it if `rhs` is not the buffer
+  // the cached copy was packed from.
+  std::shared_ptr<const PackedMatrix> GetPackedRhs(const float* rhs, int64_t k,
+                                                   int64_t n,
+                                                   bool transpose_rhs);
+
   // Col-major x Col-major MatMul implementation as Eigen contraction.
   template <typename T, Eigen::AlignmentType alignment>
   static void MatMul(const Eigen::ThreadPoolDevice* device, T* out, T* lhs,
@@ -98,6 +167,17 @@ class DotThunk final : public Thunk {
   // Contracting dimensions of the LHS and RHS matmul shapes.
   absl::InlinedVector<int64_t, 2> lhs_matmul_contracting_dims_;
   absl::InlinedVector<int64_t, 2> rhs_matmul_contracting_dims_;
+
+  // Elementwise epilogue fused into the dot and its side inputs.
+  DotEpilogue epilogue_;
+  std::vector<BufferAllocation::Slice> epilogue_buffers_;
+
+  // Constant RHS (e.g. weights) packed into the panel layout of
+  // `PackedMatMul` on first execution, and the buffer it was packed from.
+  absl::Mutex packed_rhs_mu_;
+  const float* packed_rhs_source_ ABSL_GUARDED_BY(packed_rhs_mu_) = nullptr;
+  std::shared_ptr<const PackedMatrix> packed_rhs_
+      ABSL_GUARDED_BY(packed_rhs_mu_);
 };
 
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,213 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/dot_thunk.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xla/backends/cpu/runtime/buffer_allocations.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/service/maybe_owning_device_memory.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+#define EIGEN_USE_THREADS
+
+#include "unsupported/Eigen/CXX11/Tensor"
+
+namespace xla::cpu {
+namespace {
+
+// NOTE: This file covers the packed matmul path of DotThunk, which depends on
+// the RHS buffer allocation. Dot semantics for all backends are covered in
+// xla/tests/dot_operation_test.cc.
+
+// A row-major [m, k] x [k, n] F32 dot. With `transpose_rhs` the RHS is stored
+// as a row-major [n, k] matrix and contracted along its minor dimension.
+struct DotDims {
+  int64_t m;
+  int64_t k;
+  int64_t n;
+  bool transpose_rhs;
+};
+
+// Small integers, so that every summation order gives the exact result.
+std::vector<float> MakeData(int64_t size, int64_t seed) {
+  std::vector<float> data(size);
+  for (int64_t i = 0; i < size; ++i) {
+    data[i] = static_cast<float>((i * 7 + seed) % 9) - 4.0f;
+  }
+  return data;
+}
+
+std::vector<float> ReferenceDot(const DotDims& dims,
+                                const std::vector<float>& lhs,
+                                const std::vector<float>& rhs) {
+  std::vector<float> out(dims.m * dims.n, 0.0f);
+  for (int64_t i = 0; i < dims.m; ++i) {
+    for (int64_t j = 0; j < dims.n; ++j) {
+      for (int64_t p = 0; p < dims.k; ++p) {
+        float rhs_value = dims.transpose_rhs ? rhs[j * dims.k + p]
+                                             : rhs[p * dims.n + j];
+        out[i * dims.n + j] += lhs[i * dims.k + p] * rhs_value;
+      }
+    }
+  }
+  return out;
+}
+
+class DotThunkTest : public ::testing::Test {
+ protected:
+  DotThunkTest()
+      : thread_pool_(tsl::Env::Default(), "dot-thunk-test", 8),
+        device_(thread_pool_.AsEigenThreadPool(), thread_pool_.NumThreads()) {}
+
+  // Creates a dot thunk. The buffer allocations must outlive the thunk.
+  absl::StatusOr<std::unique_ptr<DotThunk>> CreateDotThunk(const DotDims& dims,
+                                                           bool constant_rhs) {
+    lhs_alloc_ = std::make_unique<BufferAllocation>(
+        /*index=*/0, dims.m * dims.k * sizeof(float), /*color=*/0);
+    rhs_alloc_ = std::make_unique<BufferAllocation>(
+        /*index=*/1, dims.k * dims.n * sizeof(float), /*color=*/0);
+    out_alloc_ = std::make_unique<BufferAllocation>(
+        /*index=*/2, dims.m * dims.n * sizeof(float), /*color=*/0);
+    rhs_alloc_->set_constant(constant_rhs);
+
+    DotDimensionNumbers dot_dimensions;
+    dot_dimensions.add_lhs_contracting_dimensions(1);
+    dot_dimensions.add_rhs_contracting_dimensions(dims.transpose_rhs ? 1 : 0);
+
+    Shape lhs_shape = ShapeUtil::MakeShape(F32, {dims.m, dims.k});
+    Shape rhs_shape = dims.transpose_rhs
+                          ? ShapeUtil::MakeShape(F32, {dims.n, dims.k})
+                          : ShapeUtil::MakeShape(F32, {dims.k, dims.n});
+    Shape out_shape = ShapeUtil::MakeShape(F32, {dims.m, dims.n});
+
+    return DotThunk::Create(
+        {"dot"}, dot_dimensions,
+        BufferAllocation::Slice(lhs_alloc_.get(), 0, lhs_alloc_->size()),
+        lhs_shape,
+        BufferAllocation::Slice(rhs_alloc_.get(), 0, rhs_alloc_->size()),
+        rhs_shape,
+        BufferAllocation::Slice(out_alloc_.get(), 0, out_alloc_->size()),
+        out_shape);
+  }
+
+  absl::Status Execute(DotThunk& thunk, std::vector<float>& lhs,
+                       std::vector<float>& rhs, std::vector<float>& out) {
+    std::vector<MaybeOwningDeviceMemory> buffers;
+    buffers.emplace_back(
+        se::DeviceMemoryBase(lhs.data(), lhs.size() * sizeof(float)));
+    buffers.emplace_back(
+        se::DeviceMemoryBase(rhs.data(), rhs.size() * sizeof(float)));
+    buffers.emplace_back(
+        se::DeviceMemoryBase(out.data(), out.size() * sizeof(float)));
+    BufferAllocations allocations(buffers);
+
+    Thunk::ExecuteParams params;
+    params.buffer_allocations = &allocations;
+    params.intra_op_threadpool = &device_;
+
+    auto execute_event = thunk.Execute(params);
+    tsl::BlockUntilReady(execute_event);
+    if (execute_event.IsError()) return execute_event.GetError();
+    return absl::OkStatus();
+  }
+
+  tsl::thread::ThreadPool thread_pool_;
+  Eigen::ThreadPoolDevice device_;
+  std::unique_ptr<BufferAllocation> lhs_alloc_;
+  std::unique_ptr<BufferAllocation> rhs_alloc_;
+  std::unique_ptr<BufferAllocation> out_alloc_;
+};
+
+// Shapes with a partial last panel, with enough work to split the panels
+// between several tasks, and with more LHS rows than the packed matmul kernel
+// handles, which run on Eigen even with a constant RHS.
+constexpr DotDims kDotDims[] = {
+    {1, 7, 5, false},   {4, 37, 21, false},  {16, 512, 67, false},
+    {1, 7, 5, true},    {4, 37, 21, true},   {16, 512, 67, true},
+    {17, 37, 21, false}, {17, 37, 21, true},
+};
+
+TEST_F(DotThunkTest, ConstantRhs) {
+  for (const DotDims& dims : kDotDims) {
+    TF_ASSERT_OK_AND_ASSIGN(auto thunk,
+                            CreateDotThunk(dims, /*constant_rhs=*/true));
+    std::vector<float> lhs = MakeData(dims.m * dims.k, 1);
+    std::vector<float> rhs = MakeData(dims.k * dims.n, 2);
+    std::vector<float> out(dims.m * dims.n);
+
+    // The second execution uses the RHS packed by the first one.
+    for (int i = 0; i < 2; ++i) {
+      TF_ASSERT_OK(Execute(*thunk, lhs, rhs, out));
+      EXPECT_EQ(out, ReferenceDot(dims, lhs, rhs))
+          << "m=" << dims.m << " k=" << dims.k << " n=" << dims.n
+          << " transpose_rhs=" << dims.transpose_rhs << " execution=" << i;
+    }
+  }
+}
+
+TEST_F(DotThunkTest, NonConstantRhs) {
+  for (const DotDims& dims : kDotDims) {
+    TF_ASSERT_OK_AND_ASSIGN(auto thunk,
+                            CreateDotThunk(dims, /*constant_rhs=*/false));
+    std::vector<float> lhs = MakeData(dims.m * dims.k, 1);
+    std::vector<float> rhs = MakeData(dims.k * dims.n, 2);
+    std::vector<float> out(dims.m * dims.n);
+
+    TF_ASSERT_OK(Execute(*thunk, lhs, rhs, out));
+    EXPECT_EQ(out, ReferenceDot(dims, lhs, rhs))
+        << "m=" << dims.m << " k=" << dims.k << " n=" << dims.n
+        << " transpose_rhs=" << dims.transpose_rhs;
+  }
+}
+
+TEST_F(DotThunkTest, ConstantRhsIsRepackedForNewBuffer) {
+  DotDims dims = {4, 37, 21, false};
+  TF_ASSERT_OK_AND_ASSIGN(auto thunk,
+                          CreateDotThunk(dims, /*constant_rhs=*/true));
+  std::vector<float> lhs = MakeData(dims.m * dims.k, 1);
+  std::vector<float> rhs_0 = MakeData(dims.k * dims.n, 2);
+  std::vector<float> rhs_1 = MakeData(dims.k * dims.n, 3);
+  std::vector<float> out(dims.m * dims.n);
+
+  TF_ASSERT_OK(Execute(*thunk, lhs, rhs_0, out));
+  EXPECT_EQ(out, ReferenceDot(dims, lhs, rhs_0));
+
+  // The same thunk executed with a constant in a different buffer, e.g. by
+  // another instance of the executable.
+  TF_ASSERT_OK(Execute(*thunk, lhs, rhs_1, out));
+  EXPECT_EQ(out, ReferenceDot(dims, lhs, rhs_1));
+
+  TF_ASSERT_OK(Execute(*thunk, lhs, rhs_0, out));
+  EXPECT_EQ(out, ReferenceDot(dims, lhs, rhs_0));
+}
+
+}  // namespace
+}  // namespace xla::cpu
@@ -14,6 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "xla/backends/cpu/runtime/fft_thunk.h"
 
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 
@@ -21,16 +25,19 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "unsupported/Eigen/CXX11/Tensor"
+#include "xla/backends/cpu/runtime/concurrency.h"
 #include "xla/backends/cpu/runtime/thunk.h"
 #include "xla/layout_util.h"
 #include "xla/runtime/buffer_use.h"
 #include "xla/service/buffer_assignment.h"
-#include "xla/service/cpu/runtime_fft.h"
 #include "xla/service/cpu/runtime_single_threaded_fft.h"
 #include "xla/shape.h"
+#include "xla/shape_util.h"
 #include "xla/status_macros.h"
 #include "xla/stream_executor/device_memory.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/util.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/profiler/lib/traceme.h"
 
@@ -49,15 +56,36 @@ FftThunk::FftThunk(Info thunk_info, bool is_multi_thread_eigen,
       fft_type_(fft_type),
       fft_length_(fft_length.begin(), fft_length.end()),
       input_buffer_(input_buffer),
-      output_buffer_(output_buffer),
-      input_shape_(input_shape),
-      output_shape_(output_shape) {}
+      output_buffer_(output_buffer) {
+  const int fft_rank = fft_length_.size();
+
+  // Flatten operand batches.
+  operand_shape_flat_.resize(fft_rank + 1);
+  int64_t input_batch = 1;
+  int64_t input_batch_length = output_shape.dimensions_size() - fft_rank;
+  for (int i = 0; i < input_batch_length; i++) {
+    input_batch *= input_shape.dimensions(i);
+  }
+  operand_shape_flat_[0] = input_batch;
+  for (int i = 0; i < fft_rank; ++i) {
+    operand_shape_flat_[i + 1] = input_shape.dimensions(i + input_batch_length);
+  }
+
+  if (input_batch > 0) {
+    input_batch_bytes_ = ShapeUtil::ByteSizeOfElements(input_shape) /
+                         input_batch;
+    output_batch_bytes_ = ShapeUtil::ByteSizeOfElements(output_shape) /
+                          input_batch;
+  }
+}
 
 absl::StatusOr<std::unique_ptr<FftThunk>> FftThunk::Create(
     Info thunk_info, bool is_multi_thread_eigen, int32_t fft_type,
     absl::Span<const int64_t> fft_length, BufferAllocation::Slice input_buffer,
     const Shape& input_shape, BufferAllocation::Slice output_buffer,
     const Shape& output_shape) {
+  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(input_shape.layout()));
+  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(output_shape.layout()));
   return absl::WrapUnique(
       new FftThunk(thunk_info, is_multi_thread_eigen, fft_type, fft_length,
                    input_buffer, input_shape, output_buffer, output_shape));
@@ -66,8 +94,6 @@ absl::StatusOr<std::unique_ptr<FftThunk>> FftThunk::Create(
 tsl::AsyncValueRef<Thunk::ExecuteEvent> FftThunk::Execute(
     const ExecuteParams& params) {
   tsl::profiler::TraceMe trace([&] { return TraceMeEncode(); });
-  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(input_shape_.layout()));
-  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(output_shape_.layout()));
 
   TF_ASSIGN_OR_RETURN(
       se::DeviceMemoryBase input_data,
@@ -77,34 +103,48 @@ tsl::AsyncValueRef<Thunk::ExecuteEvent> FftThunk::Execute(
       params.buffer_allocations->GetDeviceAddress(output_buffer_));
 
   const int fft_rank = fft_length_.size();
+  auto* input = static_cast<char*>(input_data.opaque());
+  auto* output = static_cast<char*>(output_data.opaque());
 
-  // Flatten operand batches.
-  absl::InlinedVector<int64_t, 4> operand_shape_flat(fft_rank + 1);
-  int64_t input_batch = 1;
-  int64_t input_batch_length = output_shape_.dimensions_size() - fft_rank;
-  for (int i = 0; i < input_batch_length; i++) {
-    input_batch *= input_shape_.dimensions(i);
-  }
-  operand_shape_flat[0] = input_batch;
-  for (int i = 0; i < fft_rank; ++i) {
-    operand_shape_flat[i + 1] = input_shape_.dimensions(i + input_batch_length);
-  }
-
-  // Args have been computed, make the call.
-  if (is_multi_thread_eigen_) {
-    __xla_cpu_runtime_DuccFft(nullptr,
-                              reinterpret_cast<float*>(output_data.opaque()),
-                              reinterpret_cast<float*>(input_data.opaque()),
-                              fft_type_, is_double_precision_, fft_rank,
-                              operand_shape_flat.data(), fft_length_.data());
-  } else {
+  // Computes FFTs of the batches [begin, end) in the caller thread.
+  auto fft = [this, fft_rank, input, output](int64_t begin, int64_t end) {
+    absl::InlinedVector<int64_t, 4> operand_shape = operand_shape_flat_;
+    operand_shape[0] = end - begin;
     __xla_cpu_runtime_DuccSingleThreadedFft(
-        nullptr, reinterpret_cast<float*>(output_data.opaque()),
-        reinterpret_cast<float*>(input_data.opaque()), fft_type_,
-        is_double_precision_, fft_rank, operand_shape_flat.data(),
-        fft_length_.data());
+        nullptr, output + begin * output_batch_bytes_,
+        input + begin * input_batch_bytes_, fft_type_, is_double_precision_,
+        fft_rank, operand_shape.data(), fft_length_.data());
+  };
+
+  int64_t batch = operand_shape_flat_[0];
+  int64_t num_threads = params.intra_op_threadpool
+                            ? params.intra_op_threadpool->numThreadsInPool()
+                            : 1;
+  int64_t num_tasks = std::min(batch, num_threads);
+
+  if (!is_multi_thread_eigen_ || params.intra_op_threadpool == nullptr ||
+      num_tasks <= 1) {
+    fft(0, batch);
+    return OkExecuteEvent();
   }
-  return OkExecuteEvent();
+
+  // Split the batch across the intra-op thread pool, and complete the execute
+  // event when the last task is done.
+  int64_t batch_per_task = CeilOfRatio(batch, num_tasks);
+  num_tasks = CeilOfRatio(batch, batch_per_task);
+
+  auto event = tsl::MakeConstructedAsyncValueRef<ExecuteEvent>();
+  auto pending = std::make_shared<std::atomic<int64_t>>(num_tasks);
+
+  ScheduleAll(params.intra_op_threadpool, num_tasks, [=](int64_t task_index) {
+    int64_t begin = task_index * batch_per_task;
+    fft(begin, std::min(batch, begin + batch_per_task));
+    if (pending->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      event.SetStateConcrete();
+    }
+  });
+
+  return event;
 }
 
 Thunk::BufferUses FftThunk::buffer_uses() const {
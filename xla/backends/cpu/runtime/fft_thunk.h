@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xla/backends/cpu/runtime/thunk.h"
@@ -33,6 +34,10 @@ namespace xla::cpu {
 // This class stores everything that is needed to launch an FFT.
 // It is generated by IrEmitter.
 //
+// Multi-threaded FFTs split the batch dimension across the intra-op thread
+// pool tasks and complete the execute event asynchronously, as thunks must not
+// block waiting for the intra-op thread pool.
+//
 // This is thread-compatible.
 class FftThunk final : public Thunk {
  public:
@@ -62,8 +67,15 @@ class FftThunk final : public Thunk {
   const BufferAllocation::Slice input_buffer_;
   const BufferAllocation::Slice output_buffer_;
 
-  const Shape input_shape_;
-  const Shape output_shape_;
+  // Input shape with all batch dimensions flattened into the first one,
+  // followed by the FFT dimensions. Computed once as it depends only on the
+  // static shapes.
+  absl::InlinedVector<int64_t, 4> operand_shape_flat_;
+
+  // Sizes in bytes of one batch of the input and of the output, used to split
+  // multi-threaded FFTs into batches.
+  int64_t input_batch_bytes_ = 0;
+  int64_t output_batch_bytes_ = 0;
 };
 
 }  // namespace xla::cpu
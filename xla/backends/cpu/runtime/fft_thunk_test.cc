@@ -0,0 +1,117 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/fft_thunk.h"
+
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "xla/backends/cpu/runtime/buffer_allocations.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/service/maybe_owning_device_memory.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+#define EIGEN_USE_THREADS
+
+#include "unsupported/Eigen/CXX11/Tensor"
+
+namespace xla::cpu {
+namespace {
+
+using Complex = std::complex<float>;
+
+// Runs a forward complex FFT of length 4 over `batch` rows of `input`.
+absl::Status RunFft(std::vector<Complex>& input, std::vector<Complex>& output,
+                    int64_t batch, bool is_multi_thread_eigen,
+                    const Eigen::ThreadPoolDevice* device = nullptr) {
+  std::vector<MaybeOwningDeviceMemory> buffers;
+  buffers.emplace_back(
+      se::DeviceMemoryBase(input.data(), input.size() * sizeof(Complex)));
+  buffers.emplace_back(
+      se::DeviceMemoryBase(output.data(), output.size() * sizeof(Complex)));
+  BufferAllocations allocations(buffers);
+
+  BufferAllocation alloc0(0, buffers[0].AsDeviceMemoryBase().size(), 0);
+  BufferAllocation alloc1(1, buffers[1].AsDeviceMemoryBase().size(), 0);
+
+  BufferAllocation::Slice input_slice(&alloc0, 0, alloc0.size());
+  BufferAllocation::Slice output_slice(&alloc1, 0, alloc1.size());
+
+  Shape shape = ShapeUtil::MakeShapeWithDescendingLayout(C64, {batch, 4});
+
+  TF_ASSIGN_OR_RETURN(
+      auto thunk, FftThunk::Create({"fft"}, is_multi_thread_eigen, FftType::FFT,
+                                   /*fft_length=*/{4}, input_slice, shape,
+                                   output_slice, shape));
+
+  Thunk::ExecuteParams params;
+  params.buffer_allocations = &allocations;
+  params.intra_op_threadpool = device;
+
+  auto execute_event = thunk->Execute(params);
+  tsl::BlockUntilReady(execute_event);
+  if (execute_event.IsError()) return execute_event.GetError();
+  return absl::OkStatus();
+}
+
+TEST(FftThunkTest, ForwardFft) {
+  std::vector<Complex> input = {1, 0, 0, 0, 0, 1, 0, 0};
+  std::vector<Complex> output(8);
+
+  TF_ASSERT_OK(RunFft(input, output, /*batch=*/2,
+                      /*is_multi_thread_eigen=*/false));
+  std::vector<Complex> expected = {1, 1, 1, 1, {1, 0}, {0, -1}, {-1, 0},
+                                   {0, 1}};
+  for (int64_t i = 0; i < output.size(); ++i) {
+    EXPECT_NEAR(output[i].real(), expected[i].real(), 1e-6) << i;
+    EXPECT_NEAR(output[i].imag(), expected[i].imag(), 1e-6) << i;
+  }
+}
+
+TEST(FftThunkTest, MultiThreadedFftMatchesSingleThreaded) {
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "fft-test", 8);
+  Eigen::ThreadPoolDevice device(thread_pool.AsEigenThreadPool(),
+                                 thread_pool.NumThreads());
+
+  int64_t batch = 123;
+  std::vector<Complex> input(batch * 4);
+  for (int64_t i = 0; i < input.size(); ++i) {
+    input[i] = Complex((i * 7919) % 17, (i * 104729) % 13);
+  }
+
+  std::vector<Complex> expected(input.size());
+  TF_ASSERT_OK(RunFft(input, expected, batch,
+                      /*is_multi_thread_eigen=*/false));
+
+  std::vector<Complex> output(input.size());
+  TF_ASSERT_OK(RunFft(input, output, batch, /*is_multi_thread_eigen=*/true,
+                      &device));
+  EXPECT_EQ(output, expected);
+}
+
+}  // namespace
+}  // namespace xla::cpu
@@ -0,0 +1,88 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/first_touch.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/types/span.h"
+#include "xla/backends/cpu/runtime/concurrency.h"
+#include "xla/stream_executor/device_memory.h"
+#include "tsl/platform/logging.h"
+
+namespace xla::cpu {
+
+// Touches pages in the [begin, end) range of pages of the concatenated buffers.
+// `offsets[i]` is the index of the first page of `buffers[i]`.
+static void TouchPages(absl::Span<const se::DeviceMemoryBase> buffers,
+                       absl::Span<const int64_t> offsets, int64_t begin,
+                       int64_t end) {
+  // Find the buffer that contains the page `begin`.
+  size_t i = std::upper_bound(offsets.begin(), offsets.end(), begin) -
+             offsets.begin() - 1;
+
+  for (int64_t page = begin; page < end; ++page) {
+    while (page >= offsets[i + 1]) ++i;
+    volatile char* base = static_cast<volatile char*>(buffers[i].opaque());
+    base[(page - offsets[i]) * kFirstTouchPageSize] = 0;
+  }
+}
+
+void FirstTouchBuffers(absl::Span<const se::DeviceMemoryBase> buffers,
+                       const Eigen::ThreadPoolDevice* intra_op_threadpool) {
+  if (intra_op_threadpool == nullptr ||
+      intra_op_threadpool->numThreads() <= 1) {
+    return;
+  }
+
+  // Page offsets of all buffers in the concatenated range of pages, with the
+  // total number of pages as the last element.
+  std::vector<int64_t> offsets = {0};
+  offsets.reserve(buffers.size() + 1);
+  for (const se::DeviceMemoryBase& buffer : buffers) {
+    int64_t num_pages =
+        (buffer.size() + kFirstTouchPageSize - 1) / kFirstTouchPageSize;
+    offsets.push_back(offsets.back() + num_pages);
+  }
+
+  int64_t num_pages = offsets.back();
+  int64_t num_tasks =
+      std::min<int64_t>(intra_op_threadpool->numThreads(), num_pages);
+  if (num_tasks == 0) return;
+
+  VLOG(3) << "First touch " << num_pages << " pages of " << buffers.size()
+          << " buffers using " << num_tasks << " tasks";
+
+  // Distribute pages evenly: the first `num_pages % num_tasks` tasks touch one
+  // extra page.
+  int64_t pages_per_task = num_pages / num_tasks;
+  int64_t num_larger_tasks = num_pages % num_tasks;
+  auto task_begin = [&](int64_t task) {
+    return task * pages_per_task + std::min(task, num_larger_tasks);
+  };
+
+  absl::BlockingCounter counter(num_tasks);
+  ScheduleAll(intra_op_threadpool, num_tasks, [&](int64_t task) {
+    TouchPages(buffers, offsets, task_begin(task), task_begin(task + 1));
+    counter.DecrementCount();
+  });
+  counter.Wait();
+}
+
+}  // namespace xla::cpu
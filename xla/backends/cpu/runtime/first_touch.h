@@ -0,0 +1,51 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_BACKENDS_CPU_RUNTIME_FIRST_TOUCH_H_
+#define XLA_BACKENDS_CPU_RUNTIME_FIRST_TOUCH_H_
+
+#include <cstddef>
+
+#include "absl/types/span.h"
+#include "xla/stream_executor/device_memory.h"
+
+#define EIGEN_USE_THREADS
+#include "unsupported/Eigen/CXX11/Tensor"
+
+namespace xla::cpu {
+
+// Granularity of the first-touch writes. Writing one byte per (smallest) page
+// is enough to fault in the page on the NUMA node of the writing thread.
+inline constexpr size_t kFirstTouchPageSize = 4096;
+
+// Writes to every page of `buffers` from the worker threads of the
+// `intra_op_threadpool`, so that with the default first-touch NUMA policy the
+// pages of freshly allocated buffers are distributed across the NUMA nodes of
+// the thread pool instead of being faulted in on the node of the thread that
+// happens to touch them first (usually the thread running the first thunk).
+//
+// Buffers are concatenated and split into one contiguous range of pages per
+// thread, which mirrors the contiguous row partitioning of parallel thunks and
+// keeps every partition of a large buffer on few NUMA nodes.
+//
+// The contents of the buffers are clobbered, so it must only be used for
+// buffers without live data (i.e., temporary buffers). Blocks the caller until
+// all pages are touched, and must not be called from the thread pool itself.
+void FirstTouchBuffers(absl::Span<const se::DeviceMemoryBase> buffers,
+                       const Eigen::ThreadPoolDevice* intra_op_threadpool);
+
+}  // namespace xla::cpu
+
+#endif  // XLA_BACKENDS_CPU_RUNTIME_FIRST_TOUCH_H_
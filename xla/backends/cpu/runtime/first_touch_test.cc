@@ -0,0 +1,71 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/first_touch.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "xla/stream_executor/device_memory.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+#define EIGEN_USE_THREADS
+#include "unsupported/Eigen/CXX11/Tensor"
+
+namespace xla::cpu {
+namespace {
+
+TEST(FirstTouchTest, TouchesEveryPage) {
+  tsl::thread::ThreadPool threads(tsl::Env::Default(), "test", 4);
+  Eigen::ThreadPoolDevice device(threads.AsEigenThreadPool(),
+                                 threads.NumThreads());
+
+  // Buffers with sizes that are not multiples of the page size, including an
+  // empty one.
+  std::vector<size_t> sizes = {3 * kFirstTouchPageSize + 1, 0,
+                               kFirstTouchPageSize / 2,
+                               10 * kFirstTouchPageSize};
+
+  std::vector<std::vector<char>> data;
+  std::vector<se::DeviceMemoryBase> buffers;
+  for (size_t size : sizes) {
+    data.emplace_back(size, 1);
+    buffers.emplace_back(data.back().data(), size);
+  }
+
+  FirstTouchBuffers(buffers, &device);
+
+  for (size_t i = 0; i < data.size(); ++i) {
+    for (size_t offset = 0; offset < data[i].size(); ++offset) {
+      bool is_page_start = offset % kFirstTouchPageSize == 0;
+      EXPECT_EQ(data[i][offset], is_page_start ? 0 : 1)
+          << "buffer=" << i << " offset=" << offset;
+    }
+  }
+}
+
+TEST(FirstTouchTest, NoThreadPool) {
+  std::vector<char> data(kFirstTouchPageSize, 1);
+  std::vector<se::DeviceMemoryBase> buffers = {
+      se::DeviceMemoryBase(data.data(), data.size())};
+
+  FirstTouchBuffers(buffers, /*intra_op_threadpool=*/nullptr);
+  EXPECT_EQ(data[0], 1);
+}
+
+}  // namespace
+}  // namespace xla::cpu
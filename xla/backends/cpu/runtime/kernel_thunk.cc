@@ -228,13 +228,20 @@ KernelThunk<num_arguments, num_results>::ExecuteInternal(
   }
 
   // If intra-op thread pool is not nullptr, we launch HostKernel in async mode
-  // by scheduling tasks into it. HostKernel launch completion will
+  // by scheduling one worker per pool thread into it, and workers dynamically
+  // balance kernel partitions between them. HostKernel launch completion will
   // automatically signal KernelThunk execute completion.
+  //
+  // Workers might still be scheduling tasks after the last kernel partition
+  // completed the launch event, so the task runner must not refer to `params`.
   if (ABSL_PREDICT_TRUE(params.intra_op_threadpool)) {
+    Eigen::ThreadPoolInterface* pool = params.intra_op_threadpool->getPool();
     return kernel->Launch(
-        thread_dim_, kernel_args, [&params](se::host::HostKernel::Task task) {
-          params.intra_op_threadpool->getPool()->Schedule(std::move(task));
-        });
+        thread_dim_, kernel_args,
+        [pool](se::host::HostKernel::Task task) {
+          pool->Schedule(std::move(task));
+        },
+        params.intra_op_threadpool->numThreadsInPool());
   }
 
   TF_RETURN_IF_ERROR(kernel->Launch(thread_dim_, kernel_args));
@@ -0,0 +1,190 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/packed_matmul.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/base/casts.h"
+#include "tsl/platform/ml_dtypes.h"
+
+namespace xla::cpu {
+
+static constexpr int64_t kPanelCols = PackedMatrix::kPanelCols;
+
+// Number of `lhs` rows computed together by the micro-kernel. Together with
+// the panel width it defines the [kBlockRows, kPanelCols] output tile that is
+// accumulated in registers.
+static constexpr int64_t kBlockRows = 4;
+
+PackedMatrix PackedMatrix::Pack(const float* data, int64_t k, int64_t n,
+                                bool transposed) {
+  int64_t num_panels = (n + kPanelCols - 1) / kPanelCols;
+  std::vector<float> packed(num_panels * k * kPanelCols, 0.0f);
+
+  for (int64_t p = 0; p < num_panels; ++p) {
+    float* panel = packed.data() + p * k * kPanelCols;
+    int64_t cols = std::min(kPanelCols, n - p * kPanelCols);
+    for (int64_t kk = 0; kk < k; ++kk) {
+      for (int64_t j = 0; j < cols; ++j) {
+        int64_t col = p * kPanelCols + j;
+        panel[kk * kPanelCols + j] =
+            transposed ? data[col * k + kk] : data[kk * n + col];
+      }
+    }
+  }
+
+  return PackedMatrix(k, n, std::move(packed));
+}
+
+// Computes a [kRows, kPanelCols] output tile from `kRows` rows of `lhs` and a
+// single panel. Column `j` of the tile is stored only if `j < cols`.
+template <int64_t kRows>
+static void PackedMatMulTile(const float* lhs, const float* panel, float* out,
+                             int64_t k, int64_t n, int64_t cols) {
+  float acc[kRows][kPanelCols] = {};
+
+  for (int64_t kk = 0; kk < k; ++kk) {
+    const float* b = panel + kk * kPanelCols;
+    for (int64_t i = 0; i < kRows; ++i) {
+      float a = lhs[i * k + kk];
+      for (int64_t j = 0; j < kPanelCols; ++j) {
+        acc[i][j] += a * b[j];
+      }
+    }
+  }
+
+  for (int64_t i = 0; i < kRows; ++i) {
+    std::copy_n(acc[i], cols, out + i * n);
+  }
+}
+
+void PackedMatMulPanel(const float* lhs, const float* panel, float* out,
+                       int64_t m, int64_t k, int64_t n, int64_t index) {
+  int64_t cols = std::min(kPanelCols, n - index * kPanelCols);
+  float* out_panel = out + index * kPanelCols;
+
+  int64_t i = 0;
+  for (; i + kBlockRows <= m; i += kBlockRows) {
+    PackedMatMulTile<kBlockRows>(lhs + i * k, panel, out_panel + i * n, k, n,
+                                 cols);
+  }
+  for (; i < m; ++i) {
+    PackedMatMulTile<1>(lhs + i * k, panel, out_panel + i * n, k, n, cols);
+  }
+}
+
+void PackedMatMul(const float* lhs, const PackedMatrix& rhs, float* out,
+                  int64_t m, int64_t panel_begin, int64_t panel_end) {
+  for (int64_t p = panel_begin; p < panel_end; ++p) {
+    PackedMatMulPanel(lhs, rhs.panel(p), out, m, rhs.k(), rhs.n(), p);
+  }
+}
+
+// Returns a table mapping every byte of a quantized element to its F32 value.
+// 4-bit elements are looked up by their 4 bits, or by a byte that holds them
+// sign-extended (S4) or zero-extended (U4) if they are not packed.
+static const std::array<float, 256>& GetDequantizeTable(QuantizedType type) {
+  using Table = std::array<float, 256>;
+  static const std::array<Table, 4>* tables = [] {
+    auto* tables = new std::array<Table, 4>();
+    for (int value = 0; value < 256; ++value) {
+      uint8_t byte = value;
+      (*tables)[static_cast<int>(QuantizedType::kS4)][value] =
+          static_cast<int8_t>(byte << 4) >> 4;
+      (*tables)[static_cast<int>(QuantizedType::kU4)][value] = byte & 0xF;
+      (*tables)[static_cast<int>(QuantizedType::kF8E4M3FN)][value] =
+          static_cast<float>(absl::bit_cast<tsl::float8_e4m3fn>(byte));
+      (*tables)[static_cast<int>(QuantizedType::kF8E5M2)][value] =
+          static_cast<float>(absl::bit_cast<tsl::float8_e5m2>(byte));
+    }
+    return tables;
+  }();
+  return (*tables)[static_cast<int>(type)];
+}
+
+static bool IsPacked(const QuantizedMatrix& matrix) {
+  return matrix.packed && (matrix.type == QuantizedType::kS4 ||
+                           matrix.type == QuantizedType::kU4);
+}
+
+// Loads the quantized element with the given linear index.
+static uint8_t LoadQuantized(const uint8_t* data, bool is_packed,
+                             int64_t element) {
+  if (!is_packed) return data[element];
+  uint8_t byte = data[element / 2];
+  return element % 2 == 0 ? byte >> 4 : byte & 0xF;
+}
+
+void Dequantize(const QuantizedMatrix& matrix, float* out) {
+  const std::array<float, 256>& table = GetDequantizeTable(matrix.type);
+  const uint8_t* data = static_cast<const uint8_t*>(matrix.data);
+  bool is_packed = IsPacked(matrix);
+
+  int64_t num_elements = matrix.k * matrix.n;
+  for (int64_t i = 0; i < num_elements; ++i) {
+    out[i] = table[LoadQuantized(data, is_packed, i)];
+  }
+}
+
+void DequantizePanel(const QuantizedMatrix& matrix, int64_t index,
+                     float* panel) {
+  const std::array<float, 256>& table = GetDequantizeTable(matrix.type);
+  const uint8_t* data = static_cast<const uint8_t*>(matrix.data);
+  const int64_t k = matrix.k;
+  const int64_t n = matrix.n;
+
+  int64_t col_begin = index * kPanelCols;
+  int64_t cols = std::min(kPanelCols, n - col_begin);
+  if (cols < kPanelCols) std::fill_n(panel, k * kPanelCols, 0.0f);
+
+  bool is_packed = IsPacked(matrix);
+  auto load = [&](int64_t element) {
+    return LoadQuantized(data, is_packed, element);
+  };
+
+  for (int64_t kk = 0; kk < k; ++kk) {
+    float* row = panel + kk * kPanelCols;
+
+    if (matrix.transposed) {
+      for (int64_t j = 0; j < cols; ++j) {
+        row[j] = table[load((col_begin + j) * k + kk)];
+      }
+      continue;
+    }
+
+    // A full panel row of packed elements starting at a byte boundary is
+    // unpacked byte by byte, two elements at a time.
+    int64_t element = kk * n + col_begin;
+    if (is_packed && cols == kPanelCols && element % 2 == 0) {
+      const uint8_t* bytes = data + element / 2;
+      for (int64_t j = 0; j < kPanelCols / 2; ++j) {
+        row[2 * j] = table[bytes[j] >> 4];
+        row[2 * j + 1] = table[bytes[j] & 0xF];
+      }
+      continue;
+    }
+
+    for (int64_t j = 0; j < cols; ++j) {
+      row[j] = table[load(element + j)];
+    }
+  }
+}
+
+}  // namespace xla::cpu
@@ -0,0 +1,105 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_BACKENDS_CPU_RUNTIME_PACKED_MATMUL_H_
+#define XLA_BACKENDS_CPU_RUNTIME_PACKED_MATMUL_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace xla::cpu {
+
+// A [k, n] matrix packed into panels of `kPanelCols` columns. Every panel is a
+// contiguous row-major [k, kPanelCols] block, and the last panel is padded
+// with zeros. This is the layout consumed by the micro-kernel of
+// `PackedMatMul`, so a matrix that doesn't change between calls (e.g. a
+// constant weight of a dot) can be packed once and reused without repacking.
+class PackedMatrix {
+ public:
+  static constexpr int64_t kPanelCols = 8;
+
+  // Packs a row-major [k, n] matrix, or a row-major [n, k] matrix holding its
+  // transpose if `transposed` is true.
+  static PackedMatrix Pack(const float* data, int64_t k, int64_t n,
+                           bool transposed);
+
+  int64_t k() const { return k_; }
+  int64_t n() const { return n_; }
+  int64_t num_panels() const { return (n_ + kPanelCols - 1) / kPanelCols; }
+
+  // Returns a pointer to the [k, kPanelCols] block of panel `index`.
+  const float* panel(int64_t index) const {
+    return data_.data() + index * k_ * kPanelCols;
+  }
+
+ private:
+  PackedMatrix(int64_t k, int64_t n, std::vector<float> data)
+      : k_(k), n_(n), data_(std::move(data)) {}
+
+  int64_t k_;
+  int64_t n_;
+  std::vector<float> data_;
+};
+
+// Element type of a quantized matrix (e.g. weight-only quantized weights).
+enum class QuantizedType { kS4, kU4, kF8E4M3FN, kF8E5M2 };
+
+// A [k, n] quantized matrix that is dequantized to F32 panel by panel, in the
+// layout of `PackedMatrix` panels, right before the panel is multiplied.
+struct QuantizedMatrix {
+  QuantizedType type;
+
+  // A row-major [k, n] matrix, or a row-major [n, k] matrix holding its
+  // transpose if `transposed` is true. Unless `packed` is false, 4-bit
+  // elements are packed two per byte, the first one in the most significant
+  // bits.
+  const void* data;
+  int64_t k;
+  int64_t n;
+  bool transposed = false;
+  bool packed = true;
+
+  int64_t num_panels() const {
+    return (n + PackedMatrix::kPanelCols - 1) / PackedMatrix::kPanelCols;
+  }
+};
+
+// Dequantizes panel `index` of `matrix` into `panel`, a [k, kPanelCols] block
+// that is padded with zeros in the last panel.
+void DequantizePanel(const QuantizedMatrix& matrix, int64_t index,
+                     float* panel);
+
+// Dequantizes the whole `matrix` into `out`, a row-major F32 matrix with the
+// same dimensions and layout as `matrix.data`.
+void Dequantize(const QuantizedMatrix& matrix, float* out);
+
+// Computes columns of `out` = `lhs` x `panel` for a single [k, kPanelCols]
+// panel with the given `index`, where `lhs` is a row-major [m, k] matrix and
+// `out` is a row-major [m, n] matrix.
+void PackedMatMulPanel(const float* lhs, const float* panel, float* out,
+                       int64_t m, int64_t k, int64_t n, int64_t index);
+
+// Computes columns of `out` = `lhs` x `rhs` for the panels
+// [panel_begin, panel_end) of `rhs`, where `lhs` is a row-major [m, k] matrix
+// and `out` is a row-major [m, rhs.n()] matrix. The kernel keeps the output
+// tile in registers and streams each panel once per block of rows, so it is
+// intended for a small `m` (e.g. batch-1 inference).
+void PackedMatMul(const float* lhs, const PackedMatrix& rhs, float* out,
+                  int64_t m, int64_t panel_begin, int64_t panel_end);
+
+}  // namespace xla::cpu
+
+#endif  // XLA_BACKENDS_CPU_RUNTIME_PACKED_MATMUL_H_
@@ -0,0 +1,172 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/packed_matmul.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tsl/platform/ml_dtypes.h"
+#include "tsl/platform/test.h"
+
+namespace xla::cpu {
+namespace {
+
+// Reference matmul of a row-major [m, k] lhs with a row-major [k, n] rhs, or
+// a row-major [n, k] rhs if `transposed` is true.
+std::vector<float> ReferenceMatMul(const std::vector<float>& lhs,
+                                   const std::vector<float>& rhs, int64_t m,
+                                   int64_t k, int64_t n, bool transposed) {
+  std::vector<float> out(m * n, 0.0f);
+  for (int64_t i = 0; i < m; ++i) {
+    for (int64_t j = 0; j < n; ++j) {
+      for (int64_t kk = 0; kk < k; ++kk) {
+        float b = transposed ? rhs[j * k + kk] : rhs[kk * n + j];
+        out[i * n + j] += lhs[i * k + kk] * b;
+      }
+    }
+  }
+  return out;
+}
+
+std::vector<float> Iota(int64_t size, float scale) {
+  std::vector<float> data(size);
+  for (int64_t i = 0; i < size; ++i) data[i] = scale * (i % 17 - 8);
+  return data;
+}
+
+TEST(PackedMatMulTest, PackPadsLastPanel) {
+  // [2, 10] matrix packed into two panels of 8 columns.
+  std::vector<float> rhs = Iota(20, 1.0f);
+  PackedMatrix packed = PackedMatrix::Pack(rhs.data(), 2, 10, false);
+
+  ASSERT_EQ(packed.num_panels(), 2);
+  EXPECT_EQ(packed.panel(0)[0], rhs[0]);
+  EXPECT_EQ(packed.panel(0)[PackedMatrix::kPanelCols], rhs[10]);
+  EXPECT_EQ(packed.panel(1)[1], rhs[9]);
+  EXPECT_EQ(packed.panel(1)[2], 0.0f);
+}
+
+TEST(PackedMatMulTest, MatchesReference) {
+  for (int64_t m : {1, 3, 4, 9}) {
+    for (int64_t k : {1, 7, 64}) {
+      for (int64_t n : {1, 8, 13, 40}) {
+        for (bool transposed : {false, true}) {
+          std::vector<float> lhs = Iota(m * k, 0.5f);
+          std::vector<float> rhs = Iota(k * n, 0.25f);
+
+          PackedMatrix packed =
+              PackedMatrix::Pack(rhs.data(), k, n, transposed);
+          std::vector<float> out(m * n, -1.0f);
+          PackedMatMul(lhs.data(), packed, out.data(), m, 0,
+                       packed.num_panels());
+
+          EXPECT_EQ(out, ReferenceMatMul(lhs, rhs, m, k, n, transposed))
+              << "m=" << m << " k=" << k << " n=" << n
+              << " transposed=" << transposed;
+        }
+      }
+    }
+  }
+}
+
+TEST(PackedMatMulTest, ComputesPanelRange) {
+  int64_t m = 2, k = 5, n = 24;
+  std::vector<float> lhs = Iota(m * k, 1.0f);
+  std::vector<float> rhs = Iota(k * n, 1.0f);
+  PackedMatrix packed = PackedMatrix::Pack(rhs.data(), k, n, false);
+
+  // Compute panels one by one, as if they were computed by separate tasks.
+  std::vector<float> out(m * n, 0.0f);
+  for (int64_t p = packed.num_panels() - 1; p >= 0; --p) {
+    PackedMatMul(lhs.data(), packed, out.data(), m, p, p + 1);
+  }
+
+  EXPECT_EQ(out, ReferenceMatMul(lhs, rhs, m, k, n, false));
+}
+
+// Computes `lhs` x `rhs` for a quantized `rhs` one dequantized panel at a
+// time.
+std::vector<float> DequantizedMatMul(const std::vector<float>& lhs,
+                                     const QuantizedMatrix& rhs, int64_t m) {
+  std::vector<float> out(m * rhs.n, -1.0f);
+  std::vector<float> panel(rhs.k * PackedMatrix::kPanelCols);
+  for (int64_t p = 0; p < rhs.num_panels(); ++p) {
+    DequantizePanel(rhs, p, panel.data());
+    PackedMatMulPanel(lhs.data(), panel.data(), out.data(), m, rhs.k, rhs.n,
+                      p);
+  }
+  return out;
+}
+
+TEST(PackedMatMulTest, DequantizedInt4MatchesReference) {
+  for (int64_t n : {1, 8, 13, 40}) {
+    for (bool transposed : {false, true}) {
+      int64_t m = 3, k = 7;
+      std::vector<float> lhs = Iota(m * k, 0.5f);
+
+      // Pack S4 values in [-8, 7] two per byte, and U4 values in [0, 15].
+      std::vector<float> s4_values(k * n), u4_values(k * n);
+      std::vector<uint8_t> s4((k * n + 1) / 2, 0), u4((k * n + 1) / 2, 0);
+      for (int64_t i = 0; i < k * n; ++i) {
+        int64_t s4_value = i % 16 - 8, u4_value = (i * 7) % 16;
+        s4_values[i] = s4_value;
+        u4_values[i] = u4_value;
+        int64_t shift = i % 2 == 0 ? 4 : 0;
+        s4[i / 2] |= (s4_value & 0xF) << shift;
+        u4[i / 2] |= u4_value << shift;
+      }
+
+      QuantizedMatrix s4_rhs{QuantizedType::kS4, s4.data(), k, n, transposed};
+      EXPECT_EQ(DequantizedMatMul(lhs, s4_rhs, m),
+                ReferenceMatMul(lhs, s4_values, m, k, n, transposed))
+          << "n=" << n << " transposed=" << transposed;
+
+      QuantizedMatrix u4_rhs{QuantizedType::kU4, u4.data(), k, n, transposed};
+      EXPECT_EQ(DequantizedMatMul(lhs, u4_rhs, m),
+                ReferenceMatMul(lhs, u4_values, m, k, n, transposed))
+          << "n=" << n << " transposed=" << transposed;
+
+      std::vector<float> dequantized(k * n);
+      Dequantize(s4_rhs, dequantized.data());
+      EXPECT_EQ(dequantized, s4_values);
+    }
+  }
+}
+
+TEST(PackedMatMulTest, DequantizedFloat8MatchesReference) {
+  int64_t m = 5, k = 9, n = 11;
+  std::vector<float> lhs = Iota(m * k, 0.5f);
+  std::vector<float> values = Iota(k * n, 0.25f);
+
+  std::vector<tsl::float8_e4m3fn> e4m3(values.begin(), values.end());
+  std::vector<tsl::float8_e5m2> e5m2(values.begin(), values.end());
+
+  QuantizedMatrix e4m3_rhs{QuantizedType::kF8E4M3FN, e4m3.data(), k, n};
+  EXPECT_EQ(DequantizedMatMul(lhs, e4m3_rhs, m),
+            ReferenceMatMul(lhs, values, m, k, n, false));
+
+  QuantizedMatrix e5m2_rhs{QuantizedType::kF8E5M2, e5m2.data(), k, n,
+                           /*transposed=*/true};
+  EXPECT_EQ(DequantizedMatMul(lhs, e5m2_rhs, m),
+            ReferenceMatMul(lhs, values, m, k, n, true));
+
+  std::vector<float> dequantized(k * n);
+  Dequantize(e5m2_rhs, dequantized.data());
+  EXPECT_EQ(dequantized, values);
+}
+
+}  // namespace
+}  // namespace xla::cpu
@@ -0,0 +1,446 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/rng_bit_generator_thunk.h"
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "absl/base/config.h"
+#include "absl/base/dynamic_annotations.h"
+#include "absl/base/optimization.h"
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "unsupported/Eigen/CXX11/Tensor"
+#include "xla/backends/cpu/runtime/concurrency.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/layout_util.h"
+#include "xla/primitive_util.h"
+#include "xla/runtime/buffer_use.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/util.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/profiler/lib/traceme.h"
+
+namespace xla::cpu {
+
+// Minimum number of output elements for generating random bits in parallel.
+static constexpr int64_t kMinParallelRngElements = 1 << 16;
+
+absl::StatusOr<std::unique_ptr<RngBitGeneratorThunk>>
+RngBitGeneratorThunk::Create(Info info, Algorithm algorithm, Buffer state,
+                             Buffer output_state, Buffer output) {
+  const Shape& state_shape = state.shape;
+  if (state_shape.element_type() != U64 || state_shape.rank() != 1) {
+    return InvalidArgument("RngBitGenerator state must be a u64 vector, got %s",
+                           state_shape.ToString());
+  }
+  int64_t state_size = state_shape.dimensions(0);
+  if ((algorithm == Algorithm::kPhilox && state_size != 2 &&
+       state_size != 3) ||
+      (algorithm == Algorithm::kThreeFry && state_size != 2)) {
+    return InvalidArgument("Unsupported RngBitGenerator state shape %s",
+                           state_shape.ToString());
+  }
+  if (!ShapeUtil::Compatible(state_shape, output_state.shape)) {
+    return InvalidArgument(
+        "RngBitGenerator state shape %s must be equal to output state shape "
+        "%s",
+        state_shape.ToString(), output_state.shape.ToString());
+  }
+
+  const Shape& shape = output.shape;
+  PrimitiveType type = shape.element_type();
+  if (!shape.IsArray() || type == PRED || primitive_util::IsComplexType(type)) {
+    return InvalidArgument("Unsupported RngBitGenerator output shape %s",
+                           shape.ToString());
+  }
+  int bit_width = primitive_util::BitWidth(type);
+  if (bit_width != 8 && bit_width != 16 && bit_width != 32 && bit_width != 64) {
+    return InvalidArgument("Unsupported RngBitGenerator output shape %s",
+                           shape.ToString());
+  }
+  if (shape.has_layout() &&
+      !LayoutUtil::IsMonotonicWithDim0Major(shape.layout())) {
+    return InvalidArgument(
+        "RngBitGenerator output %s must have a row-major layout",
+        shape.ToString(true));
+  }
+
+  return absl::WrapUnique(new RngBitGeneratorThunk(
+      std::move(info), algorithm, std::move(state), std::move(output_state),
+      std::move(output)));
+}
+
+RngBitGeneratorThunk::RngBitGeneratorThunk(Info info, Algorithm algorithm,
+                                           Buffer state, Buffer output_state,
+                                           Buffer output)
+    : Thunk(Kind::kRngBitGenerator, std::move(info)),
+      algorithm_(algorithm),
+      state_(std::move(state)),
+      output_state_(std::move(output_state)),
+      output_(std::move(output)) {}
+
+namespace {
+
+// Number of counters processed together by the generators below. The loops
+// over the lanes have no dependencies between lanes, so that the compiler
+// vectorizes them.
+constexpr int64_t kLanes = 8;
+
+// Computes Philox4x32 with 10 rounds, for `kLanes` consecutive 128-bit
+// counters starting at `counter` + `offset`. `counter` is represented as two
+// u64 with the lower 64 bits first, as in the expanded computation.
+void Philox4x32(uint64_t key, std::array<uint64_t, 2> counter, uint64_t offset,
+                uint32_t (&x)[4][kLanes]) {
+  // Constants specified by the Philox algorithm.
+  constexpr uint32_t kPhiloxW32A = 0x9E3779B9;
+  constexpr uint32_t kPhiloxW32B = 0xBB67AE85;
+  constexpr uint32_t kPhiloxM4x32A = 0xD2511F53;
+  constexpr uint32_t kPhiloxM4x32B = 0xCD9E8D57;
+
+  for (int64_t l = 0; l < kLanes; ++l) {
+    uint64_t low = counter[0] + offset + l;
+    uint64_t high = counter[1] + (low < counter[0] ? 1 : 0);
+    x[0][l] = static_cast<uint32_t>(low);
+    x[1][l] = static_cast<uint32_t>(low >> 32);
+    x[2][l] = static_cast<uint32_t>(high);
+    x[3][l] = static_cast<uint32_t>(high >> 32);
+  }
+
+  uint32_t key0 = static_cast<uint32_t>(key);
+  uint32_t key1 = static_cast<uint32_t>(key >> 32);
+  for (int round = 0; round < 10; ++round) {
+    for (int64_t l = 0; l < kLanes; ++l) {
+      uint64_t product0 = uint64_t{x[0][l]} * kPhiloxM4x32A;
+      uint64_t product1 = uint64_t{x[2][l]} * kPhiloxM4x32B;
+      uint32_t x1 = x[1][l];
+      uint32_t x3 = x[3][l];
+      x[0][l] = static_cast<uint32_t>(product1 >> 32) ^ x1 ^ key0;
+      x[1][l] = static_cast<uint32_t>(product1);
+      x[2][l] = static_cast<uint32_t>(product0 >> 32) ^ x3 ^ key1;
+      x[3][l] = static_cast<uint32_t>(product0);
+    }
+    key0 += kPhiloxW32A;
+    key1 += kPhiloxW32B;
+  }
+}
+
+// Computes ThreeFry2x32 with 20 rounds, for `kLanes` consecutive 64-bit
+// counters starting at `counter` + `offset`.
+void ThreeFry2x32(uint64_t key, uint64_t counter, uint64_t offset,
+                  uint32_t (&x)[2][kLanes]) {
+  // Rotation distances specified by the Threefry2x32 algorithm.
+  constexpr std::array<int, 8> kRotations = {13, 15, 26, 6, 17, 29, 16, 24};
+
+  std::array<uint32_t, 3> ks;
+  ks[0] = static_cast<uint32_t>(key);
+  ks[1] = static_cast<uint32_t>(key >> 32);
+  // 0x1BD11BDA is a parity constant specified by the ThreeFry2x32 algorithm.
+  ks[2] = 0x1BD11BDA ^ ks[0] ^ ks[1];
+
+  for (int64_t l = 0; l < kLanes; ++l) {
+    uint64_t input = counter + offset + l;
+    x[0][l] = static_cast<uint32_t>(input) + ks[0];
+    x[1][l] = static_cast<uint32_t>(input >> 32) + ks[1];
+  }
+
+  auto rounds = [&](int first_rotation) {
+    for (int r = first_rotation; r < first_rotation + 4; ++r) {
+      int rotation = kRotations[r];
+      for (int64_t l = 0; l < kLanes; ++l) {
+        x[0][l] += x[1][l];
+        x[1][l] = (x[1][l] << rotation) | (x[1][l] >> (32 - rotation));
+        x[1][l] ^= x[0][l];
+      }
+    }
+  };
+  auto inject = [&](int i) {
+    for (int64_t l = 0; l < kLanes; ++l) {
+      x[0][l] += ks[i % 3];
+      x[1][l] += ks[(i + 1) % 3] + i;
+    }
+  };
+
+  for (int i = 1; i <= 5; ++i) {
+    rounds(i % 2 == 1 ? 0 : 4);
+    inject(i);
+  }
+}
+
+// The output of ThreeFry with elements narrower than 64 bits viewed as a
+// row-major [outer, size, inner] array split along its middle dimension. Every
+// ThreeFry block produces the two elements at positions 2 * i and 2 * i + 1 of
+// the middle dimension, as in the expanded computation.
+struct ThreeFrySplit {
+  int64_t outer;
+  int64_t size;
+  int64_t inner;
+  int64_t half;
+};
+
+ThreeFrySplit GetThreeFrySplit(const Shape& shape) {
+  if (shape.rank() == 0) {
+    return ThreeFrySplit{1, 1, 1, 1};
+  }
+
+  // Split the first even dimension, or the first largest one if there is none.
+  int64_t split_dim = -1;
+  for (int64_t i = 0; i < shape.rank(); ++i) {
+    if (shape.dimensions(i) % 2 == 0) {
+      split_dim = i;
+      break;
+    }
+  }
+  if (split_dim == -1) {
+    split_dim = 0;
+    for (int64_t i = 1; i < shape.rank(); ++i) {
+      if (shape.dimensions(i) > shape.dimensions(split_dim)) {
+        split_dim = i;
+      }
+    }
+  }
+
+  ThreeFrySplit split{1, shape.dimensions(split_dim), 1, 0};
+  for (int64_t i = 0; i < split_dim; ++i) split.outer *= shape.dimensions(i);
+  for (int64_t i = split_dim + 1; i < shape.rank(); ++i) {
+    split.inner *= shape.dimensions(i);
+  }
+  split.half = CeilOfRatio<int64_t>(split.size, 2);
+  return split;
+}
+
+// Parameters of the generation of one RngBitGenerator output, split into
+// blocks that are generated independently.
+struct Generator {
+  RngBitGeneratorThunk::Algorithm algorithm;
+  uint64_t key;
+  std::array<uint64_t, 2> counter;
+  void* output;
+  int64_t num_elements;
+  int bit_width;
+  ThreeFrySplit split;
+
+  // Returns the number of independent blocks of the output.
+  int64_t NumBlocks() const;
+
+  // Generates blocks [begin, end) of the output.
+  void operator()(int64_t begin, int64_t end) const;
+
+  template <typename T>
+  void Philox(T* out, int64_t begin, int64_t end) const;
+
+  template <typename T>
+  void ThreeFry(T* out, int64_t begin, int64_t end) const;
+};
+
+int64_t Generator::NumBlocks() const {
+  if (algorithm == RngBitGeneratorThunk::Algorithm::kPhilox) {
+    // Philox generates 128 bits per counter.
+    return CeilOfRatio<int64_t>(num_elements, bit_width == 64 ? 2 : 4);
+  }
+  // ThreeFry generates 64 bits per counter, as one 64-bit element, or as two
+  // (possibly truncated) 32-bit elements.
+  return bit_width == 64 ? num_elements
+                         : split.outer * split.half * split.inner;
+}
+
+template <typename T>
+void Generator::Philox(T* out, int64_t begin, int64_t end) const {
+  uint32_t x[4][kLanes];
+  for (int64_t block = begin; block < end; block += kLanes) {
+    Philox4x32(key, counter, block, x);
+    int64_t lanes = std::min(kLanes, end - block);
+    for (int64_t l = 0; l < lanes; ++l) {
+      if constexpr (sizeof(T) == 8) {
+        // The two u64 of a block are consecutive elements.
+        int64_t i = 2 * (block + l);
+        out[i] = x[0][l] | (uint64_t{x[1][l]} << 32);
+        if (i + 1 < num_elements) {
+          out[i + 1] = x[2][l] | (uint64_t{x[3][l]} << 32);
+        }
+      } else {
+        // The four u32 of a block are consecutive elements, narrower elements
+        // keep their lower bits.
+        int64_t i = 4 * (block + l);
+        for (int64_t j = 0; j < 4 && i + j < num_elements; ++j) {
+          out[i + j] = static_cast<T>(x[j][l]);
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void Generator::ThreeFry(T* out, int64_t begin, int64_t end) const {
+  uint32_t x[2][kLanes];
+  for (int64_t block = begin; block < end; block += kLanes) {
+    ThreeFry2x32(key, counter[0], block, x);
+    int64_t lanes = std::min(kLanes, end - block);
+    for (int64_t l = 0; l < lanes; ++l) {
+      if constexpr (sizeof(T) == 8) {
+        out[block + l] = x[0][l] | (uint64_t{x[1][l]} << 32);
+      } else {
+        int64_t b = block + l;
+        int64_t inner = b % split.inner;
+        int64_t middle = (b / split.inner) % split.half;
+        int64_t outer = b / (split.inner * split.half);
+        int64_t i = (outer * split.size + 2 * middle) * split.inner + inner;
+        out[i] = static_cast<T>(x[0][l]);
+        if (2 * middle + 1 < split.size) {
+          out[i + split.inner] = static_cast<T>(x[1][l]);
+        }
+      }
+    }
+  }
+}
+
+void Generator::operator()(int64_t begin, int64_t end) const {
+  auto generate = [&](auto* out) {
+    if (algorithm == RngBitGeneratorThunk::Algorithm::kPhilox) {
+      Philox(out, begin, end);
+    } else {
+      ThreeFry(out, begin, end);
+    }
+  };
+  switch (bit_width) {
+    case 8:
+      return generate(static_cast<uint8_t*>(output));
+    case 16:
+      return generate(static_cast<uint16_t*>(output));
+    case 32:
+      return generate(static_cast<uint32_t*>(output));
+    case 64:
+      return generate(static_cast<uint64_t*>(output));
+    default:
+      LOG(FATAL) << "Unsupported RngBitGenerator bit width: " << bit_width;
+  }
+}
+
+}  // namespace
+
+tsl::AsyncValueRef<RngBitGeneratorThunk::ExecuteEvent>
+RngBitGeneratorThunk::Execute(const ExecuteParams& params) {
+  tsl::profiler::TraceMe trace([&] { return TraceMeEncode(); });
+
+  TF_ASSIGN_OR_RETURN(
+      se::DeviceMemoryBase state_data,
+      params.buffer_allocations->GetDeviceAddress(state_.slice));
+  TF_ASSIGN_OR_RETURN(
+      se::DeviceMemoryBase output_state_data,
+      params.buffer_allocations->GetDeviceAddress(output_state_.slice));
+  TF_ASSIGN_OR_RETURN(
+      se::DeviceMemoryBase output_data,
+      params.buffer_allocations->GetDeviceAddress(output_.slice));
+
+  int64_t state_size = state_.shape.dimensions(0);
+  if (state_data.size() != state_size * sizeof(uint64_t) ||
+      output_state_data.size() != state_data.size()) {
+    return InvalidArgument("Invalid state buffer size: %d", state_data.size());
+  }
+  int64_t num_elements = ShapeUtil::ElementsIn(output_.shape);
+  int bit_width = primitive_util::BitWidth(output_.shape.element_type());
+  if (output_data.size() != num_elements * (bit_width / 8)) {
+    return InvalidArgument("Invalid output buffer size: %d",
+                           output_data.size());
+  }
+
+  // Annotate memory that might have been initialized by jit-compiled code.
+  ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(state_data.opaque(), state_data.size());
+
+  VLOG(3) << absl::StreamFormat(
+      "RngBitGenerator %s (%s) from state %s (%p) to slice %s (%p)",
+      output_.shape.ToString(true),
+      algorithm_ == Algorithm::kPhilox ? "philox" : "three-fry",
+      state_.slice.ToString(), state_data.opaque(), output_.slice.ToString(),
+      output_data.opaque());
+
+  // Read the state before writing the updated one, as the buffers might alias.
+  static_assert(ABSL_IS_LITTLE_ENDIAN, "Big endian not supported");
+  std::array<uint64_t, 3> state = {0, 0, 0};
+  std::memcpy(state.data(), state_data.opaque(), state_data.size());
+
+  Generator generator;
+  generator.algorithm = algorithm_;
+  generator.key = state[0];
+  // The 128-bit Philox counter of a 2-element state is the reversed state, and
+  // only its lower half is written back, as in the expanded computation.
+  generator.counter = state_size == 3
+                          ? std::array<uint64_t, 2>{state[1], state[2]}
+                          : std::array<uint64_t, 2>{state[1], state[0]};
+  generator.output = output_data.opaque();
+  generator.num_elements = num_elements;
+  generator.bit_width = bit_width;
+  if (algorithm_ == Algorithm::kThreeFry && bit_width != 64) {
+    generator.split = GetThreeFrySplit(output_.shape);
+  }
+
+  int64_t num_blocks = generator.NumBlocks();
+  uint64_t counter_low = generator.counter[0] + num_blocks;
+  uint64_t counter_high =
+      generator.counter[1] + (counter_low < generator.counter[0] ? 1 : 0);
+  std::array<uint64_t, 3> output_state = {state[0], counter_low, counter_high};
+  std::memcpy(output_state_data.opaque(), output_state.data(),
+              output_state_data.size());
+
+  int64_t num_threads = params.intra_op_threadpool
+                            ? params.intra_op_threadpool->numThreadsInPool()
+                            : 1;
+  if (ABSL_PREDICT_TRUE(params.intra_op_threadpool == nullptr ||
+                        num_elements < kMinParallelRngElements ||
+                        num_threads <= 1)) {
+    generator(0, num_blocks);
+    return OkExecuteEvent();
+  }
+
+  // Every task generates a range of blocks, which start at multiples of the
+  // number of lanes to keep the vectorized loops full.
+  int64_t blocks_per_task =
+      RoundUpTo(CeilOfRatio(num_blocks, num_threads), kLanes);
+  int64_t num_tasks = CeilOfRatio(num_blocks, blocks_per_task);
+
+  auto event = tsl::MakeConstructedAsyncValueRef<ExecuteEvent>();
+  auto pending = std::make_shared<std::atomic<int64_t>>(num_tasks);
+
+  ScheduleAll(params.intra_op_threadpool, num_tasks, [=](int64_t task_index) {
+    int64_t begin = task_index * blocks_per_task;
+    generator(begin, std::min(num_blocks, begin + blocks_per_task));
+    if (pending->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      event.SetStateConcrete();
+    }
+  });
+
+  return event;
+}
+
+RngBitGeneratorThunk::BufferUses RngBitGeneratorThunk::buffer_uses() const {
+  return {BufferUse::Read(state_.slice), BufferUse::Write(output_state_.slice),
+          BufferUse::Write(output_.slice)};
+}
+
+}  // namespace xla::cpu
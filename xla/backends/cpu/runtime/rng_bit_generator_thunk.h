@@ -0,0 +1,68 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_BACKENDS_CPU_RUNTIME_RNG_BIT_GENERATOR_THUNK_H_
+#define XLA_BACKENDS_CPU_RUNTIME_RNG_BIT_GENERATOR_THUNK_H_
+
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/shape.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+
+namespace xla::cpu {
+
+// Generates random bits for RngBitGenerator instructions matched by
+// `PotentiallyImplementedAsRngBitGeneratorThunk`, instead of running the
+// counter-based generators lowered to HLO by RngBitGeneratorExpander. The
+// generated bits and the updated state are identical to the ones of the
+// expanded computation.
+//
+// Philox4x32 and ThreeFry2x32 are counter-based: every block of output bits is
+// a function of the key and of the initial counter offset by the block index,
+// so blocks are generated in batches that the compiler vectorizes, and if the
+// intra-op thread pool is available large outputs are generated in parallel.
+class RngBitGeneratorThunk final : public Thunk {
+ public:
+  enum class Algorithm { kPhilox, kThreeFry };
+
+  struct Buffer {
+    BufferAllocation::Slice slice;
+    Shape shape;
+  };
+
+  static absl::StatusOr<std::unique_ptr<RngBitGeneratorThunk>> Create(
+      Info info, Algorithm algorithm, Buffer state, Buffer output_state,
+      Buffer output);
+
+  tsl::AsyncValueRef<ExecuteEvent> Execute(const ExecuteParams& params) final;
+
+  BufferUses buffer_uses() const final;
+
+ private:
+  RngBitGeneratorThunk(Info info, Algorithm algorithm, Buffer state,
+                       Buffer output_state, Buffer output);
+
+  Algorithm algorithm_;
+  Buffer state_;
+  Buffer output_state_;
+  Buffer output_;
+};
+
+}  // namespace xla::cpu
+
+#endif  // XLA_BACKENDS_CPU_RUNTIME_RNG_BIT_GENERATOR_THUNK_H_
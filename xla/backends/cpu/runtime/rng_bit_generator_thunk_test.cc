@@ -0,0 +1,153 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/rng_bit_generator_thunk.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xla/backends/cpu/runtime/buffer_allocations.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/primitive_util.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/service/maybe_owning_device_memory.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+#define EIGEN_USE_THREADS
+
+#include "unsupported/Eigen/CXX11/Tensor"
+
+namespace xla::cpu {
+namespace {
+
+using Algorithm = RngBitGeneratorThunk::Algorithm;
+
+// Runs a rng bit generator thunk that updates `state` in place and writes
+// random bits of the given dimensions into `output`.
+template <typename T>
+absl::Status RunRngBitGenerator(
+    Algorithm algorithm, std::vector<uint64_t>& state, std::vector<T>& output,
+    absl::Span<const int64_t> dimensions,
+    const Eigen::ThreadPoolDevice* device = nullptr) {
+  std::vector<MaybeOwningDeviceMemory> buffers;
+  buffers.emplace_back(se::DeviceMemoryBase(
+      state.data(), state.size() * sizeof(uint64_t)));
+  buffers.emplace_back(
+      se::DeviceMemoryBase(output.data(), output.size() * sizeof(T)));
+  BufferAllocations allocations(buffers);
+
+  BufferAllocation alloc0(0, buffers[0].AsDeviceMemoryBase().size(), 0);
+  BufferAllocation alloc1(1, buffers[1].AsDeviceMemoryBase().size(), 0);
+
+  BufferAllocation::Slice state_slice(&alloc0, 0, alloc0.size());
+  BufferAllocation::Slice output_slice(&alloc1, 0, alloc1.size());
+
+  Shape state_shape =
+      ShapeUtil::MakeShape(U64, {static_cast<int64_t>(state.size())});
+  Shape shape = ShapeUtil::MakeShape(
+      primitive_util::NativeToPrimitiveType<T>(), dimensions);
+
+  TF_ASSIGN_OR_RETURN(
+      auto thunk, RngBitGeneratorThunk::Create(
+                      {"rng-bit-generator"}, algorithm,
+                      {state_slice, state_shape}, {state_slice, state_shape},
+                      {output_slice, shape}));
+
+  Thunk::ExecuteParams params;
+  params.buffer_allocations = &allocations;
+  params.intra_op_threadpool = device;
+
+  auto execute_event = thunk->Execute(params);
+  tsl::BlockUntilReady(execute_event);
+  if (execute_event.IsError()) return execute_event.GetError();
+  return absl::OkStatus();
+}
+
+TEST(RngBitGeneratorThunkTest, Philox) {
+  // Known answer of Philox4x32 with 10 rounds for a zero key and counter.
+  std::vector<uint64_t> state = {0, 0, 0};
+  std::vector<uint32_t> output(4);
+
+  TF_ASSERT_OK(RunRngBitGenerator(Algorithm::kPhilox, state, output, {4}));
+  EXPECT_EQ(output, (std::vector<uint32_t>{0x6627e8d5, 0xe169c58d, 0xbc57ac4c,
+                                           0x9b00dbd8}));
+  EXPECT_EQ(state, (std::vector<uint64_t>{0, 1, 0}));
+}
+
+TEST(RngBitGeneratorThunkTest, Philox64) {
+  std::vector<uint64_t> state = {0, 0, 0};
+  std::vector<uint64_t> output(3);
+
+  TF_ASSERT_OK(RunRngBitGenerator(Algorithm::kPhilox, state, output, {3}));
+  EXPECT_EQ(output[0], 0xe169c58d6627e8d5);
+  EXPECT_EQ(output[1], 0x9b00dbd8bc57ac4c);
+  EXPECT_EQ(state, (std::vector<uint64_t>{0, 2, 0}));
+}
+
+TEST(RngBitGeneratorThunkTest, ThreeFry) {
+  // Known answer of ThreeFry2x32 with 20 rounds for a zero key and counter.
+  std::vector<uint64_t> state = {0, 0};
+  std::vector<uint32_t> output(2);
+
+  TF_ASSERT_OK(RunRngBitGenerator(Algorithm::kThreeFry, state, output, {2}));
+  EXPECT_EQ(output, (std::vector<uint32_t>{0x6b200159, 0x99ba4efe}));
+  EXPECT_EQ(state, (std::vector<uint64_t>{0, 1}));
+}
+
+TEST(RngBitGeneratorThunkTest, ParallelMatchesSerial) {
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "rng-test", 8);
+  Eigen::ThreadPoolDevice device(thread_pool.AsEigenThreadPool(),
+                                 thread_pool.NumThreads());
+
+  for (Algorithm algorithm : {Algorithm::kPhilox, Algorithm::kThreeFry}) {
+    std::vector<uint64_t> serial_state = {42, 7};
+    std::vector<uint64_t> parallel_state = serial_state;
+
+    int64_t d0 = 3, d1 = 257, d2 = 129;
+    std::vector<uint16_t> serial(d0 * d1 * d2);
+    std::vector<uint16_t> parallel(serial.size());
+
+    TF_ASSERT_OK(
+        RunRngBitGenerator(algorithm, serial_state, serial, {d0, d1, d2}));
+    TF_ASSERT_OK(RunRngBitGenerator(algorithm, parallel_state, parallel,
+                                    {d0, d1, d2}, &device));
+    EXPECT_EQ(serial, parallel);
+    EXPECT_EQ(serial_state, parallel_state);
+  }
+}
+
+TEST(RngBitGeneratorThunkTest, RejectsInvalidState) {
+  BufferAllocation alloc(0, 1024, 0);
+  BufferAllocation::Slice slice(&alloc, 0, alloc.size());
+
+  Shape state_shape = ShapeUtil::MakeShape(U64, {3});
+  auto thunk = RngBitGeneratorThunk::Create(
+      {"rng-bit-generator"}, Algorithm::kThreeFry, {slice, state_shape},
+      {slice, state_shape}, {slice, ShapeUtil::MakeShape(U32, {4})});
+  EXPECT_FALSE(thunk.ok());
+}
+
+}  // namespace
+}  // namespace xla::cpu
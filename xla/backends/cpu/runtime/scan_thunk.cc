@@ -0,0 +1,290 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/scan_thunk.h"
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/base/dynamic_annotations.h"
+#include "absl/base/optimization.h"
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "unsupported/Eigen/CXX11/Tensor"
+#include "xla/backends/cpu/runtime/concurrency.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/layout_util.h"
+#include "xla/primitive_util.h"
+#include "xla/runtime/buffer_use.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/util.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/profiler/lib/traceme.h"
+
+namespace xla::cpu {
+
+// Minimum number of elements for running scan in parallel.
+static constexpr int64_t kMinParallelScanElements = 1 << 15;
+
+absl::StatusOr<std::unique_ptr<ScanThunk>> ScanThunk::Create(
+    Info info, Buffer input, Buffer output, int64_t dimension, bool reverse,
+    Combiner combiner) {
+  if (!ShapeUtil::Equal(input.shape, output.shape)) {
+    return InvalidArgument(
+        "Scan input shape %s must be equal to output shape %s",
+        input.shape.ToString(true), output.shape.ToString(true));
+  }
+  if (dimension < 0 || dimension >= input.shape.rank()) {
+    return InvalidArgument("Scan dimension %d is out of range of shape %s",
+                           dimension, input.shape.ToString());
+  }
+  PrimitiveType type = input.shape.element_type();
+  if (type != F32 && type != F64 && type != S32 && type != S64) {
+    return InvalidArgument("Unsupported scan element type: %s",
+                           input.shape.ToString());
+  }
+  if (input.shape.has_layout() &&
+      !LayoutUtil::IsMonotonicWithDim0Major(input.shape.layout())) {
+    return InvalidArgument("Scan buffer %s must have a row-major layout",
+                           input.shape.ToString(true));
+  }
+
+  return absl::WrapUnique(new ScanThunk(std::move(info), std::move(input),
+                                        std::move(output), dimension, reverse,
+                                        combiner));
+}
+
+ScanThunk::ScanThunk(Info info, Buffer input, Buffer output, int64_t dimension,
+                     bool reverse, Combiner combiner)
+    : Thunk(Kind::kScan, std::move(info)),
+      input_(std::move(input)),
+      output_(std::move(output)),
+      dimension_(dimension),
+      reverse_(reverse),
+      combiner_(combiner) {}
+
+namespace {
+
+// The scanned buffer viewed as a row-major [outer, length, inner] array.
+struct ScanDims {
+  int64_t outer;
+  int64_t length;
+  int64_t inner;
+};
+
+// Minimum and maximum propagating NaNs, as HLO minimum and maximum do.
+template <typename T>
+T Min(T a, T b) {
+  if constexpr (std::is_floating_point_v<T>) {
+    if (std::isnan(a)) return a;
+  }
+  return a <= b ? a : b;
+}
+
+template <typename T>
+T Max(T a, T b) {
+  if constexpr (std::is_floating_point_v<T>) {
+    if (std::isnan(a)) return a;
+  }
+  return a >= b ? a : b;
+}
+
+}  // namespace
+
+// Scans columns [begin, end) of the [length, inner] block of `outer` index.
+template <typename T, typename Combine>
+static void ScanBlock(const T* input, T* output, const ScanDims& dims,
+                      int64_t outer, int64_t begin, int64_t end, bool reverse,
+                      Combine combine) {
+  if (dims.length == 0) return;
+
+  input += outer * dims.length * dims.inner;
+  output += outer * dims.length * dims.inner;
+
+  // Offset of the i-th row of the block in the order of the scan.
+  auto row = [&](int64_t i) {
+    return (reverse ? dims.length - 1 - i : i) * dims.inner;
+  };
+
+  // Scans of the minor dimension accumulate in a register.
+  if (dims.inner == 1) {
+    T acc = input[row(0)];
+    output[row(0)] = acc;
+    for (int64_t i = 1; i < dims.length; ++i) {
+      acc = combine(acc, input[row(i)]);
+      output[row(i)] = acc;
+    }
+    return;
+  }
+
+  std::copy(input + row(0) + begin, input + row(0) + end,
+            output + row(0) + begin);
+  for (int64_t i = 1; i < dims.length; ++i) {
+    const T* prev = output + row(i - 1);
+    const T* in = input + row(i);
+    T* out = output + row(i);
+    for (int64_t j = begin; j < end; ++j) {
+      out[j] = combine(prev[j], in[j]);
+    }
+  }
+}
+
+template <typename T>
+static void ScanBlock(ScanThunk::Combiner combiner, const void* input,
+                      void* output, const ScanDims& dims, int64_t outer,
+                      int64_t begin, int64_t end, bool reverse) {
+  const T* in = static_cast<const T*>(input);
+  T* out = static_cast<T*>(output);
+  switch (combiner) {
+    case ScanThunk::Combiner::kAdd:
+      return ScanBlock(in, out, dims, outer, begin, end, reverse,
+                       [](T a, T b) { return a + b; });
+    case ScanThunk::Combiner::kMul:
+      return ScanBlock(in, out, dims, outer, begin, end, reverse,
+                       [](T a, T b) { return a * b; });
+    case ScanThunk::Combiner::kMin:
+      return ScanBlock(in, out, dims, outer, begin, end, reverse, Min<T>);
+    case ScanThunk::Combiner::kMax:
+      return ScanBlock(in, out, dims, outer, begin, end, reverse, Max<T>);
+  }
+}
+
+static void ScanBlock(PrimitiveType type, ScanThunk::Combiner combiner,
+                      const void* input, void* output, const ScanDims& dims,
+                      int64_t outer, int64_t begin, int64_t end,
+                      bool reverse) {
+  switch (type) {
+    case F32:
+      return ScanBlock<float>(combiner, input, output, dims, outer, begin,
+                              end, reverse);
+    case F64:
+      return ScanBlock<double>(combiner, input, output, dims, outer, begin,
+                               end, reverse);
+    case S32:
+      return ScanBlock<int32_t>(combiner, input, output, dims, outer, begin,
+                                end, reverse);
+    case S64:
+      return ScanBlock<int64_t>(combiner, input, output, dims, outer, begin,
+                                end, reverse);
+    default:
+      LOG(FATAL) << "Unsupported scan element type: "
+                 << primitive_util::LowercasePrimitiveTypeName(type);
+  }
+}
+
+tsl::AsyncValueRef<ScanThunk::ExecuteEvent> ScanThunk::Execute(
+    const ExecuteParams& params) {
+  tsl::profiler::TraceMe trace([&] { return TraceMeEncode(); });
+
+  TF_ASSIGN_OR_RETURN(
+      se::DeviceMemoryBase input_data,
+      params.buffer_allocations->GetDeviceAddress(input_.slice));
+  TF_ASSIGN_OR_RETURN(
+      se::DeviceMemoryBase output_data,
+      params.buffer_allocations->GetDeviceAddress(output_.slice));
+
+  // Annotate memory that might have been initialized by jit-compiled code.
+  ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(input_data.opaque(), input_data.size());
+
+  VLOG(3) << absl::StreamFormat(
+      "Scan %s along dimension %d (reverse=%v) from slice %s (%p) to slice "
+      "%s (%p)",
+      input_.shape.ToString(true), dimension_, reverse_,
+      input_.slice.ToString(), input_data.opaque(), output_.slice.ToString(),
+      output_data.opaque());
+
+  absl::Span<const int64_t> dimensions = input_.shape.dimensions();
+  ScanDims dims{
+      absl::c_accumulate(dimensions.first(dimension_), int64_t{1},
+                         std::multiplies<int64_t>()),
+      dimensions[dimension_],
+      absl::c_accumulate(dimensions.subspan(dimension_ + 1), int64_t{1},
+                         std::multiplies<int64_t>())};
+
+  PrimitiveType type = input_.shape.element_type();
+  const void* input = input_data.opaque();
+  void* output = output_data.opaque();
+
+  // Every task scans a range of blocks of `inner_block` columns. Split the
+  // columns only if there are not enough rows to keep all threads busy.
+  int64_t num_threads = params.intra_op_threadpool
+                            ? params.intra_op_threadpool->numThreadsInPool()
+                            : 1;
+  int64_t inner_blocks = 1;
+  if (dims.inner > 1 && dims.outer < num_threads) {
+    inner_blocks = std::min(dims.inner, CeilOfRatio(num_threads, dims.outer));
+  }
+  int64_t inner_block =
+      std::max<int64_t>(1, CeilOfRatio(dims.inner, inner_blocks));
+  inner_blocks = CeilOfRatio(dims.inner, inner_block);
+  int64_t num_units = dims.outer * inner_blocks;
+
+  auto scan_units = [=, combiner = combiner_, reverse = reverse_](
+                        int64_t unit_begin, int64_t unit_end) {
+    for (int64_t unit = unit_begin; unit < unit_end; ++unit) {
+      int64_t begin = (unit % inner_blocks) * inner_block;
+      int64_t end = std::min(dims.inner, begin + inner_block);
+      ScanBlock(type, combiner, input, output, dims, unit / inner_blocks,
+                begin, end, reverse);
+    }
+  };
+
+  int64_t num_elements = dims.outer * dims.length * dims.inner;
+  if (ABSL_PREDICT_TRUE(params.intra_op_threadpool == nullptr ||
+                        num_elements < kMinParallelScanElements ||
+                        num_units <= 1)) {
+    scan_units(0, num_units);
+    return OkExecuteEvent();
+  }
+
+  int64_t num_tasks = std::min(num_units, num_threads);
+  int64_t units_per_task = CeilOfRatio(num_units, num_tasks);
+  num_tasks = CeilOfRatio(num_units, units_per_task);
+
+  auto event = tsl::MakeConstructedAsyncValueRef<ExecuteEvent>();
+  auto pending = std::make_shared<std::atomic<int64_t>>(num_tasks);
+
+  ScheduleAll(params.intra_op_threadpool, num_tasks, [=](int64_t task_index) {
+    int64_t unit_begin = task_index * units_per_task;
+    scan_units(unit_begin, std::min(num_units, unit_begin + units_per_task));
+    if (pending->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      event.SetStateConcrete();
+    }
+  });
+
+  return event;
+}
+
+ScanThunk::BufferUses ScanThunk::buffer_uses() const {
+  return {BufferUse::Read(input_.slice), BufferUse::Write(output_.slice)};
+}
+
+}  // namespace xla::cpu
@@ -0,0 +1,69 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_BACKENDS_CPU_RUNTIME_SCAN_THUNK_H_
+#define XLA_BACKENDS_CPU_RUNTIME_SCAN_THUNK_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/shape.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+
+namespace xla::cpu {
+
+// Computes an inclusive scan (e.g. a cumulative sum) of the input buffer along
+// the given dimension, and writes it to the output buffer. Implements reduce
+// windows matched by `PotentiallyImplementedAsScanThunk` with O(n) work,
+// instead of reducing a whole window for every output element.
+//
+// Scans of different rows are independent, and if the intra-op thread pool is
+// available they run in parallel. Scans over the minor dimension run one row
+// at a time, otherwise all rows at the same position along the scanned
+// dimension are combined with a single contiguous loop.
+class ScanThunk final : public Thunk {
+ public:
+  enum class Combiner { kAdd, kMul, kMin, kMax };
+
+  struct Buffer {
+    BufferAllocation::Slice slice;
+    Shape shape;
+  };
+
+  static absl::StatusOr<std::unique_ptr<ScanThunk>> Create(
+      Info info, Buffer input, Buffer output, int64_t dimension, bool reverse,
+      Combiner combiner);
+
+  tsl::AsyncValueRef<ExecuteEvent> Execute(const ExecuteParams& params) final;
+
+  BufferUses buffer_uses() const final;
+
+ private:
+  ScanThunk(Info info, Buffer input, Buffer output, int64_t dimension,
+            bool reverse, Combiner combiner);
+
+  Buffer input_;
+  Buffer output_;
+  int64_t dimension_;
+  bool reverse_;
+  Combiner combiner_;
+};
+
+}  // namespace xla::cpu
+
+#endif  // XLA_BACKENDS_CPU_RUNTIME_SCAN_THUNK_H_
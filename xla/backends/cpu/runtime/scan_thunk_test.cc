@@ -0,0 +1,161 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/scan_thunk.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xla/backends/cpu/runtime/buffer_allocations.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/primitive_util.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/service/maybe_owning_device_memory.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+#define EIGEN_USE_THREADS
+
+#include "unsupported/Eigen/CXX11/Tensor"
+
+namespace xla::cpu {
+namespace {
+
+// Runs a scan thunk over `input` with the given dimensions.
+template <typename T>
+absl::Status RunScan(std::vector<T>& input, std::vector<T>& output,
+                     absl::Span<const int64_t> dimensions, int64_t dimension,
+                     bool reverse, ScanThunk::Combiner combiner,
+                     const Eigen::ThreadPoolDevice* device = nullptr) {
+  std::vector<MaybeOwningDeviceMemory> buffers;
+  buffers.emplace_back(
+      se::DeviceMemoryBase(input.data(), input.size() * sizeof(T)));
+  buffers.emplace_back(
+      se::DeviceMemoryBase(output.data(), output.size() * sizeof(T)));
+  BufferAllocations allocations(buffers);
+
+  BufferAllocation alloc0(0, buffers[0].AsDeviceMemoryBase().size(), 0);
+  BufferAllocation alloc1(1, buffers[1].AsDeviceMemoryBase().size(), 0);
+
+  BufferAllocation::Slice input_slice(&alloc0, 0, alloc0.size());
+  BufferAllocation::Slice output_slice(&alloc1, 0, alloc1.size());
+
+  Shape shape = ShapeUtil::MakeShape(
+      primitive_util::NativeToPrimitiveType<T>(), dimensions);
+
+  TF_ASSIGN_OR_RETURN(
+      auto thunk,
+      ScanThunk::Create({"scan"}, {input_slice, shape}, {output_slice, shape},
+                        dimension, reverse, combiner));
+
+  Thunk::ExecuteParams params;
+  params.buffer_allocations = &allocations;
+  params.intra_op_threadpool = device;
+
+  auto execute_event = thunk->Execute(params);
+  tsl::BlockUntilReady(execute_event);
+  if (execute_event.IsError()) return execute_event.GetError();
+  return absl::OkStatus();
+}
+
+TEST(ScanThunkTest, CumSum) {
+  std::vector<float> input = {1, 2, 3, 4, 5};
+  std::vector<float> output(5);
+
+  TF_ASSERT_OK(RunScan(input, output, {5}, /*dimension=*/0, /*reverse=*/false,
+                       ScanThunk::Combiner::kAdd));
+  EXPECT_EQ(output, (std::vector<float>{1, 3, 6, 10, 15}));
+
+  TF_ASSERT_OK(RunScan(input, output, {5}, /*dimension=*/0, /*reverse=*/true,
+                       ScanThunk::Combiner::kAdd));
+  EXPECT_EQ(output, (std::vector<float>{15, 14, 12, 9, 5}));
+}
+
+TEST(ScanThunkTest, CumProdMajorAndMinorDimension) {
+  std::vector<int32_t> input = {1, 2, 3, 4, 5, 6};
+  std::vector<int32_t> output(6);
+
+  TF_ASSERT_OK(RunScan(input, output, {2, 3}, /*dimension=*/0,
+                       /*reverse=*/false, ScanThunk::Combiner::kMul));
+  EXPECT_EQ(output, (std::vector<int32_t>{1, 2, 3, 4, 10, 18}));
+
+  TF_ASSERT_OK(RunScan(input, output, {2, 3}, /*dimension=*/1,
+                       /*reverse=*/false, ScanThunk::Combiner::kMul));
+  EXPECT_EQ(output, (std::vector<int32_t>{1, 2, 6, 4, 20, 120}));
+}
+
+TEST(ScanThunkTest, CumMaxPropagatesNaN) {
+  float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> input = {1, 3, nan, 5};
+  std::vector<float> output(4);
+
+  TF_ASSERT_OK(RunScan(input, output, {4}, /*dimension=*/0, /*reverse=*/false,
+                       ScanThunk::Combiner::kMax));
+  EXPECT_EQ(output[0], 1);
+  EXPECT_EQ(output[1], 3);
+  EXPECT_TRUE(std::isnan(output[2]));
+  EXPECT_TRUE(std::isnan(output[3]));
+}
+
+TEST(ScanThunkTest, ParallelCumMin) {
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "scan-test", 8);
+  Eigen::ThreadPoolDevice device(thread_pool.AsEigenThreadPool(),
+                                 thread_pool.NumThreads());
+
+  int64_t d0 = 3, d1 = 128, d2 = 200;
+  std::vector<int64_t> input(d0 * d1 * d2);
+  for (int64_t i = 0; i < input.size(); ++i) input[i] = (i * 7919) % 1009;
+
+  std::vector<int64_t> expected = input;
+  for (int64_t i = 0; i < d0; ++i) {
+    for (int64_t j = d1 - 2; j >= 0; --j) {
+      for (int64_t k = 0; k < d2; ++k) {
+        int64_t& e = expected[(i * d1 + j) * d2 + k];
+        e = std::min(e, expected[(i * d1 + j + 1) * d2 + k]);
+      }
+    }
+  }
+
+  std::vector<int64_t> output(input.size());
+  TF_ASSERT_OK(RunScan(input, output, {d0, d1, d2}, /*dimension=*/1,
+                       /*reverse=*/true, ScanThunk::Combiner::kMin, &device));
+  EXPECT_EQ(output, expected);
+}
+
+TEST(ScanThunkTest, RejectsMismatchedShapes) {
+  BufferAllocation alloc(0, 1024, 0);
+  BufferAllocation::Slice slice(&alloc, 0, alloc.size());
+
+  auto thunk = ScanThunk::Create(
+      {"scan"}, {slice, ShapeUtil::MakeShape(F32, {4})},
+      {slice, ShapeUtil::MakeShape(F32, {8})}, /*dimension=*/0,
+      /*reverse=*/false, ScanThunk::Combiner::kAdd);
+  EXPECT_FALSE(thunk.ok());
+}
+
+}  // namespace
+}  // namespace xla::cpu
@@ -0,0 +1,304 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/scatter_thunk.h"
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "absl/base/dynamic_annotations.h"
+#include "absl/base/optimization.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "unsupported/Eigen/CXX11/Tensor"
+#include "xla/backends/cpu/runtime/concurrency.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/layout_util.h"
+#include "xla/primitive_util.h"
+#include "xla/runtime/buffer_use.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/util.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/profiler/lib/traceme.h"
+
+namespace xla::cpu {
+
+// Minimum number of updated elements for running scatter in parallel.
+static constexpr int64_t kMinParallelScatterElements = 1 << 15;
+
+static bool IsSupportedElementType(PrimitiveType type) {
+  return type == F32 || type == F64 || type == S32 || type == S64;
+}
+
+absl::StatusOr<std::unique_ptr<ScatterThunk>> ScatterThunk::Create(
+    Info info, Buffer operand, Buffer indices, Buffer updates, Buffer output,
+    Combiner combiner) {
+  if (!ShapeUtil::Equal(operand.shape, output.shape)) {
+    return InvalidArgument(
+        "Scatter operand shape %s must be equal to output shape %s",
+        operand.shape.ToString(true), output.shape.ToString(true));
+  }
+  if (operand.shape.rank() == 0) {
+    return InvalidArgument("Scatter operand must not be a scalar");
+  }
+  if (!IsSupportedElementType(operand.shape.element_type()) ||
+      updates.shape.element_type() != operand.shape.element_type()) {
+    return InvalidArgument("Unsupported scatter element types: %s and %s",
+                           operand.shape.ToString(), updates.shape.ToString());
+  }
+  if (indices.shape.element_type() != S32 &&
+      indices.shape.element_type() != S64) {
+    return InvalidArgument("Unsupported scatter indices type: %s",
+                           indices.shape.ToString());
+  }
+
+  for (const Shape* shape : {&operand.shape, &indices.shape, &updates.shape}) {
+    if (shape->has_layout() &&
+        !LayoutUtil::IsMonotonicWithDim0Major(shape->layout())) {
+      return InvalidArgument("Scatter buffer %s must have a row-major layout",
+                             shape->ToString(true));
+    }
+  }
+
+  int64_t row_size = ShapeUtil::ElementsIn(operand.shape) /
+                     std::max<int64_t>(1, operand.shape.dimensions(0));
+  int64_t num_indices = ShapeUtil::ElementsIn(indices.shape);
+  if (ShapeUtil::ElementsIn(updates.shape) != num_indices * row_size) {
+    return InvalidArgument(
+        "Scatter updates %s must have one row of operand %s for each of the "
+        "%d indices",
+        updates.shape.ToString(), operand.shape.ToString(), num_indices);
+  }
+
+  return absl::WrapUnique(new ScatterThunk(std::move(info), std::move(operand),
+                                           std::move(indices),
+                                           std::move(updates),
+                                           std::move(output), combiner));
+}
+
+ScatterThunk::ScatterThunk(Info info, Buffer operand, Buffer indices,
+                           Buffer updates, Buffer output, Combiner combiner)
+    : Thunk(Kind::kScatter, std::move(info)),
+      operand_(std::move(operand)),
+      indices_(std::move(indices)),
+      updates_(std::move(updates)),
+      output_(std::move(output)),
+      combiner_(combiner) {}
+
+namespace {
+
+// Pointers to the scatter buffers and the scatter dimensions.
+struct ScatterArgs {
+  void* output;
+  const void* indices;
+  const void* updates;
+  int64_t num_indices;
+  int64_t row_size;
+};
+
+// Minimum and maximum propagating NaNs, as HLO minimum and maximum do.
+template <typename T>
+T Min(T a, T b) {
+  if constexpr (std::is_floating_point_v<T>) {
+    if (std::isnan(a)) return a;
+  }
+  return a <= b ? a : b;
+}
+
+template <typename T>
+T Max(T a, T b) {
+  if constexpr (std::is_floating_point_v<T>) {
+    if (std::isnan(a)) return a;
+  }
+  return a >= b ? a : b;
+}
+
+// Addition wrapping around on overflow, as HLO add does for integers. Signed
+// overflow is undefined behavior in C++, so integers are added as unsigned.
+template <typename T>
+T Add(T a, T b) {
+  if constexpr (std::is_integral_v<T>) {
+    using U = std::make_unsigned_t<T>;
+    return static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+  } else {
+    return a + b;
+  }
+}
+
+}  // namespace
+
+// Applies updates to the output rows in the [begin, end) range.
+template <typename T, typename Index, typename Combine>
+static void ScatterRows(const ScatterArgs& args, int64_t begin, int64_t end,
+                        Combine combine) {
+  T* output = static_cast<T*>(args.output);
+  const Index* indices = static_cast<const Index*>(args.indices);
+  const T* updates = static_cast<const T*>(args.updates);
+
+  for (int64_t i = 0; i < args.num_indices; ++i) {
+    int64_t row = indices[i];
+    if (row < begin || row >= end) continue;
+
+    T* dst = output + row * args.row_size;
+    const T* src = updates + i * args.row_size;
+    for (int64_t j = 0; j < args.row_size; ++j) {
+      dst[j] = combine(dst[j], src[j]);
+    }
+  }
+}
+
+template <typename T, typename Index>
+static void ScatterRows(ScatterThunk::Combiner combiner,
+                        const ScatterArgs& args, int64_t begin, int64_t end) {
+  switch (combiner) {
+    case ScatterThunk::Combiner::kAssign:
+      return ScatterRows<T, Index>(args, begin, end, [](T, T u) { return u; });
+    case ScatterThunk::Combiner::kAdd:
+      return ScatterRows<T, Index>(args, begin, end, Add<T>);
+    case ScatterThunk::Combiner::kMin:
+      return ScatterRows<T, Index>(args, begin, end, Min<T>);
+    case ScatterThunk::Combiner::kMax:
+      return ScatterRows<T, Index>(args, begin, end, Max<T>);
+  }
+}
+
+template <typename T>
+static void ScatterRows(PrimitiveType index_type,
+                        ScatterThunk::Combiner combiner,
+                        const ScatterArgs& args, int64_t begin, int64_t end) {
+  if (index_type == S32) {
+    ScatterRows<T, int32_t>(combiner, args, begin, end);
+  } else {
+    ScatterRows<T, int64_t>(combiner, args, begin, end);
+  }
+}
+
+static void ScatterRows(PrimitiveType type, PrimitiveType index_type,
+                        ScatterThunk::Combiner combiner,
+                        const ScatterArgs& args, int64_t begin, int64_t end) {
+  switch (type) {
+    case F32:
+      return ScatterRows<float>(index_type, combiner, args, begin, end);
+    case F64:
+      return ScatterRows<double>(index_type, combiner, args, begin, end);
+    case S32:
+      return ScatterRows<int32_t>(index_type, combiner, args, begin, end);
+    case S64:
+      return ScatterRows<int64_t>(index_type, combiner, args, begin, end);
+    default:
+      LOG(FATAL) << "Unsupported scatter element type: "
+                 << primitive_util::LowercasePrimitiveTypeName(type);
+  }
+}
+
+tsl::AsyncValueRef<ScatterThunk::ExecuteEvent> ScatterThunk::Execute(
+    const ExecuteParams& params) {
+  tsl::profiler::TraceMe trace([&] { return TraceMeEncode(); });
+
+  TF_ASSIGN_OR_RETURN(
+      se::DeviceMemoryBase operand_data,
+      params.buffer_allocations->GetDeviceAddress(operand_.slice));
+  TF_ASSIGN_OR_RETURN(
+      se::DeviceMemoryBase indices_data,
+      params.buffer_allocations->GetDeviceAddress(indices_.slice));
+  TF_ASSIGN_OR_RETURN(
+      se::DeviceMemoryBase updates_data,
+      params.buffer_allocations->GetDeviceAddress(updates_.slice));
+  TF_ASSIGN_OR_RETURN(
+      se::DeviceMemoryBase output_data,
+      params.buffer_allocations->GetDeviceAddress(output_.slice));
+
+  // Annotate memory that might have been initialized by jit-compiled code.
+  ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(operand_data.opaque(),
+                                      operand_data.size());
+  ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(indices_data.opaque(),
+                                      indices_data.size());
+  ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(updates_data.opaque(),
+                                      updates_data.size());
+
+  VLOG(3) << absl::StreamFormat(
+      "Scatter %s into %s (%p) at %s (%p), output in slice %s (%p)",
+      updates_.shape.ToString(true), operand_.shape.ToString(true),
+      operand_data.opaque(), indices_.shape.ToString(true),
+      indices_data.opaque(), output_.slice.ToString(), output_data.opaque());
+
+  // Scatter updates the output in place, unless the output aliases the
+  // operand we have to copy the operand first.
+  if (operand_data.opaque() != output_data.opaque()) {
+    std::memcpy(output_data.opaque(), operand_data.opaque(),
+                output_data.size());
+  }
+
+  int64_t num_rows = operand_.shape.dimensions(0);
+  ScatterArgs args{output_data.opaque(), indices_data.opaque(),
+                   updates_data.opaque(),
+                   ShapeUtil::ElementsIn(indices_.shape),
+                   ShapeUtil::ElementsIn(operand_.shape) /
+                       std::max<int64_t>(1, num_rows)};
+
+  PrimitiveType type = operand_.shape.element_type();
+  PrimitiveType index_type = indices_.shape.element_type();
+
+  int64_t num_elements = args.num_indices * args.row_size;
+  if (ABSL_PREDICT_TRUE(params.intra_op_threadpool == nullptr ||
+                        num_elements < kMinParallelScatterElements ||
+                        num_rows <= 1)) {
+    ScatterRows(type, index_type, combiner_, args, 0, num_rows);
+    return OkExecuteEvent();
+  }
+
+  // Every task owns a contiguous range of output rows.
+  int64_t num_tasks = std::min<int64_t>(
+      num_rows, params.intra_op_threadpool->numThreadsInPool());
+  int64_t rows_per_task = CeilOfRatio(num_rows, num_tasks);
+  num_tasks = CeilOfRatio(num_rows, rows_per_task);
+
+  auto event = tsl::MakeConstructedAsyncValueRef<ExecuteEvent>();
+  auto pending = std::make_shared<std::atomic<int64_t>>(num_tasks);
+
+  ScheduleAll(params.intra_op_threadpool, num_tasks,
+              [=, combiner = combiner_](int64_t task_index) {
+                int64_t begin = task_index * rows_per_task;
+                int64_t end = std::min(num_rows, begin + rows_per_task);
+                ScatterRows(type, index_type, combiner, args, begin, end);
+                if (pending->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                  event.SetStateConcrete();
+                }
+              });
+
+  return event;
+}
+
+ScatterThunk::BufferUses ScatterThunk::buffer_uses() const {
+  return {BufferUse::Read(operand_.slice), BufferUse::Read(indices_.slice),
+          BufferUse::Read(updates_.slice), BufferUse::Write(output_.slice)};
+}
+
+}  // namespace xla::cpu
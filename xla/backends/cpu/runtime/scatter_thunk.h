@@ -0,0 +1,69 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_BACKENDS_CPU_RUNTIME_SCATTER_THUNK_H_
+#define XLA_BACKENDS_CPU_RUNTIME_SCATTER_THUNK_H_
+
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/shape.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+
+namespace xla::cpu {
+
+// Scatters rows of `updates` into the rows of `operand` selected by `indices`
+// and writes the result to `output`. Implements scatters matched by
+// `PotentiallyImplementedAsScatterThunk`: every index selects a row along the
+// major dimension of the operand, and out of bounds indices are skipped.
+//
+// If the intra-op thread pool is available, large scatters partition the
+// operand rows across threads. Every thread scans all indices and updates only
+// the rows it owns, so updates to the same row are applied in order without
+// atomics and results are deterministic.
+class ScatterThunk final : public Thunk {
+ public:
+  // Function combining the operand row with the update row.
+  enum class Combiner { kAssign, kAdd, kMin, kMax };
+
+  struct Buffer {
+    BufferAllocation::Slice slice;
+    Shape shape;
+  };
+
+  static absl::StatusOr<std::unique_ptr<ScatterThunk>> Create(
+      Info info, Buffer operand, Buffer indices, Buffer updates, Buffer output,
+      Combiner combiner);
+
+  tsl::AsyncValueRef<ExecuteEvent> Execute(const ExecuteParams& params) final;
+
+  BufferUses buffer_uses() const final;
+
+ private:
+  ScatterThunk(Info info, Buffer operand, Buffer indices, Buffer updates,
+               Buffer output, Combiner combiner);
+
+  Buffer operand_;
+  Buffer indices_;
+  Buffer updates_;
+  Buffer output_;
+  Combiner combiner_;
+};
+
+}  // namespace xla::cpu
+
+#endif  // XLA_BACKENDS_CPU_RUNTIME_SCATTER_THUNK_H_
@@ -0,0 +1,184 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/scatter_thunk.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "xla/backends/cpu/runtime/buffer_allocations.h"
+#include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/primitive_util.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/service/maybe_owning_device_memory.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/tsl/concurrency/async_value_ref.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+#define EIGEN_USE_THREADS
+
+#include "unsupported/Eigen/CXX11/Tensor"
+
+namespace xla::cpu {
+namespace {
+
+// Runs a scatter thunk with the operand aliased with the output.
+template <typename T, typename Index>
+absl::Status RunScatter(std::vector<T>& operand, std::vector<Index>& indices,
+                        std::vector<T>& updates, int64_t row_size,
+                        ScatterThunk::Combiner combiner,
+                        const Eigen::ThreadPoolDevice* device = nullptr) {
+  std::vector<MaybeOwningDeviceMemory> buffers;
+  buffers.emplace_back(
+      se::DeviceMemoryBase(operand.data(), operand.size() * sizeof(T)));
+  buffers.emplace_back(
+      se::DeviceMemoryBase(indices.data(), indices.size() * sizeof(Index)));
+  buffers.emplace_back(
+      se::DeviceMemoryBase(updates.data(), updates.size() * sizeof(T)));
+  BufferAllocations allocations(buffers);
+
+  BufferAllocation alloc0(0, buffers[0].AsDeviceMemoryBase().size(), 0);
+  BufferAllocation alloc1(1, buffers[1].AsDeviceMemoryBase().size(), 0);
+  BufferAllocation alloc2(2, buffers[2].AsDeviceMemoryBase().size(), 0);
+
+  BufferAllocation::Slice operand_slice(&alloc0, 0, alloc0.size());
+  BufferAllocation::Slice indices_slice(&alloc1, 0, alloc1.size());
+  BufferAllocation::Slice updates_slice(&alloc2, 0, alloc2.size());
+
+  PrimitiveType type = primitive_util::NativeToPrimitiveType<T>();
+  PrimitiveType index_type = primitive_util::NativeToPrimitiveType<Index>();
+  int64_t num_rows = operand.size() / row_size;
+  int64_t num_indices = indices.size();
+
+  Shape operand_shape = ShapeUtil::MakeShape(type, {num_rows, row_size});
+  Shape indices_shape = ShapeUtil::MakeShape(index_type, {num_indices});
+  Shape updates_shape = ShapeUtil::MakeShape(type, {num_indices, row_size});
+
+  TF_ASSIGN_OR_RETURN(
+      auto thunk, ScatterThunk::Create({"scatter"},
+                                       {operand_slice, operand_shape},
+                                       {indices_slice, indices_shape},
+                                       {updates_slice, updates_shape},
+                                       {operand_slice, operand_shape},
+                                       combiner));
+
+  Thunk::ExecuteParams params;
+  params.buffer_allocations = &allocations;
+  params.intra_op_threadpool = device;
+
+  auto execute_event = thunk->Execute(params);
+  tsl::BlockUntilReady(execute_event);
+  if (execute_event.IsError()) return execute_event.GetError();
+  return absl::OkStatus();
+}
+
+TEST(ScatterThunkTest, ScatterAdd) {
+  std::vector<float> operand = {1, 1, 2, 2, 3, 3};
+  std::vector<int32_t> indices = {2, 0, 2, 5, -1};
+  std::vector<float> updates = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+  TF_ASSERT_OK(RunScatter(operand, indices, updates, /*row_size=*/2,
+                          ScatterThunk::Combiner::kAdd));
+
+  // Out of bounds indices are skipped.
+  std::vector<float> expected = {4, 5, 2, 2, 9, 11};
+  EXPECT_EQ(operand, expected);
+}
+
+TEST(ScatterThunkTest, ScatterAddWrapsAroundOnOverflow) {
+  constexpr int32_t kMax = std::numeric_limits<int32_t>::max();
+  constexpr int32_t kMin = std::numeric_limits<int32_t>::min();
+  std::vector<int32_t> operand = {kMax, kMin};
+  std::vector<int32_t> indices = {0, 1};
+  std::vector<int32_t> updates = {1, -1};
+
+  TF_ASSERT_OK(RunScatter(operand, indices, updates, /*row_size=*/1,
+                          ScatterThunk::Combiner::kAdd));
+  EXPECT_EQ(operand, (std::vector<int32_t>{kMin, kMax}));
+}
+
+TEST(ScatterThunkTest, ScatterAssignMinMax) {
+  std::vector<int64_t> indices = {1, 0, 1};
+  std::vector<int64_t> updates = {5, -5, 0};
+
+  std::vector<int64_t> assign = {1, 2};
+  TF_ASSERT_OK(RunScatter(assign, indices, updates, /*row_size=*/1,
+                          ScatterThunk::Combiner::kAssign));
+  EXPECT_EQ(assign, (std::vector<int64_t>{-5, 0}));
+
+  std::vector<int64_t> min = {1, 2};
+  TF_ASSERT_OK(RunScatter(min, indices, updates, /*row_size=*/1,
+                          ScatterThunk::Combiner::kMin));
+  EXPECT_EQ(min, (std::vector<int64_t>{-5, 0}));
+
+  std::vector<int64_t> max = {1, 2};
+  TF_ASSERT_OK(RunScatter(max, indices, updates, /*row_size=*/1,
+                          ScatterThunk::Combiner::kMax));
+  EXPECT_EQ(max, (std::vector<int64_t>{1, 5}));
+}
+
+TEST(ScatterThunkTest, ScatterMaxPropagatesNaN) {
+  float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> operand = {1, nan};
+  std::vector<int32_t> indices = {0, 1};
+  std::vector<float> updates = {nan, 2};
+
+  TF_ASSERT_OK(RunScatter(operand, indices, updates, /*row_size=*/1,
+                          ScatterThunk::Combiner::kMax));
+  EXPECT_TRUE(std::isnan(operand[0]));
+  EXPECT_TRUE(std::isnan(operand[1]));
+}
+
+TEST(ScatterThunkTest, ParallelScatterAdd) {
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "scatter-test", 8);
+  Eigen::ThreadPoolDevice device(thread_pool.AsEigenThreadPool(),
+                                 thread_pool.NumThreads());
+
+  int64_t num_rows = 100, row_size = 64, num_indices = 4096;
+
+  std::minstd_rand0 engine;
+  std::uniform_int_distribution<int32_t> dist(0, num_rows - 1);
+  std::vector<int32_t> indices(num_indices);
+  for (int32_t& index : indices) index = dist(engine);
+
+  std::vector<int64_t> updates(num_indices * row_size);
+  for (int64_t i = 0; i < updates.size(); ++i) updates[i] = i;
+
+  std::vector<int64_t> expected(num_rows * row_size, 0);
+  for (int64_t i = 0; i < num_indices; ++i) {
+    for (int64_t j = 0; j < row_size; ++j) {
+      expected[indices[i] * row_size + j] += updates[i * row_size + j];
+    }
+  }
+
+  std::vector<int64_t> operand(num_rows * row_size, 0);
+  TF_ASSERT_OK(RunScatter(operand, indices, updates, row_size,
+                          ScatterThunk::Combiner::kAdd, &device));
+  EXPECT_EQ(operand, expected);
+}
+
+}  // namespace
+}  // namespace xla::cpu
@@ -37,10 +37,21 @@ namespace xla::cpu {
 
 // Sorts data in the input buffers along the given dimension with a custom
 // less-than comparator function.
+//
+// If the intra-op thread pool is available, large sorts run in parallel: many
+// slices are distributed across the threads, and a few large slices are sorted
+// in chunks that are then merged.
 class SortThunk final : public Thunk {
  public:
   using LessThan = absl::AnyInvocable<bool(const void** data)>;
 
+  // Direction of a sort whose comparator only compares the values of the
+  // first input, i.e. `lhs < rhs` for kAscending and `lhs > rhs` for
+  // kDescending, with a total order for floating point values. For F32, S32
+  // and BF16 keys such sorts use a radix sort instead of calling the
+  // comparator.
+  enum class SortDirection { kAscending, kDescending };
+
   struct Input {
     BufferAllocation::Slice slice;
     Shape shape;
@@ -48,11 +59,13 @@ class SortThunk final : public Thunk {
 
   static absl::StatusOr<std::unique_ptr<SortThunk>> Create(
       Info info, absl::Span<const Input> inputs, int64_t dimension,
-      bool is_stable, LessThan less_than);
+      bool is_stable, LessThan less_than,
+      std::optional<SortDirection> direction = std::nullopt);
 
   static absl::StatusOr<std::unique_ptr<SortThunk>> Create(
       Info info, absl::Span<const Input> inputs, int64_t dimension,
-      bool is_stable, std::string comparator_name);
+      bool is_stable, std::string comparator_name,
+      std::optional<SortDirection> direction = std::nullopt);
 
   tsl::AsyncValueRef<ExecuteEvent> Execute(const ExecuteParams& params) final;
 
@@ -60,14 +73,17 @@ class SortThunk final : public Thunk {
 
  private:
   SortThunk(Info info, absl::Span<const Input> inputs, int64_t dimension,
-            bool is_stable, LessThan less_than);
+            bool is_stable, LessThan less_than,
+            std::optional<SortDirection> direction);
 
   SortThunk(Info info, absl::Span<const Input> inputs, int64_t dimension,
-            bool is_stable, std::string comparator_name);
+            bool is_stable, std::string comparator_name,
+            std::optional<SortDirection> direction);
 
   std::vector<Input> inputs_;
   int64_t dimension_;
   bool is_stable_;
+  std::optional<SortDirection> direction_;
 
   // Name of the comparator function, lazily resolved to a comparator function
   // pointer using Thunk::FunctionRegistry.
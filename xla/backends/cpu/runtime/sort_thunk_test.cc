@@ -16,12 +16,19 @@ limitations under the License.
 #include "xla/backends/cpu/runtime/sort_thunk.h"
 
 #include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <limits>
 #include <numeric>
+#include <optional>
+#include <random>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xla/backends/cpu/runtime/buffer_allocations.h"
 #include "xla/backends/cpu/runtime/thunk.h"
@@ -33,10 +40,17 @@ limitations under the License.
 #include "xla/shape_util.h"
 #include "xla/stream_executor/device_memory.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test.h"
 #include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
+
+#define EIGEN_USE_THREADS
+
+#include "Eigen/ThreadPool"
+#include "unsupported/Eigen/CXX11/Tensor"
 
 namespace xla::cpu {
 namespace {
@@ -317,6 +331,164 @@ TEST_P(SortThunkTest, Sort2DWithLayout) {
   EXPECT_EQ(indices, expected_indices);
 }
 
+// Sorts `keys` of the given shape along dimension 1, together with `indices`
+// of the same shape but with S32 elements.
+template <typename T>
+static absl::Status SortKeysAndIndices(
+    std::vector<T>& keys, std::vector<int32_t>& indices, Shape keys_shape,
+    bool is_stable, SortThunk::LessThan less_than,
+    std::optional<SortThunk::SortDirection> direction,
+    const Eigen::ThreadPoolDevice* device) {
+  size_t keys_size_in_bytes = keys.size() * sizeof(T);
+  size_t indices_size_in_bytes = indices.size() * sizeof(int32_t);
+
+  std::vector<MaybeOwningDeviceMemory> buffers;
+  buffers.emplace_back(se::DeviceMemoryBase(keys.data(), keys_size_in_bytes));
+  buffers.emplace_back(
+      se::DeviceMemoryBase(indices.data(), indices_size_in_bytes));
+  BufferAllocations allocations(buffers);
+
+  BufferAllocation alloc0(0, keys_size_in_bytes, 0);
+  BufferAllocation alloc1(1, indices_size_in_bytes, 0);
+  BufferAllocation::Slice slice0(&alloc0, 0, keys_size_in_bytes);
+  BufferAllocation::Slice slice1(&alloc1, 0, indices_size_in_bytes);
+
+  Shape indices_shape = ShapeUtil::ChangeElementType(keys_shape, S32);
+
+  TF_ASSIGN_OR_RETURN(
+      auto thunk,
+      SortThunk::Create({"sort"},
+                        {{slice0, keys_shape}, {slice1, indices_shape}},
+                        /*dimension=*/1, is_stable, std::move(less_than),
+                        direction));
+
+  Thunk::ExecuteParams params;
+  params.buffer_allocations = &allocations;
+  params.intra_op_threadpool = device;
+
+  auto execute_event = thunk->Execute(params);
+  tsl::BlockUntilReady(execute_event);
+  if (execute_event.IsError()) return execute_event.GetError();
+  return absl::OkStatus();
+}
+
+// Checks that each row of `keys` is sorted by `less_than`, and was permuted
+// from `original_keys` as given by `indices`.
+template <typename T, typename LessThan>
+static void ExpectSortedRows(const std::vector<T>& original_keys,
+                             const std::vector<T>& keys,
+                             const std::vector<int32_t>& indices,
+                             int64_t row_size, bool is_stable,
+                             LessThan less_than) {
+  for (int64_t row = 0; row < keys.size() / row_size; ++row) {
+    for (int64_t i = 0; i < row_size; ++i) {
+      int64_t idx = row * row_size + i;
+      ASSERT_EQ(keys[idx], original_keys[row * row_size + indices[idx]]);
+      if (i == 0) continue;
+      ASSERT_FALSE(less_than(keys[idx], keys[idx - 1])) << "at " << idx;
+      if (is_stable && !less_than(keys[idx - 1], keys[idx])) {
+        ASSERT_LT(indices[idx - 1], indices[idx]) << "at " << idx;
+      }
+    }
+  }
+}
+
+TEST_P(SortThunkTest, ParallelSort) {
+  bool is_stable = GetParam();
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "sort-test", 8);
+  Eigen::ThreadPoolDevice device(thread_pool.AsEigenThreadPool(),
+                                 thread_pool.NumThreads());
+
+  // Many small rows are sorted by different threads, and a single large row
+  // is sorted in chunks that are then merged.
+  for (auto [num_rows, row_size] : {std::pair<int64_t, int64_t>{256, 1000},
+                                    std::pair<int64_t, int64_t>{1, 100000}}) {
+    std::minstd_rand0 engine;
+    std::uniform_int_distribution<int32_t> dist(0, 1000);
+    std::vector<float> keys(num_rows * row_size);
+    for (float& key : keys) key = dist(engine);
+    std::vector<int32_t> indices(keys.size());
+    for (int64_t i = 0; i < indices.size(); ++i) indices[i] = i % row_size;
+
+    std::vector<float> original_keys = keys;
+    TF_ASSERT_OK(SortKeysAndIndices(
+        keys, indices, ShapeUtil::MakeShape(F32, {num_rows, row_size}),
+        is_stable, LessThan, std::nullopt, &device));
+    ExpectSortedRows(original_keys, keys, indices, row_size, is_stable,
+                     std::less<float>());
+  }
+}
+
+TEST_P(SortThunkTest, RadixSort) {
+  bool is_stable = GetParam();
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "sort-test", 8);
+  Eigen::ThreadPoolDevice device(thread_pool.AsEigenThreadPool(),
+                                 thread_pool.NumThreads());
+
+  // Sorts with a known direction must not call the comparator.
+  auto unused_less_than = [](const void** data) {
+    ADD_FAILURE() << "Comparator must not be called";
+    return false;
+  };
+
+  constexpr int64_t kNumRows = 64;
+  constexpr int64_t kRowSize = 1000;
+  std::minstd_rand0 engine;
+  std::uniform_int_distribution<int32_t> dist(-100, 100);
+
+  for (const Eigen::ThreadPoolDevice* threadpool :
+       {static_cast<const Eigen::ThreadPoolDevice*>(nullptr),
+        static_cast<const Eigen::ThreadPoolDevice*>(&device)}) {
+    std::vector<float> f32_keys(kNumRows * kRowSize);
+    std::vector<int32_t> s32_keys(kNumRows * kRowSize);
+    for (int64_t i = 0; i < f32_keys.size(); ++i) {
+      s32_keys[i] = dist(engine) * 1000;
+      f32_keys[i] = s32_keys[i] / 7.0f;
+    }
+    f32_keys[1] = -0.0f;
+    f32_keys[2] = std::numeric_limits<float>::infinity();
+    f32_keys[3] = -std::numeric_limits<float>::infinity();
+    s32_keys[1] = std::numeric_limits<int32_t>::min();
+    s32_keys[2] = std::numeric_limits<int32_t>::max();
+
+    for (auto direction : {SortThunk::SortDirection::kAscending,
+                           SortThunk::SortDirection::kDescending}) {
+      bool ascending = direction == SortThunk::SortDirection::kAscending;
+      std::vector<int32_t> indices(f32_keys.size());
+      for (int64_t i = 0; i < indices.size(); ++i) indices[i] = i % kRowSize;
+
+      std::vector<float> sorted_f32_keys = f32_keys;
+      TF_ASSERT_OK(SortKeysAndIndices(
+          sorted_f32_keys, indices,
+          ShapeUtil::MakeShape(F32, {kNumRows, kRowSize}), is_stable,
+          unused_less_than, direction, threadpool));
+      // Radix sorts use the total order, in which -0.0 comes before +0.0.
+      auto f32_less_than = [&](float a, float b) {
+        auto total_order_less = [](float x, float y) {
+          return x < y || (x == y && std::signbit(x) && !std::signbit(y));
+        };
+        return ascending ? total_order_less(a, b) : total_order_less(b, a);
+      };
+      ExpectSortedRows(f32_keys, sorted_f32_keys, indices, kRowSize, is_stable,
+                       f32_less_than);
+
+      for (int64_t i = 0; i < indices.size(); ++i) indices[i] = i % kRowSize;
+      std::vector<int32_t> sorted_s32_keys = s32_keys;
+      TF_ASSERT_OK(SortKeysAndIndices(
+          sorted_s32_keys, indices,
+          ShapeUtil::MakeShape(S32, {kNumRows, kRowSize}), is_stable,
+          unused_less_than, direction, threadpool));
+      auto s32_less_than = [&](int32_t a, int32_t b) {
+        return ascending ? a < b : a > b;
+      };
+      ExpectSortedRows(s32_keys, sorted_s32_keys, indices, kRowSize, is_stable,
+                       s32_less_than);
+    }
+  }
+}
+
 void BM_DynamicSort1D(::testing::benchmark::State& state, bool is_stable) {
   const int total_num_of_slices = state.range(0);
   const int num_of_empty_slices = total_num_of_slices - 2;
@@ -75,8 +75,14 @@ std::string_view Thunk::KindToString(Kind kind) {
       return "reduce-scatter";
     case Kind::kReplicaId:
       return "replica-id";
+    case Kind::kRngBitGenerator:
+      return "rng-bit-generator";
     case Kind::kRngGetAndUpdateState:
       return "rng-get-and-update-state";
+    case Kind::kScan:
+      return "scan";
+    case Kind::kScatter:
+      return "scatter";
     case Kind::kSort:
       return "sort";
     case Kind::kTopK:
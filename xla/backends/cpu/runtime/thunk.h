@@ -87,7 +87,10 @@ class Thunk {
     kPartitionId,
     kReduceScatter,
     kReplicaId,
+    kRngBitGenerator,
     kRngGetAndUpdateState,
+    kScan,
+    kScatter,
     kSort,
     kTopK,
     kWhile,
@@ -18,6 +18,7 @@ limitations under the License.
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
@@ -34,6 +35,7 @@ limitations under the License.
 #include "absl/types/span.h"
 #include "xla/backends/cpu/runtime/resource_use.h"
 #include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/backends/cpu/runtime/thunk_executor_stats.h"
 #include "xla/runtime/buffer_use.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
 #include "tsl/platform/logging.h"
@@ -48,7 +50,12 @@ ThunkExecutor::ThunkExecutor(ThunkSequence thunk_sequence,
       options_(options),
       num_thunks_(thunk_sequence_.size()),
       nodes_defs_(std::move(nodes_defs)),
-      is_sequential_(true) {
+      is_sequential_(true),
+      execute_state_cache_(std::make_unique<ExecuteStateCache>()) {
+  if (options_.collect_stats) {
+    stats_ = std::make_unique<ThunkExecutorStats>(num_thunks_);
+  }
+
   for (NodeId i = 0; i < nodes_defs_.size(); ++i) {
     // Mark nodes with empty in-edges as source nodes.
     if (nodes_defs_[i].in_edges.empty()) {
@@ -135,7 +142,9 @@ absl::StatusOr<ThunkExecutor> ThunkExecutor::Create(
 }
 
 ThunkExecutor::ExecuteState::Node::Node(const NodeDef& node_def)
-    : counter(node_def.in_edges.size()), out_edges(&node_def.out_edges) {}
+    : counter(node_def.in_edges.size()),
+      out_edges(&node_def.out_edges),
+      ready_ns(0) {}
 
 ThunkExecutor::ExecuteState::ExecuteState(ThunkExecutor* executor,
                                           Thunk::TaskRunner* runner)
@@ -152,6 +161,50 @@ ThunkExecutor::ExecuteState::ExecuteState(ThunkExecutor* executor,
   for (const NodeDef& node_def : executor->nodes_defs()) {
     new (node++) Node(node_def);
   }
+
+  // Source nodes are ready to execute when the execution starts.
+  if (ABSL_PREDICT_FALSE(executor->stats() != nullptr)) {
+    int64_t now_ns = ThunkExecutorStats::NowNanos();
+    for (NodeId id : executor->source()) this->node(id).ready_ns = now_ns;
+  }
+}
+
+void ThunkExecutor::ExecuteState::Reset(ThunkExecutor* executor,
+                                        Thunk::TaskRunner* runner) {
+  DCHECK(runner == nullptr || static_cast<bool>(*runner))
+      << "`runner` must be nullptr or a valid TaskRunner";
+  DCHECK_EQ(nodes.size(), executor->nodes_defs().size());
+
+  this->executor = executor;
+  this->runner = runner;
+
+  // Nodes are trivially destructible, so we can construct them in place.
+  NodeStorage* node = nodes.data();
+  for (const NodeDef& node_def : executor->nodes_defs()) {
+    new (node++) Node(node_def);
+  }
+
+  execute_event = tsl::MakeConstructedAsyncValueRef<ExecuteEvent>();
+  pending_sink_nodes.store(executor->sink().size(), std::memory_order_relaxed);
+  abort.store(false, std::memory_order_relaxed);
+  {
+    absl::MutexLock lock(&abort_mutex);
+    abort_status = absl::OkStatus();
+  }
+
+  if (ABSL_PREDICT_FALSE(executor->stats() != nullptr)) {
+    int64_t now_ns = ThunkExecutorStats::NowNanos();
+    for (NodeId id : executor->source()) this->node(id).ready_ns = now_ns;
+  }
+}
+
+std::unique_ptr<ThunkExecutor::ExecuteState>
+ThunkExecutor::AcquireExecuteState(Thunk::TaskRunner* runner) {
+  if (std::unique_ptr<ExecuteState> state = execute_state_cache_->Take()) {
+    state->Reset(this, runner);
+    return state;
+  }
+  return std::make_unique<ExecuteState>(this, runner);
 }
 
 tsl::AsyncValueRef<ThunkExecutor::ExecuteEvent> ThunkExecutor::Execute(
@@ -161,6 +214,26 @@ tsl::AsyncValueRef<ThunkExecutor::ExecuteEvent> ThunkExecutor::Execute(
     return Thunk::OkExecuteEventSingleton();
   }
   if (ABSL_PREDICT_FALSE(num_thunks_ == 1)) {
+    if (ABSL_PREDICT_FALSE(stats_ != nullptr)) {
+      int64_t start_ns = ThunkExecutorStats::NowNanos();
+      auto execute_event = thunk_sequence_[0]->Execute(params);
+      if (ABSL_PREDICT_TRUE(execute_event.IsAvailable())) {
+        RecordStats(0, start_ns, /*queue_delay_ns=*/0);
+        return execute_event;
+      }
+      // Record stats before forwarding the completion to the caller, as the
+      // executor might be destroyed once the returned event is available.
+      auto event = tsl::MakeConstructedAsyncValueRef<ExecuteEvent>();
+      execute_event.AndThen([this, start_ns, event](absl::Status status) {
+        RecordStats(0, start_ns, /*queue_delay_ns=*/0);
+        if (ABSL_PREDICT_FALSE(!status.ok())) {
+          event.SetError(std::move(status));
+        } else {
+          event.SetStateConcrete();
+        }
+      });
+      return event;
+    }
     return thunk_sequence_[0]->Execute(params);
   }
 
@@ -172,26 +245,38 @@ tsl::AsyncValueRef<ThunkExecutor::ExecuteEvent> ThunkExecutor::Execute(
     return ExecuteSequential(params);
   }
 
-  // Create async execution state on heap and kick-off execution.
-  auto state = std::make_unique<ExecuteState>(this, params.task_runner);
+  // Create (or reuse) async execution state on heap and kick-off execution.
+  std::unique_ptr<ExecuteState> state = AcquireExecuteState(params.task_runner);
 
   // When we kick-off execution we don't have to grab the session lock, as the
   // main thread is not counted towards the number of concurrent workers limit.
   // This also works for thunks with nested thunk executors (i.e., WhileThunk),
   // as launching nested thunk sequence must not reduce the available
   // concurrency for the other thunks executing in parallel.
-  if (options_.use_priority_ready_queue) {
-    Execute(state.get(), params, PriorityReadyQueue(nodes_defs_, source_),
-            /*lock=*/nullptr);
-  } else {
-    Execute(state.get(), params, FifoReadyQueue(source_),
-            /*lock=*/nullptr);
+  switch (options_.ready_queue_type) {
+    case Options::ReadyQueueType::kFifo:
+      Execute(state.get(), params, FifoReadyQueue(source_),
+              /*lock=*/nullptr);
+      break;
+    case Options::ReadyQueueType::kLifo:
+      Execute(state.get(), params, LifoReadyQueue(source_),
+              /*lock=*/nullptr);
+      break;
+    case Options::ReadyQueueType::kPriority:
+      Execute(state.get(), params, PriorityReadyQueue(nodes_defs_, source_),
+              /*lock=*/nullptr);
+      break;
   }
 
   // If execution already completed (all kernels executed in the caller thread),
   // immediately return the result to avoid wasteful reference counting below.
+  // Completed execution doesn't touch the state anymore, so we can return it to
+  // the cache.
   if (ABSL_PREDICT_TRUE(state->execute_event.IsAvailable())) {
-    return std::move(state->execute_event);
+    tsl::AsyncValueRef<ExecuteEvent> execute_event =
+        std::move(state->execute_event);
+    execute_state_cache_->Put(std::move(state));
+    return execute_event;
   }
 
   // Move execute state to the execute event callback to ensure that it is kept
@@ -211,8 +296,20 @@ tsl::AsyncValueRef<ThunkExecutor::ExecuteEvent>
 ThunkExecutor::ExecuteSequential(const Thunk::ExecuteParams& params) {
   for (auto it = thunk_sequence_.begin(); it != thunk_sequence_.end(); ++it) {
     Thunk& thunk = **it;
+    int64_t start_ns = 0;
+    if (ABSL_PREDICT_FALSE(stats_ != nullptr)) {
+      start_ns = ThunkExecutorStats::NowNanos();
+    }
+
     auto execute_event = thunk.Execute(params);
 
+    // Thunks are executed back to back, so there is no queueing delay.
+    if (ABSL_PREDICT_FALSE(stats_ != nullptr) &&
+        ABSL_PREDICT_TRUE(execute_event.IsAvailable())) {
+      RecordStats(std::distance(thunk_sequence_.begin(), it), start_ns,
+                  /*queue_delay_ns=*/0);
+    }
+
     // Fast path for thunks executed inline and returned OkExecuteEvent.
     if (ABSL_PREDICT_TRUE(thunk.IsOkExecuteEvent(execute_event))) {
       continue;
@@ -222,7 +319,12 @@ ThunkExecutor::ExecuteSequential(const Thunk::ExecuteParams& params) {
     // resume sequential execution starting from the next thunk.
     if (ABSL_PREDICT_FALSE(!execute_event.IsAvailable())) {
       auto event = tsl::MakeConstructedAsyncValueRef<ExecuteEvent>();
-      execute_event.AndThen([this, &params, it, event](absl::Status status) {
+      execute_event.AndThen([this, &params, it, start_ns,
+                             event](absl::Status status) {
+        if (ABSL_PREDICT_FALSE(stats_ != nullptr)) {
+          RecordStats(std::distance(thunk_sequence_.begin(), it), start_ns,
+                      /*queue_delay_ns=*/0);
+        }
         if (ABSL_PREDICT_FALSE(!status.ok())) {
           event.SetError(std::move(status));
         } else {
@@ -248,8 +350,20 @@ void ThunkExecutor::ResumeExecuteSequential(
     tsl::AsyncValueRef<ExecuteEvent> event) {
   for (; it != thunk_sequence_.end(); ++it) {
     Thunk& thunk = **it;
+    int64_t start_ns = 0;
+    if (ABSL_PREDICT_FALSE(stats_ != nullptr)) {
+      start_ns = ThunkExecutorStats::NowNanos();
+    }
+
     auto execute_event = thunk.Execute(params);
 
+    // Thunks are executed back to back, so there is no queueing delay.
+    if (ABSL_PREDICT_FALSE(stats_ != nullptr) &&
+        ABSL_PREDICT_TRUE(execute_event.IsAvailable())) {
+      RecordStats(std::distance(thunk_sequence_.begin(), it), start_ns,
+                  /*queue_delay_ns=*/0);
+    }
+
     // Fast path for thunks executed inline and returned OkExecuteEvent.
     if (ABSL_PREDICT_TRUE(thunk.IsOkExecuteEvent(execute_event))) {
       continue;
@@ -258,14 +372,18 @@ void ThunkExecutor::ResumeExecuteSequential(
     // If thunk execution is not completed yet, attach a continuation to
     // resume sequential execution starting from the next thunk.
     if (ABSL_PREDICT_FALSE(!execute_event.IsAvailable())) {
-      execute_event.AndThen(
-          [this, &params, it, event = std::move(event)](absl::Status status) {
-            if (ABSL_PREDICT_FALSE(!status.ok())) {
-              event.SetError(std::move(status));
-            } else {
-              ResumeExecuteSequential(it + 1, params, std::move(event));
-            }
-          });
+      execute_event.AndThen([this, &params, it, start_ns,
+                             event = std::move(event)](absl::Status status) {
+        if (ABSL_PREDICT_FALSE(stats_ != nullptr)) {
+          RecordStats(std::distance(thunk_sequence_.begin(), it), start_ns,
+                      /*queue_delay_ns=*/0);
+        }
+        if (ABSL_PREDICT_FALSE(!status.ok())) {
+          event.SetError(std::move(status));
+        } else {
+          ResumeExecuteSequential(it + 1, params, std::move(event));
+        }
+      });
       return;
     }
 
@@ -281,6 +399,12 @@ void ThunkExecutor::ResumeExecuteSequential(
   event.SetStateConcrete();
 }
 
+void ThunkExecutor::RecordStats(NodeId id, int64_t start_ns,
+                                int64_t queue_delay_ns) {
+  stats_->Record(id, ThunkExecutorStats::NowNanos() - start_ns,
+                 queue_delay_ns);
+}
+
 template <typename ReadyQueue>
 void ThunkExecutor::Execute(ExecuteState* state,
                             const Thunk::ExecuteParams& params,
@@ -317,12 +441,24 @@ void ThunkExecutor::Execute(ExecuteState* state,
     // Execute thunk for the given node id. If execution is aborted, we keep
     // processing the nodes DAG without executing thunks.
     Thunk& thunk = *state->executor->thunk_sequence_[id];
+    ThunkExecutorStats* stats = state->executor->stats_.get();
+    int64_t start_ns = 0;
+    if (ABSL_PREDICT_FALSE(stats != nullptr)) {
+      start_ns = ThunkExecutorStats::NowNanos();
+    }
+
     tsl::AsyncValueRef<ExecuteEvent> execute_event =
         ABSL_PREDICT_FALSE(state->abort.load(std::memory_order_relaxed))
             ? Thunk::OkExecuteEventSingleton()
             : thunk.Execute(params);
 
     if (ABSL_PREDICT_TRUE(execute_event.IsAvailable())) {
+      // Stats must be recorded before processing out edges, as completing the
+      // last sink node might destroy the execute state.
+      if (ABSL_PREDICT_FALSE(stats != nullptr)) {
+        state->executor->RecordStats(id, start_ns, start_ns - node.ready_ns);
+      }
+
       // If thunk execution is completed, process out edges in the current
       // thread and keep working on the ready queue.
       ProcessOutEdges(state, execute_event.AsPtr(), node, ready_queue);
@@ -339,10 +475,17 @@ void ThunkExecutor::Execute(ExecuteState* state,
       // queue, we will forward the lock that we already hold (note that the
       // lock might be empty, if `Execute` was called by the main thread).
       execute_event.AndThen(
-          [&params, &node, state, execute_event = execute_event.AsPtr(),
+          [&params, &node, state, id, start_ns,
+           execute_event = execute_event.AsPtr(),
            ready_queue = ready_queue.CreateEmptyReadyQueue(),
            lock = ready_queue.Empty() ? std::move(lock)
                                       : params.session.Join()]() mutable {
+            // Record stats before processing out edges, which might complete
+            // the execution and destroy the `state`.
+            if (ABSL_PREDICT_FALSE(state->executor->stats_ != nullptr)) {
+              state->executor->RecordStats(id, start_ns,
+                                           start_ns - node.ready_ns);
+            }
             state->executor->ProcessOutEdges(state, execute_event, node,
                                              ready_queue);
             // If ready queue is empty, it might mean that we have completed an
@@ -409,7 +552,12 @@ void ThunkExecutor::ProcessOutEdges(
 
     int64_t cnt = out_node.counter.fetch_sub(1, std::memory_order_release);
     DCHECK_GE(cnt, 1) << "Node counter can't drop below 0";
-    if (cnt == 1) ready_queue.Push(out_edge);
+    if (cnt == 1) {
+      if (ABSL_PREDICT_FALSE(state->executor->stats_ != nullptr)) {
+        out_node.ready_ns = ThunkExecutorStats::NowNanos();
+      }
+      ready_queue.Push(out_edge);
+    }
   }
 
   // Drop the pending sink nodes counter if the node is a sink.
@@ -595,6 +743,57 @@ ThunkExecutor::FifoReadyQueue::CreateEmptyReadyQueue() const {
   return FifoReadyQueue(absl::Span<const NodeId>());
 }
 
+ThunkExecutor::LifoReadyQueue::LifoReadyQueue(
+    absl::Span<const NodeId> ready_nodes)
+    : queue_(ready_nodes.begin(), ready_nodes.end()) {}
+
+void ThunkExecutor::LifoReadyQueue::Push(NodeId id) { queue_.push_back(id); }
+
+ThunkExecutor::NodeId ThunkExecutor::LifoReadyQueue::Pop() {
+  DCHECK(!Empty()) << "Queue must not be empty";
+  NodeId id = queue_.back();
+  queue_.pop_back();
+
+  // Reset the queue storage once all nodes are popped, so that the front of
+  // the queue consumed by `PopHalf` does not grow unbounded.
+  if (queue_.size() == head_) {
+    queue_.clear();
+    head_ = 0;
+  }
+
+  return id;
+}
+
+ThunkExecutor::LifoReadyQueue ThunkExecutor::LifoReadyQueue::PopHalf() {
+  DCHECK(!Empty()) << "Queue must not be empty";
+  // Hand off the oldest nodes from the front of the queue, and keep the most
+  // recently pushed nodes for the current worker.
+  auto begin = queue_.begin() + head_;
+  auto mid = begin + (Size() - Size() / 2);
+  LifoReadyQueue popped(absl::MakeConstSpan(&*begin, mid - begin));
+  head_ = mid - queue_.begin();
+
+  if (queue_.size() == head_) {
+    queue_.clear();
+    head_ = 0;
+  }
+
+  return popped;
+}
+
+size_t ThunkExecutor::LifoReadyQueue::Size() const {
+  return queue_.size() - head_;
+}
+
+bool ThunkExecutor::LifoReadyQueue::Empty() const {
+  return head_ == queue_.size();
+}
+
+ThunkExecutor::LifoReadyQueue
+ThunkExecutor::LifoReadyQueue::CreateEmptyReadyQueue() const {
+  return LifoReadyQueue(absl::Span<const NodeId>());
+}
+
 ThunkExecutor::PriorityReadyQueue::PriorityReadyQueue(
     absl::Span<const NodeDef> nodes_defs, absl::Span<const NodeId> ready_nodes)
     : nodes_defs_(nodes_defs),
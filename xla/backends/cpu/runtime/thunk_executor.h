@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <new>
 #include <queue>
 #include <string>
@@ -34,6 +35,7 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/backends/cpu/runtime/thunk_executor_stats.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
 
 namespace xla::cpu {
@@ -42,6 +44,18 @@ namespace internal {
 // Clang does not allow defining a nested struct with member initializer, as
 // a workaround we define a struct in internal namespace and create an alias.
 struct ThunkExecutorOptions {
+  // Discipline used by the ready queue that holds nodes with all in-edges
+  // completed.
+  enum class ReadyQueueType {
+    // Execute nodes in the order they became ready.
+    kFifo,
+    // Execute most recently readied nodes first and donate the oldest ready
+    // nodes to other workers (work-stealing deque discipline).
+    kLifo,
+    // Execute nodes according to their NodeDef priority.
+    kPriority,
+  };
+
   // If all thunks in a sequence use buffers of size less than or equal to the
   // given threshold, we mark execution as sequential, as concurrency overheads
   // will likely dominate the overall execution time.
@@ -52,9 +66,12 @@ struct ThunkExecutorOptions {
   // the overall execution time.
   size_t execute_sequential_num_thunks_threshold = 8;
 
-  // Use priority ready queue to execute nodes according to their priority. By
-  // default we use FIFO ready queue.
-  bool use_priority_ready_queue = false;
+  // Ready queue type used to execute nodes. By default we use FIFO ready queue.
+  ReadyQueueType ready_queue_type = ReadyQueueType::kFifo;
+
+  // If true, the executor records per-thunk wall time and queueing delay
+  // histograms (see ThunkExecutorStats).
+  bool collect_stats = false;
 };
 }  // namespace internal
 
@@ -95,6 +112,8 @@ class ThunkExecutor {
   // If any of the thunks failed, the event will be in error state.
   tsl::AsyncValueRef<ExecuteEvent> Execute(const Thunk::ExecuteParams& params);
 
+  const ThunkSequence& thunk_sequence() const { return thunk_sequence_; }
+
   absl::Span<const NodeDef> nodes_defs() const { return nodes_defs_; }
   const NodeDef& node_def(NodeId id) const { return nodes_defs_[id]; }
 
@@ -108,6 +127,11 @@ class ThunkExecutor {
 
   bool is_sequential() const { return is_sequential_; }
 
+  // Returns execution statistics if they are enabled by the executor options,
+  // or nullptr otherwise.
+  const ThunkExecutorStats* stats() const { return stats_.get(); }
+  ThunkExecutorStats* stats() { return stats_.get(); }
+
   // A ready queue that executes nodes in FIFO order.
   class FifoReadyQueue {
    public:
@@ -128,6 +152,30 @@ class ThunkExecutor {
     size_t head_ = 0;
   };
 
+  // A ready queue that follows a work-stealing deque discipline: the owner
+  // pushes and pops nodes at the back of the queue (LIFO), so that successors
+  // of a just completed node are executed by the same worker while their
+  // inputs are still hot in cache, and `PopHalf` hands off the oldest nodes
+  // from the front of the queue to other workers.
+  class LifoReadyQueue {
+   public:
+    explicit LifoReadyQueue(absl::Span<const NodeId> ready_nodes);
+
+    void Push(NodeId id);
+
+    NodeId Pop();
+    LifoReadyQueue PopHalf();
+
+    size_t Size() const;
+    bool Empty() const;
+
+    LifoReadyQueue CreateEmptyReadyQueue() const;
+
+   private:
+    absl::InlinedVector<NodeId, 8> queue_;
+    size_t head_ = 0;
+  };
+
   // A ready queue that executes nodes sorted by NodeDef priority.
   class PriorityReadyQueue {
    public:
@@ -178,6 +226,10 @@ class ThunkExecutor {
 
       alignas(kAtomicAlignment) std::atomic<int64_t> counter;
       const std::vector<NodeId>* out_edges;
+
+      // Time when the node became ready to execute. Updated only if the
+      // executor collects execution statistics.
+      int64_t ready_ns;
     };
 
     static_assert(std::is_trivially_destructible_v<Node>,
@@ -189,6 +241,9 @@ class ThunkExecutor {
 
     ExecuteState(ThunkExecutor* executor, Thunk::TaskRunner* runner);
 
+    // Prepares a state of a completed execution for the next one.
+    void Reset(ThunkExecutor* executor, Thunk::TaskRunner* runner);
+
     Node& node(NodeId id) { return *reinterpret_cast<Node*>(&nodes[id]); }
 
     ThunkExecutor* executor;
@@ -208,6 +263,35 @@ class ThunkExecutor {
     absl::Status abort_status ABSL_GUARDED_BY(abort_mutex);
   };
 
+  // A single slot cache for the execute state of a completed execution. Reusing
+  // it saves allocating a new state for every execution, i.e. for every
+  // iteration of a while loop body. Concurrent executions that find the slot
+  // empty allocate their own state.
+  class ExecuteStateCache {
+   public:
+    ~ExecuteStateCache() { delete state_.exchange(nullptr); }
+
+    std::unique_ptr<ExecuteState> Take() {
+      return std::unique_ptr<ExecuteState>(
+          state_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    void Put(std::unique_ptr<ExecuteState> state) {
+      ExecuteState* empty = nullptr;
+      if (state_.compare_exchange_strong(empty, state.get(),
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+        state.release();
+      }
+    }
+
+   private:
+    std::atomic<ExecuteState*> state_{nullptr};
+  };
+
+  // Returns a cached execute state reset for a new execution, or a new one.
+  std::unique_ptr<ExecuteState> AcquireExecuteState(Thunk::TaskRunner* runner);
+
   ThunkExecutor(ThunkSequence thunk_sequence, std::vector<NodeDef> nodes_defs,
                 const Options& options);
 
@@ -221,6 +305,12 @@ class ThunkExecutor {
                                const Thunk::ExecuteParams& params,
                                tsl::AsyncValueRef<ExecuteEvent> event);
 
+  // Records execution statistics of the thunk `id` that started execution at
+  // `start_ns` and just completed. Must be called from the thread (or the
+  // execute event continuation) that processes thunk completion, before the
+  // completion is forwarded to the executor.
+  void RecordStats(NodeId id, int64_t start_ns, int64_t queue_delay_ns);
+
   // Executes nodes in the ready queue with given thunk parameters.
   template <typename ReadyQueue>
   void Execute(ExecuteState* state, const Thunk::ExecuteParams& params,
@@ -260,6 +350,10 @@ class ThunkExecutor {
   // opportunities for executing thunks concurrently, we skip the expensive
   // async execution and simply run thunks in the `thunk_sequence_` one by one.
   bool is_sequential_;
+
+  std::unique_ptr<ThunkExecutorStats> stats_;
+
+  std::unique_ptr<ExecuteStateCache> execute_state_cache_;
 };
 
 }  // namespace xla::cpu
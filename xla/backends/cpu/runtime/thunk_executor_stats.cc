@@ -0,0 +1,117 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/thunk_executor_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/numeric/bits.h"
+
+namespace xla::cpu {
+
+ThunkExecutorStats::ThunkExecutorStats(size_t num_thunks)
+    : thunks_(num_thunks) {}
+
+int64_t ThunkExecutorStats::NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int64_t ThunkExecutorStats::CurrentWorkerId() {
+  static std::atomic<int64_t> next_worker_id{0};
+  thread_local int64_t worker_id =
+      next_worker_id.fetch_add(1, std::memory_order_relaxed);
+  return worker_id;
+}
+
+size_t ThunkExecutorStats::BucketIndex(int64_t value_ns) {
+  if (value_ns <= 0) return 0;
+  size_t bucket = absl::bit_width(static_cast<uint64_t>(value_ns));
+  return std::min(bucket, kNumBuckets - 1);
+}
+
+void ThunkExecutorStats::Histogram::Record(int64_t value_ns) {
+  value_ns = std::max<int64_t>(value_ns, 0);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_ns_.fetch_add(value_ns, std::memory_order_relaxed);
+  buckets_[BucketIndex(value_ns)].fetch_add(1, std::memory_order_relaxed);
+
+  int64_t max_ns = max_ns_.load(std::memory_order_relaxed);
+  while (value_ns > max_ns &&
+         !max_ns_.compare_exchange_weak(max_ns, value_ns,
+                                        std::memory_order_relaxed)) {
+  }
+}
+
+ThunkExecutorStats::HistogramSnapshot
+ThunkExecutorStats::Histogram::GetSnapshot() const {
+  HistogramSnapshot snapshot;
+  snapshot.count = count_.load(std::memory_order_relaxed);
+  snapshot.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+  snapshot.max_ns = max_ns_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+void ThunkExecutorStats::Histogram::Reset() {
+  count_.store(0, std::memory_order_relaxed);
+  sum_ns_.store(0, std::memory_order_relaxed);
+  max_ns_.store(0, std::memory_order_relaxed);
+  for (std::atomic<int64_t>& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+void ThunkExecutorStats::Record(size_t thunk_index, int64_t wall_time_ns,
+                                int64_t queue_delay_ns) {
+  ThunkStats& thunk = thunks_[thunk_index];
+  thunk.wall_time.Record(wall_time_ns);
+  thunk.queue_delay.Record(queue_delay_ns);
+  workers_[CurrentWorkerId() % kMaxWorkers].wall_time.Record(wall_time_ns);
+}
+
+ThunkExecutorStats::Snapshot ThunkExecutorStats::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.thunks.reserve(thunks_.size());
+  for (const ThunkStats& thunk : thunks_) {
+    snapshot.thunks.push_back(
+        {thunk.wall_time.GetSnapshot(), thunk.queue_delay.GetSnapshot()});
+  }
+  for (size_t i = 0; i < kMaxWorkers; ++i) {
+    HistogramSnapshot wall_time = workers_[i].wall_time.GetSnapshot();
+    if (wall_time.count == 0) continue;
+    snapshot.workers.push_back({static_cast<int64_t>(i), wall_time});
+  }
+  return snapshot;
+}
+
+void ThunkExecutorStats::Reset() {
+  for (ThunkStats& thunk : thunks_) {
+    thunk.wall_time.Reset();
+    thunk.queue_delay.Reset();
+  }
+  for (WorkerStats& worker : workers_) {
+    worker.wall_time.Reset();
+  }
+}
+
+}  // namespace xla::cpu
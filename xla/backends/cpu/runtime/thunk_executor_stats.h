@@ -0,0 +1,132 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_BACKENDS_CPU_RUNTIME_THUNK_EXECUTOR_STATS_H_
+#define XLA_BACKENDS_CPU_RUNTIME_THUNK_EXECUTOR_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "absl/container/fixed_array.h"
+
+namespace xla::cpu {
+
+// Cheap always-on execution statistics for the thunks of a ThunkExecutor.
+//
+// For every thunk we record a histogram of its wall time (from the start of
+// `Thunk::Execute` until its execute event becomes available) and of its
+// queueing delay (from the time the thunk became ready until it started
+// executing). For every worker thread we record the number of executed thunks
+// and a histogram of their wall time, which shows how evenly the work was
+// distributed across the thread pool.
+//
+// All counters are relaxed atomics and recording never takes a lock. Worker
+// statistics are sharded by worker id, and each shard lives on its own cache
+// line, so concurrent workers don't contend on shared counters.
+class ThunkExecutorStats {
+ public:
+  // Histograms have power-of-two buckets: bucket `i > 0` counts values in
+  // the [2^(i-1), 2^i) nanoseconds range, and the last bucket counts all
+  // values larger than that.
+  static constexpr size_t kNumBuckets = 32;
+
+  // Maximum number of worker shards. Workers with ids larger than that share
+  // shards with other workers.
+  static constexpr size_t kMaxWorkers = 64;
+
+  struct HistogramSnapshot {
+    int64_t count = 0;
+    int64_t sum_ns = 0;
+    int64_t max_ns = 0;
+    std::array<int64_t, kNumBuckets> buckets = {};
+  };
+
+  struct ThunkSnapshot {
+    HistogramSnapshot wall_time;
+    HistogramSnapshot queue_delay;
+  };
+
+  struct WorkerSnapshot {
+    // Worker shard, which is the worker id modulo `kMaxWorkers`.
+    int64_t worker_id = 0;
+    HistogramSnapshot wall_time;
+  };
+
+  struct Snapshot {
+    // Indexed by the thunk index in the thunk sequence.
+    std::vector<ThunkSnapshot> thunks;
+    // Only workers that executed at least one thunk.
+    std::vector<WorkerSnapshot> workers;
+  };
+
+  explicit ThunkExecutorStats(size_t num_thunks);
+
+  // Records execution of the thunk at `thunk_index` by the current thread.
+  void Record(size_t thunk_index, int64_t wall_time_ns, int64_t queue_delay_ns);
+
+  Snapshot GetSnapshot() const;
+  void Reset();
+
+  // Returns a monotonic clock timestamp in nanoseconds.
+  static int64_t NowNanos();
+
+  // Returns a process-wide unique id of the current thread, assigned on the
+  // first call from that thread.
+  static int64_t CurrentWorkerId();
+
+  // Returns the histogram bucket for a value.
+  static size_t BucketIndex(int64_t value_ns);
+
+ private:
+  static constexpr size_t kCacheLineSize =
+#if defined(__cpp_lib_hardware_interference_size)
+      std::hardware_destructive_interference_size;
+#else
+      64;
+#endif
+
+  class Histogram {
+   public:
+    void Record(int64_t value_ns);
+    HistogramSnapshot GetSnapshot() const;
+    void Reset();
+
+   private:
+    std::atomic<int64_t> count_{0};
+    std::atomic<int64_t> sum_ns_{0};
+    std::atomic<int64_t> max_ns_{0};
+    std::array<std::atomic<int64_t>, kNumBuckets> buckets_ = {};
+  };
+
+  struct ThunkStats {
+    Histogram wall_time;
+    Histogram queue_delay;
+  };
+
+  struct alignas(kCacheLineSize) WorkerStats {
+    Histogram wall_time;
+  };
+
+  absl::FixedArray<ThunkStats> thunks_;
+  std::array<WorkerStats, kMaxWorkers> workers_;
+};
+
+}  // namespace xla::cpu
+
+#endif  // XLA_BACKENDS_CPU_RUNTIME_THUNK_EXECUTOR_STATS_H_
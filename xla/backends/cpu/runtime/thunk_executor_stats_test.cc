@@ -0,0 +1,96 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/cpu/runtime/thunk_executor_stats.h"
+
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "tsl/platform/test.h"
+
+namespace xla::cpu {
+namespace {
+
+TEST(ThunkExecutorStatsTest, BucketIndex) {
+  EXPECT_EQ(ThunkExecutorStats::BucketIndex(-1), 0);
+  EXPECT_EQ(ThunkExecutorStats::BucketIndex(0), 0);
+  EXPECT_EQ(ThunkExecutorStats::BucketIndex(1), 1);
+  EXPECT_EQ(ThunkExecutorStats::BucketIndex(2), 2);
+  EXPECT_EQ(ThunkExecutorStats::BucketIndex(3), 2);
+  EXPECT_EQ(ThunkExecutorStats::BucketIndex(1024), 11);
+  EXPECT_EQ(ThunkExecutorStats::BucketIndex(int64_t{1} << 62),
+            ThunkExecutorStats::kNumBuckets - 1);
+}
+
+TEST(ThunkExecutorStatsTest, Record) {
+  ThunkExecutorStats stats(/*num_thunks=*/2);
+  stats.Record(0, /*wall_time_ns=*/100, /*queue_delay_ns=*/10);
+  stats.Record(0, /*wall_time_ns=*/300, /*queue_delay_ns=*/0);
+  stats.Record(1, /*wall_time_ns=*/5, /*queue_delay_ns=*/7);
+
+  ThunkExecutorStats::Snapshot snapshot = stats.GetSnapshot();
+  ASSERT_EQ(snapshot.thunks.size(), 2);
+
+  const auto& wall_time = snapshot.thunks[0].wall_time;
+  EXPECT_EQ(wall_time.count, 2);
+  EXPECT_EQ(wall_time.sum_ns, 400);
+  EXPECT_EQ(wall_time.max_ns, 300);
+  EXPECT_EQ(wall_time.buckets[ThunkExecutorStats::BucketIndex(100)], 1);
+  EXPECT_EQ(wall_time.buckets[ThunkExecutorStats::BucketIndex(300)], 1);
+
+  const auto& queue_delay = snapshot.thunks[0].queue_delay;
+  EXPECT_EQ(queue_delay.count, 2);
+  EXPECT_EQ(queue_delay.sum_ns, 10);
+  EXPECT_EQ(queue_delay.buckets[0], 1);
+
+  EXPECT_EQ(snapshot.thunks[1].wall_time.max_ns, 5);
+  EXPECT_EQ(snapshot.thunks[1].queue_delay.max_ns, 7);
+
+  ASSERT_EQ(snapshot.workers.size(), 1);
+  EXPECT_EQ(snapshot.workers[0].worker_id,
+            ThunkExecutorStats::CurrentWorkerId() %
+                ThunkExecutorStats::kMaxWorkers);
+  EXPECT_EQ(snapshot.workers[0].wall_time.count, 3);
+}
+
+TEST(ThunkExecutorStatsTest, RecordConcurrently) {
+  static constexpr int kNumThreads = 4;
+  static constexpr int kNumRecords = 1000;
+
+  ThunkExecutorStats stats(/*num_thunks=*/1);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < kNumRecords; ++j) stats.Record(0, j, 1);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  ThunkExecutorStats::Snapshot snapshot = stats.GetSnapshot();
+  EXPECT_EQ(snapshot.thunks[0].wall_time.count, kNumThreads * kNumRecords);
+  EXPECT_EQ(snapshot.thunks[0].wall_time.max_ns, kNumRecords - 1);
+  EXPECT_EQ(snapshot.thunks[0].queue_delay.sum_ns, kNumThreads * kNumRecords);
+
+  int64_t num_worker_records = 0;
+  for (const auto& worker : snapshot.workers) {
+    num_worker_records += worker.wall_time.count;
+  }
+  EXPECT_EQ(num_worker_records, kNumThreads * kNumRecords);
+}
+
+}  // namespace
+}  // namespace xla::cpu
@@ -33,6 +33,7 @@ limitations under the License.
 #include "xla/backends/cpu/runtime/buffer_allocations.h"
 #include "xla/backends/cpu/runtime/resource_use.h"
 #include "xla/backends/cpu/runtime/thunk.h"
+#include "xla/backends/cpu/runtime/thunk_executor_stats.h"
 #include "xla/runtime/buffer_use.h"
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/maybe_owning_device_memory.h"
@@ -274,6 +275,72 @@ TEST(ThunkExecutorTest, FifoReadyQueueTest) {
   EXPECT_EQ(half2.Pop(), 5);
 }
 
+TEST(ThunkExecutorTest, LifoReadyQueueTest) {
+  ThunkExecutor::LifoReadyQueue queue({});
+
+  // Check basic queue properties.
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(queue.Size(), 0);
+
+  queue.Push(1);
+  queue.Push(2);
+  queue.Push(3);
+
+  EXPECT_EQ(queue.Size(), 3);
+
+  EXPECT_EQ(queue.Pop(), 3);
+  EXPECT_EQ(queue.Pop(), 2);
+  EXPECT_EQ(queue.Pop(), 1);
+
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(queue.Size(), 0);
+
+  // Prepare queue for PopHalf test case.
+  queue.Push(1);
+  queue.Push(2);
+  queue.Push(3);
+
+  // Pop half of the queue from the front.
+  ThunkExecutor::LifoReadyQueue half0 = queue.PopHalf();
+  EXPECT_EQ(half0.Size(), 2);
+  EXPECT_EQ(half0.Pop(), 2);
+  EXPECT_EQ(half0.Pop(), 1);
+
+  // Check that the most recently pushed node is still in the queue.
+  EXPECT_EQ(queue.Size(), 1);
+
+  // Pop the rest of the queue.
+  ThunkExecutor::LifoReadyQueue half1 = queue.PopHalf();
+  EXPECT_EQ(half1.Size(), 1);
+  EXPECT_EQ(half1.Pop(), 3);
+
+  // Check that all nodes were returned from PopHalf.
+  EXPECT_EQ(queue.Size(), 0);
+
+  // Add 5 elements to test Pop followed by PopHalf.
+  queue.Push(1);
+  queue.Push(2);
+  queue.Push(3);
+  queue.Push(4);
+  queue.Push(5);
+
+  EXPECT_EQ(queue.Pop(), 5);
+
+  // Check that PopHalf returns 2 first nodes.
+  ThunkExecutor::LifoReadyQueue half2 = queue.PopHalf();
+  EXPECT_EQ(half2.Size(), 2);
+  EXPECT_EQ(half2.Pop(), 2);
+  EXPECT_EQ(half2.Pop(), 1);
+
+  // Check that remaining nodes are popped in LIFO order.
+  queue.Push(6);
+  EXPECT_EQ(queue.Size(), 3);
+  EXPECT_EQ(queue.Pop(), 6);
+  EXPECT_EQ(queue.Pop(), 4);
+  EXPECT_EQ(queue.Pop(), 3);
+  EXPECT_TRUE(queue.Empty());
+}
+
 TEST(ThunkExecutorTest, PriorityReadyQueueTest) {
   std::vector<ThunkExecutor::NodeDef> nodes_defs(16);
   for (size_t i = 0; i < nodes_defs.size(); ++i) {
@@ -477,6 +544,101 @@ TEST(ThunkExecutorTest, Execute) {
                                 2, 2, 2, 2, 2));               // slice1
 }
 
+TEST(ThunkExecutorTest, ExecuteRepeatedly) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/80, /*color=*/0);
+
+  BufferAllocation::Slice slice0(&alloc, /*offset=*/0, /*size=*/40);
+  BufferAllocation::Slice slice1(&alloc, /*offset=*/40, /*size=*/40);
+  BufferAllocation::Slice slice2(&alloc, /*offset=*/20, /*size=*/40);
+
+  std::vector<std::string> trace;
+
+  ThunkSequence sequence;
+  sequence.push_back(AddI32Thunk::Create("a", {slice0}, {slice0}, &trace));
+  sequence.push_back(AddI32Thunk::Create("b", {slice1}, {slice1}, &trace));
+  sequence.push_back(AddI32Thunk::Create("c", {slice2}, {slice2}, &trace));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      ThunkExecutor executor,
+      ThunkExecutor::Create(std::move(sequence), OptionsForTest()));
+  ASSERT_FALSE(executor.is_sequential());
+
+  // Every execution after the first one reuses the execute state of the
+  // previous one, and must see all node counters reset.
+  for (int i = 0; i < 3; ++i) {
+    trace.clear();
+    std::vector<int32_t> data(20, 1);  // shared src and dst allocation
+
+    auto buffers = AddI32Thunk::AsDeviceMemory({&data});
+    BufferAllocations allocations(buffers);
+
+    Thunk::ExecuteParams params = {nullptr, &allocations};
+
+    auto execute_event = executor.Execute(params);
+
+    tsl::BlockUntilReady(execute_event);
+    ASSERT_TRUE(execute_event.IsConcrete());
+
+    EXPECT_THAT(trace, ElementsAre("a", "b", "c"));
+    EXPECT_THAT(data, ElementsAre(2, 2, 2, 2, 2,                 // slice0
+                                  4, 4, 4, 4, 4, 4, 4, 4, 4, 4,  // slice2
+                                  2, 2, 2, 2, 2));               // slice1
+  }
+}
+
+TEST(ThunkExecutorTest, ExecuteWithStats) {
+  BufferAllocation alloc(/*index=*/0, /*size=*/80, /*color=*/0);
+
+  BufferAllocation::Slice slice0(&alloc, /*offset=*/0, /*size=*/40);
+  BufferAllocation::Slice slice1(&alloc, /*offset=*/40, /*size=*/40);
+  BufferAllocation::Slice slice2(&alloc, /*offset=*/20, /*size=*/40);
+
+  ThunkSequence sequence;
+  sequence.push_back(AddI32Thunk::Create("a", {slice0}, {slice0}));
+  sequence.push_back(AddI32Thunk::Create("b", {slice1}, {slice1}));
+  sequence.push_back(AddI32Thunk::Create("c", {slice2}, {slice2}));
+
+  ThunkExecutor::Options options = OptionsForTest();
+  options.collect_stats = true;
+
+  TF_ASSERT_OK_AND_ASSIGN(ThunkExecutor executor,
+                          ThunkExecutor::Create(std::move(sequence), options));
+  ASSERT_NE(executor.stats(), nullptr);
+
+  std::vector<int32_t> data(20, 1);  // shared src and dst allocation
+
+  auto buffers = AddI32Thunk::AsDeviceMemory({&data});
+  BufferAllocations allocations(buffers);
+
+  Thunk::ExecuteParams params = {nullptr, &allocations};
+
+  for (int i = 0; i < 2; ++i) {
+    auto execute_event = executor.Execute(params);
+    tsl::BlockUntilReady(execute_event);
+    ASSERT_TRUE(execute_event.IsConcrete());
+  }
+
+  ThunkExecutorStats::Snapshot snapshot = executor.stats()->GetSnapshot();
+  ASSERT_EQ(snapshot.thunks.size(), 3);
+  for (const ThunkExecutorStats::ThunkSnapshot& thunk : snapshot.thunks) {
+    EXPECT_EQ(thunk.wall_time.count, 2);
+    EXPECT_EQ(thunk.queue_delay.count, 2);
+  }
+
+  // All thunks were executed in the caller thread.
+  ASSERT_EQ(snapshot.workers.size(), 1);
+  EXPECT_EQ(snapshot.workers[0].wall_time.count, 6);
+
+  executor.stats()->Reset();
+  EXPECT_EQ(executor.stats()->GetSnapshot().thunks[0].wall_time.count, 0);
+}
+
+TEST(ThunkExecutorTest, StatsDisabledByDefault) {
+  TF_ASSERT_OK_AND_ASSIGN(ThunkExecutor executor,
+                          ThunkExecutor::Create(ThunkSequence::Empty()));
+  EXPECT_EQ(executor.stats(), nullptr);
+}
+
 //===----------------------------------------------------------------------===//
 // ThunkExecutor stress testing
 //===----------------------------------------------------------------------===//
@@ -565,11 +727,12 @@ GenerateThunkSequence(size_t num_elements, size_t num_thunks,
 // and optionally uses a thread pool to execute thunk executor tasks.
 class ThunkExecutorStressTest
     : public testing::TestWithParam<
-          std::tuple<int32_t, bool, bool, SharedResourceUse, bool, bool>> {
+          std::tuple<int32_t, bool, bool, SharedResourceUse, bool,
+                     ThunkExecutor::Options::ReadyQueueType>> {
  public:
   void SetUp() override {
     auto& [num_thunks, use_task_runner, use_device, shared_resource_use,
-           inject_errors, use_priority_ready_queue] = GetParam();
+           inject_errors, ready_queue_type] = GetParam();
 
     use_task_runner_ = use_task_runner;
     use_device_ = use_device;
@@ -609,17 +772,16 @@ class ThunkExecutorStressTest
 
 TEST_P(ThunkExecutorStressTest, Execute) {
   auto [num_thunks, use_task_runner, use_device, shared_resource_use,
-        inject_errors, use_priority_ready_queue] = GetParam();
+        inject_errors, ready_queue_type] = GetParam();
 
   TF_ASSERT_OK_AND_ASSIGN(
       std::unique_ptr<GeneratedThunkSequence> g,
       GenerateThunkSequence(/*num_elements=*/1024, num_thunks,
                             shared_resource_use, inject_errors));
 
-  ThunkExecutor::Options executor_options = {
-      /*execute_sequential_buffer_threshold=*/0,
-      /*use_priority_ready_queue=*/use_priority_ready_queue,
-  };
+  ThunkExecutor::Options executor_options;
+  executor_options.execute_sequential_buffer_threshold = 0;
+  executor_options.ready_queue_type = ready_queue_type;
 
   TF_ASSERT_OK_AND_ASSIGN(
       ThunkExecutor executor,
@@ -654,7 +816,11 @@ INSTANTIATE_TEST_SUITE_P(
                                      SharedResourceUse::kAll,
                                      SharedResourceUse::kRandom),
                      /*inject_errors=*/testing::Bool(),
-                     /*use_priority_ready_queue=*/testing::Bool()));
+                     /*ready_queue_type=*/
+                     testing::Values(
+                         ThunkExecutor::Options::ReadyQueueType::kFifo,
+                         ThunkExecutor::Options::ReadyQueueType::kLifo,
+                         ThunkExecutor::Options::ReadyQueueType::kPriority)));
 
 //===----------------------------------------------------------------------===//
 // Performance benchmarks below
@@ -686,6 +852,32 @@ static void BM_FifoReadyQueuePushPopHalf(benchmark::State& state) {
   }
 }
 
+static void BM_LifoReadyQueuePushPop(benchmark::State& state) {
+  ThunkExecutor::LifoReadyQueue queue({});
+  const size_t num_push_pop = state.range(0);
+
+  for (auto _ : state) {
+    for (int i = 0; i < num_push_pop; ++i) {
+      queue.Push(i);
+    }
+    for (int i = 0; i < num_push_pop; ++i) {
+      benchmark::DoNotOptimize(queue.Pop());
+    }
+  }
+}
+
+static void BM_LifoReadyQueuePushPopHalf(benchmark::State& state) {
+  ThunkExecutor::LifoReadyQueue queue({});
+  const size_t num_push_pop = state.range(0);
+
+  for (auto _ : state) {
+    for (int i = 0; i < num_push_pop; ++i) {
+      queue.Push(i);
+    }
+    benchmark::DoNotOptimize(queue.PopHalf());
+  }
+}
+
 static void BM_PriorityReadyQueuePushPop(benchmark::State& state) {
   std::vector<ThunkExecutor::NodeDef> nodes_defs(16);
   for (size_t i = 0; i < nodes_defs.size(); ++i) {
@@ -739,6 +931,8 @@ static void BM_PriorityReadyQueuePushPopHalf(benchmark::State& state) {
 
 BENCHMARK_READY_QUEUE(BM_FifoReadyQueuePushPop);
 BENCHMARK_READY_QUEUE(BM_FifoReadyQueuePushPopHalf);
+BENCHMARK_READY_QUEUE(BM_LifoReadyQueuePushPop);
+BENCHMARK_READY_QUEUE(BM_LifoReadyQueuePushPopHalf);
 BENCHMARK_READY_QUEUE(BM_PriorityReadyQueuePushPop);
 BENCHMARK_READY_QUEUE(BM_PriorityReadyQueuePushPopHalf);
 
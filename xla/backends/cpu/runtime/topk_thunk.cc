@@ -15,12 +15,16 @@ limitations under the License.
 
 #include "xla/backends/cpu/runtime/topk_thunk.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <utility>
 
+#include "absl/base/optimization.h"
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
+#include "xla/backends/cpu/runtime/concurrency.h"
 #include "xla/backends/cpu/runtime/thunk.h"
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/cpu/runtime_topk.h"
@@ -30,6 +34,9 @@ limitations under the License.
 
 namespace xla::cpu {
 
+// TopK operations with fewer values than this run in the caller thread.
+static constexpr int64_t kMinParallelTopKElements = 1 << 15;
+
 TopKThunk::TopKThunk(Info info, BufferAllocation::Slice values,
                      BufferAllocation::Slice output,
                      BufferAllocation::Slice indices, int64_t batch_size,
@@ -62,11 +69,41 @@ tsl::AsyncValueRef<Thunk::ExecuteEvent> TopKThunk::Execute(
       se::DeviceMemoryBase indices,
       params.buffer_allocations->GetDeviceAddress(indices_buffer_));
 
-  __xla_cpu_runtime_TopKF32(batch_size_, input_size_, k_,
-                            reinterpret_cast<const float*>(values.opaque()),
-                            reinterpret_cast<float*>(output.opaque()),
-                            reinterpret_cast<int32_t*>(indices.opaque()));
-  return OkExecuteEvent();
+  const float* values_data = reinterpret_cast<const float*>(values.opaque());
+  float* output_data = reinterpret_cast<float*>(output.opaque());
+  int32_t* indices_data = reinterpret_cast<int32_t*>(indices.opaque());
+
+  if (ABSL_PREDICT_TRUE(params.intra_op_threadpool == nullptr ||
+                        batch_size_ == 1 ||
+                        batch_size_ * input_size_ < kMinParallelTopKElements)) {
+    __xla_cpu_runtime_TopKF32(batch_size_, input_size_, k_, values_data,
+                              output_data, indices_data);
+    return OkExecuteEvent();
+  }
+
+  // Use intra-op thread pool to compute blocks of batch rows in parallel.
+  int64_t num_tasks = std::min<int64_t>(
+      batch_size_, params.intra_op_threadpool->numThreads());
+
+  auto event = tsl::MakeConstructedAsyncValueRef<ExecuteEvent>();
+  auto counter = std::make_shared<std::atomic<int64_t>>(num_tasks);
+
+  auto execute = [this, event, counter, num_tasks, values_data, output_data,
+                  indices_data](int64_t task) {
+    int64_t start = task * batch_size_ / num_tasks;
+    int64_t end = (task + 1) * batch_size_ / num_tasks;
+    __xla_cpu_runtime_TopKF32(end - start, input_size_, k_,
+                              values_data + start * input_size_,
+                              output_data + start * k_,
+                              indices_data + start * k_);
+
+    if (counter->load() == 1 || counter->fetch_sub(1) == 1) {
+      event.SetStateConcrete();
+    }
+  };
+
+  ScheduleAll(params.intra_op_threadpool, num_tasks, std::move(execute));
+  return event;
 }
 
 }  // namespace xla::cpu
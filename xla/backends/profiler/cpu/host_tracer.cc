@@ -41,7 +41,7 @@ namespace {
 // Thread-safety: This class is go/thread-compatible.
 class HostTracer : public tsl::profiler::ProfilerInterface {
  public:
-  explicit HostTracer(int host_trace_level);
+  HostTracer(int host_trace_level, int sampling_period);
   ~HostTracer() override;
 
   absl::Status Start() override;  // TENSORFLOW_STATUS_OK
@@ -55,6 +55,9 @@ class HostTracer : public tsl::profiler::ProfilerInterface {
   // Level of host tracing.
   const int host_trace_level_;
 
+  // Only one in sampling_period complete events is recorded.
+  const int sampling_period_;
+
   // True if currently recording.
   bool recording_ = false;
 
@@ -65,8 +68,8 @@ class HostTracer : public tsl::profiler::ProfilerInterface {
   tsl::profiler::TraceMeRecorder::Events events_;
 };
 
-HostTracer::HostTracer(int host_trace_level)
-    : host_trace_level_(host_trace_level) {}
+HostTracer::HostTracer(int host_trace_level, int sampling_period)
+    : host_trace_level_(host_trace_level), sampling_period_(sampling_period) {}
 
 HostTracer::~HostTracer() { Stop().IgnoreError(); }  // NOLINT
 
@@ -79,7 +82,8 @@ absl::Status HostTracer::Start() {  // TENSORFLOW_STATUS_OK
   // start_timestamp_ns_ to prevent timestamp underflow in XPlane.
   // Therefore this have to be done before TraceMeRecorder::Start.
   start_timestamp_ns_ = tsl::profiler::GetCurrentTimeNanos();
-  recording_ = tsl::profiler::TraceMeRecorder::Start(host_trace_level_);
+  recording_ = tsl::profiler::TraceMeRecorder::Start(host_trace_level_,
+                                                     sampling_period_);
   if (!recording_) {
     return tsl::errors::Internal("Failed to start TraceMeRecorder");
   }
@@ -118,7 +122,8 @@ std::unique_ptr<tsl::profiler::ProfilerInterface> CreateHostTracer(
     const HostTracerOptions& options) {
   if (options.trace_level == 0) return nullptr;
   std::vector<std::unique_ptr<tsl::profiler::ProfilerInterface>> profilers;
-  profilers.push_back(std::make_unique<HostTracer>(options.trace_level));
+  profilers.push_back(std::make_unique<HostTracer>(options.trace_level,
+                                                 options.sampling_period));
   profilers.push_back(
       std::make_unique<tsl::profiler::ThreadpoolProfilerInterface>());
   return std::make_unique<tsl::profiler::ProfilerCollection>(
@@ -32,6 +32,11 @@ struct HostTracerOptions {
   // - Level 3 enables tracing of all level 2 TraceMe(s) and more verbose
   //           (low-level) program execution details (cheap TF ops, etc).
   int trace_level = 2;
+
+  // If greater than 1, only one in sampling_period complete TraceMe events of
+  // every thread is recorded. This keeps the overhead of long running, always
+  // on host tracing low at the cost of an incomplete timeline.
+  int sampling_period = 1;
 };
 
 std::unique_ptr<tsl::profiler::ProfilerInterface> CreateHostTracer(
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "xla/backends/profiler/gpu/cupti_buffer_events.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 #include "absl/strings/str_cat.h"
 #include "third_party/gpus/cuda/include/cuda.h"
 #include "xla/backends/profiler/gpu/cupti_interface.h"
@@ -571,6 +576,37 @@ CuptiActivityBufferManager::ActivityBufferAndSize::ActivityBufferAndSize(
              }),
       size(sz) {}
 
+CuptiActivityBufferManager::CuptiActivityBufferManager(
+    size_t buffer_size_in_bytes, size_t num_preallocated_buffers,
+    size_t max_buffers)
+    : buffer_pool_(buffer_size_in_bytes), max_buffers_(max_buffers) {
+  if (max_buffers_ > 0) {
+    num_preallocated_buffers = std::min(num_preallocated_buffers, max_buffers_);
+  }
+  std::vector<uint8_t *> buffers;
+  buffers.reserve(num_preallocated_buffers);
+  for (size_t i = 0; i < num_preallocated_buffers; ++i) {
+    uint8_t *buffer = buffer_pool_.GetOrCreateBuffer();
+    if (buffer == nullptr) break;
+    buffers.push_back(buffer);
+  }
+  for (uint8_t *buffer : buffers) buffer_pool_.ReclaimBuffer(buffer);
+}
+
+uint8_t *CuptiActivityBufferManager::GetOrCreateBuffer() {
+  size_t in_use = num_buffers_in_use_.fetch_add(1, std::memory_order_relaxed);
+  if (max_buffers_ > 0 && in_use >= max_buffers_) {
+    num_buffers_in_use_.fetch_sub(1, std::memory_order_relaxed);
+    num_refused_buffers_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  uint8_t *buffer = buffer_pool_.GetOrCreateBuffer();
+  if (buffer == nullptr) {
+    num_buffers_in_use_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  return buffer;
+}
+
 void AddActivityBufferListEventsTo(
     CuptiEventCollectorDelegate &collector,
     std::list<CuptiActivityBufferManager::ActivityBufferAndSize> &buffer_list,
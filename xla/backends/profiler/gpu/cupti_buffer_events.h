@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef XLA_BACKENDS_PROFILER_GPU_CUPTI_BUFFER_EVENTS_H_
 #define XLA_BACKENDS_PROFILER_GPU_CUPTI_BUFFER_EVENTS_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -308,14 +309,22 @@ class CuptiActivityBufferManager {
     explicit ActivityBufferAndSize(uint8_t* p = nullptr, size_t sz = 0);
   };
 
-  explicit CuptiActivityBufferManager(size_t buffer_size_in_bytes)
-      : buffer_pool_(buffer_size_in_bytes) {}
+  // Preallocates `num_preallocated_buffers` buffers, so that CUPTI requests
+  // made while tracing do not have to allocate memory. If `max_buffers` is
+  // not zero, at most `max_buffers` buffers are handed out to CUPTI or cached
+  // for decoding at any time, GetOrCreateBuffer returns nullptr beyond that.
+  explicit CuptiActivityBufferManager(size_t buffer_size_in_bytes,
+                                      size_t num_preallocated_buffers = 0,
+                                      size_t max_buffers = 0);
 
   size_t GetBufferSizeInBytes() { return buffer_pool_.GetBufferSizeInBytes(); }
 
-  uint8_t* GetOrCreateBuffer() { return buffer_pool_.GetOrCreateBuffer(); }
+  uint8_t* GetOrCreateBuffer();
 
-  void ReclaimBuffer(uint8_t* p) { buffer_pool_.ReclaimBuffer(p); }
+  void ReclaimBuffer(uint8_t* p) {
+    buffer_pool_.ReclaimBuffer(p);
+    num_buffers_in_use_.fetch_sub(1, std::memory_order_relaxed);
+  }
 
   void CacheCuptiFilledActivityBuffer(uint8_t* p, size_t sz) {
     tsl::mutex_lock lock(buffer_mutex_);
@@ -324,13 +333,26 @@ class CuptiActivityBufferManager {
 
   std::list<ActivityBufferAndSize> PopCachedBuffers() {
     std::list<ActivityBufferAndSize> result;
-    tsl::mutex_lock lock(buffer_mutex_);
-    std::swap(result, cached_buffers_);
+    {
+      tsl::mutex_lock lock(buffer_mutex_);
+      std::swap(result, cached_buffers_);
+    }
+    // Popped buffers are owned by the caller and no longer count against the
+    // budget.
+    num_buffers_in_use_.fetch_sub(result.size(), std::memory_order_relaxed);
     return result;
   }
 
+  // Number of buffer requests refused because the budget was exhausted.
+  size_t NumRefusedBuffers() const {
+    return num_refused_buffers_.load(std::memory_order_relaxed);
+  }
+
  private:
   tsl::profiler::BufferPool buffer_pool_;
+  const size_t max_buffers_;
+  std::atomic<size_t> num_buffers_in_use_ = 0;
+  std::atomic<size_t> num_refused_buffers_ = 0;
   tsl::mutex buffer_mutex_;
   std::list<ActivityBufferAndSize> cached_buffers_ TF_GUARDED_BY(buffer_mutex_);
 };
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "xla/backends/profiler/gpu/cupti_buffer_events.h"
 
+#include <cstdint>
+
 #include "tsl/platform/test.h"
 
 namespace xla {
@@ -58,6 +60,32 @@ TEST(CuptiBufferEventsTest, EventInitialization) {
   EXPECT_EQ(event.graph_id, 5);
 }
 
+TEST(CuptiActivityBufferManagerTest, RefusesBuffersOverBudget) {
+  CuptiActivityBufferManager manager(/*buffer_size_in_bytes=*/1024,
+                                     /*num_preallocated_buffers=*/1,
+                                     /*max_buffers=*/2);
+  uint8_t* first = manager.GetOrCreateBuffer();
+  uint8_t* second = manager.GetOrCreateBuffer();
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(manager.GetOrCreateBuffer(), nullptr);
+  EXPECT_EQ(manager.NumRefusedBuffers(), 1);
+
+  // A reclaimed buffer is reused and cached buffers count against the budget
+  // until they are popped.
+  manager.ReclaimBuffer(first);
+  EXPECT_EQ(manager.GetOrCreateBuffer(), first);
+  manager.CacheCuptiFilledActivityBuffer(second, 0);
+  EXPECT_EQ(manager.GetOrCreateBuffer(), nullptr);
+  EXPECT_EQ(manager.PopCachedBuffers().size(), 1);
+  uint8_t* third = manager.GetOrCreateBuffer();
+  EXPECT_NE(third, nullptr);
+  EXPECT_EQ(manager.NumRefusedBuffers(), 2);
+
+  manager.ReclaimBuffer(first);
+  manager.ReclaimBuffer(third);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace profiler
@@ -1041,8 +1041,10 @@ void CuptiTracer::Disable() {
       GatherCallbackAnnotationsAndEvents(/*stop_recording=*/true),
       IsCallbackApiEventsRequired());
 
+  size_t num_refused_activity_buffers = 0;
   if (activity_buffers_) {
     auto cached_buffers = activity_buffers_->PopCachedBuffers();
+    num_refused_activity_buffers = activity_buffers_->NumRefusedBuffers();
     activity_buffers_.reset();
     collector_->OnTracerCachedActivityBuffers(std::move(cached_buffers));
   }
@@ -1055,6 +1057,11 @@ void CuptiTracer::Disable() {
     collector_->OnEventsDropped("Activity Event dropped in dropped buffer:",
                                 num_activity_events_in_dropped_buffer_);
   }
+  if (num_refused_activity_buffers > 0) {
+    collector_->OnEventsDropped(
+        "Activity buffer requests refused over the buffer budget:",
+        num_refused_activity_buffers);
+  }
 
   collector_->Flush();
   collector_ = nullptr;
@@ -1362,7 +1369,7 @@ void CuptiTracer::ConfigureActivityUnifiedMemoryCounter(bool enable) {
 void CuptiTracer::RequestActivityBuffer(uint8_t **buffer, size_t *size) {
   *buffer = activity_buffers_->GetOrCreateBuffer();
   if (*buffer == nullptr) {
-    LOG(WARNING)
+    LOG_EVERY_N(WARNING, 1000)
         << "CUPTI Buffer not allocated, activity records will be dropped";
     *size = 0;
     return;
@@ -1472,8 +1479,9 @@ void CuptiTracer::PrepareCallbackStart() {
 }
 
 void CuptiTracer::PrepareActivityStart() {
-  activity_buffers_ =
-      std::make_unique<CuptiActivityBufferManager>(kBufferSizeInBytes);
+  activity_buffers_ = std::make_unique<CuptiActivityBufferManager>(
+      kBufferSizeInBytes, option_->num_preallocated_activity_buffers,
+      option_->max_activity_buffers);
   cupti_dropped_activity_event_count_ = 0;
   num_activity_events_in_cached_buffer_ = 0;
   num_activity_events_in_dropped_buffer_ = 0;
@@ -48,6 +48,13 @@ struct CuptiTracerOptions {
   bool sync_devices_before_stop = false;
   // Whether to enable NVTX tracking, we need this for TensorRT tracking.
   bool enable_nvtx_tracking = false;
+  // Number of activity buffers allocated before tracing starts, so that CUPTI
+  // buffer requests are served from the pool instead of the allocator.
+  size_t num_preallocated_activity_buffers = 0;
+  // Maximum number of activity buffers handed out to CUPTI or waiting to be
+  // decoded at any time. CUPTI drops activity records while the budget is
+  // exhausted, the drops are reported to the collector. Zero means unlimited.
+  size_t max_activity_buffers = 0;
 };
 
 class CuptiTracer;
@@ -89,6 +89,11 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_cpu_enable_concurrency_optimized_scheduler(false);
   opts.set_xla_cpu_prefer_vector_width(256);
   opts.set_xla_cpu_max_isa("");
+  opts.set_xla_cpu_jit_cache_dir("");
+  opts.set_xla_cpu_parallel_task_profile_path("");
+  opts.set_xla_cpu_enable_thunk_stats(false);
+  opts.set_xla_cpu_parallel_first_touch_min_bytes(0);
+  opts.set_xla_cpu_huge_page_min_bytes(0);
 
   opts.set_xla_cpu_enable_fast_math(false);
   // Disable forms of fast math that have caused users problems in the past.
@@ -156,6 +161,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_enable_nccl_per_stream_comms(false);
 
   opts.set_xla_gpu_temp_buffer_use_separate_color(false);
+  opts.set_xla_gpu_enable_persistent_temp_buffers(false);
 
   // Set 4GB space limit for redzone scratch allocator.
   opts.set_xla_gpu_redzone_scratch_max_megabytes(1LL << 12);
@@ -207,6 +213,8 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_exhaustive_tiling_search(false);
 
   opts.set_xla_gpu_enable_priority_fusion(true);
+  opts.set_xla_gpu_priority_fusion_max_candidates_per_round(1);
+  opts.set_xla_gpu_experimental_performance_model_cache_file("");
   opts.set_xla_gpu_experimental_enable_triton_softmax_priority_fusion(false);
 
   opts.set_xla_gpu_auto_spmd_partitioning_memory_budget_gb(0);
@@ -265,6 +273,26 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_gemm_rewrite_size_threshold(kDefaultMinGemmRewriteSize);
 
   opts.set_xla_gpu_use_memcpy_local_p2p(false);
+  opts.set_xla_gpu_one_shot_all_reduce_max_bytes(0);
+  opts.set_xla_gpu_enable_parallel_nccl_clique_acquisition(false);
+  opts.set_xla_gpu_enable_auto_combine_threshold(false);
+  opts.set_xla_gpu_collective_compression_type("");
+  opts.set_xla_gpu_collective_compression_min_bytes(1024 * 1024);
+  opts.set_xla_gpu_collective_compression_error_feedback(true);
+  opts.set_xla_gpu_hierarchical_collectives_min_bytes(0);
+  opts.set_xla_gpu_enable_triton_gemm_atomic_split_k(false);
+  opts.set_xla_gpu_enable_triton_attention(false);
+  opts.set_xla_gpu_enable_triton_grouped_gemm(false);
+  opts.set_xla_gpu_persistent_grid_min_waves(0);
+  opts.set_xla_gpu_cubin_cache_dir("");
+  opts.set_xla_gpu_split_llvm_module_by_cost(true);
+  opts.set_xla_gpu_enable_pipelined_host_offloading(false);
+  opts.set_xla_gpu_host_offload_max_slice_bytes(0);
+  opts.set_xla_gpu_cudnn_graph_cache_dir("");
+  opts.set_xla_gpu_autotune_max_devices(0);
+  opts.set_xla_gpu_autotune_successive_halving(false);
+  opts.set_xla_gpu_enable_sparse_weight_compression(false);
+  opts.set_xla_dump_async(false);
 
   opts.set_xla_reduce_window_rewrite_base_length(16);
 
@@ -900,6 +928,43 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "use newer instructions. Available values: SSE4_2, AVX, AVX2, AVX512, "
       "AVX512_VNNI, AVX512_BF16, AMX, and AMX_FP16. (`AMX` will enable both "
       "`AMX_BF16` and `AMX_INT8` instructions.)"));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_jit_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_cpu_jit_cache_dir),
+      debug_options->xla_cpu_jit_cache_dir(),
+      "Experimental: Maintain a persistent cache of XLA:CPU compiled object "
+      "files in the given directory. XLA will load compiled executables from "
+      "the cache instead of running LLVM code generation when possible, and "
+      "will write new compilation results to the cache. Cache invalidation has "
+      "to be handled by the user."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_task_profile_path",
+      string_setter_for(&DebugOptions::set_xla_cpu_parallel_task_profile_path),
+      debug_options->xla_cpu_parallel_task_profile_path(),
+      "Path to a text or binary ProfiledInstructionsProto with per-instruction "
+      "timings from earlier runs. XLA:CPU uses the measured timings to pick "
+      "the number of parallel tasks of the profiled instructions."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_enable_thunk_stats",
+      bool_setter_for(&DebugOptions::set_xla_cpu_enable_thunk_stats),
+      debug_options->xla_cpu_enable_thunk_stats(),
+      "Record per-thunk wall time and queueing delay histograms in XLA:CPU "
+      "thunk executors."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_first_touch_min_bytes",
+      int64_setter_for(
+          &DebugOptions::set_xla_cpu_parallel_first_touch_min_bytes),
+      debug_options->xla_cpu_parallel_first_touch_min_bytes(),
+      "If positive, XLA:CPU touches the pages of temporary allocations of at "
+      "least this many bytes from the intra-op thread pool before execution, "
+      "to spread them across NUMA nodes. 0 disables it."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_huge_page_min_bytes",
+      int64_setter_for(&DebugOptions::set_xla_cpu_huge_page_min_bytes),
+      debug_options->xla_cpu_huge_page_min_bytes(),
+      "If positive, XLA:CPU advises the kernel to back buffer allocations, "
+      "constants and JIT data sections of at least this many bytes with "
+      "transparent huge pages. 0 disables it."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_crash_on_verification_failures",
       bool_setter_for(
@@ -993,6 +1058,11 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
                 "optimizations. debug_options are written to the --xla_dump_to "
                 "dir, or, if no dir is specified, to stdout. Ignored unless "
                 "xla_dump_hlo_as_text is true."));
+  flag_list->push_back(tsl::Flag(
+      "xla_dump_async", bool_setter_for(&DebugOptions::set_xla_dump_async),
+      debug_options->xla_dump_async(),
+      "Render and write HLO module dumps in text, proto and graph formats on "
+      "a background thread pool instead of on the compiling thread."));
   flag_list->push_back(
       tsl::Flag("xla_dump_hlo_as_proto",
                 bool_setter_for(&DebugOptions::set_xla_dump_hlo_as_proto),
@@ -1200,7 +1270,9 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "`WHILE_LOOP_UNROLLING_DOUBLE_BUFFER` unrolls the loop by factor of 2, "
       "`WHILE_LOOP_UNROLLING_FULL_UNROLL` will unroll the entire loop "
       "`WHILE_LOOP_UNROLLING_AUTO_UNROLL` unrolls by a factor of 2, if there is"
-      " any collective present within a while loop."));
+      " any collective present within a while loop, "
+      "`WHILE_LOOP_UNROLLING_PARTIAL_UNROLL` unrolls loops with small bodies "
+      "by a factor chosen from the body size."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_all_reduce_combine_threshold_bytes",
       int64_setter_for(
@@ -1417,6 +1489,15 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "Enables temp User Buffer Registration. Enable this flag will use a "
       "separate cuda async memory allocator to allocate temp buffer, this will "
       "allocate temp buffer to the fixed address on every iteration"));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_persistent_temp_buffers",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_persistent_temp_buffers),
+      debug_options->xla_gpu_enable_persistent_temp_buffers(),
+      "Keeps the temp buffers of a GPU executable alive across executions on "
+      "the same stream, so that consecutive runs skip the allocator and see "
+      "stable temp buffer addresses. Cached buffers are released when the "
+      "device runs out of memory."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_enable_nccl_comm_splitting",
       bool_setter_for(&DebugOptions::set_xla_gpu_enable_nccl_comm_splitting),
@@ -1614,6 +1695,23 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       bool_setter_for(&DebugOptions::set_xla_gpu_enable_priority_fusion),
       debug_options->xla_gpu_enable_priority_fusion(),
       "Enable priority queue for fusion order."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_priority_fusion_max_candidates_per_round",
+      int32_setter_for(
+          &DebugOptions::set_xla_gpu_priority_fusion_max_candidates_per_round),
+      debug_options->xla_gpu_priority_fusion_max_candidates_per_round(),
+      "Maximum number of non-interfering producers fused by priority fusion "
+      "before priorities are recomputed. Larger values reduce compile time, "
+      "but can change fusion decisions compared to the exact greedy order."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_experimental_performance_model_cache_file",
+      string_setter_for(
+          &DebugOptions::set_xla_gpu_experimental_performance_model_cache_file),
+      debug_options->xla_gpu_experimental_performance_model_cache_file(),
+      "Experimental: Maintain a persistent cache of GPU performance model "
+      "estimates used by priority fusion in the given file, so that "
+      "compilations of similar modules can reuse them. Cache invalidation has "
+      "to be handled by the user."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_experimental_enable_triton_softmax_priority_fusion",
       bool_setter_for(
@@ -1871,6 +1969,156 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       bool_setter_for(&DebugOptions::set_xla_gpu_use_memcpy_local_p2p),
       debug_options->xla_gpu_use_memcpy_local_p2p(),
       "Whether to use memcpy for local p2p communication."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_one_shot_all_reduce_max_bytes",
+      int64_setter_for(
+          &DebugOptions::set_xla_gpu_one_shot_all_reduce_max_bytes),
+      debug_options->xla_gpu_one_shot_all_reduce_max_bytes(),
+      "If positive, all-reduce operations with operands of up to this many "
+      "bytes are executed with a one-shot all-reduce kernel instead of NCCL "
+      "when all participants are local devices with peer access. A good "
+      "value for NVLink connected GPUs is 262144 (256KiB)."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_parallel_nccl_clique_acquisition",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_parallel_nccl_clique_acquisition),
+      debug_options->xla_gpu_enable_parallel_nccl_clique_acquisition(),
+      "Whether to initialize independent NCCL communicators (cliques that "
+      "can't be split from already acquired cliques) concurrently."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_collective_topology",
+      string_setter_for(&DebugOptions::set_xla_gpu_collective_topology),
+      debug_options->xla_gpu_collective_topology(),
+      "Description of the collective fabric used by the latency estimators "
+      "and collective combiners, as a comma-separated list of key=value "
+      "pairs: devices_per_node, intra_node_bw and inter_node_bw (per device "
+      "GB/s), intra_node_latency_us and inter_node_latency_us. For example: "
+      "devices_per_node=8,intra_node_bw=150,inter_node_bw=25."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_auto_combine_threshold",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_auto_combine_threshold),
+      debug_options->xla_gpu_enable_auto_combine_threshold(),
+      "If true, picks all-reduce, all-gather and reduce-scatter combine "
+      "thresholds per module from the collective performance model. Requires "
+      "--xla_gpu_collective_topology."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_collective_compression_type",
+      string_setter_for(&DebugOptions::set_xla_gpu_collective_compression_type),
+      debug_options->xla_gpu_collective_compression_type(),
+      "If set, compresses large sum all-reduce and reduce-scatter payloads to "
+      "the given type: bf16, f16, f8e4m3fn or f8e5m2. Lossy, off by "
+      "default."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_collective_compression_min_bytes",
+      int64_setter_for(
+          &DebugOptions::set_xla_gpu_collective_compression_min_bytes),
+      debug_options->xla_gpu_collective_compression_min_bytes(),
+      "Minimum operand size in bytes of collectives compressed by "
+      "--xla_gpu_collective_compression_type."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_collective_compression_error_feedback",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_collective_compression_error_feedback),
+      debug_options->xla_gpu_collective_compression_error_feedback(),
+      "Whether to carry the compression error of collectives in while loops "
+      "to the next iteration."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_hierarchical_collectives_min_bytes",
+      int64_setter_for(
+          &DebugOptions::set_xla_gpu_hierarchical_collectives_min_bytes),
+      debug_options->xla_gpu_hierarchical_collectives_min_bytes(),
+      "If positive, decomposes all-reduce, all-gather and reduce-scatter ops "
+      "of at least this many bytes spanning multiple nodes into intra-node "
+      "and inter-node phases. The number of devices per node is taken from "
+      "--xla_gpu_collective_topology (8 if not set)."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_triton_gemm_atomic_split_k",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_triton_gemm_atomic_split_k),
+      debug_options->xla_gpu_enable_triton_gemm_atomic_split_k(),
+      "If true, the GEMM fusion autotuner also tries split-K configurations "
+      "that accumulate partial results atomically in the Triton GEMM kernel "
+      "instead of reducing them in a separate fusion. Non-deterministic."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_triton_attention",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_triton_attention),
+      debug_options->xla_gpu_enable_triton_attention(),
+      "If true, fuses attention patterns not handled by cuDNN into Triton "
+      "flash attention kernels on Ampere and newer GPUs."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_triton_grouped_gemm",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_triton_grouped_gemm),
+      debug_options->xla_gpu_enable_triton_grouped_gemm(),
+      "If true, fuses small independent dots into grouped GEMMs computed by "
+      "one Triton kernel each, on Ampere and newer GPUs. Reduces the number "
+      "of kernel launches of e.g. mixture-of-experts layers."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_persistent_grid_min_waves",
+      int64_setter_for(&DebugOptions::set_xla_gpu_persistent_grid_min_waves),
+      debug_options->xla_gpu_persistent_grid_min_waves(),
+      "If positive, loop and multi-row reduction fusions whose grid would "
+      "take at least this many waves of resident blocks are launched with a "
+      "persistent grid of one wave that iterates over the remaining work. "
+      "Zero disables persistent grids."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_cubin_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_cubin_cache_dir),
+      debug_options->xla_gpu_cubin_cache_dir(),
+      "If non-empty, cubins compiled from PTX are stored in and reused from "
+      "this directory, which may be shared by concurrent processes. Entries "
+      "are keyed by the PTX, the compute capability, the PTX compiler version "
+      "and its flags."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_split_llvm_module_by_cost",
+      bool_setter_for(&DebugOptions::set_xla_gpu_split_llvm_module_by_cost),
+      debug_options->xla_gpu_split_llvm_module_by_cost(),
+      "If true, the LLVM module is split for parallel compilation by the "
+      "estimated compile cost of its kernels rather than their number, and "
+      "the most expensive shards are compiled first."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_pipelined_host_offloading",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_pipelined_host_offloading),
+      debug_options->xla_gpu_enable_pipelined_host_offloading(),
+      "If true, host to device dynamic-slices of offloaded tensors in while "
+      "loops are pipelined into the previous iteration, double buffering the "
+      "transfers so that they overlap with the compute of the current "
+      "iteration."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_host_offload_max_slice_bytes",
+      int64_setter_for(&DebugOptions::set_xla_gpu_host_offload_max_slice_bytes),
+      debug_options->xla_gpu_host_offload_max_slice_bytes(),
+      "If positive, host to device copies of offloaded tensors larger than "
+      "this many bytes are split into asynchronous transfers of at most this "
+      "size. Zero transfers every tensor as a single copy."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_cudnn_graph_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_cudnn_graph_cache_dir),
+      debug_options->xla_gpu_cudnn_graph_cache_dir(),
+      "If non-empty, cuDNN graphs compiled for fusions are stored in and "
+      "reused from this directory, which may be shared by concurrent "
+      "processes. Entries are keyed by the fusion, the device and the cuDNN "
+      "version."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_autotune_max_devices",
+      int32_setter_for(&DebugOptions::set_xla_gpu_autotune_max_devices),
+      debug_options->xla_gpu_autotune_max_devices(),
+      "Maximum number of identical local devices the GEMM fusion autotuner "
+      "profiles on in parallel. 0 means all devices the allocator can serve."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_autotune_successive_halving",
+      bool_setter_for(&DebugOptions::set_xla_gpu_autotune_successive_halving),
+      debug_options->xla_gpu_autotune_successive_halving(),
+      "Prune Triton GEMM tilings with a cost model and profile the remaining "
+      "candidates in rounds of short runs, fully measuring and checking only "
+      "the fastest ones."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_sparse_weight_compression",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_sparse_weight_compression),
+      debug_options->xla_gpu_enable_sparse_weight_compression(),
+      "Compress constant dot weights that are 2:4 sparse along the contracting "
+      "dimension and run the dots as Triton sparse GEMMs."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_dump_autotune_logs_to",
       string_setter_for(&DebugOptions::set_xla_gpu_dump_autotune_logs_to),
@@ -1911,7 +2159,7 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
                 "Path to a file to cache compiled kernels. Cached kernels get "
                 "reused in further compilations; not yet cached kernels are "
                 "compiled as usual and get appended to the cache file whenever "
-                "possible."));
+                "possible. Files written for another GPU are ignored."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_per_fusion_autotune_cache_dir",
       string_setter_for(
@@ -1924,7 +2172,9 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "use an empty directory if you want to start with an empty cache). XLA "
       "version checks must be done by the user (e.g. if you want to use "
       "separate caches for different versions of XLA, please use different "
-      "directories). Default: no cache."));
+      "directories). The cache is sharded and append-only, and it is safe to "
+      "share the same directory between concurrently running processes. "
+      "Default: no cache."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_experimental_autotune_cache_mode",
       setter_for_xla_gpu_experimental_autotune_cache_mode,
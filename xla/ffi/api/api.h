@@ -1184,14 +1184,16 @@ class DictionaryBase {
     XLA_FFI_ByteSpan** begin = attrs_->names;
     XLA_FFI_ByteSpan** end = begin + attrs_->size;
 
-    auto name_eq = [&](XLA_FFI_ByteSpan* attr) {
-      std::string_view name_view = {attr->ptr, attr->len};
-      return name_view == name;
+    auto name_lt = [](XLA_FFI_ByteSpan* attr, std::string_view name) {
+      return std::string_view(attr->ptr, attr->len) < name;
     };
 
-    // TODO(ezhulenev): Attributes names sorted by name. We can use a binary
-    // search here instead of a linear scan.
-    return std::distance(begin, std::find_if(begin, end, name_eq));
+    // Attributes are sorted by name (see `XLA_FFI_Attrs` documentation).
+    XLA_FFI_ByteSpan** it = std::lower_bound(begin, end, name, name_lt);
+    if (it == end || std::string_view((*it)->ptr, (*it)->len) != name) {
+      return attrs_->size;
+    }
+    return std::distance(begin, it);
   }
 
   const XLA_FFI_Attrs* attrs_;
@@ -1715,23 +1717,48 @@ struct DecodeDictionaryAttr {
              << kSize << " attributes but got " << attrs->size;
     }
 
-    // TODO(ezhulenev): We rely on dictionary to lookup struct members by name
-    // at run time, however it can become really expensive. We should
-    // pre-compute mapping from `names` to index in the `XLA_FFI_Attrs`
-    // (attributes ordered by name) in a static variable, and rely on it
-    // to decode attributes with constant run time complexity.
-    //
-    // Consider using `static auto decoder = ...` below, and compute mapping in
-    // constructor. Add benchmarks first to know what to improve!
-    internal::DictionaryBase dict(attrs);
+    // Struct member names are fixed for the type `T`, and attributes in the
+    // `XLA_FFI_Attrs` are ordered by name, so the index of every member in the
+    // attributes is computed once and then only checked against its name.
+    static const std::array<size_t, kSize> idx = SortedIndices(names);
 
     std::tuple<std::optional<Ts>...> members = {
-        dict.get<Ts>(names[Is], diagnostic)...};
+        DecodeMember<Ts>(attrs, idx[Is], names[Is], diagnostic)...};
     bool all_decoded = (std::get<Is>(members).has_value() && ...);
     if (XLA_FFI_PREDICT_FALSE(!all_decoded)) return std::nullopt;
 
     return T{std::move(*std::get<Is>(members))...};
   }
+
+ private:
+  // Returns the position of every name in the sorted array of names.
+  static std::array<size_t, kSize> SortedIndices(
+      const std::array<std::string_view, kSize>& names) {
+    std::array<std::string_view, kSize> sorted = names;
+    std::sort(sorted.begin(), sorted.end());
+
+    std::array<size_t, kSize> idx;
+    for (size_t i = 0; i < kSize; ++i) {
+      idx[i] = std::distance(sorted.begin(),
+                             std::find(sorted.begin(), sorted.end(), names[i]));
+    }
+    return idx;
+  }
+
+  // Decodes a struct member from the attribute at index `idx`, and falls back
+  // to the lookup by name if the attribute at that index has another name.
+  template <typename U>
+  XLA_FFI_ATTRIBUTE_ALWAYS_INLINE static std::optional<U> DecodeMember(
+      const XLA_FFI_Attrs* attrs, size_t idx, std::string_view name,
+      DiagnosticEngine& diagnostic) {
+    XLA_FFI_ByteSpan* attr_name = attrs->names[idx];
+    if (XLA_FFI_PREDICT_TRUE(std::string_view(attr_name->ptr,
+                                              attr_name->len) == name)) {
+      return AttrDecoding<U>::Decode(attrs->types[idx], attrs->attrs[idx],
+                                     diagnostic);
+    }
+    return internal::DictionaryBase(attrs).get<U>(name, diagnostic);
+  }
 };
 
 template <typename... Members>
@@ -939,6 +939,25 @@ TEST(FfiTest, AttrsAsStruct) {
   TF_ASSERT_OK(status);
 }
 
+TEST(FfiTest, AttrsAsStructWrongMemberName) {
+  CallFrameBuilder::AttributesBuilder attrs;
+  attrs.Insert("i32", 42);
+  attrs.Insert("f64", 42.0);
+
+  CallFrameBuilder builder(/*num_args=*/0, /*num_rets=*/0);
+  builder.AddAttributes(attrs.Build());
+  auto call_frame = builder.Build();
+
+  auto fn = [&](PairOfI32AndF32) { return Error::Success(); };
+
+  auto handler = Ffi::Bind().Attrs<PairOfI32AndF32>().To(fn);
+  auto status = Call(*handler, call_frame);
+
+  EXPECT_TRUE(absl::StrContains(status.message(), "Unexpected attribute: f32"))
+      << "status.message():\n"
+      << status.message() << "\n";
+}
+
 TEST(FfiTest, PointerAttr) {
   std::string foo = "foo";
 
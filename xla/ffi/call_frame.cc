@@ -30,6 +30,8 @@ limitations under the License.
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xla/ffi/api/api.h"
 #include "xla/ffi/api/c_api.h"
@@ -38,6 +40,7 @@ limitations under the License.
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
 
 namespace xla::ffi {
 
@@ -581,4 +584,38 @@ absl::StatusOr<CallFrame> CallFrame::CopyWithBuffers(
   return clone;
 }
 
+//===----------------------------------------------------------------------===//
+// CallFramePool
+//===----------------------------------------------------------------------===//
+
+CallFramePool::CallFramePool(CallFrame call_frame)
+    : call_frame_(std::move(call_frame)) {}
+
+absl::StatusOr<CallFramePool::Ptr> CallFramePool::BorrowCallFrame(
+    absl::Span<const se::DeviceMemoryBase> args,
+    absl::Span<const se::DeviceMemoryBase> rets) {
+  std::unique_ptr<CallFrame> call_frame;
+  {
+    absl::MutexLock lock(&mu_);
+    if (!call_frames_.empty()) {
+      call_frame = std::move(call_frames_.back());
+      call_frames_.pop_back();
+    }
+  }
+
+  if (call_frame) {
+    Ptr ptr(call_frame.release(), PtrDeleter{this});
+    TF_RETURN_IF_ERROR(ptr->UpdateWithBuffers(args, rets));
+    return ptr;
+  }
+
+  TF_ASSIGN_OR_RETURN(CallFrame copy, call_frame_.CopyWithBuffers(args, rets));
+  return Ptr(new CallFrame(std::move(copy)), PtrDeleter{this});
+}
+
+void CallFramePool::ReturnCallFrame(CallFrame* call_frame) {
+  absl::MutexLock lock(&mu_);
+  call_frames_.emplace_back(call_frame);
+}
+
 }  // namespace xla::ffi
@@ -24,9 +24,11 @@ limitations under the License.
 #include <variant>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xla/ffi/api/c_api.h"
 #include "xla/stream_executor/device_memory.h"
@@ -237,6 +239,49 @@ class CallFrame {
   std::shared_ptr<Attributes> attributes_;
 };
 
+//===----------------------------------------------------------------------===//
+// CallFramePool
+//===----------------------------------------------------------------------===//
+
+// Pool of copies of a call frame, which are created as needed and destroyed
+// when the pool is destroyed. Custom call thunks borrow call frames from the
+// pool to avoid copying the call frame on every execution, while still
+// allowing concurrent executions of the same thunk.
+class CallFramePool {
+ public:
+  struct PtrDeleter {
+    void operator()(CallFrame* call_frame) {
+      pool->ReturnCallFrame(call_frame);
+    }
+    CallFramePool* pool;
+  };
+
+  // Call frame pointer type returned by BorrowCallFrame, which returns the
+  // call frame to the pool on destruction.
+  using Ptr = std::unique_ptr<CallFrame, PtrDeleter>;
+
+  explicit CallFramePool(CallFrame call_frame);
+
+  // Returns a copy of the call frame updated with the given arguments and
+  // results, copying the call frame only if none is available in the pool.
+  //
+  // This method is thread-safe.
+  absl::StatusOr<Ptr> BorrowCallFrame(
+      absl::Span<const se::DeviceMemoryBase> args,
+      absl::Span<const se::DeviceMemoryBase> rets);
+
+ private:
+  // Puts a call frame back into the pool, leaving it free for future use.
+  //
+  // This method is thread-safe.
+  void ReturnCallFrame(CallFrame* call_frame);
+
+  CallFrame call_frame_;
+
+  absl::Mutex mu_;
+  std::vector<std::unique_ptr<CallFrame>> call_frames_ ABSL_GUARDED_BY(mu_);
+};
+
 }  // namespace xla::ffi
 
 #endif  // XLA_FFI_CALL_FRAME_H_
@@ -107,6 +107,46 @@ TEST(CallFrameTest, UpdateCallFrame) {
   }
 }
 
+TEST(CallFrameTest, CallFramePool) {
+  se::DeviceMemoryBase mem0(reinterpret_cast<void*>(0x12345678), 1024);
+  se::DeviceMemoryBase mem1(reinterpret_cast<void*>(0x87654321), 1024);
+
+  std::vector<int64_t> dims = {1, 2, 3, 4};
+
+  CallFrameBuilder builder(/*num_args=*/1, /*num_rets=*/1);
+  builder.AddBufferArg(se::DeviceMemoryBase{}, PrimitiveType::F32, dims);
+  builder.AddBufferRet(se::DeviceMemoryBase{}, PrimitiveType::F32, dims);
+
+  CallFramePool pool(builder.Build());
+
+  auto arg_data = [](CallFrame& call_frame) {
+    XLA_FFI_CallFrame ffi_call_frame = call_frame.Build(
+        /*api=*/nullptr, /*ctx=*/nullptr, XLA_FFI_ExecutionStage_EXECUTE);
+    return static_cast<XLA_FFI_Buffer*>(ffi_call_frame.args.args[0])->data;
+  };
+
+  CallFrame* borrowed = nullptr;
+  {  // Concurrently borrowed call frames are distinct copies.
+    TF_ASSERT_OK_AND_ASSIGN(auto call_frame0,
+                            pool.BorrowCallFrame({mem0}, {mem1}));
+    TF_ASSERT_OK_AND_ASSIGN(auto call_frame1,
+                            pool.BorrowCallFrame({mem1}, {mem0}));
+    EXPECT_NE(call_frame0.get(), call_frame1.get());
+    EXPECT_EQ(arg_data(*call_frame0), mem0.opaque());
+    EXPECT_EQ(arg_data(*call_frame1), mem1.opaque());
+    // `call_frame0` is destroyed last and is the first to be reused.
+    borrowed = call_frame0.get();
+  }
+
+  // A returned call frame is reused and updated with the new buffers.
+  TF_ASSERT_OK_AND_ASSIGN(auto call_frame,
+                          pool.BorrowCallFrame({mem1}, {mem0}));
+  EXPECT_EQ(call_frame.get(), borrowed);
+  EXPECT_EQ(arg_data(*call_frame), mem1.opaque());
+
+  EXPECT_FALSE(pool.BorrowCallFrame({mem0, mem1}, {mem0}).ok());
+}
+
 //===----------------------------------------------------------------------===//
 // Performance benchmarks below
 //===----------------------------------------------------------------------===//
@@ -4713,14 +4713,24 @@ std::unique_ptr<Array2D<T>> MatmulArray2DImpl(
   int n = rhs.width();
   int k = lhs.width();
   auto result = std::make_unique<Array2D<T>>(m, n);
-  // Because Eigen is a header-oriented library, make sure that the Eigen code
-  // is the same as the code used by the CPU backend (otherwise the linker will
-  // randomly pick *some* definition).
-  impl_fn(
-      /*run_options_ptr=*/nullptr, result->data(), rhs.data(), lhs.data(), n, m,
-      k,
-      /*transpose_lhs=*/0,
-      /*transpose_rhs=*/0);
+  // Rows of the row-major `lhs` and `result` are contiguous, so blocks of rows
+  // are independent matmuls. Give each block at least ~64K multiply-adds.
+  constexpr int64_t kMinMacsPerBlock = 64 * 1024;
+  const int64_t min_rows_per_block =
+      std::max<int64_t>(1, kMinMacsPerBlock / std::max<int64_t>(1, n * k));
+  HloEvaluator::ParallelForEachLinearChunk(
+      m,
+      [&](int64_t begin, int64_t end) {
+        // Because Eigen is a header-oriented library, make sure that the Eigen
+        // code is the same as the code used by the CPU backend (otherwise the
+        // linker will randomly pick *some* definition).
+        impl_fn(
+            /*run_options_ptr=*/nullptr, result->data() + begin * n,
+            rhs.data(), lhs.data() + begin * k, n, end - begin, k,
+            /*transpose_lhs=*/0,
+            /*transpose_rhs=*/0);
+      },
+      min_rows_per_block);
   return result;
 }
 }  // namespace
@@ -4847,4 +4857,39 @@ std::unique_ptr<Array2D<tsl::float8_e4m3fn>> HloEvaluator::MatmulArray2D(
   }
 }
 
+/* static */ bool HloEvaluator::HaveSameLayout(
+    const Literal& result, absl::Span<const Literal* const> operands) {
+  const Shape& shape = result.shape();
+  if (!shape.IsArray() || !shape.is_static() ||
+      !LayoutUtil::IsDenseArray(shape)) {
+    return false;
+  }
+  return absl::c_all_of(operands, [&](const Literal* operand) {
+    const Shape& operand_shape = operand->shape();
+    return operand_shape.IsArray() && operand_shape.is_static() &&
+           ShapeUtil::SameDimensions(shape, operand_shape) &&
+           LayoutUtil::Equal(shape.layout(), operand_shape.layout());
+  });
+}
+
+/* static */ void HloEvaluator::ParallelForEachLinearChunk(
+    int64_t num_elements, absl::FunctionRef<void(int64_t, int64_t)> fn,
+    int64_t min_chunk_size) {
+  const int64_t num_chunks =
+      std::min<int64_t>(CeilOfRatio(num_elements, min_chunk_size),
+                        ShapeUtil::GetForEachIndexParallelThreadCount());
+  if (num_chunks <= 1) {
+    fn(0, num_elements);
+    return;
+  }
+  const int64_t chunk_size = CeilOfRatio(num_elements, num_chunks);
+  ShapeUtil::ForEachIndexParallel(
+      ShapeUtil::MakeShape(PRED, {num_chunks}),
+      [&](absl::Span<const int64_t> chunk, int) -> absl::StatusOr<bool> {
+        const int64_t begin = chunk[0] * chunk_size;
+        fn(begin, std::min(begin + chunk_size, num_elements));
+        return true;
+      });
+}
+
 }  // namespace xla
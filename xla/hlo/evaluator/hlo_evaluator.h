@@ -36,6 +36,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xla/array2d.h"
@@ -224,7 +225,15 @@ class HloEvaluator : public ConstDfsHloVisitorWithDefault {
     trace_mac_handler_ = std::move(handler);
   }
 
-  // Returns the result of a matrix multiply `lhs x rhs`.
+  // Calls `fn(begin, end)` on disjoint chunks covering [0, num_elements), in
+  // parallel on the thread pool used by ShapeUtil::ForEachIndexParallel.
+  // Chunks hold at least `min_chunk_size` elements, except the last one.
+  static void ParallelForEachLinearChunk(
+      int64_t num_elements, absl::FunctionRef<void(int64_t, int64_t)> fn,
+      int64_t min_chunk_size = 16 * 1024);
+
+  // Returns the result of a matrix multiply `lhs x rhs`. Blocks of rows of
+  // `lhs` are multiplied in parallel.
   static std::unique_ptr<Array2D<Eigen::half>> MatmulArray2D(
       const Array2D<Eigen::half>& lhs, const Array2D<Eigen::half>& rhs);
   static std::unique_ptr<Array2D<float>> MatmulArray2D(
@@ -470,6 +479,17 @@ class HloEvaluator : public ConstDfsHloVisitorWithDefault {
     TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
 
     Literal result(shape);
+    if (HaveSameLayout(result, {&operand_literal})) {
+      absl::Span<const NativeT> operand_data = operand_literal.data<NativeT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      ParallelForEachLinearChunk(
+          result_data.size(), [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              result_data[i] = unary_op(operand_data[i]);
+            }
+          });
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
         [&](absl::Span<const int64_t> multi_index, int) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
@@ -477,6 +497,12 @@ class HloEvaluator : public ConstDfsHloVisitorWithDefault {
     return std::move(result);
   }
 
+  // Returns true if `result` and all `operands` are static dense arrays with
+  // the same layout. Elementwise ops can then walk the flat buffers directly
+  // instead of computing a linear index for every element.
+  static bool HaveSameLayout(const Literal& result,
+                             absl::Span<const Literal* const> operands);
+
   // Map from a primitive type to its associated (templated) DfsHloVisitor.
   std::unique_ptr<ConstDfsHloVisitor> typed_visitors_[PrimitiveType_ARRAYSIZE];
 
@@ -584,6 +584,51 @@ TEST_F(HloEvaluatorTest, DoesReshape) {
       });
 }
 
+// Elementwise ops on large operands with matching layouts walk the buffers
+// linearly, in parallel chunks.
+TEST_F(HloEvaluatorTest, DoesLargeElementwiseOps) {
+  constexpr absl::string_view hlo_text = R"(
+HloModule m
+
+ENTRY main {
+  iota0 = s32[256,512] iota(), iota_dimension=0
+  iota1 = s32[256,512] iota(), iota_dimension=1
+  add = s32[256,512] add(iota0, iota1)
+  negate = s32[256,512] negate(add)
+  compare = pred[256,512] compare(iota0, iota1), direction=LT
+  ROOT select = s32[256,512] select(compare, add, negate)
+}
+)";
+  Array2D<int32_t> expected(256, 512);
+  expected.Each([](int64_t i, int64_t j, int32_t* value) {
+    *value = i < j ? i + j : -(i + j);
+  });
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate());
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateR2FromArray2D(expected), result));
+}
+
+// Operands with a different layout than the result take the indexed path.
+TEST_F(HloEvaluatorTest, DoesLargeElementwiseOpsWithMixedLayouts) {
+  constexpr absl::string_view hlo_text = R"(
+HloModule m
+
+ENTRY main {
+  iota0 = s32[256,512]{1,0} iota(), iota_dimension=0
+  iota1 = s32[256,512]{0,1} iota(), iota_dimension=1
+  ROOT add = s32[256,512]{1,0} add(iota0, iota1)
+}
+)";
+  Array2D<int32_t> expected(256, 512);
+  expected.Each(
+      [](int64_t i, int64_t j, int32_t* value) { *value = i + j; });
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate());
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateR2FromArray2D(expected), result));
+}
+
 // Verifies Broadcast operation is correctly evaluated.
 TEST_F(HloEvaluatorTest, DoesBroadcast) {
   HloComputation::Builder b(TestName());
@@ -1059,6 +1104,34 @@ TEST_P(HloEvaluatorBf16Test, DotRank4AndRank4) {
   EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
 }
 
+// The Eigen fast path multiplies blocks of rows in parallel. Integer valued
+// inputs keep the result exact, so both paths must agree bit for bit.
+TEST_F(HloEvaluatorTest, LargeDotFastPathMatchesSlowPath) {
+  constexpr absl::string_view hlo_text = R"(
+HloModule m
+
+ENTRY main {
+  lhs = f64[512,64] parameter(0)
+  rhs = f64[64,128] parameter(1)
+  ROOT dot = f64[512,128] dot(lhs, rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+}
+)";
+  Array2D<double> lhs_array(512, 64);
+  lhs_array.Each([](int64_t i, int64_t j, double* v) { *v = (i + j) % 7; });
+  Array2D<double> rhs_array(64, 128);
+  rhs_array.Each([](int64_t i, int64_t j, double* v) { *v = (i * j) % 5; });
+  Literal lhs = LiteralUtil::CreateR2FromArray2D(lhs_array);
+  Literal rhs = LiteralUtil::CreateR2FromArray2D(rhs_array);
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+
+  evaluator_.set_use_fast_path(false);
+  TF_ASSERT_OK_AND_ASSIGN(Literal slow_result, Evaluate({&lhs, &rhs}));
+  evaluator_.set_use_fast_path(true);
+  TF_ASSERT_OK_AND_ASSIGN(Literal fast_result, Evaluate({&lhs, &rhs}));
+  EXPECT_TRUE(LiteralTestUtil::Equal(slow_result, fast_result));
+}
+
 TEST_P(HloEvaluatorBf16Test, SimpleConv1D) {
   HloComputation::Builder b(TestName());
 
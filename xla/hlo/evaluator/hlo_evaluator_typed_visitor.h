@@ -1039,8 +1039,15 @@ class HloEvaluatorTypedVisitor : public ConstDfsHloVisitorWithDefault {
     return HandleDotSlowPath(dot);
   }
 
-  template <typename NativeT, typename std::enable_if_t<
-                                  std::is_same_v<NativeT, float>>* = nullptr>
+  // Types for which the fast path delegates to Eigen. Eigen accumulates in
+  // the element type itself, like the slow path does for these types.
+  template <typename NativeT>
+  static constexpr bool kIsEigenDotType =
+      std::is_same_v<NativeT, float> || std::is_same_v<NativeT, double> ||
+      std::is_same_v<NativeT, complex64> || std::is_same_v<NativeT, complex128>;
+
+  template <typename NativeT,
+            typename std::enable_if_t<kIsEigenDotType<NativeT>>* = nullptr>
   absl::Status HandleDot(const HloInstruction* dot) {
     const HloInstruction* lhs = dot->operand(0);
     const HloInstruction* rhs = dot->operand(1);
@@ -1104,8 +1111,8 @@ class HloEvaluatorTypedVisitor : public ConstDfsHloVisitorWithDefault {
     return absl::OkStatus();
   }
 
-  template <typename NativeT, typename std::enable_if_t<
-                                  !std::is_same_v<NativeT, float>>* = nullptr>
+  template <typename NativeT,
+            typename std::enable_if_t<!kIsEigenDotType<NativeT>>* = nullptr>
   absl::Status HandleDot(const HloInstruction* dot) {
     return HandleDotSlowPath(dot);
   }
@@ -1157,6 +1164,20 @@ class HloEvaluatorTypedVisitor : public ConstDfsHloVisitorWithDefault {
       contracting_dim_sizes.push_back(dim_size);
     }
     const int64_t total_contraction_size = Product(contracting_dim_sizes);
+
+    // Walk the contracting dimensions with linear strides, so that the inner
+    // loop does not recompute a linear index for every term.
+    DimensionVector lhs_contracting_strides;
+    DimensionVector rhs_contracting_strides;
+    for (int64_t i = 0; i < contracting_dim_sizes.size(); ++i) {
+      lhs_contracting_strides.push_back(IndexUtil::GetDimensionStride(
+          lhs_literal.shape(), lhs_contracting_dims[i]));
+      rhs_contracting_strides.push_back(IndexUtil::GetDimensionStride(
+          rhs_literal.shape(), rhs_contracting_dims[i]));
+    }
+    absl::Span<const ReturnT> lhs_data = lhs_literal.data<ReturnT>();
+    absl::Span<const ReturnT> rhs_data = rhs_literal.data<ReturnT>();
+
     Literal result(dot->shape());
     TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
         [&](absl::Span<const int64_t> result_index, int /*thread_id*/) {
@@ -1179,14 +1200,20 @@ class HloEvaluatorTypedVisitor : public ConstDfsHloVisitorWithDefault {
           for (int64_t i = 0; i < rhs_non_contracting_dims.size(); i++) {
             rhs_index[rhs_non_contracting_dims[i]] = result_index[idx++];
           }
+          int64_t lhs_linear_index =
+              IndexUtil::MultidimensionalIndexToLinearIndex(lhs_literal.shape(),
+                                                            lhs_index);
+          int64_t rhs_linear_index =
+              IndexUtil::MultidimensionalIndexToLinearIndex(rhs_literal.shape(),
+                                                            rhs_index);
 
           // Accumulate resulting product along the contracting dimensions.
           ElementwiseT result_val = static_cast<ElementwiseT>(0);
           for (int64_t k = 0; k < total_contraction_size; k++) {
             const auto lhs =
-                static_cast<ElementwiseT>(lhs_literal.Get<ReturnT>(lhs_index));
+                static_cast<ElementwiseT>(lhs_data[lhs_linear_index]);
             const auto rhs =
-                static_cast<ElementwiseT>(rhs_literal.Get<ReturnT>(rhs_index));
+                static_cast<ElementwiseT>(rhs_data[rhs_linear_index]);
             if (is_packed_nibble) {
               auto lhs_n0 = ToArithmeticSafeType(Nibble0(lhs));
               auto lhs_n1 = ToArithmeticSafeType(Nibble1(lhs));
@@ -1201,13 +1228,6 @@ class HloEvaluatorTypedVisitor : public ConstDfsHloVisitorWithDefault {
                 const int64_t result_linear_index =
                     IndexUtil::MultidimensionalIndexToLinearIndex(dot->shape(),
                                                                   result_index);
-                const int64_t lhs_linear_index =
-                    IndexUtil::MultidimensionalIndexToLinearIndex(
-                        lhs_literal.shape(), lhs_index);
-                const int64_t rhs_linear_index =
-                    IndexUtil::MultidimensionalIndexToLinearIndex(
-                        rhs_literal.shape(), rhs_index);
-
                 parent_->trace_mac_handler_(result_linear_index,
                                             lhs_linear_index, rhs_linear_index);
               }
@@ -1219,12 +1239,18 @@ class HloEvaluatorTypedVisitor : public ConstDfsHloVisitorWithDefault {
               for (int64_t i = contracting_dim_sizes.size() - 1; i >= 0; --i) {
                 lhs_index[lhs_contracting_dims[i]]++;
                 rhs_index[rhs_contracting_dims[i]]++;
+                lhs_linear_index += lhs_contracting_strides[i];
+                rhs_linear_index += rhs_contracting_strides[i];
                 if (lhs_index[lhs_contracting_dims[i]] !=
                     contracting_dim_sizes[i]) {
                   break;
                 }
                 lhs_index[lhs_contracting_dims[i]] = 0;
                 rhs_index[rhs_contracting_dims[i]] = 0;
+                lhs_linear_index -=
+                    contracting_dim_sizes[i] * lhs_contracting_strides[i];
+                rhs_linear_index -=
+                    contracting_dim_sizes[i] * rhs_contracting_strides[i];
               }
             }
           }
@@ -1533,11 +1559,10 @@ class HloEvaluatorTypedVisitor : public ConstDfsHloVisitorWithDefault {
                   is_complex_v<ElementwiseT> ||
                   std::is_floating_point_v<ElementwiseT>) {
       Literal result(iota->shape());
-      ShapeUtil::ForEachIndexNoStatus(
-          iota->shape(), [&](absl::Span<const int64_t> idx) {
-            result.Set(idx, static_cast<ReturnT>(idx[iota->iota_dimension()]));
-            return true;
-          });
+      TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
+          [&](absl::Span<const int64_t> idx, int) {
+            return static_cast<ReturnT>(idx[iota->iota_dimension()]);
+          }));
       parent_->evaluated_[iota] = std::move(result);
       return absl::OkStatus();
     }
@@ -1670,6 +1695,19 @@ class HloEvaluatorTypedVisitor : public ConstDfsHloVisitorWithDefault {
     const Literal& rhs_literal = parent_->GetEvaluatedLiteralFor(rhs);
 
     Literal result(shape);
+    if (HloEvaluator::HaveSameLayout(result, {&lhs_literal, &rhs_literal})) {
+      auto op = ConvertBinaryFunction(binary_op);
+      absl::Span<const ReturnT> lhs_data = lhs_literal.data<ReturnT>();
+      absl::Span<const ReturnT> rhs_data = rhs_literal.data<ReturnT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      HloEvaluator::ParallelForEachLinearChunk(
+          result_data.size(), [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              result_data[i] = op(lhs_data[i], rhs_data[i]);
+            }
+          });
+      return std::move(result);
+    }
 
     TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
         [&](absl::Span<const int64_t> multi_index, int) {
@@ -1697,6 +1735,21 @@ class HloEvaluatorTypedVisitor : public ConstDfsHloVisitorWithDefault {
     const Literal& ehs_literal = parent_->GetEvaluatedLiteralFor(ehs);
 
     Literal result(shape);
+    if (HloEvaluator::HaveSameLayout(
+            result, {&lhs_literal, &rhs_literal, &ehs_literal})) {
+      absl::Span<const LhsType> lhs_data = lhs_literal.data<LhsType>();
+      absl::Span<const RhsType> rhs_data = rhs_literal.data<RhsType>();
+      absl::Span<const EhsType> ehs_data = ehs_literal.data<EhsType>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      HloEvaluator::ParallelForEachLinearChunk(
+          result_data.size(), [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              result_data[i] =
+                  ternary_op(lhs_data[i], rhs_data[i], ehs_data[i]);
+            }
+          });
+      return std::move(result);
+    }
 
     TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
         [&](absl::Span<const int64_t> multi_index, int) {
@@ -1747,6 +1747,49 @@ std::unique_ptr<StrategyGroup> CreateReshapeStrategies(
   return strategy_group;
 }
 
+namespace {
+
+// Number of operand/user hops around an instruction that must be isomorphic
+// for its strategies to be tied to those of its structural duplicates.
+constexpr int64_t kRepeatedLayerHashRadius = 8;
+
+// Returns (follower, followee) pairs that tie the strategies of structurally
+// identical instructions, e.g., corresponding instructions of the repeated
+// layers of a transformer stack, to the first of them. Nodes are only tied if
+// their strategies have identical output shardings in the same order, so that
+// followers can use the strategy indices of their followees.
+std::vector<std::pair<NodeIdx, NodeIdx>> FindRepeatedLayerFollowers(
+    const HloInstructionSequence& sequence,
+    const StrategyGroups& strategy_groups,
+    absl::Span<const int64_t> s_follow) {
+  const std::vector<uint64_t> hashes =
+      BuildInstructionStructuralHashes(sequence, kRepeatedLayerHashRadius);
+  absl::flat_hash_map<std::pair<uint64_t, int64_t>, NodeIdx> representatives;
+  std::vector<std::pair<NodeIdx, NodeIdx>> followers;
+  for (NodeIdx node_idx = 0; node_idx < strategy_groups.size(); ++node_idx) {
+    if (s_follow[node_idx] >= 0) continue;
+    const StrategyGroup* strategy_group = strategy_groups[node_idx];
+    const auto [it, inserted] = representatives.insert(
+        {{hashes[strategy_group->instruction_id],
+          strategy_group->tuple_element_idx.value_or(-1)},
+         node_idx});
+    if (inserted) continue;
+    const auto& strategies = strategy_group->GetStrategies();
+    const auto& representative_strategies =
+        strategy_groups[it->second]->GetStrategies();
+    if (strategies.size() != representative_strategies.size()) continue;
+    bool same_strategies = true;
+    for (NodeStrategyIdx j = 0; j < strategies.size() && same_strategies; ++j) {
+      same_strategies = strategies[j].output_sharding ==
+                        representative_strategies[j].output_sharding;
+    }
+    if (same_strategies) followers.push_back({node_idx, it->second});
+  }
+  return followers;
+}
+
+}  // namespace
+
 absl::StatusOr<AutoShardingSolverOutput>
 CreateAutoShardingSolverRequestAndCallSolver(
     const HloModule& hlo_module, const HloLiveRange& hlo_live_range,
@@ -1928,7 +1971,20 @@ CreateAutoShardingSolverRequestAndCallSolver(
     }
   }
 
-  // Process any new followers that had originally been modeled as aliases.
+  // Tie the strategies of repeated layers, which (like alias followers) keeps
+  // strategy indices unchanged.
+  if (option.reuse_strategies_across_repeated_layers) {
+    const std::vector<std::pair<NodeIdx, NodeIdx>> layer_followers =
+        FindRepeatedLayerFollowers(sequence, strategy_groups,
+                                   request.s_follow());
+    LOG(INFO) << "Tying " << layer_followers.size()
+              << " nodes to structurally identical nodes of repeated layers";
+    new_followers.insert(new_followers.end(), layer_followers.begin(),
+                         layer_followers.end());
+  }
+
+  // Process any new followers that had originally been modeled as aliases or
+  // that tie repeated layers.
   auto s_follow = request.mutable_s_follow();
   for (auto [follower, followee] : new_followers) {
     // New followers may have introduced chains, so find the root nodes.
@@ -1970,7 +2026,34 @@ CreateAutoShardingSolverRequestAndCallSolver(
 
   PopulateTemporalValues(cost_graph, request);
 
-  return FormulateAndSolveMIPFromSolverRequest(request);
+  // Warm-starts the solver with the solution of a previous compilation of the
+  // same module, if the caller didn't provide a hint.
+  std::string solution_cache_key;
+  if (!option.solver_solution_cache_dir.empty()) {
+    solution_cache_key =
+        absl::StrCat(hlo_module.GetFingerprint128(), "_", request_name);
+    if (request.s_hint().empty()) {
+      if (std::optional<std::vector<NodeStrategyIdx>> cached_solution =
+              ReadCachedSolverSolution(option.solver_solution_cache_dir,
+                                       solution_cache_key, request)) {
+        request.mutable_s_hint()->Add(cached_solution->begin(),
+                                      cached_solution->end());
+      }
+    }
+  }
+
+  absl::StatusOr<AutoShardingSolverOutput> output =
+      FormulateAndSolveMIPFromSolverRequest(request);
+  if (output.ok() && !solution_cache_key.empty()) {
+    if (absl::Status status = WriteCachedSolverSolution(
+            option.solver_solution_cache_dir, solution_cache_key, request,
+            *output);
+        !status.ok()) {
+      LOG(WARNING) << "Failed to persist the auto-sharding solution: "
+                   << status;
+    }
+  }
+  return output;
 }
 
 void CheckHloSharding(
@@ -214,6 +214,9 @@ void CostGraph::AddEdgeCost(NodeIdx i, NodeIdx j,
     adjacency_[j].insert(i);
     edge_costs_[{i, j}] = cost;
   }
+  // Edge costs are only read from here on (apart from being summed up again
+  // when merging nodes), so store them compressed to keep the cost graph small.
+  edge_costs_[{i, j}].Compress();
 }
 
 void CostGraph::RemoveEdge(NodeIdx i, NodeIdx j) {
@@ -237,7 +240,7 @@ void CostGraph::MergeNode(const NodeIdx src, const NodeIdx dst) {
   CHECK(!merged_to_.contains(dst));
   CHECK_NE(src, dst);
 
-  EdgeReshardingCostMatrix edge_cost = GetEdgeCost(dst, src);
+  const EdgeReshardingCostMatrix edge_cost = GetEdgeCost(dst, src);
 
   std::vector<NodeStrategyIdx> reindexing(node_lens_[dst]);
   if (node_lens_[dst] == node_lens_[src]) {
@@ -286,7 +289,7 @@ void CostGraph::MergeNode(const NodeIdx src, const NodeIdx dst) {
     } else {
       EdgeReshardingCostMatrix added_edge_cost(node_lens_[dst],
                                                node_lens_[adj]);
-      EdgeReshardingCostMatrix edge_cost_src_adj = GetEdgeCost(src, adj);
+      const EdgeReshardingCostMatrix edge_cost_src_adj = GetEdgeCost(src, adj);
       for (NodeStrategyIdx i = 0; i < node_lens_[dst]; ++i) {
         for (NodeStrategyIdx k = 0; k < node_lens_[adj]; ++k) {
           added_edge_cost(i, k) = edge_cost_src_adj(reindexing[i], k);
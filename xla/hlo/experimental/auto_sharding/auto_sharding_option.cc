@@ -115,6 +115,9 @@ std::string AutoShardingOption::ToString() const {
   lines.push_back(
       absl::StrCat("solver_timeout_in_seconds: ", solver_timeout_in_seconds));
 
+  lines.push_back(
+      absl::StrCat("solver_solution_cache_dir: ", solver_solution_cache_dir));
+
   lines.push_back(absl::StrCat("loop_iteration_count_estimate: ",
                                loop_iteration_count_estimate));
 
@@ -141,6 +144,9 @@ std::string AutoShardingOption::ToString() const {
   lines.push_back(absl::StrCat("insert_resharding_reshapes_for_non_dot_ops: ",
                                insert_resharding_reshapes_for_non_dot_ops));
 
+  lines.push_back(absl::StrCat("reuse_strategies_across_repeated_layers: ",
+                               reuse_strategies_across_repeated_layers));
+
   return absl::StrJoin(lines, "\n");
 }
 
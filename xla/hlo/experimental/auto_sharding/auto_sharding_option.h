@@ -157,6 +157,11 @@ struct AutoShardingOption {
   // sharding_propagation.cc.
   int64_t solver_timeout_in_seconds = 3600;
 
+  // If non-empty, solver solutions are persisted in this directory keyed by
+  // the module fingerprint, and used to warm-start the solver when the same
+  // module is compiled again.
+  std::string solver_solution_cache_dir;
+
   // Static estimate for iteration count of a while loop, used in the cost
   // model. This estimate is used when we cannot infer an upper bound on the
   // number of iterations in the loop (as implemented in
@@ -202,6 +207,11 @@ struct AutoShardingOption {
   // ops in a principled manner.
   bool insert_resharding_reshapes_for_non_dot_ops = false;
 
+  // Whether to tie the strategies of structurally identical instructions, such
+  // as those of the repeated layers of a transformer stack, so that the solver
+  // only decides the strategies of one representative layer.
+  bool reuse_strategies_across_repeated_layers = false;
+
   // Prints a debug string.
   std::string ToString() const;
 
@@ -39,15 +39,23 @@ limitations under the License.
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "xla/hlo/experimental/auto_sharding/auto_sharding_memory.h"
 #include "xla/hlo/experimental/auto_sharding/auto_sharding_strategy.h"
+#include "xla/service/persistent_cache_file.h"
 #include "xla/status_macros.h"
 #include "xla/util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
 #include "tsl/platform/fingerprint.h"
 #include "tsl/platform/hash.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/protobuf.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
 #include "ortools/linear_solver/linear_solver.h"
 #include "ortools/linear_solver/linear_solver.pb.h"
@@ -393,12 +401,11 @@ void AddMemoryTerms(
 //    can be a few (usually < 10) edges in the problem with negative costs. This
 //    is guaranteed to never produce a negative overall cost for the graph,
 //    however.
-absl::StatusOr<AutoShardingSolverOutput> FormulateAndSolveMIPFromSolverRequest(
-    const AutoShardingSolverRequest& unscaled_request) {
+absl::StatusOr<AutoShardingSolverOutput> FormulateAndSolveMIP(
+    const AutoShardingSolverRequest& unscaled_request,
+    const AutoShardingSolverRequest& request, const int num_workers) {
   const absl::Time start_time = absl::Now();
-  const AutoShardingSolverRequest& request = ScaleRequest(unscaled_request);
   const size_t num_edges = request.edges_size();
-  const int num_workers = 32;
   // SAT or SCIP
 #ifdef PLATFORM_GOOGLE
   std::unique_ptr<MPSolver> solver(MPSolver::CreateSolver("SAT"));
@@ -810,6 +817,298 @@ absl::StatusOr<AutoShardingSolverOutput> FormulateAndSolveMIPFromSolverRequest(
   return result;
 }
 
+// Maximum number of subproblems solved concurrently; independent components of
+// the cost graph are packed into this many subproblems to bound the overhead
+// of setting up many tiny solves.
+constexpr int64_t kMaxSubproblems = 8;
+
+// Total number of solver workers, shared among concurrently solved subproblems.
+constexpr int kNumWorkers = 32;
+
+NodeIdx FindSubproblemRoot(std::vector<NodeIdx>& parent, NodeIdx node_idx) {
+  while (parent[node_idx] != node_idx) {
+    parent[node_idx] = parent[parent[node_idx]];
+    node_idx = parent[node_idx];
+  }
+  return node_idx;
+}
+
+std::vector<std::vector<NodeIdx>> PartitionIntoIndependentSubproblems(
+    const AutoShardingSolverRequest& request, int64_t max_subproblems) {
+  const int64_t num_nodes = request.num_nodes();
+  std::vector<NodeIdx> all_nodes(num_nodes);
+  for (NodeIdx node_idx = 0; node_idx < num_nodes; ++node_idx) {
+    all_nodes[node_idx] = node_idx;
+  }
+  // Memory, makespan & departure constraints (as well as a maximum cost) range
+  // over all nodes, in which case the problem can't be decomposed exactly.
+  if (max_subproblems <= 1 || num_nodes <= 1 || request.memory_budget() > 0 ||
+      request.has_makespan_coeff() || request.has_max_departures() ||
+      (request.has_max_cost() && request.max_cost().coeff() < kMaxCostValue)) {
+    return {std::move(all_nodes)};
+  }
+  std::vector<NodeIdx> parent = all_nodes;
+  const auto merge = [&](NodeIdx a, NodeIdx b) {
+    a = FindSubproblemRoot(parent, a);
+    b = FindSubproblemRoot(parent, b);
+    if (a != b) parent[std::max(a, b)] = std::min(a, b);
+  };
+  for (NodeIdx node_idx = 0; node_idx < num_nodes; ++node_idx) {
+    if (request.s_follow(node_idx) >= 0) {
+      merge(node_idx, request.s_follow(node_idx));
+    }
+  }
+  for (const auto& edge : request.edges()) merge(edge.first(), edge.second());
+  for (const auto& alias : request.aliases()) {
+    merge(alias.first(), alias.second());
+  }
+  // Collects the components in order of their smallest node.
+  std::vector<std::vector<NodeIdx>> components;
+  std::vector<int64_t> component_of_root(num_nodes, -1);
+  for (NodeIdx node_idx = 0; node_idx < num_nodes; ++node_idx) {
+    const NodeIdx root = FindSubproblemRoot(parent, node_idx);
+    if (component_of_root[root] < 0) {
+      component_of_root[root] = components.size();
+      components.emplace_back();
+    }
+    components[component_of_root[root]].push_back(node_idx);
+  }
+  if (components.size() <= 1) return {std::move(all_nodes)};
+  // Packs the components into subproblems of balanced size, largest first.
+  std::stable_sort(components.begin(), components.end(),
+                   [](const std::vector<NodeIdx>& a,
+                      const std::vector<NodeIdx>& b) {
+                     return a.size() > b.size();
+                   });
+  std::vector<std::vector<NodeIdx>> subproblems(
+      std::min<int64_t>(max_subproblems, components.size()));
+  for (const std::vector<NodeIdx>& component : components) {
+    auto smallest = std::min_element(
+        subproblems.begin(), subproblems.end(),
+        [](const std::vector<NodeIdx>& a, const std::vector<NodeIdx>& b) {
+          return a.size() < b.size();
+        });
+    smallest->insert(smallest->end(), component.begin(), component.end());
+  }
+  for (std::vector<NodeIdx>& subproblem : subproblems) {
+    std::sort(subproblem.begin(), subproblem.end());
+  }
+  return subproblems;
+}
+
+template <typename T>
+void AddSubproblemEntry(const tsl::protobuf::RepeatedPtrField<T>& from,
+                        int64_t idx, int64_t expected_size,
+                        tsl::protobuf::RepeatedPtrField<T>* to) {
+  if (from.size() == expected_size) *to->Add() = from[idx];
+}
+
+// Splits the request into one request per subproblem, with nodes renumbered in
+// the order of the subproblem's node indices. Liveness information is dropped,
+// as it is only used by memory constraints (which prevent decomposition).
+std::vector<AutoShardingSolverRequest> SplitRequest(
+    const AutoShardingSolverRequest& request,
+    const std::vector<std::vector<NodeIdx>>& subproblems) {
+  AutoShardingSolverRequest skeleton = request;
+  skeleton.clear_s_len();
+  skeleton.clear_s_follow();
+  skeleton.clear_s_hint();
+  skeleton.clear_peak_times();
+  skeleton.clear_edges();
+  skeleton.clear_live();
+  skeleton.clear_live_edges();
+  skeleton.clear_node_intervals();
+  skeleton.clear_edge_intervals();
+  skeleton.clear_node_groups();
+  skeleton.clear_edge_groups();
+  skeleton.clear_computation_costs();
+  skeleton.clear_communication_costs();
+  skeleton.clear_memory_costs();
+  skeleton.clear_memory_edge_costs();
+  skeleton.clear_departure_costs();
+  skeleton.clear_resharding_costs();
+  skeleton.clear_duration_costs();
+  skeleton.clear_aliases();
+  skeleton.clear_value_costs();
+  skeleton.clear_instruction_names();
+  skeleton.clear_opcodes();
+  skeleton.clear_metadata_source_files();
+  skeleton.clear_strategy_names();
+  // The request has already been scaled as a whole.
+  skeleton.clear_coeff_limit();
+
+  const int64_t num_nodes = request.num_nodes();
+  std::vector<int64_t> subproblem_of(num_nodes, -1);
+  std::vector<NodeIdx> local_idx(num_nodes, -1);
+  std::vector<AutoShardingSolverRequest> sub_requests(subproblems.size(),
+                                                      skeleton);
+  for (int64_t i = 0; i < subproblems.size(); ++i) {
+    AutoShardingSolverRequest& sub_request = sub_requests[i];
+    sub_request.set_num_nodes(subproblems[i].size());
+    sub_request.set_request_name(
+        absl::StrCat(request.request_name(), "_subproblem_", i));
+    for (const NodeIdx node_idx : subproblems[i]) {
+      subproblem_of[node_idx] = i;
+      local_idx[node_idx] = sub_request.s_len_size();
+      sub_request.add_s_len(request.s_len(node_idx));
+      if (!request.s_hint().empty()) {
+        sub_request.add_s_hint(request.s_hint(node_idx));
+      }
+      AddSubproblemEntry(request.computation_costs(), node_idx, num_nodes,
+                         sub_request.mutable_computation_costs());
+      AddSubproblemEntry(request.communication_costs(), node_idx, num_nodes,
+                         sub_request.mutable_communication_costs());
+      AddSubproblemEntry(request.memory_costs(), node_idx, num_nodes,
+                         sub_request.mutable_memory_costs());
+      AddSubproblemEntry(request.departure_costs(), node_idx, num_nodes,
+                         sub_request.mutable_departure_costs());
+      AddSubproblemEntry(request.instruction_names(), node_idx, num_nodes,
+                         sub_request.mutable_instruction_names());
+      AddSubproblemEntry(request.opcodes(), node_idx, num_nodes,
+                         sub_request.mutable_opcodes());
+      AddSubproblemEntry(request.metadata_source_files(), node_idx, num_nodes,
+                         sub_request.mutable_metadata_source_files());
+      AddSubproblemEntry(request.strategy_names(), node_idx, num_nodes,
+                         sub_request.mutable_strategy_names());
+    }
+  }
+  for (NodeIdx node_idx = 0; node_idx < num_nodes; ++node_idx) {
+    const NodeIdx follow = request.s_follow(node_idx);
+    sub_requests[subproblem_of[node_idx]].add_s_follow(
+        follow >= 0 ? local_idx[follow] : follow);
+  }
+  const int64_t num_edges = request.edges_size();
+  for (EdgeIdx edge_idx = 0; edge_idx < num_edges; ++edge_idx) {
+    const auto& edge = request.edges(edge_idx);
+    AutoShardingSolverRequest& sub_request =
+        sub_requests[subproblem_of[edge.first()]];
+    AutoShardingSolverRequest_Pair* sub_edge = sub_request.add_edges();
+    sub_edge->set_first(local_idx[edge.first()]);
+    sub_edge->set_second(local_idx[edge.second()]);
+    AddSubproblemEntry(request.resharding_costs(), edge_idx, num_edges,
+                       sub_request.mutable_resharding_costs());
+    AddSubproblemEntry(request.duration_costs(), edge_idx, num_edges,
+                       sub_request.mutable_duration_costs());
+    AddSubproblemEntry(request.memory_edge_costs(), edge_idx, num_edges,
+                       sub_request.mutable_memory_edge_costs());
+  }
+  for (AliasIdx alias_idx = 0; alias_idx < request.aliases_size();
+       ++alias_idx) {
+    const auto& alias = request.aliases(alias_idx);
+    AutoShardingSolverRequest& sub_request =
+        sub_requests[subproblem_of[alias.first()]];
+    AutoShardingSolverRequest_Pair* sub_alias = sub_request.add_aliases();
+    sub_alias->set_first(local_idx[alias.first()]);
+    sub_alias->set_second(local_idx[alias.second()]);
+    *sub_request.add_value_costs() = request.value_costs(alias_idx);
+  }
+  return sub_requests;
+}
+
+absl::StatusOr<AutoShardingSolverOutput> FormulateAndSolveMIPFromSolverRequest(
+    const AutoShardingSolverRequest& unscaled_request) {
+  const AutoShardingSolverRequest request = ScaleRequest(unscaled_request);
+  const std::vector<std::vector<NodeIdx>> subproblems =
+      PartitionIntoIndependentSubproblems(request, kMaxSubproblems);
+  if (subproblems.size() <= 1) {
+    return FormulateAndSolveMIP(unscaled_request, request, kNumWorkers);
+  }
+
+  const absl::Time start_time = absl::Now();
+  LOG(INFO) << "Solving " << subproblems.size()
+            << " independent subproblems concurrently";
+  const std::vector<AutoShardingSolverRequest> sub_requests =
+      SplitRequest(request, subproblems);
+  const int num_subproblems = subproblems.size();
+  const int num_workers = std::max(1, kNumWorkers / num_subproblems);
+  std::vector<absl::StatusOr<AutoShardingSolverOutput>> sub_outputs(
+      subproblems.size(), absl::UnknownError("Subproblem was not solved."));
+  {
+    tsl::thread::ThreadPool thread_pool(tsl::Env::Default(),
+                                        "auto_sharding_solver",
+                                        num_subproblems);
+    for (int64_t i = 0; i < subproblems.size(); ++i) {
+      thread_pool.Schedule([&, i] {
+        sub_outputs[i] =
+            FormulateAndSolveMIP(sub_requests[i], sub_requests[i], num_workers);
+      });
+    }
+  }
+
+  // The subproblems share no variables or constraints, so the objective of the
+  // whole problem is the sum of the subproblem objectives.
+  AutoShardingSolverOutput output;
+  output.s_val.resize(request.num_nodes(), -1);
+  output.cost = 0.0;
+  for (int64_t i = 0; i < subproblems.size(); ++i) {
+    TF_RETURN_IF_ERROR(sub_outputs[i].status());
+    for (int64_t j = 0; j < subproblems[i].size(); ++j) {
+      output.s_val[subproblems[i][j]] = sub_outputs[i]->s_val[j];
+    }
+    output.cost += sub_outputs[i]->cost;
+    output.is_optimal &= sub_outputs[i]->is_optimal;
+  }
+  LOG(INFO) << "Objective value of the whole problem: " << output.cost;
+  LOG(INFO) << "Solving all subproblems took "
+            << absl::ToInt64Milliseconds(absl::Now() - start_time) << " ms";
+  return output;
+}
+
+std::string SolverSolutionCachePath(absl::string_view cache_dir,
+                                    absl::string_view key) {
+  return tsl::io::JoinPath(cache_dir, absl::StrCat(key, ".pb"));
+}
+
+std::optional<std::vector<NodeStrategyIdx>> ReadCachedSolverSolution(
+    absl::string_view cache_dir, absl::string_view key,
+    const AutoShardingSolverRequest& request) {
+  const std::string path = SolverSolutionCachePath(cache_dir, key);
+  absl::StatusOr<std::optional<std::string>> serialized_solution =
+      ReadPersistentCacheFile(tsl::Env::Default(), path);
+  if (!serialized_solution.ok()) {
+    LOG(WARNING) << "Failed to read cached auto-sharding solution: "
+                 << serialized_solution.status();
+    return std::nullopt;
+  }
+  if (!serialized_solution->has_value()) {
+    VLOG(1) << "No cached auto-sharding solution at " << path;
+    return std::nullopt;
+  }
+  AutoShardingSolverSolution solution;
+  if (!solution.ParseFromString(**serialized_solution)) {
+    LOG(WARNING) << "Failed to parse cached auto-sharding solution at " << path;
+    return std::nullopt;
+  }
+  // The module may have changed in ways the key doesn't capture; only use the
+  // solution if it is still a valid assignment of strategies.
+  if (solution.s_val_size() != request.num_nodes() ||
+      solution.s_len_size() != request.s_len_size()) {
+    return std::nullopt;
+  }
+  for (NodeIdx node_idx = 0; node_idx < request.num_nodes(); ++node_idx) {
+    if (solution.s_len(node_idx) != request.s_len(node_idx) ||
+        solution.s_val(node_idx) < 0 ||
+        solution.s_val(node_idx) >= request.s_len(node_idx)) {
+      return std::nullopt;
+    }
+  }
+  VLOG(1) << "Using cached auto-sharding solution at " << path;
+  return std::vector<NodeStrategyIdx>(solution.s_val().begin(),
+                                      solution.s_val().end());
+}
+
+absl::Status WriteCachedSolverSolution(absl::string_view cache_dir,
+                                       absl::string_view key,
+                                       const AutoShardingSolverRequest& request,
+                                       const AutoShardingSolverOutput& output) {
+  AutoShardingSolverSolution solution;
+  solution.mutable_s_len()->Add(request.s_len().begin(), request.s_len().end());
+  solution.mutable_s_val()->Add(output.s_val.begin(), output.s_val.end());
+  return WritePersistentCacheFile(tsl::Env::Default(),
+                                  SolverSolutionCachePath(cache_dir, key),
+                                  solution.SerializeAsString());
+}
+
 std::vector<NodeStrategyIdx> GetChosenNodeStrategy(
     const AutoShardingSolverRequest& request,
     const std::vector<std::vector<MPVariable*>>& s) {
@@ -16,11 +16,14 @@ limitations under the License.
 #ifndef XLA_HLO_EXPERIMENTAL_AUTO_SHARDING_AUTO_SHARDING_SOLVER_H_
 #define XLA_HLO_EXPERIMENTAL_AUTO_SHARDING_AUTO_SHARDING_SOLVER_H_
 
+#include <cstdint>
+#include <optional>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "xla/hlo/experimental/auto_sharding/auto_sharding.pb.h"
 #include "xla/hlo/experimental/auto_sharding/auto_sharding_strategy.h"
 #include "ortools/linear_solver/linear_solver.h"
@@ -37,9 +40,33 @@ struct AutoShardingSolverOutput {
   bool operator==(const AutoShardingSolverOutput& other) const;
 };
 
+// Solves the request. If the request consists of several weakly-connected
+// subproblems that no constraint couples (i.e., there is no memory budget,
+// makespan, departure or max cost constraint), the subproblems are solved
+// concurrently and their solutions are merged.
 absl::StatusOr<AutoShardingSolverOutput> FormulateAndSolveMIPFromSolverRequest(
     const AutoShardingSolverRequest& request);
 
+// Partitions the nodes of the request into at most `max_subproblems` groups
+// such that no edge, follower or alias connects nodes of different groups, and
+// no other constraint of the request couples them. Returns a single group with
+// all nodes if the request cannot be decomposed. Node indices within each
+// group are sorted.
+std::vector<std::vector<NodeIdx>> PartitionIntoIndependentSubproblems(
+    const AutoShardingSolverRequest& request, int64_t max_subproblems);
+
+// Returns the solution persisted under `key` in `cache_dir` if there is one and
+// it fits the strategy counts of `request`, to be used as a solver hint.
+std::optional<std::vector<NodeStrategyIdx>> ReadCachedSolverSolution(
+    absl::string_view cache_dir, absl::string_view key,
+    const AutoShardingSolverRequest& request);
+
+// Persists the solution of `request` under `key` in `cache_dir`.
+absl::Status WriteCachedSolverSolution(absl::string_view cache_dir,
+                                       absl::string_view key,
+                                       const AutoShardingSolverRequest& request,
+                                       const AutoShardingSolverOutput& output);
+
 enum AutoShardingViolationCode {
   kAliasViolationCode,     // Some node's strategy does not match its alias
   kFollowerViolationCode,  // Some node's strategy does not match its follower
@@ -13,6 +13,7 @@ limitations under the License.
 #include "xla/hlo/experimental/auto_sharding/auto_sharding_solver.h"
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,8 +25,11 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "xla/hlo/experimental/auto_sharding/auto_sharding.pb.h"
 #include "xla/hlo/experimental/auto_sharding/auto_sharding_strategy.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tsl/platform/path.h"
 #include "tsl/platform/platform.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
 
 namespace xla {
 namespace spmd {
@@ -578,6 +582,63 @@ TEST(FormulateAndSolveMIPFromSolverRequestTest, SolvesWithEquivalences) {
   EXPECT_EQ(result, expected_output);
 }
 
+TEST(FormulateAndSolveMIPFromSolverRequestTest, SolvesIndependentSubproblems) {
+  AutoShardingSolverRequest request = DefaultAutoShardingSolverRequest();
+  request.set_memory_budget(-1);
+  request.clear_live();
+  request.clear_aliases();
+  request.clear_value_costs();
+
+  TF_ASSERT_OK_AND_ASSIGN(const AutoShardingSolverOutput result,
+                          FormulateAndSolveMIPFromSolverRequest(request));
+
+  const std::vector<NodeStrategyIdx> s_val = {0, 0, 0, 0, 0};
+  const double objective_value = 7650.0;
+  const AutoShardingSolverOutput expected_output = {s_val, objective_value};
+  EXPECT_EQ(result, expected_output);
+}
+
+TEST(PartitionIntoIndependentSubproblemsTest, SplitsWeaklyConnectedNodes) {
+  AutoShardingSolverRequest request = DefaultAutoShardingSolverRequest();
+  request.set_memory_budget(-1);
+  request.clear_aliases();
+  request.clear_value_costs();
+
+  const std::vector<std::vector<NodeIdx>> expected_subproblems = {{0, 1, 2, 3},
+                                                                  {4}};
+  EXPECT_EQ(PartitionIntoIndependentSubproblems(request, 8),
+            expected_subproblems);
+}
+
+TEST(PartitionIntoIndependentSubproblemsTest, KeepsNodesWithMemoryBudget) {
+  AutoShardingSolverRequest request = DefaultAutoShardingSolverRequest();
+  request.clear_aliases();
+  request.clear_value_costs();
+
+  const std::vector<std::vector<NodeIdx>> expected_subproblems = {
+      {0, 1, 2, 3, 4}};
+  EXPECT_EQ(PartitionIntoIndependentSubproblems(request, 8),
+            expected_subproblems);
+}
+
+TEST(SolverSolutionCacheTest, ReadsWrittenSolution) {
+  const std::string cache_dir =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "auto_sharding_solutions");
+  AutoShardingSolverRequest request = DefaultAutoShardingSolverRequest();
+  EXPECT_EQ(ReadCachedSolverSolution(cache_dir, "module", request),
+            std::nullopt);
+
+  const std::vector<NodeStrategyIdx> s_val = {1, 0, 2, 2, 0};
+  const AutoShardingSolverOutput output = {s_val, 8000.0};
+  TF_ASSERT_OK(WriteCachedSolverSolution(cache_dir, "module", request, output));
+  EXPECT_EQ(ReadCachedSolverSolution(cache_dir, "module", request), s_val);
+
+  // The solution doesn't fit a request with different strategies for a node.
+  request.set_s_len(0, 3);
+  EXPECT_EQ(ReadCachedSolverSolution(cache_dir, "module", request),
+            std::nullopt);
+}
+
 TEST(AutoShardingEvaluatorTest, NoViolations) {
   const AutoShardingSolverRequest request = DefaultAutoShardingSolverRequest();
   const std::vector<NodeStrategyIdx> s_val = {3, 1, 2, 2, 1};
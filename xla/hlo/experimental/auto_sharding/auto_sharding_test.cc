@@ -30,6 +30,8 @@ limitations under the License.
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "xla/hlo/experimental/auto_sharding/auto_sharding_cost_graph.h"
 #include "xla/hlo/experimental/auto_sharding/auto_sharding_device_mesh.h"
@@ -2870,6 +2872,90 @@ ENTRY matmul {
   EXPECT_TRUE(changed);
 }
 
+TEST_F(AutoShardingTest, StructuralHashesMatchRepeatedLayers) {
+  constexpr absl::string_view kHloString = R"(
+HloModule module
+ENTRY %entry {
+  %x = f32[128,128]{1,0} parameter(0)
+  %w1 = f32[128,128]{1,0} parameter(1)
+  %w2 = f32[128,128]{1,0} parameter(2)
+  %w3 = f32[128,128]{1,0} parameter(3)
+  %w4 = f32[128,128]{1,0} parameter(4)
+  %w5 = f32[128,128]{1,0} parameter(5)
+  %w6 = f32[128,128]{1,0} parameter(6)
+  %dot1 = f32[128,128]{1,0} dot(%x, %w1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  %tanh1 = f32[128,128]{1,0} tanh(%dot1)
+  %dot2 = f32[128,128]{1,0} dot(%tanh1, %w2), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  %tanh2 = f32[128,128]{1,0} tanh(%dot2)
+  %dot3 = f32[128,128]{1,0} dot(%tanh2, %w3), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  %tanh3 = f32[128,128]{1,0} tanh(%dot3)
+  %dot4 = f32[128,128]{1,0} dot(%tanh3, %w4), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  %tanh4 = f32[128,128]{1,0} tanh(%dot4)
+  %dot5 = f32[128,128]{1,0} dot(%tanh4, %w5), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  %tanh5 = f32[128,128]{1,0} tanh(%dot5)
+  %dot6 = f32[128,128]{1,0} dot(%tanh5, %w6), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT %tanh6 = f32[128,128]{1,0} tanh(%dot6)
+})";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  const HloInstructionSequence sequence(
+      module->entry_computation()->MakeInstructionPostOrder());
+  const std::vector<uint64_t> hashes =
+      BuildInstructionStructuralHashes(sequence, /*radius=*/2);
+  const auto hash_of = [&](absl::string_view name) {
+    const HloInstruction* ins = FindInstruction(module.get(), name);
+    CHECK_NE(ins, nullptr);
+    const auto it = absl::c_find(sequence.instructions(), ins);
+    return hashes[it - sequence.instructions().begin()];
+  };
+  EXPECT_EQ(hash_of("dot3"), hash_of("dot4"));
+  EXPECT_EQ(hash_of("tanh2"), hash_of("tanh3"));
+  EXPECT_NE(hash_of("dot1"), hash_of("dot3"));
+  EXPECT_NE(hash_of("dot3"), hash_of("tanh3"));
+}
+
+TEST_F(AutoShardingTest, ReuseStrategiesAcrossRepeatedLayers) {
+  // A stack of layers that is deep enough for its middle layers to be
+  // structurally identical.
+  constexpr int kNumLayers = 12;
+  std::string hlo_string = R"(
+HloModule module
+ENTRY %entry {
+  %tanh0 = f32[128,128]{1,0} parameter(0)
+)";
+  for (int i = 1; i <= kNumLayers; ++i) {
+    absl::StrAppendFormat(
+        &hlo_string,
+        "  %%w%d = f32[128,128]{1,0} parameter(%d)\n"
+        "  %%dot%d = f32[128,128]{1,0} dot(%%tanh%d, %%w%d), "
+        "lhs_contracting_dims={1}, rhs_contracting_dims={0}\n"
+        "  %s%%tanh%d = f32[128,128]{1,0} tanh(%%dot%d)\n",
+        i, i, i, i - 1, i, i == kNumLayers ? "ROOT " : "", i, i);
+  }
+  absl::StrAppend(&hlo_string, "}");
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  AutoShardingOption option;
+  option.enable = true;
+  option.reuse_strategies_across_repeated_layers = true;
+  option.device_mesh_shape = {2, 2};
+  option.device_mesh_ids = {0, 1, 2, 3};
+  option.device_mesh_alpha = {1.0, 1.0};
+  option.device_mesh_beta = {0.01, 1.0};
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, AutoSharding(option).Run(module.get()));
+  VLOG(2) << module->ToString();
+  EXPECT_TRUE(changed);
+  const HloInstruction* dot6 = FindInstruction(module.get(), "dot6");
+  const HloInstruction* dot7 = FindInstruction(module.get(), "dot7");
+  ASSERT_NE(dot6, nullptr);
+  ASSERT_NE(dot7, nullptr);
+  ASSERT_TRUE(dot6->has_sharding());
+  ASSERT_TRUE(dot7->has_sharding());
+  EXPECT_EQ(dot6->sharding(), dot7->sharding());
+}
+
 TEST(NormalizeTest, NormalizeHandlesNegativeCosts) {
   EdgeReshardingCostMatrix edge_cost(2, 2);
   edge_cost(0, 0).communication_cost = -100;
@@ -2900,6 +2986,39 @@ TEST(NormalizeTest, NormalizeHandlesPositiveCosts) {
   EXPECT_EQ(normalized_edge_cost(1, 1).communication_cost, 400);
 }
 
+TEST(MatrixTest, CompressPreservesEntries) {
+  // Rows 0 and 2 are identical, and row 1 is mostly infinite.
+  EdgeReshardingCostMatrix edge_cost(3, 8);
+  for (int j = 0; j < 8; ++j) {
+    edge_cost(0, j) = EdgeReshardingCost(j, 2 * j);
+    edge_cost(1, j) = EdgeReshardingCost(kInfinityCost, 0);
+    edge_cost(2, j) = EdgeReshardingCost(j, 2 * j);
+  }
+  edge_cost(1, 3) = EdgeReshardingCost(5, 7);
+  const EdgeReshardingCostMatrix transposed = edge_cost.Transpose();
+
+  EdgeReshardingCostMatrix compressed = edge_cost;
+  compressed.Compress();
+  ASSERT_TRUE(compressed.is_compressed());
+  const EdgeReshardingCostMatrix& compressed_view = compressed;
+  const EdgeReshardingCostMatrix compressed_transpose = compressed.Transpose();
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 8; ++j) {
+      EXPECT_EQ(compressed_view(i, j).communication_cost,
+                transposed(j, i).communication_cost);
+      EXPECT_EQ(compressed_view(i, j).memory_cost,
+                transposed(j, i).memory_cost);
+      EXPECT_EQ(compressed_transpose(j, i).communication_cost,
+                transposed(j, i).communication_cost);
+    }
+  }
+
+  // Writing to a compressed matrix leaves other views of it unchanged.
+  compressed(1, 3).communication_cost = 6;
+  EXPECT_FALSE(compressed.is_compressed());
+  EXPECT_EQ(compressed_transpose(3, 1).communication_cost, 5);
+}
+
 }  // namespace
 }  // namespace spmd
 }  // namespace xla
@@ -31,6 +31,7 @@ limitations under the License.
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -62,6 +63,7 @@ limitations under the License.
 #include "xla/shape_util.h"
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/statusor.h"
 
 namespace xla {
@@ -797,6 +799,58 @@ InstructionBatchDimMap BuildInstructionBatchDimMap(
   return batch_map;
 }
 
+std::vector<uint64_t> BuildInstructionStructuralHashes(
+    const HloInstructionSequence& sequence, int64_t radius) {
+  const std::vector<HloInstruction*>& instructions = sequence.instructions();
+  ConstInstructionMap<int64_t> instruction_ids;
+  for (int64_t id = 0; id < instructions.size(); ++id) {
+    instruction_ids[instructions[id]] = id;
+  }
+
+  // The initial hash covers the instruction itself: its opcode, shape and
+  // attributes, but not its name or the names of its operands. Parameter
+  // numbers are ignored, as every layer has its own weights.
+  const HloPrintOptions print_options =
+      HloPrintOptions::Fingerprint().set_print_subcomputation_mode(
+          HloPrintOptions::PrintSubcomputationMode::kNameOnly);
+  std::vector<uint64_t> hashes(instructions.size());
+  for (int64_t id = 0; id < instructions.size(); ++id) {
+    const HloInstruction* ins = instructions[id];
+    hashes[id] = ins->opcode() == HloOpcode::kParameter
+                     ? absl::HashOf(ins->opcode(), ins->shape().ToString(
+                                                       /*print_layout=*/true))
+                     : tsl::Fingerprint64(ins->ToString(print_options));
+  }
+
+  // Each round extends the hash by one hop, in the way of Weisfeiler-Lehman
+  // graph hashing. Operands are hashed in order, users as a multiset keyed by
+  // the operand position they use the instruction at.
+  std::vector<uint64_t> next_hashes(instructions.size());
+  std::vector<uint64_t> operand_hashes, user_hashes;
+  for (int64_t round = 0; round < radius; ++round) {
+    for (int64_t id = 0; id < instructions.size(); ++id) {
+      const HloInstruction* ins = instructions[id];
+      operand_hashes.clear();
+      for (const HloInstruction* operand : ins->operands()) {
+        auto it = instruction_ids.find(operand);
+        operand_hashes.push_back(
+            it == instruction_ids.end() ? 0 : hashes[it->second]);
+      }
+      user_hashes.clear();
+      for (const HloInstruction* user : ins->users()) {
+        auto it = instruction_ids.find(user);
+        if (it == instruction_ids.end()) continue;
+        user_hashes.push_back(
+            absl::HashOf(hashes[it->second], user->operand_index(ins)));
+      }
+      absl::c_sort(user_hashes);
+      next_hashes[id] = absl::HashOf(hashes[id], operand_hashes, user_hashes);
+    }
+    std::swap(hashes, next_hashes);
+  }
+  return hashes;
+}
+
 // Returns true if there is one row with only infinity cost.
 bool AllInfinityCosts(
     const std::vector<std::vector<double>>& resharding_costs) {
@@ -309,6 +309,14 @@ std::string GetBatchDimMapKey(const HloInstruction* ins, int64_t idx = -1);
 InstructionBatchDimMap BuildInstructionBatchDimMap(
     const HloInstructionSequence& sequence);
 
+// Structural hashing that assigns equal hashes to instructions whose
+// neighborhoods within `radius` operand and user hops are isomorphic, ignoring
+// instruction names. Corresponding instructions of repeated layers (e.g., of a
+// transformer stack) thus get equal hashes, except for those close to the ends
+// of the stack. The hashes are indexed by position in the sequence.
+std::vector<uint64_t> BuildInstructionStructuralHashes(
+    const HloInstructionSequence& sequence, int64_t radius);
+
 /*
  * HloSharding Utility
  */
@@ -20,20 +20,28 @@ limitations under the License.
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tsl/platform/logging.h"
 
 namespace xla {
 namespace spmd {
 // A simple matrix class to store and manipulate the cost matrices on edges.
 // It can create a view for matrix transpose without copying the memory.
+//
+// Cost matrices can be compressed once they are fully built (see Compress()):
+// identical rows are stored only once and rows in which most entries have the
+// same value (e.g., infinite resharding costs) are stored sparsely.
 // TODO (zhuohan): Inherit from Array2D and add Transpose and operator+ (See
 // tensorflow/compiler/xla/array2d.h;l=39)
 template <typename T>
@@ -56,33 +64,27 @@ class Matrix {
     this->data_ = data;
   }
 
-  Matrix Transpose() { return Matrix(m_, n_, !transpose_, data_); }
+  Matrix Transpose() const {
+    Matrix transposed(m_, n_, !transpose_, data_);
+    transposed.compressed_ = compressed_;
+    return transposed;
+  }
 
   T operator()(size_t i, size_t j) const {
-    size_t idx;
-    if (transpose_) {
-      idx = j * n_ + i;
-    } else {
-      idx = i * m_ + j;
+    CHECK(i < n_ && j < m_) << i << " , " << j << " , " << n_ << " , " << m_;
+    if (compressed_ != nullptr) {
+      return transpose_ ? compressed_->Get(j, i) : compressed_->Get(i, j);
     }
-    CHECK(data_ != nullptr) << n_ << " , " << m_;
-    CHECK(idx < n_ * m_) << idx << " , " << n_ << " , " << m_;
-    return (*data_)[idx];
+    return (*data_)[Index(i, j)];
   }
 
+  // Writing to a compressed matrix decompresses it first.
   T& operator()(size_t i, size_t j) {
-    size_t idx;
-    if (transpose_) {
-      idx = j * n_ + i;
-    } else {
-      idx = i * m_ + j;
-    }
-    CHECK(data_ != nullptr) << n_ << " , " << m_;
-    CHECK(idx < n_ * m_) << idx << " , " << n_ << " , " << m_;
-    return (*data_)[idx];
+    if (compressed_ != nullptr) Decompress();
+    return (*data_)[Index(i, j)];
   }
 
-  Matrix<T> operator+(const Matrix<T>& other) {
+  Matrix<T> operator+(const Matrix<T>& other) const {
     CHECK_EQ(n_, other.n_);
     CHECK_EQ(m_, other.m_);
     Matrix ret = Matrix(n_, m_);
@@ -94,6 +96,82 @@ class Matrix {
     return ret;
   }
 
+  // Compresses the storage of the matrix. Reading entries remains cheap (an
+  // additional binary search for sparse rows), so this should be used for
+  // matrices that are no longer written to. The storage shared with other
+  // (e.g., transposed) views of the matrix is released by this view only.
+  void Compress() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (compressed_ != nullptr || data_ == nullptr) return;
+    // Rows and columns of the underlying storage.
+    const size_t num_rows = transpose_ ? m_ : n_;
+    const size_t num_cols = transpose_ ? n_ : m_;
+    const auto row_bytes = [&](size_t row) {
+      return absl::string_view(
+          reinterpret_cast<const char*>(data_->data() + row * num_cols),
+          num_cols * sizeof(T));
+    };
+    const auto entry_bytes = [&](size_t row, size_t col) {
+      return row_bytes(row).substr(col * sizeof(T), sizeof(T));
+    };
+
+    auto compressed = std::make_shared<CompressedRows>();
+    compressed->row_ids.reserve(num_rows);
+    absl::flat_hash_map<absl::string_view, size_t> unique_rows;
+    std::vector<size_t> cols(num_cols);
+    for (size_t row = 0; row < num_rows; ++row) {
+      auto [it, inserted] =
+          unique_rows.insert({row_bytes(row), compressed->rows.size()});
+      compressed->row_ids.push_back(it->second);
+      if (!inserted) continue;
+
+      // Finds the most frequent entry of the row.
+      std::iota(cols.begin(), cols.end(), 0);
+      std::sort(cols.begin(), cols.end(), [&](size_t a, size_t b) {
+        return entry_bytes(row, a) < entry_bytes(row, b);
+      });
+      size_t fill_col = 0, fill_count = 0;
+      for (size_t begin = 0, end = 0; begin < num_cols; begin = end) {
+        while (end < num_cols &&
+               entry_bytes(row, cols[end]) == entry_bytes(row, cols[begin])) {
+          ++end;
+        }
+        if (end - begin > fill_count) {
+          fill_col = cols[begin];
+          fill_count = end - begin;
+        }
+      }
+
+      typename CompressedRows::Row compressed_row;
+      compressed_row.value_begin = compressed->values.size();
+      compressed_row.column_begin = compressed->columns.size();
+      const size_t num_sparse_entries = num_cols - fill_count;
+      compressed_row.sparse =
+          num_sparse_entries * (sizeof(T) + sizeof(uint32_t)) <
+          num_cols * sizeof(T);
+      if (num_cols > 0) {
+        compressed_row.fill = (*data_)[row * num_cols + fill_col];
+      }
+      for (size_t col = 0; col < num_cols; ++col) {
+        if (compressed_row.sparse &&
+            entry_bytes(row, col) == entry_bytes(row, fill_col)) {
+          continue;
+        }
+        if (compressed_row.sparse) compressed->columns.push_back(col);
+        compressed->values.push_back((*data_)[row * num_cols + col]);
+      }
+      compressed_row.size =
+          compressed->values.size() - compressed_row.value_begin;
+      compressed->rows.push_back(compressed_row);
+    }
+    compressed->values.shrink_to_fit();
+    compressed->columns.shrink_to_fit();
+    compressed_ = std::move(compressed);
+    data_.reset();
+  }
+
+  bool is_compressed() const { return compressed_ != nullptr; }
+
   std::string ToString() const {
     std::string str;
 
@@ -111,6 +189,69 @@ class Matrix {
   size_t m_;
   bool transpose_;
   std::shared_ptr<std::vector<T>> data_;
+
+ private:
+  // The compressed storage, which is immutable and can thus be shared among
+  // views of the matrix.
+  struct CompressedRows {
+    struct Row {
+      // Start of the row's entries in `values` (and `columns` if sparse).
+      size_t value_begin = 0;
+      size_t column_begin = 0;
+      // The number of stored entries.
+      size_t size = 0;
+      // If true, only the entries that differ from `fill` are stored, along
+      // with their (sorted) columns.
+      bool sparse = false;
+      T fill = T();
+    };
+
+    T Get(size_t row, size_t col) const {
+      const Row& compressed_row = rows[row_ids[row]];
+      if (!compressed_row.sparse) {
+        return values[compressed_row.value_begin + col];
+      }
+      auto first = columns.begin() + compressed_row.column_begin;
+      auto last = first + compressed_row.size;
+      auto it = std::lower_bound(first, last, col);
+      if (it == last || *it != col) return compressed_row.fill;
+      return values[compressed_row.value_begin + (it - first)];
+    }
+
+    // Maps every row of the storage to its unique row in `rows`.
+    std::vector<size_t> row_ids;
+    std::vector<Row> rows;
+    std::vector<T> values;
+    std::vector<uint32_t> columns;
+  };
+
+  size_t Index(size_t i, size_t j) const {
+    size_t idx;
+    if (transpose_) {
+      idx = j * n_ + i;
+    } else {
+      idx = i * m_ + j;
+    }
+    CHECK(data_ != nullptr) << n_ << " , " << m_;
+    CHECK(idx < n_ * m_) << idx << " , " << n_ << " , " << m_;
+    return idx;
+  }
+
+  void Decompress() {
+    const size_t num_rows = transpose_ ? m_ : n_;
+    const size_t num_cols = transpose_ ? n_ : m_;
+    auto data = std::make_shared<std::vector<T>>();
+    data->reserve(num_rows * num_cols);
+    for (size_t row = 0; row < num_rows; ++row) {
+      for (size_t col = 0; col < num_cols; ++col) {
+        data->push_back(compressed_->Get(row, col));
+      }
+    }
+    data_ = std::move(data);
+    compressed_.reset();
+  }
+
+  std::shared_ptr<const CompressedRows> compressed_;
 };
 }  // namespace spmd
 }  // namespace xla
@@ -0,0 +1,115 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/hlo/ir/hlo_arena.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "absl/base/attributes.h"
+#include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
+
+namespace xla {
+namespace {
+
+// Size of the blocks the arena allocates memory from. Larger allocations get a
+// dedicated block.
+constexpr size_t kBlockSize = 64 * 1024;
+constexpr size_t kMaxSizeInSharedBlock = kBlockSize / 8;
+
+// Every allocation is prefixed with a header that records the arena it was
+// allocated from, so that we can find it in Deallocate().
+struct alignas(std::max_align_t) AllocationHeader {
+  HloArena* arena;
+};
+
+constexpr size_t RoundUpToAlignment(size_t size) {
+  constexpr size_t kAlignment = alignof(std::max_align_t);
+  return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+ABSL_CONST_INIT thread_local HloArena* current_arena = nullptr;
+
+}  // namespace
+
+HloArena::Scope::Scope(HloArena* arena) : previous_(current_arena) {
+  current_arena = arena;
+}
+
+HloArena::Scope::~Scope() { current_arena = previous_; }
+
+HloArena* HloArena::current() { return current_arena; }
+
+HloArena::~HloArena() {
+  absl::MutexLock lock(&mu_);
+  for (char* block : blocks_) {
+    std::free(block);
+  }
+}
+
+void* HloArena::AllocateFromBlocks(size_t size) {
+  absl::MutexLock lock(&mu_);
+  allocated_bytes_ += size;
+  if (size > kMaxSizeInSharedBlock) {
+    char* block = static_cast<char*>(std::malloc(size));
+    CHECK(block != nullptr) << "Failed to allocate " << size << " bytes";
+    blocks_.push_back(block);
+    return block;
+  }
+  if (static_cast<size_t>(end_ - ptr_) < size) {
+    ptr_ = static_cast<char*>(std::malloc(kBlockSize));
+    CHECK(ptr_ != nullptr) << "Failed to allocate " << kBlockSize << " bytes";
+    end_ = ptr_ + kBlockSize;
+    blocks_.push_back(ptr_);
+  }
+  void* result = ptr_;
+  ptr_ += size;
+  return result;
+}
+
+void* HloArena::Allocate(size_t size) {
+  size_t allocation_size = sizeof(AllocationHeader) + RoundUpToAlignment(size);
+  HloArena* arena = current_arena;
+
+  void* ptr;
+  if (arena != nullptr) {
+    ptr = arena->AllocateFromBlocks(allocation_size);
+    arena->Ref();
+  } else {
+    ptr = ::operator new(allocation_size);
+  }
+
+  AllocationHeader* header = new (ptr) AllocationHeader{arena};
+  return header + 1;
+}
+
+void HloArena::Deallocate(void* ptr) {
+  if (ptr == nullptr) return;
+  AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+  if (HloArena* arena = header->arena) {
+    arena->Unref();
+  } else {
+    ::operator delete(header);
+  }
+}
+
+size_t HloArena::allocated_bytes() const {
+  absl::MutexLock lock(&mu_);
+  return allocated_bytes_;
+}
+
+}  // namespace xla
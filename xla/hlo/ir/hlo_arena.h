@@ -0,0 +1,87 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_HLO_IR_HLO_ARENA_H_
+#define XLA_HLO_IR_HLO_ARENA_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "tsl/platform/refcount.h"
+
+namespace xla {
+
+// A bump-pointer arena for IR objects (e.g. HloInstruction) of large HLO
+// modules. Allocating all instructions of a module from a few large blocks
+// avoids the malloc/free overhead of individual allocations and places
+// instructions created together next to each other in memory, which improves
+// locality of instruction traversals.
+//
+// Objects are allocated from the arena of the current thread (see Scope), and
+// from the heap if there is none. Deallocating an object doesn't free its
+// memory, instead every live object holds a reference to its arena and all
+// arena memory is released at once when the last reference is dropped. This
+// makes it safe to move objects between modules or to keep them alive longer
+// than the module that owns the arena, although memory of removed objects is
+// not reused until the whole arena is released.
+//
+// This class is thread-safe.
+class HloArena : public tsl::core::RefCounted {
+ public:
+  HloArena() = default;
+
+  // Makes `arena` the arena for all allocations on the current thread for the
+  // lifetime of the scope. `arena` can be nullptr to allocate from the heap.
+  class Scope {
+   public:
+    explicit Scope(HloArena* arena);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    HloArena* previous_;
+  };
+
+  // Returns the arena of the current thread, or nullptr if there is none.
+  static HloArena* current();
+
+  // Allocates `size` bytes from the arena of the current thread, or from the
+  // heap if there is none. Memory must be released with Deallocate().
+  static void* Allocate(size_t size);
+  static void Deallocate(void* ptr);
+
+  // Returns the number of bytes allocated from the arena, including the
+  // memory of objects that were already deallocated.
+  size_t allocated_bytes() const;
+
+ private:
+  ~HloArena() override;
+
+  void* AllocateFromBlocks(size_t size);
+
+  mutable absl::Mutex mu_;
+  std::vector<char*> blocks_ ABSL_GUARDED_BY(mu_);
+  char* ptr_ ABSL_GUARDED_BY(mu_) = nullptr;
+  char* end_ ABSL_GUARDED_BY(mu_) = nullptr;
+  size_t allocated_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace xla
+
+#endif  // XLA_HLO_IR_HLO_ARENA_H_
@@ -0,0 +1,118 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/hlo/ir/hlo_arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/refcount.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla {
+namespace {
+
+TEST(HloArenaTest, AllocatesFromHeapWithoutScope) {
+  EXPECT_EQ(HloArena::current(), nullptr);
+  void* ptr = HloArena::Allocate(100);
+  std::memset(ptr, 0xff, 100);
+  HloArena::Deallocate(ptr);
+}
+
+TEST(HloArenaTest, AllocatesFromCurrentArena) {
+  tsl::core::RefCountPtr<HloArena> arena(new HloArena());
+
+  std::vector<void*> ptrs;
+  {
+    HloArena::Scope scope(arena.get());
+    EXPECT_EQ(HloArena::current(), arena.get());
+    for (size_t size : {1, 8, 100, 1000, 100000}) {
+      void* ptr = HloArena::Allocate(size);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t),
+                0);
+      std::memset(ptr, 0xff, size);
+      ptrs.push_back(ptr);
+    }
+
+    // Nested scopes can disable the arena.
+    HloArena::Scope heap_scope(nullptr);
+    EXPECT_EQ(HloArena::current(), nullptr);
+  }
+  EXPECT_EQ(HloArena::current(), nullptr);
+  EXPECT_GE(arena->allocated_bytes(), 1 + 8 + 100 + 1000 + 100000);
+
+  for (void* ptr : ptrs) {
+    HloArena::Deallocate(ptr);
+  }
+}
+
+TEST(HloArenaTest, AllocationsOutliveArenaOwner) {
+  tsl::core::RefCountPtr<HloArena> arena(new HloArena());
+
+  void* ptr;
+  {
+    HloArena::Scope scope(arena.get());
+    ptr = HloArena::Allocate(sizeof(int64_t));
+  }
+
+  // The allocation keeps the arena alive.
+  arena.reset();
+  *static_cast<int64_t*>(ptr) = 42;
+  EXPECT_EQ(*static_cast<int64_t*>(ptr), 42);
+  HloArena::Deallocate(ptr);
+}
+
+TEST(HloArenaTest, ConcurrentAllocations) {
+  tsl::core::RefCountPtr<HloArena> arena(new HloArena());
+  constexpr int kNumThreads = 8;
+  constexpr int kAllocationsPerThread = 1000;
+
+  absl::Mutex mu;
+  std::vector<void*> ptrs;
+  {
+    tsl::thread::ThreadPool pool(tsl::Env::Default(), "test", kNumThreads);
+    for (int i = 0; i < kNumThreads; ++i) {
+      pool.Schedule([&, i] {
+        HloArena::Scope scope(arena.get());
+        std::vector<void*> thread_ptrs;
+        for (int j = 0; j < kAllocationsPerThread; ++j) {
+          void* ptr = HloArena::Allocate(sizeof(int));
+          *static_cast<int*>(ptr) = i * kAllocationsPerThread + j;
+          thread_ptrs.push_back(ptr);
+        }
+        absl::MutexLock lock(&mu);
+        ptrs.insert(ptrs.end(), thread_ptrs.begin(), thread_ptrs.end());
+      });
+    }
+  }
+
+  // Allocations don't overlap, so every value must have survived.
+  std::vector<bool> seen(kNumThreads * kAllocationsPerThread);
+  for (void* ptr : ptrs) {
+    seen[*static_cast<int*>(ptr)] = true;
+    HloArena::Deallocate(ptr);
+  }
+  for (bool value_seen : seen) {
+    EXPECT_TRUE(value_seen);
+  }
+}
+
+}  // namespace
+}  // namespace xla
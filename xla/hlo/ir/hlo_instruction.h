@@ -50,6 +50,7 @@ limitations under the License.
 #include "xla/hlo/ir/backend_config.h"
 #include "xla/hlo/ir/collective_device_list.h"
 #include "xla/hlo/ir/dfs_hlo_visitor.h"
+#include "xla/hlo/ir/hlo_arena.h"
 #include "xla/hlo/ir/hlo_clone_context.h"
 #include "xla/hlo/ir/hlo_domain_metadata.h"
 #include "xla/hlo/ir/hlo_opcode.h"
@@ -690,6 +691,11 @@ class HloInstruction {
 
   virtual ~HloInstruction() { DetachFromOperandsAndUsers(); }
 
+  // Instructions are allocated from the arena of the current thread if there
+  // is one (see HloArena and HloModule::EnableInstructionArena).
+  static void* operator new(size_t size) { return HloArena::Allocate(size); }
+  static void operator delete(void* ptr) { HloArena::Deallocate(ptr); }
+
   // Detaches an instruction from its operands and users. That is, remove the
   // instruction from each operand's user set and user's operand set.
   void DetachFromOperandsAndUsers();
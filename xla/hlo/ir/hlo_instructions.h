@@ -1294,6 +1294,11 @@ class HloConstantInstruction : public HloInstruction {
   }
   // Returns whether there is literal associated with this instruction.
   bool HasLiteral() const { return static_cast<bool>(literal_); }
+  // Sets the literal of a constant created without one. The literal shape must
+  // be compatible with the instruction shape.
+  void set_literal(Literal literal) {
+    literal_ = std::make_shared<Literal>(std::move(literal));
+  }
   // Returns a serialized representation of this instruction.
   HloInstructionProto ToProto() const override;
 
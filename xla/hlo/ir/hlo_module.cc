@@ -37,13 +37,16 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xla/hlo/ir/hlo_casting_utils.h"
 #include "xla/hlo/ir/hlo_clone_context.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_input_output_alias_config.h"
 #include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/hlo/ir/hlo_schedule.h"
 #include "xla/hlo/ir/hlo_sharding.h"
+#include "xla/literal.h"
 #include "xla/map_util.h"
 #include "xla/printer.h"
 #include "xla/service/compilation_environments.h"
@@ -171,13 +174,13 @@ HloComputation* HloModule::AddComputationInternal(
     // next_unique_id_ to the one greater than the max unique id of any
     // instruction (or the computation) to avoid ID collisions.
     computation_name_uniquer_.GetUniqueName(computation->name());
+    int next_unique_id = next_unique_id_.load(std::memory_order_relaxed);
     for (auto* instruction : computation->instructions()) {
       instruction_name_uniquer_.GetUniqueName(instruction->name());
-      next_unique_id_ = std::max(next_unique_id_, instruction->unique_id() + 1);
-    }
-    if (next_unique_id_ < computation->unique_id() + 1) {
-      next_unique_id_ = computation->unique_id() + 1;
+      next_unique_id = std::max(next_unique_id, instruction->unique_id() + 1);
     }
+    next_unique_id = std::max(next_unique_id, computation->unique_id() + 1);
+    next_unique_id_.store(next_unique_id, std::memory_order_relaxed);
   }
 
   computation->set_parent(this);
@@ -695,6 +698,55 @@ absl::StatusOr<std::unique_ptr<HloModule>> HloModule::CreateFromProto(
   return std::move(module);
 }
 
+absl::StatusOr<std::unique_ptr<HloModule>> HloModule::CreateFromProto(
+    HloModuleProto&& proto, const HloModuleConfig& module_config,
+    bool prohibit_empty_literal) {
+  // Convert constant literals upfront and release their protos right away, so
+  // that we never hold two copies of all constants at the same time.
+  absl::flat_hash_map<int64_t, Literal> literals;
+  for (HloComputationProto& computation : *proto.mutable_computations()) {
+    for (HloInstructionProto& instruction :
+         *computation.mutable_instructions()) {
+      if (instruction.opcode() != HloOpcodeString(HloOpcode::kConstant) ||
+          !instruction.has_literal()) {
+        continue;
+      }
+      TF_ASSIGN_OR_RETURN(Literal literal,
+                          Literal::CreateFromProto(instruction.literal(),
+                                                   prohibit_empty_literal));
+      instruction.clear_literal();
+      bool inserted =
+          literals.emplace(instruction.id(), std::move(literal)).second;
+      TF_RET_CHECK(inserted) << "Duplicate instruction id " << instruction.id();
+    }
+  }
+
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloModule> module,
+                      CreateFromProto(std::as_const(proto), module_config,
+                                      prohibit_empty_literal));
+
+  // Instructions keep their proto ids, which are unique within the module.
+  for (HloComputation* computation : module->computations()) {
+    for (HloInstruction* instruction : computation->instructions()) {
+      if (instruction->opcode() != HloOpcode::kConstant) {
+        continue;
+      }
+      auto it = literals.find(instruction->unique_id());
+      if (it == literals.end()) {
+        continue;
+      }
+      // Literal's shape may have no/different tiling info.
+      TF_RET_CHECK(Shape::Equal().MinorToMajorOnlyInLayout()(
+          it->second.shape(), instruction->shape()))
+          << it->second.shape().ToString(true) << " vs "
+          << instruction->shape().ToString(true);
+      Cast<HloConstantInstruction>(instruction)
+          ->set_literal(std::move(it->second));
+    }
+  }
+  return std::move(module);
+}
+
 /* static */
 absl::StatusOr<HloModuleConfig> HloModule::CreateModuleConfigFromShape(
     const ProgramShape& program_shape, const DebugOptions& debug_options,
@@ -999,8 +1051,9 @@ class FingerprintMap {
   uint64_t GetFingerprint(const HloComputation* computation) {
     auto result = fingerprint_map_.try_emplace(computation, 0);
     if (result.second) {
-      result.first->second =
-          tsl::Fingerprint64(computation->ToString(print_options_));
+      FingerprintPrinter printer;
+      computation->Print(&printer, print_options_);
+      result.first->second = std::move(printer).ToFingerprint128().low64;
     }
     return result.first->second;
   }
@@ -1176,7 +1229,9 @@ HloComputation* HloModule::GetComputationWithName(absl::string_view name) {
 }
 
 std::string HloModule::GetFingerprint128(const HloPrintOptions& options) const {
-  const tsl::Fprint128 fingerprint = tsl::Fingerprint128(ToString(options));
+  FingerprintPrinter printer;
+  Print(&printer, options);
+  const tsl::Fprint128 fingerprint = std::move(printer).ToFingerprint128();
   absl::string_view fp_bytes(reinterpret_cast<const char*>(&fingerprint),
                              sizeof(tsl::Fprint128));
   return absl::BytesToHexString(fp_bytes);
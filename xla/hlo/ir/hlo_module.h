@@ -33,6 +33,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "xla/hlo/ir/dynamic_parameter_binding.h"
+#include "xla/hlo/ir/hlo_arena.h"
 #include "xla/hlo/ir/hlo_clone_context.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_input_output_alias_config.h"
@@ -49,6 +50,7 @@ limitations under the License.
 #include "xla/tsl/lib/gtl/iterator_range.h"
 #include "xla/xla.pb.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/refcount.h"
 
 namespace xla {
 
@@ -355,6 +357,21 @@ class HloModule {
   // Gets the number of instructions in this module.
   int64_t instruction_count() const;
 
+  // Enables allocation of instructions from an arena owned by the module, which
+  // improves compile times of large modules. Instructions are allocated from
+  // the arena only on threads that have an active HloArena::Scope for it (e.g.
+  // while HloPassPipeline runs passes on the module). The arena memory is
+  // released when the module and all instructions allocated from it are
+  // destroyed.
+  void EnableInstructionArena() {
+    if (instruction_arena_ == nullptr) {
+      instruction_arena_.reset(new HloArena());
+    }
+  }
+
+  // Returns the instruction arena of the module, or nullptr if it's disabled.
+  HloArena* instruction_arena() const { return instruction_arena_.get(); }
+
   // Deallocate removed instructions in each computation.
   void Cleanup() {
     for (auto& comp : computations_) {
@@ -456,6 +473,13 @@ class HloModule {
   static absl::StatusOr<std::unique_ptr<HloModule>> CreateFromProto(
       const HloModuleProto& proto, const HloModuleConfig& module_config,
       bool prohibit_empty_literal = true);
+  // Same as above, but consumes `proto`. Constant literals are dropped from the
+  // proto as soon as they are converted, so for modules with large constants
+  // peak memory usage stays close to the size of the proto instead of twice
+  // that. `proto` is left in a valid but unspecified state.
+  static absl::StatusOr<std::unique_ptr<HloModule>> CreateFromProto(
+      HloModuleProto&& proto, const HloModuleConfig& module_config,
+      bool prohibit_empty_literal = true);
 
   // Convert an HloModule to or from a proto that includes module configuration
   HloModuleProtoWithConfig ToProtoWithConfig() const;
@@ -495,11 +519,10 @@ class HloModule {
   // Returns the NameUniquer for uniquing computation names in this module.
   NameUniquer& computation_name_uniquer() { return computation_name_uniquer_; }
 
-  // Assign a new unique dense id for an instruction
+  // Assign a new unique dense id for an instruction. Thread-safe, so that
+  // instructions can be added to different computations concurrently.
   int NewUniqueInstructionId() {
-    int result = next_unique_id_;
-    next_unique_id_++;
-    return result;
+    return next_unique_id_.fetch_add(1, std::memory_order_relaxed);
   }
 
   // input_output_alias_config indicates the list of aliased buffers that are
@@ -704,7 +727,8 @@ class HloModule {
   CompilationEnvironments& comp_envs() const { return *comp_envs_; }
 
   // Get 128-bit fingerprint of the module by printing it using the given print
-  // options.
+  // options. The printed text is hashed as it is produced and never
+  // materialized, and the fingerprint is stable across processes.
   std::string GetFingerprint128(const HloPrintOptions& options =
                                     HloPrintOptions::ModuleFingerprint()) const;
 
@@ -749,7 +773,10 @@ class HloModule {
   // unique per module.
   NameUniquer computation_name_uniquer_{/*separator=*/"."};
   NameUniquer instruction_name_uniquer_{/*separator=*/"."};
-  int next_unique_id_ = 0;
+  std::atomic<int> next_unique_id_{0};
+
+  // Arena for instructions of the module, see EnableInstructionArena().
+  tsl::core::RefCountPtr<HloArena> instruction_arena_;
 
   // Used to keep track of the next unique module id that should be assigned.
   static std::atomic<int> next_unique_module_id_;
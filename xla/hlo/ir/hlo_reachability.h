@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef XLA_HLO_IR_HLO_REACHABILITY_H_
 #define XLA_HLO_IR_HLO_REACHABILITY_H_
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -141,34 +144,48 @@ class HloReachabilityMap {
  private:
   // A dynamically sized bit-set implementation specialized for this use case
   // providing fast bitwise OR (not available in tsl::gtl::BitMap).
+  //
+  // Storage only extends to the highest bit that has been set; words past the
+  // end of `vector_` are implicitly zero. When instructions are indexed in
+  // post order, an instruction is only reachable from instructions with
+  // smaller indices, so the sets built by Build() form a triangular matrix and
+  // take about half the memory (and half the union work) of dense N x N bits.
   class BitSet {
    public:
     BitSet() = default;
-    explicit BitSet(size_t size)
-        : size_(size), vector_((size + kBits - 1) / kBits, 0) {}
+    explicit BitSet(size_t size) : size_(size) {}
 
     // Returns the bit at the given index.
     bool Get(Index index) const {
       DCHECK(index >= 0 && index < size_);
-      return vector_[index / kBits] & (1ull << (index % kBits));
+      const size_t word = index / kBits;
+      return word < vector_.size() &&
+             (vector_[word] & (1ull << (index % kBits)));
     }
 
     // Sets the bit at the given index.
     void Set(Index index) {
       DCHECK(index >= 0 && index < size_);
-      vector_[index / kBits] |= 1ull << (index % kBits);
+      const size_t word = index / kBits;
+      if (word >= vector_.size()) {
+        vector_.resize(word + 1, 0);
+      }
+      vector_[word] |= 1ull << (index % kBits);
     }
 
     // Sets this bit-set to union of this bit-set and `other`.
     void operator|=(const BitSet& other) {
       if (this == &other) return;
       DCHECK(size_ == other.size_);
+      const size_t num_words = other.vector_.size();
+      if (num_words > vector_.size()) {
+        vector_.resize(num_words, 0);
+      }
 
       // Ease the work of the auto-vectorizer.
       const Word* a = vector_.data();
       const Word* b = other.vector_.data();
       Word* __restrict out = vector_.data();
-      size_t num_words = vector_.size();
       for (size_t i = 0; i < num_words; ++i) {
         out[i] = a[i] | b[i];
       }
@@ -178,7 +195,13 @@ class HloReachabilityMap {
     void SetToZero() { absl::c_fill(vector_, 0); }
 
     bool operator==(const BitSet& other) const {
-      return vector_ == other.vector_;
+      const std::vector<Word>& shorter =
+          vector_.size() <= other.vector_.size() ? vector_ : other.vector_;
+      const std::vector<Word>& longer =
+          vector_.size() <= other.vector_.size() ? other.vector_ : vector_;
+      return std::equal(shorter.begin(), shorter.end(), longer.begin()) &&
+             std::all_of(longer.begin() + shorter.size(), longer.end(),
+                         [](Word word) { return word == 0; });
     }
     bool operator!=(const BitSet& other) const { return !(*this == other); }
 
@@ -186,7 +209,7 @@ class HloReachabilityMap {
     using Word = uint64_t;
     static constexpr size_t kBits = 64;
 
-    size_t size_;  // Number of bits in the set.
+    size_t size_ = 0;  // Number of bits in the set.
     std::vector<Word> vector_;
   };
 
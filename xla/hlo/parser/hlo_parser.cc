@@ -4125,7 +4125,8 @@ bool HloParserImpl::SetValueInLiteralHelper(LocTy loc, ParsedElemT value,
   }
 
   // Check that the index is in range and assign into the literal
-  if (index >= ShapeUtil::ElementsIn(literal->shape())) {
+  absl::Span<LiteralNativeT> data = literal->data<LiteralNativeT>();
+  if (index >= static_cast<int64_t>(data.size())) {
     return Error(loc, StrCat("tries to set value ", StringifyValue(value),
                              " to a literal in shape ",
                              ShapeUtil::HumanString(literal->shape()),
@@ -4193,9 +4194,8 @@ bool HloParserImpl::SetValueInLiteralHelper(LocTy loc, ParsedElemT value,
       return false;
     }
   }
-  literal->data<LiteralNativeT>().at(index) =
-      LiteralNativeFromRealImag<LiteralNativeT>(literal_real_value,
-                                                literal_imag_value);
+  data[index] = LiteralNativeFromRealImag<LiteralNativeT>(literal_real_value,
+                                                          literal_imag_value);
   return true;
 }
 
@@ -4524,7 +4524,11 @@ bool HloParserImpl::ParseDenseLiteral(Literal* literal, const Shape& shape) {
     }  // end of switch
   } while (nest_level > 0);
 
-  *literal = literal->Relayout(shape.layout());
+  // The literal was built in the default layout; only pay for a copy of the
+  // (possibly very large) buffer when the requested layout differs.
+  if (literal->shape().layout() != shape.layout()) {
+    *literal = literal->Relayout(shape.layout());
+  }
   return true;
 }
 
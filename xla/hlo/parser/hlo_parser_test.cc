@@ -42,6 +42,7 @@ limitations under the License.
 #include "xla/hlo/parser/hlo_lexer.h"
 #include "xla/layout.h"
 #include "xla/layout_util.h"
+#include "xla/literal.h"
 #include "xla/service/hlo_module_config.h"
 #include "xla/service/pattern_matcher.h"
 #include "xla/service/pattern_matcher_gmock.h"
@@ -3158,6 +3159,31 @@ ENTRY %ConstantWithExp.v4 () -> f32[] {
   // printed as "300".
 }
 
+TEST_F(HloParserTest, ConstantInDefaultAndTransposedLayouts) {
+  const std::string original = R"(HloModule ConstantLayouts_module
+
+ENTRY %ConstantLayouts () -> (f32[2,3], f32[2,3]) {
+  %row_major = f32[2,3]{1,0} constant({{1, 2, 3}, {4, 5, 6}})
+  %col_major = f32[2,3]{0,1} constant({{1, 2, 3}, {4, 5, 6}})
+  ROOT %tuple = (f32[2,3]{1,0}, f32[2,3]{0,1}) tuple(%row_major, %col_major)
+}
+
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnUnverifiedModule(original));
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  for (const HloInstruction* constant : root->operands()) {
+    const Literal& literal = constant->literal();
+    EXPECT_TRUE(LayoutUtil::Equal(literal.shape().layout(),
+                                  constant->shape().layout()));
+    for (int64_t i = 0; i < 2; ++i) {
+      for (int64_t j = 0; j < 3; ++j) {
+        EXPECT_EQ(literal.Get<float>({i, j}), 3 * i + j + 1);
+      }
+    }
+  }
+}
+
 TEST_F(HloParserTest, ShortConstant) {
   const std::string original =
       R"(HloModule ShortConstant_module, entry_computation_layout={()->f32[67,89]{1,0}}
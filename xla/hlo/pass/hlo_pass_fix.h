@@ -59,6 +59,10 @@ class HloPassFix : public Pass {
     return !run_state.changed.empty();
   }
 
+  // Running the wrapped computation pass concurrently on computations would
+  // skip the fixed point iteration in Run().
+  bool IsComputationPass() const override { return false; }
+
   using HloPassInterface::RunOnModuleGroup;
   absl::StatusOr<bool> RunOnModuleGroup(
       HloModuleGroup* module_group,
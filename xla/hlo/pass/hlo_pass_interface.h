@@ -101,6 +101,18 @@ class HloPassInterface {
     return absl::OkStatus();
   }
 
+  // Returns true if HloPassPipeline may run this pass incrementally, i.e. only
+  // on computations that the pass hasn't processed before. This requires that:
+  //
+  //  * the pass transforms every computation independently of the rest of the
+  //    module (including the bodies of the computations it calls),
+  //  * RunOnChangedComputations visits the computations in
+  //    `changed_last_iteration` and reports all computations that it changed
+  //    or created in `changed_this_iteration`, and
+  //  * the pass is idempotent: running it again on a computation it produced
+  //    doesn't change the computation.
+  virtual bool IsComputationLocal() const { return false; }
+
   // Run the pass on the given HLO module group for specified
   // `execution_threads`. Empty `execution_threads` list means all execution
   // threads are included. Returns whether it modified the module group.
@@ -117,6 +129,11 @@ class HloPassInterface {
       const absl::flat_hash_set<absl::string_view>& execution_threads) = 0;
 
   virtual bool IsPassPipeline() { return false; }
+
+  // Returns true if the pass is an HloComputationPass whose Run() only calls
+  // RunOnComputation on every computation, so that HloPassPipeline may call
+  // RunOnComputation concurrently on different computations instead.
+  virtual bool IsComputationPass() const { return false; }
 };
 
 // Base class for passes which are module-scoped.
@@ -145,6 +162,71 @@ class HloModulePass : public HloPassInterface {
   virtual void UpdateLayout(Shape* shape) {}
 };
 
+// Base class for passes which transform each computation on its own, without
+// any state shared across computations. HloPassPipeline may run such passes on
+// different computations concurrently if they are allowlisted (see
+// HloPassPipeline::set_thread_pool). It then calls RunOnComputation directly,
+// so subclasses that override Run() must also override IsComputationPass() to
+// return false.
+//
+// RunOnComputation must only mutate the computation it is given; it may read,
+// but not modify, the computations it calls. The only exception are fusion
+// computations, which may also update their fusion instruction and its users
+// (e.g. when removing fusion parameters or fusion outputs), so the pipeline
+// never runs them concurrently. RunOnComputation must not add computations to
+// or remove them from the module. Adding instructions to `computation` is
+// allowed, as instruction name and id allocation in HloModule is thread-safe.
+class HloComputationPass : public HloModulePass {
+ public:
+  // Runs the pass on a single computation. Returns whether the computation
+  // has been changed.
+  virtual absl::StatusOr<bool> RunOnComputation(HloComputation* computation) = 0;
+
+  // Returns true if the pass should run on `computation`.
+  virtual bool ShouldRunOnComputation(const HloComputation* computation) const {
+    return true;
+  }
+
+  // Runs the pass on all computations of the module sequentially.
+  using HloPassInterface::Run;
+  absl::StatusOr<bool> Run(HloModule* module,
+                           const absl::flat_hash_set<absl::string_view>&
+                               execution_threads) override {
+    bool changed = false;
+    for (HloComputation* computation :
+         module->computations(execution_threads)) {
+      if (!ShouldRunOnComputation(computation)) {
+        continue;
+      }
+      TF_ASSIGN_OR_RETURN(bool computation_changed,
+                          RunOnComputation(computation));
+      changed |= computation_changed;
+    }
+    return changed;
+  }
+
+  absl::Status RunOnChangedComputations(
+      HloModule* module, RunState* run_state,
+      const absl::flat_hash_set<absl::string_view>& execution_threads)
+      override {
+    for (HloComputation* computation :
+         module->computations(execution_threads)) {
+      if (!run_state->changed_last_iteration.contains(computation) ||
+          !ShouldRunOnComputation(computation)) {
+        continue;
+      }
+      TF_ASSIGN_OR_RETURN(bool computation_changed,
+                          RunOnComputation(computation));
+      if (computation_changed) {
+        run_state->changed_this_iteration.insert(computation);
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  bool IsComputationPass() const override { return true; }
+};
+
 // Base class for passes which are module-group scoped. These passes cannot run
 // on an HLO module.
 class HloModuleGroupPass : public HloPassInterface {
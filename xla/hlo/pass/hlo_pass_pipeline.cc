@@ -15,20 +15,34 @@ limitations under the License.
 
 #include "xla/hlo/pass/hlo_pass_pipeline.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_arena.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
 #include "xla/service/dump.h"
 #include "xla/service/hlo_graph_dumper.h"
 #include "xla/service/hlo_proto_util.h"
 #include "xla/status_macros.h"
 #include "xla/types.h"
 #include "xla/util.h"
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/status.h"
 #include "tsl/profiler/lib/scoped_annotation.h"
@@ -43,6 +57,8 @@ void RecordPassStartMetadata(HloModule& module, const std::string& pass_name,
   // An HloPassMetadata was just created so absl::Status should always be OK.
   TF_CHECK_OK(module.metadata()->set_current_pass_name(pass_name));
   TF_CHECK_OK(module.metadata()->set_current_pass_pipeline_name(pipeline_name));
+  TF_CHECK_OK(module.metadata()->set_current_pass_instruction_count_before(
+      module.instruction_count()));
 }
 
 void RecordPassStartMetadata(HloModuleGroup& module_group,
@@ -62,6 +78,9 @@ absl::Status AttemptRecordPassEndMetadata(HloModule& module,
       module.metadata()->set_current_pass_module_id(module.unique_id()));
   TF_RETURN_IF_ERROR(
       module.metadata()->set_current_pass_module_changed(module_changed));
+  TF_RETURN_IF_ERROR(
+      module.metadata()->set_current_pass_instruction_count_after(
+          module.instruction_count()));
   TF_RETURN_IF_ERROR(module.metadata()->RecordPassEnd());
   return absl::OkStatus();
 }
@@ -165,6 +184,7 @@ absl::StatusOr<bool> HloPassPipeline::RunPassesInternal(
                         /*module_changed=*/false);
 
   bool changed = false;
+  ComputationFingerprints fingerprints;
   for (int i = 0; i < passes.size(); i++) {
     HloPassInterface* pass = passes[i];
     std::string pass_name = std::string(pass->name());
@@ -179,12 +199,26 @@ absl::StatusOr<bool> HloPassPipeline::RunPassesInternal(
       compilation_stats_->StartPass(pass_name);
     }
     RecordPassStartMetadata(*hlo, pass_name, pipeline_name);
-    auto status_or_changed = RunHelper(pass, hlo, execution_threads);
+    bool run_incrementally = incremental_ && pass->IsComputationLocal();
+    bool run_in_parallel = !run_incrementally && thread_pool_ != nullptr &&
+                           pass->IsComputationPass() &&
+                           parallel_passes_.contains(pass_name);
+    auto status_or_changed =
+        run_incrementally
+            ? RunIncrementally(pass, hlo, execution_threads, fingerprints)
+        : run_in_parallel
+            ? RunInParallel(static_cast<HloComputationPass*>(pass), hlo,
+                            execution_threads)
+            : RunHelper(pass, hlo, execution_threads);
     if (auto status = status_or_changed.status(); !status.ok()) {
       compilation_stats_->RecordPassError(
           pass_name, absl::StatusCodeToString(status.code()));
     }
     TF_ASSIGN_OR_RETURN(bool pass_changed, status_or_changed);
+    if (pass_changed && !run_incrementally) {
+      // We don't know which computations were changed by the pass.
+      fingerprints.clear();
+    }
     if (!dump_regex.empty() && (pass_changed || dump_regex != ".*")) {
       MaybeDumpHloAndSaveFilenames(*hlo,
                                    /*after_pass_name=*/pass_name,
@@ -210,6 +244,146 @@ absl::StatusOr<bool> HloPassPipeline::RunPassesInternal(
   return changed;
 }
 
+namespace {
+tsl::Fprint128 ComputationFingerprint(const HloComputation& computation) {
+  // Constant values can change the result of a pass (e.g. constant folding),
+  // so we can't use default fingerprint options that skip them.
+  return tsl::Fingerprint128(
+      computation.ToString(HloPrintOptions::ModuleFingerprint()
+                               .set_print_only_essential_constants(false)
+                               .set_print_large_constants(true)));
+}
+}  // namespace
+
+absl::StatusOr<bool> HloPassPipeline::RunIncrementally(
+    HloPassInterface* pass, HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads,
+    ComputationFingerprints& fingerprints) {
+  auto fingerprint = [&](const HloComputation* computation) {
+    auto [it, inserted] = fingerprints.try_emplace(computation);
+    if (inserted) {
+      it->second = ComputationFingerprint(*computation);
+    }
+    return it->second;
+  };
+
+  auto& processed = processed_computations_[pass];
+  HloPassInterface::RunState run_state;
+  for (HloComputation* computation : module->computations(execution_threads)) {
+    if (!processed.contains(fingerprint(computation))) {
+      run_state.changed_last_iteration.insert(computation);
+    }
+  }
+
+  if (run_state.changed_last_iteration.empty()) {
+    VLOG(1) << "  Skipping HLO pass " << pass->name()
+            << ": no computations changed since it last ran";
+    return false;
+  }
+  VLOG(1) << "  Running HLO pass " << pass->name() << " on "
+          << run_state.changed_last_iteration.size() << " of "
+          << module->computation_count() << " computations";
+
+  TF_RETURN_IF_ERROR(
+      pass->RunOnChangedComputations(module, &run_state, execution_threads));
+  module->Cleanup();
+
+  bool changed = !run_state.changed_this_iteration.empty();
+  if (changed) {
+    // Invalidate fingerprints of changed computations, and of computations
+    // removed from the module, as their addresses might get reused.
+    for (const HloComputation* computation :
+         run_state.changed_this_iteration) {
+      fingerprints.erase(computation);
+    }
+    absl::flat_hash_set<const HloComputation*> live_computations(
+        module->computations().begin(), module->computations().end());
+    absl::erase_if(fingerprints, [&](const auto& entry) {
+      return !live_computations.contains(entry.first);
+    });
+  }
+
+  for (HloComputation* computation : module->computations(execution_threads)) {
+    processed.insert(fingerprint(computation));
+  }
+  return changed;
+}
+
+absl::StatusOr<bool> HloPassPipeline::RunInParallel(
+    HloComputationPass* pass, HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  // Assign each computation the length of the longest call chain from a root
+  // computation. Callers always have a smaller depth than their callees.
+  std::vector<HloComputation*> post_order =
+      module->MakeComputationPostOrder(execution_threads);
+  absl::flat_hash_map<const HloComputation*, int64_t> depth;
+  for (const HloComputation* computation : post_order) {
+    depth[computation] = 0;
+  }
+  int64_t max_depth = 0;
+  for (auto it = post_order.rbegin(); it != post_order.rend(); ++it) {
+    int64_t callee_depth = depth[*it] + 1;
+    for (const HloInstruction* instruction : (*it)->instructions()) {
+      for (const HloComputation* callee : instruction->called_computations()) {
+        auto callee_it = depth.find(callee);
+        if (callee_it != depth.end() && callee_it->second < callee_depth) {
+          callee_it->second = callee_depth;
+          max_depth = std::max(max_depth, callee_depth);
+        }
+      }
+    }
+  }
+
+  std::vector<std::vector<HloComputation*>> waves(max_depth + 1);
+  for (HloComputation* computation : post_order) {
+    if (pass->ShouldRunOnComputation(computation)) {
+      waves[depth[computation]].push_back(computation);
+    }
+  }
+
+  bool changed = false;
+  for (auto wave = waves.rbegin(); wave != waves.rend(); ++wave) {
+    // Fusion computations might update their fusion instructions, which can
+    // share operands and users with sibling fusions, and the entry computation
+    // might update the module config. We run them one by one after all other
+    // computations of the wave.
+    std::vector<HloComputation*> concurrent;
+    std::vector<HloComputation*> sequential;
+    for (HloComputation* computation : *wave) {
+      if (computation->IsFusionComputation() ||
+          computation->IsEntryComputation()) {
+        sequential.push_back(computation);
+      } else {
+        concurrent.push_back(computation);
+      }
+    }
+
+    std::vector<absl::StatusOr<bool>> results(concurrent.size());
+    tsl::BlockingCounter counter(concurrent.size());
+    for (size_t i = 0; i < concurrent.size(); ++i) {
+      thread_pool_->Schedule([&, i] {
+        HloArena::Scope arena_scope(module->instruction_arena());
+        results[i] = pass->RunOnComputation(concurrent[i]);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+
+    for (absl::StatusOr<bool>& result : results) {
+      TF_ASSIGN_OR_RETURN(bool computation_changed, std::move(result));
+      changed |= computation_changed;
+    }
+    for (HloComputation* computation : sequential) {
+      TF_ASSIGN_OR_RETURN(bool computation_changed,
+                          pass->RunOnComputation(computation));
+      changed |= computation_changed;
+    }
+  }
+
+  module->Cleanup();
+  return changed;
+}
+
 std::vector<HloPassInterface*> HloPassPipeline::GetEnabledPasses(
     const DebugOptions& debug_options) {
   if (debug_options.xla_disable_all_hlo_passes()) {
@@ -295,6 +469,9 @@ absl::StatusOr<bool> HloPassPipeline::Run(
   VLOG(1) << "Running HLO pass pipeline on module " << module->name() << ": "
           << name();
 
+  // Instructions created by the passes belong to `module`, so we allocate them
+  // from its arena (or from the heap if the module doesn't have one).
+  HloArena::Scope arena_scope(module->instruction_arena());
   return RunPassesInternal(module, module->config().debug_options(),
                            execution_threads);
 }
@@ -19,14 +19,22 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_module_group.h"
 #include "xla/hlo/pass/hlo_pass_interface.h"
 #include "xla/service/compilation_stats.h"
 #include "xla/types.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 
@@ -89,6 +97,31 @@ class HloPassPipeline : public HloPassInterface {
 
   bool IsPassPipeline() override { return true; }
 
+  // Enables incremental execution of passes that are computation local (see
+  // HloPassInterface::IsComputationLocal). For each such pass the pipeline
+  // remembers the fingerprints of the computations the pass has produced, also
+  // across Run() invocations, and runs the pass only on computations whose
+  // fingerprint it hasn't seen before. The pass is skipped entirely if no
+  // computation changed since it last ran. Only applies to HloModule runs.
+  void set_incremental(bool incremental) { incremental_ = incremental; }
+  bool incremental() const { return incremental_; }
+
+  // Runs the computation passes (see HloComputationPass) named in
+  // `parallel_passes` on independent computations of a module concurrently in
+  // `thread_pool`. Only passes known to be safe to run on computations
+  // concurrently belong in the allowlist; all other passes run sequentially.
+  // Computations are processed in waves: each wave contains computations at
+  // the same call depth and waves run from the deepest one, so a computation
+  // never runs concurrently with its callers or callees. Unique ids and names
+  // of instructions added within one wave depend on the scheduling order. Only
+  // applies to HloModule runs, and only if the pass doesn't run incrementally.
+  // `thread_pool` may be null and must otherwise outlive the pipeline runs.
+  void set_thread_pool(tsl::thread::ThreadPool* thread_pool,
+                       absl::flat_hash_set<std::string> parallel_passes) {
+    thread_pool_ = thread_pool;
+    parallel_passes_ = std::move(parallel_passes);
+  }
+
   // Return size of passes_.
   int PassesSize() { return passes_.size(); }
   // Return reference to pass specified by index.
@@ -151,11 +184,54 @@ class HloPassPipeline : public HloPassInterface {
     return changed;
   }
 
+  // Fingerprints of the computations of a module, valid for its current state.
+  using ComputationFingerprints =
+      absl::flat_hash_map<const HloComputation*, tsl::Fprint128>;
+
+  // Runs a computation local `pass` only on the computations of `module` it
+  // hasn't processed yet. `fingerprints` caches the fingerprints of the
+  // module computations and is updated to reflect changes made by the pass.
+  absl::StatusOr<bool> RunIncrementally(
+      HloPassInterface* pass, HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads,
+      ComputationFingerprints& fingerprints);
+
+  // Overload for module groups, which we always run non-incrementally.
+  absl::StatusOr<bool> RunIncrementally(
+      HloPassInterface* pass, HloModuleGroup* module_group,
+      const absl::flat_hash_set<absl::string_view>& execution_threads,
+      ComputationFingerprints& fingerprints) {
+    return RunHelper(pass, module_group, execution_threads);
+  }
+
+  // Runs a computation `pass` on the computations of `module` concurrently in
+  // `thread_pool_`.
+  absl::StatusOr<bool> RunInParallel(
+      HloComputationPass* pass, HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads);
+
+  // Overload for module groups, which we always run sequentially.
+  absl::StatusOr<bool> RunInParallel(
+      HloComputationPass* pass, HloModuleGroup* module_group,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) {
+    return RunHelper(pass, module_group, execution_threads);
+  }
+
   const std::string name_;
   std::vector<std::unique_ptr<HloPassInterface>> passes_;
   std::vector<std::unique_ptr<HloPassInterface>> invariant_checkers_;
   bool run_called_ = false;
 
+  bool incremental_ = false;
+  // Fingerprints of the computations that each computation local pass has
+  // produced. Used by incremental runs to skip already processed computations.
+  absl::flat_hash_map<const HloPassInterface*,
+                      absl::flat_hash_set<tsl::Fprint128, tsl::Fprint128Hasher>>
+      processed_computations_;
+
+  tsl::thread::ThreadPool* thread_pool_ = nullptr;
+  absl::flat_hash_set<std::string> parallel_passes_;
+
   CompilationStats* compilation_stats_;
   // Default stats instance for when one is not passed in the constructor.
   // Use via compilation_stats_, not directly.
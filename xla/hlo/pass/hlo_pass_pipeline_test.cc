@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -27,18 +28,23 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/ir/hlo_module_group.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/hlo/pass/hlo_pass_fix.h"
 #include "xla/hlo/pass/hlo_pass_interface.h"
 #include "xla/service/hlo_parser.h"
 #include "xla/test_helpers.h"
 #include "xla/tests/hlo_test_base.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "xla/util.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -46,6 +52,7 @@ namespace {
 using ::testing::ElementsAre;
 using ::testing::SizeIs;
 using ::testing::StrEq;
+using ::testing::UnorderedElementsAre;
 
 class HloPassPipelineTest : public HloTestBase {
  protected:
@@ -130,6 +137,101 @@ class BazToQuxModuleGroupPass : public HloModuleGroupPass {
   }
 };
 
+// A computation local pass which records the names of the computations it
+// visits and never changes them.
+class RecordVisitedComputationsPass : public HloModulePass {
+ public:
+  explicit RecordVisitedComputationsPass(std::vector<std::string>* visited)
+      : visited_(visited) {}
+
+  absl::string_view name() const override { return "record-visited"; }
+  bool IsComputationLocal() const override { return true; }
+
+  using HloPassInterface::Run;
+  absl::StatusOr<bool> Run(HloModule* module,
+                           const absl::flat_hash_set<absl::string_view>&
+                               execution_threads) override {
+    RunState run_state(module);
+    TF_RETURN_IF_ERROR(
+        RunOnChangedComputations(module, &run_state, execution_threads));
+    return !run_state.changed_this_iteration.empty();
+  }
+
+  absl::Status RunOnChangedComputations(
+      HloModule* module, RunState* run_state,
+      const absl::flat_hash_set<absl::string_view>& execution_threads)
+      override {
+    for (HloComputation* computation :
+         module->MakeComputationSorted(execution_threads)) {
+      if (run_state->changed_last_iteration.contains(computation)) {
+        visited_->push_back(std::string(computation->name()));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  std::vector<std::string>* visited_;
+};
+
+// A computation pass which negates the root of every computation and records
+// the names of the computations in the order it visits them.
+class NegateRootComputationPass : public HloComputationPass {
+ public:
+  explicit NegateRootComputationPass(std::vector<std::string>* visited)
+      : visited_(visited) {}
+
+  absl::string_view name() const override { return "negate-root"; }
+
+  absl::StatusOr<bool> RunOnComputation(HloComputation* computation) override {
+    HloInstruction* root = computation->root_instruction();
+    computation->set_root_instruction(
+        computation->AddInstruction(HloInstruction::CreateUnary(
+            root->shape(), HloOpcode::kNegate, root)));
+    absl::MutexLock lock(&mu_);
+    visited_->push_back(std::string(computation->name()));
+    return true;
+  }
+
+ private:
+  absl::Mutex mu_;
+  std::vector<std::string>* visited_;
+};
+
+// A computation pass which negates the root of every computation until it is
+// a chain of three negates, and records the threads it runs on.
+class NegateRootThreeTimesPass : public HloComputationPass {
+ public:
+  explicit NegateRootThreeTimesPass(
+      absl::flat_hash_set<std::thread::id>* threads)
+      : threads_(threads) {}
+
+  absl::string_view name() const override { return "negate-root-three-times"; }
+
+  absl::StatusOr<bool> RunOnComputation(HloComputation* computation) override {
+    {
+      absl::MutexLock lock(&mu_);
+      threads_->insert(std::this_thread::get_id());
+    }
+    HloInstruction* root = computation->root_instruction();
+    int num_negates = 0;
+    for (HloInstruction* instruction = root;
+         instruction->opcode() == HloOpcode::kNegate;
+         instruction = instruction->mutable_operand(0)) {
+      ++num_negates;
+    }
+    if (num_negates >= 3) return false;
+    computation->set_root_instruction(
+        computation->AddInstruction(HloInstruction::CreateUnary(
+            root->shape(), HloOpcode::kNegate, root)));
+    return true;
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_set<std::thread::id>* threads_;
+};
+
 // An invariant checker pass which returns an error if there exists an
 // instruction named 'bar'.
 class BarBlowerUpper : public HloModulePass {
@@ -418,5 +520,202 @@ TEST_F(HloPassPipelineTest, SetHloModuleMetadata) {
   }
 }
 
+TEST_F(HloPassPipelineTest, RecordsInstructionCountsInPassMetadata) {
+  const std::string module_str = R"(
+HloModule RecordsInstructionCounts
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT foo = f32[] multiply(a, b)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+  std::vector<std::string> visited;
+  HloPassPipeline pipeline(TestName());
+  pipeline.AddPass<NegateRootComputationPass>(&visited);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  const HloModuleMetadataProto& metadata = module->metadata()->proto();
+  ASSERT_THAT(metadata.pass_metadata(), SizeIs(2));
+  const HloPassMetadata& pass_metadata = metadata.pass_metadata(1);
+  EXPECT_THAT(pass_metadata.pass_name(), StrEq("negate-root"));
+  EXPECT_TRUE(pass_metadata.module_changed());
+  EXPECT_EQ(pass_metadata.instruction_count_before(), 3);
+  EXPECT_EQ(pass_metadata.instruction_count_after(), 4);
+}
+
+TEST_F(HloPassPipelineTest, IncrementalPipelineSkipsUnchangedComputations) {
+  const std::string module_str = R"(
+HloModule IncrementalModule
+
+f {
+  p0 = f32[] parameter(0)
+  ROOT add = f32[] add(p0, p0)
+}
+
+g {
+  p0 = f32[] parameter(0)
+  ROOT multiply = f32[] multiply(p0, p0)
+}
+
+ENTRY main {
+  p0 = f32[] parameter(0)
+  call_f = f32[] call(p0), to_apply=f
+  call_g = f32[] call(p0), to_apply=g
+  ROOT subtract = f32[] subtract(call_f, call_g)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+
+  std::vector<std::string> visited;
+  HloPassPipeline pipeline(TestName());
+  pipeline.set_incremental(true);
+  pipeline.AddPass<RecordVisitedComputationsPass>(&visited);
+
+  // The first run visits all computations.
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_THAT(visited, UnorderedElementsAre("f", "g", "main"));
+
+  // Nothing changed since the last run, so the pass is skipped.
+  visited.clear();
+  TF_ASSERT_OK_AND_ASSIGN(changed, pipeline.Run(module.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_THAT(visited, SizeIs(0));
+
+  // Only the modified computation is visited again.
+  HloComputation* g = FindComputation(module.get(), "g");
+  HloInstruction* root = g->root_instruction();
+  g->set_root_instruction(g->AddInstruction(HloInstruction::CreateUnary(
+      root->shape(), HloOpcode::kNegate, root)));
+
+  visited.clear();
+  TF_ASSERT_OK_AND_ASSIGN(changed, pipeline.Run(module.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_THAT(visited, ElementsAre("g"));
+}
+
+TEST_F(HloPassPipelineTest, ComputationPassRunsInParallel) {
+  const std::string module_str = R"(
+HloModule ParallelModule
+
+h {
+  p0 = f32[] parameter(0)
+  ROOT add = f32[] add(p0, p0)
+}
+
+f {
+  p0 = f32[] parameter(0)
+  ROOT call_h = f32[] call(p0), to_apply=h
+}
+
+g {
+  p0 = f32[] parameter(0)
+  ROOT multiply = f32[] multiply(p0, p0)
+}
+
+k {
+  p0 = f32[] parameter(0)
+  ROOT call_h = f32[] call(p0), to_apply=h
+}
+
+ENTRY main {
+  p0 = f32[] parameter(0)
+  call_f = f32[] call(p0), to_apply=f
+  call_g = f32[] call(p0), to_apply=g
+  call_k = f32[] call(p0), to_apply=k
+  add = f32[] add(call_f, call_g)
+  ROOT subtract = f32[] subtract(add, call_k)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), TestName(), 4);
+  std::vector<std::string> visited;
+  HloPassPipeline pipeline(TestName());
+  pipeline.set_thread_pool(&thread_pool, /*parallel_passes=*/{"negate-root"});
+  pipeline.AddPass<NegateRootComputationPass>(&visited);
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(visited, UnorderedElementsAre("f", "g", "h", "k", "main"));
+
+  // Callees are always processed before their callers.
+  auto index = [&](absl::string_view name) {
+    return std::find(visited.begin(), visited.end(), name) - visited.begin();
+  };
+  EXPECT_LT(index("h"), index("f"));
+  EXPECT_LT(index("h"), index("k"));
+  EXPECT_LT(index("f"), index("main"));
+  EXPECT_LT(index("g"), index("main"));
+  EXPECT_LT(index("k"), index("main"));
+
+  // Instructions added concurrently still get unique names and ids.
+  TF_EXPECT_OK(module->CheckUniqueNamesAndIdsForComputationsAndInstructions());
+  for (HloComputation* computation : module->computations()) {
+    EXPECT_EQ(computation->root_instruction()->opcode(), HloOpcode::kNegate);
+  }
+}
+
+constexpr absl::string_view kTwoComputationsModule = R"(
+HloModule TwoComputations
+
+f {
+  p0 = f32[] parameter(0)
+  ROOT add = f32[] add(p0, p0)
+}
+
+ENTRY main {
+  p0 = f32[] parameter(0)
+  ROOT call_f = f32[] call(p0), to_apply=f
+}
+)";
+
+TEST_F(HloPassPipelineTest, ComputationPassNotInAllowlistRunsSequentially) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(kTwoComputationsModule));
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), TestName(), 4);
+  absl::flat_hash_set<std::thread::id> threads;
+  HloPassPipeline pipeline(TestName());
+  pipeline.set_thread_pool(&thread_pool, /*parallel_passes=*/{"negate-root"});
+  pipeline.AddPass<NegateRootThreeTimesPass>(&threads);
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(threads, UnorderedElementsAre(std::this_thread::get_id()));
+}
+
+TEST_F(HloPassPipelineTest, ComputationPassFixRunsToFixedPoint) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(kTwoComputationsModule));
+
+  // HloPassFix keeps the name of the pass it wraps, so it is allowlisted, but
+  // must still iterate to a fixed point rather than run each computation once.
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), TestName(), 4);
+  absl::flat_hash_set<std::thread::id> threads;
+  HloPassPipeline pipeline(TestName());
+  pipeline.set_thread_pool(&thread_pool,
+                           /*parallel_passes=*/{"negate-root-three-times"});
+  pipeline.AddPass<HloPassFix<NegateRootThreeTimesPass>>(&threads);
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_TRUE(changed);
+  for (HloComputation* computation : module->computations()) {
+    const HloInstruction* instruction = computation->root_instruction();
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_EQ(instruction->opcode(), HloOpcode::kNegate)
+          << computation->name();
+      instruction = instruction->operand(0);
+    }
+    EXPECT_NE(instruction->opcode(), HloOpcode::kNegate);
+  }
+}
+
 }  // namespace
 }  // namespace xla
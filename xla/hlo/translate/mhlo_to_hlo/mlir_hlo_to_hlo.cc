@@ -19,6 +19,7 @@ limitations under the License.
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <string>
@@ -44,6 +45,7 @@ limitations under the License.
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/Shape/IR/Shape.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/AsmState.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/BuiltinAttributeInterfaces.h"
 #include "mlir/IR/BuiltinAttributes.h"
@@ -238,8 +240,54 @@ xla::Array<T> ArrayFromDenseElementsAttr(mlir::DenseElementsAttr dense_attr) {
   return array;
 }
 
+// Returns the data of `attr` if it is stored exactly as in a literal of
+// `shape` with a major-to-minor layout, so that large constants can be moved
+// into HLO with a single copy instead of element by element.
+std::optional<llvm::ArrayRef<char>> GetRawLiteralData(mlir::ElementsAttr attr,
+                                                      const xla::Shape& shape) {
+  if (!shape.IsArray() || !shape.is_static()) return std::nullopt;
+  // MLIR packs predicates and sub-byte types differently from XLA.
+  xla::PrimitiveType type = shape.element_type();
+  if (type == xla::PRED || xla::primitive_util::IsSubByteNonPredType(type)) {
+    return std::nullopt;
+  }
+  if (shape.has_layout() &&
+      !xla::LayoutUtil::IsMonotonicWithDim0Major(shape.layout())) {
+    return std::nullopt;
+  }
+
+  llvm::ArrayRef<char> data;
+  if (auto dense_attr = mlir::dyn_cast<mlir::DenseElementsAttr>(attr)) {
+    // Splats only store a single element.
+    if (dense_attr.isSplat()) return std::nullopt;
+    data = dense_attr.getRawData();
+  } else if (auto resource_attr =
+                 mlir::dyn_cast<mlir::DenseResourceElementsAttr>(attr)) {
+    mlir::AsmResourceBlob* blob = resource_attr.getRawHandle().getBlob();
+    if (blob == nullptr) return std::nullopt;
+    data = blob->getData();
+  } else {
+    return std::nullopt;
+  }
+  if (data.size() != xla::ShapeUtil::ByteSizeOfElements(shape)) {
+    return std::nullopt;
+  }
+  return data;
+}
+
 absl::StatusOr<xla::Literal> CreateArrayLiteralFromAttr(mlir::ElementsAttr attr,
                                                         xla::Layout layout) {
+  xla::Shape raw_shape = xla::TypeToShape(attr.getShapedType());
+  if (std::optional<llvm::ArrayRef<char>> data =
+          GetRawLiteralData(attr, raw_shape)) {
+    xla::Literal literal(raw_shape);
+    std::memcpy(literal.untyped_data(), data->data(), data->size());
+    if (layout.minor_to_major().empty() || layout == raw_shape.layout()) {
+      return literal;
+    }
+    return literal.Relayout(layout);
+  }
+
   auto dense_attr = mlir::dyn_cast<mlir::DenseElementsAttr>(attr);
   if (!dense_attr)
     return tsl::errors::Unimplemented("Only dense elements attr are supported");
@@ -3301,12 +3349,23 @@ LogicalResult ConvertToHloModule::LowerConstant(
   mlir::FailureOr<xla::Shape> shape_or = ExtractXlaShape(inst);
   if (failed(shape_or)) return failure();
 
-  auto literal_or = CreateArrayLiteralFromAttr(const_attr, shape_or->layout());
-  if (!literal_or.ok()) return inst->emitError(literal_or.status().ToString());
-
   xla::XlaScopedShardingAssignment scoped_sharding(
       builder, CreateOpShardingFromAttribute(inst));
-  auto constant = xla::ConstantLiteral(builder, literal_or.value());
+  xla::XlaOp constant;
+  // Pass the data of large constants straight to the builder when possible,
+  // instead of creating an intermediate literal.
+  if (std::optional<llvm::ArrayRef<char>> data =
+          GetRawLiteralData(const_attr, *shape_or)) {
+    constant = xla::ConstantLiteral(
+        builder, xla::BorrowingLiteral(data->data(), *shape_or));
+  } else {
+    auto literal_or =
+        CreateArrayLiteralFromAttr(const_attr, shape_or->layout());
+    if (!literal_or.ok()) {
+      return inst->emitError(literal_or.status().ToString());
+    }
+    constant = xla::ConstantLiteral(builder, literal_or.value());
+  }
   auto& value_map = *value_lowering;
   value_map[inst->getResult(0)] = constant;
 
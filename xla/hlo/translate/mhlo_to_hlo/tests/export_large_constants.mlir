@@ -18,3 +18,22 @@ func.func @main(%arg0: tensor<11xi32>) -> tensor<11xi32> {
 
 // CHECK-SMALL: constant({...})
 // CHECK-LARGE: constant({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10})
+
+// -----
+
+// Resources are exported from their raw data.
+func.func @main() -> tensor<2x2xf32> {
+  %0 = mhlo.constant dense_resource<cst> : tensor<2x2xf32>
+  func.return %0 : tensor<2x2xf32>
+}
+
+{-#
+  dialect_resources: {
+    builtin: {
+      cst: "0x040000000000803F000000400000404000008040"
+    }
+  }
+#-}
+
+// CHECK-SMALL: constant({ { 1, 2 }, { 3, 4 } })
+// CHECK-LARGE: constant({ { 1, 2 }, { 3, 4 } })
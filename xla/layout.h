@@ -89,7 +89,9 @@ class Tile {
   absl::InlinedVector<int64_t, 2> dimensions_;
 };
 
-using TileVector = absl::InlinedVector<Tile, 3>;
+// Two inline tiles cover the common tiled layouts (e.g. T(8,128)(2,1)) without
+// making every Layout, and therefore every Shape, pay for a third.
+using TileVector = absl::InlinedVector<Tile, 2>;
 
 // Describes how data is split between different memories. Each SplitConfig
 // object represents a split in one dimension. Each SplitConfig is associated
@@ -283,7 +285,7 @@ class Layout {
   // Methods for accessing the DimLevelType array.
   int dim_level_types_size() const { return n_dim_level_types_; }
   DimLevelType dim_level_type(int index) const {
-    return dim_attributes_[index].dim_level_type;
+    return static_cast<DimLevelType>(dim_attributes_[index].dim_level_type);
   }
   Layout& set_dim_level_type(int index, DimLevelType dim_level_type) {
     dim_attributes_[index].dim_level_type = dim_level_type;
@@ -456,12 +458,15 @@ class Layout {
   }
 
  private:
-  // We store a single inlined vector to hold
+  // We store a single inlined vector to hold the per-dimension level type,
+  // uniqueness and ordering attributes. The level type is a uint8_t bit-field
+  // rather than a DimLevelType one, so that DimInfo packs into a single byte
+  // instead of taking the size and alignment of the enum's underlying int.
   struct DimInfo {
     DimInfo()
         : dim_level_type(DIM_DENSE), dim_unique(false), dim_ordered(false) {}
 
-    DimLevelType dim_level_type : 6;
+    uint8_t dim_level_type : 6;
     bool dim_unique : 1;
     bool dim_ordered : 1;
   };
@@ -1064,8 +1064,23 @@ absl::StatusOr<Literal> BroadcastHelper(const LiteralBase& src,
   auto src_minor_to_major = LayoutUtil::MinorToMajor(src_shape);
   auto result_minor_to_major = LayoutUtil::MinorToMajor(result_shape);
 
-  ShapeUtil::ForEachIndexNoStatus(
-      result_shape, [&](absl::Span<const int64_t> output_index) {
+  // The result is visited in runs along its most minor dimension. Within a
+  // run the destination advances by one element, and the source by the stride
+  // of the operand dimension the run is broadcast from, or not at all.
+  int64_t src_minor_stride = 0;
+  if (result_shape.rank() > 0) {
+    const int64_t result_minor_dim = result_minor_to_major[0];
+    for (int64_t i = 0, end = dimensions.size(); i < end; ++i) {
+      if (dimensions[i] == result_minor_dim) {
+        src_minor_stride = IndexUtil::GetDimensionStride(src_shape, i);
+      }
+    }
+  }
+
+  TF_RETURN_IF_ERROR(ShapeUtil::ForEachMinorDimensionSpanWithStatus(
+      result_shape,
+      [&](absl::Span<const int64_t> output_index,
+          int64_t span_length) -> absl::StatusOr<bool> {
         // Compute dest_index
         int64_t dest_index = IndexUtil::MultidimensionalIndexToLinearIndex(
             result_shape, result_minor_to_major, output_index);
@@ -1085,11 +1100,16 @@ absl::StatusOr<Literal> BroadcastHelper(const LiteralBase& src,
           source_index = IndexUtil::MultidimensionalIndexToLinearIndex(
               src_shape, src_minor_to_major, scratch_source_span);
         }
-        // Move one element from source_index in source to dest_index in dest
-        memcpy(dest_data + PRIMITIVE_SIZE * dest_index,
-               source_data + PRIMITIVE_SIZE * source_index, PRIMITIVE_SIZE);
+        // Move the run from source_index in source to dest_index in dest
+        char* dest_ptr = dest_data + PRIMITIVE_SIZE * dest_index;
+        const char* source_ptr = source_data + PRIMITIVE_SIZE * source_index;
+        for (int64_t j = 0; j < span_length; ++j) {
+          memcpy(dest_ptr, source_ptr, PRIMITIVE_SIZE);
+          dest_ptr += PRIMITIVE_SIZE;
+          source_ptr += PRIMITIVE_SIZE * src_minor_stride;
+        }
         return true;
-      });
+      }));
 
   return std::move(result);
 }
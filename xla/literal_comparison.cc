@@ -24,6 +24,7 @@ limitations under the License.
 #include <array>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <optional>
 #include <set>
@@ -173,6 +174,29 @@ absl::Status Equal(LiteralSlice expected, LiteralSlice actual,
   return result;
 }
 
+// Returns true if `expected` and `actual` are static arrays of the same type
+// and layout with bytewise identical buffers. Every element then compares
+// equal, including under the bitwise float comparison used by Equal, so
+// callers can skip the per-element comparison.
+bool BuffersAreBytewiseEqual(const LiteralSlice& expected,
+                             const LiteralSlice& actual) {
+  const Shape& expected_shape = expected.shape();
+  const Shape& actual_shape = actual.shape();
+  if (!expected_shape.IsArray() || !actual_shape.IsArray() ||
+      !expected_shape.is_static() || !actual_shape.is_static() ||
+      !ShapeUtil::Equal(expected_shape, actual_shape)) {
+    return false;
+  }
+  // Sub-byte types leave the padding bits of each byte unspecified.
+  if (primitive_util::IsSubByteNonPredType(expected_shape.element_type())) {
+    return false;
+  }
+  const int64_t size_bytes = expected.size_bytes();
+  return size_bytes == actual.size_bytes() &&
+         std::memcmp(expected.untyped_data(), actual.untyped_data(),
+                     size_bytes) == 0;
+}
+
 // Gets the total element count.  For tuples, this is not the count of tuple
 // elements, but the sum of elements of each tuple element.
 int64_t RecursiveElementCount(const Shape& shape) {
@@ -300,6 +324,10 @@ class NearComparator {
                              ShapeUtil::HumanString(expected_.shape()));
     }
 
+    if (BuffersAreBytewiseEqual(expected_, actual_)) {
+      return absl::OkStatus();
+    }
+
     mismatches_ = Literal(ShapeUtil::ChangeElementType(actual_.shape(), PRED));
     mismatches_.PopulateWithValue(false);
 
@@ -702,6 +730,8 @@ absl::Status EqualHelper(const LiteralSlice& expected,
       }
       next_index.pop_back();
     }
+  } else if (BuffersAreBytewiseEqual(expected, actual)) {
+    return absl::OkStatus();
   } else {
     std::vector<int64_t> multi_index(expected.shape().dimensions_size(), 0);
     auto index = absl::MakeSpan(multi_index);
@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "xla/literal_comparison.h"
 
+#include <cstdint>
+#include <limits>
+
 #include <gtest/gtest.h>
 #include "xla/error_spec.h"
+#include "xla/layout_util.h"
 #include "xla/literal_util.h"
 #include "xla/test_helpers.h"
 #include "xla/tsl/lib/core/status_test_util.h"
@@ -106,5 +110,31 @@ TYPED_TEST(LiteralComparisonTest, FloatUsingCompareNear_NotEqual_4ulps) {
                                         /*miscompare_callback=*/nullptr));
 }
 
+TEST(LiteralComparisonTest, CompareEqual_SignedZerosDiffer) {
+  auto actual = LiteralUtil::CreateR1<float>({1.0f, 0.0f, 2.0f});
+  auto expected = LiteralUtil::CreateR1<float>({1.0f, -0.0f, 2.0f});
+  EXPECT_IS_NOT_OK(literal_comparison::Equal(expected, actual));
+  TF_EXPECT_OK(literal_comparison::Equal(expected, expected.Clone()));
+}
+
+TEST(LiteralComparisonTest, CompareEqual_DifferentLayouts) {
+  auto expected = LiteralUtil::CreateR2WithLayout<int32_t>(
+      {{1, 2}, {3, 4}}, LayoutUtil::MakeLayout({0, 1}));
+  auto actual = LiteralUtil::CreateR2WithLayout<int32_t>(
+      {{1, 2}, {3, 4}}, LayoutUtil::MakeLayout({1, 0}));
+  TF_EXPECT_OK(literal_comparison::Equal(expected, actual));
+  actual.Set<int32_t>({1, 0}, 5);
+  EXPECT_IS_NOT_OK(literal_comparison::Equal(expected, actual));
+}
+
+TEST(LiteralComparisonTest, CompareNear_IdenticalNans) {
+  float nan = std::numeric_limits<float>::quiet_NaN();
+  auto expected = LiteralUtil::CreateR1<float>({1.0f, nan});
+  TF_EXPECT_OK(literal_comparison::Near(expected, expected.Clone(),
+                                        ErrorSpec(0.0, 0.0),
+                                        /*detailed_message=*/false,
+                                        /*miscompare_callback=*/nullptr));
+}
+
 }  // namespace
 }  // namespace xla
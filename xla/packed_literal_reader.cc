@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/packed_literal_reader.h"
 
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <string>
@@ -23,11 +24,14 @@ limitations under the License.
 #include "absl/base/casts.h"
 #include "xla/layout_util.h"
 #include "xla/literal.h"
+#include "xla/primitive_util.h"
 #include "xla/shape_util.h"
 #include "xla/status_macros.h"
 #include "xla/types.h"
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/protobuf.h"
 
@@ -79,6 +83,62 @@ absl::StatusOr<Literal> PackedLiteralReader::Read(const Shape& shape,
   return std::move(result);
 }
 
+MappedPackedLiteralReader::MappedPackedLiteralReader(
+    std::unique_ptr<tsl::ReadOnlyMemoryRegion> region)
+    : region_(std::move(region)) {}
+
+/*static*/ absl::StatusOr<std::unique_ptr<MappedPackedLiteralReader>>
+MappedPackedLiteralReader::Open(tsl::Env* env, const std::string& path) {
+  std::unique_ptr<tsl::ReadOnlyMemoryRegion> region;
+  TF_RETURN_IF_ERROR(env->NewReadOnlyMemoryRegionFromFile(path, &region));
+  return std::make_unique<MappedPackedLiteralReader>(std::move(region));
+}
+
+absl::StatusOr<BorrowingLiteral> MappedPackedLiteralReader::Read(
+    const Shape& shape, const Layout* layout) {
+  VLOG(3) << "mapping shape from region: " << ShapeUtil::HumanString(shape)
+          << " layout: " << (layout == nullptr ? "<none>" : layout->ToString());
+  if (!shape.IsArray() || !shape.is_static()) {
+    return InvalidArgument("packed literals must be static arrays: %s",
+                           ShapeUtil::HumanString(shape));
+  }
+  if (primitive_util::IsSubByteNonPredType(shape.element_type())) {
+    return Unimplemented(
+        "not yet implemented element type for mapped literal reading: %s",
+        PrimitiveType_Name(shape.element_type()));
+  }
+  Shape literal_shape = shape;
+  if (layout != nullptr) {
+    TF_RETURN_IF_ERROR(
+        LayoutUtil::ValidateLayoutForShape(*layout, literal_shape));
+    *literal_shape.mutable_layout() = *layout;
+  } else {
+    LayoutUtil::SetToDefaultLayout(&literal_shape);
+  }
+
+  const uint64_t bytes = ShapeUtil::ByteSizeOfElements(literal_shape);
+  if (bytes > region_->length() - offset_) {
+    return InvalidArgument(
+        "%d bytes requested at offset %d, but region has %d bytes", bytes,
+        offset_, region_->length());
+  }
+  const char* data = static_cast<const char*>(region_->data()) + offset_;
+  const int64_t element_size =
+      ShapeUtil::ByteSizeOfPrimitiveType(shape.element_type());
+  if (reinterpret_cast<uintptr_t>(data) % element_size != 0) {
+    return FailedPrecondition(
+        "data for %s at offset %d is not aligned to its element size",
+        ShapeUtil::HumanString(shape), offset_);
+  }
+  offset_ += bytes;
+  VLOG(3) << "mapped shape from region: " << ShapeUtil::HumanString(shape);
+  return BorrowingLiteral(data, literal_shape);
+}
+
+bool MappedPackedLiteralReader::IsExhausted() const {
+  return offset_ >= region_->length();
+}
+
 bool PackedLiteralReader::IsExhausted() const {
   // Try to read a single byte from offset_.  If we can't, we've
   // exhausted the data.
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef XLA_PACKED_LITERAL_READER_H_
 #define XLA_PACKED_LITERAL_READER_H_
 
+#include <cstdint>
 #include <memory>
+#include <string>
 
 #include "absl/status/statusor.h"
 #include "xla/literal.h"
@@ -55,6 +57,40 @@ class PackedLiteralReader {
   PackedLiteralReader& operator=(const PackedLiteralReader&) = delete;
 };
 
+// Reads packed data in the same format as PackedLiteralReader from a read-only
+// memory region, typically a memory-mapped file. Literals are yielded as views
+// into the region, so no data is copied and pages are only loaded on access.
+// The yielded literals must not outlive the reader; use Clone() to get an
+// owning, mutable copy.
+class MappedPackedLiteralReader {
+ public:
+  explicit MappedPackedLiteralReader(
+      std::unique_ptr<tsl::ReadOnlyMemoryRegion> region);
+
+  // Maps the file at `path` into memory and returns a reader over it.
+  static absl::StatusOr<std::unique_ptr<MappedPackedLiteralReader>> Open(
+      tsl::Env* env, const std::string& path);
+
+  // Yields a view of the next packed literal with shape "shape". Unlike
+  // PackedLiteralReader, any array element type that is at least a byte wide
+  // is supported. The data must be aligned to its element size in the region.
+  //
+  // Layout is optional. If it is not provided, the default layout is used.
+  absl::StatusOr<BorrowingLiteral> Read(const Shape& shape,
+                                        const Layout* layout = nullptr);
+
+  // Returns whether all bytes of the region have been read.
+  bool IsExhausted() const;
+
+ private:
+  std::unique_ptr<tsl::ReadOnlyMemoryRegion> region_;
+  uint64_t offset_ = 0;  // Next region offset to read from
+
+  MappedPackedLiteralReader(const MappedPackedLiteralReader&) = delete;
+  MappedPackedLiteralReader& operator=(const MappedPackedLiteralReader&) =
+      delete;
+};
+
 }  // namespace xla
 
 #endif  // XLA_PACKED_LITERAL_READER_H_
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -714,8 +715,8 @@ AbstractTfrtCpuBuffer::BufferFromHostBufferHelper(
     std::optional<absl::Span<int64_t const>> byte_strides,
     PjRtClient::HostBufferSemantics host_buffer_semantics,
     absl::AnyInvocable<void() &&> on_done_with_host_buffer, const Shape& shape,
-    AsyncWorkRunner* async_work_runner, absl::Mutex* transpose_mu,
-    TransposePlanCache* transpose_cache) {
+    AsyncWorkRunner* async_work_runner, TransposePlanCache* transpose_cache,
+    int transpose_num_threads) {
   bool has_default_layout =
       !byte_strides || HasMajorToMinorLayout(type, dims, *byte_strides);
   const int bit_width = primitive_util::BitWidth(type);
@@ -774,9 +775,9 @@ AbstractTfrtCpuBuffer::BufferFromHostBufferHelper(
     if (!has_default_layout || is_packed) {
       // If the input array does not have a major-to-minor layout, transpose it
       // into major-to-minor layout. Currently we choose to always do this
-      // synchronously.
+      // synchronously, although large transposes may be split across the
+      // threads of `async_work_runner`.
       // TODO(phawkins): consider performing the transpose asynchronously.
-      // TODO(phawkins): parallelize the transpose.
       std::shared_ptr<TransposePlan> transpose;
       {
         absl::InlinedVector<int64_t, 4> permutation(dims.size());
@@ -786,18 +787,21 @@ AbstractTfrtCpuBuffer::BufferFromHostBufferHelper(
         options.dims = dims;
         options.permutation = permutation;
         options.input_layout = TransposePlan::Striding{*byte_strides};
-        absl::MutexLock lock(transpose_mu);
+        options.num_threads = transpose_num_threads;
         TF_ASSIGN_OR_RETURN(transpose, transpose_cache->GetOrCreate(options));
       }
+      auto schedule_work = [&](std::function<void()> fn) {
+        async_work_runner->Schedule(std::move(fn));
+      };
       if (!is_packed) {
-        transpose->Execute(data, dst_data_ptr);
+        transpose->Execute(data, dst_data_ptr, schedule_work);
       } else {
         // First transpose the unpacked data into a new temporary buffer, then
         // pack the data.
         // TODO(reedwm): Fuse the transpose and packing by having TransposePlan
         // support packing.
         auto data_transposed = std::make_unique<char[]>(byte_size);
-        transpose->Execute(data, data_transposed.get());
+        transpose->Execute(data, data_transposed.get(), schedule_work);
         absl::Span<const char> src_data_span(data_transposed.get(), byte_size);
         absl::Span<char> dst_data_span(static_cast<char*>(dst_data_ptr),
                                        dst_byte_size);
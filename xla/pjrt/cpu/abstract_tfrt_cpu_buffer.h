@@ -226,8 +226,9 @@ class AbstractTfrtCpuBuffer : public PjRtBuffer {
 
   // A helper function for PjRtClient::BufferFromHostBuffer. Creates a new cpu
   // device buffer from the host buffer (maybe zero-copy or async).
-  // `transpose_mu` and `transpose_cache` are used to transpose the input
-  // layout.
+  // `transpose_cache` is used to transpose the input layout. Transposes may be
+  // split into up to `transpose_num_threads` partitions that run on
+  // `async_work_runner`.
   static absl::StatusOr<std::unique_ptr<TrackedTfrtCpuDeviceBuffer>>
   BufferFromHostBufferHelper(
       const void* data, PrimitiveType type, absl::Span<int64_t const> dims,
@@ -235,7 +236,7 @@ class AbstractTfrtCpuBuffer : public PjRtBuffer {
       PjRtClient::HostBufferSemantics host_buffer_semantics,
       absl::AnyInvocable<void() &&> on_done_with_host_buffer,
       const Shape& shape, AsyncWorkRunner* async_work_runner,
-      absl::Mutex* transpose_mu, TransposePlanCache* transpose_cache);
+      TransposePlanCache* transpose_cache, int transpose_num_threads = 1);
 
  protected:
   virtual absl::string_view buffer_name() const = 0;
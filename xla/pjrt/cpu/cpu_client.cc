@@ -326,6 +326,11 @@ absl::Status TfrtCpuDevice::TransferToInfeed(const LiteralSlice& literal) {
   return TransferLiteralToInfeedOnCpu(local_hardware_id().value(), literal);
 }
 
+absl::Status TfrtCpuDevice::TransferOwnedLiteralToInfeed(Literal literal) {
+  return TransferOwnedLiteralToInfeedOnCpu(local_hardware_id().value(),
+                                           std::move(literal));
+}
+
 absl::Status TfrtCpuDevice::TransferFromOutfeed(
     MutableBorrowingLiteral literal) {
   return TransferLiteralFromOutfeedOnCpu(local_hardware_id().value(), literal);
@@ -397,7 +402,7 @@ absl::StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(
 
   return std::unique_ptr<PjRtClient>(std::make_unique<TfrtCpuClient>(
       options.process_id, std::move(devices), std::move(options.collectives),
-      num_threads, options.asynchronous));
+      num_threads, options.asynchronous, options.transpose_num_threads));
 }
 
 // An upper bound on the number of threads to use for intra-op parallelism. It
@@ -418,7 +423,7 @@ static tsl::ThreadOptions GetThreadOptions() {
 TfrtCpuClient::TfrtCpuClient(
     int process_index, std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
     std::shared_ptr<cpu::CollectivesInterface> collectives, size_t num_threads,
-    bool asynchronous)
+    bool asynchronous, int transpose_num_threads)
     : process_index_(process_index),
       owned_devices_(std::move(devices)),
       computation_placer_(std::make_unique<ComputationPlacer>()),
@@ -436,6 +441,8 @@ TfrtCpuClient::TfrtCpuClient(
       last_collective_launch_event_(
           tsl::MakeAvailableAsyncValueRef<CpuEvent>()),
       transpose_cache_(1024),
+      transpose_num_threads_(std::clamp<int>(transpose_num_threads, 1,
+                                             static_cast<int>(num_threads))),
       collectives_(std::move(collectives)),
       topology_(TfrtCpuTopologyDescription::Create(
           platform_id(), platform_name(), platform_version(), owned_devices_,
@@ -975,7 +982,7 @@ absl::StatusOr<std::unique_ptr<PjRtBuffer>> TfrtCpuClient::BufferFromHostBuffer(
       AbstractTfrtCpuBuffer::BufferFromHostBufferHelper(
           data, type, dims, byte_strides, host_buffer_semantics,
           std::move(on_done_with_host_buffer), shape, async_work_runner(),
-          &transpose_mu_, &transpose_cache_));
+          &transpose_cache_, transpose_num_threads_));
 
   return std::unique_ptr<PjRtBuffer>(std::make_unique<TfrtCpuBuffer>(
       shape, std::move(tracked_device_buffer), this,
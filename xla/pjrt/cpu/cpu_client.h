@@ -218,6 +218,8 @@ class TfrtCpuDevice final : public PjRtDevice {
 
   absl::Status TransferToInfeed(const LiteralSlice& literal) override;
 
+  absl::Status TransferOwnedLiteralToInfeed(Literal literal) override;
+
   absl::Status TransferFromOutfeed(MutableBorrowingLiteral literal) override;
 
   void AttachMemorySpace(PjRtMemorySpace* memory_space);
@@ -258,7 +260,8 @@ class TfrtCpuClient final : public PjRtClient {
   TfrtCpuClient(int process_index,
                 std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
                 std::shared_ptr<cpu::CollectivesInterface> collectives,
-                size_t num_threads, bool asynchronous);
+                size_t num_threads, bool asynchronous,
+                int transpose_num_threads = 1);
   ~TfrtCpuClient() override;
 
   int process_index() const override { return process_index_; }
@@ -468,8 +471,9 @@ class TfrtCpuClient final : public PjRtClient {
   // A cache for transpose plans. We use transposes to convert
   // (possibly strided) buffers provided to BufferFromHostBuffer into dense
   // major-to-minor layout.
-  absl::Mutex transpose_mu_;
-  TransposePlanCache transpose_cache_ ABSL_GUARDED_BY(transpose_mu_);
+  TransposePlanCache transpose_cache_;
+  // Number of threads of `pjrt_client_thread_pool_` used by transposes.
+  int transpose_num_threads_;
 
   std::shared_ptr<cpu::CollectivesInterface> collectives_;
 
@@ -703,6 +707,12 @@ struct CpuClientOptions {
 
   int max_inflight_computations_per_device = 32;
 
+  // Maximum number of threads used to relayout host buffers with a
+  // non-default layout in BufferFromHostBuffer. Large transposes are
+  // partitioned by TransposePlan and run on the client thread pool; the
+  // default of one thread runs all transposes on the calling thread.
+  int transpose_num_threads = 1;
+
   // My process ID.
   int process_id = 0;
 
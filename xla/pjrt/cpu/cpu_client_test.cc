@@ -144,6 +144,40 @@ ENTRY DonationWithExecutionError() -> f32[2, 2] {
               HasSubstr("buffer has been deleted or donated."));
 }
 
+TEST(TfrtCpuClientTest, TransferOwnedLiteralToInfeed) {
+  static constexpr char kProgram[] = R"(
+    HloModule infeed
+    ENTRY main {
+      token0 = token[] after-all()
+      infeed = ((f32[4], f32[4]), token[]) infeed(token0)
+      data = (f32[4], f32[4]) get-tuple-element(infeed), index=0
+      a = f32[4] get-tuple-element(data), index=0
+      b = f32[4] get-tuple-element(data), index=1
+      ROOT result = f32[4] add(a, b)
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(CpuClientOptions()));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module,
+                          ParseAndReturnUnverifiedModule(kProgram, {}));
+  XlaComputation xla_computation(hlo_module->ToProto());
+  TF_ASSERT_OK_AND_ASSIGN(auto executable,
+                          client->Compile(xla_computation, {}));
+
+  TF_ASSERT_OK(client->addressable_devices()[0]->TransferOwnedLiteralToInfeed(
+      LiteralUtil::MakeTupleOwned(
+          LiteralUtil::CreateR1<float>({1.0f, 2.0f, 3.0f, 4.0f}),
+          LiteralUtil::CreateR1<float>({10.0f, 20.0f, 30.0f, 40.0f}))));
+
+  auto result = executable->Execute(/*argument_handles=*/{{}}, /*options=*/{});
+  TF_ASSERT_OK(result);
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::Literal> result_literal,
+                          result->at(0).at(0)->ToLiteralSync());
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateR1<float>({11.0f, 22.0f, 33.0f, 44.0f}),
+      *result_literal));
+}
+
 TEST(TfrtCpuClientTest, HloSnapshot) {
   static constexpr char kProgram[] = R"(
     HloModule add
@@ -276,6 +310,37 @@ TEST(TfrtCpuClientTest, BufferFromLiteralInt4) {
               ElementsAreArray(literal.data<s4>()));
 }
 
+TEST(TfrtCpuClientTest, BufferFromHostBufferWithParallelTranspose) {
+  CpuClientOptions options;
+  options.transpose_num_threads = 4;
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(options));
+
+  // Rows are padded, so the input doesn't have a default layout and has to be
+  // relayed out. The array is large enough to be split between threads.
+  constexpr int64_t kRows = 4096;
+  constexpr int64_t kCols = 256;
+  constexpr int64_t kPaddedCols = kCols + 16;
+  std::vector<float> data(kRows * kPaddedCols);
+  std::vector<float> expected(kRows * kCols);
+  for (int64_t i = 0; i < kRows; ++i) {
+    for (int64_t j = 0; j < kCols; ++j) {
+      data[i * kPaddedCols + j] = i * kCols + j;
+      expected[i * kCols + j] = i * kCols + j;
+    }
+  }
+
+  std::vector<int64_t> byte_strides = {kPaddedCols * sizeof(float),
+                                       sizeof(float)};
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), F32, {kRows, kCols}, byte_strides,
+          PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall, nullptr,
+          client->addressable_devices()[0]));
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, buffer->ToLiteralSync());
+  EXPECT_THAT(literal->data<float>(), ElementsAreArray(expected));
+}
+
 TEST(TfrtCpuClientTest, AsyncTransferCallsOnDone) {
   TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(CpuClientOptions()));
   xla::Shape shape = ShapeUtil::MakeShape(F32, {3, 2});
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/pjrt/cpu/gloo_collectives.h"
 
+#include <algorithm>
 #include <complex>
 #include <cstddef>
 #include <cstdint>
@@ -31,6 +32,7 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -38,6 +40,7 @@ limitations under the License.
 #include "gloo/algorithm.h"
 #include "gloo/allgather.h"
 #include "gloo/allreduce.h"
+#include "gloo/allreduce_halving_doubling.h"
 #include "gloo/context.h"
 #include "gloo/math.h"
 #include "gloo/reduce_scatter.h"
@@ -53,6 +56,7 @@ limitations under the License.
 #include "xla/service/global_device_id.h"
 #include "xla/status_macros.h"
 #include "xla/types.h"
+#include "xla/util.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
@@ -60,10 +64,80 @@ limitations under the License.
 namespace xla::cpu {
 
 GlooCollectivesCommunicator::GlooCollectivesCommunicator(
-    std::shared_ptr<gloo::Context> context)
-    : context_(std::move(context)) {}
+    std::shared_ptr<gloo::Context> context, GlooCollectivesOptions options)
+    : context_(std::move(context)), options_(options) {}
 GlooCollectivesCommunicator::~GlooCollectivesCommunicator() = default;
 
+// Calls `f` with a value of the Gloo type that corresponds to `element_type`.
+template <typename F>
+static absl::Status GlooTypeSwitch(PrimitiveType element_type,
+                                   absl::string_view collective, F&& f) {
+  switch (element_type) {
+    case S8:
+      return f(int8_t{});
+    case PRED:
+    case U8:
+      return f(uint8_t{});
+    case S16:
+      return f(int16_t{});
+    case U16:
+      return f(uint16_t{});
+    case S32:
+      return f(int32_t{});
+    case U32:
+      return f(uint32_t{});
+    case S64:
+      return f(int64_t{});
+    case U64:
+      return f(uint64_t{});
+    case F16:
+      return f(gloo::float16{});
+    case BF16:
+      return f(bfloat16{});
+    case F32:
+      return f(float{});
+    case F64:
+      return f(double{});
+    case C64:
+      return f(std::complex<float>{});
+    case C128:
+      return f(std::complex<double>{});
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown datatype in ", collective));
+  }
+}
+
+template <typename T>
+static absl::StatusOr<const gloo::ReductionFunction<T>*> GetReductionFunction(
+    ReductionKind reduction_kind) {
+  if constexpr (is_complex_v<T>) {
+    switch (reduction_kind) {
+      case ReductionKind::SUM:
+        return gloo::ReductionFunction<T>::sum;
+      case ReductionKind::PRODUCT:
+        return gloo::ReductionFunction<T>::product;
+      default:
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Unsupported reduction kind: ", static_cast<int>(reduction_kind)));
+    }
+  } else {
+    switch (reduction_kind) {
+      case ReductionKind::SUM:
+        return gloo::ReductionFunction<T>::sum;
+      case ReductionKind::PRODUCT:
+        return gloo::ReductionFunction<T>::product;
+      case ReductionKind::MAX:
+        return gloo::ReductionFunction<T>::max;
+      case ReductionKind::MIN:
+        return gloo::ReductionFunction<T>::min;
+      default:
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Unsupported reduction kind: ", static_cast<int>(reduction_kind)));
+    }
+  }
+}
+
 template <typename T>
 static absl::Status SetAllReduceOptions(ReductionKind reduction_kind,
                                         const void* input_buffer,
@@ -104,75 +178,22 @@ static absl::Status SetAllReduceOptions(ReductionKind reduction_kind,
   return absl::OkStatus();
 }
 
-absl::Status GlooCollectivesCommunicator::AllReduce(
-    const RendezvousKey& key, ReductionKind reduction_kind,
-    PrimitiveType element_type, size_t num_elements, const void* input_buffer,
-    void* output_buffer, absl::Duration timeout) {
-  gloo::AllreduceOptions options(context_);
+// Bandwidth-optimal all-reduce for large buffers: Gloo's ring algorithm
+// pipelines transfers and reductions of buffer segments.
+template <typename T>
+static absl::Status RingAllReduce(const std::shared_ptr<gloo::Context>& context,
+                                  ReductionKind reduction_kind,
+                                  const void* input_buffer,
+                                  void* output_buffer, size_t num_elements,
+                                  size_t segment_bytes,
+                                  absl::Duration timeout) {
+  gloo::AllreduceOptions options(context);
   // TODO(phawkins): how to do tags?
   // options.setTag(tag);
-  switch (element_type) {
-    case S8:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<int8_t>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case PRED:
-    case U8:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<uint8_t>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case S16:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<int16_t>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case U16:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<uint16_t>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case S32:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<int32_t>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case U32:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<uint32_t>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case S64:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<int64_t>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case U64:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<uint64_t>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case F16:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<gloo::float16>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case BF16:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<bfloat16>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case F32:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<float>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case F64:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<double>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case C64:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<std::complex<float>>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    case C128:
-      TF_RETURN_IF_ERROR(SetAllReduceOptions<std::complex<double>>(
-          reduction_kind, input_buffer, output_buffer, num_elements, options));
-      break;
-    default:
-      return absl::InvalidArgumentError("Unknown datatype in allreduce");
-  }
+  TF_RETURN_IF_ERROR(SetAllReduceOptions<T>(
+      reduction_kind, input_buffer, output_buffer, num_elements, options));
   options.setAlgorithm(gloo::AllreduceOptions::Algorithm::RING);
+  options.setMaxSegmentSize(segment_bytes);
   options.setTimeout(absl::ToChronoMilliseconds(timeout));
 
   try {
@@ -184,6 +205,53 @@ absl::Status GlooCollectivesCommunicator::AllReduce(
   return absl::OkStatus();
 }
 
+// Latency-optimal all-reduce for small buffers: recursive halving-doubling
+// needs a logarithmic number of communication rounds instead of a linear one.
+template <typename T>
+static absl::Status HalvingDoublingAllReduce(
+    const std::shared_ptr<gloo::Context>& context,
+    ReductionKind reduction_kind, const void* input_buffer,
+    void* output_buffer, size_t num_elements) {
+  TF_ASSIGN_OR_RETURN(const gloo::ReductionFunction<T>* reduction_function,
+                      GetReductionFunction<T>(reduction_kind));
+  if (output_buffer != input_buffer) {
+    std::memcpy(output_buffer, input_buffer, num_elements * sizeof(T));
+  }
+  if (num_elements == 0) {
+    return absl::OkStatus();
+  }
+  try {
+    gloo::AllreduceHalvingDoubling<T> algorithm(
+        context, std::vector<T*>{reinterpret_cast<T*>(output_buffer)},
+        static_cast<int>(num_elements), reduction_function);
+    algorithm.run();
+  } catch (std::exception& e) {
+    return absl::UnknownError(
+        absl::StrCat("Gloo all-reduce failed: ", e.what()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status GlooCollectivesCommunicator::AllReduce(
+    const RendezvousKey& key, ReductionKind reduction_kind,
+    PrimitiveType element_type, size_t num_elements, const void* input_buffer,
+    void* output_buffer, absl::Duration timeout) {
+  size_t num_bytes = num_elements * primitive_util::ByteWidth(element_type);
+  bool small_message = num_bytes <= options_.small_message_bytes;
+  return GlooTypeSwitch(
+      element_type, "allreduce", [&](auto type_tag) -> absl::Status {
+        using T = decltype(type_tag);
+        if (small_message) {
+          return HalvingDoublingAllReduce<T>(context_, reduction_kind,
+                                             input_buffer, output_buffer,
+                                             num_elements);
+        }
+        return RingAllReduce<T>(context_, reduction_kind, input_buffer,
+                                output_buffer, num_elements,
+                                options_.segment_bytes, timeout);
+      });
+}
+
 static constexpr uint8_t kCollectivePermuteSlotPrefix = 0x40;
 
 absl::Status GlooCollectivesCommunicator::CollectivePermute(
@@ -308,47 +376,18 @@ absl::Status GlooCollectivesCommunicator::AllGather(const RendezvousKey& key,
   return absl::OkStatus();
 }
 
+// Latency-optimal reduce-scatter for small buffers. Leaves the reduced chunk
+// of this rank at the beginning of `buffer`.
 template <typename T>
-absl::Status ReduceScatterHelper(std::shared_ptr<gloo::Context> context,
-                                 ReductionKind reduction_kind, void* buffer,
-                                 size_t chunk_elems) {
-  const gloo::ReductionFunction<T>* reduction_function = nullptr;
-  if constexpr (is_complex_v<T>) {
-    switch (reduction_kind) {
-      case ReductionKind::SUM:
-        reduction_function = gloo::ReductionFunction<T>::sum;
-        break;
-      case ReductionKind::PRODUCT:
-        reduction_function = gloo::ReductionFunction<T>::product;
-        break;
-      default:
-        return absl::InvalidArgumentError(absl::StrCat(
-            "Unsupported reduction kind: ", static_cast<int>(reduction_kind)));
-    }
-  } else {
-    switch (reduction_kind) {
-      case ReductionKind::SUM:
-        reduction_function = gloo::ReductionFunction<T>::sum;
-        break;
-      case ReductionKind::PRODUCT:
-        reduction_function = gloo::ReductionFunction<T>::product;
-        break;
-      case ReductionKind::MAX:
-        reduction_function = gloo::ReductionFunction<T>::max;
-        break;
-      case ReductionKind::MIN:
-        reduction_function = gloo::ReductionFunction<T>::min;
-        break;
-      default:
-        return absl::InvalidArgumentError(absl::StrCat(
-            "Unsupported reduction kind: ", static_cast<int>(reduction_kind)));
-    }
-  }
+static absl::Status HalvingDoublingReduceScatter(
+    const std::shared_ptr<gloo::Context>& context,
+    const gloo::ReductionFunction<T>* reduction_function, T* buffer,
+    size_t chunk_elems) {
   try {
     std::vector<int> recv_elems(context->size, chunk_elems);
     gloo::ReduceScatterHalvingDoubling<T> algorithm(
-        context, std::vector<T*>{reinterpret_cast<T*>(buffer)},
-        chunk_elems * context->size, recv_elems, reduction_function);
+        context, std::vector<T*>{buffer}, chunk_elems * context->size,
+        recv_elems, reduction_function);
     algorithm.run();
   } catch (std::exception& e) {
     return absl::UnknownError(
@@ -357,6 +396,80 @@ absl::Status ReduceScatterHelper(std::shared_ptr<gloo::Context> context,
   return absl::OkStatus();
 }
 
+// Bandwidth-optimal reduce-scatter for large buffers. In step `s` every rank
+// sends one partially reduced chunk to its right neighbor and reduces the
+// chunk received from its left neighbor into `buffer`, so that after
+// `size - 1` steps rank `r` holds the fully reduced chunk `r`. Chunks are
+// transferred in segments of at most `segment_elems` elements, and received
+// segments are double buffered, so that reductions overlap with transfers.
+template <typename T>
+static absl::Status RingReduceScatter(
+    const std::shared_ptr<gloo::Context>& context,
+    const gloo::ReductionFunction<T>* reduction_function, T* buffer,
+    size_t chunk_elems, size_t segment_elems, absl::Duration timeout) {
+  const int rank = context->rank;
+  const int size = context->size;
+  if (size == 1 || chunk_elems == 0) {
+    return absl::OkStatus();
+  }
+
+  const int left = (rank + size - 1) % size;
+  const int right = (rank + 1) % size;
+  const size_t num_segments = CeilOfRatio(chunk_elems, segment_elems);
+  auto segment_size = [&](size_t segment) {
+    return std::min(segment_elems, chunk_elems - segment * segment_elems);
+  };
+
+  try {
+    const auto slot = context->nextSlot();
+    auto deadline = absl::ToChronoTime(absl::Now() + timeout);
+
+    std::unique_ptr<gloo::transport::UnboundBuffer> send_buffer =
+        context->createUnboundBuffer(buffer, size * chunk_elems * sizeof(T));
+    std::vector<T> scratch(2 * segment_elems);
+    std::unique_ptr<gloo::transport::UnboundBuffer> recv_buffers[2] = {
+        context->createUnboundBuffer(scratch.data(),
+                                     segment_elems * sizeof(T)),
+        context->createUnboundBuffer(scratch.data() + segment_elems,
+                                     segment_elems * sizeof(T))};
+
+    for (int step = 0; step < size - 1; ++step) {
+      // The chunk received in one step is sent in the next one.
+      const size_t send_chunk = (rank + 2 * size - step - 1) % size;
+      const size_t recv_chunk = (rank + 2 * size - step - 2) % size;
+
+      for (size_t segment = 0; segment < num_segments; ++segment) {
+        send_buffer->send(
+            right, slot,
+            (send_chunk * chunk_elems + segment * segment_elems) * sizeof(T),
+            segment_size(segment) * sizeof(T));
+      }
+
+      recv_buffers[0]->recv(left, slot, /*offset=*/0,
+                            segment_size(0) * sizeof(T));
+      for (size_t segment = 0; segment < num_segments; ++segment) {
+        if (segment + 1 < num_segments) {
+          recv_buffers[(segment + 1) % 2]->recv(
+              left, slot, /*offset=*/0, segment_size(segment + 1) * sizeof(T));
+        }
+        recv_buffers[segment % 2]->waitRecv(deadline);
+        reduction_function->call(
+            buffer + recv_chunk * chunk_elems + segment * segment_elems,
+            scratch.data() + (segment % 2) * segment_elems,
+            segment_size(segment));
+      }
+
+      for (size_t segment = 0; segment < num_segments; ++segment) {
+        send_buffer->waitSend(deadline);
+      }
+    }
+  } catch (std::exception& e) {
+    return absl::UnknownError(
+        absl::StrCat("Gloo ReduceScatter failed: ", e.what()));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status GlooCollectivesCommunicator::ReduceScatter(
     const RendezvousKey& key, ReductionKind reduction_kind,
     PrimitiveType element_type, size_t chunk_elems, const void* input_buffer,
@@ -364,75 +477,35 @@ absl::Status GlooCollectivesCommunicator::ReduceScatter(
   size_t chunk_bytes = chunk_elems * primitive_util::ByteWidth(element_type);
   std::unique_ptr<char[]> temp(new char[chunk_bytes * context_->size]);
   std::memcpy(temp.get(), input_buffer, chunk_bytes * context_->size);
-  switch (element_type) {
-    case S8:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<int8_t>(context_, reduction_kind,
-                                                     temp.get(), chunk_elems));
-      break;
-    case PRED:
-    case U8:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<uint8_t>(context_, reduction_kind,
-                                                      temp.get(), chunk_elems));
-      break;
-    case S16:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<int16_t>(context_, reduction_kind,
-                                                      temp.get(), chunk_elems));
-      break;
-    case U16:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<uint16_t>(
-          context_, reduction_kind, temp.get(), chunk_elems));
-      break;
-    case S32:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<int32_t>(context_, reduction_kind,
-                                                      temp.get(), chunk_elems));
-      break;
-    case U32:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<uint32_t>(
-          context_, reduction_kind, temp.get(), chunk_elems));
-      break;
-    case S64:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<int64_t>(context_, reduction_kind,
-                                                      temp.get(), chunk_elems));
-      break;
-    case U64:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<uint64_t>(
-          context_, reduction_kind, temp.get(), chunk_elems));
-      break;
-    case BF16:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<bfloat16>(
-          context_, reduction_kind, temp.get(), chunk_elems));
-      break;
-    case F16:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<gloo::float16>(
-          context_, reduction_kind, temp.get(), chunk_elems));
-      break;
-    case F32:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<float>(context_, reduction_kind,
-                                                    temp.get(), chunk_elems));
-      break;
-    case F64:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<double>(context_, reduction_kind,
-                                                     temp.get(), chunk_elems));
-      break;
-    case C64:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<std::complex<float>>(
-          context_, reduction_kind, temp.get(), chunk_elems));
-      break;
-    case C128:
-      TF_RETURN_IF_ERROR(ReduceScatterHelper<std::complex<double>>(
-          context_, reduction_kind, temp.get(), chunk_elems));
-      break;
-    default:
-      return absl::InvalidArgumentError("Unknown datatype in reducescatter");
-  }
-  std::memcpy(output_buffer, temp.get(), chunk_bytes);
+
+  bool small_message =
+      chunk_bytes * context_->size <= options_.small_message_bytes;
+  size_t result_offset = 0;
+  TF_RETURN_IF_ERROR(GlooTypeSwitch(
+      element_type, "reducescatter", [&](auto type_tag) -> absl::Status {
+        using T = decltype(type_tag);
+        TF_ASSIGN_OR_RETURN(const gloo::ReductionFunction<T>* reduction_fn,
+                            GetReductionFunction<T>(reduction_kind));
+        T* buffer = reinterpret_cast<T*>(temp.get());
+        if (small_message) {
+          return HalvingDoublingReduceScatter<T>(context_, reduction_fn,
+                                                 buffer, chunk_elems);
+        }
+        result_offset = context_->rank * chunk_bytes;
+        size_t segment_elems =
+            std::max<size_t>(1, options_.segment_bytes / sizeof(T));
+        return RingReduceScatter<T>(context_, reduction_fn, buffer,
+                                    chunk_elems, segment_elems, timeout);
+      }));
+  std::memcpy(output_buffer, temp.get() + result_offset, chunk_bytes);
   return absl::OkStatus();
 }
 
 GlooCollectives::GlooCollectives(
     std::unique_ptr<gloo::rendezvous::Store> store,
-    std::shared_ptr<gloo::transport::Device> device)
-    : store_(std::move(store)), device_(std::move(device)) {}
+    std::shared_ptr<gloo::transport::Device> device,
+    GlooCollectivesOptions options)
+    : store_(std::move(store)), device_(std::move(device)), options_(options) {}
 
 GlooCollectives::~GlooCollectives() = default;
 
@@ -470,8 +543,8 @@ GlooCollectives::GetCommunicator(
     return absl::UnknownError(
         absl::StrCat("Gloo context initialization failed: ", e.what()));
   }
-  context->communicator =
-      std::make_shared<GlooCollectivesCommunicator>(std::move(gloo_context));
+  context->communicator = std::make_shared<GlooCollectivesCommunicator>(
+      std::move(gloo_context), options_);
   return context->communicator;
 }
 
@@ -39,9 +39,21 @@ limitations under the License.
 
 namespace xla::cpu {
 
+struct GlooCollectivesOptions {
+  // All-reduce and reduce-scatter of at most this many bytes use recursive
+  // halving-doubling, which needs fewer communication rounds. Larger ones use
+  // pipelined ring algorithms, which make better use of network bandwidth.
+  size_t small_message_bytes = 256 * 1024;
+
+  // Ring algorithms transfer buffers in segments of at most this many bytes, so
+  // that reductions of received segments overlap with transfers of next ones.
+  size_t segment_bytes = 1024 * 1024;
+};
+
 class GlooCollectivesCommunicator : public CollectivesCommunicator {
  public:
-  explicit GlooCollectivesCommunicator(std::shared_ptr<gloo::Context> context);
+  explicit GlooCollectivesCommunicator(std::shared_ptr<gloo::Context> context,
+                                       GlooCollectivesOptions options = {});
   ~GlooCollectivesCommunicator() override;
 
   absl::Status AllReduce(const RendezvousKey& key, ReductionKind reduction_kind,
@@ -68,12 +80,14 @@ class GlooCollectivesCommunicator : public CollectivesCommunicator {
 
  private:
   std::shared_ptr<gloo::Context> context_;
+  GlooCollectivesOptions options_;
 };
 
 class GlooCollectives : public CollectivesInterface {
  public:
   GlooCollectives(std::unique_ptr<gloo::rendezvous::Store> store,
-                  std::shared_ptr<gloo::transport::Device> device);
+                  std::shared_ptr<gloo::transport::Device> device,
+                  GlooCollectivesOptions options = {});
   ~GlooCollectives() override;
 
   // Thread-safe.
@@ -83,6 +97,7 @@ class GlooCollectives : public CollectivesInterface {
  private:
   std::unique_ptr<gloo::rendezvous::Store> store_;
   std::shared_ptr<gloo::transport::Device> device_;
+  GlooCollectivesOptions options_;
   absl::Mutex mu_;
   struct Context {
     absl::Mutex mu;
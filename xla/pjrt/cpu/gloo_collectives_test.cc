@@ -58,14 +58,16 @@ constexpr absl::Duration kTimeout = absl::Seconds(5);
 
 absl::StatusOr<std::shared_ptr<CollectivesCommunicator>> GetCommunicator(
     size_t kNumParticipants, absl::Span<GlobalDeviceId const> global_devices,
-    const std::shared_ptr<xla::KeyValueStoreInterface>& kv_store, int rank) {
+    const std::shared_ptr<xla::KeyValueStoreInterface>& kv_store, int rank,
+    GlooCollectivesOptions options = {}) {
   auto collectives = std::make_shared<cpu::GlooCollectives>(
       std::make_unique<cpu::GlooKeyValueStore>(kv_store),
 #if defined(__linux__)
-      gloo::transport::tcp::CreateDevice(gloo::transport::tcp::attr()));
+      gloo::transport::tcp::CreateDevice(gloo::transport::tcp::attr()),
 #elif defined(__APPLE__)
-      gloo::transport::uv::CreateDevice(gloo::transport::uv::attr()));
+      gloo::transport::uv::CreateDevice(gloo::transport::uv::attr()),
 #endif  // defined(__linux__)
+      options);
   return collectives->GetCommunicator(global_devices, rank);
 }
 
@@ -77,15 +79,24 @@ RendezvousKey MakeRendezvousKey(std::vector<GlobalDeviceId> global_devices) {
 
 // TODO(cobley) - add tests for other collectives.
 
+// Options that force ring algorithms with many small segments.
+GlooCollectivesOptions RingOptions() {
+  GlooCollectivesOptions options;
+  options.small_message_bytes = 0;
+  options.segment_bytes = 24;
+  return options;
+}
+
 absl::StatusOr<std::vector<uint8_t>> AllReduce(
     const std::shared_ptr<xla::KeyValueStoreInterface>& kv_store,
     const std::vector<uint8_t>& input_buffer,
-    std::vector<GlobalDeviceId> global_devices, int rank) {
+    std::vector<GlobalDeviceId> global_devices, int rank,
+    GlooCollectivesOptions options = {}) {
   std::vector<uint8_t> output_buffer(kBufferSize);
   RendezvousKey rendezvous_key = MakeRendezvousKey(global_devices);
-  TF_ASSIGN_OR_RETURN(
-      auto communicator,
-      GetCommunicator(kNumParticipants, global_devices, kv_store, rank));
+  TF_ASSIGN_OR_RETURN(auto communicator,
+                      GetCommunicator(kNumParticipants, global_devices,
+                                      kv_store, rank, options));
 
   TF_RETURN_IF_ERROR(communicator->AllReduce(
       rendezvous_key, xla::ReductionKind::SUM, xla::PrimitiveType::U8,
@@ -94,7 +105,7 @@ absl::StatusOr<std::vector<uint8_t>> AllReduce(
   return output_buffer;
 }
 
-TEST(GlooCollectives, AllReduce) {
+void TestAllReduce(GlooCollectivesOptions options) {
   std::vector<GlobalDeviceId> global_devices;
   global_devices.reserve(kNumParticipants);
   for (int rank = 0; rank < kNumParticipants; ++rank) {
@@ -113,10 +124,10 @@ TEST(GlooCollectives, AllReduce) {
         tsl::Env::Default(), "AllReduceParticipants", kNumParticipants);
     for (int rank = 0; rank < kNumParticipants; ++rank) {
       thread_pool.Schedule(
-          [rank, &output_buffers, &kv_store, &global_devices]() {
+          [rank, &output_buffers, &kv_store, &global_devices, &options]() {
             std::vector<uint8_t> input_buffer(kBufferSize, rank + 1);
-            output_buffers[rank] =
-                AllReduce(kv_store, input_buffer, global_devices, rank);
+            output_buffers[rank] = AllReduce(kv_store, input_buffer,
+                                             global_devices, rank, options);
           });
     }
   }
@@ -132,5 +143,77 @@ TEST(GlooCollectives, AllReduce) {
                 Each(Eq(kNumParticipants * (kNumParticipants + 1) / 2)));
   }
 }
+
+TEST(GlooCollectives, AllReduce) { TestAllReduce(GlooCollectivesOptions()); }
+
+TEST(GlooCollectives, RingAllReduce) { TestAllReduce(RingOptions()); }
+
+absl::StatusOr<std::vector<float>> ReduceScatter(
+    const std::shared_ptr<xla::KeyValueStoreInterface>& kv_store,
+    const std::vector<float>& input_buffer,
+    std::vector<GlobalDeviceId> global_devices, int rank,
+    GlooCollectivesOptions options) {
+  size_t chunk_elems = input_buffer.size() / kNumParticipants;
+  std::vector<float> output_buffer(chunk_elems);
+  RendezvousKey rendezvous_key = MakeRendezvousKey(global_devices);
+  TF_ASSIGN_OR_RETURN(auto communicator,
+                      GetCommunicator(kNumParticipants, global_devices,
+                                      kv_store, rank, options));
+
+  TF_RETURN_IF_ERROR(communicator->ReduceScatter(
+      rendezvous_key, xla::ReductionKind::SUM, xla::PrimitiveType::F32,
+      chunk_elems, input_buffer.data(), output_buffer.data(), kTimeout));
+
+  return output_buffer;
+}
+
+void TestReduceScatter(GlooCollectivesOptions options) {
+  std::vector<GlobalDeviceId> global_devices;
+  global_devices.reserve(kNumParticipants);
+  for (int rank = 0; rank < kNumParticipants; ++rank) {
+    global_devices.push_back(GlobalDeviceId(rank));
+  }
+
+  auto kv_store = std::make_shared<xla::InMemoryKeyValueStore>();
+
+  std::vector<absl::StatusOr<std::vector<float>>> output_buffers(
+      kNumParticipants);
+
+  {
+    tsl::thread::ThreadPool thread_pool(
+        tsl::Env::Default(), "ReduceScatterParticipants", kNumParticipants);
+    for (int rank = 0; rank < kNumParticipants; ++rank) {
+      thread_pool.Schedule(
+          [rank, &output_buffers, &kv_store, &global_devices, &options]() {
+            // Element `i` of participant `rank` has value `rank + i`.
+            std::vector<float> input_buffer(kBufferSize * kNumParticipants);
+            for (size_t i = 0; i < input_buffer.size(); ++i) {
+              input_buffer[i] = rank + i;
+            }
+            output_buffers[rank] = ReduceScatter(
+                kv_store, input_buffer, global_devices, rank, options);
+          });
+    }
+  }
+
+  for (int rank = 0; rank < kNumParticipants; ++rank) {
+    TF_ASSERT_OK(output_buffers[rank].status());
+    const std::vector<float>& output = output_buffers[rank].value();
+    ASSERT_EQ(output.size(), kBufferSize);
+    for (size_t i = 0; i < kBufferSize; ++i) {
+      size_t index = rank * kBufferSize + i;
+      float expected = kNumParticipants * (kNumParticipants - 1) / 2 +
+                       kNumParticipants * index;
+      EXPECT_EQ(output[i], expected) << "rank=" << rank << " i=" << i;
+    }
+  }
+}
+
+TEST(GlooCollectives, ReduceScatter) {
+  TestReduceScatter(GlooCollectivesOptions());
+}
+
+TEST(GlooCollectives, RingReduceScatter) { TestReduceScatter(RingOptions()); }
+
 }  // namespace
 }  // namespace xla::cpu
@@ -16,6 +16,8 @@ limitations under the License.
 #include "xla/pjrt/distributed/topology_util.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <map>
 #include <set>
@@ -36,11 +38,11 @@ limitations under the License.
 #include "xla/pjrt/distributed/key_value_store_interface.h"
 #include "xla/pjrt/distributed/protocol.pb.h"
 #include "xla/pjrt/pjrt_client.h"
-#include "xla/pjrt/utils.h"
 #include "xla/util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/snappy.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/threadpool.h"
 
@@ -68,57 +70,160 @@ absl::StatusOr<std::string> GetBootIdString() {
   return boot_id_str;
 }
 
-static std::string GetLocalTopologyKey(std::string_view platform, int node_id) {
-  return absl::StrCat("local_topology/", platform, "/", node_id);
+// Local topologies are gathered to the lead node along a tree with this
+// fan-out, so that no node waits for the topologies of more than this many
+// other nodes.
+static constexpr int kTopologyGatherFanout = 32;
+
+static std::string GetSubtreeTopologyKey(std::string_view platform,
+                                         int node_id) {
+  return absl::StrCat("subtree_topology/", platform, "/", node_id);
 }
 
 static std::string GetGlobalTopologyKey(std::string_view platform) {
   return absl::StrCat("global_topology/", platform);
 }
 
-static absl::StatusOr<std::vector<LocalTopologyProto>> GetAllLocalTopologies(
-    std::string_view platform, int num_nodes, KeyValueStoreInterface* kv_store,
-    absl::Duration timeout) {
-  std::vector<absl::StatusOr<std::string>> local_topology_strs(num_nodes);
-
-  // TODO(ezhulenev): Should a thread pool become a function argument?
-  tsl::thread::ThreadPool thread_pool(
-      tsl::Env::Default(), "GetAllLocalTopologies", DefaultThreadPoolSize());
-
-  absl::BlockingCounter blocking_counter(num_nodes);
-  absl::Mutex mu;
-  for (int i = 0; i < num_nodes; i++) {
-    thread_pool.Schedule([&, i] {
-      absl::StatusOr<std::string> local_topology_str =
-          kv_store->Get(GetLocalTopologyKey(platform, i), timeout);
-      {
-        absl::MutexLock lock(&mu);
-        local_topology_strs[i] = local_topology_str;
+// Topologies published to the key-value store are prefixed with one byte that
+// tells how the rest of the value is encoded. Gathered topologies repeat boot
+// ids and device descriptions of many nodes, and compress well.
+enum class TopologyEncoding : char {
+  kUncompressed = 0,
+  kSnappy = 1,
+};
+
+std::string EncodeTopology(const GlobalTopologyProto& topology) {
+  std::string serialized = topology.SerializeAsString();
+  std::string compressed;
+  // Only compress if it saves at least 1/8 of the bytes, as decompression is
+  // not free either. Compression is not available in all builds.
+  if (tsl::port::Snappy_Compress(serialized.data(), serialized.size(),
+                                 &compressed) &&
+      compressed.size() < serialized.size() - serialized.size() / 8) {
+    std::string encoded(1, static_cast<char>(TopologyEncoding::kSnappy));
+    return encoded.append(compressed);
+  }
+  std::string encoded(1, static_cast<char>(TopologyEncoding::kUncompressed));
+  return encoded.append(serialized);
+}
+
+absl::StatusOr<GlobalTopologyProto> DecodeTopology(std::string_view encoded) {
+  if (encoded.empty()) {
+    return absl::InvalidArgumentError("Empty encoded topology");
+  }
+  std::string_view data = encoded.substr(1);
+  std::string uncompressed;
+  switch (static_cast<TopologyEncoding>(encoded[0])) {
+    case TopologyEncoding::kUncompressed:
+      break;
+    case TopologyEncoding::kSnappy: {
+      size_t uncompressed_size;
+      if (!tsl::port::Snappy_GetUncompressedLength(data.data(), data.size(),
+                                                   &uncompressed_size)) {
+        return absl::InvalidArgumentError(
+            "Failed to get uncompressed topology size");
+      }
+      uncompressed.resize(uncompressed_size);
+      if (!tsl::port::Snappy_Uncompress(data.data(), data.size(),
+                                        uncompressed.data())) {
+        return absl::InvalidArgumentError("Failed to uncompress topology");
       }
-      blocking_counter.DecrementCount();
-    });
+      data = uncompressed;
+      break;
+    }
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Unknown topology encoding: ", static_cast<int>(encoded[0])));
+  }
+  GlobalTopologyProto topology;
+  if (!topology.ParseFromArray(data.data(), data.size())) {
+    return absl::InvalidArgumentError("Failed to parse topology");
+  }
+  return topology;
+}
+
+// Returns the ids of the children of `node_id` in the gather tree.
+static std::vector<int> GetChildNodeIds(int node_id, int num_nodes) {
+  std::vector<int> children;
+  int64_t first_child = int64_t{node_id} * kTopologyGatherFanout + 1;
+  for (int64_t child = first_child;
+       child < first_child + kTopologyGatherFanout && child < num_nodes;
+       ++child) {
+    children.push_back(child);
+  }
+  return children;
+}
+
+// Appends the ids of the nodes in the subtree of `node_id` in the order in
+// which their topologies are gathered (pre-order).
+static void AppendSubtreeNodeIds(int node_id, int num_nodes,
+                                 std::vector<int>* node_ids) {
+  node_ids->push_back(node_id);
+  for (int child : GetChildNodeIds(node_id, num_nodes)) {
+    AppendSubtreeNodeIds(child, num_nodes, node_ids);
+  }
+}
+
+// Returns the local topologies of all nodes in the subtree of `node_id`,
+// gathered from the subtree topologies published by its children. Waits for
+// the children until `deadline`, which is shared by all levels of the tree so
+// that the whole gather, and not each level of it, is bounded by the timeout.
+static absl::StatusOr<GlobalTopologyProto> GatherSubtreeTopologies(
+    std::string_view platform, int node_id, int num_nodes,
+    KeyValueStoreInterface* kv_store, const LocalTopologyProto& local_topology,
+    absl::Time deadline) {
+  GlobalTopologyProto subtree;
+  *subtree.add_nodes() = local_topology;
+
+  std::vector<int> children = GetChildNodeIds(node_id, num_nodes);
+  if (children.empty()) {
+    return subtree;
+  }
+
+  std::vector<absl::StatusOr<std::string>> subtree_strs(children.size());
+  {
+    tsl::thread::ThreadPool thread_pool(
+        tsl::Env::Default(), "GatherSubtreeTopologies", children.size());
+
+    absl::BlockingCounter blocking_counter(children.size());
+    absl::Mutex mu;
+    for (int i = 0; i < children.size(); i++) {
+      thread_pool.Schedule([&, i] {
+        absl::StatusOr<std::string> subtree_str = kv_store->Get(
+            GetSubtreeTopologyKey(platform, children[i]),
+            std::max(deadline - absl::Now(), absl::ZeroDuration()));
+        {
+          absl::MutexLock lock(&mu);
+          subtree_strs[i] = subtree_str;
+        }
+        blocking_counter.DecrementCount();
+      });
+    }
+    blocking_counter.Wait();
   }
-  blocking_counter.Wait();
 
   std::vector<std::string> error_messages;
-  std::vector<LocalTopologyProto> local_topologies;
   int max_num_failed_message = 10;
   int failed_count = 0;
-  for (const absl::StatusOr<std::string>& str : local_topology_strs) {
-    if (str.ok()) {
-      LocalTopologyProto local;
-      local.ParseFromString(*str);
-      local_topologies.push_back(local);
+  for (int i = 0; i < children.size(); i++) {
+    const absl::StatusOr<std::string>& str = subtree_strs[i];
+    absl::StatusOr<GlobalTopologyProto> child_subtree =
+        str.ok() ? DecodeTopology(*str) : str.status();
+    if (child_subtree.ok()) {
+      for (LocalTopologyProto& local : *child_subtree->mutable_nodes()) {
+        subtree.add_nodes()->Swap(&local);
+      }
     } else {
       error_messages.push_back(
-          absl::StrCat("Error ", ++failed_count, ": ", str.status().message()));
+          absl::StrCat("Error ", ++failed_count, " (from node ", children[i],
+                       "): ", child_subtree.status().message()));
       if (failed_count > max_num_failed_message) {
         break;
       }
     }
   }
   if (error_messages.empty()) {
-    return local_topologies;
+    return subtree;
   }
   return absl::InternalError(
       absl::StrCat("Getting local topologies failed: ",
@@ -179,26 +284,44 @@ absl::Status ExchangeTopologies(std::string_view platform, int node_id,
     return absl::OkStatus();
   }
   CHECK(kv_store != nullptr);
-  TF_RETURN_IF_ERROR(kv_store->Set(GetLocalTopologyKey(platform, node_id),
-                                   local_topology.SerializeAsString()));
+  absl::Time local_topology_deadline = absl::Now() + get_local_topology_timeout;
+
+  // Local topologies are gathered along a tree rooted at the lead node: every
+  // node waits for the topologies of its children's subtrees, and publishes
+  // them together with its own topology to its parent.
+  TF_ASSIGN_OR_RETURN(
+      GlobalTopologyProto subtree,
+      GatherSubtreeTopologies(platform, node_id, num_nodes, kv_store,
+                              local_topology, local_topology_deadline));
 
-  // The lead node gets all local topologies, builds the global topology and
+  // The lead node builds the global topology from all local topologies and
   // puts it to the key-value store.
   std::string global_topology_key = GetGlobalTopologyKey(platform);
   if (node_id == 0) {
-    TF_ASSIGN_OR_RETURN(std::vector<LocalTopologyProto> local_topologies,
-                        GetAllLocalTopologies(platform, num_nodes, kv_store,
-                                              get_local_topology_timeout));
+    std::vector<int> node_ids;
+    AppendSubtreeNodeIds(/*node_id=*/0, num_nodes, &node_ids);
+    if (subtree.nodes_size() != num_nodes) {
+      return absl::InternalError(
+          absl::StrCat("Gathered ", subtree.nodes_size(),
+                       " local topologies, expected ", num_nodes));
+    }
+
+    std::vector<LocalTopologyProto> local_topologies(num_nodes);
+    for (int i = 0; i < num_nodes; i++) {
+      local_topologies[node_ids[i]].Swap(subtree.mutable_nodes(i));
+    }
     *global_topology =
         BuildGlobalTopology(absl::Span<LocalTopologyProto>(local_topologies),
                             assign_global_device_ids);
-    TF_RETURN_IF_ERROR(kv_store->Set(global_topology_key,
-                                     global_topology->SerializeAsString()));
+    TF_RETURN_IF_ERROR(
+        kv_store->Set(global_topology_key, EncodeTopology(*global_topology)));
   } else {
+    TF_RETURN_IF_ERROR(kv_store->Set(GetSubtreeTopologyKey(platform, node_id),
+                                     EncodeTopology(subtree)));
     TF_ASSIGN_OR_RETURN(
         std::string global_topology_str,
         kv_store->Get(global_topology_key, get_global_topology_timeout));
-    global_topology->ParseFromString(global_topology_str);
+    TF_ASSIGN_OR_RETURN(*global_topology, DecodeTopology(global_topology_str));
   }
   VLOG(3) << "Global topology for platform " << platform << ":\n"
           << global_topology->DebugString();
@@ -62,6 +62,11 @@ GlobalTopologyProto BuildGlobalTopology(
 // given GlobalTopologyProto.
 absl::StatusOr<GpuTopologyProto> BuildGpuTopology(
     const GlobalTopologyProto& global_topology);
+
+// Encodes a topology as it is published to the KV store, compressed if that
+// saves enough bytes, and decodes it back.
+std::string EncodeTopology(const GlobalTopologyProto& topology);
+absl::StatusOr<GlobalTopologyProto> DecodeTopology(std::string_view encoded);
 }  // namespace xla
 
 #endif  // XLA_PJRT_DISTRIBUTED_TOPOLOGY_UTIL_H_
@@ -19,6 +19,7 @@ limitations under the License.
 #include <string_view>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xla/pjrt/distributed/in_memory_key_value_store.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "xla/test_helpers.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/snappy.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test.h"
 #include "tsl/platform/threadpool.h"
@@ -87,6 +89,96 @@ TEST(TopologyTest, ExchangeTopology) {
   }
 }
 
+TEST(TopologyTest, ExchangeTopologyAcrossManyNodes) {
+  // Enough nodes for local topologies to be gathered along several levels of
+  // the gather tree.
+  int num_nodes = 70;
+  std::vector<LocalTopologyProto> locals(num_nodes);
+  for (int i = 0; i < num_nodes; i++) {
+    locals[i].set_node_id(i);
+    locals[i].add_devices()->set_local_device_ordinal(0);
+  }
+
+  InMemoryKeyValueStore kv_store;
+  std::vector<GlobalTopologyProto> globals(num_nodes);
+  {
+    tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "TestPool",
+                                        num_nodes);
+    for (int i = 0; i < num_nodes; i++) {
+      thread_pool.Schedule([&, i] {
+        TF_ASSERT_OK(ExchangeTopologies(
+            /*platform=*/"cuda", /*node_id=*/i, num_nodes,
+            /*get_local_topology_timeout=*/
+            absl::Seconds(10), /*get_global_topology_timeout=*/
+            absl::Seconds(10), &kv_store, locals[i], &globals[i],
+            /*assign_global_device_ids=*/true));
+      });
+    }
+  }
+  for (const GlobalTopologyProto& global : globals) {
+    ASSERT_EQ(global.nodes_size(), num_nodes);
+    for (int i = 0; i < num_nodes; i++) {
+      EXPECT_EQ(global.nodes(i).node_id(), i);
+      EXPECT_EQ(global.nodes(i).devices(0).global_device_id(), i);
+    }
+  }
+}
+
+TEST(TopologyTest, EncodeDecodeTopology) {
+  GlobalTopologyProto topology;
+  LocalTopologyProto* node = topology.add_nodes();
+  node->set_node_id(3);
+  node->set_boot_id("foo");
+  DeviceProto* device = node->add_devices();
+  device->set_local_device_ordinal(1);
+  device->set_global_device_id(7);
+
+  TF_ASSERT_OK_AND_ASSIGN(GlobalTopologyProto decoded,
+                          DecodeTopology(EncodeTopology(topology)));
+  EXPECT_EQ(decoded.SerializeAsString(), topology.SerializeAsString());
+}
+
+TEST(TopologyTest, EncodeDecodeLargeTopology) {
+  // Repeated boot ids and device descriptions, which compress well.
+  GlobalTopologyProto topology;
+  for (int i = 0; i < 256; i++) {
+    LocalTopologyProto* node = topology.add_nodes();
+    node->set_node_id(i);
+    node->set_boot_id(absl::StrCat("boot-id-of-slice-", i / 16));
+    for (int j = 0; j < 8; j++) {
+      DeviceProto* device = node->add_devices();
+      device->set_local_device_ordinal(j);
+      device->set_global_device_id(i * 8 + j);
+      device->set_name("NVIDIA H100 80GB HBM3");
+      device->set_vendor("NVIDIA Corporation");
+      device->set_compute_capability("9.0");
+      device->set_device_kind("NVIDIA H100 80GB HBM3");
+    }
+  }
+
+  std::string serialized = topology.SerializeAsString();
+  std::string encoded = EncodeTopology(topology);
+  std::string compressed;
+  if (tsl::port::Snappy_Compress(serialized.data(), serialized.size(),
+                                 &compressed)) {
+    EXPECT_LT(encoded.size(), serialized.size());
+  } else {
+    EXPECT_EQ(encoded.size(), serialized.size() + 1);
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(GlobalTopologyProto decoded,
+                          DecodeTopology(encoded));
+  EXPECT_EQ(decoded.SerializeAsString(), serialized);
+}
+
+TEST(TopologyTest, DecodeInvalidTopology) {
+  EXPECT_FALSE(DecodeTopology("").ok());
+  EXPECT_FALSE(DecodeTopology(std::string_view("\x7f", 1)).ok());
+
+  // A Snappy encoded topology that is not valid Snappy data.
+  EXPECT_FALSE(DecodeTopology(std::string_view("\x01\xff\xff", 3)).ok());
+}
+
 TEST(TopologyTest, BuildGpuTopology) {
   std::string slice_0_boot_id = "foo";
   std::string slice_1_boot_id = "bar";
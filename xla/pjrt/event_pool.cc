@@ -15,9 +15,14 @@ limitations under the License.
 
 #include "xla/pjrt/event_pool.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
 #include <memory>
+#include <thread>  // NOLINT
 #include <utility>
 
+#include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/stream_executor/stream.h"
@@ -27,25 +32,59 @@ namespace xla {
 
 EventPool::Handle::~Handle() {
   if (pool_ && event_) {
-    absl::MutexLock lock(&pool_->mu_free_events_);
-    pool_->free_events_.push(std::move(event_));
+    pool_->PushFreeEvent(std::move(event_));
   }
 }
 
 EventPool::EventPool(bool allow_reuse)
     : allow_reuse_(allow_reuse), next_sequence_number_(1) {}
 
+EventPool::Cache& EventPool::ThreadCache() {
+  static thread_local const size_t shard =
+      absl::HashOf(std::this_thread::get_id()) % kNumShards;
+  return caches_[shard];
+}
+
+std::unique_ptr<se::Event> EventPool::PopFreeEvent() {
+  Cache& cache = ThreadCache();
+  absl::MutexLock lock(&cache.mu);
+
+  if (cache.events.empty()) {
+    absl::MutexLock global_lock(&mu_free_events_);
+    size_t n = std::min(kBatchSize, free_events_.size());
+    std::move(free_events_.end() - n, free_events_.end(),
+              std::back_inserter(cache.events));
+    free_events_.resize(free_events_.size() - n);
+  }
+
+  if (cache.events.empty()) return nullptr;
+  std::unique_ptr<se::Event> event = std::move(cache.events.back());
+  cache.events.pop_back();
+  return event;
+}
+
+void EventPool::PushFreeEvent(std::unique_ptr<se::Event> event) {
+  Cache& cache = ThreadCache();
+  absl::MutexLock lock(&cache.mu);
+  cache.events.push_back(std::move(event));
+
+  // Return a batch of events to the global free list, so that threads that
+  // release more events than they allocate don't hoard them.
+  if (cache.events.size() > 2 * kBatchSize) {
+    absl::MutexLock global_lock(&mu_free_events_);
+    std::move(cache.events.end() - kBatchSize, cache.events.end(),
+              std::back_inserter(free_events_));
+    cache.events.resize(cache.events.size() - kBatchSize);
+  }
+}
+
 absl::StatusOr<EventPool::Handle> EventPool::AllocateEvent(
     se::StreamExecutor* executor) {
   Handle event;
 
   if (allow_reuse_) {
     event.pool_ = this;
-    absl::MutexLock lock(&mu_free_events_);
-    if (!free_events_.empty()) {
-      event.event_ = std::move(free_events_.top());
-      free_events_.pop();
-    }
+    event.event_ = PopFreeEvent();
   }
   if (!event.event_) {
     TF_ASSIGN_OR_RETURN(event.event_, executor->CreateEvent());
@@ -54,9 +93,10 @@ absl::StatusOr<EventPool::Handle> EventPool::AllocateEvent(
 }
 
 void EventPool::ThenRecordEvent(se::Stream* stream, EventPool::Handle& handle) {
-  absl::MutexLock lock(&mu_sequence_number_);
+  absl::MutexLock lock(&mu_record_[absl::HashOf(stream) % kNumShards]);
   stream->RecordEvent(handle.event_.get()).IgnoreError();
-  handle.sequence_number_ = next_sequence_number_++;
+  handle.sequence_number_ =
+      next_sequence_number_.fetch_add(1, std::memory_order_relaxed);
 }
 
 absl::StatusOr<EventPool::Handle> EventPool::ThenAllocateAndRecordEvent(
@@ -16,9 +16,14 @@ limitations under the License.
 #ifndef XLA_PJRT_EVENT_POOL_H_
 #define XLA_PJRT_EVENT_POOL_H_
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <stack>
+#include <vector>
 
+#include "absl/base/optimization.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
@@ -87,14 +92,37 @@ class EventPool {
   void ThenRecordEvent(se::Stream* stream, EventPool::Handle& handle);
 
  private:
+  // Free events are cached in shards selected by the calling thread, so that
+  // threads allocating and releasing events concurrently rarely contend.
+  // Shards exchange events with the global free list in batches.
+  struct alignas(ABSL_CACHELINE_SIZE) Cache {
+    absl::Mutex mu;
+    std::vector<std::unique_ptr<se::Event>> events ABSL_GUARDED_BY(mu);
+  };
+
+  static constexpr size_t kNumShards = 16;
+  static constexpr size_t kBatchSize = 16;
+
+  // Returns the cache of the calling thread.
+  Cache& ThreadCache();
+
+  // Returns a free event, or nullptr if there is none.
+  std::unique_ptr<se::Event> PopFreeEvent();
+  void PushFreeEvent(std::unique_ptr<se::Event> event);
+
   const bool allow_reuse_;
 
+  std::array<Cache, kNumShards> caches_;
+
   absl::Mutex mu_free_events_;
-  std::stack<std::unique_ptr<se::Event>> free_events_
+  std::vector<std::unique_ptr<se::Event>> free_events_
       ABSL_GUARDED_BY(mu_free_events_);
 
-  absl::Mutex mu_sequence_number_;
-  uint64_t next_sequence_number_ ABSL_GUARDED_BY(mu_sequence_number_);
+  // Events recorded on the same stream must get increasing sequence numbers,
+  // so recording and sequence number assignment happen under a lock. Locks
+  // are striped by stream, so recording on different streams rarely contends.
+  std::array<absl::Mutex, kNumShards> mu_record_;
+  std::atomic<uint64_t> next_sequence_number_;
 };
 
 }  // namespace xla
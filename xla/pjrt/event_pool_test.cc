@@ -0,0 +1,147 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/event_pool.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/stream_executor/event.h"
+#include "xla/stream_executor/platform.h"
+#include "xla/stream_executor/platform_manager.h"
+#include "xla/stream_executor/stream.h"
+#include "xla/stream_executor/stream_executor.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla {
+namespace {
+
+se::StreamExecutor* HostExecutor() {
+  se::Platform* platform =
+      se::PlatformManager::PlatformWithName("Host").value();
+  return platform->ExecutorForDevice(0).value();
+}
+
+TEST(EventPoolTest, RecordsIncreasingSequenceNumbers) {
+  EventPool pool(/*allow_reuse=*/false);
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, HostExecutor()->CreateStream());
+
+  uint64_t last_sequence_number = 0;
+  for (int i = 0; i < 4; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(EventPool::Handle handle,
+                            pool.ThenAllocateAndRecordEvent(stream.get()));
+    EXPECT_NE(handle.event(), nullptr);
+    EXPECT_GT(handle.sequence_number(), last_sequence_number);
+    last_sequence_number = handle.sequence_number();
+  }
+  TF_ASSERT_OK(stream->BlockHostUntilDone());
+}
+
+TEST(EventPoolTest, ReusesReleasedEvents) {
+  EventPool pool(/*allow_reuse=*/true);
+  se::StreamExecutor* executor = HostExecutor();
+
+  // Enough events to move batches between the thread's cache and the global
+  // free list.
+  constexpr int kNumEvents = 100;
+  absl::flat_hash_set<se::Event*> events;
+  {
+    std::vector<EventPool::Handle> handles;
+    for (int i = 0; i < kNumEvents; ++i) {
+      TF_ASSERT_OK_AND_ASSIGN(handles.emplace_back(),
+                              pool.AllocateEvent(executor));
+      EXPECT_TRUE(events.insert(handles.back().event()).second);
+    }
+  }
+
+  // The released events are still owned by the pool, so newly created events
+  // can't have the same addresses.
+  std::vector<EventPool::Handle> handles;
+  for (int i = 0; i < kNumEvents; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(handles.emplace_back(),
+                            pool.AllocateEvent(executor));
+    EXPECT_EQ(events.erase(handles.back().event()), 1);
+  }
+  EXPECT_TRUE(events.empty());
+}
+
+TEST(EventPoolTest, ConcurrentAllocateAndRelease) {
+  EventPool pool(/*allow_reuse=*/true);
+  se::StreamExecutor* executor = HostExecutor();
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumIterations = 500;
+  constexpr int kMaxLiveEventsPerThread = 20;
+
+  // Events held by some handle. An event must never be handed out twice.
+  absl::Mutex mu;
+  absl::flat_hash_set<se::Event*> live_events;
+
+  {
+    tsl::thread::ThreadPool threads(tsl::Env::Default(), "event_pool_test",
+                                    kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.Schedule([&, t] {
+        auto stream = executor->CreateStream();
+        TF_ASSERT_OK(stream.status());
+        std::vector<EventPool::Handle> handles;
+        uint64_t last_sequence_number = 0;
+        for (int i = 0; i < kNumIterations; ++i) {
+          auto handle = pool.ThenAllocateAndRecordEvent(stream->get());
+          TF_ASSERT_OK(handle.status());
+          // Events recorded on the same stream are ordered.
+          EXPECT_GT(handle->sequence_number(), last_sequence_number);
+          last_sequence_number = handle->sequence_number();
+          {
+            absl::MutexLock lock(&mu);
+            EXPECT_TRUE(live_events.insert(handle->event()).second);
+          }
+          handles.push_back(*std::move(handle));
+
+          // Release a varying number of events, so that threads return
+          // events to the pool at different rates.
+          if (handles.size() >= kMaxLiveEventsPerThread ||
+              (i + t) % 3 == 0) {
+            int num_released = 1 + (i + t) % handles.size();
+            for (int j = 0; j < num_released; ++j) {
+              {
+                absl::MutexLock lock(&mu);
+                live_events.erase(handles.back().event());
+              }
+              handles.pop_back();
+            }
+          }
+        }
+        TF_ASSERT_OK((*stream)->BlockHostUntilDone());
+        absl::MutexLock lock(&mu);
+        for (const EventPool::Handle& handle : handles) {
+          live_events.erase(handle.event());
+        }
+      });
+    }
+  }
+  EXPECT_TRUE(live_events.empty());
+}
+
+}  // namespace
+}  // namespace xla
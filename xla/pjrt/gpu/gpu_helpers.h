@@ -23,6 +23,7 @@ limitations under the License.
 #include <string>
 
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xla/client/local_client.h"
 #include "xla/stream_executor/stream_executor.h"
@@ -68,6 +69,24 @@ struct GpuAllocatorConfig {
   // allocator will allocate more memory as allocations are requested.
   bool preallocate = true;
 
+  // Only used if kind == kBFC. If true, small allocations are served from
+  // slabs of fixed size classes carved out of the BFC allocator, which avoids
+  // contending on the BFC allocator's lock for small buffers.
+  bool enable_slab_allocator = false;
+
+  // Only used if kind == kCudaAsync, and for the temp buffer allocator. If
+  // non-zero, the allocator checks for memory pressure at this interval and
+  // trims its pool down to the recent working set when less than
+  // `cuda_async_min_free_memory_fraction` of device memory is free.
+  absl::Duration cuda_async_trim_interval = absl::ZeroDuration();
+  double cuda_async_min_free_memory_fraction = 0.1;
+
+  // If true, the allocator for temp buffers with a separate memory space color
+  // (xla_gpu_temp_buffer_use_separate_color) allocates and frees
+  // stream-ordered on the compute stream instead of synchronizing the stream
+  // after every allocation.
+  bool stream_ordered_temp_buffers = false;
+
   // Amount of collective memory (ncclMemAlloc) to preallocate. If this value is
   // 0, collective memory space will be grown as needed to fit the application's
   // usage, with the drawback of potentially higher fragmentation. If set,
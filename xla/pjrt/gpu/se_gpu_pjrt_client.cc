@@ -82,6 +82,7 @@ limitations under the License.
 #include "xla/stream_executor/stream.h"
 #include "xla/stream_executor/stream_executor.h"
 #include "xla/tsl/framework/allocator.h"
+#include "xla/tsl/framework/slab_allocator.h"
 #include "xla/tsl/lib/strings/proto_serialization.h"
 #include "tsl/platform/casts.h"
 #include "tsl/platform/errors.h"
@@ -843,6 +844,176 @@ StreamExecutorGpuClient::Load(std::unique_ptr<PjRtExecutable> executable) {
   return std::unique_ptr<PjRtLoadedExecutable>(std::move(ret));
 }
 
+#if GOOGLE_CUDA
+namespace {
+
+// Serialized form of a handle returned by ExportBufferIpcHandle: the CUDA IPC
+// handle of the allocation containing the buffer, followed by the offset of
+// the buffer within that allocation and the buffer's size in bytes.
+struct IpcHandlePayload {
+  cudaIpcMemHandle_t mem_handle;
+  uint64_t offset;
+  uint64_t size;
+};
+
+absl::Status CudaIpcStatus(cudaError_t error, absl::string_view what) {
+  if (error == cudaSuccess) {
+    return absl::OkStatus();
+  }
+  return Internal("%s failed: %s", what, cudaGetErrorString(error));
+}
+
+// Makes `device_ordinal` the current CUDA device for the lifetime of the
+// object, restoring the previous device on destruction.
+class ScopedCudaDevice {
+ public:
+  explicit ScopedCudaDevice(int device_ordinal) {
+    if (cudaGetDevice(&previous_) != cudaSuccess) {
+      previous_ = -1;
+    }
+    if (previous_ != device_ordinal) {
+      cudaSetDevice(device_ordinal);
+    }
+  }
+  ~ScopedCudaDevice() {
+    if (previous_ >= 0) {
+      cudaSetDevice(previous_);
+    }
+  }
+
+ private:
+  int previous_;
+};
+
+}  // namespace
+#endif  // GOOGLE_CUDA
+
+absl::StatusOr<StreamExecutorGpuClient::IpcBufferExport>
+StreamExecutorGpuClient::ExportBufferIpcHandle(PjRtBuffer* buffer) {
+#if GOOGLE_CUDA
+  if (buffer->client() != this) {
+    return InvalidArgument(
+        "ExportBufferIpcHandle called with a buffer from another client.");
+  }
+  const Shape& shape = buffer->on_device_shape();
+  if (!shape.IsArray() || shape.is_dynamic()) {
+    return InvalidArgument(
+        "ExportBufferIpcHandle requires a static array buffer, got %s.",
+        shape.ToString());
+  }
+  TF_ASSIGN_OR_RETURN(size_t size, buffer->GetOnDeviceSizeInBytes());
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtBuffer::ExternalReference> reference,
+                      buffer->AcquireExternalReference());
+  auto ptr =
+      reinterpret_cast<CUdeviceptr>(reference->OpaqueDeviceMemoryDataPointer());
+
+  // Allocators hand out sub-ranges of larger allocations, and IPC handles
+  // always refer to a whole allocation, so record where the buffer starts.
+  ScopedCudaDevice scoped_device(
+      tensorflow::down_cast<PjRtStreamExecutorDevice*>(buffer->device())
+          ->local_device_state()
+          ->executor()
+          ->device_ordinal());
+  CUdeviceptr base;
+  if (CUresult result = cuPointerGetAttribute(
+          &base, CU_POINTER_ATTRIBUTE_RANGE_START_ADDR, ptr);
+      result != CUDA_SUCCESS) {
+    return Internal("cuPointerGetAttribute failed with error %d.", result);
+  }
+  IpcHandlePayload payload;
+  TF_RETURN_IF_ERROR(CudaIpcStatus(
+      cudaIpcGetMemHandle(&payload.mem_handle, reinterpret_cast<void*>(base)),
+      "cudaIpcGetMemHandle"));
+  payload.offset = ptr - base;
+  payload.size = size;
+
+  IpcBufferExport result;
+  result.handle.resize(sizeof(payload));
+  std::memcpy(result.handle.data(), &payload, sizeof(payload));
+  result.external_reference = std::move(reference);
+  return result;
+#else
+  return Unimplemented("ExportBufferIpcHandle is only supported on CUDA.");
+#endif  // GOOGLE_CUDA
+}
+
+absl::StatusOr<std::unique_ptr<PjRtBuffer>>
+StreamExecutorGpuClient::ImportBufferFromIpcHandle(absl::string_view handle,
+                                                   const Shape& shape,
+                                                   PjRtDevice* device) {
+#if GOOGLE_CUDA
+  IpcHandlePayload payload;
+  if (handle.size() != sizeof(payload)) {
+    return InvalidArgument("Malformed IPC handle of size %d.", handle.size());
+  }
+  std::memcpy(&payload, handle.data(), sizeof(payload));
+  if (!shape.IsArray() || shape.is_dynamic()) {
+    return InvalidArgument(
+        "ImportBufferFromIpcHandle requires a static array shape, got %s.",
+        shape.ToString());
+  }
+  if (ShapeUtil::ByteSizeOf(shape) > payload.size) {
+    return InvalidArgument(
+        "Shape %s does not fit in the %d bytes of the exported buffer.",
+        shape.ToString(), payload.size);
+  }
+  TF_ASSIGN_OR_RETURN(LocalDeviceState * local_device,
+                      tensorflow::down_cast<PjRtStreamExecutorDevice*>(device)
+                          ->GetLocalDeviceState());
+  int device_ordinal = local_device->executor()->device_ordinal();
+
+  std::string key = absl::StrCat(
+      device_ordinal, ":",
+      absl::string_view(reinterpret_cast<const char*>(&payload.mem_handle),
+                        sizeof(payload.mem_handle)));
+  void* base;
+  {
+    absl::MutexLock lock(&ipc_mu_);
+    IpcMapping& mapping = ipc_mappings_[key];
+    if (mapping.num_imports == 0) {
+      ScopedCudaDevice scoped_device(device_ordinal);
+      absl::Status status = CudaIpcStatus(
+          cudaIpcOpenMemHandle(&mapping.base, payload.mem_handle,
+                               cudaIpcMemLazyEnablePeerAccess),
+          "cudaIpcOpenMemHandle");
+      if (!status.ok()) {
+        ipc_mappings_.erase(key);
+        return status;
+      }
+    }
+    ++mapping.num_imports;
+    base = mapping.base;
+  }
+
+  auto release_mapping = [this, key, device_ordinal]() {
+    absl::MutexLock lock(&ipc_mu_);
+    auto it = ipc_mappings_.find(key);
+    CHECK(it != ipc_mappings_.end());
+    if (--it->second.num_imports > 0) {
+      return;
+    }
+    ScopedCudaDevice scoped_device(device_ordinal);
+    absl::Status status = CudaIpcStatus(
+        cudaIpcCloseMemHandle(it->second.base), "cudaIpcCloseMemHandle");
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+    }
+    ipc_mappings_.erase(it);
+  };
+
+  absl::StatusOr<std::unique_ptr<PjRtBuffer>> buffer =
+      CreateViewOfDeviceBuffer(static_cast<char*>(base) + payload.offset, shape,
+                               device, release_mapping,
+                               /*stream=*/std::nullopt);
+  if (!buffer.ok()) {
+    release_mapping();
+  }
+  return buffer;
+#else
+  return Unimplemented("ImportBufferFromIpcHandle is only supported on CUDA.");
+#endif  // GOOGLE_CUDA
+}
+
 namespace {
 
 #if defined(GOOGLE_CUDA) && CUDA_VERSION >= 11020
@@ -850,7 +1021,8 @@ namespace {
 absl::StatusOr<std::unique_ptr<se::GpuCudaMallocAsyncAllocator>>
 CreateCudaAsyncAllocator(const LocalDeviceState& device, double memory_fraction,
                          bool reserve_memory, bool create_new_pool,
-                         bool sync_mode, bool compute_stats = true) {
+                         bool sync_mode, bool compute_stats,
+                         const GpuAllocatorConfig& allocator_config) {
   se::StreamExecutor* executor = device.executor();
   int device_ordinal = executor->device_ordinal();
 
@@ -886,6 +1058,12 @@ CreateCudaAsyncAllocator(const LocalDeviceState& device, double memory_fraction,
 
   allocator->SetStreamAndPreallocateMemory(
       device.compute_stream()->platform_specific_handle().stream);
+  if (compute_stats &&
+      allocator_config.cuda_async_trim_interval > absl::ZeroDuration()) {
+    allocator->SetPoolTrimPolicy(
+        {allocator_config.cuda_async_trim_interval,
+         allocator_config.cuda_async_min_free_memory_fraction});
+  }
 
   return allocator;
 }
@@ -893,7 +1071,8 @@ CreateCudaAsyncAllocator(const LocalDeviceState& device, double memory_fraction,
 #else  // defined(GOOGLE_CUDA) && CUDA_VERSION >= 11020
 absl::StatusOr<std::unique_ptr<tsl::Allocator>> CreateCudaAsyncAllocator(
     const LocalDeviceState& device, double memory_fraction, bool reserve_memory,
-    bool create_new_pool, bool sync_mode, bool compute_stats = true) {
+    bool create_new_pool, bool sync_mode, bool compute_stats,
+    const GpuAllocatorConfig& allocator_config) {
   return FailedPrecondition("CUDA async allocator requires CUDA >= 11.2");
 }
 
@@ -901,7 +1080,23 @@ absl::StatusOr<std::unique_ptr<tsl::Allocator>> CreateCudaAsyncAllocator(
 
 // Builds a LocalDeviceState for each GPU present.
 absl::StatusOr<std::map<int, std::unique_ptr<LocalDeviceState>>>
-BuildLocalDeviceStates(LocalClient* xla_client) {
+BuildLocalDeviceStates(
+    LocalClient* xla_client, int num_shared_worker_threads,
+    int max_inflight_computations,
+    std::optional<LocalDeviceState::StreamOptions> stream_options) {
+  std::shared_ptr<tsl::thread::ThreadPool> worker_thread_pool;
+  if (num_shared_worker_threads > 0) {
+    int num_devices = xla_client->backend().stream_executors().size();
+    if (num_shared_worker_threads <= num_devices) {
+      return InvalidArgument(
+          "num_shared_worker_threads must be larger than the number of local "
+          "devices, got %d for %d devices",
+          num_shared_worker_threads, num_devices);
+    }
+    worker_thread_pool = std::make_shared<tsl::thread::ThreadPool>(
+        tsl::Env::Default(), "py_xla_worker", num_shared_worker_threads);
+  }
+
   std::map<int, std::unique_ptr<LocalDeviceState>> addressable_devices;
   for (se::StreamExecutor* executor :
        xla_client->backend().stream_executors()) {
@@ -909,8 +1104,9 @@ BuildLocalDeviceStates(LocalClient* xla_client) {
         executor->device_ordinal(),
         std::make_unique<LocalDeviceState>(
             executor, xla_client, LocalDeviceState::kComputeSynchronized,
-            /*max_inflight_computations=*/32,
-            /*allow_event_reuse=*/true, /*use_callback_stream=*/true));
+            max_inflight_computations,
+            /*allow_event_reuse=*/true, /*use_callback_stream=*/true,
+            /*device_ordinal=*/-1, stream_options, worker_thread_pool));
   }
   return std::move(addressable_devices);
 }
@@ -930,7 +1126,8 @@ GetStreamExecutorGpuDeviceAllocator(
             auto async_allocator,
             CreateCudaAsyncAllocator(
                 *(ordinal_and_device.second), allocator_config.memory_fraction,
-                allocator_config.preallocate, false, false, true));
+                allocator_config.preallocate, false, false, true,
+                allocator_config));
         allocators.emplace_back(std::move(async_allocator),
                                 ordinal_and_device.second->compute_stream(),
                                 /*memory_space=*/0);
@@ -948,7 +1145,13 @@ GetStreamExecutorGpuDeviceAllocator(
                                allocator_config.memory_fraction,
                                allocator_config.preallocate,
                                allocator_config.gpu_system_memory_size));
-        allocators.emplace_back(std::move(bfc_allocator),
+        std::unique_ptr<tsl::Allocator> device_allocator =
+            std::move(bfc_allocator);
+        if (allocator_config.enable_slab_allocator) {
+          device_allocator = std::make_unique<tsl::SlabAllocator>(
+              std::move(device_allocator), tsl::SlabAllocator::Options());
+        }
+        allocators.emplace_back(std::move(device_allocator),
                                 ordinal_and_device.second->compute_stream(),
                                 /*memory_space=*/0);
       }
@@ -997,8 +1200,10 @@ GetStreamExecutorGpuDeviceAllocator(
     for (const auto& ordinal_and_device : addressable_devices) {
       TF_ASSIGN_OR_RETURN(
           auto async_allocator,
-          CreateCudaAsyncAllocator(*(ordinal_and_device.second), 1.0, false,
-                                   true, true, true));
+          CreateCudaAsyncAllocator(
+              *(ordinal_and_device.second), 1.0, false, true,
+              /*sync_mode=*/!allocator_config.stream_ordered_temp_buffers,
+              true, allocator_config));
       allocators.emplace_back(
           std::move(async_allocator),
           ordinal_and_device.second->compute_stream(),
@@ -1260,7 +1465,11 @@ absl::StatusOr<std::unique_ptr<PjRtClient>> GetStreamExecutorGpuClient(
       LocalClient * xla_client,
       GetGpuXlaClient(options.platform_name, options.allowed_devices));
   std::map<int, std::unique_ptr<LocalDeviceState>> local_device_states;
-  TF_ASSIGN_OR_RETURN(local_device_states, BuildLocalDeviceStates(xla_client));
+  TF_ASSIGN_OR_RETURN(
+      local_device_states,
+      BuildLocalDeviceStates(xla_client, options.num_shared_worker_threads,
+                             options.max_inflight_computations_per_device,
+                             options.stream_options));
   EnablePeerAccess(xla_client->backend().stream_executors());
   TF_ASSIGN_OR_RETURN(auto allocator,
                       GetStreamExecutorGpuDeviceAllocator(
@@ -25,11 +25,13 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xla/client/local_client.h"
@@ -256,9 +258,46 @@ class StreamExecutorGpuClient : public xla::PjRtStreamExecutorClient {
   absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>> Compile(
       const XlaComputation& computation, CompileOptions options) override;
 
+  // A device buffer exported for use by other processes on the same host.
+  // `handle` is an opaque string that can be passed to
+  // ImportBufferFromIpcHandle in another process. The exported memory stays
+  // valid for as long as `external_reference` is alive; the exporting process
+  // must keep it until every importer has dropped its buffer.
+  struct IpcBufferExport {
+    std::string handle;
+    std::unique_ptr<PjRtBuffer::ExternalReference> external_reference;
+  };
+
+  // Exports the device memory of a dense array `buffer` as a CUDA IPC handle.
+  // The caller is responsible for ordering any writes to the buffer before
+  // reads in the importing process, e.g. by awaiting GetReadyFuture() before
+  // sending the handle.
+  absl::StatusOr<IpcBufferExport> ExportBufferIpcHandle(PjRtBuffer* buffer);
+
+  // Opens a handle produced by ExportBufferIpcHandle in another process and
+  // returns a buffer on `device` that aliases the exported memory. Like
+  // buffers created by CreateViewOfDeviceBuffer, the returned buffer does not
+  // own its memory; the mapping is closed when the buffer is deleted. `device`
+  // must be the same physical GPU as the exporting device.
+  absl::StatusOr<std::unique_ptr<PjRtBuffer>> ImportBufferFromIpcHandle(
+      absl::string_view handle, const Shape& shape, PjRtDevice* device);
+
  private:
+  // An IPC allocation opened by ImportBufferFromIpcHandle. CUDA only allows an
+  // allocation to be opened once per process, so buffers aliasing the same
+  // exported allocation share one mapping.
+  struct IpcMapping {
+    void* base = nullptr;
+    int num_imports = 0;
+  };
+
   xla::StreamExecutorGpuTopologyDescription topology_;
   std::shared_ptr<KeyValueStoreInterface> kv_store_;
+
+  absl::Mutex ipc_mu_;
+  // Keyed by the device ordinal and the CUDA IPC handle of the allocation.
+  absl::flat_hash_map<std::string, IpcMapping> ipc_mappings_
+      ABSL_GUARDED_BY(ipc_mu_);
 };
 
 std::vector<std::unique_ptr<PjRtStreamExecutorDevice>> BuildLocalDevices(
@@ -290,6 +329,21 @@ struct GpuClientOptions {
 
   bool should_stage_host_to_device_transfers = true;
 
+  // If positive, the execute and callback worker threads of all local devices
+  // share a thread pool of this size instead of each running on a dedicated
+  // thread. Must be larger than the number of local devices.
+  int num_shared_worker_threads = 0;
+
+  // The number of computations that may be enqueued on a device before
+  // Execute blocks. Use PjRtStreamExecutorDevice::WaitForExecuteCapacity to
+  // wait for capacity without blocking.
+  int max_inflight_computations_per_device = 32;
+
+  // Options for the streams of every local device, e.g., the number of
+  // host-to-device streams that large transfers are striped across. If unset,
+  // LocalDeviceState picks its default streams.
+  std::optional<LocalDeviceState::StreamOptions> stream_options = std::nullopt;
+
   // kv_store must be non-null if num_nodes > 1.
   std::shared_ptr<KeyValueStoreInterface> kv_store = nullptr;
 
@@ -61,6 +61,7 @@ limitations under the License.
 #include "xla/stream_executor/stream.h"
 #include "xla/test.h"
 #include "xla/tests/literal_test_util.h"
+#include "xla/tsl/framework/allocator.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "xla/types.h"
 #include "xla/util.h"
@@ -161,6 +162,27 @@ TEST(StreamExecutorGpuClientTest, MemorySpace) {
   }
 }
 
+TEST(StreamExecutorGpuClientTest, WaitForExecuteCapacity) {
+  GpuClientOptions options;
+  options.max_inflight_computations_per_device = 1;
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetStreamExecutorGpuClient(options));
+
+  for (auto* device : client->addressable_devices()) {
+    auto* se_device = tensorflow::down_cast<PjRtStreamExecutorDevice*>(device);
+    TF_ASSERT_OK_AND_ASSIGN(LocalDeviceState * device_state,
+                            se_device->GetLocalDeviceState());
+    EXPECT_EQ(device_state->compute_semaphore().capacity(), 1);
+    TF_EXPECT_OK(se_device->WaitForExecuteCapacity().Await());
+
+    // While the only slot is taken, the future stays pending.
+    auto reservation = device_state->compute_semaphore().ScopedAcquire(1);
+    PjRtFuture<> capacity = se_device->WaitForExecuteCapacity();
+    EXPECT_FALSE(capacity.IsReady());
+    { auto released = std::move(reservation); }
+    TF_EXPECT_OK(capacity.Await());
+  }
+}
+
 TEST(StreamExecutorGpuClientTest, PropagateError) {
   TF_ASSERT_OK_AND_ASSIGN(auto client,
                           GetStreamExecutorGpuClient(GpuClientOptions()));
@@ -725,6 +747,134 @@ TEST(StreamExecutorGpuClientTest, DeleteBufferThenFulfillBufferNoDeadLock) {
   }
 }
 
+TEST(StreamExecutorGpuClientTest, CreateSliceView) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client,
+                          GetStreamExecutorGpuClient(GpuClientOptions()));
+  auto literal = xla::LiteralUtil::CreateR2<float>(
+      {{1.0f, 2.0f}, {3.0f, 4.0f}, {5.0f, 6.0f}, {7.0f, 8.0f}});
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> buffer,
+      client->BufferFromHostLiteral(literal, client->addressable_devices()[0]));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtBuffer> view,
+                          buffer->CreateSliceView(/*start=*/1, /*limit=*/3));
+  EXPECT_EQ(view->on_device_shape().dimensions(0), 2);
+  EXPECT_EQ(view->GetOnDeviceSizeInBytes().value(), 4 * sizeof(float));
+
+  // Deleting the parent does not free the memory the view aliases.
+  buffer->Delete();
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> sliced,
+                          view->ToLiteralSync());
+  EXPECT_EQ(*sliced, xla::LiteralUtil::CreateR2<float>(
+                         {{3.0f, 4.0f}, {5.0f, 6.0f}}));
+
+  EXPECT_FALSE(view->CreateSliceView(/*start=*/1, /*limit=*/3).ok());
+}
+
+TEST(StreamExecutorGpuClientTest, StripedCopyToDevice) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client,
+                          GetStreamExecutorGpuClient(GpuClientOptions()));
+  if (client->addressable_devices().size() < 2) {
+    GTEST_SKIP() << "Test requires at least two GPUs.";
+  }
+
+  // Large enough to be striped across all device-to-device streams, with a
+  // shorter last chunk.
+  std::vector<float> data((int64_t{32} << 20) / sizeof(float) + 17);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<float>(i % 4096);
+  }
+  auto literal = LiteralUtil::CreateR1<float>(data);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> buffer,
+      client->BufferFromHostLiteral(literal, client->addressable_devices()[0]));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> copy,
+      buffer->CopyToDevice(client->addressable_devices()[1]));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> result,
+                          copy->ToLiteralSync());
+  EXPECT_EQ(*result, literal);
+}
+
+TEST(StreamExecutorGpuClientTest, StripedHostToDeviceTransfer) {
+  GpuClientOptions options;
+  options.stream_options.emplace();
+  options.stream_options->num_host_to_device_streams = 4;
+  options.stream_options->host_to_device_stripe_bytes = 4096;
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetStreamExecutorGpuClient(options));
+
+  // Split into four chunks, the last one shorter.
+  std::vector<float> data(3 * 4096 + 17);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<float>(i);
+  }
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> buffer,
+      client->BufferFromHostBuffer(
+          data.data(), F32, {static_cast<int64_t>(data.size())},
+          /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableUntilTransferCompletes,
+          /*on_done_with_host_buffer=*/nullptr,
+          client->addressable_devices()[0]));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> result,
+                          buffer->ToLiteralSync());
+  EXPECT_EQ(*result, LiteralUtil::CreateR1<float>(data));
+}
+
+TEST(StreamExecutorGpuClientTest, ExportBufferIpcHandle) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client,
+                          GetStreamExecutorGpuClient(GpuClientOptions()));
+  auto* gpu_client =
+      tensorflow::down_cast<StreamExecutorGpuClient*>(client.get());
+  auto literal = xla::LiteralUtil::CreateR1<float>({1.0f, 2.0f, 3.0f});
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> buffer,
+      client->BufferFromHostLiteral(literal, client->addressable_devices()[0]));
+  TF_ASSERT_OK(buffer->GetReadyFuture().Await());
+
+  TF_ASSERT_OK_AND_ASSIGN(auto exported,
+                          gpu_client->ExportBufferIpcHandle(buffer.get()));
+  EXPECT_FALSE(exported.handle.empty());
+  EXPECT_NE(exported.external_reference->OpaqueDeviceMemoryDataPointer(),
+            nullptr);
+
+  // CUDA does not allow opening a handle in the process that exported it, so
+  // only check that malformed handles are rejected.
+  EXPECT_THAT(gpu_client->ImportBufferFromIpcHandle(
+                  exported.handle.substr(1), literal.shape(),
+                  client->addressable_devices()[0]),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(gpu_client->ImportBufferFromIpcHandle(
+                  exported.handle, ShapeUtil::MakeShape(F32, {1024}),
+                  client->addressable_devices()[0]),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(StreamExecutorGpuClientTest, CreateSliceViewRejectsDonation) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client,
+                          GetStreamExecutorGpuClient(GpuClientOptions()));
+  auto literal = xla::LiteralUtil::CreateR2<float>(
+      {{1.0f, 2.0f}, {3.0f, 4.0f}, {5.0f, 6.0f}, {7.0f, 8.0f}});
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> buffer,
+      client->BufferFromHostLiteral(literal, client->addressable_devices()[0]));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtBuffer> view,
+                          buffer->CreateSliceView(/*start=*/1, /*limit=*/3));
+
+  PjRtFuture<> ready(absl::OkStatus());
+  EXPECT_THAT(view->DonateWithControlDependency(ready).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_FALSE(view->IsDeleted());
+
+  // The parent can't be donated while the view is alive, but can afterwards.
+  EXPECT_THAT(buffer->DonateWithControlDependency(ready).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  view.reset();
+  TF_EXPECT_OK(buffer->DonateWithControlDependency(ready).status());
+}
+
 TEST(StreamExecutorGpuClientTest, CopyRawToHostFullBuffer) {
   TF_ASSERT_OK_AND_ASSIGN(auto client,
                           GetStreamExecutorGpuClient(GpuClientOptions()));
@@ -778,6 +928,46 @@ TEST(StreamExecutorGpuClientTest, CopyRawToHostOutOfRange) {
   free(dst);
 }
 
+TEST(StreamExecutorGpuClientTest, CopyRawToHostChunked) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client,
+                          GetStreamExecutorGpuClient(GpuClientOptions()));
+  std::vector<float> data(1000);
+  std::iota(data.begin(), data.end(), 0.0f);
+  auto literal = xla::LiteralUtil::CreateR1<float>(data);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> buffer,
+      client->BufferFromHostLiteral(literal, client->addressable_devices()[0]));
+
+  // Four chunks, the last of them shorter, through two staging chunks.
+  std::string received;
+  std::vector<int64_t> offsets;
+  TF_EXPECT_OK(buffer
+                   ->CopyRawToHostChunked(
+                       /*chunk_size=*/1024, /*num_staging_chunks=*/2,
+                       [&](int64_t offset, absl::Span<const char> chunk) {
+                         offsets.push_back(offset);
+                         received.append(chunk.data(), chunk.size());
+                         return PjRtFuture<>(absl::OkStatus());
+                       })
+                   .Await());
+  EXPECT_THAT(offsets, ElementsAre(0, 1024, 2048, 3072));
+  ASSERT_EQ(received.size(), data.size() * sizeof(float));
+  EXPECT_EQ(std::memcmp(received.data(), data.data(), received.size()), 0);
+
+  // An error from the consumer aborts the copy.
+  int num_chunks = 0;
+  EXPECT_THAT(buffer
+                  ->CopyRawToHostChunked(
+                      /*chunk_size=*/1024, /*num_staging_chunks=*/1,
+                      [&](int64_t offset, absl::Span<const char> chunk) {
+                        ++num_chunks;
+                        return PjRtFuture<>(absl::InternalError("disk full"));
+                      })
+                  .Await(),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_EQ(num_chunks, 1);
+}
+
 TEST(StreamExecutorGpuClientTest, CopyRawToHostFuture) {
   TF_ASSERT_OK_AND_ASSIGN(auto client,
                           GetStreamExecutorGpuClient(GpuClientOptions()));
@@ -962,6 +1152,9 @@ TEST(StreamExecutorGpuClientTest, GetAllocatorStatsTest) {
     auto stats = device->GetAllocatorStats();
     TF_ASSERT_OK(stats.status());
     ASSERT_GT(stats.value().peak_bytes_in_use, 0);
+    EXPECT_GT(stats.value().largest_free_block_bytes, 0);
+    EXPECT_TRUE(stats.value().fragmentation.has_value());
+    EXPECT_EQ(stats.value().num_alloc_retries, 0);
   }
 }
 
@@ -1085,6 +1278,147 @@ TEST(StreamExecutorGpuClientTest, MockNcclClientWithGpuTopologyMismatchTest) {
   EXPECT_FALSE(GetStreamExecutorGpuClient(options).ok());
 }
 
+TEST(StreamExecutorGpuClientTest, BufferFromHostBufferStagedInChunks) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client,
+                          GetStreamExecutorGpuClient(GpuClientOptions()));
+
+  // Large enough to be staged through several pinned staging chunks.
+  std::vector<int32_t> data(10 * 1024 * 1024 + 7);
+  std::iota(data.begin(), data.end(), 0);
+  Shape shape =
+      ShapeUtil::MakeShape(S32, {static_cast<int64_t>(data.size())});
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), shape.element_type(), shape.dimensions(),
+          /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableUntilTransferCompletes,
+          /*on_done_with_host_buffer=*/nullptr,
+          client->addressable_devices()[0]));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, buffer->ToLiteralSync());
+  EXPECT_TRUE(
+      LiteralTestUtil::Equal(LiteralUtil::CreateR1<int32_t>(data), *literal));
+}
+
+TEST(StreamExecutorGpuClientTest, RelocateBuffer) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client,
+                          GetStreamExecutorGpuClient(GpuClientOptions()));
+  std::vector<int32_t> data{1, 2, 3, 4};
+  Shape shape = ShapeUtil::MakeShape(S32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), shape.element_type(), shape.dimensions(),
+          /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall,
+          /*on_done_with_host_buffer=*/nullptr,
+          client->addressable_devices()[0]));
+  TF_ASSERT_OK(buffer->GetReadyFuture().Await());
+
+  auto* se_buffer = tensorflow::down_cast<PjRtStreamExecutorBuffer*>(
+      buffer.get());
+  TF_ASSERT_OK_AND_ASSIGN(auto old_ptr,
+                          client->UnsafeBufferPointer(buffer.get()));
+  TF_ASSERT_OK(se_buffer->Relocate());
+  TF_ASSERT_OK_AND_ASSIGN(auto new_ptr,
+                          client->UnsafeBufferPointer(buffer.get()));
+  EXPECT_NE(old_ptr, new_ptr);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, buffer->ToLiteralSync());
+  EXPECT_TRUE(
+      LiteralTestUtil::Equal(LiteralUtil::CreateR1<int32_t>(data), *literal));
+
+  // Buffers pinned by an external reference can't move.
+  TF_ASSERT_OK_AND_ASSIGN(auto external_reference,
+                          buffer->AcquireExternalReference());
+  EXPECT_EQ(se_buffer->Relocate().code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST(StreamExecutorGpuClientTest, BuffersToLiterals) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client,
+                          GetStreamExecutorGpuClient(GpuClientOptions()));
+  auto* se_client =
+      tensorflow::down_cast<PjRtStreamExecutorClient*>(client.get());
+
+  std::vector<Literal> src_literals;
+  for (int i = 0; i < 32; ++i) {
+    src_literals.push_back(LiteralUtil::CreateR0<float>(i));
+  }
+  src_literals.push_back(LiteralUtil::CreateR1<int32_t>({1, 2, 3, 4, 5}));
+  src_literals.push_back(LiteralUtil::MakeTupleOwned(
+      LiteralUtil::CreateR0<int32_t>(7), LiteralUtil::CreateR0<float>(8)));
+
+  std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+  std::vector<PjRtBuffer*> buffer_ptrs;
+  std::vector<Literal> literals;
+  std::vector<MutableLiteralBase*> literal_ptrs;
+  for (const Literal& src_literal : src_literals) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto buffer,
+        client->BufferFromHostLiteral(src_literal,
+                                      client->addressable_devices()[0]));
+    literals.emplace_back(
+        ShapeUtil::DeviceShapeToHostShape(buffer->on_device_shape()));
+    buffer_ptrs.push_back(buffer.get());
+    buffers.push_back(std::move(buffer));
+  }
+  for (Literal& literal : literals) literal_ptrs.push_back(&literal);
+
+  TF_ASSERT_OK(se_client->BuffersToLiterals(buffer_ptrs, literal_ptrs).Await());
+  for (int i = 0; i < src_literals.size(); ++i) {
+    EXPECT_TRUE(LiteralTestUtil::Equal(src_literals[i], literals[i]));
+  }
+
+  EXPECT_EQ(se_client->BuffersToLiterals(buffer_ptrs, {}).Await().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(StreamExecutorGpuClientTest, PackedBuffersFromHostLiterals) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client,
+                          GetStreamExecutorGpuClient(GpuClientOptions()));
+  auto* se_client =
+      tensorflow::down_cast<PjRtStreamExecutorClient*>(client.get());
+
+  std::vector<Literal> src_literals;
+  for (int i = 0; i < 16; ++i) {
+    src_literals.push_back(LiteralUtil::CreateR0<int32_t>(i));
+  }
+  src_literals.push_back(LiteralUtil::CreateR1<float>({1.0f, 2.0f, 3.0f}));
+  src_literals.push_back(LiteralUtil::CreateR2WithLayout<int32_t>(
+      {{1, 2, 3}, {4, 5, 6}},
+      ShapeUtil::MakeShapeWithDenseLayout(S32, {2, 3}, {0, 1}).layout()));
+  std::vector<LiteralSlice> slices(src_literals.begin(), src_literals.end());
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffers, se_client->PackedBuffersFromHostLiterals(
+                        slices, client->addressable_devices()[0]));
+  ASSERT_EQ(buffers.size(), src_literals.size());
+
+  TF_ASSERT_OK_AND_ASSIGN(auto first_ptr,
+                          client->UnsafeBufferPointer(buffers[0].get()));
+  TF_ASSERT_OK_AND_ASSIGN(auto second_ptr,
+                          client->UnsafeBufferPointer(buffers[1].get()));
+  EXPECT_EQ(second_ptr - first_ptr, tsl::Allocator::kAllocatorAlignment);
+
+  // The remaining buffers keep the shared allocation alive.
+  buffers[0].reset();
+  for (int i = 1; i < buffers.size(); ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(auto literal, buffers[i]->ToLiteralSync());
+    EXPECT_TRUE(LiteralTestUtil::Equal(src_literals[i], *literal));
+  }
+
+  Literal tuple = LiteralUtil::MakeTupleOwned(LiteralUtil::CreateR0<float>(1));
+  EXPECT_EQ(se_client
+                ->PackedBuffersFromHostLiterals(
+                    {LiteralSlice(tuple)}, client->addressable_devices()[0])
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 TEST(StreamExecutorGpuClientTest, BufferFromHostBufferPinnedMemory) {
   TF_ASSERT_OK_AND_ASSIGN(auto client,
                           GetStreamExecutorGpuClient(GpuClientOptions()));
@@ -71,21 +71,25 @@ absl::Status HostCallbackContext::OnSend(int arg_num,
   // supposed to be invoked sequentially.
   ready_count_.store(args_.size());
 
+  if (batch_ != nullptr) {
+    // The batch takes ownership of the arguments of this invocation, so the
+    // next one can start filling `args_` again.
+    std::vector<PjRtChunk> args(args_.size());
+    args.swap(args_);
+    return batch_->Submit(batch_index_, this, std::move(args));
+  }
+
   std::vector<void*> arg_ptrs;
   arg_ptrs.reserve(args_.size());
   for (auto& arg : args_) {
     arg_ptrs.push_back(arg.data());
   }
 
-  std::vector<PjRtChunk> results;
+  std::vector<PjRtChunk> results = AllocateResults();
   std::vector<void*> result_ptrs;
-  results.reserve(result_channels_.size());
-  result_ptrs.reserve(result_channels_.size());
-  for (int i = 0; i < result_channels_.size(); ++i) {
-    const auto& host_shape = host_callback_.results.at(i).shape;
-    size_t host_size = ShapeUtil::ByteSizeOf(host_shape);
-    results.push_back(PjRtChunk::AllocateDefault(host_size));
-    result_ptrs.push_back(results.back().data());
+  result_ptrs.reserve(results.size());
+  for (auto& result : results) {
+    result_ptrs.push_back(result.data());
   }
 
   EnterHostCallback();
@@ -102,10 +106,82 @@ absl::Status HostCallbackContext::OnSend(int arg_num,
 
   // Sending the results to recv callbacks if there is any. Note that after
   // this point, this callback can be invoked again (e.g. in a loop) anytime.
+  PushResults(std::move(results));
+
+  return status;
+}
+
+std::vector<PjRtChunk> HostCallbackContext::AllocateResults() const {
+  std::vector<PjRtChunk> results;
+  results.reserve(result_channels_.size());
+  for (int i = 0; i < result_channels_.size(); ++i) {
+    const auto& host_shape = host_callback_.results.at(i).shape;
+    size_t host_size = ShapeUtil::ByteSizeOf(host_shape);
+    results.push_back(PjRtChunk::AllocateDefault(host_size));
+  }
+  return results;
+}
+
+void HostCallbackContext::PushResults(std::vector<PjRtChunk> results) {
   for (int i = 0; i < result_channels_.size(); ++i) {
     auto& result_channel = result_channels_[i];
     result_channel->Push(std::move(results[i]));
   }
+}
+
+absl::Status HostCallbackBatch::Submit(int device, HostCallbackContext* context,
+                                       std::vector<PjRtChunk> args) {
+  absl::MutexLock lock(&mu_);
+  int64_t step_id = next_step_.at(device)++;
+  auto it = steps_.try_emplace(step_id, num_devices_).first;
+  Step& step = it->second;
+  DCHECK(step.pending.at(device).context == nullptr);
+  step.pending.at(device) = Pending{context, std::move(args)};
+  if (++step.num_arrived != num_devices_) {
+    return absl::OkStatus();
+  }
+
+  // Every step completes after the previous one, as each device submits its
+  // steps in order.
+  std::vector<Pending> batch = std::move(step.pending);
+  steps_.erase(it);
+
+  std::vector<std::vector<PjRtChunk>> results;
+  std::vector<std::vector<void*>> arg_ptrs;
+  std::vector<std::vector<void*>> result_ptrs;
+  results.reserve(batch.size());
+  arg_ptrs.reserve(batch.size());
+  result_ptrs.reserve(batch.size());
+  for (Pending& pending : batch) {
+    auto& device_args = arg_ptrs.emplace_back();
+    for (auto& arg : pending.args) {
+      device_args.push_back(arg.data());
+    }
+    auto& device_results = results.emplace_back(
+        pending.context->AllocateResults());
+    auto& device_result_ptrs = result_ptrs.emplace_back();
+    for (auto& result : device_results) {
+      device_result_ptrs.push_back(result.data());
+    }
+  }
+
+  std::vector<void**> batched_args;
+  std::vector<void**> batched_results;
+  batched_args.reserve(batch.size());
+  batched_results.reserve(batch.size());
+  for (int i = 0; i < batch.size(); ++i) {
+    batched_args.push_back(arg_ptrs[i].data());
+    batched_results.push_back(result_ptrs[i].data());
+  }
+
+  EnterHostCallback();
+  auto status = context->host_callback().batched_callback(batched_results,
+                                                          batched_args);
+  LeaveHostCallback();
+
+  for (int i = 0; i < batch.size(); ++i) {
+    batch[i].context->PushResults(std::move(results[i]));
+  }
 
   return status;
 }
@@ -140,10 +216,11 @@ CreateHostCallbackStateAndAppendSendRecvCallbacks(
     PjRtHostMemoryForDeviceManager* host_memory_for_device_manager,
     std::vector<SendCallback>& send_callbacks,
     std::vector<RecvCallback>& recv_callbacks,
-    bool use_major_to_minor_data_layout_for_callbacks) {
+    bool use_major_to_minor_data_layout_for_callbacks,
+    std::shared_ptr<HostCallbackBatch> batch, int batch_index) {
   auto context = std::make_unique<HostCallbackContext>(
       std::move(host_callback), use_major_to_minor_data_layout_for_callbacks,
-      host_memory_for_device_manager);
+      host_memory_for_device_manager, std::move(batch), batch_index);
 
   const auto& hb = context->host_callback();
   for (int arg_num = 0; arg_num < hb.operands.size(); ++arg_num) {
@@ -25,9 +25,11 @@ limitations under the License.
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_executable.h"
 #include "xla/pjrt/pjrt_future.h"
@@ -104,6 +106,57 @@ struct HostCallback {
   // callback can also return error status to indicate the entire execution
   // should fail.
   std::function<absl::Status(void**, void**)> callback;
+
+  // Optional batched variant of `callback`. If set and the host callback runs
+  // on several devices of one execution, it is invoked once per step after the
+  // operands of all devices have arrived, instead of invoking `callback` once
+  // per device. The i-th element of the two spans holds the result and operand
+  // pointer arrays of the i-th device, laid out like those of `callback`.
+  std::function<absl::Status(absl::Span<void** const>,
+                             absl::Span<void** const>)>
+      batched_callback;
+};
+
+class HostCallbackContext;
+
+// Coalesces the invocations of a host callback across the devices of one
+// execution. Every device hands over its operands once they have all been
+// sent; the last device to arrive invokes `batched_callback` for the whole
+// batch and forwards each device its results. Earlier devices return from
+// their send right away, so an error returned by the callback is only
+// reported through the send of the last device.
+//
+// Invocations are matched across devices by step: the n-th submission of
+// every device belongs to the n-th batch, so a device that runs ahead (e.g. in
+// a loop) doesn't mix its operands into the batch of the previous step.
+class HostCallbackBatch {
+ public:
+  explicit HostCallbackBatch(int num_devices)
+      : num_devices_(num_devices), next_step_(num_devices, 0) {}
+
+  absl::Status Submit(int device, HostCallbackContext* context,
+                      std::vector<PjRtChunk> args);
+
+ private:
+  struct Pending {
+    HostCallbackContext* context = nullptr;
+    std::vector<PjRtChunk> args;
+  };
+
+  // Operands of one step of all devices.
+  struct Step {
+    explicit Step(int num_devices) : pending(num_devices) {}
+    std::vector<Pending> pending;
+    int num_arrived = 0;
+  };
+
+  const int num_devices_;
+
+  // Held while the batch is invoked, so that the results of consecutive steps
+  // (e.g. in a loop) are delivered in order.
+  absl::Mutex mu_;
+  std::vector<int64_t> next_step_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<int64_t, Step> steps_ ABSL_GUARDED_BY(mu_);
 };
 
 // A helper class that maintains the send/recv states for a host callback.
@@ -112,11 +165,14 @@ class HostCallbackContext {
   HostCallbackContext(
       HostCallback host_callback,
       bool use_major_to_minor_data_layout_for_callbacks,
-      PjRtHostMemoryForDeviceManager* host_memory_for_device_manager)
+      PjRtHostMemoryForDeviceManager* host_memory_for_device_manager,
+      std::shared_ptr<HostCallbackBatch> batch = nullptr, int batch_index = 0)
       : host_callback_(std::move(host_callback)),
         use_major_to_minor_data_layout_for_callbacks_(
             use_major_to_minor_data_layout_for_callbacks),
         host_memory_for_device_manager_(host_memory_for_device_manager),
+        batch_(std::move(batch)),
+        batch_index_(batch_index),
         args_(host_callback_.operands.size()),
         result_channels_(host_callback_.results.size()),
         ready_count_(args_.size()) {
@@ -137,9 +193,20 @@ class HostCallbackContext {
   const HostCallback& host_callback() const { return host_callback_; }
 
  private:
+  friend class HostCallbackBatch;
+
+  // Allocates host buffers for the results of one invocation.
+  std::vector<PjRtChunk> AllocateResults() const;
+
+  // Hands the results of one invocation to the recv callbacks.
+  void PushResults(std::vector<PjRtChunk> results);
+
   HostCallback host_callback_;
   bool use_major_to_minor_data_layout_for_callbacks_;
   PjRtHostMemoryForDeviceManager* host_memory_for_device_manager_ = nullptr;
+  // Set if invocations are coalesced with those of other devices.
+  std::shared_ptr<HostCallbackBatch> batch_;
+  int batch_index_;
   std::vector<PjRtChunk> args_;
   std::vector<std::unique_ptr<ThreadSafePjRtChunkQueue>> result_channels_;
   std::atomic<int> ready_count_;
@@ -162,13 +229,17 @@ struct HostCallbackStates {
 // the corresponding ExecuteOptions; see the comment there for more
 // info. `host_memory_for_device_manager` may be nullptr if
 // `use_major_to_minor_data_layout_for_callbacks` is true.
+//
+// If `batch` is set, the replica takes the `batch_index`-th slot of it and the
+// host callback is invoked through `batched_callback`.
 std::unique_ptr<HostCallbackContext>
 CreateHostCallbackStateAndAppendSendRecvCallbacks(
     HostCallback host_callback,
     PjRtHostMemoryForDeviceManager* host_memory_for_device_manager,
     std::vector<SendCallback>& send_callbacks,
     std::vector<RecvCallback>& recv_callbacks,
-    bool use_major_to_minor_data_layout_for_callbacks);
+    bool use_major_to_minor_data_layout_for_callbacks,
+    std::shared_ptr<HostCallbackBatch> batch = nullptr, int batch_index = 0);
 
 }  // namespace xla
 
@@ -18,9 +18,11 @@ limitations under the License.
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/tests/literal_test_util.h"
 #include "xla/tsl/lib/core/status_test_util.h"
@@ -170,5 +172,127 @@ TEST(HostCallbackTest, NonBlockingRecv) {
   EXPECT_TRUE(LiteralTestUtil::Equal(literal, borrowing_literal));
 }
 
+TEST(HostCallbackTest, BatchedAcrossDevices) {
+  constexpr int kNumDevices = 2;
+
+  HostCallback host_callback;
+
+  Shape shape = ShapeUtil::MakeShape(F32, {2, 2});
+  size_t byte_size = ShapeUtil::ByteSizeOf(shape);
+
+  int num_invocations = 0;
+  host_callback.operands = {HostCallbackArgInfo{/*channel_id=*/1, shape}};
+  host_callback.results = {HostCallbackArgInfo{/*channel_id=*/2, shape}};
+  host_callback.batched_callback = [&](absl::Span<void** const> outputs,
+                                       absl::Span<void** const> inputs) {
+    ++num_invocations;
+    EXPECT_EQ(outputs.size(), kNumDevices);
+    EXPECT_EQ(inputs.size(), kNumDevices);
+    for (int i = 0; i < kNumDevices; ++i) {
+      std::memcpy(outputs[i][0], inputs[i][0], byte_size);
+    }
+    return absl::OkStatus();
+  };
+
+  HostCallbackStates states;
+  auto batch = std::make_shared<HostCallbackBatch>(kNumDevices);
+  TestPjRtHostMemoryForDeviceManager test_host_memory_for_device_manager;
+  std::vector<std::unique_ptr<HostCallbackContext>> contexts;
+  for (int i = 0; i < kNumDevices; ++i) {
+    auto& send_callbacks = states.send_callbacks.emplace_back();
+    auto& recv_callbacks = states.recv_callbacks.emplace_back();
+    contexts.push_back(CreateHostCallbackStateAndAppendSendRecvCallbacks(
+        host_callback, &test_host_memory_for_device_manager, send_callbacks,
+        recv_callbacks,
+        /*use_major_to_minor_data_layout_for_callbacks=*/false, batch,
+        /*batch_index=*/i));
+  }
+
+  PjRtTransferMetadata metadata;
+  metadata.device_shape = shape;
+
+  std::vector<Literal> literals;
+  literals.push_back(LiteralUtil::CreateR2({{1.0f, 2.0f}, {3.0f, 4.0f}}));
+  literals.push_back(LiteralUtil::CreateR2({{5.0f, 6.0f}, {7.0f, 8.0f}}));
+  for (int i = 0; i < kNumDevices; ++i) {
+    auto chunk = PjRtChunk::AllocateDefault(/*size=*/byte_size);
+    std::memcpy(chunk.data(), literals[i].untyped_data(),
+                literals[i].size_bytes());
+    TF_ASSERT_OK(
+        contexts[i]->OnSend(/*arg_num=*/0, metadata, std::move(chunk)));
+    // The callback only runs once the last device has sent its operands.
+    EXPECT_EQ(num_invocations, i == kNumDevices - 1 ? 1 : 0);
+  }
+
+  for (int i = 0; i < kNumDevices; ++i) {
+    PjRtChunk received_chunk;
+    absl::Notification done;
+    auto stream = std::make_unique<TestStream>(byte_size, /*granule_bytes=*/8,
+                                               received_chunk, done);
+    contexts[i]->Receive(/*res_num=*/0, metadata, std::move(stream));
+    done.WaitForNotification();
+
+    BorrowingLiteral borrowing_literal(
+        reinterpret_cast<const char*>(received_chunk.data()), shape);
+    EXPECT_TRUE(LiteralTestUtil::Equal(literals[i], borrowing_literal));
+  }
+}
+
+TEST(HostCallbackTest, BatchedDeviceRunsAhead) {
+  constexpr int kNumDevices = 2;
+
+  HostCallback host_callback;
+
+  Shape shape = ShapeUtil::MakeShape(F32, {});
+  size_t byte_size = ShapeUtil::ByteSizeOf(shape);
+
+  // Operands of every invocation, per device.
+  std::vector<std::vector<float>> invocations;
+  host_callback.operands = {HostCallbackArgInfo{/*channel_id=*/1, shape}};
+  host_callback.batched_callback = [&](absl::Span<void** const> outputs,
+                                       absl::Span<void** const> inputs) {
+    auto& invocation = invocations.emplace_back();
+    for (int i = 0; i < kNumDevices; ++i) {
+      invocation.push_back(*static_cast<float*>(inputs[i][0]));
+    }
+    return absl::OkStatus();
+  };
+
+  HostCallbackStates states;
+  auto batch = std::make_shared<HostCallbackBatch>(kNumDevices);
+  TestPjRtHostMemoryForDeviceManager test_host_memory_for_device_manager;
+  std::vector<std::unique_ptr<HostCallbackContext>> contexts;
+  for (int i = 0; i < kNumDevices; ++i) {
+    auto& send_callbacks = states.send_callbacks.emplace_back();
+    auto& recv_callbacks = states.recv_callbacks.emplace_back();
+    contexts.push_back(CreateHostCallbackStateAndAppendSendRecvCallbacks(
+        host_callback, &test_host_memory_for_device_manager, send_callbacks,
+        recv_callbacks,
+        /*use_major_to_minor_data_layout_for_callbacks=*/false, batch,
+        /*batch_index=*/i));
+  }
+
+  PjRtTransferMetadata metadata;
+  metadata.device_shape = shape;
+
+  auto send = [&](int device, float value) {
+    auto chunk = PjRtChunk::AllocateDefault(/*size=*/byte_size);
+    std::memcpy(chunk.data(), &value, byte_size);
+    return contexts[device]->OnSend(/*arg_num=*/0, metadata, std::move(chunk));
+  };
+
+  // Device 0 sends the operands of two steps before device 1 sends any.
+  TF_ASSERT_OK(send(0, 1.0f));
+  TF_ASSERT_OK(send(0, 2.0f));
+  EXPECT_TRUE(invocations.empty());
+
+  TF_ASSERT_OK(send(1, 10.0f));
+  TF_ASSERT_OK(send(1, 20.0f));
+
+  ASSERT_EQ(invocations.size(), 2);
+  EXPECT_EQ(invocations[0], (std::vector<float>{1.0f, 10.0f}));
+  EXPECT_EQ(invocations[1], (std::vector<float>{2.0f, 20.0f}));
+}
+
 }  // namespace
 }  // namespace xla
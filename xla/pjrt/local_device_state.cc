@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "xla/pjrt/local_device_state.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -26,6 +28,7 @@ limitations under the License.
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
 #include "absl/synchronization/mutex.h"
+#include "xla/stream_executor/device_memory.h"
 #include "xla/stream_executor/stream.h"
 #include "xla/tsl/protobuf/error_codes.pb.h"
 #include "xla/tsl/util/env_var.h"
@@ -33,6 +36,7 @@ limitations under the License.
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/profiler/lib/traceme.h"
 
 namespace xla {
@@ -43,7 +47,9 @@ LocalDeviceState::LocalDeviceState(se::StreamExecutor* executor,
                                    int max_inflight_computations,
                                    bool allow_event_reuse,
                                    bool use_callback_stream, int device_ordinal,
-                                   std::optional<StreamOptions> stream_options)
+                                   std::optional<StreamOptions> stream_options,
+                                   std::shared_ptr<tsl::thread::ThreadPool>
+                                       worker_thread_pool)
     : allocation_model_(allocation_model),
       event_pool_(allow_event_reuse),
       compute_semaphore_(
@@ -71,6 +77,16 @@ LocalDeviceState::LocalDeviceState(se::StreamExecutor* executor,
   local_device_id_ =
       device_ordinal != -1 ? device_ordinal : executor_->device_ordinal();
 
+  int num_host_to_device_streams =
+      stream_options.has_value() ? stream_options->num_host_to_device_streams
+                                 : kNumHostToDeviceStreams;
+  host_to_device_stripe_bytes_ =
+      stream_options.has_value() ? stream_options->host_to_device_stripe_bytes
+                                 : StreamOptions().host_to_device_stripe_bytes;
+  device_to_device_stripe_bytes_ =
+      stream_options.has_value()
+          ? stream_options->device_to_device_stripe_bytes
+          : StreamOptions().device_to_device_stripe_bytes;
   int num_device_to_host_streams =
       stream_options.has_value() ? stream_options->num_device_to_host_streams
                                  : kNumDeviceToHostStreams;
@@ -91,6 +107,10 @@ LocalDeviceState::LocalDeviceState(se::StreamExecutor* executor,
   };
   compute_stream_ = create_stream("Compute");
   host_to_device_stream_ = create_stream("Host-to-device");
+  for (int i = 1; i < num_host_to_device_streams; ++i) {
+    host_to_device_stripe_streams_.emplace_back(
+        create_stream(absl::StrFormat("Host-to-device #%d", i)));
+  }
   if (use_callback_stream) {
     callback_stream_map_ =
         absl::flat_hash_map<se::Stream*, std::unique_ptr<se::Stream>>();
@@ -115,10 +135,17 @@ LocalDeviceState::LocalDeviceState(se::StreamExecutor* executor,
     external_ready_event_streams_.emplace_back(
         create_stream(absl::StrFormat("External ready event #%d", i)));
   }
-  execute_thread_ =
-      std::make_unique<WorkerThread>(tsl::Env::Default(), "py_xla_execute");
-  callback_thread_ =
-      std::make_unique<WorkerThread>(tsl::Env::Default(), "py_xla_callback");
+  worker_thread_pool_ = std::move(worker_thread_pool);
+  if (worker_thread_pool_ != nullptr) {
+    execute_thread_ = std::make_unique<WorkerThread>(worker_thread_pool_.get());
+    callback_thread_ =
+        std::make_unique<WorkerThread>(worker_thread_pool_.get());
+  } else {
+    execute_thread_ =
+        std::make_unique<WorkerThread>(tsl::Env::Default(), "py_xla_execute");
+    callback_thread_ =
+        std::make_unique<WorkerThread>(tsl::Env::Default(), "py_xla_callback");
+  }
   cleanup_thread_ =
       std::make_unique<WorkerThread>(tsl::Env::Default(), "py_xla_cleanup");
 }
@@ -160,7 +187,100 @@ absl::Status LocalDeviceState::ThenMemcpyDeviceToDevice(
   // The default implementation simply calls MemcpyD2D, and assumes that
   // the buffer addresses identify the devices. This does not work
   // on all platforms; this method is virtual so it can be overridden.
-  return transfer_stream->MemcpyD2D(&dst_buffer, src_buffer, dst_buffer.size());
+  uint64_t size = dst_buffer.size();
+  int64_t num_chunks =
+      device_to_device_stripe_bytes_ <= 0
+          ? 1
+          : std::min<int64_t>(device_to_device_streams_.size(),
+                              static_cast<int64_t>(size) /
+                                  device_to_device_stripe_bytes_);
+  if (num_chunks <= 1) {
+    return transfer_stream->MemcpyD2D(&dst_buffer, src_buffer, size);
+  }
+
+  // Stripe over the other device-to-device streams; `transfer_stream` takes
+  // the first chunk.
+  std::vector<se::Stream*> stripe_streams;
+  for (const auto& stream : device_to_device_streams_) {
+    if (stripe_streams.size() + 1 == num_chunks) break;
+    if (stream.get() != transfer_stream) stripe_streams.push_back(stream.get());
+  }
+  num_chunks = 1 + stripe_streams.size();
+
+  constexpr uint64_t kChunkAlignment = 4096;
+  uint64_t chunk_size = RoundUpTo<uint64_t>(
+      CeilOfRatio<uint64_t>(size, num_chunks), kChunkAlignment);
+  num_chunks = CeilOfRatio<uint64_t>(size, chunk_size);
+
+  tsl::profiler::TraceMe traceme([&] {
+    return absl::StrFormat("ThenMemcpyDeviceToDevice:#size=%d,chunks=%d#",
+                           size, num_chunks);
+  });
+
+  for (int64_t i = 1; i < num_chunks; ++i) {
+    TF_RETURN_IF_ERROR(stripe_streams[i - 1]->WaitFor(transfer_stream));
+  }
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    se::Stream* chunk_stream = i == 0 ? transfer_stream : stripe_streams[i - 1];
+    uint64_t offset = i * chunk_size;
+    uint64_t chunk_bytes = std::min(chunk_size, size - offset);
+    se::DeviceMemoryBase dst_chunk =
+        dst_buffer.GetByteSlice(offset, chunk_bytes);
+    TF_RETURN_IF_ERROR(chunk_stream->MemcpyD2D(
+        &dst_chunk, src_buffer.GetByteSlice(offset, chunk_bytes),
+        chunk_bytes));
+  }
+  for (int64_t i = 1; i < num_chunks; ++i) {
+    TF_RETURN_IF_ERROR(transfer_stream->WaitFor(stripe_streams[i - 1]));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status LocalDeviceState::ThenMemcpyHostToDevice(
+    se::DeviceMemoryBase* dst, const void* src, uint64_t size) {
+  se::Stream* stream = host_to_device_stream_.get();
+
+  int64_t num_chunks = std::min<int64_t>(
+      1 + host_to_device_stripe_streams_.size(),
+      static_cast<int64_t>(size) / std::max<int64_t>(
+                                       host_to_device_stripe_bytes_, 1));
+  if (num_chunks <= 1) {
+    return stream->Memcpy(dst, src, size);
+  }
+
+  // Keep chunk boundaries page aligned.
+  constexpr uint64_t kChunkAlignment = 4096;
+  uint64_t chunk_size =
+      RoundUpTo<uint64_t>(CeilOfRatio<uint64_t>(size, num_chunks),
+                          kChunkAlignment);
+  num_chunks = CeilOfRatio<uint64_t>(size, chunk_size);
+
+  tsl::profiler::TraceMe traceme([&] {
+    return absl::StrFormat("ThenMemcpyHostToDevice:#size=%d,chunks=%d#", size,
+                           num_chunks);
+  });
+
+  // We must make all stripe streams wait for the primary stream before we
+  // enqueue the first chunk, otherwise the stripe streams would wait for it.
+  for (int64_t i = 1; i < num_chunks; ++i) {
+    TF_RETURN_IF_ERROR(host_to_device_stripe_streams_[i - 1]->WaitFor(stream));
+  }
+
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    se::Stream* chunk_stream =
+        i == 0 ? stream : host_to_device_stripe_streams_[i - 1].get();
+    uint64_t offset = i * chunk_size;
+    uint64_t chunk_bytes = std::min(chunk_size, size - offset);
+    se::DeviceMemoryBase chunk = dst->GetByteSlice(offset, chunk_bytes);
+    TF_RETURN_IF_ERROR(chunk_stream->Memcpy(
+        &chunk, static_cast<const char*>(src) + offset, chunk_bytes));
+  }
+
+  for (int64_t i = 1; i < num_chunks; ++i) {
+    TF_RETURN_IF_ERROR(
+        stream->WaitFor(host_to_device_stripe_streams_[i - 1].get()));
+  }
+  return absl::OkStatus();
 }
 
 absl::Status LocalDeviceState::ThenExecuteCallback(
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef XLA_PJRT_LOCAL_DEVICE_STATE_H_
 #define XLA_PJRT_LOCAL_DEVICE_STATE_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -30,8 +31,10 @@ limitations under the License.
 #include "xla/pjrt/pjrt_common.h"
 #include "xla/pjrt/semaphore.h"
 #include "xla/pjrt/worker_thread.h"
+#include "xla/stream_executor/device_memory.h"
 #include "xla/stream_executor/stream.h"
 #include "xla/stream_executor/stream_executor.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 
@@ -96,6 +99,15 @@ class LocalDeviceState {
     int priority = 0;
     int num_device_to_host_streams = 1;
     int num_device_to_device_streams = 1;
+    // Host-to-device transfers of at least `host_to_device_stripe_bytes` per
+    // stream are split into chunks and striped across all host-to-device
+    // streams (see ThenMemcpyHostToDevice).
+    int num_host_to_device_streams = 1;
+    int64_t host_to_device_stripe_bytes = int64_t{8} << 20;
+    // Device-to-device copies of at least `device_to_device_stripe_bytes` per
+    // stream are striped across the device-to-device streams (see
+    // ThenMemcpyDeviceToDevice). Zero disables striping.
+    int64_t device_to_device_stripe_bytes = int64_t{8} << 20;
   };
 
   // `device_ordinal` is the logical local device ordinal (returned by
@@ -105,11 +117,19 @@ class LocalDeviceState {
   // `local_hardware_id()`). In general, different PJRT devices have different
   // logical device ordinals, and several PJRT devices can have the same
   // physical device ordinal if they share the same physical device.
-  LocalDeviceState(se::StreamExecutor* executor, LocalClient* client,
-                   AllocationModel allocation_model,
-                   int max_inflight_computations, bool allow_event_reuse,
-                   bool use_callback_stream, int device_ordinal = -1,
-                   std::optional<StreamOptions> stream_options = std::nullopt);
+  //
+  // If `worker_thread_pool` is set, the execute and callback worker threads
+  // run on it instead of on dedicated threads. The pool can be shared by
+  // multiple devices, but it must have more threads than the number of devices
+  // sharing it, as closures on the execute thread may block until callbacks
+  // run.
+  LocalDeviceState(
+      se::StreamExecutor* executor, LocalClient* client,
+      AllocationModel allocation_model, int max_inflight_computations,
+      bool allow_event_reuse, bool use_callback_stream,
+      int device_ordinal = -1,
+      std::optional<StreamOptions> stream_options = std::nullopt,
+      std::shared_ptr<tsl::thread::ThreadPool> worker_thread_pool = nullptr);
   virtual ~LocalDeviceState();
 
   se::StreamExecutor* executor() const { return executor_; }
@@ -124,10 +144,22 @@ class LocalDeviceState {
   EventPool& event_pool() { return event_pool_; }
 
   se::Stream* compute_stream() const { return compute_stream_.get(); }
+  // Returns the primary host-to-device stream. Transfers striped across
+  // multiple host-to-device streams are joined back into this stream, so
+  // events recorded on it after a transfer is enqueued complete only after the
+  // whole transfer is done.
   se::Stream* host_to_device_stream() const {
     return host_to_device_stream_.get();
   }
 
+  // Enqueues a copy of `size` bytes from host memory at `src` to `dst`. Large
+  // copies are split into chunks across all host-to-device streams. All chunks
+  // are ordered after the work already enqueued on host_to_device_stream(), and
+  // host_to_device_stream() waits for all chunks, so the copy can be tracked as
+  // if it was enqueued on host_to_device_stream() alone.
+  absl::Status ThenMemcpyHostToDevice(se::DeviceMemoryBase* dst,
+                                      const void* src, uint64_t size);
+
   // Returns a device to host stream. Allocates streams in a round-robin fashion
   // amongst the available streams.
   se::Stream* GetDeviceToHostStream();
@@ -164,6 +196,9 @@ class LocalDeviceState {
   void ReturnStreamToPool(std::unique_ptr<se::Stream> stream);
 
   // Enqueues a copy of `src_buffer` to `dst_buffer` onto `transfer_stream`.
+  // Large copies are split into chunks across the device-to-device streams so
+  // that several copy engines work on them in parallel; `transfer_stream`
+  // waits for all chunks, so the copy can still be tracked on it alone.
   virtual absl::Status ThenMemcpyDeviceToDevice(
       se::Stream* transfer_stream, se::Stream* dst_stream,
       se::DeviceMemoryBase src_buffer, se::DeviceMemoryBase dst_buffer);
@@ -224,11 +259,16 @@ class LocalDeviceState {
   LocalClient* const client_;
   std::unique_ptr<se::Stream> compute_stream_;
   std::unique_ptr<se::Stream> host_to_device_stream_;
+  // Additional host-to-device streams used for striping large transfers.
+  std::vector<std::unique_ptr<se::Stream>> host_to_device_stripe_streams_;
+  int64_t host_to_device_stripe_bytes_;
+  int64_t device_to_device_stripe_bytes_;
   std::vector<std::unique_ptr<se::Stream>> device_to_host_streams_;
   std::vector<std::unique_ptr<se::Stream>> device_to_device_streams_;
   std::vector<std::unique_ptr<se::Stream>> fixed_size_pool_usage_streams_;
   std::vector<std::unique_ptr<se::Stream>> external_ready_event_streams_;
 
+  static constexpr int kNumHostToDeviceStreams = 1;
   static constexpr int kNumDeviceToHostStreams = 4;
   static constexpr int kNumDeviceToDeviceStreams = 4;
   static constexpr int kNumFixedSizePoolUsageStreams = 4;
@@ -255,6 +295,10 @@ class LocalDeviceState {
   std::optional<absl::flat_hash_map<se::Stream*, std::unique_ptr<se::Stream>>>
       callback_stream_map_;
 
+  // Thread pool backing the execute and callback threads if set. Declared
+  // before the worker threads, so it is destroyed after them.
+  std::shared_ptr<tsl::thread::ThreadPool> worker_thread_pool_;
+
   // A worker thread, used for replicated computation launches.
   std::unique_ptr<WorkerThread> execute_thread_;
 
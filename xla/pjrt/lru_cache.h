@@ -16,10 +16,17 @@ limitations under the License.
 #ifndef XLA_PJRT_LRU_CACHE_H_
 #define XLA_PJRT_LRU_CACHE_H_
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "tsl/platform/logging.h"
 
 namespace xla {
@@ -191,6 +198,115 @@ Value LRUCache<Key, Value, Hash, Eq>::GetOrCreateIfAbsent(
   return v;
 }
 
+// A thread-safe LRU cache that splits entries between multiple independently
+// locked shards to reduce lock contention between concurrent callers. Each
+// shard is an LRUCache with its own LRU list and a capacity of
+// `capacity / num_shards` (rounded up), which means that eviction order is
+// only approximately LRU across the whole cache.
+//
+// Value factory is called with a shard lock held, so it must not call back
+// into the cache.
+template <typename Key, typename Value,
+          typename Hash = typename absl::node_hash_map<Key, Value>::hasher,
+          typename Eq = typename absl::node_hash_map<Key, Value>::key_equal>
+class ShardedLRUCache {
+ public:
+  // We shard the cache only if each shard can hold at least this number of
+  // entries, as otherwise per-shard eviction will diverge too much from LRU.
+  static constexpr int kMinShardCapacity = 64;
+  static constexpr int kMaxNumShards = 16;
+
+  // Returns the default number of shards for a cache of a given capacity.
+  static int DefaultNumShards(int capacity) {
+    return std::clamp(capacity / kMinShardCapacity, 1, kMaxNumShards);
+  }
+
+  explicit ShardedLRUCache(int capacity)
+      : ShardedLRUCache(capacity, DefaultNumShards(capacity)) {}
+  ShardedLRUCache(int capacity, int num_shards);
+
+  ShardedLRUCache(const ShardedLRUCache&) = delete;
+  ShardedLRUCache(ShardedLRUCache&&) = delete;
+  ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+  ShardedLRUCache& operator=(ShardedLRUCache&&) = delete;
+
+  // Returns the `value` associated with `key`. Creates a value with `factory`
+  // and inserts it if absent.
+  Value GetOrCreateIfAbsent(const Key& key,
+                            const std::function<Value(const Key&)>& factory);
+
+  void Remove(const Key& key);
+
+  // Removes all entries from the cache.
+  void Clear();
+
+  int Size() const;
+  int Capacity() const { return capacity_; }
+  int NumShards() const { return shards_.size(); }
+
+ private:
+  struct Shard {
+    explicit Shard(int capacity) : lru_list(capacity), cache(&lru_list) {}
+
+    absl::Mutex mu;
+    typename LRUCache<Key, Value, Hash, Eq>::LRUList lru_list
+        ABSL_GUARDED_BY(mu);
+    LRUCache<Key, Value, Hash, Eq> cache ABSL_GUARDED_BY(mu);
+  };
+
+  Shard& GetShard(const Key& key) const {
+    return *shards_[Hash()(key) % shards_.size()];
+  }
+
+  int capacity_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+ShardedLRUCache<Key, Value, Hash, Eq>::ShardedLRUCache(int capacity,
+                                                        int num_shards)
+    : capacity_(capacity) {
+  CHECK_GT(num_shards, 0) << "Number of shards must be positive";
+  int shard_capacity = (capacity + num_shards - 1) / num_shards;
+  shards_.reserve(num_shards);
+  for (int i = 0; i < num_shards; ++i) {
+    shards_.push_back(std::make_unique<Shard>(shard_capacity));
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+Value ShardedLRUCache<Key, Value, Hash, Eq>::GetOrCreateIfAbsent(
+    const Key& key, const std::function<Value(const Key&)>& factory) {
+  Shard& shard = GetShard(key);
+  absl::MutexLock lock(&shard.mu);
+  return shard.cache.GetOrCreateIfAbsent(key, factory);
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+void ShardedLRUCache<Key, Value, Hash, Eq>::Remove(const Key& key) {
+  Shard& shard = GetShard(key);
+  absl::MutexLock lock(&shard.mu);
+  shard.cache.Remove(key);
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+void ShardedLRUCache<Key, Value, Hash, Eq>::Clear() {
+  for (auto& shard : shards_) {
+    absl::MutexLock lock(&shard->mu);
+    shard->cache.Clear();
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+int ShardedLRUCache<Key, Value, Hash, Eq>::Size() const {
+  int size = 0;
+  for (auto& shard : shards_) {
+    absl::MutexLock lock(&shard->mu);
+    size += shard->cache.Size();
+  }
+  return size;
+}
+
 }  // namespace xla
 
 #endif  // XLA_PJRT_LRU_CACHE_H_
@@ -15,9 +15,15 @@ limitations under the License.
 
 #include "xla/pjrt/lru_cache.h"
 
+#include <cstdint>
 #include <random>
+#include <vector>
 
+#include "absl/synchronization/mutex.h"
 #include "xla/test.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -115,5 +121,110 @@ TEST(LRUCache, RandomInsertions) {
   }
 }
 
+TEST(ShardedLRUCache, SingleShardIsLRU) {
+  ShardedLRUCache<int, int> cache(/*capacity=*/3, /*num_shards=*/1);
+  EXPECT_EQ(3, cache.Capacity());
+  EXPECT_EQ(1, cache.NumShards());
+  EXPECT_EQ(0, cache.Size());
+  EXPECT_EQ(0, cache.GetOrCreateIfAbsent(0, [](int) { return 0; }));
+  EXPECT_EQ(1, cache.GetOrCreateIfAbsent(1, [](int) { return 1; }));
+  EXPECT_EQ(2, cache.GetOrCreateIfAbsent(2, [](int) { return 2; }));
+  EXPECT_EQ(3, cache.Size());
+  EXPECT_EQ(0, cache.GetOrCreateIfAbsent(0, [](int) { return 3; }));
+  EXPECT_EQ(4, cache.GetOrCreateIfAbsent(3, [](int) { return 4; }));
+  EXPECT_EQ(3, cache.Size());
+  EXPECT_EQ(2, cache.GetOrCreateIfAbsent(2, [](int) { return 5; }));
+  EXPECT_EQ(6, cache.GetOrCreateIfAbsent(1, [](int) { return 6; }));
+  EXPECT_EQ(3, cache.Size());
+  cache.Remove(1);
+  EXPECT_EQ(2, cache.Size());
+  cache.Clear();
+  EXPECT_EQ(0, cache.Size());
+}
+
+TEST(ShardedLRUCache, DefaultNumShards) {
+  EXPECT_EQ(1, ShardedLRUCache<int, int>(2).NumShards());
+  EXPECT_EQ(1, ShardedLRUCache<int, int>(127).NumShards());
+  EXPECT_EQ(2, ShardedLRUCache<int, int>(128).NumShards());
+  EXPECT_EQ(16, ShardedLRUCache<int, int>(1024).NumShards());
+  EXPECT_EQ(16, ShardedLRUCache<int, int>(1 << 20).NumShards());
+}
+
+TEST(ShardedLRUCache, RandomInsertions) {
+  ShardedLRUCache<int, int> cache(/*capacity=*/16, /*num_shards=*/4);
+  std::random_device rng;
+  std::uniform_int_distribution<int> dist(0, 100);
+
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_LE(cache.Size(), cache.Capacity());
+    int key = dist(rng);
+    int v = cache.GetOrCreateIfAbsent(key, [&](int k_arg) {
+      CHECK_EQ(k_arg, key);
+      return k_arg * 37;
+    });
+    EXPECT_EQ(v, key * 37);
+  }
+}
+
+TEST(ShardedLRUCache, ConcurrentInsertions) {
+  ShardedLRUCache<int, int> cache(/*capacity=*/256);
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "sharded-lru-cache", 8);
+
+  for (int t = 0; t < 8; ++t) {
+    pool.Schedule([&cache, t] {
+      std::minstd_rand0 rng(t);
+      std::uniform_int_distribution<int> dist(0, 1000);
+      for (int i = 0; i < 1000; ++i) {
+        int key = dist(rng);
+        int v = cache.GetOrCreateIfAbsent(key, [](int k) { return k * 37; });
+        CHECK_EQ(v, key * 37);
+      }
+    });
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Performance benchmarks below
+//===----------------------------------------------------------------------===//
+
+// Benchmarks below measure lock contention between concurrent cache users
+// with a working set that fits into the cache.
+static constexpr int kBenchmarkCapacity = 1024;
+static constexpr int kBenchmarkNumKeys = 512;
+
+static void BM_MutexLRUCacheContention(benchmark::State& state) {
+  static auto* mu = new absl::Mutex();
+  static auto* list = new LRUCache<int64_t, int64_t>::LRUList(
+      kBenchmarkCapacity);
+  static auto* cache = new LRUCache<int64_t, int64_t>(list);
+
+  std::minstd_rand0 rng(state.thread_index());
+  std::uniform_int_distribution<int64_t> dist(0, kBenchmarkNumKeys - 1);
+
+  for (auto _ : state) {
+    int64_t key = dist(rng);
+    absl::MutexLock lock(mu);
+    benchmark::DoNotOptimize(
+        cache->GetOrCreateIfAbsent(key, [](int64_t k) { return k; }));
+  }
+}
+
+static void BM_ShardedLRUCacheContention(benchmark::State& state) {
+  static auto* cache =
+      new ShardedLRUCache<int64_t, int64_t>(kBenchmarkCapacity);
+
+  std::minstd_rand0 rng(state.thread_index());
+  std::uniform_int_distribution<int64_t> dist(0, kBenchmarkNumKeys - 1);
+
+  for (auto _ : state) {
+    int64_t key = dist(rng);
+    benchmark::DoNotOptimize(
+        cache->GetOrCreateIfAbsent(key, [](int64_t k) { return k; }));
+  }
+}
+
+BENCHMARK(BM_MutexLRUCacheContention)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_ShardedLRUCacheContention)->ThreadRange(1, 16)->UseRealTime();
+
 }  // namespace
 }  // namespace xla
@@ -16,9 +16,16 @@ limitations under the License.
 #include "xla/pjrt/metrics.h"
 
 #include <cstdint>
+#include <string>
 
+#include "absl/base/attributes.h"
+#include "absl/base/const_init.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "xla/tsl/lib/monitoring/counter.h"
 #include "xla/tsl/lib/monitoring/gauge.h"
+#include "xla/tsl/lib/monitoring/sampler.h"
 
 namespace xla {
 namespace {
@@ -41,6 +48,38 @@ auto* pjrt_compiler_is_compiling_module = tsl::monitoring::Gauge<bool, 0>::New(
     metrics::kPjrtCompilerCompileModuleMetricName,
     "Whether the PjRT compiler is compiling modules.");
 
+auto* pjrt_executable_enqueue_time_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/jax/pjrt/pjrt_executable_enqueue_time_usecs",
+     "The time from the start of an execute call until the execution is "
+     "enqueued on the device in microseconds.",
+     "fingerprint"},
+    // These exponential buckets cover the following range:
+    // Minimum: 1 us
+    // Maximum: 1 us * 2 ^ 30 == ~17.9 minutes
+    {tsl::monitoring::Buckets::Exponential(1, 2, 31)});
+
+auto* pjrt_executable_execution_time_usecs_histogram =
+    tsl::monitoring::Sampler<1>::New(
+        {"/jax/pjrt/pjrt_executable_execution_time_usecs_histogram",
+         "The time from the start of an execute call until the execution "
+         "finished on the device in microseconds.",
+         "fingerprint"},
+        {tsl::monitoring::Buckets::Exponential(1, 2, 31)});
+
+auto* pjrt_executable_executions_in_flight =
+    tsl::monitoring::Gauge<int64_t, 1>::New(
+        metrics::kPjrtExecutableExecutionsInFlightMetricName,
+        "The number of executions enqueued on the device but not yet "
+        "completed.",
+        "fingerprint");
+
+auto* pjrt_device_execute_queue_depth = tsl::monitoring::Gauge<int64_t, 1>::New(
+    metrics::kPjrtDeviceExecuteQueueDepthMetricName,
+    "The number of computations enqueued on a device but not yet completed.",
+    "device");
+
+ABSL_CONST_INIT absl::Mutex executions_in_flight_mu(absl::kConstInit);
+
 }  // namespace
 
 namespace metrics {
@@ -64,5 +103,42 @@ void RecordPjrtCompilerCompileModuleStatus(bool is_compiling) {
   pjrt_compiler_is_compiling_module->GetCell()->Set(is_compiling);
 }
 
+void RecordDeviceExecuteQueueDepth(int device_id, int64_t depth) {
+  pjrt_device_execute_queue_depth->GetCell(absl::StrCat(device_id))->Set(depth);
+}
+
+ExecutableMetrics::ExecutableMetrics(absl::string_view fingerprint)
+    : enqueue_time_usecs_(pjrt_executable_enqueue_time_usecs->GetCell(
+          std::string(fingerprint))),
+      execution_time_usecs_(
+          pjrt_executable_execution_time_usecs_histogram->GetCell(
+              std::string(fingerprint))),
+      in_flight_(pjrt_executable_executions_in_flight->GetCell(
+          std::string(fingerprint))) {}
+
+void ExecutableMetrics::RecordExecutionEnqueued(uint64_t enqueue_time_usecs) {
+  enqueue_time_usecs_->Add(enqueue_time_usecs);
+  UpdateExecutionsInFlight(1);
+}
+
+void ExecutableMetrics::RecordExecutionCompleted(
+    uint64_t execution_time_usecs) {
+  execution_time_usecs_->Add(execution_time_usecs);
+  RecordExecutionAborted();
+}
+
+void ExecutableMetrics::RecordExecutionAborted() {
+  UpdateExecutionsInFlight(-1);
+}
+
+int64_t ExecutableMetrics::num_in_flight() const { return in_flight_->value(); }
+
+void ExecutableMetrics::UpdateExecutionsInFlight(int64_t delta) {
+  // Gauges can only be set, so the read-modify-write is serialized. The cell
+  // is shared by all executables with the same fingerprint.
+  absl::MutexLock lock(&executions_in_flight_mu);
+  in_flight_->Set(in_flight_->value() + delta);
+}
+
 }  // namespace metrics
 }  // namespace xla
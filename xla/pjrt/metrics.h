@@ -16,9 +16,13 @@ limitations under the License.
 #ifndef XLA_PJRT_METRICS_H_
 #define XLA_PJRT_METRICS_H_
 
+#include <cstdint>
+
 #include "absl/base/attributes.h"
 #include "absl/strings/string_view.h"
 #include "xla/tsl/lib/monitoring/counter.h"
+#include "xla/tsl/lib/monitoring/gauge.h"
+#include "xla/tsl/lib/monitoring/sampler.h"
 
 // Simplified version of tensorflow/core/framework/metrics.h for JAX.
 
@@ -29,6 +33,10 @@ inline constexpr absl::string_view kPjrtCompilerCompileComputationMetricName =
     "/pjrt/compiler/is_compiling_computation";
 inline constexpr absl::string_view kPjrtCompilerCompileModuleMetricName =
     "/pjrt/compiler/is_compiling_module";
+inline constexpr absl::string_view kPjrtExecutableExecutionsInFlightMetricName =
+    "/jax/pjrt/pjrt_executable_executions_in_flight";
+inline constexpr absl::string_view kPjrtDeviceExecuteQueueDepthMetricName =
+    "/jax/pjrt/pjrt_device_execute_queue_depth";
 
 void ReportExecutableEnqueueTime(uint64_t running_time_usecs);
 
@@ -36,6 +44,42 @@ void RecordPjrtCompilerCompileComputationStatus(bool is_compiling);
 
 void RecordPjrtCompilerCompileModuleStatus(bool is_compiling);
 
+// Records the number of computations enqueued on device `device_id` that have
+// not completed yet.
+void RecordDeviceExecuteQueueDepth(int device_id, int64_t depth);
+
+// Execution metrics of a single loaded executable, exported with the
+// executable fingerprint as label. The metric cells are looked up once at
+// construction, so recording only updates the cells and is cheap enough to be
+// always on. This class is thread-safe.
+class ExecutableMetrics {
+ public:
+  explicit ExecutableMetrics(absl::string_view fingerprint);
+
+  // Records the time from the start of an execute call until the execution is
+  // enqueued on the device, and counts the execution as in flight.
+  void RecordExecutionEnqueued(uint64_t enqueue_time_usecs);
+
+  // Records the time from the start of an execute call until the execution
+  // finished on the device, and counts the execution as no longer in flight.
+  void RecordExecutionCompleted(uint64_t execution_time_usecs);
+
+  // Counts an enqueued execution whose completion will never be recorded as
+  // no longer in flight.
+  void RecordExecutionAborted();
+
+  // Returns the number of executions enqueued but not yet completed, over all
+  // executables with the same fingerprint.
+  int64_t num_in_flight() const;
+
+ private:
+  void UpdateExecutionsInFlight(int64_t delta);
+
+  tsl::monitoring::SamplerCell* enqueue_time_usecs_;
+  tsl::monitoring::SamplerCell* execution_time_usecs_;
+  tsl::monitoring::GaugeCell<int64_t>* in_flight_;
+};
+
 }  // namespace metrics
 }  // namespace xla
 
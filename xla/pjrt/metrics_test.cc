@@ -0,0 +1,102 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/metrics.h"
+
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "xla/tsl/lib/monitoring/cell_reader.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla {
+namespace metrics {
+namespace {
+
+using ::tsl::monitoring::testing::CellReader;
+
+TEST(ExecutableMetricsTest, TracksExecutionsInFlight) {
+  CellReader<int64_t> in_flight_reader(
+      std::string{kPjrtExecutableExecutionsInFlightMetricName});
+  ExecutableMetrics metrics("fingerprint");
+
+  metrics.RecordExecutionEnqueued(/*enqueue_time_usecs=*/10);
+  metrics.RecordExecutionEnqueued(/*enqueue_time_usecs=*/20);
+  EXPECT_EQ(metrics.num_in_flight(), 2);
+  EXPECT_EQ(in_flight_reader.Read("fingerprint"), 2);
+
+  metrics.RecordExecutionCompleted(/*execution_time_usecs=*/100);
+  EXPECT_EQ(in_flight_reader.Read("fingerprint"), 1);
+  metrics.RecordExecutionAborted();
+  EXPECT_EQ(metrics.num_in_flight(), 0);
+  EXPECT_EQ(in_flight_reader.Read("fingerprint"), 0);
+}
+
+TEST(ExecutableMetricsTest, SharesExecutionsInFlightByFingerprint) {
+  CellReader<int64_t> in_flight_reader(
+      std::string{kPjrtExecutableExecutionsInFlightMetricName});
+  ExecutableMetrics metrics("shared_fingerprint");
+  ExecutableMetrics other_metrics("shared_fingerprint");
+
+  metrics.RecordExecutionEnqueued(/*enqueue_time_usecs=*/10);
+  other_metrics.RecordExecutionEnqueued(/*enqueue_time_usecs=*/10);
+  EXPECT_EQ(in_flight_reader.Read("shared_fingerprint"), 2);
+  metrics.RecordExecutionCompleted(/*execution_time_usecs=*/100);
+  EXPECT_EQ(in_flight_reader.Read("shared_fingerprint"), 1);
+  other_metrics.RecordExecutionCompleted(/*execution_time_usecs=*/100);
+  EXPECT_EQ(in_flight_reader.Read("shared_fingerprint"), 0);
+}
+
+TEST(ExecutableMetricsTest, ConcurrentUpdatesAreNotLost) {
+  CellReader<int64_t> in_flight_reader(
+      std::string{kPjrtExecutableExecutionsInFlightMetricName});
+  ExecutableMetrics metrics("concurrent_fingerprint");
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumExecutions = 1000;
+  {
+    tsl::thread::ThreadPool threads(tsl::Env::Default(), "metrics_test",
+                                    kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.Schedule([&metrics] {
+        for (int i = 0; i < kNumExecutions; ++i) {
+          metrics.RecordExecutionEnqueued(/*enqueue_time_usecs=*/1);
+        }
+      });
+    }
+  }
+  EXPECT_EQ(in_flight_reader.Read("concurrent_fingerprint"),
+            kNumThreads * kNumExecutions);
+
+  {
+    tsl::thread::ThreadPool threads(tsl::Env::Default(), "metrics_test",
+                                    kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.Schedule([&metrics] {
+        for (int i = 0; i < kNumExecutions; ++i) {
+          metrics.RecordExecutionCompleted(/*execution_time_usecs=*/1);
+        }
+      });
+    }
+  }
+  EXPECT_EQ(in_flight_reader.Read("concurrent_fingerprint"), 0);
+  EXPECT_EQ(metrics.num_in_flight(), 0);
+}
+
+}  // namespace
+}  // namespace metrics
+}  // namespace xla
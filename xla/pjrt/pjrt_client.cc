@@ -15,15 +15,24 @@ limitations under the License.
 
 #include "xla/pjrt/pjrt_client.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/casts.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xla/hlo/ir/hlo_module.h"
+#include "xla/pjrt/pjrt_future.h"
 #include "xla/pjrt/utils.h"
+#include "xla/tsl/framework/allocator.h"
 #include "xla/util.h"
 #include "tsl/platform/errors.h"
 
@@ -52,6 +61,191 @@ PjRtFuture<> PjRtBuffer::CopyRawToHostFuture(PjRtFuture<void*> dst,
       "PjRtBuffer::CopyRawToHostFuture is not implemented"));
 }
 
+namespace {
+
+// Shared state of a CopyRawToHostChunked call. Chunk `i` is staged in slot
+// `i % num_slots`; a slot is reused once the consumer of its chunk is done.
+struct ChunkedCopyState {
+  ChunkedCopyState(PjRtBuffer* buffer, int64_t total_size, int64_t chunk_size,
+                   int num_slots, PjRtBuffer::RawChunkCallback on_chunk,
+                   tsl::Allocator* allocator)
+      : buffer(buffer),
+        total_size(total_size),
+        chunk_size(chunk_size),
+        num_chunks(CeilOfRatio(total_size, chunk_size)),
+        num_slots(num_slots),
+        on_chunk(std::move(on_chunk)),
+        allocator(allocator),
+        staging(static_cast<char*>(allocator->AllocateRaw(
+            tsl::Allocator::kAllocatorAlignment, chunk_size * num_slots))),
+        promise(PjRtFuture<>::CreatePromise()),
+        slot_busy(num_slots, false),
+        slot_landed(num_slots, false) {}
+
+  ~ChunkedCopyState() {
+    if (staging != nullptr) {
+      allocator->DeallocateRaw(staging);
+    }
+  }
+
+  int64_t ChunkOffset(int64_t chunk) const { return chunk * chunk_size; }
+  int64_t ChunkSize(int64_t chunk) const {
+    return std::min(chunk_size, total_size - ChunkOffset(chunk));
+  }
+  char* Slot(int64_t chunk) const {
+    return staging + (chunk % num_slots) * chunk_size;
+  }
+
+  PjRtBuffer* const buffer;
+  const int64_t total_size;
+  const int64_t chunk_size;
+  const int64_t num_chunks;
+  const int num_slots;
+  PjRtBuffer::RawChunkCallback on_chunk;
+  tsl::Allocator* const allocator;
+  char* const staging;
+  PjRtFuture<>::Promise promise;
+
+  absl::Mutex mu;
+  bool done ABSL_GUARDED_BY(mu) = false;
+  // True while a thread is calling `on_chunk`, which must not run
+  // concurrently.
+  bool delivering ABSL_GUARDED_BY(mu) = false;
+  int64_t next_to_issue ABSL_GUARDED_BY(mu) = 0;
+  int64_t next_to_deliver ABSL_GUARDED_BY(mu) = 0;
+  int64_t num_consumed ABSL_GUARDED_BY(mu) = 0;
+  std::vector<bool> slot_busy ABSL_GUARDED_BY(mu);
+  std::vector<bool> slot_landed ABSL_GUARDED_BY(mu);
+};
+
+void FinishChunkedCopy(const std::shared_ptr<ChunkedCopyState>& state,
+                       absl::Status status) {
+  {
+    absl::MutexLock lock(&state->mu);
+    if (state->done) {
+      return;
+    }
+    state->done = true;
+  }
+  state->promise.Set(std::move(status));
+}
+
+void IssueChunkCopies(const std::shared_ptr<ChunkedCopyState>& state);
+
+void OnChunkConsumed(const std::shared_ptr<ChunkedCopyState>& state,
+                     int64_t chunk, absl::Status status) {
+  if (!status.ok()) {
+    FinishChunkedCopy(state, std::move(status));
+    return;
+  }
+  bool all_consumed;
+  {
+    absl::MutexLock lock(&state->mu);
+    state->slot_busy[chunk % state->num_slots] = false;
+    all_consumed = ++state->num_consumed == state->num_chunks;
+  }
+  if (all_consumed) {
+    FinishChunkedCopy(state, absl::OkStatus());
+  } else {
+    IssueChunkCopies(state);
+  }
+}
+
+// Hands every chunk that has landed to the consumer, in order.
+void OnChunkCopied(const std::shared_ptr<ChunkedCopyState>& state,
+                   int64_t chunk, absl::Status status) {
+  if (!status.ok()) {
+    FinishChunkedCopy(state, std::move(status));
+    return;
+  }
+  absl::MutexLock lock(&state->mu);
+  state->slot_landed[chunk % state->num_slots] = true;
+  if (state->delivering) {
+    return;
+  }
+  state->delivering = true;
+  while (!state->done && state->next_to_deliver < state->num_chunks &&
+         state->slot_landed[state->next_to_deliver % state->num_slots]) {
+    int64_t next = state->next_to_deliver++;
+    state->slot_landed[next % state->num_slots] = false;
+    state->mu.Unlock();
+    PjRtFuture<> consumed = state->on_chunk(
+        state->ChunkOffset(next),
+        absl::Span<const char>(state->Slot(next), state->ChunkSize(next)));
+    consumed.OnReady([state, next](absl::Status status) {
+      OnChunkConsumed(state, next, std::move(status));
+    });
+    state->mu.Lock();
+  }
+  state->delivering = false;
+}
+
+// Starts the copies of as many chunks as there are free staging slots.
+void IssueChunkCopies(const std::shared_ptr<ChunkedCopyState>& state) {
+  while (true) {
+    int64_t chunk;
+    {
+      absl::MutexLock lock(&state->mu);
+      if (state->done || state->next_to_issue == state->num_chunks ||
+          state->slot_busy[state->next_to_issue % state->num_slots]) {
+        return;
+      }
+      chunk = state->next_to_issue++;
+      state->slot_busy[chunk % state->num_slots] = true;
+    }
+    state->buffer
+        ->CopyRawToHost(state->Slot(chunk), state->ChunkOffset(chunk),
+                        state->ChunkSize(chunk))
+        .OnReady([state, chunk](absl::Status status) {
+          OnChunkCopied(state, chunk, std::move(status));
+        });
+  }
+}
+
+}  // namespace
+
+PjRtFuture<> PjRtBuffer::CopyRawToHostChunked(int64_t chunk_size,
+                                              int num_staging_chunks,
+                                              RawChunkCallback on_chunk) {
+  return CopyRawToHostChunkedWithAllocator(chunk_size, num_staging_chunks,
+                                           std::move(on_chunk),
+                                           tsl::cpu_allocator());
+}
+
+PjRtFuture<> PjRtBuffer::CopyRawToHostChunkedWithAllocator(
+    int64_t chunk_size, int num_staging_chunks, RawChunkCallback on_chunk,
+    tsl::Allocator* staging_allocator) {
+  if (chunk_size <= 0 || num_staging_chunks <= 0) {
+    return PjRtFuture<>(InvalidArgument(
+        "CopyRawToHostChunked requires a positive chunk size and number of "
+        "staging chunks, got %d and %d.",
+        chunk_size, num_staging_chunks));
+  }
+  absl::StatusOr<size_t> total_size = GetOnDeviceSizeInBytes();
+  if (!total_size.ok()) {
+    return PjRtFuture<>(total_size.status());
+  }
+  if (*total_size == 0) {
+    return PjRtFuture<>(absl::OkStatus());
+  }
+  // Don't allocate more staging memory than the buffer needs.
+  chunk_size = std::min<int64_t>(chunk_size, *total_size);
+  num_staging_chunks = std::min<int64_t>(
+      num_staging_chunks, CeilOfRatio<int64_t>(*total_size, chunk_size));
+  auto state = std::make_shared<ChunkedCopyState>(
+      this, *total_size, chunk_size, num_staging_chunks, std::move(on_chunk),
+      staging_allocator);
+  if (state->staging == nullptr) {
+    return PjRtFuture<>(ResourceExhausted(
+        "Failed to allocate %d bytes of host staging memory for "
+        "CopyRawToHostChunked",
+        chunk_size * num_staging_chunks));
+  }
+  PjRtFuture<> result(state->promise);
+  IssueChunkCopies(state);
+  return result;
+}
+
 std::string CompiledMemoryStats::DebugString() const {
   return absl::Substitute(
       "CompiledMemoryStats("
@@ -207,6 +207,14 @@ class PjRtDevice {
   // Transfer the given literal to the infeed queue.
   virtual absl::Status TransferToInfeed(const LiteralSlice& literal) = 0;
 
+  // Transfer the given literal to the infeed queue, handing over ownership of
+  // its buffers. Devices that can read host memory directly enqueue the
+  // literal's buffers without copying them; the default implementation falls
+  // back to TransferToInfeed.
+  virtual absl::Status TransferOwnedLiteralToInfeed(Literal literal) {
+    return TransferToInfeed(literal);
+  }
+
   // Transfer and return a value of the given shape from the outfeed queue.
   virtual absl::Status TransferFromOutfeed(MutableBorrowingLiteral literal) = 0;
 
@@ -1259,6 +1267,29 @@ class PjRtBuffer {
                                            int64_t offset,
                                            int64_t transfer_size);
 
+  // Called by CopyRawToHostChunked with each chunk of the buffer's raw
+  // on-device bytes, starting at `offset`. `chunk` stays valid until the
+  // returned future becomes ready, after which its memory is reused for a
+  // later chunk. Returning a future that holds an error aborts the copy.
+  using RawChunkCallback = absl::AnyInvocable<PjRtFuture<>(
+      int64_t offset, absl::Span<const char> chunk)>;
+
+  // Streams the bytes CopyRawToHost would return to the host in chunks of
+  // `chunk_size` bytes, the last of which may be shorter, staged through a
+  // ring of `num_staging_chunks` host buffers. Host memory use is therefore
+  // bounded by chunk_size * num_staging_chunks regardless of the size of the
+  // buffer, and the transfer of later chunks overlaps with the consumption of
+  // earlier ones, e.g. by a checkpoint writer. `on_chunk` is called in order
+  // of increasing offset and never concurrently. The returned future becomes
+  // ready once every chunk has been consumed or with the first error. The
+  // buffer must not be destroyed before then.
+  //
+  // The default implementation is built on CopyRawToHost and stages through
+  // heap memory.
+  virtual PjRtFuture<> CopyRawToHostChunked(int64_t chunk_size,
+                                            int num_staging_chunks,
+                                            RawChunkCallback on_chunk);
+
   // Drops the buffer's reference to its associated device memory, leaving the
   // buffer in an invalid state. The memory will be freed lazily when all async
   // operations using the buffer have completed, according to the allocation
@@ -1387,6 +1418,16 @@ class PjRtBuffer {
     return Unimplemented("DonateWithControlDependency is not supported.");
   }
 
+  // Returns a buffer that aliases rows [start, limit) of the major dimension
+  // of 'this' without copying, e.g. to split a batch. Only dense arrays whose
+  // layout is major-to-minor can be sliced this way. The view keeps the memory
+  // of 'this' alive and prevents it from being donated until the view is
+  // deleted.
+  virtual absl::StatusOr<std::unique_ptr<PjRtBuffer>> CreateSliceView(
+      int64_t start, int64_t limit) {
+    return Unimplemented("CreateSliceView is not supported.");
+  }
+
   // Helper to allow a caller to indicate that it is going to do some "sends"
   // of the buffer a later date, where a send is a transfer out of a device
   // buffer, either copying to host, or to a remote device.
@@ -1459,6 +1500,13 @@ class PjRtBuffer {
 
   // Whether this buffer is on CPU and thus allows for certain optimizations.
   virtual bool IsOnCpu() const = 0;
+
+ protected:
+  // Implements CopyRawToHostChunked on top of CopyRawToHost, allocating the
+  // staging ring from `staging_allocator`, which must outlive the copy.
+  PjRtFuture<> CopyRawToHostChunkedWithAllocator(
+      int64_t chunk_size, int num_staging_chunks, RawChunkCallback on_chunk,
+      tsl::Allocator* staging_allocator);
 };
 
 // Represents a compiled computation that can be executed given handles to
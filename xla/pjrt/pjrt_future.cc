@@ -29,6 +29,10 @@ limitations under the License.
 namespace xla {
 
 namespace {
+
+// Shared by the OnReady callbacks of the joined futures. The callbacks hold a
+// plain pointer, and the one bringing `pending_count` to zero completes the
+// promise and deletes the state.
 struct State {
   explicit State(int32_t size)
       : pending_count(size), promise(PjRtFuture<>::CreatePromise()) {}
@@ -39,36 +43,80 @@ struct State {
   absl::Mutex mu;
   absl::Status status ABSL_GUARDED_BY(&mu);
 };
+
+void DropPending(State* state, int32_t count) {
+  const int32_t pending_count =
+      state->pending_count.fetch_sub(count, std::memory_order_acq_rel);
+  CHECK_GE(pending_count, count) << "Pending count can't drop below 0";
+
+  if (pending_count == count) {
+    absl::Status status;
+    {
+      absl::MutexLock lock(&state->mu);
+      status = std::move(state->status);
+    }
+    state->promise.Set(std::move(status));
+    delete state;
+  }
+}
+
 }  // namespace
 
 PjRtFuture<> JoinFutures(absl::Span<const PjRtFuture<>> futures) {
-  if (futures.empty()) {
-    return PjRtFuture<>(absl::OkStatus());
-  } else if (futures.size() == 1) {
-    return futures.front();
+  // When at most one future is still pending and there is no error yet, one
+  // of the input futures can stand in for the join. This is the common case
+  // when joining the definition events of many buffers of a step.
+  const PjRtFuture<>* first_error = nullptr;
+  const PjRtFuture<>* last_pending = nullptr;
+  int32_t num_pending = 0;
+  for (const PjRtFuture<>& future : futures) {
+    if (!future.IsKnownReady()) {
+      last_pending = &future;
+      ++num_pending;
+    } else if (first_error == nullptr && !future.Await().ok()) {
+      first_error = &future;
+    }
+  }
+
+  if (num_pending == 0) {
+    if (first_error != nullptr) return *first_error;
+    return futures.empty() ? PjRtFuture<>(absl::OkStatus()) : futures.front();
+  }
+  if (num_pending == 1 && first_error == nullptr) {
+    return *last_pending;
   }
 
-  auto state = std::make_shared<State>(futures.size());
+  // Futures may become ready while we register the callbacks, so only those
+  // still pending get one. Start with a count that can't drop to zero before
+  // we are done, and drop the part of it that no callback accounts for at the
+  // end.
+  const int32_t initial_count = futures.size() + 1;
+  auto* state = new State(initial_count);
+  PjRtFuture<> joined(state->promise);
 
+  int32_t num_registered = 0;
+  absl::Status ready_status;
   for (const PjRtFuture<>& future : futures) {
-    future.OnReady([state](absl::Status status) {
+    if (future.IsKnownReady()) {
+      ready_status.Update(future.Await());
+      continue;
+    }
+    ++num_registered;
+    future.OnReady([state](const absl::Status& status) {
       if (!status.ok()) {
         absl::MutexLock lock(&state->mu);
         state->status.Update(status);
       }
-
-      const int pending_count =
-          state->pending_count.fetch_sub(1, std::memory_order_acq_rel);
-      CHECK_GE(pending_count, 1) << "Pending count can't drop below 0";
-
-      if (pending_count == 1) {
-        absl::MutexLock lock(&state->mu);
-        state->promise.Set(std::move(state->status));
-      }
+      DropPending(state, 1);
     });
   }
 
-  return PjRtFuture<>(state->promise);
+  if (!ready_status.ok()) {
+    absl::MutexLock lock(&state->mu);
+    state->status.Update(ready_status);
+  }
+  DropPending(state, initial_count - num_registered);
+  return joined;
 }
 
 }  // namespace xla
@@ -42,7 +42,8 @@ class PjRtFutureBase;
 }
 
 // Returns a `PjRtFuture` that will be successful if all `futures` complete
-// successfully, or return a first encountered error.
+// successfully, or return a first encountered error. If at most one of
+// `futures` is still pending, the result may be one of `futures` itself.
 PjRtFuture<> JoinFutures(absl::Span<const PjRtFuture<>> futures);
 
 // An RAII event that a caller can use to tell the PjRtClient about asynchronous
@@ -175,7 +176,7 @@ class PjRtFutureBase : public PjRtFutureMoveControl<unique> {
   // call to `Await()` has already returned, or any callback passed to
   // `OnReady` has already been triggered. Otherwise IsReady() may block for
   // the duration of a network message on some backends.
-  bool IsReady() {
+  bool IsReady() const {
     CHECK(IsValid());
     return promise_.IsAvailable();
   }
@@ -184,7 +185,7 @@ class PjRtFutureBase : public PjRtFutureMoveControl<unique> {
   // callback passed to `OnReady` has already been triggered. Otherwise,
   // `IsKnownReady()` may return false in some cases in which the future was
   // ready before `IsKnownReady()` was called.
-  bool IsKnownReady() {
+  bool IsKnownReady() const {
     CHECK(IsValid());
     return promise_.IsAvailable();
   }
@@ -231,4 +231,35 @@ TEST(PjRtFutureTest, JoinErrors) {
   EXPECT_EQ(join_two.Await(), absl::InternalError("error #0"));
 }
 
+TEST(PjRtFutureTest, JoinReadyAndPendingFutures) {
+  PjRtFuture<> ready(absl::OkStatus());
+  PjRtFuture<> failed(absl::InternalError("error #0"));
+
+  auto join_ready = JoinFutures({ready, ready, failed});
+  EXPECT_TRUE(join_ready.IsReady());
+  EXPECT_EQ(join_ready.Await(), absl::InternalError("error #0"));
+
+  auto promise0 = PjRtFuture<>::CreatePromise();
+  auto promise1 = PjRtFuture<>::CreatePromise();
+
+  std::vector<PjRtFuture<>> futures0 = {ready, PjRtFuture<>(promise0), ready};
+  std::vector<PjRtFuture<>> futures1 = {ready, PjRtFuture<>(promise0), failed,
+                                        PjRtFuture<>(promise1)};
+
+  auto join_one = JoinFutures(futures0);
+  EXPECT_FALSE(join_one.IsReady());
+
+  auto join_two = JoinFutures(futures1);
+  EXPECT_FALSE(join_two.IsReady());
+
+  promise0.Set();
+  EXPECT_TRUE(join_one.IsReady());
+  EXPECT_EQ(join_one.Await(), absl::OkStatus());
+  EXPECT_FALSE(join_two.IsReady());
+
+  promise1.Set(absl::InternalError("error #1"));
+  EXPECT_TRUE(join_two.IsReady());
+  EXPECT_EQ(join_two.Await(), absl::InternalError("error #0"));
+}
+
 }  // namespace xla
@@ -65,12 +65,15 @@ limitations under the License.
 #include "xla/pjrt/pjrt_stream_executor_client.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <initializer_list>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -85,6 +88,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -92,6 +96,7 @@ limitations under the License.
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "mlir/IR/BuiltinOps.h"
@@ -100,6 +105,7 @@ limitations under the License.
 #include "xla/executable_run_options.h"
 #include "xla/hlo/builder/xla_computation.h"
 #include "xla/layout.h"
+#include "xla/layout_util.h"
 #include "xla/literal.h"
 #include "xla/pjrt/distributed/protocol.pb.h"
 #include "xla/pjrt/event_pool.h"
@@ -134,6 +140,7 @@ limitations under the License.
 #include "xla/stream_executor/device_memory_allocator.h"
 #include "xla/stream_executor/stream.h"
 #include "xla/tsl/framework/allocator.h"
+#include "xla/tsl/lib/strings/proto_serialization.h"
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/casts.h"
@@ -177,6 +184,21 @@ PjRtStreamExecutorDevice::GetLocalDeviceState() const {
   return InvalidArgument("Device %s is not a local device.", DebugString());
 }
 
+PjRtFuture<> PjRtStreamExecutorDevice::WaitForExecuteCapacity() const {
+  if (!local_device_state_) {
+    return PjRtFuture<>(
+        InvalidArgument("Device %s is not a local device.", DebugString()));
+  }
+  auto promise = PjRtFuture<>::CreatePromise();
+  // Continuations of the future must not run on the thread that releases
+  // the reservation, which may be a stream callback thread.
+  local_device_state_->compute_semaphore().OnAvailable(
+      /*amount=*/1,
+      tensorflow::down_cast<PjRtStreamExecutorClient*>(client_)->thread_pool(),
+      [promise]() mutable { promise.Set(); });
+  return PjRtFuture<>(std::move(promise));
+}
+
 absl::StatusOr<DeviceAssignment> DevicesToDeviceAssignment(
     absl::Span<const std::vector<PjRtDevice*>> devices) {
   if (devices.empty()) {
@@ -446,6 +468,59 @@ void MaybeWaitForEventOnStream(BufferSequencingEvent* event,
   }
 }
 
+// Size of the pinned staging chunks of double-buffered host-to-device
+// transfers. Smaller transfers are staged through a single buffer.
+constexpr int64_t kStagingChunkBytes = int64_t{16} << 20;
+
+// Allocates a host staging buffer of `num_bytes` from `host_memory_allocator`,
+// which is returned to the allocator when the last reference goes away.
+absl::StatusOr<std::shared_ptr<void>> AllocateStagingBuffer(
+    tsl::Allocator* host_memory_allocator, int64_t num_bytes) {
+  void* ptr = host_memory_allocator->AllocateRaw(
+      tsl::Allocator::kAllocatorAlignment, num_bytes);
+  if (ptr == nullptr && num_bytes > 0) {
+    return ResourceExhausted(
+        "Failed to allocate %d bytes of host staging memory", num_bytes);
+  }
+  return std::shared_ptr<void>(ptr, [host_memory_allocator](void* ptr) {
+    host_memory_allocator->DeallocateRaw(ptr);
+  });
+}
+
+// Copies `size` bytes from host memory at `src` to `dst` through the two
+// staging `chunks` of `kStagingChunkBytes` each, so that the host copy of one
+// chunk overlaps with the DMA of the other one. The chunks are released after
+// all DMAs complete.
+absl::Status ThenMemcpyHostToDeviceDoubleBuffered(
+    LocalDeviceState* local_device,
+    std::array<std::shared_ptr<void>, 2> chunks, se::DeviceMemoryBase* dst,
+    const void* src, int64_t size) {
+  se::Stream* stream = local_device->host_to_device_stream();
+  int64_t chunk_bytes = kStagingChunkBytes;
+
+  // Notified when the DMA from the corresponding staging chunk is done.
+  std::array<std::shared_ptr<absl::Notification>, 2> chunk_done;
+
+  for (int64_t i = 0, offset = 0; offset < size; ++i, offset += chunk_bytes) {
+    int64_t slot = i % 2;
+    if (chunk_done[slot]) chunk_done[slot]->WaitForNotification();
+
+    int64_t bytes = std::min(chunk_bytes, size - offset);
+    std::memcpy(chunks[slot].get(), static_cast<const char*>(src) + offset,
+                bytes);
+
+    se::DeviceMemoryBase dst_chunk = dst->GetByteSlice(offset, bytes);
+    TF_RETURN_IF_ERROR(local_device->ThenMemcpyHostToDevice(
+        &dst_chunk, chunks[slot].get(), bytes));
+
+    chunk_done[slot] = std::make_shared<absl::Notification>();
+    TF_RETURN_IF_ERROR(stream->DoHostCallback(
+        [done = chunk_done[slot]]() { done->Notify(); }));
+  }
+
+  return local_device->ThenRelease(stream, std::move(chunks));
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<PjRtStreamExecutorBuffer>>
@@ -778,6 +853,57 @@ PjRtStreamExecutorBuffer::ReleaseDeviceMemoryOwnership(
   return ref;
 }
 
+absl::StatusOr<std::unique_ptr<PjRtBuffer>>
+PjRtStreamExecutorBuffer::CreateSliceView(int64_t start, int64_t limit) {
+  const Shape& shape = on_device_shape_;
+  if (!shape.IsArray() || shape.rank() == 0 || shape.is_dynamic()) {
+    return InvalidArgument(
+        "CreateSliceView requires a static array of rank >= 1, got %s",
+        shape.ToString());
+  }
+  if (!LayoutUtil::IsMonotonicWithDim0Major(shape.layout()) ||
+      !shape.layout().tiles().empty() ||
+      primitive_util::IsSubByteNonPredType(shape.element_type())) {
+    return InvalidArgument(
+        "CreateSliceView requires a dense major-to-minor layout, got %s",
+        ShapeUtil::HumanStringWithLayout(shape));
+  }
+  const int64_t num_rows = shape.dimensions(0);
+  if (start < 0 || start > limit || limit > num_rows) {
+    return InvalidArgument(
+        "Invalid slice [%d, %d) of major dimension with size %d", start, limit,
+        num_rows);
+  }
+
+  // The external reference hold keeps the parent memory alive and rules out
+  // donating it while the view exists. The view itself is never donatable,
+  // see GetBufferForHoldLocked().
+  ScopedHold hold = GetBufferWithExternalReference();
+  TF_RETURN_IF_ERROR(hold.status());
+  const se::DeviceMemoryBase& parent_memory = hold->device_memory().front();
+  const int64_t row_bytes =
+      num_rows == 0 ? 0 : ShapeUtil::ByteSizeOf(shape) / num_rows;
+  se::DeviceMemoryBase view_memory(
+      static_cast<char*>(parent_memory.opaque()) + start * row_bytes,
+      (limit - start) * row_bytes);
+
+  Shape view_shape = shape;
+  view_shape.set_dimensions(0, limit - start);
+  absl::InlinedVector<std::shared_ptr<BufferSequencingEvent>, 2>
+      definition_events(hold->definition_events().begin(),
+                        hold->definition_events().end());
+  auto device_buffer = std::make_shared<TrackedDeviceBuffer>(
+      /*allocator=*/nullptr, device_,
+      std::initializer_list<se::DeviceMemoryBase>{view_memory},
+      definition_events,
+      /*on_delete_callback=*/[hold = std::move(hold)]() {});
+  auto view = std::make_unique<PjRtStreamExecutorBuffer>(
+      std::move(view_shape), std::move(device_buffer), client_, device_,
+      memory_space_);
+  view->is_slice_view_ = true;
+  return std::unique_ptr<PjRtBuffer>(std::move(view));
+}
+
 absl::StatusOr<std::unique_ptr<PjRtBuffer>>
 PjRtStreamExecutorBuffer::DonateWithControlDependency(PjRtFuture<> dependency) {
   VLOG(1) << "PjRtStreamExecutorBuffer::DonateWithControlDependency";
@@ -905,7 +1031,6 @@ PjRtStreamExecutorClient::BufferFromHostBufferInternal(
     options.dims = dims;
     options.permutation = permutation;
     options.input_layout = TransposePlan::Striding{*byte_strides};
-    absl::MutexLock lock(&transpose_mu_);
     TF_ASSIGN_OR_RETURN(transpose, transpose_cache_.GetOrCreate(options));
   }
 
@@ -925,17 +1050,24 @@ PjRtStreamExecutorClient::BufferFromHostBufferInternal(
   bool must_use_staging_buffer =
       host_buffer_semantics == HostBufferSemantics::kImmutableOnlyDuringCall ||
       !host_and_device_strides_equal || packed_size != size;
-  // Allocating multigigabyte pinned buffers can be very slow. In that case,
-  // using a staging buffer is probably worse than not using one.
-  // TODO(phawkins): add chunking for transfers.
-  if (must_use_staging_buffer || (should_stage_host_to_device_transfers() &&
-                                  packed_size < (int64_t{1} << 30))) {
-    void* ptr = host_memory_allocator()->AllocateRaw(
-        tsl::Allocator::kAllocatorAlignment, transpose ? size : packed_size);
-    staging_buffer = std::shared_ptr<void>(
-        ptr, [host_memory_allocator = host_memory_allocator()](void* ptr) {
-          host_memory_allocator->DeallocateRaw(ptr);
-        });
+  // Allocating large pinned buffers can be very slow, so if the host buffer
+  // stays valid for the duration of the transfer we stage large transfers in
+  // chunks through a pair of recycled pinned buffers instead.
+  bool stage_in_chunks = !must_use_staging_buffer &&
+                         should_stage_host_to_device_transfers() &&
+                         packed_size > kStagingChunkBytes;
+  std::array<std::shared_ptr<void>, 2> staging_chunks;
+  if (must_use_staging_buffer ||
+      (should_stage_host_to_device_transfers() && !stage_in_chunks)) {
+    TF_ASSIGN_OR_RETURN(
+        staging_buffer,
+        AllocateStagingBuffer(host_memory_allocator(),
+                              transpose ? size : packed_size));
+  } else if (stage_in_chunks) {
+    for (std::shared_ptr<void>& chunk : staging_chunks) {
+      TF_ASSIGN_OR_RETURN(chunk, AllocateStagingBuffer(host_memory_allocator(),
+                                                       kStagingChunkBytes));
+    }
   }
 
   // Copy the buffer into a staging buffer before returning control to the
@@ -980,7 +1112,8 @@ PjRtStreamExecutorClient::BufferFromHostBufferInternal(
        type, packed_size, movable_device_buffer{device_buffer.ToClosure()},
        device_shape, should_pack, py_buffer{py_buffer.get()},
        on_device_shape{py_buffer->on_device_shape()},
-       staging_buffer{std::move(staging_buffer)},
+       staging_buffer{std::move(staging_buffer)}, stage_in_chunks,
+       staging_chunks{std::move(staging_chunks)},
        on_done_with_host_buffer =
            on_done_with_host_buffer
                ? std::make_shared<absl::AnyInvocable<void() &&>>(
@@ -1027,11 +1160,15 @@ PjRtStreamExecutorClient::BufferFromHostBufferInternal(
               }
             }
           }
-          TF_CHECK_OK(local_device->host_to_device_stream()->Memcpy(
+          TF_CHECK_OK(local_device->ThenMemcpyHostToDevice(
               &device_memory, staging_buffer.get(), packed_size));
+        } else if (stage_in_chunks) {
+          TF_CHECK_OK(ThenMemcpyHostToDeviceDoubleBuffered(
+              local_device, staging_chunks, &device_memory, data,
+              packed_size));
         } else {
-          TF_CHECK_OK(local_device->host_to_device_stream()->Memcpy(
-              &device_memory, data, packed_size));
+          TF_CHECK_OK(local_device->ThenMemcpyHostToDevice(&device_memory,
+                                                           data, packed_size));
         }
 
         std::shared_ptr<BufferSequencingEvent> event =
@@ -1230,6 +1367,352 @@ PjRtStreamExecutorClient::BufferFromHostLiteral(const LiteralSlice& literal,
       platform_name()));
 }
 
+PjRtFuture<> PjRtStreamExecutorClient::BuffersToLiterals(
+    absl::Span<PjRtBuffer* const> buffers,
+    absl::Span<MutableLiteralBase* const> literals) {
+  tsl::profiler::TraceMe traceme("PjRtStreamExecutorClient::BuffersToLiterals");
+  if (buffers.size() != literals.size()) {
+    return PjRtFuture<>(InvalidArgument(
+        "BuffersToLiterals called with %d buffers and %d literals",
+        buffers.size(), literals.size()));
+  }
+
+  struct Batch {
+    std::vector<PjRtStreamExecutorBuffer*> buffers;
+    std::vector<MutableLiteralBase*> literals;
+  };
+  std::vector<PjRtStreamExecutorDevice*> devices;
+  absl::flat_hash_map<PjRtStreamExecutorDevice*, Batch> batches;
+  std::vector<PjRtFuture<>> futures;
+
+  for (int i = 0; i < buffers.size(); ++i) {
+    auto* buffer =
+        tensorflow::down_cast<PjRtStreamExecutorBuffer*>(buffers[i]);
+    const Shape& shape = buffer->on_device_shape();
+    // Only dense arrays whose device representation matches the literal byte
+    // for byte can be copied without going through the transfer manager.
+    bool can_batch =
+        shape.IsArray() && shape.is_static() &&
+        !primitive_util::IsSubByteNonPredType(shape.element_type()) &&
+        Shape::Equal().MinorToMajorOnlyInLayout()(shape, literals[i]->shape());
+    if (!can_batch) {
+      futures.push_back(buffer->ToLiteral(literals[i]));
+      continue;
+    }
+    auto [it, inserted] = batches.try_emplace(buffer->device());
+    if (inserted) devices.push_back(buffer->device());
+    it->second.buffers.push_back(buffer);
+    it->second.literals.push_back(literals[i]);
+  }
+
+  for (PjRtStreamExecutorDevice* device : devices) {
+    const Batch& batch = batches.at(device);
+    futures.push_back(
+        BatchedBuffersToLiterals(device, batch.buffers, batch.literals));
+  }
+  return JoinFutures(futures);
+}
+
+PjRtFuture<> PjRtStreamExecutorClient::BatchedBuffersToLiterals(
+    PjRtStreamExecutorDevice* device,
+    absl::Span<PjRtStreamExecutorBuffer* const> buffers,
+    absl::Span<MutableLiteralBase* const> literals) {
+  // Alignment of the buffers within the staging allocation.
+  static constexpr int64_t kStagingAlignment = 64;
+
+  LocalDeviceState* local_device = device->local_device_state();
+  se::Stream* stream = local_device->GetDeviceToHostStream();
+
+  // Acquire all usage holds before converting any of them, so that a buffer
+  // that was deleted or donated doesn't leave the others waiting on a usage
+  // event that is never recorded.
+  std::vector<PjRtStreamExecutorBuffer::ScopedHold> holds;
+  holds.reserve(buffers.size());
+  for (PjRtStreamExecutorBuffer* buffer : buffers) {
+    holds.push_back(buffer->GetBufferWithUsageHold());
+    if (!holds.back().ok()) {
+      return PjRtFuture<>(holds.back().status());
+    }
+  }
+
+  std::vector<int64_t> offsets;
+  offsets.reserve(literals.size());
+  int64_t staging_bytes = 0;
+  for (MutableLiteralBase* literal : literals) {
+    offsets.push_back(staging_bytes);
+    staging_bytes +=
+        RoundUpTo<int64_t>(literal->size_bytes(), kStagingAlignment);
+  }
+
+  auto promise = PjRtFuture<>::CreatePromise();
+  auto usage_event = std::make_shared<BufferSequencingEvent>(thread_pool());
+
+  // As in ToLiteral, retain a reference to the device buffers until the copy
+  // completes rather than synchronizing the compute stream past the transfer.
+  std::vector<std::shared_ptr<TrackedDeviceBuffer>> device_buffers;
+  device_buffers.reserve(holds.size());
+  for (PjRtStreamExecutorBuffer::ScopedHold& hold : holds) {
+    device_buffers.push_back(hold.buffer());
+    hold.ConvertUsageHold(stream, usage_event, /*reference_held=*/true);
+  }
+
+  std::vector<MutableLiteralBase*> dst_literals(literals.begin(),
+                                                literals.end());
+  auto batched_copy = [this, promise, stream, local_device, device_buffers,
+                       dst_literals = std::move(dst_literals),
+                       offsets = std::move(offsets), staging_bytes,
+                       usage_event = std::move(usage_event)]() mutable {
+    absl::StatusOr<EventPool::Handle> event =
+        local_device->event_pool().AllocateEvent(stream->parent());
+    if (!event.ok()) {
+      promise.Set(event.status());
+      return;
+    }
+
+    for (const auto& device_buffer : device_buffers) {
+      absl::Status defined_status =
+          device_buffer->definition_events()[0]->GetDefinedStatus();
+      if (!defined_status.ok()) {
+        promise.Set(defined_status);
+        return;
+      }
+    }
+
+    std::shared_ptr<char> staging_buffer;
+    if (staging_bytes > 0) {
+      if (tsl::Allocator* allocator = host_memory_allocator()) {
+        staging_buffer = std::shared_ptr<char>(
+            static_cast<char*>(
+                allocator->AllocateRaw(kStagingAlignment, staging_bytes)),
+            [allocator](char* ptr) { allocator->DeallocateRaw(ptr); });
+      } else {
+        staging_buffer = std::shared_ptr<char>(
+            static_cast<char*>(
+                tsl::port::AlignedMalloc(staging_bytes, kStagingAlignment)),
+            [](char* ptr) { tsl::port::AlignedFree(ptr); });
+      }
+      if (staging_buffer == nullptr) {
+        promise.Set(ResourceExhausted(
+            "Failed to allocate %d bytes of host staging memory for "
+            "BuffersToLiterals",
+            staging_bytes));
+        return;
+      }
+    }
+
+    for (int i = 0; i < device_buffers.size(); ++i) {
+      WaitForBufferDefinitionEventsOnStream(*device_buffers[i], stream);
+      int64_t size = dst_literals[i]->size_bytes();
+      const se::DeviceMemoryBase& device_memory =
+          device_buffers[i]->device_memory()[0];
+      if (device_memory.size() < size) {
+        promise.Set(InvalidArgument(
+            "BuffersToLiterals: device buffer of %d bytes is too small for a "
+            "literal of %d bytes",
+            device_memory.size(), size));
+        return;
+      }
+      if (size == 0) continue;
+      if (absl::Status status = stream->Memcpy(
+              staging_buffer.get() + offsets[i], device_memory, size);
+          !status.ok()) {
+        promise.Set(std::move(status));
+        return;
+      }
+    }
+
+    local_device->event_pool().ThenRecordEvent(stream, event.value());
+    usage_event->SetSequencingEvent(std::move(event).value(), stream);
+
+    absl::Status callback_status = local_device->ThenExecuteCallback(
+        stream, [promise, device_buffers = std::move(device_buffers),
+                 dst_literals = std::move(dst_literals),
+                 offsets = std::move(offsets),
+                 staging_buffer = std::move(staging_buffer)]() mutable {
+          for (int i = 0; i < dst_literals.size(); ++i) {
+            int64_t size = dst_literals[i]->size_bytes();
+            if (size == 0) continue;
+            std::memcpy(dst_literals[i]->untyped_data(),
+                        staging_buffer.get() + offsets[i], size);
+          }
+          promise.Set();
+        });
+    if (!callback_status.ok()) {
+      promise.Set(std::move(callback_status));
+    }
+  };
+
+  // Enqueue the copies once the definition events of all buffers have been
+  // recorded on their streams.
+  auto pending = std::make_shared<std::atomic<int64_t>>(device_buffers.size());
+  auto shared_copy = std::make_shared<decltype(batched_copy)>(
+      std::move(batched_copy));
+  for (const auto& device_buffer : device_buffers) {
+    device_buffer->definition_events()[0]->ExecuteOrAddToFutureTasks(
+        absl::StrFormat("batched_buffers_to_literals_%p", shared_copy.get()),
+        [pending, shared_copy]() {
+          if (pending->fetch_sub(1) == 1) (*shared_copy)();
+        });
+  }
+
+  return PjRtFuture<>(
+      std::move(promise),
+      /*on_block_start=*/
+      []() {
+        tsl::profiler::TraceMeProducer traceme(
+            "PjRtStreamExecutorClient::BuffersToLiterals");
+        VLOG(1) << "PjRtStreamExecutorClient::BuffersToLiterals";
+        return PjRtFutureHelpers::ProfilingKeys(
+            {/*traceme_context_id =*/traceme.GetContextId()});
+      },
+      /*on_block_end=*/
+      [](PjRtFutureHelpers::ProfilingKeys keys) {
+        tsl::profiler::TraceMeConsumer traceme(
+            "PjRtStreamExecutorClient::BuffersToLiterals",
+            keys.traceme_context_id);
+      });
+}
+
+absl::StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+PjRtStreamExecutorClient::PackedBuffersFromHostLiterals(
+    absl::Span<const LiteralSlice> literals, PjRtDevice* device) {
+  tsl::profiler::TraceMe traceme(
+      "PjRtStreamExecutorClient::PackedBuffersFromHostLiterals");
+  VLOG(1) << "PjRtStreamExecutorClient::PackedBuffersFromHostLiterals: "
+          << literals.size() << " literals, device: " << device->DebugString();
+  auto* se_device = tensorflow::down_cast<PjRtStreamExecutorDevice*>(device);
+  TF_ASSIGN_OR_RETURN(LocalDeviceState * local_device,
+                      se_device->GetLocalDeviceState());
+  TransferManager* transfer_manager = client()->backend().transfer_manager();
+
+  // Literals that had to be converted to the device layout.
+  std::vector<Literal> relaid_literals;
+  std::vector<const char*> sources;
+  std::vector<Shape> on_device_shapes;
+  std::vector<int64_t> offsets;
+  std::vector<int64_t> sizes;
+  relaid_literals.reserve(literals.size());
+  int64_t total_bytes = 0;
+  for (const LiteralSlice& literal : literals) {
+    const Shape& shape = literal.shape();
+    if (!shape.IsArray() || !shape.is_static() ||
+        primitive_util::IsSubByteNonPredType(shape.element_type())) {
+      return InvalidArgument(
+          "PackedBuffersFromHostLiterals only supports static arrays without "
+          "sub-byte element types, got %s",
+          shape.ToString());
+    }
+    TF_ASSIGN_OR_RETURN(Shape compact_shape,
+                        transfer_manager->ChooseCompactLayoutForShape(shape));
+    const char* source = static_cast<const char*>(literal.untyped_data());
+    if (!Layout::Equal().MinorToMajorOnly()(compact_shape.layout(),
+                                            shape.layout())) {
+      relaid_literals.push_back(literal.Relayout(compact_shape.layout()));
+      source = static_cast<const char*>(relaid_literals.back().untyped_data());
+    }
+    Shape on_device_shape =
+        transfer_manager->HostShapeToDeviceShape(compact_shape);
+    int64_t size = ShapeUtil::ByteSizeOf(on_device_shape);
+    if (size != literal.size_bytes()) {
+      return InvalidArgument(
+          "PackedBuffersFromHostLiterals can't pack %s with on-device shape %s",
+          shape.ToString(), on_device_shape.ToString());
+    }
+    sources.push_back(source);
+    on_device_shapes.push_back(std::move(on_device_shape));
+    offsets.push_back(total_bytes);
+    sizes.push_back(size);
+    total_bytes +=
+        RoundUpTo<int64_t>(size, tsl::Allocator::kAllocatorAlignment);
+  }
+
+  // Pack the literals into host staging memory, which is pinned on GPU.
+  std::shared_ptr<char> staging_buffer;
+  if (total_bytes > 0) {
+    if (tsl::Allocator* allocator = host_memory_allocator()) {
+      staging_buffer = std::shared_ptr<char>(
+          static_cast<char*>(allocator->AllocateRaw(
+              tsl::Allocator::kAllocatorAlignment, total_bytes)),
+          [allocator](char* ptr) { allocator->DeallocateRaw(ptr); });
+    } else {
+      staging_buffer = std::shared_ptr<char>(
+          static_cast<char*>(tsl::port::AlignedMalloc(
+              total_bytes, tsl::Allocator::kAllocatorAlignment)),
+          [](char* ptr) { tsl::port::AlignedFree(ptr); });
+    }
+    if (staging_buffer == nullptr) {
+      return ResourceExhausted(
+          "Failed to allocate %d bytes of host staging memory for "
+          "PackedBuffersFromHostLiterals",
+          total_bytes);
+    }
+    for (int i = 0; i < sources.size(); ++i) {
+      if (sizes[i] > 0) {
+        std::memcpy(staging_buffer.get() + offsets[i], sources[i], sizes[i]);
+      }
+    }
+  }
+
+  // The device allocation is owned jointly by the returned buffers, and freed
+  // when the last of their TrackedDeviceBuffers is destroyed.
+  TF_ASSIGN_OR_RETURN(
+      se::OwningDeviceMemory owning_memory,
+      allocator()->Allocate(local_device->local_device_id().value(),
+                            total_bytes));
+  auto allocation =
+      std::make_shared<se::OwningDeviceMemory>(std::move(owning_memory));
+  se::DeviceMemoryBase device_memory = allocation->cref();
+
+  se::Stream* h2d_stream = local_device->host_to_device_stream();
+  if (local_device->allocation_model() ==
+      LocalDeviceState::kComputeSynchronized) {
+    TF_RETURN_IF_ERROR(h2d_stream->WaitFor(local_device->compute_stream()));
+  }
+
+  // All buffers share a single definition event for the packed copy.
+  auto definition_event =
+      std::make_shared<BufferSequencingEvent>(this->thread_pool());
+  std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+  std::vector<PjRtStreamExecutorBuffer::ScopedHold> holds;
+  buffers.reserve(literals.size());
+  holds.reserve(literals.size());
+  for (int i = 0; i < literals.size(); ++i) {
+    auto device_buffer = std::make_shared<TrackedDeviceBuffer>(
+        /*allocator=*/nullptr, device,
+        std::initializer_list<se::DeviceMemoryBase>{
+            device_memory.GetByteSlice(offsets[i], sizes[i])},
+        std::initializer_list<std::shared_ptr<BufferSequencingEvent>>{
+            definition_event},
+        /*on_delete_callback=*/[allocation]() {});
+    auto buffer = std::make_unique<PjRtStreamExecutorBuffer>(
+        on_device_shapes[i], std::move(device_buffer), this, device,
+        device->default_memory_space().value_or(nullptr));
+    holds.push_back(buffer->GetBufferWithUsageHold());
+    CHECK(holds.back().ok());
+    buffers.push_back(std::move(buffer));
+  }
+
+  if (total_bytes > 0) {
+    TF_RETURN_IF_ERROR(local_device->ThenMemcpyHostToDevice(
+        &device_memory, staging_buffer.get(), total_bytes));
+  }
+  absl::StatusOr<EventPool::Handle> event_or =
+      local_device->event_pool().ThenAllocateAndRecordEvent(h2d_stream);
+  if (!event_or.ok()) {
+    StallStreamOnError(local_device, h2d_stream);
+    return event_or.status();
+  }
+  definition_event->SetSequencingEvent(std::move(event_or).value(),
+                                       h2d_stream);
+  for (PjRtStreamExecutorBuffer::ScopedHold& hold : holds) {
+    RecordUsage(std::move(hold), local_device, local_device, definition_event,
+                h2d_stream, /*prefer_to_retain_reference=*/false);
+  }
+  TF_RETURN_IF_ERROR(
+      local_device->ThenRelease(h2d_stream, std::move(staging_buffer)));
+  return buffers;
+}
+
 absl::StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
 PjRtStreamExecutorClient::MakeCrossHostReceiveBuffers(
     absl::Span<const Shape> shapes, PjRtDevice* device,
@@ -1615,6 +2098,10 @@ PjRtStreamExecutorBuffer::GetBufferForHoldLocked(ScopedHold::Type type) {
     if (device_buffer_ == nullptr) {
       return InvalidArgument("Donation requested for invalid buffer");
     }
+    if (is_slice_view_) {
+      return InvalidArgument(
+          "Donation requested for a slice view of another buffer");
+    }
     if (holds_[ScopedHold::kExternalReference] > 0) {
       return InvalidArgument(
           "Donation requested for buffer with external reference");
@@ -1828,6 +2315,13 @@ PjRtFuture<> PjRtStreamExecutorBuffer::CopyRawToHostFuture(
   return client_->CopyRawSubBufferToHost(this, dst, offset, transfer_size);
 }
 
+PjRtFuture<> PjRtStreamExecutorBuffer::CopyRawToHostChunked(
+    int64_t chunk_size, int num_staging_chunks, RawChunkCallback on_chunk) {
+  return CopyRawToHostChunkedWithAllocator(chunk_size, num_staging_chunks,
+                                           std::move(on_chunk),
+                                           client_->host_memory_allocator());
+}
+
 absl::StatusOr<ShapedBuffer> PjRtStreamExecutorBuffer::AsShapedBuffer() const {
   absl::MutexLock lock(&mu_);
   if (device_buffer_ == nullptr) {
@@ -2084,6 +2578,82 @@ void PjRtStreamExecutorBuffer::CopyToRemoteDeviceScattered(
   }
 }
 
+absl::Status PjRtStreamExecutorBuffer::Relocate() {
+  tsl::profiler::TraceMe trace_me("PjRtStreamExecutorBuffer::Relocate");
+  if (on_device_shape_.IsTuple()) {
+    return Unimplemented("Relocate is not supported for tuple buffers");
+  }
+  LocalDeviceState* local_device = device_->local_device_state();
+  se::Stream* stream = local_device->compute_stream();
+
+  absl::MutexLock lock(&mu_);
+  // We can't perform any other action while a donation hold is in progress.
+  WaitForOutstandingDonationHold();
+  if (device_buffer_ == nullptr) {
+    return InvalidArgument("Relocate called on deleted or donated buffer");
+  }
+  if (holds_[ScopedHold::kUsage] > 0 ||
+      holds_[ScopedHold::kExternalReference] > 0) {
+    return FailedPrecondition(
+        "Relocate called on a buffer with outstanding holds");
+  }
+  se::DeviceMemoryAllocator* allocator = device_buffer_->allocator();
+  if (allocator == nullptr) {
+    return FailedPrecondition(
+        "Relocate called on a buffer that doesn't own its device memory");
+  }
+  for (const auto& event : device_buffer_->definition_events()) {
+    if (!event->IsDefined() || event->IsPredeterminedError()) {
+      return FailedPrecondition("Relocate called on a buffer that isn't ready");
+    }
+  }
+  CHECK_EQ(device_buffer_->device_memory().size(), 1);
+  const se::DeviceMemoryBase& src = device_buffer_->device_memory()[0];
+  if (src.size() == 0) {
+    return absl::OkStatus();
+  }
+
+  int memory_space = on_device_shape_.has_layout()
+                         ? on_device_shape_.layout().memory_space()
+                         : 0;
+  TF_ASSIGN_OR_RETURN(
+      se::OwningDeviceMemory dst,
+      allocator->Allocate(local_device->local_device_id().value(), src.size(),
+                          /*retry_on_failure=*/false, memory_space));
+
+  // The copy must follow the definition of the buffer, and the old memory may
+  // only be freed once all uses on other streams have completed.
+  for (const auto& event : device_buffer_->definition_events()) {
+    event->WaitForEventOnStream(stream);
+  }
+  for (const auto& stream_and_event : device_buffer_->usage_events()) {
+    stream_and_event.event->WaitForEventOnStream(stream);
+  }
+  se::DeviceMemoryBase dst_memory = dst.cref();
+  TF_RETURN_IF_ERROR(stream->MemcpyD2D(&dst_memory, src, src.size()));
+
+  auto definition_event =
+      std::make_shared<BufferSequencingEvent>(client_->thread_pool());
+  absl::StatusOr<EventPool::Handle> event_or =
+      local_device->event_pool().ThenAllocateAndRecordEvent(stream);
+  if (!event_or.ok()) {
+    StallStreamOnError(local_device, stream);
+    return event_or.status();
+  }
+  definition_event->SetSequencingEvent(std::move(event_or).value(), stream);
+
+  std::shared_ptr<TrackedDeviceBuffer> old_buffer = std::move(device_buffer_);
+  old_buffer->LockUseAndTransferUsageEvents();
+  device_buffer_ = std::make_shared<TrackedDeviceBuffer>(
+      allocator, device_,
+      std::initializer_list<se::DeviceMemoryBase>{dst.Release()},
+      absl::MakeSpan(&definition_event, 1),
+      /*on_delete_callback=*/nullptr);
+  return local_device->ThenExecuteCallback(stream, [old_buffer]() {
+    // Drops old_buffer shared pointer.
+  });
+}
+
 PjRtFuture<> PjRtStreamExecutorBuffer::GetReadyFuture() {
   std::shared_ptr<TrackedDeviceBuffer> device_buffer;
   PjRtFuture<>::Promise definition_promise;
@@ -2357,6 +2927,22 @@ PjRtStreamExecutorLoadedExecutable::PjRtStreamExecutorLoadedExecutable(
     std::vector<LogicalDeviceIds> addressable_device_logical_ids,
     std::vector<PjRtDevice*> addressable_devices,
     PjRtStreamExecutorClient* client)
+    : PjRtStreamExecutorLoadedExecutable(
+          std::vector<std::shared_ptr<LocalExecutable>>(
+              std::make_move_iterator(executables.begin()),
+              std::make_move_iterator(executables.end())),
+          parameter_is_tupled_arguments, std::move(device_assignment),
+          std::move(compile_options), std::move(addressable_device_logical_ids),
+          std::move(addressable_devices), client) {}
+
+PjRtStreamExecutorLoadedExecutable::PjRtStreamExecutorLoadedExecutable(
+    std::vector<std::shared_ptr<LocalExecutable>> executables,
+    bool parameter_is_tupled_arguments,
+    std::shared_ptr<DeviceAssignment> device_assignment,
+    CompileOptions compile_options,
+    std::vector<LogicalDeviceIds> addressable_device_logical_ids,
+    std::vector<PjRtDevice*> addressable_devices,
+    PjRtStreamExecutorClient* client)
     : client_(client),
       device_assignment_(std::move(device_assignment)),
       compile_options_(std::move(compile_options)),
@@ -2385,6 +2971,7 @@ PjRtStreamExecutorLoadedExecutable::PjRtStreamExecutorLoadedExecutable(
         std::move(parameter_shapes));
   }
   fingerprint_ = absl::StrCat(fingerprint.low64, fingerprint.high64);
+  metrics_ = std::make_shared<metrics::ExecutableMetrics>(fingerprint_);
 
   int num_partitions;
   if (device_assignment_ == nullptr) {
@@ -2911,8 +3498,19 @@ PjRtStreamExecutorLoadedExecutable::EnqueueExecution(
   std::shared_ptr<Semaphore::ScopedReservation> compute_reservation;
   {
     tsl::profiler::TraceMe traceme("ComputeSemaphoreAcquire");
-    compute_reservation = std::make_shared<Semaphore::ScopedReservation>(
-        device_state->compute_semaphore().ScopedAcquire(1));
+    Semaphore* compute_semaphore = &device_state->compute_semaphore();
+    const int device_id = device->id();
+    compute_reservation = std::shared_ptr<Semaphore::ScopedReservation>(
+        new Semaphore::ScopedReservation(compute_semaphore->ScopedAcquire(1)),
+        [compute_semaphore, device_id](Semaphore::ScopedReservation* r) {
+          delete r;
+          metrics::RecordDeviceExecuteQueueDepth(
+              device_id,
+              compute_semaphore->capacity() - compute_semaphore->available());
+        });
+    metrics::RecordDeviceExecuteQueueDepth(
+        device_id,
+        compute_semaphore->capacity() - compute_semaphore->available());
   }
 
   absl::StatusOr<ExecutionOutput> result_buffer_or_status =
@@ -3136,15 +3734,27 @@ PjRtStreamExecutorLoadedExecutable::ExecuteHelper(
     compute_callbacks.push_back(
         [promise = std::move(promise)]() mutable { promise.Set(); });
   }
-  TF_RETURN_IF_ERROR(device_state->ThenExecuteCallback(
+  compute_callbacks.push_back([metrics = metrics_, start_time_usecs]() {
+    metrics->RecordExecutionCompleted(tsl::Env::Default()->NowMicros() -
+                                      start_time_usecs);
+  });
+  const uint64_t enqueue_time_usecs =
+      tsl::Env::Default()->NowMicros() - start_time_usecs;
+  metrics_->RecordExecutionEnqueued(enqueue_time_usecs);
+  absl::Status callback_status = device_state->ThenExecuteCallback(
       stream, [callbacks{std::move(compute_callbacks)},
                buffers_to_release{std::move(buffers_to_release)}]() {
         for (auto& fn : callbacks) {
           fn();
         }
-      }));
-  metrics::ReportExecutableEnqueueTime(tsl::Env::Default()->NowMicros() -
-                                       start_time_usecs);
+      });
+  if (!callback_status.ok()) {
+    // The completion callback will never run, so it can't retire the
+    // execution from the in-flight count.
+    metrics_->RecordExecutionAborted();
+    return callback_status;
+  }
+  metrics::ReportExecutableEnqueueTime(enqueue_time_usecs);
   return Result({/*future=*/std::move(future), /*buffers=*/std::move(outputs)});
 }
 
@@ -3486,6 +4096,120 @@ PjRtStreamExecutorClient::GetExecutableExtras(CompileOptions* options) {
   return extras;
 }
 
+namespace {
+
+// Returns the key of a compilation in the compile cache, or std::nullopt if
+// the compilation can't be cached. Must be called before the layout
+// canonicalization callback is set on `options`.
+std::optional<std::string> CompileCacheKey(
+    const XlaComputation& computation,
+    const std::vector<const Shape*>& argument_layout_pointers,
+    const CompileOptions& options, bool has_layout_canonicalization_callback) {
+  absl::StatusOr<CompileOptionsProto> options_proto = options.ToProto();
+  if (!options_proto.ok()) {
+    VLOG(2) << "Not caching compilation: " << options_proto.status();
+    return std::nullopt;
+  }
+  std::string serialized_computation;
+  std::string serialized_options;
+  if (!tsl::SerializeToStringDeterministic(computation.proto(),
+                                           &serialized_computation) ||
+      !tsl::SerializeToStringDeterministic(*options_proto,
+                                           &serialized_options)) {
+    return std::nullopt;
+  }
+  tsl::Fprint128 fingerprint =
+      tsl::FingerprintCat128(tsl::Fingerprint128(serialized_computation),
+                             tsl::Fingerprint128(serialized_options));
+  for (const Shape* shape : argument_layout_pointers) {
+    fingerprint = tsl::FingerprintCat128(
+        fingerprint,
+        tsl::Fingerprint128(shape->ToString(/*print_layout=*/true)));
+  }
+  // The halves of the fingerprint are separated, so that keys of different
+  // fingerprints can't run into each other.
+  return absl::StrCat(fingerprint.high64, "_", fingerprint.low64,
+                      has_layout_canonicalization_callback ? "_canonical" : "");
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<std::shared_ptr<LocalExecutable>>>
+PjRtStreamExecutorClient::CompileLocalExecutables(
+    const XlaComputation& computation,
+    const std::vector<const Shape*>& argument_layout_pointers,
+    const ExecutableBuildOptions& build_options,
+    std::optional<std::string> cache_key) {
+  auto compile = [&]()
+      -> absl::StatusOr<std::vector<std::shared_ptr<LocalExecutable>>> {
+    TF_ASSIGN_OR_RETURN(
+        std::vector<std::unique_ptr<LocalExecutable>> local_executables,
+        client()->Compile(computation, argument_layout_pointers,
+                          build_options));
+    return std::vector<std::shared_ptr<LocalExecutable>>(
+        std::make_move_iterator(local_executables.begin()),
+        std::make_move_iterator(local_executables.end()));
+  };
+  if (!cache_key.has_value()) {
+    return compile();
+  }
+
+  CompileCacheEntry* entry;
+  {
+    absl::MutexLock lock(&compile_cache_mu_);
+    // Pointers into a node_hash_map stay valid until the entry is erased,
+    // which never happens to an entry that is in flight or waited on.
+    entry = &compile_cache_[*cache_key];
+    if (entry->in_flight) {
+      ++entry->waiters;
+      while (entry->in_flight) {
+        entry->compilation_done_cv.Wait(&compile_cache_mu_);
+      }
+      --entry->waiters;
+      if (!entry->status.ok()) {
+        return entry->status;
+      }
+    }
+    std::vector<std::shared_ptr<LocalExecutable>> executables;
+    executables.reserve(entry->executables.size());
+    for (const std::weak_ptr<LocalExecutable>& executable :
+         entry->executables) {
+      if (std::shared_ptr<LocalExecutable> alive = executable.lock()) {
+        executables.push_back(std::move(alive));
+      }
+    }
+    if (!executables.empty() &&
+        executables.size() == entry->executables.size()) {
+      VLOG(1) << "Reusing the executables of an earlier compilation";
+      return executables;
+    }
+    entry->in_flight = true;
+  }
+
+  absl::StatusOr<std::vector<std::shared_ptr<LocalExecutable>>> executables =
+      compile();
+
+  absl::MutexLock lock(&compile_cache_mu_);
+  entry->in_flight = false;
+  entry->status = executables.status();
+  entry->executables.clear();
+  if (executables.ok()) {
+    entry->executables.assign(executables->begin(), executables->end());
+  }
+  entry->compilation_done_cv.SignalAll();
+  // Drop the entries of programs that nothing holds on to anymore, so that the
+  // cache doesn't grow with every program the client ever compiled.
+  absl::erase_if(compile_cache_, [](const auto& key_and_entry) {
+    const CompileCacheEntry& cached = key_and_entry.second;
+    return !cached.in_flight && cached.waiters == 0 &&
+           absl::c_all_of(cached.executables,
+                          [](const std::weak_ptr<LocalExecutable>& executable) {
+                            return executable.expired();
+                          });
+  });
+  return executables;
+}
+
 absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>>
 PjRtStreamExecutorClient::CompileInternal(
     const XlaComputation& computation,
@@ -3510,6 +4234,10 @@ PjRtStreamExecutorClient::CompileInternal(
       addressable_device_logical_ids = extras.addressable_device_logical_ids;
   std::vector<PjRtDevice*>& addressable_devices = extras.addressable_devices;
 
+  std::optional<std::string> cache_key =
+      CompileCacheKey(computation, argument_layout_pointers, options,
+                      layout_canonicalization_callback != nullptr);
+
   // It is important to set the canonicalization callback after creating
   // a copy of the options so that the executable's options remain without
   // the callback - the callback would break the executable's serializability.
@@ -3519,9 +4247,10 @@ PjRtStreamExecutorClient::CompileInternal(
   }
 
   TF_ASSIGN_OR_RETURN(
-      std::vector<std::unique_ptr<LocalExecutable>> local_executables,
-      client()->Compile(computation, argument_layout_pointers,
-                        options.executable_build_options));
+      std::vector<std::shared_ptr<LocalExecutable>> local_executables,
+      CompileLocalExecutables(computation, argument_layout_pointers,
+                              options.executable_build_options,
+                              std::move(cache_key)));
 
   auto executable = std::make_unique<PjRtStreamExecutorLoadedExecutable>(
       std::move(local_executables), options.parameter_is_tupled_arguments,
@@ -3534,9 +4263,9 @@ PjRtStreamExecutorClient::CompileInternal(
   return std::unique_ptr<PjRtLoadedExecutable>(std::move(executable));
 }
 
-absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>>
-PjRtStreamExecutorClient::Compile(mlir::ModuleOp module,
-                                  CompileOptions options) {
+absl::StatusOr<PjRtStreamExecutorClient::CompileFn>
+PjRtStreamExecutorClient::PrepareCompile(mlir::ModuleOp module,
+                                         CompileOptions options) {
   XlaComputation xla_computation;
   const ExecutableBuildOptions& exec_build_options =
       options.executable_build_options;
@@ -3548,7 +4277,10 @@ PjRtStreamExecutorClient::Compile(mlir::ModuleOp module,
   // If the compile options specify argument layout, then let's
   // fall back to using the options to determine layouts.
   if (options.argument_layouts) {
-    return Compile(xla_computation, options);
+    return CompileFn([this, xla_computation = std::move(xla_computation),
+                      options = std::move(options)]() mutable {
+      return Compile(xla_computation, std::move(options));
+    });
   }
 
   TF_ASSIGN_OR_RETURN(std::vector<LayoutMode> arg_layout_modes,
@@ -3560,24 +4292,6 @@ PjRtStreamExecutorClient::Compile(mlir::ModuleOp module,
   TF_ASSIGN_OR_RETURN(std::vector<MemorySpaceColor> out_memory_spaces,
                       GetOutputMemoryKinds(module));
 
-  // If auto-sharding modifies shapes of arguments and/or result,
-  // we get a callback to restore the layouts. Let us restore the layouts
-  // according to the attributes we parsed from MLIR.
-  auto layout_callback = [local_client = client(), &arg_layout_modes,
-                          &out_layout_modes, &arg_memory_spaces,
-                          &out_memory_spaces](const HloModule& module)
-      -> absl::StatusOr<std::pair<std::vector<Shape>, Shape>> {
-    XlaComputation xla_computation(XlaComputation(module.ToProto()));
-    return LayoutModesToXlaShapes(
-        xla_computation, arg_layout_modes, out_layout_modes, arg_memory_spaces,
-        out_memory_spaces,
-        [local_client](Shape shape) -> absl::StatusOr<Shape> {
-          return local_client->backend()
-              .transfer_manager()
-              ->ChooseCompactLayoutForShape(shape);
-        });
-  };
-
   // This call will update result_layout in options.executable_build_options.
   TF_ASSIGN_OR_RETURN(auto arg_layouts_and_pointers,
                       LayoutModesToXla(
@@ -3591,8 +4305,43 @@ PjRtStreamExecutorClient::Compile(mlir::ModuleOp module,
                           },
                           options.executable_build_options));
 
-  return CompileInternal(xla_computation, arg_layouts_and_pointers.second,
-                         layout_callback, options);
+  // Moving the layouts keeps the pointers to them valid.
+  return CompileFn([this, xla_computation = std::move(xla_computation),
+                    arg_layout_modes = std::move(arg_layout_modes),
+                    out_layout_modes = std::move(out_layout_modes),
+                    arg_memory_spaces = std::move(arg_memory_spaces),
+                    out_memory_spaces = std::move(out_memory_spaces),
+                    arg_layouts_and_pointers =
+                        std::move(arg_layouts_and_pointers),
+                    options = std::move(options)]() mutable {
+    // If auto-sharding modifies shapes of arguments and/or result,
+    // we get a callback to restore the layouts. Let us restore the layouts
+    // according to the attributes we parsed from MLIR.
+    auto layout_callback = [local_client = client(), &arg_layout_modes,
+                            &out_layout_modes, &arg_memory_spaces,
+                            &out_memory_spaces](const HloModule& module)
+        -> absl::StatusOr<std::pair<std::vector<Shape>, Shape>> {
+      XlaComputation xla_computation(XlaComputation(module.ToProto()));
+      return LayoutModesToXlaShapes(
+          xla_computation, arg_layout_modes, out_layout_modes,
+          arg_memory_spaces, out_memory_spaces,
+          [local_client](Shape shape) -> absl::StatusOr<Shape> {
+            return local_client->backend()
+                .transfer_manager()
+                ->ChooseCompactLayoutForShape(shape);
+          });
+    };
+    return CompileInternal(xla_computation, arg_layouts_and_pointers.second,
+                           layout_callback, std::move(options));
+  });
+}
+
+absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>>
+PjRtStreamExecutorClient::Compile(mlir::ModuleOp module,
+                                  CompileOptions options) {
+  TF_ASSIGN_OR_RETURN(CompileFn compile,
+                      PrepareCompile(module, std::move(options)));
+  return std::move(compile)();
 }
 
 absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>>
@@ -3613,6 +4362,38 @@ PjRtStreamExecutorClient::Compile(const XlaComputation& computation,
                          options);
 }
 
+PjRtFuture<std::unique_ptr<PjRtLoadedExecutable>>
+PjRtStreamExecutorClient::ScheduleCompile(CompileFn compile) {
+  auto promise =
+      PjRtFuture<std::unique_ptr<PjRtLoadedExecutable>>::CreatePromise();
+  // tsl::thread::ThreadPool::Schedule wants a copyable function.
+  auto shared_compile = std::make_shared<CompileFn>(std::move(compile));
+  thread_pool()->Schedule([promise, shared_compile]() mutable {
+    promise.Set(std::move(*shared_compile)());
+  });
+  return PjRtFuture<std::unique_ptr<PjRtLoadedExecutable>>(std::move(promise));
+}
+
+PjRtFuture<std::unique_ptr<PjRtLoadedExecutable>>
+PjRtStreamExecutorClient::CompileAsync(XlaComputation computation,
+                                       CompileOptions options) {
+  return ScheduleCompile([this, computation = std::move(computation),
+                          options = std::move(options)]() mutable {
+    return Compile(computation, std::move(options));
+  });
+}
+
+PjRtFuture<std::unique_ptr<PjRtLoadedExecutable>>
+PjRtStreamExecutorClient::CompileAsync(mlir::ModuleOp module,
+                                       CompileOptions options) {
+  absl::StatusOr<CompileFn> compile =
+      PrepareCompile(module, std::move(options));
+  if (!compile.ok()) {
+    return PjRtFuture<std::unique_ptr<PjRtLoadedExecutable>>(compile.status());
+  }
+  return ScheduleCompile(*std::move(compile));
+}
+
 absl::StatusOr<std::string> PjRtStreamExecutorClient::SerializeExecutable(
     const PjRtLoadedExecutable& executable) const {
   const PjRtStreamExecutorLoadedExecutable* se_executable =
@@ -32,6 +32,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
@@ -49,6 +50,7 @@ limitations under the License.
 #include "xla/layout.h"
 #include "xla/literal.h"
 #include "xla/pjrt/local_device_state.h"
+#include "xla/pjrt/metrics.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_common.h"
 #include "xla/pjrt/pjrt_compiler.h"
@@ -186,6 +188,12 @@ class PjRtStreamExecutorDevice : public PjRtDevice {
   // is not local to this host.
   absl::StatusOr<LocalDeviceState*> GetLocalDeviceState() const;
 
+  // Returns a future that becomes ready once the device has room for another
+  // in-flight computation, i.e. once Execute would not block on the device's
+  // limit. Callers that must not block can chain their Execute call on it to
+  // apply backpressure.
+  PjRtFuture<> WaitForExecuteCapacity() const;
+
   absl::Status TransferToInfeed(const LiteralSlice& literal) override;
 
   absl::Status TransferFromOutfeed(MutableBorrowingLiteral literal) override;
@@ -249,6 +257,8 @@ class PjRtStreamExecutorMemorySpace : public PjRtMemorySpace {
   std::string to_string_;
 };
 
+class PjRtStreamExecutorBuffer;
+
 class PjRtStreamExecutorClient : public PjRtClient {
  public:
   // `allocator` may null, in which case the platform default allocator is used.
@@ -308,6 +318,15 @@ class PjRtStreamExecutorClient : public PjRtClient {
   absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>> Compile(
       mlir::ModuleOp mlir_module, CompileOptions options) override;
 
+  // Compiles on the client's thread pool. A `mlir_module` is lowered to HLO
+  // before returning, so the caller may destroy it right away. Compiles of the
+  // same program with the same options share a single compilation, see
+  // `compile_cache_`.
+  PjRtFuture<std::unique_ptr<PjRtLoadedExecutable>> CompileAsync(
+      XlaComputation computation, CompileOptions options);
+  PjRtFuture<std::unique_ptr<PjRtLoadedExecutable>> CompileAsync(
+      mlir::ModuleOp mlir_module, CompileOptions options);
+
   virtual absl::StatusOr<std::string> SerializeExecutable(
       const PjRtLoadedExecutable& executable) const;
 
@@ -378,6 +397,29 @@ class PjRtStreamExecutorClient : public PjRtClient {
   absl::StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromHostLiteral(
       const LiteralSlice& literal, PjRtMemorySpace* memory_space) override;
 
+  // Copies each of `buffers` into the literal at the same index in `literals`.
+  // Array buffers whose on-device shape matches the shape of their literal are
+  // batched per device: they are copied into a single host staging allocation
+  // with one completion event and one host callback, and then scattered into
+  // the literals. All other buffers are copied with ToLiteral. The returned
+  // future becomes ready once all literals are populated.
+  PjRtFuture<> BuffersToLiterals(
+      absl::Span<PjRtBuffer* const> buffers,
+      absl::Span<MutableLiteralBase* const> literals);
+
+  // Transfers `literals` to `device` with a single host-to-device copy. The
+  // literals are packed into one host staging allocation and copied into one
+  // device allocation, and each returned buffer is a slice of it. The device
+  // allocation is freed once all of the returned buffers are deleted. All
+  // literals must be arrays with static shapes and without sub-byte element
+  // types. The literals may be freed as soon as the call returns.
+  //
+  // Like buffers created by CreateViewOfDeviceBuffer, the returned buffers
+  // don't own their device memory and can't be donated to an execution.
+  absl::StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+  PackedBuffersFromHostLiterals(absl::Span<const LiteralSlice> literals,
+                                PjRtDevice* device);
+
   absl::StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
   MakeCrossHostReceiveBuffers(absl::Span<const Shape> shapes,
                               PjRtDevice* device,
@@ -477,6 +519,35 @@ class PjRtStreamExecutorClient : public PjRtClient {
       LayoutCanonicalizationCallback layout_canonicalization_callback,
       CompileOptions options);
 
+  using CompileFn = absl::AnyInvocable<
+      absl::StatusOr<std::unique_ptr<PjRtLoadedExecutable>>() &&>;
+
+  // Lowers `mlir_module` to HLO and resolves its layout modes. The returned
+  // function finishes the compilation and does not refer to `mlir_module`.
+  absl::StatusOr<CompileFn> PrepareCompile(mlir::ModuleOp mlir_module,
+                                           CompileOptions options);
+
+  // Runs `compile` on the client's thread pool.
+  PjRtFuture<std::unique_ptr<PjRtLoadedExecutable>> ScheduleCompile(
+      CompileFn compile);
+
+  // Returns the LocalExecutables for `computation`, reusing the ones of an
+  // earlier compilation with the same `cache_key` while they are still alive,
+  // and waiting for a compilation of the same key already in flight.
+  absl::StatusOr<std::vector<std::shared_ptr<LocalExecutable>>>
+  CompileLocalExecutables(
+      const XlaComputation& computation,
+      const std::vector<const Shape*>& argument_layout_pointers,
+      const ExecutableBuildOptions& build_options,
+      std::optional<std::string> cache_key);
+
+  // Batched copy of `buffers`, which must all live on `device`, into
+  // `literals`. See BuffersToLiterals.
+  PjRtFuture<> BatchedBuffersToLiterals(
+      PjRtStreamExecutorDevice* device,
+      absl::Span<PjRtStreamExecutorBuffer* const> buffers,
+      absl::Span<MutableLiteralBase* const> literals);
+
   absl::StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromHostBufferInternal(
       const void* data, PrimitiveType type, absl::Span<int64_t const> dims,
       std::optional<absl::Span<int64_t const>> byte_strides,
@@ -521,8 +592,25 @@ class PjRtStreamExecutorClient : public PjRtClient {
 
   tsl::thread::ThreadPool thread_pool_;
 
-  absl::Mutex transpose_mu_;
-  TransposePlanCache transpose_cache_ ABSL_GUARDED_BY(transpose_mu_);
+  TransposePlanCache transpose_cache_;
+
+  // LocalExecutables of earlier compilations, keyed by a fingerprint of the
+  // computation, the compile options and the argument layouts. Entries only
+  // hold weak references, so an executable is reused while some
+  // PjRtLoadedExecutable still owns it and recompiled afterwards.
+  struct CompileCacheEntry {
+    bool in_flight = false;
+    // Number of requests waiting for the compilation in flight.
+    int waiters = 0;
+    // Status of the last compilation, handed to the requests that waited for
+    // it if it failed.
+    absl::Status status;
+    std::vector<std::weak_ptr<LocalExecutable>> executables;
+    absl::CondVar compilation_done_cv;
+  };
+  absl::Mutex compile_cache_mu_;
+  absl::node_hash_map<std::string, CompileCacheEntry> compile_cache_
+      ABSL_GUARDED_BY(compile_cache_mu_);
 };
 
 // Converts a 2D set of Device objects indexed by [replica][partition] into an
@@ -738,6 +826,9 @@ class PjRtStreamExecutorBuffer : public PjRtBuffer {
   absl::StatusOr<std::unique_ptr<ExternalReference>>
   ReleaseDeviceMemoryOwnership(bool wait_for_operations_to_complete) override;
 
+  absl::StatusOr<std::unique_ptr<PjRtBuffer>> CreateSliceView(
+      int64_t start, int64_t limit) override;
+
   using PjRtBuffer::ToLiteralSync;
   PjRtFuture<> ToLiteral(MutableLiteralBase* literal) override;
   PjRtFuture<> LazyToLiteral(
@@ -752,6 +843,11 @@ class PjRtStreamExecutorBuffer : public PjRtBuffer {
   PjRtFuture<> CopyRawToHostFuture(PjRtFuture<void*> dst, int64_t offset,
                                    int64_t transfer_size) override;
 
+  // Stages chunks through the client's host memory allocator, which is pinned
+  // on GPU.
+  PjRtFuture<> CopyRawToHostChunked(int64_t chunk_size, int num_staging_chunks,
+                                    RawChunkCallback on_chunk) override;
+
   // Drops the buffer's reference to its associated device memory, leaving the
   // buffer in an invalid state. The memory will be freed lazily when all async
   // operations using the buffer have completed, according to the allocation
@@ -818,6 +914,17 @@ class PjRtStreamExecutorBuffer : public PjRtBuffer {
   absl::StatusOr<std::unique_ptr<PjRtBuffer>> DonateWithControlDependency(
       PjRtFuture<> dependency) override;
 
+  // Moves the contents of the buffer to newly allocated device memory, e.g. to
+  // defragment the device allocator by moving buffers out of fragmented
+  // regions. The buffer keeps its identity; its old device memory is freed
+  // once the copy and all outstanding uses have completed on the compute
+  // stream.
+  //
+  // Only buffers that own their memory, aren't tuples, are fully defined and
+  // have no usage holds or external references can be relocated. Returns
+  // FailedPrecondition otherwise, in which case the buffer is unchanged.
+  absl::Status Relocate();
+
  private:
   friend class PjRtClient;
 
@@ -873,6 +980,9 @@ class PjRtStreamExecutorBuffer : public PjRtBuffer {
   const Shape on_device_shape_;
   PjRtStreamExecutorDevice* const device_;
   PjRtMemorySpace* const memory_space_;
+  // True if the buffer was created by CreateSliceView() and aliases part of
+  // another buffer's memory. Such buffers can't be donated.
+  bool is_slice_view_ = false;
 
   mutable absl::Mutex mu_;
   std::shared_ptr<TrackedDeviceBuffer> device_buffer_ ABSL_GUARDED_BY(mu_);
@@ -913,6 +1023,16 @@ class PjRtStreamExecutorLoadedExecutable : public PjRtLoadedExecutable {
       std::vector<LogicalDeviceIds> addressable_device_logical_ids,
       std::vector<PjRtDevice*> addressable_devices,
       PjRtStreamExecutorClient* client);
+  // As above, for LocalExecutables that may be shared with other
+  // PjRtStreamExecutorLoadedExecutables compiled from the same program.
+  PjRtStreamExecutorLoadedExecutable(
+      std::vector<std::shared_ptr<LocalExecutable>> executables,
+      bool parameter_is_tupled_arguments,
+      std::shared_ptr<DeviceAssignment> device_assignment,
+      CompileOptions compile_options,
+      std::vector<LogicalDeviceIds> addressable_device_logical_ids,
+      std::vector<PjRtDevice*> addressable_devices,
+      PjRtStreamExecutorClient* client);
 
   ~PjRtStreamExecutorLoadedExecutable() override = default;
 
@@ -1092,6 +1212,10 @@ class PjRtStreamExecutorLoadedExecutable : public PjRtLoadedExecutable {
   // unique_ptrs to play well with the Python bindings (see xla.cc).
   std::vector<PjRtDevice*> addressable_devices_;
   std::string fingerprint_;
+
+  // Execution metrics keyed by fingerprint_. Shared with the compute callbacks
+  // that record completed executions, which may outlive the executable.
+  std::shared_ptr<metrics::ExecutableMetrics> metrics_;
 };
 
 }  // namespace xla
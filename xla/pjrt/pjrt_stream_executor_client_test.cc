@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "xla/pjrt/pjrt_stream_executor_client.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,9 +27,11 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "xla/client/client_library.h"
 #include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
 #include "xla/literal.h"
 #include "xla/literal_comparison.h"
 #include "xla/literal_util.h"
+#include "xla/pjrt/local_device_state.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_future.h"
 #include "xla/service/platform_util.h"
@@ -42,7 +46,9 @@ limitations under the License.
 namespace xla {
 namespace {
 
-absl::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient() {
+absl::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient(
+    std::optional<LocalDeviceState::StreamOptions> stream_options =
+        std::nullopt) {
   LocalClient* local_client = xla::ClientLibrary::LocalClientOrDie();
   TF_ASSIGN_OR_RETURN(se::Platform * platform,
                       PlatformUtil::GetPlatform("Host"));
@@ -51,7 +57,8 @@ absl::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient() {
   auto device_state = std::make_unique<LocalDeviceState>(
       executor, local_client, LocalDeviceState::kSynchronous,
       /*max_inflight_computations=*/32,
-      /*allow_event_reuse=*/false, /*use_callback_stream=*/false);
+      /*allow_event_reuse=*/false, /*use_callback_stream=*/false,
+      /*device_ordinal=*/-1, stream_options);
   auto device = std::make_unique<PjRtStreamExecutorDevice>(
       0, std::move(device_state), "cpu");
   std::vector<std::unique_ptr<PjRtStreamExecutorDevice>> devices;
@@ -161,5 +168,93 @@ TEST(PjRtStreamExecutorClientTest, DonateWithControlDependency) {
   TF_ASSERT_OK(literal_comparison::Equal(literal, *result_literal));
 }
 
+TEST(PjRtStreamExecutorClientTest, StripedHostToDeviceTransfer) {
+  LocalDeviceState::StreamOptions stream_options;
+  stream_options.num_host_to_device_streams = 4;
+  stream_options.host_to_device_stripe_bytes = 4096;
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient(stream_options));
+
+  // Transfer a buffer that is split into four chunks, the last one shorter.
+  std::vector<float> data(3 * 4096 + 17);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<float>(i);
+  }
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> buffer,
+      client->BufferFromHostBuffer(
+          data.data(), F32, {static_cast<int64_t>(data.size())},
+          /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableUntilTransferCompletes,
+          /*on_done_with_host_buffer=*/nullptr,
+          client->addressable_devices()[0]));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                          buffer->ToLiteralSync());
+  TF_ASSERT_OK(literal_comparison::Equal(LiteralUtil::CreateR1<float>(data),
+                                         *literal));
+}
+
+XlaComputation AddComputation(const Shape& shape) {
+  XlaBuilder builder("Add");
+  Add(Parameter(&builder, 0, shape, "a"), Parameter(&builder, 1, shape, "b"));
+  return builder.Build().value();
+}
+
+LocalExecutable* GetLocalExecutable(PjRtLoadedExecutable& executable) {
+  return static_cast<PjRtStreamExecutorLoadedExecutable&>(executable)
+      .executables()[0]
+      .get();
+}
+
+TEST(PjRtStreamExecutorClientTest, CompileReusesLiveExecutables) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  Shape shape = ShapeUtil::MakeShape(F32, {4});
+  XlaComputation computation = AddComputation(shape);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto first,
+                          client->Compile(computation, CompileOptions()));
+  TF_ASSERT_OK_AND_ASSIGN(auto second,
+                          client->Compile(computation, CompileOptions()));
+  EXPECT_EQ(GetLocalExecutable(*first), GetLocalExecutable(*second));
+
+  CompileOptions other_options;
+  other_options.executable_build_options.mutable_debug_options()
+      ->set_xla_backend_optimization_level(0);
+  TF_ASSERT_OK_AND_ASSIGN(auto third,
+                          client->Compile(computation, other_options));
+  EXPECT_NE(GetLocalExecutable(*first), GetLocalExecutable(*third));
+}
+
+TEST(PjRtStreamExecutorClientTest, CompileAsync) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  Shape shape = ShapeUtil::MakeShape(F32, {4});
+
+  std::vector<PjRtFuture<std::unique_ptr<PjRtLoadedExecutable>>> futures;
+  for (int i = 0; i < 4; ++i) {
+    futures.push_back(
+        client->CompileAsync(AddComputation(shape), CompileOptions()));
+  }
+  std::vector<std::unique_ptr<PjRtLoadedExecutable>> executables;
+  for (auto& future : futures) {
+    TF_ASSERT_OK_AND_ASSIGN(executables.emplace_back(), future.Await());
+  }
+  for (auto& executable : executables) {
+    EXPECT_EQ(GetLocalExecutable(*executable),
+              GetLocalExecutable(*executables[0]));
+  }
+
+  auto literal = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostLiteral(literal, client->addressable_devices()[0]));
+  TF_ASSERT_OK_AND_ASSIGN(auto results, executables.back()->Execute(
+                                            {{buffer.get(), buffer.get()}},
+                                            /*options=*/{}));
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> result,
+                          results[0][0]->ToLiteralSync());
+  TF_ASSERT_OK(literal_comparison::Equal(
+      LiteralUtil::CreateR1<float>({2, 4, 6, 8}), *result));
+}
+
 }  // namespace
 }  // namespace xla
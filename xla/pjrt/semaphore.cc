@@ -16,9 +16,14 @@ limitations under the License.
 #include "xla/pjrt/semaphore.h"
 
 #include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
 
+#include "absl/functional/any_invocable.h"
 #include "absl/synchronization/mutex.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 
@@ -55,8 +60,45 @@ bool Semaphore::TryAcquire(int64_t amount) {
 
 void Semaphore::Release(int64_t amount) {
   CHECK_GE(amount, 0);
-  absl::MutexLock lock(&mu_);
-  value_ += amount;
+  std::vector<Waiter> ready;
+  {
+    absl::MutexLock lock(&mu_);
+    value_ += amount;
+    // Waiters are woken in order; a waiter that needs more units than are
+    // available holds back the ones registered after it.
+    auto it = waiters_.begin();
+    while (it != waiters_.end() && it->amount <= value_) {
+      ready.push_back(std::move(*it));
+      ++it;
+    }
+    waiters_.erase(waiters_.begin(), it);
+  }
+  for (auto& waiter : ready) {
+    Schedule(std::move(waiter));
+  }
+}
+
+void Semaphore::OnAvailable(int64_t amount, tsl::thread::ThreadPool* executor,
+                            absl::AnyInvocable<void() &&> callback) {
+  CHECK_GE(amount, 0);
+  CHECK_LE(amount, max_capacity_);
+  CHECK(executor != nullptr);
+  Waiter waiter{amount, executor, std::move(callback)};
+  {
+    absl::MutexLock lock(&mu_);
+    if (value_ < amount || !waiters_.empty()) {
+      waiters_.push_back(std::move(waiter));
+      return;
+    }
+  }
+  Schedule(std::move(waiter));
+}
+
+void Semaphore::Schedule(Waiter waiter) {
+  // ThreadPool::Schedule takes a copyable std::function.
+  auto callback = std::make_shared<absl::AnyInvocable<void() &&>>(
+      std::move(waiter.callback));
+  waiter.executor->Schedule([callback]() { std::move(*callback)(); });
 }
 
 Semaphore::ScopedReservation::~ScopedReservation() {
@@ -17,9 +17,13 @@ limitations under the License.
 #define XLA_PJRT_SEMAPHORE_H_
 
 #include <cstdint>
+#include <utility>
+#include <vector>
 
+#include "absl/functional/any_invocable.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/types.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 
@@ -37,6 +41,19 @@ class Semaphore {
   // Returns `amount` units to the semaphore.
   void Release(int64_t amount);
 
+  // Schedules `callback` on `executor` once `amount` units are available,
+  // without acquiring them. The callback never runs on the thread that calls
+  // Release(), so it may acquire or release units itself. This is only a hint:
+  // another caller may acquire the units before the callback runs.
+  void OnAvailable(int64_t amount, tsl::thread::ThreadPool* executor,
+                   absl::AnyInvocable<void() &&> callback);
+
+  // Returns the number of units that are currently available.
+  int64_t available() {
+    absl::MutexLock lock(&mu_);
+    return value_;
+  }
+
   // Returns the capacity of the semaphore.
   int64_t capacity() const { return max_capacity_; }
 
@@ -71,6 +88,16 @@ class Semaphore {
   absl::Mutex mu_;
   int64_t value_ ABSL_GUARDED_BY(mu_);
   const int64_t max_capacity_;
+  struct Waiter {
+    int64_t amount;
+    tsl::thread::ThreadPool* executor;
+    absl::AnyInvocable<void() &&> callback;
+  };
+  static void Schedule(Waiter waiter);
+
+  // Callbacks registered by OnAvailable() that wait for units, in the order
+  // they were registered.
+  std::vector<Waiter> waiters_ ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace xla
@@ -80,5 +80,47 @@ TEST(SemaphoreTest, ConcurrentTest) {
   a_done.WaitForNotification();
 }
 
+TEST(SemaphoreTest, OnAvailable) {
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "test", 2);
+  Semaphore semaphore(2);
+  absl::Notification a_called;
+  semaphore.OnAvailable(2, &pool, [&] { a_called.Notify(); });
+  a_called.WaitForNotification();
+
+  semaphore.Acquire(2);
+  EXPECT_EQ(semaphore.available(), 0);
+  absl::Notification b_called;
+  absl::Notification c_called;
+  semaphore.OnAvailable(2, &pool, [&] { b_called.Notify(); });
+  semaphore.OnAvailable(1, &pool, [&] { c_called.Notify(); });
+
+  // The second waiter only needs one unit but is queued behind the first.
+  semaphore.Release(1);
+  EXPECT_FALSE(b_called.HasBeenNotified());
+  EXPECT_FALSE(c_called.HasBeenNotified());
+  semaphore.Release(1);
+  b_called.WaitForNotification();
+  c_called.WaitForNotification();
+  EXPECT_EQ(semaphore.available(), 2);
+}
+
+TEST(SemaphoreTest, OnAvailableCallbackUsesSemaphore) {
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "test", 2);
+  Semaphore semaphore(1);
+  semaphore.Acquire(1);
+
+  // The callback runs on the pool rather than inside Release(), so it can
+  // acquire and release units of the same semaphore.
+  absl::Notification called;
+  semaphore.OnAvailable(1, &pool, [&] {
+    semaphore.Acquire(1);
+    semaphore.Release(1);
+    called.Notify();
+  });
+  semaphore.Release(1);
+  called.WaitForNotification();
+  EXPECT_EQ(semaphore.available(), 1);
+}
+
 }  // namespace
 }  // namespace xla
@@ -105,13 +105,54 @@ limitations under the License.
 namespace xla {
 
 namespace {
-#ifdef __AVX__
+#ifdef __AVX512F__
+static constexpr int kMaxInnerBlockSizeBytes = sizeof(__m512i);
+#elif defined(__AVX__)
 static constexpr int kMaxInnerBlockSizeBytes = sizeof(__m256i);
 #elif defined(XLA_HAS_VEC128)
-static constexpr int kMaxInnerBlockSizeBytes = sizeof(Vec128);
+// Vec128SquareTransposeMicroKernelImpl handles blocks whose rows span two
+// vectors.
+static constexpr int kMaxInnerBlockSizeBytes = 2 * sizeof(Vec128);
 #else
 static constexpr int kMaxInnerBlockSizeBytes = 16;
 #endif
+
+// Granularity at which we try to partition the output between threads. We use
+// the smallest common page size; partitions aligned to larger pages are also
+// aligned to this one.
+static constexpr int64_t kOutputPartitionAlignmentBytes = 4096;
+
+// Returns the number of iterations of a loop with `num_iterations` iterations
+// that each of `num_tasks` tasks should execute. Each iteration advances the
+// output pointer by `output_bytes_per_iteration` bytes.
+//
+// Where possible, the per-task iteration count is rounded up so that the
+// output range written by each task starts on a page boundary. Under a
+// first-touch NUMA policy this places the pages of a freshly allocated output
+// on the node of the thread that writes them, and it avoids threads running on
+// different sockets writing to the same page.
+int64_t IterationsPerTask(int64_t num_iterations, int num_tasks,
+                          int64_t output_bytes_per_iteration) {
+  int64_t iterations_per_task =
+      CeilOfRatio<int64_t>(num_iterations, num_tasks);
+  output_bytes_per_iteration = std::abs(output_bytes_per_iteration);
+  if (num_tasks <= 1 || output_bytes_per_iteration == 0) {
+    return iterations_per_task;
+  }
+  int64_t alignment =
+      kOutputPartitionAlignmentBytes /
+      std::gcd(kOutputPartitionAlignmentBytes, output_bytes_per_iteration);
+  int64_t aligned_iterations_per_task =
+      RoundUpTo<int64_t>(iterations_per_task, alignment);
+  // Only use the aligned partitioning if it doesn't unbalance the work too
+  // much and every task still has work to do.
+  if (aligned_iterations_per_task - iterations_per_task <=
+          iterations_per_task / 8 &&
+      aligned_iterations_per_task * (num_tasks - 1) < num_iterations) {
+    return aligned_iterations_per_task;
+  }
+  return iterations_per_task;
+}
 }  // namespace
 
 // A plan is a data structure that describes a loop nest.
@@ -813,8 +854,9 @@ void TransposePlan::BuildPlanNodes(
       int task_id = task_id_at_loop / num_tasks_at_loop;
       int64_t size = partial ? a_dims_[a_dim] % tile_size : tile_size;
       int64_t num_iterations = CeilOfRatio(size, node.inc);
-      int64_t num_iterations_per_task = CeilOfRatio<int64_t>(
-          num_iterations, loop_parallelism_[agendum.loop_id]);
+      int64_t num_iterations_per_task =
+          IterationsPerTask(num_iterations, loop_parallelism_[agendum.loop_id],
+                            node.ldb * node.inc);
       node.start = std::min(size, task_id * num_iterations_per_task * node.inc);
       node.end =
           std::min(size, (task_id + 1) * num_iterations_per_task * node.inc);
@@ -871,8 +913,9 @@ void TransposePlan::BuildPlanNodes(
       // Evenly divide the loop iterations amongst the threads.
       int64_t num_tiles = partial ? 1 : num_complete_tiles;
       int64_t num_iterations = CeilOfRatio(num_tiles, node.inc);
-      int64_t num_iterations_per_task = CeilOfRatio<int64_t>(
-          num_iterations, loop_parallelism_[agendum.loop_id]);
+      int64_t num_iterations_per_task =
+          IterationsPerTask(num_iterations, loop_parallelism_[agendum.loop_id],
+                            node.ldb * node.inc);
       node.start =
           std::min(num_tiles, task_id * num_iterations_per_task * node.inc);
       node.end = std::min(num_tiles,
@@ -1356,8 +1399,7 @@ H AbslHashValue(H h, const TransposePlanCacheKey& key) {
                     key.input_layout, key.output_tiling);
 }
 
-TransposePlanCache::TransposePlanCache(int capacity)
-    : lru_list_(capacity), cache_(&lru_list_) {}
+TransposePlanCache::TransposePlanCache(int capacity) : cache_(capacity) {}
 
 TransposePlanCache::~TransposePlanCache() = default;
 
@@ -267,10 +267,11 @@ struct TransposePlanCacheKey {
 template <typename H>
 H AbslHashValue(H h, const TransposePlanCacheKey& key);
 
-// An LRU cache for transpose plans. Not thread-safe.
+// An LRU cache for transpose plans. Thread-safe.
 // Transpose plans aren't cheap to build, but once computed for a particular set
 // of inputs can be cached and reused for arrays. TransposePlanCache implements
-// such a cache.
+// such a cache. The cache is sharded to avoid lock contention between threads
+// concurrently transferring host buffers.
 class TransposePlanCache {
  public:
   explicit TransposePlanCache(int capacity);
@@ -286,10 +287,8 @@ class TransposePlanCache {
       const TransposePlan::Options& options);
 
  private:
-  LRUCache<TransposePlanCacheKey,
-           absl::StatusOr<std::shared_ptr<TransposePlan>>>::LRUList lru_list_;
-  LRUCache<TransposePlanCacheKey,
-           absl::StatusOr<std::shared_ptr<TransposePlan>>>
+  ShardedLRUCache<TransposePlanCacheKey,
+                  absl::StatusOr<std::shared_ptr<TransposePlan>>>
       cache_;
 };
 
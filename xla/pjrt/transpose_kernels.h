@@ -203,6 +203,49 @@ inline __m256i Unpack<8, Extract::kHi>(__m256i a, __m256i b) {
 #endif
 #endif
 
+#ifdef __AVX512F__
+template <size_t element_size, Extract>
+__m512i Unpack(__m512i a, __m512i b);
+
+#if defined(__AVX512BW__)
+template <>
+inline __m512i Unpack<1, Extract::kLo>(__m512i a, __m512i b) {
+  return _mm512_unpacklo_epi8(a, b);
+}
+template <>
+inline __m512i Unpack<1, Extract::kHi>(__m512i a, __m512i b) {
+  return _mm512_unpackhi_epi8(a, b);
+}
+
+template <>
+inline __m512i Unpack<2, Extract::kLo>(__m512i a, __m512i b) {
+  return _mm512_unpacklo_epi16(a, b);
+}
+template <>
+inline __m512i Unpack<2, Extract::kHi>(__m512i a, __m512i b) {
+  return _mm512_unpackhi_epi16(a, b);
+}
+#endif
+
+template <>
+inline __m512i Unpack<4, Extract::kLo>(__m512i a, __m512i b) {
+  return _mm512_unpacklo_epi32(a, b);
+}
+template <>
+inline __m512i Unpack<4, Extract::kHi>(__m512i a, __m512i b) {
+  return _mm512_unpackhi_epi32(a, b);
+}
+
+template <>
+inline __m512i Unpack<8, Extract::kLo>(__m512i a, __m512i b) {
+  return _mm512_unpacklo_epi64(a, b);
+}
+template <>
+inline __m512i Unpack<8, Extract::kHi>(__m512i a, __m512i b) {
+  return _mm512_unpackhi_epi64(a, b);
+}
+#endif
+
 #ifdef XLA_HAS_SSE2
 template <size_t element_size, Extract>
 __m128i Unpack(__m128i a, __m128i b);
@@ -567,6 +610,47 @@ struct Vec128RectangularTransposeMicroKernelImpl {
   }
 };
 
+
+// Transposes a square block whose rows span two 128-bit vectors. The block is
+// split into four quadrants of (bs / 2) x (bs / 2) elements, each of which
+// fills exactly `bs / 2` vectors. Every quadrant is transposed in registers and
+// stored into the mirrored quadrant of the output. This lets targets without
+// 256-bit vectors (e.g. NEON) use the same inner block sizes as AVX.
+template <typename T, int bs>
+struct Vec128SquareTransposeMicroKernelImpl {
+  XLA_FLATTEN static void Apply(const char* __restrict a, int64_t lda,
+                                char* __restrict b, int64_t ldb) {
+    constexpr size_t element_size = sizeof(T);
+    static_assert(sizeof(Vec128) % element_size == 0);
+    static_assert(bs % 2 == 0);
+    static_assert(element_size * bs == 2 * sizeof(Vec128));
+    constexpr int kHalf = bs / 2;
+
+    XLA_UNROLL
+    for (int row_block = 0; row_block < 2; ++row_block) {
+      XLA_UNROLL
+      for (int col_block = 0; col_block < 2; ++col_block) {
+        std::array<Vec128, kHalf> quadrant;
+        XLA_UNROLL
+        for (int i = 0; i < kHalf; ++i) {
+          quadrant[i] = LoadElementIntoVec128<sizeof(Vec128)>(
+              a + lda * (row_block * kHalf + i) + col_block * sizeof(Vec128));
+        }
+
+        quadrant =
+            UnpackSequence<element_size, /*step_size=*/1,
+                           /*unpack_limit=*/sizeof(Vec128)>(quadrant);
+
+        XLA_UNROLL
+        for (int i = 0; i < kHalf; ++i) {
+          StoreElementFromVec128<sizeof(Vec128), /*lane=*/0>(
+              b + ldb * (col_block * kHalf + i) + row_block * sizeof(Vec128),
+              quadrant[i]);
+        }
+      }
+    }
+  }
+};
 #endif
 
 #ifdef __AVX__
@@ -657,6 +741,55 @@ struct AvxRectangularTransposeMicroKernelImpl {
 };
 #endif
 
+#ifdef __AVX512F__
+// Transposes a square block whose rows fill a 512-bit vector, e.g. 16x16
+// 32-bit or 8x8 64-bit elements. AVX-512 unpack instructions operate
+// independently on each 128-bit lane, so we interleave the loads such that
+// lane `l` of vector `g * bs / 4 + i` holds the `g`-th 128-bit chunk of row
+// `l * bs / 4 + i`. The in-lane transpose then produces full output rows.
+template <typename T, int bs>
+struct Avx512SquareTransposeMicroKernelImpl {
+  XLA_FLATTEN static void Apply(const char* __restrict a, int64_t lda,
+                                char* __restrict b, int64_t ldb) {
+    constexpr size_t element_size = sizeof(T);
+    static_assert(element_size <= sizeof(__m128i) / 2);
+    static_assert(sizeof(__m128i) % element_size == 0);
+    static_assert(bs % 4 == 0);
+    static_assert(element_size * bs == sizeof(__m512i));
+#ifndef __AVX512BW__
+    static_assert(element_size >= 4, "1- and 2-byte unpacks need AVX-512BW");
+#endif
+    constexpr int kQuarter = bs / 4;
+    std::array<__m512i, bs> last_transpose;
+    XLA_UNROLL
+    for (int g = 0; g < 4; ++g) {
+      XLA_UNROLL
+      for (int i = 0; i < kQuarter; ++i) {
+        auto load = [&](int lane) {
+          return _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+              a + lda * (lane * kQuarter + i) + g * sizeof(__m128i)));
+        };
+        __m512i v = _mm512_castsi128_si512(load(0));
+        v = _mm512_inserti32x4(v, load(1), 1);
+        v = _mm512_inserti32x4(v, load(2), 2);
+        v = _mm512_inserti32x4(v, load(3), 3);
+        last_transpose[g * kQuarter + i] = v;
+      }
+    }
+
+    last_transpose =
+        UnpackSequence<element_size, /*step_size=*/1,
+                       /*unpack_limit=*/sizeof(__m128i)>(last_transpose);
+
+    XLA_UNROLL
+    for (int i = 0; i < bs; ++i) {
+      _mm512_storeu_si512(reinterpret_cast<void*>(b + ldb * i),
+                          last_transpose[i]);
+    }
+  }
+};
+#endif
+
 // The transpose kernel requires its input to be contiguous in one of the two
 // dimensions being transposed, and the output to be contiguous in the other
 // dimension.
@@ -667,6 +800,20 @@ struct TransposeMicroKernel {
   static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
                     int64_t ldb) {
     if constexpr (bs % 2 == 0) {
+#ifdef __AVX512F__
+      // 512-bit unpacks of 1- and 2-byte elements require AVX-512BW.
+#ifdef __AVX512BW__
+      constexpr size_t kMinAvx512ElementSize = 1;
+#else
+      constexpr size_t kMinAvx512ElementSize = 4;
+#endif
+      if constexpr (sizeof(T) * bs == sizeof(__m512i) &&
+                    sizeof(T) >= kMinAvx512ElementSize &&
+                    sizeof(T) <= sizeof(__m128i) / 2) {
+        return Avx512SquareTransposeMicroKernelImpl<T, bs>::Apply(a, lda, b,
+                                                                  ldb);
+      }
+#endif
 #ifdef __AVX__
       if constexpr (sizeof(T) * bs == sizeof(__m256i)) {
         return AvxSquareTransposeMicroKernelImpl<T, bs>::Apply(a, lda, b, ldb);
@@ -679,6 +826,9 @@ struct TransposeMicroKernel {
       if constexpr (sizeof(T) * bs <= sizeof(Vec128)) {
         return Vec128RectangularTransposeMicroKernelImpl<T, bs>::Apply(a, lda,
                                                                        b, ldb);
+      } else if constexpr (sizeof(T) * bs == 2 * sizeof(Vec128)) {
+        return Vec128SquareTransposeMicroKernelImpl<T, bs>::Apply(a, lda, b,
+                                                                  ldb);
       }
 #endif
     }
@@ -311,6 +311,8 @@ std::vector<TransposeTestCase> GetTransposeTestCases() {
       TransposeTestCase(/*dims=*/{8, 8}, /*permutation=*/{1, 0}),
       TransposeTestCase(/*dims=*/{16, 16}, /*permutation=*/{0, 1}),
       TransposeTestCase(/*dims=*/{16, 16}, /*permutation=*/{1, 0}),
+      TransposeTestCase(/*dims=*/{32, 48}, /*permutation=*/{1, 0}),
+      TransposeTestCase(/*dims=*/{33, 17}, /*permutation=*/{1, 0}),
       TransposeTestCase(/*dims=*/{11, 15}, /*permutation=*/{0, 1}),
       TransposeTestCase(/*dims=*/{11, 15}, /*permutation=*/{1, 0}),
       TransposeTestCase(/*dims=*/{11, 15, 13}, /*permutation=*/{0, 1, 2}),
@@ -408,6 +410,7 @@ TEST_P(TransposeTest, TransposeInt128) { TestTranspose<absl::int128>(1); }
 
 TEST_P(TransposeTest, ParallelTransposeInt8) { TestTranspose<int8_t>(16); }
 TEST_P(TransposeTest, ParallelTransposeInt32) { TestTranspose<int32_t>(16); }
+TEST_P(TransposeTest, ParallelTransposeInt64) { TestTranspose<int64_t>(16); }
 
 INSTANTIATE_TEST_SUITE_P(TransposeTestInstance, TransposeTest,
                          ::testing::ValuesIn(GetTransposeTestCases()));
@@ -512,10 +515,18 @@ static void BM_Eigen_uint8(const TransposeTestCase& bm, int parallelism,
                            ::testing::benchmark::State& state) {
   BM_Eigen<uint8_t>(std::move(bm), parallelism, state);
 }
+static void BM_Eigen_uint16(const TransposeTestCase& bm, int parallelism,
+                            ::testing::benchmark::State& state) {
+  BM_Eigen<uint16_t>(bm, parallelism, state);
+}
 static void BM_Eigen_float(const TransposeTestCase& bm, int parallelism,
                            ::testing::benchmark::State& state) {
   BM_Eigen<float>(bm, parallelism, state);
 }
+static void BM_Eigen_double(const TransposeTestCase& bm, int parallelism,
+                            ::testing::benchmark::State& state) {
+  BM_Eigen<double>(bm, parallelism, state);
+}
 
 template <typename T>
 void BM_Transpose(const TransposeTestCase& bm, int parallelism,
@@ -546,10 +557,18 @@ static void BM_Transpose_uint8(const TransposeTestCase& bm, int parallelism,
                                ::testing::benchmark::State& state) {
   BM_Transpose<uint8_t>(bm, parallelism, state);
 }
+static void BM_Transpose_uint16(const TransposeTestCase& bm, int parallelism,
+                                ::testing::benchmark::State& state) {
+  BM_Transpose<uint16_t>(bm, parallelism, state);
+}
 static void BM_Transpose_float(const TransposeTestCase& bm, int parallelism,
                                ::testing::benchmark::State& state) {
   BM_Transpose<float>(bm, parallelism, state);
 }
+static void BM_Transpose_double(const TransposeTestCase& bm, int parallelism,
+                                ::testing::benchmark::State& state) {
+  BM_Transpose<double>(bm, parallelism, state);
+}
 
 static void* benchmarks = []() {
   using BenchmarkFn =
@@ -558,8 +577,12 @@ static void* benchmarks = []() {
       {
           {"BM_Eigen_uint8", BM_Eigen_uint8, {1}},
           {"BM_Transpose_uint8", BM_Transpose_uint8, {1, 4, 8}},  //
+          {"BM_Eigen_uint16", BM_Eigen_uint16, {1}},
+          {"BM_Transpose_uint16", BM_Transpose_uint16, {1, 4, 8}},  //
           {"BM_Eigen_float", BM_Eigen_float, {1}},
           {"BM_Transpose_float", BM_Transpose_float, {1, 4, 8}},  //
+          {"BM_Eigen_double", BM_Eigen_double, {1}},
+          {"BM_Transpose_double", BM_Transpose_double, {1, 4, 8}},  //
   };
   auto benchmark_cases = BenchmarkCases();
   for (const auto& benchmark_case : benchmark_cases) {
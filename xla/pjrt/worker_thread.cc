@@ -29,19 +29,43 @@ WorkerThread::WorkerThread(tsl::Env* env, const std::string& name) {
       env->StartThread(tsl::ThreadOptions(), name, [this]() { WorkLoop(); }));
 }
 
+WorkerThread::WorkerThread(tsl::thread::ThreadPool* pool) : pool_(pool) {
+  CHECK(pool_ != nullptr);
+}
+
 WorkerThread::~WorkerThread() {
-  absl::MutexLock lock(&mu_);
-  work_queue_.push(nullptr);
+  if (pool_ != nullptr) {
+    // RunQueue only clears `running_` under the lock right before it returns,
+    // and it doesn't touch the worker after that.
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &WorkerThread::Idle));
+    return;
+  }
+  {
+    absl::MutexLock lock(&mu_);
+    work_queue_.push(nullptr);
+  }
+  // Join the thread before destroying the state it reads.
+  thread_.reset();
 }
 
 void WorkerThread::Schedule(absl::AnyInvocable<void() &&> fn) {
   CHECK(fn != nullptr);
-  absl::MutexLock lock(&mu_);
-  work_queue_.push(std::move(fn));
+  {
+    absl::MutexLock lock(&mu_);
+    work_queue_.push(std::move(fn));
+    if (pool_ == nullptr || running_) {
+      return;
+    }
+    running_ = true;
+  }
+  pool_->Schedule([this]() { RunQueue(); });
 }
 
 bool WorkerThread::WorkAvailable() { return !work_queue_.empty(); }
 
+bool WorkerThread::Idle() { return !running_; }
+
 void WorkerThread::WorkLoop() {
   while (true) {
     absl::AnyInvocable<void() &&> fn;
@@ -58,4 +82,20 @@ void WorkerThread::WorkLoop() {
   }
 }
 
+void WorkerThread::RunQueue() {
+  while (true) {
+    absl::AnyInvocable<void() &&> fn;
+    {
+      absl::MutexLock lock(&mu_);
+      if (work_queue_.empty()) {
+        running_ = false;
+        return;
+      }
+      fn = std::move(work_queue_.front());
+      work_queue_.pop();
+    }
+    std::move(fn)();
+  }
+}
+
 }  // namespace xla
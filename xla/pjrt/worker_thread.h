@@ -24,16 +24,25 @@ limitations under the License.
 #include "absl/functional/any_invocable.h"
 #include "absl/synchronization/mutex.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 
 // A worker thread that runs a sequence of closures. Equivalent to a thread
 // pool of size 1.
+//
+// A worker thread can also be backed by a thread pool shared with other
+// workers instead of a dedicated thread. Closures still run one at a time in
+// FIFO order, and a worker occupies a thread of the pool only while it has
+// closures to run.
 class WorkerThread {
  public:
   // 'name' is a name for the thread for debugging purposes.
   WorkerThread(tsl::Env* env, const std::string& name);
 
+  // Runs closures on `pool`, which must outlive the worker thread.
+  explicit WorkerThread(tsl::thread::ThreadPool* pool);
+
   // Blocks until all enqueued closures have completed.
   ~WorkerThread();
 
@@ -42,12 +51,20 @@ class WorkerThread {
 
  private:
   bool WorkAvailable() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool Idle() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   void WorkLoop();
 
+  // Runs queued closures on a thread of `pool_` until the queue is empty.
+  void RunQueue();
+
   absl::Mutex mu_;
   std::queue<absl::AnyInvocable<void() &&>> work_queue_ ABSL_GUARDED_BY(mu_);
 
   std::unique_ptr<tsl::Thread> thread_;
+
+  tsl::thread::ThreadPool* pool_ = nullptr;
+  // True if RunQueue is scheduled or running on `pool_`.
+  bool running_ ABSL_GUARDED_BY(mu_) = false;
 };
 
 }  // namespace xla
@@ -0,0 +1,99 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/worker_thread.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/synchronization/mutex.h"
+#include "xla/test.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla {
+namespace {
+
+TEST(WorkerThreadTest, DedicatedThreadRunsInOrder) {
+  absl::Mutex mu;
+  std::vector<int> order;
+  {
+    WorkerThread worker(tsl::Env::Default(), "worker");
+    for (int i = 0; i < 100; ++i) {
+      worker.Schedule([&, i]() {
+        absl::MutexLock lock(&mu);
+        order.push_back(i);
+      });
+    }
+  }
+  ASSERT_EQ(order.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(order[i], i);
+  }
+}
+
+TEST(WorkerThreadTest, SharedPoolRunsEachWorkerInOrder) {
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "pool", 4);
+
+  constexpr int kNumWorkers = 8;
+  constexpr int kNumClosures = 1000;
+
+  absl::Mutex mu;
+  std::vector<std::vector<int>> order(kNumWorkers);
+
+  std::vector<std::unique_ptr<WorkerThread>> workers;
+  for (int w = 0; w < kNumWorkers; ++w) {
+    workers.push_back(std::make_unique<WorkerThread>(&pool));
+  }
+
+  for (int i = 0; i < kNumClosures; ++i) {
+    for (int w = 0; w < kNumWorkers; ++w) {
+      workers[w]->Schedule([&, w, i]() {
+        absl::MutexLock lock(&mu);
+        order[w].push_back(i);
+      });
+    }
+  }
+
+  // Destroying the workers blocks until all closures have completed.
+  workers.clear();
+
+  for (int w = 0; w < kNumWorkers; ++w) {
+    ASSERT_EQ(order[w].size(), kNumClosures);
+    for (int i = 0; i < kNumClosures; ++i) {
+      EXPECT_EQ(order[w][i], i);
+    }
+  }
+}
+
+TEST(WorkerThreadTest, DestroyWhileRunning) {
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "pool", 4);
+  for (int i = 0; i < 100; ++i) {
+    int counter = 0;
+    {
+      WorkerThread pool_worker(&pool);
+      WorkerThread thread_worker(tsl::Env::Default(), "worker");
+      pool_worker.Schedule([&counter]() { ++counter; });
+      thread_worker.Schedule([&counter, &pool_worker]() {
+        pool_worker.Schedule([&counter]() { ++counter; });
+      });
+    }
+    EXPECT_EQ(counter, 2);
+  }
+}
+
+}  // namespace
+}  // namespace xla
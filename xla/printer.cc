@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "xla/printer.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <string>
 #include <utility>
@@ -22,6 +24,8 @@ limitations under the License.
 #include "absl/strings/cord.h"
 #include "absl/strings/cord_buffer.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/logging.h"
 
 namespace xla {
@@ -67,4 +71,31 @@ absl::Cord CordPrinter::ToCord() && {
   return std::move(result_);
 }
 
+void FingerprintPrinter::Append(const absl::AlphaNum& a) {
+  absl::string_view piece = a.Piece();
+  total_length_ += piece.size();
+  while (!piece.empty()) {
+    size_t n = std::min(piece.size(), kChunkSize - length_);
+    std::memcpy(buffer_.get() + length_, piece.data(), n);
+    length_ += n;
+    piece.remove_prefix(n);
+    if (length_ == kChunkSize) FlushChunk();
+  }
+}
+
+void FingerprintPrinter::FlushChunk() {
+  tsl::Fprint128 chunk =
+      tsl::Fingerprint128(absl::string_view(buffer_.get(), length_));
+  fingerprint_.low64 = tsl::FingerprintCat64(fingerprint_.low64, chunk.low64);
+  fingerprint_.high64 =
+      tsl::FingerprintCat64(fingerprint_.high64, chunk.high64);
+  length_ = 0;
+}
+
+tsl::Fprint128 FingerprintPrinter::ToFingerprint128() && {
+  if (length_ > 0) FlushChunk();
+  fingerprint_.low64 = tsl::FingerprintCat64(fingerprint_.low64, total_length_);
+  return fingerprint_;
+}
+
 }  // namespace xla
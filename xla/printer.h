@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef XLA_PRINTER_H_
 #define XLA_PRINTER_H_
 
+#include <cstddef>
 #include <iterator>
+#include <memory>
 #include <string>
 
 #include "absl/base/optimization.h"
@@ -24,6 +26,7 @@ limitations under the License.
 #include "absl/strings/cord_buffer.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "tsl/platform/fingerprint.h"
 
 namespace xla {
 
@@ -67,6 +70,30 @@ class CordPrinter : public Printer {
   absl::Cord result_;
 };
 
+// A printer implementation that computes a 128-bit fingerprint of the printed
+// strings without materializing them. The fingerprint only depends on the
+// concatenation of the appended strings (not on how it was split into Append
+// calls) and is stable across processes, so it can be used in persistent keys.
+class FingerprintPrinter : public Printer {
+ public:
+  void Append(const absl::AlphaNum& a) override;
+
+  tsl::Fprint128 ToFingerprint128() &&;
+
+ private:
+  static constexpr size_t kChunkSize = 16 << 10;
+
+  // Folds the buffered chunk into the running fingerprint.
+  void FlushChunk();
+
+  // Heap allocated, so that printers can live on the stack of deeply nested
+  // callers.
+  std::unique_ptr<char[]> buffer_ = std::make_unique<char[]>(kChunkSize);
+  size_t length_ = 0;
+  size_t total_length_ = 0;
+  tsl::Fprint128 fingerprint_ = {0, 0};
+};
+
 // Utility functions that appends a list of elements to a Printer as if by
 // calling printer->Append(absl::StrJoin(...)), but does it in-place.
 template <typename Range, typename PrintFunc>
@@ -0,0 +1,217 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/python/auto_pgle_executable.h"
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/python/xplane_to_profile_instructions.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/profiler/lib/profiler_session.h"
+#include "tsl/profiler/protobuf/profiled_instructions.pb.h"
+#include "tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace xla {
+
+/*static*/ absl::StatusOr<std::unique_ptr<AutoPgleExecutable>>
+AutoPgleExecutable::Compile(PjRtClient* client,
+                            const XlaComputation& computation,
+                            CompileOptions compile_options, Options options) {
+  if (!compile_options.executable_build_options.fdo_profile().empty()) {
+    VLOG(1) << "Compile options already carry an FDO profile, disabling "
+               "automatic PGLE";
+    options.num_profiled_runs = 0;
+  }
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtLoadedExecutable> executable,
+                      client->Compile(computation, compile_options));
+  return absl::WrapUnique(
+      new AutoPgleExecutable(client, computation, std::move(compile_options),
+                             options, std::move(executable)));
+}
+
+AutoPgleExecutable::AutoPgleExecutable(
+    PjRtClient* client, const XlaComputation& computation,
+    CompileOptions compile_options, Options options,
+    std::unique_ptr<PjRtLoadedExecutable> executable)
+    : client_(client),
+      computation_(computation),
+      compile_options_(std::move(compile_options)),
+      options_(options),
+      executable_(std::move(executable)) {}
+
+AutoPgleExecutable::~AutoPgleExecutable() {
+  // Joins the background compilation, if any.
+  compilation_thread_.reset();
+}
+
+absl::StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+AutoPgleExecutable::Execute(
+    absl::Span<const std::vector<PjRtBuffer*>> argument_handles,
+    const ExecuteOptions& options,
+    std::optional<std::vector<PjRtFuture<>>>& returned_futures) {
+  std::shared_ptr<PjRtLoadedExecutable> executable;
+  bool profile = false;
+  {
+    absl::MutexLock lock(&mu_);
+    if (pgle_executable_ != nullptr) {
+      VLOG(1) << "Switching " << executable_->name()
+              << " to its PGLE optimized executable";
+      executable_ = std::move(pgle_executable_);
+      is_pgle_optimized_ = true;
+    }
+    executable = executable_;
+    if (num_started_profiled_runs_ < options_.num_profiled_runs) {
+      ++num_started_profiled_runs_;
+      profile = true;
+    }
+  }
+  if (!profile) {
+    return executable->Execute(argument_handles, options, returned_futures);
+  }
+  return ExecuteAndProfile(*executable, argument_handles, options,
+                           returned_futures);
+}
+
+absl::StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+AutoPgleExecutable::ExecuteAndProfile(
+    PjRtLoadedExecutable& executable,
+    absl::Span<const std::vector<PjRtBuffer*>> argument_handles,
+    const ExecuteOptions& options,
+    std::optional<std::vector<PjRtFuture<>>>& returned_futures) {
+  absl::MutexLock lock(&profile_mu_);
+  tensorflow::ProfileOptions profile_options =
+      tsl::ProfilerSession::DefaultOptions();
+  // The HLO protos map the profiled ops back to the module fingerprint.
+  profile_options.set_enable_hlo_proto(true);
+  std::unique_ptr<tsl::ProfilerSession> session =
+      tsl::ProfilerSession::Create(profile_options);
+  absl::Status session_status = session->Status();
+  if (!session_status.ok()) {
+    LOG(WARNING) << "Unable to profile " << executable.name()
+                 << " for automatic PGLE: " << session_status;
+  }
+
+  // Wait for the execution to finish so that the profile covers all of it.
+  std::optional<std::vector<PjRtFuture<>>> futures;
+  futures.emplace();
+  absl::StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+      results = executable.Execute(argument_handles, options, futures);
+  if (!results.ok()) {
+    FinishProfiledRun();
+    return results;
+  }
+  for (PjRtFuture<>& future : *futures) {
+    // Execution errors are reported through the futures and buffers.
+    future.Await().IgnoreError();
+  }
+  if (returned_futures.has_value()) {
+    *returned_futures = std::move(*futures);
+  }
+
+  if (session_status.ok()) {
+    tensorflow::profiler::XSpace xspace;
+    absl::Status collect_status = session->CollectData(&xspace);
+    if (collect_status.ok()) {
+      xspaces_.push_back(std::move(xspace));
+    } else {
+      LOG(WARNING) << "Unable to collect the profile of " << executable.name()
+                   << " for automatic PGLE: " << collect_status;
+    }
+  }
+
+  FinishProfiledRun();
+  return results;
+}
+
+void AutoPgleExecutable::FinishProfiledRun() {
+  if (++num_finished_profiled_runs_ != options_.num_profiled_runs) {
+    return;
+  }
+  {
+    absl::MutexLock lock(&mu_);
+    compilation_started_ = true;
+  }
+  std::vector<tensorflow::profiler::XSpace> xspaces = std::move(xspaces_);
+  xspaces_.clear();
+  compilation_thread_.reset(tsl::Env::Default()->StartThread(
+      tsl::ThreadOptions(), "auto_pgle_compilation",
+      [this, xspaces = std::move(xspaces)]() mutable {
+        absl::Status status = CompileWithProfile(std::move(xspaces));
+        if (!status.ok()) {
+          LOG(WARNING) << "Automatic PGLE recompilation failed: " << status;
+        }
+        absl::MutexLock lock(&mu_);
+        compilation_status_ = std::move(status);
+        compilation_done_ = true;
+      }));
+}
+
+absl::Status AutoPgleExecutable::CompileWithProfile(
+    std::vector<tensorflow::profiler::XSpace> xspaces) {
+  tensorflow::profiler::ProfiledInstructionsProto profile;
+  TF_RETURN_IF_ERROR(
+      ConvertXplaneToProfiledInstructionsProto(std::move(xspaces), &profile));
+  if (profile.costs().empty()) {
+    LOG(INFO) << "The profile has no instruction costs, keeping the "
+                 "executable compiled without PGLE";
+    return absl::OkStatus();
+  }
+  CompileOptions compile_options = compile_options_;
+  compile_options.executable_build_options.set_fdo_profile(
+      profile.SerializeAsString());
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtLoadedExecutable> executable,
+                      client_->Compile(computation_, compile_options));
+  absl::MutexLock lock(&mu_);
+  pgle_executable_ = std::move(executable);
+  return absl::OkStatus();
+}
+
+std::shared_ptr<PjRtLoadedExecutable> AutoPgleExecutable::executable() const {
+  absl::MutexLock lock(&mu_);
+  return executable_;
+}
+
+bool AutoPgleExecutable::is_pgle_optimized() const {
+  absl::MutexLock lock(&mu_);
+  return is_pgle_optimized_;
+}
+
+absl::Status AutoPgleExecutable::WaitForPgleCompilation() {
+  absl::MutexLock lock(&mu_);
+  if (!compilation_started_) {
+    return absl::FailedPreconditionError(
+        "The PGLE recompilation starts after all profiled runs finished");
+  }
+  mu_.Await(absl::Condition(&compilation_done_));
+  return compilation_status_;
+}
+
+}  // namespace xla
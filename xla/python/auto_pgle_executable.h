@@ -0,0 +1,128 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_PYTHON_AUTO_PGLE_EXECUTABLE_H_
+#define XLA_PYTHON_AUTO_PGLE_EXECUTABLE_H_
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "tsl/platform/env.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace xla {
+
+// Applies profile guided latency estimation (PGLE) to a computation without a
+// manual profile-and-recompile workflow.
+//
+// The first `num_profiled_runs` executions run under a profiler session and
+// wait for their results. Once all of them finished, their traces are
+// converted into a ProfiledInstructionsProto, which becomes the `fdo_profile`
+// of a recompilation that runs on a background thread. When that compilation
+// is done, the next Execute call switches to the PGLE optimized executable, so
+// a single step never mixes the two executables. Executions that are already
+// in flight keep running on the executable they were started with.
+//
+// If the profile does not contain any instruction costs, e.g. on backends
+// that do not trace device activity, the original executable is kept.
+class AutoPgleExecutable {
+ public:
+  struct Options {
+    // Number of executions that are profiled before recompiling. Zero
+    // disables automatic PGLE.
+    int num_profiled_runs = 3;
+  };
+
+  // Compiles `computation` with `compile_options`. If `compile_options`
+  // already carry an FDO profile, automatic PGLE is disabled.
+  static absl::StatusOr<std::unique_ptr<AutoPgleExecutable>> Compile(
+      PjRtClient* client, const XlaComputation& computation,
+      CompileOptions compile_options, Options options);
+
+  ~AutoPgleExecutable();
+
+  // Same contract as PjRtLoadedExecutable::Execute.
+  absl::StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>> Execute(
+      absl::Span<const std::vector<PjRtBuffer*>> argument_handles,
+      const ExecuteOptions& options,
+      std::optional<std::vector<PjRtFuture<>>>& returned_futures);
+
+  // Returns the executable the next Execute call would run, without switching
+  // to a PGLE optimized executable that is ready.
+  std::shared_ptr<PjRtLoadedExecutable> executable() const;
+
+  // True once Execute switched to the PGLE optimized executable.
+  bool is_pgle_optimized() const;
+
+  // Blocks until the background recompilation finished and returns its
+  // status. Fails if not all profiled runs have been executed yet.
+  absl::Status WaitForPgleCompilation();
+
+ private:
+  AutoPgleExecutable(PjRtClient* client, const XlaComputation& computation,
+                     CompileOptions compile_options, Options options,
+                     std::unique_ptr<PjRtLoadedExecutable> executable);
+
+  absl::StatusOr<std::vector<std::vector<std::unique_ptr<PjRtBuffer>>>>
+  ExecuteAndProfile(PjRtLoadedExecutable& executable,
+                    absl::Span<const std::vector<PjRtBuffer*>> argument_handles,
+                    const ExecuteOptions& options,
+                    std::optional<std::vector<PjRtFuture<>>>& returned_futures);
+
+  // Counts a finished profiled run and starts the recompilation after the
+  // last one.
+  void FinishProfiledRun() ABSL_EXCLUSIVE_LOCKS_REQUIRED(profile_mu_);
+
+  // Recompiles the computation with the profile built from `xspaces`.
+  absl::Status CompileWithProfile(
+      std::vector<tensorflow::profiler::XSpace> xspaces);
+
+  PjRtClient* client_;
+  const XlaComputation computation_;
+  const CompileOptions compile_options_;
+  const Options options_;
+
+  mutable absl::Mutex mu_;
+  std::shared_ptr<PjRtLoadedExecutable> executable_ ABSL_GUARDED_BY(mu_);
+  std::unique_ptr<PjRtLoadedExecutable> pgle_executable_ ABSL_GUARDED_BY(mu_);
+  bool is_pgle_optimized_ ABSL_GUARDED_BY(mu_) = false;
+  int num_started_profiled_runs_ ABSL_GUARDED_BY(mu_) = 0;
+  bool compilation_started_ ABSL_GUARDED_BY(mu_) = false;
+  bool compilation_done_ ABSL_GUARDED_BY(mu_) = false;
+  absl::Status compilation_status_ ABSL_GUARDED_BY(mu_);
+
+  // Serializes profiled runs: only one profiler session can be active.
+  absl::Mutex profile_mu_;
+  int num_finished_profiled_runs_ ABSL_GUARDED_BY(profile_mu_) = 0;
+  std::vector<tensorflow::profiler::XSpace> xspaces_
+      ABSL_GUARDED_BY(profile_mu_);
+
+  // Declared last so that it is joined before the members it uses go away.
+  std::unique_ptr<tsl::Thread> compilation_thread_;
+};
+
+}  // namespace xla
+
+#endif  // XLA_PYTHON_AUTO_PGLE_EXECUTABLE_H_
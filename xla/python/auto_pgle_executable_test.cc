@@ -0,0 +1,111 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/auto_pgle_executable.h"
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "xla/hlo/builder/xla_computation.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/pjrt/cpu/cpu_client.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/service/hlo_parser.h"
+#include "xla/tests/literal_test_util.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace {
+
+using ::tsl::testing::StatusIs;
+
+constexpr char kProgram[] = R"(
+  HloModule add
+  ENTRY add {
+    x = f32[2] parameter(0)
+    ROOT add = f32[2] add(x, x)
+  })";
+
+class AutoPgleExecutableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TF_ASSERT_OK_AND_ASSIGN(client_, GetTfrtCpuClient(CpuClientOptions()));
+    TF_ASSERT_OK_AND_ASSIGN(auto hlo_module,
+                            ParseAndReturnUnverifiedModule(kProgram, {}));
+    computation_ = XlaComputation(hlo_module->ToProto());
+    TF_ASSERT_OK_AND_ASSIGN(
+        input_, client_->BufferFromHostLiteral(
+                    LiteralUtil::CreateR1<float>({1, 2}),
+                    client_->addressable_devices()[0]));
+  }
+
+  // Executes `executable` and checks its result.
+  void ExecuteAndCheck(AutoPgleExecutable& executable) {
+    std::optional<std::vector<PjRtFuture<>>> futures;
+    futures.emplace();
+    TF_ASSERT_OK_AND_ASSIGN(auto results,
+                            executable.Execute({{input_.get()}}, {}, futures));
+    ASSERT_EQ(futures->size(), 1);
+    TF_ASSERT_OK(futures->front().Await());
+    TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> result,
+                            results[0][0]->ToLiteralSync());
+    EXPECT_TRUE(LiteralTestUtil::Equal(LiteralUtil::CreateR1<float>({2, 4}),
+                                       *result));
+  }
+
+  std::unique_ptr<PjRtClient> client_;
+  XlaComputation computation_;
+  std::unique_ptr<PjRtBuffer> input_;
+};
+
+TEST_F(AutoPgleExecutableTest, RecompilesAfterProfiledRuns) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto executable,
+      AutoPgleExecutable::Compile(client_.get(), computation_, {},
+                                  {/*num_profiled_runs=*/2}));
+  ExecuteAndCheck(*executable);
+  EXPECT_THAT(executable->WaitForPgleCompilation(),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  ExecuteAndCheck(*executable);
+  TF_EXPECT_OK(executable->WaitForPgleCompilation());
+  for (int i = 0; i < 3; ++i) {
+    ExecuteAndCheck(*executable);
+  }
+}
+
+TEST_F(AutoPgleExecutableTest, KeepsExplicitFdoProfile) {
+  CompileOptions compile_options;
+  compile_options.executable_build_options.set_fdo_profile("profile");
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto executable,
+      AutoPgleExecutable::Compile(client_.get(), computation_, compile_options,
+                                  {/*num_profiled_runs=*/1}));
+  ExecuteAndCheck(*executable);
+  EXPECT_THAT(executable->WaitForPgleCompilation(),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  EXPECT_FALSE(executable->is_pgle_optimized());
+}
+
+}  // namespace
+}  // namespace xla
@@ -30,17 +30,24 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "include/dlpack/dlpack.h"
 #include "llvm/Support/Casting.h"
 #include "nanobind/nanobind.h"
+#include "xla/hlo/builder/xla_builder.h"
+#include "xla/hlo/builder/xla_computation.h"
 #include "xla/layout.h"
 #include "xla/pjrt/exceptions.h"
+#include "xla/pjrt/lru_cache.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_common.h"
 #include "xla/pjrt/pjrt_compiler.h"
+#include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
 #include "xla/pjrt/pjrt_layout.h"
 #include "xla/python/ifrt/array.h"
+#include "xla/python/ifrt/client.h"
 #include "xla/python/ifrt/device.h"
 #include "xla/python/nb_class_ptr.h"
 #include "xla/python/pjrt_ifrt/pjrt_array.h"
@@ -55,6 +62,7 @@ limitations under the License.
 #include "xla/shape_util.h"
 #include "xla/status_macros.h"
 #include "xla/util.h"
+#include "xla/xla_data.pb.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/statusor.h"
@@ -361,6 +369,160 @@ absl::StatusOr<std::unique_ptr<PjRtBuffer>> MakePjrtBuffer(
   return result;
 }
 
+struct RelayoutExecutableCacheKey {
+  PjRtDevice* device;
+  PrimitiveType element_type;
+  std::vector<int64_t> dimensions;
+  std::vector<int64_t> strides;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const RelayoutExecutableCacheKey& value) {
+    return H::combine(std::move(h), value.device, value.element_type,
+                      value.dimensions, value.strides);
+  }
+  bool operator==(const RelayoutExecutableCacheKey& other) const {
+    return device == other.device && element_type == other.element_type &&
+           dimensions == other.dimensions && strides == other.strides;
+  }
+};
+
+struct RelayoutExecutableCacheEntry {
+  // Keeps the client, and thus the device of the key, alive while the
+  // executable is cached.
+  std::shared_ptr<ifrt::Client> client;
+  std::shared_ptr<PjRtLoadedExecutable> executable;
+};
+
+// Returns the gather computation that MakeRelayoutedPjrtBuffer runs to import
+// a tensor with `dimensions` and `strides` on `device`. Tensors of the same
+// shape are usually imported repeatedly, so executables are cached.
+absl::StatusOr<std::shared_ptr<PjRtLoadedExecutable>> GetRelayoutExecutable(
+    std::shared_ptr<ifrt::Client> client, PjRtDevice& device,
+    PrimitiveType element_type, absl::Span<int64_t const> dimensions,
+    absl::Span<int64_t const> strides, int64_t extent) {
+  using CacheT = LRUCache<RelayoutExecutableCacheKey,
+                          std::shared_ptr<RelayoutExecutableCacheEntry>>;
+  static auto* mu = new absl::Mutex();
+  static auto* lru_list = new CacheT::LRUList(64);
+  static auto* cache = new CacheT(lru_list);
+
+  RelayoutExecutableCacheKey key{
+      &device, element_type,
+      std::vector<int64_t>(dimensions.begin(), dimensions.end()),
+      std::vector<int64_t>(strides.begin(), strides.end())};
+  std::shared_ptr<RelayoutExecutableCacheEntry> entry;
+  {
+    absl::MutexLock lock(mu);
+    entry = cache->GetOrCreateIfAbsent(
+        key, [](const RelayoutExecutableCacheKey&) {
+          return std::make_shared<RelayoutExecutableCacheEntry>();
+        });
+    if (entry->executable != nullptr) {
+      return entry->executable;
+    }
+  }
+
+  // View the memory spanned by the tensor as a flat array, and gather the
+  // elements at offsets `sum_i(index_i * stride_i)` from it.
+  Shape flat_shape = ShapeUtil::MakeShape(element_type, {extent});
+  XlaBuilder builder("dlpack_relayout");
+  XlaOp flat = Parameter(&builder, 0, flat_shape, "flat");
+  Shape index_shape = ShapeUtil::MakeShape(S64, dimensions);
+  XlaOp indices = Broadcast(ConstantR0<int64_t>(&builder, 0), dimensions);
+  for (int i = 0; i < dimensions.size(); ++i) {
+    indices = Add(indices, Mul(Iota(&builder, index_shape, i),
+                               ConstantR0<int64_t>(&builder, strides[i])));
+  }
+  GatherDimensionNumbers dnums;
+  dnums.add_collapsed_slice_dims(0);
+  dnums.add_start_index_map(0);
+  dnums.set_index_vector_dim(dimensions.size());
+  Gather(flat, indices, dnums, /*slice_sizes=*/{1});
+  TF_ASSIGN_OR_RETURN(XlaComputation computation, builder.Build());
+
+  CompileOptions options;
+  options.compile_portable_executable = true;
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<PjRtLoadedExecutable> executable,
+                      device.client()->Compile(computation, options));
+
+  // Concurrent imports of the same shape might have compiled it as well, in
+  // which case either executable can be used.
+  absl::MutexLock lock(mu);
+  entry->client = std::move(client);
+  entry->executable = executable;
+  return executable;
+}
+
+// Imports a DLPack tensor whose elements can't be viewed with the default
+// layout, e.g. because its strides describe a slice, a broadcast, or a
+// transposition of the underlying buffer. The elements are gathered into a new
+// buffer with the default layout: with a strided copy on CPU, and with a gather
+// computation on other devices, so that the data doesn't round-trip through
+// host memory.
+//
+// Takes ownership of `dlmt` only if it returns a buffer.
+absl::StatusOr<std::unique_ptr<PjRtBuffer>> MakeRelayoutedPjrtBuffer(
+    std::shared_ptr<ifrt::Client> client, PjRtDevice& device,
+    ::DLManagedTensor* dlmt, PrimitiveType element_type,
+    absl::Span<int64_t const> dimensions, absl::Span<int64_t const> strides) {
+  TF_RET_CHECK(strides.size() == dimensions.size());
+  void* data =
+      static_cast<char*>(dlmt->dl_tensor.data) + dlmt->dl_tensor.byte_offset;
+
+  if (dlmt->dl_tensor.device.device_type == kDLCPU) {
+    TF_ASSIGN_OR_RETURN(std::vector<int64_t> byte_strides,
+                        GetByteStrides(dlmt->dl_tensor));
+    TF_ASSIGN_OR_RETURN(
+        auto result,
+        device.client()->BufferFromHostBuffer(
+            data, element_type, dimensions, byte_strides,
+            PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall,
+            /*on_done_with_host_buffer=*/nullptr, &device));
+    if (dlmt->deleter) {
+      dlmt->deleter(dlmt);
+    }
+    return result;
+  }
+
+  int64_t extent = 1;
+  for (int i = 0; i < dimensions.size(); ++i) {
+    if (strides[i] < 0) {
+      return Unimplemented(
+          "DLPack tensors with negative strides are not supported. Strides "
+          "were [%s].",
+          absl::StrJoin(strides, ","));
+    }
+    extent += (dimensions[i] - 1) * strides[i];
+  }
+  Shape flat_shape = ShapeUtil::MakeShape(element_type, {extent});
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<PjRtLoadedExecutable> executable,
+                      GetRelayoutExecutable(std::move(client), device,
+                                            element_type, dimensions, strides,
+                                            extent));
+
+  // The view doesn't own the tensor: if anything fails before the gather is
+  // enqueued, the capsule still owns it.
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<PjRtBuffer> view,
+      device.client()->CreateViewOfDeviceBuffer(
+          data, flat_shape, &device, /*on_delete_callback=*/nullptr));
+  TF_ASSIGN_OR_RETURN(
+      std::vector<std::unique_ptr<PjRtBuffer>> results,
+      executable->ExecutePortable({view.get()}, &device, ExecuteOptions()));
+  TF_RET_CHECK(results.size() == 1);
+
+  // Release the tensor once the gather has read it.
+  results[0]->GetReadyFuture().OnReady(
+      [dlmt, view = std::move(view),
+       executable = std::move(executable)](absl::Status) mutable {
+        view.reset();
+        if (dlmt->deleter) {
+          dlmt->deleter(dlmt);
+        }
+      });
+  return std::move(results[0]);
+}
+
 }  // namespace
 
 absl::StatusOr<nb::capsule> BufferToDLPackManagedTensor(
@@ -477,44 +639,49 @@ absl::StatusOr<nb::object> DLPackManagedTensorToBuffer(
   TF_ASSIGN_OR_RETURN(PrimitiveType element_type,
                       DLDataTypeToPrimitiveType(dlmt->dl_tensor.dtype));
 
-  std::vector<int64_t> minor_to_major;
+  absl::Span<int64_t const> strides;
+  std::optional<std::vector<int64_t>> minor_to_major;
   if (dlmt->dl_tensor.strides &&
       absl::c_find(dimensions, 0) == dimensions.end()) {
-    absl::Span<int64_t const> strides(
+    strides = absl::Span<int64_t const>(
         reinterpret_cast<int64_t*>(dlmt->dl_tensor.strides),
         dlmt->dl_tensor.ndim);
-    TF_ASSIGN_OR_RETURN(minor_to_major, StridesToLayout(dimensions, strides));
+    absl::StatusOr<std::vector<int64_t>> layout =
+        StridesToLayout(dimensions, strides);
+    if (layout.ok()) {
+      minor_to_major = *std::move(layout);
+    }
   } else {
-    minor_to_major.resize(dlmt->dl_tensor.ndim);
-    std::iota(minor_to_major.rbegin(), minor_to_major.rend(), 0);
+    minor_to_major.emplace(dlmt->dl_tensor.ndim);
+    std::iota(minor_to_major->rbegin(), minor_to_major->rend(), 0);
   }
-  Shape shape = ShapeUtil::MakeShapeWithDenseLayout(element_type, dimensions,
-                                                    minor_to_major);
 
-  // Raise an error if the resulting PjRtBuffer would have a non-default layout.
+  // Relayout on device if the resulting PjRtBuffer would have a non-default
+  // layout.
   // TODO(skyewm): we do this because JAX doesn't currently have good support
   // for non-default layouts, and will return wrong results if a non-default
   // layout is passed to a computation expecting default layouts. Remove this
   // special case when non-default layouts are better supported by JAX.
   TF_ASSIGN_OR_RETURN(Layout default_layout, device->client()->GetDefaultLayout(
                                                  element_type, dimensions));
-  if (shape.layout() != default_layout) {
-    return Unimplemented(
-        "from_dlpack got array with non-default layout with minor-to-major "
-        "dimensions (%s), expected (%s)",
-        absl::StrJoin(shape.layout().minor_to_major(), ","),
-        absl::StrJoin(default_layout.minor_to_major(), ","));
-  }
-
-  std::function<void()> on_delete_callback;
-  if (dlmt->deleter) {
-    on_delete_callback = [dlmt]() { dlmt->deleter(dlmt); };
+  std::unique_ptr<PjRtBuffer> pjrt_buffer;
+  if (minor_to_major.has_value() &&
+      Layout(*minor_to_major) == default_layout) {
+    Shape shape = ShapeUtil::MakeShapeWithDenseLayout(element_type, dimensions,
+                                                      *minor_to_major);
+    TF_ASSIGN_OR_RETURN(
+        pjrt_buffer,
+        MakePjrtBuffer(*device, dlmt, shape, element_type, dimensions));
+  } else {
+    const nb_class_ptr<PyClient>& client =
+        (cpu_client && device->client() == cpu_pjrt_client) ? *cpu_client
+                                                             : *gpu_client;
+    TF_ASSIGN_OR_RETURN(
+        pjrt_buffer,
+        MakeRelayoutedPjrtBuffer(client->shared_ptr_ifrt_client(), *device,
+                                 dlmt, element_type, dimensions, strides));
   }
 
-  TF_ASSIGN_OR_RETURN(
-      auto pjrt_buffer,
-      MakePjrtBuffer(*device, dlmt, shape, element_type, dimensions));
-
   // We have taken ownership of the array inside the capsule; make sure the
   // capsule it cannot be used again.
   PyCapsule_SetName(tensor.ptr(), "used_dltensor");
@@ -567,23 +734,39 @@ absl::StatusOr<nb::object> DLPackManagedTensorToBuffer(
   TF_ASSIGN_OR_RETURN(PrimitiveType element_type,
                       DLDataTypeToPrimitiveType(dlmt->dl_tensor.dtype));
 
-  std::vector<int64_t> minor_to_major;
+  absl::Span<int64_t const> strides;
+  std::optional<std::vector<int64_t>> minor_to_major;
   if (dlmt->dl_tensor.strides &&
       absl::c_find(dimensions, 0) == dimensions.end()) {
-    absl::Span<int64_t const> strides(
+    strides = absl::Span<int64_t const>(
         reinterpret_cast<int64_t*>(dlmt->dl_tensor.strides),
         dlmt->dl_tensor.ndim);
-    TF_ASSIGN_OR_RETURN(minor_to_major, StridesToLayout(dimensions, strides));
+    absl::StatusOr<std::vector<int64_t>> layout =
+        StridesToLayout(dimensions, strides);
+    if (layout.ok()) {
+      minor_to_major = *std::move(layout);
+    }
   } else {
-    minor_to_major.resize(dlmt->dl_tensor.ndim);
-    std::iota(minor_to_major.rbegin(), minor_to_major.rend(), 0);
+    minor_to_major.emplace(dlmt->dl_tensor.ndim);
+    std::iota(minor_to_major->rbegin(), minor_to_major->rend(), 0);
   }
-  Shape shape = ShapeUtil::MakeShapeWithDenseLayout(element_type, dimensions,
-                                                    minor_to_major);
 
-  TF_ASSIGN_OR_RETURN(auto pjrt_buffer,
-                      MakePjrtBuffer(*device->pjrt_device(), dlmt, shape,
-                                     element_type, dimensions));
+  // Tensors with a compact layout, including transposed ones, are imported
+  // without a copy and keep their layout. Others are gathered on device.
+  std::unique_ptr<PjRtBuffer> pjrt_buffer;
+  if (minor_to_major.has_value()) {
+    Shape shape = ShapeUtil::MakeShapeWithDenseLayout(element_type, dimensions,
+                                                      *minor_to_major);
+    TF_ASSIGN_OR_RETURN(pjrt_buffer,
+                        MakePjrtBuffer(*device->pjrt_device(), dlmt, shape,
+                                       element_type, dimensions));
+  } else {
+    TF_ASSIGN_OR_RETURN(
+        pjrt_buffer,
+        MakeRelayoutedPjrtBuffer(client->shared_ptr_ifrt_client(),
+                                 *device->pjrt_device(), dlmt, element_type,
+                                 dimensions, strides));
+  }
 
   // We have taken ownership of the array inside the capsule; make sure the
   // capsule it cannot be used again.
@@ -603,6 +603,82 @@ TEST(ArrayImplTest, CopyToDifferentDevice) {
   }
 }
 
+TEST(ArrayImplTest, CopyShardedArrayToPermutedDevices) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, test_util::GetClient());
+
+  DType dtype(DType::kF32);
+  Shape shape({2, 3});
+  Device* device0 = client->addressable_devices().at(0);
+  Device* device1 = client->addressable_devices().at(1);
+  auto devices =
+      BasicDeviceList::Create(BasicDeviceList::Devices({device0, device1}));
+  auto permuted_devices =
+      BasicDeviceList::Create(BasicDeviceList::Devices({device1, device0}));
+
+  // Shards of a sharded array hold different data and have to move, while
+  // the shards of a replicated one coincide.
+  struct TestCase {
+    ShardingParam sharding_param;
+    Shape assembled_shape;
+    std::vector<float> offsets;
+  };
+  std::vector<TestCase> test_cases = {
+      {ShardingParam(/*dim_shards=*/{2, 1},
+                     {/*permutation=*/{0, 1}, /*axis_sizes=*/{2, 1}}),
+       Shape({4, 3}),
+       {0, 6}},
+      {ShardingParam(/*dim_shards=*/{1, 1},
+                     {/*permutation=*/{0}, /*axis_sizes=*/{2}}),
+       Shape({2, 3}),
+       {0, 0}},
+  };
+  for (TestCase& test_case : test_cases) {
+    std::vector<tsl::RCReference<Array>> shards;
+    for (int i = 0; i < 2; ++i) {
+      std::vector<float> data(6);
+      std::iota(data.begin(), data.end(), test_case.offsets[i]);
+      TF_ASSERT_OK_AND_ASSIGN(
+          shards.emplace_back(),
+          client->MakeArrayFromHostBuffer(
+              data.data(), dtype, shape,
+              /*byte_strides=*/std::nullopt,
+              SingleDeviceSharding::Create(devices->devices()[i], MemoryKind()),
+              Client::HostBufferSemantics::kImmutableOnlyDuringCall,
+              /*on_done_with_host_buffer=*/{}));
+    }
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::shared_ptr<const Sharding> sharding,
+        ShardingParamSharding::Create(test_case.sharding_param, devices,
+                                      MemoryKind()));
+    TF_ASSERT_OK_AND_ASSIGN(auto array,
+                            client->AssembleArrayFromSingleDeviceArrays(
+                                test_case.assembled_shape, sharding,
+                                absl::MakeSpan(shards),
+                                ArrayCopySemantics::kAlwaysCopy));
+
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto new_arrays,
+        client->CopyArrays(absl::MakeSpan(&array, 1), permuted_devices,
+                           MemoryKind(), ArrayCopySemantics::kAlwaysCopy));
+    TF_ASSERT_OK_AND_ASSIGN(auto new_shards,
+                            new_arrays[0]->DisassembleIntoSingleDeviceArrays(
+                                ArrayCopySemantics::kAlwaysCopy));
+    ASSERT_THAT(new_shards, SizeIs(2));
+    for (int i = 0; i < 2; ++i) {
+      EXPECT_THAT(new_shards[i]->sharding().devices()->devices(),
+                  ElementsAre(permuted_devices->devices()[i]));
+      std::vector<float> expected(6);
+      std::iota(expected.begin(), expected.end(), test_case.offsets[i]);
+      std::vector<float> out_data(6);
+      auto future = new_shards[i]->CopyToHostBuffer(
+          out_data.data(), /*byte_strides=*/std::nullopt,
+          ArrayCopySemantics::kAlwaysCopy);
+      TF_ASSERT_OK(future.Await());
+      EXPECT_THAT(out_data, ElementsAreArray(expected));
+    }
+  }
+}
+
 TEST(ArrayImplTest, CopyMixedSourceDevices) {
   TF_ASSERT_OK_AND_ASSIGN(auto client, test_util::GetClient());
 
@@ -85,6 +85,33 @@ Array::MakeArrayFromHostBuffer(
     *req->mutable_byte_strides() = ToByteStridesProto(*byte_strides);
   }
 
+  if (rpc_helper->version().protocol_version() >= 10) {
+    // The client assigns the array handle, so the array can be returned
+    // without waiting for the server. Requests that use the array are
+    // processed after this one, and fail with the same error if the server
+    // could not create the array.
+    const ArrayHandle handle{rpc_helper->NextHandle()};
+    req->set_array_handle(handle.handle);
+    rpc_helper->MakeArrayFromHostBuffer(std::move(req))
+        .OnReady([](absl::StatusOr<
+                     std::shared_ptr<MakeArrayFromHostBufferResponse>>
+                        response) {
+          if (!response.ok()) {
+            LOG(WARNING) << "Server returned an error when asked to make "
+                            "array from host buffer: "
+                         << response.status();
+          }
+        });
+
+    if (on_done_with_host_buffer != nullptr) {
+      std::move(on_done_with_host_buffer)();
+    }
+
+    return tsl::RCReference<xla::ifrt::Array>(
+        tsl::MakeRef<Array>(client, std::move(rpc_helper), dtype,
+                            std::move(shape), std::move(sharding), handle));
+  }
+
   TF_ASSIGN_OR_RETURN(
       auto response,
       rpc_helper->MakeArrayFromHostBuffer(std::move(req)).Await());
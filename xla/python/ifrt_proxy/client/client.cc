@@ -25,6 +25,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/log/log.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -275,18 +276,46 @@ Client::CopyArrays(
   }
   req->set_copy_semantics(ToArrayCopySemanticsProto(semantics));
 
-  auto future = rpc_helper_->CopyArrays(std::move(req));
-  TF_ASSIGN_OR_RETURN(auto response, future.Await());
+  std::vector<std::shared_ptr<const Sharding>> new_shardings;
+  new_shardings.reserve(arrays.size());
+  for (const auto& array : arrays) {
+    TF_ASSIGN_OR_RETURN(
+        new_shardings.emplace_back(),
+        array->sharding().WithDeviceAssignment(devices, memory_kind));
+  }
+
+  std::vector<ArrayHandle> new_handles;
+  new_handles.reserve(arrays.size());
+  if (rpc_helper_->version().protocol_version() >= 10) {
+    // Assign the result handles on the client so that the copied arrays can be
+    // used without waiting for the server to respond.
+    for (int i = 0; i < arrays.size(); ++i) {
+      new_handles.push_back(ArrayHandle{rpc_helper_->NextHandle()});
+      req->add_result_handles(new_handles.back().handle);
+    }
+    rpc_helper_->CopyArrays(std::move(req))
+        .OnReady(
+            [](absl::StatusOr<std::shared_ptr<CopyArraysResponse>> response) {
+              if (!response.ok()) {
+                LOG(WARNING)
+                    << "Server returned an error when asked to copy arrays: "
+                    << response.status();
+              }
+            });
+  } else {
+    auto future = rpc_helper_->CopyArrays(std::move(req));
+    TF_ASSIGN_OR_RETURN(auto response, future.Await());
+    for (const uint64_t handle : response->array_handles()) {
+      new_handles.push_back(ArrayHandle{handle});
+    }
+  }
 
   std::vector<tsl::RCReference<xla::ifrt::Array>> new_arrays;
   new_arrays.reserve(arrays.size());
-  for (int i = 0; i < response->array_handles_size(); ++i) {
-    TF_ASSIGN_OR_RETURN(
-        auto new_sharding,
-        arrays[i]->sharding().WithDeviceAssignment(devices, memory_kind));
+  for (int i = 0; i < new_handles.size(); ++i) {
     new_arrays.push_back(tsl::MakeRef<Array>(
         this, rpc_helper_, arrays[i]->dtype(), arrays[i]->shape(),
-        std::move(new_sharding), ArrayHandle{response->array_handles(i)}));
+        std::move(new_shardings[i]), new_handles[i]));
   }
   return new_arrays;
 }
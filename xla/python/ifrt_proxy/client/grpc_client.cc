@@ -52,7 +52,9 @@ namespace {
 // returns a non-OK status.
 absl::StatusOr<std::unique_ptr<Client>> AttemptConnection(
     absl::string_view server_address,
-    std::function<void(absl::Status)> on_disconnect, int attempt_no,
+    std::function<void(absl::Status)> on_disconnect,
+    const GrpcClientHostBufferStoreOptions& host_buffer_store_options,
+    int attempt_no,
     absl::AnyInvocable<void(absl::string_view)> log_initial_connection) {
   std::unique_ptr<RpcHelper> rpc_helper;
   auto init_response_promise =
@@ -130,7 +132,8 @@ absl::StatusOr<std::unique_ptr<Client>> AttemptConnection(
       Future<std::shared_ptr<InitResponse>>(init_response_promise).Await());
 
   auto host_buffer_store = std::make_unique<GrpcClientHostBufferStore>(
-      stub, metadata.version(), init_response->session_id());
+      stub, metadata.version(), init_response->session_id(),
+      host_buffer_store_options);
   rpc_helper->set_host_buffer_store(std::move(host_buffer_store));
 
   return Client::Create(std::move(rpc_helper), std::move(*init_response));
@@ -146,14 +149,19 @@ absl::StatusOr<std::unique_ptr<Client>> CreateGrpcClient(
         }
       };
 
+  GrpcClientHostBufferStoreOptions host_buffer_store_options;
+  host_buffer_store_options.use_shared_memory =
+      options.use_shared_memory_for_host_buffers;
+
   absl::Time start_time = absl::Now();
   absl::Status last_status;
   for (int i = 0; absl::Now() - start_time < options.connection_timeout; ++i) {
     log_initial_connection(absl::StrCat("Connecting to IFRT proxy server at ",
                                         server_address, ", attempt #", i,
                                         "..."));
-    absl::StatusOr<std::unique_ptr<Client>> result = AttemptConnection(
-        server_address, options.on_disconnect, i, log_initial_connection);
+    absl::StatusOr<std::unique_ptr<Client>> result =
+        AttemptConnection(server_address, options.on_disconnect,
+                          host_buffer_store_options, i, log_initial_connection);
     if (result.ok()) {
       log_initial_connection(absl::StrCat("Connected to IFRT proxy server on ",
                                           "attempt #", i, "."));
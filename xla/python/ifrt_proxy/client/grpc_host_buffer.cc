@@ -14,17 +14,24 @@
 
 #include "xla/python/ifrt_proxy/client/grpc_host_buffer.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/cleanup/cleanup.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "grpcpp/client_context.h"
 #include "grpcpp/support/client_callback.h"
 #include "grpcpp/support/status.h"
@@ -33,24 +40,33 @@
 #include "xla/python/ifrt/future.h"
 #include "xla/python/ifrt_proxy/common/grpc_ifrt_service.grpc.pb.h"
 #include "xla/python/ifrt_proxy/common/grpc_ifrt_service.pb.h"
+#include "xla/python/ifrt_proxy/common/shared_memory.h"
 #include "xla/tsl/protobuf/status.pb.h"
+#include "xla/util.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/snappy.h"
 #include "tsl/platform/unbounded_work_queue.h"
 
 namespace xla {
 namespace ifrt {
 namespace proxy {
 
-static constexpr int64_t kChunkSize = 1024 * 1024;
-
 GrpcClientHostBufferStore::GrpcClientHostBufferStore(
     std::shared_ptr<grpc::GrpcIfrtService::StubInterface> stub,
-    IfrtProxyVersion version, uint64_t session_id)
+    IfrtProxyVersion version, uint64_t session_id,
+    GrpcClientHostBufferStoreOptions options)
     : stub_(std::move(stub)),
       version_(std::move(version)),
       session_id_(session_id),
+      options_(std::move(options)),
       lookup_work_queue_(std::make_unique<tsl::UnboundedWorkQueue>(
-          tsl::Env::Default(), "HostBufferStoreLookupsWorkQueue")) {}
+          tsl::Env::Default(), "HostBufferStoreLookupsWorkQueue")),
+      store_work_queue_(std::make_unique<tsl::UnboundedWorkQueue>(
+          tsl::Env::Default(), "HostBufferStoreStoresWorkQueue")) {
+  CHECK_GT(options_.chunk_size, 0);
+  CHECK_GT(options_.max_num_streams, 0);
+}
 
 GrpcClientHostBufferStore::~GrpcClientHostBufferStore() {
   LOG(INFO) << "Waiting for destruction of HostBufferStoreLookupsWorkQueue...";
@@ -64,13 +80,95 @@ uint64_t GrpcClientHostBufferStore::NextHandle() {
 
 Future<> GrpcClientHostBufferStore::Store(uint64_t handle,
                                           absl::string_view data) {
+  // `Store()` returns only after all chunks were sent, so we can refer to
+  // `data` without copying it.
+  return Store(handle, absl::MakeCordFromExternal(data, [] {}));
+}
+
+Future<> GrpcClientHostBufferStore::Store(uint64_t handle,
+                                          const absl::Cord& data) {
   // The current implementation synchronously sends host buffer chunks. We may
   // consider making it asynchronous if the caller can leverage such asynchrony.
 
+  if (options_.use_shared_memory && version_.protocol_version() >= 9 &&
+      shared_memory_state_.load() != SharedMemoryState::kUnavailable) {
+    absl::StatusOr<bool> stored = TryStoreViaSharedMemory(handle, data);
+    if (!stored.ok() || *stored) {
+      return Future<>(stored.status());
+    }
+  }
+
+  const int64_t buffer_size = data.size();
+
+  // Older servers expect each buffer to be sent over a single stream.
+  int64_t num_stripes = 1;
+  if (version_.protocol_version() >= 8) {
+    num_stripes = std::clamp<int64_t>(
+        buffer_size / std::max<int64_t>(options_.min_stream_bytes, 1), 1,
+        options_.max_num_streams);
+  }
+  if (num_stripes == 1) {
+    return Future<>(StoreStripe(handle, buffer_size, /*offset=*/0, data));
+  }
+
+  // Keep stripe boundaries chunk-aligned so that every but the last chunk is a
+  // full chunk.
+  const int64_t stripe_size =
+      RoundUpTo(CeilOfRatio(buffer_size, num_stripes), options_.chunk_size);
+  num_stripes = CeilOfRatio(buffer_size, stripe_size);
+
+  std::vector<absl::Status> statuses(num_stripes);
+  absl::BlockingCounter stripes_done(num_stripes - 1);
+  auto store_stripe = [&](int64_t i) {
+    const int64_t offset = i * stripe_size;
+    statuses[i] = StoreStripe(
+        handle, buffer_size, offset,
+        data.Subcord(offset, std::min(stripe_size, buffer_size - offset)));
+  };
+  for (int64_t i = 1; i < num_stripes; ++i) {
+    store_work_queue_->Schedule([&, i]() {
+      store_stripe(i);
+      stripes_done.DecrementCount();
+    });
+  }
+  store_stripe(0);
+  stripes_done.Wait();
+
+  for (const absl::Status& status : statuses) {
+    if (!status.ok()) {
+      // The server keeps the stripes that were stored successfully until the
+      // buffer is complete, so free them explicitly.
+      Delete(handle).Await().IgnoreError();
+      return Future<>(status);
+    }
+  }
+  return Future<>(absl::OkStatus());
+}
+
+absl::StatusOr<bool> GrpcClientHostBufferStore::TryStoreViaSharedMemory(
+    uint64_t handle, const absl::Cord& data) {
+  const std::string name = SharedMemoryRegion::UniqueName("store");
+  absl::StatusOr<std::unique_ptr<SharedMemoryRegion>> region =
+      SharedMemoryRegion::Create(name, data.size());
+  if (!region.ok()) {
+    VLOG(1) << "Unable to store host buffer through shared memory: "
+            << region.status();
+    return false;
+  }
+  absl::Cleanup unlink = [&] {
+    SharedMemoryRegion::Unlink(name).IgnoreError();
+  };
+  char* dst = (*region)->data();
+  for (absl::string_view chunk : data.Chunks()) {
+    std::memcpy(dst, chunk.data(), chunk.size());
+    dst += chunk.size();
+  }
+
   GrpcHostBufferStoreMetadata metadata;
   metadata.set_session_id(session_id_);
   metadata.set_handle(handle);
   metadata.set_buffer_size(data.size());
+  metadata.set_shared_memory_name(name);
 
   ::grpc::ClientContext context;
   context.AddMetadata("ifrt-proxy-grpc-host-buffer-store-metadata-bin",
@@ -78,35 +176,68 @@ Future<> GrpcClientHostBufferStore::Store(uint64_t handle,
 
   GrpcHostBufferStoreResponse response;
   auto writer = stub_->HostBufferStore(&context, &response);
+  if (!writer->WritesDone()) {
+    return absl::InternalError("Failed to finish host buffer store");
+  }
+  absl::Status status = xla::FromGrpcStatus(writer->Finish());
 
-  for (int64_t offset = 0; offset < data.size(); offset += kChunkSize) {
-    GrpcHostBufferStoreRequest request;
-#if defined(PLATFORM_GOOGLE)
-    request.set_alias_data(data.substr(offset, kChunkSize));
-#else
-    // TODO(b/325306748): Find a way to not do a memory-copy.
-    request.set_data(std::string(data.substr(offset, kChunkSize)));
-#endif
-    writer->Write(request);
+  if (absl::IsFailedPrecondition(status)) {
+    if (shared_memory_state_.exchange(SharedMemoryState::kUnavailable) !=
+        SharedMemoryState::kUnavailable) {
+      LOG(WARNING) << "IFRT proxy server can't access client shared memory, "
+                   << "sending host buffers over the connection: " << status;
+    }
+    return false;
   }
+  TF_RETURN_IF_ERROR(status);
+  shared_memory_state_.store(SharedMemoryState::kAvailable);
+  return true;
+}
 
-  if (!writer->WritesDone()) {
-    return Future<>(
-        absl::InternalError("Failed to write all host buffer chunks"));
+absl::StatusOr<absl::Cord> GrpcClientHostBufferStore::LookupViaSharedMemory(
+    uint64_t handle) {
+  const std::string name = SharedMemoryRegion::UniqueName("lookup");
+
+  GrpcHostBufferLookupRequest request;
+  request.set_handle(handle);
+  request.set_session_id(session_id_);
+  request.set_shared_memory_name(name);
+
+  ::grpc::ClientContext context;
+  std::unique_ptr<::grpc::ClientReaderInterface<GrpcHostBufferLookupResponse>>
+      stream = stub_->HostBufferLookup(&context, request);
+  GrpcHostBufferLookupResponse response;
+  while (stream->Read(&response)) {
   }
+  TF_RETURN_IF_ERROR(xla::FromGrpcStatus(stream->Finish()));
 
-  return Future<>(xla::FromGrpcStatus(writer->Finish()));
-}
+  absl::StatusOr<std::unique_ptr<SharedMemoryRegion>> region =
+      SharedMemoryRegion::Open(name);
+  // The mapping stays valid after unlinking, so we can remove the name right
+  // away.
+  SharedMemoryRegion::Unlink(name).IgnoreError();
+  if (!region.ok()) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Unable to open host buffer shared memory: ",
+                     region.status().ToString()));
+  }
 
-Future<> GrpcClientHostBufferStore::Store(uint64_t handle,
-                                          const absl::Cord& data) {
-  // The current implementation synchronously sends host buffer chunks. We may
-  // consider making it asynchronous if the caller can leverage such asynchrony.
+  // Hand the mapping to the returned cord to avoid copying the buffer. The
+  // region is unmapped when the cord releases it.
+  absl::string_view data((*region)->data(), (*region)->size());
+  return absl::MakeCordFromExternal(data, [region = *std::move(region)]() {});
+}
 
+absl::Status GrpcClientHostBufferStore::StoreStripe(uint64_t handle,
+                                                    int64_t buffer_size,
+                                                    int64_t offset,
+                                                    const absl::Cord& stripe) {
   GrpcHostBufferStoreMetadata metadata;
   metadata.set_session_id(session_id_);
   metadata.set_handle(handle);
-  metadata.set_buffer_size(data.size());
+  metadata.set_buffer_size(buffer_size);
+  metadata.set_offset(offset);
+  metadata.set_stripe_size(stripe.size());
 
   ::grpc::ClientContext context;
   context.AddMetadata("ifrt-proxy-grpc-host-buffer-store-metadata-bin",
@@ -115,30 +246,57 @@ Future<> GrpcClientHostBufferStore::Store(uint64_t handle,
   GrpcHostBufferStoreResponse response;
   auto writer = stub_->HostBufferStore(&context, &response);
 
-  for (absl::string_view chunk : data.Chunks()) {
-    for (int64_t offset = 0; offset < chunk.size(); offset += kChunkSize) {
+  const bool compress =
+      options_.enable_compression && version_.protocol_version() >= 8;
+  const int64_t chunk_size = options_.chunk_size;
+  std::string compressed;
+  for (absl::string_view chunk : stripe.Chunks()) {
+    for (int64_t pos = 0; pos < chunk.size(); pos += chunk_size) {
+      absl::string_view piece = chunk.substr(pos, chunk_size);
       GrpcHostBufferStoreRequest request;
+      // Only send compressed data if it saves at least 1/8 of the bytes, as
+      // decompression is not free either.
+      if (compress &&
+          tsl::port::Snappy_Compress(piece.data(), piece.size(),
+                                     &compressed) &&
+          compressed.size() < piece.size() - piece.size() / 8) {
+        request.set_data(std::move(compressed));
+        request.set_compressed(true);
+      } else {
 #if defined(PLATFORM_GOOGLE)
-      request.set_alias_data(chunk.substr(offset, kChunkSize));
+        request.set_alias_data(piece);
 #else
-      // TODO(b/325306748): Find a way to not do a memory-copy.
-      request.set_data(std::string(chunk.substr(offset, kChunkSize)));
+        // TODO(b/325306748): Find a way to not do a memory-copy.
+        request.set_data(std::string(piece));
 #endif
+      }
       writer->Write(request);
     }
   }
   if (!writer->WritesDone()) {
-    return Future<>(
-        absl::InternalError("Failed to write all host buffer chunks"));
+    return absl::InternalError("Failed to write all host buffer chunks");
   }
 
-  return Future<>(xla::FromGrpcStatus(writer->Finish()));
+  return xla::FromGrpcStatus(writer->Finish());
 }
 
 Future<absl::Cord> GrpcClientHostBufferStore::Lookup(uint64_t handle) {
   auto promise = Future<absl::Cord>::CreatePromise();
 
   lookup_work_queue_->Schedule([this, handle, promise]() mutable -> void {
+    // Only use shared memory once a store has shown that the server can access
+    // it, as the server would otherwise leak objects on its own host.
+    if (options_.use_shared_memory &&
+        shared_memory_state_.load() == SharedMemoryState::kAvailable) {
+      absl::StatusOr<absl::Cord> data = LookupViaSharedMemory(handle);
+      if (!absl::IsFailedPrecondition(data.status())) {
+        promise.Set(std::move(data));
+        return;
+      }
+      VLOG(1) << "Falling back to looking up host buffer over the connection: "
+              << data.status();
+    }
+
     GrpcHostBufferLookupRequest request;
     request.set_handle(handle);
     request.set_session_id(session_id_);
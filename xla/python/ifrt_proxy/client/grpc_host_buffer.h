@@ -21,6 +21,7 @@
 #include <cstdint>
 #include <memory>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/string_view.h"
@@ -33,11 +34,35 @@ namespace xla {
 namespace ifrt {
 namespace proxy {
 
+struct GrpcClientHostBufferStoreOptions {
+  // Size of the chunks that host buffers are sent in.
+  int64_t chunk_size = 1024 * 1024;
+
+  // Maximum number of concurrent streams that a single host buffer is sent
+  // over. A single stream is often limited well below the link capacity.
+  int max_num_streams = 4;
+
+  // Minimum number of bytes sent over each stream. Buffers smaller than twice
+  // this size are sent over a single stream.
+  int64_t min_stream_bytes = 16 * 1024 * 1024;
+
+  // If true, chunks are compressed with Snappy if that makes them noticeably
+  // smaller, which helps with sparse or low-entropy buffers on slow links.
+  bool enable_compression = false;
+
+  // If true, host buffers are exchanged through POSIX shared memory instead of
+  // being sent over the connection if the server runs on the same host. The
+  // first stored buffer detects whether the server can access the client's
+  // shared memory; if not, all transfers fall back to the connection.
+  bool use_shared_memory = false;
+};
+
 class GrpcClientHostBufferStore : public ClientHostBufferStore {
  public:
   GrpcClientHostBufferStore(
       std::shared_ptr<grpc::GrpcIfrtService::StubInterface> stub,
-      IfrtProxyVersion version, uint64_t session_id);
+      IfrtProxyVersion version, uint64_t session_id,
+      GrpcClientHostBufferStoreOptions options = {});
 
   ~GrpcClientHostBufferStore() override;
 
@@ -50,10 +75,30 @@ class GrpcClientHostBufferStore : public ClientHostBufferStore {
   Future<> Delete(uint64_t handle) override;
 
  private:
+  enum class SharedMemoryState { kUnknown, kAvailable, kUnavailable };
+
+  // Stores `data` through shared memory. Returns false if shared memory can't
+  // be used and the buffer must be sent over the connection instead.
+  absl::StatusOr<bool> TryStoreViaSharedMemory(uint64_t handle,
+                                               const absl::Cord& data);
+
+  // Looks up the buffer through shared memory. Returns `FAILED_PRECONDITION`
+  // if shared memory can't be used.
+  absl::StatusOr<absl::Cord> LookupViaSharedMemory(uint64_t handle);
+
+  // Sends the `stripe` of the `buffer_size`-byte buffer starting at `offset`
+  // over a single stream.
+  absl::Status StoreStripe(uint64_t handle, int64_t buffer_size,
+                           int64_t offset, const absl::Cord& stripe);
+
   const std::shared_ptr<grpc::GrpcIfrtService::StubInterface> stub_;
   const IfrtProxyVersion version_;
   const uint64_t session_id_;
+  const GrpcClientHostBufferStoreOptions options_;
   std::atomic<uint64_t> next_handle_ = 0;
+  std::atomic<SharedMemoryState> shared_memory_state_ =
+      SharedMemoryState::kUnknown;
+
 
   // Implementation note: `lookup_work_queue_` may have closures that invoke
   // user-defined code. Each `Lookup()` call is associated with a scheduled
@@ -61,6 +106,9 @@ class GrpcClientHostBufferStore : public ClientHostBufferStore {
   // streaming RPC, and then to do `promise.Set()` for the Future returned to
   // the caller.
   std::unique_ptr<tsl::UnboundedWorkQueue> lookup_work_queue_;
+
+  // Runs the stores of all but the first stripe of striped host buffers.
+  std::unique_ptr<tsl::UnboundedWorkQueue> store_work_queue_;
 };
 
 }  // namespace proxy
@@ -48,6 +48,7 @@ namespace {
 struct PyClientConnectionOptions {
   std::optional<std::function<void(std::string)>> on_disconnect;
   std::optional<std::function<void(std::string)>> on_connection_update;
+  bool use_shared_memory_for_host_buffers = false;
 };
 
 absl::StatusOr<nb_class_ptr<PyClient>> GetClient(
@@ -57,6 +58,8 @@ absl::StatusOr<nb_class_ptr<PyClient>> GetClient(
   std::unique_ptr<xla::ifrt::Client> client;
 
   ClientConnectionOptions options;
+  options.use_shared_memory_for_host_buffers =
+      py_options.use_shared_memory_for_host_buffers;
   if (py_options.on_disconnect) {
     // While it is possible to pass around `py_options.on_disconnect` without
     // wrapping it via a shared_ptr, copying the `py_options.on_disconnect`
@@ -110,7 +113,9 @@ void BuildIfrtProxySubmodule(nb::module_& m) {
               nb::arg().none())
       .def_rw("on_connection_update",
               &PyClientConnectionOptions::on_connection_update,
-              nb::arg().none());
+              nb::arg().none())
+      .def_rw("use_shared_memory_for_host_buffers",
+              &PyClientConnectionOptions::use_shared_memory_for_host_buffers);
 
   sub_module.def("get_client", xla::ValueOrThrowWrapper(GetClient),
                  nb::arg("proxy_server_address"), nb::arg("options"));
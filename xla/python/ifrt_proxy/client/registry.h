@@ -45,6 +45,10 @@ struct ClientConnectionOptions {
   // synchronously from a thread that performs various important activities,
   // so the function should not block (or deadlocks may happen).
   std::function<void(absl::string_view)> on_connection_update = nullptr;
+
+  // If true, host buffers are exchanged through shared memory instead of being
+  // sent over the connection if the proxy server runs on the same host.
+  bool use_shared_memory_for_host_buffers = false;
 };
 
 // Registers a new factory for client backend implementation. Crashes if the
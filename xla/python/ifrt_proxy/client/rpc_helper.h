@@ -17,6 +17,7 @@
 #ifndef XLA_PYTHON_IFRT_PROXY_CLIENT_RPC_HELPER_H_
 #define XLA_PYTHON_IFRT_PROXY_CLIENT_RPC_HELPER_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <utility>
@@ -143,6 +144,14 @@ class RpcHelper {
 
   Future<> CheckFuture(uint64_t handle);
 
+  // Returns a new array handle that the client assigns to an array it asks the
+  // server to create, so that dependent requests can be sent without waiting
+  // for the response. Client-assigned handles have the most significant bit
+  // set and never collide with handles generated by the server.
+  uint64_t NextHandle() {
+    return next_handle_.fetch_add(1, std::memory_order_relaxed);
+  }
+
  private:
   const std::unique_ptr<Batcher> batcher_;
 
@@ -151,6 +160,9 @@ class RpcHelper {
 
   absl::Mutex mu_;
   uint64_t next_op_id_ ABSL_GUARDED_BY(mu_) = 1;
+
+  static constexpr uint64_t kClientHandleBase = uint64_t{1} << 63;
+  std::atomic<uint64_t> next_handle_ = kClientHandleBase;
 };
 
 }  // namespace proxy
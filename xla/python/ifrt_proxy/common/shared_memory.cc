@@ -0,0 +1,175 @@
+// Copyright 2024 The OpenXLA Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xla/python/ifrt_proxy/common/shared_memory.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace xla {
+namespace ifrt {
+namespace proxy {
+
+#if !defined(_WIN32)
+
+namespace {
+
+absl::Status ErrnoToStatus(absl::string_view what, absl::string_view name) {
+  const int error = errno;
+  std::string message =
+      absl::StrCat(what, " of shared memory object ", name,
+                   " failed: ", std::strerror(error));
+  switch (error) {
+    case ENOENT:
+      return absl::NotFoundError(message);
+    case EEXIST:
+      return absl::AlreadyExistsError(message);
+    case EACCES:
+    case EPERM:
+      return absl::PermissionDeniedError(message);
+    default:
+      return absl::InternalError(message);
+  }
+}
+
+// Maps `size` bytes of `fd`, or returns a dummy pointer for empty objects that
+// can't be mapped.
+absl::StatusOr<char*> Map(int fd, size_t size, int prot,
+                          absl::string_view name) {
+  if (size == 0) {
+    static char empty;
+    return &empty;
+  }
+  void* data = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    return ErrnoToStatus("mmap", name);
+  }
+  return static_cast<char*>(data);
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<SharedMemoryRegion>> SharedMemoryRegion::Create(
+    absl::string_view name, size_t size) {
+  std::string name_str(name);
+  int fd = shm_open(name_str.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return ErrnoToStatus("shm_open", name);
+  }
+  if (ftruncate(fd, size) != 0) {
+    absl::Status status = ErrnoToStatus("ftruncate", name);
+    close(fd);
+    shm_unlink(name_str.c_str());
+    return status;
+  }
+  absl::StatusOr<char*> data = Map(fd, size, PROT_READ | PROT_WRITE, name);
+  close(fd);
+  if (!data.ok()) {
+    shm_unlink(name_str.c_str());
+    return data.status();
+  }
+  return absl::WrapUnique(new SharedMemoryRegion(*data, size));
+}
+
+absl::StatusOr<std::unique_ptr<SharedMemoryRegion>> SharedMemoryRegion::Open(
+    absl::string_view name) {
+  std::string name_str(name);
+  int fd = shm_open(name_str.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return ErrnoToStatus("shm_open", name);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    absl::Status status = ErrnoToStatus("fstat", name);
+    close(fd);
+    return status;
+  }
+  const size_t size = st.st_size;
+  absl::StatusOr<char*> data = Map(fd, size, PROT_READ, name);
+  close(fd);
+  if (!data.ok()) {
+    return data.status();
+  }
+  return absl::WrapUnique(new SharedMemoryRegion(*data, size));
+}
+
+absl::Status SharedMemoryRegion::Unlink(absl::string_view name) {
+  if (shm_unlink(std::string(name).c_str()) != 0) {
+    return ErrnoToStatus("shm_unlink", name);
+  }
+  return absl::OkStatus();
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+  if (size_ > 0) {
+    munmap(data_, size_);
+  }
+}
+
+#else  // defined(_WIN32)
+
+absl::StatusOr<std::unique_ptr<SharedMemoryRegion>> SharedMemoryRegion::Create(
+    absl::string_view name, size_t size) {
+  return absl::UnimplementedError("Shared memory is not supported");
+}
+
+absl::StatusOr<std::unique_ptr<SharedMemoryRegion>> SharedMemoryRegion::Open(
+    absl::string_view name) {
+  return absl::UnimplementedError("Shared memory is not supported");
+}
+
+absl::Status SharedMemoryRegion::Unlink(absl::string_view name) {
+  return absl::UnimplementedError("Shared memory is not supported");
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() = default;
+
+#endif  // defined(_WIN32)
+
+std::string SharedMemoryRegion::UniqueName(absl::string_view tag) {
+  static std::atomic<uint64_t> next_id = 0;
+#if !defined(_WIN32)
+  const int64_t pid = getpid();
+#else
+  const int64_t pid = 0;
+#endif
+  // The time stamp avoids collisions with objects leaked by an earlier process
+  // with the same pid.
+  return absl::StrCat("/ifrt-proxy-", tag, "-", pid, "-",
+                      absl::ToUnixNanos(absl::Now()), "-",
+                      next_id.fetch_add(1, std::memory_order_relaxed));
+}
+
+}  // namespace proxy
+}  // namespace ifrt
+}  // namespace xla
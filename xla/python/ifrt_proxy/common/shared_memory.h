@@ -0,0 +1,75 @@
+/*
+ * Copyright 2024 The OpenXLA Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XLA_PYTHON_IFRT_PROXY_COMMON_SHARED_MEMORY_H_
+#define XLA_PYTHON_IFRT_PROXY_COMMON_SHARED_MEMORY_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace xla {
+namespace ifrt {
+namespace proxy {
+
+// A mapping of a named POSIX shared memory object. Used to exchange host
+// buffers between an IFRT proxy client and server that run on the same host
+// without sending the bytes over the connection.
+class SharedMemoryRegion {
+ public:
+  // Creates a new shared memory object `name` of `size` bytes and maps it
+  // read-write. Fails if an object with this name already exists.
+  static absl::StatusOr<std::unique_ptr<SharedMemoryRegion>> Create(
+      absl::string_view name, size_t size);
+
+  // Maps the existing shared memory object `name` read-only.
+  static absl::StatusOr<std::unique_ptr<SharedMemoryRegion>> Open(
+      absl::string_view name);
+
+  // Removes the name of a shared memory object. Existing mappings stay valid
+  // and the memory is released once the last one is unmapped.
+  static absl::Status Unlink(absl::string_view name);
+
+  // Returns a name for a shared memory object that is unique on this host.
+  // `tag` is included to make the name easier to recognize.
+  static std::string UniqueName(absl::string_view tag);
+
+  ~SharedMemoryRegion();
+
+  SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+  SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+  // Returns the mapped memory. Must not be written to if the region was
+  // created with `Open()`.
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  SharedMemoryRegion(char* data, size_t size) : data_(data), size_(size) {}
+
+  char* data_;
+  size_t size_;
+};
+
+}  // namespace proxy
+}  // namespace ifrt
+}  // namespace xla
+
+#endif  // XLA_PYTHON_IFRT_PROXY_COMMON_SHARED_MEMORY_H_
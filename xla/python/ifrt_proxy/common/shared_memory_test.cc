@@ -0,0 +1,75 @@
+// Copyright 2024 The OpenXLA Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xla/python/ifrt_proxy/common/shared_memory.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace ifrt {
+namespace proxy {
+namespace {
+
+using ::testing::Ne;
+using ::tsl::testing::IsOk;
+using ::tsl::testing::StatusIs;
+
+TEST(SharedMemoryRegionTest, CreateAndOpen) {
+  const std::string name = SharedMemoryRegion::UniqueName("test");
+  constexpr absl::string_view kData = "foobar";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto writer,
+                          SharedMemoryRegion::Create(name, kData.size()));
+  std::memcpy(writer->data(), kData.data(), kData.size());
+
+  TF_ASSERT_OK_AND_ASSIGN(auto reader, SharedMemoryRegion::Open(name));
+  EXPECT_EQ(absl::string_view(reader->data(), reader->size()), kData);
+
+  EXPECT_THAT(SharedMemoryRegion::Create(name, kData.size()),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+
+  // Mappings stay valid after the name has been removed.
+  ASSERT_THAT(SharedMemoryRegion::Unlink(name), IsOk());
+  EXPECT_EQ(absl::string_view(reader->data(), reader->size()), kData);
+  EXPECT_THAT(SharedMemoryRegion::Open(name),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(SharedMemoryRegionTest, Empty) {
+  const std::string name = SharedMemoryRegion::UniqueName("test");
+
+  TF_ASSERT_OK_AND_ASSIGN(auto writer, SharedMemoryRegion::Create(name, 0));
+  TF_ASSERT_OK_AND_ASSIGN(auto reader, SharedMemoryRegion::Open(name));
+  EXPECT_EQ(reader->size(), 0);
+  ASSERT_THAT(SharedMemoryRegion::Unlink(name), IsOk());
+}
+
+TEST(SharedMemoryRegionTest, UniqueNames) {
+  EXPECT_THAT(SharedMemoryRegion::UniqueName("test"),
+              Ne(SharedMemoryRegion::UniqueName("test")));
+}
+
+}  // namespace
+}  // namespace proxy
+}  // namespace ifrt
+}  // namespace xla
@@ -35,10 +35,14 @@ class ConnectionOptions:
     on_connection_update: Optional, a callback that will be called with status
       updates about initial connection establishment. The updates will be
       provided as human-readable strings, and an end-user may find them helpful.
+    use_shared_memory_for_host_buffers: If true, host buffers are exchanged
+      through shared memory instead of being sent over the connection if the
+      proxy server runs on the same host.
   """
 
   on_disconnect: Optional[Callable[[str], None]] = None
   on_connection_update: Optional[Callable[[str], None]] = None
+  use_shared_memory_for_host_buffers: bool = False
 
 
 _backend_created: bool = False
@@ -53,6 +57,9 @@ def get_client(proxy_server_address: str) -> xla_client.Client:
   cpp_options = py_module.ClientConnectionOptions()
   cpp_options.on_disconnect = _connection_options.on_disconnect
   cpp_options.on_connection_update = _connection_options.on_connection_update
+  cpp_options.use_shared_memory_for_host_buffers = (
+      _connection_options.use_shared_memory_for_host_buffers
+  )
   client = py_module.get_client(proxy_server_address, cpp_options)
   return client
 
@@ -15,7 +15,9 @@
 #include "xla/python/ifrt_proxy/server/grpc_service_impl.h"
 
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -33,8 +35,10 @@
 #include "xla/pjrt/distributed/util.h"
 #include "xla/python/ifrt_proxy/common/grpc_ifrt_service.pb.h"
 #include "xla/python/ifrt_proxy/common/proto_util.h"
+#include "xla/python/ifrt_proxy/common/shared_memory.h"
 #include "xla/python/ifrt_proxy/server/host_buffer.h"
 #include "xla/python/ifrt_proxy/server/version.h"
+#include "tsl/platform/snappy.h"
 
 namespace xla {
 namespace ifrt {
@@ -146,26 +150,84 @@ namespace proxy {
                           "Unable to parse GrpcHostBufferStoreMetadata");
   }
 
-  std::string data;
-  data.reserve(metadata.buffer_size());
-
-  GrpcHostBufferStoreRequest request;
-  while (stream->Read(&request)) {
-    data.append(request.data());
-  }
-  if (data.size() != metadata.buffer_size()) {
+  const int64_t offset = metadata.offset();
+  const int64_t stripe_size = metadata.stripe_size() > 0
+                                  ? metadata.stripe_size()
+                                  : metadata.buffer_size() - offset;
+  if (offset < 0 || stripe_size < 0 ||
+      offset + stripe_size > metadata.buffer_size()) {
     return ::grpc::Status(
-        ::grpc::StatusCode::DATA_LOSS,
-        absl::StrCat("Potential data loss for host buffers: expected ",
-                     metadata.buffer_size(), " bytes but got ", data.size(),
-                     " bytes"));
+        ::grpc::StatusCode::INVALID_ARGUMENT,
+        absl::StrCat("Invalid host buffer stripe: offset ", offset, ", size ",
+                     stripe_size, ", buffer size ", metadata.buffer_size()));
   }
 
   auto store = GetHostBufferStore(metadata.session_id());
   if (!store.ok()) {
     return xla::ToGrpcStatus(store.status());
   }
-  return xla::ToGrpcStatus((*store)->Store(metadata.handle(), std::move(data)));
+
+  if (!metadata.shared_memory_name().empty()) {
+    auto region = SharedMemoryRegion::Open(metadata.shared_memory_name());
+    if (!region.ok()) {
+      return ::grpc::Status(::grpc::StatusCode::FAILED_PRECONDITION,
+                            region.status().ToString());
+    }
+    if (static_cast<int64_t>((*region)->size()) != metadata.buffer_size()) {
+      return ::grpc::Status(
+          ::grpc::StatusCode::DATA_LOSS,
+          absl::StrCat("Host buffer shared memory has ", (*region)->size(),
+                       " bytes, expected ", metadata.buffer_size()));
+    }
+    return xla::ToGrpcStatus((*store)->Store(
+        metadata.handle(), std::string((*region)->data(), (*region)->size())));
+  }
+
+  auto buffer = (*store)->GetOrCreatePendingBuffer(metadata.handle(),
+                                                   metadata.buffer_size());
+  if (!buffer.ok()) {
+    return xla::ToGrpcStatus(buffer.status());
+  }
+  auto abort = [&](absl::Status status) {
+    (*store)->AbortPendingBuffer(metadata.handle(), *buffer);
+    return xla::ToGrpcStatus(status);
+  };
+
+  // Chunks are written into the final buffer as they arrive, so that no copy
+  // is needed once the last chunk was received.
+  char* stripe = (*buffer)->data() + offset;
+  int64_t received = 0;
+  GrpcHostBufferStoreRequest request;
+  while (stream->Read(&request)) {
+    const auto& data = request.data();
+    if (request.compressed()) {
+      size_t uncompressed_size;
+      if (!tsl::port::Snappy_GetUncompressedLength(data.data(), data.size(),
+                                                   &uncompressed_size) ||
+          received + static_cast<int64_t>(uncompressed_size) > stripe_size ||
+          !tsl::port::Snappy_Uncompress(data.data(), data.size(),
+                                        stripe + received)) {
+        return abort(absl::DataLossError(
+            "Unable to decompress host buffer chunk"));
+      }
+      received += uncompressed_size;
+    } else {
+      if (received + static_cast<int64_t>(data.size()) > stripe_size) {
+        return abort(absl::DataLossError(absl::StrCat(
+            "Received more than ", stripe_size, " bytes for host buffer")));
+      }
+      std::memcpy(stripe + received, data.data(), data.size());
+      received += data.size();
+    }
+  }
+  if (received != stripe_size) {
+    return abort(absl::DataLossError(absl::StrCat(
+        "Potential data loss for host buffers: expected ", stripe_size,
+        " bytes but got ", received, " bytes")));
+  }
+
+  return xla::ToGrpcStatus((*store)->FinishStripe(metadata.handle(), *buffer,
+                                                  stripe_size));
 }
 
 ::grpc::Status GrpcServiceImpl::HostBufferLookup(
@@ -182,6 +244,17 @@ namespace proxy {
     return xla::ToGrpcStatus(data.status());
   }
 
+  if (!request->shared_memory_name().empty()) {
+    auto region = SharedMemoryRegion::Create(request->shared_memory_name(),
+                                             (*data)->size());
+    if (!region.ok()) {
+      return ::grpc::Status(::grpc::StatusCode::FAILED_PRECONDITION,
+                            region.status().ToString());
+    }
+    std::memcpy((*region)->data(), (*data)->data(), (*data)->size());
+    return ::grpc::Status::OK;
+  }
+
   GrpcHostBufferLookupResponse response;
   if (!(*data)->empty()) {
     for (int64_t offset = 0; offset < (*data)->size(); offset += kChunkSize) {
@@ -44,6 +44,7 @@ namespace ifrt {
 namespace proxy {
 namespace {
 
+using ::testing::Pointee;
 using ::tsl::testing::IsOk;
 using ::tsl::testing::IsOkAndHolds;
 using ::tsl::testing::StatusIs;
@@ -138,6 +139,48 @@ TEST_P(GrpcIfrtServiceImplHostBufferTest, StoreAndLookupCord) {
   EXPECT_TRUE(impl_.Test_DeleteHostBufferStore(kSessionId));
 }
 
+TEST_P(GrpcIfrtServiceImplHostBufferTest, StoreAndLookupStripedCompressed) {
+  static constexpr uint64_t kSessionId = 1;
+
+  auto store = std::make_shared<HostBufferStore>();
+  ASSERT_TRUE(impl_.Test_InsertHostBufferStore(kSessionId, store));
+  GrpcClientHostBufferStoreOptions options;
+  options.chunk_size = 64 * 1024;
+  options.max_num_streams = 3;
+  options.min_stream_bytes = 256 * 1024;
+  options.enable_compression = true;
+  GrpcClientHostBufferStore client(stub_, Version(), kSessionId, options);
+
+  constexpr uint64_t kHandle = 2;
+  const std::string data = GetTestData();
+
+  ASSERT_THAT(client.Store(kHandle, absl::string_view(data)).Await(), IsOk());
+  EXPECT_THAT(client.Lookup(kHandle).Await(), IsOkAndHolds(data));
+
+  EXPECT_TRUE(impl_.Test_DeleteHostBufferStore(kSessionId));
+}
+
+TEST_P(GrpcIfrtServiceImplHostBufferTest, StoreAndLookupSharedMemory) {
+  static constexpr uint64_t kSessionId = 1;
+
+  auto store = std::make_shared<HostBufferStore>();
+  ASSERT_TRUE(impl_.Test_InsertHostBufferStore(kSessionId, store));
+  GrpcClientHostBufferStoreOptions options;
+  options.use_shared_memory = true;
+  GrpcClientHostBufferStore client(stub_, Version(), kSessionId, options);
+
+  constexpr uint64_t kHandle = 2;
+  const std::string data = GetTestData();
+
+  // The first store detects that the server can access the shared memory and
+  // enables it for lookups.
+  ASSERT_THAT(client.Store(kHandle, absl::Cord(data)).Await(), IsOk());
+  EXPECT_THAT(store->Lookup(kHandle), IsOkAndHolds(Pointee(data)));
+  EXPECT_THAT(client.Lookup(kHandle).Await(), IsOkAndHolds(data));
+
+  EXPECT_TRUE(impl_.Test_DeleteHostBufferStore(kSessionId));
+}
+
 TEST_P(GrpcIfrtServiceImplHostBufferTest, Lookup) {
   static constexpr uint64_t kSessionId = 1;
 
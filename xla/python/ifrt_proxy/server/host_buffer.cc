@@ -14,15 +14,18 @@
 
 #include "xla/python/ifrt_proxy/server/host_buffer.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
+#include "tsl/platform/statusor.h"
 
 namespace xla {
 namespace ifrt {
@@ -30,6 +33,10 @@ namespace proxy {
 
 absl::Status HostBufferStore::Store(uint64_t handle, std::string data) {
   absl::MutexLock lock(&mu_);
+  if (pending_buffers_.contains(handle)) {
+    return absl::AlreadyExistsError(
+        absl::StrCat("Host buffer handle ", handle, " already exists"));
+  }
   const bool inserted =
       buffers_.insert({handle, std::make_shared<std::string>(std::move(data))})
           .second;
@@ -53,13 +60,92 @@ absl::StatusOr<std::shared_ptr<const std::string>> HostBufferStore::Lookup(
 
 absl::Status HostBufferStore::Delete(uint64_t handle) {
   absl::MutexLock lock(&mu_);
-  if (buffers_.erase(handle) == 0) {
+  if (buffers_.erase(handle) == 0 && pending_buffers_.erase(handle) == 0) {
     return absl::NotFoundError(
         absl::StrCat("Host buffer handle ", handle, " not found"));
   }
   return absl::OkStatus();
 }
 
+absl::StatusOr<std::shared_ptr<std::string>>
+HostBufferStore::GetOrCreatePendingBuffer(uint64_t handle,
+                                          int64_t buffer_size) {
+  auto get_pending_buffer =
+      [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_)
+          -> absl::StatusOr<std::shared_ptr<std::string>> {
+    if (buffers_.contains(handle)) {
+      return absl::AlreadyExistsError(
+          absl::StrCat("Host buffer handle ", handle, " already exists"));
+    }
+    const auto it = pending_buffers_.find(handle);
+    if (it == pending_buffers_.end()) {
+      return nullptr;
+    }
+    if (static_cast<int64_t>(it->second.data->size()) != buffer_size) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Host buffer handle ", handle, " is being stored with ",
+          it->second.data->size(), " bytes, but got a stripe for a buffer of ",
+          buffer_size, " bytes"));
+    }
+    return it->second.data;
+  };
+
+  {
+    absl::MutexLock lock(&mu_);
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<std::string> buffer,
+                        get_pending_buffer());
+    if (buffer != nullptr) {
+      return buffer;
+    }
+  }
+
+  // Allocate the buffer without holding the lock as it might be large. If
+  // another stripe of the same buffer races with us, we use its buffer.
+  auto buffer = std::make_shared<std::string>(buffer_size, '\0');
+
+  absl::MutexLock lock(&mu_);
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<std::string> existing,
+                      get_pending_buffer());
+  if (existing != nullptr) {
+    return existing;
+  }
+  pending_buffers_.insert({handle, PendingBuffer{buffer, buffer_size}});
+  return buffer;
+}
+
+absl::Status HostBufferStore::FinishStripe(
+    uint64_t handle, const std::shared_ptr<std::string>& buffer,
+    int64_t stripe_size) {
+  absl::MutexLock lock(&mu_);
+  const auto it = pending_buffers_.find(handle);
+  if (it == pending_buffers_.end() || it->second.data != buffer) {
+    return absl::AbortedError(
+        absl::StrCat("Store of host buffer handle ", handle, " was aborted"));
+  }
+
+  PendingBuffer& pending = it->second;
+  pending.remaining_bytes -= stripe_size;
+  if (pending.remaining_bytes < 0) {
+    pending_buffers_.erase(it);
+    return absl::DataLossError(absl::StrCat(
+        "Received more bytes than expected for host buffer handle ", handle));
+  }
+  if (pending.remaining_bytes == 0) {
+    buffers_.insert({handle, std::move(pending.data)});
+    pending_buffers_.erase(it);
+  }
+  return absl::OkStatus();
+}
+
+void HostBufferStore::AbortPendingBuffer(
+    uint64_t handle, const std::shared_ptr<std::string>& buffer) {
+  absl::MutexLock lock(&mu_);
+  const auto it = pending_buffers_.find(handle);
+  if (it != pending_buffers_.end() && it->second.data == buffer) {
+    pending_buffers_.erase(it);
+  }
+}
+
 }  // namespace proxy
 }  // namespace ifrt
 }  // namespace xla
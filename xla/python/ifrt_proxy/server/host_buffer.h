@@ -17,6 +17,7 @@
 #ifndef XLA_PYTHON_IFRT_PROXY_SERVER_HOST_BUFFER_H_
 #define XLA_PYTHON_IFRT_PROXY_SERVER_HOST_BUFFER_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -45,14 +46,43 @@ class HostBufferStore {
   // handle does not exist.
   absl::StatusOr<std::shared_ptr<const std::string>> Lookup(uint64_t handle);
 
-  // Deletes the host buffer associated with the handle. Returns an error if the
-  // handle does not exist.
+  // Deletes the host buffer associated with the handle. Deleting a buffer that
+  // is still being stored aborts the store. Returns an error if the handle
+  // does not exist.
   absl::Status Delete(uint64_t handle);
 
+  // Large host buffers can be stored as several disjoint stripes that are
+  // received concurrently and written directly into the final buffer.
+  //
+  // Returns the pending `buffer_size`-byte buffer for the handle, creating it
+  // if this is the first stripe. Returns an error if the handle already exists
+  // or if a pending buffer of a different size exists.
+  absl::StatusOr<std::shared_ptr<std::string>> GetOrCreatePendingBuffer(
+      uint64_t handle, int64_t buffer_size);
+
+  // Records that `stripe_size` bytes of the pending `buffer` have been written.
+  // The buffer becomes visible to `Lookup()` once all of its bytes have been
+  // written. Returns an error if the transfer was aborted.
+  absl::Status FinishStripe(uint64_t handle,
+                            const std::shared_ptr<std::string>& buffer,
+                            int64_t stripe_size);
+
+  // Drops the pending `buffer`, e.g., because one of its stripes failed. The
+  // remaining stripes will fail in `FinishStripe()`.
+  void AbortPendingBuffer(uint64_t handle,
+                          const std::shared_ptr<std::string>& buffer);
+
  private:
+  struct PendingBuffer {
+    std::shared_ptr<std::string> data;
+    int64_t remaining_bytes;
+  };
+
   absl::Mutex mu_;
   absl::flat_hash_map<uint64_t, std::shared_ptr<const std::string>> buffers_
       ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<uint64_t, PendingBuffer> pending_buffers_
+      ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace proxy
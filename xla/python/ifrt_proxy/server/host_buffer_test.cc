@@ -21,6 +21,7 @@
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
 #include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
 
 namespace xla {
 namespace ifrt {
@@ -43,6 +44,56 @@ TEST(HostBufferStoreTest, ReadAfterWrite) {
   EXPECT_THAT(store.Lookup(kHandle), StatusIs(absl::StatusCode::kNotFound));
 }
 
+TEST(HostBufferStoreTest, StripedStore) {
+  HostBufferStore store;
+  const uint64_t kHandle = 1;
+
+  TF_ASSERT_OK_AND_ASSIGN(auto buffer,
+                          store.GetOrCreatePendingBuffer(kHandle, 6));
+  TF_ASSERT_OK_AND_ASSIGN(auto same_buffer,
+                          store.GetOrCreatePendingBuffer(kHandle, 6));
+  EXPECT_EQ(buffer, same_buffer);
+  EXPECT_THAT(store.GetOrCreatePendingBuffer(kHandle, 7),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  buffer->replace(3, 3, "bar");
+  ASSERT_THAT(store.FinishStripe(kHandle, buffer, 3), IsOk());
+  EXPECT_THAT(store.Lookup(kHandle), StatusIs(absl::StatusCode::kNotFound));
+
+  buffer->replace(0, 3, "foo");
+  ASSERT_THAT(store.FinishStripe(kHandle, buffer, 3), IsOk());
+  EXPECT_THAT(store.Lookup(kHandle),
+              IsOkAndHolds(Pointee(std::string("foobar"))));
+  EXPECT_THAT(store.GetOrCreatePendingBuffer(kHandle, 6),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+}
+
+TEST(HostBufferStoreTest, AbortedStripedStore) {
+  HostBufferStore store;
+  const uint64_t kHandle = 1;
+
+  TF_ASSERT_OK_AND_ASSIGN(auto buffer,
+                          store.GetOrCreatePendingBuffer(kHandle, 6));
+  store.AbortPendingBuffer(kHandle, buffer);
+  EXPECT_THAT(store.FinishStripe(kHandle, buffer, 6),
+              StatusIs(absl::StatusCode::kAborted));
+  EXPECT_THAT(store.Lookup(kHandle), StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(HostBufferStoreTest, DeletePendingStripedStore) {
+  HostBufferStore store;
+  const uint64_t kHandle = 1;
+
+  TF_ASSERT_OK_AND_ASSIGN(auto buffer,
+                          store.GetOrCreatePendingBuffer(kHandle, 6));
+  ASSERT_THAT(store.FinishStripe(kHandle, buffer, 3), IsOk());
+  ASSERT_THAT(store.Delete(kHandle), IsOk());
+  EXPECT_THAT(store.FinishStripe(kHandle, buffer, 3),
+              StatusIs(absl::StatusCode::kAborted));
+  EXPECT_THAT(store.Lookup(kHandle), StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(store.Delete(kHandle), StatusIs(absl::StatusCode::kNotFound));
+}
+
 TEST(HostBufferStoreTest, UnknownHandle) {
   HostBufferStore store;
   const uint64_t kHandle = 1;
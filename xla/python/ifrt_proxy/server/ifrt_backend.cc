@@ -14,6 +14,7 @@
 
 #include "xla/python/ifrt_proxy/server/ifrt_backend.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <functional>
@@ -154,9 +155,17 @@ Future<BackendInterface::Response> IfrtBackend::Process(
       return Future<Response>(HandleInit(std::move(request)));
     case IfrtRequest::RequestCase::kCheckFutureRequest:
       return HandleCheckFutureRequest(std::move(request));
-    case IfrtRequest::RequestCase::kMakeArrayFromHostBufferRequest:
-      return Future<Response>(
-          HandleMakeArrayFromHostBufferRequest(std::move(request)));
+    case IfrtRequest::RequestCase::kMakeArrayFromHostBufferRequest: {
+      std::vector<uint64_t> client_handles;
+      if (const uint64_t handle =
+              request->make_array_from_host_buffer_request().array_handle();
+          handle != 0) {
+        client_handles.push_back(handle);
+      }
+      return Future<Response>(RecordClientArrayErrors(
+          client_handles,
+          HandleMakeArrayFromHostBufferRequest(std::move(request))));
+    }
     case IfrtRequest::RequestCase::kAssembleArrayFromSingleDeviceArraysRequest:
       return Future<Response>(
           HandleAssembleArrayFromSingleDeviceArraysRequest(std::move(request)));
@@ -169,8 +178,14 @@ Future<BackendInterface::Response> IfrtBackend::Process(
           HandleDisassembleIntoSingleDeviceArraysRequest(std::move(request)));
     case IfrtRequest::RequestCase::kCheckValueReadyRequest:
       return Future<Response>(HandleCheckValueReadyRequest(std::move(request)));
-    case IfrtRequest::RequestCase::kCopyArraysRequest:
-      return Future<Response>(HandleCopyArraysRequest(std::move(request)));
+    case IfrtRequest::RequestCase::kCopyArraysRequest: {
+      const auto& result_handles =
+          request->copy_arrays_request().result_handles();
+      std::vector<uint64_t> client_handles(result_handles.begin(),
+                                           result_handles.end());
+      return Future<Response>(RecordClientArrayErrors(
+          client_handles, HandleCopyArraysRequest(std::move(request))));
+    }
     case IfrtRequest::RequestCase::kReshardRequest:
       return Future<Response>(HandleReshardRequest(std::move(request)));
     case IfrtRequest::RequestCase::kFullyReplicatedShardRequest:
@@ -447,10 +462,16 @@ IfrtBackend::HandleMakeArrayFromHostBufferRequest(
 
   // TODO(b/282757875): Consider merging the handle_generator with the
   // arrays_.
-  uint64_t handle = handle_generator_.New();
+  uint64_t handle = make_array_request->array_handle();
+  if (handle == 0) {
+    handle = handle_generator_.New();
+  }
   {
     absl::MutexLock lock(&arrays_mutex_);
-    arrays_.insert({handle, std::move(array)});
+    if (!arrays_.insert({handle, std::move(array)}).second) {
+      return absl::AlreadyExistsError(
+          absl::StrCat("Array handle ", handle, " already exists"));
+    }
   }
 
   std::unique_ptr<IfrtResponse> response =
@@ -656,6 +677,14 @@ IfrtBackend::HandleDisassembleIntoSingleDeviceArraysRequest(
 absl::StatusOr<BackendInterface::Response> IfrtBackend::HandleCopyArraysRequest(
     std::unique_ptr<IfrtRequest> request) {
   const auto& copy_arrays_request = request->copy_arrays_request();
+  if (copy_arrays_request.result_handles_size() != 0 &&
+      copy_arrays_request.result_handles_size() !=
+          copy_arrays_request.array_handles_size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "CopyArrays got ", copy_arrays_request.array_handles_size(),
+        " arrays but ", copy_arrays_request.result_handles_size(),
+        " result handles"));
+  }
 
   std::vector<tsl::RCReference<xla::ifrt::Array>> arrays;
   arrays.reserve(copy_arrays_request.array_handles_size());
@@ -694,11 +723,19 @@ absl::StatusOr<BackendInterface::Response> IfrtBackend::HandleCopyArraysRequest(
   auto* const copy_arrays_resp = ifrt_resp->mutable_copy_arrays_response();
 
   std::vector<uint64_t> new_handles(new_arrays.size());
-  handle_generator_.BulkNew(absl::MakeSpan(new_handles));
+  if (copy_arrays_request.result_handles_size() > 0) {
+    std::copy(copy_arrays_request.result_handles().begin(),
+              copy_arrays_request.result_handles().end(), new_handles.begin());
+  } else {
+    handle_generator_.BulkNew(absl::MakeSpan(new_handles));
+  }
   {
     absl::MutexLock lock(&arrays_mutex_);
     for (int i = 0; i < new_arrays.size(); ++i) {
-      arrays_.insert({new_handles[i], new_arrays[i]});
+      if (!arrays_.insert({new_handles[i], new_arrays[i]}).second) {
+        return absl::AlreadyExistsError(
+            absl::StrCat("Array handle ", new_handles[i], " already exists"));
+      }
       copy_arrays_resp->add_array_handles(new_handles[i]);
     }
   }
@@ -829,7 +866,7 @@ IfrtBackend::HandleDestructArrayRequest(std::unique_ptr<IfrtRequest> request) {
     absl::MutexLock lock(&arrays_mutex_);
     for (const uint64_t array_handle :
          request->destruct_array_request().array_handle()) {
-      if (!arrays_.erase(array_handle)) {
+      if (!arrays_.erase(array_handle) && !array_errors_.erase(array_handle)) {
         bad_handles.push_back(array_handle);
       }
     }
@@ -1380,12 +1417,35 @@ absl::StatusOr<tsl::RCReference<xla::ifrt::Array>> IfrtBackend::GetArrayLocked(
     uint64_t array_handle) {
   auto it = arrays_.find(array_handle);
   if (it == arrays_.end()) {
+    if (auto error = array_errors_.find(array_handle);
+        error != array_errors_.end()) {
+      return absl::Status(error->second.code(),
+                          absl::StrCat("Array ", array_handle,
+                                       " failed to be created: ",
+                                       error->second.message()));
+    }
     return absl::NotFoundError(
         absl::StrCat("Unknown array handle: ", array_handle));
   }
   return it->second;
 }
 
+absl::StatusOr<BackendInterface::Response> IfrtBackend::RecordClientArrayErrors(
+    absl::Span<const uint64_t> client_handles,
+    absl::StatusOr<Response> response) {
+  if (!response.ok() && !client_handles.empty()) {
+    absl::MutexLock lock(&arrays_mutex_);
+    for (const uint64_t handle : client_handles) {
+      // Keep arrays that were created successfully, e.g., if the handle was
+      // already in use.
+      if (!arrays_.contains(handle)) {
+        array_errors_.insert({handle, response.status()});
+      }
+    }
+  }
+  return response;
+}
+
 }  // namespace proxy
 }  // namespace ifrt
 }  // namespace xla
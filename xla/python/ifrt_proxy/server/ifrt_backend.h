@@ -23,6 +23,7 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
@@ -172,6 +173,13 @@ class IfrtBackend final : public BackendInterface {
   absl::StatusOr<tsl::RCReference<xla::ifrt::Array>> GetArrayLocked(
       uint64_t handle) ABSL_SHARED_LOCKS_REQUIRED(arrays_mutex_);
 
+  // Records the error of a failed request that was supposed to create arrays
+  // with the given client-assigned handles, so that later requests using
+  // these handles fail with the same error.
+  absl::StatusOr<Response> RecordClientArrayErrors(
+      absl::Span<const uint64_t> client_handles,
+      absl::StatusOr<Response> response);
+
   HandleGenerator handle_generator_;
 
   // Must not change during the life of this object.
@@ -187,6 +195,10 @@ class IfrtBackend final : public BackendInterface {
   absl::Mutex arrays_mutex_;
   absl::flat_hash_map<uint64_t, tsl::RCReference<xla::ifrt::Array>> arrays_
       ABSL_GUARDED_BY(arrays_mutex_);
+  // Errors of requests that failed to create arrays with client-assigned
+  // handles. Entries are removed when the client destructs the array.
+  absl::flat_hash_map<uint64_t, absl::Status> array_errors_
+      ABSL_GUARDED_BY(arrays_mutex_);
 
   absl::Mutex executables_mutex_;
   absl::flat_hash_map<uint64_t, std::shared_ptr<xla::ifrt::LoadedExecutable>>
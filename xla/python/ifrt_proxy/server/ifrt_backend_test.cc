@@ -89,6 +89,7 @@ namespace {
 using ::testing::_;
 using ::testing::ByMove;
 using ::testing::DoAll;
+using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::HasSubstr;
 using ::testing::Invoke;
@@ -805,6 +806,83 @@ TEST_P(IfrtBackendHandlerTest, CopyArrays) {
               SizeIs(copied_arrays.size()));
 }
 
+TEST_P(IfrtBackendHandlerTest, CopyArraysWithClientAssignedHandles) {
+  if (Version().protocol_version() < 10) {
+    GTEST_SKIP() << "Client-assigned array handles are not supported";
+  }
+  constexpr uint64_t kResultHandle = (uint64_t{1} << 63) + 42;
+
+  auto src_array = tsl::MakeRef<xla::ifrt::MockArray>();
+  auto copied_array = tsl::MakeRef<xla::ifrt::MockArray>();
+  EXPECT_CALL(*mock_client_, CopyArrays(_, _, _, _))
+      .WillOnce(Return(std::vector<tsl::RCReference<xla::ifrt::Array>>(
+          {copied_array})));
+  EXPECT_CALL(*copied_array, IsDeleted()).WillOnce(Return(false));
+
+  auto ifrt_request = NewIfrtRequest(NewOpId());
+  auto* copy_arrays_request = ifrt_request->mutable_copy_arrays_request();
+  TF_ASSERT_OK_AND_ASSIGN(auto src_array_handle,
+                          MakeTestArray(std::move(src_array)));
+  copy_arrays_request->add_array_handles(src_array_handle);
+  copy_arrays_request->add_result_handles(kResultHandle);
+  copy_arrays_request->set_copy_semantics(
+      proto::ARRAY_COPY_SEMANTICS_ALWAYS_COPY);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto response, CallBackend(std::move(ifrt_request)));
+  EXPECT_THAT(response->copy_arrays_response().array_handles(),
+              ElementsAre(kResultHandle));
+
+  // The array is usable through the client-assigned handle.
+  auto is_deleted_request = NewIfrtRequest(NewOpId());
+  is_deleted_request->mutable_is_array_deleted_request()->set_array_handle(
+      kResultHandle);
+  TF_ASSERT_OK_AND_ASSIGN(response,
+                          CallBackend(std::move(is_deleted_request)));
+  EXPECT_FALSE(response->is_array_deleted_response().deleted());
+}
+
+TEST_P(IfrtBackendHandlerTest,
+       FailedCopyArraysPropagatesErrorToClientAssignedHandles) {
+  if (Version().protocol_version() < 10) {
+    GTEST_SKIP() << "Client-assigned array handles are not supported";
+  }
+  constexpr uint64_t kResultHandle = (uint64_t{1} << 63) + 42;
+
+  EXPECT_CALL(*mock_client_, CopyArrays(_, _, _, _))
+      .WillOnce(Return(absl::UnknownError("injected error")));
+
+  auto ifrt_request = NewIfrtRequest(NewOpId());
+  auto* copy_arrays_request = ifrt_request->mutable_copy_arrays_request();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto src_array_handle,
+      MakeTestArray(tsl::MakeRef<xla::ifrt::MockArray>()));
+  copy_arrays_request->add_array_handles(src_array_handle);
+  copy_arrays_request->add_result_handles(kResultHandle);
+  copy_arrays_request->set_copy_semantics(
+      proto::ARRAY_COPY_SEMANTICS_ALWAYS_COPY);
+  EXPECT_THAT(CallBackend(std::move(ifrt_request)),
+              StatusIs(absl::StatusCode::kUnknown));
+
+  // Requests that use the handle fail with the error of the failed request.
+  auto is_deleted_request = NewIfrtRequest(NewOpId());
+  is_deleted_request->mutable_is_array_deleted_request()->set_array_handle(
+      kResultHandle);
+  EXPECT_THAT(CallBackend(std::move(is_deleted_request)),
+              StatusIs(absl::StatusCode::kUnknown, HasSubstr("injected error")));
+
+  // Destructing the array clears the recorded error.
+  auto destruct_request = NewIfrtRequest(NewOpId());
+  destruct_request->mutable_destruct_array_request()->add_array_handle(
+      kResultHandle);
+  TF_ASSERT_OK(CallBackend(std::move(destruct_request)).status());
+
+  is_deleted_request = NewIfrtRequest(NewOpId());
+  is_deleted_request->mutable_is_array_deleted_request()->set_array_handle(
+      kResultHandle);
+  EXPECT_THAT(CallBackend(std::move(is_deleted_request)),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 TEST_P(IfrtBackendHandlerTest, ReshardSuccess) {
   auto src_mock_array = tsl::MakeRef<xla::ifrt::MockArray>();
   TF_ASSERT_OK_AND_ASSIGN(auto* device,
@@ -226,7 +226,30 @@ std::string CallSignature::DebugString() const {
       OptionalDebugString(thread_local_extra_jit_context));
 }
 
+size_t CallSignature::DynamicArgsHash() const {
+  if (dynamic_args_hash.has_value()) {
+    return *dynamic_args_hash;
+  }
+  DCHECK(dynamic_arg_shardings.empty() ||
+         dynamic_arg_shardings.size() == dynamic_arg_signatures.size());
+  size_t hash = 0;
+  for (int i = 0; i < dynamic_arg_signatures.size(); ++i) {
+    nb::handle sharding = i < dynamic_arg_shardings.size()
+                              ? nb::handle(dynamic_arg_shardings[i])
+                              : nb::handle(Py_None);
+    bool committed = i < committed_args.size() && committed_args[i];
+    hash = CombineDynamicArgHash(hash, dynamic_arg_signatures[i], sharding,
+                                 committed);
+  }
+  return hash;
+}
+
 bool CallSignature::operator==(const CallSignature& other) const {
+  // Cheap rejection of signatures whose dynamic arguments differ.
+  if (dynamic_args_hash.has_value() && other.dynamic_args_hash.has_value() &&
+      *dynamic_args_hash != *other.dynamic_args_hash) {
+    return false;
+  }
   if (arg_signature != other.arg_signature) {
     return false;
   }
@@ -271,9 +294,20 @@ absl::Status ParseArguments(
     absl::Span<int const> static_argnums,
     absl::Span<nb::str const> static_argnames,
     xla::PyTreeRegistry* pytree_registry, ArgumentSignature& signature,
-    absl::InlinedVector<nanobind::object, 2>& flat_dynamic_args) {
+    absl::InlinedVector<nanobind::object, 2>& flat_dynamic_args,
+    xla::PyTreeFlattenCache* flatten_cache) {
   tsl::profiler::TraceMe traceme("ParseArguments");
 
+  // Keyword arguments are cached after the positional arguments.
+  auto flatten = [&](int position, nb::handle arg,
+                     xla::PyTreeDef& pytree_def) {
+    if (flatten_cache != nullptr) {
+      flatten_cache->Flatten(position, arg, pytree_def, flat_dynamic_args);
+    } else {
+      pytree_def.Flatten(arg, flat_dynamic_args);
+    }
+  };
+
   flat_dynamic_args.reserve(positional_args.size() + keyword_args.size());
   if (static_argnums.empty()) {
     signature.dynamic_arg_treedefs.reserve(positional_args.size());
@@ -282,7 +316,7 @@ absl::Status ParseArguments(
     for (int i = 0; i < positional_args.size(); ++i) {
       signature.dynamic_arg_treedefs.emplace_back(pytree_registry);
       xla::PyTreeDef& pytree_def = signature.dynamic_arg_treedefs.back();
-      pytree_def.Flatten(nb::handle(positional_args[i]), flat_dynamic_args);
+      flatten(i, nb::handle(positional_args[i]), pytree_def);
     }
   } else {
     signature.dynamic_arg_treedefs.reserve(positional_args.size());
@@ -296,7 +330,7 @@ absl::Status ParseArguments(
                        }) == static_argnums.end()) {
         signature.dynamic_arg_treedefs.emplace_back(pytree_registry);
         xla::PyTreeDef& pytree_def = signature.dynamic_arg_treedefs.back();
-        pytree_def.Flatten(positional_args[i], flat_dynamic_args);
+        flatten(i, positional_args[i], pytree_def);
       } else {
         signature.static_args.emplace_back(
             nb::borrow<nb::object>(positional_args[i]));
@@ -346,8 +380,8 @@ absl::Status ParseArguments(
             nb::steal<nb::object>(kwargs[i].first));
         signature.dynamic_arg_treedefs.emplace_back(pytree_registry);
         xla::PyTreeDef& pytree_def = signature.dynamic_arg_treedefs.back();
-        pytree_def.Flatten(nb::handle(kwargs[i].second.ptr()),
-                           flat_dynamic_args);
+        flatten(positional_args.size() + i,
+                nb::handle(kwargs[i].second.ptr()), pytree_def);
       }
     }
   }
@@ -427,7 +461,8 @@ void BuildJaxjitSubmodule(nb::module_& m) {
       [](nb::sequence positional_args, nb::sequence keyword_args,
          nb::tuple kwnames, absl::Span<int const> static_argnums,
          absl::Span<nb::str const> static_argnames,
-         xla::PyTreeRegistry* pytree_registry) {
+         xla::PyTreeRegistry* pytree_registry,
+         xla::PyTreeFlattenCache* flatten_cache) {
         ArgumentSignature signature;
         absl::InlinedVector<nanobind::object, 2> flat_dynamic_args;
         nb::object positional_args_seq = nb::steal(PySequence_Fast(
@@ -448,13 +483,14 @@ void BuildJaxjitSubmodule(nb::module_& m) {
                            PySequence_Fast_GET_SIZE(keyword_args_seq.ptr()));
         xla::ThrowIfError(ParseArguments(
             positional_args_span, keyword_args_span, kwnames, static_argnums,
-            static_argnames, pytree_registry, signature, flat_dynamic_args));
+            static_argnames, pytree_registry, signature, flat_dynamic_args,
+            flatten_cache));
         return std::make_pair(std::move(signature),
                               std::move(flat_dynamic_args));
       },
       nb::arg("positional_args"), nb::arg("keyword_args"), nb::arg("kwnames"),
       nb::arg("static_argnums"), nb::arg("static_argnames"),
-      nb::arg("pytree_registry"),
+      nb::arg("pytree_registry"), nb::arg("flatten_cache").none() = nullptr,
       R"doc(Parses the arguments to a function as jax.jit would.
 
 Returns a ArgumentSignature and the flattened dynamic arguments.
@@ -466,6 +502,8 @@ Args:
   static_argnums: The static argument numbers.
   static_argnames: The static argument names.
   pytree_registry: The pytree registry.
+  flatten_cache: An optional PyTreeFlattenCache that caches the structure of
+    the dynamic arguments across calls.
 )doc");
 }
 
@@ -28,6 +28,7 @@ limitations under the License.
 
 // placeholder for index annotation headers
 #include "absl/container/inlined_vector.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
@@ -166,13 +167,28 @@ H AbslHashValue(H h, const ArgumentSignature& s) {
 //  dynamic arguments.
 // flat_dynamic_args: output; the concatenation of the dynamic positional
 //  arguments and sorted keyword arguments.
+// flatten_cache: optional; caches the tree structure of the dynamic arguments
+//  across calls.
 absl::Status ParseArguments(
     absl::Span<PyObject* const> positional_args,
     absl::Span<PyObject* const> keyword_args, nanobind::handle kwnames,
     absl::Span<int const> static_argnums,
     absl::Span<nanobind::str const> static_argnames,
     xla::PyTreeRegistry* pytree_registry, ArgumentSignature& signature,
-    absl::InlinedVector<nanobind::object, 2>& flat_dynamic_args);
+    absl::InlinedVector<nanobind::object, 2>& flat_dynamic_args,
+    xla::PyTreeFlattenCache* flatten_cache = nullptr);
+
+// Combines the signature, sharding and committedness of a dynamic argument
+// into `hash`, the hash of the preceding dynamic arguments of a call.
+//
+// TODO(chky): For now, we are only hashing the pointer of shardings to avoid
+// slow python hashing function. Consider implementing hashing function and
+// equality checks in C++ in jax::Sharding and use those here.
+inline size_t CombineDynamicArgHash(size_t hash,
+                                    const xla::PyArgSignature& signature,
+                                    nanobind::handle sharding, bool committed) {
+  return absl::HashOf(hash, signature, ShardingHash(sharding), committed);
+}
 
 // The signature of Python jitted function call, partitioned into:
 // - dynamic positional arguments (i.e. positional args which are not static)
@@ -199,6 +215,11 @@ struct CallSignature {
 
   absl::InlinedVector<bool, 2> committed_args;
 
+  // Hash of the dynamic argument signatures, shardings and committedness,
+  // computed incrementally with CombineDynamicArgHash while the signature is
+  // built. If unset, it is recomputed whenever the signature is hashed.
+  std::optional<size_t> dynamic_args_hash;
+
   // For JIT, we need this in the key because computation follows the data, so
   // we may have multiple executables depending on the devices the data is on.
   // This is not the case for PMAP, and is set to `nullptr`.
@@ -219,25 +240,17 @@ struct CallSignature {
     return !(*this == other);
   }
 
+  // Returns `dynamic_args_hash`, computing it if it is unset.
+  size_t DynamicArgsHash() const;
+
   std::string DebugString() const;
 };
 
 template <typename H>
 H AbslHashValue(H h, const CallSignature& s) {
-  h = H::combine(std::move(h), s.arg_signature, s.dynamic_arg_signatures);
-
-  DCHECK(s.dynamic_arg_shardings.empty() ||
-         s.dynamic_arg_shardings.size() == s.dynamic_arg_signatures.size());
-
-  // TODO(chky): For now, we are only hashing the pointer of shardings to avoid
-  // slow python hashing function. Consider implementing hashing function and
-  // equality checks in C++ in jax::Sharding and use those here.
-  for (const auto& sharding : s.dynamic_arg_shardings) {
-    // TODO(phawkins): remove .ptr() after nanobind transition is complete.
-    h = H::combine(std::move(h), ShardingHash(sharding.ptr()));
-  }
-
-  h = H::combine(std::move(h), s.committed_args, s.device, s.jax_enable_x64);
+  h = H::combine(std::move(h), s.arg_signature,
+                 s.dynamic_arg_signatures.size(), s.DynamicArgsHash(),
+                 s.device, s.jax_enable_x64);
 
   // We do not hash the extra_jit_context fields since calling Python hash
   // functions is expensive (~300ns) and we don't expect a large number of
@@ -14,15 +14,74 @@
 # ==============================================================================
 """Tests for jax_jit helper functions."""
 
+import collections
+import gc
+import weakref
+
 from absl.testing import absltest
+import numpy as np
 
 from xla.python import xla_client
 
 jax_jit = xla_client._xla.jax_jit
 pytree = xla_client._xla.pytree
+ops = xla_client.ops
+
+jax_jit.set_thread_local_state_initialization_callback(lambda: None)
+jax_jit.global_state().disable_jit = False
+jax_jit.global_state().enable_x64 = False
+jax_jit.global_state().enable_memories = False
 
 pytree_registry = pytree.default_registry()
 
+Point = collections.namedtuple("Point", "x y")
+
+
+class Key:
+  """A hashable, orderable dict key that can refer to other objects."""
+
+  def __init__(self, name):
+    self.name = name
+    self.ref = None
+
+  def __hash__(self):
+    return hash(self.name)
+
+  def __eq__(self, other):
+    return self.name == other.name
+
+  def __lt__(self, other):
+    return self.name < other.name
+
+
+def _parse_arguments(args, flatten_cache=None):
+  return jax_jit.parse_arguments(
+      positional_args=args,
+      keyword_args=[],
+      kwnames=(),
+      static_argnums=[],
+      static_argnames=[],
+      pytree_registry=pytree_registry,
+      flatten_cache=flatten_cache,
+  )
+
+
+Aval = collections.namedtuple("Aval", "shape dtype weak_type")
+
+FastpathData = collections.namedtuple(
+    "FastpathData",
+    [
+        "xla_executable",
+        "in_shardings",
+        "out_shardings",
+        "out_avals",
+        "out_committed",
+        "out_pytree_def",
+        "kept_var_bitvec",
+        "in_device_local_layouts",
+    ],
+)
+
 
 class JaxJitTest(absltest.TestCase):
 
@@ -42,6 +101,187 @@ class JaxJitTest(absltest.TestCase):
     self.assertEqual(sig.dynamic_arg_names, ["b"])
     self.assertEqual(sig.dynamic_arg_treedefs, [leaf, leaf])
 
+  def testParseArgumentsWithFlattenCache(self):
+    cache = pytree.PyTreeFlattenCache()
+    calls = [
+        [{"a": 1, "b": (2, 3)}, [4]],
+        [{"a": 5, "b": (6, 7)}, [8]],
+        [{"a": 1, "c": (2, 3)}, [4]],
+        [{"a": 1, "b": (2, 3, 4)}, [5]],
+        [{"a": 1, "b": Point(2, 3)}, [4]],
+        [{"a": 1, "b": (None, 3)}, [4]],
+        [{"a": (1,), "b": (2, 3)}, 4],
+        [{"a": 1, "b": (2, 3)}, [4]],
+    ]
+    for args in calls:
+      expected_sig, expected_leaves = _parse_arguments(args)
+      sig, leaves = _parse_arguments(args, flatten_cache=cache)
+      self.assertEqual(sig, expected_sig)
+      self.assertEqual(
+          sig.dynamic_arg_treedefs, expected_sig.dynamic_arg_treedefs
+      )
+      self.assertEqual(leaves, expected_leaves)
+
+  def testFlattenCacheIsCollectedInCycles(self):
+    cache = pytree.PyTreeFlattenCache()
+    key = Key("a")
+    _parse_arguments([{key: 1}], flatten_cache=cache)
+    # The cached structure refers to `key`, which refers to the cache.
+    key.ref = cache
+    cache_ref = weakref.ref(cache)
+    key_ref = weakref.ref(key)
+    del cache, key
+    gc.collect()
+    self.assertIsNone(cache_ref())
+    self.assertIsNone(key_ref())
+
+
+class PjitFrozenTest(absltest.TestCase):
+
+  def setUp(self):
+    super().setUp()
+    self.backend = xla_client.make_cpu_client()
+    self.device = self.backend.local_devices()[0]
+    self.sharding = xla_client.SingleDeviceSharding(self.device)
+    self.shape = (2,)
+    self.aval = Aval(self.shape, np.dtype(np.float32), False)
+    b = xla_client.XlaBuilder("add_one")
+    p = ops.Parameter(
+        b, 0, xla_client.shape_from_pyval(np.zeros(self.shape, np.float32))
+    )
+    ops.Add(p, ops.Constant(b, np.float32(1)))
+    self.executable = self.backend.compile(
+        xla_client._xla.mlir.xla_computation_to_mlir_module(b.build())
+    )
+    self.cache_misses = []
+
+  def _array(self, value, sharding=None, committed=True, dtype=np.float32):
+    shard = np.full(self.shape, value, dtype)
+    aval = Aval(self.shape, np.dtype(dtype), False)
+    return xla_client.batched_device_put(
+        aval, sharding or self.sharding, [shard], [self.device], committed
+    )
+
+  def _cache_miss(self, x):
+    self.cache_misses.append(x)
+    out = np.asarray(x) + 1
+    if x.shape != self.shape or x.dtype != np.float32:
+      return out, None
+    fastpath_data = FastpathData(
+        xla_executable=self.executable,
+        in_shardings=[getattr(x, "sharding", self.sharding)],
+        out_shardings=[self.sharding],
+        out_avals=[self.aval],
+        out_committed=[True],
+        out_pytree_def=pytree_registry.flatten(0)[1],
+        kept_var_bitvec=[True],
+        in_device_local_layouts=[None],
+    )
+    return out, fastpath_data
+
+  def _pjit(self):
+    def fun(x):
+      return x + 1
+
+    def shard_arg_fallback(*args):
+      raise AssertionError(f"unexpected shard_arg_fallback{args}")
+
+    # With a capacity of 1, calling `_evict` drops the cache entries of every
+    # other signature, so only frozen calls avoid a cache miss.
+    return xla_client._xla.pjit(
+        "fun",
+        fun,
+        self._cache_miss,
+        [],
+        [],
+        "key",
+        pytree_registry,
+        shard_arg_fallback,
+        xla_client._xla.PjitFunctionCache(1),
+    )
+
+  def _evict(self, f):
+    misses = len(self.cache_misses)
+    f(np.zeros((3,), np.float32))
+    self.assertLen(self.cache_misses, misses + 1)
+
+  def _assert_call(self, f, x, cache_miss):
+    misses = len(self.cache_misses)
+    np.testing.assert_equal(np.asarray(f(x)), np.asarray(x) + 1)
+    self.assertLen(self.cache_misses, misses + int(cache_miss))
+
+  def testFrozenProperty(self):
+    f = self._pjit()
+    self.assertFalse(f._frozen)
+    f._frozen = True
+    self.assertTrue(f._frozen)
+    f._frozen = False
+    self.assertFalse(f._frozen)
+
+  def testFrozenCallSkipsExecutableCache(self):
+    f = self._pjit()
+    f._frozen = True
+    x = self._array(1)
+    self._assert_call(f, x, cache_miss=True)
+    # The second call takes the regular fast path and records the call.
+    self._assert_call(f, x, cache_miss=False)
+    self._evict(f)
+    self._assert_call(f, x, cache_miss=False)
+    # Other arrays with the same signature and sharding object use the record
+    # too, and compute with their own values.
+    self._assert_call(f, self._array(5), cache_miss=False)
+
+  def testCallsAreNotRecordedUnlessFrozen(self):
+    f = self._pjit()
+    x = self._array(1)
+    self._assert_call(f, x, cache_miss=True)
+    self._assert_call(f, x, cache_miss=False)
+    self._evict(f)
+    self._assert_call(f, x, cache_miss=True)
+
+  def testMismatchedCallsTakeRegularPath(self):
+    f = self._pjit()
+    f._frozen = True
+    x = self._array(1)
+    self._assert_call(f, x, cache_miss=True)
+    self._assert_call(f, x, cache_miss=False)
+    mismatched_args = [
+        # An equal sharding that is a different object.
+        self._array(2, sharding=xla_client.SingleDeviceSharding(self.device)),
+        self._array(3, committed=False),
+        self._array(4, dtype=np.int32),
+        np.full(self.shape, 5, np.float32),
+    ]
+    for arg in mismatched_args:
+      self._evict(f)
+      self._assert_call(f, arg, cache_miss=True)
+    # None of the mismatched calls replaced the record.
+    self._evict(f)
+    self._assert_call(f, x, cache_miss=False)
+
+  def testNonArrayArgumentsAreNotRecorded(self):
+    f = self._pjit()
+    f._frozen = True
+    x = np.full(self.shape, 1, np.float32)
+    self._assert_call(f, x, cache_miss=True)
+    self._assert_call(f, x, cache_miss=False)
+    self._evict(f)
+    self._assert_call(f, x, cache_miss=True)
+
+  def testClearCacheAndUnfreezingDropRecord(self):
+    f = self._pjit()
+    f._frozen = True
+    x = self._array(1)
+    self._assert_call(f, x, cache_miss=True)
+    self._assert_call(f, x, cache_miss=False)
+    f._clear_cache()
+    self._assert_call(f, x, cache_miss=True)
+    self._assert_call(f, x, cache_miss=False)
+    f._frozen = False
+    f._frozen = True
+    self._evict(f)
+    self._assert_call(f, x, cache_miss=True)
+
 
 if __name__ == "__main__":
   absltest.main()
@@ -32,6 +32,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
@@ -63,6 +64,7 @@ limitations under the License.
 #include "xla/python/jax_jit.h"
 #include "xla/python/nb_helpers.h"
 #include "xla/python/nb_numpy.h"
+#include "xla/python/pjrt_ifrt/pjrt_dtype.h"
 #include "xla/python/py_array.h"
 #include "xla/python/py_executable.h"
 #include "xla/python/py_values.h"
@@ -112,6 +114,13 @@ struct PjitCacheEntry {
   bool fall_back_to_python = false;
 };
 
+// The last call of a frozen PjitFunction, if all its arguments were committed
+// jax.Arrays that were passed to the executable as is.
+struct PjitFrozenCall {
+  std::shared_ptr<PjitCacheEntry> cache_entry;
+  CallSignature signature;
+};
+
 // A PjitFunctionCache represents a cache of compiled functions that can be
 // shared between one or more PjitFunction objects. It serves two goals:
 // - reduce the number of lru caches (hash map) across multiple JITs.
@@ -293,6 +302,9 @@ class PjitFunction {
     return pytree_registry_;
   }
   const nb::callable& shard_arg_fallback() const { return shard_arg_fallback_; }
+  const xla::PyTreeFlattenCache& flatten_cache() const {
+    return flatten_cache_;
+  }
 
   const std::vector<int>& static_argnums() const { return static_argnums_; }
   const std::vector<nb::str>& static_argnames() const {
@@ -303,7 +315,22 @@ class PjitFunction {
 
   int cache_capacity() const { return executables_->Size(); }
 
-  void ClearCache() { executables_->Clear(); }
+  void ClearCache() {
+    executables_->Clear();
+    flatten_cache_.Clear();
+    frozen_call_.reset();
+  }
+
+  // A frozen PjitFunction assumes that its calls have the same signature as
+  // the last one, which it checks by comparing the Python objects in the
+  // signature by identity, and passes the arguments to the executable without
+  // checking their shardings and layouts again. Calls with a different
+  // signature take the regular path.
+  bool frozen() const { return frozen_; }
+  void set_frozen(bool frozen) {
+    frozen_ = frozen;
+    frozen_call_.reset();
+  }
 
   nb::object PythonSignature() {
     if (!fun_.has_value()) {
@@ -326,6 +353,27 @@ class PjitFunction {
   void PopulateCacheEntry(PjitCacheEntry& cache_entry,
                           const nb::tuple& out_and_fastpath_data);
 
+  // Returns true if a call with `arg_signature` and `flat_dynamic_args` has
+  // the signature of `frozen_call_`, and fills `input_arrays` with the arrays
+  // to pass to its executable.
+  bool MatchFrozenCall(
+      const ArgumentSignature& arg_signature,
+      absl::Span<nb::object const> flat_dynamic_args,
+      std::vector<tsl::RCReference<xla::ifrt::Array>>& input_arrays);
+
+  // Records a call as `frozen_call_` if its arguments were passed to the
+  // executable as is.
+  void RecordFrozenCall(
+      std::shared_ptr<PjitCacheEntry> cache_entry, CallSignature signature,
+      absl::Span<nb::object const> flat_dynamic_args,
+      absl::Span<const tsl::RCReference<xla::ifrt::Array>> input_arrays);
+
+  // Executes `cache_entry` and builds the outputs of the call.
+  absl::StatusOr<nb::object> CallExecutable(
+      nb::handle callable, PyObject* const* args, size_t nargs,
+      PyObject* kwnames, PjitCacheEntry& cache_entry,
+      std::vector<tsl::RCReference<xla::ifrt::Array>> input_arrays);
+
   std::string function_name_;
   std::optional<nb::callable> fun_;
   nb::callable cache_miss_;
@@ -334,9 +382,14 @@ class PjitFunction {
   nb::object global_cache_key_;
 
   std::shared_ptr<xla::PyTreeRegistry> pytree_registry_;
+  // Structure of the arguments of recent calls. Protected by the GIL.
+  xla::PyTreeFlattenCache flatten_cache_;
   nb::callable shard_arg_fallback_;
   std::shared_ptr<PjitFunctionCache> cache_;
   std::shared_ptr<PjitFunctionCache::Cache> executables_;
+
+  bool frozen_ = false;
+  std::unique_ptr<PjitFrozenCall> frozen_call_;
 };
 
 // thread-compatible.
@@ -619,12 +672,23 @@ absl::StatusOr<nb::object> PjitFunction::Call(nb::handle callable,
   absl::InlinedVector<nb::object, 2> flat_dynamic_args;
   auto status = ParseArguments(
       positional_args, keyword_args, kwnames, static_argnums_, static_argnames_,
-      pytree_registry_.get(), call_signature.arg_signature, flat_dynamic_args);
+      pytree_registry_.get(), call_signature.arg_signature, flat_dynamic_args,
+      &flatten_cache_);
   if (!status.ok()) {
     VLOG(2) << "ParseArguments failed: " << status;
     return fallback_to_cache_miss();
   }
 
+  if (frozen_call_ != nullptr) {
+    std::vector<tsl::RCReference<xla::ifrt::Array>> input_arrays;
+    if (MatchFrozenCall(call_signature.arg_signature, flat_dynamic_args,
+                        input_arrays)) {
+      std::shared_ptr<PjitCacheEntry> cache_entry = frozen_call_->cache_entry;
+      return CallExecutable(callable, args, nargs, kwnames, *cache_entry,
+                            std::move(input_arrays));
+    }
+  }
+
   // Perform a few checks for the arguments. Currently we are only allowing
   // committed PyArray inputs. For other cases, e.g. Tracers or ShapedArray, it
   // will fallback to python. For jit, numpy arrays and scalars are also
@@ -734,20 +798,120 @@ absl::StatusOr<nb::object> PjitFunction::Call(nb::handle callable,
     return fallback_to_cache_miss();
   }
 
+  if (frozen_) {
+    RecordFrozenCall(cache_entry, std::move(call_signature), flat_dynamic_args,
+                     *num_args_arrays);
+  }
+
+  return CallExecutable(callable, args, nargs, kwnames, *cache_entry,
+                        *std::move(num_args_arrays));
+}
+
+bool PjitFunction::MatchFrozenCall(
+    const ArgumentSignature& arg_signature,
+    absl::Span<nb::object const> flat_dynamic_args,
+    std::vector<tsl::RCReference<xla::ifrt::Array>>& input_arrays) {
+  const CallSignature& signature = frozen_call_->signature;
+  auto same_object = [](const std::optional<nb::object>& a,
+                        const std::optional<nb::object>& b) {
+    return a.has_value() == b.has_value() && (!a || a->ptr() == b->ptr());
+  };
+  if (flat_dynamic_args.size() != signature.dynamic_arg_signatures.size() ||
+      GetEnableX64() != signature.jax_enable_x64 ||
+      GetEnableMemories() != signature.jax_enable_memories ||
+      !same_object(GetDefaultDevice(), signature.default_device) ||
+      !same_object(ThreadLocalJitState().extra_jit_context,
+                   signature.thread_local_extra_jit_context) ||
+      !same_object(GlobalJitState().extra_jit_context,
+                   signature.global_extra_jit_context) ||
+      arg_signature != signature.arg_signature) {
+    return false;
+  }
+
+  const std::vector<bool>& kept_args =
+      frozen_call_->cache_entry->kept_var_bitvec;
+  nb::handle array_type = xla::PyArray::type();
+  input_arrays.reserve(flat_dynamic_args.size());
+  for (size_t i = 0; i < flat_dynamic_args.size(); ++i) {
+    nb::handle arg = flat_dynamic_args[i];
+    if (!arg.type().is(array_type)) {
+      return false;
+    }
+    auto py_array = nb::borrow<xla::PyArray>(arg);
+    xla::ifrt::Array* ifrt_array = py_array.ifrt_array();
+    const xla::PyArgSignature& dynamic_arg_signature =
+        signature.dynamic_arg_signatures[i];
+    if (ifrt_array == nullptr ||
+        py_array.sharding().ptr() != signature.dynamic_arg_shardings[i].ptr() ||
+        py_array.committed() != signature.committed_args[i] ||
+        py_array.weak_type() != dynamic_arg_signature.weak_type ||
+        !absl::c_equal(py_array.shape(), dynamic_arg_signature.shape)) {
+      return false;
+    }
+    absl::StatusOr<xla::PrimitiveType> dtype =
+        xla::ifrt::ToPrimitiveType(ifrt_array->dtype());
+    if (!dtype.ok() || *dtype != dynamic_arg_signature.dtype) {
+      return false;
+    }
+    if (kept_args[i]) {
+      input_arrays.push_back(tsl::FormRef(ifrt_array));
+    }
+  }
+  return true;
+}
+
+void PjitFunction::RecordFrozenCall(
+    std::shared_ptr<PjitCacheEntry> cache_entry, CallSignature signature,
+    absl::Span<nb::object const> flat_dynamic_args,
+    absl::Span<const tsl::RCReference<xla::ifrt::Array>> input_arrays) {
+  frozen_call_.reset();
+  // Arguments with a device-local layout need their layout checked on every
+  // call.
+  for (nb::handle layout : cache_entry->in_device_local_layouts) {
+    if (!layout.is_none()) {
+      return;
+    }
+  }
+  nb::handle array_type = xla::PyArray::type();
+  size_t input_index = 0;
+  for (size_t i = 0; i < flat_dynamic_args.size(); ++i) {
+    nb::handle arg = flat_dynamic_args[i];
+    if (!arg.type().is(array_type)) {
+      return;
+    }
+    if (!cache_entry->kept_var_bitvec[i]) {
+      continue;
+    }
+    // Arguments that were copied or resharded don't take the frozen path.
+    if (input_arrays[input_index++].get() !=
+        nb::borrow<xla::PyArray>(arg).ifrt_array()) {
+      return;
+    }
+  }
+  frozen_call_ = std::make_unique<PjitFrozenCall>(
+      PjitFrozenCall{std::move(cache_entry), std::move(signature)});
+}
+
+absl::StatusOr<nb::object> PjitFunction::CallExecutable(
+    nb::handle callable, PyObject* const* args, size_t nargs,
+    PyObject* kwnames, PjitCacheEntry& cache_entry,
+    std::vector<tsl::RCReference<xla::ifrt::Array>> input_arrays) {
+  size_t num_positional_args = PyVectorcall_NARGS(nargs);
+  size_t num_keyword_args = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+
   // A vector of [num_outputs].
   std::vector<tsl::RCReference<xla::ifrt::Array>> output_arrays;
   {
     nb::gil_scoped_release gil_release;
     TF_ASSIGN_OR_RETURN(auto result,
-                        cache_entry->executable->ifrt_executable()->Execute(
-                            absl::MakeSpan(*num_args_arrays),
-                            cache_entry->executable->options(),
+                        cache_entry.executable->ifrt_executable()->Execute(
+                            absl::MakeSpan(input_arrays),
+                            cache_entry.executable->options(),
                             /*devices=*/std::nullopt));
     output_arrays = std::move(result.outputs);
   }
 
   auto traceback = xla::Traceback::Get();
-  const auto& client = cache_entry->executable->client();
 
   // Convert the ifrt::Array objects to PyArray.
   int num_outputs = output_arrays.size();
@@ -758,17 +922,17 @@ absl::StatusOr<nb::object> PjitFunction::Call(nb::handle callable,
     // like `aval` and `sharding` are retrieved from the cache for this
     // function, which are produced by the python path in `cache_miss`.
     xla::PyArray py_array(
-        cache_entry->out_avals[i], cache_entry->out_weak_types[i],
-        cache_entry->out_dtypes[i], cache_entry->out_shapes[i],
-        cache_entry->out_shardings[i], cache_entry->executable->client(),
+        cache_entry.out_avals[i], cache_entry.out_weak_types[i],
+        cache_entry.out_dtypes[i], cache_entry.out_shapes[i],
+        cache_entry.out_shardings[i], cache_entry.executable->client(),
         traceback, std::move(output_arrays[i]),
-        /*committed=*/cache_entry->out_committed.at(i), /*skip_checks=*/true);
+        /*committed=*/cache_entry.out_committed.at(i), /*skip_checks=*/true);
 
     outputs.push_back(std::move(py_array));
   }
 
   nb::object out = nb::steal<nb::object>(
-      cache_entry->out_pytree_def.Unflatten(outputs).release().ptr());
+      cache_entry.out_pytree_def.Unflatten(outputs).release().ptr());
 
   // If there is a post-hook function, call it with the inputs and the outputs.
   std::optional<nb::object> post_hook = GetPostHook();
@@ -810,23 +974,40 @@ absl::Status PjitFunction::ComputeCallSignature(
   dynamic_arg_signatures.reserve(flat_dynamic_args.size());
   auto& dynamic_arg_shardings = signature.dynamic_arg_shardings;
   dynamic_arg_shardings.reserve(flat_dynamic_args.size());
+  auto& committed_args = signature.committed_args;
+  committed_args.reserve(flat_dynamic_args.size());
 
+  nb::handle array_type = xla::PyArray::type();
+  size_t dynamic_args_hash = 0;
   for (nb::handle arg : flat_dynamic_args) {
-    TF_ASSIGN_OR_RETURN(auto arg_signature,
-                        xla::PyArgSignatureOfValue(arg, jax_enable_x64));
-    signature.dynamic_arg_signatures.push_back(std::move(arg_signature));
-
     // It should be already checked previously in the entry point of
     // PjitFunction::Call().
-    if (arg.type().ptr() == xla::PyArray::type().ptr()) {
+    if (arg.type().is(array_type)) {
+      // Read the signature of jax.Arrays, the common case, directly from the
+      // array instead of going through PyArgSignatureOfValue.
       auto py_array = nb::borrow<xla::PyArray>(arg);
-      signature.dynamic_arg_shardings.push_back(py_array.sharding());
-      signature.committed_args.push_back(py_array.committed());
+      xla::ifrt::Array* ifrt_array = py_array.ifrt_array();
+      if (ifrt_array == nullptr) {
+        return xla::InvalidArgument("Array has been deleted.");
+      }
+      TF_ASSIGN_OR_RETURN(auto primitive_type,
+                          xla::ifrt::ToPrimitiveType(ifrt_array->dtype()));
+      dynamic_arg_signatures.emplace_back(primitive_type, py_array.shape(),
+                                          py_array.weak_type());
+      dynamic_arg_shardings.push_back(py_array.sharding());
+      committed_args.push_back(py_array.committed());
     } else {
-      signature.dynamic_arg_shardings.push_back(nb::none());
-      signature.committed_args.push_back(false);
+      TF_ASSIGN_OR_RETURN(auto arg_signature,
+                          xla::PyArgSignatureOfValue(arg, jax_enable_x64));
+      dynamic_arg_signatures.push_back(std::move(arg_signature));
+      dynamic_arg_shardings.push_back(nb::none());
+      committed_args.push_back(false);
     }
+    dynamic_args_hash = CombineDynamicArgHash(
+        dynamic_args_hash, dynamic_arg_signatures.back(),
+        dynamic_arg_shardings.back(), committed_args.back());
   }
+  signature.dynamic_args_hash = dynamic_args_hash;
 
   signature.thread_local_extra_jit_context = tls.extra_jit_context;
   signature.global_extra_jit_context = global_state.extra_jit_context;
@@ -911,6 +1092,10 @@ void PjitFunction::ClearPythonReferences() {
   std::swap(cache_miss_, cache_miss);
   std::swap(fun_, fun);
   std::swap(shard_arg_fallback_, shard_arg_fallback);
+  xla::PyTreeFlattenCache flatten_cache;
+  std::swap(flatten_cache_, flatten_cache);
+  std::unique_ptr<PjitFrozenCall> frozen_call;
+  std::swap(frozen_call_, frozen_call);
 }
 
 struct PjitFunctionObject {
@@ -1020,6 +1205,9 @@ int PjitFunction_tp_traverse(PyObject* self, visitproc visit, void* arg) {
   if (o->fun.fun()) {
     Py_VISIT(o->fun.fun()->ptr());
   }
+  if (int ret = o->fun.flatten_cache().Traverse(visit, arg); ret != 0) {
+    return ret;
+  }
   return 0;
 }
 
@@ -1280,6 +1468,11 @@ void BuildPjitSubmodule(nb::module_& m) {
   cfun.attr("_clear_cache") = nb::cpp_function(
       [](nb::handle self) { AsPjitFunction(self)->ClearCache(); },
       nb::is_method());
+  cfun.attr("_frozen") = xla::nb_property(
+      [](nb::handle self) -> bool { return AsPjitFunction(self)->frozen(); },
+      [](nb::handle self, bool frozen) {
+        AsPjitFunction(self)->set_frozen(frozen);
+      });
 
   m.def(
       "pjit",
@@ -23,6 +23,7 @@ limitations under the License.
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -40,6 +41,7 @@ limitations under the License.
 #include "xla/python/ifrt/device_list.h"
 #include "xla/python/ifrt/dtype.h"
 #include "xla/python/ifrt/future.h"
+#include "xla/python/ifrt/index_domain.h"
 #include "xla/python/ifrt/memory.h"
 #include "xla/python/ifrt/shape.h"
 #include "xla/python/ifrt/sharding.h"
@@ -400,10 +402,57 @@ absl::StatusOr<tsl::RCReference<Array>> PjRtArray::Copy(
       canonicalized_sharding_memory_kind.memory_kind().has_value();
   const absl::Span<Device* const> new_sharding_devices =
       new_sharding->devices()->devices();
+  std::vector<Device*> buffer_devices;
+  buffer_devices.reserve(pjrt_buffers_.size());
+  for (const auto& pjrt_buffer : pjrt_buffers_) {
+    TF_ASSIGN_OR_RETURN(buffer_devices.emplace_back(),
+                        client_->LookupPjRtDevice(pjrt_buffer->device()));
+  }
+  auto in_new_memory_kind = [&](int i) {
+    return !new_sharding_has_memory_kind ||
+           pjrt_buffers_[i]->memory_space() == nullptr ||
+           pjrt_buffers_[i]->memory_space()->kind() ==
+               canonicalized_sharding_memory_kind.memory_kind();
+  };
+
+  // A shard that has to move can alias the buffer of another shard that is
+  // already on the destination device and holds the same data, e.g. when a
+  // replicated array is copied to a permutation of its devices. Both the
+  // shards by device and their index domains are only computed when some
+  // shard has to move.
+  std::optional<absl::flat_hash_map<Device*, int>> shard_by_device;
+  std::optional<std::vector<IndexDomain>> index_domains;
+  auto find_coinciding_shard = [&](int i) -> std::optional<int> {
+    if (!shard_by_device.has_value()) {
+      shard_by_device.emplace();
+      for (int j = 0; j < buffer_devices.size(); ++j) {
+        shard_by_device->try_emplace(buffer_devices[j], j);
+      }
+      const Shape* static_shape = std::get_if<Shape>(&shape_);
+      if (!sharding_->IsFullyReplicated() && static_shape != nullptr) {
+        absl::StatusOr<std::vector<IndexDomain>> domains =
+            sharding_->IndexDomains(*static_shape);
+        if (domains.ok()) index_domains = *std::move(domains);
+      }
+    }
+    auto it = shard_by_device->find(new_sharding_devices[i]);
+    if (it == shard_by_device->end() || !in_new_memory_kind(it->second)) {
+      return std::nullopt;
+    }
+    const int j = it->second;
+    if (sharding_->IsFullyReplicated() ||
+        (index_domains.has_value() &&
+         (*index_domains)[i] == (*index_domains)[j])) {
+      return j;
+    }
+    return std::nullopt;
+  };
+
+  // Donated buffers are only released at the end, so that they can still be
+  // aliased by other shards.
+  std::vector<int> donated_buffers;
   for (int i = 0; i < pjrt_buffers_.size(); ++i) {
-    TF_ASSIGN_OR_RETURN(Device * buffer_device,
-                        client_->LookupPjRtDevice(pjrt_buffers_[i]->device()));
-    bool devices_equal = buffer_device == new_sharding_devices[i];
+    bool devices_equal = buffer_devices[i] == new_sharding_devices[i];
     bool memories_supported = pjrt_buffers_[i]->memory_space() != nullptr;
     bool memory_kind_equal =
         new_sharding_has_memory_kind && memories_supported &&
@@ -428,6 +477,9 @@ absl::StatusOr<tsl::RCReference<Array>> PjRtArray::Copy(
           buffers.push_back(pjrt_buffers_[i]);
           break;
       }
+    } else if (std::optional<int> j = find_coinciding_shard(i)) {
+      // Same as above, the data is already on the destination device.
+      buffers.push_back(pjrt_buffers_[*j]);
     } else {
       PjRtCompatibleDevice* pjrt_device =
           llvm::dyn_cast<PjRtCompatibleDevice>(new_sharding_devices[i]);
@@ -461,7 +513,7 @@ absl::StatusOr<tsl::RCReference<Array>> PjRtArray::Copy(
             return Unimplemented(
                 "Donation across different memory kinds is not implemented.");
           }
-          pjrt_buffers_[i] = nullptr;
+          donated_buffers.push_back(i);
         }
         buffers.push_back(std::shared_ptr<PjRtBuffer>(copied_buffer.release()));
       } else {
@@ -470,12 +522,15 @@ absl::StatusOr<tsl::RCReference<Array>> PjRtArray::Copy(
             std::unique_ptr<xla::PjRtBuffer> copied_buffer,
             pjrt_buffers_[i]->CopyToDevice(pjrt_device->pjrt_device()));
         if (semantics == ArrayCopySemantics::kDonateInput) {
-          pjrt_buffers_[i] = nullptr;
+          donated_buffers.push_back(i);
         }
         buffers.push_back(std::shared_ptr<PjRtBuffer>(copied_buffer.release()));
       }
     }
   }
+  for (int i : donated_buffers) {
+    pjrt_buffers_[i] = nullptr;
+  }
   return std::visit(
       [this, &new_sharding, &buffers](const auto& shape) {
         return PjRtArray::Create(client_, dtype_, shape,
@@ -558,6 +558,17 @@ PjRtLoadedExecutable::Execute(
   std::unique_ptr<HostCallbackStates> host_callback_states;
   if (!host_send_recv_callbacks_.empty()) {
     host_callback_states = std::make_unique<HostCallbackStates>();
+    // Host callbacks with a batched variant are invoked once for all
+    // computations instead of once per computation.
+    std::vector<std::shared_ptr<HostCallbackBatch>> batches;
+    batches.reserve(host_send_recv_callbacks_.size());
+    for (const auto& host_send_recv_callback : host_send_recv_callbacks_) {
+      auto& batch = batches.emplace_back();
+      if (num_computations > 1 &&
+          host_send_recv_callback->host_callback().batched_callback) {
+        batch = std::make_shared<HostCallbackBatch>(num_computations);
+      }
+    }
     for (int i = 0; i < num_computations; ++i) {
       auto& contexts = host_callback_states->contexts.emplace_back();
       auto& send_callbacks =
@@ -565,11 +576,12 @@ PjRtLoadedExecutable::Execute(
       auto& recv_callbacks =
           host_callback_states->recv_callbacks.emplace_back();
 
-      for (const auto& host_send_recv_callback : host_send_recv_callbacks_) {
+      for (int j = 0; j < host_send_recv_callbacks_.size(); ++j) {
         contexts.push_back(CreateHostCallbackStateAndAppendSendRecvCallbacks(
-            host_send_recv_callback->host_callback(),
+            host_send_recv_callbacks_[j]->host_callback(),
             /*host_memory_for_device_manager=*/nullptr, send_callbacks,
-            recv_callbacks, opts.use_major_to_minor_data_layout_for_callbacks));
+            recv_callbacks, opts.use_major_to_minor_data_layout_for_callbacks,
+            batches[j], /*batch_index=*/i));
       }
     }
     opts.send_callbacks = host_callback_states->send_callbacks;
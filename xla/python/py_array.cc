@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <Python.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -38,10 +39,12 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "absl/types/span.h"
 #include "llvm/Support/Casting.h"
 #include "nanobind/nanobind.h"
@@ -91,9 +94,12 @@ limitations under the License.
 #include "xla/tsl/concurrency/ref_count.h"
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
+#include "tsl/platform/cpu_info.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -406,6 +412,41 @@ struct BatchedCopyToDeviceWithShardingKey {
   }
 };
 
+// Thread pool that runs the per-device transfers of a batched device_put.
+// Transfers from host memory spend most of their time in strided copies into
+// staging buffers, which are independent for each device.
+tsl::thread::ThreadPool* GetDevicePutThreadPool() {
+  static auto* const pool = new tsl::thread::ThreadPool(
+      tsl::Env::Default(), "XLADevicePut",
+      std::min(32, tsl::port::MaxParallelism()));
+  return pool;
+}
+
+// Runs `device_put_fns` in parallel and returns their results in order. The
+// first function runs on the calling thread. Must be called without the GIL.
+// The functions and their results may own Python objects, so they are left to
+// the caller to destroy once it holds the GIL again, even on errors.
+std::vector<absl::StatusOr<DevicePutResult>> RunDevicePutFns(
+    absl::Span<DevicePutResultFn> device_put_fns) {
+  const size_t n = device_put_fns.size();
+  std::vector<absl::StatusOr<DevicePutResult>> results(n);
+  if (n > 1) {
+    tsl::thread::ThreadPool* pool = GetDevicePutThreadPool();
+    absl::BlockingCounter counter(n - 1);
+    for (size_t i = 1; i < n; ++i) {
+      pool->Schedule([&, i] {
+        results[i] = std::move(device_put_fns[i])();
+        counter.DecrementCount();
+      });
+    }
+    results[0] = std::move(device_put_fns[0])();
+    counter.Wait();
+  } else if (n == 1) {
+    results[0] = std::move(device_put_fns[0])();
+  }
+  return results;
+}
+
 }  // namespace
 
 PyArray_Storage::PyArray_Storage(
@@ -992,6 +1033,39 @@ absl::Status PyArray::Delete() {
   return absl::OkStatus();
 }
 
+absl::Status PyArray::ReplaceIfrtArray(
+    tsl::RCReference<ifrt::Array> ifrt_array) {
+  if (ifrt_array->client() != py_client()->ifrt_client()) {
+    return InvalidArgument("Client mismatch when replacing the array buffers.");
+  }
+  if (ifrt_array->shape().dims() != shape()) {
+    return InvalidArgument(
+        "Shape mismatch when replacing the array buffers: %s vs [%s]",
+        ifrt_array->shape().DebugString(), absl::StrJoin(shape(), ","));
+  }
+  TF_ASSIGN_OR_RETURN(ifrt::DType dtype, DtypeToIfRtDType(this->dtype()));
+  if (ifrt_array->dtype() != dtype) {
+    return InvalidArgument(
+        "Dtype mismatch when replacing the array buffers: %s vs %s",
+        ifrt_array->dtype().DebugString(), dtype.DebugString());
+  }
+  ifrt::Array* old_array = this->ifrt_array();
+  if (old_array != nullptr) {
+    const ifrt::DeviceList& old_devices = *old_array->sharding().devices();
+    const ifrt::DeviceList& new_devices = *ifrt_array->sharding().devices();
+    if (!(old_devices == new_devices)) {
+      return InvalidArgument(
+          "Device mismatch when replacing the array buffers: %s vs %s",
+          new_devices.DebugString(), old_devices.DebugString());
+    }
+  }
+  py_arrays().clear();
+  set_npy_value(nb::none());
+  GetStorage().result_status = PjRtFuture<>();
+  SetIfrtArray(std::move(ifrt_array));
+  return absl::OkStatus();
+}
+
 bool PyArray::IsDeleted() const {
   if (ifrt_array() == nullptr) {
     return true;
@@ -1194,22 +1268,19 @@ absl::StatusOr<PyArray> PyArray::BatchedDevicePut(
                   dst_devices[i]->device(), options, dst_memory_kind));
     ++i;
   }
-  std::vector<DevicePutResult> device_puts;
-  device_puts.reserve(device_put_fns.size());
+  std::vector<absl::StatusOr<DevicePutResult>> device_puts;
   {
     nb::gil_scoped_release gil_release;
-    for (auto& device_put_fn : device_put_fns) {
-      TF_ASSIGN_OR_RETURN(auto device_put, std::move(device_put_fn)());
-      device_puts.push_back(std::move(device_put));
-    }
+    device_puts = RunDevicePutFns(absl::MakeSpan(device_put_fns));
   }
   for (auto& device_put : device_puts) {
-    ifrt_arrays.push_back(std::move(device_put.ifrt_array));
+    TF_RETURN_IF_ERROR(device_put.status());
+    ifrt_arrays.push_back(std::move(device_put->ifrt_array));
     devices.push_back(
         ifrt_arrays.back()->sharding().devices()->devices().front());
     shapes.push_back(ifrt_arrays.back()->shape());
-    if (device_put.owning_pybuffer) {
-      owning_pylist.append(device_put.owning_pybuffer);
+    if (device_put->owning_pybuffer) {
+      owning_pylist.append(device_put->owning_pybuffer);
     }
   }
 
@@ -1263,6 +1334,47 @@ absl::Status PyArray::BatchedBlockUntilReady(std::vector<nb::object> objs) {
   return AwaitBuffersReady(absl::MakeConstSpan(ifrt_arrays));
 }
 
+absl::Status PyArray::BatchedDelete(std::vector<nb::object> objs) {
+  // Check all arguments before deleting any of them.
+  for (nb::handle obj : objs) {
+    if (!obj.type().is(PyArray::type())) {
+      return absl::InvalidArgumentError(
+          "PyArray::BatchedDelete can take PyArray only");
+    }
+  }
+
+  std::vector<tsl::RCReference<ifrt::Array>> ifrt_arrays;
+  ifrt_arrays.reserve(objs.size());
+  std::vector<nb::object> garbage;
+  std::vector<PyArray> worklist;
+  worklist.reserve(objs.size());
+  for (nb::handle obj : objs) {
+    worklist.push_back(nb::borrow<PyArray>(obj));
+  }
+  while (!worklist.empty()) {
+    PyArray array = std::move(worklist.back());
+    worklist.pop_back();
+    for (PyArray& shard : array.py_arrays()) {
+      worklist.push_back(shard);
+      garbage.push_back(std::move(shard));
+    }
+    array.py_arrays().clear();
+    if (array.ifrt_array() != nullptr) {
+      ifrt_arrays.push_back(tsl::FormRef(array.ifrt_array()));
+      array.SetIfrtArray(tsl::RCReference<ifrt::Array>());
+    }
+  }
+  GlobalPyRefManager()->AddGarbage(absl::MakeSpan(garbage));
+
+  nb::gil_scoped_release gil_release;
+  // As in Delete(), we do not wait for the deletions to complete.
+  for (auto& ifrt_array : ifrt_arrays) {
+    ifrt_array->Delete();
+  }
+  ifrt_arrays.clear();
+  return absl::OkStatus();
+}
+
 std::vector<nb::object> PyClient::LiveArrays() const {
   std::vector<nb::object> result;
   for (PyArray::Storage* array = arrays_; array; array = array->next) {
@@ -274,6 +274,12 @@ class PyArray : public nanobind::object {
 
   absl::Status Delete();
 
+  // Replaces the device buffers of this array with `ifrt_array`, which must
+  // have the same shape, dtype and devices. The previous buffers, if any, are
+  // dropped but not deleted. Used to reuse the Python object of an array for
+  // the output of a later computation.
+  absl::Status ReplaceIfrtArray(tsl::RCReference<ifrt::Array> ifrt_array);
+
   bool IsDeleted() const;
 
   PyArray Clone() const;
@@ -293,6 +299,12 @@ class PyArray : public nanobind::object {
   static absl::Status BatchedBlockUntilReady(
       std::vector<nanobind::object> objs);
 
+  // Deletes the device buffers of all of `objs`, which must be PyArrays. The
+  // buffers are released in one pass without the GIL, and the references to
+  // the per-shard arrays of `objs` are handed to the global PythonRefManager,
+  // to be released the next time it collects garbage.
+  static absl::Status BatchedDelete(std::vector<nanobind::object> objs);
+
  private:
   absl::StatusOr<PyArray> AssertUnsharded(std::string_view api);
 
@@ -511,7 +511,7 @@ bool HeapProfileKey::operator==(const HeapProfileKey& other) const {
   if ((traceback == nullptr) != (other.traceback == nullptr)) {
     return false;
   }
-  if (traceback && traceback->raw_frames() != other.traceback->raw_frames()) {
+  if (traceback && *traceback != *other.traceback) {
     return false;
   }
   return true;
@@ -520,7 +520,7 @@ bool HeapProfileKey::operator==(const HeapProfileKey& other) const {
 template <typename H>
 H AbslHashValue(H h, const HeapProfileKey& key) {
   if (key.traceback) {
-    h = H::combine(std::move(h), key.traceback->raw_frames());
+    h = H::combine(std::move(h), *key.traceback);
   }
   h = H::combine(std::move(h), key.size, key.device);
   return h;
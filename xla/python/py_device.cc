@@ -222,6 +222,10 @@ absl::StatusOr<std::optional<nb::dict>> PyDevice::MemoryStats() const {
   if (maybe_stats->peak_pool_bytes) {
     result["peak_pool_bytes"] = *maybe_stats->peak_pool_bytes;
   }
+  if (maybe_stats->fragmentation) {
+    result["fragmentation"] = *maybe_stats->fragmentation;
+  }
+  result["num_alloc_retries"] = maybe_stats->num_alloc_retries;
   return result;
 }
 
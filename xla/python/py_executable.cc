@@ -27,12 +27,15 @@ limitations under the License.
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
+#include "llvm/Support/Casting.h"
 #include "nanobind/nanobind.h"
 #include "xla/hlo/ir/hlo_module.h"
+#include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_executable.h"
 #include "xla/pjrt/pjrt_future.h"
 #include "xla/pjrt/pjrt_layout.h"
@@ -42,12 +45,16 @@ limitations under the License.
 #include "xla/python/ifrt/executable.h"
 #include "xla/python/ifrt/future.h"
 #include "xla/python/ifrt/memory.h"
+#include "xla/python/ifrt/shape.h"
 #include "xla/python/ifrt/sharding.h"
 #include "xla/python/nb_class_ptr.h"
+#include "xla/python/pjrt_ifrt/pjrt_array.h"
+#include "xla/python/pjrt_ifrt/pjrt_dtype.h"
 #include "xla/python/py_array.h"
 #include "xla/python/py_client.h"
 #include "xla/python/py_device.h"
 #include "xla/python/traceback.h"
+#include "xla/shape.h"
 #include "xla/tsl/concurrency/ref_count.h"
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
@@ -402,6 +409,164 @@ absl::StatusOr<PyExecuteResults> PyLoadedExecutable::ExecuteSharded(
                                               span_args, returned_futures);
 }
 
+namespace {
+
+// Returns the identities of the device buffers held by `array`: its PjRt
+// buffers on PjRt-compatible backends, its IFRT array otherwise. Two arrays
+// alias exactly when their identities intersect.
+std::vector<const void*> BufferIdentities(const PyArray& array) {
+  std::vector<const void*> ids;
+  ifrt::Array* ifrt_array = array.ifrt_array();
+  if (ifrt_array == nullptr) return ids;
+  if (auto* arr = llvm::dyn_cast<ifrt::PjRtCompatibleArray>(ifrt_array)) {
+    for (const std::shared_ptr<PjRtBuffer>& buffer : arr->pjrt_buffers()) {
+      ids.push_back(buffer.get());
+    }
+  } else {
+    ids.push_back(ifrt_array);
+  }
+  return ids;
+}
+
+// Checks that `outputs` can hold the results of `executable`, so that
+// execute_sharded_into fails before deleting any of their buffers.
+absl::Status ValidateShardedIntoOutputs(ifrt::LoadedExecutable* executable,
+                                        const PyClient* client,
+                                        absl::Span<const PyArray> outputs) {
+  TF_ASSIGN_OR_RETURN(std::vector<std::vector<std::string_view>> memory_kinds,
+                      executable->GetOutputMemoryKinds());
+  if (memory_kinds.empty() || memory_kinds.front().size() != outputs.size()) {
+    return InvalidArgument(
+        "Mismatch between outputs and num_results of execute_sharded_into: "
+        "%d vs %d",
+        outputs.size(),
+        memory_kinds.empty() ? 0 : memory_kinds.front().size());
+  }
+  TF_ASSIGN_OR_RETURN(std::vector<std::shared_ptr<HloModule>> hlo_modules,
+                      executable->GetHloModules());
+  std::vector<const Shape*> result_shapes;
+  if (!hlo_modules.empty()) {
+    const Shape& result_shape = hlo_modules.front()->result_shape();
+    if (result_shape.IsTuple()) {
+      for (const Shape& shape : result_shape.tuple_shapes()) {
+        result_shapes.push_back(&shape);
+      }
+    } else {
+      result_shapes.push_back(&result_shape);
+    }
+  }
+
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const PyArray& output = outputs[i];
+    if (output.py_client().get() != client) {
+      return InvalidArgument(
+          "Output arrays of execute_sharded_into must belong to the client of "
+          "the executable.");
+    }
+    ifrt::Array* ifrt_array = output.ifrt_array();
+    if (ifrt_array == nullptr) continue;
+    if (!absl::c_equal(ifrt_array->sharding().devices()->devices(),
+                       executable->addressable_devices())) {
+      return InvalidArgument(
+          "Output %d of execute_sharded_into is not on the addressable devices "
+          "of the executable: %s",
+          i, ifrt_array->sharding().devices()->DebugString());
+    }
+    if (result_shapes.size() != outputs.size()) continue;
+    const Shape& result_shape = *result_shapes[i];
+    TF_ASSIGN_OR_RETURN(ifrt::DType result_dtype,
+                        ifrt::ToDType(result_shape.element_type()));
+    if (ifrt_array->dtype() != result_dtype) {
+      return InvalidArgument(
+          "Dtype mismatch for output %d of execute_sharded_into: %s vs %s", i,
+          ifrt_array->dtype().DebugString(), result_dtype.DebugString());
+    }
+    // The compiled module produces per-device shards. Shardings without a
+    // uniform shard shape are left to ReplaceIfrtArray.
+    absl::StatusOr<ifrt::Shape> shard_shape =
+        ifrt_array->sharding().GetShardShape(ifrt_array->shape());
+    if (shard_shape.ok() &&
+        !absl::c_equal(shard_shape->dims(), result_shape.dimensions())) {
+      return InvalidArgument(
+          "Shape mismatch for output %d of execute_sharded_into: %s vs %s", i,
+          shard_shape->DebugString(), result_shape.ToString());
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status PyLoadedExecutable::ExecuteShardedInto(
+    std::vector<ExecuteShardedArg> args, std::vector<PyArray> outputs) {
+  TF_RETURN_IF_ERROR(ValidateShardedIntoOutputs(
+      ifrt_loaded_executable_.get(), client_.get(), outputs));
+
+  absl::flat_hash_set<const void*> arg_buffers;
+  for (const ExecuteShardedArg& arg : args) {
+    if (std::holds_alternative<PyArray>(arg)) {
+      for (const void* id : BufferIdentities(std::get<PyArray>(arg))) {
+        arg_buffers.insert(id);
+      }
+    } else {
+      for (const PyArray& shard : std::get<std::vector<PyArray>>(arg)) {
+        for (const void* id : BufferIdentities(shard)) {
+          arg_buffers.insert(id);
+        }
+      }
+    }
+  }
+  // Outputs whose buffers are also passed as arguments, possibly through a
+  // different Python object, are left to the alias and donation config.
+  std::vector<bool> is_argument(outputs.size());
+  absl::flat_hash_set<const void*> output_buffers;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    for (const void* id : BufferIdentities(outputs[i])) {
+      if (!output_buffers.insert(id).second) {
+        return InvalidArgument(
+            "Output %d of execute_sharded_into shares buffers with another "
+            "output.",
+            i);
+      }
+      if (arg_buffers.contains(id)) is_argument[i] = true;
+    }
+  }
+
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    if (is_argument[i]) continue;
+    PyArray& output = outputs[i];
+    // Keep the deleted array around: its sharding is checked against the
+    // result when the output is replaced.
+    for (PyArray& shard : output.py_arrays()) {
+      TF_RETURN_IF_ERROR(shard.Delete());
+    }
+    output.py_arrays().clear();
+    if (output.ifrt_array() != nullptr) {
+      output.ifrt_array()->Delete();
+    }
+  }
+
+  xla::ifrt::ExecuteOptions options = options_;
+  options.fill_status = false;
+  std::optional<std::vector<PjRtFuture<>>> returned_futures;
+  absl::Span<const ExecuteShardedArg> span_args = args;
+  TF_ASSIGN_OR_RETURN(PyExecuteResults results,
+                      ExecuteShardedOnLocalDevicesInternal(
+                          options, client_, ifrt_loaded_executable_.get(),
+                          span_args, returned_futures));
+  if (results.Size() != outputs.size()) {
+    return InvalidArgument(
+        "Mismatch between outputs and num_results of execute_sharded_into: "
+        "%d vs %d",
+        outputs.size(), results.Size());
+  }
+  std::vector<tsl::RCReference<ifrt::Array>> ifrt_arrays = results.Consume();
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    TF_RETURN_IF_ERROR(outputs[i].ReplaceIfrtArray(std::move(ifrt_arrays[i])));
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::vector<std::shared_ptr<HloModule>>>
 PyLoadedExecutable::HloModules() const {
   nb::gil_scoped_release gil_release;
@@ -185,6 +185,20 @@ class PyLoadedExecutable {
   absl::StatusOr<PyExecuteResults> ExecuteSharded(
       std::vector<ExecuteShardedArg> args, bool with_tokens);
 
+  // Like ExecuteSharded, but stores the results in `outputs`, one existing
+  // PyArray per result, instead of creating new PyArrays. The device buffers
+  // held by `outputs` are deleted before the computation is launched, so that
+  // the allocator can reuse them for the results; outputs that are also passed
+  // as arguments are left to the input/output alias and donation config of the
+  // executable; aliasing is detected through the underlying device buffers,
+  // not the Python objects. A steady-state loop can thus alternate between two
+  // sets of outputs without creating Python objects or growing device memory.
+  // The number, client, devices, dtypes and shard shapes of `outputs` are
+  // validated before anything is deleted; if the launch itself fails, the
+  // buffers of `outputs` may already have been deleted.
+  absl::Status ExecuteShardedInto(std::vector<ExecuteShardedArg> args,
+                                  std::vector<PyArray> outputs);
+
   absl::StatusOr<std::vector<std::shared_ptr<HloModule>>> HloModules() const;
 
   absl::StatusOr<std::vector<std::vector<std::string_view>>>
@@ -36,7 +36,9 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
 #include "absl/hash/hash.h"
+#include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -52,7 +54,9 @@ limitations under the License.
 #include "xla/python/nb_class_ptr.h"
 #include "xla/python/nb_helpers.h"
 #include "xla/python/pytree.pb.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/protobuf.h"
 
 namespace xla {
 
@@ -97,6 +101,7 @@ void PyTreeRegistry::Register(nb::object type, nb::callable to_iterable,
         absl::StrFormat("Duplicate custom PyTreeDef type registration for %s.",
                         nb::cast<std::string_view>(nb::repr(type))));
   }
+  ++version_;
 }
 
 void PyTreeRegistry::RegisterDataclass(nb::object type,
@@ -113,6 +118,7 @@ void PyTreeRegistry::RegisterDataclass(nb::object type,
         "Duplicate custom dataclass PyTreeDef type registration for %s.",
         nb::cast<std::string_view>(nb::repr(std::move(type)))));
   }
+  ++version_;
 }
 
 std::pair<nanobind::iterable, nanobind::object>
@@ -434,6 +440,196 @@ PyTreeDef::Flatten(nb::handle x, std::optional<nb::callable> leaf_predicate,
   return std::make_pair(std::move(leaves), std::move(def));
 }
 
+// Maximum number of leaf types remembered per flatten plan.
+constexpr int kMaxCachedLeafTypes = 8;
+
+bool PyTreeDef::MatchStructure(
+    nb::handle handle,
+    absl::InlinedVector<PyTreeDef::Node, 1>::const_reverse_iterator* it,
+    nb::object** next_leaf,
+    absl::InlinedVector<nb::object, 4>& leaf_types) const {
+  const Node& node = **it;
+  ++*it;
+  PyObject* obj = handle.ptr();
+  // Children are visited in reverse order, matching the reverse post-order
+  // traversal of the plan.
+  auto match = [&](nb::handle child) {
+    return MatchStructure(child, it, next_leaf, leaf_types);
+  };
+  switch (node.kind) {
+    case PyTreeKind::kLeaf: {
+      bool known_leaf = absl::c_any_of(leaf_types, [&](const nb::object& t) {
+        return t.ptr() == reinterpret_cast<PyObject*>(Py_TYPE(obj));
+      });
+      if (!known_leaf) {
+        const PyTreeRegistry::Registration* custom;
+        if (registry_->KindOfObject(handle, &custom) != PyTreeKind::kLeaf) {
+          return false;
+        }
+        // Whether a tuple subclass is a namedtuple depends on the instance, so
+        // only remember other types.
+        if (!PyTuple_Check(obj) && leaf_types.size() < kMaxCachedLeafTypes) {
+          leaf_types.push_back(nb::borrow<nb::object>(handle.type()));
+        }
+      }
+      --*next_leaf;
+      **next_leaf = nb::borrow<nb::object>(handle);
+      return true;
+    }
+    case PyTreeKind::kNone:
+      return handle.is_none();
+    case PyTreeKind::kTuple:
+      if (!PyTuple_CheckExact(obj) || PyTuple_GET_SIZE(obj) != node.arity) {
+        return false;
+      }
+      for (int i = node.arity - 1; i >= 0; --i) {
+        if (!match(PyTuple_GET_ITEM(obj, i))) return false;
+      }
+      return true;
+    case PyTreeKind::kList:
+      if (!PyList_CheckExact(obj) || PyList_GET_SIZE(obj) != node.arity) {
+        return false;
+      }
+      for (int i = node.arity - 1; i >= 0; --i) {
+        if (!match(PyList_GET_ITEM(obj, i))) return false;
+      }
+      return true;
+    case PyTreeKind::kDict: {
+      // A dict of the same size that contains all of the keys of the plan has
+      // the same sorted keys.
+      if (!PyDict_CheckExact(obj) || PyDict_GET_SIZE(obj) != node.arity) {
+        return false;
+      }
+      for (auto key = node.sorted_dict_keys.rbegin();
+           key != node.sorted_dict_keys.rend(); ++key) {
+        PyObject* value = PyDict_GetItemWithError(obj, key->ptr());
+        if (value == nullptr) {
+          if (PyErr_Occurred()) throw nb::python_error();
+          return false;
+        }
+        if (!match(value)) return false;
+      }
+      return true;
+    }
+    case PyTreeKind::kNamedTuple:
+      if (!handle.type().is(node.node_data) ||
+          PyTuple_GET_SIZE(obj) != node.arity) {
+        return false;
+      }
+      for (int i = node.arity - 1; i >= 0; --i) {
+        if (!match(PyTuple_GET_ITEM(obj, i))) return false;
+      }
+      return true;
+    case PyTreeKind::kCustom: {
+      if (!handle.type().is(node.custom->type)) return false;
+      auto [children, aux_data] = node.custom->ToIterable(handle);
+      if (aux_data.not_equal(node.node_data)) return false;
+      absl::InlinedVector<nb::object, 4> entries;
+      for (nb::handle entry : children) {
+        entries.push_back(nb::borrow<nb::object>(entry));
+      }
+      if (entries.size() != node.arity) return false;
+      for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+        if (!match(*entry)) return false;
+      }
+      return true;
+    }
+    case PyTreeKind::kDataclass: {
+      if (!handle.type().is(node.custom->type)) return false;
+      const auto& meta_fields = node.custom->meta_fields;
+      for (int i = 0; i < meta_fields.size(); ++i) {
+        nb::handle expected = PyTuple_GET_ITEM(node.node_data.ptr(), i);
+        if (nb::getattr(handle, meta_fields[i]).not_equal(expected)) {
+          return false;
+        }
+      }
+      const auto& data_fields = node.custom->data_fields;
+      for (int i = data_fields.size() - 1; i >= 0; --i) {
+        if (!match(nb::getattr(handle, data_fields[i]))) return false;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PyTreeDef::FlattenLike(const PyTreeDef& plan, nb::handle handle,
+                            absl::InlinedVector<nb::object, 2>& leaves,
+                            absl::InlinedVector<nb::object, 4>& leaf_types) {
+  const size_t start_num_leaves = leaves.size();
+  leaves.resize(start_num_leaves + plan.num_leaves());
+  nb::object* next_leaf = leaves.data() + leaves.size();
+  auto it = plan.traversal_.crbegin();
+  bool matches;
+  try {
+    matches = plan.MatchStructure(handle, &it, &next_leaf, leaf_types);
+  } catch (...) {
+    leaves.resize(start_num_leaves);
+    throw;
+  }
+  if (!matches) {
+    leaves.resize(start_num_leaves);
+    return false;
+  }
+  DCHECK(it == plan.traversal_.crend());
+  DCHECK_EQ(next_leaf, leaves.data() + start_num_leaves);
+  traversal_.insert(traversal_.end(), plan.traversal_.begin(),
+                    plan.traversal_.end());
+  return true;
+}
+
+void PyTreeFlattenCache::Flatten(int position, nb::handle handle,
+                                 PyTreeDef& treedef,
+                                 absl::InlinedVector<nb::object, 2>& leaves) {
+  DCHECK_EQ(treedef.num_nodes(), 0);
+  PyTreeRegistry* registry = treedef.registry();
+  std::pair<int, PyObject*> key(position, handle.type().ptr());
+  auto it = plans_.find(key);
+  if (it != plans_.end()) {
+    Plan& plan = it->second;
+    if (plan.registry == registry &&
+        plan.registry_version == registry->version() &&
+        treedef.FlattenLike(*plan.treedef, handle, leaves, plan.leaf_types)) {
+      return;
+    }
+  }
+
+  treedef.Flatten(handle, leaves);
+
+  if (it == plans_.end() && plans_.size() >= capacity_) {
+    plans_.clear();
+  }
+  Plan& plan = plans_[key];
+  plan.root_type = nb::borrow<nb::object>(handle.type());
+  plan.registry = registry;
+  plan.registry_version = registry->version();
+  plan.treedef = std::make_unique<PyTreeDef>(treedef);
+  plan.leaf_types.clear();
+}
+
+int PyTreeDef::Traverse(visitproc visit, void* arg) const {
+  for (const Node& node : traversal_) {
+    Py_VISIT(node.node_data.ptr());
+    for (const nb::object& key : node.sorted_dict_keys) {
+      Py_VISIT(key.ptr());
+    }
+  }
+  return 0;
+}
+
+int PyTreeFlattenCache::Traverse(visitproc visit, void* arg) const {
+  for (const auto& [key, plan] : plans_) {
+    Py_VISIT(plan.root_type.ptr());
+    for (const nb::object& leaf_type : plan.leaf_types) {
+      Py_VISIT(leaf_type.ptr());
+    }
+    if (int ret = plan.treedef->Traverse(visit, arg); ret != 0) {
+      return ret;
+    }
+  }
+  return 0;
+}
+
 /*static*/ bool PyTreeDef::AllLeaves(PyTreeRegistry* registry,
                                      const nb::iterable& x) {
   const PyTreeRegistry::Registration* custom;
@@ -1081,6 +1277,82 @@ void PyTreeDef::SetNumLeavesAndNumNodes() {
   }
 }
 
+void PyTreeDef::NodeToProto(
+    const Node& node,
+    absl::FunctionRef<uint32_t(const std::string&)> intern_str,
+    jax::PyTreeNodeDefProto& result) {
+  result.set_arity(node.arity);
+  switch (node.kind) {
+    case PyTreeKind::kLeaf:
+      result.set_type(jax::PyTreeNodeType::PY_TREE_KIND_LEAF);
+      break;
+    case PyTreeKind::kList:
+      result.set_type(jax::PyTreeNodeType::PY_TREE_KIND_LIST);
+      break;
+    case PyTreeKind::kNone:
+      result.set_type(jax::PyTreeNodeType::PY_TREE_KIND_NONE);
+      break;
+    case PyTreeKind::kTuple:
+      result.set_type(jax::PyTreeNodeType::PY_TREE_KIND_TUPLE);
+      break;
+    case PyTreeKind::kDict:
+      result.set_type(jax::PyTreeNodeType::PY_TREE_KIND_DICT);
+      for (auto& key : node.sorted_dict_keys) {
+        if (!nb::isinstance<nb::str>(key)) {
+          throw std::invalid_argument(
+              "Only string keys are supported in proto pytree "
+              "serialization.");
+        }
+        result.mutable_dict_keys()->add_str_id(
+            intern_str(nb::cast<std::string>(key)));
+      }
+      break;
+    default:
+      throw std::invalid_argument(
+          "User-defined nodes are not supported when serializing pytrees as "
+          "protocol buffers. You should either convert the user-defined "
+          "nodes to another type or use pickle instead.");
+      break;
+  }
+}
+
+PyTreeDef::Node PyTreeDef::NodeFromProto(
+    const jax::PyTreeNodeDefProto& input,
+    absl::Span<const nb::object> interned_strings) {
+  Node node;
+  node.arity = input.arity();
+  node.custom = nullptr;
+  switch (input.type()) {
+    case jax::PyTreeNodeType::PY_TREE_KIND_LEAF:
+      node.kind = PyTreeKind::kLeaf;
+      break;
+    case jax::PyTreeNodeType::PY_TREE_KIND_LIST:
+      node.kind = PyTreeKind::kList;
+      break;
+    case jax::PyTreeNodeType::PY_TREE_KIND_NONE:
+      node.kind = PyTreeKind::kNone;
+      break;
+    case jax::PyTreeNodeType::PY_TREE_KIND_TUPLE:
+      node.kind = PyTreeKind::kTuple;
+      break;
+    case jax::PyTreeNodeType::PY_TREE_KIND_DICT:
+      node.kind = PyTreeKind::kDict;
+      for (uint32_t str_id : input.dict_keys().str_id()) {
+        if (str_id >= interned_strings.size()) {
+          throw std::invalid_argument(
+              "Malformed pytree proto (dict_key out of range).");
+        }
+        node.sorted_dict_keys.push_back(interned_strings[str_id]);
+      }
+      break;
+    default:
+      throw std::invalid_argument(
+          "Malformed pytree proto (invalid node type)");
+      break;
+  }
+  return node;
+}
+
 void PyTreeDef::SerializeTo(jax::PyTreeDefProto& result) const {
   absl::flat_hash_map<std::string, uint32_t> interned_strings;
   auto intern_str = [&](const std::string& key) {
@@ -1092,40 +1364,7 @@ void PyTreeDef::SerializeTo(jax::PyTreeDefProto& result) const {
     return it->second;
   };
   for (const auto& node : traversal_) {
-    auto* node_data = result.add_nodes();
-    node_data->set_arity(node.arity);
-    switch (node.kind) {
-      case PyTreeKind::kLeaf:
-        node_data->set_type(jax::PyTreeNodeType::PY_TREE_KIND_LEAF);
-        break;
-      case PyTreeKind::kList:
-        node_data->set_type(jax::PyTreeNodeType::PY_TREE_KIND_LIST);
-        break;
-      case PyTreeKind::kNone:
-        node_data->set_type(jax::PyTreeNodeType::PY_TREE_KIND_NONE);
-        break;
-      case PyTreeKind::kTuple:
-        node_data->set_type(jax::PyTreeNodeType::PY_TREE_KIND_TUPLE);
-        break;
-      case PyTreeKind::kDict:
-        node_data->set_type(jax::PyTreeNodeType::PY_TREE_KIND_DICT);
-        for (auto& key : node.sorted_dict_keys) {
-          if (!nb::isinstance<nb::str>(key)) {
-            throw std::invalid_argument(
-                "Only string keys are supported in proto pytree "
-                "serialization.");
-          }
-          node_data->mutable_dict_keys()->add_str_id(
-              intern_str(nb::cast<std::string>(key)));
-        }
-        break;
-      default:
-        throw std::invalid_argument(
-            "User-defined nodes are not supported when serializing pytrees as "
-            "protocol buffers. You should either convert the user-defined "
-            "nodes to another type or use pickle instead.");
-        break;
-    }
+    NodeToProto(node, intern_str, *result.add_nodes());
   }
 }
 
@@ -1140,39 +1379,151 @@ nb_class_ptr<PyTreeDef> PyTreeDef::DeserializeFrom(
   nb_class_ptr<PyTreeDef> result =
       make_nb_class<PyTreeDef>(std::move(registry));
   for (auto& node_proto : input.nodes()) {
-    result->traversal_.emplace_back();
-    auto& node = result->traversal_.back();
-    node.arity = node_proto.arity();
-    node.custom = nullptr;
-    switch (node_proto.type()) {
-      case jax::PyTreeNodeType::PY_TREE_KIND_LEAF:
-        node.kind = PyTreeKind::kLeaf;
-        break;
-      case jax::PyTreeNodeType::PY_TREE_KIND_LIST:
-        node.kind = PyTreeKind::kList;
-        break;
-      case jax::PyTreeNodeType::PY_TREE_KIND_NONE:
-        node.kind = PyTreeKind::kNone;
-        break;
-      case jax::PyTreeNodeType::PY_TREE_KIND_TUPLE:
-        node.kind = PyTreeKind::kTuple;
-        break;
-      case jax::PyTreeNodeType::PY_TREE_KIND_DICT:
-        node.kind = PyTreeKind::kDict;
-        for (uint32_t str_id : node_proto.dict_keys().str_id()) {
-          if (str_id >= interned_strings.size()) {
-            throw std::invalid_argument(
-                "Malformed pytree proto (dict_key out of range).");
-          }
-          node.sorted_dict_keys.push_back(interned_strings.at(str_id));
+    result->traversal_.push_back(NodeFromProto(node_proto, interned_strings));
+  }
+  result->SetNumLeavesAndNumNodes();
+  return result;
+}
+
+namespace {
+
+// Tags of the repeated fields of PyTreeDefProto, which are both
+// length-delimited (wire type 2).
+constexpr uint32_t kNodesTag =
+    (jax::PyTreeDefProto::kNodesFieldNumber << 3) | 2;
+constexpr uint32_t kInternedStringsTag =
+    (jax::PyTreeDefProto::kInternedStringsFieldNumber << 3) | 2;
+
+// Appends the bytes written to a protobuf output stream to a file.
+class WritableFileCopyingStream
+    : public tsl::protobuf::io::CopyingOutputStream {
+ public:
+  explicit WritableFileCopyingStream(tsl::WritableFile* file) : file_(file) {}
+
+  bool Write(const void* buffer, int size) override {
+    status_ = file_->Append(
+        std::string_view(static_cast<const char*>(buffer), size));
+    return status_.ok();
+  }
+
+  const absl::Status& status() const { return status_; }
+
+ private:
+  tsl::WritableFile* file_;
+  absl::Status status_;
+};
+
+void ThrowIfIoError(const absl::Status& status, const std::string& path) {
+  if (!status.ok()) {
+    throw xla::XlaRuntimeError(
+        absl::StrCat("I/O error on pytree serialization file ", path, ": ",
+                     status.ToString()));
+  }
+}
+
+}  // namespace
+
+void PyTreeDef::SerializeToFile(const std::string& path) const {
+  std::unique_ptr<tsl::WritableFile> file;
+  ThrowIfIoError(tsl::Env::Default()->NewWritableFile(path, &file), path);
+  WritableFileCopyingStream copying_stream(file.get());
+  {
+    tsl::protobuf::io::CopyingOutputStreamAdaptor adaptor(&copying_stream);
+    {
+      tsl::protobuf::io::CodedOutputStream output(&adaptor);
+      // Strings are written as they are interned, so that they always precede
+      // the nodes that refer to them. Proto parsers concatenate the elements
+      // of a repeated field in order, so the interleaving is still a valid
+      // PyTreeDefProto.
+      absl::flat_hash_map<std::string, uint32_t> interned_strings;
+      auto intern_str = [&](const std::string& key) {
+        auto [it, added] =
+            interned_strings.emplace(key, interned_strings.size());
+        if (added) {
+          output.WriteTag(kInternedStringsTag);
+          output.WriteVarint32(key.size());
+          output.WriteString(key);
         }
-        break;
-      default:
-        throw std::invalid_argument(
-            "Malformed pytree proto (invalid node type)");
-        break;
+        return it->second;
+      };
+      jax::PyTreeNodeDefProto node_proto;
+      for (const auto& node : traversal_) {
+        node_proto.Clear();
+        NodeToProto(node, intern_str, node_proto);
+        output.WriteTag(kNodesTag);
+        output.WriteVarint32(node_proto.ByteSizeLong());
+        node_proto.SerializeWithCachedSizes(&output);
+      }
+      if (output.HadError()) {
+        ThrowIfIoError(copying_stream.status(), path);
+        throw xla::XlaRuntimeError("Could not serialize PyTreeDefProto.");
+      }
+    }
+    if (!adaptor.Flush()) {
+      ThrowIfIoError(copying_stream.status(), path);
+    }
+  }
+  ThrowIfIoError(file->Close(), path);
+}
+
+nb_class_ptr<PyTreeDef> PyTreeDef::DeserializeFromFile(
+    std::shared_ptr<PyTreeRegistry> registry, const std::string& path) {
+  std::unique_ptr<tsl::ReadOnlyMemoryRegion> region;
+  ThrowIfIoError(
+      tsl::Env::Default()->NewReadOnlyMemoryRegionFromFile(path, &region),
+      path);
+  if (region->length() > std::numeric_limits<int>::max()) {
+    throw xla::XlaRuntimeError(
+        "Pytree serialization too large to deserialize.");
+  }
+  tsl::protobuf::io::CodedInputStream input(
+      static_cast<const uint8_t*>(region->data()), region->length());
+
+  nb_class_ptr<PyTreeDef> result =
+      make_nb_class<PyTreeDef>(std::move(registry));
+  std::vector<nb::object> interned_strings;
+  // Dict nodes that refer to strings further in the file, e.g. when it was
+  // written by SerializeTo, which emits all the strings after the nodes.
+  std::vector<std::pair<size_t, jax::PyTreeNodeDefProto>> pending_nodes;
+  jax::PyTreeNodeDefProto node_proto;
+  std::string str;
+  while (uint32_t tag = input.ReadTag()) {
+    uint32_t length;
+    if (!input.ReadVarint32(&length)) {
+      throw xla::XlaRuntimeError("Could not deserialize PyTreeDefProto.");
+    }
+    if (tag == kInternedStringsTag) {
+      if (!input.ReadString(&str, length)) {
+        throw xla::XlaRuntimeError("Could not deserialize PyTreeDefProto.");
+      }
+      interned_strings.push_back(nb::cast(str));
+    } else if (tag == kNodesTag) {
+      auto limit = input.PushLimit(length);
+      node_proto.Clear();
+      if (!node_proto.MergeFromCodedStream(&input) ||
+          !input.ConsumedEntireMessage()) {
+        throw xla::XlaRuntimeError("Could not deserialize PyTreeDefProto.");
+      }
+      input.PopLimit(limit);
+      if (absl::c_all_of(node_proto.dict_keys().str_id(), [&](uint32_t id) {
+            return id < interned_strings.size();
+          })) {
+        result->traversal_.push_back(
+            NodeFromProto(node_proto, interned_strings));
+      } else {
+        result->traversal_.emplace_back();
+        pending_nodes.emplace_back(result->traversal_.size() - 1, node_proto);
+      }
+    } else {
+      throw xla::XlaRuntimeError("Could not deserialize PyTreeDefProto.");
     }
   }
+  if (!input.ConsumedEntireMessage()) {
+    throw xla::XlaRuntimeError("Could not deserialize PyTreeDefProto.");
+  }
+  for (const auto& [index, pending_proto] : pending_nodes) {
+    result->traversal_[index] = NodeFromProto(pending_proto, interned_strings);
+  }
   result->SetNumLeavesAndNumNodes();
   return result;
 }
@@ -1260,6 +1611,30 @@ nb_class_ptr<PyTreeDef> PyTreeDef::MakeFromNodeDataAndChildren(
   return result;
 }
 
+namespace {
+
+int PyTreeFlattenCache_tp_traverse(PyObject* self, visitproc visit,
+                                   void* arg) {
+  Py_VISIT(Py_TYPE(self));
+  if (!nb::inst_ready(self)) {
+    return 0;
+  }
+  return nb::inst_ptr<PyTreeFlattenCache>(self)->Traverse(visit, arg);
+}
+
+int PyTreeFlattenCache_tp_clear(PyObject* self) {
+  nb::inst_ptr<PyTreeFlattenCache>(self)->Clear();
+  return 0;
+}
+
+PyType_Slot PyTreeFlattenCache_slots[] = {
+    {Py_tp_traverse, (void*)PyTreeFlattenCache_tp_traverse},
+    {Py_tp_clear, (void*)PyTreeFlattenCache_tp_clear},
+    {0, nullptr},
+};
+
+}  // namespace
+
 void BuildPytreeSubmodule(nb::module_& m) {
   nb::module_ pytree = m.def_submodule("pytree", "Python tree library");
   pytree.attr("version") = nb::int_(3);
@@ -1336,6 +1711,11 @@ void BuildPytreeSubmodule(nb::module_& m) {
         return PyTreeDef::DeserializeFrom(std::move(registry), input);
       },
       nb::arg("registry"), nb::arg("data"));
+  treedef.def("serialize_using_proto_to_file", &PyTreeDef::SerializeToFile,
+              nb::arg("path"));
+  treedef.def_static("deserialize_using_proto_from_file",
+                     &PyTreeDef::DeserializeFromFile, nb::arg("registry"),
+                     nb::arg("path"));
   treedef.def("node_data", &PyTreeDef::GetNodeData,
               "Returns None if a leaf-pytree, else (type, node_data)");
   treedef.def_static(
@@ -1344,6 +1724,13 @@ void BuildPytreeSubmodule(nb::module_& m) {
       nb::arg("node_data").none(), nb::arg("children"),
       "Reconstructs a pytree from `node_data()` and `children()`.");
   treedef.def("__getstate__", &PyTreeDef::ToPickle);
+
+  nb::class_<PyTreeFlattenCache>(pytree, "PyTreeFlattenCache",
+                                 nb::is_weak_referenceable(),
+                                 nb::type_slots(PyTreeFlattenCache_slots))
+      .def(nb::init<int>(),
+           nb::arg("capacity") = PyTreeFlattenCache::kDefaultCapacity)
+      .def("clear", &PyTreeFlattenCache::Clear);
   treedef.def("__setstate__", [](PyTreeDef& t, nb::object o) {
     nb::tuple pickle = nb::cast<nb::tuple>(o);
     if (pickle.size() != 2) {
@@ -20,6 +20,7 @@ limitations under the License.
 // about pytree.
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -29,6 +30,7 @@ limitations under the License.
 // placeholder for index annotation headers
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
 #include "absl/hash/hash.h"
 #include "absl/types/span.h"
 #include "nanobind/nanobind.h"
@@ -100,6 +102,10 @@ class PyTreeRegistry : public std::enable_shared_from_this<PyTreeRegistry> {
   // the node data, or None, if the entry is a leaf.
   nanobind::object FlattenOneLevel(nanobind::handle x) const;
 
+  // Incremented whenever a type is registered. Used to invalidate structure
+  // that was derived from the registrations, see PyTreeFlattenCache.
+  uint64_t version() const { return version_; }
+
  private:
   struct TypeHash {
     using is_transparent = void;
@@ -125,6 +131,7 @@ class PyTreeRegistry : public std::enable_shared_from_this<PyTreeRegistry> {
                       TypeEq>
       registrations_;
   bool enable_namedtuple_;
+  uint64_t version_ = 0;
 };
 
 // Returns the default pytree registry.
@@ -207,6 +214,10 @@ class PyTreeDef {
 
   PyTreeRegistry* registry() const { return registry_; }
 
+  // Visits the Python objects referenced by the nodes of this PyTreeDef, for
+  // use in the tp_traverse implementation of objects that own PyTreeDefs.
+  int Traverse(visitproc visit, void* arg) const;
+
   size_t Hash() const;
 
   bool operator==(const PyTreeDef& other) const;
@@ -228,6 +239,17 @@ class PyTreeDef {
       std::shared_ptr<PyTreeRegistry> registry,
       const jax::PyTreeDefProto& input);
 
+  // Like SerializeTo, but writes each node and interned string to the file at
+  // `path` as soon as it is produced, instead of building the whole proto in
+  // memory. The file contains a serialized PyTreeDefProto.
+  void SerializeToFile(const std::string& path) const;
+
+  // Deserializes a PyTreeDefProto from the file at `path`. The file is memory
+  // mapped and parsed one node at a time, so only the resulting PyTreeDef is
+  // held in memory.
+  static nb_class_ptr<PyTreeDef> DeserializeFromFile(
+      std::shared_ptr<PyTreeRegistry> registry, const std::string& path);
+
   std::optional<std::pair<nanobind::object, nanobind::object>> GetNodeData()
       const;
 
@@ -269,6 +291,8 @@ class PyTreeDef {
   template <typename H>
   friend H AbslHashValue(H h, const Node& n);
 
+  friend class PyTreeFlattenCache;
+
   template <typename H>
   friend H AbslHashValue(H h, const PyTreeDef& t);
 
@@ -276,6 +300,19 @@ class PyTreeDef {
   static nanobind::object MakeNode(const Node& node,
                                    absl::Span<nanobind::object> children);
 
+  // Converts `node` to its proto form, using `intern_str` to map dict keys to
+  // ids in the interned strings of the proto.
+  static void NodeToProto(
+      const Node& node,
+      absl::FunctionRef<uint32_t(const std::string&)> intern_str,
+      jax::PyTreeNodeDefProto& result);
+
+  // Converts a node from its proto form. Dict key ids index into
+  // `interned_strings`.
+  static Node NodeFromProto(
+      const jax::PyTreeNodeDefProto& input,
+      absl::Span<const nanobind::object> interned_strings);
+
   // Recursive helper used to implement FromIterableTree()
   nanobind::object FromIterableTreeHelper(
       nanobind::handle xs,
@@ -286,6 +323,24 @@ class PyTreeDef {
   void FlattenImpl(nanobind::handle handle, T& leaves,
                    const std::optional<nanobind::callable>& leaf_predicate);
 
+  // Flattens `handle` into `leaves` if it has the same structure as `plan`, a
+  // PyTreeDef of a single tree, and appends the nodes of `plan` to this
+  // PyTreeDef. `leaf_types` caches the types known to be leaves under the
+  // current registrations. Returns false, leaving `leaves` and this PyTreeDef
+  // unchanged, if the structure of `handle` differs from `plan`.
+  bool FlattenLike(const PyTreeDef& plan, nanobind::handle handle,
+                   absl::InlinedVector<nanobind::object, 2>& leaves,
+                   absl::InlinedVector<nanobind::object, 4>& leaf_types);
+
+  // Recursive helper used to implement FlattenLike(). Checks that `handle`
+  // matches the subtree rooted at `*it`, advancing `it` past the subtree and
+  // storing its leaves in reverse order before `*next_leaf`.
+  bool MatchStructure(
+      nanobind::handle handle,
+      absl::InlinedVector<PyTreeDef::Node, 1>::const_reverse_iterator* it,
+      nanobind::object** next_leaf,
+      absl::InlinedVector<nanobind::object, 4>& leaf_types) const;
+
   template <typename T>
   nanobind::object UnflattenImpl(T leaves) const;
 
@@ -301,6 +356,47 @@ class PyTreeDef {
   absl::InlinedVector<Node, 1> traversal_;
 };
 
+// Caches the structure of recently flattened pytrees, keyed by a caller-chosen
+// position (e.g., the index of an argument) and the type of the root object.
+// Flattening a tree with the same structure as the cached tree only checks the
+// types, dict keys and auxiliary data of its nodes against the cached
+// PyTreeDef, instead of looking up every node in the registry and sorting dict
+// keys. Custom to_iterable functions may therefore be called twice for trees
+// whose structure differs from the cached tree.
+//
+// Thread-compatible; callers are expected to hold the GIL.
+class PyTreeFlattenCache {
+ public:
+  static constexpr int kDefaultCapacity = 64;
+  explicit PyTreeFlattenCache(int capacity = kDefaultCapacity)
+      : capacity_(capacity) {}
+
+  // Flattens `handle` into `leaves` and `treedef`, which must not contain any
+  // nodes yet. Equivalent to `treedef.Flatten(handle, leaves)`.
+  void Flatten(int position, nanobind::handle handle, PyTreeDef& treedef,
+               absl::InlinedVector<nanobind::object, 2>& leaves);
+
+  void Clear() { plans_.clear(); }
+
+  // Visits the Python objects referenced by the cached plans, for use in the
+  // tp_traverse implementation of the owner of the cache.
+  int Traverse(visitproc visit, void* arg) const;
+
+ private:
+  struct Plan {
+    // Holds a reference to the root type, which is part of the key.
+    nanobind::object root_type;
+    PyTreeRegistry* registry = nullptr;
+    uint64_t registry_version = 0;
+    std::unique_ptr<PyTreeDef> treedef;
+    // Types of leaves that aren't pytree nodes under `registry_version`.
+    absl::InlinedVector<nanobind::object, 4> leaf_types;
+  };
+
+  int capacity_;
+  absl::flat_hash_map<std::pair<int, PyObject*>, Plan> plans_;
+};
+
 template <typename H>
 H AbslHashValue(H h, const PyTreeDef::Node& n) {
   h = H::combine(std::move(h), n.kind, n.arity, n.custom);
@@ -69,6 +69,33 @@ class PyTreeTest(absltest.TestCase):
     o = object()
     self.roundtrip(({"a": o, "b": o}, [o, (o, o), None]))
 
+  def testSerializeDeserializeUsingFiles(self):
+    o = object()
+    example = [
+        {"a": o, "b": (o, None)},
+        [{"b": o, "c": {"a": o}} for _ in range(100)],
+    ]
+    original = registry.flatten(example)[1]
+    path = self.create_tempfile().full_path
+    original.serialize_using_proto_to_file(path)
+    self.assertEqual(
+        pytree.PyTreeDef.deserialize_using_proto_from_file(registry, path),
+        original,
+    )
+    # Files written in streaming mode are regular serialized protos, and vice
+    # versa.
+    with open(path, "rb") as f:
+      self.assertEqual(
+          pytree.PyTreeDef.deserialize_using_proto(registry, f.read()),
+          original,
+      )
+    with open(path, "wb") as f:
+      f.write(original.serialize_using_proto())
+    self.assertEqual(
+        pytree.PyTreeDef.deserialize_using_proto_from_file(registry, path),
+        original,
+    )
+
   def testSerializeWithFallback(self):
     o = object()
     with self.assertRaises(ValueError):
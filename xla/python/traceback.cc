@@ -18,6 +18,7 @@ limitations under the License.
 #include <Python.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -25,9 +26,13 @@ limitations under the License.
 #include <vector>
 
 #include "absl/base/casts.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/hash/hash.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "nanobind/nanobind.h"
 #include "nanobind/stl/optional.h"  // IWYU pragma: keep
 #include "nanobind/stl/string.h"  // IWYU pragma: keep
@@ -49,9 +54,110 @@ namespace nb = nanobind;
 
 bool Traceback::enabled_ = true;
 
+namespace {
+
+// Table of interned raw frames. Each entry counts the tracebacks that refer to
+// it, and holds a reference to its code object while that count is nonzero, so
+// that a code object's address can't be reused by another one while it is in
+// the table. Entries are removed once no traceback refers to them, and their
+// ids are reused by later frames.
+//
+// With the GIL, the table is protected by the GIL. Without it, the table is
+// protected by `mu`, which must not be held while running code that may
+// allocate Python objects or release references, since that may run the
+// garbage collector and destroy other tracebacks.
+struct FrameTable {
+  struct Entry {
+    PyCodeObject* code;
+    int lasti;
+    int64_t refs;
+  };
+  std::vector<Entry> frames;
+  std::vector<uint32_t> free_ids;
+  absl::flat_hash_map<std::pair<PyCodeObject*, int>, uint32_t> ids;
+#ifdef Py_GIL_DISABLED
+  absl::Mutex mu;
+#endif  // Py_GIL_DISABLED
+};
+
+FrameTable& GetFrameTable() {
+  static auto* const table = new FrameTable();
+  return *table;
+}
+
+// Locks the frame table if it isn't protected by the GIL.
+class FrameTableLock {
+ public:
+  explicit FrameTableLock(FrameTable& table)
+#ifdef Py_GIL_DISABLED
+      : lock_(&table.mu)
+#endif  // Py_GIL_DISABLED
+  {
+  }
+
+ private:
+#ifdef Py_GIL_DISABLED
+  absl::MutexLock lock_;
+#endif  // Py_GIL_DISABLED
+};
+
+using RawFrames = absl::InlinedVector<std::pair<PyCodeObject*, int>, 32>;
+
+// Requires the GIL. Appends the ids of `raw_frames` to `ids`, interning frames
+// that aren't in the table yet. The code objects of `raw_frames` must be alive.
+void InternFrames(const RawFrames& raw_frames,
+                  absl::InlinedVector<uint32_t, 32>& ids) {
+  FrameTable& table = GetFrameTable();
+  FrameTableLock lock(table);
+  ids.reserve(raw_frames.size());
+  for (const auto& [code, lasti] : raw_frames) {
+    uint32_t id = table.free_ids.empty() ? table.frames.size()
+                                         : table.free_ids.back();
+    auto [it, inserted] =
+        table.ids.try_emplace(std::make_pair(code, lasti), id);
+    if (inserted) {
+      Py_INCREF(code);
+      if (id == table.frames.size()) {
+        table.frames.push_back(FrameTable::Entry{code, lasti, 0});
+      } else {
+        table.free_ids.pop_back();
+        table.frames[id] = FrameTable::Entry{code, lasti, 0};
+      }
+    }
+    ++table.frames[it->second].refs;
+    ids.push_back(it->second);
+  }
+}
+
+// Requires the GIL. Drops the references of a traceback to the frames `ids`.
+void ReleaseFrames(absl::Span<const uint32_t> ids) {
+  FrameTable& table = GetFrameTable();
+  absl::InlinedVector<PyCodeObject*, 32> dead_code;
+  {
+    FrameTableLock lock(table);
+    for (uint32_t id : ids) {
+      FrameTable::Entry& entry = table.frames[id];
+      if (--entry.refs == 0) {
+        table.ids.erase(std::make_pair(entry.code, entry.lasti));
+        table.free_ids.push_back(id);
+        dead_code.push_back(entry.code);
+        entry.code = nullptr;
+      }
+    }
+  }
+  for (PyCodeObject* code : dead_code) {
+    Py_DECREF(code);
+  }
+}
+
+}  // namespace
+
 Traceback::Traceback() {
   DCHECK(PyGILState_Check());
   PyThreadState* thread_state = PyThreadState_GET();
+  // The frames are collected before interning them, since walking the stack
+  // may allocate frame objects.
+  RawFrames raw_frames;
 
 #if PY_VERSION_HEX < 0x030b0000
   // The representation of frame->f_lasti changed from bytes to words in Python
@@ -61,8 +167,8 @@ Traceback::Traceback() {
 
   for (PyFrameObject* py_frame = thread_state->frame; py_frame != nullptr;
        py_frame = py_frame->f_back) {
-    Py_INCREF(py_frame->f_code);
-    frames_.emplace_back(py_frame->f_code, py_frame->f_lasti * kLastiWordBytes);
+    raw_frames.emplace_back(py_frame->f_code,
+                            py_frame->f_lasti * kLastiWordBytes);
   }
 #else  // PY_VERSION_HEX < 0x030b0000
 
@@ -75,27 +181,30 @@ Traceback::Traceback() {
   for (_PyInterpreterFrame* f = thread_state->cframe->current_frame;
        f != nullptr; f = f->previous) {
     if (_PyFrame_IsIncomplete(f)) continue;
-    Py_INCREF(f->f_code);
-    frames_.emplace_back(f->f_code,
-                         _PyInterpreterFrame_LASTI(f) * sizeof(_Py_CODEUNIT));
+    raw_frames.emplace_back(
+        f->f_code, _PyInterpreterFrame_LASTI(f) * sizeof(_Py_CODEUNIT));
   }
 #else   // PLATFORM_GOOGLE
   PyFrameObject* next;
   for (PyFrameObject* py_frame = PyThreadState_GetFrame(thread_state);
        py_frame != nullptr; py_frame = next) {
-    frames_.emplace_back(PyFrame_GetCode(py_frame), PyFrame_GetLasti(py_frame));
+    // The code object stays alive while its frame is on the stack.
+    PyCodeObject* code = PyFrame_GetCode(py_frame);
+    raw_frames.emplace_back(code, PyFrame_GetLasti(py_frame));
+    Py_DECREF(code);
     next = PyFrame_GetBack(py_frame);
     Py_XDECREF(py_frame);
   }
 #endif  // PLATFORM_GOOGLE
 
 #endif  // PY_VERSION_HEX < 0x030b0000
+  InternFrames(raw_frames, frames_);
 }
 
 Traceback::~Traceback() {
-  for (auto& frame : frames_) {
+  if (!frames_.empty()) {
     DCHECK(PyGILState_Check());
-    Py_DECREF(frame.first);
+    ReleaseFrames(frames_);
   }
 }
 
@@ -107,6 +216,19 @@ Traceback::Traceback(Traceback&& other) noexcept
   other.frames_.clear();
 }
 
+absl::InlinedVector<std::pair<PyCodeObject*, int>, 32> Traceback::raw_frames()
+    const {
+  FrameTable& table = GetFrameTable();
+  FrameTableLock lock(table);
+  RawFrames frames;
+  frames.reserve(frames_.size());
+  for (uint32_t id : frames_) {
+    const FrameTable::Entry& entry = table.frames[id];
+    frames.emplace_back(entry.code, entry.lasti);
+  }
+  return frames;
+}
+
 std::string Traceback::Frame::ToString() const {
   return absl::StrFormat("%s:%d (%s)", nb::cast<std::string_view>(file_name),
                          line_num, nb::cast<std::string_view>(function_name));
@@ -126,7 +248,7 @@ std::vector<Traceback::Frame> Traceback::Frames() const {
   CHECK(PyGILState_Check());
   std::vector<Traceback::Frame> frames;
   frames.reserve(frames_.size());
-  for (const auto& frame : frames_) {
+  for (const auto& frame : raw_frames()) {
     frames.push_back(Frame{nb::borrow<nb::str>(frame.first->co_filename),
                            nb::borrow<nb::str>(frame.first->co_name),
                            frame.first->co_firstlineno,
@@ -149,7 +271,7 @@ nb::object Traceback::AsPythonTraceback() const {
   nb::object traceback = nb::none();
   nb::dict globals;
   nb::handle traceback_type(reinterpret_cast<PyObject*>(&PyTraceBack_Type));
-  for (const std::pair<PyCodeObject*, int>& frame : frames_) {
+  for (const auto& frame : raw_frames()) {
     int lineno = PyCode_Addr2Line(frame.first, frame.second);
     // Under Python 3.11 we observed crashes when using a fake PyFrameObject
     // with a real PyCodeObject (https://github.com/google/jax/issues/16027).
@@ -257,11 +379,11 @@ void BuildTracebackSubmodule(nb::module_& m) {
     // We return a tuple of lists, rather than a list of tuples, because it
     // is cheaper to allocate only three Python objects for everything rather
     // than one per frame.
-    nb::list out_code = nb::steal<nb::list>(PyList_New(tb.raw_frames().size()));
-    nb::list out_lasti =
-        nb::steal<nb::list>(PyList_New(tb.raw_frames().size()));
-    for (size_t i = 0; i < tb.raw_frames().size(); ++i) {
-      const auto& frame = tb.raw_frames()[i];
+    auto raw_frames = tb.raw_frames();
+    nb::list out_code = nb::steal<nb::list>(PyList_New(raw_frames.size()));
+    nb::list out_lasti = nb::steal<nb::list>(PyList_New(raw_frames.size()));
+    for (size_t i = 0; i < raw_frames.size(); ++i) {
+      const auto& frame = raw_frames[i];
       PyObject* code = reinterpret_cast<PyObject*>(frame.first);
       Py_INCREF(code);
       PyList_SET_ITEM(out_code.ptr(), i, code);
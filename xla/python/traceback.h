@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef XLA_PYTHON_TRACEBACK_H_
 #define XLA_PYTHON_TRACEBACK_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -65,8 +66,16 @@ class Traceback {
   };
   std::vector<Frame> Frames() const;
 
-  const absl::InlinedVector<std::pair<PyCodeObject*, int>, 32>& raw_frames()
-      const {
+  // Each raw frame is a pair of a code object and a "lasti" instruction
+  // location in bytes. The size of _Py_CODEUNIT has changed across different
+  // Python versions; the lasti value here has already been multiplied by
+  // sizeof(_Py_CODEUNIT) if needed and is suitable for passing to functions
+  // like PyCode_Addr2Line(). Requires the GIL.
+  absl::InlinedVector<std::pair<PyCodeObject*, int>, 32> raw_frames() const;
+
+  // Identifiers of the interned raw frames of the traceback. Two tracebacks
+  // have the same raw frames iff they have the same frame ids.
+  const absl::InlinedVector<uint32_t, 32>& frame_ids() const {
     return frames_;
   }
 
@@ -82,12 +91,11 @@ class Traceback {
   }
 
  private:
-  // Each frame is a pair of a code object and a "lasti" instruction location
-  // in bytes. The size of _Py_CODEUNIT has changed across different Python
-  // versions; the lasti value here has already been multiplied by
-  // sizeof(_Py_CODEUNIT) if needed and is suitable for passing to functions
-  // like PyCode_Addr2Line().
-  absl::InlinedVector<std::pair<PyCodeObject*, int>, 32> frames_;
+  // Raw frames are interned in a global table, which holds a reference to
+  // their code objects while tracebacks refer to them, so that copying a frame
+  // into a traceback doesn't touch Python reference counts, and doesn't
+  // allocate for tracebacks of up to 32 frames.
+  absl::InlinedVector<uint32_t, 32> frames_;
 
   // Protected by GIL.
   static bool enabled_;
@@ -97,7 +105,7 @@ using nb_traceback = nb_class_ptr<Traceback>;
 
 template <typename H>
 H AbslHashValue(H h, const Traceback& traceback) {
-  h = H::combine(std::move(h), traceback.raw_frames());
+  h = H::combine(std::move(h), traceback.frame_ids());
   return h;
 }
 
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/python/weakref_lru_cache.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
@@ -102,6 +103,17 @@ struct HashableKey {
 
 }  // namespace
 
+// Number of independently locked shards of a WeakrefLRUCache. Shards are
+// selected by the hash of the weakref key, and each shard has its own LRU list
+// of capacity `maxsize / kNumShards`. With the GIL, lookups are serialized
+// anyway, so we use a single shard to keep the eviction order of an unsharded
+// cache.
+#ifdef Py_GIL_DISABLED
+constexpr int kNumShards = 16;
+#else
+constexpr int kNumShards = 1;
+#endif
+
 class WeakrefLRUCache : public std::enable_shared_from_this<WeakrefLRUCache> {
  public:
   class Key {
@@ -113,8 +125,14 @@ class WeakrefLRUCache : public std::enable_shared_from_this<WeakrefLRUCache> {
           cached_hash_(absl::HashOf(HashableKey{context_, args_, kwargs_})) {}
 
     bool operator==(const Key& other) const {
-      return context_.equal(other.context_) && args_.equal(other.args_) &&
-             kwargs_.equal(other.kwargs_);
+      // Keys with different hashes are never equal. Comparing the precomputed
+      // hashes first avoids calling Python __eq__ methods for keys that merely
+      // share a bucket.
+      if (cached_hash_ != other.cached_hash_) {
+        return false;
+      }
+      return (context_.is(other.context_) || context_.equal(other.context_)) &&
+             args_.equal(other.args_) && kwargs_.equal(other.kwargs_);
     }
 
     template <typename H>
@@ -169,14 +187,70 @@ class WeakrefLRUCache : public std::enable_shared_from_this<WeakrefLRUCache> {
     }
   };
 
+  // The lock order is shard mutex, then GIL: the GIL must be released before
+  // acquiring `mu`, since Python hash and equality functions called with `mu`
+  // held may release the GIL.
+  struct Shard {
+    explicit Shard(int capacity) : lru_list(capacity) {}
+
+    absl::Mutex mu;
+    Cache::LRUList lru_list ABSL_GUARDED_BY(mu);
+    std::unordered_map<WeakrefCacheKey, WeakrefCacheValue, WeakrefKeyHash,
+                       WeakrefKeyEq>
+        entries ABSL_GUARDED_BY(mu);
+
+    // Keys of entries whose weakref died while `mu` was held, to be erased
+    // by the next thread that acquires `mu`. Never held while calling into
+    // Python.
+    absl::Mutex dead_keys_mu ABSL_ACQUIRED_AFTER(mu);
+    std::vector<WeakrefCacheKey> dead_keys ABSL_GUARDED_BY(dead_keys_mu);
+  };
+
   WeakrefLRUCache(nb::callable cache_context_fn, nb::callable fn,
                   int64_t maxsize)
-      : cache_context_fn_(cache_context_fn), fn_(fn), lru_list_(maxsize) {}
+      : cache_context_fn_(cache_context_fn), fn_(fn), maxsize_(maxsize) {
+    int shard_capacity = (maxsize + kNumShards - 1) / kNumShards;
+    shards_.reserve(kNumShards);
+    for (int i = 0; i < kNumShards; ++i) {
+      shards_.push_back(std::make_unique<Shard>(shard_capacity));
+    }
+  }
 
-  std::shared_ptr<Cache> GetCache(WeakrefCacheKey key) {
-    WeakrefCacheValue& value = entries_[key];
+  Shard& ShardFor(size_t wrcache_hash) {
+    return *shards_[wrcache_hash % kNumShards];
+  }
+
+  static void LockShard(Shard& shard) ABSL_EXCLUSIVE_LOCK_FUNCTION(shard.mu) {
+    nb::gil_scoped_release release;
+    shard.mu.Lock();
+  }
+
+  // Erases the entries of weakrefs that died while another thread held the
+  // shard's mutex.
+  static void EraseDeadEntries(Shard& shard)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    std::vector<WeakrefCacheKey> dead_keys;
+    {
+      absl::MutexLock lock(&shard.dead_keys_mu);
+      dead_keys.swap(shard.dead_keys);
+    }
+    for (const WeakrefCacheKey& key : dead_keys) {
+      // Dead weakrefs compare by identity, so this lookup doesn't call into
+      // Python.
+      auto it = shard.entries.find(key);
+      if (it != shard.entries.end()) {
+        // Create temp-var to avoid re-entrant erase.
+        auto tmp = std::move(it->second);
+        shard.entries.erase(it);
+      }
+    }
+  }
+
+  static std::shared_ptr<Cache> GetCache(Shard& shard, WeakrefCacheKey key)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    WeakrefCacheValue& value = shard.entries[key];
     if (!value.cache) {
-      value.cache = std::make_shared<Cache>(&lru_list_);
+      value.cache = std::make_shared<Cache>(&shard.lru_list);
     }
     return value.cache;
   }
@@ -190,13 +264,15 @@ class WeakrefLRUCache : public std::enable_shared_from_this<WeakrefLRUCache> {
     // least, MSVC's std::unordered_map has undefined behavior if the hash
     // function throws an exception
     // (https://learn.microsoft.com/en-us/cpp/standard-library/unordered-map-class?view=msvc-170#emplace).
+    // This also keeps Python hash functions outside of the shard lock.
     Key key(context, args, kwargs);
     size_t wrcache_hash = static_cast<size_t>(nb::hash(weakref_key));
 
     // No hash computations after this point.
 
     auto weakref_gc_callback = nb::cpp_function(
-        [this_weak = weak_from_this(), wrcache_hash](nb::handle weakref) {
+        [this_weak = weak_from_this(),
+         wrcache_hash](nb::handle weakref) ABSL_NO_THREAD_SAFETY_ANALYSIS {
           auto cache = this_weak.lock();
           if (cache == nullptr) {
             return;
@@ -205,45 +281,54 @@ class WeakrefLRUCache : public std::enable_shared_from_this<WeakrefLRUCache> {
           // destroyed, so we cannot refer to its contents. Python weakref
           // objects compare based on identity if the object they refer to is
           // gone, so the hash lookup will work fine.
-          auto it = cache->entries_.find(
-              WeakrefCacheKey{nb::borrow<nb::weakref>(weakref), wrcache_hash});
-          if (it == cache->entries_.end()) {
+          WeakrefCacheKey key{nb::borrow<nb::weakref>(weakref), wrcache_hash};
+          Shard& shard = cache->ShardFor(wrcache_hash);
+          // The callback may run while this or another thread holds the
+          // shard's mutex, e.g. from a garbage collection triggered by a
+          // Python __eq__ method. Blocking could deadlock, so we leave the
+          // erasure to the holder of the mutex instead.
+          if (!shard.mu.TryLock()) {
+            absl::MutexLock lock(&shard.dead_keys_mu);
+            shard.dead_keys.push_back(std::move(key));
+            return;
+          }
+          absl::Cleanup unlock = [&shard]() { shard.mu.Unlock(); };
+          auto it = shard.entries.find(key);
+          if (it == shard.entries.end()) {
             return;
           }
           // Create temp-var to avoid re-entrant erase.
           auto tmp = std::move(it->second);
-          cache->entries_.erase(it);
+          shard.entries.erase(it);
         });
     nb::weakref weakref = nb::weakref(weakref_key, weakref_gc_callback);
     WeakrefCacheKey wrcache_key{weakref, wrcache_hash};
-    std::shared_ptr<Cache> cache_ptr = GetCache(wrcache_key);
-    Cache& cache = *cache_ptr;
-    ++total_queries_;
+    Shard& shard = ShardFor(wrcache_hash);
+    total_queries_.fetch_add(1, std::memory_order_relaxed);
 
     bool inserted = false;
+    std::shared_ptr<Cache> cache_ptr;
     std::shared_ptr<CacheEntry> entry;
+    // Because the gil can be released during cache insertion, this forces
+    // the lock order to be mu then gil so we must release the gil first.
+    // The mutex avoids problems where the gil is released during cache
+    // insertion and then a second thread invalidates the cache order.
+    LockShard(shard);
     {
-      // Because the gil can be released during cache insertion, this forces
-      // the lock order to be mu_ then gil so we must release the gil first.
-      nb::gil_scoped_release release;
-      // Acquire a mutex to avoid problems where the gil is released during
-      // cache insertion and then a second thread invalidates the cache order.
-      mu_.Lock();
-    }
-    {
-      // GetOrCreateIfAbsent calls into Python hash and equality functions,
-      // which may throw exceptions. The use of absl::Cleanup ensures mu_ is
+      // GetOrCreateIfAbsent calls into Python equality functions, which may
+      // throw exceptions. The use of absl::Cleanup ensures the mutex is
       // released if that happens.
-      absl::Cleanup unlock = [this]()
-                                 ABSL_UNLOCK_FUNCTION(mu_) { mu_.Unlock(); };
-      entry = cache.GetOrCreateIfAbsent(key, [&inserted](const Key& key) {
+      absl::Cleanup unlock = [&shard]() { shard.mu.Unlock(); };
+      EraseDeadEntries(shard);
+      cache_ptr = GetCache(shard, wrcache_key);
+      entry = cache_ptr->GetOrCreateIfAbsent(key, [&inserted](const Key& key) {
         inserted = true;
         return std::make_shared<CacheEntry>();
       });
     }
     if (!entry->completed.HasBeenNotified()) {
       if (inserted) {
-        ++misses_;
+        misses_.fetch_add(1, std::memory_order_relaxed);
         absl::Cleanup notify = [&] { entry->completed.Notify(); };
         entry->result = fn_(weakref_key, *args, **kwargs);
         entry->has_result = true;
@@ -264,52 +349,65 @@ class WeakrefLRUCache : public std::enable_shared_from_this<WeakrefLRUCache> {
     if (entry->has_result) {
       return entry->result;
     } else {
-      ++misses_;
+      misses_.fetch_add(1, std::memory_order_relaxed);
       return fn_(weakref_key, *args, **kwargs);
     }
   }
-  std::vector<nb::object> GetKeys() {
+  std::vector<nb::object> GetKeys() ABSL_NO_THREAD_SAFETY_ANALYSIS {
     std::vector<nb::object> results;
-    mu_.Lock();
-    for (const auto& wr_entry : entries_) {
-      for (const auto& rest : *wr_entry.second.cache) {
-        nb::tuple result =
-            nb::make_tuple(*wr_entry.first.ref, rest.first.context(),
-                           rest.first.args(), rest.first.kwargs());
-        results.push_back(std::move(result));
+    for (auto& shard : shards_) {
+      LockShard(*shard);
+      absl::Cleanup unlock = [&shard]() { shard->mu.Unlock(); };
+      EraseDeadEntries(*shard);
+      for (const auto& wr_entry : shard->entries) {
+        for (const auto& rest : *wr_entry.second.cache) {
+          nb::tuple result =
+              nb::make_tuple(*wr_entry.first.ref, rest.first.context(),
+                             rest.first.args(), rest.first.kwargs());
+          results.push_back(std::move(result));
+        }
       }
     }
-    mu_.Unlock();
     return results;
   }
-  CacheInfo GetCacheInfo() const {
+  CacheInfo GetCacheInfo() ABSL_NO_THREAD_SAFETY_ANALYSIS {
     CacheInfo result;
-    result.hits = total_queries_ - misses_;
-    result.misses = misses_;
-    result.maxsize = lru_list_.Capacity();
-    result.currsize = lru_list_.Size();
+    result.misses = misses_.load(std::memory_order_relaxed);
+    result.hits =
+        total_queries_.load(std::memory_order_relaxed) - result.misses;
+    result.maxsize = maxsize_;
+    result.currsize = 0;
+    for (auto& shard : shards_) {
+      LockShard(*shard);
+      absl::Cleanup unlock = [&shard]() { shard->mu.Unlock(); };
+      EraseDeadEntries(*shard);
+      result.currsize += shard->lru_list.Size();
+    }
     return result;
   }
-  void Clear() {
-    total_queries_ = misses_ = 0;
-    std::vector<std::shared_ptr<Cache>> deferred_deletes;
-    deferred_deletes.reserve(entries_.size());
-    for (auto& entry : entries_) {
-      deferred_deletes.push_back(std::move(entry.second.cache));
+  void Clear() ABSL_NO_THREAD_SAFETY_ANALYSIS {
+    total_queries_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+    for (auto& shard : shards_) {
+      LockShard(*shard);
+      absl::Cleanup unlock = [&shard]() { shard->mu.Unlock(); };
+      EraseDeadEntries(*shard);
+      std::vector<std::shared_ptr<Cache>> deferred_deletes;
+      deferred_deletes.reserve(shard->entries.size());
+      for (auto& entry : shard->entries) {
+        deferred_deletes.push_back(std::move(entry.second.cache));
+      }
+      shard->entries.clear();
+      deferred_deletes.clear();
     }
-    entries_.clear();
-    deferred_deletes.clear();
   }
 
   nb::callable cache_context_fn_;
   nb::callable fn_;
-  Cache::LRUList lru_list_;
-  std::unordered_map<WeakrefCacheKey, WeakrefCacheValue, WeakrefKeyHash,
-                     WeakrefKeyEq>
-      entries_;
-  int64_t misses_ = 0;
-  int64_t total_queries_ = 0;
-  absl::Mutex mu_;
+  const int64_t maxsize_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<int64_t> misses_ = 0;
+  std::atomic<int64_t> total_queries_ = 0;
 };
 
 void BuildWeakrefLRUCacheAPI(nb::module_& m) {
@@ -75,6 +75,37 @@ class WeakrefLRUCacheTest(absltest.TestCase):
       cache(wrkey, GilReleasingCacheKey())
     t.join()
 
+  def testManyThreads(self):
+    class WRKey:
+      pass
+
+    num_calls = 0
+
+    def CacheFn(obj, arg):
+      del obj
+      nonlocal num_calls
+      num_calls += 1
+      return arg
+
+    cache = xla_client.weakref_lru_cache(lambda: None, CacheFn, 2048)
+    wrkeys = [WRKey() for _ in range(8)]
+
+    def Body(wrkey):
+      for i in range(100):
+        self.assertEqual(cache(wrkey, i % 10), i % 10)
+
+    threads = [threading.Thread(target=Body, args=(k,)) for k in wrkeys]
+    for t in threads:
+      t.start()
+    for t in threads:
+      t.join()
+
+    info = cache.cache_info()
+    self.assertEqual(info.hits + info.misses, 800)
+    self.assertEqual(info.currsize, 80)
+    self.assertEqual(num_calls, 80)
+    self.assertLen(cache.cache_keys(), 80)
+
   def testKwargsDictOrder(self):
     miss_id = 0
 
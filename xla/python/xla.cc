@@ -520,6 +520,14 @@ NB_MODULE(xla_extension, m_nb) {
       .def("execute_sharded",
            xla::ValueOrThrowWrapper(&PyLoadedExecutable::ExecuteSharded),
            nb::arg("arguments"), nb::arg("with_tokens") = false)
+      .def(
+          "execute_sharded_into",
+          [](PyLoadedExecutable& self, std::vector<ExecuteShardedArg> args,
+             std::vector<PyArray> outputs) {
+            xla::ThrowIfError(
+                self.ExecuteShardedInto(std::move(args), std::move(outputs)));
+          },
+          nb::arg("arguments"), nb::arg("outputs"))
       .def("hlo_modules", ValueOrThrowWrapper(&PyLoadedExecutable::HloModules))
       .def("get_output_memory_kinds",
            xla::ValueOrThrowWrapper(&PyLoadedExecutable::GetOutputMemoryKinds))
@@ -912,6 +920,10 @@ NB_MODULE(xla_extension, m_nb) {
     ThrowIfError(PyArray::BatchedBlockUntilReady(std::move(xs)));
   });
 
+  m_nb.def("batched_delete", [](std::vector<nb::object> xs) {
+    ThrowIfError(PyArray::BatchedDelete(std::move(xs)));
+  });
+
   m_nb.def("check_and_canonicalize_memory_kind",
            &jax::CheckAndCanonicalizeMemoryKind, nb::arg("memory_kind").none(),
            nb::arg("device_list"));
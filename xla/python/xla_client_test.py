@@ -16,12 +16,14 @@
 
 import collections
 import functools
+import gc
 import itertools
 import re
 import threading
 import traceback
 from typing import Sequence
 import unittest
+import weakref
 
 from absl import flags
 from absl import logging
@@ -1153,6 +1155,18 @@ module @jit__lambda_ attributes {mhlo.num_partitions = 1 : i32,
               "BlockHostUntilReady() called on deleted or donated buffer")):
         buffer.block_until_ready()
 
+    def testBatchedDelete(self):
+      buffers = [
+          self.backend.buffer_from_pyval(np.array([i, i + 1], np.float32))
+          for i in range(4)
+      ]
+      xla_client._xla.batched_delete(buffers[1:])
+      self.assertFalse(buffers[0].is_deleted())
+      for buffer in buffers[1:]:
+        self.assertTrue(buffer.is_deleted())
+      np.testing.assert_array_equal(
+          np.asarray(buffers[0]), np.array([0, 1], np.float32))
+
     @unittest.skipIf(pathways_ifrt, "not implemented")
     def testOnDeviceSizeInBytes(self):
       if not isinstance(self.backend, xla_client.Client):
@@ -1231,6 +1245,39 @@ module @jit__lambda_ attributes {mhlo.num_partitions = 1 : i32,
         arr = np.asarray(arr)
         self.assertEqual(dtype, type(arr[0]))
 
+    def _BatchedDevicePutArgs(self, shards):
+      devices = self.backend.local_devices()[:len(shards)]
+      aval = collections.namedtuple("Aval", ["shape", "dtype", "weak_type"])(
+          (2 * len(devices),), np.dtype(np.float32), False)
+      sharding = xla_client.GSPMDSharding(
+          devices,
+          xla_client.HloSharding.from_string(
+              "{devices=[%d]%s}"
+              % (len(devices), ",".join(str(i) for i in range(len(devices))))
+          ),
+      )
+      return aval, sharding, devices
+
+    def testBatchedDevicePut(self):
+      n = len(self.backend.local_devices())
+      shards = [np.full((2,), i, np.float32) for i in range(n)]
+      aval, sharding, devices = self._BatchedDevicePutArgs(shards)
+      # Shards are transferred in parallel without the GIL, and zero-copy
+      # transfers keep references to the numpy arrays.
+      for _ in range(10):
+        arr = xla_client.batched_device_put(aval, sharding, shards, devices)
+        for i, shard in enumerate(arr._arrays):
+          np.testing.assert_equal(np.asarray(shard), shards[i])
+
+    def testBatchedDevicePutError(self):
+      n = len(self.backend.local_devices())
+      shards = [np.full((2,), i, np.float32) for i in range(n)]
+      aval, sharding, devices = self._BatchedDevicePutArgs(shards)
+      shards[-1] = object()
+      for _ in range(10):
+        with self.assertRaises(Exception):
+          xla_client.batched_device_put(aval, sharding, shards, devices)
+
     @unittest.skipIf(pathways_ifrt, "not implemented")
     def testUnsafeBufferPointer(self):
       if not isinstance(self.backend, xla_client.Client):
@@ -3014,9 +3061,6 @@ module @jit__lambda_ attributes {mhlo.num_partitions = 1 : i32,
       if self.backend.platform != "cpu":
         self.skipTest("Test requires CPU")
 
-      if transpose and use_legacy_api:
-        self.skipTest("Non-default layout is not supported in legacy API")
-
       # Create a numpy array that is not aligned to XLA requirements. XLA's
       # alignment requirements differ for different hardware, so we use the
       # smallest possible value. If we make sure the buffer is not aligned to
@@ -3053,6 +3097,26 @@ module @jit__lambda_ attributes {mhlo.num_partitions = 1 : i32,
       )
       np.testing.assert_array_equal(y, x)
 
+    @parameterized.parameters(False, True)
+    def testNonCompactDlpackTensor(self, use_legacy_api):
+      x = np.array(np.random.rand(3, 8, 5), dtype=np.float32)
+      # A strided slice, whose striding doesn't describe a layout.
+      x = x[:, ::2, 1:]
+
+      dlpack_tensor = x.__dlpack__()
+      buffer = self._DLPackManagedTensorToBuffer(dlpack_tensor, use_legacy_api)
+      np.testing.assert_array_equal(np.asarray(buffer), x)
+
+    def testLegacyApiRelayoutsTransposedDlpackTensor(self):
+      x = np.array(np.random.rand(3, 4, 5), dtype=np.float32)
+      x = x.transpose((2, 0, 1))
+
+      dlpack_tensor = x.__dlpack__()
+      buffer = self._DLPackManagedTensorToBuffer(
+          dlpack_tensor, use_legacy_api=True
+      )
+      np.testing.assert_array_equal(np.asarray(buffer), x)
+
   tests.append(DLPackTest)
 
   class BufferProtocolTest(parameterized.TestCase):
@@ -3162,6 +3226,38 @@ module @jit__lambda_ attributes {mhlo.num_partitions = 1 : i32,
         self.assertEqual(frames[i - 1].function_name, "AnotherFunction")
         self.assertEqual(frames[i + 1].function_name, "testNestedFunction")
 
+    def testTracebacksOfTheSameFramesAreEqual(self):
+      def F():
+        return xla_client.Traceback.get_traceback()
+
+      with xla_client.tracebacks(enabled=True):
+        tbs = [F() for _ in range(2)]
+        other = xla_client.Traceback.get_traceback()
+        self.assertEqual(tbs[0], tbs[1])
+        self.assertEqual(hash(tbs[0]), hash(tbs[1]))
+        self.assertNotEqual(tbs[0], other)
+        # Frames that are no longer referenced by any traceback are dropped,
+        # and their ids may be reused by other frames.
+        del tbs[1], other
+        others = [xla_client.Traceback.get_traceback() for _ in range(2)]
+        self.assertEqual(others[0], others[1])
+        self.assertNotEqual(tbs[0], others[0])
+        self.assertEqual(tbs[0].frames[0].function_name, "F")
+
+    def testTracebackKeepsCodeAliveOnlyWhileAlive(self):
+      namespace = {"get_traceback": xla_client.Traceback.get_traceback}
+      exec("def F():\n  return get_traceback()\n", namespace)
+      code = weakref.ref(namespace["F"].__code__)
+      with xla_client.tracebacks(enabled=True):
+        tb = namespace["F"]()
+      del namespace
+      gc.collect()
+      self.assertIsNotNone(code())
+      self.assertEqual(tb.frames[0].function_name, "F")
+      del tb
+      gc.collect()
+      self.assertIsNone(code())
+
     def testPythonTracebackHasCorrectLineNumbers(self):
       def B():
         return xla_client.Traceback.get_traceback()
@@ -3601,6 +3697,42 @@ module @jit__lambda_ attributes {mhlo.num_partitions = 1 : i32,
       results[0][0].block_until_ready()
       self.assertIsInstance(results[0][0], xla_client.ArrayImpl)
 
+    def testExecuteShardedIntoPreallocatedOutputs(self):
+      arg = np.arange(12, dtype=np.int16).reshape(3, 4)
+      c = self._NewComputation()
+      ops.Add(
+          ops.Parameter(c, 0, xla_client.shape_from_pyval(arg)),
+          ops.Constant(c, np.int16(1)))
+
+      options = xla_client.CompileOptions()
+      options.num_replicas = 1
+      compiled_c = self.backend.compile(
+          xla_computation_to_mlir_module(c.build()), compile_options=options)
+
+      ping = self.backend.buffer_from_pyval(arg)
+      pong = self.backend.buffer_from_pyval(np.zeros_like(arg))
+      for i in range(1, 5):
+        compiled_c.execute_sharded_into([[ping]], [pong])
+        np.testing.assert_equal(np.asarray(pong), arg + 2 * i - 1)
+        compiled_c.execute_sharded_into([[pong]], [ping])
+        np.testing.assert_equal(np.asarray(ping), arg + 2 * i)
+
+      # Invalid outputs are rejected before any buffer is deleted.
+      wrong_shape = self.backend.buffer_from_pyval(np.zeros(3, np.int16))
+      with self.assertRaises(xla_client.XlaRuntimeError):
+        compiled_c.execute_sharded_into([[ping]], [wrong_shape])
+      np.testing.assert_equal(np.asarray(wrong_shape), np.zeros(3, np.int16))
+      wrong_dtype = self.backend.buffer_from_pyval(np.zeros_like(arg, np.int32))
+      with self.assertRaises(xla_client.XlaRuntimeError):
+        compiled_c.execute_sharded_into([[ping]], [wrong_dtype])
+      np.testing.assert_equal(
+          np.asarray(wrong_dtype), np.zeros_like(arg, np.int32))
+      with self.assertRaises(xla_client.XlaRuntimeError):
+        compiled_c.execute_sharded_into([[ping]], [pong, pong])
+      np.testing.assert_equal(np.asarray(pong), arg + 7)
+      with self.assertRaises(xla_client.XlaRuntimeError):
+        compiled_c.execute_sharded_into([[ping]], [])
+
   tests.append(ExecuteShardedOverloadTest)
 
   return tests
@@ -642,6 +642,7 @@ def batched_copy_array_to_devices_with_sharding(
 ) -> Sequence[ArrayImpl]: ...
 
 def batched_block_until_ready(x: Sequence[ArrayImpl]) -> None: ...
+def batched_delete(x: Sequence[ArrayImpl]) -> None: ...
 
 def batched_device_put(
     aval: Any,
@@ -691,6 +692,11 @@ class LoadedExecutable:
   def execute_sharded(
       self, arguments: Sequence[List[ArrayImpl]], with_tokens: bool = ...
   ) -> ExecuteResults: ...
+  def execute_sharded_into(
+      self,
+      arguments: Sequence[List[ArrayImpl]],
+      outputs: Sequence[ArrayImpl],
+  ) -> None: ...
   def hlo_modules(self) -> List[HloModule]: ...
   def get_output_memory_kinds(self) -> List[List[str]]: ...
   def get_compiled_memory_stats(self) -> CompiledMemoryStats: ...
@@ -916,6 +922,7 @@ class GSPMDSharding(Sharding):
 
 class PjitFunction:
   def __call__(self, *args, **kwargs) -> Any: ...
+  _frozen: bool
 
 class PjitFunctionCache:
   def __init__(self, capacity: int = ...): ...
@@ -24,6 +24,7 @@ Client = xla_extension.Client
 class ClientConnectionOptions:
   on_disconnect: Optional[Callable[[_Status], None]] = None
   on_connection_update: Optional[Callable[[str], None]] = None
+  use_shared_memory_for_host_buffers: bool = False
 
 
 def get_client(
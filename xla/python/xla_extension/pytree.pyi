@@ -82,6 +82,12 @@ class PyTreeDef:
       registry: PyTreeRegistry, data: bytes
   ) -> PyTreeDef:
     ...
+  def serialize_using_proto_to_file(self, path: str) -> None: ...
+  @staticmethod
+  def deserialize_using_proto_from_file(
+      registry: PyTreeRegistry, path: str
+  ) -> PyTreeDef:
+    ...
 
 _Children = TypeVar("_Children", bound=Iterable[Any])
 _AuxData = TypeVar("_AuxData", bound=Hashable)
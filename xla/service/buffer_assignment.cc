@@ -1396,13 +1396,42 @@ bool BufferAssigner::MaybeAssignBuffer(BufferAllocation* allocation,
     return false;
   }
 
+  // With a total order live ranges are intervals in the schedule. Look up the
+  // live ranges of the new values once and skip the pairs with disjoint
+  // intervals without running the full interference check.
+  const bool total_order_scheduled =
+      assignment->hlo_live_range().total_order_scheduled();
+  const auto& buffer_live_ranges =
+      assignment->hlo_live_range().buffer_live_ranges();
+  auto find_live_range =
+      [&](const HloValue* value) -> const HloLiveRange::TimeBound* {
+    auto it = buffer_live_ranges.find(value);
+    return it == buffer_live_ranges.end() ? nullptr : &it->second;
+  };
+  std::vector<const HloLiveRange::TimeBound*> new_live_ranges;
+  if (total_order_scheduled) {
+    new_live_ranges.reserve(hlo_buffer.values().size());
+    for (const HloValue* new_value : hlo_buffer.values()) {
+      new_live_ranges.push_back(find_live_range(new_value));
+    }
+  }
+
   for (const auto& buffer_offset_size : allocation->assigned_buffers()) {
     // Pairwise compare.
     const HloValue& assigned_buffer =
         *CHECK_NOTNULL(dynamic_cast<const HloValue*>(buffer_offset_size.first));
-    for (const HloValue* new_value : hlo_buffer.values()) {
-      if (assignment->hlo_live_range().total_order_scheduled()) {
-        if (LiveRangeInterferes(new_value, &assigned_buffer, assignment)) {
+    const HloLiveRange::TimeBound* assigned_live_range =
+        total_order_scheduled ? find_live_range(&assigned_buffer) : nullptr;
+    for (int64_t i = 0; i < hlo_buffer.values().size(); ++i) {
+      const HloValue* new_value = hlo_buffer.values()[i];
+      if (total_order_scheduled) {
+        const HloLiveRange::TimeBound* new_live_range = new_live_ranges[i];
+        bool disjoint = assigned_live_range != nullptr &&
+                        new_live_range != nullptr &&
+                        (assigned_live_range->start > new_live_range->end ||
+                         new_live_range->start > assigned_live_range->end);
+        if (!disjoint &&
+            LiveRangeInterferes(new_value, &assigned_buffer, assignment)) {
           VLOG(4) << "Can't assign: assignee " << assigned_buffer
                   << " live range interferes with "
                   << new_value->ToShortString();
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -58,6 +59,7 @@ limitations under the License.
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/status.h"
+#include "tsl/platform/test_benchmark.h"
 #include "tsl/platform/statusor.h"
 
 namespace xla {
@@ -3487,5 +3489,51 @@ ENTRY entry_computation {
   EXPECT_EQ(dus9_alloc_slice.allocation(), dus5_alloc_slice.allocation());
   EXPECT_EQ(dus9_alloc_slice, dus5_alloc_slice);
 }
+
+// Builds a chain of `n` negates whose results are all live out, so every new
+// buffer is checked for interference against all existing allocations.
+std::unique_ptr<HloModule> MakeManyLiveOutValuesModule(int64_t n) {
+  auto module = std::make_unique<HloModule>("many_live_out_values",
+                                            HloModuleConfig());
+  const Shape shape = ShapeUtil::MakeShape(F32, {16});
+  auto builder = HloComputation::Builder("entry");
+  HloInstruction* value = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape, "p"));
+  std::vector<HloInstruction*> outputs;
+  for (int64_t i = 0; i < n; ++i) {
+    value = builder.AddInstruction(
+        HloInstruction::CreateUnary(shape, HloOpcode::kNegate, value));
+    outputs.push_back(value);
+  }
+  builder.AddInstruction(HloInstruction::CreateTuple(outputs));
+  HloComputation* entry = module->AddEntryComputation(builder.Build());
+
+  HloSchedule schedule(module.get());
+  schedule.set_sequence(entry, entry->MakeInstructionPostOrder());
+  CHECK_OK(module->set_schedule(std::move(schedule)));
+  return module;
+}
+
+void BM_BufferAssignmentManyLiveOutValues(
+    ::testing::benchmark::State& state) {
+  std::unique_ptr<HloModule> module =
+      MakeManyLiveOutValuesModule(state.range(0));
+  auto buffer_size = [](const BufferValue& buffer) {
+    return ShapeUtil::ByteSizeOf(buffer.shape(), sizeof(void*));
+  };
+  for (auto s : state) {
+    auto assignment =
+        BufferAssigner::Run(
+            module.get(),
+            std::make_unique<SequentialHloOrdering>(module->schedule()),
+            buffer_size, [](LogicalBuffer::Color) { return 1; },
+            /*allocate_buffers_for_constants=*/true)
+            .value();
+    tsl::testing::DoNotOptimize(assignment);
+  }
+}
+
+BENCHMARK(BM_BufferAssignmentManyLiveOutValues)->Range(128, 4096);
+
 }  // namespace
 }  // namespace xla
@@ -0,0 +1,393 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/collective_compressor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/comparison_util.h"
+#include "xla/hlo/ir/hlo_casting_utils.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/hlo/utils/hlo_query.h"
+#include "xla/literal_util.h"
+#include "xla/primitive_util.h"
+#include "xla/service/call_graph.h"
+#include "xla/service/collective_ops_utils.h"
+#include "xla/service/hlo_creation_utils.h"
+#include "xla/service/while_util.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace {
+
+// A sum all-reduce or reduce-scatter that can be compressed. Its operand is
+// viewed as a `[num_devices, num_blocks, block_size]` array, where the major
+// dimension indexes the shards exchanged between devices.
+struct Candidate {
+  HloInstruction* collective;
+  int64_t num_devices;
+  int64_t num_blocks;
+  int64_t block_size;
+};
+
+// A compressed payload with optional per-block scales.
+struct Compressed {
+  HloInstruction* payload;
+  HloInstruction* scales;
+};
+
+bool NeedsScaling(PrimitiveType compressed_type) {
+  return compressed_type != BF16;
+}
+
+double MaxFiniteValue(PrimitiveType type) {
+  return primitive_util::FloatingPointTypeSwitch<double>(
+      [](auto primitive_type) -> double {
+        using NativeT = primitive_util::NativeTypeOf<primitive_type>;
+        return static_cast<double>(std::numeric_limits<NativeT>::max());
+      },
+      type);
+}
+
+// Returns the number of devices in each replica group if all groups have the
+// same size, and the collective can be decomposed into all-to-all and
+// all-gather with the same device groups.
+std::optional<int64_t> GetUniformGroupSize(
+    const HloAllReduceInstructionBase* collective) {
+  absl::StatusOr<CollectiveOpGroupMode> group_mode = GetCollectiveOpGroupMode(
+      collective->channel_id().has_value(),
+      collective->use_global_device_ids());
+  if (!group_mode.ok() ||
+      (*group_mode != CollectiveOpGroupMode::kCrossReplica &&
+       *group_mode != CollectiveOpGroupMode::kCrossPartition)) {
+    return std::nullopt;
+  }
+
+  const HloModuleConfig& config = collective->GetModule()->config();
+  absl::StatusOr<std::vector<int64_t>> participant_counts =
+      GetPariticipantCountsForReplicaGroups(
+          config.replica_count(), config.num_partitions(),
+          collective->replica_groups(), *group_mode);
+  if (!participant_counts.ok() || participant_counts->empty()) {
+    return std::nullopt;
+  }
+
+  int64_t group_size = participant_counts->front();
+  for (int64_t count : *participant_counts) {
+    if (count != group_size) return std::nullopt;
+  }
+  return group_size;
+}
+
+std::optional<Candidate> MatchCandidate(
+    HloInstruction* instr, const CollectiveCompressor::Config& config) {
+  if (instr->opcode() != HloOpcode::kAllReduce &&
+      instr->opcode() != HloOpcode::kReduceScatter) {
+    return std::nullopt;
+  }
+
+  auto* collective = Cast<HloAllReduceInstructionBase>(instr);
+  if (collective->operand_count() != 1 || collective->constrain_layout() ||
+      !collective->shape().IsArray()) {
+    return std::nullopt;
+  }
+
+  const Shape& shape = collective->operand(0)->shape();
+  if (!primitive_util::IsFloatingPointType(shape.element_type()) ||
+      primitive_util::BitWidth(shape.element_type()) <=
+          primitive_util::BitWidth(config.compressed_type) ||
+      ShapeUtil::ByteSizeOf(shape) < config.min_bytes) {
+    return std::nullopt;
+  }
+
+  if (MatchReductionComputation(collective->to_apply()) != ReductionKind::SUM) {
+    return std::nullopt;
+  }
+
+  // Shards of reduce-scatter must be contiguous in the row-major order, so that
+  // we can exchange them with an all-to-all of the flattened operand.
+  if (auto* reduce_scatter = DynCast<HloReduceScatterInstruction>(instr)) {
+    for (int64_t i = 0; i < reduce_scatter->scatter_dimension(); ++i) {
+      if (shape.dimensions(i) != 1) return std::nullopt;
+    }
+  }
+
+  std::optional<int64_t> num_devices = GetUniformGroupSize(collective);
+  if (!num_devices.has_value() || *num_devices <= 1) return std::nullopt;
+
+  int64_t num_elements = ShapeUtil::ElementsIn(shape);
+  if (num_elements % *num_devices != 0) return std::nullopt;
+  int64_t shard_size = num_elements / *num_devices;
+
+  int64_t block_size = shard_size;
+  if (NeedsScaling(config.compressed_type)) {
+    block_size = std::min(config.block_size, shard_size);
+    if (shard_size % block_size != 0) return std::nullopt;
+  }
+
+  return Candidate{instr, *num_devices, shard_size / block_size, block_size};
+}
+
+// Compresses `value` of shape `[num_shards, num_blocks, block_size]`.
+absl::StatusOr<Compressed> Compress(HloInstruction* value,
+                                    PrimitiveType compressed_type) {
+  if (!NeedsScaling(compressed_type)) {
+    return Compressed{MakeConvertToHlo(value, compressed_type), nullptr};
+  }
+
+  HloComputation* computation = value->parent();
+  PrimitiveType type = value->shape().element_type();
+  const Shape& shape = value->shape();
+
+  // Scale every block so that its absolute maximum maps to the largest finite
+  // value of the compressed type.
+  TF_ASSIGN_OR_RETURN(HloInstruction * abs,
+                      MakeUnaryHlo(HloOpcode::kAbs, value));
+  HloInstruction* zero = computation->AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::Zero(type)));
+  TF_ASSIGN_OR_RETURN(HloInstruction * amax,
+                      MakeReduceHlo(abs, zero, /*dimensions=*/{2},
+                                    HloOpcode::kMaximum));
+
+  double max_value = MaxFiniteValue(compressed_type);
+  TF_ASSIGN_OR_RETURN(
+      HloInstruction * scales,
+      MakeBinaryHlo(HloOpcode::kDivide, amax, MakeScalarLike(amax, max_value)));
+
+  // Blocks of zeros keep the unit scale to avoid dividing by zero.
+  TF_ASSIGN_OR_RETURN(HloInstruction * is_zero,
+                      MakeCompareHlo(Comparison::Direction::kEq, scales,
+                                     MakeScalarLike(scales, 0)));
+  TF_ASSIGN_OR_RETURN(
+      scales, MakeSelectHlo(is_zero, MakeScalarLike(scales, 1), scales));
+
+  HloInstruction* scales_bcast = MakeBroadcastHlo(scales, {0, 1}, shape);
+  TF_ASSIGN_OR_RETURN(HloInstruction * scaled,
+                      MakeBinaryHlo(HloOpcode::kDivide, value, scales_bcast));
+  HloInstruction* clamped = computation->AddInstruction(
+      HloInstruction::CreateTernary(shape, HloOpcode::kClamp,
+                                    MakeScalarLike(scaled, -max_value), scaled,
+                                    MakeScalarLike(scaled, max_value)));
+
+  return Compressed{MakeConvertToHlo(clamped, compressed_type), scales};
+}
+
+absl::StatusOr<HloInstruction*> Decompress(const Compressed& compressed,
+                                           PrimitiveType type) {
+  HloInstruction* value = MakeConvertToHlo(compressed.payload, type);
+  if (compressed.scales == nullptr) return value;
+  HloInstruction* scales_bcast =
+      MakeBroadcastHlo(compressed.scales, {0, 1}, value->shape());
+  return MakeBinaryHlo(HloOpcode::kMultiply, value, scales_bcast);
+}
+
+// Rewrites a compressible collective. If `error` is not null, it is the
+// compression error from the previous iteration, and the function returns the
+// compression error of this iteration.
+absl::StatusOr<HloInstruction*> CompressCollective(
+    const Candidate& candidate, PrimitiveType compressed_type,
+    HloInstruction* error, int64_t& next_channel_id) {
+  auto* collective = Cast<HloAllReduceInstructionBase>(candidate.collective);
+  HloComputation* computation = collective->parent();
+  PrimitiveType type = collective->shape().element_type();
+
+  const int64_t n = candidate.num_devices;
+  const int64_t k = candidate.num_blocks;
+  const int64_t b = candidate.block_size;
+
+  auto next_channel = [&]() -> std::optional<int64_t> {
+    if (!collective->channel_id().has_value()) return std::nullopt;
+    return next_channel_id++;
+  };
+
+  // Sends the shard `i` of `value` to the device `i` of the replica group.
+  auto all_to_all = [&](HloInstruction* value) {
+    return computation->AddInstruction(HloInstruction::CreateAllToAll(
+        value->shape(), {value}, collective->device_list(),
+        /*constrain_layout=*/false, next_channel(), /*split_dimension=*/0));
+  };
+
+  auto all_gather = [&](HloInstruction* value) {
+    Shape shape = value->shape();
+    shape.set_dimensions(0, n);
+    return computation->AddInstruction(HloInstruction::CreateAllGather(
+        shape, {value}, /*all_gather_dimension=*/0, collective->device_list(),
+        /*constrain_layout=*/false, next_channel(),
+        collective->use_global_device_ids()));
+  };
+
+  TF_ASSIGN_OR_RETURN(
+      HloInstruction * operand,
+      MakeReshapeHlo({n, k, b}, collective->mutable_operand(0)));
+  if (error != nullptr) {
+    TF_ASSIGN_OR_RETURN(operand,
+                        MakeBinaryHlo(HloOpcode::kAdd, operand, error));
+  }
+
+  TF_ASSIGN_OR_RETURN(Compressed compressed,
+                      Compress(operand, compressed_type));
+
+  HloInstruction* new_error = nullptr;
+  if (error != nullptr) {
+    TF_ASSIGN_OR_RETURN(HloInstruction * decompressed,
+                        Decompress(compressed, type));
+    TF_ASSIGN_OR_RETURN(new_error, MakeBinaryHlo(HloOpcode::kSubtract,
+                                                 operand, decompressed));
+  }
+
+  // Exchange shards and reduce them in the original type.
+  Compressed received{all_to_all(compressed.payload),
+                      compressed.scales ? all_to_all(compressed.scales)
+                                        : nullptr};
+  TF_ASSIGN_OR_RETURN(HloInstruction * shards, Decompress(received, type));
+  HloInstruction* zero = computation->AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::Zero(type)));
+  TF_ASSIGN_OR_RETURN(
+      HloInstruction * shard,
+      MakeReduceHlo(shards, zero, /*dimensions=*/{0}, HloOpcode::kAdd));
+
+  HloInstruction* result = shard;
+  if (collective->opcode() == HloOpcode::kAllReduce) {
+    TF_ASSIGN_OR_RETURN(HloInstruction * shard_1xkxb,
+                        MakeReshapeHlo({1, k, b}, shard));
+    TF_ASSIGN_OR_RETURN(Compressed compressed_shard,
+                        Compress(shard_1xkxb, compressed_type));
+    Compressed gathered{all_gather(compressed_shard.payload),
+                        compressed_shard.scales
+                            ? all_gather(compressed_shard.scales)
+                            : nullptr};
+    TF_ASSIGN_OR_RETURN(result, Decompress(gathered, type));
+  }
+
+  TF_ASSIGN_OR_RETURN(result, MakeReshapeHlo(collective->shape(), result));
+  TF_RETURN_IF_ERROR(computation->ReplaceInstruction(collective, result));
+  return new_error;
+}
+
+// Returns the while loop that has `computation` as its body if it's the only
+// caller of the computation.
+HloInstruction* GetUniqueWhileCaller(const CallGraph& call_graph,
+                                     const HloComputation* computation) {
+  const CallGraphNode& node = call_graph.GetNode(computation);
+  if (node.caller_callsites().size() != 1) return nullptr;
+  HloInstruction* caller = node.caller_callsites().front().instruction();
+  if (caller->opcode() != HloOpcode::kWhile ||
+      caller->while_body() != computation || !caller->shape().IsTuple()) {
+    return nullptr;
+  }
+  return caller;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> CollectiveCompressor::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  std::unique_ptr<CallGraph> call_graph = CallGraph::Build(module);
+  int64_t next_channel_id = hlo_query::NextChannelId(*module);
+  bool changed = false;
+
+  // Visit callees before callers, so that widening a nested while loop updates
+  // its parent computation before the parent itself gets rewritten.
+  for (HloComputation* computation :
+       module->MakeComputationPostOrder(execution_threads)) {
+    if (computation->IsFusionComputation()) continue;
+
+    std::vector<Candidate> candidates;
+    for (HloInstruction* instr : computation->instructions()) {
+      if (std::optional<Candidate> candidate = MatchCandidate(instr, config_)) {
+        candidates.push_back(*candidate);
+      }
+    }
+    if (candidates.empty()) continue;
+
+    VLOG(2) << "Compress " << candidates.size() << " collectives in "
+            << computation->name() << " to "
+            << primitive_util::LowercasePrimitiveTypeName(
+                   config_.compressed_type);
+    changed = true;
+
+    HloInstruction* while_instr =
+        config_.error_feedback ? GetUniqueWhileCaller(*call_graph, computation)
+                               : nullptr;
+
+    if (while_instr == nullptr) {
+      for (const Candidate& candidate : candidates) {
+        TF_RETURN_IF_ERROR(CompressCollective(candidate,
+                                              config_.compressed_type,
+                                              /*error=*/nullptr,
+                                              next_channel_id)
+                               .status());
+      }
+      continue;
+    }
+
+    // Add a zero-initialized loop-carried error buffer for every collective.
+    std::vector<HloInstruction*> zeros;
+    for (const Candidate& candidate : candidates) {
+      PrimitiveType type = candidate.collective->shape().element_type();
+      HloInstruction* zero = while_instr->parent()->AddInstruction(
+          HloInstruction::CreateConstant(LiteralUtil::Zero(type)));
+      zeros.push_back(MakeBroadcastHlo(
+          zero, /*broadcast_dimensions=*/{},
+          ShapeUtil::MakeShape(type, {candidate.num_devices,
+                                      candidate.num_blocks,
+                                      candidate.block_size})));
+    }
+
+    int64_t num_loop_state_elements = while_instr->shape().tuple_shapes_size();
+    TF_ASSIGN_OR_RETURN(
+        WhileUtil::MakeInstructionsLiveInResult live_in,
+        WhileUtil::MakeInstructionsLiveIn(while_instr, zeros));
+    HloInstruction* root =
+        live_in.new_while_instr->while_body()->root_instruction();
+
+    for (int64_t i = 0; i < candidates.size(); ++i) {
+      Candidate candidate = candidates[i];
+      candidate.collective =
+          live_in.while_body_instruction_map.at(candidate.collective);
+      TF_ASSIGN_OR_RETURN(
+          HloInstruction * error,
+          CompressCollective(candidate, config_.compressed_type,
+                             live_in.while_body_live_in_values[i],
+                             next_channel_id));
+      TF_RETURN_IF_ERROR(
+          root->ReplaceOperandWith(num_loop_state_elements + i, error));
+    }
+  }
+
+  return changed;
+}
+
+}  // namespace xla
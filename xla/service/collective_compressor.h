@@ -0,0 +1,84 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_COLLECTIVE_COMPRESSOR_H_
+#define XLA_SERVICE_COLLECTIVE_COMPRESSOR_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/pass/hlo_pass_interface.h"
+#include "xla/xla_data.pb.h"
+
+namespace xla {
+
+// Reduces the amount of data transferred by large sum all-reduce and
+// reduce-scatter ops by compressing their payloads to a narrower floating
+// point type. Unlike CollectiveQuantizer, this pass introduces new (lossy)
+// type conversions.
+//
+// Reductions are computed in the original type, so the collectives are
+// decomposed into
+//
+//   compress --> all-to-all --> decompress --> reduce
+//
+// for reduce-scatter, and all-reduce additionally compresses the reduced shard
+// again and exchanges it with
+//
+//   compress --> all-gather --> decompress.
+//
+// This transfers the same number of (compressed) bytes as the ring algorithm.
+// For f16 and fp8 types, which have a narrower exponent range than the
+// original type, every block of `block_size` elements is scaled by its
+// absolute maximum to use the full range of the compressed type.
+//
+// If `error_feedback` is true and the collective is in a while loop body, the
+// compression error of the collective operand is added to the operand in the
+// next iteration. The error is kept in a new loop-carried buffer of the
+// while loop.
+class CollectiveCompressor : public HloModulePass {
+ public:
+  struct Config {
+    // Type of the compressed payload: BF16, F16, F8E4M3FN or F8E5M2.
+    PrimitiveType compressed_type = BF16;
+
+    // Only compress collectives with operands of at least this many bytes.
+    int64_t min_bytes = 1024 * 1024;
+
+    // Number of elements sharing the same scale in f16 and fp8 payloads.
+    int64_t block_size = 256;
+
+    bool error_feedback = true;
+  };
+
+  explicit CollectiveCompressor(Config config) : config_(config) {}
+
+  absl::string_view name() const override { return "collective-compressor"; }
+
+  using HloPassInterface::Run;
+  absl::StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  Config config_;
+};
+
+}  // namespace xla
+
+#endif  // XLA_SERVICE_COLLECTIVE_COMPRESSOR_H_
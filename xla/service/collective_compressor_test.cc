@@ -0,0 +1,220 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/collective_compressor.h"
+
+#include <cstdint>
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/algorithm/container.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/hlo/utils/hlo_matchers.h"
+#include "xla/tests/hlo_test_base.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class CollectiveCompressorTest : public HloTestBase {
+ public:
+  absl::StatusOr<bool> RunCollectiveCompressor(
+      HloModule* module, PrimitiveType compressed_type,
+      int64_t min_bytes = 0) {
+    CollectiveCompressor::Config config;
+    config.compressed_type = compressed_type;
+    config.min_bytes = min_bytes;
+    TF_ASSIGN_OR_RETURN(bool changed,
+                        RunHloPass(CollectiveCompressor(config), module));
+    TF_RETURN_IF_ERROR(verifier().Run(module).status());
+    return changed;
+  }
+
+  static int64_t CountInstructions(const HloComputation* computation,
+                                   HloOpcode opcode) {
+    return absl::c_count_if(computation->instructions(),
+                            [&](const HloInstruction* instr) {
+                              return instr->opcode() == opcode;
+                            });
+  }
+};
+
+TEST_F(CollectiveCompressorTest, AllReduceBF16) {
+  absl::string_view hlo_string = R"(
+  HloModule module, replica_count=4
+
+  add {
+    a = f32[] parameter(0)
+    b = f32[] parameter(1)
+    ROOT add = f32[] add(a, b)
+  }
+
+  ENTRY entry {
+    param = f32[8,1024] parameter(0)
+    ROOT all-reduce = f32[8,1024] all-reduce(param), to_apply=add,
+      replica_groups={{0,1,2,3}}
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunCollectiveCompressor(module.get(), BF16));
+  EXPECT_TRUE(changed);
+
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Reshape(op::Convert(op::AllGather(
+                        op::Convert(op::Reshape(op::Reduce(
+                            op::Convert(op::AllToAll(op::Convert(
+                                op::Reshape(op::Parameter(0))))),
+                            op::Constant())))))));
+  EXPECT_EQ(root->operand(0)->operand(0)->shape().element_type(), BF16);
+}
+
+TEST_F(CollectiveCompressorTest, ReduceScatterF8WithScales) {
+  absl::string_view hlo_string = R"(
+  HloModule module, replica_count=4
+
+  add {
+    a = f32[] parameter(0)
+    b = f32[] parameter(1)
+    ROOT add = f32[] add(a, b)
+  }
+
+  ENTRY entry {
+    param = f32[4,1024] parameter(0)
+    ROOT reduce-scatter = f32[1,1024] reduce-scatter(param), to_apply=add,
+      replica_groups={{0,1,2,3}}, dimensions={0}
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunCollectiveCompressor(module.get(), F8E4M3FN));
+  EXPECT_TRUE(changed);
+
+  const HloComputation* entry = module->entry_computation();
+  EXPECT_THAT(entry->root_instruction(), op::Reshape(op::Reduce()));
+  EXPECT_EQ(CountInstructions(entry, HloOpcode::kReduceScatter), 0);
+  EXPECT_EQ(CountInstructions(entry, HloOpcode::kAllGather), 0);
+
+  // The payload and the per-block scales are exchanged separately.
+  EXPECT_EQ(CountInstructions(entry, HloOpcode::kAllToAll), 2);
+  for (const HloInstruction* instr : entry->instructions()) {
+    if (instr->opcode() != HloOpcode::kAllToAll) continue;
+    EXPECT_TRUE(instr->shape().element_type() == F8E4M3FN ||
+                instr->shape().element_type() == F32);
+  }
+}
+
+TEST_F(CollectiveCompressorTest, ErrorFeedbackInWhileLoop) {
+  absl::string_view hlo_string = R"(
+  HloModule module, replica_count=4
+
+  add {
+    a = f32[] parameter(0)
+    b = f32[] parameter(1)
+    ROOT add = f32[] add(a, b)
+  }
+
+  cond {
+    param = (s32[], f32[8,1024]) parameter(0)
+    i = s32[] get-tuple-element(param), index=0
+    n = s32[] constant(10)
+    ROOT lt = pred[] compare(i, n), direction=LT
+  }
+
+  body {
+    param = (s32[], f32[8,1024]) parameter(0)
+    i = s32[] get-tuple-element(param), index=0
+    one = s32[] constant(1)
+    next = s32[] add(i, one)
+    x = f32[8,1024] get-tuple-element(param), index=1
+    all-reduce = f32[8,1024] all-reduce(x), to_apply=add,
+      replica_groups={{0,1,2,3}}
+    ROOT tuple = (s32[], f32[8,1024]) tuple(next, all-reduce)
+  }
+
+  ENTRY entry {
+    zero = s32[] constant(0)
+    param = f32[8,1024] parameter(0)
+    init = (s32[], f32[8,1024]) tuple(zero, param)
+    while = (s32[], f32[8,1024]) while(init), condition=cond, body=body
+    ROOT result = f32[8,1024] get-tuple-element(while), index=1
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunCollectiveCompressor(module.get(), F8E5M2));
+  EXPECT_TRUE(changed);
+
+  HloInstruction* while_instr = nullptr;
+  for (HloInstruction* instr : module->entry_computation()->instructions()) {
+    if (instr->opcode() == HloOpcode::kWhile) while_instr = instr;
+  }
+  ASSERT_NE(while_instr, nullptr);
+  ASSERT_EQ(while_instr->shape().tuple_shapes_size(), 3);
+
+  // The error buffer starts at zero and is updated by the loop body.
+  EXPECT_THAT(while_instr->operand(0)->operand(2), op::Broadcast());
+  const HloInstruction* root = while_instr->while_body()->root_instruction();
+  EXPECT_THAT(root->operand(2), op::Subtract(op::Add(), op::Multiply()));
+  EXPECT_EQ(CountInstructions(while_instr->while_body(), HloOpcode::kAllReduce),
+            0);
+}
+
+TEST_F(CollectiveCompressorTest, SkipSmallAndNonSumCollectives) {
+  absl::string_view hlo_string = R"(
+  HloModule module, replica_count=4
+
+  max {
+    a = f32[] parameter(0)
+    b = f32[] parameter(1)
+    ROOT max = f32[] maximum(a, b)
+  }
+
+  add {
+    a = f32[] parameter(0)
+    b = f32[] parameter(1)
+    ROOT add = f32[] add(a, b)
+  }
+
+  ENTRY entry {
+    param = f32[8,1024] parameter(0)
+    all-reduce-max = f32[8,1024] all-reduce(param), to_apply=max,
+      replica_groups={{0,1,2,3}}
+    small = f32[8,16] slice(param), slice={[0:8], [0:16]}
+    all-reduce-small = f32[8,16] all-reduce(small), to_apply=add,
+      replica_groups={{0,1,2,3}}
+    ROOT tuple = (f32[8,1024], f32[8,16]) tuple(all-reduce-max,
+                                                all-reduce-small)
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      RunCollectiveCompressor(module.get(), BF16, /*min_bytes=*/4096));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace xla
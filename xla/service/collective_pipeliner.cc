@@ -628,6 +628,19 @@ struct WhileMoveInfo {
   std::vector<int64_t> output_indices;
 };
 
+// Returns the size of the array buffers produced by a pipelined `instr`, which
+// are carried to the adjacent loop iteration.
+int64_t PipelinedBufferBytes(const HloInstruction* instr) {
+  int64_t bytes = 0;
+  ShapeUtil::ForEachSubshape(
+      instr->shape(), [&](const Shape& subshape, const ShapeIndex&) {
+        if (subshape.IsArray()) {
+          bytes += ShapeUtil::ByteSizeOfElements(subshape);
+        }
+      });
+  return bytes;
+}
+
 std::string ToString(const WhileMoveInfo& move_info) {
   // Combine the dynamic-update-slices and output indices into a single vector
   // so we can print them together.
@@ -735,12 +748,14 @@ class WhileLoopAnalysis {
  public:
   explicit WhileLoopAnalysis(
       HloInstruction* while_instr, int64_t max_pipelining_per_loop,
-      bool pipeline_use_tree, bool process_different_sized_options,
+      int64_t max_pipelined_bytes_per_loop, bool pipeline_use_tree,
+      bool process_different_sized_options,
       TuplePointsToAnalysis* tuple_points_to_analysis, CallGraph* call_graph,
       std::optional<ConstantValue> known_start = std::nullopt)
       : while_(while_instr),
         loop_start_(known_start),
         max_pipelining_per_loop_(max_pipelining_per_loop),
+        max_pipelined_bytes_per_loop_(max_pipelined_bytes_per_loop),
         tuple_points_to_analysis_(tuple_points_to_analysis),
         call_graph_(call_graph),
         pipeline_use_tree_(pipeline_use_tree),
@@ -838,6 +853,7 @@ class WhileLoopAnalysis {
   absl::flat_hash_set<const HloInstruction*> invariant_loop_parameters_;
   absl::flat_hash_set<const HloInstruction*> invariant_loop_instructions_;
   int64_t max_pipelining_per_loop_;
+  int64_t max_pipelined_bytes_per_loop_;
 
   // Precomputed TuplePointsToAnalysis for the HLO module containing `while_`.
   // May be null, in which case the analysis will be performed from scratch.
@@ -1266,6 +1282,9 @@ void WhileLoopAnalysis::CollectCollectivesToMove(
     instruction_order[instr] = count++;
   }
 
+  // Every pipelined collective keeps its buffer live across the loop back
+  // edge, so we stop picking collectives that don't fit in the budget.
+  int64_t pipelined_bytes = 0;
   for (auto* instr : instructions_post_order) {
     if (direction == CollectivePipeliner::PipeliningDirection::kForward &&
         (instr->operand_count() != 1 ||
@@ -1276,6 +1295,13 @@ void WhileLoopAnalysis::CollectCollectivesToMove(
     if (!should_process(instr)) {
       continue;
     }
+    int64_t instr_bytes = PipelinedBufferBytes(instr);
+    if (instr_bytes > max_pipelined_bytes_per_loop_ - pipelined_bytes) {
+      VLOG(5) << "Skipping " << instr->name() << " because pipelining its "
+              << instr_bytes << " bytes exceeds the budget of "
+              << max_pipelined_bytes_per_loop_ << " bytes per loop";
+      continue;
+    }
     if (direction == CollectivePipeliner::PipeliningDirection::kForward ||
         direction == CollectivePipeliner::PipeliningDirection::kForwardSink) {
       auto [dyn_updates, formatting_ops] = CheckStoreIntoSliceIsCompatible(
@@ -1374,6 +1400,7 @@ void WhileLoopAnalysis::CollectCollectivesToMove(
       move_infos_.push_back(
           WhileMoveInfo{{instr}, {}, std::move(*chain_collected), {}, {}});
     }
+    pipelined_bytes += instr_bytes;
     if (move_infos_.size() >= max_pipelining_per_loop_) {
       break;
     }
@@ -2954,7 +2981,8 @@ absl::StatusOr<bool> CollectivePipeliner::RunPipeliner(
       VLOG(1) << "Pipelinable while: " << instruction->name();
       auto loop_analysis = std::make_unique<WhileLoopAnalysis>(
           instruction, config_.max_pipelining_per_loop,
-          config_.pipeline_use_tree, config_.process_different_sized_ops,
+          config_.max_pipelined_bytes_per_loop, config_.pipeline_use_tree,
+          config_.process_different_sized_ops,
           tuple_points_to_analysis.get(), call_graph.get());
       loop_analysis->ComputeLoopStatistics();
       if (loop_analysis->GetLoopIterationCount() &&
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef XLA_SERVICE_COLLECTIVE_PIPELINER_H_
 #define XLA_SERVICE_COLLECTIVE_PIPELINER_H_
 
+#include <cstdint>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -103,6 +105,11 @@ class CollectivePipeliner : public HloModulePass {
     // Determines whether a loop invariant instruction can be considered
     // in the pipelining chain.
     bool should_add_loop_invariant_op_in_chain = false;
+    // Maximum total size in bytes of the buffers produced by the collectives
+    // pipelined per loop. Every pipelined collective keeps an extra buffer live
+    // across the loop back edge, so this bounds the memory overhead of the
+    // transformation.
+    int64_t max_pipelined_bytes_per_loop = INT64_MAX;
   };
   static const char* const kInsertedByPreviousStep;
   static const char* const kSunkByPreviousStep;
@@ -42,6 +42,7 @@ limitations under the License.
 #include "xla/service/hlo_module_config.h"
 #include "xla/service/hlo_verifier.h"
 #include "xla/service/host_memory_offload_annotations.h"
+#include "xla/service/host_offload_utils.h"
 #include "xla/test_helpers.h"
 #include "xla/tests/filecheck.h"
 #include "xla/tests/hlo_test_base.h"
@@ -3852,5 +3853,140 @@ ENTRY entry {
             1);
 }
 
+TEST_F(CollectivePipelinerTest, BackwardPipelineHostToDeviceDynamicSlice) {
+  constexpr absl::string_view hlo_string = R"(
+HloModule module
+
+while_cond {
+  param = (s32[], f32[4,8]{1,0:S(5)}, f32[1,8]{1,0}) parameter(0)
+  gte = s32[] get-tuple-element(param), index=0
+  constant.1 = s32[] constant(4)
+  ROOT cmp = pred[] compare(gte, constant.1), direction=LT
+}
+
+while_body {
+  param = (s32[], f32[4,8]{1,0:S(5)}, f32[1,8]{1,0}) parameter(0)
+  i = s32[] get-tuple-element(param), index=0
+  host = f32[4,8]{1,0:S(5)} get-tuple-element(param), index=1
+  acc = f32[1,8]{1,0} get-tuple-element(param), index=2
+  constant.0 = s32[] constant(0)
+  constant.1 = s32[] constant(1)
+  constant.3 = s32[] constant(3)
+  index = s32[] subtract(constant.3, i)
+  slice = f32[1,8]{1,0} dynamic-slice(host, index, constant.0), dynamic_slice_sizes={1,8}
+  add = f32[1,8]{1,0} add(acc, slice)
+  next = s32[] add(i, constant.1)
+  ROOT tuple = (s32[], f32[4,8]{1,0:S(5)}, f32[1,8]{1,0}) tuple(next, host, add)
+}
+
+ENTRY entry {
+  c0 = s32[] constant(0)
+  p0 = f32[4,8]{1,0:S(5)} parameter(0)
+  p1 = f32[1,8]{1,0} parameter(1)
+  tuple = (s32[], f32[4,8]{1,0:S(5)}, f32[1,8]{1,0}) tuple(c0, p0, p1)
+  while = (s32[], f32[4,8]{1,0:S(5)}, f32[1,8]{1,0}) while(tuple), condition=while_cond, body=while_body
+  ROOT gte1 = f32[1,8]{1,0} get-tuple-element(while), index=2
+}
+)";
+  auto module = ParseAndReturnUnverifiedModule(hlo_string, config_).value();
+  EXPECT_TRUE(RunOptimizer(module.get(), /*last_run=*/true, 0,
+                           /*pipeline_use_tree=*/false,
+                           /*process_different_sized_ops=*/false,
+                           CollectivePipeliner::PipeliningDirection::kBackward,
+                           host_offload_utils::IsHostToDeviceDynamicSlice,
+                           /*acceptable_formatting=*/HloPredicateTrue,
+                           /*reuse_pipelined_op_buffer=*/HloPredicateFalse,
+                           /*should_allow_loop_variant_parameter_in_chain=*/
+                           HloPredicateFalse,
+                           /*postprocess_backward_peeled=*/std::nullopt,
+                           /*postprocess_backward_rotated=*/std::nullopt,
+                           /*should_add_loop_invariant_op_in_chain=*/true)
+                  .value());
+  XLA_VLOG_LINES(1, module->ToString());
+  // The slice for the first iteration is peeled out of the loop and the loop
+  // body slices for the next iteration, so that the transfer overlaps the
+  // compute of the current one.
+  const HloInstruction* while_instr =
+      FindInstruction(module.get(), HloOpcode::kWhile);
+  EXPECT_THAT(while_instr->operand(0)->operands(),
+              ::testing::Contains(op::DynamicSlice(op::Parameter(0), _, _)));
+  const HloInstruction* root = while_instr->while_body()->root_instruction();
+  EXPECT_EQ(root->operand_count(), 4);
+  EXPECT_THAT(root->operands(), ::testing::Contains(op::DynamicSlice(
+                                    op::GetTupleElement(), _, _)));
+  const HloInstruction* add = *absl::c_find_if(
+      while_instr->while_body()->instructions(),
+      [](const HloInstruction* instr) {
+        return instr->opcode() == HloOpcode::kAdd &&
+               instr->shape().element_type() == F32;
+      });
+  EXPECT_THAT(add, op::Add(_, op::GetTupleElement(op::Parameter(0))));
+}
+
+TEST_F(CollectivePipelinerTest, NoTransformOverPipelinedBytesBudget) {
+  constexpr absl::string_view hlo_string = R"(
+HloModule module
+
+add {
+  lhs = bf16[] parameter(0)
+  rhs = bf16[] parameter(1)
+  ROOT add = bf16[] add(lhs, rhs)
+}
+
+while_cond {
+  param = (s32[], bf16[3,8,128], bf16[3,8,128]) parameter(0)
+  gte = s32[] get-tuple-element(param), index=0
+  constant.1 = s32[] constant(3)
+  ROOT cmp = pred[] compare(gte, constant.1), direction=LT
+}
+
+while_body {
+  param = (s32[], bf16[3,8,128], bf16[3,8,128]) parameter(0)
+  get-tuple-element.394 = s32[] get-tuple-element(param), index=0
+  get-tuple-element.395 = bf16[3,8,128] get-tuple-element(param), index=1
+  get-tuple-element.5 = bf16[3,8,128] get-tuple-element(param), index=2
+  constant.2557 = s32[] constant(1)
+  add.230 = s32[] add(get-tuple-element.394, constant.2557)
+  constant.2559 = s32[] constant(3)
+  subtract.139 = s32[] subtract(constant.2559, get-tuple-element.394)
+  constant.2560 = s32[] constant(-1)
+  add.231 = s32[] add(subtract.139, constant.2560)
+  constant.2561 = s32[] constant(0)
+  compare.747 = pred[] compare(add.231, constant.2561), direction=LT
+  constant.2562 = s32[] constant(2)
+  add.232 = s32[] add(subtract.139, constant.2562)
+  select.1348 = s32[] select(compare.747, add.232, add.231)
+  dynamic-slice.99 = bf16[1,8,128] dynamic-slice(get-tuple-element.5, select.1348, constant.2561, constant.2561), dynamic_slice_sizes={1,8,128}
+  mul = bf16[1,8,128] multiply(dynamic-slice.99, dynamic-slice.99)
+  ar.1 = bf16[1,8,128] all-reduce(mul), replica_groups={}, to_apply=add, channel_id=1
+  dynamic-update-slice.35 = bf16[3,8,128] dynamic-update-slice(get-tuple-element.395, ar.1, select.1348, constant.2561, constant.2561)
+  ROOT tuple = (s32[], bf16[3,8,128], bf16[3,8,128]) tuple(add.230, dynamic-update-slice.35, get-tuple-element.5)
+}
+
+ENTRY entry {
+  c0 = s32[] constant(0)
+  p0 = bf16[3,8,128] parameter(0)
+  tuple = (s32[], bf16[3,8,128], bf16[3,8,128]) tuple(c0, p0, p0)
+  while = (s32[], bf16[3,8,128], bf16[3,8,128]) while(tuple), condition=while_cond, body=while_body
+  ROOT gte1 = bf16[3,8,128] get-tuple-element(while), index=1
+}
+)";
+  CollectivePipeliner::Config config;
+  config.max_pipelining_per_loop = INT64_MAX;
+  config.pipelining_direction =
+      CollectivePipeliner::PipeliningDirection::kForward;
+  config.should_process = HloPredicateIsOp<HloOpcode::kAllReduce>;
+  config.acceptable_formatting = HloPredicateTrue;
+  config.reuse_pipelined_op_buffer = HloPredicateTrue;
+
+  // The all-reduce result is bf16[1,8,128], i.e. 2048 bytes.
+  config.max_pipelined_bytes_per_loop = 2047;
+  auto module = ParseAndReturnUnverifiedModule(hlo_string, config_).value();
+  EXPECT_FALSE(CollectivePipeliner(config).Run(module.get()).value());
+
+  config.max_pipelined_bytes_per_loop = 2048;
+  EXPECT_TRUE(CollectivePipeliner(config).Run(module.get()).value());
+}
+
 }  // namespace
 }  // namespace xla
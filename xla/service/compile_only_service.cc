@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "xla/service/compile_only_service.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "xla/debug_options_flags.h"
 #include "xla/service/backend.h"
@@ -29,7 +31,9 @@ limitations under the License.
 #include "xla/stream_executor/stream_executor.h"
 #include "xla/types.h"
 #include "xla/util.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 
@@ -130,10 +134,50 @@ CompileOnlyService::CompileAheadOfTime(
     hlo_modules.push_back(std::move(hlo_module));
   }
 
-  return compiler_->CompileAheadOfTime(
-      std::make_unique<HloModuleGroup>(hlo_modules[0]->name(),
-                                       absl::MakeSpan(hlo_modules)),
-      options, metadata);
+  // With an executor, compilations may autotune on that device. Concurrent
+  // autotuning would skew the measurements of all of them, so the group is
+  // compiled as a whole.
+  const int num_threads = std::min<int>(
+      options.max_parallel_module_compilations(), hlo_modules.size());
+  if (num_threads <= 1 || metadata != nullptr ||
+      options.executor() != nullptr) {
+    return compiler_->CompileAheadOfTime(
+        std::make_unique<HloModuleGroup>(hlo_modules[0]->name(),
+                                         absl::MakeSpan(hlo_modules)),
+        options, metadata);
+  }
+  return CompileModulesInParallel(std::move(hlo_modules), options, num_threads);
+}
+
+absl::StatusOr<std::vector<std::unique_ptr<AotCompilationResult>>>
+CompileOnlyService::CompileModulesInParallel(
+    std::vector<std::unique_ptr<HloModule>> hlo_modules,
+    const AotCompilationOptions& options, int num_threads) {
+  using Results = std::vector<std::unique_ptr<AotCompilationResult>>;
+  std::vector<absl::StatusOr<Results>> module_results(hlo_modules.size());
+  {
+    // Modules of a group are independent, so each of them is compiled as a
+    // group of its own. Destroying the pool waits for all compilations.
+    tsl::thread::ThreadPool pool(tsl::Env::Default(), "aot_compile",
+                                 num_threads);
+    for (size_t i = 0; i < hlo_modules.size(); ++i) {
+      pool.Schedule([&, i] {
+        module_results[i] = compiler_->CompileAheadOfTime(
+            std::make_unique<HloModuleGroup>(std::move(hlo_modules[i])),
+            options);
+      });
+    }
+  }
+
+  Results results;
+  results.reserve(module_results.size());
+  for (absl::StatusOr<Results>& module_result : module_results) {
+    TF_RETURN_IF_ERROR(module_result.status());
+    for (std::unique_ptr<AotCompilationResult>& result : *module_result) {
+      results.push_back(std::move(result));
+    }
+  }
+  return results;
 }
 
 }  // namespace xla
@@ -77,6 +77,13 @@ class CompileOnlyService : public Service {
   CompileOnlyService(const CompileOnlyService&) = delete;
   void operator=(const CompileOnlyService&) = delete;
 
+  // Compiles every module as a module group of its own, using `num_threads`
+  // threads. Results are returned in the order of `hlo_modules`.
+  absl::StatusOr<std::vector<std::unique_ptr<AotCompilationResult>>>
+  CompileModulesInParallel(std::vector<std::unique_ptr<HloModule>> hlo_modules,
+                           const AotCompilationOptions& options,
+                           int num_threads);
+
   // The compiler for the target platform.  This is included in place of
   // the Service::execute_backend_'s compiler, since execute_backend_ is a
   // nullptr in CompileOnlyService.
@@ -446,6 +446,31 @@ class AotCompilationOptions {
     target_config_ = target_config;
   }
 
+  // Additional targets to compile device binaries for, next to the one
+  // described by `target_config` or `executor`. The results then carry one
+  // binary per target and pick the matching one when loaded. Only supported
+  // by GPU compilers.
+  const std::vector<Compiler::TargetConfig>& additional_target_configs()
+      const {
+    return additional_target_configs_;
+  }
+  void add_additional_target_config(
+      const Compiler::TargetConfig& target_config) {
+    additional_target_configs_.push_back(target_config);
+  }
+
+  // Maximum number of modules of a module group compiled concurrently by
+  // CompileOnlyService. Modules are only compiled concurrently when no
+  // AotCompilationMetadata is requested, as metadata describes the whole
+  // group, and when no executor is set, as compilations for an executor may
+  // autotune on it. Values <= 1 compile the group as a whole.
+  int max_parallel_module_compilations() const {
+    return max_parallel_module_compilations_;
+  }
+  void set_max_parallel_module_compilations(int max_parallel) {
+    max_parallel_module_compilations_ = max_parallel;
+  }
+
  protected:
   AotCompilationOptions();
 
@@ -465,6 +490,8 @@ class AotCompilationOptions {
   std::vector<std::string> sanitize_abilists_dataflow_;
   // Contains target-specific information required by AOT compilation.
   std::optional<Compiler::TargetConfig> target_config_;
+  std::vector<Compiler::TargetConfig> additional_target_configs_;
+  int max_parallel_module_compilations_ = 1;
 };
 
 }  // namespace xla
@@ -555,8 +555,7 @@ class LiveRangeRegions {
     if (p == computation_map_.end()) {
       return false;
     }
-    auto instr_map = (*p).second;
-    return instr_map.find(instr) != instr_map.end();
+    return p->second.find(instr) != p->second.end();
   }
 
   std::string ToString() const {
@@ -890,10 +889,10 @@ class ComputeRelativeLocation {
     Relation dir_src_dest;
     for (const auto* computation1 : range1) {
       for (const auto* computation2 : range2) {
-        for (auto instr_entry2 : range2[computation2]) {
-          if (!ordering_->call_graph().Dominates(computation1, computation2)) {
-            continue;
-          }
+        if (!ordering_->call_graph().Dominates(computation1, computation2)) {
+          continue;
+        }
+        for (const auto& instr_entry2 : range2[computation2]) {
           VLOG(3) << "Locationing " << instr_entry2.first->ToString();
           // Saves relations between instr2 and other instructions in range1.
           bool instr2_can_modify =
@@ -1205,18 +1204,21 @@ class ComputeRelativeLocation {
             return false;
           }
         };
-        if (!ctrl_deps_.empty()) {
-          auto ctrl_deps = ctrl_deps_[instr1->parent()];
-          if (absl::c_any_of(ctrl_deps[instr2], [&](HloInstruction* pred2) {
-                return ControlDependenceBefore(instr1, pred2);
-              })) {
+        auto ctrl_deps = ctrl_deps_.find(instr1->parent());
+        if (ctrl_deps != ctrl_deps_.end()) {
+          auto ControlDependenceBeforeAny = [&](HloInstruction* op,
+                                                HloInstruction* succ) {
+            auto preds = ctrl_deps->second.find(succ);
+            return preds != ctrl_deps->second.end() &&
+                   absl::c_any_of(preds->second, [&](HloInstruction* pred) {
+                     return ControlDependenceBefore(op, pred);
+                   });
+          };
+          if (ControlDependenceBeforeAny(instr1, instr2)) {
             VLOG(2) << "control-dependent: " << instr1->name() << " vs "
                     << instr2->name();
             return Save(instr1, instr2, Relation::kBeforeStart);
-          } else if (absl::c_any_of(
-                         ctrl_deps[instr1], [&](HloInstruction* pred1) {
-                           return ControlDependenceBefore(instr2, pred1);
-                         })) {
+          } else if (ControlDependenceBeforeAny(instr2, instr1)) {
             VLOG(2) << "control-dependent: " << instr2->name() << " vs "
                     << instr1->name();
             return Save(instr1, instr2, Relation::kAfterEnd);
@@ -2020,8 +2022,18 @@ absl::Status CopyInsertion::AddCopiesForConditional(
 absl::Status CopyInsertion::AddCopiesToResolveInterference(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
-  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloAliasAnalysis> alias_analysis,
-                      HloAliasAnalysis::Run(module, can_share_buffer_));
+  // The alias analysis is only needed once we find an instruction that may
+  // require copies, so build it lazily. No copies are added before the first
+  // request, so the result is identical to building it up front, but modules
+  // without loops, conditionals or in-place operations skip the analysis.
+  std::unique_ptr<HloAliasAnalysis> alias_analysis;
+  auto get_alias_analysis = [&]() -> absl::StatusOr<const HloAliasAnalysis*> {
+    if (alias_analysis == nullptr) {
+      TF_ASSIGN_OR_RETURN(alias_analysis,
+                          HloAliasAnalysis::Run(module, can_share_buffer_));
+    }
+    return alias_analysis.get();
+  };
   for (HloComputation* computation :
        module->MakeNonfusionComputations(execution_threads)) {
     if (computation->IsAsyncComputation()) {
@@ -2030,10 +2042,13 @@ absl::Status CopyInsertion::AddCopiesToResolveInterference(
     for (HloInstruction* instruction :
          computation->MakeInstructionPostOrder()) {
       if (instruction->opcode() == HloOpcode::kWhile) {
-        TF_RETURN_IF_ERROR(AddCopiesForWhile(*alias_analysis, instruction));
+        TF_ASSIGN_OR_RETURN(const HloAliasAnalysis* analysis,
+                            get_alias_analysis());
+        TF_RETURN_IF_ERROR(AddCopiesForWhile(*analysis, instruction));
       } else if (instruction->opcode() == HloOpcode::kConditional) {
-        TF_RETURN_IF_ERROR(
-            AddCopiesForConditional(*alias_analysis, instruction));
+        TF_ASSIGN_OR_RETURN(const HloAliasAnalysis* analysis,
+                            get_alias_analysis());
+        TF_RETURN_IF_ERROR(AddCopiesForConditional(*analysis, instruction));
       } else {
         // When an operand is a tuple, we avoid copying the operand multiple
         // times by recording and checking the operand number of operands that
@@ -2079,8 +2094,10 @@ absl::Status CopyInsertion::AddCopiesToResolveInterference(
             continue;
           }
           copied_operands.insert(operand_index.operand_number);
+          TF_ASSIGN_OR_RETURN(const HloAliasAnalysis* analysis,
+                              get_alias_analysis());
           TF_RETURN_IF_ERROR(AddCopiesForInPlaceOperation(
-              *alias_analysis, instruction, operand_index.operand_number));
+              *analysis, instruction, operand_index.operand_number));
         }
       }
     }
@@ -2271,6 +2288,12 @@ absl::Status CopyInsertion::RemoveUnnecessaryCopies(
   XLA_VLOG_LINES(
       4, module->ToString(HloPrintOptions().set_syntax_sugar_async_ops(false)));
 
+  int64_t num_existing_copies = GetNumExistingCopies(module, execution_threads);
+  if (num_existing_copies == 0) {
+    // Nothing to remove; don't pay for the ordering and alias analysis.
+    return absl::OkStatus();
+  }
+
   // Use SequentialHloOrdering if the module has a schedule. The schedule can
   // provide more information on the ordering, allowing for detecting more
   // redundant copies.
@@ -2293,7 +2316,6 @@ absl::Status CopyInsertion::RemoveUnnecessaryCopies(
     }
   }
 
-  int64_t num_existing_copies = GetNumExistingCopies(module, execution_threads);
   bool changed = true;
   int64_t num_iterations = -1;
   VLOG(6) << "Copy Insertion analyzing module with instruction count = "
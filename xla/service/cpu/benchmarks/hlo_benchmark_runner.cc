@@ -21,6 +21,8 @@ limitations under the License.
 
 #include "absl/status/status.h"
 #include "absl/strings/str_replace.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xla/client/xla_computation.h"
 #include "xla/hlo/ir/hlo_module.h"
@@ -58,8 +60,10 @@ absl::Status RunHloBenchmark(benchmark::State& state,
     compile_options.executable_build_options.mutable_debug_options()
         ->add_xla_disable_hlo_passes("cpu-parallel-task-assigner");
   }
+  absl::Time compile_start = absl::Now();
   TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtLoadedExecutable> executable,
                       client->Compile(computation, compile_options));
+  absl::Duration compile_time = absl::Now() - compile_start;
 
   // Convert literals to PjRtBuffers.
   std::vector<std::unique_ptr<PjRtBuffer>> args_buffers;
@@ -82,9 +86,27 @@ absl::Status RunHloBenchmark(benchmark::State& state,
   }
 
   // Warmup executable.
+  absl::Time first_run_start = absl::Now();
   TF_ASSIGN_OR_RETURN(
       std::vector<std::unique_ptr<PjRtBuffer>> results,
       executable->ExecuteSharded(args_ptrs, device, execute_options));
+  absl::Duration first_run_time = absl::Now() - first_run_start;
+
+  // Report one-off costs next to the steady-state time measured below, so they
+  // are part of the machine-readable benchmark output.
+  state.counters["compile_time_us"] =
+      benchmark::Counter(absl::ToDoubleMicroseconds(compile_time));
+  state.counters["first_run_time_us"] =
+      benchmark::Counter(absl::ToDoubleMicroseconds(first_run_time));
+  // This is the total size of the buffer allocations, not the peak of live
+  // memory, which the memory stats don't expose.
+  if (auto memory_stats = executable->GetCompiledMemoryStats();
+      memory_stats.ok()) {
+    state.counters["allocated_memory_bytes"] = benchmark::Counter(
+        memory_stats->argument_size_in_bytes +
+        memory_stats->output_size_in_bytes + memory_stats->temp_size_in_bytes -
+        memory_stats->alias_size_in_bytes);
+  }
 
   // Benchmark executable.
   for (auto _ : state) {
@@ -39,6 +39,10 @@ using StrToStrMapping =
 // If `disable_parallel_task_assigner` is true, the parallel task assigner will
 // not be run on the HLO module before running the benchmark. Therefore,
 // parallel backend will not be executed.
+//
+// Besides the steady-state time per iteration, the benchmark reports the
+// compile time, the time of the first (warmup) run and the memory allocated
+// for the executable's arguments, outputs and temporaries as counters.
 absl::Status RunHloBenchmark(benchmark::State& state,
                              std::string_view hlo_module,
                              absl::Span<const Literal* const> args,
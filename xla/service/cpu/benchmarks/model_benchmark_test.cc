@@ -0,0 +1,328 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/service/cpu/benchmarks/hlo_benchmark_runner.h"
+#include "xla/shape_util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/test_benchmark.h"
+
+// End-to-end benchmarks of small but representative models. Together with the
+// compile time, first run time and allocated memory counters reported by
+// RunHloBenchmark, they are meant to qualify compiler and runtime upgrades on
+// whole programs rather than on single operations.
+
+namespace xla::cpu {
+
+static Literal RandomLiteral(const Shape& shape, std::minstd_rand0* engine) {
+  return *LiteralUtil::CreateRandomLiteral<F32>(shape, engine, 0.0f, 0.1f);
+}
+
+// A single head self-attention layer followed by an MLP, both with residual
+// connections.
+static void BM_TransformerBlock(benchmark::State& state) {
+  int64_t batch = state.range(0);
+
+  std::string_view hlo = R"(
+    HloModule transformer_block_$batch
+
+    max {
+      p0 = f32[] parameter(0)
+      p1 = f32[] parameter(1)
+      ROOT max = f32[] maximum(p0, p1)
+    }
+
+    add {
+      p0 = f32[] parameter(0)
+      p1 = f32[] parameter(1)
+      ROOT add = f32[] add(p0, p1)
+    }
+
+    ENTRY e {
+      x = f32[$batch,128,256] parameter(0)
+      wq = f32[256,256] parameter(1)
+      wk = f32[256,256] parameter(2)
+      wv = f32[256,256] parameter(3)
+      w1 = f32[256,1024] parameter(4)
+      w2 = f32[1024,256] parameter(5)
+
+      q = f32[$batch,128,256] dot(x, wq),
+        lhs_contracting_dims={2}, rhs_contracting_dims={0}
+      k = f32[$batch,128,256] dot(x, wk),
+        lhs_contracting_dims={2}, rhs_contracting_dims={0}
+      v = f32[$batch,128,256] dot(x, wv),
+        lhs_contracting_dims={2}, rhs_contracting_dims={0}
+
+      scores = f32[$batch,128,128] dot(q, k),
+        lhs_batch_dims={0}, lhs_contracting_dims={2},
+        rhs_batch_dims={0}, rhs_contracting_dims={2}
+      ninf = f32[] constant(-inf)
+      scores_max = f32[$batch,128] reduce(scores, ninf), dimensions={2},
+        to_apply=max
+      scores_max_bcast = f32[$batch,128,128] broadcast(scores_max),
+        dimensions={0,1}
+      scores_sub = f32[$batch,128,128] subtract(scores, scores_max_bcast)
+      scores_exp = f32[$batch,128,128] exponential(scores_sub)
+      zero = f32[] constant(0)
+      scores_sum = f32[$batch,128] reduce(scores_exp, zero), dimensions={2},
+        to_apply=add
+      scores_sum_bcast = f32[$batch,128,128] broadcast(scores_sum),
+        dimensions={0,1}
+      probs = f32[$batch,128,128] divide(scores_exp, scores_sum_bcast)
+      attention = f32[$batch,128,256] dot(probs, v),
+        lhs_batch_dims={0}, lhs_contracting_dims={2},
+        rhs_batch_dims={0}, rhs_contracting_dims={1}
+      residual = f32[$batch,128,256] add(x, attention)
+
+      mlp0 = f32[$batch,128,1024] dot(residual, w1),
+        lhs_contracting_dims={2}, rhs_contracting_dims={0}
+      zero_bcast = f32[$batch,128,1024] broadcast(zero), dimensions={}
+      relu = f32[$batch,128,1024] maximum(mlp0, zero_bcast)
+      mlp1 = f32[$batch,128,256] dot(relu, w2),
+        lhs_contracting_dims={2}, rhs_contracting_dims={0}
+      ROOT out = f32[$batch,128,256] add(residual, mlp1)
+    }
+  )";
+
+  std::minstd_rand0 engine;
+
+  auto x = RandomLiteral(ShapeUtil::MakeShape(F32, {batch, 128, 256}), &engine);
+  auto wq = RandomLiteral(ShapeUtil::MakeShape(F32, {256, 256}), &engine);
+  auto wk = RandomLiteral(ShapeUtil::MakeShape(F32, {256, 256}), &engine);
+  auto wv = RandomLiteral(ShapeUtil::MakeShape(F32, {256, 256}), &engine);
+  auto w1 = RandomLiteral(ShapeUtil::MakeShape(F32, {256, 1024}), &engine);
+  auto w2 = RandomLiteral(ShapeUtil::MakeShape(F32, {1024, 256}), &engine);
+
+  std::vector<const Literal*> args = {&x, &wq, &wk, &wv, &w1, &w2};
+  CHECK_OK(RunHloBenchmark(state, hlo, args,
+                           {{"$batch", absl::StrCat(batch)}}));
+}
+
+// A densely gated mixture of experts layer: every token is processed by all
+// experts and the expert outputs are combined with softmax gates.
+static void BM_MixtureOfExperts(benchmark::State& state) {
+  int64_t tokens = state.range(0);
+
+  std::string_view hlo = R"(
+    HloModule mixture_of_experts_$tokens
+
+    max {
+      p0 = f32[] parameter(0)
+      p1 = f32[] parameter(1)
+      ROOT max = f32[] maximum(p0, p1)
+    }
+
+    add {
+      p0 = f32[] parameter(0)
+      p1 = f32[] parameter(1)
+      ROOT add = f32[] add(p0, p1)
+    }
+
+    ENTRY e {
+      x = f32[$tokens,256] parameter(0)
+      wg = f32[256,8] parameter(1)
+      w1 = f32[8,256,512] parameter(2)
+      w2 = f32[8,512,256] parameter(3)
+
+      logits = f32[$tokens,8] dot(x, wg),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+      ninf = f32[] constant(-inf)
+      logits_max = f32[$tokens] reduce(logits, ninf), dimensions={1},
+        to_apply=max
+      logits_max_bcast = f32[$tokens,8] broadcast(logits_max), dimensions={0}
+      logits_sub = f32[$tokens,8] subtract(logits, logits_max_bcast)
+      logits_exp = f32[$tokens,8] exponential(logits_sub)
+      zero = f32[] constant(0)
+      logits_sum = f32[$tokens] reduce(logits_exp, zero), dimensions={1},
+        to_apply=add
+      logits_sum_bcast = f32[$tokens,8] broadcast(logits_sum), dimensions={0}
+      gates = f32[$tokens,8] divide(logits_exp, logits_sum_bcast)
+
+      hidden = f32[$tokens,8,512] dot(x, w1),
+        lhs_contracting_dims={1}, rhs_contracting_dims={1}
+      zero_bcast = f32[$tokens,8,512] broadcast(zero), dimensions={}
+      relu = f32[$tokens,8,512] maximum(hidden, zero_bcast)
+      experts = f32[8,$tokens,256] dot(relu, w2),
+        lhs_batch_dims={1}, lhs_contracting_dims={2},
+        rhs_batch_dims={0}, rhs_contracting_dims={1}
+
+      gates_t = f32[8,$tokens] transpose(gates), dimensions={1,0}
+      gates_bcast = f32[8,$tokens,256] broadcast(gates_t), dimensions={0,1}
+      weighted = f32[8,$tokens,256] multiply(experts, gates_bcast)
+      ROOT out = f32[$tokens,256] reduce(weighted, zero), dimensions={0},
+        to_apply=add
+    }
+  )";
+
+  std::minstd_rand0 engine;
+
+  auto x = RandomLiteral(ShapeUtil::MakeShape(F32, {tokens, 256}), &engine);
+  auto wg = RandomLiteral(ShapeUtil::MakeShape(F32, {256, 8}), &engine);
+  auto w1 = RandomLiteral(ShapeUtil::MakeShape(F32, {8, 256, 512}), &engine);
+  auto w2 = RandomLiteral(ShapeUtil::MakeShape(F32, {8, 512, 256}), &engine);
+
+  std::vector<const Literal*> args = {&x, &wg, &w1, &w2};
+  CHECK_OK(RunHloBenchmark(state, hlo, args,
+                           {{"$tokens", absl::StrCat(tokens)}}));
+}
+
+// Two 3x3 convolutions with ReLU activations, global average pooling and a
+// dense classifier.
+static void BM_ConvNet(benchmark::State& state) {
+  int64_t batch = state.range(0);
+
+  std::string_view hlo = R"(
+    HloModule conv_net_$batch
+
+    add {
+      p0 = f32[] parameter(0)
+      p1 = f32[] parameter(1)
+      ROOT add = f32[] add(p0, p1)
+    }
+
+    ENTRY e {
+      x = f32[$batch,32,32,3] parameter(0)
+      k1 = f32[3,3,3,32] parameter(1)
+      k2 = f32[3,3,32,64] parameter(2)
+      w = f32[64,10] parameter(3)
+
+      zero = f32[] constant(0)
+      conv1 = f32[$batch,32,32,32] convolution(x, k1),
+        window={size=3x3 pad=1_1x1_1}, dim_labels=b01f_01io->b01f
+      zero_bcast1 = f32[$batch,32,32,32] broadcast(zero), dimensions={}
+      relu1 = f32[$batch,32,32,32] maximum(conv1, zero_bcast1)
+      conv2 = f32[$batch,32,32,64] convolution(relu1, k2),
+        window={size=3x3 pad=1_1x1_1}, dim_labels=b01f_01io->b01f
+      zero_bcast2 = f32[$batch,32,32,64] broadcast(zero), dimensions={}
+      relu2 = f32[$batch,32,32,64] maximum(conv2, zero_bcast2)
+
+      sum = f32[$batch,64] reduce(relu2, zero), dimensions={1,2}, to_apply=add
+      scale = f32[] constant(0.0009765625)
+      scale_bcast = f32[$batch,64] broadcast(scale), dimensions={}
+      mean = f32[$batch,64] multiply(sum, scale_bcast)
+      ROOT logits = f32[$batch,10] dot(mean, w),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    }
+  )";
+
+  std::minstd_rand0 engine;
+
+  auto x =
+      RandomLiteral(ShapeUtil::MakeShape(F32, {batch, 32, 32, 3}), &engine);
+  auto k1 = RandomLiteral(ShapeUtil::MakeShape(F32, {3, 3, 3, 32}), &engine);
+  auto k2 = RandomLiteral(ShapeUtil::MakeShape(F32, {3, 3, 32, 64}), &engine);
+  auto w = RandomLiteral(ShapeUtil::MakeShape(F32, {64, 10}), &engine);
+
+  std::vector<const Literal*> args = {&x, &k1, &k2, &w};
+  CHECK_OK(RunHloBenchmark(state, hlo, args,
+                           {{"$batch", absl::StrCat(batch)}}));
+}
+
+// A recurrent network scanned over a sequence with a while loop, which
+// exercises loop overheads and dynamic slicing of the loop inputs.
+static void BM_ScanLoop(benchmark::State& state) {
+  int64_t steps = state.range(0);
+
+  std::string_view hlo = R"(
+    HloModule scan_loop_$steps
+
+    body {
+      p = (s32[], f32[16,256], f32[$steps,16,256], f32[256,256]) parameter(0)
+      i = s32[] get-tuple-element(p), index=0
+      h = f32[16,256] get-tuple-element(p), index=1
+      xs = f32[$steps,16,256] get-tuple-element(p), index=2
+      w = f32[256,256] get-tuple-element(p), index=3
+
+      zero = s32[] constant(0)
+      x_slice = f32[1,16,256] dynamic-slice(xs, i, zero, zero),
+        dynamic_slice_sizes={1,16,256}
+      x = f32[16,256] reshape(x_slice)
+      hw = f32[16,256] dot(h, w),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+      sum = f32[16,256] add(hw, x)
+      h_next = f32[16,256] tanh(sum)
+
+      one = s32[] constant(1)
+      i_next = s32[] add(i, one)
+      ROOT tuple = (s32[], f32[16,256], f32[$steps,16,256], f32[256,256])
+        tuple(i_next, h_next, xs, w)
+    }
+
+    cond {
+      p = (s32[], f32[16,256], f32[$steps,16,256], f32[256,256]) parameter(0)
+      i = s32[] get-tuple-element(p), index=0
+      n = s32[] constant($steps)
+      ROOT lt = pred[] compare(i, n), direction=LT
+    }
+
+    ENTRY e {
+      h0 = f32[16,256] parameter(0)
+      xs = f32[$steps,16,256] parameter(1)
+      w = f32[256,256] parameter(2)
+
+      zero = s32[] constant(0)
+      init = (s32[], f32[16,256], f32[$steps,16,256], f32[256,256])
+        tuple(zero, h0, xs, w)
+      loop = (s32[], f32[16,256], f32[$steps,16,256], f32[256,256])
+        while(init), condition=cond, body=body
+      ROOT out = f32[16,256] get-tuple-element(loop), index=1
+    }
+  )";
+
+  std::minstd_rand0 engine;
+
+  auto h0 = RandomLiteral(ShapeUtil::MakeShape(F32, {16, 256}), &engine);
+  auto xs = RandomLiteral(ShapeUtil::MakeShape(F32, {steps, 16, 256}), &engine);
+  auto w = RandomLiteral(ShapeUtil::MakeShape(F32, {256, 256}), &engine);
+
+  std::vector<const Literal*> args = {&h0, &xs, &w};
+  CHECK_OK(RunHloBenchmark(state, hlo, args,
+                           {{"$steps", absl::StrCat(steps)}}));
+}
+
+BENCHMARK(BM_TransformerBlock)
+    ->MeasureProcessCPUTime()
+    ->Arg(1)
+    ->Arg(8)
+    ->Arg(32);
+
+BENCHMARK(BM_MixtureOfExperts)
+    ->MeasureProcessCPUTime()
+    ->Arg(128)
+    ->Arg(1024)
+    ->Arg(4096);
+
+BENCHMARK(BM_ConvNet)
+    ->MeasureProcessCPUTime()
+    ->Arg(1)
+    ->Arg(8)
+    ->Arg(32);
+
+BENCHMARK(BM_ScanLoop)
+    ->MeasureProcessCPUTime()
+    ->Arg(16)
+    ->Arg(128)
+    ->Arg(1024);
+
+}  // namespace xla::cpu
@@ -95,7 +95,10 @@ static void BM_TopK_BF16(benchmark::State& state) {
       ->Args({16, 64, 16})                 \
       ->Args({64, 4, 64})                  \
       ->Args({64, 16, 64})                 \
-      ->Args({64, 64, 64})
+      ->Args({64, 64, 64})                 \
+      ->Args({1, 256, 16384})              \
+      ->Args({16, 256, 16384})             \
+      ->Args({64, 256, 16384})
 
 BENCHMARK_TOPK(BM_TopKCustomCall_F32);
 BENCHMARK_TOPK(BM_TopK_BF16);
@@ -37,7 +37,9 @@ absl::StatusOr<bool> ConvCanonicalization::Run(
        module->entry_computation()->MakeInstructionPostOrder()) {
     if (hlo->opcode() == HloOpcode::kConvolution &&
         !PotentiallyImplementedAsEigenConvolution(*hlo,
-                                                  target_machine_features_)) {
+                                                  target_machine_features_) &&
+        !PotentiallyImplementedAsInt8Convolution(*hlo,
+                                                 target_machine_features_)) {
       const ConvolutionDimensionNumbers& dnums =
           hlo->convolution_dimension_numbers();
       auto input_batch_dim = dnums.input_batch_dimension();
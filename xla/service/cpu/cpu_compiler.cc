@@ -121,10 +121,13 @@ limitations under the License.
 #include "xla/service/cpu/cpu_instruction_fusion.h"
 #include "xla/service/cpu/cpu_layout_assignment.h"
 #include "xla/service/cpu/cpu_options.h"
+#include "xla/service/cpu/dot_epilogue_fusion.h"
 #include "xla/service/cpu/dot_op_emitter.h"
 #include "xla/service/cpu/executable.pb.h"
+#include "xla/service/cpu/ir_emission_utils.h"
 #include "xla/service/cpu/ir_emitter.h"
 #include "xla/service/cpu/ir_emitter2.h"
+#include "xla/service/cpu/jit_compilation_cache.h"
 #include "xla/service/cpu/parallel_task_assignment.h"
 #include "xla/service/cpu/simple_orc_jit.h"
 #include "xla/service/cpu/target_machine_features.h"
@@ -471,6 +474,47 @@ void AddHloVerifier(HloPassPipeline* pipeline, HloVerifierOpts&& opts = {},
   }
 }
 
+// Expands scatters into while loops, except for the scatters implemented by
+// ScatterThunk when compiling for the thunk runtime.
+class CpuScatterExpander : public ScatterExpander {
+ public:
+  explicit CpuScatterExpander(bool is_thunk_runtime)
+      : ScatterExpander(kEliminateAllScatters),
+        is_thunk_runtime_(is_thunk_runtime) {}
+
+ protected:
+  bool InstructionMatchesPattern(HloInstruction* inst) override {
+    if (is_thunk_runtime_ && PotentiallyImplementedAsScatterThunk(*inst)) {
+      return false;
+    }
+    return ScatterExpander::InstructionMatchesPattern(inst);
+  }
+
+ private:
+  bool is_thunk_runtime_;
+};
+
+// Expands rng bit generators into HLO computations, except for the ones
+// implemented by RngBitGeneratorThunk when compiling for the thunk runtime.
+class CpuRngBitGeneratorExpander : public RngBitGeneratorExpander {
+ public:
+  explicit CpuRngBitGeneratorExpander(bool is_thunk_runtime)
+      : RngBitGeneratorExpander(RandomAlgorithm::RNG_PHILOX),
+        is_thunk_runtime_(is_thunk_runtime) {}
+
+ protected:
+  bool InstructionMatchesPattern(HloInstruction* inst) override {
+    if (is_thunk_runtime_ &&
+        PotentiallyImplementedAsRngBitGeneratorThunk(*inst)) {
+      return false;
+    }
+    return RngBitGeneratorExpander::InstructionMatchesPattern(inst);
+  }
+
+ private:
+  bool is_thunk_runtime_;
+};
+
 }  // namespace
 
 absl::Status CpuCompiler::RunHloPassesThroughLayoutAssn(
@@ -535,7 +579,8 @@ absl::Status CpuCompiler::RunHloPassesThroughLayoutAssn(
   // Expand random number generation.
   pipeline.AddPass<RngExpander>();
   if (!is_mlir_compile) {
-    pipeline.AddPass<RngBitGeneratorExpander>(RandomAlgorithm::RNG_PHILOX);
+    pipeline.AddPass<CpuRngBitGeneratorExpander>(
+        debug_options.xla_cpu_use_thunk_runtime());
   }
 
   // Remove zero-sized HLO from the input so that other passes don't have to
@@ -643,8 +688,14 @@ absl::Status CpuCompiler::RunHloPassesThroughLayoutAssn(
   pipeline.AddPass<DynamicDimensionSimplifier>();
 
   if (debug_options.xla_reduce_window_rewrite_base_length() != 0) {
+    // Scans are implemented natively by the thunk runtime in linear time, and
+    // don't need to be rewritten into tree reductions.
+    bool use_thunk_runtime = debug_options.xla_cpu_use_thunk_runtime();
     pipeline.AddPass<HloPassFix<ReduceWindowRewriter>>(
-        debug_options.xla_reduce_window_rewrite_base_length());
+        debug_options.xla_reduce_window_rewrite_base_length(),
+        [use_thunk_runtime](const HloInstruction* instr) {
+          return use_thunk_runtime && PotentiallyImplementedAsScanThunk(*instr);
+        });
   }
 
   auto dynamic_padder_options = DynamicPadderOptions();
@@ -660,7 +711,8 @@ absl::Status CpuCompiler::RunHloPassesThroughLayoutAssn(
   pipeline.AddPass<DynamicPadder>(dynamic_padder_options);
   if (!is_mlir_compile) {
     pipeline.AddPass<SelectAndScatterExpander>();
-    pipeline.AddPass<ScatterExpander>(ScatterExpander::kEliminateAllScatters);
+    pipeline.AddPass<CpuScatterExpander>(
+        debug_options.xla_cpu_use_thunk_runtime());
   }
   pipeline.AddPass<ConvCanonicalization>(target_machine_features);
 
@@ -821,6 +873,12 @@ absl::Status CpuCompiler::RunHloPassesAfterLayoutAssn(
   }
 #endif  // INTEL_MKL && ENABLE_ONEDNN_V3
 
+  // Fuse elementwise epilogues into dots before the generic fusion pass picks
+  // them up as separate loop fusions.
+  if (is_thunk_runtime) {
+    pipeline.AddPass<DotEpilogueFusion>();
+  }
+
   // Add a fusion pass now that layout assignment is done.
   pipeline.AddPass<CpuInstructionFusion>();
 
@@ -1359,7 +1417,8 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
       llvm_ir::GetCpuFastMathFlags(module->config()), pre_optimization_ir_hook,
       post_optimization_ir_hook,
       CreateOrcJITPostCompilationHook(module.get(), &obj_files),
-      parallel_codegen_split_count, debug_options.xla_cpu_max_isa());
+      parallel_codegen_split_count, debug_options.xla_cpu_max_isa(),
+      debug_options.xla_cpu_huge_page_min_bytes());
   if (!jit) {
     return Internal("Creating JIT failed: %s", llvm::toString(jit.takeError()));
   }
@@ -1699,6 +1758,18 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
   return with_hlo_proto(std::move(cpu_executable));
 }
 
+// Returns true if compilation results for the module can be loaded from and
+// stored into the persistent JIT compilation cache. Exported executables do
+// not preserve profiling metadata and embedded IR, and user-provided LLVM IR
+// hooks expect to observe the module, so we skip the cache in these cases.
+static bool UseJitCompilationCache(const HloModule& module,
+                                   bool has_user_hooks) {
+  const DebugOptions& debug_options = module.config().debug_options();
+  return !debug_options.xla_cpu_jit_cache_dir().empty() && !has_user_hooks &&
+         !module.config().hlo_profiling_enabled() &&
+         !debug_options.xla_embed_ir_in_executable();
+}
+
 absl::StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
     std::unique_ptr<HloModule> module,
     [[maybe_unused]] se::StreamExecutor* stream_exec,
@@ -1713,12 +1784,65 @@ absl::StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   absl::call_once(llvm_command_line_options_initialized,
                   &InitializeLLVMCommandLineOptions, module->config());
 
+  // Try to load a compiled executable from the persistent compilation cache.
+  // Failures to read from the cache are not fatal, and we fall back to
+  // compiling the module.
+  std::optional<JitCompilationCache> cache;
+  std::string cache_key;
+  if (UseJitCompilationCache(*module, user_pre_optimization_hook_ ||
+                                          user_post_optimization_hook_)) {
+    cache.emplace(module->config().debug_options().xla_cpu_jit_cache_dir());
+    cache_key = JitCompilationCache::GetCacheKey(*module);
+
+    auto load_from_cache =
+        [&]() -> absl::StatusOr<std::unique_ptr<Executable>> {
+      TF_ASSIGN_OR_RETURN(std::optional<std::string> serialized,
+                          cache->Lookup(cache_key));
+      if (!serialized.has_value()) return std::unique_ptr<Executable>();
+      TF_ASSIGN_OR_RETURN(std::unique_ptr<AotCompilationResult> result,
+                          LoadAotCompilationResult(*serialized));
+      return result->LoadExecutable(this, stream_exec);
+    };
+
+    absl::StatusOr<std::unique_ptr<Executable>> cached = load_from_cache();
+    if (cached.ok() && *cached != nullptr) {
+      auto* cpu_executable =
+          tensorflow::down_cast<CpuExecutable*>(cached->get());
+      cpu_executable->set_debug_info(
+          cpu_executable->buffer_assignment().GetStats().ToString());
+      VLOG(1) << "Loaded compiled module " << module->name()
+              << " from the JIT compilation cache; key=" << cache_key;
+      return std::move(*cached);
+    }
+    if (!cached.ok()) {
+      LOG(WARNING) << "Failed to load compiled module " << module->name()
+                   << " from the JIT compilation cache: " << cached.status();
+    }
+  }
+
   std::unique_ptr<CpuExecutable> cpu_executable;
   TF_ASSIGN_OR_RETURN(cpu_executable,
                       CompileLegacyCpuExecutable(std::move(module)));
 
   cpu_executable->set_debug_info(
       cpu_executable->buffer_assignment().GetStats().ToString());
+
+  // Store compilation result into the persistent compilation cache. Failures
+  // to write to the cache are not fatal.
+  if (cache.has_value()) {
+    auto store_to_cache = [&]() -> absl::Status {
+      TF_ASSIGN_OR_RETURN(std::unique_ptr<AotCompilationResult> result,
+                          Export(cpu_executable.get()));
+      TF_ASSIGN_OR_RETURN(std::string serialized, result->SerializeAsString());
+      return cache->Insert(cache_key, serialized);
+    };
+    if (absl::Status status = store_to_cache(); !status.ok()) {
+      LOG(WARNING) << "Failed to store compiled module "
+                   << cpu_executable->module_name()
+                   << " to the JIT compilation cache: " << status;
+    }
+  }
+
   VLOG(1) << "Compilation finished";
   return std::unique_ptr<Executable>(std::move(cpu_executable));
 }
@@ -1992,6 +2116,8 @@ class CpuExecutableAotCompilationResult : public AotCompilationResult {
     }
     proto_.set_obj_files_kind(obj_file_kind);
     module_ = hlo_module->Clone();
+    // The module is already known, so the lazy creation is a no-op.
+    absl::call_once(module_once_, [] {});
   }
 
   absl::StatusOr<std::string> SerializeAsString() const override {
@@ -2006,30 +2132,52 @@ class CpuExecutableAotCompilationResult : public AotCompilationResult {
           "Failed to parse serialized CpuExecutableAotCompilationResult.");
     }
 
-    TF_ASSIGN_OR_RETURN(
-        std::unique_ptr<HloModule> module,
-        HloModule::CreateFromProtoWithConfig(proto.hlo_module()));
-
+    // The optimized module is not needed to load the executable, which builds
+    // its own module from the proto, so it's only created when asked for.
     return std::unique_ptr<CpuExecutableAotCompilationResult>(
-        new CpuExecutableAotCompilationResult(proto, std::move(module)));
+        new CpuExecutableAotCompilationResult(std::move(proto)));
   }
 
   absl::StatusOr<std::unique_ptr<Executable>> LoadExecutable(
       Compiler* compiler, const se::StreamExecutor* stream_exec) const override;
 
-  const HloModule* optimized_module() const override { return module_.get(); }
+  const HloModule* optimized_module() const override {
+    if (absl::Status status = MaybeCreateOptimizedModule(); !status.ok()) {
+      LOG(ERROR) << "Failed to create optimized module: " << status;
+    }
+    return module_.get();
+  }
 
   std::unique_ptr<HloModule> consume_optimized_module() override {
+    if (absl::Status status = MaybeCreateOptimizedModule(); !status.ok()) {
+      LOG(ERROR) << "Failed to create optimized module: " << status;
+    }
     return std::move(module_);
   }
 
  private:
-  explicit CpuExecutableAotCompilationResult(CompilationResultProto proto,
-                                             std::unique_ptr<HloModule> module)
-      : proto_(std::move(proto)), module_(std::move(module)) {}
+  explicit CpuExecutableAotCompilationResult(CompilationResultProto proto)
+      : proto_(std::move(proto)) {}
+
+  // Creates the optimized module from the proto on the first call and returns
+  // the result of that parse on every call. Safe to call concurrently.
+  absl::Status MaybeCreateOptimizedModule() const {
+    absl::call_once(module_once_, [this] {
+      absl::StatusOr<std::unique_ptr<HloModule>> module =
+          HloModule::CreateFromProtoWithConfig(proto_.hlo_module());
+      if (!module.ok()) {
+        module_status_ = module.status();
+        return;
+      }
+      module_ = *std::move(module);
+    });
+    return module_status_;
+  }
 
   CompilationResultProto proto_;
-  std::unique_ptr<HloModule> module_;
+  mutable absl::once_flag module_once_;
+  mutable absl::Status module_status_;
+  mutable std::unique_ptr<HloModule> module_;
 };
 
 }  // namespace
@@ -2062,7 +2210,8 @@ CpuExecutableAotCompilationResult::LoadExecutable(
       llvm_ir::GetCpuFastMathFlags(module->config()),
       /*pre_optimization_hook=*/nullptr, /*post_optimization_hook=*/nullptr,
       /*post_codegen_hook=*/nullptr, /*num_jit_dylibs=*/1,
-      debug_options.xla_cpu_max_isa());
+      debug_options.xla_cpu_max_isa(),
+      debug_options.xla_cpu_huge_page_min_bytes());
   if (!jit) {
     return Internal("Creating JIT failed: %s", llvm::toString(jit.takeError()));
   }
@@ -2165,11 +2314,11 @@ CpuExecutableAotCompilationResult::LoadExecutable(
   }
 
   // Dump computation proto state and buffer assignment for
-  // GetCompiledMemoryStats results.
+  // GetCompiledMemoryStats results. The executable was loaded from exactly
+  // these protos, so copy them instead of serializing the module again.
   auto hlo_proto = std::make_unique<HloProto>();
-  *hlo_proto->mutable_hlo_module() = cpu_executable->module().ToProto();
-  *hlo_proto->mutable_buffer_assignment() =
-      cpu_executable->buffer_assignment().ToProto();
+  *hlo_proto->mutable_hlo_module() = proto_.hlo_module().hlo_module();
+  *hlo_proto->mutable_buffer_assignment() = proto_.buffer_assignment();
   cpu_executable->set_hlo_proto(std::move(hlo_proto));
 
   return cpu_executable;
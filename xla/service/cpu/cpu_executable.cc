@@ -20,6 +20,7 @@ limitations under the License.
 #include <stdint.h>
 
 #include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <memory>
 #include <optional>
@@ -42,8 +43,10 @@ limitations under the License.
 #include "llvm/IR/Mangler.h"
 #include "llvm/Support/Error.h"
 #include "xla/backends/cpu/runtime/buffer_allocations.h"
+#include "xla/backends/cpu/runtime/first_touch.h"
 #include "xla/backends/cpu/runtime/thunk.h"
 #include "xla/backends/cpu/runtime/thunk_executor.h"
+#include "xla/backends/cpu/runtime/thunk_executor_stats.h"
 #include "xla/executable_run_options.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_input_output_alias_config.h"
@@ -51,6 +54,8 @@ limitations under the License.
 #include "xla/literal.h"
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/cpu/cpu_runtime.h"
+#include "xla/service/cpu/executable.pb.h"
+#include "xla/service/cpu/huge_pages.h"
 #include "xla/service/cpu/simple_orc_jit.h"
 #include "xla/service/custom_call_status.h"
 #include "xla/service/custom_call_status_internal.h"
@@ -186,8 +191,45 @@ absl::StatusOr<std::unique_ptr<CpuExecutable>> CpuExecutable::Create(
   executable->jit_->DoneCompiling();
   executable->function_registry_ = FunctionRegistry(executable->jit_.get());
 
-  TF_ASSIGN_OR_RETURN(executable->thunks_,
-                      ThunkExecutor::Create(std::move(thunks)));
+  const DebugOptions& debug_options =
+      executable->module().config().debug_options();
+
+  ThunkExecutor::Options thunk_executor_options;
+  thunk_executor_options.collect_stats =
+      debug_options.xla_cpu_enable_thunk_stats();
+
+  TF_ASSIGN_OR_RETURN(
+      executable->thunks_,
+      ThunkExecutor::Create(std::move(thunks), thunk_executor_options));
+
+  // Find large temporary allocations that we touch from the intra-op thread
+  // pool before execution to spread their pages across NUMA nodes.
+  int64_t first_touch_min_bytes =
+      debug_options.xla_cpu_parallel_first_touch_min_bytes();
+  if (first_touch_min_bytes > 0) {
+    for (const BufferAllocation& allocation :
+         executable->assignment_->Allocations()) {
+      if (allocation.is_entry_computation_parameter() ||
+          allocation.is_constant() || allocation.is_thread_local() ||
+          allocation.maybe_live_out() ||
+          allocation.size() < first_touch_min_bytes) {
+        continue;
+      }
+      executable->first_touch_allocations_.push_back(allocation.index());
+    }
+  }
+
+  // Constants are already populated, so their pages can only be collapsed into
+  // huge pages in the background by the kernel.
+  int64_t huge_page_min_bytes = debug_options.xla_cpu_huge_page_min_bytes();
+  if (huge_page_min_bytes > 0) {
+    for (const ConstantAllocation& constant : constants) {
+      se::DeviceMemoryBase data = constant.AsDeviceMemoryBase();
+      if (data.size() >= huge_page_min_bytes) {
+        AdviseHugePages(data.opaque(), data.size());
+      }
+    }
+  }
 
   // Re-index constants by their allocation index to allow efficient lookup.
   for (auto& constant : constants) {
@@ -224,7 +266,8 @@ static absl::StatusOr<MaybeOwningDeviceMemory> MemoryForAllocation(
     const BufferAllocation& allocation,
     absl::Span<const ExecutionInput> arguments,
     absl::Span<const ConstantAllocation> constants,
-    se::DeviceMemoryAllocator* memory_allocator, int device_ordinal) {
+    se::DeviceMemoryAllocator* memory_allocator, int device_ordinal,
+    int64_t huge_page_min_bytes) {
   VLOG(3) << allocation.ToString();
   if (allocation.is_entry_computation_parameter()) {
     se::DeviceMemoryBase out = arguments[allocation.parameter_number()]
@@ -253,6 +296,12 @@ static absl::StatusOr<MaybeOwningDeviceMemory> MemoryForAllocation(
   VLOG(3) << "buffer allocated " << buffer_size << " bytes [" << out->opaque()
           << "]";
 
+  // Advise huge pages before the buffer is touched, so that it is faulted in
+  // with huge pages right away.
+  if (huge_page_min_bytes > 0 && buffer_size >= huge_page_min_bytes) {
+    AdviseHugePages(out->opaque(), buffer_size);
+  }
+
   // Since the output buffer and all the temporary buffers were written into
   // by the JITed code, memory sanitizer has no way of knowing their memory was
   // initialized. Mark them initialized so that memory sanitizer doesn't flag
@@ -269,12 +318,15 @@ CpuExecutable::CreateBufferTable(se::DeviceMemoryAllocator* memory_allocator,
       assignment_->Allocations().size());
   VLOG(3) << "Allocating " << assignment_->Allocations().size()
           << " allocations for module " << module().name();
+  int64_t huge_page_min_bytes =
+      module().config().debug_options().xla_cpu_huge_page_min_bytes();
   for (BufferAllocation::Index i = 0; i < assignment_->Allocations().size();
        ++i) {
     const BufferAllocation& allocation = assignment_->GetAllocation(i);
-    TF_ASSIGN_OR_RETURN(buffers[i],
-                        MemoryForAllocation(allocation, arguments, constants_,
-                                            memory_allocator, device_ordinal));
+    TF_ASSIGN_OR_RETURN(
+        buffers[i],
+        MemoryForAllocation(allocation, arguments, constants_, memory_allocator,
+                            device_ordinal, huge_page_min_bytes));
   }
 
   if (VLOG_IS_ON(3)) {
@@ -393,6 +445,17 @@ absl::Status CpuExecutable::ExecuteThunks(
     run_options->intra_op_thread_pool()->getPool()->Schedule(std::move(task));
   };
 
+  // Temporary buffers are freshly allocated for every execution, and don't
+  // have any live data that we could clobber.
+  if (!first_touch_allocations_.empty()) {
+    std::vector<se::DeviceMemoryBase> first_touch_buffers;
+    first_touch_buffers.reserve(first_touch_allocations_.size());
+    for (BufferAllocation::Index index : first_touch_allocations_) {
+      first_touch_buffers.push_back(buffers[index].AsDeviceMemoryBase());
+    }
+    FirstTouchBuffers(first_touch_buffers, run_options->intra_op_thread_pool());
+  }
+
   Thunk::ExecuteParams execute_params = {
       &*function_registry_,
       &allocations,
@@ -422,6 +485,42 @@ absl::Status CpuExecutable::ExecuteThunks(
              : absl::OkStatus();
 }
 
+static void ToProto(const ThunkExecutorStats::HistogramSnapshot& histogram,
+                    ThunkExecutionStatsProto::Histogram* proto) {
+  proto->set_count(histogram.count);
+  proto->set_sum_ns(histogram.sum_ns);
+  proto->set_max_ns(histogram.max_ns);
+  proto->mutable_buckets()->Add(histogram.buckets.begin(),
+                                histogram.buckets.end());
+}
+
+std::optional<ThunkExecutionStatsProto> CpuExecutable::GetThunkExecutionStats()
+    const {
+  if (!thunks_.has_value() || thunks_->stats() == nullptr) return std::nullopt;
+
+  ThunkExecutorStats::Snapshot snapshot = thunks_->stats()->GetSnapshot();
+  const ThunkSequence& thunk_sequence = thunks_->thunk_sequence();
+
+  ThunkExecutionStatsProto proto;
+  for (size_t i = 0; i < snapshot.thunks.size(); ++i) {
+    const Thunk& thunk = *thunk_sequence[i];
+    ThunkExecutionStatsProto::Thunk* thunk_proto = proto.add_thunks();
+    thunk_proto->set_index(i);
+    thunk_proto->set_kind(std::string(Thunk::KindToString(thunk.kind())));
+    thunk_proto->set_op_name(thunk.info().op_name);
+    ToProto(snapshot.thunks[i].wall_time, thunk_proto->mutable_wall_time());
+    ToProto(snapshot.thunks[i].queue_delay, thunk_proto->mutable_queue_delay());
+  }
+
+  for (const ThunkExecutorStats::WorkerSnapshot& worker : snapshot.workers) {
+    ThunkExecutionStatsProto::Worker* worker_proto = proto.add_workers();
+    worker_proto->set_worker_id(worker.worker_id);
+    ToProto(worker.wall_time, worker_proto->mutable_wall_time());
+  }
+
+  return proto;
+}
+
 absl::StatusOr<ExecutionOutput> CpuExecutable::CreateResultShapedBuffer(
     const ServiceExecutableRunOptions* run_options,
     absl::Span<MaybeOwningDeviceMemory> buffers,
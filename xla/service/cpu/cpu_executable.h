@@ -35,6 +35,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/literal.h"
 #include "xla/service/buffer_assignment.h"
+#include "xla/service/cpu/executable.pb.h"
 #include "xla/service/cpu/simple_orc_jit.h"
 #include "xla/service/custom_call_status.h"
 #include "xla/service/custom_call_status_internal.h"
@@ -133,6 +134,11 @@ class CpuExecutable : public Executable {
   bool has_thunks() const { return thunks_.has_value(); }
   ThunkExecutor& thunks() { return *thunks_; }
 
+  // Returns a summary of the thunk execution statistics collected so far, or
+  // std::nullopt if the executable was compiled without thunks or without
+  // `xla_cpu_enable_thunk_stats`.
+  std::optional<ThunkExecutionStatsProto> GetThunkExecutionStats() const;
+
   const BufferAssignment& buffer_assignment() const { return *assignment_; }
   absl::Span<const ConstantAllocation> constants() const { return constants_; }
 
@@ -228,6 +234,9 @@ class CpuExecutable : public Executable {
 
   // A thunk executor created from the compiled thunk sequence.
   std::optional<ThunkExecutor> thunks_;
+  // Temporary allocations touched from the intra-op thread pool before thunk
+  // execution (see `xla_cpu_parallel_first_touch_min_bytes`).
+  std::vector<BufferAllocation::Index> first_touch_allocations_;
   // Vector indexed by BufferAllocation::Index for efficient access.
   std::vector<ConstantAllocation> constants_;
   // On-demand JIT compiler for functions required by thunks.
@@ -110,12 +110,20 @@ static bool OperandsAndResultMustHaveRowMajorLayout(
     const TargetMachineFeatures& target_machine_features) {
   if (instr.opcode() == HloOpcode::kConvolution) {
     return PotentiallyImplementedAsEigenConvolution(instr,
-                                                    target_machine_features);
+                                                    target_machine_features) ||
+           PotentiallyImplementedAsInt8Convolution(instr,
+                                                   target_machine_features);
   } else if (instr.opcode() == HloOpcode::kDot) {
     return DotOperandsAndResultMustHaveRowMajorLayout(instr,
                                                       target_machine_features);
   } else if (instr.opcode() == HloOpcode::kCustomCall) {
     return instr.custom_call_target() == "TopK";
+  } else if (instr.opcode() == HloOpcode::kScatter) {
+    return PotentiallyImplementedAsScatterThunk(instr);
+  } else if (instr.opcode() == HloOpcode::kReduceWindow) {
+    return PotentiallyImplementedAsScanThunk(instr);
+  } else if (instr.opcode() == HloOpcode::kRngBitGenerator) {
+    return PotentiallyImplementedAsRngBitGeneratorThunk(instr);
   }
   return false;
 }
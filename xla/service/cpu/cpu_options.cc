@@ -25,6 +25,8 @@ const char* const kLlvmIrDotTilingFactor = "xla_llvm_dot_tiling_factor";
 const char* const kXlaForceEnableExperimentalLlvmIrGemm =
     "xla_force_enable_experimental_llvm_ir_gemm";
 const char* const kLlvmIrGemmTileSize = "xla_llvm_ir_gemm_tile_size";
+const char* const kLlvmIrGemmMaxParallelism =
+    "xla_llvm_ir_gemm_max_parallelism";
 const char* const kDisableSlpVectorizer = "xla_cpu_disable_slp_vectorizer";
 
 }  // namespace
@@ -105,6 +107,18 @@ std::optional<std::tuple<int64_t, int64_t, int64_t>> LlvmIrGemmTileSize(
                                                tile_size_n_in_vector_width);
 }
 
+std::optional<int64_t> LlvmIrGemmMaxParallelism(const HloModuleConfig& config) {
+  const auto& extra_options_map =
+      config.debug_options().xla_backend_extra_options();
+  auto it = extra_options_map.find(kLlvmIrGemmMaxParallelism);
+  int64_t max_parallelism;
+  if (it != extra_options_map.end() &&
+      absl::SimpleAtoi(it->second, &max_parallelism)) {
+    return max_parallelism;
+  }
+  return std::nullopt;
+}
+
 }  // namespace options
 }  // namespace cpu
 }  // namespace xla
@@ -33,6 +33,9 @@ bool ForceEnableExperimentalLlvmIrGemm(const HloModuleConfig& config);
 std::optional<int64_t> LlvmIrGemvTilingFactor(const HloModuleConfig& config);
 std::optional<std::tuple<int64_t, int64_t, int64_t>> LlvmIrGemmTileSize(
     const HloModuleConfig& config);
+// Maximum number of tasks a tiled LLVM IR GEMM is split into along the M
+// dimension when running with the thunk runtime.
+std::optional<int64_t> LlvmIrGemmMaxParallelism(const HloModuleConfig& config);
 
 }  // namespace options
 }  // namespace cpu
@@ -57,6 +57,24 @@ class CpuInfeedBuffer : public cpu::runtime::XfeedBuffer {
   char* buffer_;
 };
 
+// Infeed buffer that points into a literal owned by the infeed queue. The
+// literal is released once all of its buffers have been consumed.
+class CpuOwnedInfeedBuffer : public cpu::runtime::XfeedBuffer {
+ public:
+  CpuOwnedInfeedBuffer(std::shared_ptr<Literal> literal, void* data,
+                       int32_t length)
+      : literal_(std::move(literal)), data_(data), length_(length) {}
+
+  int32_t length() override { return length_; }
+  void* data() override { return data_; }
+  void Done(absl::StatusOr<Shape> /*shape*/) override { delete this; }
+
+ private:
+  std::shared_ptr<Literal> literal_;
+  void* data_;
+  int32_t length_;
+};
+
 class CpuOutfeedBuffer : public cpu::runtime::XfeedBuffer {
  public:
   CpuOutfeedBuffer(void* destination, int32_t length)
@@ -83,8 +101,7 @@ class CpuOutfeedBuffer : public cpu::runtime::XfeedBuffer {
 
 // Transfers infeed data to device. InfeedBuffer->Done() must be called to
 // clean up the memory allocated for InfeedBuffer.
-absl::StatusOr<cpu::runtime::XfeedBuffer*> TransferBufferToInfeedInternal(
-    int64_t size, const void* source) {
+absl::Status CheckInfeedBufferSize(int64_t size) {
   if (size > std::numeric_limits<int32_t>::max()) {
     return InvalidArgument("CPU infeed of %d bytes exceeds maximum of %d bytes",
                            size, std::numeric_limits<int32_t>::max());
@@ -94,6 +111,12 @@ absl::StatusOr<cpu::runtime::XfeedBuffer*> TransferBufferToInfeedInternal(
     return InvalidArgument("Infeed shape must have positive size; got %d",
                            size);
   }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<cpu::runtime::XfeedBuffer*> TransferBufferToInfeedInternal(
+    int64_t size, const void* source) {
+  TF_RETURN_IF_ERROR(CheckInfeedBufferSize(size));
 
   auto size_32 = static_cast<int32_t>(size);
   auto queued_buffer = new CpuInfeedBuffer(size_32);
@@ -221,6 +244,51 @@ absl::Status TransferLiteralToInfeedOnCpu(int device_ordinal,
   return absl::OkStatus();
 }
 
+absl::Status TransferOwnedLiteralToInfeedOnCpu(int device_ordinal,
+                                               Literal literal) {
+  VLOG(2) << "Transferring owned literal to infeed with shape: "
+          << ShapeUtil::HumanString(literal.shape());
+
+  if (ShapeUtil::IsNestedTuple(literal.shape())) {
+    return Unimplemented(
+        "Infeed with a nested tuple shape is not supported: %s",
+        ShapeUtil::HumanString(literal.shape()));
+  }
+
+  // Collect the (index, size) of every array buffer before the literal is
+  // moved into shared ownership of the enqueued buffers.
+  std::vector<std::pair<ShapeIndex, int64_t>> elements;
+  if (literal.shape().IsTuple()) {
+    for (int64_t i = 0; i < ShapeUtil::TupleElementCount(literal.shape());
+         ++i) {
+      elements.push_back(
+          {{i}, cpu::runtime::GetByteSizeRequirement(
+                    ShapeUtil::GetSubshape(literal.shape(), {i}),
+                    sizeof(void*))});
+    }
+  } else {
+    elements.push_back({{}, cpu::runtime::GetByteSizeRequirement(
+                                literal.shape(), sizeof(void*))});
+  }
+  for (const auto& element : elements) {
+    TF_RETURN_IF_ERROR(CheckInfeedBufferSize(element.second));
+  }
+
+  auto owned_literal = std::make_shared<Literal>(std::move(literal));
+  std::vector<cpu::runtime::XfeedBuffer*> buffers;
+  buffers.reserve(elements.size());
+  for (const auto& [index, size] : elements) {
+    buffers.push_back(new CpuOwnedInfeedBuffer(
+        owned_literal, owned_literal->untyped_data(index),
+        static_cast<int32_t>(size)));
+  }
+
+  cpu::runtime::XfeedManager* xfeed_manager =
+      cpu::runtime::GetXfeedManager(device_ordinal);
+  xfeed_manager->infeed()->EnqueueBuffersAtomically(buffers);
+  return absl::OkStatus();
+}
+
 absl::Status TransferLiteralFromOutfeedOnCpu(int device_ordinal,
                                              MutableBorrowingLiteral literal) {
   if (!literal.shape().IsTuple()) {
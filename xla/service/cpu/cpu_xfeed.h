@@ -33,7 +33,14 @@ namespace xla {
 absl::Status TransferLiteralToInfeedOnCpu(int device_ordinal,
                                           const LiteralSlice& literal);
 
-// Helper function to transfers from outfeed on CPU.
+// Helper function to transfers to infeed on CPU without copying: the infeed
+// queue takes ownership of `literal` and the program reads its buffers
+// directly. The literal is destroyed once all of its buffers are consumed.
+absl::Status TransferOwnedLiteralToInfeedOnCpu(int device_ordinal,
+                                               Literal literal);
+
+// Helper function to transfers from outfeed on CPU. The outfed data is written
+// directly into the buffers borrowed by `literal`.
 absl::Status TransferLiteralFromOutfeedOnCpu(int device_ordinal,
                                              MutableBorrowingLiteral literal);
 
@@ -0,0 +1,185 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/dot_epilogue_fusion.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/layout_util.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/logging.h"
+
+namespace xla::cpu {
+namespace {
+
+bool IsEpilogueDot(const HloInstruction* dot) {
+  if (dot->opcode() != HloOpcode::kDot) return false;
+
+  const Shape& shape = dot->shape();
+  const DotDimensionNumbers& dnums = dot->dot_dimension_numbers();
+  return shape.element_type() == F32 && shape.rank() == 2 &&
+         LayoutUtil::IsMonotonicWithDim0Major(shape.layout()) &&
+         dnums.lhs_batch_dimensions_size() == 0 &&
+         dnums.lhs_contracting_dimensions_size() == 1 &&
+         dnums.rhs_contracting_dimensions_size() == 1;
+}
+
+bool IsUnaryEpilogueOp(HloOpcode opcode) {
+  return opcode == HloOpcode::kNegate || opcode == HloOpcode::kExp ||
+         opcode == HloOpcode::kTanh;
+}
+
+bool IsBinaryEpilogueOp(HloOpcode opcode) {
+  return opcode == HloOpcode::kAdd || opcode == HloOpcode::kSubtract ||
+         opcode == HloOpcode::kMultiply || opcode == HloOpcode::kDivide ||
+         opcode == HloOpcode::kMaximum || opcode == HloOpcode::kMinimum;
+}
+
+// Returns true if `side` is a broadcast of a scalar, or of a vector along the
+// rows or the columns of the rank 2 `shape`.
+bool IsEpilogueSideInput(const HloInstruction* side, const Shape& shape) {
+  if (side->opcode() != HloOpcode::kBroadcast ||
+      side->operand(0)->shape().element_type() != F32) {
+    return false;
+  }
+  const Shape& operand_shape = side->operand(0)->shape();
+  if (operand_shape.rank() == 0) return true;
+  return operand_shape.rank() == 1 && side->dimensions().size() == 1 &&
+         operand_shape.dimensions(0) == shape.dimensions(side->dimensions(0));
+}
+
+// Returns true if `user` can be applied as the next operation of an epilogue
+// that computes `value`. The `value` must be a single operand of `user`.
+bool IsEpilogueOp(const HloInstruction* user, const HloInstruction* value) {
+  if (!ShapeUtil::Equal(user->shape(), value->shape())) return false;
+  if (absl::c_count(user->operands(), value) != 1) return false;
+
+  if (IsUnaryEpilogueOp(user->opcode())) return true;
+  if (!IsBinaryEpilogueOp(user->opcode())) return false;
+
+  const HloInstruction* side =
+      user->operand(0) == value ? user->operand(1) : user->operand(0);
+  return IsEpilogueSideInput(side, value->shape());
+}
+
+bool HasSingleUser(const HloInstruction* instr) {
+  return instr->user_count() == 1 && !instr->IsRoot();
+}
+
+bool IsQuantizedType(PrimitiveType type) {
+  return type == S4 || type == U4 || type == F8E4M3FN || type == F8E5M2;
+}
+
+// Returns true if the RHS of `dot` is a convert from a quantized type (e.g.
+// weight-only quantized weights), that DotThunk can dequantize on the fly.
+bool HasDequantizingRhs(const HloInstruction* dot) {
+  const HloInstruction* lhs = dot->operand(0);
+  const HloInstruction* rhs = dot->operand(1);
+  if (rhs->opcode() != HloOpcode::kConvert || !HasSingleUser(rhs)) {
+    return false;
+  }
+  const Shape& quantized_shape = rhs->operand(0)->shape();
+  return IsQuantizedType(quantized_shape.element_type()) &&
+         LayoutUtil::IsMonotonicWithDim0Major(quantized_shape.layout()) &&
+         lhs->shape().element_type() == F32 &&
+         dot->dot_dimension_numbers().lhs_contracting_dimensions(0) == 1;
+}
+
+// Fuses the epilogue of `dot` and the dequantization of its RHS into an
+// output fusion. Returns false if `dot` has nothing to fuse.
+bool FuseEpilogue(HloComputation* computation, HloInstruction* dot) {
+  // Consumer chain starting from the dot, in the order of execution.
+  std::vector<HloInstruction*> chain;
+  HloInstruction* value = dot;
+  while (HasSingleUser(value) && IsEpilogueOp(value->users().front(), value)) {
+    value = value->users().front();
+    chain.push_back(value);
+  }
+  bool fuse_rhs = HasDequantizingRhs(dot);
+  if (chain.empty() && !fuse_rhs) return false;
+
+  VLOG(2) << "Fuse " << chain.size() << " epilogue operations into dot "
+          << dot->name() << " (dequantizing RHS: " << fuse_rhs << ")";
+
+  // Instructions to fuse, in the reverse post order expected by
+  // `CreateFusionInstruction`: the chain from its root, the side input
+  // broadcasts, the dot and the RHS convert.
+  std::vector<HloInstruction*> to_fuse(chain.rbegin(), chain.rend());
+  for (HloInstruction* instr : chain) {
+    for (HloInstruction* operand : instr->operands()) {
+      if (operand->opcode() == HloOpcode::kBroadcast &&
+          !absl::c_linear_search(to_fuse, operand)) {
+        to_fuse.push_back(operand);
+      }
+    }
+  }
+  to_fuse.push_back(dot);
+  if (fuse_rhs) to_fuse.push_back(dot->mutable_operand(1));
+
+  computation->CreateFusionInstruction(to_fuse,
+                                       HloInstruction::FusionKind::kOutput);
+  return true;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> DotEpilogueFusion::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  bool changed = false;
+  for (HloComputation* computation :
+       module->MakeNonfusionComputations(execution_threads)) {
+    std::vector<HloInstruction*> dots;
+    for (HloInstruction* instr : computation->instructions()) {
+      if (IsEpilogueDot(instr)) dots.push_back(instr);
+    }
+    for (HloInstruction* dot : dots) {
+      changed |= FuseEpilogue(computation, dot);
+    }
+  }
+  return changed;
+}
+
+const HloInstruction* GetDotEpilogueFusionDot(const HloInstruction& instr) {
+  if (instr.opcode() != HloOpcode::kFusion ||
+      instr.fusion_kind() != HloInstruction::FusionKind::kOutput) {
+    return nullptr;
+  }
+
+  // Output fusions of matrix-vector dots with an addend are created by
+  // CpuInstructionFusion, and have a rank 1 (or scalar) dot. The dot is the
+  // root only if it has no epilogue and a fused RHS convert.
+  const HloInstruction* root = instr.fused_expression_root();
+  for (const HloInstruction* fused : instr.fused_instructions()) {
+    if (!IsEpilogueDot(fused)) continue;
+    if (fused != root || fused->operand(1)->opcode() == HloOpcode::kConvert) {
+      return fused;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace xla::cpu
@@ -0,0 +1,62 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_DOT_EPILOGUE_FUSION_H_
+#define XLA_SERVICE_CPU_DOT_EPILOGUE_FUSION_H_
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/pass/hlo_pass_interface.h"
+
+namespace xla::cpu {
+
+// An HLO pass that fuses a chain of simple elementwise consumers of a dot
+// (e.g. bias-add followed by an activation) into an output fusion with the
+// dot, so that the epilogue is applied to the dot result while it is still in
+// cache instead of running as a separate loop fusion.
+//
+// Only non-batched row-major F32 matrix-matrix dots are fused. Supported
+// epilogue operations are `add`, `subtract`, `multiply`, `divide`, `maximum`
+// and `minimum` with a side input broadcasted from a scalar or from a vector
+// along the rows or columns of the result, and `negate`, `exponential` and
+// `tanh`. The side input broadcasts are fused as well.
+//
+// A convert of the dot RHS from S4, U4, F8E4M3FN or F8E5M2 (e.g. weight-only
+// quantized weights) is fused too, even without an epilogue, so that DotThunk
+// dequantizes the RHS panel by panel instead of materializing it in F32.
+//
+// Both the DotThunk (Eigen) and the LLVM IR dot emitters can execute the
+// fused epilogue, and only DotThunk can execute the fused RHS convert. This
+// pass is only run with the thunk runtime.
+class DotEpilogueFusion : public HloModulePass {
+ public:
+  absl::string_view name() const override { return "dot-epilogue-fusion"; }
+
+  using HloPassInterface::Run;
+  absl::StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+};
+
+// Returns the dot of an output fusion created by `DotEpilogueFusion`, or
+// nullptr if `instr` is not such a fusion.
+const HloInstruction* GetDotEpilogueFusionDot(const HloInstruction& instr);
+
+}  // namespace xla::cpu
+
+#endif  // XLA_SERVICE_CPU_DOT_EPILOGUE_FUSION_H_
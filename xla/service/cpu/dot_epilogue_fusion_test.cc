@@ -0,0 +1,157 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/dot_epilogue_fusion.h"
+
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/hlo/utils/hlo_matchers.h"
+#include "xla/tests/hlo_test_base.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace op = xla::testing::opcode_matchers;
+
+namespace xla::cpu {
+namespace {
+
+using DotEpilogueFusionTest = HloTestBase;
+
+TEST_F(DotEpilogueFusionTest, FusesBiasAddAndRelu) {
+  constexpr absl::string_view kHlo = R"(
+    HloModule m
+
+    ENTRY e {
+      lhs = f32[64,32] parameter(0)
+      rhs = f32[32,16] parameter(1)
+      bias = f32[16] parameter(2)
+      dot = f32[64,16] dot(lhs, rhs),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+      bias.bcast = f32[64,16] broadcast(bias), dimensions={1}
+      add = f32[64,16] add(dot, bias.bcast)
+      zero = f32[] constant(0)
+      zero.bcast = f32[64,16] broadcast(zero), dimensions={}
+      ROOT relu = f32[64,16] maximum(add, zero.bcast)
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, DotEpilogueFusion().Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Fusion());
+  EXPECT_EQ(root->operand_count(), 4);
+  EXPECT_EQ(root->fusion_kind(), HloInstruction::FusionKind::kOutput);
+  EXPECT_THAT(root->fused_expression_root(),
+              op::Maximum(op::Add(op::Dot(), op::Broadcast()),
+                          op::Broadcast()));
+
+  const HloInstruction* dot = GetDotEpilogueFusionDot(*root);
+  ASSERT_NE(dot, nullptr);
+  EXPECT_EQ(dot->opcode(), HloOpcode::kDot);
+}
+
+TEST_F(DotEpilogueFusionTest, StopsAtUnsupportedOperation) {
+  constexpr absl::string_view kHlo = R"(
+    HloModule m
+
+    ENTRY e {
+      lhs = f32[64,32] parameter(0)
+      rhs = f32[32,16] parameter(1)
+      other = f32[64,16] parameter(2)
+      dot = f32[64,16] dot(lhs, rhs),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+      tanh = f32[64,16] tanh(dot)
+      ROOT add = f32[64,16] add(tanh, other)
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, DotEpilogueFusion().Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  // Full-shape side inputs are not fused, only `tanh` is.
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Add(op::Fusion(), op::Parameter(2)));
+  EXPECT_THAT(root->operand(0)->fused_expression_root(), op::Tanh(op::Dot()));
+}
+
+TEST_F(DotEpilogueFusionTest, DoesNotFuseDotWithMultipleUsers) {
+  constexpr absl::string_view kHlo = R"(
+    HloModule m
+
+    ENTRY e {
+      lhs = f32[64,32] parameter(0)
+      rhs = f32[32,16] parameter(1)
+      dot = f32[64,16] dot(lhs, rhs),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+      tanh = f32[64,16] tanh(dot)
+      ROOT tuple = (f32[64,16], f32[64,16]) tuple(dot, tanh)
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, DotEpilogueFusion().Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(DotEpilogueFusionTest, DoesNotFuseBatchDot) {
+  constexpr absl::string_view kHlo = R"(
+    HloModule m
+
+    ENTRY e {
+      lhs = f32[4,64,32] parameter(0)
+      rhs = f32[4,32,16] parameter(1)
+      dot = f32[4,64,16] dot(lhs, rhs), lhs_batch_dims={0},
+        rhs_batch_dims={0}, lhs_contracting_dims={2}, rhs_contracting_dims={1}
+      ROOT tanh = f32[4,64,16] tanh(dot)
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, DotEpilogueFusion().Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(DotEpilogueFusionTest, FusesDequantizingRhsConvert) {
+  constexpr absl::string_view kHlo = R"(
+    HloModule m
+
+    ENTRY e {
+      lhs = f32[1,32] parameter(0)
+      weights = s4[32,16] parameter(1)
+      rhs = f32[32,16] convert(weights)
+      ROOT dot = f32[1,16] dot(lhs, rhs),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, DotEpilogueFusion().Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Fusion(op::Parameter(0), op::Parameter(1)));
+  EXPECT_EQ(root->fusion_kind(), HloInstruction::FusionKind::kOutput);
+  EXPECT_THAT(root->fused_expression_root(),
+              op::Dot(op::Parameter(), op::Convert(op::Parameter())));
+
+  const HloInstruction* dot = GetDotEpilogueFusionDot(*root);
+  ASSERT_NE(dot, nullptr);
+  EXPECT_EQ(dot->opcode(), HloOpcode::kDot);
+}
+
+}  // namespace
+}  // namespace xla::cpu
@@ -120,12 +120,62 @@ bool IsAlignedGemm(const DotInfo& dot_info,
                        dot_info.result_shape, target_machine_features);
 }
 
+std::tuple<int64_t, int64_t, int64_t> GetGemmTileSize(
+    const HloModuleConfig& config) {
+  // Tuned for broadwell - Intel(R) Xeon(R) CPU E5-2690 v4 @ 2.60GHz
+  //
+  // TODO(b/80093688): Tune for other architectures and centralize this
+  // information in one place.
+  const std::tuple<int64_t, int64_t, int64_t> kDefaultTileSize =
+      std::tuple<int64_t, int64_t, int64_t>(11, 9, 1);
+  return options::LlvmIrGemmTileSize(config).value_or(kDefaultTileSize);
+}
+
+// Returns the maximum number of tasks a tiled LLVM IR GEMM can be split into
+// along the M dimension. Partitioned GEMMs are only supported by the thunk
+// runtime, which runs every partition of a host kernel as a separate task.
+int64_t GetGemmMaxParallelism(const HloModuleConfig& config) {
+  if (!config.debug_options().xla_cpu_use_thunk_runtime()) {
+    return 1;
+  }
+  return std::max<int64_t>(
+      1, options::LlvmIrGemmMaxParallelism(config).value_or(1));
+}
+
+// Partitioning of the M dimension of a tiled LLVM IR GEMM. Every partition
+// except the last one has `rows_per_partition` rows, which is a multiple of
+// the M tile size, so that only the last partition handles the residue on M.
+struct GemmRowPartitioning {
+  int64_t rows_per_partition;
+  int64_t num_partitions;
+};
+
+GemmRowPartitioning GetGemmRowPartitioning(const HloModuleConfig& config,
+                                           int64_t m, int64_t k, int64_t n) {
+  // Minimum number of multiply-adds per partition (~10us of work), so that the
+  // cost of scheduling a task is amortized.
+  static constexpr int64_t kMinMulAddsPerPartition = 1 << 18;
+
+  const int64_t max_parallelism = GetGemmMaxParallelism(config);
+  const int64_t tile_size_m = std::get<0>(GetGemmTileSize(config));
+
+  int64_t rows_per_partition = std::max(
+      CeilOfRatio(m, max_parallelism),
+      CeilOfRatio(kMinMulAddsPerPartition, std::max<int64_t>(1, k * n)));
+  rows_per_partition = std::min(m, RoundUpTo(rows_per_partition, tile_size_m));
+  return {rows_per_partition, CeilOfRatio(m, rows_per_partition)};
+}
+
 bool CanEmitTiledLlvmIrGemm(
     const HloModuleConfig& config, const DotInfo& dot_info,
     const TargetMachineFeatures& target_machine_features) {
   CHECK(IsAlignedGemm(dot_info, target_machine_features));
 
-  if (ShouldUseMultiThreadedEigen(config)) {
+  // Medium sized GEMMs are emitted as tiled LLVM IR when they can be split
+  // into multiple tasks along the M dimension.
+  const bool partitioned_gemm = GetGemmMaxParallelism(config) > 1;
+
+  if (ShouldUseMultiThreadedEigen(config) && !partitioned_gemm) {
     return false;
   }
 
@@ -138,7 +188,10 @@ bool CanEmitTiledLlvmIrGemm(
     // TODO(sanjoy):  We should make these numbers micro-arch specific.
     bool small_gemm =
         k <= 128 && ((m <= 32 && n <= 128) || (m <= 128 && n <= 32));
-    if (!small_gemm) {
+    // Larger GEMMs are better handled by Eigen, which does cache blocking on
+    // all dimensions.
+    bool medium_gemm = partitioned_gemm && m <= 1024 && k <= 1024 && n <= 1024;
+    if (!small_gemm && !medium_gemm) {
       return false;
     }
   }
@@ -229,6 +282,10 @@ class DotOpEmitter {
   // Emits the IR to perform the batch dot operation.
   absl::Status EmitBatch();
 
+  // Emits the IR to compute the rows of partition `partition_index` (an i64
+  // value) of a dot operation lowered to a tiled LLVM IR GEMM.
+  absl::Status EmitRowPartition(llvm::Value* partition_index);
+
  private:
   // Emits instructions to perform a scalar dot product (a multiply of the
   // LHS and RHS) and store the results in the target.
@@ -278,8 +335,10 @@ class DotOpEmitter {
   // Lowers the dot operation as a tiled Matrix*Vector loop.
   void EmitTiledLlvmIrGemv();
 
-  // Lowers the dot operation as a tiled Matrix*Matrix loop.
-  void EmitTiledLlvmIrGemm();
+  // Lowers the dot operation as a tiled Matrix*Matrix loop. If
+  // `partition_index` is not null, only the rows of the given partition of
+  // the M dimension are computed.
+  void EmitTiledLlvmIrGemm(llvm::Value* partition_index = nullptr);
 
   // Lowers the dot operation as a naive nested loop that computes the result
   // one element at a time.
@@ -294,14 +353,7 @@ class DotOpEmitter {
   }
 
   std::tuple<int64_t, int64_t, int64_t> GetGemmTileSize() const {
-    // Tuned for broadwell - Intel(R) Xeon(R) CPU E5-2690 v4 @ 2.60GHz
-    //
-    // TODO(b/80093688): Tune for other architectures and centralize this
-    // information in one place.
-    const std::tuple<int64_t, int64_t, int64_t> kDefaultTileSize =
-        std::tuple<int64_t, int64_t, int64_t>(11, 9, 1);
-    return options::LlvmIrGemmTileSize(hlo_module_config_)
-        .value_or(kDefaultTileSize);
+    return ::xla::cpu::GetGemmTileSize(hlo_module_config_);
   }
 
   DotInfo dot_info_;
@@ -340,7 +392,7 @@ DotOpEmitter::DotOpEmitter(DotInfo dot_info, std::string dot_hlo_name,
       target_machine_features_(target_machine_features),
       allow_runtime_calls_(allow_runtime_calls) {}
 
-void DotOpEmitter::EmitTiledLlvmIrGemm() {
+void DotOpEmitter::EmitTiledLlvmIrGemm(llvm::Value* partition_index) {
   PrimitiveType primitive_type = dot_info_.result_shape.element_type();
   MatMultDims mat_mult_dims = GetMatMultDims();
 
@@ -352,15 +404,12 @@ void DotOpEmitter::EmitTiledLlvmIrGemm() {
   int64_t n = mat_mult_dims.n;
 
   if (mat_mult_dims.lhs_column_major) {
+    CHECK(partition_index == nullptr)
+        << "Partitioned GEMM requires row major operands";
     std::swap(lhs, rhs);
     std::swap(m, n);
   }
 
-  int64_t size_bytes =
-      m * n * ShapeUtil::ByteSizeOfPrimitiveType(primitive_type);
-  b_->CreateMemSet(target, b_->getInt8(0), /*Size=*/size_bytes,
-                   /*Align=*/llvm::MaybeAlign(1));
-
   int64_t max_target_vector_width =
       target_machine_features_.vector_register_num_elements(
           *b_->GetInsertBlock()->getParent(), primitive_type);
@@ -369,14 +418,62 @@ void DotOpEmitter::EmitTiledLlvmIrGemm() {
   std::tie(tile_size_m, tile_size_k, tile_size_n_in_vector_width) =
       GetGemmTileSize();
 
-  EmitSmallGemm(
-      /*scalar_type=*/primitive_type,
-      /*m=*/m, /*k=*/k, /*n=*/n,
-      /*max_vectorization_width=*/max_target_vector_width,
-      /*max_vector_count=*/tile_size_n_in_vector_width,
-      /*min_vectorization_width=*/std::min<int64_t>(4, max_target_vector_width),
-      /*tile_size_m=*/tile_size_m, /*tile_size_k=*/tile_size_k, /*lhs=*/lhs,
-      /*rhs=*/rhs, /*result=*/target, b_, hlo_module_config_);
+  // Emits a GEMM of `rows` rows of `lhs` [rows, k] with `rhs` [k, n] into
+  // `target` [rows, n].
+  auto emit_gemm = [&](int64_t rows, llvm::Value* lhs, llvm::Value* target) {
+    int64_t size_bytes =
+        rows * n * ShapeUtil::ByteSizeOfPrimitiveType(primitive_type);
+    b_->CreateMemSet(target, b_->getInt8(0), /*Size=*/size_bytes,
+                     /*Align=*/llvm::MaybeAlign(1));
+
+    EmitSmallGemm(
+        /*scalar_type=*/primitive_type,
+        /*m=*/rows, /*k=*/k, /*n=*/n,
+        /*max_vectorization_width=*/max_target_vector_width,
+        /*max_vector_count=*/tile_size_n_in_vector_width,
+        /*min_vectorization_width=*/
+        std::min<int64_t>(4, max_target_vector_width),
+        /*tile_size_m=*/tile_size_m, /*tile_size_k=*/tile_size_k, /*lhs=*/lhs,
+        /*rhs=*/rhs, /*result=*/target, b_, hlo_module_config_);
+  };
+
+  if (partition_index == nullptr) {
+    emit_gemm(m, lhs, target);
+    return;
+  }
+
+  // Offset `lhs` and `target` to the first row of the partition. All
+  // partitions but the last one have the same number of rows, so we emit at
+  // most two (outlined) GEMM kernels.
+  GemmRowPartitioning partitioning =
+      GetGemmRowPartitioning(hlo_module_config_, m, k, n);
+  llvm::Type* element_type = llvm_ir::PrimitiveTypeToIrType(
+      primitive_type, b_->GetInsertBlock()->getModule());
+  llvm::Value* row_start = b_->CreateMul(
+      partition_index, b_->getInt64(partitioning.rows_per_partition));
+  llvm::Value* lhs_partition = b_->CreateInBoundsGEP(
+      element_type, lhs, b_->CreateMul(row_start, b_->getInt64(k)));
+  llvm::Value* target_partition = b_->CreateInBoundsGEP(
+      element_type, target, b_->CreateMul(row_start, b_->getInt64(n)));
+
+  int64_t last_partition_rows =
+      m - partitioning.rows_per_partition * (partitioning.num_partitions - 1);
+  if (last_partition_rows == partitioning.rows_per_partition) {
+    emit_gemm(partitioning.rows_per_partition, lhs_partition,
+              target_partition);
+    return;
+  }
+
+  KernelSupportLibrary ksl(b_);
+  ksl.If(
+      "dot.partition",
+      b_->CreateICmpULT(partition_index,
+                        b_->getInt64(partitioning.num_partitions - 1)),
+      [&] {
+        emit_gemm(partitioning.rows_per_partition, lhs_partition,
+                  target_partition);
+      },
+      [&] { emit_gemm(last_partition_rows, lhs_partition, target_partition); });
 }
 
 void DotOpEmitter::EmitTiledLlvmIrGemv() {
@@ -545,6 +642,14 @@ absl::Status DotOpEmitter::Emit() {
   }
 }
 
+absl::Status DotOpEmitter::EmitRowPartition(llvm::Value* partition_index) {
+  TF_RET_CHECK(GetNonBatchDotImplementationStrategy(
+                   hlo_module_config_, dot_info_, target_machine_features_) ==
+               DotImplementationStrategy::kTiledLlvmIrGemm);
+  EmitTiledLlvmIrGemm(partition_index);
+  return absl::OkStatus();
+}
+
 absl::Status DotOpEmitter::EmitBatch() {
   // The dot operation performs a sum of products over dimension 0 of the left
   // hand side operand and dimension 1 of the right hand side operand.
@@ -1407,5 +1512,62 @@ absl::Status EmitDotOperation(
       target_machine_features, allow_runtime_calls);
 }
 
+// Returns the row partitioning of `dot`, or std::nullopt if `dot` is not a
+// tiled LLVM IR GEMM that can be partitioned.
+static std::optional<GemmRowPartitioning> GetDotGemmRowPartitioning(
+    const HloInstruction& dot,
+    const TargetMachineFeatures& target_machine_features) {
+  const HloModuleConfig& config = dot.GetModule()->config();
+  if (IsBatchDot(dot) || GetDotImplementationStrategy(
+                             config, dot, target_machine_features) !=
+                             DotImplementationStrategy::kTiledLlvmIrGemm) {
+    return std::nullopt;
+  }
+
+  DotInfo dot_info(dot);
+  const Shape& lhs_shape = dot_info.lhs_shape;
+  if (lhs_shape.has_layout() && LayoutUtil::Minor(lhs_shape.layout(), 0) == 0) {
+    return std::nullopt;
+  }
+
+  int64_t m = dot_info.result_shape.dimensions(0);
+  int64_t k =
+      lhs_shape.dimensions(dot_info.dim_nums.lhs_contracting_dimensions(0));
+  int64_t n = dot_info.result_shape.dimensions(1);
+  return GetGemmRowPartitioning(config, m, k, n);
+}
+
+int64_t GetDotRowPartitionCount(
+    const HloInstruction& dot,
+    const TargetMachineFeatures& target_machine_features) {
+  std::optional<GemmRowPartitioning> partitioning =
+      GetDotGemmRowPartitioning(dot, target_machine_features);
+  return partitioning ? partitioning->num_partitions : 1;
+}
+
+int64_t GetDotRowsPerPartition(
+    const HloInstruction& dot,
+    const TargetMachineFeatures& target_machine_features) {
+  std::optional<GemmRowPartitioning> partitioning =
+      GetDotGemmRowPartitioning(dot, target_machine_features);
+  return partitioning ? partitioning->rows_per_partition
+                      : dot.shape().dimensions(0);
+}
+
+absl::Status EmitDotRowPartition(
+    const HloInstruction& dot, llvm::Value* partition_index,
+    const llvm_ir::IrArray& target_array, const llvm_ir::IrArray& lhs_array,
+    const llvm_ir::IrArray& rhs_array, llvm::IRBuilder<>* b,
+    const HloModuleConfig& hlo_module_config,
+    const TargetMachineFeatures& target_machine_features) {
+  TF_RET_CHECK(!IsBatchDot(dot));
+  DotOpEmitter dot_emitter(DotInfo(dot), std::string(dot.name()), target_array,
+                           lhs_array, rhs_array, /*addend_array=*/nullptr,
+                           /*executable_run_options_value=*/nullptr, b,
+                           hlo_module_config, target_machine_features,
+                           /*allow_runtime_calls=*/false);
+  return dot_emitter.EmitRowPartition(partition_index);
+}
+
 }  // namespace cpu
 }  // namespace xla
@@ -133,6 +133,31 @@ absl::Status EmitDotOperation(
     const TargetMachineFeatures& target_machine_features,
     bool allow_runtime_calls = true);
 
+// Returns the number of partitions of the M dimension of `dot` when it is
+// lowered to a tiled LLVM IR GEMM that can run as multiple tasks (see the
+// `xla_llvm_ir_gemm_max_parallelism` backend option). Returns 1 if `dot` is
+// not partitioned.
+int64_t GetDotRowPartitionCount(
+    const HloInstruction& dot,
+    const TargetMachineFeatures& target_machine_features);
+
+// Returns the number of output rows computed by every partition of `dot`
+// except the last one, which may compute fewer rows. Returns the number of
+// rows of `dot` if it is not partitioned.
+int64_t GetDotRowsPerPartition(
+    const HloInstruction& dot,
+    const TargetMachineFeatures& target_machine_features);
+
+// Emit LLVM IR to compute the rows of partition `partition_index` (an i64
+// value in [0, GetDotRowPartitionCount(dot))) of the dot operation on
+// lhs_array and rhs_array, and place them in target_array.
+absl::Status EmitDotRowPartition(
+    const HloInstruction& dot, llvm::Value* partition_index,
+    const llvm_ir::IrArray& target_array, const llvm_ir::IrArray& lhs_array,
+    const llvm_ir::IrArray& rhs_array, llvm::IRBuilder<>* b,
+    const HloModuleConfig& hlo_module_config,
+    const TargetMachineFeatures& target_machine_features);
+
 }  // namespace xla::cpu
 
 #endif  // XLA_SERVICE_CPU_DOT_OP_EMITTER_H_
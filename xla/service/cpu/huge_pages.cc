@@ -0,0 +1,75 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/huge_pages.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "tsl/platform/logging.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace xla::cpu {
+
+static std::atomic<int64_t> advised_regions{0};
+static std::atomic<int64_t> advised_bytes{0};
+static std::atomic<int64_t> skipped_regions{0};
+static std::atomic<int64_t> failed_regions{0};
+
+bool AdviseHugePages(void* data, size_t size) {
+  auto begin = reinterpret_cast<uintptr_t>(data);
+  uintptr_t aligned_begin = (begin + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  uintptr_t aligned_end = (begin + size) & ~(kHugePageSize - 1);
+
+  if (aligned_begin >= aligned_end) {
+    skipped_regions.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  size_t aligned_size = aligned_end - aligned_begin;
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (madvise(reinterpret_cast<void*>(aligned_begin), aligned_size,
+              MADV_HUGEPAGE) == 0) {
+    VLOG(3) << "Advised " << aligned_size << " bytes at "
+            << reinterpret_cast<void*>(aligned_begin) << " to use huge pages";
+    advised_regions.fetch_add(1, std::memory_order_relaxed);
+    advised_bytes.fetch_add(aligned_size, std::memory_order_relaxed);
+    return true;
+  }
+  VLOG(2) << "madvise(MADV_HUGEPAGE) failed: " << std::strerror(errno);
+#endif
+
+  failed_regions.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+HugePageCounters GetHugePageCounters() {
+  HugePageCounters counters;
+  counters.advised_regions = advised_regions.load(std::memory_order_relaxed);
+  counters.advised_bytes = advised_bytes.load(std::memory_order_relaxed);
+  counters.skipped_regions = skipped_regions.load(std::memory_order_relaxed);
+  counters.failed_regions = failed_regions.load(std::memory_order_relaxed);
+  return counters;
+}
+
+}  // namespace xla::cpu
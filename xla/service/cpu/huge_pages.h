@@ -0,0 +1,55 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_HUGE_PAGES_H_
+#define XLA_SERVICE_CPU_HUGE_PAGES_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xla::cpu {
+
+// Size of a transparent huge page on x86-64 and aarch64 (with 4K base pages).
+inline constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+// Process-wide counters of `AdviseHugePages` calls.
+struct HugePageCounters {
+  // Regions successfully advised to use huge pages, and their total size.
+  int64_t advised_regions = 0;
+  int64_t advised_bytes = 0;
+
+  // Regions too small to contain a single aligned huge page.
+  int64_t skipped_regions = 0;
+
+  // Regions for which the kernel rejected the advice (e.g. kernel built
+  // without transparent huge pages), or huge pages are not supported on the
+  // platform.
+  int64_t failed_regions = 0;
+};
+
+// Advises the kernel to back the huge page aligned part of the [data, data +
+// size) memory region with transparent huge pages (`madvise(MADV_HUGEPAGE)`).
+// Pages that are not yet faulted in will be allocated as huge pages when
+// possible, and already populated pages can be collapsed into huge pages by
+// `khugepaged` in the background. Returns false if the advice was not applied;
+// it is always safe to ignore the result, as the memory stays usable with
+// regular pages.
+bool AdviseHugePages(void* data, size_t size);
+
+HugePageCounters GetHugePageCounters();
+
+}  // namespace xla::cpu
+
+#endif  // XLA_SERVICE_CPU_HUGE_PAGES_H_
@@ -0,0 +1,65 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/huge_pages.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "tsl/platform/test.h"
+
+namespace xla::cpu {
+namespace {
+
+TEST(HugePagesTest, SkipsSmallRegions) {
+  char data[1024];
+  HugePageCounters before = GetHugePageCounters();
+  EXPECT_FALSE(AdviseHugePages(data, sizeof(data)));
+  HugePageCounters after = GetHugePageCounters();
+  EXPECT_EQ(after.skipped_regions, before.skipped_regions + 1);
+  EXPECT_EQ(after.advised_regions, before.advised_regions);
+}
+
+TEST(HugePagesTest, AdvisesAlignedPart) {
+  // An unaligned region that contains exactly two aligned huge pages.
+  size_t size = 4 * kHugePageSize;
+  void* storage = std::aligned_alloc(kHugePageSize, size);
+  ASSERT_NE(storage, nullptr);
+  char* data = static_cast<char*>(storage) + 1;
+
+  HugePageCounters before = GetHugePageCounters();
+  bool advised = AdviseHugePages(data, 3 * kHugePageSize);
+  HugePageCounters after = GetHugePageCounters();
+
+  // Huge pages might not be supported by the kernel, in which case we must
+  // gracefully fall back to regular pages.
+  if (advised) {
+    EXPECT_EQ(after.advised_regions, before.advised_regions + 1);
+    EXPECT_EQ(after.advised_bytes, before.advised_bytes + 2 * kHugePageSize);
+  } else {
+    EXPECT_EQ(after.failed_regions, before.failed_regions + 1);
+  }
+
+  // Memory must stay usable either way.
+  std::memset(data, 1, 3 * kHugePageSize);
+  EXPECT_EQ(data[3 * kHugePageSize - 1], 1);
+
+  std::free(storage);
+}
+
+}  // namespace
+}  // namespace xla::cpu
@@ -23,6 +23,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -38,6 +39,7 @@ limitations under the License.
 #include "xla/service/cpu/collectives_interface.h"
 #include "xla/service/global_device_id.h"
 #include "xla/status_macros.h"
+#include "xla/types.h"
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/errors.h"
@@ -98,49 +100,77 @@ template <ReductionKind>
 constexpr bool always_false_v = false;
 
 template <ReductionKind reduction_kind, typename T>
-void ReduceHelper(absl::Span<T> acc, absl::Span<T const* const> inputs) {
-  // TODO(penporn): make sure this gets vectorized.
+T ReduceElements(T a, T b) {
   if constexpr (reduction_kind == ReductionKind::SUM) {
-    for (size_t j = 0; j < inputs.size(); ++j) {
-      for (size_t i = 0; i < acc.size(); ++i) {
-        acc[i] += inputs[j][i];
-      }
-    }
+    return a + b;
   } else if constexpr (reduction_kind == ReductionKind::PRODUCT) {
-    for (size_t j = 0; j < inputs.size(); ++j) {
-      for (size_t i = 0; i < acc.size(); ++i) {
-        acc[i] *= inputs[j][i];
-      }
-    }
+    return a * b;
   } else if constexpr (reduction_kind == ReductionKind::MIN) {
-    for (size_t j = 0; j < inputs.size(); ++j) {
-      for (size_t i = 0; i < acc.size(); ++i) {
-        acc[i] = std::min(acc[i], inputs[j][i]);
-      }
-    }
+    return std::min(a, b);
   } else if constexpr (reduction_kind == ReductionKind::MAX) {
-    for (size_t j = 0; j < inputs.size(); ++j) {
-      for (size_t i = 0; i < acc.size(); ++i) {
-        acc[i] = std::max(acc[i], inputs[j][i]);
-      }
-    }
+    return std::max(a, b);
   } else {
     static_assert(always_false_v<reduction_kind>, "Unsupported reduction kind");
   }
 }
 
+// 16-bit floating point types don't have native arithmetic on most CPUs, so we
+// reduce them in f32 and round the result once at the end. This keeps the
+// inner loops vectorizable and is also more accurate than rounding after
+// every input.
+template <typename T>
+using ReduceAccumulatorType =
+    std::conditional_t<std::is_same_v<T, half> || std::is_same_v<T, bfloat16>,
+                       float, T>;
+
+// Number of elements reduced at a time. The accumulator block stays in L1
+// while we stream the corresponding block of every input through it.
+constexpr size_t kReduceBlockElems = 1024;
+
+// Reduces `inputs` element-wise into `out`. `out` may alias one of the inputs.
+template <ReductionKind reduction_kind, typename T>
+void ReduceHelper(absl::Span<T> out, absl::Span<T const* const> inputs) {
+  using AccT = ReduceAccumulatorType<T>;
+
+  if (inputs.empty()) {
+    std::fill(out.begin(), out.end(), GetInitialValue<T>(reduction_kind));
+    return;
+  }
+
+  AccT acc[kReduceBlockElems];
+  for (size_t start = 0; start < out.size(); start += kReduceBlockElems) {
+    size_t n = std::min(kReduceBlockElems, out.size() - start);
+
+    // Initialize the accumulator with the first input instead of the identity
+    // of the reduction to save one pass over the block.
+    const T* first = inputs[0] + start;
+    for (size_t i = 0; i < n; ++i) {
+      acc[i] = static_cast<AccT>(first[i]);
+    }
+
+    for (size_t j = 1; j < inputs.size(); ++j) {
+      const T* input = inputs[j] + start;
+      for (size_t i = 0; i < n; ++i) {
+        acc[i] = ReduceElements<reduction_kind, AccT>(
+            acc[i], static_cast<AccT>(input[i]));
+      }
+    }
+
+    T* result = out.data() + start;
+    for (size_t i = 0; i < n; ++i) {
+      result[i] = static_cast<T>(acc[i]);
+    }
+  }
+}
+
 template <PrimitiveType PT>
 absl::Status ReduceScatter(ReductionKind reduction_kind,
                            absl::Span<const void* const> inputs, void* output,
                            int64_t num_elems) {
   using T = typename primitive_util::PrimitiveTypeToNative<PT>::type;
-  T initial_value = GetInitialValue<T>(reduction_kind);
 
   absl::Span<T> out_chunk =
       absl::MakeSpan(reinterpret_cast<T*>(output), num_elems);
-  for (int64_t i = 0; i < num_elems; ++i) {
-    out_chunk[i] = initial_value;
-  }
 
   absl::Span<T const* const> input_chunks(
       reinterpret_cast<T const* const*>(inputs.data()), inputs.size());
@@ -241,6 +271,10 @@ class CpuAllReduceRendezvous
         TF_RETURN_IF_ERROR(ReduceScatter<U64>(me.reduction_kind, inputs,
                                               reduce_output, chunk_elems));
         break;
+      case BF16:
+        TF_RETURN_IF_ERROR(ReduceScatter<BF16>(me.reduction_kind, inputs,
+                                               reduce_output, chunk_elems));
+        break;
       case F16:
         TF_RETURN_IF_ERROR(ReduceScatter<F16>(me.reduction_kind, inputs,
                                               reduce_output, chunk_elems));
@@ -477,6 +511,10 @@ class CpuReduceScatterRendezvous
         TF_RETURN_IF_ERROR(ReduceScatter<U64>(
             me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
         break;
+      case BF16:
+        TF_RETURN_IF_ERROR(ReduceScatter<BF16>(
+            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
+        break;
       case F16:
         TF_RETURN_IF_ERROR(ReduceScatter<F16>(
             me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
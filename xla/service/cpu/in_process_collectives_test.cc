@@ -0,0 +1,240 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/in_process_collectives.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "xla/executable_run_options.h"
+#include "xla/service/collective_ops_utils.h"
+#include "xla/service/cpu/collectives_interface.h"
+#include "xla/service/global_device_id.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/types.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla::cpu::runtime {
+namespace {
+
+constexpr int kNumRanks = 4;
+constexpr absl::Duration kTimeout = absl::Seconds(60);
+
+std::vector<GlobalDeviceId> Devices() {
+  std::vector<GlobalDeviceId> devices;
+  for (int i = 0; i < kNumRanks; ++i) {
+    devices.push_back(GlobalDeviceId(i));
+  }
+  return devices;
+}
+
+// Runs `fn(communicator, rank)` concurrently on every rank.
+template <typename Fn>
+void RunOnAllRanks(Fn fn) {
+  InProcessCollectives collectives;
+  std::vector<absl::Status> statuses(kNumRanks);
+  {
+    tsl::thread::ThreadPool pool(tsl::Env::Default(), "collectives",
+                                 kNumRanks);
+    for (int rank = 0; rank < kNumRanks; ++rank) {
+      pool.Schedule([&, rank] {
+        auto communicator = collectives.GetCommunicator(Devices(), rank);
+        statuses[rank] = communicator.ok() ? fn(**communicator, rank)
+                                           : communicator.status();
+      });
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    TF_EXPECT_OK(status);
+  }
+}
+
+RendezvousKey MakeKey() {
+  return RendezvousKey(RunId(0), Devices(), kNumRanks,
+                       RendezvousKey::kCrossReplica, /*op_id=*/0);
+}
+
+// All-reduces `buffers`, one per rank, and returns the result of every rank.
+// With `in_place`, each rank uses the same buffer for input and output.
+template <typename T>
+std::vector<std::vector<T>> AllReduce(ReductionKind reduction_kind,
+                                      PrimitiveType element_type,
+                                      std::vector<std::vector<T>> buffers,
+                                      bool in_place = false) {
+  std::vector<std::vector<T>> outputs;
+  if (!in_place) {
+    for (const auto& buffer : buffers) {
+      outputs.emplace_back(buffer.size());
+    }
+  }
+  std::vector<std::vector<T>>& results = in_place ? buffers : outputs;
+  RendezvousKey key = MakeKey();
+  RunOnAllRanks([&](CollectivesCommunicator& communicator, int rank) {
+    return communicator.AllReduce(key, reduction_kind, element_type,
+                                  buffers[rank].size(), buffers[rank].data(),
+                                  results[rank].data(), kTimeout);
+  });
+  return results;
+}
+
+// Element `i` of the input of `rank`.
+int64_t InputValue(int rank, size_t i) {
+  return static_cast<int64_t>((i * 7 + rank * 3) % 11) + 1;
+}
+
+template <typename T>
+std::vector<std::vector<T>> MakeInputs(size_t num_elements) {
+  std::vector<std::vector<T>> inputs(kNumRanks);
+  for (int rank = 0; rank < kNumRanks; ++rank) {
+    for (size_t i = 0; i < num_elements; ++i) {
+      inputs[rank].push_back(static_cast<T>(InputValue(rank, i)));
+    }
+  }
+  return inputs;
+}
+
+int64_t ExpectedValue(ReductionKind reduction_kind, size_t i) {
+  int64_t result = InputValue(0, i);
+  for (int rank = 1; rank < kNumRanks; ++rank) {
+    int64_t value = InputValue(rank, i);
+    switch (reduction_kind) {
+      case ReductionKind::SUM:
+        result += value;
+        break;
+      case ReductionKind::PRODUCT:
+        result *= value;
+        break;
+      case ReductionKind::MIN:
+        result = std::min(result, value);
+        break;
+      case ReductionKind::MAX:
+        result = std::max(result, value);
+        break;
+    }
+  }
+  return result;
+}
+
+template <typename T>
+void ExpectAllReduceResults(ReductionKind reduction_kind,
+                            PrimitiveType element_type, size_t num_elements,
+                            bool in_place) {
+  std::vector<std::vector<T>> results =
+      AllReduce<T>(reduction_kind, element_type, MakeInputs<T>(num_elements),
+                   in_place);
+  for (int rank = 0; rank < kNumRanks; ++rank) {
+    ASSERT_EQ(results[rank].size(), num_elements);
+    for (size_t i = 0; i < num_elements; ++i) {
+      ASSERT_EQ(results[rank][i],
+                static_cast<T>(ExpectedValue(reduction_kind, i)))
+          << "rank " << rank << ", element " << i << " of " << num_elements;
+    }
+  }
+}
+
+// Element counts that are smaller than the number of ranks, and chunks of
+// each rank that are smaller than, equal to, and span several reduction
+// blocks.
+constexpr size_t kNumElements[] = {1, 3, 4 * 1024, 4 * 1024 + 5, 4 * 4099};
+
+constexpr ReductionKind kReductionKinds[] = {
+    ReductionKind::SUM, ReductionKind::PRODUCT, ReductionKind::MIN,
+    ReductionKind::MAX};
+
+TEST(InProcessCollectivesTest, AllReduceF32) {
+  for (ReductionKind reduction_kind : kReductionKinds) {
+    for (size_t num_elements : kNumElements) {
+      ExpectAllReduceResults<float>(reduction_kind, F32, num_elements,
+                                    /*in_place=*/false);
+    }
+  }
+}
+
+TEST(InProcessCollectivesTest, AllReduceS32) {
+  for (ReductionKind reduction_kind : kReductionKinds) {
+    for (size_t num_elements : kNumElements) {
+      ExpectAllReduceResults<int32_t>(reduction_kind, S32, num_elements,
+                                      /*in_place=*/false);
+    }
+  }
+}
+
+TEST(InProcessCollectivesTest, AllReduceInPlace) {
+  for (ReductionKind reduction_kind : kReductionKinds) {
+    for (size_t num_elements : kNumElements) {
+      ExpectAllReduceResults<float>(reduction_kind, F32, num_elements,
+                                    /*in_place=*/true);
+    }
+  }
+}
+
+TEST(InProcessCollectivesTest, AllReduce16BitFloats) {
+  // Sums of the inputs all fit in the mantissa of bf16 and f16.
+  for (ReductionKind reduction_kind :
+       {ReductionKind::SUM, ReductionKind::MIN, ReductionKind::MAX}) {
+    for (size_t num_elements : kNumElements) {
+      ExpectAllReduceResults<bfloat16>(reduction_kind, BF16, num_elements,
+                                       /*in_place=*/false);
+      ExpectAllReduceResults<half>(reduction_kind, F16, num_elements,
+                                   /*in_place=*/false);
+    }
+  }
+}
+
+TEST(InProcessCollectivesTest, AllReduceBF16AccumulatesInF32) {
+  // 256 + 1 + 1 + 1 = 259 is rounded to 260 once. Rounding after every
+  // addition would give 256, since 257 is rounded back down to 256.
+  std::vector<std::vector<bfloat16>> inputs(kNumRanks,
+                                            {static_cast<bfloat16>(1.0f)});
+  inputs[0] = {static_cast<bfloat16>(256.0f)};
+  std::vector<std::vector<bfloat16>> results =
+      AllReduce<bfloat16>(ReductionKind::SUM, BF16, inputs);
+  for (int rank = 0; rank < kNumRanks; ++rank) {
+    EXPECT_EQ(static_cast<float>(results[rank][0]), 260.0f);
+  }
+}
+
+TEST(InProcessCollectivesTest, ReduceScatter) {
+  constexpr size_t kChunkElems = 1024 + 3;
+  for (ReductionKind reduction_kind : kReductionKinds) {
+    std::vector<std::vector<int32_t>> inputs =
+        MakeInputs<int32_t>(kNumRanks * kChunkElems);
+    std::vector<std::vector<int32_t>> outputs(
+        kNumRanks, std::vector<int32_t>(kChunkElems));
+    RendezvousKey key = MakeKey();
+    RunOnAllRanks([&](CollectivesCommunicator& communicator, int rank) {
+      return communicator.ReduceScatter(key, reduction_kind, S32, kChunkElems,
+                                        inputs[rank].data(),
+                                        outputs[rank].data(), kTimeout);
+    });
+    for (int rank = 0; rank < kNumRanks; ++rank) {
+      for (size_t i = 0; i < kChunkElems; ++i) {
+        ASSERT_EQ(outputs[rank][i],
+                  ExpectedValue(reduction_kind, rank * kChunkElems + i))
+            << "rank " << rank << ", element " << i;
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xla::cpu::runtime
@@ -15,8 +15,14 @@ limitations under the License.
 
 #include "xla/service/cpu/ir_emission_utils.h"
 
+#include "xla/hlo/ir/hlo_casting_utils.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instructions.h"
 #include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/layout_util.h"
+#include "xla/literal_util.h"
+#include "xla/primitive_util.h"
 #include "xla/service/cpu/cpu_runtime.h"
 #include "xla/shape_util.h"
 #include "xla/window_util.h"
@@ -39,7 +45,9 @@ int64_t GetMinimumAlignmentForArray(
       allocation_size_bytes);
 }
 
-bool PotentiallyImplementedAsEigenConvolution(
+// Returns true if `convolution` has the shapes, alignment and dimension numbers
+// required by the convolution runtime, independent of its element types.
+static bool HasConvolutionRuntimeLayout(
     const HloInstruction& convolution,
     const TargetMachineFeatures& target_machine_features) {
   // The following conditions are necessary (but not sufficient) for
@@ -70,11 +78,6 @@ bool PotentiallyImplementedAsEigenConvolution(
   // Make sure input and kernel has the same data type.
   CHECK(
       ShapeUtil::SameElementTypeIgnoringFpPrecision(input_shape, kernel_shape));
-  // TODO(b/65408531): Explore using Eigen dot for complex64 type.
-  PrimitiveType primitive_type = input_shape.element_type();
-  if (primitive_type != F16 && primitive_type != F32) {
-    return false;
-  }
   if (window_util::HasWindowReversal(convolution.window())) {
     return false;
   }
@@ -110,5 +113,206 @@ bool PotentiallyImplementedAsEigenConvolution(
              kernel_shape.dimensions_size() - 1;
 }
 
+bool PotentiallyImplementedAsEigenConvolution(
+    const HloInstruction& convolution,
+    const TargetMachineFeatures& target_machine_features) {
+  // TODO(b/65408531): Explore using Eigen dot for complex64 type.
+  PrimitiveType primitive_type = convolution.operand(0)->shape().element_type();
+  if (primitive_type != F16 && primitive_type != F32) {
+    return false;
+  }
+  return HasConvolutionRuntimeLayout(convolution, target_machine_features);
+}
+
+bool PotentiallyImplementedAsInt8Convolution(
+    const HloInstruction& convolution,
+    const TargetMachineFeatures& target_machine_features) {
+  if (convolution.operand(0)->shape().element_type() != S8 ||
+      convolution.operand(1)->shape().element_type() != S8 ||
+      convolution.shape().element_type() != S32) {
+    return false;
+  }
+  return HasConvolutionRuntimeLayout(convolution, target_machine_features);
+}
+
+bool PotentiallyImplementedAsScatterThunk(const HloInstruction& instr) {
+  if (instr.opcode() != HloOpcode::kScatter) {
+    return false;
+  }
+  auto* scatter = Cast<HloScatterInstruction>(&instr);
+  if (scatter->scatter_operand_count() != 1) {
+    return false;
+  }
+
+  const Shape& operand_shape = scatter->scatter_operands()[0]->shape();
+  const Shape& indices_shape = scatter->scatter_indices()->shape();
+  const Shape& updates_shape = scatter->scatter_updates()[0]->shape();
+  if (!operand_shape.is_static() || !indices_shape.is_static() ||
+      !updates_shape.is_static() || operand_shape.rank() == 0) {
+    return false;
+  }
+
+  PrimitiveType element_type = operand_shape.element_type();
+  if (element_type != F32 && element_type != F64 && element_type != S32 &&
+      element_type != S64) {
+    return false;
+  }
+  PrimitiveType index_type = indices_shape.element_type();
+  if (index_type != S32 && index_type != S64) {
+    return false;
+  }
+
+  // Every index selects one row of the operand (all dimensions but the major
+  // one), and indices are either scalars or vectors of size 1.
+  const ScatterDimensionNumbers& dnums =
+      scatter->scatter_dimension_numbers();
+  if (dnums.inserted_window_dims_size() != 1 ||
+      dnums.inserted_window_dims(0) != 0 ||
+      dnums.scatter_dims_to_operand_dims_size() != 1 ||
+      dnums.scatter_dims_to_operand_dims(0) != 0 ||
+      dnums.input_batching_dims_size() != 0) {
+    return false;
+  }
+  int64_t num_scatter_dims = indices_shape.rank();
+  if (dnums.index_vector_dim() < indices_shape.rank()) {
+    if (dnums.index_vector_dim() != indices_shape.rank() - 1 ||
+        indices_shape.dimensions(dnums.index_vector_dim()) != 1) {
+      return false;
+    }
+    --num_scatter_dims;
+  }
+
+  // Updated rows must be the minor dimensions of the updates.
+  if (dnums.update_window_dims_size() != operand_shape.rank() - 1) {
+    return false;
+  }
+  for (int64_t i = 0; i < dnums.update_window_dims_size(); ++i) {
+    if (dnums.update_window_dims(i) != num_scatter_dims + i ||
+        updates_shape.dimensions(dnums.update_window_dims(i)) !=
+            operand_shape.dimensions(i + 1)) {
+      return false;
+    }
+  }
+
+  // The combiner either overwrites the operand or combines it with the update
+  // with a commutative binary op.
+  const HloComputation* combiner = scatter->to_apply();
+  const HloInstruction* root = combiner->root_instruction();
+  if (root == combiner->parameter_instruction(1)) {
+    return true;
+  }
+  if (root->opcode() != HloOpcode::kAdd &&
+      root->opcode() != HloOpcode::kMinimum &&
+      root->opcode() != HloOpcode::kMaximum) {
+    return false;
+  }
+  return root->operand(0)->opcode() == HloOpcode::kParameter &&
+         root->operand(1)->opcode() == HloOpcode::kParameter &&
+         root->operand(0) != root->operand(1);
+}
+
+bool PotentiallyImplementedAsScanThunk(const HloInstruction& instr) {
+  if (instr.opcode() != HloOpcode::kReduceWindow ||
+      instr.operand_count() != 2) {
+    return false;
+  }
+
+  const Shape& shape = instr.operand(0)->shape();
+  if (!shape.is_static() || !ShapeUtil::Equal(shape, instr.shape())) {
+    return false;
+  }
+  PrimitiveType element_type = shape.element_type();
+  if (element_type != F32 && element_type != F64 && element_type != S32 &&
+      element_type != S64) {
+    return false;
+  }
+
+  // All window dimensions are trivial, except for the scanned one.
+  const Window& window = instr.window();
+  int64_t scan_dim = -1;
+  for (int64_t i = 0; i < shape.rank(); ++i) {
+    const WindowDimension& dim = window.dimensions(i);
+    if (window_util::IsTrivialWindowDimension(dim)) continue;
+    if (scan_dim != -1) return false;
+    scan_dim = i;
+
+    int64_t length = shape.dimensions(i);
+    bool forward = dim.padding_low() == length - 1 && dim.padding_high() == 0;
+    bool reverse = dim.padding_high() == length - 1 && dim.padding_low() == 0;
+    if (dim.size() != length || dim.stride() != 1 || (!forward && !reverse) ||
+        dim.window_reversal() || dim.base_dilation() != 1 ||
+        dim.window_dilation() != 1) {
+      return false;
+    }
+  }
+  if (scan_dim == -1) {
+    return false;
+  }
+
+  // The combiner is a binary op of the two parameters, and the init value is
+  // its identity, so that padding doesn't change the result.
+  const HloComputation* combiner = instr.to_apply();
+  const HloInstruction* root = combiner->root_instruction();
+  if (root->operand_count() != 2 ||
+      root->operand(0)->opcode() != HloOpcode::kParameter ||
+      root->operand(1)->opcode() != HloOpcode::kParameter ||
+      root->operand(0) == root->operand(1)) {
+    return false;
+  }
+
+  const HloInstruction* init = instr.operand(1);
+  if (init->opcode() != HloOpcode::kConstant) {
+    return false;
+  }
+  switch (root->opcode()) {
+    case HloOpcode::kAdd:
+      return init->literal() == LiteralUtil::Zero(element_type);
+    case HloOpcode::kMultiply:
+      return init->literal() == LiteralUtil::One(element_type);
+    case HloOpcode::kMinimum:
+      return init->literal() == LiteralUtil::MaxValue(element_type);
+    case HloOpcode::kMaximum:
+      return init->literal() == LiteralUtil::MinValue(element_type);
+    default:
+      return false;
+  }
+}
+
+bool PotentiallyImplementedAsRngBitGeneratorThunk(const HloInstruction& instr) {
+  if (instr.opcode() != HloOpcode::kRngBitGenerator) {
+    return false;
+  }
+
+  // RngBitGeneratorExpander lowers the default algorithm to Philox on CPU.
+  RandomAlgorithm algorithm = instr.rng_algorithm();
+  if (algorithm == RandomAlgorithm::RNG_DEFAULT) {
+    algorithm = RandomAlgorithm::RNG_PHILOX;
+  }
+
+  const Shape& state_shape = instr.operand(0)->shape();
+  if (!state_shape.IsArray() || state_shape.element_type() != U64 ||
+      state_shape.rank() != 1 || !state_shape.is_static()) {
+    return false;
+  }
+  int64_t state_size = state_shape.dimensions(0);
+  if (algorithm == RandomAlgorithm::RNG_PHILOX) {
+    if (state_size != 2 && state_size != 3) return false;
+  } else if (algorithm == RandomAlgorithm::RNG_THREE_FRY) {
+    if (state_size != 2) return false;
+  } else {
+    return false;
+  }
+
+  const Shape& data_shape = ShapeUtil::GetTupleElementShape(instr.shape(), 1);
+  PrimitiveType element_type = data_shape.element_type();
+  if (!data_shape.IsArray() || !data_shape.is_static() ||
+      element_type == PRED || primitive_util::IsComplexType(element_type)) {
+    return false;
+  }
+  int bit_width = primitive_util::BitWidth(element_type);
+  return bit_width == 8 || bit_width == 16 || bit_width == 32 ||
+         bit_width == 64;
+}
+
 }  // namespace cpu
 }  // namespace xla
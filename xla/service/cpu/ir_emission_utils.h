@@ -27,6 +27,32 @@ bool PotentiallyImplementedAsEigenConvolution(
     const HloInstruction& convolution,
     const TargetMachineFeatures& target_machine_features);
 
+// Returns true if `convolution` is an s8 x s8 -> s32 convolution that can be
+// implemented by the int8 kernel of the thunk runtime's ConvolutionThunk. It
+// has the same layout requirements as an Eigen convolution.
+bool PotentiallyImplementedAsInt8Convolution(
+    const HloInstruction& convolution,
+    const TargetMachineFeatures& target_machine_features);
+
+// Returns true if `scatter` updates whole rows of a single operand along its
+// major dimension, with an assignment, add, minimum or maximum combiner. Such
+// scatters (e.g. embedding gradients) are implemented natively by the thunk
+// runtime instead of being expanded into while loops.
+bool PotentiallyImplementedAsScatterThunk(const HloInstruction& scatter);
+
+// Returns true if `reduce_window` is an inclusive cumulative sum, product,
+// minimum or maximum along a single dimension (a window spanning the whole
+// dimension, padded to compute one prefix per element). Such reduce windows
+// are implemented natively by the thunk runtime as O(n) scans.
+bool PotentiallyImplementedAsScanThunk(const HloInstruction& reduce_window);
+
+// Returns true if `rng_bit_generator` uses the Philox or ThreeFry algorithm
+// with a state and output supported by the thunk runtime's
+// RngBitGeneratorThunk, which generates the same bits as the computation
+// produced by RngBitGeneratorExpander.
+bool PotentiallyImplementedAsRngBitGeneratorThunk(
+    const HloInstruction& rng_bit_generator);
+
 // Computes the minimum alignment guaranteed for a tensor of shape `shape` on
 // the target machine.
 int64_t GetMinimumAlignmentForArray(
@@ -52,5 +52,129 @@ ENTRY Conv {
       *conv_instr, target_machine_features));
 }
 
+TEST_F(IrEmitterTest, RowScatterImplementedAsScatterThunk) {
+  const char* const hlo_string = R"(
+HloModule ModuleWithScatter
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+mul {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT mul = f32[] multiply(lhs, rhs)
+}
+
+ENTRY Scatter {
+  operand = f32[100,16] parameter(0)
+  indices = s32[8,1] parameter(1)
+  updates = f32[8,16] parameter(2)
+  rows = f32[100,16] scatter(operand, indices, updates),
+    update_window_dims={1}, inserted_window_dims={0},
+    scatter_dims_to_operand_dims={0}, index_vector_dim=1, to_apply=add
+  product = f32[100,16] scatter(operand, indices, updates),
+    update_window_dims={1}, inserted_window_dims={0},
+    scatter_dims_to_operand_dims={0}, index_vector_dim=1, to_apply=mul
+  slices = s32[8,2] parameter(3)
+  elements = f32[8] parameter(4)
+  points = f32[100,16] scatter(operand, slices, elements),
+    update_window_dims={}, inserted_window_dims={0,1},
+    scatter_dims_to_operand_dims={0,1}, index_vector_dim=1, to_apply=add
+  ROOT tuple = (f32[100,16], f32[100,16], f32[100,16])
+    tuple(rows, product, points)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+
+  HloComputation* entry_computation = module->entry_computation();
+  EXPECT_TRUE(cpu::PotentiallyImplementedAsScatterThunk(
+      *FindInstruction(module.get(), "rows")));
+  EXPECT_FALSE(cpu::PotentiallyImplementedAsScatterThunk(
+      *FindInstruction(module.get(), "product")));
+  EXPECT_FALSE(cpu::PotentiallyImplementedAsScatterThunk(
+      *FindInstruction(module.get(), "points")));
+  EXPECT_FALSE(cpu::PotentiallyImplementedAsScatterThunk(
+      *entry_computation->root_instruction()));
+}
+
+TEST_F(IrEmitterTest, CumulativeReduceWindowImplementedAsScanThunk) {
+  const char* const hlo_string = R"(
+HloModule ModuleWithReduceWindow
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+max {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT max = f32[] maximum(lhs, rhs)
+}
+
+ENTRY ReduceWindow {
+  input = f32[8,128] parameter(0)
+  zero = f32[] constant(0)
+  ninf = f32[] constant(-inf)
+  cumsum = f32[8,128] reduce-window(input, zero),
+    window={size=1x128 pad=0_0x127_0}, to_apply=add
+  reverse_cummax = f32[8,128] reduce-window(input, ninf),
+    window={size=8x1 pad=0_7x0_0}, to_apply=max
+  wrong_init = f32[8,128] reduce-window(input, ninf),
+    window={size=1x128 pad=0_0x127_0}, to_apply=add
+  pool = f32[4,64] reduce-window(input, ninf),
+    window={size=2x2 stride=2x2}, to_apply=max
+  ROOT tuple = (f32[8,128], f32[8,128], f32[8,128], f32[4,64])
+    tuple(cumsum, reverse_cummax, wrong_init, pool)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+
+  EXPECT_TRUE(cpu::PotentiallyImplementedAsScanThunk(
+      *FindInstruction(module.get(), "cumsum")));
+  EXPECT_TRUE(cpu::PotentiallyImplementedAsScanThunk(
+      *FindInstruction(module.get(), "reverse_cummax")));
+  EXPECT_FALSE(cpu::PotentiallyImplementedAsScanThunk(
+      *FindInstruction(module.get(), "wrong_init")));
+  EXPECT_FALSE(cpu::PotentiallyImplementedAsScanThunk(
+      *FindInstruction(module.get(), "pool")));
+}
+
+TEST_F(IrEmitterTest, RngBitGeneratorImplementedAsThunk) {
+  const char* const hlo_string = R"(
+HloModule ModuleWithRngBitGenerator
+
+ENTRY RngBitGenerator {
+  state2 = u64[2] parameter(0)
+  state3 = u64[3] parameter(1)
+  philox = (u64[3], u32[8,16]) rng-bit-generator(state3), algorithm=rng_philox
+  default = (u64[2], f32[128]) rng-bit-generator(state2), algorithm=rng_default
+  three_fry = (u64[2], u16[7,5]) rng-bit-generator(state2),
+    algorithm=rng_three_fry
+  three_fry_state3 = (u64[3], u32[4]) rng-bit-generator(state3),
+    algorithm=rng_three_fry
+  ROOT tuple = ((u64[3], u32[8,16]), (u64[2], f32[128]), (u64[2], u16[7,5]),
+    (u64[3], u32[4])) tuple(philox, default, three_fry, three_fry_state3)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+
+  EXPECT_TRUE(cpu::PotentiallyImplementedAsRngBitGeneratorThunk(
+      *FindInstruction(module.get(), "philox")));
+  EXPECT_TRUE(cpu::PotentiallyImplementedAsRngBitGeneratorThunk(
+      *FindInstruction(module.get(), "default")));
+  EXPECT_TRUE(cpu::PotentiallyImplementedAsRngBitGeneratorThunk(
+      *FindInstruction(module.get(), "three_fry")));
+  EXPECT_FALSE(cpu::PotentiallyImplementedAsRngBitGeneratorThunk(
+      *FindInstruction(module.get(), "three_fry_state3")));
+}
+
 }  // namespace
 }  // namespace xla
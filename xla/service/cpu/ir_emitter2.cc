@@ -44,6 +44,7 @@ limitations under the License.
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
@@ -57,8 +58,10 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/hlo/ir/hlo_schedule.h"
 #include "xla/layout_util.h"
+#include "xla/primitive_util.h"
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/dot_epilogue_fusion.h"
 #include "xla/service/cpu/dot_op_emitter.h"
 #include "xla/service/cpu/elemental_math_emitter.h"
 #include "xla/service/cpu/ir_emitter.h"
@@ -68,6 +71,7 @@ limitations under the License.
 #include "xla/service/llvm_ir/dynamic_update_slice_util.h"
 #include "xla/service/llvm_ir/fused_ir_emitter.h"
 #include "xla/service/llvm_ir/ir_array.h"
+#include "xla/service/llvm_ir/kernel_support_library.h"
 #include "xla/service/llvm_ir/llvm_util.h"
 #include "xla/service/llvm_ir/loop_emitter.h"
 #include "xla/shape.h"
@@ -118,6 +122,22 @@ static llvm::FunctionType* KernelFunctionTy(llvm::LLVMContext& ctx) {
                                  /*isVarArg=*/false);
 }
 
+// Extends `index` to i64 and clamps it to [0, max_index], which is how gather
+// and dynamic-slice handle out of bounds start indices.
+static llvm::Value* EmitClampedIndex(llvm::IRBuilder<>& b, llvm::Value* index,
+                                     PrimitiveType index_type,
+                                     int64_t max_index) {
+  llvm::Value* max = b.getInt64(max_index);
+  if (primitive_util::IsSignedIntegralType(index_type)) {
+    index = b.CreateSExt(index, b.getInt64Ty());
+    index = b.CreateSelect(b.CreateICmpSLT(index, b.getInt64(0)),
+                           b.getInt64(0), index);
+    return b.CreateSelect(b.CreateICmpSGT(index, max), max, index);
+  }
+  index = b.CreateZExt(index, b.getInt64Ty());
+  return b.CreateSelect(b.CreateICmpUGT(index, max), max, index);
+}
+
 }  // namespace
 
 //===----------------------------------------------------------------------===//
@@ -393,6 +413,21 @@ absl::StatusOr<IrEmitter2::KernelInfo> IrEmitter2::EmitDotHostKernel(
   llvm_ir::IrArray rhs_array = kernel_prototype.arguments[1];
   llvm_ir::IrArray target_array = kernel_prototype.results[0];
 
+  // Split tiled GEMMs along the M dimension, and compute one partition per
+  // kernel thread.
+  int64_t num_partitions = GetDotRowPartitionCount(
+      *instr, nested_ir_emitter_->target_machine_features());
+  if (num_partitions > 1) {
+    TF_RETURN_IF_ERROR(EmitDotRowPartition(
+        *instr, kernel_prototype.thread.x, target_array, lhs_array, rhs_array,
+        &b, hlo_module_.config(),
+        nested_ir_emitter_->target_machine_features()));
+
+    return kernels_.emplace_back(KernelInfo(std::move(kernel_prototype),
+                                            se::BlockDim(),
+                                            se::ThreadDim(num_partitions)));
+  }
+
   TF_RETURN_IF_ERROR(EmitDotOperation(
       *instr, target_array, lhs_array, rhs_array,
       /*addend_array=*/nullptr, /*executable_run_options_value=*/nullptr, &b,
@@ -428,10 +463,156 @@ absl::StatusOr<IrEmitter2::KernelInfo> IrEmitter2::EmitConcatenateHostKernel(
   return EmitElementalHostKernel(instr);
 }
 
+absl::StatusOr<IrEmitter2::KernelInfo> IrEmitter2::EmitGatherHostKernel(
+    const HloInstruction* instr) {
+  VLOG(2) << "Emit gather host kernel: " << instr->name();
+
+  auto fast_impl_reason = CanDoFastGather(instr);
+  if (!fast_impl_reason.ok()) {
+    VLOG(1) << "Could not emit fast gather for " << instr->ToString() << ": "
+            << fast_impl_reason.message();
+    return EmitElementalHostKernel(instr);
+  }
+
+  TF_ASSIGN_OR_RETURN(KernelPrototype kernel_prototype,
+                      EmitKernelPrototype(instr));
+
+  llvm::IRBuilder<> b(module_->getContext());
+  b.SetInsertPoint(kernel_prototype.function->getEntryBlock().getTerminator());
+
+  llvm_ir::IrArray operand_array = kernel_prototype.arguments[0];
+  llvm_ir::IrArray indices_array = kernel_prototype.arguments[1];
+  llvm_ir::IrArray output_array = kernel_prototype.results[0];
+
+  const Shape& operand_shape = instr->operand(0)->shape();
+  const Shape& indices_shape = instr->operand(1)->shape();
+  PrimitiveType element_type = operand_shape.element_type();
+
+  // Every index selects one row of the operand (all dimensions but the major
+  // one), and the selected rows are stored back to back in the output.
+  const int64_t num_rows = ShapeUtil::ElementsIn(indices_shape);
+  const int64_t row_elements =
+      ShapeUtil::ElementsIn(operand_shape) / operand_shape.dimensions(0);
+  llvm::Type* element_ir_type =
+      llvm_ir::PrimitiveTypeToIrType(element_type, module_);
+  llvm::Type* index_ir_type =
+      llvm_ir::PrimitiveTypeToIrType(indices_shape.element_type(), module_);
+
+  // Split rows between kernel threads using the partition count assigned by
+  // the parallel task assigner.
+  int64_t num_partitions = 1;
+  if (auto parallel_config = GetParallelConfig(instr)) {
+    num_partitions = ShapePartitionAssigner::GetTotalPartitionCount(
+        parallel_config->outer_dimension_partitions);
+  }
+  const int64_t rows_per_partition = CeilOfRatio(num_rows, num_partitions);
+  num_partitions = CeilOfRatio(num_rows, rows_per_partition);
+
+  llvm::Value* row_begin = b.getInt64(0);
+  llvm::Value* row_end = b.getInt64(num_rows);
+  if (num_partitions > 1) {
+    row_begin = b.CreateMul(kernel_prototype.thread.x,
+                            b.getInt64(rows_per_partition));
+    llvm::Value* partition_end =
+        b.CreateAdd(row_begin, b.getInt64(rows_per_partition));
+    row_end = b.CreateSelect(b.CreateICmpULT(partition_end, row_end),
+                             partition_end, row_end);
+  }
+
+  auto emit_row_address = [&](llvm::Value* row) {
+    llvm::Value* index = b.CreateLoad(
+        index_ir_type,
+        b.CreateInBoundsGEP(index_ir_type, indices_array.GetBasePointer(),
+                            row));
+    index = EmitClampedIndex(b, index, indices_shape.element_type(),
+                             operand_shape.dimensions(0) - 1);
+    return b.CreateInBoundsGEP(element_ir_type, operand_array.GetBasePointer(),
+                               b.CreateMul(index, b.getInt64(row_elements)));
+  };
+
+  // Rows are usually picked at random from a large table, so we prefetch the
+  // row a few iterations ahead to overlap its cache misses with the copies.
+  constexpr int64_t kPrefetchDistance = 8;
+  llvm::Value* last_row = b.CreateSub(row_end, b.getInt64(1));
+
+  KernelSupportLibrary ksl(&b);
+  ksl.For("row", row_begin, row_end, b.getInt64(1), [&](llvm::Value* row) {
+    llvm::Value* prefetch_row = b.CreateAdd(row, b.getInt64(kPrefetchDistance));
+    prefetch_row = b.CreateSelect(b.CreateICmpULT(prefetch_row, last_row),
+                                  prefetch_row, last_row);
+    b.CreateIntrinsic(
+        llvm::Intrinsic::prefetch, {b.getPtrTy()},
+        {emit_row_address(prefetch_row), /*rw=*/b.getInt32(0),
+         /*locality=*/b.getInt32(3), /*cache_type=*/b.getInt32(1)});
+
+    llvm::Value* target = b.CreateInBoundsGEP(
+        element_ir_type, output_array.GetBasePointer(),
+        b.CreateMul(row, b.getInt64(row_elements)));
+    EmitTransferElements(target, emit_row_address(row), row_elements,
+                         element_type, output_array, operand_array, module_, b);
+  });
+
+  return kernels_.emplace_back(KernelInfo(std::move(kernel_prototype),
+                                          se::BlockDim(),
+                                          se::ThreadDim(num_partitions)));
+}
+
+absl::StatusOr<IrEmitter2::KernelInfo> IrEmitter2::EmitDynamicSliceHostKernel(
+    const HloInstruction* instr) {
+  VLOG(2) << "Emit dynamic-slice host kernel: " << instr->name();
+
+  auto fast_impl_reason = CanDoFastDynamicSlice(instr);
+  if (!fast_impl_reason.ok()) {
+    VLOG(1) << "Could not emit fast dynamic-slice for " << instr->ToString()
+            << ": " << fast_impl_reason.message();
+    return EmitElementalHostKernel(instr);
+  }
+
+  TF_ASSIGN_OR_RETURN(KernelPrototype kernel_prototype,
+                      EmitKernelPrototype(instr));
+
+  llvm::IRBuilder<> b(module_->getContext());
+  b.SetInsertPoint(kernel_prototype.function->getEntryBlock().getTerminator());
+
+  llvm_ir::IrArray operand_array = kernel_prototype.arguments[0];
+  llvm_ir::IrArray start_array = kernel_prototype.arguments[1];
+  llvm_ir::IrArray output_array = kernel_prototype.results[0];
+
+  const Shape& operand_shape = instr->operand(0)->shape();
+  const Shape& start_shape = instr->operand(1)->shape();
+  PrimitiveType element_type = operand_shape.element_type();
+
+  // The slice covers all dimensions but the major one, so it is a contiguous
+  // block of rows and only the major start index matters.
+  const int64_t row_elements =
+      ShapeUtil::ElementsIn(operand_shape) / operand_shape.dimensions(0);
+  llvm::Value* start = b.CreateLoad(
+      llvm_ir::PrimitiveTypeToIrType(start_shape.element_type(), module_),
+      start_array.GetBasePointer());
+  start = EmitClampedIndex(
+      b, start, start_shape.element_type(),
+      operand_shape.dimensions(0) - instr->shape().dimensions(0));
+
+  llvm::Value* source = b.CreateInBoundsGEP(
+      llvm_ir::PrimitiveTypeToIrType(element_type, module_),
+      operand_array.GetBasePointer(),
+      b.CreateMul(start, b.getInt64(row_elements)));
+  EmitTransferElements(output_array.GetBasePointer(), source,
+                       ShapeUtil::ElementsIn(instr->shape()), element_type,
+                       output_array, operand_array, module_, b);
+
+  return kernels_.emplace_back(
+      KernelInfo(std::move(kernel_prototype), se::BlockDim(), se::ThreadDim()));
+}
+
 absl::StatusOr<IrEmitter2::KernelInfo> IrEmitter2::EmitDotFusionHostKernel(
     const HloFusionInstruction* fusion) {
   VLOG(2) << "Emit dot fusion host kernel: " << fusion->name();
 
+  if (const HloInstruction* dot = GetDotEpilogueFusionDot(*fusion)) {
+    return EmitDotEpilogueFusionHostKernel(fusion, dot);
+  }
+
   // Dot fusion only supports adding a side input to the dot product.
   const HloInstruction* add = fusion->fused_expression_root();
   if (add->opcode() != HloOpcode::kAdd) {
@@ -485,6 +666,101 @@ absl::StatusOr<IrEmitter2::KernelInfo> IrEmitter2::EmitDotFusionHostKernel(
       KernelInfo(std::move(kernel_prototype), se::BlockDim(), se::ThreadDim()));
 }
 
+absl::StatusOr<IrEmitter2::KernelInfo>
+IrEmitter2::EmitDotEpilogueFusionHostKernel(const HloFusionInstruction* fusion,
+                                            const HloInstruction* dot) {
+  VLOG(2) << "Emit dot epilogue fusion host kernel: " << fusion->name();
+
+  const TargetMachineFeatures& target_machine_features =
+      nested_ir_emitter_->target_machine_features();
+
+  DotImplementationStrategy strategy = GetDotImplementationStrategy(
+      hlo_module_.config(), *dot, target_machine_features);
+  if (!IsDotCodegenStrategy(strategy)) {
+    return Internal("Unsupported dot implementation strategy");
+  }
+
+  TF_ASSIGN_OR_RETURN(KernelPrototype kernel_prototype,
+                      EmitKernelPrototype(fusion));
+
+  llvm::IRBuilder<> b(module_->getContext());
+  b.SetInsertPoint(kernel_prototype.function->getEntryBlock().getTerminator());
+
+  llvm_ir::IrArray lhs_array =
+      kernel_prototype.arguments[dot->operand(0)->parameter_number()];
+  llvm_ir::IrArray rhs_array =
+      kernel_prototype.arguments[dot->operand(1)->parameter_number()];
+  llvm_ir::IrArray target_array = kernel_prototype.results[0];
+
+  // The dot writes its result into the fusion result buffer, and every kernel
+  // thread then applies the epilogue in place to the rows it just computed.
+  const int64_t m = dot->shape().dimensions(0);
+  const int64_t n = dot->shape().dimensions(1);
+  llvm::Value* row_begin = b.getInt64(0);
+  llvm::Value* row_end = b.getInt64(m);
+
+  int64_t num_partitions =
+      GetDotRowPartitionCount(*dot, target_machine_features);
+  if (num_partitions > 1) {
+    TF_RETURN_IF_ERROR(EmitDotRowPartition(
+        *dot, kernel_prototype.thread.x, target_array, lhs_array, rhs_array,
+        &b, hlo_module_.config(), target_machine_features));
+
+    int64_t rows_per_partition =
+        GetDotRowsPerPartition(*dot, target_machine_features);
+    row_begin = b.CreateMul(kernel_prototype.thread.x,
+                            b.getInt64(rows_per_partition));
+    llvm::Value* partition_end =
+        b.CreateAdd(row_begin, b.getInt64(rows_per_partition));
+    row_end = b.CreateSelect(b.CreateICmpULT(partition_end, row_end),
+                             partition_end, row_end);
+  } else {
+    TF_RETURN_IF_ERROR(EmitDotOperation(
+        *dot, target_array, lhs_array, rhs_array,
+        /*addend_array=*/nullptr, /*executable_run_options_value=*/nullptr, &b,
+        hlo_module_.config(), target_machine_features,
+        /*allow_runtime_calls=*/false));
+  }
+
+  ElementalIrEmitter elemental_emitter(module_, &b, &hlo_module_,
+                                       nested_ir_emitter_, fast_min_max());
+
+  FusedIrEmitter fused_emitter(elemental_emitter);
+  for (int i = 0; i < fusion->operand_count(); i++) {
+    fused_emitter.BindGenerator(
+        *fusion->fused_parameter(i), [&, i](llvm_ir::IrArray::Index idx) {
+          return kernel_prototype.arguments[i].EmitReadArrayElement(idx, &b);
+        });
+  }
+  fused_emitter.BindGenerator(*dot, [&](llvm_ir::IrArray::Index idx) {
+    return target_array.EmitReadArrayElement(idx, &b);
+  });
+
+  TF_ASSIGN_OR_RETURN(
+      auto element_generator,
+      fused_emitter.GetGenerator(*fusion->fused_expression_root()));
+
+  KernelSupportLibrary ksl(&b);
+  TF_RETURN_IF_ERROR(ksl.ForWithStatus(
+      "dot.epilogue.row", row_begin, row_end, /*step=*/1,
+      [&](llvm::Value* row) {
+        return ksl.ForWithStatus(
+            "dot.epilogue.col", b.getInt64(0), b.getInt64(n), /*step=*/1,
+            [&](llvm::Value* col) -> absl::Status {
+              llvm_ir::IrArray::Index index({row, col}, target_array.GetShape(),
+                                            b.getInt64Ty());
+              TF_ASSIGN_OR_RETURN(llvm::Value * value,
+                                  element_generator(index));
+              target_array.EmitWriteArrayElement(index, value, &b);
+              return absl::OkStatus();
+            });
+      }));
+
+  return kernels_.emplace_back(KernelInfo(std::move(kernel_prototype),
+                                          se::BlockDim(),
+                                          se::ThreadDim(num_partitions)));
+}
+
 absl::StatusOr<IrEmitter2::KernelInfo> IrEmitter2::EmitSliceToDynamicHostKernel(
     const HloInstruction* instr) {
   VLOG(2) << "Emit slice-to-dynamic host kernel: " << instr->name();
@@ -928,6 +1204,88 @@ absl::Status IrEmitter2::CanDoFastConcatenate(
   return absl::OkStatus();
 };
 
+// Gathers and dynamic slices of whole rows can be emitted as row copies if all
+// arrays use the default (row-major) layout, so that rows are contiguous.
+static absl::Status CheckRowMajorArray(const Shape& shape) {
+  if (!shape.IsArray() || !shape.is_static()) {
+    return absl::FailedPreconditionError("Shape must be a static array");
+  }
+  if (primitive_util::IsSubByteNonPredType(shape.element_type())) {
+    return absl::FailedPreconditionError("Sub-byte types are not supported");
+  }
+  if (!LayoutUtil::IsMonotonicWithDim0Major(shape.layout())) {
+    return absl::FailedPreconditionError("Shape must have a row-major layout");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status IrEmitter2::CanDoFastGather(const HloInstruction* instr) const {
+  auto* gather = Cast<HloGatherInstruction>(instr);
+  const Shape& operand_shape = gather->operand(0)->shape();
+  const Shape& indices_shape = gather->operand(1)->shape();
+  TF_RETURN_IF_ERROR(CheckRowMajorArray(operand_shape));
+  TF_RETURN_IF_ERROR(CheckRowMajorArray(indices_shape));
+  TF_RETURN_IF_ERROR(CheckRowMajorArray(gather->shape()));
+  if (operand_shape.rank() == 0 ||
+      ShapeUtil::IsZeroElementArray(operand_shape) ||
+      ShapeUtil::IsZeroElementArray(gather->shape())) {
+    return absl::FailedPreconditionError("Gather must copy at least one row");
+  }
+
+  const GatherDimensionNumbers& dnums = gather->gather_dimension_numbers();
+  if (dnums.start_index_map_size() != 1 || dnums.start_index_map(0) != 0 ||
+      dnums.collapsed_slice_dims_size() != 1 ||
+      dnums.collapsed_slice_dims(0) != 0 ||
+      dnums.operand_batching_dims_size() != 0) {
+    return absl::FailedPreconditionError(
+        "Gather must index into the major operand dimension only");
+  }
+
+  // Indices are either scalars or vectors of size 1 along the minor dimension.
+  int64_t num_batch_dims = indices_shape.rank();
+  if (dnums.index_vector_dim() < indices_shape.rank()) {
+    if (dnums.index_vector_dim() != indices_shape.rank() - 1 ||
+        indices_shape.dimensions(dnums.index_vector_dim()) != 1) {
+      return absl::FailedPreconditionError(
+          "Index vector must be the minor dimension of the indices");
+    }
+    --num_batch_dims;
+  }
+
+  absl::Span<const int64_t> slice_sizes = gather->gather_slice_sizes();
+  for (int64_t i = 1; i < operand_shape.rank(); ++i) {
+    if (slice_sizes[i] != operand_shape.dimensions(i)) {
+      return absl::FailedPreconditionError("Gather must copy whole rows");
+    }
+  }
+  for (int64_t i = 0; i < dnums.offset_dims_size(); ++i) {
+    if (dnums.offset_dims(i) != num_batch_dims + i) {
+      return absl::FailedPreconditionError(
+          "Gathered rows must be the minor output dimensions");
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status IrEmitter2::CanDoFastDynamicSlice(
+    const HloInstruction* dynamic_slice) const {
+  const Shape& operand_shape = dynamic_slice->operand(0)->shape();
+  TF_RETURN_IF_ERROR(CheckRowMajorArray(operand_shape));
+  TF_RETURN_IF_ERROR(CheckRowMajorArray(dynamic_slice->shape()));
+  if (operand_shape.rank() == 0 ||
+      ShapeUtil::IsZeroElementArray(dynamic_slice->shape())) {
+    return absl::FailedPreconditionError(
+        "Dynamic slice must copy at least one row");
+  }
+  for (int64_t i = 1; i < operand_shape.rank(); ++i) {
+    if (dynamic_slice->shape().dimensions(i) != operand_shape.dimensions(i)) {
+      return absl::FailedPreconditionError(
+          "Dynamic slice must copy whole rows");
+    }
+  }
+  return absl::OkStatus();
+}
+
 IrEmitter2::ParallelPartitionBounds IrEmitter2::EmitParallelPartitionBounds(
     llvm::IRBuilder<>& b, const KernelPrototype& kernel_prototype,
     const ParallelConfig& parallel_config, const Shape& shape,
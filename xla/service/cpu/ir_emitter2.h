@@ -141,10 +141,24 @@ class IrEmitter2 {
   absl::StatusOr<KernelInfo> EmitConcatenateHostKernel(
       const HloInstruction* instr);
 
+  // Emits a host kernel for the given gather instruction. Gathers of whole rows
+  // along the major operand dimension (embedding lookups) are emitted as a
+  // loop of row copies with software prefetching, parallelized across indices.
+  absl::StatusOr<KernelInfo> EmitGatherHostKernel(const HloInstruction* instr);
+
+  // Emits a host kernel for the given dynamic-slice instruction. Slices of
+  // whole rows are emitted as a single copy.
+  absl::StatusOr<KernelInfo> EmitDynamicSliceHostKernel(
+      const HloInstruction* instr);
+
   // Emits a host kernel for the given dot fusion instruction (output fusion).
   absl::StatusOr<KernelInfo> EmitDotFusionHostKernel(
       const HloFusionInstruction* fusion);
 
+  // Emits a host kernel for an output fusion created by DotEpilogueFusion.
+  absl::StatusOr<KernelInfo> EmitDotEpilogueFusionHostKernel(
+      const HloFusionInstruction* fusion, const HloInstruction* dot);
+
   // Emits a host kernel for the given slice-to-dynamic instruction.
   absl::StatusOr<KernelInfo> EmitSliceToDynamicHostKernel(
       const HloInstruction* instr);
@@ -239,6 +253,8 @@ class IrEmitter2 {
   std::optional<ParallelConfig> GetParallelConfig(const HloInstruction* instr);
 
   absl::Status CanDoFastConcatenate(const HloInstruction* concatenate) const;
+  absl::Status CanDoFastGather(const HloInstruction* gather) const;
+  absl::Status CanDoFastDynamicSlice(const HloInstruction* dynamic_slice) const;
 
   // Emits LLVM IR that computes parallel partition bounds from the call frame's
   // block and thread dimensions and parallel execution config.
@@ -280,6 +280,104 @@ TEST_F(IrEmitter2Test, EmitParallelKernel) {
   )"));
 }
 
+TEST_F(IrEmitter2Test, EmitPartitionedDotKernel) {
+  llvm::LLVMContext context;
+  auto module = std::make_unique<llvm::Module>("test", context);
+
+  const char* hlo_text = R"(
+    HloModule m
+    ENTRY main {
+      p0 = f32[256,256] parameter(0)
+      p1 = f32[256,256] parameter(1)
+      ROOT dot = f32[256,256] dot(p0, p1),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    })";
+
+  HloModuleConfig config = GetModuleConfigForTest();
+  DebugOptions debug_options = config.debug_options();
+  (*debug_options.mutable_xla_backend_extra_options())
+      ["xla_llvm_ir_gemm_max_parallelism"] = "4";
+  config.set_debug_options(debug_options);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo,
+                          ParseAndReturnUnverifiedModule(hlo_text, config));
+  TF_ASSERT_OK_AND_ASSIGN(IrEmitter2 ir_emitter, MakeIrEmitter2(*module, *hlo));
+  TF_ASSERT_OK_AND_ASSIGN(
+      IrEmitter2::KernelInfo kernel,
+      ir_emitter.EmitDotHostKernel(FindInstruction(hlo.get(), "dot")));
+
+  // 256 rows are split into three partitions of 66 rows and one of 58 rows.
+  EXPECT_EQ(kernel.thread_dims.x, 4);
+  ASSERT_TRUE(*RunFileCheck(llvm_ir::DumpToString(module.get()), R"(
+    CHECK: define ptr @dot(ptr %0) #0 {
+    CHECK:   mul i64 %tid_x, 66
+    CHECK:   icmp ult i64 %tid_x, 3
+    CHECK: }
+  )"));
+}
+
+TEST_F(IrEmitter2Test, EmitRowGatherKernel) {
+  llvm::LLVMContext context;
+  auto module = std::make_unique<llvm::Module>("test", context);
+
+  const char* hlo_text = R"(
+    HloModule m
+    ENTRY main {
+      operand = f32[1000,64] parameter(0)
+      indices = s32[256,1] parameter(1)
+      ROOT gather = f32[256,64] gather(operand, indices),
+        offset_dims={1}, collapsed_slice_dims={0}, start_index_map={0},
+        index_vector_dim=1, slice_sizes={1,64},
+        backend_config={"outer_dimension_partitions":["4"]}
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo, ParseAndReturnUnverifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(IrEmitter2 ir_emitter, MakeIrEmitter2(*module, *hlo));
+  TF_ASSERT_OK_AND_ASSIGN(
+      IrEmitter2::KernelInfo kernel,
+      ir_emitter.EmitGatherHostKernel(FindInstruction(hlo.get(), "gather")));
+
+  // 256 rows of 64 floats are split into four partitions of 64 rows.
+  EXPECT_EQ(kernel.thread_dims.x, 4);
+  ASSERT_TRUE(*RunFileCheck(llvm_ir::DumpToString(module.get()), R"(
+    CHECK: define ptr @gather(ptr %0) #0 {
+    CHECK:   mul i64 %tid_x, 64
+    CHECK:   call void @llvm.prefetch.p0(ptr {{.*}}, i32 0, i32 3, i32 1)
+    CHECK:   call void @llvm.memcpy.p0.p0.i64(ptr {{.*}}, ptr {{.*}}, i64 256
+    CHECK: }
+  )"));
+}
+
+TEST_F(IrEmitter2Test, EmitRowDynamicSliceKernel) {
+  llvm::LLVMContext context;
+  auto module = std::make_unique<llvm::Module>("test", context);
+
+  const char* hlo_text = R"(
+    HloModule m
+    ENTRY main {
+      operand = f32[1000,64] parameter(0)
+      i0 = s32[] parameter(1)
+      i1 = s32[] parameter(2)
+      ROOT slice = f32[16,64] dynamic-slice(operand, i0, i1),
+        dynamic_slice_sizes={16,64}
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo, ParseAndReturnUnverifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(IrEmitter2 ir_emitter, MakeIrEmitter2(*module, *hlo));
+  TF_ASSERT_OK_AND_ASSIGN(IrEmitter2::KernelInfo kernel,
+                          ir_emitter.EmitDynamicSliceHostKernel(
+                              FindInstruction(hlo.get(), "slice")));
+
+  // The start index is clamped to [0, 1000 - 16] and the slice is copied with
+  // a single memcpy of 16 rows.
+  ASSERT_TRUE(*RunFileCheck(llvm_ir::DumpToString(module.get()), R"(
+    CHECK: define ptr @slice(ptr %0) #0 {
+    CHECK:   icmp sgt i64 {{.*}}, 984
+    CHECK:   call void @llvm.memcpy.p0.p0.i64(ptr {{.*}}, ptr {{.*}}, i64 4096
+    CHECK: }
+  )"));
+}
+
 using IrEmitter2InvariantBuffersTest = IrEmitter2Test;
 
 TEST_F(IrEmitter2InvariantBuffersTest, AllInvariantBuffers) {
@@ -0,0 +1,126 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/jit_compilation_cache.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "llvm/TargetParser/Host.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/cpu/simple_orc_jit.h"
+#include "xla/service/persistent_cache_file.h"
+#include "xla/tsl/lib/strings/proto_serialization.h"
+#include "xla/xla.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/protobuf.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::cpu {
+namespace {
+
+// Bump this version whenever you change the structure of the cached results or
+// the way we compute cache keys.
+constexpr int kVersion = 1;
+
+// Returns debug options that might affect the compiled code. We conservatively
+// keep all debug options except the ones that only control dumping and the
+// location of the cache itself.
+DebugOptions CodegenDebugOptions(const DebugOptions& debug_options) {
+  DebugOptions options = debug_options;
+
+  const tsl::protobuf::Descriptor* descriptor = options.GetDescriptor();
+  const tsl::protobuf::Reflection* reflection = options.GetReflection();
+  for (int i = 0; i < descriptor->field_count(); ++i) {
+    const tsl::protobuf::FieldDescriptor* field = descriptor->field(i);
+    if (absl::StartsWith(field->name(), "xla_dump_")) {
+      reflection->ClearField(&options, field);
+    }
+  }
+
+  options.clear_xla_cpu_jit_cache_dir();
+  return options;
+}
+
+// Returns a description of the host target machine that XLA:CPU compiles for.
+std::string HostTargetMachine(const DebugOptions& debug_options) {
+  DetectedMachineAttributes attrs = DetectMachineAttributes(
+      ISAStringToFeature(debug_options.xla_cpu_max_isa()));
+  return absl::StrCat(llvm::sys::getProcessTriple(), ";",
+                      llvm::sys::getHostCPUName().str(), ";",
+                      absl::StrJoin(attrs.features, ","));
+}
+
+}  // namespace
+
+JitCompilationCache::JitCompilationCache(std::string cache_dir, tsl::Env* env)
+    : cache_dir_(std::move(cache_dir)), env_(env) {}
+
+std::string JitCompilationCache::GetCacheKey(const HloModule& module) {
+  const DebugOptions& debug_options = module.config().debug_options();
+
+  // We can't use default module fingerprint options, as they skip constant
+  // values that are embedded into the compiled object files.
+  std::string module_fingerprint =
+      module.GetFingerprint128(HloPrintOptions::ModuleFingerprint()
+                                   .set_print_only_essential_constants(false)
+                                   .set_print_large_constants(true));
+
+  std::string serialized_debug_options;
+  tsl::SerializeToStringDeterministic(CodegenDebugOptions(debug_options),
+                                      &serialized_debug_options);
+
+  tsl::Fprint128 fingerprint = tsl::Fingerprint128(absl::StrCat(
+      "version=", kVersion, ";module=", module_fingerprint,
+      ";target=", HostTargetMachine(debug_options),
+      ";debug_options=", serialized_debug_options));
+
+  return absl::StrFormat("%016x%016x", fingerprint.high64, fingerprint.low64);
+}
+
+std::string JitCompilationCache::GetCacheFilePath(absl::string_view key) const {
+  return tsl::io::JoinPath(cache_dir_, absl::StrCat(key, ".pb"));
+}
+
+absl::StatusOr<std::optional<std::string>> JitCompilationCache::Lookup(
+    absl::string_view key) const {
+  std::string file_path = GetCacheFilePath(key);
+  TF_ASSIGN_OR_RETURN(std::optional<std::string> serialized_result,
+                      ReadPersistentCacheFile(env_, file_path));
+  VLOG(2) << "XLA:CPU compilation cache "
+          << (serialized_result.has_value() ? "hit: " : "miss: ") << file_path;
+  return serialized_result;
+}
+
+absl::Status JitCompilationCache::Insert(
+    absl::string_view key, absl::string_view serialized_result) const {
+  std::string file_path = GetCacheFilePath(key);
+  VLOG(2) << "Write XLA:CPU compilation result to: " << file_path;
+  return WritePersistentCacheFile(env_, file_path, serialized_result);
+}
+
+}  // namespace xla::cpu
@@ -0,0 +1,71 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_JIT_COMPILATION_CACHE_H_
+#define XLA_SERVICE_CPU_JIT_COMPILATION_CACHE_H_
+
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "tsl/platform/env.h"
+
+namespace xla::cpu {
+
+// A persistent content-addressed on-disk cache of XLA:CPU compilation results.
+// Cache entries are serialized `CompilationResultProto` (object files together
+// with the metadata required to load them), and they are keyed by the
+// fingerprint of the optimized HLO module, host target machine features, and
+// debug options that affect LLVM code generation.
+//
+// Entries are written with a write-to-temp-file + rename trick, so concurrent
+// writers never produce partially written entries, and readers never observe
+// them. Cache invalidation (e.g. after XLA version upgrade) has to be handled
+// by the user, although the cache key includes a version number that we bump
+// whenever the format of cached results changes.
+class JitCompilationCache {
+ public:
+  explicit JitCompilationCache(std::string cache_dir,
+                               tsl::Env* env = tsl::Env::Default());
+
+  // Returns a cache key for the optimized HLO module compiled for the host
+  // target machine. Keys are safe to use as file names.
+  static std::string GetCacheKey(const HloModule& module);
+
+  // Returns a serialized compilation result for the given key, or std::nullopt
+  // if the cache doesn't have an entry for the key.
+  absl::StatusOr<std::optional<std::string>> Lookup(
+      absl::string_view key) const;
+
+  // Stores a serialized compilation result for the given key. If the cache
+  // already has an entry for the key, it is replaced atomically.
+  absl::Status Insert(absl::string_view key,
+                      absl::string_view serialized_result) const;
+
+  absl::string_view cache_dir() const { return cache_dir_; }
+
+ private:
+  std::string GetCacheFilePath(absl::string_view key) const;
+
+  std::string cache_dir_;
+  tsl::Env* env_;
+};
+
+}  // namespace xla::cpu
+
+#endif  // XLA_SERVICE_CPU_JIT_COMPILATION_CACHE_H_
@@ -0,0 +1,116 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/jit_compilation_cache.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/tests/hlo_test_base.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace xla::cpu {
+namespace {
+
+class JitCompilationCacheTest : public HloTestBase {};
+
+constexpr absl::string_view kModuleWithConstant = R"(
+  HloModule m
+
+  ENTRY e {
+    p0 = f32[4] parameter(0)
+    c0 = f32[4] constant({1.5, 2.5, 3.5, 4.5})
+    ROOT add = f32[4] add(p0, c0)
+  })";
+
+constexpr absl::string_view kModuleWithOtherConstant = R"(
+  HloModule m
+
+  ENTRY e {
+    p0 = f32[4] parameter(0)
+    c0 = f32[4] constant({1.5, 2.5, 3.5, 5.5})
+    ROOT add = f32[4] add(p0, c0)
+  })";
+
+TEST_F(JitCompilationCacheTest, CacheKeyIsDeterministic) {
+  TF_ASSERT_OK_AND_ASSIGN(auto m0,
+                          ParseAndReturnVerifiedModule(kModuleWithConstant));
+  TF_ASSERT_OK_AND_ASSIGN(auto m1,
+                          ParseAndReturnVerifiedModule(kModuleWithConstant));
+
+  EXPECT_EQ(JitCompilationCache::GetCacheKey(*m0),
+            JitCompilationCache::GetCacheKey(*m1));
+}
+
+TEST_F(JitCompilationCacheTest, CacheKeyDependsOnConstantValues) {
+  TF_ASSERT_OK_AND_ASSIGN(auto m0,
+                          ParseAndReturnVerifiedModule(kModuleWithConstant));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto m1, ParseAndReturnVerifiedModule(kModuleWithOtherConstant));
+
+  EXPECT_NE(JitCompilationCache::GetCacheKey(*m0),
+            JitCompilationCache::GetCacheKey(*m1));
+}
+
+TEST_F(JitCompilationCacheTest, CacheKeyDependsOnCodegenDebugOptions) {
+  TF_ASSERT_OK_AND_ASSIGN(auto m,
+                          ParseAndReturnVerifiedModule(kModuleWithConstant));
+  std::string key = JitCompilationCache::GetCacheKey(*m);
+
+  // Dump options do not change the compiled code.
+  DebugOptions debug_options = m->config().debug_options();
+  debug_options.set_xla_dump_to("/tmp/dump");
+  debug_options.set_xla_cpu_jit_cache_dir("/tmp/cache");
+  m->mutable_config().set_debug_options(debug_options);
+  EXPECT_EQ(JitCompilationCache::GetCacheKey(*m), key);
+
+  debug_options.set_xla_cpu_enable_fast_math(
+      !debug_options.xla_cpu_enable_fast_math());
+  m->mutable_config().set_debug_options(debug_options);
+  EXPECT_NE(JitCompilationCache::GetCacheKey(*m), key);
+}
+
+TEST_F(JitCompilationCacheTest, InsertAndLookup) {
+  std::string cache_dir =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "jit_compilation_cache");
+  JitCompilationCache cache(cache_dir);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::optional<std::string> missing,
+                          cache.Lookup("key"));
+  EXPECT_FALSE(missing.has_value());
+
+  TF_ASSERT_OK(cache.Insert("key", "compiled"));
+  TF_ASSERT_OK_AND_ASSIGN(std::optional<std::string> found,
+                          cache.Lookup("key"));
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(*found, "compiled");
+
+  // Inserting an entry for the same key replaces the existing one.
+  TF_ASSERT_OK(cache.Insert("key", "recompiled"));
+  TF_ASSERT_OK_AND_ASSIGN(found, cache.Lookup("key"));
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(*found, "recompiled");
+}
+
+}  // namespace
+}  // namespace xla::cpu
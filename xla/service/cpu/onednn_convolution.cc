@@ -21,6 +21,9 @@ limitations under the License.
 #include <cmath>
 #include <cstring>
 #include <initializer_list>
+#include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -33,6 +36,7 @@ limitations under the License.
 #include "xla/service/cpu/backend_config.pb.h"
 #include "xla/service/cpu/onednn_config.pb.h"
 #include "xla/service/cpu/onednn_memory_util.h"
+#include "xla/service/cpu/onednn_util.h"
 #include "xla/service/cpu/runtime_lightweight_check.h"
 #include "xla/tsl/util/onednn_threadpool.h"
 #include "tsl/platform/logging.h"
@@ -47,12 +51,20 @@ using dnnl::prop_kind;
 using dnnl::stream;
 }  // namespace
 
-dnnl::memory ReorderMemory(const dnnl::engine& engine,
+dnnl::reorder MakeReorder(const dnnl::engine& engine,
+                          const dnnl::memory::desc& src_md,
+                          const dnnl::memory::desc& dest_md) {
+  return dnnl::reorder(
+      dnnl::reorder::primitive_desc(engine, src_md, engine, dest_md));
+}
+
+dnnl::memory ReorderMemory(const dnnl::reorder& reorder,
+                           const dnnl::engine& engine,
                            const dnnl::memory::desc& dest_md,
                            dnnl::memory& src_mem,
                            const dnnl::stream& onednn_stream) {
   auto dest_mem = memory(dest_md, engine);
-  dnnl::reorder(src_mem, dest_mem).execute(onednn_stream, src_mem, dest_mem);
+  reorder.execute(onednn_stream, src_mem, dest_mem);
   return dest_mem;
 }
 
@@ -70,6 +82,28 @@ GetKernelConfig<kOnednnConvConfig>(
   return (*backend_config)->mutable_onednn_conv_config();
 }
 
+namespace {
+
+// A convolution primitive cached across runtime calls with the same config and
+// operand memory descriptors, together with the reorders between the operand
+// layouts and the memory formats picked by the primitive.
+struct CachedConvolution {
+  std::unique_ptr<convolution_forward::primitive_desc> conv_pd;
+  convolution_forward conv_prim;
+  std::optional<dnnl::reorder> src_reorder;
+  std::optional<dnnl::reorder> weights_reorder;
+  std::optional<dnnl::reorder> dst_reorder;
+  // Execution argument index and memory descriptor of every fused operand.
+  std::vector<std::pair<int, memory::desc>> postop_arg_descs;
+};
+
+OneDnnPrimitiveCache<CachedConvolution>& GetConvolutionCache() {
+  static auto* cache = new OneDnnPrimitiveCache<CachedConvolution>();
+  return *cache;
+}
+
+}  // namespace
+
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnConvolution(
     void* result, void** args) {
   // args[0]: ptr to nargs
@@ -85,7 +119,7 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnConvolution(
   XLA_LIGHTWEIGHT_CHECK(run_options->intra_op_thread_pool() != nullptr);
   tsl::OneDnnThreadPool thread_pool(
       run_options->intra_op_thread_pool()->getPool(), false);
-  dnnl::engine cpu_engine(dnnl::engine::kind::cpu, 0);
+  const dnnl::engine& cpu_engine = GetOneDnnCpuEngine();
 #ifndef ENABLE_ONEDNN_OPENMP
   auto onednn_stream =
       stream(dnnl::threadpool_interop::make_stream(cpu_engine, &thread_pool));
@@ -189,93 +223,119 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnConvolution(
     fused_bufs.push_back(operand_minfo.Data());
   }
 
-  std::vector<std::pair<int, dnnl::memory>> postop_args;
-
-  auto bias_md = memory::desc();
-
-  dnnl::post_ops post_ops;
-  int fused_operand_idx = 0;
-  for (auto& fused_op : conv_config.fusions().ops()) {
-    switch (fused_op) {
-      case OneDnnFusionConfig::BIAS: {
-        bias_md = fused_mds.at(fused_operand_idx);
-        postop_args.emplace_back(
-            DNNL_ARG_BIAS,
-            dnnl::memory(bias_md, cpu_engine, fused_bufs[fused_operand_idx]));
-        fused_operand_idx++;
-      } break;
-      case OneDnnFusionConfig::BINARY_ADD: {
-        auto binary_md = fused_mds.at(fused_operand_idx);
-        binary_md = binary_md.permute_axes(out_axes);
-        auto arg_idx =
-            DNNL_ARG_ATTR_MULTIPLE_POST_OP(post_ops.len()) | DNNL_ARG_SRC_1;
-        postop_args.emplace_back(
-            arg_idx,
-            dnnl::memory(binary_md, cpu_engine, fused_bufs[fused_operand_idx]));
-        post_ops.append_binary(dnnl::algorithm::binary_add, binary_md);
-        fused_operand_idx++;
-      } break;
-      default:
-        LOG(FATAL)
-            << __FILE__ << ":" << __LINE__
-            << " Attempt to call OneDNN Convolution runtime library with "
-               "unsupported post op."
-            << std::endl;
-    }
-  }
-
-  auto any_ker_md =
-      memory::desc(new_ker_md.get_dims(), new_ker_md.get_data_type(),
-                   dnnl::memory::format_tag::any);
-  auto any_inp_md =
-      memory::desc(new_inp_md.get_dims(), new_inp_md.get_data_type(),
-                   GetFormatTag(new_inp_md.get_ndims()));
-  auto any_res_md =
-      memory::desc(new_res_md.get_dims(), new_res_md.get_data_type(),
-                   GetFormatTag(new_res_md.get_ndims()));
-
   XLA_LIGHTWEIGHT_CHECK(num_args == arg_indx);
 
-  dnnl::primitive_attr attrs;
-  if (post_ops.len() > 0) {
-    attrs.set_post_ops(post_ops);
+  // Steady-state calls find the primitive and the reorders into its memory
+  // formats in the cache, and only bind the operand buffers before executing.
+  std::string cache_key = config_str;
+  AppendMemDescToKey(new_inp_md, &cache_key);
+  AppendMemDescToKey(new_ker_md, &cache_key);
+  AppendMemDescToKey(new_res_md, &cache_key);
+  for (const memory::desc& fused_md : fused_mds) {
+    AppendMemDescToKey(fused_md, &cache_key);
   }
 
-  auto conv_pd = std::make_unique<convolution_forward::primitive_desc>(
-      cpu_engine, prop_kind::forward_inference, algorithm::convolution_direct,
-      any_inp_md, any_ker_md, bias_md, any_res_md, strides, rhs_dilations,
-      pad_left, pad_right, attrs);
+  std::shared_ptr<const CachedConvolution> cached =
+      GetConvolutionCache().GetOrCreate(cache_key, [&] {
+        auto entry = std::make_unique<CachedConvolution>();
+        auto bias_md = memory::desc();
+
+        dnnl::post_ops post_ops;
+        int fused_operand_idx = 0;
+        for (auto& fused_op : conv_config.fusions().ops()) {
+          switch (fused_op) {
+            case OneDnnFusionConfig::BIAS: {
+              bias_md = fused_mds.at(fused_operand_idx);
+              entry->postop_arg_descs.emplace_back(DNNL_ARG_BIAS, bias_md);
+              fused_operand_idx++;
+            } break;
+            case OneDnnFusionConfig::BINARY_ADD: {
+              auto binary_md = fused_mds.at(fused_operand_idx);
+              binary_md = binary_md.permute_axes(out_axes);
+              auto arg_idx = DNNL_ARG_ATTR_MULTIPLE_POST_OP(post_ops.len()) |
+                             DNNL_ARG_SRC_1;
+              entry->postop_arg_descs.emplace_back(arg_idx, binary_md);
+              post_ops.append_binary(dnnl::algorithm::binary_add, binary_md);
+              fused_operand_idx++;
+            } break;
+            default:
+              LOG(FATAL)
+                  << __FILE__ << ":" << __LINE__
+                  << " Attempt to call OneDNN Convolution runtime library with "
+                     "unsupported post op."
+                  << std::endl;
+          }
+        }
+
+        auto any_ker_md =
+            memory::desc(new_ker_md.get_dims(), new_ker_md.get_data_type(),
+                         dnnl::memory::format_tag::any);
+        auto any_inp_md =
+            memory::desc(new_inp_md.get_dims(), new_inp_md.get_data_type(),
+                         GetFormatTag(new_inp_md.get_ndims()));
+        auto any_res_md =
+            memory::desc(new_res_md.get_dims(), new_res_md.get_data_type(),
+                         GetFormatTag(new_res_md.get_ndims()));
+
+        dnnl::primitive_attr attrs;
+        if (post_ops.len() > 0) {
+          attrs.set_post_ops(post_ops);
+        }
+
+        entry->conv_pd = std::make_unique<convolution_forward::primitive_desc>(
+            cpu_engine, prop_kind::forward_inference,
+            algorithm::convolution_direct, any_inp_md, any_ker_md, bias_md,
+            any_res_md, strides, rhs_dilations, pad_left, pad_right, attrs);
+        entry->conv_prim = convolution_forward(*entry->conv_pd);
+
+        // Stash the reorders between the operand layouts and the memory
+        // formats picked by the primitive.
+        if (entry->conv_pd->src_desc() != new_inp_md) {
+          entry->src_reorder =
+              MakeReorder(cpu_engine, new_inp_md, entry->conv_pd->src_desc());
+        }
+        if (entry->conv_pd->weights_desc() != new_ker_md) {
+          entry->weights_reorder = MakeReorder(cpu_engine, new_ker_md,
+                                               entry->conv_pd->weights_desc());
+        }
+        if (entry->conv_pd->dst_desc() != new_res_md) {
+          entry->dst_reorder =
+              MakeReorder(cpu_engine, entry->conv_pd->dst_desc(), new_res_md);
+        }
+        return entry;
+      });
+  const convolution_forward::primitive_desc& conv_pd = *cached->conv_pd;
 
   auto inp_mem = memory(new_inp_md, cpu_engine, inp_minfo.Data());
   auto ker_mem = memory(new_ker_md, cpu_engine, ker_minfo.Data());
   auto res_mem = memory(new_res_md, cpu_engine, res_minfo.Data());
 
-  auto new_inp_mem = (conv_pd->src_desc() == inp_mem.get_desc())
-                         ? inp_mem
-                         : ReorderMemory(cpu_engine, conv_pd->src_desc(),
-                                         inp_mem, onednn_stream);
-  auto new_ker_mem = (conv_pd->weights_desc() == ker_mem.get_desc())
-                         ? ker_mem
-                         : ReorderMemory(cpu_engine, conv_pd->weights_desc(),
-                                         ker_mem, onednn_stream);
-  auto new_res_mem = (conv_pd->dst_desc() == res_mem.get_desc())
-                         ? res_mem
-                         : memory(conv_pd->dst_desc(), cpu_engine);
-
-  auto conv_prim = convolution_forward(*conv_pd);
+  auto new_inp_mem = cached->src_reorder
+                         ? ReorderMemory(*cached->src_reorder, cpu_engine,
+                                         conv_pd.src_desc(), inp_mem,
+                                         onednn_stream)
+                         : inp_mem;
+  auto new_ker_mem = cached->weights_reorder
+                         ? ReorderMemory(*cached->weights_reorder, cpu_engine,
+                                         conv_pd.weights_desc(), ker_mem,
+                                         onednn_stream)
+                         : ker_mem;
+  auto new_res_mem = cached->dst_reorder
+                         ? memory(conv_pd.dst_desc(), cpu_engine)
+                         : res_mem;
 
   std::unordered_map<int, memory> conv_args{{DNNL_ARG_SRC, new_inp_mem},
                                             {DNNL_ARG_WEIGHTS, new_ker_mem},
                                             {DNNL_ARG_DST, new_res_mem}};
 
-  conv_args.insert(postop_args.begin(), postop_args.end());
-  conv_prim.execute(onednn_stream, conv_args);
+  for (size_t i = 0; i < cached->postop_arg_descs.size(); ++i) {
+    const auto& [arg_idx, arg_md] = cached->postop_arg_descs[i];
+    conv_args.insert({arg_idx, memory(arg_md, cpu_engine, fused_bufs.at(i))});
+  }
+  cached->conv_prim.execute(onednn_stream, conv_args);
 
-  if (conv_pd->dst_desc() == res_mem.get_desc()) {
-    res_mem = new_res_mem;
-  } else {
-    dnnl::reorder(new_res_mem, res_mem)
-        .execute(onednn_stream, new_res_mem, res_mem);
+  if (cached->dst_reorder) {
+    cached->dst_reorder->execute(onednn_stream, new_res_mem, res_mem);
   }
 }
 
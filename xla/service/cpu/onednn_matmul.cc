@@ -20,6 +20,8 @@ limitations under the License.
 #include <cstring>
 #include <initializer_list>
 #include <iterator>
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -104,17 +106,16 @@ Shape OneDnnMatMulOptWeightsShape(const Shape& input_shape,
   return MemDescToXlaShapeFlattened(optimized_weights_md);
 }
 
-struct FusedOperandsRef {
-  const std::vector<void*>& bufs;
-  std::vector<std::pair<int, dnnl::memory>>& postop_args;
-};
+// Execution argument index and memory descriptor of every fused operand, in
+// the order of the fused operands of the custom call.
+using PostOpArgDescs = std::vector<std::pair<int, memory::desc>>;
 
 std::unique_ptr<matmul::primitive_desc> CreateMatMulPrimDesc(
     const engine& cpu_engine, const memory::desc& input_md,
     const memory::desc& plain_weights_md, const memory::desc& output_md,
     const std::vector<memory::desc>& fused_mds,
     const OneDnnMatMulConfig& matmul_config,
-    FusedOperandsRef* fused_operands_ref = nullptr) {
+    PostOpArgDescs* postop_arg_descs = nullptr) {
   auto bias_md = memory::desc();
   bool weights_packed = matmul_config.optimization_config().weights_prepacked();
   auto weights_md = plain_weights_md;
@@ -155,11 +156,8 @@ std::unique_ptr<matmul::primitive_desc> CreateMatMulPrimDesc(
           bias_dims.insert(bias_dims.begin(), missed_rank, 1);
           bias_md = bias_md.reshape(bias_dims);
         }
-        if (fused_operands_ref) {
-          fused_operands_ref->postop_args.emplace_back(
-              DNNL_ARG_BIAS,
-              dnnl::memory(bias_md, cpu_engine,
-                           fused_operands_ref->bufs[fused_operand_idx]));
+        if (postop_arg_descs) {
+          postop_arg_descs->emplace_back(DNNL_ARG_BIAS, bias_md);
         }
         fused_operand_idx++;
       } break;
@@ -176,13 +174,10 @@ std::unique_ptr<matmul::primitive_desc> CreateMatMulPrimDesc(
           binary_dims.insert(binary_dims.begin(), missed_rank, 1);
           binary_md = binary_md.reshape(binary_dims);
         }
-        if (fused_operands_ref) {
+        if (postop_arg_descs) {
           auto arg_idx =
               DNNL_ARG_ATTR_MULTIPLE_POST_OP(post_ops.len()) | DNNL_ARG_SRC_1;
-          fused_operands_ref->postop_args.emplace_back(
-              arg_idx,
-              dnnl::memory(binary_md, cpu_engine,
-                           fused_operands_ref->bufs[fused_operand_idx]));
+          postop_arg_descs->emplace_back(arg_idx, binary_md);
         }
         post_ops.append_binary(dnnl::algorithm::binary_add, binary_md);
         fused_operand_idx++;
@@ -269,6 +264,23 @@ CreateOneDnnPrimDesc<dnnl::matmul::primitive_desc>(HloInstruction* instr) {
                               fused_shapes, matmul_config);
 }
 
+namespace {
+
+// A matmul primitive cached across runtime calls with the same config and
+// operand memory descriptors.
+struct CachedMatMul {
+  std::unique_ptr<matmul::primitive_desc> matmul_pd;
+  matmul matmul_prim;
+  PostOpArgDescs postop_arg_descs;
+};
+
+OneDnnPrimitiveCache<CachedMatMul>& GetMatMulCache() {
+  static auto* cache = new OneDnnPrimitiveCache<CachedMatMul>();
+  return *cache;
+}
+
+}  // namespace
+
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnMatMul(
     void* result, void* scratch, void** args) {
   // args[0]: ptr to nargs
@@ -282,7 +294,7 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnMatMul(
       static_cast<const xla::ExecutableRunOptions*>(args[arg_indx++]);
   auto thread_pool = CreateOneDnnThreadPool(
       run_options ? run_options->intra_op_thread_pool() : nullptr);
-  engine cpu_engine(engine::kind::cpu, 0);
+  const engine& cpu_engine = GetOneDnnCpuEngine();
   auto onednn_stream = MakeOneDnnStream(cpu_engine, thread_pool.get());
 
   std::string config_str(static_cast<const char*>(args[arg_indx++]));
@@ -321,25 +333,38 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnMatMul(
     fused_bufs.push_back(operand_minfo.Data());
   }
 
-  std::vector<std::pair<int, dnnl::memory>> postop_args;
-  FusedOperandsRef fused_operands_ref{fused_bufs, postop_args};
-  auto matmul_pd =
-      CreateMatMulPrimDesc(cpu_engine, input_md, weights_md, output_md,
-                           fused_mds, matmul_config, &fused_operands_ref);
-
   XLA_LIGHTWEIGHT_CHECK(num_args == arg_indx);
 
+  // Steady-state calls find the primitive in the cache and only bind the
+  // operand buffers before executing it.
+  std::string cache_key = config_str;
+  AppendMemDescToKey(input_md, &cache_key);
+  AppendMemDescToKey(weights_md, &cache_key);
+  AppendMemDescToKey(output_md, &cache_key);
+  for (const memory::desc& fused_md : fused_mds) {
+    AppendMemDescToKey(fused_md, &cache_key);
+  }
+
+  std::shared_ptr<const CachedMatMul> cached =
+      GetMatMulCache().GetOrCreate(cache_key, [&] {
+        auto entry = std::make_unique<CachedMatMul>();
+        entry->matmul_pd = CreateMatMulPrimDesc(
+            cpu_engine, input_md, weights_md, output_md, fused_mds,
+            matmul_config, &entry->postop_arg_descs);
+        if (std::strstr(entry->matmul_pd->impl_info_str(), "ref") != nullptr) {
+          LOG(WARNING)
+              << "[Perf]: MatMul reference implementation being executed";
+        }
+        entry->matmul_prim = matmul(*entry->matmul_pd);
+        return entry;
+      });
+  const matmul::primitive_desc& matmul_pd = *cached->matmul_pd;
+
   auto lhs_mem = memory(input_md, cpu_engine, input_minfo.Data());
   auto rhs_mem =
-      memory(matmul_pd->weights_desc(), cpu_engine, weights_minfo.Data());
+      memory(matmul_pd.weights_desc(), cpu_engine, weights_minfo.Data());
   auto result_mem = memory(output_md, cpu_engine, output_minfo.Data());
 
-  if (std::strstr(matmul_pd->impl_info_str(), "ref") != nullptr) {
-    LOG(WARNING) << "[Perf]: MatMul reference implementation being executed";
-  }
-
-  auto matmul_prim = matmul(*matmul_pd);
-
   std::unordered_map<int, memory> matmul_args{{DNNL_ARG_SRC, lhs_mem},
                                               {DNNL_ARG_WEIGHTS, rhs_mem},
                                               {DNNL_ARG_DST, result_mem}};
@@ -347,14 +372,17 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnMatMul(
   if (matmul_config.optimization_config().user_scratchpad()) {
     XLA_LIGHTWEIGHT_CHECK(scratch != nullptr);
     MemrefInfo scratch_minfo(scratch);
-    auto scratchpad_md = matmul_pd->scratchpad_desc();
+    auto scratchpad_md = matmul_pd.scratchpad_desc();
     auto scratch_mem = memory(scratchpad_md, cpu_engine, scratch_minfo.Data());
     matmul_args.insert({DNNL_ARG_SCRATCHPAD, scratch_mem});
   }
 
-  matmul_args.insert(postop_args.begin(), postop_args.end());
+  for (size_t i = 0; i < cached->postop_arg_descs.size(); ++i) {
+    const auto& [arg_idx, arg_md] = cached->postop_arg_descs[i];
+    matmul_args.insert({arg_idx, memory(arg_md, cpu_engine, fused_bufs.at(i))});
+  }
 
-  matmul_prim.execute(onednn_stream, matmul_args);
+  cached->matmul_prim.execute(onednn_stream, matmul_args);
 }
 
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnMatMulReorder(
@@ -16,6 +16,12 @@ limitations under the License.
 
 #include "xla/service/cpu/onednn_util.h"
 
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+
 #define EIGEN_USE_THREADS
 
 namespace xla {
@@ -40,6 +46,22 @@ dnnl::stream MakeOneDnnStream(
              : dnnl::stream(cpu_engine);
 }
 
+const dnnl::engine& GetOneDnnCpuEngine() {
+  static const dnnl::engine* cpu_engine =
+      new dnnl::engine(dnnl::engine::kind::cpu, 0);
+  return *cpu_engine;
+}
+
+void AppendMemDescToKey(const dnnl::memory::desc& md, std::string* key) {
+  if (md.is_zero()) {
+    absl::StrAppend(key, "[]");
+    return;
+  }
+  absl::StrAppend(key, "[", static_cast<int>(md.get_data_type()), ":",
+                  absl::StrJoin(md.get_dims(), "x"), ":",
+                  absl::StrJoin(md.get_strides(), ","), "]");
+}
+
 }  // namespace cpu
 }  // namespace xla
 
@@ -20,6 +20,14 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
 #include "unsupported/Eigen/CXX11/Tensor"
 #include "dnnl.hpp"
 #include "xla/hlo/ir/hlo_instruction.h"
@@ -59,6 +67,52 @@ dnnl::stream MakeOneDnnStream(
     const dnnl::engine& cpu_engine,
     dnnl::threadpool_interop::threadpool_iface* thread_pool);
 
+// Returns the CPU engine shared by all cached oneDNN primitives. oneDNN
+// requires a primitive to be executed on a stream of the engine it was created
+// for, so runtime calls that reuse cached primitives must use this engine.
+const dnnl::engine& GetOneDnnCpuEngine();
+
+// Appends the dims, data type and strides of `md` to a primitive cache key.
+void AppendMemDescToKey(const dnnl::memory::desc& md, std::string* key);
+
+// A thread-safe cache of oneDNN primitives used by the custom call runtime
+// functions. Creating a primitive descriptor and a primitive is much more
+// expensive than executing a small primitive, so runtime functions look up the
+// primitive by a key built from the serialized op config and the operand memory
+// descriptors, and only create it the first time they see a key. Entries are
+// immutable once created and can be shared by concurrent calls.
+template <typename Entry>
+class OneDnnPrimitiveCache {
+ public:
+  // The cache is cleared when it grows above this size, to bound the memory
+  // held by programs with many distinct (e.g. dynamically shaped) ops.
+  static constexpr size_t kMaxEntries = 1024;
+
+  std::shared_ptr<const Entry> GetOrCreate(
+      const std::string& key,
+      absl::FunctionRef<std::unique_ptr<Entry>()> create) {
+    {
+      absl::MutexLock lock(&mu_);
+      if (auto it = entries_.find(key); it != entries_.end()) {
+        return it->second;
+      }
+    }
+
+    // Create the primitive without holding the lock. Concurrent misses for
+    // the same key create it twice and only the first one is kept.
+    std::shared_ptr<const Entry> entry = create();
+
+    absl::MutexLock lock(&mu_);
+    if (entries_.size() >= kMaxEntries) entries_.clear();
+    return entries_.try_emplace(key, std::move(entry)).first->second;
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<const Entry>> entries_
+      ABSL_GUARDED_BY(mu_);
+};
+
 typedef BackendConfig::BackendConfigOneofCase BackendConfigOneofCase;
 
 // These template functions must have explicit specialization at the definition
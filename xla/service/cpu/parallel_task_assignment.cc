@@ -19,10 +19,13 @@ limitations under the License.
 #include <cmath>
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -39,8 +42,10 @@ limitations under the License.
 #include "xla/service/llvm_ir/dynamic_update_slice_util.h"
 #include "xla/util.h"
 #include "tsl/platform/cpu_info.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"  // IWYU pragma: keep
 #include "tsl/platform/status.h"
+#include "tsl/profiler/protobuf/profiled_instructions.pb.h"
 
 namespace xla {
 namespace cpu {
@@ -124,10 +129,78 @@ class DefaultCostModel : public ParallelCostModel {
   const std::unique_ptr<HloCostAnalysis> cost_analysis_;
 };
 
+// Cost model based on instruction timings recorded from earlier runs. The
+// recorded cost of an instruction is split into tasks of at least
+// 'kMinCostPerTaskUs' of work, which amortizes the overhead of scheduling a
+// task on the intra-op thread pool. Instructions without a recorded cost are
+// delegated to 'fallback_'.
+class ProfileGuidedCostModel : public ParallelCostModel {
+ public:
+  ProfileGuidedCostModel(
+      const int64_t max_parallelism,
+      const tensorflow::profiler::ProfiledInstructionsProto& profile,
+      std::unique_ptr<ParallelCostModel> fallback)
+      : max_parallelism_(max_parallelism), fallback_(std::move(fallback)) {
+    for (const auto& cost : profile.costs()) {
+      costs_us_[cost.name()] = cost.cost_us();
+    }
+  }
+  ~ProfileGuidedCostModel() override {}
+
+  int64_t GetParallelTaskCount(HloInstruction* instruction) override {
+    auto it = costs_us_.find(instruction->name());
+    if (it == costs_us_.end()) {
+      return fallback_->GetParallelTaskCount(instruction);
+    }
+    // Measured time already accounts for memory bandwidth, so (unlike the
+    // analytical model) I/O bound instructions are not capped separately.
+    const int64_t task_count =
+        static_cast<int64_t>(std::floor(it->second / kMinCostPerTaskUs));
+    VLOG(2) << "Profile-guided parallel task count: " << task_count
+            << " for instruction: " << instruction->name()
+            << " cost_us: " << it->second;
+    // Return target parallel task count in [1, max_parallelism_].
+    return std::min(max_parallelism_, std::max(int64_t{1}, task_count));
+  }
+
+ private:
+  // Minimum per-task cost, which matches the 100000 cycles of work on a 2GHz
+  // core used by DefaultCostModel for compute bound instructions.
+  static constexpr double kMinCostPerTaskUs = 50.0;
+
+  const int64_t max_parallelism_;
+  absl::flat_hash_map<std::string, double> costs_us_;
+  const std::unique_ptr<ParallelCostModel> fallback_;
+};
+
+// Reads the profile named by the `xla_cpu_parallel_task_profile_path` debug
+// option as a text or binary ProfiledInstructionsProto. Returns std::nullopt if
+// the option is not set or the profile can't be read.
+static std::optional<tensorflow::profiler::ProfiledInstructionsProto>
+ReadParallelTaskProfile(const HloModule* module) {
+  const std::string& path =
+      module->config().debug_options().xla_cpu_parallel_task_profile_path();
+  if (path.empty()) {
+    return std::nullopt;
+  }
+  tensorflow::profiler::ProfiledInstructionsProto profile;
+  absl::Status status =
+      tsl::ReadTextOrBinaryProto(tsl::Env::Default(), path, &profile);
+  if (!status.ok()) {
+    LOG(ERROR) << "Unable to read parallel task profile from " << path << ": "
+               << status.message();
+    return std::nullopt;
+  }
+  VLOG(1) << "Using parallel task profile from " << path << " with "
+          << profile.costs_size() << " instruction costs";
+  return profile;
+}
+
 ParallelTaskAssignment::ParallelTaskAssignment(
     const int64_t max_parallelism,
     const HloCostAnalysis::ShapeSizeFunction& shape_size, HloModule* module,
-    const TargetMachineFeatures* target_machine_features)
+    const TargetMachineFeatures* target_machine_features,
+    const tensorflow::profiler::ProfiledInstructionsProto* profile)
     : target_machine_features_(*target_machine_features) {
   VLOG(1) << "ParallelTaskAssignment max_parallelism: " << max_parallelism;
   // Run cost analysis on 'module'.
@@ -146,6 +219,11 @@ ParallelTaskAssignment::ParallelTaskAssignment(
     cost_model_ =
         std::make_unique<SimpleCostModel>(max_parallelism, shape_size);
   }
+  if (profile != nullptr && profile->costs_size() > 0) {
+    // Prefer measured instruction costs over the analytical estimates.
+    cost_model_ = std::make_unique<ProfileGuidedCostModel>(
+        max_parallelism, *profile, std::move(cost_model_));
+  }
 }
 
 int64_t ParallelTaskAssignment::GetTargetParallelTaskCount(
@@ -273,9 +351,15 @@ bool ParallelTaskAssigner::AssignParallelTasksHelper(
 
 void ParallelTaskAssigner::ComputeTargetParallelTasks(
     HloModule* module, HloToParallelTasks* hlo_to_parallel_tasks) {
-  ParallelTaskAssignment parallel_task_assignment(max_parallelism_,
-                                                  shape_size_function_, module,
-                                                  &target_machine_features_);
+  std::optional<tensorflow::profiler::ProfiledInstructionsProto> profile;
+  if (!profile_.has_value()) {
+    profile = ReadParallelTaskProfile(module);
+  }
+  const auto& maybe_profile = profile_.has_value() ? profile_ : profile;
+  ParallelTaskAssignment parallel_task_assignment(
+      max_parallelism_, shape_size_function_, module,
+      &target_machine_features_,
+      maybe_profile.has_value() ? &*maybe_profile : nullptr);
 
   // Compute parallel task counts for all instructions in 'module'.
   for (auto* computation : module->MakeNonfusionComputations()) {
@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <utility>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -30,6 +32,7 @@ limitations under the License.
 #include "xla/service/cpu/target_machine_features.h"
 #include "xla/service/hlo_cost_analysis.h"
 #include "xla/util.h"
+#include "tsl/profiler/protobuf/profiled_instructions.pb.h"
 
 namespace xla {
 namespace cpu {
@@ -48,10 +51,15 @@ class ParallelTaskAssignment {
   // 'shape_size': shape size function used by HloCostAnalysis during parallel
   //               task assignment.
   // 'module': the containing HloModule.
-  ParallelTaskAssignment(int64_t max_parallelism,
-                         const HloCostAnalysis::ShapeSizeFunction& shape_size,
-                         HloModule* module,
-                         const TargetMachineFeatures* target_machine_features);
+  // 'profile': optional per-instruction timings recorded from earlier runs of
+  //            'module'. Instructions with a recorded cost get a parallel task
+  //            count derived from their measured time; all other instructions
+  //            fall back to the analytical cost model.
+  ParallelTaskAssignment(
+      int64_t max_parallelism,
+      const HloCostAnalysis::ShapeSizeFunction& shape_size, HloModule* module,
+      const TargetMachineFeatures* target_machine_features,
+      const tensorflow::profiler::ProfiledInstructionsProto* profile = nullptr);
   ~ParallelTaskAssignment() {}
 
   // Computes and returns the target parallel task count for 'instruction'.
@@ -75,12 +83,19 @@ class ParallelTaskAssigner : public HloModulePass {
   // 'max_parallelism': the maximum parallel task count per instruction.
   // 'shape_size': shape size function used by HloCostAnalysis during parallel
   //               task assignment.
-  ParallelTaskAssigner(const int64_t max_parallelism,
-                       const HloCostAnalysis::ShapeSizeFunction& shape_size,
-                       const TargetMachineFeatures* target_machine_features)
+  // 'profile': optional per-instruction timings used by the profile-guided
+  //            cost model. If not set, the profile is read from the file named
+  //            by the `xla_cpu_parallel_task_profile_path` debug option.
+  ParallelTaskAssigner(
+      const int64_t max_parallelism,
+      const HloCostAnalysis::ShapeSizeFunction& shape_size,
+      const TargetMachineFeatures* target_machine_features,
+      std::optional<tensorflow::profiler::ProfiledInstructionsProto> profile =
+          std::nullopt)
       : max_parallelism_(max_parallelism),
         shape_size_function_(shape_size),
-        target_machine_features_(*target_machine_features) {}
+        target_machine_features_(*target_machine_features),
+        profile_(std::move(profile)) {}
   ~ParallelTaskAssigner() override {}
 
   absl::string_view name() const override {
@@ -116,6 +131,7 @@ class ParallelTaskAssigner : public HloModulePass {
   int64_t max_parallelism_;
   HloCostAnalysis::ShapeSizeFunction shape_size_function_;
   const TargetMachineFeatures& target_machine_features_;
+  std::optional<tensorflow::profiler::ProfiledInstructionsProto> profile_;
 };
 
 }  // namespace cpu
@@ -30,6 +30,7 @@ limitations under the License.
 #include "xla/test.h"
 #include "xla/tests/hlo_test_base.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/profiler/protobuf/profiled_instructions.pb.h"
 
 namespace xla {
 namespace {
@@ -53,6 +54,14 @@ class ParallelTaskAssignmentTest : public HloTestBase {
         .Run(module);
   }
 
+  absl::StatusOr<bool> RunParallelTaskAssigner(
+      HloModule* module,
+      const tensorflow::profiler::ProfiledInstructionsProto& profile) {
+    return cpu::ParallelTaskAssigner(max_parallelism_, shape_size_func_,
+                                     &target_machine_features_, profile)
+        .Run(module);
+  }
+
   const HloCostAnalysis::ShapeSizeFunction shape_size_func_ =
       cpu::CpuExecutable::ShapeSizeBytes;
 };
@@ -245,5 +254,78 @@ TEST_F(ParallelTaskAssignmentTest, ConstantNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+constexpr char kReduceWindowHlo[] = R"(
+  HloModule m
+    add {
+      lhs = f32[] parameter(0)
+      rhs = f32[] parameter(1)
+      ROOT add = f32[] add(lhs, rhs)
+    }
+
+    ENTRY e {
+      p0 = f32[512,256] parameter(0)
+      p1 = f32[] parameter(1)
+      ROOT reduce-window = f32[16,256] reduce-window(p0, p1),
+          window={size=32x1 stride=32x1}, to_apply=add
+    }
+  )";
+
+TEST_F(ParallelTaskAssignmentTest, ProfileGuidedReduceWindowParallelized) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(kReduceWindowHlo));
+
+  // 400us of measured work is split into 8 tasks of 50us.
+  tensorflow::profiler::ProfiledInstructionsProto profile;
+  auto* cost = profile.add_costs();
+  cost->set_name("reduce-window");
+  cost->set_cost_us(400.0);
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunParallelTaskAssigner(m.get(), profile));
+  EXPECT_TRUE(changed);
+
+  auto* reduce_window = FindInstruction(m.get(), HloOpcode::kReduceWindow);
+  TF_ASSERT_OK_AND_ASSIGN(auto backend_config,
+                          reduce_window->backend_config<cpu::BackendConfig>());
+  EXPECT_EQ(backend_config.outer_dimension_partitions_size(), 1);
+  EXPECT_EQ(backend_config.outer_dimension_partitions(0), 8);
+}
+
+TEST_F(ParallelTaskAssignmentTest, ProfileGuidedCheapOpNotParallelized) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(kReduceWindowHlo));
+
+  // Measured time is too short to amortize the cost of scheduling tasks.
+  tensorflow::profiler::ProfiledInstructionsProto profile;
+  auto* cost = profile.add_costs();
+  cost->set_name("reduce-window");
+  cost->set_cost_us(20.0);
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunParallelTaskAssigner(m.get(), profile));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(ParallelTaskAssignmentTest, ProfileGuidedFallsBackForUnprofiledOps) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(kReduceWindowHlo));
+
+  tensorflow::profiler::ProfiledInstructionsProto profile;
+  auto* cost = profile.add_costs();
+  cost->set_name("some-other-instruction");
+  cost->set_cost_us(1000.0);
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunParallelTaskAssigner(m.get(), profile));
+  EXPECT_TRUE(changed);
+
+  // Same partitioning as the analytical cost model.
+  auto* reduce_window = FindInstruction(m.get(), HloOpcode::kReduceWindow);
+  TF_ASSERT_OK_AND_ASSIGN(auto backend_config,
+                          reduce_window->backend_config<cpu::BackendConfig>());
+  EXPECT_EQ(backend_config.outer_dimension_partitions_size(), 1);
+  EXPECT_EQ(backend_config.outer_dimension_partitions(0), 2);
+}
+
 }  // namespace
 }  // namespace xla
@@ -16,14 +16,22 @@ limitations under the License.
 #include "xla/service/cpu/runtime_topk.h"
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <cstring>
 #include <limits>
-#include <numeric>
 #include <vector>
 
 #include "absl/base/casts.h"
 #include "absl/base/dynamic_annotations.h"
+#include "absl/base/optimization.h"
+
+// Number of values per block checked against the current k-th largest value
+// before any of them is inserted into the heap.
+static constexpr int64_t kTopKBlockSize = 16;
+
+// Largest k for which the heap lives on the stack.
+static constexpr int64_t kMaxStackTopK = 64;
 
 template <typename T>
 static void TopK(int64_t batch_size, int64_t input_size, int64_t k,
@@ -32,36 +40,77 @@ static void TopK(int64_t batch_size, int64_t input_size, int64_t k,
   // initialized.
   ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(values,
                                       input_size * batch_size * sizeof(T));
-  static constexpr auto convert_to_int = [](T value) {
+  if (k == 0) return;
+
+  // Do the comparisons in integers to enforce a total order of
+  // -NaN < -Inf < -0 < +0 < +Inf < +NaN.
+  static constexpr auto convert_to_int = [](T value) -> int32_t {
     uint32_t x = absl::bit_cast<uint32_t>(value);
     return static_cast<int32_t>(x) < 0 ? std::numeric_limits<int32_t>::max() - x
                                        : x;
   };
 
-  std::vector<int32_t> temp_indices(input_size);
-  for (int64_t batch = 0; batch != batch_size; ++batch) {
-    std::iota(temp_indices.begin(), temp_indices.end(), 0);
+  struct Candidate {
+    int32_t key;
+    int32_t index;
+  };
+
+  // Orders candidates from the best to the worst: larger values first, and
+  // smaller indices first among equal values.
+  static constexpr auto better = [](const Candidate& a, const Candidate& b) {
+    return a.key > b.key || (a.key == b.key && a.index < b.index);
+  };
 
+  // A heap of the k best values seen so far, with the worst of them on top.
+  std::array<Candidate, kMaxStackTopK> stack_heap;
+  std::vector<Candidate> heap_storage;
+  Candidate* heap = stack_heap.data();
+  if (k > kMaxStackTopK) {
+    heap_storage.resize(k);
+    heap = heap_storage.data();
+  }
+
+  for (int64_t batch = 0; batch != batch_size; ++batch) {
     const T* values_batch = values + batch * input_size;
 
-    auto kth_element = temp_indices.begin() + k;
-    std::partial_sort(temp_indices.begin(), kth_element, temp_indices.end(),
-                      [values_batch](size_t i1, size_t i2) {
-                        // Do the comparison in integers to enforce a total
-                        // order of -NaN < -Inf < -0 < +0 < +Inf < +NaN.
-                        int32_t v1 = convert_to_int(values_batch[i1]);
-                        int32_t v2 = convert_to_int(values_batch[i2]);
-                        if (v1 == v2) {
-                          return i1 < i2;  // Stabilize sorting.
-                        }
-                        return v1 > v2;
-                      });
+    for (int64_t i = 0; i < k; ++i) {
+      heap[i] = Candidate{convert_to_int(values_batch[i]),
+                          static_cast<int32_t>(i)};
+    }
+    std::make_heap(heap, heap + k, better);
+
+    // Values are visited in the order of their indices, so a value only gets
+    // into the top k if it is strictly larger than the current k-th largest.
+    int32_t threshold = heap[0].key;
+    auto insert = [&](int64_t i) {
+      int32_t key = convert_to_int(values_batch[i]);
+      if (ABSL_PREDICT_TRUE(key <= threshold)) return;
+      std::pop_heap(heap, heap + k, better);
+      heap[k - 1] = Candidate{key, static_cast<int32_t>(i)};
+      std::push_heap(heap, heap + k, better);
+      threshold = heap[0].key;
+    };
+
+    int64_t pos = k;
+    for (; pos + kTopKBlockSize <= input_size; pos += kTopKBlockSize) {
+      // Skip the whole block if none of its values gets into the top k. This
+      // loop has no branches, so that the compiler can vectorize it.
+      int32_t block_max = std::numeric_limits<int32_t>::min();
+      for (int64_t j = 0; j < kTopKBlockSize; ++j) {
+        block_max = std::max(block_max, convert_to_int(values_batch[pos + j]));
+      }
+      if (ABSL_PREDICT_TRUE(block_max <= threshold)) continue;
+      for (int64_t j = 0; j < kTopKBlockSize; ++j) insert(pos + j);
+    }
+    for (; pos < input_size; ++pos) insert(pos);
+
+    std::sort_heap(heap, heap + k, better);
 
     T* out_values_batch = out_values + batch * k;
     int32_t* out_indices_batch = out_indices + batch * k;
-    std::copy(temp_indices.begin(), kth_element, out_indices_batch);
     for (int64_t i = 0; i < k; i++) {
-      out_values_batch[i] = values_batch[temp_indices[i]];
+      out_indices_batch[i] = heap[i].index;
+      out_values_batch[i] = values_batch[heap[i].index];
     }
   }
 }
@@ -60,6 +60,7 @@ limitations under the License.
 #include "mlir/ExecutionEngine/CRunnerUtils.h"
 #include "xla/service/cpu/compiler_functor.h"
 #include "xla/service/cpu/cpu_runtime.h"
+#include "xla/service/cpu/huge_pages.h"
 #include "xla/service/cpu/orc_jit_memory_mapper.h"
 #include "xla/service/cpu/runtime_conv2d.h"
 #include "xla/service/cpu/runtime_conv2d_acl.h"
@@ -142,9 +143,12 @@ class DefaultMemoryMapper final
 // done.
 class ContiguousSectionMemoryManager : public llvm::RTDyldMemoryManager {
  public:
-  explicit ContiguousSectionMemoryManager(
-      llvm::SectionMemoryManager::MemoryMapper* mmapper)
-      : mmapper_(mmapper), mmapper_is_owned_(false) {
+  ContiguousSectionMemoryManager(
+      llvm::SectionMemoryManager::MemoryMapper* mmapper,
+      int64_t huge_page_min_bytes)
+      : mmapper_(mmapper),
+        mmapper_is_owned_(false),
+        huge_page_min_bytes_(huge_page_min_bytes) {
     if (mmapper_ == nullptr) {
       mmapper_ = new DefaultMemoryMapper();
       mmapper_is_owned_ = true;
@@ -174,6 +178,9 @@ class ContiguousSectionMemoryManager : public llvm::RTDyldMemoryManager {
   llvm::SectionMemoryManager::MemoryMapper* mmapper_;
   bool mmapper_is_owned_;
 
+  // Data sections of at least this size are backed by huge pages.
+  int64_t huge_page_min_bytes_;
+
   llvm::sys::MemoryBlock allocation_;
 
   // Sections must be in the order code < rodata < rwdata.
@@ -237,6 +244,13 @@ void ContiguousSectionMemoryManager::reserveAllocationSpace(
   base += ro_data_size;
   rw_data_block_ = rw_data_free_ =
       llvm::sys::MemoryBlock(reinterpret_cast<void*>(base), rw_data_size);
+
+  // Data sections are adjacent, and large ones usually hold constants. Advise
+  // huge pages before LLVM copies section contents into the blocks.
+  uintptr_t data_size = ro_data_size + rw_data_size;
+  if (huge_page_min_bytes_ > 0 && data_size >= huge_page_min_bytes_) {
+    AdviseHugePages(ro_data_block_.base(), data_size);
+  }
 }
 
 uint8_t* ContiguousSectionMemoryManager::allocateDataSection(
@@ -468,7 +482,8 @@ SimpleOrcJIT::SimpleOrcJIT(
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
     absl::AnyInvocable<void(const llvm::object::ObjectFile&)> post_codegen_hook,
-    size_t num_jit_dylibs, absl::string_view max_cpu_isa)
+    size_t num_jit_dylibs, absl::string_view max_cpu_isa,
+    int64_t huge_page_min_bytes)
     : target_machine_builder_(
           CreateTargetMachineBuilder(target_options, opt_level, max_cpu_isa)),
       target_machine_(target_machine_builder_()),
@@ -477,9 +492,10 @@ SimpleOrcJIT::SimpleOrcJIT(
       target_process_control_(std::move(target_process_control)),
       execution_session_(std::move(execution_session)),
       object_layer_(*execution_session_,
-                    []() {
+                    [huge_page_min_bytes]() {
                       return std::make_unique<ContiguousSectionMemoryManager>(
-                          orc_jit_memory_mapper::GetInstance());
+                          orc_jit_memory_mapper::GetInstance(),
+                          huge_page_min_bytes);
                     }),
       compile_layer_(
           *execution_session_, object_layer_,
@@ -556,7 +572,8 @@ llvm::Expected<std::unique_ptr<SimpleOrcJIT>> SimpleOrcJIT::Create(
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
     absl::AnyInvocable<void(const llvm::object::ObjectFile&)> post_codegen_hook,
-    size_t num_jit_dylibs, absl::string_view max_cpu_isa) {
+    size_t num_jit_dylibs, absl::string_view max_cpu_isa,
+    int64_t huge_page_min_bytes) {
   auto SSP = std::make_shared<llvm::orc::SymbolStringPool>();
   auto target_process_control =
       llvm::orc::SelfExecutorProcessControl::Create(std::move(SSP));
@@ -571,7 +588,7 @@ llvm::Expected<std::unique_ptr<SimpleOrcJIT>> SimpleOrcJIT::Create(
       target_options, opt_level, optimize_for_size, disable_expensive_passes,
       disable_slp_vectorizer, fast_math_flags, std::move(pre_optimization_hook),
       std::move(post_optimization_hook), std::move(post_codegen_hook),
-      num_jit_dylibs, std::move(max_cpu_isa));
+      num_jit_dylibs, std::move(max_cpu_isa), huge_page_min_bytes);
 }
 
 llvm::orc::ExecutorSymbolDef SimpleOrcJIT::ResolveRuntimeSymbol(
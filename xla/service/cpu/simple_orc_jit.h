@@ -70,7 +70,8 @@ class SimpleOrcJIT : public llvm::JITEventListener {
   //
   // {pre,post}_optimization_hook is invoked on the module before/after all
   // LLVM IR-level optimizations.  post_codegen_hook is invoked after
-  // compiling to machine code.
+  // compiling to machine code. If huge_page_min_bytes is positive, JIT data
+  // sections of at least that size are backed by transparent huge pages.
   SimpleOrcJIT(
       std::unique_ptr<llvm::orc::ExecutorProcessControl> target_process_control,
       std::unique_ptr<llvm::orc::ExecutionSession> execution_session,
@@ -82,7 +83,8 @@ class SimpleOrcJIT : public llvm::JITEventListener {
       LLVMCompiler::ModuleHook post_optimization_hook,
       absl::AnyInvocable<void(const llvm::object::ObjectFile&)>
           post_codegen_hook,
-      size_t num_jit_dylibs, absl::string_view max_cpu_isa);
+      size_t num_jit_dylibs, absl::string_view max_cpu_isa,
+      int64_t huge_page_min_bytes);
 
   static llvm::Expected<std::unique_ptr<SimpleOrcJIT>> Create(
       const llvm::TargetOptions& target_options,
@@ -93,7 +95,8 @@ class SimpleOrcJIT : public llvm::JITEventListener {
       LLVMCompiler::ModuleHook post_optimization_hook,
       absl::AnyInvocable<void(const llvm::object::ObjectFile&)>
           post_codegen_hook,
-      size_t num_jit_dylibs, absl::string_view max_cpu_isa);
+      size_t num_jit_dylibs, absl::string_view max_cpu_isa,
+      int64_t huge_page_min_bytes);
 
   ~SimpleOrcJIT() override;
 
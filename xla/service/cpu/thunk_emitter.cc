@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -38,6 +39,7 @@ limitations under the License.
 #include "xla/backends/cpu/runtime/convolution_thunk.h"
 #include "xla/backends/cpu/runtime/copy_thunk.h"
 #include "xla/backends/cpu/runtime/custom_call_thunk.h"
+#include "xla/backends/cpu/runtime/dot_epilogue.h"
 #include "xla/backends/cpu/runtime/dot_thunk.h"
 #include "xla/backends/cpu/runtime/fft_thunk.h"
 #include "xla/backends/cpu/runtime/infeed_thunk.h"
@@ -46,11 +48,15 @@ limitations under the License.
 #include "xla/backends/cpu/runtime/outfeed_thunk.h"
 #include "xla/backends/cpu/runtime/reduce_scatter_thunk.h"
 #include "xla/backends/cpu/runtime/resource_use.h"
+#include "xla/backends/cpu/runtime/rng_bit_generator_thunk.h"
 #include "xla/backends/cpu/runtime/rng_state_thunk.h"
+#include "xla/backends/cpu/runtime/scan_thunk.h"
+#include "xla/backends/cpu/runtime/scatter_thunk.h"
 #include "xla/backends/cpu/runtime/sort_thunk.h"
 #include "xla/backends/cpu/runtime/thunk.h"
 #include "xla/backends/cpu/runtime/topk_thunk.h"
 #include "xla/backends/cpu/runtime/while_thunk.h"
+#include "xla/comparison_util.h"
 #include "xla/cpu_function_runtime.h"
 #include "xla/hlo/ir/hlo_casting_utils.h"
 #include "xla/hlo/ir/hlo_computation.h"
@@ -62,6 +68,7 @@ limitations under the License.
 #include "xla/layout_util.h"
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/collective_ops_utils.h"
+#include "xla/service/cpu/dot_epilogue_fusion.h"
 #include "xla/service/cpu/dot_op_emitter.h"
 #include "xla/service/cpu/ir_emission_utils.h"
 #include "xla/service/cpu/ir_emitter2.h"
@@ -72,6 +79,7 @@ limitations under the License.
 #include "xla/shape_util.h"
 #include "xla/status_macros.h"
 #include "xla/util.h"
+#include "xla/window_util.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
@@ -209,7 +217,6 @@ absl::StatusOr<ThunkSequence> ThunkEmitter::EmitHloInstruction(
     case HloOpcode::kExp:
     case HloOpcode::kExpm1:
     case HloOpcode::kFloor:
-    case HloOpcode::kGather:
     case HloOpcode::kImag:
     case HloOpcode::kIota:
     case HloOpcode::kIsFinite:
@@ -271,9 +278,14 @@ absl::StatusOr<ThunkSequence> ThunkEmitter::EmitHloInstruction(
       return EmitPadKernelThunk(instruction);
 
     case HloOpcode::kSlice:
-    case HloOpcode::kDynamicSlice:
       return EmitSliceThunk(instruction);
 
+    case HloOpcode::kDynamicSlice:
+      return EmitDynamicSliceKernelThunk(instruction);
+
+    case HloOpcode::kGather:
+      return EmitGatherKernelThunk(instruction);
+
     case HloOpcode::kDynamicUpdateSlice:
       return EmitDynamicUpdateSliceThunk(instruction);
 
@@ -284,7 +296,12 @@ absl::StatusOr<ThunkSequence> ThunkEmitter::EmitHloInstruction(
       return EmitFusionKernelThunk(instruction);
 
     case HloOpcode::kReduce:
+      return EmitReductionKernelThunk(instruction);
+
     case HloOpcode::kReduceWindow:
+      if (PotentiallyImplementedAsScanThunk(*instruction)) {
+        return EmitScanThunk(instruction);
+      }
       return EmitReductionKernelThunk(instruction);
 
     case HloOpcode::kRng:
@@ -326,6 +343,9 @@ absl::StatusOr<ThunkSequence> ThunkEmitter::EmitHloInstruction(
     case HloOpcode::kSort:
       return EmitSortThunk(instruction);
 
+    case HloOpcode::kScatter:
+      return EmitScatterThunk(instruction);
+
     default:
       return absl::UnimplementedError(
           absl::StrCat("HLO opcode `", HloOpcodeString(instruction->opcode()),
@@ -523,6 +543,28 @@ absl::StatusOr<ThunkSequence> ThunkEmitter::EmitConcatenateKernelThunk(
       /*min_alignment=*/cpu_function_runtime::MinAlign());
 }
 
+absl::StatusOr<ThunkSequence> ThunkEmitter::EmitGatherKernelThunk(
+    const HloInstruction* instruction) {
+  TF_ASSIGN_OR_RETURN(auto kernel,
+                      ir_emitter_.EmitGatherHostKernel(instruction));
+  TF_ASSIGN_OR_RETURN(auto buffers, GetHostKernelAllocationSlices(instruction));
+
+  return MakeKernelThunkSequence(
+      instruction, buffers, kernel,
+      /*min_alignment=*/cpu_function_runtime::MinAlign());
+}
+
+absl::StatusOr<ThunkSequence> ThunkEmitter::EmitDynamicSliceKernelThunk(
+    const HloInstruction* instruction) {
+  TF_ASSIGN_OR_RETURN(auto kernel,
+                      ir_emitter_.EmitDynamicSliceHostKernel(instruction));
+  TF_ASSIGN_OR_RETURN(auto buffers, GetHostKernelAllocationSlices(instruction));
+
+  return MakeKernelThunkSequence(
+      instruction, buffers, kernel,
+      /*min_alignment=*/cpu_function_runtime::MinAlign());
+}
+
 absl::StatusOr<ThunkSequence> ThunkEmitter::EmitGetDimensionSizeThunk(
     const HloInstruction* instruction) {
   return Unimplemented("GetDimensionSize should be rewritten for CPU.");
@@ -558,7 +600,9 @@ absl::StatusOr<ThunkSequence> ThunkEmitter::EmitConvolutionThunk(
   // TODO(tonywy): Add PotentiallyImplementedAsMKLConvolution to support
   // different data layouts.
   if (PotentiallyImplementedAsEigenConvolution(*instruction,
-                                               target_machine_features_)) {
+                                               target_machine_features_) ||
+      PotentiallyImplementedAsInt8Convolution(*instruction,
+                                              target_machine_features_)) {
     const Shape& input_shape = input->shape();
     const Shape& kernel_shape = kernel->shape();
     const Shape& output_shape = instruction->shape();
@@ -630,6 +674,20 @@ absl::StatusOr<ThunkSequence> ThunkEmitter::EmitPadKernelThunk(
 absl::StatusOr<ThunkSequence> ThunkEmitter::EmitFusionKernelThunk(
     const HloInstruction* instruction) {
   auto* fusion = Cast<HloFusionInstruction>(instruction);
+
+  // Dots with a fused epilogue that are not emitted as LLVM IR are executed
+  // by the DotThunk, which applies the epilogue to the dot result in place.
+  // Dots with a fused RHS convert are always executed by the DotThunk, which
+  // dequantizes the RHS on the fly.
+  if (const HloInstruction* dot = GetDotEpilogueFusionDot(*fusion)) {
+    DotImplementationStrategy strategy = GetDotImplementationStrategy(
+        hlo_module_config_, *dot, target_machine_features_);
+    if (strategy == DotImplementationStrategy::kEigen ||
+        dot->operand(1)->opcode() == HloOpcode::kConvert) {
+      return EmitDotEpilogueFusionThunk(fusion, dot);
+    }
+  }
+
   TF_ASSIGN_OR_RETURN(auto kernel, ir_emitter_.EmitFusionHostKernel(fusion));
   TF_ASSIGN_OR_RETURN(auto buffers, GetHostKernelAllocationSlices(instruction));
 
@@ -656,7 +714,36 @@ absl::StatusOr<ThunkSequence> ThunkEmitter::EmitRngThunk(
 
 absl::StatusOr<ThunkSequence> ThunkEmitter::EmitRngBitGeneratorThunk(
     const HloInstruction* instruction) {
-  return Unimplemented("RngBitGenerator should be expanded for CPU.");
+  if (!PotentiallyImplementedAsRngBitGeneratorThunk(*instruction)) {
+    return Unimplemented(
+        "RngBitGenerator %s must be expanded by RngBitGeneratorExpander for "
+        "XLA:CPU ThunkEmitter",
+        instruction->name());
+  }
+
+  // RngBitGeneratorExpander lowers the default algorithm to Philox on CPU.
+  RngBitGeneratorThunk::Algorithm algorithm =
+      instruction->rng_algorithm() == RandomAlgorithm::RNG_THREE_FRY
+          ? RngBitGeneratorThunk::Algorithm::kThreeFry
+          : RngBitGeneratorThunk::Algorithm::kPhilox;
+
+  const HloInstruction* state = instruction->operand(0);
+  const Shape& output_state_shape =
+      ShapeUtil::GetTupleElementShape(instruction->shape(), 0);
+  const Shape& output_shape =
+      ShapeUtil::GetTupleElementShape(instruction->shape(), 1);
+
+  TF_ASSIGN_OR_RETURN(auto state_buffer, GetAllocationSlice(state));
+  TF_ASSIGN_OR_RETURN(auto output_state_buffer,
+                      GetAllocationSlice(instruction, {0}));
+  TF_ASSIGN_OR_RETURN(auto output_buffer,
+                      GetAllocationSlice(instruction, {1}));
+
+  return ThunkSequence::Of<RngBitGeneratorThunk>(
+      ThunkInfo(instruction), algorithm,
+      RngBitGeneratorThunk::Buffer{state_buffer, state->shape()},
+      RngBitGeneratorThunk::Buffer{output_state_buffer, output_state_shape},
+      RngBitGeneratorThunk::Buffer{output_buffer, output_shape});
 }
 
 absl::StatusOr<ThunkSequence> ThunkEmitter::EmitRngGetAndUpdateStateThunk(
@@ -820,6 +907,128 @@ absl::StatusOr<ThunkSequence> ThunkEmitter::EmitDotThunk(
   }
 }
 
+static absl::StatusOr<DotEpilogue::OpKind> GetDotEpilogueOpKind(
+    const HloInstruction* instr) {
+  switch (instr->opcode()) {
+    case HloOpcode::kAdd:
+      return DotEpilogue::OpKind::kAdd;
+    case HloOpcode::kSubtract:
+      return DotEpilogue::OpKind::kSubtract;
+    case HloOpcode::kMultiply:
+      return DotEpilogue::OpKind::kMultiply;
+    case HloOpcode::kDivide:
+      return DotEpilogue::OpKind::kDivide;
+    case HloOpcode::kMaximum:
+      return DotEpilogue::OpKind::kMaximum;
+    case HloOpcode::kMinimum:
+      return DotEpilogue::OpKind::kMinimum;
+    case HloOpcode::kNegate:
+      return DotEpilogue::OpKind::kNegate;
+    case HloOpcode::kExp:
+      return DotEpilogue::OpKind::kExp;
+    case HloOpcode::kTanh:
+      return DotEpilogue::OpKind::kTanh;
+    default:
+      return Internal("Unsupported dot epilogue operation: %s",
+                      instr->ToString());
+  }
+}
+
+// Converts the fused computation of a dot epilogue fusion into a DotEpilogue.
+// Appends fusion operands of the epilogue side inputs to `side_inputs`.
+static absl::StatusOr<DotEpilogue> GetDotEpilogue(
+    const HloInstruction* fusion, const HloInstruction* dot,
+    std::vector<const HloInstruction*>* side_inputs) {
+  // Collect the epilogue operations from the fusion root down to the dot.
+  std::vector<const HloInstruction*> chain;
+  for (const HloInstruction* instr = fusion->fused_expression_root();
+       instr != dot;) {
+    chain.push_back(instr);
+    auto on_chain = [](const HloInstruction* operand) {
+      return operand->opcode() != HloOpcode::kBroadcast &&
+             operand->opcode() != HloOpcode::kParameter;
+    };
+    auto it = absl::c_find_if(instr->operands(), on_chain);
+    if (it == instr->operands().end()) {
+      return Internal("Dot epilogue operation %s doesn't use the dot result",
+                      instr->ToString());
+    }
+    instr = *it;
+  }
+
+  DotEpilogue epilogue;
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    const HloInstruction* instr = *it;
+    DotEpilogue::Op op;
+    TF_ASSIGN_OR_RETURN(op.kind, GetDotEpilogueOpKind(instr));
+
+    if (!DotEpilogue::IsUnary(op.kind)) {
+      op.reversed = instr->operand(0)->opcode() == HloOpcode::kBroadcast;
+      const HloInstruction* broadcast = instr->operand(op.reversed ? 0 : 1);
+      const HloInstruction* param = broadcast->operand(0);
+      TF_RET_CHECK(broadcast->opcode() == HloOpcode::kBroadcast &&
+                   param->opcode() == HloOpcode::kParameter);
+
+      if (param->shape().rank() == 0) {
+        op.broadcast = DotEpilogue::Broadcast::kScalar;
+      } else if (broadcast->dimensions(0) == 0) {
+        op.broadcast = DotEpilogue::Broadcast::kPerRow;
+      } else {
+        op.broadcast = DotEpilogue::Broadcast::kPerColumn;
+      }
+
+      const HloInstruction* operand =
+          fusion->operand(param->parameter_number());
+      auto side_input = absl::c_find(*side_inputs, operand);
+      op.operand = std::distance(side_inputs->begin(), side_input);
+      if (side_input == side_inputs->end()) side_inputs->push_back(operand);
+    }
+
+    epilogue.ops.push_back(op);
+  }
+
+  return epilogue;
+}
+
+absl::StatusOr<ThunkSequence> ThunkEmitter::EmitDotEpilogueFusionThunk(
+    const HloInstruction* fusion, const HloInstruction* dot) {
+  // A fused RHS convert is executed by the DotThunk, which reads the RHS in
+  // its original quantized type.
+  const HloInstruction* rhs_param = dot->operand(1);
+  if (rhs_param->opcode() == HloOpcode::kConvert) {
+    rhs_param = rhs_param->operand(0);
+  }
+
+  TF_RET_CHECK(dot->operand(0)->opcode() == HloOpcode::kParameter &&
+               rhs_param->opcode() == HloOpcode::kParameter);
+  const HloInstruction* lhs =
+      fusion->operand(dot->operand(0)->parameter_number());
+  const HloInstruction* rhs = fusion->operand(rhs_param->parameter_number());
+
+  std::vector<const HloInstruction*> side_inputs;
+  TF_ASSIGN_OR_RETURN(DotEpilogue epilogue,
+                      GetDotEpilogue(fusion, dot, &side_inputs));
+
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice lhs_slice,
+                      GetAllocationSlice(lhs));
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice rhs_slice,
+                      GetAllocationSlice(rhs));
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice out_slice,
+                      GetAllocationSlice(fusion));
+
+  std::vector<BufferAllocation::Slice> epilogue_slices;
+  for (const HloInstruction* side_input : side_inputs) {
+    TF_ASSIGN_OR_RETURN(BufferAllocation::Slice slice,
+                        GetAllocationSlice(side_input));
+    epilogue_slices.push_back(slice);
+  }
+
+  return ThunkSequence::Of<DotThunk>(
+      ThunkInfo(fusion), dot->dot_dimension_numbers(), lhs_slice, lhs->shape(),
+      rhs_slice, rhs->shape(), out_slice, fusion->shape(), std::move(epilogue),
+      std::move(epilogue_slices));
+}
+
 absl::StatusOr<ThunkSequence> ThunkEmitter::EmitTopKThunk(
     const HloCustomCallInstruction* custom_call) {
   const auto& result_shape = custom_call->shape();
@@ -1011,6 +1220,58 @@ absl::StatusOr<ThunkSequence> ThunkEmitter::EmitDynamicUpdateSliceThunk(
   return MakeKernelThunkSequence(instruction, buffers, kernel);
 }
 
+// Returns the direction of `sort` if its comparator only compares the first
+// operand with `<` or `>` (with a total order for floating point values), so
+// that the sort thunk can sort without calling the comparator.
+static std::optional<SortThunk::SortDirection> MatchSortDirection(
+    const HloSortInstruction* sort) {
+  const HloInstruction* root = sort->to_apply()->root_instruction();
+  if (root->opcode() != HloOpcode::kCompare) return std::nullopt;
+  auto* compare = Cast<HloCompareInstruction>(root);
+
+  const HloInstruction* lhs = root->operand(0);
+  const HloInstruction* rhs = root->operand(1);
+  if (lhs->opcode() != HloOpcode::kParameter ||
+      rhs->opcode() != HloOpcode::kParameter) {
+    return std::nullopt;
+  }
+
+  // Parameters 0 and 1 are the compared values of the first operand.
+  bool swapped;
+  if (lhs->parameter_number() == 0 && rhs->parameter_number() == 1) {
+    swapped = false;
+  } else if (lhs->parameter_number() == 1 && rhs->parameter_number() == 0) {
+    swapped = true;
+  } else {
+    return std::nullopt;
+  }
+
+  Comparison::Type expected_type;
+  switch (sort->operand(0)->shape().element_type()) {
+    case F32:
+    case BF16:
+      expected_type = Comparison::Type::kFloatTotalOrder;
+      break;
+    case S32:
+      expected_type = Comparison::Type::kSigned;
+      break;
+    default:
+      return std::nullopt;
+  }
+  if (compare->type() != expected_type) return std::nullopt;
+
+  switch (compare->direction()) {
+    case ComparisonDirection::kLt:
+      return swapped ? SortThunk::SortDirection::kDescending
+                     : SortThunk::SortDirection::kAscending;
+    case ComparisonDirection::kGt:
+      return swapped ? SortThunk::SortDirection::kAscending
+                     : SortThunk::SortDirection::kDescending;
+    default:
+      return std::nullopt;
+  }
+}
+
 absl::StatusOr<ThunkSequence> ThunkEmitter::EmitSortThunk(
     const HloInstruction* instruction) {
   auto* sort = Cast<HloSortInstruction>(instruction);
@@ -1048,11 +1309,92 @@ absl::StatusOr<ThunkSequence> ThunkEmitter::EmitSortThunk(
   TF_ASSIGN_OR_RETURN(
       thunks.emplace_back(),
       SortThunk::Create(ThunkInfo(instruction), inputs, sort->sort_dimension(),
-                        sort->is_stable(), comparator.name));
+                        sort->is_stable(), comparator.name,
+                        MatchSortDirection(sort)));
 
   return thunks;
 }
 
+absl::StatusOr<ThunkSequence> ThunkEmitter::EmitScatterThunk(
+    const HloInstruction* instruction) {
+  if (!PotentiallyImplementedAsScatterThunk(*instruction)) {
+    return Unimplemented(
+        "Scatter %s must be expanded by ScatterExpander for XLA:CPU "
+        "ThunkEmitter",
+        instruction->name());
+  }
+
+  auto* scatter = Cast<HloScatterInstruction>(instruction);
+  const HloInstruction* operand = scatter->scatter_operands()[0];
+  const HloInstruction* indices = scatter->scatter_indices();
+  const HloInstruction* updates = scatter->scatter_updates()[0];
+
+  const HloComputation* computation = scatter->to_apply();
+  const HloInstruction* root = computation->root_instruction();
+
+  ScatterThunk::Combiner combiner = ScatterThunk::Combiner::kAssign;
+  if (root->opcode() == HloOpcode::kAdd) {
+    combiner = ScatterThunk::Combiner::kAdd;
+  } else if (root->opcode() == HloOpcode::kMinimum) {
+    combiner = ScatterThunk::Combiner::kMin;
+  } else if (root->opcode() == HloOpcode::kMaximum) {
+    combiner = ScatterThunk::Combiner::kMax;
+  }
+
+  TF_ASSIGN_OR_RETURN(auto operand_buffer, GetAllocationSlice(operand));
+  TF_ASSIGN_OR_RETURN(auto indices_buffer, GetAllocationSlice(indices));
+  TF_ASSIGN_OR_RETURN(auto updates_buffer, GetAllocationSlice(updates));
+  TF_ASSIGN_OR_RETURN(auto output_buffer, GetAllocationSlice(instruction));
+
+  return ThunkSequence::Of<ScatterThunk>(
+      ThunkInfo(instruction),
+      ScatterThunk::Buffer{operand_buffer, operand->shape()},
+      ScatterThunk::Buffer{indices_buffer, indices->shape()},
+      ScatterThunk::Buffer{updates_buffer, updates->shape()},
+      ScatterThunk::Buffer{output_buffer, instruction->shape()}, combiner);
+}
+
+absl::StatusOr<ThunkSequence> ThunkEmitter::EmitScanThunk(
+    const HloInstruction* instruction) {
+  const HloInstruction* operand = instruction->operand(0);
+  const Window& window = instruction->window();
+
+  // Scan dimension is the only non-trivial window dimension, and the window
+  // is padded in front of it for forward scans and behind it for reverse ones.
+  int64_t dimension = 0;
+  for (int64_t i = 0; i < window.dimensions_size(); ++i) {
+    if (!window_util::IsTrivialWindowDimension(window.dimensions(i))) {
+      dimension = i;
+      break;
+    }
+  }
+  bool reverse = window.dimensions(dimension).padding_low() == 0;
+
+  ScanThunk::Combiner combiner = ScanThunk::Combiner::kAdd;
+  switch (instruction->to_apply()->root_instruction()->opcode()) {
+    case HloOpcode::kMultiply:
+      combiner = ScanThunk::Combiner::kMul;
+      break;
+    case HloOpcode::kMinimum:
+      combiner = ScanThunk::Combiner::kMin;
+      break;
+    case HloOpcode::kMaximum:
+      combiner = ScanThunk::Combiner::kMax;
+      break;
+    default:
+      break;
+  }
+
+  TF_ASSIGN_OR_RETURN(auto operand_buffer, GetAllocationSlice(operand));
+  TF_ASSIGN_OR_RETURN(auto output_buffer, GetAllocationSlice(instruction));
+
+  return ThunkSequence::Of<ScanThunk>(
+      ThunkInfo(instruction),
+      ScanThunk::Buffer{operand_buffer, operand->shape()},
+      ScanThunk::Buffer{output_buffer, instruction->shape()}, dimension,
+      reverse, combiner);
+}
+
 absl::StatusOr<ThunkEmitter::HostKernelAllocationSlices>
 ThunkEmitter::GetHostKernelAllocationSlices(const HloInstruction* instruction) {
   HostKernelAllocationSlices slices;
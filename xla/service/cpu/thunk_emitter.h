@@ -84,6 +84,9 @@ class ThunkEmitter {
   absl::StatusOr<ThunkSequence> EmitConcatenateKernelThunk(
       const HloInstruction* instruction);
 
+  absl::StatusOr<ThunkSequence> EmitGatherKernelThunk(
+      const HloInstruction* instruction);
+
   absl::StatusOr<ThunkSequence> EmitGetDimensionSizeThunk(
       const HloInstruction* instruction);
 
@@ -141,6 +144,11 @@ class ThunkEmitter {
 
   absl::StatusOr<ThunkSequence> EmitDotThunk(const HloInstruction* instruction);
 
+  // Emits a DotThunk with a fused elementwise epilogue for an output fusion
+  // created by DotEpilogueFusion.
+  absl::StatusOr<ThunkSequence> EmitDotEpilogueFusionThunk(
+      const HloInstruction* fusion, const HloInstruction* dot);
+
   absl::StatusOr<ThunkSequence> EmitReplicaIdThunk(
       const HloInstruction* instruction);
 
@@ -177,12 +185,21 @@ class ThunkEmitter {
   absl::StatusOr<ThunkSequence> EmitSliceThunk(
       const HloInstruction* instruction);
 
+  absl::StatusOr<ThunkSequence> EmitDynamicSliceKernelThunk(
+      const HloInstruction* instruction);
+
   absl::StatusOr<ThunkSequence> EmitDynamicUpdateSliceThunk(
       const HloInstruction* instruction);
 
   absl::StatusOr<ThunkSequence> EmitSortThunk(
       const HloInstruction* instruction);
 
+  absl::StatusOr<ThunkSequence> EmitScatterThunk(
+      const HloInstruction* instruction);
+
+  absl::StatusOr<ThunkSequence> EmitScanThunk(
+      const HloInstruction* instruction);
+
   // Returns the list of buffer allocation slices assigned to the given
   // instruction that will be passed to the host kernel as arguments: a
   // flattened list of all the leaf buffers for all operands and result. We do
@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/service/dump.h"
 
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -60,6 +61,7 @@ limitations under the License.
 #include "tsl/platform/path.h"
 #include "tsl/platform/regexp.h"
 #include "tsl/platform/status.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/profiler/lib/scoped_annotation.h"
 
 namespace xla {
@@ -121,7 +123,8 @@ struct CanonicalDebugOptions {
         dump_as_long_text(opts.xla_dump_hlo_as_long_text()),
         dump_mlir_pretty_form(opts.xla_dump_enable_mlir_pretty_form()),
         dump_large_constants(opts.xla_dump_large_constants()),
-        syntax_sugar_async_ops(opts.xla_syntax_sugar_async_ops()) {
+        syntax_sugar_async_ops(opts.xla_syntax_sugar_async_ops()),
+        dump_async(opts.xla_dump_async()) {
     // This constructor examines the values in `opts` and turns on other flags
     // based on what we think is the user's intent.  To reduce confusion about
     // what was a user-specified value versus an extrapolated value, within this
@@ -240,6 +243,7 @@ struct CanonicalDebugOptions {
   bool dump_mlir_pretty_form;
   bool dump_large_constants;
   bool syntax_sugar_async_ops;
+  bool dump_async;
 };
 
 // Helper class to hold a list of functions that produces data to be written to
@@ -422,6 +426,166 @@ static std::optional<std::string> DumpToFileInDirOrStdoutImpl(
   return DumpToFileInDirImpl(filename, data_producer, opts);
 }
 
+// Runs dump jobs on a dedicated thread pool, so that rendering and writing
+// large modules does not block compilation. Pending jobs hold a snapshot of
+// their module; callers wait while the snapshots exceed kMaxPendingBytes.
+class AsyncDumper {
+ public:
+  static AsyncDumper& Get() {
+    static AsyncDumper* const dumper = [] {
+      auto* dumper = new AsyncDumper();
+      // Write out the dumps that are still pending when the process exits.
+      std::atexit([] { Get().Flush(); });
+      return dumper;
+    }();
+    return *dumper;
+  }
+
+  void Schedule(int64_t bytes, std::function<void()> job) {
+    {
+      absl::MutexLock lock(&mu_);
+      auto has_room = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return pending_bytes_ == 0 ||
+               pending_bytes_ + bytes <= kMaxPendingBytes;
+      };
+      mu_.Await(absl::Condition(&has_room));
+      pending_bytes_ += bytes;
+      ++pending_jobs_;
+    }
+    thread_pool_.Schedule([this, bytes, job = std::move(job)] {
+      job();
+      absl::MutexLock lock(&mu_);
+      pending_bytes_ -= bytes;
+      --pending_jobs_;
+    });
+  }
+
+  void Flush() {
+    absl::MutexLock lock(&mu_);
+    auto done = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return pending_jobs_ == 0;
+    };
+    mu_.Await(absl::Condition(&done));
+  }
+
+ private:
+  static constexpr int kNumThreads = 4;
+  static constexpr int64_t kMaxPendingBytes = int64_t{1} << 30;
+
+  AsyncDumper()
+      : thread_pool_(tsl::Env::Default(), "xla_dump", kNumThreads) {}
+
+  absl::Mutex mu_;
+  int64_t pending_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t pending_jobs_ ABSL_GUARDED_BY(mu_) = 0;
+  tsl::thread::ThreadPool thread_pool_;
+};
+
+static HloPrintOptions DumpPrintOptions(const CanonicalDebugOptions& opts) {
+  auto print_options = opts.dump_as_long_text
+                           ? HloPrintOptions::Default()
+                           : HloPrintOptions::ShortParsable();
+  print_options.set_print_large_constants(opts.dump_large_constants);
+  print_options.set_print_control_dependencies(true);
+  print_options.set_print_operand_index_annotation_interval(5);
+  print_options.set_print_backend_config(true);
+  print_options.set_print_metadata(opts.dump_hlo_metadata);
+  print_options.set_print_name_after_closing_brace(true);
+  print_options.set_syntax_sugar_async_ops(opts.syntax_sugar_async_ops);
+  return print_options;
+}
+
+static std::string SerializeHloProto(const HloProto& module_proto) {
+  std::string pb;
+  if (!tsl::SerializeToStringDeterministic(module_proto, &pb)) {
+    pb = "Failed to serialize HLO module proto.";
+  }
+  return pb;
+}
+
+static void WriteDumpFile(const std::string& file_path, string_view contents,
+                          bool compress = false) {
+  auto status =
+      WriteStringToFile(tsl::Env::Default(), file_path, contents, compress);
+  if (!status.ok()) {
+    LOG(ERROR) << "Could not write XLA debug data to " << file_path << ": "
+               << status;
+  }
+}
+
+// Module dumps that are rendered and written on the AsyncDumper. The paths are
+// resolved on the caller, in the same order as for synchronous dumping, so the
+// dump limits apply the same way and the same paths are returned.
+struct AsyncHloModuleDump {
+  std::optional<std::string> text_path;
+  std::optional<std::string> proto_path;
+  std::optional<std::string> dot_path;
+  std::optional<std::string> html_path;
+  std::optional<std::string> top_level_html_path;
+  // Proto of the module with its buffer assignment, which is built on the
+  // caller since the buffer assignment does not outlive it. Built from the
+  // snapshot otherwise.
+  std::optional<HloProto> proto;
+};
+
+// Rough size of a cloned instruction, used to bound the memory of pending
+// snapshots. Clones share the literals of constants with the original module.
+constexpr int64_t kSnapshotBytesPerInstruction = 1024;
+
+// Snapshots the module and schedules `dump` of the snapshot on the
+// AsyncDumper. The snapshot is a clone of the module, which keeps the names of
+// its instructions and computations, so its text and graphs are the same as
+// those of the module.
+static void ScheduleHloModuleDump(const HloModule& module,
+                                  const std::string& filename,
+                                  const CanonicalDebugOptions& opts,
+                                  AsyncHloModuleDump dump) {
+  if (!dump.text_path && !dump.proto_path && !dump.dot_path &&
+      !dump.html_path && !dump.top_level_html_path) {
+    return;
+  }
+
+  std::shared_ptr<const HloModule> snapshot = module.Clone(/*suffix=*/"");
+  int64_t bytes = module.instruction_count() * kSnapshotBytesPerInstruction;
+  if (dump.proto) {
+    bytes += dump.proto->ByteSizeLong();
+  }
+  HloPrintOptions print_options = DumpPrintOptions(opts);
+  bool compress_protos = opts.dump_compress_protos;
+
+  auto shared_dump =
+      std::make_shared<const AsyncHloModuleDump>(std::move(dump));
+  AsyncDumper::Get().Schedule(bytes, [=, snapshot = std::move(snapshot),
+                                      dump = std::move(shared_dump)] {
+    tsl::profiler::ScopedAnnotation annotation([&] {
+      return absl::StrFormat("XlaAsyncDumpHloModule:#module=%s#",
+                             snapshot->name());
+    });
+    if (dump->text_path) {
+      WriteDumpFile(*dump->text_path, snapshot->ToString(print_options));
+    }
+    if (dump->proto_path) {
+      WriteDumpFile(*dump->proto_path,
+                    SerializeHloProto(dump->proto ? *dump->proto
+                                                  : MakeHloProto(*snapshot)),
+                    compress_protos);
+    }
+    if (dump->dot_path) {
+      WriteDumpFile(*dump->dot_path, RenderGraph(filename, *snapshot,
+                                                 RenderedGraphFormat::kDot));
+    }
+    if (dump->html_path) {
+      WriteDumpFile(*dump->html_path, RenderGraph(filename, *snapshot,
+                                                  RenderedGraphFormat::kHtml));
+    }
+    if (dump->top_level_html_path) {
+      WriteDumpFile(*dump->top_level_html_path,
+                    RenderGraph(filename, *snapshot, RenderedGraphFormat::kHtml,
+                                false));
+    }
+  });
+}
+
 // Returns whether the computation is trivial enough not to warrant dumping.
 // Currently skips instructions where the root instruction has only parameters
 // as operands AND is not a fusion.
@@ -446,19 +610,20 @@ static std::vector<std::string> DumpHloModuleImpl(
 
   std::vector<std::optional<std::string>> file_paths;
 
+  // The buffer assignment, fusion visualization and URL dumps are rendered
+  // synchronously, since they read state that does not outlive the caller.
+  const bool dump_async = opts.dump_async && !opts.dumping_to_stdout();
+  AsyncHloModuleDump async_dump;
+
   if (opts.dump_as_text) {
-    auto print_options = opts.dump_as_long_text
-                             ? HloPrintOptions::Default()
-                             : HloPrintOptions::ShortParsable();
-    print_options.set_print_large_constants(opts.dump_large_constants);
-    print_options.set_print_control_dependencies(true);
-    print_options.set_print_operand_index_annotation_interval(5);
-    print_options.set_print_backend_config(true);
-    print_options.set_print_metadata(opts.dump_hlo_metadata);
-    print_options.set_print_name_after_closing_brace(true);
-    print_options.set_syntax_sugar_async_ops(opts.syntax_sugar_async_ops);
-    file_paths.push_back(DumpToFileInDirOrStdoutImpl(
-        StrCat(filename, ".txt"), module.ToString(print_options), opts));
+    if (dump_async) {
+      async_dump.text_path = GetDumpFilePath(StrCat(filename, ".txt"), opts);
+      file_paths.push_back(async_dump.text_path);
+    } else {
+      file_paths.push_back(DumpToFileInDirOrStdoutImpl(
+          StrCat(filename, ".txt"), module.ToString(DumpPrintOptions(opts)),
+          opts));
+    }
     if (buffer_assn) {
       DataProducer buffer_assignment;
       buffer_assignment.Append([&] { return buffer_assn->ToString(); });
@@ -475,35 +640,65 @@ static std::vector<std::string> DumpHloModuleImpl(
   }
 
   if (opts.dump_as_proto) {
-    HloProto module_proto =
-        buffer_assn ? MakeHloProto(module, *buffer_assn) : MakeHloProto(module);
-    std::string pb;
-    if (!tsl::SerializeToStringDeterministic(module_proto, &pb)) {
-      pb = "Failed to serialize HLO module proto.";
+    std::string proto_filename =
+        StrCat(filename, opts.dump_compress_protos ? ".hlo.pb.gz" : ".hlo.pb");
+    if (dump_async) {
+      async_dump.proto_path = GetDumpFilePath(proto_filename, opts);
+      file_paths.push_back(async_dump.proto_path);
+      if (async_dump.proto_path && buffer_assn) {
+        async_dump.proto = MakeHloProto(module, *buffer_assn);
+      }
+    } else {
+      HloProto module_proto = buffer_assn ? MakeHloProto(module, *buffer_assn)
+                                          : MakeHloProto(module);
+      file_paths.push_back(
+          DumpToFileInDirImpl(proto_filename, SerializeHloProto(module_proto),
+                              opts, opts.dump_compress_protos));
     }
-    file_paths.push_back(DumpToFileInDirImpl(
-        StrCat(filename, opts.dump_compress_protos ? ".hlo.pb.gz" : ".hlo.pb"),
-        pb, opts, opts.dump_compress_protos));
   }
 
   if (opts.dump_as_dot) {
-    file_paths.push_back(DumpToFileInDirImpl(
-        StrFormat("%s.dot", filename),
-        RenderGraph(filename, module, RenderedGraphFormat::kDot), opts));
+    std::string dot_filename = StrFormat("%s.dot", filename);
+    if (dump_async) {
+      async_dump.dot_path = GetDumpFilePath(dot_filename, opts);
+      file_paths.push_back(async_dump.dot_path);
+    } else {
+      file_paths.push_back(DumpToFileInDirImpl(
+          dot_filename,
+          RenderGraph(filename, module, RenderedGraphFormat::kDot), opts));
+    }
   }
 
   if (opts.dump_as_html) {
-    file_paths.push_back(DumpToFileInDirImpl(
-        StrFormat("%s.html", filename),
-        RenderGraph(filename, module, RenderedGraphFormat::kHtml), opts));
-    if (absl::StrContains(filename, kAfterOptimizationsDumpName)) {
+    std::string html_filename = StrFormat("%s.html", filename);
+    if (dump_async) {
+      async_dump.html_path = GetDumpFilePath(html_filename, opts);
+      file_paths.push_back(async_dump.html_path);
+    } else {
       file_paths.push_back(DumpToFileInDirImpl(
-          StrFormat("%s.top_level.html", filename),
-          RenderGraph(filename, module, RenderedGraphFormat::kHtml, false),
-          opts));
+          html_filename,
+          RenderGraph(filename, module, RenderedGraphFormat::kHtml), opts));
+    }
+    if (absl::StrContains(filename, kAfterOptimizationsDumpName)) {
+      std::string top_level_html_filename =
+          StrFormat("%s.top_level.html", filename);
+      if (dump_async) {
+        async_dump.top_level_html_path =
+            GetDumpFilePath(top_level_html_filename, opts);
+        file_paths.push_back(async_dump.top_level_html_path);
+      } else {
+        file_paths.push_back(DumpToFileInDirImpl(
+            top_level_html_filename,
+            RenderGraph(filename, module, RenderedGraphFormat::kHtml, false),
+            opts));
+      }
     }
   }
 
+  if (dump_async) {
+    ScheduleHloModuleDump(module, filename, opts, std::move(async_dump));
+  }
+
   if (opts.dump_fusion_visualization) {
     for (const HloComputation* computation :
          module.MakeNonfusionComputations()) {
@@ -762,6 +957,8 @@ bool DumpingToStdout(const DebugOptions& opts) {
   return CanonicalDebugOptions(opts).dumping_to_stdout();
 }
 
+void WaitForAsyncDumps() { AsyncDumper::Get().Flush(); }
+
 std::vector<std::string> DumpHloModuleBetweenPassesIfEnabled(
     string_view pipeline_name, string_view before_pass_name,
     string_view after_pass_name, const HloModule& module) {
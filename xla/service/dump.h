@@ -177,6 +177,10 @@ inline bool DumpingEnabledForHloModule(const HloModule& module) {
 // writing to two files, but you don't want to print twice.
 bool DumpingToStdout(const DebugOptions& opts);
 
+// Blocks until the module dumps scheduled so far with --xla_dump_async have
+// been written. Pending dumps are also flushed at process exit.
+void WaitForAsyncDumps();
+
 // Writes the given message in binary proto to the path formed by joining
 // 'directory/file_name.pb'. The 'directory' is recursively created if it
 // doesn't already exist, and the 'file_name' is sanitized by replacing
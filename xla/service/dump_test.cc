@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "absl/strings/match.h"
 #include "xla/hlo/parser/hlo_parser.h"
+#include "xla/service/hlo.pb.h"
 #include "xla/service/hlo_module_config.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "xla/xla.pb.h"
@@ -90,6 +91,94 @@ TEST(DumpHloIfEnabled, LargeConstantPrinted) {
   EXPECT_TRUE(!absl::StrContains(data, "{...}"));
 }
 
+TEST(DumpHloIfEnabled, AsyncDumpWrittenAfterWait) {
+  HloModuleConfig config;
+  DebugOptions options = config.debug_options();
+  auto env = tsl::Env::Default();
+  std::string dump_dir;
+  EXPECT_TRUE(env->LocalTempFilename(&dump_dir));
+  options.set_xla_dump_to(dump_dir);
+  options.set_xla_dump_hlo_as_text(true);
+  options.set_xla_dump_hlo_as_proto(true);
+  options.set_xla_dump_async(true);
+  config.set_debug_options(options);
+  const char* kModuleStr = R"(
+    HloModule m
+    test {
+      p0 = s32[11] parameter(0)
+      ROOT x = s32[11] negate(p0)
+    }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(auto m,
+                          ParseAndReturnUnverifiedModule(kModuleStr, config));
+  auto paths = DumpHloModuleIfEnabled(*m, "dump");
+  ASSERT_EQ(paths.size(), 2);
+  WaitForAsyncDumps();
+
+  std::string data;
+  TF_ASSERT_OK(ReadFileToString(env, paths[0], &data));
+  EXPECT_TRUE(absl::StrContains(data, "negate("));
+  HloProto proto;
+  TF_ASSERT_OK(tsl::ReadBinaryProto(env, paths[1], &proto));
+  EXPECT_EQ(proto.hlo_module().name(), "m");
+}
+
+TEST(DumpHloIfEnabled, AsyncDumpMatchesSyncDump) {
+  const char* kModuleStr = R"(
+    HloModule m
+    add {
+      a = f32[] parameter(0)
+      b = f32[] parameter(1)
+      ROOT sum = f32[] add(a, b)
+    }
+    test {
+      p0 = f32[11] parameter(0)
+      c = f32[] constant(0)
+      ROOT r = f32[] reduce(p0, c), dimensions={0}, to_apply=add
+    }
+  )";
+  auto env = tsl::Env::Default();
+  auto dump = [&](bool dump_async, std::vector<std::string>& paths) {
+    HloModuleConfig config;
+    DebugOptions options = config.debug_options();
+    std::string dump_dir;
+    EXPECT_TRUE(env->LocalTempFilename(&dump_dir));
+    options.set_xla_dump_to(dump_dir);
+    options.set_xla_dump_hlo_as_text(true);
+    options.set_xla_dump_hlo_as_proto(true);
+    options.set_xla_dump_hlo_as_dot(true);
+    options.set_xla_dump_async(dump_async);
+    config.set_debug_options(options);
+    TF_ASSERT_OK_AND_ASSIGN(auto m,
+                            ParseAndReturnUnverifiedModule(kModuleStr, config));
+    paths = DumpHloModuleIfEnabled(*m, "dump");
+    // The module may change or be destroyed right after an async dump.
+    m.reset();
+    WaitForAsyncDumps();
+  };
+  std::vector<std::string> sync_paths, async_paths;
+  dump(/*dump_async=*/false, sync_paths);
+  dump(/*dump_async=*/true, async_paths);
+
+  ASSERT_EQ(sync_paths.size(), 3);
+  ASSERT_EQ(async_paths.size(), sync_paths.size());
+  for (int i = 0; i < sync_paths.size(); ++i) {
+    EXPECT_EQ(tsl::io::Basename(async_paths[i]),
+              tsl::io::Basename(sync_paths[i]));
+  }
+  std::string sync_text, async_text;
+  TF_ASSERT_OK(ReadFileToString(env, sync_paths[0], &sync_text));
+  TF_ASSERT_OK(ReadFileToString(env, async_paths[0], &async_text));
+  EXPECT_EQ(async_text, sync_text);
+  std::string dot;
+  TF_ASSERT_OK(ReadFileToString(env, async_paths[2], &dot));
+  EXPECT_TRUE(absl::StrContains(dot, "digraph"));
+  HloProto proto;
+  TF_ASSERT_OK(tsl::ReadBinaryProto(env, async_paths[1], &proto));
+  EXPECT_EQ(proto.hlo_module().name(), "m");
+  EXPECT_EQ(proto.hlo_module().computations_size(), 2);
+}
+
 TEST(DumpTest, NoDumpingToFileWhenNotEnabled) {
   std::string filename =
       tsl::io::JoinPath(tsl::testing::TmpDir(), "disable_override");
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/service/gpu/autotuning/autotuner_compile_util.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <iterator>
 #include <memory>
@@ -104,7 +105,7 @@ absl::StatusOr<std::optional<AutotunerCompileUtil::ProfilingOutput>>
 AutotunerCompileUtil::ProfileExecutable(
     Executable* executable, se::Stream* stream,
     absl::Span<se::DeviceMemoryBase const> input_buffers,
-    absl::Span<Shape const> input_shapes) {
+    absl::Span<Shape const> input_shapes, int num_runs) {
   {
     std::vector<ExecutionInput> execution_inputs =
         ExecutionInputsFromBuffers(input_buffers, input_shapes);
@@ -125,18 +126,24 @@ AutotunerCompileUtil::ProfileExecutable(
 
     TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
   }
-  std::vector<ExecutionInput> execution_inputs =
-      ExecutionInputsFromBuffers(input_buffers, input_shapes);
-  ExecutionProfile profile;
-  // Flag that a warm-up run was executed so that GpuTimer can use the, more
-  // accurate, delay kernel implementation.
-  profile.set_warmup_run_executed(true);
-  TF_ASSIGN_OR_RETURN(
-      ExecutionOutput execution_output,
-      Execute(*executable, std::move(execution_inputs), &profile));
-  return std::make_optional<ProfilingOutput>(
-      absl::Nanoseconds(profile.compute_time_ns()),
-      execution_output.Commit().ConsumeResult());
+  std::optional<ProfilingOutput> result;
+  for (int run = 0; run < std::max(num_runs, 1); ++run) {
+    std::vector<ExecutionInput> execution_inputs =
+        ExecutionInputsFromBuffers(input_buffers, input_shapes);
+    ExecutionProfile profile;
+    // Flag that a warm-up run was executed so that GpuTimer can use the, more
+    // accurate, delay kernel implementation.
+    profile.set_warmup_run_executed(true);
+    TF_ASSIGN_OR_RETURN(
+        ExecutionOutput execution_output,
+        Execute(*executable, std::move(execution_inputs), &profile));
+    absl::Duration duration = absl::Nanoseconds(profile.compute_time_ns());
+    if (result.has_value()) {
+      duration = std::min(duration, result->duration);
+    }
+    result.emplace(duration, execution_output.Commit().ConsumeResult());
+  }
+  return result;
 }
 
 absl::StatusOr<std::unique_ptr<Executable>> AutotunerCompileUtil::Compile(
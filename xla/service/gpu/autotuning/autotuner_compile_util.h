@@ -81,10 +81,13 @@ class AutotunerCompileUtil {
   // Runs the resulting executable with the given extractor, cached with
   // `(cache_key, config)`. Returns `std::nullopt` on expected failure, bad
   // `Status` otherwise.
+  //
+  // After a warm-up run the executable is timed `num_runs` times. The
+  // shortest time is returned together with the output of the last run.
   absl::StatusOr<std::optional<ProfilingOutput>> ProfileExecutable(
       Executable* executable, se::Stream* stream,
       absl::Span<se::DeviceMemoryBase const> input_buffers,
-      absl::Span<Shape const> input_shapes);
+      absl::Span<Shape const> input_shapes, int num_runs = 1);
 
   // Generic method to compile a generated module from `extractor` in isolation.
   //
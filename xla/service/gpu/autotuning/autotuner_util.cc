@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <optional>
@@ -97,9 +98,34 @@ absl::StatusOr<std::string> GetBase64EncodedSha256Hash(absl::string_view s) {
 
 namespace {
 
+// Number of leading characters of the key hash used to select a cache shard.
+// With base64 encoded hashes this gives 4096 shards, which keeps the number of
+// files per directory small even when many jobs share the same cache dir.
+constexpr size_t kCacheShardPrefixLength = 2;
+
+// Get the shard directory corresponding to the given key.
+absl::StatusOr<std::string> GetCacheShardDir(absl::string_view cache_dir,
+                                             absl::string_view key_hash) {
+  if (cache_dir.empty()) {
+    return absl::InvalidArgumentError("autotune_cache_dir should not be empty");
+  }
+
+  return tsl::io::JoinPath(cache_dir,
+                           key_hash.substr(0, kCacheShardPrefixLength));
+}
+
 // Get the path corresponding to the given key.
 absl::StatusOr<std::string> GetCacheFilePath(absl::string_view cache_dir,
                                              absl::string_view key_hash) {
+  TF_ASSIGN_OR_RETURN(std::string shard_dir,
+                      GetCacheShardDir(cache_dir, key_hash));
+  return tsl::io::JoinPath(shard_dir, absl::StrCat(key_hash, ".textproto"));
+}
+
+// Get the path corresponding to the given key in the legacy (unsharded) cache
+// layout, that we still support for reading.
+absl::StatusOr<std::string> GetLegacyCacheFilePath(absl::string_view cache_dir,
+                                                   absl::string_view key_hash) {
   if (cache_dir.empty()) {
     return absl::InvalidArgumentError("autotune_cache_dir should not be empty");
   }
@@ -141,9 +167,23 @@ absl::Status AddResultToFileBasedCacheIfEnabled(
   TF_ASSIGN_OR_RETURN(std::string key_hash,
                       GetBase64EncodedSha256Hash(key.ToString()));
 
+  TF_ASSIGN_OR_RETURN(const std::string shard_dir,
+                      GetCacheShardDir(cache_dir, key_hash));
+  TF_RETURN_IF_ERROR(CreateDirIfNeeded(shard_dir, default_env));
+
   TF_ASSIGN_OR_RETURN(const std::string file_path,
                       GetCacheFilePath(cache_dir, key_hash));
 
+  // The file based cache is append-only: if another process (or thread) has
+  // already written the result for the same key, we keep the existing entry.
+  // Autotuning results for the same key are interchangeable, and not
+  // rewriting existing entries avoids redundant writes when many jobs that
+  // share the cache directory autotune the same fusions.
+  if (default_env->FileExists(file_path).ok()) {
+    VLOG(1) << "Autotune result file already exists: " << file_path;
+    return absl::OkStatus();
+  }
+
   VLOG(1) << "Writing autotune result to file: " << file_path;
 
   std::string result_str;
@@ -159,8 +199,11 @@ absl::Status AddResultToFileBasedCacheIfEnabled(
   TF_RETURN_IF_ERROR(CreateDirIfNeeded(tmp_dir, default_env));
   int64_t time_stamp = absl::GetCurrentTimeNanos();
 
+  // Temporary file name includes the process id to avoid collisions between
+  // concurrent writers from multiple processes.
   std::string temp_file_path = tsl::io::JoinPath(
       tmp_dir, absl::StrCat("tmp_per_fusion_cache_", key_hash, "_",
+                            default_env->GetProcessId(), "_",
                             std::to_string(time_stamp), ".textproto"));
 
   TF_RETURN_IF_ERROR(
@@ -202,11 +245,18 @@ TryToFindInFileBasedCacheIfEnabled(const AutotuneCacheKey& key,
   TF_ASSIGN_OR_RETURN(std::string key_hash,
                       GetBase64EncodedSha256Hash(key.ToString()));
 
-  TF_ASSIGN_OR_RETURN(const std::string file_path,
+  // Reads do not take any locks: cache entries are written atomically with a
+  // rename, so we either see a complete entry or no entry at all.
+  TF_ASSIGN_OR_RETURN(std::string file_path,
                       GetCacheFilePath(cache_dir, key_hash));
   if (!tsl::Env::Default()->FileExists(file_path).ok()) {
-    VLOG(1) << "Autotune result file not found: " << file_path;
-    return std::nullopt;
+    TF_ASSIGN_OR_RETURN(std::string legacy_file_path,
+                        GetLegacyCacheFilePath(cache_dir, key_hash));
+    if (!tsl::Env::Default()->FileExists(legacy_file_path).ok()) {
+      VLOG(1) << "Autotune result file not found: " << file_path;
+      return std::nullopt;
+    }
+    file_path = std::move(legacy_file_path);
   }
 
   VLOG(1) << "Autotune result file found: " << file_path;
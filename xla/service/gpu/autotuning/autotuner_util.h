@@ -125,6 +125,12 @@ class AutotuneConfig {
         autotune_cache_dir_(right.autotune_cache_dir_),
         autotune_cache_mode_(right.autotune_cache_mode_) {}
 
+  // Same settings as `right`, but measuring on the device in `device_config`.
+  AutotuneConfig(const AutotuneConfig& right, const DeviceConfig& device_config)
+      : AutotuneConfig(right) {
+    config_ = device_config;
+  }
+
   AutotuneConfig(const std::variant<DeviceConfig, DevicelessConfig>& config,
                  const DebugOptions& debug_options)
       : config_(config),
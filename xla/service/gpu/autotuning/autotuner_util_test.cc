@@ -299,7 +299,8 @@ class FileBasedCacheTest : public AutotunerUtilTest {
 
   void Write(const absl::string_view filepath,
              const absl::string_view content) {
-    TF_CHECK_OK(CreateDirIfNeeded(cache_dir_, tsl::Env::Default()));
+    TF_CHECK_OK(CreateDirIfNeeded(std::string(tsl::io::Dirname(filepath)),
+                                  tsl::Env::Default()));
     TF_CHECK_OK(tsl::WriteStringToFile(tsl::Env::Default(),
                                        std::string(filepath), content));
   }
@@ -339,7 +340,16 @@ class FileBasedCacheTest : public AutotunerUtilTest {
     return absl::StrCat(key_hash.value(), ".textproto");
   }
 
+  std::string GetCacheShardName() const {
+    return GetCacheFilename().substr(0, 2);
+  }
+
   std::string GetCacheFilePath() const {
+    return tsl::io::JoinPath(cache_dir_, GetCacheShardName(),
+                             GetCacheFilename());
+  }
+
+  std::string GetLegacyCacheFilePath() const {
     return tsl::io::JoinPath(cache_dir_, GetCacheFilename());
   }
   const AutotuneResult result1_ = [] {
@@ -367,7 +377,9 @@ TEST_F(FileBasedCacheTest, AutotuneCreatesTmpAndWritesResultToTheCacheDir) {
   EXPECT_EQ(ToString(result), ToString(result1_));
 
   ASSERT_THAT(GetFilesInDir(cache_dir_),
-              UnorderedElementsAre(GetCacheFilename(), "tmp"));
+              UnorderedElementsAre(GetCacheShardName(), "tmp"));
+  ASSERT_THAT(GetFilesInDir(tsl::io::Dirname(GetCacheFilePath())),
+              UnorderedElementsAre(GetCacheFilename()));
   EXPECT_EQ(Read(GetCacheFilePath()), ToString(result1_));
 }
 
@@ -387,6 +399,22 @@ TEST_F(FileBasedCacheTest, AutotuneReadsResultFromTheCacheDir) {
   EXPECT_EQ(ToString(result), ToString(result1_));
 }
 
+TEST_F(FileBasedCacheTest, AutotuneReadsResultFromTheLegacyCacheLayout) {
+  Write(GetLegacyCacheFilePath(), ToString(result1_));
+
+  bool cache_hit = true;
+  TF_ASSERT_OK_AND_ASSIGN(AutotuneResult result,
+                          AutotunerUtil::Autotune(dot_, GetConfig(), [&] {
+                            cache_hit = false;
+                            return result2_;
+                          }));
+
+  EXPECT_TRUE(cache_hit);
+  EXPECT_EQ(AutotunerUtil::GetCacheStats().cache_hits, 1);
+  EXPECT_EQ(AutotunerUtil::GetCacheStats().cache_misses, 0);
+  EXPECT_EQ(ToString(result), ToString(result1_));
+}
+
 TEST_F(FileBasedCacheTest,
        RepeatedAutotuneCallsDontReadOrWriteTheCacheFileAgain) {
   auto check_autotune_cache_hit = [](const HloInstruction* instr,
@@ -449,7 +477,9 @@ TEST_F(FileBasedCacheTest, AddResultAddsTheResultToTheFileBasedCache) {
   EXPECT_TRUE(added);
 
   ASSERT_THAT(GetFilesInDir(cache_dir_),
-              UnorderedElementsAre(GetCacheFilename(), "tmp"));
+              UnorderedElementsAre(GetCacheShardName(), "tmp"));
+  ASSERT_THAT(GetFilesInDir(tsl::io::Dirname(GetCacheFilePath())),
+              UnorderedElementsAre(GetCacheFilename()));
   EXPECT_EQ(Read(GetCacheFilePath()), ToString(result1_));
 }
 
@@ -463,7 +493,9 @@ TEST_F(FileBasedCacheTest, RepeatedAddResultDoesNotWriteTheFileAgain) {
     EXPECT_TRUE(added);
   }
   ASSERT_THAT(GetFilesInDir(cache_dir_),
-              UnorderedElementsAre(GetCacheFilename(), "tmp"));
+              UnorderedElementsAre(GetCacheShardName(), "tmp"));
+  ASSERT_THAT(GetFilesInDir(tsl::io::Dirname(GetCacheFilePath())),
+              UnorderedElementsAre(GetCacheFilename()));
   EXPECT_EQ(Read(cache_file_path), ToString(result1_));
   constexpr absl::string_view kPlaceholderContent = "placeholder content";
   Write(cache_file_path, kPlaceholderContent);
@@ -478,6 +510,21 @@ TEST_F(FileBasedCacheTest, RepeatedAddResultDoesNotWriteTheFileAgain) {
   EXPECT_EQ(Read(cache_file_path), kPlaceholderContent);
 }
 
+TEST_F(FileBasedCacheTest, AddResultDoesNotOverwriteEntryFromAnotherProcess) {
+  // Simulate another process that shares the cache dir and has already
+  // written the result for the same key.
+  const std::string cache_file_path = GetCacheFilePath();
+  Write(cache_file_path, ToString(result2_));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool added,
+      AutotunerUtil::AddResult(GetCacheKey(), result1_, GetConfig()));
+  EXPECT_TRUE(added);  // was added to in memory cache.
+
+  // File based cache is append-only and keeps the existing entry.
+  EXPECT_EQ(Read(cache_file_path), ToString(result2_));
+}
+
 TEST(AutotuneCacheKeyTest, DeviceDescriptionToCacheKey) {
   auto device_description =
       [](absl::string_view spec_file_name) -> se::DeviceDescription {
@@ -20,6 +20,7 @@ limitations under the License.
 #include <atomic>
 #include <cstdint>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
@@ -89,8 +90,10 @@ limitations under the License.
 #include "xla/stream_executor/device_memory.h"
 #include "xla/stream_executor/device_memory_allocator.h"
 #include "xla/stream_executor/gpu/redzone_allocator.h"
+#include "xla/stream_executor/platform.h"
 #include "xla/stream_executor/semantic_version.h"
 #include "xla/stream_executor/stream.h"
+#include "xla/stream_executor/stream_executor.h"
 #include "xla/stream_executor/stream_executor_memory_allocator.h"
 #include "xla/tools/hlo_decomposer.h"
 #include "xla/tsl/lib/core/bits.h"
@@ -137,6 +140,16 @@ constexpr TritonGemmConfig kDefaultGemmTiling = {32, 32, 32, 1, 1, 4};
 // Split-K is enabled when the estimate number of waves is lower than the limit.
 constexpr int kMaxWavesForSplitK = 5;
 
+// With successive halving, tilings whose estimated cost exceeds the best
+// estimate by more than this factor are not compiled.
+constexpr double kMaxEstimatedSlowdown = 4.0;
+
+// With successive halving, each timing round keeps 1/kHalvingReductionFactor
+// of the candidates, but never fewer than kNumFinalists. The number of timed
+// runs doubles from one round to the next.
+constexpr int kHalvingReductionFactor = 4;
+constexpr int kNumFinalists = 4;
+
 // Search space for exhaustive matmul autotuning.
 constexpr std::array<int, 6> kBlockSizes = {16, 32, 64, 128, 256, 512};
 constexpr std::array<int, 4> kNumStages = {1, 2, 3, 4};
@@ -260,6 +273,64 @@ absl::StatusOr<TileSizeLimit> GetLimits(const HloDotInstruction& dot) {
   };
 }
 
+// Drops the Triton tilings that are obviously slower than the others.
+//
+// The cost of a tiling is estimated as the number of waves of thread blocks
+// times the work of one block, as if every core ran one block at a time at the
+// same throughput. This ignores everything but wave quantization and the split
+// of the contracting dimension, which is enough to recognize tilings that leave
+// most of the GPU idle, but too coarse to rank tilings of similar cost, so
+// only configs far behind the best estimate are dropped.
+absl::StatusOr<std::vector<TritonGemmConfig>> DropSlowTritonConfigs(
+    const HloDotInstruction& dot, int core_count,
+    std::vector<TritonGemmConfig> configs) {
+  TF_ASSIGN_OR_RETURN(int64_t non_contracting_index_lhs,
+                      NonContractingDimensionIndex(dot, /*operand_number=*/0));
+  TF_ASSIGN_OR_RETURN(int64_t non_contracting_index_rhs,
+                      NonContractingDimensionIndex(dot, /*operand_number=*/1));
+  const DotDimensionNumbers& dims = dot.dot_dimension_numbers();
+  const Shape& lhs_shape = dot.operand(0)->shape();
+  const int64_t m = lhs_shape.dimensions(non_contracting_index_lhs);
+  const int64_t n =
+      dot.operand(1)->shape().dimensions(non_contracting_index_rhs);
+  int64_t k = 1;
+  for (int64_t dim : dims.lhs_contracting_dimensions()) {
+    k *= lhs_shape.dimensions(dim);
+  }
+  int64_t batch = 1;
+  for (int64_t dim : dims.lhs_batch_dimensions()) {
+    batch *= lhs_shape.dimensions(dim);
+  }
+
+  auto estimate_cost = [&](const TritonGemmConfig& config) {
+    const int64_t num_blocks = batch * CeilOfRatio<int64_t>(m, config.block_m) *
+                               CeilOfRatio<int64_t>(n, config.block_n) *
+                               config.split_k;
+    const int64_t num_waves =
+        CeilOfRatio<int64_t>(num_blocks, std::max(core_count, 1));
+    const int64_t k_per_block =
+        RoundUpTo<int64_t>(CeilOfRatio<int64_t>(k, config.split_k),
+                           config.block_k);
+    return static_cast<double>(num_waves) * config.block_m * config.block_n *
+           k_per_block;
+  };
+
+  double best_cost = std::numeric_limits<double>::infinity();
+  for (const TritonGemmConfig& config : configs) {
+    best_cost = std::min(best_cost, estimate_cost(config));
+  }
+  const size_t num_configs = configs.size();
+  configs.erase(std::remove_if(configs.begin(), configs.end(),
+                               [&](const TritonGemmConfig& config) {
+                                 return estimate_cost(config) >
+                                        kMaxEstimatedSlowdown * best_cost;
+                               }),
+                configs.end());
+  VLOG(3) << "Cost model dropped " << num_configs - configs.size() << " of "
+          << num_configs << " Triton configs for " << dot.name();
+  return configs;
+}
+
 int GetLogEveryN() { return VLOG_IS_ON(3) ? 100 : 1000; }
 
 int64_t PriorityFusionShapeSize(const Shape& shape) {
@@ -302,7 +373,7 @@ absl::StatusOr<std::unique_ptr<HloModule>> TritonGemmAutotuneExtractor(
   *backend_config.mutable_triton_gemm_config() = config.ToProto();
   TF_RETURN_IF_ERROR(cloned_dot_fusion->set_backend_config(gpu_config));
 
-  if (config.split_k > 1) {
+  if (config.NeedsSplitKRewrite()) {
     TF_RETURN_IF_ERROR(MakeDotSplitKBatch(cloned_dot_fusion, config));
     for (PrimitiveType type :
          {BF16, F8E5M2, F8E4M3FN, F8E4M3B11FNUZ, F8E5M2FNUZ, F8E4M3FNUZ}) {
@@ -595,7 +666,7 @@ absl::Status HandleTritonGemm(HloInstruction* fusion_instr,
   TF_ASSIGN_OR_RETURN(
       const TritonGemmConfig config,
       TritonGemmConfig::FromProto(fusion_backend_config.triton_gemm_config()));
-  if (config.split_k > 1) {
+  if (config.NeedsSplitKRewrite()) {
     TF_RETURN_IF_ERROR(MakeDotSplitKBatch(fusion_instr, config));
   }
   return absl::OkStatus();
@@ -885,6 +956,15 @@ GemmFusionAutotunerImpl::GenerateTritonConfigs(const HloDotInstruction& dot) {
   const int64_t kSufficientNumberOfTiles = kMaxWavesForSplitK * kCoreCount;
   const int64_t result_size = ShapeUtil::ElementsIn(dot.shape());
 
+  // Atomic split-K avoids the separate reduction fusion and the HBM traffic
+  // for the partial results, but the order of additions is not fixed.
+  const bool try_atomic_split_k =
+      debug_options_.xla_gpu_enable_split_k_autotuning() &&
+      debug_options_.xla_gpu_enable_triton_gemm_atomic_split_k() &&
+      !debug_options_.xla_gpu_deterministic_ops() &&
+      !debug_options_.xla_gpu_exclude_nondeterministic_ops() &&
+      SupportsAtomicSplitK(dot);
+
   // Triton configurations are adjusted and deduplicated.
   absl::flat_hash_set<TritonGemmConfig> added;
   bool is_hopper =
@@ -926,6 +1006,17 @@ GemmFusionAutotunerImpl::GenerateTritonConfigs(const HloDotInstruction& dot) {
     if (added.insert(config).second) {
       result_configs.push_back(config);
     }
+    if (try_atomic_split_k && config.split_k > 1) {
+      TritonGemmConfig atomic_config = config;
+      atomic_config.atomic_split_k = true;
+      if (added.insert(atomic_config).second) {
+        result_configs.push_back(atomic_config);
+      }
+    }
+  }
+  if (debug_options_.xla_gpu_autotune_successive_halving() &&
+      result_configs.size() > 1) {
+    return DropSlowTritonConfigs(dot, kCoreCount, std::move(result_configs));
   }
   return result_configs;
 }
@@ -1083,11 +1174,12 @@ GemmFusionAutotunerImpl::CompileAll(AutotunerCompileUtil& compile_util,
 }
 
 absl::StatusOr<std::vector<AutotuneResult>> GemmFusionAutotunerImpl::Profile(
-    AutotunerCompileUtil& compile_util, const HloFusionInstruction& fusion,
+    AutotunerCompileUtil& compile_util, const AutotuneConfig& config,
+    const HloFusionInstruction& fusion,
     absl::Span<const ExecutableCandidate> candidates) {
   const HloComputation* fusion_computation = fusion.called_computations().at(0);
 
-  se::StreamExecutor* stream_exec = config_.GetExecutor();
+  se::StreamExecutor* stream_exec = config.GetExecutor();
   if (!stream_exec->SynchronizeAllActivity()) {
     return Internal("Failed to synchronize GPU for autotuning.");
   }
@@ -1095,14 +1187,14 @@ absl::StatusOr<std::vector<AutotuneResult>> GemmFusionAutotunerImpl::Profile(
     return absl::StrFormat("XlaAutotunerMeasurement:#hlo_op=%s#",
                            fusion.name());
   });
-  se::DeviceMemoryAllocator* allocator = config_.GetAllocator();
+  se::DeviceMemoryAllocator* allocator = config.GetAllocator();
   std::unique_ptr<se::DeviceMemoryAllocator> owned_allocator;
   if (allocator == nullptr) {
     owned_allocator =
         std::make_unique<se::StreamExecutorMemoryAllocator>(stream_exec);
     allocator = owned_allocator.get();
   }
-  TF_ASSIGN_OR_RETURN(se::Stream* const stream, config_.GetStream());
+  TF_ASSIGN_OR_RETURN(se::Stream* const stream, config.GetStream());
 
   const HloInstruction& root = *fusion_computation->root_instruction();
   BufferComparator comparator(root.shape(),
@@ -1110,31 +1202,96 @@ absl::StatusOr<std::vector<AutotuneResult>> GemmFusionAutotunerImpl::Profile(
 
   TF_ASSIGN_OR_RETURN(auto rz_buffers,
                       RedzoneBuffers::FromInstruction(
-                          *fusion_computation->FusionInstruction(), config_,
+                          *fusion_computation->FusionInstruction(), config,
                           debug_options_, RedzoneBuffers::kAllInputs));
 
+  std::vector<const ExecutableCandidate*> finalists;
+  std::vector<AutotuneResult> pruned_results;
+  int num_runs = 1;
+  if (debug_options_.xla_gpu_autotune_successive_halving() &&
+      IsAutotuningEnabled()) {
+    // Rounds of timing runs without correctness checks select the finalists.
+    // The cuBLAS reference is always measured fully.
+    std::vector<const ExecutableCandidate*> contenders;
+    for (const ExecutableCandidate& candidate : candidates) {
+      if (std::holds_alternative<CuBlasConfig>(candidate.config)) {
+        finalists.push_back(&candidate);
+      } else {
+        contenders.push_back(&candidate);
+      }
+    }
+    while (contenders.size() > kNumFinalists) {
+      std::vector<std::pair<absl::Duration, const ExecutableCandidate*>>
+          timings;
+      for (const ExecutableCandidate* candidate : contenders) {
+        TF_ASSIGN_OR_RETURN(std::optional<ProfilingOutput> profiling_output,
+                            compile_util.ProfileExecutable(
+                                candidate->executable.get(), stream,
+                                rz_buffers.input_buffers(),
+                                rz_buffers.input_shapes(), num_runs));
+        if (!profiling_output) {
+          VLOG(5) << "Skipping this tiling.";
+          continue;
+        }
+        timings.push_back({profiling_output->duration, candidate});
+      }
+      // Candidates with equal timings keep their well-defined order.
+      absl::c_stable_sort(timings, [](const auto& a, const auto& b) {
+        return a.first < b.first;
+      });
+      const size_t num_kept = std::max<size_t>(
+          kNumFinalists,
+          CeilOfRatio<size_t>(timings.size(), kHalvingReductionFactor));
+      contenders.clear();
+      for (size_t i = 0; i < timings.size(); ++i) {
+        if (i < num_kept) {
+          contenders.push_back(timings[i].second);
+          continue;
+        }
+        AutotuneResult res = FromConfig(timings[i].second->config);
+        *res.mutable_run_time() =
+            tsl::proto_utils::ToDurationProto(timings[i].first);
+        res.mutable_failure()->set_kind(AutotuneResult::DISQUALIFIED);
+        res.mutable_failure()->set_msg(
+            "Pruned by a successive halving round.");
+        pruned_results.push_back(std::move(res));
+      }
+      VLOG(3) << "Successive halving kept " << contenders.size() << " of "
+              << timings.size() << " candidates for " << fusion.name()
+              << " after " << num_runs << " runs each.";
+      num_runs *= 2;
+    }
+    // Measure the finalists in the original order of the candidates.
+    absl::c_sort(contenders);
+    finalists.insert(finalists.end(), contenders.begin(), contenders.end());
+  } else {
+    for (const ExecutableCandidate& candidate : candidates) {
+      finalists.push_back(&candidate);
+    }
+  }
+
   const int log_every_n = GetLogEveryN();
   std::vector<AutotuneResult> results;
   std::optional<ScopedShapedBuffer> reference_buffer;
-  for (const ExecutableCandidate& candidate : candidates) {
-    VLOG(5) << "Trying : " << ToString(candidate.config);
-    AutotuneResult res = FromConfig(candidate.config);
+  for (const ExecutableCandidate* candidate : finalists) {
+    VLOG(5) << "Trying : " << ToString(candidate->config);
+    AutotuneResult res = FromConfig(candidate->config);
 
     std::optional<ProfilingOutput> profiling_output;
     if (IsAutotuningEnabled()) {
       TF_ASSIGN_OR_RETURN(
           profiling_output,
-          compile_util.ProfileExecutable(candidate.executable.get(), stream,
-                                         rz_buffers.input_buffers(),
-                                         rz_buffers.input_shapes()));
-      if (std::holds_alternative<CuBlasConfig>(candidate.config) &&
-          config_.should_check_correctness()) {
+          compile_util.ProfileExecutable(
+              candidate->executable.get(), stream, rz_buffers.input_buffers(),
+              rz_buffers.input_shapes(), num_runs));
+      if (std::holds_alternative<CuBlasConfig>(candidate->config) &&
+          config.should_check_correctness()) {
         reference_buffer = std::move(profiling_output->output);
       }
 
       int ran_so_far = results.size() + 1;
       if (ran_so_far % log_every_n == 0) {
-        VLOG(2) << "Ran " << ran_so_far << " configs of " << candidates.size()
+        VLOG(2) << "Ran " << ran_so_far << " configs of " << finalists.size()
                 << ".";
       }
       if (!profiling_output) {
@@ -1147,7 +1304,7 @@ absl::StatusOr<std::vector<AutotuneResult>> GemmFusionAutotunerImpl::Profile(
         LOG(WARNING) << "Slow kernel for "
                      << fusion.called_computations()[0]->ToString()
                      << " took: " << profiling_output->duration << ". "
-                     << ToString(candidate.config);
+                     << ToString(candidate->config);
       }
       *res.mutable_run_time() =
           tsl::proto_utils::ToDurationProto(profiling_output->duration);
@@ -1156,7 +1313,7 @@ absl::StatusOr<std::vector<AutotuneResult>> GemmFusionAutotunerImpl::Profile(
     // Reference buffer is available when `config.should_check_correctness()`
     // is set and reference executable was compiled.
     if (reference_buffer.has_value() &&
-        !std::holds_alternative<CuBlasConfig>(candidate.config)) {
+        !std::holds_alternative<CuBlasConfig>(candidate->config)) {
       TF_ASSIGN_OR_RETURN(
           se::RedzoneAllocator::RedzoneCheckStatus rz_check_status,
           rz_buffers.RedzoneAllocator().CheckRedzones());
@@ -1164,7 +1321,7 @@ absl::StatusOr<std::vector<AutotuneResult>> GemmFusionAutotunerImpl::Profile(
         LOG(ERROR) << "Red zone modified";
         res.mutable_failure()->set_kind(AutotuneResult::REDZONE_MODIFIED);
         res.mutable_failure()->set_msg(rz_check_status.RedzoneFailureMsg());
-        CHECK(!config_.should_crash_on_check_failure());
+        CHECK(!config.should_crash_on_check_failure());
         continue;
       }
 
@@ -1178,7 +1335,7 @@ absl::StatusOr<std::vector<AutotuneResult>> GemmFusionAutotunerImpl::Profile(
             "Results do not match the reference. This is likely a "
             "bug/unexpected loss of precision.";
         LOG(ERROR) << kMessage;
-        CHECK(!config_.should_crash_on_check_failure());
+        CHECK(!config.should_crash_on_check_failure());
         // WRONG_RESULT is not taken seriously by PickBestResult(), so
         // use DISQUALIFIED.
         res.mutable_failure()->set_kind(AutotuneResult::DISQUALIFIED);
@@ -1187,6 +1344,8 @@ absl::StatusOr<std::vector<AutotuneResult>> GemmFusionAutotunerImpl::Profile(
     }
     results.push_back(std::move(res));
   }
+  // Pruned candidates come last, so that the reference stays first.
+  absl::c_move(pruned_results, std::back_inserter(results));
   VLOG(2) << "Done running.";
   return results;
 }
@@ -1288,6 +1447,31 @@ absl::Status DumpAutotuningLogs(const DebugOptions& debug_opts,
   return absl::OkStatus();
 }
 
+// Returns the configs of the devices that fusions can be profiled on in
+// parallel: the device of `config` first, followed by the other local devices
+// of the same model that are already in use by this process and that the
+// configured allocator can serve, up to `max_devices` in total. Devices that
+// the allocator does not know about may be owned by other processes and are
+// never used.
+static std::vector<AutotuneConfig> GetProfilingConfigs(
+    const AutotuneConfig& config, int max_devices) {
+  std::vector<AutotuneConfig> configs = {config};
+  se::StreamExecutor* stream_exec = config.GetExecutor();
+  se::Platform* platform = stream_exec->GetPlatform();
+  se::DeviceMemoryAllocator* allocator = config.GetAllocator();
+  const std::string model_str = config.GetModelStr();
+  for (int ordinal = 0; ordinal < platform->VisibleDeviceCount(); ++ordinal) {
+    if (static_cast<int>(configs.size()) >= max_devices) break;
+    if (ordinal == stream_exec->device_ordinal()) continue;
+    absl::StatusOr<se::StreamExecutor*> peer = platform->FindExisting(ordinal);
+    if (!peer.ok() || !allocator->GetStream(ordinal).ok()) continue;
+    AutotuneConfig peer_config(config, DeviceConfig{*peer, allocator});
+    if (peer_config.GetModelStr() != model_str) continue;
+    configs.push_back(std::move(peer_config));
+  }
+  return configs;
+}
+
 absl::Status GemmFusionAutotunerImpl::Autotune(
     AutotunerCompileUtil& compile_util, const BackendConfigs& gemm_config_sets,
     AutoTuneCacheKeyCount fusion_count_map) {
@@ -1302,11 +1486,82 @@ absl::Status GemmFusionAutotunerImpl::Autotune(
     });
   }
 
+  // Process the fusions in a well-defined order, so that neither the hash map
+  // iteration order nor the device a fusion was profiled on affect the dumps
+  // and the order in which results are added to the cache.
+  std::vector<const HloFusionInstruction*> fusions;
+  fusions.reserve(executable_sets.size());
+  for (const auto& [fusion, unused] : executable_sets) {
+    fusions.push_back(fusion);
+  }
+  absl::c_sort(fusions, [](const HloFusionInstruction* a,
+                           const HloFusionInstruction* b) {
+    return a->name() < b->name();
+  });
+
+  int max_devices = fusions.size();
+  if (debug_options_.xla_gpu_autotune_max_devices() > 0) {
+    max_devices = std::min(max_devices,
+                           debug_options_.xla_gpu_autotune_max_devices());
+  }
+  std::vector<AutotuneConfig> device_configs =
+      GetProfilingConfigs(config_, max_devices);
+
+  // All candidates of a fusion are profiled on the same device, so their
+  // timings stay comparable and the correctness check uses a reference
+  // computed on that device.
+  std::vector<absl::StatusOr<std::vector<AutotuneResult>>> fusion_results(
+      fusions.size());
+  if (device_configs.size() == 1) {
+    for (int i = 0; i < fusions.size(); ++i) {
+      fusion_results[i] = Profile(compile_util, config_, *fusions[i],
+                                  executable_sets.at(fusions[i]));
+      if (!fusion_results[i].ok()) break;
+    }
+  } else {
+    std::vector<AutotunerCompileUtil> peer_compile_utils;
+    peer_compile_utils.reserve(device_configs.size() - 1);
+    std::vector<AutotunerCompileUtil*> device_compile_utils = {&compile_util};
+    for (int d = 1; d < device_configs.size(); ++d) {
+      TF_ASSIGN_OR_RETURN(
+          std::optional<AutotunerCompileUtil> peer_compile_util,
+          AutotunerCompileUtil::Create(device_configs[d], debug_options_));
+      TF_RET_CHECK(peer_compile_util.has_value());
+      peer_compile_utils.push_back(*std::move(peer_compile_util));
+      device_compile_utils.push_back(&peer_compile_utils.back());
+    }
+    VLOG(1) << "Profiling " << fusions.size() << " fusions on "
+            << device_configs.size() << " devices.";
+
+    // Every device takes the next unprofiled fusion when it becomes idle. After
+    // a failure no new fusions are started, and since they are taken in order,
+    // all fusions before the failed one have results.
+    std::atomic<int> next_fusion = 0;
+    std::atomic<bool> failed = false;
+    {
+      tsl::thread::ThreadPool profiling_pool(tsl::Env::Default(),
+                                             "xla-autotuner-profiling",
+                                             device_configs.size());
+      for (int d = 0; d < device_configs.size(); ++d) {
+        profiling_pool.Schedule([&, d] {
+          for (int i = next_fusion++; i < fusions.size() && !failed;
+               i = next_fusion++) {
+            fusion_results[i] =
+                Profile(*device_compile_utils[d], device_configs[d],
+                        *fusions[i], executable_sets.at(fusions[i]));
+            if (!fusion_results[i].ok()) failed = true;
+          }
+        });
+      }
+    }
+  }
+
   AutotuningLogs autotuning_logs;
   int fusion_id = 0;
-  for (const auto& [fusion, candidates] : executable_sets) {
+  for (int i = 0; i < fusions.size(); ++i) {
+    const HloFusionInstruction* fusion = fusions[i];
     TF_ASSIGN_OR_RETURN(std::vector<AutotuneResult> results,
-                        Profile(compile_util, *fusion, candidates));
+                        std::move(fusion_results[i]));
 
     // The reference config (if it exists) will be the first in the results,
     // due to how sorting the variants work.
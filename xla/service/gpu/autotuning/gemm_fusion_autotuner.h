@@ -139,9 +139,11 @@ class GemmFusionAutotunerImpl {
                                      std::vector<ExecutableCandidate>>>
   CompileAll(AutotunerCompileUtil& compile_util, const BackendConfigs& task);
 
-  // Profile all executables for a fusion.
+  // Profile all executables for a fusion on the device of `config`.
+  // `compile_util` has to be created for the same device.
   absl::StatusOr<std::vector<AutotuneResult>> Profile(
-      AutotunerCompileUtil& compile_util, const HloFusionInstruction& fusion,
+      AutotunerCompileUtil& compile_util, const AutotuneConfig& config,
+      const HloFusionInstruction& fusion,
       absl::Span<const ExecutableCandidate> candidates);
 
   // Autotune and save the results to the autotuning cache.
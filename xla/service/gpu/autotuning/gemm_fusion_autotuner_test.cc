@@ -1026,6 +1026,119 @@ ENTRY e {
       [](const TritonGemmConfig& config) { return config.split_k == 1; }));
 }
 
+TEST_F(GemmFusionAutotunerTest, SuccessiveHalvingDropsTilingsLeavingGpuIdle) {
+  std::unique_ptr<VerifiedHloModule> module = ParseAndReturnVerifiedModule(R"(
+ENTRY e {
+  p0 = f32[1024,1024] parameter(0)
+  p1 = f32[1024,1024] parameter(1)
+  ROOT r = f32[1024,1024] dot(p0, p1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+})")
+                                                  .value();
+  const se::CudaComputeCapability compute_capability{
+      se::CudaComputeCapability::AMPERE, /*minor=*/0};
+  const auto& dot = *Cast<HloDotInstruction>(
+      module->entry_computation()->root_instruction());
+  // A single 512x512 tile per core leaves most of the cores idle.
+  auto is_huge_tile = [](const TritonGemmConfig& config) {
+    return config.block_m == 512 && config.block_n == 512 &&
+           config.split_k == 1;
+  };
+  DebugOptions debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_gpu_exhaustive_tiling_search(true);
+  TF_ASSERT_OK_AND_ASSIGN(
+      const std::vector<TritonGemmConfig> all_configs,
+      GetPossibleMatmulAutotuneTritonConfigs(dot, compute_capability,
+                                             GetToolkitVersion(),
+                                             debug_options));
+  EXPECT_TRUE(
+      std::any_of(all_configs.begin(), all_configs.end(), is_huge_tile));
+
+  debug_options.set_xla_gpu_autotune_successive_halving(true);
+  TF_ASSERT_OK_AND_ASSIGN(
+      const std::vector<TritonGemmConfig> configs,
+      GetPossibleMatmulAutotuneTritonConfigs(dot, compute_capability,
+                                             GetToolkitVersion(),
+                                             debug_options));
+  EXPECT_FALSE(configs.empty());
+  EXPECT_LT(configs.size(), all_configs.size());
+  EXPECT_FALSE(std::any_of(configs.begin(), configs.end(), is_huge_tile));
+  for (const TritonGemmConfig& config : configs) {
+    EXPECT_NE(std::find(all_configs.begin(), all_configs.end(), config),
+              all_configs.end());
+  }
+}
+
+class GemmFusionAutotunerSuccessiveHalvingTest
+    : public GemmFusionAutotunerTest {
+ public:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options =
+        GemmFusionAutotunerTest::GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_autotune_successive_halving(true);
+    return debug_options;
+  }
+};
+
+TEST_F(GemmFusionAutotunerSuccessiveHalvingTest, SelectsWorkingConfig) {
+  const std::string kHloText = R"(
+HloModule m
+
+ENTRY e {
+  p0 = f16[512,1024] parameter(0)
+  p1 = f16[1024,512] parameter(1)
+  ROOT r = f16[512,512] dot(p0, p1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+})";
+
+  MatchOptimizedHlo(kHloText, R"(
+; CHECK: kind=kCustom
+; CHECK-SAME: block_m
+      )");
+
+  EXPECT_TRUE(RunAndCompare(kHloText, ErrorSpec{/*aabs=*/1e-2, /*arel=*/1e-2}));
+}
+
+TEST_F(GemmFusionAutotunerTest, GeneratesAtomicSplitKConfigs) {
+  std::unique_ptr<VerifiedHloModule> module = ParseAndReturnVerifiedModule(R"(
+ENTRY e {
+  p0 = f32[1024,1024] parameter(0)
+  p1 = f32[1024,1024] parameter(1)
+  ROOT r = f32[1024,1024] dot(p0, p1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+})")
+                                                  .value();
+  const se::CudaComputeCapability compute_capability{
+      se::CudaComputeCapability::AMPERE, /*minor=*/0};
+  const auto& dot = *Cast<HloDotInstruction>(
+      module->entry_computation()->root_instruction());
+  DebugOptions debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_gpu_enable_triton_gemm_atomic_split_k(true);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<TritonGemmConfig> configs,
+      GetPossibleMatmulAutotuneTritonConfigs(dot, compute_capability,
+                                             GetToolkitVersion(),
+                                             debug_options));
+  EXPECT_TRUE(std::any_of(
+      configs.begin(), configs.end(),
+      [](const TritonGemmConfig& config) { return config.atomic_split_k; }));
+  EXPECT_TRUE(std::all_of(configs.begin(), configs.end(),
+                          [](const TritonGemmConfig& config) {
+                            return !config.atomic_split_k || config.split_k > 1;
+                          }));
+
+  // The order of the atomic additions is not deterministic.
+  debug_options.set_xla_gpu_exclude_nondeterministic_ops(true);
+  TF_ASSERT_OK_AND_ASSIGN(
+      configs,
+      GetPossibleMatmulAutotuneTritonConfigs(dot, compute_capability,
+                                             GetToolkitVersion(),
+                                             debug_options));
+  EXPECT_FALSE(std::any_of(
+      configs.begin(), configs.end(),
+      [](const TritonGemmConfig& config) { return config.atomic_split_k; }));
+}
+
 class GemmFusionAutotunerConfigTest
     : public StatelessAutotunerTest,
       public ::testing::WithParamInterface<bool> {};
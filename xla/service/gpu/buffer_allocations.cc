@@ -38,10 +38,9 @@ absl::Status BufferAllocations::TearDown(
     const BufferAllocation& allocation = allocations[i];
     se::DeviceMemoryBase buffer_address = GetDeviceAddress(allocation.index());
     // Deallocate buffers marked "maybe_live_out" but aren't actually live out,
-    // and temp buffers.
-    if ((allocation.maybe_live_out() &&
-         !live_addresses.count(buffer_address)) ||
-        allocation.IsPreallocatedTempBuffer()) {
+    // and temp buffers that aren't kept alive.
+    if ((allocation.maybe_live_out() || allocation.IsPreallocatedTempBuffer()) &&
+        !live_addresses.count(buffer_address)) {
       auto dealloc_result =
           memory_allocator_->Deallocate(device_ordinal_, buffer_address);
       if (!dealloc_result.ok() && status.ok()) {
@@ -23,6 +23,8 @@ limitations under the License.
 #include <vector>
 
 #include "Eigen/Core"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "xla/service/gpu/launch_dimensions.h"
 #include "xla/service/hlo_module_config.h"
 #include "xla/shape.h"
@@ -45,7 +47,12 @@ namespace gpu {
 template <typename ElementT>
 using ComparisonKernelT =
     se::TypedKernel<se::DeviceMemory<ElementT>, se::DeviceMemory<ElementT>,
-                    float, uint64_t, se::DeviceMemory<uint64_t>>;
+                    float, uint64_t, se::DeviceMemoryBase>;
+
+using ComparisonSummary = BufferComparator::ComparisonSummary;
+
+// The comparison kernels write the summary with this layout.
+static_assert(sizeof(ComparisonSummary) == 16);
 
 struct ComparisonParams {
   double relative_tol = 0.1;
@@ -56,23 +63,25 @@ struct ComparisonParams {
   se::DeviceMemoryBase expected{};
 };
 
-// Compares two buffers on the GPU.
-//
-// Returns `true` if two buffers are equal, `false` otherwise.
+// Enqueues the comparison of two buffers on the GPU, which writes its result
+// to `summary`.
 template <typename ElementT>
-static absl::StatusOr<bool> DeviceCompare(std::string_view kernel_name,
-                                          void* kernel_symbol,
-                                          const ComparisonParams& params) {
+static absl::Status DeviceCompare(std::string_view kernel_name,
+                                  void* kernel_symbol,
+                                  const ComparisonParams& params,
+                                  se::DeviceMemoryBase summary) {
   se::StreamExecutor* executor = params.stream->parent();
 
-  se::DeviceMemoryHandle out(executor, executor->AllocateScalar<uint64_t>());
-
-  TF_RETURN_IF_ERROR(
-      params.stream->MemZero(out.memory_ptr(), sizeof(uint64_t)));
   if (params.current.size() != params.expected.size()) {
     return Internal("Mismatched buffer size: %d bytes vs. %d bytes",
                     params.current.size(), params.expected.size());
   }
+  if (summary.size() < sizeof(ComparisonSummary)) {
+    return InvalidArgument("Comparison summary buffer too small: %d bytes",
+                           summary.size());
+  }
+  TF_RETURN_IF_ERROR(
+      params.stream->MemZero(&summary, sizeof(ComparisonSummary)));
 
   se::DeviceMemory<ElementT> current_typed(params.current);
   se::DeviceMemory<ElementT> expected_typed(params.expected);
@@ -82,8 +91,8 @@ static absl::StatusOr<bool> DeviceCompare(std::string_view kernel_name,
       ComparisonKernelT<ElementT> comparison_kernel,
       (se::TypedKernelFactory<
           se::DeviceMemory<ElementT>, se::DeviceMemory<ElementT>, float,
-          uint64_t, se::DeviceMemory<uint64_t>>::Create(executor, kernel_name,
-                                                        kernel_symbol)));
+          uint64_t, se::DeviceMemoryBase>::Create(executor, kernel_name,
+                                                  kernel_symbol)));
 
   const se::DeviceDescription& gpu_device_info =
       executor->GetDeviceDescription();
@@ -91,18 +100,10 @@ static absl::StatusOr<bool> DeviceCompare(std::string_view kernel_name,
   LaunchDimensions dim =
       CalculateLaunchDimensions(*params.shape, gpu_device_info);
 
-  se::DeviceMemory<uint64_t> as_uint64(out.memory());
-  TF_RETURN_IF_ERROR(params.stream->ThenLaunch(
+  return params.stream->ThenLaunch(
       dim.thread_counts_per_block(), dim.block_counts(), comparison_kernel,
       current_typed, expected_typed, static_cast<float>(params.relative_tol),
-      buffer_size, as_uint64));
-
-  uint64_t result = -1;
-  CHECK_EQ(out.memory().size(), sizeof(result));
-  TF_RETURN_IF_ERROR(
-      params.stream->Memcpy(&result, out.memory(), sizeof(result)));
-  TF_RETURN_IF_ERROR(params.stream->BlockHostUntilDone());
-  return result == 0;
+      buffer_size, summary);
 }
 
 // Host side comparison code that does the same thing, but reports some of the
@@ -161,75 +162,103 @@ static absl::StatusOr<bool> HostCompare(const ComparisonParams& params) {
   return differences_seen == 0;
 }
 
-template <typename ElementT, typename ComparisonT>
-static absl::StatusOr<bool> CompareEqualParameterized(
-    std::string_view kernel_name, void* kernel_symbol,
-    const ComparisonParams& params) {
-  XLA_SCOPED_LOGGING_TIMER("BufferComparator::CompareEqual");
-  TF_ASSIGN_OR_RETURN(
-      bool result, DeviceCompare<ElementT>(kernel_name, kernel_symbol, params));
-
-  if (result) {
-    return true;
-  }
-
-  TF_ASSIGN_OR_RETURN(bool host_return,
-                      (HostCompare<ElementT, ComparisonT>(params)));
-  CHECK_EQ(host_return, result)
-      << "Host comparison succeeded even though GPU comparison failed.";
-  return false;
-}
-
-absl::StatusOr<bool> BufferComparator::CompareEqual(
-    se::Stream* stream, se::DeviceMemoryBase current,
-    se::DeviceMemoryBase expected) const {
-  ComparisonParams params{relative_tol_, verbose_, &shape_,
-                          stream,        current,  expected};
-
-  switch (shape_.element_type()) {
+// Calls `fn(ElementT{}, ComparisonT{}, kernel_name, kernel_symbol)` for the
+// element and comparison types of `element_type`.
+template <typename Fn>
+static absl::StatusOr<bool> DispatchOnElementType(PrimitiveType element_type,
+                                                  Fn&& fn) {
+  switch (element_type) {
 #if GOOGLE_CUDA  // not available for ROCm yet..
     case xla::F8E4M3FN:
-      return CompareEqualParameterized<tsl::float8_e4m3fn, float>(
-          "fp8_e4m3fn_comparison", buffer_comparator::fp8_e4m3fn_comparison(),
-          params);
+      return fn(tsl::float8_e4m3fn{}, float{}, "fp8_e4m3fn_comparison",
+                buffer_comparator::fp8_e4m3fn_comparison());
     case xla::F8E5M2:
-      return CompareEqualParameterized<tsl::float8_e5m2, float>(
-          "fp8_e5m2_comparison", buffer_comparator::fp8_e5m2_comparison(),
-          params);
+      return fn(tsl::float8_e5m2{}, float{}, "fp8_e5m2_comparison",
+                buffer_comparator::fp8_e5m2_comparison());
 #endif  // GOOGLE_CUDA
 #if TENSORFLOW_USE_ROCM && TF_ROCM_VERSION >= 60200
     case xla::F8E4M3FNUZ:
-      return CompareEqualParameterized<tsl::float8_e4m3fnuz, float>(
-          "fp8_e4m3fnuz_comparison",
-          buffer_comparator::fp8_e4m3fnuz_comparison(), params);
+      return fn(tsl::float8_e4m3fnuz{}, float{}, "fp8_e4m3fnuz_comparison",
+                buffer_comparator::fp8_e4m3fnuz_comparison());
     case xla::F8E5M2FNUZ:
-      return CompareEqualParameterized<tsl::float8_e5m2fnuz, float>(
-          "fp8_e5m2fnuz_comparison",
-          buffer_comparator::fp8_e5m2fnuz_comparison(), params);
+      return fn(tsl::float8_e5m2fnuz{}, float{}, "fp8_e5m2fnuz_comparison",
+                buffer_comparator::fp8_e5m2fnuz_comparison());
 #endif  // TENSORFLOW_USE_ROCM && TF_ROCM_VERSION >= 60200
     case xla::F16:
-      return CompareEqualParameterized<Eigen::half, float>(
-          "fp16_comparison", buffer_comparator::fp16_comparison(), params);
+      return fn(Eigen::half{}, float{}, "fp16_comparison",
+                buffer_comparator::fp16_comparison());
     case xla::BF16:
-      return CompareEqualParameterized<Eigen::bfloat16, float>(
-          "bf16_comparison", buffer_comparator::bf16_comparison(), params);
+      return fn(Eigen::bfloat16{}, float{}, "bf16_comparison",
+                buffer_comparator::bf16_comparison());
     case xla::F32:
-      return CompareEqualParameterized<float, float>(
-          "fp32_comparison", buffer_comparator::fp32_comparison(), params);
+      return fn(float{}, float{}, "fp32_comparison",
+                buffer_comparator::fp32_comparison());
     case xla::F64:
-      return CompareEqualParameterized<double, double>(
-          "fp64_comparison", buffer_comparator::fp64_comparison(), params);
+      return fn(double{}, double{}, "fp64_comparison",
+                buffer_comparator::fp64_comparison());
     case xla::S8:
-      return CompareEqualParameterized<int8_t, float>(
-          "int8_comparison", buffer_comparator::int8_comparison(), params);
+      return fn(int8_t{}, float{}, "int8_comparison",
+                buffer_comparator::int8_comparison());
     case xla::S32:
-      return CompareEqualParameterized<int32_t, float>(
-          "int32_comparison", buffer_comparator::int32_comparison(), params);
+      return fn(int32_t{}, float{}, "int32_comparison",
+                buffer_comparator::int32_comparison());
     default:
       return Unimplemented("Unimplemented element type");
   }
 }
 
+absl::Status BufferComparator::EnqueueCompare(
+    se::Stream* stream, se::DeviceMemoryBase current,
+    se::DeviceMemoryBase expected, se::DeviceMemoryBase summary) const {
+  ComparisonParams params{relative_tol_, verbose_, &shape_,
+                          stream,        current,  expected};
+  return DispatchOnElementType(
+             shape_.element_type(),
+             [&](auto element, auto, std::string_view kernel_name,
+                 void* kernel_symbol) -> absl::StatusOr<bool> {
+               TF_RETURN_IF_ERROR(DeviceCompare<decltype(element)>(
+                   kernel_name, kernel_symbol, params, summary));
+               return true;
+             })
+      .status();
+}
+
+absl::StatusOr<bool> BufferComparator::CompareEqual(
+    se::Stream* stream, se::DeviceMemoryBase current,
+    se::DeviceMemoryBase expected) const {
+  XLA_SCOPED_LOGGING_TIMER("BufferComparator::CompareEqual");
+  se::StreamExecutor* executor = stream->parent();
+  se::DeviceMemoryHandle out(executor,
+                             executor->Allocate(sizeof(ComparisonSummary)));
+  TF_RETURN_IF_ERROR(EnqueueCompare(stream, current, expected, out.memory()));
+
+  ComparisonSummary summary;
+  TF_RETURN_IF_ERROR(stream->Memcpy(&summary, out.memory(), sizeof(summary)));
+  TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
+  if (summary.mismatch_count == 0) {
+    return true;
+  }
+  if (!verbose_) {
+    return false;
+  }
+
+  LOG(ERROR) << summary.mismatch_count << " mismatches, max relative error "
+             << summary.max_relative_error;
+  ComparisonParams params{relative_tol_, verbose_, &shape_,
+                          stream,        current,  expected};
+  TF_ASSIGN_OR_RETURN(
+      bool host_return,
+      DispatchOnElementType(
+          shape_.element_type(),
+          [&](auto element, auto comparison, std::string_view, void*) {
+            return HostCompare<decltype(element), decltype(comparison)>(
+                params);
+          }));
+  CHECK(!host_return)
+      << "Host comparison succeeded even though GPU comparison failed.";
+  return false;
+}
+
 BufferComparator::BufferComparator(const Shape& shape, double tolerance,
                                    bool verbose)
     : shape_(shape), relative_tol_(tolerance), verbose_(verbose) {
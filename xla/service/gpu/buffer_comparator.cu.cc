@@ -41,208 +41,213 @@ namespace xla::gpu::buffer_comparator {
 
 // Comparison kernel code: compare two buffers of
 // fp8/bf16/fp16/fp32/fp64/int8_t/int32_t of length buffer_length where the
-// relative error does not exceed the passed rel_error_threshold. Write the
-// number of mismatches into out parameter mismatch_count.
+// relative error does not exceed the passed rel_error_threshold. Add the
+// number of mismatches and the largest relative error to the summary.
 
 // NaN's are considered equal, and for half's we clamp all numbers to largest
 // and smallest numbers representable to avoid miscomparisons due to overflows.
 namespace {
 
+// Layout of BufferComparator::ComparisonSummary.
+struct Summary {
+  unsigned long long mismatch_count;  // NOLINT(runtime/int)
+  // Relative errors are never negative, so their bit patterns order like
+  // unsigned integers and can be combined with an integer atomicMax.
+  unsigned int max_rel_error_bits;
+};
+
 __device__ __inline__ float Canonicalize(float input) {
   // All fp16 infinities are treated as 65505 or -65505, in order to avoid
   // differences due to overflows.
   return isnan(input) ? input : max(-65505.0f, min(input, 65505.0f));
 }
 
+template <typename T>
+__device__ __inline__ T RelError(T elem_a, T elem_b) {
+  if (isnan(elem_a) && isnan(elem_b)) return 0;
+  if (isinf(elem_a) && isinf(elem_b) && signbit(elem_a) == signbit(elem_b))
+    return 0;
+  return abs(elem_a - elem_b) / (max(abs(elem_a), abs(elem_b)) + 1);
+}
+
+// Compares the buffers in a single pass. Every thread accumulates a
+// grid-stride range of elements, the threads of a block combine their results
+// in shared memory, and every block updates the summary with two atomics.
+template <typename T, typename ToFloat>
+__device__ __inline__ void CompareBuffers(const T* buffer_a, const T* buffer_b,
+                                          float rel_error_threshold,
+                                          uint64_t buffer_length,
+                                          Summary* summary) {
+  __shared__ unsigned long long block_mismatch_count;  // NOLINT(runtime/int)
+  __shared__ unsigned int block_max_rel_error_bits;
+  if (threadIdx.x == 0) {
+    block_mismatch_count = 0;
+    block_max_rel_error_bits = 0;
+  }
+  __syncthreads();
+
+  ToFloat to_float;
+  unsigned long long mismatch_count = 0;  // NOLINT(runtime/int)
+  float max_rel_error = 0;
+  const uint64_t start =
+      threadIdx.x + static_cast<uint64_t>(blockIdx.x) * blockDim.x;
+  const uint64_t stride = static_cast<uint64_t>(gridDim.x) * blockDim.x;
+  for (uint64_t idx = start; idx < buffer_length; idx += stride) {
+    auto rel_error = RelError(to_float(buffer_a[idx]), to_float(buffer_b[idx]));
+    if (rel_error > rel_error_threshold || isnan(rel_error)) ++mismatch_count;
+    // NaN errors count as the largest possible error.
+    max_rel_error = isnan(rel_error)
+                        ? INFINITY
+                        : max(max_rel_error, static_cast<float>(rel_error));
+  }
+
+  if (mismatch_count != 0) atomicAdd(&block_mismatch_count, mismatch_count);
+  atomicMax(&block_max_rel_error_bits, __float_as_uint(max_rel_error));
+  __syncthreads();
+
+  if (threadIdx.x == 0) {
+    if (block_mismatch_count != 0) {
+      atomicAdd(&summary->mismatch_count, block_mismatch_count);
+    }
+    atomicMax(&summary->max_rel_error_bits, block_max_rel_error_bits);
+  }
+}
+
 #if GOOGLE_CUDA
+// TODO(philipphack): Replace with direct conversion to float when this
+// functionality becomes available.
+struct Fp8E4M3FnToFloat {
+  __device__ float operator()(__nv_fp8_storage_t x) const {
+    return Canonicalize(__half2float(__nv_cvt_fp8_to_halfraw(x, __NV_E4M3)));
+  }
+};
+
+struct Fp8E5M2ToFloat {
+  __device__ float operator()(__nv_fp8_storage_t x) const {
+    return Canonicalize(__half2float(__nv_cvt_fp8_to_halfraw(x, __NV_E5M2)));
+  }
+};
+
 __global__ void xla_fp8_e4m3fn_comparison(__nv_fp8_storage_t* buffer_a,
                                           __nv_fp8_storage_t* buffer_b,
                                           float rel_error_threshold,
                                           uint64_t buffer_length,
-                                          int* mismatch_count) {
-  int idx = threadIdx.x + blockIdx.x * blockDim.x;
-  if (idx >= buffer_length) return;
-  // TODO(philipphack): Replace with direct conversion to float when this
-  // functionality becomes available.
-  float elem_a =
-      __half2float(__nv_cvt_fp8_to_halfraw(buffer_a[idx], __NV_E4M3));
-  float elem_b =
-      __half2float(__nv_cvt_fp8_to_halfraw(buffer_b[idx], __NV_E4M3));
-  elem_a = Canonicalize(elem_a);
-  elem_b = Canonicalize(elem_b);
-  if (isnan(elem_a) && isnan(elem_b)) return;
-
-  float rel_error = abs(elem_a - elem_b) / (max(abs(elem_a), abs(elem_b)) + 1);
-
-  if (rel_error > rel_error_threshold || isnan(rel_error))
-    atomicAdd(mismatch_count, 1);
+                                          Summary* summary) {
+  CompareBuffers<__nv_fp8_storage_t, Fp8E4M3FnToFloat>(
+      buffer_a, buffer_b, rel_error_threshold, buffer_length, summary);
 }
 
 __global__ void xla_fp8_e5m2_comparison(__nv_fp8_storage_t* buffer_a,
                                         __nv_fp8_storage_t* buffer_b,
                                         float rel_error_threshold,
                                         uint64_t buffer_length,
-                                        int* mismatch_count) {
-  int idx = threadIdx.x + blockIdx.x * blockDim.x;
-  if (idx >= buffer_length) return;
-  // TODO(philipphack): Replace with direct conversion to float when this
-  // functionality becomes available.
-  float elem_a =
-      __half2float(__nv_cvt_fp8_to_halfraw(buffer_a[idx], __NV_E5M2));
-  float elem_b =
-      __half2float(__nv_cvt_fp8_to_halfraw(buffer_b[idx], __NV_E5M2));
-  elem_a = Canonicalize(elem_a);
-  elem_b = Canonicalize(elem_b);
-  if (isnan(elem_a) && isnan(elem_b)) return;
-
-  float rel_error = abs(elem_a - elem_b) / (max(abs(elem_a), abs(elem_b)) + 1);
-
-  if (rel_error > rel_error_threshold || isnan(rel_error))
-    atomicAdd(mismatch_count, 1);
+                                        Summary* summary) {
+  CompareBuffers<__nv_fp8_storage_t, Fp8E5M2ToFloat>(
+      buffer_a, buffer_b, rel_error_threshold, buffer_length, summary);
 }
 #endif  // GOOGLE_CUDA
 
 #if TENSORFLOW_USE_ROCM && TF_ROCM_VERSION >= 60200
+struct Fp8E4M3FnuzToFloat {
+  __device__ float operator()(__hip_fp8_storage_t x) const {
+    __hip_fp8_e4m3_fnuz elem;
+    elem.__x = x;
+    return Canonicalize(static_cast<float>(elem));
+  }
+};
+
+struct Fp8E5M2FnuzToFloat {
+  __device__ float operator()(__hip_fp8_storage_t x) const {
+    __hip_fp8_e5m2_fnuz elem;
+    elem.__x = x;
+    return Canonicalize(static_cast<float>(elem));
+  }
+};
+
 __global__ void xla_fp8_e4m3fnuz_comparison(__hip_fp8_storage_t* buffer_a,
                                             __hip_fp8_storage_t* buffer_b,
                                             float rel_error_threshold,
                                             uint64_t buffer_length,
-                                            int* mismatch_count) {
-  int idx = threadIdx.x + blockIdx.x * blockDim.x;
-  if (idx >= buffer_length) return;
-  __hip_fp8_e4m3_fnuz elem_a_fp8, elem_b_fp8;
-  elem_a_fp8.__x = buffer_a[idx];
-  elem_b_fp8.__x = buffer_b[idx];
-  float elem_a = static_cast<float>(elem_a_fp8);
-  float elem_b = static_cast<float>(elem_b_fp8);
-  elem_a = Canonicalize(elem_a);
-  elem_b = Canonicalize(elem_b);
-  if (isnan(elem_a) && isnan(elem_b)) return;
-
-  float rel_error = abs(elem_a - elem_b) / (max(abs(elem_a), abs(elem_b)) + 1);
-
-  if (rel_error > rel_error_threshold || isnan(rel_error))
-    atomicAdd(mismatch_count, 1);
+                                            Summary* summary) {
+  CompareBuffers<__hip_fp8_storage_t, Fp8E4M3FnuzToFloat>(
+      buffer_a, buffer_b, rel_error_threshold, buffer_length, summary);
 }
 
 __global__ void xla_fp8_e5m2fnuz_comparison(__hip_fp8_storage_t* buffer_a,
                                             __hip_fp8_storage_t* buffer_b,
                                             float rel_error_threshold,
                                             uint64_t buffer_length,
-                                            int* mismatch_count) {
-  int idx = threadIdx.x + blockIdx.x * blockDim.x;
-  if (idx >= buffer_length) return;
-  __hip_fp8_e5m2_fnuz elem_a_fp8, elem_b_fp8;
-  elem_a_fp8.__x = buffer_a[idx];
-  elem_b_fp8.__x = buffer_b[idx];
-  float elem_a = static_cast<float>(elem_a_fp8);
-  float elem_b = static_cast<float>(elem_b_fp8);
-  elem_a = Canonicalize(elem_a);
-  elem_b = Canonicalize(elem_b);
-  if (isnan(elem_a) && isnan(elem_b)) return;
-
-  float rel_error = abs(elem_a - elem_b) / (max(abs(elem_a), abs(elem_b)) + 1);
-
-  if (rel_error > rel_error_threshold || isnan(rel_error))
-    atomicAdd(mismatch_count, 1);
+                                            Summary* summary) {
+  CompareBuffers<__hip_fp8_storage_t, Fp8E5M2FnuzToFloat>(
+      buffer_a, buffer_b, rel_error_threshold, buffer_length, summary);
 }
 #endif  // TENSORFLOW_USE_ROCM && TF_ROCM_VERSION >= 60200
 
+struct Fp16ToFloat {
+  __device__ float operator()(__half x) const {
+    return Canonicalize(__half2float(x));
+  }
+};
+
+struct Bf16ToFloat {
+  __device__ float operator()(bfloat16 x) const {
+    return Canonicalize(BF16_TO_F32(x));
+  }
+};
+
+template <typename T>
+struct Identity {
+  __device__ T operator()(T x) const { return x; }
+};
+
+template <typename T>
+struct IntToFloat {
+  __device__ float operator()(T x) const { return static_cast<float>(x); }
+};
+
 __global__ void xla_fp16_comparison(__half* buffer_a, __half* buffer_b,
                                     float rel_error_threshold,
-                                    uint64_t buffer_length,
-                                    int* mismatch_count) {
-  int idx = threadIdx.x + blockIdx.x * blockDim.x;
-  if (idx >= buffer_length) return;
-  float elem_a = __half2float(buffer_a[idx]);
-  float elem_b = __half2float(buffer_b[idx]);
-  elem_a = Canonicalize(elem_a);
-  elem_b = Canonicalize(elem_b);
-  if (isnan(elem_a) && isnan(elem_b)) return;
-
-  float rel_error = abs(elem_a - elem_b) / (max(abs(elem_a), abs(elem_b)) + 1);
-
-  if (rel_error > rel_error_threshold || isnan(rel_error))
-    atomicAdd(mismatch_count, 1);
+                                    uint64_t buffer_length, Summary* summary) {
+  CompareBuffers<__half, Fp16ToFloat>(buffer_a, buffer_b, rel_error_threshold,
+                                      buffer_length, summary);
 }
 
 __global__ void xla_fp32_comparison(float* buffer_a, float* buffer_b,
                                     float rel_error_threshold,
-                                    uint64_t buffer_length,
-                                    int* mismatch_count) {
-  int idx = threadIdx.x + blockIdx.x * blockDim.x;
-  if (idx >= buffer_length) return;
-  float elem_a = buffer_a[idx];
-  float elem_b = buffer_b[idx];
-  if (isnan(elem_a) && isnan(elem_b)) return;
-  if (isinf(elem_a) && isinf(elem_b) && signbit(elem_a) == signbit(elem_b))
-    return;
-
-  float rel_error = abs(elem_a - elem_b) / (max(abs(elem_a), abs(elem_b)) + 1);
-  if (rel_error > rel_error_threshold || isnan(rel_error))
-    atomicAdd(mismatch_count, 1);
+                                    uint64_t buffer_length, Summary* summary) {
+  CompareBuffers<float, Identity<float>>(buffer_a, buffer_b,
+                                         rel_error_threshold, buffer_length,
+                                         summary);
 }
 
 __global__ void xla_fp64_comparison(double* buffer_a, double* buffer_b,
                                     float rel_error_threshold,
-                                    uint64_t buffer_length,
-                                    int* mismatch_count) {
-  int idx = threadIdx.x + blockIdx.x * blockDim.x;
-  if (idx >= buffer_length) return;
-
-  double elem_a = buffer_a[idx];
-  double elem_b = buffer_b[idx];
-  if (isnan(elem_a) && isnan(elem_b)) return;
-  if (isinf(elem_a) && isinf(elem_b) && signbit(elem_a) == signbit(elem_b))
-    return;
-  double rel_error = abs(elem_a - elem_b) / (max(abs(elem_a), abs(elem_b)) + 1);
-  if (rel_error > rel_error_threshold || isnan(rel_error))
-    atomicAdd(mismatch_count, 1);
+                                    uint64_t buffer_length, Summary* summary) {
+  CompareBuffers<double, Identity<double>>(buffer_a, buffer_b,
+                                           rel_error_threshold, buffer_length,
+                                           summary);
 }
 
 __global__ void xla_bf16_comparison(bfloat16* buffer_a, bfloat16* buffer_b,
                                     float rel_error_threshold,
-                                    uint64_t buffer_length,
-                                    int* mismatch_count) {
-  int idx = threadIdx.x + blockIdx.x * blockDim.x;
-  if (idx >= buffer_length) return;
-  float elem_a = BF16_TO_F32(buffer_a[idx]);
-  float elem_b = BF16_TO_F32(buffer_b[idx]);
-  elem_a = Canonicalize(elem_a);
-  elem_b = Canonicalize(elem_b);
-  if (isnan(elem_a) && isnan(elem_b)) return;
-
-  float rel_error = abs(elem_a - elem_b) / (max(abs(elem_a), abs(elem_b)) + 1);
-
-  if (rel_error > rel_error_threshold || isnan(rel_error))
-    atomicAdd(mismatch_count, 1);
+                                    uint64_t buffer_length, Summary* summary) {
+  CompareBuffers<bfloat16, Bf16ToFloat>(buffer_a, buffer_b, rel_error_threshold,
+                                        buffer_length, summary);
 }
 
 // TODO(b/191520348): The comparison below requires exact equality.
 __global__ void xla_int8_comparison(int8_t* buffer_a, int8_t* buffer_b,
                                     float rel_error_threshold,
-                                    uint64_t buffer_length,
-                                    int* mismatch_count) {
-  int idx = threadIdx.x + blockIdx.x * blockDim.x;
-  if (idx >= buffer_length) return;
-  float a = buffer_a[idx];
-  float b = buffer_b[idx];
-  float rel_error = abs(a - b) / (max(abs(a), abs(b)) + 1);
-  if (rel_error > rel_error_threshold || isnan(rel_error))
-    atomicAdd(mismatch_count, 1);
+                                    uint64_t buffer_length, Summary* summary) {
+  CompareBuffers<int8_t, IntToFloat<int8_t>>(
+      buffer_a, buffer_b, rel_error_threshold, buffer_length, summary);
 }
 
 __global__ void xla_int32_comparison(int* buffer_a, int* buffer_b,
                                      float rel_error_threshold,
-                                     uint64_t buffer_length,
-                                     int* mismatch_count) {
-  int idx = threadIdx.x + blockIdx.x * blockDim.x;
-  if (idx >= buffer_length) return;
-  float elem_a = static_cast<float>(buffer_a[idx]);
-  float elem_b = static_cast<float>(buffer_b[idx]);
-  float rel_error = abs(elem_a - elem_b) / (max(abs(elem_a), abs(elem_b)) + 1);
-  if (rel_error > rel_error_threshold || isnan(rel_error))
-    atomicAdd(mismatch_count, 1);
+                                     uint64_t buffer_length, Summary* summary) {
+  CompareBuffers<int, IntToFloat<int>>(buffer_a, buffer_b, rel_error_threshold,
+                                       buffer_length, summary);
 }
 
 }  // namespace
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef XLA_SERVICE_GPU_BUFFER_COMPARATOR_H_
 #define XLA_SERVICE_GPU_BUFFER_COMPARATOR_H_
 
+#include <cstdint>
+
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xla/service/hlo_module_config.h"
 #include "xla/shape.h"
@@ -34,6 +37,13 @@ class BufferComparator {
   BufferComparator(const BufferComparator&) = delete;
   BufferComparator(BufferComparator&&) = default;
 
+  // Result of a comparison on the device.
+  struct ComparisonSummary {
+    uint64_t mismatch_count = 0;
+    // NaN relative errors are reported as infinity.
+    float max_relative_error = 0;
+  };
+
   explicit BufferComparator(const Shape& shape, double tolerance = 0.1,
                             bool verbose = true);
 
@@ -45,10 +55,20 @@ class BufferComparator {
   // * With NaNs and infs taken care of, a and b compare equal iff:
   //     abs(a - b) / (max(abs(a), abs(b)) + 1) < tolerance
   //
-  // See the implementation for the tolerance value.
+  // See the implementation for the tolerance value. The buffers are copied to
+  // the host for a detailed report of the differences only if `verbose`.
   absl::StatusOr<bool> CompareEqual(se::Stream* stream,
                                     se::DeviceMemoryBase current,
                                     se::DeviceMemoryBase expected) const;
+
+  // Enqueues the comparison of the two buffers on `stream` without waiting for
+  // it. The ComparisonSummary is written to `summary`, a device buffer of at
+  // least sizeof(ComparisonSummary) bytes. Comparisons of several candidates
+  // can be enqueued into the slots of one allocation and read back together.
+  absl::Status EnqueueCompare(se::Stream* stream, se::DeviceMemoryBase current,
+                              se::DeviceMemoryBase expected,
+                              se::DeviceMemoryBase summary) const;
+
  private:
   Shape shape_;
   double relative_tol_;  // relative tolerance for comparison
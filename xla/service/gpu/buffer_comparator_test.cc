@@ -399,6 +399,43 @@ TEST_F(BufferComparatorTest, BF16) {
                    .value());
 }
 
+TEST_F(BufferComparatorTest, EnqueuedComparisonsShareOneSummaryBuffer) {
+  using ComparisonSummary = BufferComparator::ComparisonSummary;
+  const std::vector<float> expected = {1, 2.1, 1, 4};
+  const std::vector<float> current = {1, 2, 10, 4};
+
+  auto stream = stream_exec_->CreateStream().value();
+  se::DeviceMemoryHandle expected_buffer(
+      stream_exec_, stream_exec_->AllocateArray<float>(expected.size()));
+  se::DeviceMemoryHandle current_buffer(
+      stream_exec_, stream_exec_->AllocateArray<float>(current.size()));
+  se::DeviceMemoryHandle summary_buffer(
+      stream_exec_, stream_exec_->Allocate(2 * sizeof(ComparisonSummary)));
+  TF_CHECK_OK(stream->Memcpy(expected_buffer.memory_ptr(), expected.data(),
+                             expected_buffer.memory().size()));
+  TF_CHECK_OK(stream->Memcpy(current_buffer.memory_ptr(), current.data(),
+                             current_buffer.memory().size()));
+
+  BufferComparator comparator(
+      ShapeUtil::MakeShape(F32, {static_cast<int64_t>(expected.size())}));
+  se::DeviceMemoryBase summaries = summary_buffer.memory();
+  TF_CHECK_OK(comparator.EnqueueCompare(
+      stream.get(), expected_buffer.memory(), expected_buffer.memory(),
+      summaries.GetByteSlice(0, sizeof(ComparisonSummary))));
+  TF_CHECK_OK(comparator.EnqueueCompare(
+      stream.get(), current_buffer.memory(), expected_buffer.memory(),
+      summaries.GetByteSlice(sizeof(ComparisonSummary),
+                             sizeof(ComparisonSummary))));
+
+  ComparisonSummary results[2];
+  TF_CHECK_OK(stream->Memcpy(results, summaries, sizeof(results)));
+  TF_CHECK_OK(stream->BlockHostUntilDone());
+  EXPECT_EQ(results[0].mismatch_count, 0);
+  EXPECT_EQ(results[0].max_relative_error, 0);
+  EXPECT_EQ(results[1].mismatch_count, 1);
+  EXPECT_NEAR(results[1].max_relative_error, 9.0 / 11.0, 1e-6);
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
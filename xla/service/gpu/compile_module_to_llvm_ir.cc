@@ -53,6 +53,7 @@ limitations under the License.
 #include "xla/service/gpu/gpu_memory_space_assignment.h"
 #include "xla/service/gpu/ir_emitter_context.h"
 #include "xla/service/gpu/ir_emitter_unnested.h"
+#include "xla/service/gpu/kernel_reuse_cache.h"
 #include "xla/service/gpu/metrics.h"
 #include "xla/service/hlo_dataflow_analysis.h"
 #include "xla/service/hlo_ordering.h"
@@ -117,6 +118,14 @@ absl::Status LoadCache(IrEmitterContext& ir_emitter_context,
     if (!proto.ParseFromString(serialized)) {
       return Internal("Failed to parse serialized CompilationCacheProto.");
     }
+    std::string target = GetKernelCacheTarget(
+        ir_emitter_context.gpu_device_info().gpu_compute_capability());
+    if (proto.target() != target) {
+      LOG(WARNING) << "Ignoring the kernel cache file " << resolved_path
+                   << " compiled for '" << proto.target()
+                   << "' when compiling for '" << target << "'.";
+      return absl::OkStatus();
+    }
     // Register all cached kernel names with the name uniquer to avoid
     // naming conflicts.
     for (const auto& [name, _] : proto.entries()) {
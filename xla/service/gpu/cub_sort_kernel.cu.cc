@@ -37,6 +37,16 @@ namespace {
   }
 #endif
 
+// Batched sorts with segments of at most this many items use
+// DeviceSegmentedSort, which sorts short segments with a (sub-)warp each,
+// instead of DeviceSegmentedRadixSort, which spends a whole thread block and
+// all radix passes on every segment and is only efficient for long segments.
+constexpr size_t kMaxShortSegmentSize = 4096;
+
+bool HasShortSegments(size_t num_items, size_t batch_size) {
+  return num_items / batch_size <= kMaxShortSegmentSize;
+}
+
 template <typename KeyT>
 const char* CubSortKeys(
     void* d_temp_storage, size_t& temp_bytes, const void* d_keys_in,
@@ -69,6 +79,22 @@ const char* CubSortKeys(
   int* start_offsets =
       d_temp_storage != nullptr ? static_cast<int*>(d_offsets) : nullptr;
   int* end_offsets = start_offsets != nullptr ? start_offsets + 1 : nullptr;
+  if (HasShortSegments(num_items, batch_size)) {
+    auto err =
+        descending
+            ? gpuprim::DeviceSegmentedSort::SortKeysDescending<KeyT>(
+                  d_temp_storage, temp_bytes,
+                  static_cast<const KeyT*>(d_keys_in),
+                  static_cast<KeyT*>(d_keys_out), num_items, batch_size,
+                  start_offsets, end_offsets, gpu_stream_handle)
+            : gpuprim::DeviceSegmentedSort::SortKeys<KeyT>(
+                  d_temp_storage, temp_bytes,
+                  static_cast<const KeyT*>(d_keys_in),
+                  static_cast<KeyT*>(d_keys_out), num_items, batch_size,
+                  start_offsets, end_offsets, gpu_stream_handle);
+    CHK_GPU_ERR(err)
+    return nullptr;
+  }
   auto err =
       descending
           ? gpuprim::DeviceSegmentedRadixSort::SortKeysDescending<KeyT>(
@@ -123,6 +149,28 @@ const char* CubSortPairs(
   int* start_offsets =
       d_temp_storage != nullptr ? static_cast<int*>(d_offsets) : nullptr;
   int* end_offsets = start_offsets != nullptr ? start_offsets + 1 : nullptr;
+  if (HasShortSegments(num_items, batch_size)) {
+    // Equal keys keep the order of their values, like with radix sort.
+    auto err =
+        descending
+            ? gpuprim::DeviceSegmentedSort::StableSortPairsDescending<KeyT,
+                                                                      ValT>(
+                  d_temp_storage, temp_bytes,
+                  static_cast<const KeyT*>(d_keys_in),
+                  static_cast<KeyT*>(d_keys_out),
+                  static_cast<const ValT*>(d_values_in),
+                  static_cast<ValT*>(d_values_out), num_items, batch_size,
+                  start_offsets, end_offsets, gpu_stream_handle)
+            : gpuprim::DeviceSegmentedSort::StableSortPairs<KeyT, ValT>(
+                  d_temp_storage, temp_bytes,
+                  static_cast<const KeyT*>(d_keys_in),
+                  static_cast<KeyT*>(d_keys_out),
+                  static_cast<const ValT*>(d_values_in),
+                  static_cast<ValT*>(d_values_out), num_items, batch_size,
+                  start_offsets, end_offsets, gpu_stream_handle);
+    CHK_GPU_ERR(err)
+    return nullptr;
+  }
   auto err =
       descending
           ? gpuprim::DeviceSegmentedRadixSort::SortPairsDescending<KeyT, ValT>(
@@ -256,5 +304,17 @@ XLA_CUB_DEFINE_SORT_PAIRS(u64_b32, uint64_t, uint32_t)
 XLA_CUB_DEFINE_SORT_PAIRS(u64_b64, uint64_t, uint64_t)
 #endif
 
+// Pairs with signed or floating point key, e.g. for sorting scores together
+// with their indices.
+#ifdef CUB_TYPE_F16_B32
+XLA_CUB_DEFINE_SORT_PAIRS(f16_b32, __half, uint32_t)
+#endif
+#ifdef CUB_TYPE_F32_B32
+XLA_CUB_DEFINE_SORT_PAIRS(f32_b32, float, uint32_t)
+#endif
+#ifdef CUB_TYPE_S32_B32
+XLA_CUB_DEFINE_SORT_PAIRS(s32_b32, int32_t, uint32_t)
+#endif
+
 }  // namespace gpu
 }  // namespace xla
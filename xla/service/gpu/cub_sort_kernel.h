@@ -66,6 +66,9 @@ XLA_CUB_DECLARE_SORT_PAIRS(u32_b64)
 XLA_CUB_DECLARE_SORT_PAIRS(u64_b16)
 XLA_CUB_DECLARE_SORT_PAIRS(u64_b32)
 XLA_CUB_DECLARE_SORT_PAIRS(u64_b64)
+XLA_CUB_DECLARE_SORT_PAIRS(f16_b32)
+XLA_CUB_DECLARE_SORT_PAIRS(f32_b32)
+XLA_CUB_DECLARE_SORT_PAIRS(s32_b32)
 
 }  // namespace gpu
 }  // namespace xla
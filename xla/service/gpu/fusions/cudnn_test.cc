@@ -17,6 +17,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -554,6 +555,52 @@ ENTRY e {
   EXPECT_TRUE(RunAndCompare(kHloText, ErrorSpec{/*aabs=*/0, /*arel=*/0}));
 }
 
+TEST_F(CuDnnFusionTest, CompiledGraphsAreReusedFromCacheDir) {
+  // The shapes are unique to this test, so the graph is not in the in-process
+  // cache yet.
+  constexpr absl::string_view kHlo = R"(
+fd0 {
+  p0 = f32[32,48] parameter(0)
+  p1 = f32[48,80] parameter(1)
+  ROOT d = f32[32,80] dot(p0, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+}
+
+ENTRY e {
+  p0 = f32[32,48] parameter(0)
+  p1 = f32[48,80] parameter(1)
+  ROOT d0 = f32[32,80] fusion(p0, p1), kind=kCustom, calls=fd0,
+    backend_config={"fusion_backend_config":{"kind":"__cudnn$fusion"}}
+})";
+  const std::string cache_dir =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "cudnn_graph_cache");
+
+  auto compile = [&](BinaryMap& graphs) -> absl::StatusOr<std::string> {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<VerifiedHloModule> module,
+                        ParseAndReturnVerifiedModule(kHlo));
+    module->mutable_config()
+        .mutable_debug_options()
+        .set_xla_gpu_cudnn_graph_cache_dir(cache_dir);
+    CuDnnFusionCompiler cudnn_compiler(*backend().default_stream_executor(),
+                                       graphs);
+    TF_RETURN_IF_ERROR(cudnn_compiler.Run(module.get()).status());
+    return module->ToString();
+  };
+
+  BinaryMap first_graphs;
+  TF_ASSERT_OK_AND_ASSIGN(std::string first_module, compile(first_graphs));
+  std::vector<std::string> entries;
+  TF_ASSERT_OK(tsl::Env::Default()->GetMatchingPaths(
+      tsl::io::JoinPath(cache_dir, "*", "*.cudnn_graph"), &entries));
+  EXPECT_EQ(entries.size(), 1);
+
+  // The second compilation picks the same plan and workspace without building
+  // the graph again.
+  BinaryMap second_graphs;
+  TF_ASSERT_OK_AND_ASSIGN(std::string second_module, compile(second_graphs));
+  EXPECT_EQ(first_module, second_module);
+  EXPECT_EQ(first_graphs, second_graphs);
+}
+
 class CuDnnFusionCommandBufferTest : public CuDnnFusionTest {
  public:
   DebugOptions GetDebugOptionsForTest() override {
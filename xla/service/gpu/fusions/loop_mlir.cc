@@ -35,6 +35,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/hlo/ir/hlo_module.h"
 #include "xla/service/gpu/fusions/ir/xla_gpu_ops.h"
 #include "xla/service/gpu/fusions/mlir/computation_partitioner.h"
 #include "xla/service/gpu/fusions/mlir/elemental_hlo_to_mlir.h"
@@ -61,6 +62,18 @@ const Shape& GetIndexShape(const Shape& shape) {
 
 }  // namespace
 
+MlirLoopFusion::MlirLoopFusion(const HloFusionAnalysis& analysis)
+    : analysis_(analysis), config_(ComputeLoopFusionConfig(analysis)) {
+  // The thread ID indexing iterates over chunks of the output until all
+  // elements are covered, so launching fewer blocks is always correct.
+  config_.persistent_grid_min_waves = analysis.fusion_root(0)
+                                          .instruction()
+                                          .GetModule()
+                                          ->config()
+                                          .debug_options()
+                                          .xla_gpu_persistent_grid_min_waves();
+}
+
 std::optional<IndexingMap> MlirLoopFusion::ComputeThreadIdToOutputIndexing(
     int64_t root_index, mlir::MLIRContext* ctx) const {
   auto launch_dims = launch_dimensions();
@@ -35,8 +35,7 @@ namespace gpu {
 // Generic loop fusion. Lowers to LLVM via MLIR.
 class MlirLoopFusion : public MlirFusionEmitterBase {
  public:
-  explicit MlirLoopFusion(const HloFusionAnalysis& analysis)
-      : analysis_(analysis), config_(ComputeLoopFusionConfig(analysis)) {}
+  explicit MlirLoopFusion(const HloFusionAnalysis& analysis);
   LaunchDimensions launch_dimensions() const override;
 
   std::optional<IndexingMap> ComputeThreadIdToOutputIndexing(
@@ -33,6 +33,7 @@ limitations under the License.
 #include "absl/types/span.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
@@ -146,6 +147,9 @@ struct MlirReductionFusion::EmitterState {
   }
 
   mlir::ValueRange FusionOutputs() {
+    if (persistent_outputs) {
+      return *persistent_outputs;
+    }
     return entry_function.getArguments().drop_front(
         fusion.fused_parameters().size());
   }
@@ -164,6 +168,8 @@ struct MlirReductionFusion::EmitterState {
   absl::flat_hash_map<const HloInstruction*, int> fusion_result_index_starts;
   absl::flat_hash_map<const HloInstruction*, int> root_indices;
   SmallVector<Value> thread_and_block_ids;
+  // The outputs carried by the loop over block IDs of a persistent grid.
+  std::optional<mlir::ValueRange> persistent_outputs;
 };
 
 PerThreadOutputs MlirReductionFusion::EmitterState::EmitPerThreadElements(
@@ -428,7 +434,9 @@ IndexingMap MlirReductionFusion::GetThreadIndexingMap(
 
 LaunchDimensions MlirReductionFusion::launch_dimensions() const {
   size_t blocks_y = groups_.grouped_roots.size();
-  return {se::BlockDim(/*x=*/Product(num_blocks_),
+  int64_t blocks_x = persistent_num_blocks_ > 0 ? persistent_num_blocks_
+                                                : Product(num_blocks_);
+  return {se::BlockDim(/*x=*/blocks_x,
                        /*y=*/static_cast<int64_t>(blocks_y), /*z=*/1),
           se::ThreadDim(/*x=*/Product(num_threads_),
                         /*y=*/1, /*z=*/1)};
@@ -466,20 +474,44 @@ absl::Status MlirReductionFusion::EmitEntryFunction(
   auto& b = state.builder;
   b.setInsertionPointToStart(entry_function.addEntryBlock());
   state.thread_and_block_ids = EmitThreadAndBlockIds(b);
-  if (reduction_heroes_.size() == 1) {
-    b.create<mlir::func::ReturnOp>(EmitReduction(0, state));
+  if (persistent_num_blocks_ == 0) {
+    b.create<mlir::func::ReturnOp>(EmitReductionGroups(state));
     return absl::OkStatus();
   }
+
+  // Persistent grid: every block loops over the block IDs it is responsible
+  // for. The block ID is uniform within a block, so all threads of a block run
+  // the same number of iterations.
+  auto& block_id = state.thread_and_block_ids[3];
+  auto loop = b.create<mlir::scf::ForOp>(
+      block_id, b.create<mlir::arith::ConstantIndexOp>(Product(num_blocks_)),
+      b.create<mlir::arith::ConstantIndexOp>(persistent_num_blocks_),
+      state.FusionOutputs());
+  b.create<mlir::func::ReturnOp>(loop.getResults());
+  b.setInsertionPointToStart(loop.getBody());
+  block_id = loop.getInductionVar();
+  state.persistent_outputs = loop.getRegionIterArgs();
+  b.create<mlir::scf::YieldOp>(EmitReductionGroups(state));
+  return absl::OkStatus();
+}
+
+SmallVector<Value> MlirReductionFusion::EmitReductionGroups(
+    EmitterState& state) const {
+  auto& b = state.builder;
+  if (reduction_heroes_.size() == 1) {
+    return EmitReduction(0, state);
+  }
   SmallVector<int64_t> cases(reduction_heroes_.size() - 1);
   absl::c_iota(cases, 1);  // `default` is region 0.
   auto switch_op = b.create<mlir::scf::IndexSwitchOp>(
-      entry_function.getResultTypes(), EmitBlockId(b, 1), cases, cases.size());
-  b.create<mlir::func::ReturnOp>(switch_op.getResults());
+      state.entry_function.getResultTypes(), state.thread_and_block_ids[4],
+      cases, cases.size());
+  mlir::OpBuilder::InsertionGuard guard(b);
   for (auto [id, region] : llvm::enumerate(switch_op->getRegions())) {
     b.setInsertionPointToStart(&region.emplaceBlock());
     b.create<mlir::scf::YieldOp>(EmitReduction(id, state));
   }
-  return absl::OkStatus();
+  return switch_op.getResults();
 }
 
 HloValueMap MlirReductionFusion::GetInits(int group_id,
@@ -924,6 +956,18 @@ MlirMultiRowReductionFusion::MlirMultiRowReductionFusion(
   num_threads_ = GetNumThreads(reduction_dimensions_, vector_size);
   num_blocks_ = {GetNumBlocks(reduction_dimensions_, num_threads_)};
   tile_sizes_per_thread_ = {shape[0], vector_size};
+
+  // Every block reduces its rows in registers, so blocks may process several
+  // block IDs one after the other.
+  int64_t num_blocks = GetPersistentGridNumBlocks(
+      num_blocks_.front(), Product(num_threads_), analysis.device_info(),
+      first_reduce_->GetModule()
+          ->config()
+          .debug_options()
+          .xla_gpu_persistent_grid_min_waves());
+  if (num_blocks < num_blocks_.front()) {
+    persistent_num_blocks_ = num_blocks;
+  }
 }
 
 std::unique_ptr<MlirReductionFusion> MlirMultiRowReductionFusion::TryCreate(
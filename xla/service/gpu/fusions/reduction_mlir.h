@@ -90,6 +90,9 @@ class MlirReductionFusion : public MlirFusionEmitterBase {
   virtual llvm::SmallVector<mlir::Value> EmitReduction(
       int group_id, EmitterState& state) const = 0;
 
+  // Emits the reductions of all groups for the block IDs in `state`.
+  llvm::SmallVector<mlir::Value> EmitReductionGroups(EmitterState& state) const;
+
   // Returns a reduction indexing map with the given results.
   IndexingMap GetIndexingMap(llvm::ArrayRef<mlir::AffineExpr> results,
                              absl::Span<int64_t const> symbol_sizes = {}) const;
@@ -141,6 +144,11 @@ class MlirReductionFusion : public MlirFusionEmitterBase {
 
   absl::InlinedVector<int64_t, 4> num_threads_;
   absl::InlinedVector<int64_t, 4> num_blocks_;
+  // If positive, the number of blocks actually launched in x. Each of them
+  // iterates over the block IDs `block_id + k * persistent_num_blocks_` below
+  // `Product(num_blocks_)`, which remain the domain of the indexing maps.
+  // Only for reductions that don't go through shared memory.
+  int64_t persistent_num_blocks_ = 0;
   int64_t vector_size_ = 1;
 
   ReductionDimensions reduction_dimensions_;
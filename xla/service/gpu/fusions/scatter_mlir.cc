@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "xla/service/gpu/fusions/scatter_mlir.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
 #include <utility>
@@ -22,6 +23,7 @@ limitations under the License.
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -48,6 +50,9 @@ limitations under the License.
 #include "xla/service/gpu/model/indexing_map.h"
 #include "xla/service/scatter_simplifier.h"
 #include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_description.h"
+#include "xla/util.h"
 #include "xla/xla_data.pb.h"
 
 namespace xla {
@@ -67,6 +72,46 @@ using mlir_converter::CallTargetProvider;
 using mlir_converter::PartitionedComputations;
 using mlir_converter::ProvideParameter;
 
+constexpr int kScatterOperandIndex = 0;
+constexpr int kScatterIndicesIndex = 1;
+constexpr int kScatterUpdateIndex = 2;
+
+// Bounds for the number of consecutive updates that are combined by one thread
+// if the scatter indices are sorted.
+constexpr int64_t kMinSortedUpdatesPerThread = 4;
+constexpr int64_t kMaxSortedUpdatesPerThread = 32;
+
+int64_t GetNumUpdatesPerThread(const HloScatterInstruction& scatter,
+                               const se::DeviceDescription& device_info) {
+  if (!scatter.indices_are_sorted() || scatter.unique_indices() ||
+      scatter.scatter_operand_count() != 1) {
+    return 1;
+  }
+  const Shape& update_shape = scatter.scatter_updates().front()->shape();
+  int64_t num_updates = update_shape.dimensions(0);
+  if (num_updates < 2) return 1;
+  // Combine as many updates per thread as possible while still occupying the
+  // whole device. Runs of equal indices serialize on the atomics anyway, so
+  // combine at least a few updates even for small scatters.
+  int64_t max_threads =
+      device_info.threads_per_core_limit() * device_info.core_count();
+  int64_t num_updates_per_thread = std::clamp(
+      ShapeUtil::ElementsIn(update_shape) / std::max<int64_t>(max_threads, 1),
+      kMinSortedUpdatesPerThread, kMaxSortedUpdatesPerThread);
+  return std::min(num_updates_per_thread, num_updates);
+}
+
+// Returns the shape that is iterated over if every thread handles
+// `num_updates_per_thread` consecutive updates: the update shape with the
+// number of updates replaced by the number of runs.
+Shape GetUpdateRunShape(const Shape& update_shape,
+                        int64_t num_updates_per_thread) {
+  Shape run_shape = update_shape;
+  run_shape.set_dimensions(
+      0, CeilOfRatio(update_shape.dimensions(0), num_updates_per_thread));
+  return run_shape;
+}
+
 }  // namespace
 
 MlirScatterFusion::MlirScatterFusion(const HloFusionAnalysis& analysis)
@@ -74,6 +119,8 @@ MlirScatterFusion::MlirScatterFusion(const HloFusionAnalysis& analysis)
   const auto& scatter = analysis_.fusion_hero(0).instruction();
   auto& scatter_update_shape = scatter.operands().back()->shape();
   config_ = ComputeLoopFusionConfig(analysis, scatter_update_shape);
+  num_updates_per_thread_ = GetNumUpdatesPerThread(
+      *Cast<HloScatterInstruction>(&scatter), analysis_.device_info());
 }
 
 bool MlirScatterFusion::IsSupported(const HloFusionAnalysis& analysis) {
@@ -116,8 +163,12 @@ std::optional<IndexingMap> MlirScatterFusion::ComputeThreadIdToInputIndexing(
 
   // TODO(jreiffers): There are scatters where vectorization makes sense, but we
   // cannot currently detect them. Add a heuristic.
-  IndexingMap scatter_update_map = GetDefaultThreadIdIndexingMap(
-      launch_dimensions(), /*unroll_factor=*/1, scatter_update_shape, ctx);
+  IndexingMap scatter_update_map =
+      num_updates_per_thread_ == 1
+          ? GetDefaultThreadIdIndexingMap(launch_dimensions(),
+                                          /*unroll_factor=*/1,
+                                          scatter_update_shape, ctx)
+          : ComputeThreadIdToUpdateRunIndexing(ctx);
 
   // For scatter indices we project indexing for scatter updates and take the
   // first result of the affine map only, because they coincide.
@@ -140,12 +191,42 @@ std::optional<IndexingMap> MlirScatterFusion::ComputeThreadIdToInputIndexing(
   return scatter_update_map;
 }
 
+IndexingMap MlirScatterFusion::ComputeThreadIdToUpdateRunIndexing(
+    mlir::MLIRContext* ctx) const {
+  const auto& scatter = analysis_.fusion_hero(0).instruction();
+  const Shape& scatter_update_shape = scatter.operands().back()->shape();
+  Shape run_shape =
+      GetUpdateRunShape(scatter_update_shape, num_updates_per_thread_);
+  IndexingMap thread_id_to_run_map = GetDefaultThreadIdIndexingMap(
+      launch_dimensions(), /*unroll_factor=*/1, run_shape, ctx);
+
+  // (run id, slice indices...)[s0] -> (run id * n + s0, slice indices...),
+  // where s0 is the position of the update within the run.
+  SmallVector<mlir::AffineExpr> results;
+  results.push_back(mlir::getAffineDimExpr(0, ctx) * num_updates_per_thread_ +
+                    mlir::getAffineSymbolExpr(0, ctx));
+  for (int64_t i = 1; i < run_shape.rank(); ++i) {
+    results.push_back(mlir::getAffineDimExpr(i, ctx));
+  }
+  IndexingMap run_to_update_map{
+      mlir::AffineMap::get(run_shape.rank(), /*symbolCount=*/1, results, ctx),
+      DimVarsFromTensorSizes(run_shape.dimensions()),
+      RangeVarsFromTensorSizes({num_updates_per_thread_}),
+      /*rt_vars=*/{}};
+  run_to_update_map.AddConstraint(
+      results.front(), Interval{0, scatter_update_shape.dimensions(0) - 1});
+  auto thread_id_to_update_map = thread_id_to_run_map * run_to_update_map;
+  thread_id_to_update_map.Simplify();
+  return thread_id_to_update_map;
+}
+
 LaunchDimensions MlirScatterFusion::launch_dimensions() const {
   const auto& scatter = analysis_.fusion_hero(0).instruction();
   // Compute thread id mapping based on the shape of update operand.
   auto& scatter_update_shape = scatter.operands().back()->shape();
-  return CalculateLaunchDimensions(scatter_update_shape,
-                                   analysis_.device_info());
+  return CalculateLaunchDimensions(
+      GetUpdateRunShape(scatter_update_shape, num_updates_per_thread_),
+      analysis_.device_info());
 }
 
 std::vector<mlir_converter::EpilogueSpecification>
@@ -164,7 +245,6 @@ mlir::Value EmitScatterComputation(
     const mlir_converter::PartitionedComputation& root_computation,
     const mlir_converter::CallTargetProvider& call_targets,
     mlir::func::FuncOp entry_function, mlir::ImplicitLocOpBuilder& b) {
-  constexpr int kScatterOperandIndex = 0;
   auto reducer =
       call_targets(scatter->called_computations()[0]->root_instruction());
   if (scatter->unique_indices()) {
@@ -186,20 +266,89 @@ mlir::Value EmitScatterComputation(
   return atomic_rmw->getResult(0);
 }
 
+// Loads the scatter indices of the update `update_id` and returns the offsets
+// of the update slice in the output. Sets `in_bounds` to whether the whole
+// update slice fits into the output.
+SmallVector<Value, 4> EmitUpdateOffsets(
+    const HloInstruction* scatter, Value update_id, Value& in_bounds,
+    const mlir_converter::PartitionedComputation& root_computation,
+    const mlir_converter::CallTargetProvider& call_targets,
+    mlir::func::FuncOp entry_function, mlir::ImplicitLocOpBuilder& b) {
+  const HloInstruction* scatter_operand =
+      scatter->operand(kScatterOperandIndex);
+  const HloInstruction* scatter_indices =
+      scatter->operand(kScatterIndicesIndex);
+  const HloInstruction* scatter_update = scatter->operand(kScatterUpdateIndex);
+
+  in_bounds = b.create<ma::ConstantIntOp>(1, b.getI1Type());
+
+  Value zero = b.create<ma::ConstantIndexOp>(0);
+  SmallVector<Value, 4> update_offsets(scatter->shape().rank(), zero);
+  for (int i = 0; i < scatter_indices->shape().dimensions(1); ++i) {
+    SmallVector<Value, 4> indices_tensor_indices = {
+        update_id, b.create<ma::ConstantIndexOp>(i)};
+    auto index = ProvideParameter(root_computation, scatter,
+                                  kScatterIndicesIndex, indices_tensor_indices,
+                                  call_targets, entry_function, b)[0];
+    if (primitive_util::IsUnsignedIntegralType(
+            scatter_indices->shape().element_type())) {
+      index = b.create<ma::IndexCastUIOp>(b.getIndexType(), index);
+    } else {
+      index = b.create<ma::IndexCastOp>(b.getIndexType(), index);
+    }
+    Value ub = b.create<ma::ConstantIndexOp>(
+        scatter_operand->shape().dimensions(i) -
+        scatter_update->shape().dimensions(i + 1));
+    // One bounds check is enough even for signed indices: `sge 0` is
+    // implied by `ule ub`, because `ub >= 0`.
+    in_bounds = b.create<ma::AndIOp>(
+        in_bounds, b.create<ma::CmpIOp>(ma::CmpIPredicate::ule, index, ub));
+    update_offsets[i] = index;
+  }
+  return update_offsets;
+}
+
+// Combines `value` with the output element at `update_offsets + slice_indices`
+// if the update slice is in bounds. Returns the updated output tensor.
+Value EmitPredicatedScatterComputation(
+    const HloInstruction* scatter, ValueRange update_offsets,
+    ValueRange slice_indices, Value in_bounds, Value value, Value output_tensor,
+    const mlir_converter::PartitionedComputation& root_computation,
+    const mlir_converter::CallTargetProvider& call_targets,
+    mlir::func::FuncOp entry_function, mlir::ImplicitLocOpBuilder& b) {
+  return b
+      .create<scf::IfOp>(
+          in_bounds,
+          [&](OpBuilder& then_builder, Location then_loc) -> void {
+            mlir::ImplicitLocOpBuilder implicit_then_builder(then_loc,
+                                                             then_builder);
+            SmallVector<Value, 4> output_indices;
+            for (int i = 0; i < update_offsets.size(); ++i) {
+              output_indices.push_back(implicit_then_builder.create<ma::AddIOp>(
+                  slice_indices[i], update_offsets[i]));
+            }
+            Value updated_output = EmitScatterComputation(
+                scatter, output_indices, value, output_tensor,
+                root_computation, call_targets, entry_function,
+                implicit_then_builder);
+            implicit_then_builder.create<scf::YieldOp>(updated_output);
+          },
+          [&](OpBuilder& else_b, Location else_loc) {
+            else_b.create<scf::YieldOp>(else_loc, output_tensor);
+          })
+      .getResult(0);
+}
+
 // The scatter has to be canonicalized with `scatter_simplifier` pass.
 absl::Status MlirScatterFusion::EmitEntryFunction(
     const PartitionedComputations& computations,
     const CallTargetProvider& call_targets, mlir::func::FuncOp entry_function,
     const HloFusionInstruction& fusion) const {
-  constexpr int kScatterOperandIndex = 0;
-  constexpr int kScatterIndicesIndex = 1;
-  constexpr int kScatterUpdateIndex = 2;
+  if (num_updates_per_thread_ > 1) {
+    return EmitSortedIndicesEntryFunction(computations, call_targets,
+                                          entry_function, fusion);
+  }
   const auto* scatter = &analysis_.fusion_hero(0).instruction();
-  const HloInstruction* scatter_operand =
-      scatter->operand(kScatterOperandIndex);
-  const HloInstruction* scatter_indices =
-      scatter->operand(kScatterIndicesIndex);
-  const HloInstruction* scatter_update = scatter->operand(kScatterUpdateIndex);
 
   mlir::MLIRContext* mlir_context = entry_function.getContext();
   auto thread_id_to_update_map =
@@ -231,31 +380,10 @@ absl::Status MlirScatterFusion::EmitEntryFunction(
 
   // Extract slice offsets from scatter_indices operand, compute if the
   // whole slice of scatter_update operand will fit into the output.
-  mlir::Value in_bounds = b.create<ma::ConstantIntOp>(1, b.getI1Type());
-
-  Value zero = b.create<ma::ConstantIndexOp>(0);
-  SmallVector<Value, 4> update_offsets(scatter->shape().rank(), zero);
-  for (int i = 0; i < scatter_indices->shape().dimensions(1); ++i) {
-    SmallVector<Value, 4> indices_tensor_indices = {
-        thread_id_to_index_id_value, b.create<ma::ConstantIndexOp>(i)};
-    auto index = ProvideParameter(root_computation, scatter,
-                                  kScatterIndicesIndex, indices_tensor_indices,
-                                  call_targets, entry_function, b)[0];
-    if (primitive_util::IsUnsignedIntegralType(
-            scatter->operand(kScatterIndicesIndex)->shape().element_type())) {
-      index = b.create<ma::IndexCastUIOp>(b.getIndexType(), index);
-    } else {
-      index = b.create<ma::IndexCastOp>(b.getIndexType(), index);
-    }
-    Value ub = b.create<ma::ConstantIndexOp>(
-        scatter_operand->shape().dimensions(i) -
-        scatter_update->shape().dimensions(i + 1));
-    // One bounds check is enough even for signed indices: `sge 0` is
-    // implied by `ule ub`, because `ub >= 0`.
-    in_bounds = b.create<ma::AndIOp>(
-        in_bounds, b.create<ma::CmpIOp>(ma::CmpIPredicate::ule, index, ub));
-    update_offsets[i] = index;
-  }
+  mlir::Value in_bounds;
+  SmallVector<Value, 4> update_offsets = EmitUpdateOffsets(
+      scatter, thread_id_to_index_id_value, in_bounds, root_computation,
+      call_targets, entry_function, b);
   Value predicated_update =
       b.create<scf::IfOp>(
            in_bounds,
@@ -296,5 +424,137 @@ absl::Status MlirScatterFusion::EmitEntryFunction(
   return absl::OkStatus();
 }
 
+// Every thread handles one element of the update slice for a run of
+// consecutive updates. The running value is kept in registers while the
+// scatter indices do not change and is written to the output when they do:
+//
+//   value, offsets = update[first], indices[first]
+//   for update_id in (first, last):
+//     if indices[update_id] == offsets:
+//       value = reducer(value, update[update_id])
+//     else:
+//       output[offsets] = reducer(output[offsets], value)  // atomic
+//       value, offsets = update[update_id], indices[update_id]
+//   output[offsets] = reducer(output[offsets], value)  // atomic
+absl::Status MlirScatterFusion::EmitSortedIndicesEntryFunction(
+    const PartitionedComputations& computations,
+    const CallTargetProvider& call_targets, mlir::func::FuncOp entry_function,
+    const HloFusionInstruction& fusion) const {
+  const auto* scatter = &analysis_.fusion_hero(0).instruction();
+  int64_t num_updates =
+      scatter->operand(kScatterUpdateIndex)->shape().dimensions(0);
+  auto reducer =
+      call_targets(scatter->called_computations()[0]->root_instruction());
+
+  mlir::MLIRContext* mlir_context = entry_function.getContext();
+  Shape run_shape =
+      GetUpdateRunShape(scatter->operand(kScatterUpdateIndex)->shape(),
+                        num_updates_per_thread_);
+  auto thread_id_to_run_map = GetDefaultThreadIdIndexingMap(
+      launch_dimensions(), /*unroll_factor=*/1, run_shape, mlir_context);
+  thread_id_to_run_map.Simplify();
+  thread_id_to_run_map.RemoveUnusedSymbols();
+
+  const auto& root_computation = computations.FindPartitionedComputation(
+      fusion.fused_instructions_computation());
+  mlir::ImplicitLocOpBuilder b(entry_function.getLoc(), entry_function);
+  b.setInsertionPointToStart(entry_function.addEntryBlock());
+
+  auto thread_and_block_ids = EmitThreadAndBlockIds(b);
+  SmallVector<Value> result_tensors{entry_function.getArguments().back()};
+
+  auto scatter_result = mlir_converter::EmitXlaLoopOp(
+      b, thread_and_block_ids, result_tensors, thread_id_to_run_map,
+      [&](ValueRange symbol_values, ValueRange map_results,
+          ValueRange output_tensors) -> SmallVector<Value> {
+        ValueRange slice_indices = map_results.drop_front();
+        auto load_update = [&](Value update_id,
+                               mlir::ImplicitLocOpBuilder& builder) {
+          SmallVector<Value, 4> update_indices{update_id};
+          update_indices.append(slice_indices.begin(), slice_indices.end());
+          return ProvideParameter(root_computation, scatter,
+                                  kScatterUpdateIndex, update_indices,
+                                  call_targets, entry_function, builder)[0];
+        };
+
+        Value first = b.create<ma::MulIOp>(
+            map_results.front(),
+            b.create<ma::ConstantIndexOp>(num_updates_per_thread_));
+        Value last = b.create<ma::MinUIOp>(
+            b.create<ma::AddIOp>(
+                first, b.create<ma::ConstantIndexOp>(num_updates_per_thread_)),
+            b.create<ma::ConstantIndexOp>(num_updates));
+        Value in_bounds;
+        SmallVector<Value, 4> offsets =
+            EmitUpdateOffsets(scatter, first, in_bounds, root_computation,
+                              call_targets, entry_function, b);
+
+        // Loop-carried values: output, running value, in_bounds, offsets...
+        SmallVector<Value> inits{output_tensors.front(),
+                                 load_update(first, b), in_bounds};
+        inits.append(offsets.begin(), offsets.end());
+        auto run_loop = b.create<scf::ForOp>(
+            b.create<ma::AddIOp>(first, b.create<ma::ConstantIndexOp>(1)),
+            last, b.create<ma::ConstantIndexOp>(1), inits,
+            [&](OpBuilder& loop_builder, Location loop_loc, Value update_id,
+                ValueRange carried) {
+              mlir::ImplicitLocOpBuilder nested_b(loop_loc, loop_builder);
+              Value output = carried[0];
+              Value value = carried[1];
+              Value run_in_bounds = carried[2];
+              ValueRange run_offsets = carried.drop_front(3);
+
+              Value update_in_bounds;
+              SmallVector<Value, 4> update_offsets = EmitUpdateOffsets(
+                  scatter, update_id, update_in_bounds, root_computation,
+                  call_targets, entry_function, nested_b);
+              Value update_elem = load_update(update_id, nested_b);
+
+              Value same_run = nested_b.create<ma::ConstantIntOp>(
+                  1, nested_b.getI1Type());
+              for (auto [run_offset, update_offset] :
+                   llvm::zip(run_offsets, update_offsets)) {
+                same_run = nested_b.create<ma::AndIOp>(
+                    same_run,
+                    nested_b.create<ma::CmpIOp>(ma::CmpIPredicate::eq,
+                                                run_offset, update_offset));
+              }
+              auto next = nested_b.create<scf::IfOp>(
+                  same_run,
+                  [&](OpBuilder& then_builder, Location then_loc) {
+                    mlir::ImplicitLocOpBuilder then_b(then_loc, then_builder);
+                    SmallVector<Value> results{
+                        output,
+                        mlir_converter::InlineBlock(then_b,
+                                                    reducer.getBody().front(),
+                                                    {value, update_elem})[0],
+                        run_in_bounds};
+                    results.append(run_offsets.begin(), run_offsets.end());
+                    then_b.create<scf::YieldOp>(results);
+                  },
+                  [&](OpBuilder& else_builder, Location else_loc) {
+                    mlir::ImplicitLocOpBuilder else_b(else_loc, else_builder);
+                    SmallVector<Value> results{
+                        EmitPredicatedScatterComputation(
+                            scatter, run_offsets, slice_indices,
+                            run_in_bounds, value, output, root_computation,
+                            call_targets, entry_function, else_b),
+                        update_elem, update_in_bounds};
+                    results.append(update_offsets.begin(),
+                                   update_offsets.end());
+                    else_b.create<scf::YieldOp>(results);
+                  });
+              nested_b.create<scf::YieldOp>(next.getResults());
+            });
+        ValueRange run_results = run_loop.getResults();
+        return {EmitPredicatedScatterComputation(
+            scatter, run_results.drop_front(3), slice_indices, run_results[2],
+            run_results[1], run_results[0], root_computation, call_targets,
+            entry_function, b)};
+      });
+  b.create<ReturnOp>(scatter_result);
+  return absl::OkStatus();
+}
+
 }  // namespace gpu
 }  // namespace xla
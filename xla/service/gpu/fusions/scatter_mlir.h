@@ -35,6 +35,12 @@ namespace xla {
 namespace gpu {
 
 // Generic loop fusion. Lowers to LLVM via MLIR.
+//
+// If the indices are sorted but not unique, every thread handles a run of
+// consecutive updates for one element of the update slice. Updates with equal
+// indices are combined in registers, and only one atomic update is emitted per
+// run of equal indices. This avoids serializing on hot indices, e.g. in
+// embedding gradients with skewed token distributions.
 class MlirScatterFusion : public MlirFusionEmitterBase {
  public:
   explicit MlirScatterFusion(const HloFusionAnalysis& analysis);
@@ -62,8 +68,22 @@ class MlirScatterFusion : public MlirFusionEmitterBase {
       mlir::MLIRContext* mlir_context) const override;
 
  private:
+  // Emits the entry function for scatters with `num_updates_per_thread_ > 1`.
+  absl::Status EmitSortedIndicesEntryFunction(
+      const mlir_converter::PartitionedComputations& computations,
+      const mlir_converter::CallTargetProvider& call_targets,
+      mlir::func::FuncOp entry_function,
+      const HloFusionInstruction& fusion) const;
+
+  // Returns the mapping from a thread to the run of updates it handles:
+  // (run id, indices in the update slice...).
+  IndexingMap ComputeThreadIdToUpdateRunIndexing(mlir::MLIRContext* ctx) const;
+
   const HloFusionAnalysis& analysis_;
   LaunchDimensionsConfig config_;
+  // The number of consecutive updates that are combined by one thread. This is
+  // 1 unless the indices are sorted.
+  int64_t num_updates_per_thread_;
 };
 
 }  // namespace gpu
@@ -39,6 +39,8 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_instructions.h"
 #include "xla/service/gpu/fusions/fusion_emitter.h"
 #include "xla/service/gpu/fusions/triton/triton_fusion_emitter.h"
+#include "xla/service/gpu/fusions/triton/triton_fusion_emitter_attention.h"
+#include "xla/service/gpu/fusions/triton/triton_fusion_emitter_grouped_gemm.h"
 #include "xla/service/gpu/fusions/triton/triton_fusion_emitter_legacy_matmul.h"
 #include "xla/service/gpu/hlo_traversal.h"
 #include "xla/service/gpu/ir_emission_utils.h"
@@ -49,7 +51,11 @@ limitations under the License.
 #include "xla/service/gpu/matmul_utils.h"
 #include "xla/service/gpu/model/tiled_hlo_computation.h"
 #include "xla/service/gpu/runtime/kernel_thunk.h"
+#include "xla/service/gpu/runtime/memset_thunk.h"
+#include "xla/service/gpu/runtime/thunk.h"
+#include "xla/service/gpu/triton_attention_analysis.h"
 #include "xla/service/gpu/triton_fusion_analysis.h"
+#include "xla/service/gpu/triton_grouped_gemm_analysis.h"
 #include "xla/service/llvm_ir/ir_array.h"
 #include "xla/service/llvm_ir/llvm_util.h"
 #include "xla/shape.h"
@@ -82,6 +88,20 @@ TritonFusion::GenerateTritonKernelAndWrapper(
                         TritonWrapper(impl_fn_name, &fusion, cc, device_info,
                                       launch_config->block_level_parameters,
                                       llvm_module, *mlir_context));
+  } else if (fusion_kind == kTritonAttentionFusionKind ||
+             fusion_kind == kTritonGroupedGemmFusionKind) {
+    TF_ASSIGN_OR_RETURN(TritonGemmConfig config,
+                        fusion_kind == kTritonAttentionFusionKind
+                            ? GetTritonAttentionConfig(fusion)
+                            : GetTritonGroupedGemmConfig(fusion));
+    BlockLevelParameters block_level_parameters;
+    block_level_parameters.num_ctas = config.num_ctas;
+    block_level_parameters.num_stages = config.num_stages;
+    block_level_parameters.num_warps = config.num_warps;
+    TF_ASSIGN_OR_RETURN(
+        triton_wrapper_result,
+        TritonWrapper(impl_fn_name, &fusion, cc, device_info,
+                      block_level_parameters, llvm_module, *mlir_context));
   } else {  // Must be a MatMul
     CHECK_EQ(fusion_kind, kTritonGemmFusionKind);
     // TODO(bchetioui): port matmul emitter to fully use the new
@@ -145,6 +165,18 @@ absl::StatusOr<FusionEmissionResult> TritonFusion::Emit(
       // This check should be enforced by `GenerateTritonKernelWrapper`.
       CHECK(launch_config.has_value());
       launch_dimensions = std::move(launch_config->launch_dimensions);
+    } else if (fusion_kind == kTritonAttentionFusionKind) {
+      TF_ASSIGN_OR_RETURN(TritonGemmConfig config,
+                          GetTritonAttentionConfig(fusion));
+      TF_ASSIGN_OR_RETURN(
+          launch_dimensions,
+          GetAttentionLaunchDimensions(*hlo_computation, config));
+    } else if (fusion_kind == kTritonGroupedGemmFusionKind) {
+      TF_ASSIGN_OR_RETURN(TritonGemmConfig config,
+                          GetTritonGroupedGemmConfig(fusion));
+      TF_ASSIGN_OR_RETURN(
+          launch_dimensions,
+          GetGroupedGemmLaunchDimensions(*hlo_computation, config));
     } else {  // Must be a MatMul
       CHECK_EQ(fusion_kind, kTritonGemmFusionKind);
       // TODO(bchetioui): port matmul emitter to fully use the new
@@ -170,8 +202,11 @@ absl::StatusOr<FusionEmissionResult> TritonFusion::Emit(
           TritonGemmConfig config,
           TritonGemmConfig::FromProto(backend_config.triton_gemm_config()));
 
-      TF_ASSIGN_OR_RETURN(auto analysis, TritonFusionAnalysis::Execute(
-                                             *hlo_computation, config.split_k));
+      TF_ASSIGN_OR_RETURN(
+          auto analysis,
+          TritonFusionAnalysis::Execute(
+              *hlo_computation,
+              config.NeedsSplitKRewrite() ? config.split_k : 1));
 
       TF_ASSIGN_OR_RETURN(
           launch_dimensions,
@@ -211,6 +246,18 @@ absl::StatusOr<FusionEmissionResult> TritonFusion::Emit(
   TF_ASSIGN_OR_RETURN(const KernelReuseCache::Entry* entry, status_or_entry);
 
   FusionEmissionResult result;
+  // Kernels with atomic split-K add their partial results to the output.
+  if (analysis_.fusion_backend_config().triton_gemm_config().atomic_split_k()) {
+    for (const KernelArgument& arg : kernel_arguments.args()) {
+      if (!arg.written()) {
+        continue;
+      }
+      // Zeroing the output must not overwrite any of the inputs.
+      TF_RET_CHECK(!arg.aliased() && !arg.first_with_same_slice().has_value());
+      result.thunks.emplace_back(std::make_unique<MemzeroThunk>(
+          Thunk::ThunkInfo::WithProfileAnnotation(&fusion), arg.slice()));
+    }
+  }
   result.thunks.emplace_back(std::make_unique<KernelThunk>(
       &fusion, entry->kernel_name, kernel_arguments.args(),
       entry->launch_dimensions, entry->cluster_dim, entry->shmem_bytes));
@@ -0,0 +1,204 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/fusions/triton/tile_emitter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Types.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/service/gpu/fusions/triton/emitter_helpers.h"
+#include "xla/shape.h"
+#include "xla/status_macros.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/tensor_float_32_utils.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+
+namespace xla::gpu::triton {
+
+namespace ma = ::mlir::arith;
+namespace mt = ::mlir::triton;
+
+using ::llvm::SmallVector;
+using ::mlir::ArrayRef;
+using ::mlir::ImplicitLocOpBuilder;
+using ::mlir::Type;
+using ::mlir::Value;
+
+int64_t DotTileSize(int64_t dim) {
+  return std::max<int64_t>(kMinDotTileSize, llvm::PowerOf2Ceil(dim));
+}
+
+Value Splat(ImplicitLocOpBuilder& b, Value value, ArrayRef<int64_t> shape) {
+  auto type = mlir::RankedTensorType::get(shape, value.getType());
+  return b.create<mt::SplatOp>(type, value);
+}
+
+Value Range(ImplicitLocOpBuilder& b, int32_t limit) {
+  auto type = mlir::RankedTensorType::get(limit, b.getI32Type());
+  return b.create<mt::MakeRangeOp>(type, 0, limit);
+}
+
+Value AddPtr(ImplicitLocOpBuilder& b, Value ptr, Value offset) {
+  return b.create<mt::AddPtrOp>(ptr.getType(), ptr, offset);
+}
+
+Value ExpandAndBroadcast(ImplicitLocOpBuilder& b, Value vector, int axis,
+                         ArrayRef<int64_t> shape) {
+  auto type = mlir::cast<mlir::RankedTensorType>(vector.getType());
+  return b.create<mt::BroadcastOp>(
+      type.clone(shape), b.create<mt::ExpandDimsOp>(vector, axis));
+}
+
+SmallVector<Value> DelinearizeIndex(ImplicitLocOpBuilder& b, Value index,
+                                    absl::Span<const int64_t> sizes) {
+  SmallVector<Value> indices(sizes.size());
+  for (int64_t i = sizes.size() - 1; i >= 0; --i) {
+    Value size = CreateConst(b, index.getType(), sizes[i]).UnwrapScalar();
+    indices[i] = b.create<ma::RemSIOp>(index, size);
+    index = b.create<ma::DivSIOp>(index, size);
+  }
+  return indices;
+}
+
+SmallVector<int64_t> ElementStrides(const Shape& shape) {
+  SmallVector<int64_t> strides(shape.rank());
+  int64_t stride = 1;
+  for (int64_t dim : shape.layout().minor_to_major()) {
+    strides[dim] = stride;
+    stride *= shape.dimensions(dim);
+  }
+  return strides;
+}
+
+absl::StatusOr<Access> GetAccess(const HloInstruction& hlo,
+                                 absl::Span<const int64_t> dims) {
+  const HloInstruction* parameter = &hlo;
+  SmallVector<int64_t> parameter_dims(dims.begin(), dims.end());
+  if (hlo.opcode() == HloOpcode::kBroadcast) {
+    parameter = hlo.operand(0);
+    for (int64_t& dim : parameter_dims) {
+      auto it = absl::c_find(hlo.dimensions(), dim);
+      dim = it == hlo.dimensions().end() ? -1 : it - hlo.dimensions().begin();
+    }
+  }
+  TF_RET_CHECK(parameter->opcode() == HloOpcode::kParameter) << hlo.ToString();
+  SmallVector<int64_t> parameter_strides = ElementStrides(parameter->shape());
+  Access access{parameter, {}};
+  for (int64_t dim : parameter_dims) {
+    access.strides.push_back(dim < 0 ? 0 : parameter_strides[dim]);
+  }
+  return access;
+}
+
+mt::InputPrecision GetDotPrecision(const HloDotInstruction& dot) {
+  const bool tf32_allowed =
+      tsl::tensor_float_32_execution_enabled() &&
+      absl::c_all_of(dot.precision_config().operand_precision(),
+                     [](const int precision) {
+                       return precision == PrecisionConfig::DEFAULT;
+                     });
+  return tf32_allowed ? mt::InputPrecision::TF32 : mt::InputPrecision::IEEE;
+}
+
+std::pair<Value, Value> TileEmitter::EmitPointers(
+    Value base, const Access& access, Value rows, int64_t row_dim,
+    int64_t num_rows, Value cols, int64_t col_dim, int64_t num_cols) {
+  SmallVector<int64_t> shape = {
+      mlir::cast<mlir::RankedTensorType>(rows.getType()).getShape()[0],
+      mlir::cast<mlir::RankedTensorType>(cols.getType()).getShape()[0]};
+  Value row_indices = ExpandAndBroadcast(b_, rows, /*axis=*/1, shape);
+  Value col_indices = ExpandAndBroadcast(b_, cols, /*axis=*/0, shape);
+  auto in_bounds = [&](Value indices, int64_t limit) -> Value {
+    return b_.create<ma::CmpIOp>(
+        ma::CmpIPredicate::slt, indices,
+        CreateConst(b_, b_.getI32Type(), limit, shape).UnwrapTensor());
+  };
+  Value mask = b_.create<ma::AndIOp>(in_bounds(row_indices, num_rows),
+                                     in_bounds(col_indices, num_cols));
+  auto dim_offsets = [&](Value indices, int64_t stride) -> Value {
+    if (!index_ty_.isInteger(32)) {
+      indices = b_.create<ma::ExtSIOp>(
+          mlir::RankedTensorType::get(shape, index_ty_), indices);
+    }
+    return b_.create<ma::MulIOp>(
+        indices, CreateConst(b_, index_ty_, stride, shape).UnwrapTensor());
+  };
+  Value offsets = b_.create<ma::AddIOp>(
+      dim_offsets(row_indices, access.strides[row_dim]),
+      dim_offsets(col_indices, access.strides[col_dim]));
+  Value tile_base = AddPtr(b_, base, EmitBatchOffset(access));
+  return {AddPtr(b_, Splat(b_, tile_base, shape), offsets), mask};
+}
+
+Value TileEmitter::EmitLoad(std::pair<Value, Value> pointers_and_mask,
+                            Type type) {
+  auto [pointers, mask] = pointers_and_mask;
+  ArrayRef<int64_t> shape =
+      mlir::cast<mlir::RankedTensorType>(mask.getType()).getShape();
+  Type storage_ty = StorageType(b_, type);
+  Value other = CreateConst(b_, storage_ty, 0, shape).UnwrapTensor();
+  Value tile = b_.create<mt::LoadOp>(pointers, mask, other,
+                                     mt::CacheModifier::NONE,
+                                     mt::EvictionPolicy::NORMAL,
+                                     /*isVolatile=*/false);
+  if (storage_ty != type) {
+    // For example cast i8 to i1.
+    tile = Cast(b_, tile, type);
+  }
+  return tile;
+}
+
+void TileEmitter::EmitStore(std::pair<Value, Value> pointers_and_mask,
+                            Value tile, Type type) {
+  auto [pointers, mask] = pointers_and_mask;
+  tile = Cast(b_, tile, type);
+  if (Type storage_ty = StorageType(b_, type); storage_ty != type) {
+    tile = Cast(b_, tile, storage_ty);
+  }
+  b_.create<mt::StoreOp>(pointers, tile, mask, mt::CacheModifier::NONE,
+                         mt::EvictionPolicy::NORMAL);
+}
+
+Value TileEmitter::EmitBatchOffset(const Access& access) {
+  Value offset = CreateConst(b_, index_ty_, 0).UnwrapScalar();
+  for (int64_t i = 0; i < batch_indices_.size(); ++i) {
+    if (access.strides[i] == 0) {
+      continue;
+    }
+    offset = b_.create<ma::AddIOp>(
+        offset,
+        b_.create<ma::MulIOp>(
+            batch_indices_[i],
+            CreateConst(b_, index_ty_, access.strides[i]).UnwrapScalar()));
+  }
+  return offset;
+}
+
+}  // namespace xla::gpu::triton
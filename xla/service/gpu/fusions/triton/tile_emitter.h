@@ -0,0 +1,127 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_FUSIONS_TRITON_TILE_EMITTER_H_
+#define XLA_SERVICE_GPU_FUSIONS_TRITON_TILE_EMITTER_H_
+
+#include <cstdint>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Types.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/shape.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+
+// Helpers for the hand-written Triton kernels (attention, grouped GEMMs) that
+// address their inputs and outputs with explicit strides instead of going
+// through the tiling of the generic emitter.
+namespace xla::gpu::triton {
+
+// Minimal size of a dimension of the operands of tt.dot.
+inline constexpr int64_t kMinDotTileSize = 16;
+
+// Smallest power of two that is not smaller than `dim` and kMinDotTileSize.
+int64_t DotTileSize(int64_t dim);
+
+mlir::Value Splat(mlir::ImplicitLocOpBuilder& b, mlir::Value value,
+                  mlir::ArrayRef<int64_t> shape);
+
+// I32 tensor [0, limit).
+mlir::Value Range(mlir::ImplicitLocOpBuilder& b, int32_t limit);
+
+mlir::Value AddPtr(mlir::ImplicitLocOpBuilder& b, mlir::Value ptr,
+                   mlir::Value offset);
+
+// [rows] -> [rows, cols] if `axis` is 1 or [cols] -> [rows, cols] if it is 0.
+mlir::Value ExpandAndBroadcast(mlir::ImplicitLocOpBuilder& b,
+                               mlir::Value vector, int axis,
+                               mlir::ArrayRef<int64_t> shape);
+
+// Splits `index` into indices of dimensions of the given `sizes`, the last
+// one being the minor one. All values have the type of `index`.
+llvm::SmallVector<mlir::Value> DelinearizeIndex(
+    mlir::ImplicitLocOpBuilder& b, mlir::Value index,
+    absl::Span<const int64_t> sizes);
+
+// Strides in elements of the dimensions of `shape`.
+llvm::SmallVector<int64_t> ElementStrides(const Shape& shape);
+
+// How a fusion parameter or output is accessed along logical dimensions, e.g.
+// the dimensions [batch..., m, k] of the left-hand side of a dot.
+struct Access {
+  // The parameter holding the data, or the root for the output.
+  const HloInstruction* hlo;
+  // Stride of every logical dimension, or 0 if it is broadcasted.
+  llvm::SmallVector<int64_t> strides;
+};
+
+// `hlo` is a parameter or a broadcast of one, and `dims[i]` is the dimension
+// of `hlo` corresponding to the i-th logical dimension.
+absl::StatusOr<Access> GetAccess(const HloInstruction& hlo,
+                                 absl::Span<const int64_t> dims);
+
+// TF32 if it is enabled and allowed by the precision config of `dot`.
+mlir::triton::InputPrecision GetDotPrecision(const HloDotInstruction& dot);
+
+// Emits code reading and writing 2D tiles of parameters and outputs, whose
+// logical dimensions are batch dimensions followed by two tiled dimensions.
+class TileEmitter {
+ public:
+  // `batch_indices` are the indices of the batch dimensions processed by the
+  // program, of type `index_ty`.
+  TileEmitter(mlir::ImplicitLocOpBuilder& b, mlir::Type index_ty,
+              llvm::SmallVector<mlir::Value> batch_indices)
+      : b_(b),
+        index_ty_(index_ty),
+        batch_indices_(std::move(batch_indices)) {}
+
+  // Returns the pointers to the elements of a [rows, cols] tile of `base` and
+  // the mask of the elements within bounds. `rows` and `cols` are I32 indices
+  // along the logical dimensions `row_dim` and `col_dim` of `access`; the
+  // other logical dimensions are batch dimensions.
+  std::pair<mlir::Value, mlir::Value> EmitPointers(
+      mlir::Value base, const Access& access, mlir::Value rows,
+      int64_t row_dim, int64_t num_rows, mlir::Value cols, int64_t col_dim,
+      int64_t num_cols);
+
+  // Loads a tile of `type` for the given pointers, zeroing elements out of
+  // bounds.
+  mlir::Value EmitLoad(std::pair<mlir::Value, mlir::Value> pointers_and_mask,
+                       mlir::Type type);
+
+  // Stores the elements of `tile` within bounds, cast to `type`.
+  void EmitStore(std::pair<mlir::Value, mlir::Value> pointers_and_mask,
+                 mlir::Value tile, mlir::Type type);
+
+  mlir::Value batch_index(int64_t dim) const { return batch_indices_[dim]; }
+
+ private:
+  mlir::Value EmitBatchOffset(const Access& access);
+
+  mlir::ImplicitLocOpBuilder& b_;
+  mlir::Type index_ty_;
+  llvm::SmallVector<mlir::Value> batch_indices_;
+};
+
+}  // namespace xla::gpu::triton
+
+#endif  // XLA_SERVICE_GPU_FUSIONS_TRITON_TILE_EMITTER_H_
@@ -97,6 +97,8 @@ limitations under the License.
 #include "xla/service/gpu/fusions/transforms/passes.h"
 #include "xla/service/gpu/fusions/triton/emitter_helpers.h"
 #include "xla/service/gpu/fusions/triton/passes.h"
+#include "xla/service/gpu/fusions/triton/triton_fusion_emitter_attention.h"
+#include "xla/service/gpu/fusions/triton/triton_fusion_emitter_grouped_gemm.h"
 #include "xla/service/gpu/fusions/triton/triton_fusion_emitter_legacy_matmul.h"
 #include "xla/service/gpu/fusions/triton/triton_support.h"
 #include "xla/service/gpu/ir_emission_utils.h"
@@ -1087,6 +1089,12 @@ absl::StatusOr<mlir::OwningOpRef<mlir::ModuleOp>> CreateTritonModule(
   if (fusion_kind == kTritonGemmFusionKind) {
     TF_RETURN_IF_ERROR(EmitMatMul(b, libdevice_path, device_info, fusion, fn,
                                   block_level_parameters));
+  } else if (fusion_kind == kTritonAttentionFusionKind) {
+    TF_RETURN_IF_ERROR(EmitAttention(b, libdevice_path, device_info, fusion,
+                                     fn, block_level_parameters));
+  } else if (fusion_kind == kTritonGroupedGemmFusionKind) {
+    TF_RETURN_IF_ERROR(EmitGroupedGemm(b, libdevice_path, device_info, fusion,
+                                       fn, block_level_parameters));
   } else if (fusion_kind == kTritonFusionKind) {
     TF_RETURN_IF_ERROR(EmitGeneric(b, libdevice_path, device_info, fusion, fn,
                                    block_level_parameters));
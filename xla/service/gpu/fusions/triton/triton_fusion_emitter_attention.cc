@@ -0,0 +1,439 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/fusions/triton/triton_fusion_emitter_attention.h"
+
+#include <climits>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/ValueRange.h"
+#include "mlir/Support/LLVM.h"
+#include "xla/hlo/ir/hlo_casting_utils.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/hlo/utils/hlo_query.h"
+#include "xla/service/gpu/fusions/triton/emitter_helpers.h"
+#include "xla/service/gpu/fusions/triton/tile_emitter.h"
+#include "xla/service/gpu/ir_emission_utils.h"
+#include "xla/service/gpu/launch_dimensions.h"
+#include "xla/service/gpu/matmul_utils.h"
+#include "xla/service/gpu/triton_attention_analysis.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/status_macros.h"
+#include "xla/stream_executor/device_description.h"
+#include "xla/stream_executor/launch_dim.h"
+#include "xla/util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/IR/Types.h"
+
+namespace xla::gpu {
+
+namespace ma = ::mlir::arith;
+namespace mm = ::mlir::math;
+namespace mt = ::mlir::triton;
+
+using ::llvm::SmallVector;
+using ::mlir::ArrayRef;
+using ::mlir::ImplicitLocOpBuilder;
+using ::mlir::Type;
+using ::mlir::Value;
+using ::mlir::ValueRange;
+
+using ::xla::gpu::triton::Access;
+using ::xla::gpu::triton::Cast;
+using ::xla::gpu::triton::CreateConst;
+using ::xla::gpu::triton::DelinearizeIndex;
+using ::xla::gpu::triton::DotTileSize;
+using ::xla::gpu::triton::ElementStrides;
+using ::xla::gpu::triton::EmitConstant;
+using ::xla::gpu::triton::EmitElementwise;
+using ::xla::gpu::triton::ExpandAndBroadcast;
+using ::xla::gpu::triton::GetAccess;
+using ::xla::gpu::triton::GetDotPrecision;
+using ::xla::gpu::triton::kMinDotTileSize;
+using ::xla::gpu::triton::Range;
+using ::xla::gpu::triton::ScalarOrTensor;
+using ::xla::gpu::triton::Splat;
+using ::xla::gpu::triton::TileEmitter;
+using ::xla::gpu::triton::TritonType;
+
+namespace {
+
+int64_t NonContractingDim(const Shape& shape,
+                          absl::Span<const int64_t> batch_dims,
+                          int64_t contracting_dim) {
+  for (int64_t dim = 0; dim < shape.rank(); ++dim) {
+    if (dim != contracting_dim && !absl::c_linear_search(batch_dims, dim)) {
+      return dim;
+    }
+  }
+  LOG(FATAL) << "No non-contracting dimension in " << shape.ToString();
+}
+
+// Reduces a [rows, cols] F32 tile to [rows].
+Value EmitRowReduction(ImplicitLocOpBuilder& b, Value input, bool maximum) {
+  mt::ReduceOp reduction = b.create<mt::ReduceOp>(input, /*axis=*/1);
+  {
+    Type type = b.getF32Type();
+    mlir::Location loc = b.getLoc();
+    mlir::Block* reducer = b.createBlock(&reduction->getRegion(0), {},
+                                         {type, type}, {loc, loc});
+    b.setInsertionPointToStart(reducer);
+    Value result =
+        maximum ? b.create<ma::MaximumFOp>(reducer->getArgument(0),
+                                           reducer->getArgument(1))
+                      .getResult()
+                : b.create<ma::AddFOp>(reducer->getArgument(0),
+                                       reducer->getArgument(1))
+                      .getResult();
+    b.create<mt::ReduceReturnOp>(SmallVector<Value>({result}));
+    b.setInsertionPointAfter(reduction);
+  }
+  return reduction.getResult().front();
+}
+
+// Emits `hlo` of the scores graph. Arithmetic on 16-bit floats is done in F32
+// and rounded, like the other Triton emitters do after FloatNormalization.
+absl::StatusOr<Value> EmitScoreElementwise(
+    ImplicitLocOpBuilder& b, absl::string_view libdevice_path,
+    const se::DeviceDescription& device_info, const HloInstruction& hlo,
+    SmallVector<Value> operands) {
+  if (hlo.opcode() == HloOpcode::kConvert) {
+    return EmitElementwise(b, libdevice_path, device_info, hlo, operands);
+  }
+  for (Value& operand : operands) {
+    Type element_ty = mlir::getElementTypeOrSelf(operand);
+    if (element_ty.isBF16() || element_ty.isF16()) {
+      operand = Cast(b, operand, b.getF32Type());
+    }
+  }
+  TF_ASSIGN_OR_RETURN(
+      Value result,
+      EmitElementwise(b, libdevice_path, device_info, hlo, operands));
+  TF_ASSIGN_OR_RETURN(Type result_ty,
+                      TritonType(b, hlo.shape().element_type()));
+  return Cast(b, result, result_ty);
+}
+
+absl::Status ValidateAttentionConfig(const TritonGemmConfig& config) {
+  for (int block : {config.block_m, config.block_n}) {
+    if (block < kMinDotTileSize || !llvm::isPowerOf2_32(block)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported attention tiling: ", config.ToString()));
+    }
+  }
+  if (config.split_k != 1 || config.atomic_split_k) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Split-K is not supported by attention fusions: ",
+                     config.ToString()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<LaunchDimensions> GetAttentionLaunchDimensions(
+    const HloComputation& computation, const TritonGemmConfig& config) {
+  TF_ASSIGN_OR_RETURN(
+      auto analysis,
+      TritonAttentionAnalysis::Execute(*computation.root_instruction()));
+  TF_RETURN_IF_ERROR(ValidateAttentionConfig(config));
+  // All programs are laid out along X, which is the only 32-bit grid
+  // dimension.
+  const int64_t num_programs =
+      CeilOfRatio<int64_t>(analysis.num_queries(), config.block_m) *
+      analysis.batch_size();
+  TF_RET_CHECK(num_programs <= std::numeric_limits<int32_t>::max());
+  return LaunchDimensions(se::BlockDim(num_programs, 1, 1),
+                          se::ThreadDim(config.num_warps * WarpSize(), 1, 1));
+}
+
+// Variable naming: scores [m, n] = q [m, d] x k [n, d]^T,
+// out [m, dv] = softmax(f(scores)) [m, n] x v [n, dv] for every batch element.
+absl::Status EmitAttention(mlir::OpBuilder builder,
+                           absl::string_view libdevice_path,
+                           const se::DeviceDescription& device_info,
+                           const HloFusionInstruction* fusion,
+                           mlir::triton::FuncOp fn,
+                           const BlockLevelParameters&) {
+  const HloComputation* computation = fusion->fused_instructions_computation();
+  const HloInstruction* root = computation->root_instruction();
+  TF_ASSIGN_OR_RETURN(auto analysis, TritonAttentionAnalysis::Execute(*root));
+  TF_ASSIGN_OR_RETURN(TritonGemmConfig config,
+                      GetTritonAttentionConfig(*fusion));
+  TF_RETURN_IF_ERROR(ValidateAttentionConfig(config));
+
+  const HloDotInstruction* bmm1 = analysis.bmm1();
+  const HloDotInstruction* bmm2 = analysis.bmm2();
+  const int64_t num_batch_dims = analysis.num_batch_dims();
+  // Logical dimensions following the batch dimensions, e.g. [m, d] for q.
+  const int64_t first_dim = num_batch_dims;
+  const int64_t second_dim = num_batch_dims + 1;
+  const int64_t m = analysis.num_queries();
+  const int64_t n = analysis.num_keys();
+  const int64_t d = analysis.qk_head_dim();
+  const int64_t dv = analysis.v_head_dim();
+  const int block_m = config.block_m;
+  const int block_n = config.block_n;
+  const int64_t d_tile = DotTileSize(d);
+  const int64_t dv_tile = DotTileSize(dv);
+  const int64_t grid_m = CeilOfRatio<int64_t>(m, block_m);
+
+  // Use 32-bit indexing if addressing any of the inputs or the output does
+  // not cross the INT_MAX boundary. Otherwise, fall back to 64-bit indexing,
+  // which is slower.
+  bool use_64bit_indexing = ShapeUtil::ElementsIn(root->shape()) > INT_MAX;
+  for (const HloInstruction* parameter :
+       computation->parameter_instructions()) {
+    use_64bit_indexing |= ShapeUtil::ElementsIn(parameter->shape()) > INT_MAX;
+  }
+  Type index_ty = builder.getIntegerType(use_64bit_indexing ? 64 : 32);
+
+  auto loc = mlir::NameLoc::get(builder.getStringAttr(bmm2->name()));
+  ImplicitLocOpBuilder b(loc, builder);
+  auto c32 = [&](int64_t v) {
+    return CreateConst(b, b.getI32Type(), v).UnwrapScalar();
+  };
+  auto argument = [&](const Access& access) {
+    return fn.getArgument(access.hlo->parameter_number());
+  };
+
+  // Every program computes `block_m` queries of one batch element.
+  Value pid = b.create<mt::GetProgramIdOp>(mt::ProgramIDDim::X);
+  Value pid_m = b.create<ma::RemSIOp>(pid, c32(grid_m));
+  Value pid_batch = b.create<ma::DivSIOp>(pid, c32(grid_m));
+  if (use_64bit_indexing) {
+    pid_batch = b.create<ma::ExtSIOp>(index_ty, pid_batch);
+  }
+  TileEmitter tiles(
+      b, index_ty,
+      DelinearizeIndex(
+          b, pid_batch,
+          analysis.scores()->shape().dimensions().first(num_batch_dims)));
+
+  Value queries = b.create<ma::AddIOp>(
+      Range(b, block_m),
+      Splat(b, b.create<ma::MulIOp>(pid_m, c32(block_m)), {block_m}));
+
+  // Logical dimensions of the operands of the dots: q [batch..., m, d],
+  // k [batch..., n, d] and v [batch..., n, dv].
+  const DotDimensionNumbers& bmm1_dims = bmm1->dot_dimension_numbers();
+  const DotDimensionNumbers& bmm2_dims = bmm2->dot_dimension_numbers();
+  SmallVector<int64_t> q_dims(bmm1_dims.lhs_batch_dimensions().begin(),
+                              bmm1_dims.lhs_batch_dimensions().end());
+  q_dims.push_back(NonContractingDim(analysis.q()->shape(),
+                                     bmm1_dims.lhs_batch_dimensions(),
+                                     bmm1_dims.lhs_contracting_dimensions(0)));
+  q_dims.push_back(bmm1_dims.lhs_contracting_dimensions(0));
+  SmallVector<int64_t> k_dims(bmm1_dims.rhs_batch_dimensions().begin(),
+                              bmm1_dims.rhs_batch_dimensions().end());
+  k_dims.push_back(NonContractingDim(analysis.k()->shape(),
+                                     bmm1_dims.rhs_batch_dimensions(),
+                                     bmm1_dims.rhs_contracting_dimensions(0)));
+  k_dims.push_back(bmm1_dims.rhs_contracting_dimensions(0));
+  SmallVector<int64_t> v_dims(bmm2_dims.rhs_batch_dimensions().begin(),
+                              bmm2_dims.rhs_batch_dimensions().end());
+  v_dims.push_back(bmm2_dims.rhs_contracting_dimensions(0));
+  v_dims.push_back(NonContractingDim(analysis.v()->shape(),
+                                     bmm2_dims.rhs_batch_dimensions(),
+                                     bmm2_dims.rhs_contracting_dimensions(0)));
+  // In the order of the dimensions of the scores and of the output.
+  SmallVector<int64_t> identity_dims(num_batch_dims + 2);
+  absl::c_iota(identity_dims, 0);
+
+  TF_ASSIGN_OR_RETURN(Access q, GetAccess(*analysis.q(), q_dims));
+  TF_ASSIGN_OR_RETURN(Access k, GetAccess(*analysis.k(), k_dims));
+  TF_ASSIGN_OR_RETURN(Access v, GetAccess(*analysis.v(), v_dims));
+  TF_ASSIGN_OR_RETURN(Type qk_ty,
+                      TritonType(b, analysis.q()->shape().element_type()));
+  TF_ASSIGN_OR_RETURN(Type v_ty,
+                      TritonType(b, analysis.v()->shape().element_type()));
+  TF_ASSIGN_OR_RETURN(Type bmm1_ty,
+                      TritonType(b, bmm1->shape().element_type()));
+  TF_ASSIGN_OR_RETURN(Type out_ty, TritonType(b, root->shape().element_type()));
+  Type f32_ty = b.getF32Type();
+  const float neg_inf = -std::numeric_limits<float>::infinity();
+
+  // The block of q stays in registers for all blocks of keys.
+  Value q_tile = tiles.EmitLoad(
+      tiles.EmitPointers(argument(q), q, queries, first_dim, m,
+                         Range(b, d_tile), second_dim, d),
+      qk_ty);
+
+  // Online softmax: for every query, `max` is the maximum of the scores seen
+  // so far, `sum` the sum of their exponentials relative to `max` and `acc`
+  // the product of these exponentials with v.
+  Value acc_init = CreateConst(b, f32_ty, 0, {block_m, dv_tile}).UnwrapTensor();
+  Value max_init = CreateConst(b, f32_ty, neg_inf, {block_m}).UnwrapTensor();
+  Value sum_init = CreateConst(b, f32_ty, 0, {block_m}).UnwrapTensor();
+  auto loop = b.create<mlir::scf::ForOp>(
+      /*lowerBound=*/c32(0), /*upperBound=*/c32(n), /*step=*/c32(block_n),
+      /*iterArgs=*/ValueRange{acc_init, max_init, sum_init});
+  b.setInsertionPointToStart(loop.getBody());
+  {
+    Value acc = loop.getRegionIterArgs()[0];
+    Value max = loop.getRegionIterArgs()[1];
+    Value sum = loop.getRegionIterArgs()[2];
+    Value keys = b.create<ma::AddIOp>(
+        Range(b, block_n), Splat(b, loop.getInductionVar(), {block_n}));
+    const SmallVector<int64_t> scores_shape = {block_m, block_n};
+
+    // k is loaded transposed as [d, n].
+    Value k_tile = tiles.EmitLoad(
+        tiles.EmitPointers(argument(k), k, Range(b, d_tile), second_dim, d,
+                           keys, first_dim, n),
+        qk_ty);
+    Value scores = b.create<mt::DotOp>(
+        q_tile, k_tile, CreateConst(b, f32_ty, 0, scores_shape).UnwrapTensor(),
+        /*inputPrecision=*/GetDotPrecision(*bmm1),
+        /*maxNumImpreciseAcc=*/0);
+
+    // Emit f(scores, inputs...).
+    absl::flat_hash_map<const HloInstruction*, Value> values;
+    values[bmm1] = Cast(b, scores, bmm1_ty);
+    auto load_scores_input = [&](const HloInstruction& hlo,
+                                 PrimitiveType type) -> absl::StatusOr<Value> {
+      TF_ASSIGN_OR_RETURN(Access access, GetAccess(hlo, identity_dims));
+      TF_ASSIGN_OR_RETURN(Type ty, TritonType(b, type));
+      return tiles.EmitLoad(
+          tiles.EmitPointers(argument(access), access, queries, first_dim, m,
+                             keys, second_dim, n),
+          ty);
+    };
+    for (const HloInstruction* hlo : analysis.score_instructions()) {
+      Value result;
+      if (hlo->opcode() == HloOpcode::kConstant) {
+        TF_RET_CHECK(ShapeUtil::IsEffectiveScalar(hlo->shape()))
+            << hlo->ToString();
+        TF_ASSIGN_OR_RETURN(ScalarOrTensor constant, EmitConstant(b, *hlo));
+        result = constant.UnwrapScalar();
+      } else if (hlo_query::IsBroadcastOfScalarConstant(*hlo)) {
+        result = Splat(b, values[hlo->operand(0)], scores_shape);
+      } else if (hlo->opcode() == HloOpcode::kBroadcast) {
+        TF_ASSIGN_OR_RETURN(
+            result, load_scores_input(*hlo, hlo->shape().element_type()));
+      } else if (hlo->opcode() == HloOpcode::kIota) {
+        const int64_t iota_dim =
+            ::xla::Cast<HloIotaInstruction>(hlo)->iota_dimension();
+        Value indices;
+        if (iota_dim < num_batch_dims) {
+          indices = Splat(b, tiles.batch_index(iota_dim), scores_shape);
+        } else if (iota_dim == first_dim) {
+          indices = ExpandAndBroadcast(b, queries, /*axis=*/1, scores_shape);
+        } else {
+          indices = ExpandAndBroadcast(b, keys, /*axis=*/0, scores_shape);
+        }
+        TF_ASSIGN_OR_RETURN(Type iota_ty,
+                            TritonType(b, hlo->shape().element_type()));
+        result = Cast(b, indices, iota_ty);
+      } else {
+        SmallVector<Value> operands;
+        for (const HloInstruction* operand : hlo->operands()) {
+          if (!values.contains(operand)) {
+            // An input of the scores with their shape.
+            TF_ASSIGN_OR_RETURN(
+                values[operand],
+                load_scores_input(*operand, operand->shape().element_type()));
+          }
+          operands.push_back(values[operand]);
+        }
+        TF_ASSIGN_OR_RETURN(result,
+                            EmitScoreElementwise(b, libdevice_path,
+                                                 device_info, *hlo, operands));
+      }
+      values[hlo] = result;
+    }
+    // The softmax is computed in F32 whatever the type of the scores.
+    scores = Cast(b, values.at(analysis.scores()), f32_ty);
+    if (n % block_n != 0) {
+      Value in_bounds = b.create<ma::CmpIOp>(
+          ma::CmpIPredicate::slt,
+          ExpandAndBroadcast(b, keys, /*axis=*/0, scores_shape),
+          CreateConst(b, b.getI32Type(), n, scores_shape).UnwrapTensor());
+      scores = b.create<ma::SelectOp>(
+          in_bounds, scores,
+          CreateConst(b, f32_ty, neg_inf, scores_shape).UnwrapTensor());
+    }
+
+    Value max_next = b.create<ma::MaximumFOp>(
+        max, EmitRowReduction(b, scores, /*maximum=*/true));
+    // Rows whose scores are all -inf so far are shifted by 0 instead of their
+    // maximum, so that they produce exp(-inf) = 0 rather than NaN.
+    Value max_shift = b.create<ma::SelectOp>(
+        b.create<ma::CmpFOp>(
+            ma::CmpFPredicate::OEQ, max_next,
+            CreateConst(b, f32_ty, neg_inf, {block_m}).UnwrapTensor()),
+        CreateConst(b, f32_ty, 0, {block_m}).UnwrapTensor(), max_next);
+    Value probs = b.create<mm::ExpOp>(b.create<ma::SubFOp>(
+        scores, ExpandAndBroadcast(b, max_shift, /*axis=*/1, scores_shape)));
+    Value rescale = b.create<mm::ExpOp>(b.create<ma::SubFOp>(max, max_shift));
+    Value sum_next = b.create<ma::AddFOp>(
+        b.create<ma::MulFOp>(sum, rescale),
+        EmitRowReduction(b, probs, /*maximum=*/false));
+    acc = b.create<ma::MulFOp>(
+        acc, ExpandAndBroadcast(b, rescale, /*axis=*/1, {block_m, dv_tile}));
+
+    Value v_tile = tiles.EmitLoad(
+        tiles.EmitPointers(argument(v), v, keys, first_dim, n,
+                           Range(b, dv_tile), second_dim, dv),
+        v_ty);
+    Value acc_next = b.create<mt::DotOp>(
+        Cast(b, probs, v_ty), v_tile, acc,
+        /*inputPrecision=*/GetDotPrecision(*bmm2),
+        /*maxNumImpreciseAcc=*/0);
+    b.create<mlir::scf::YieldOp>(ValueRange{acc_next, max_next, sum_next});
+  }
+  b.setInsertionPointAfter(loop);
+
+  Value out = b.create<ma::DivFOp>(
+      loop.getResult(0),
+      ExpandAndBroadcast(b, loop.getResult(2), /*axis=*/1, {block_m, dv_tile}));
+  const Access out_access{root, ElementStrides(root->shape())};
+  tiles.EmitStore(
+      tiles.EmitPointers(fn.getArgument(computation->num_parameters()),
+                         out_access, queries, first_dim, m, Range(b, dv_tile),
+                         second_dim, dv),
+      out, out_ty);
+  return absl::OkStatus();
+}
+
+}  // namespace xla::gpu
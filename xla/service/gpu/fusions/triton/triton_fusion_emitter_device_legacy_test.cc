@@ -3746,6 +3746,54 @@ ENTRY e {
                                       /*run_hlo_passes=*/false));
 }
 
+TEST_F(CompareTest, AtomicSplitK) {
+  const std::string hlo_text_ref = R"(
+HloModule t
+
+triton_dot {
+  p0 = f32[100,300] parameter(0)
+  p1 = f32[300,70] parameter(1)
+  ROOT dot = f32[100,70] dot(p0, p1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+}
+
+ENTRY e {
+  p0 = f32[100,300]{1,0} parameter(0)
+  p1 = f32[300,70]{1,0} parameter(1)
+  ROOT _ = f32[100,70] fusion(p0, p1), kind=kCustom, calls=triton_dot,
+    backend_config={"fusion_backend_config": {kind: "__triton_gemm",
+    triton_gemm_config: {"block_m":32,"block_n":32,"block_k":32,
+                         "split_k":1,"num_stages":1,"num_warps":4,
+                         "num_ctas":1}}}
+})";
+
+  // K is not a multiple of block_k * split_k, so the last iterations of the
+  // programs along K are masked.
+  const std::string hlo_text_atomic_splitk = R"(
+HloModule t
+
+triton_dot {
+  p0 = f32[100,300] parameter(0)
+  p1 = f32[300,70] parameter(1)
+  ROOT dot = f32[100,70] dot(p0, p1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+}
+
+ENTRY e {
+  p0 = f32[100,300]{1,0} parameter(0)
+  p1 = f32[300,70]{1,0} parameter(1)
+  ROOT _ = f32[100,70] fusion(p0, p1), kind=kCustom, calls=triton_dot,
+    backend_config={"fusion_backend_config": {kind: "__triton_gemm",
+    triton_gemm_config: {"block_m":32,"block_n":32,"block_k":32,
+                         "split_k":4,"num_stages":1,"num_warps":4,
+                         "num_ctas":1,"atomic_split_k":true}}}
+})";
+
+  EXPECT_TRUE(RunAndCompareTwoModules(hlo_text_ref, hlo_text_atomic_splitk,
+                                      ErrorSpec{/*aabs=*/1e-4, /*arel=*/1e-4},
+                                      /*run_hlo_passes=*/false));
+}
+
 TEST_F(CompareTest, SplitKBatch) {
   if (!SupportsBF16(GpuComputeComp())) {
     GTEST_SKIP() << "BF16 not supported.";
@@ -5545,6 +5593,176 @@ ENTRY e {
                             ErrorSpec{/*aabs=*/1e-3, /*arel=*/1e-3}));
 }
 
+TEST_F(TritonGemmTest, AttentionWithBiasAndPartialBlocksOfKeys) {
+  if (!GetCudaComputeCapability().IsAtLeastAmpere()) {
+    GTEST_SKIP() << "Triton attention requires Ampere or newer.";
+  }
+  // 200 keys do not fill the last block of 64 keys; 100 queries do not fill
+  // the last block of queries.
+  constexpr std::string_view kHloText = R"(
+HloModule m
+
+max_computation {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT r = f32[] maximum(a, b)
+}
+
+add_computation {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT r = f32[] add(a, b)
+}
+
+triton_attention_computation {
+  q = bf16[2,3,100,64] parameter(0)
+  k = bf16[2,3,200,64] parameter(1)
+  bias = f32[100,200] parameter(2)
+  v = bf16[2,3,200,64] parameter(3)
+  bmm1 = bf16[2,3,100,200] dot(q, k), lhs_batch_dims={0,1},
+    lhs_contracting_dims={3}, rhs_batch_dims={0,1}, rhs_contracting_dims={3}
+  scores_f32 = f32[2,3,100,200] convert(bmm1)
+  scale = f32[] constant(0.125)
+  scale_b = f32[2,3,100,200] broadcast(scale), dimensions={}
+  scaled = f32[2,3,100,200] multiply(scores_f32, scale_b)
+  bias_b = f32[2,3,100,200] broadcast(bias), dimensions={2,3}
+  scores = f32[2,3,100,200] add(scaled, bias_b)
+  min = f32[] constant(-inf)
+  max = f32[2,3,100] reduce(scores, min), dimensions={3},
+    to_apply=max_computation
+  max_b = f32[2,3,100,200] broadcast(max), dimensions={0,1,2}
+  sub = f32[2,3,100,200] subtract(scores, max_b)
+  exp = f32[2,3,100,200] exponential(sub)
+  zero = f32[] constant(0)
+  sum = f32[2,3,100] reduce(exp, zero), dimensions={3},
+    to_apply=add_computation
+  sum_b = f32[2,3,100,200] broadcast(sum), dimensions={0,1,2}
+  probs = f32[2,3,100,200] divide(exp, sum_b)
+  probs_bf16 = bf16[2,3,100,200] convert(probs)
+  ROOT out = bf16[2,3,100,64] dot(probs_bf16, v), lhs_batch_dims={0,1},
+    lhs_contracting_dims={3}, rhs_batch_dims={0,1}, rhs_contracting_dims={2}
+}
+
+ENTRY e {
+  q = bf16[2,3,100,64] parameter(0)
+  k = bf16[2,3,200,64] parameter(1)
+  bias = f32[100,200] parameter(2)
+  v = bf16[2,3,200,64] parameter(3)
+  ROOT triton_attention = bf16[2,3,100,64] fusion(q, k, bias, v),
+    kind=kCustom, calls=triton_attention_computation,
+    backend_config={"fusion_backend_config": {kind: "__triton_attention",
+      triton_gemm_config:
+        {"block_m":64,"block_n":64,"block_k":64,
+         "split_k":1,"num_stages":2,"num_warps":4,
+         "num_ctas":1}}}
+})";
+
+  EXPECT_TRUE(RunAndCompareNoHloPasses(kHloText,
+                                       ErrorSpec{/*aabs=*/1e-2, /*arel=*/1e-2}));
+}
+
+TEST_F(TritonGemmTest, AttentionWithCausalMaskAndGroupedKeys) {
+  if (!GetCudaComputeCapability().IsAtLeastAmpere()) {
+    GTEST_SKIP() << "Triton attention requires Ampere or newer.";
+  }
+  // Two groups of four query heads share one head of keys and values.
+  constexpr std::string_view kHloText = R"(
+HloModule m
+
+max_computation {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT r = f32[] maximum(a, b)
+}
+
+add_computation {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT r = f32[] add(a, b)
+}
+
+triton_attention_computation {
+  q = f16[1,2,4,128,32] parameter(0)
+  k = f16[1,2,128,32] parameter(1)
+  v = f16[1,2,128,32] parameter(2)
+  k_b = f16[1,2,4,128,32] broadcast(k), dimensions={0,1,3,4}
+  v_b = f16[1,2,4,128,32] broadcast(v), dimensions={0,1,3,4}
+  bmm1 = f32[1,2,4,128,128] dot(q, k_b), lhs_batch_dims={0,1,2},
+    lhs_contracting_dims={4}, rhs_batch_dims={0,1,2}, rhs_contracting_dims={4}
+  query = s32[1,2,4,128,128] iota(), iota_dimension=3
+  key = s32[1,2,4,128,128] iota(), iota_dimension=4
+  causal = pred[1,2,4,128,128] compare(query, key), direction=GE
+  min = f32[] constant(-inf)
+  min_b = f32[1,2,4,128,128] broadcast(min), dimensions={}
+  scores = f32[1,2,4,128,128] select(causal, bmm1, min_b)
+  max = f32[1,2,4,128] reduce(scores, min), dimensions={4},
+    to_apply=max_computation
+  max_b = f32[1,2,4,128,128] broadcast(max), dimensions={0,1,2,3}
+  sub = f32[1,2,4,128,128] subtract(scores, max_b)
+  exp = f32[1,2,4,128,128] exponential(sub)
+  zero = f32[] constant(0)
+  sum = f32[1,2,4,128] reduce(exp, zero), dimensions={4},
+    to_apply=add_computation
+  sum_b = f32[1,2,4,128,128] broadcast(sum), dimensions={0,1,2,3}
+  probs = f32[1,2,4,128,128] divide(exp, sum_b)
+  probs_f16 = f16[1,2,4,128,128] convert(probs)
+  ROOT out = f16[1,2,4,128,32] dot(probs_f16, v_b), lhs_batch_dims={0,1,2},
+    lhs_contracting_dims={4}, rhs_batch_dims={0,1,2}, rhs_contracting_dims={3}
+}
+
+ENTRY e {
+  q = f16[1,2,4,128,32] parameter(0)
+  k = f16[1,2,128,32] parameter(1)
+  v = f16[1,2,128,32] parameter(2)
+  ROOT triton_attention = f16[1,2,4,128,32] fusion(q, k, v),
+    kind=kCustom, calls=triton_attention_computation,
+    backend_config={"fusion_backend_config": {kind: "__triton_attention",
+      triton_gemm_config:
+        {"block_m":64,"block_n":64,"block_k":32,
+         "split_k":1,"num_stages":2,"num_warps":4,
+         "num_ctas":1}}}
+})";
+
+  EXPECT_TRUE(RunAndCompareNoHloPasses(kHloText,
+                                       ErrorSpec{/*aabs=*/1e-2, /*arel=*/1e-2}));
+}
+
+TEST_F(TritonGemmTest, GroupedGemmOfDotsWithDifferentShapes) {
+  // The dots have partial tiles along all dimensions, a batch dimension and a
+  // transposed operand.
+  constexpr std::string_view kHloText = R"(
+HloModule m
+
+grouped_gemm_computation {
+  x0 = f16[100,72] parameter(0)
+  w0 = f16[72,48] parameter(1)
+  x1 = f16[3,40,64] parameter(2)
+  w1 = f16[3,80,64] parameter(3)
+  d0 = f32[100,48] dot(x0, w0), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+  d1 = f32[3,40,80] dot(x1, w1), lhs_batch_dims={0}, lhs_contracting_dims={2},
+    rhs_batch_dims={0}, rhs_contracting_dims={2}
+  ROOT tuple = (f32[100,48], f32[3,40,80]) tuple(d0, d1)
+}
+
+ENTRY e {
+  x0 = f16[100,72] parameter(0)
+  w0 = f16[72,48] parameter(1)
+  x1 = f16[3,40,64] parameter(2)
+  w1 = f16[3,80,64] parameter(3)
+  ROOT grouped_gemm = (f32[100,48], f32[3,40,80]) fusion(x0, w0, x1, w1),
+    kind=kCustom, calls=grouped_gemm_computation,
+    backend_config={"fusion_backend_config": {kind: "__triton_grouped_gemm",
+      triton_gemm_config:
+        {"block_m":32,"block_n":32,"block_k":32,
+         "split_k":1,"num_stages":2,"num_warps":4,
+         "num_ctas":1}}}
+})";
+
+  EXPECT_TRUE(RunAndCompareNoHloPasses(kHloText,
+                                       ErrorSpec{/*aabs=*/1e-3, /*arel=*/1e-3}));
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
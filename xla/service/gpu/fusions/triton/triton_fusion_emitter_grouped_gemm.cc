@@ -0,0 +1,252 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/fusions/triton/triton_fusion_emitter_grouped_gemm.h"
+
+#include <climits>
+#include <cstdint>
+#include <limits>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Types.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/ValueRange.h"
+#include "mlir/Support/LLVM.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/service/gpu/fusions/triton/emitter_helpers.h"
+#include "xla/service/gpu/fusions/triton/tile_emitter.h"
+#include "xla/service/gpu/ir_emission_utils.h"
+#include "xla/service/gpu/launch_dimensions.h"
+#include "xla/service/gpu/matmul_utils.h"
+#include "xla/service/gpu/triton_grouped_gemm_analysis.h"
+#include "xla/shape_util.h"
+#include "xla/status_macros.h"
+#include "xla/stream_executor/device_description.h"
+#include "xla/stream_executor/launch_dim.h"
+#include "xla/util.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+
+namespace xla::gpu {
+
+namespace ma = ::mlir::arith;
+namespace mt = ::mlir::triton;
+
+using ::llvm::SmallVector;
+using ::mlir::ImplicitLocOpBuilder;
+using ::mlir::Type;
+using ::mlir::Value;
+using ::mlir::ValueRange;
+
+using ::xla::gpu::triton::Access;
+using ::xla::gpu::triton::CreateConst;
+using ::xla::gpu::triton::DelinearizeIndex;
+using ::xla::gpu::triton::ElementStrides;
+using ::xla::gpu::triton::GetAccess;
+using ::xla::gpu::triton::GetDotPrecision;
+using ::xla::gpu::triton::kMinDotTileSize;
+using ::xla::gpu::triton::Range;
+using ::xla::gpu::triton::Splat;
+using ::xla::gpu::triton::TileEmitter;
+using ::xla::gpu::triton::TritonType;
+
+namespace {
+
+using Gemm = TritonGroupedGemmAnalysis::Gemm;
+
+absl::Status ValidateGroupedGemmConfig(const TritonGemmConfig& config) {
+  for (int block : {config.block_m, config.block_n, config.block_k}) {
+    if (block < kMinDotTileSize || !llvm::isPowerOf2_32(block)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported grouped GEMM tiling: ", config.ToString()));
+    }
+  }
+  if (config.split_k != 1 || config.atomic_split_k) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Split-K is not supported by grouped GEMM fusions: ",
+                     config.ToString()));
+  }
+  return absl::OkStatus();
+}
+
+// Emits the computation of the `tile`-th output tile of `gemm`, whose result
+// is the `output_index`-th output of the fusion.
+absl::Status EmitGemmTile(ImplicitLocOpBuilder& b, mt::FuncOp fn,
+                          const HloComputation& computation, const Gemm& gemm,
+                          int64_t output_index, const TritonGemmConfig& config,
+                          Type index_ty, Value tile) {
+  const HloDotInstruction* dot = gemm.dot;
+  const int64_t num_batch_dims = gemm.num_batch_dims();
+  // Logical dimensions following the batch dimensions, e.g. [m, k] for lhs.
+  const int64_t first_dim = num_batch_dims;
+  const int64_t second_dim = num_batch_dims + 1;
+  const int block_m = config.block_m;
+  const int block_n = config.block_n;
+  const int block_k = config.block_k;
+  const int64_t grid_m = CeilOfRatio<int64_t>(gemm.m, block_m);
+  const int64_t grid_n = CeilOfRatio<int64_t>(gemm.n, block_n);
+  auto c32 = [&](int64_t v) {
+    return CreateConst(b, b.getI32Type(), v).UnwrapScalar();
+  };
+
+  // Tiles are ordered as [batch, grid_m, grid_n].
+  Value pid_n = b.create<ma::RemSIOp>(tile, c32(grid_n));
+  Value pid_m = b.create<ma::RemSIOp>(
+      b.create<ma::DivSIOp>(tile, c32(grid_n)), c32(grid_m));
+  Value pid_batch = b.create<ma::DivSIOp>(tile, c32(grid_m * grid_n));
+  if (!index_ty.isInteger(32)) {
+    pid_batch = b.create<ma::ExtSIOp>(index_ty, pid_batch);
+  }
+  TileEmitter tiles(
+      b, index_ty,
+      DelinearizeIndex(b, pid_batch,
+                       dot->shape().dimensions().first(num_batch_dims)));
+
+  Value rows = b.create<ma::AddIOp>(
+      Range(b, block_m),
+      Splat(b, b.create<ma::MulIOp>(pid_m, c32(block_m)), {block_m}));
+  Value cols = b.create<ma::AddIOp>(
+      Range(b, block_n),
+      Splat(b, b.create<ma::MulIOp>(pid_n, c32(block_n)), {block_n}));
+
+  TF_ASSIGN_OR_RETURN(Access lhs, GetAccess(*dot->operand(0), gemm.lhs_dims));
+  TF_ASSIGN_OR_RETURN(Access rhs, GetAccess(*dot->operand(1), gemm.rhs_dims));
+  TF_ASSIGN_OR_RETURN(Type lhs_ty,
+                      TritonType(b, dot->operand(0)->shape().element_type()));
+  TF_ASSIGN_OR_RETURN(Type rhs_ty,
+                      TritonType(b, dot->operand(1)->shape().element_type()));
+  TF_ASSIGN_OR_RETURN(Type out_ty, TritonType(b, dot->shape().element_type()));
+  Type f32_ty = b.getF32Type();
+
+  Value acc_init = CreateConst(b, f32_ty, 0, {block_m, block_n}).UnwrapTensor();
+  auto loop = b.create<mlir::scf::ForOp>(
+      /*lowerBound=*/c32(0), /*upperBound=*/c32(gemm.k), /*step=*/c32(block_k),
+      /*iterArgs=*/ValueRange{acc_init});
+  b.setInsertionPointToStart(loop.getBody());
+  {
+    Value contracting = b.create<ma::AddIOp>(
+        Range(b, block_k), Splat(b, loop.getInductionVar(), {block_k}));
+    // Elements past k are loaded as zeros and do not contribute to the dot.
+    Value lhs_tile = tiles.EmitLoad(
+        tiles.EmitPointers(fn.getArgument(lhs.hlo->parameter_number()), lhs,
+                           rows, first_dim, gemm.m, contracting, second_dim,
+                           gemm.k),
+        lhs_ty);
+    Value rhs_tile = tiles.EmitLoad(
+        tiles.EmitPointers(fn.getArgument(rhs.hlo->parameter_number()), rhs,
+                           contracting, first_dim, gemm.k, cols, second_dim,
+                           gemm.n),
+        rhs_ty);
+    Value acc_next = b.create<mt::DotOp>(
+        lhs_tile, rhs_tile, loop.getRegionIterArgs()[0],
+        /*inputPrecision=*/GetDotPrecision(*dot),
+        /*maxNumImpreciseAcc=*/0);
+    b.create<mlir::scf::YieldOp>(ValueRange{acc_next});
+  }
+  b.setInsertionPointAfter(loop);
+
+  const Access out{dot, ElementStrides(dot->shape())};
+  tiles.EmitStore(
+      tiles.EmitPointers(
+          fn.getArgument(computation.num_parameters() + output_index), out,
+          rows, first_dim, gemm.m, cols, second_dim, gemm.n),
+      loop.getResult(0), out_ty);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<LaunchDimensions> GetGroupedGemmLaunchDimensions(
+    const HloComputation& computation, const TritonGemmConfig& config) {
+  TF_ASSIGN_OR_RETURN(auto analysis,
+                      TritonGroupedGemmAnalysis::Execute(computation));
+  TF_RETURN_IF_ERROR(ValidateGroupedGemmConfig(config));
+  // All programs are laid out along X, which is the only 32-bit grid
+  // dimension.
+  const int64_t num_programs = analysis.NumTiles(config);
+  TF_RET_CHECK(num_programs <= std::numeric_limits<int32_t>::max());
+  return LaunchDimensions(se::BlockDim(num_programs, 1, 1),
+                          se::ThreadDim(config.num_warps * WarpSize(), 1, 1));
+}
+
+absl::Status EmitGroupedGemm(mlir::OpBuilder builder,
+                             absl::string_view libdevice_path,
+                             const se::DeviceDescription& device_info,
+                             const HloFusionInstruction* fusion,
+                             mlir::triton::FuncOp fn,
+                             const BlockLevelParameters&) {
+  const HloComputation* computation = fusion->fused_instructions_computation();
+  TF_ASSIGN_OR_RETURN(auto analysis,
+                      TritonGroupedGemmAnalysis::Execute(*computation));
+  TF_ASSIGN_OR_RETURN(TritonGemmConfig config,
+                      GetTritonGroupedGemmConfig(*fusion));
+  TF_RETURN_IF_ERROR(ValidateGroupedGemmConfig(config));
+
+  // Use 32-bit indexing if addressing any of the inputs or outputs does not
+  // cross the INT_MAX boundary. Otherwise, fall back to 64-bit indexing,
+  // which is slower.
+  bool use_64bit_indexing = false;
+  for (const Gemm& gemm : analysis.gemms()) {
+    use_64bit_indexing |= ShapeUtil::ElementsIn(gemm.dot->shape()) > INT_MAX;
+  }
+  for (const HloInstruction* parameter :
+       computation->parameter_instructions()) {
+    use_64bit_indexing |= ShapeUtil::ElementsIn(parameter->shape()) > INT_MAX;
+  }
+  Type index_ty = builder.getIntegerType(use_64bit_indexing ? 64 : 32);
+
+  auto loc = mlir::NameLoc::get(
+      builder.getStringAttr(computation->root_instruction()->name()));
+  ImplicitLocOpBuilder b(loc, builder);
+  auto c32 = [&](int64_t v) {
+    return CreateConst(b, b.getI32Type(), v).UnwrapScalar();
+  };
+
+  // Programs [first_tile, first_tile + num_tiles) compute the tiles of the
+  // i-th dot. Every program takes exactly one of the branches.
+  Value pid = b.create<mt::GetProgramIdOp>(mt::ProgramIDDim::X);
+  int64_t first_tile = 0;
+  for (int64_t i = 0; i < analysis.gemms().size(); ++i) {
+    const Gemm& gemm = analysis.gemms()[i];
+    const int64_t num_tiles = gemm.NumTiles(config);
+    Value in_gemm = b.create<ma::AndIOp>(
+        b.create<ma::CmpIOp>(ma::CmpIPredicate::sge, pid, c32(first_tile)),
+        b.create<ma::CmpIOp>(ma::CmpIPredicate::slt, pid,
+                             c32(first_tile + num_tiles)));
+    auto if_op = b.create<mlir::scf::IfOp>(in_gemm, /*withElseRegion=*/false);
+    b.setInsertionPointToStart(if_op.thenBlock());
+    TF_RETURN_IF_ERROR(EmitGemmTile(
+        b, fn, *computation, gemm, /*output_index=*/i, config, index_ty,
+        b.create<ma::SubIOp>(pid, c32(first_tile))));
+    b.setInsertionPointAfter(if_op);
+    first_tile += num_tiles;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xla::gpu
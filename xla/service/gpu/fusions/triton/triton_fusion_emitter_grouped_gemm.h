@@ -0,0 +1,51 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_FUSIONS_TRITON_TRITON_FUSION_EMITTER_GROUPED_GEMM_H_
+#define XLA_SERVICE_GPU_FUSIONS_TRITON_TRITON_FUSION_EMITTER_GROUPED_GEMM_H_
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "mlir/IR/Builders.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/service/gpu/launch_dimensions.h"
+#include "xla/service/gpu/matmul_utils.h"
+#include "xla/service/gpu/model/tiled_hlo_computation.h"
+#include "xla/stream_executor/device_description.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+
+namespace xla::gpu {
+
+// Compute the launch dimensions for the given Triton grouped GEMM fusion.
+absl::StatusOr<LaunchDimensions> GetGroupedGemmLaunchDimensions(
+    const HloComputation& computation, const TritonGemmConfig& config);
+
+// Emits a single kernel computing all dots of a fusion matched by
+// TritonGroupedGemmAnalysis. The programs are split between the dots in the
+// order of the root tuple, and every program computes one
+// [block_m, block_n] tile of the result of its dot. Use tiling and execution
+// parameters from 'config'. BlockLevelParameters are ignored.
+absl::Status EmitGroupedGemm(mlir::OpBuilder builder,
+                             absl::string_view libdevice_path,
+                             const se::DeviceDescription& device_info,
+                             const HloFusionInstruction* fusion,
+                             mlir::triton::FuncOp fn,
+                             const BlockLevelParameters&);
+
+}  // namespace xla::gpu
+
+#endif  // XLA_SERVICE_GPU_FUSIONS_TRITON_TRITON_FUSION_EMITTER_GROUPED_GEMM_H_
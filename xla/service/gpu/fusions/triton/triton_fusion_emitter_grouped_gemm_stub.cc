@@ -0,0 +1,34 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/fusions/triton/triton_fusion_emitter_grouped_gemm.h"
+
+namespace xla::gpu {
+
+absl::StatusOr<LaunchDimensions> GetGroupedGemmLaunchDimensions(
+    const HloComputation& computation, const TritonGemmConfig& config) {
+  return absl::UnimplementedError("not supported for this build configuration");
+}
+
+absl::Status EmitGroupedGemm(mlir::OpBuilder builder,
+                             absl::string_view libdevice_path,
+                             const se::DeviceDescription& device_info,
+                             const HloFusionInstruction* fusion,
+                             mlir::triton::FuncOp fn,
+                             const BlockLevelParameters&) {
+  return absl::UnimplementedError("not supported for this build configuration");
+}
+
+}  // namespace xla::gpu
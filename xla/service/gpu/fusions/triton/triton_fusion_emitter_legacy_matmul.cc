@@ -750,12 +750,12 @@ struct MatMulLaunchConfig {
     const TritonGemmConfig& config, const HloDotInstruction& dot,
     const TritonFusionAnalysis& analysis) {
   MatMulDims matmul_dims;
-  if (config.split_k > 1) {
+  if (config.NeedsSplitKRewrite()) {
     // split-k is always the first logical dimension.
     matmul_dims.out_split_k_dim_idx = 0;
   }
 
-  int64_t num_split_k_dims = config.split_k > 1 ? 1 : 0;
+  int64_t num_split_k_dims = config.NeedsSplitKRewrite() ? 1 : 0;
   const auto& dims = dot.dot_dimension_numbers();
   matmul_dims.lhs_contracting_dim_idx = dims.lhs_contracting_dimensions(0);
   matmul_dims.lhs_noncontracting_dim_idx =
@@ -791,7 +791,7 @@ struct MatMulLaunchConfig {
   TF_RET_CHECK(iter_spec != nullptr);
   matmul_dims.n = iter_spec->at(0).count;
   // Contracting dimension length.
-  if (config.split_k > 1 &&
+  if (config.NeedsSplitKRewrite() &&
       dot.operand(1)->operand(0)->opcode() == HloOpcode::kPad) {
     // Unpadded LHS shape:  [..., k, ...]
     // Padded LHS shape:    [..., padded_k, ...]
@@ -804,7 +804,7 @@ struct MatMulLaunchConfig {
   } else {
     matmul_dims.k =
         dot.operand(1)->shape().dimensions(dims.rhs_contracting_dimensions(0)) *
-        config.split_k;
+        (config.NeedsSplitKRewrite() ? config.split_k : 1);
   }
 
   auto* lhs_noncontracting_split_spec = GetLhsNoncontractingSplitSpec(
@@ -874,10 +874,15 @@ absl::Status ValidateMatMulConfig(const TritonGemmConfig& config,
   TF_RET_CHECK(config.block_n >= 16);
 
   const auto& dims = dot.dot_dimension_numbers();
-  int num_batch_dims =
-      dims.lhs_batch_dimensions_size() - (config.split_k > 1 ? 1 : 0);
+  const int num_split_k_dims = config.NeedsSplitKRewrite() ? 1 : 0;
+  int num_batch_dims = dims.lhs_batch_dimensions_size() - num_split_k_dims;
   TF_RET_CHECK(num_batch_dims <= 1);
-  if (config.split_k > 1) {
+  if (config.atomic_split_k) {
+    // Partial results are added to the output, so they can't go through an
+    // epilogue.
+    TF_RET_CHECK(SupportsAtomicSplitK(dot));
+  }
+  if (config.NeedsSplitKRewrite()) {
     // Split-K dimension has to be the first batch one and have an index
     // just before the contracting one.
     const int lhs_split_k_dim_idx = dims.lhs_contracting_dimensions(0) - 1;
@@ -897,7 +902,7 @@ absl::Status ValidateMatMulConfig(const TritonGemmConfig& config,
   TF_RET_CHECK(dims.rhs_contracting_dimensions_size() == 1);
 
   TF_RET_CHECK(dot.operand(0)->shape().rank() ==
-               2 + (config.split_k > 1 ? 1 : 0) + num_batch_dims);
+               2 + num_split_k_dims + num_batch_dims);
   return absl::OkStatus();
 }
 
@@ -1887,6 +1892,48 @@ Value EmitMaskOnInput(ImplicitLocOpBuilder& b,
   return if_op.getResult(0);
 }
 
+// Returns a tensor with the pointers to the elements of the 2D block that
+// `block_pointer` refers to, and a mask of the elements within the bounds of
+// the tensor. Needed for atomic operations, which don't accept block
+// pointers.
+absl::StatusOr<std::pair<Value, Value>> EmitPointersForBlock(
+    ImplicitLocOpBuilder& b, Value block_pointer) {
+  auto advance = block_pointer.getDefiningOp<mt::AdvanceOp>();
+  TF_RET_CHECK(advance != nullptr);
+  auto make_tensor_ptr = advance.getPtr().getDefiningOp<mt::MakeTensorPtrOp>();
+  TF_RET_CHECK(make_tensor_ptr != nullptr);
+  auto block_type = mlir::cast<mlir::RankedTensorType>(
+      mlir::cast<mt::PointerType>(block_pointer.getType()).getPointeeType());
+  ArrayRef<int64_t> block_shape = block_type.getShape();
+  TF_RET_CHECK(block_shape.size() == 2);
+
+  Type i64_ty = b.getI64Type();
+  Value offsets;
+  Value mask;
+  for (int dim = 0; dim < 2; ++dim) {
+    Value start = b.create<ma::AddIOp>(make_tensor_ptr.getOffsets()[dim],
+                                       advance.getOffsets()[dim]);
+    Value range = b.create<ma::AddIOp>(Range(b, block_shape[dim]),
+                                       Splat(b, start, block_shape[dim]));
+    // [block_m] -> [block_m, 1] or [block_n] -> [1, block_n].
+    Value indices = b.create<mt::BroadcastOp>(
+        block_type.clone(b.getI32Type()),
+        b.create<mt::ExpandDimsOp>(range, /*axis=*/1 - dim));
+    indices = b.create<ma::ExtSIOp>(block_type.clone(i64_ty), indices);
+    Value in_bounds = b.create<ma::CmpIOp>(
+        ma::CmpIPredicate::slt, indices,
+        Splat(b, make_tensor_ptr.getShape()[dim], block_shape));
+    Value dim_offsets = b.create<ma::MulIOp>(
+        indices, Splat(b, make_tensor_ptr.getStrides()[dim], block_shape));
+    offsets = dim == 0 ? dim_offsets
+                       : b.create<ma::AddIOp>(offsets, dim_offsets);
+    mask = dim == 0 ? in_bounds : b.create<ma::AndIOp>(mask, in_bounds);
+  }
+  Value pointers =
+      AddPtr(b, Splat(b, make_tensor_ptr.getBase(), block_shape), offsets);
+  return std::make_pair(pointers, mask);
+}
+
 }  // namespace
 
 // Use tiling and execution parameters from 'config'. BlockLevelParameters are
@@ -1918,9 +1965,11 @@ absl::Status EmitMatMul(mlir::OpBuilder builder,
   TF_ASSIGN_OR_RETURN(
       TritonGemmConfig config,
       TritonGemmConfig::FromProto(backend_config.triton_gemm_config()));
-  TF_ASSIGN_OR_RETURN(auto analysis,
-                      TritonFusionAnalysis::Execute(
-                          *fusion->called_computation(), config.split_k));
+  TF_ASSIGN_OR_RETURN(
+      auto analysis,
+      TritonFusionAnalysis::Execute(
+          *fusion->called_computation(),
+          config.NeedsSplitKRewrite() ? config.split_k : 1));
 
   TF_RETURN_IF_ERROR(CheckGemmTilingComplexityHeuristic(config));
 
@@ -1936,7 +1985,9 @@ absl::Status EmitMatMul(mlir::OpBuilder builder,
   bool use_64bit_indexing =
       ShapeUtil::ElementsIn(dot_instr->operand(0)->shape()) > INT_MAX ||
       ShapeUtil::ElementsIn(dot_instr->operand(1)->shape()) > INT_MAX ||
-      ShapeUtil::ElementsIn(dot_instr->shape()) * config.split_k > INT_MAX;
+      ShapeUtil::ElementsIn(dot_instr->shape()) *
+          (config.NeedsSplitKRewrite() ? config.split_k : 1) >
+      INT_MAX;
   Type index_ty = builder.getIntegerType(use_64bit_indexing ? 64 : 32);
 
   const HloInstruction* root = dot_instr->parent()->root_instruction();
@@ -2189,6 +2240,16 @@ absl::Status EmitMatMul(mlir::OpBuilder builder,
             producer, scopes.out(),
             {fn.getArgument(i + dot_instr->parent()->num_parameters())},
             scopes.pid_k(), boundary_checks));
+    if (config.atomic_split_k) {
+      TF_ASSIGN_OR_RETURN(auto pointers_and_mask,
+                          EmitPointersForBlock(b, tensor_pointer));
+      auto [pointers, mask] = pointers_and_mask;
+      b.create<mt::AtomicRMWOp>(values_out[producer].getType(),
+                                mt::RMWOp::FADD, pointers, values_out[producer],
+                                mask, mt::MemSemantic::RELAXED,
+                                mt::MemSyncScope::GPU);
+      continue;
+    }
     b.create<mt::StoreOp>(tensor_pointer, values_out[producer], boundary_checks,
                           mt::CacheModifier::NONE, mt::EvictionPolicy::NORMAL);
   }
@@ -123,6 +123,49 @@ ENTRY main {
                           aot_result->LoadExecutable(compiler, stream_exec));
 }
 
+TEST_F(GpuAotCompilationTest, AotCompilationWithAdditionalTargets) {
+  const absl::string_view hlo_string = R"(
+HloModule Test
+
+ENTRY main {
+  a = f32[100, 200]{1,0} parameter(0)
+  ROOT b = f32[100, 200]{0,1} copy(a)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+
+  auto compiler = backend().compiler();
+  auto name =
+      absl::AsciiStrToUpper(PlatformUtil::CanonicalPlatformName("gpu").value());
+  TF_ASSERT_OK_AND_ASSIGN(se::Platform * platform,
+                          se::PlatformManager::PlatformWithName(name));
+  TF_ASSERT_OK_AND_ASSIGN(se::StreamExecutor * stream_exec,
+                          platform->ExecutorForDevice(0));
+
+  auto module_group = std::make_unique<HloModuleGroup>(std::move(module));
+
+  // Bundle a second binary for the same architecture; loading must pick one
+  // of them and produce a working executable.
+  Compiler::TargetConfig gpu_target_config(stream_exec);
+  AotCompilationOptions aot_options(compiler->PlatformId());
+  aot_options.set_target_config(gpu_target_config);
+  aot_options.add_additional_target_config(gpu_target_config);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::unique_ptr<AotCompilationResult>> aot_results,
+      compiler->CompileAheadOfTime(std::move(module_group), aot_options));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::string serialized_aot_result,
+                          aot_results[0]->SerializeAsString());
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<AotCompilationResult> aot_result,
+      compiler->LoadAotCompilationResult(serialized_aot_result));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Executable> executable,
+                          aot_result->LoadExecutable(compiler, stream_exec));
+}
+
 namespace {
 
 using ::mlir::ArrayRef;
@@ -71,6 +71,7 @@ limitations under the License.
 #include "xla/hlo/pass/hlo_pass_fix.h"
 #include "xla/hlo/pass/hlo_pass_pipeline.h"
 #include "xla/maybe_owning.h"
+#include "xla/primitive_util.h"
 #include "xla/service/algebraic_simplifier.h"
 #include "xla/service/all_gather_broadcast_reorder.h"
 #include "xla/service/all_gather_combiner.h"
@@ -86,9 +87,11 @@ limitations under the License.
 #include "xla/service/broadcast_canonicalizer.h"
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/call_inliner.h"
+#include "xla/service/collective_compressor.h"
 #include "xla/service/collective_permute_decomposer.h"
 #include "xla/service/collective_pipeliner.h"
 #include "xla/service/collective_quantizer.h"
+#include "xla/service/collective_utils.h"
 #include "xla/service/collectives_schedule_linearizer.h"
 #include "xla/service/comparison_expander.h"
 #include "xla/service/compiler.h"
@@ -134,8 +137,10 @@ limitations under the License.
 #include "xla/service/gpu/ir_emitter_context.h"
 #include "xla/service/gpu/ir_emitter_unnested.h"
 #include "xla/service/gpu/kernel_reuse_cache.h"
+#include "xla/service/gpu/llvm_module_split.h"
 #include "xla/service/gpu/matmul_utils.h"
 #include "xla/service/gpu/metrics.h"
+#include "xla/service/gpu/model/gpu_collective_topology.h"
 #include "xla/service/gpu/model/gpu_cost_model_stats_collection.h"
 #include "xla/service/gpu/model/gpu_hlo_cost_analysis.h"
 #include "xla/service/gpu/prepare_hlo_for_ir_emitting_pipeline.h"
@@ -166,6 +171,8 @@ limitations under the License.
 #include "xla/service/gpu/transforms/gemm_fusion.h"
 #include "xla/service/gpu/transforms/gemm_rewriter.h"
 #include "xla/service/gpu/transforms/gemv_rewriter.h"
+#include "xla/service/gpu/transforms/grouped_gemm_fusion.h"
+#include "xla/service/gpu/transforms/hierarchical_collective_decomposer.h"
 #include "xla/service/gpu/transforms/layout_assignment.h"
 #include "xla/service/gpu/transforms/move_copy_to_users.h"
 #include "xla/service/gpu/transforms/pipelined_p2p_rewriter.h"
@@ -185,6 +192,7 @@ limitations under the License.
 #include "xla/service/gpu/transforms/topk_splitter.h"
 #include "xla/service/gpu/transforms/transpose_dimension_grouper.h"
 #include "xla/service/gpu/transforms/tree_reduction_rewriter.h"
+#include "xla/service/gpu/transforms/triton_attention_rewriter.h"
 #include "xla/service/gpu/transforms/triton_fusion_numerics_verifier.h"
 #include "xla/service/gpu/transforms/windowed_einsum_handler.h"
 #include "xla/service/hlo.pb.h"
@@ -199,6 +207,7 @@ limitations under the License.
 #include "xla/service/hlo_verifier.h"
 #include "xla/service/host_memory_transfer_asyncifier.h"
 #include "xla/service/host_offload_legalize.h"
+#include "xla/service/host_offload_utils.h"
 #include "xla/service/host_offloader.h"
 #include "xla/service/layout_assignment.h"
 #include "xla/service/layout_normalization.h"
@@ -319,6 +328,27 @@ se::GpuComputeCapability GetGpuVersion(const se::StreamExecutor* stream_exec) {
   return stream_exec->GetDeviceDescription().gpu_compute_capability();
 }
 
+bool HasComputeCapability(const TargetBinaryProto& target,
+                          const se::GpuComputeCapability& gpu_version) {
+  if (auto* cuda = std::get_if<se::CudaComputeCapability>(&gpu_version)) {
+    return target.has_cuda_compute_capability() &&
+           se::CudaComputeCapability(target.cuda_compute_capability()) ==
+               *cuda;
+  }
+  const auto& rocm = std::get<se::RocmComputeCapability>(gpu_version);
+  return target.has_rocm_compute_capability() &&
+         target.rocm_compute_capability().gcn_arch_name() ==
+             rocm.gcn_arch_name();
+}
+
+std::string ComputeCapabilityToString(
+    const se::GpuComputeCapability& gpu_version) {
+  if (auto* cuda = std::get_if<se::CudaComputeCapability>(&gpu_version)) {
+    return cuda->ToString();
+  }
+  return std::get<se::RocmComputeCapability>(gpu_version).gcn_arch_name();
+}
+
 class GpuThunkAotCompilationResult : public AotCompilationResult {
  public:
   static absl::StatusOr<std::unique_ptr<GpuThunkAotCompilationResult>>
@@ -353,6 +383,25 @@ class GpuThunkAotCompilationResult : public AotCompilationResult {
         new GpuThunkAotCompilationResult(std::move(module), std::move(proto)));
   }
 
+  // Adds the device binary compiled for `gpu_version` from the same optimized
+  // module and buffer assignment.
+  void AddTargetBinary(const se::GpuComputeCapability& gpu_version,
+                       std::string_view asm_text,
+                       absl::Span<const uint8_t> binary,
+                       const BinaryMap& dnn_compiled_graphs) {
+    TargetBinaryProto* target = proto_.add_target_binaries();
+    if (auto* cuda = std::get_if<se::CudaComputeCapability>(&gpu_version)) {
+      *target->mutable_cuda_compute_capability() = cuda->ToProto();
+    } else {
+      *target->mutable_rocm_compute_capability() =
+          std::get<se::RocmComputeCapability>(gpu_version).ToProto();
+    }
+    target->set_asm_text(std::string(asm_text));
+    target->set_binary(binary.data(), binary.size());
+    target->mutable_dnn_compiled_graphs()->insert(dnn_compiled_graphs.cbegin(),
+                                                  dnn_compiled_graphs.cend());
+  }
+
   absl::StatusOr<std::string> SerializeAsString() const override {
     return proto_.SerializeAsString();
   }
@@ -393,15 +442,30 @@ GpuThunkAotCompilationResult::LoadExecutable(
 
   ExecutionStreamAssignment execution_stream_assignment(hlo_module.get());
 
-  std::vector<uint8_t> binary(proto_.binary().begin(), proto_.binary().end());
+  const se::DeviceDescription& gpu_device_info =
+      stream_exec->GetDeviceDescription();
+
+  // Pick the device binary built for this device, if the result carries
+  // binaries for several architectures.
+  const std::string* asm_text = &proto_.asm_text();
+  const std::string* binary_str = &proto_.binary();
+  const auto* dnn_compiled_graphs = &proto_.dnn_compiled_graphs();
+  for (const TargetBinaryProto& target : proto_.target_binaries()) {
+    if (HasComputeCapability(target,
+                             gpu_device_info.gpu_compute_capability())) {
+      asm_text = &target.asm_text();
+      binary_str = &target.binary();
+      dnn_compiled_graphs = &target.dnn_compiled_graphs();
+      break;
+    }
+  }
+  std::vector<uint8_t> binary(binary_str->begin(), binary_str->end());
 
   // Build the executable, which should be a thunk sequence.
   TF_ASSIGN_OR_RETURN(
       se::Platform * platform,
       se::PlatformManager::PlatformWithId(compiler->PlatformId()));
   std::string platform_name = platform->Name();
-  const se::DeviceDescription& gpu_device_info =
-      stream_exec->GetDeviceDescription();
   mlir::DialectRegistry registry;
   auto mlir_context = std::make_unique<mlir::MLIRContext>(registry);
   llvm::LLVMContext llvm_context;
@@ -445,11 +509,10 @@ GpuThunkAotCompilationResult::LoadExecutable(
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<GpuExecutable> executable,
       GpuExecutable::Create(GpuExecutable::Params{
-          /*asm_text=*/proto_.asm_text(),
+          /*asm_text=*/*asm_text,
           /*binary=*/binary,
           /*dnn_compiled_graphs=*/
-          BinaryMap(proto_.dnn_compiled_graphs().cbegin(),
-                    proto_.dnn_compiled_graphs().cend()),
+          BinaryMap(dnn_compiled_graphs->cbegin(), dnn_compiled_graphs->cend()),
           /*gpu_version=*/gpu_device_info.gpu_compute_capability(),
           /*executable=*/ir_emitter->ConsumeThunkSequence(),
           /*constants=*/std::move(constants),
@@ -928,7 +991,19 @@ absl::Status RunCollectiveOptimizationPasses(
   // Moves collectives' subsequent quantization before the collective to
   // minimize data transfers.
   collectives_pipeline.AddPass<CollectiveQuantizer>();
-  // Remove dead computations after collective quantization.
+  // Optionally compress the remaining large collectives (lossy).
+  if (!debug_options.xla_gpu_collective_compression_type().empty()) {
+    CollectiveCompressor::Config config;
+    TF_ASSIGN_OR_RETURN(
+        config.compressed_type,
+        primitive_util::StringToPrimitiveType(
+            debug_options.xla_gpu_collective_compression_type()));
+    config.min_bytes = debug_options.xla_gpu_collective_compression_min_bytes();
+    config.error_feedback =
+        debug_options.xla_gpu_collective_compression_error_feedback();
+    collectives_pipeline.AddPass<CollectiveCompressor>(config);
+  }
+  // Remove dead computations after collective quantization and compression.
   collectives_pipeline.AddPass<HloDCE>();
 
   if (!debug_options.xla_gpu_run_post_layout_collective_pipeliner()) {
@@ -937,6 +1012,17 @@ absl::Status RunCollectiveOptimizationPasses(
   }
   collectives_pipeline.AddPass<ReduceScatterCreator>();
 
+  // Split collectives spanning multiple nodes into intra-node and inter-node
+  // phases. This runs after ReduceScatterCreator, so that all-reduces feeding
+  // dynamic-slices are decomposed as reduce-scatters.
+  if (debug_options.xla_gpu_hierarchical_collectives_min_bytes() > 0) {
+    TF_ASSIGN_OR_RETURN(std::optional<GpuCollectiveTopology> topology,
+                        GpuCollectiveTopology::FromDebugOptions(debug_options));
+    collectives_pipeline.AddPass<HierarchicalCollectiveDecomposer>(
+        topology.value_or(GpuCollectiveTopology()).devices_per_node,
+        debug_options.xla_gpu_hierarchical_collectives_min_bytes());
+  }
+
   collectives_pipeline.AddPass<CollectivePermuteCycleDecomposer>(
       hlo_module->config()
           .debug_options()
@@ -1073,6 +1159,14 @@ void AddDoubleBufferingPasses(const DebugOptions& opts,
            "`xla_gpu_enable_while_loop_double_buffering` flag.";
     unroll_strategy = DoubleBufferLoopUnrolling::UnrollStrategy::kFullUnroll;
   }
+  if (opts.xla_gpu_enable_while_loop_unrolling() ==
+      DebugOptions::WHILE_LOOP_UNROLLING_PARTIAL_UNROLL) {
+    LOG_IF(WARNING, unroll_strategy != std::nullopt)
+        << "Overriding double buffering set via "
+           "`xla_gpu_enable_while_loop_double_buffering` flag.";
+    unroll_strategy =
+        DoubleBufferLoopUnrolling::UnrollStrategy::kPartialUnroll;
+  }
   if (opts.xla_gpu_enable_while_loop_unrolling() ==
           DebugOptions::WHILE_LOOP_UNROLLING_AUTO_UNROLL &&
       opts.xla_gpu_enable_heuristic_pass_configuration() &&
@@ -1087,23 +1181,69 @@ void AddDoubleBufferingPasses(const DebugOptions& opts,
   }
 }
 
+// Returns a combiner threshold for `opcode` collectives. If the collective
+// topology is known, and automatic combine thresholds are enabled or the
+// threshold is left at its default value, we derive the threshold from the
+// collective performance model.
+int64_t GetCombineThresholdBytes(
+    const HloModule& module, HloOpcode opcode, int64_t threshold_bytes,
+    int64_t default_threshold_bytes,
+    const std::optional<GpuCollectiveTopology>& topology) {
+  if (!topology.has_value()) return threshold_bytes;
+
+  const HloModuleConfig& config = module.config();
+  if (config.debug_options().xla_gpu_enable_auto_combine_threshold()) {
+    return SuggestModuleCombineThresholdBytes(
+        module, opcode, *topology, [](const Shape& shape) {
+          return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+        });
+  }
+
+  if (threshold_bytes != default_threshold_bytes) return threshold_bytes;
+
+  int64_t num_devices = config.replica_count() * config.num_partitions();
+  int64_t suggested_threshold_bytes =
+      SuggestCombineThresholdBytes(opcode, num_devices, *topology);
+  VLOG(1) << "Use " << HloOpcodeString(opcode) << " combine threshold of "
+          << suggested_threshold_bytes << " bytes for " << num_devices
+          << " devices on collective topology: " << topology->ToString();
+  return suggested_threshold_bytes;
+}
+
 absl::Status RunPostFusionPasses(
     HloModule* hlo_module,
     std::function<absl::Status(HloPassPipeline*, const DebugOptions&)>
         add_custom_kernel_replacement_passes) {
   const DebugOptions& opts = hlo_module->config().debug_options();
 
+  TF_ASSIGN_OR_RETURN(std::optional<GpuCollectiveTopology> topology,
+                      GpuCollectiveTopology::FromDebugOptions(opts));
+  if (opts.xla_gpu_enable_auto_combine_threshold() && !topology.has_value()) {
+    LOG(WARNING) << "Automatic combine thresholds require a collective "
+                    "topology (--xla_gpu_collective_topology), using fixed "
+                    "combine thresholds";
+  }
+
   HloPassPipeline pipeline("post-fusion optimization");
   pipeline.AddPass<RenameFusions>();
   pipeline.AddPass<AllGatherCombiner>(
-      opts.xla_gpu_all_gather_combine_threshold_bytes(),
+      GetCombineThresholdBytes(
+          *hlo_module, HloOpcode::kAllGather,
+          opts.xla_gpu_all_gather_combine_threshold_bytes(),
+          kDefaultAllGatherCombineThreshold, topology),
       /*combine_threshold_count=*/256,
       opts.xla_gpu_enable_all_gather_combine_by_dim());
   pipeline.AddPass<AllReduceCombiner>(
-      opts.xla_gpu_all_reduce_combine_threshold_bytes(),
+      GetCombineThresholdBytes(
+          *hlo_module, HloOpcode::kAllReduce,
+          opts.xla_gpu_all_reduce_combine_threshold_bytes(),
+          kDefaultAllReduceCombineThreshold, topology),
       /*combine_threshold_count=*/256);
   pipeline.AddPass<ReduceScatterCombiner>(
-      opts.xla_gpu_reduce_scatter_combine_threshold_bytes(),
+      GetCombineThresholdBytes(
+          *hlo_module, HloOpcode::kReduceScatter,
+          opts.xla_gpu_reduce_scatter_combine_threshold_bytes(),
+          kDefaultReduceScatterCombineThreshold, topology),
       /*combine_threshold_count=*/256,
       opts.xla_gpu_enable_reduce_scatter_combine_by_dim());
 
@@ -1509,6 +1649,20 @@ absl::Status GpuCompiler::OptimizeHloPostLayoutAssignment(
     const auto* cuda_cc = std::get_if<se::CudaComputeCapability>(&gpu_version);
     const auto* rocm_cc = std::get_if<se::RocmComputeCapability>(&gpu_version);
 
+    // Runs before the dots are rewritten individually. The attention patterns
+    // supported by cuDNN have already been turned into custom calls by
+    // CudnnFusedMHARewriter, so only the remaining ones are fused here.
+    if (debug_options.xla_gpu_enable_triton_attention() && cuda_cc != nullptr &&
+        cuda_cc->IsAtLeast(se::CudaComputeCapability::AMPERE)) {
+      pipeline.AddPass<TritonAttentionRewriter>();
+    }
+    if (debug_options.xla_gpu_enable_triton_grouped_gemm() &&
+        cuda_cc != nullptr &&
+        cuda_cc->IsAtLeast(se::CudaComputeCapability::AMPERE)) {
+      pipeline.AddPass<GroupedGemmFusion>(
+          gpu_target_config.device_description);
+    }
+
     if (debug_options.xla_gpu_enable_triton_gemm() &&
         (cuda_cc != nullptr &&
          cuda_cc->IsAtLeast(se::CudaComputeCapability::AMPERE))) {
@@ -1582,6 +1736,9 @@ absl::Status GpuCompiler::OptimizeHloPostLayoutAssignment(
   }
 
   HloPassPipeline pipeline("post-layout_assignment");
+  // CSE only rewrites the computation it runs on, so the computations of
+  // large modules can be processed concurrently.
+  pipeline.set_thread_pool(thread_pool, /*parallel_passes=*/{"cse"});
   AddHloVerifier(&pipeline, !debug_options.xla_experimental_ignore_channel_id(),
                  HloVerifierOpts{}
                      .MakeLayoutSensitive()
@@ -1612,6 +1769,31 @@ absl::Status GpuCompiler::OptimizeHloPostLayoutAssignment(
   pipeline.AddPass<HostOffloader>(
       static_cast<int64_t>(stream_executor::MemoryType::kHost));
 
+  if (debug_options.xla_gpu_enable_pipelined_host_offloading()) {
+    // Double buffer the reads of offloaded tensors in while loops: rotate
+    // host to device dynamic-slices into the previous iteration, so that the
+    // asynchronous transfer created by HostMemoryTransferAsyncifier for
+    // iteration i+1 overlaps with the compute of iteration i.
+    CollectivePipeliner::Config config{
+        /*level_to_operate_on=*/0,
+        /*max_pipelining_per_loop=*/INT64_MAX,
+        /*last_run=*/true,
+        /*pipeline_use_tree=*/false,
+        /*process_different_sized_ops=*/true,
+        /*pipelining_direction=*/
+        CollectivePipeliner::PipeliningDirection::kBackward,
+        /*should_process=*/host_offload_utils::IsHostToDeviceDynamicSlice,
+        /*acceptable_formatting=*/HloPredicateTrue,
+        /*reuse_pipelined_op_buffer=*/HloPredicateFalse,
+        /*should_allow_loop_variant_parameter_in_chain=*/HloPredicateFalse,
+        /*should_allow_control_dependencies=*/false,
+        /*postprocess_backward_peeled_op=*/std::nullopt,
+        /*postprocess_backward_rotated_op=*/std::nullopt,
+        /*should_add_loop_invariant_op_in_chain=*/true,
+    };
+    pipeline.AddPass<CollectivePipeliner>(config);
+  }
+
   TF_RETURN_IF_ERROR(
       AddConvAndGemmAutotuningPasses(&pipeline, gpu_version, options,
                                      hlo_module, autotune_config, thread_pool));
@@ -1639,7 +1821,8 @@ absl::Status GpuCompiler::OptimizeHloPostLayoutAssignment(
   pipeline.AddPass<HloCSE>(/*is_layout_sensitive=*/true);
 
   pipeline.AddPass<HostMemoryTransferAsyncifier>(
-      static_cast<int64_t>(stream_executor::MemoryType::kHost));
+      static_cast<int64_t>(stream_executor::MemoryType::kHost),
+      debug_options.xla_gpu_host_offload_max_slice_bytes());
 
 #ifdef NDEBUG
   // Verify the module in non-debug builds. For debug builds, the verifier
@@ -2068,24 +2251,29 @@ absl::StatusOr<GpuCompiler::BackendCompileResult> GpuCompiler::CompileAndLink(
     llvm_modules.reserve(num_modules);
   }
   int single_function_module_count = 0;
-  llvm::SplitModule(
-      *llvm_module, num_modules,
-      [&](std::unique_ptr<llvm::Module> module) {
-        // Change the linkage type of some global constant variables to internal
-        for (llvm::GlobalVariable& gv : module->globals()) {
-          if (gv.hasName() && gv.isConstant() && !gv.hasInitializer() &&
-              const_initializer_map.count(gv.getName()) != 0) {
-            gv.setInitializer(const_initializer_map[gv.getName()]);
-            gv.setLinkage(llvm::GlobalValue::InternalLinkage);
-          }
-        }
-        const std::string name = SingleFunctionName(*module);
-        if (!name.empty()) {
-          ++single_function_module_count;
-        }
-        llvm_modules.push_back({name, std::move(module)});
-      },
-      /*PreserveLocals=*/true, /*RoundRobin=*/true);
+  auto add_module = [&](std::unique_ptr<llvm::Module> module) {
+    // Change the linkage type of some global constant variables to internal
+    for (llvm::GlobalVariable& gv : module->globals()) {
+      if (gv.hasName() && gv.isConstant() && !gv.hasInitializer() &&
+          const_initializer_map.count(gv.getName()) != 0) {
+        gv.setInitializer(const_initializer_map[gv.getName()]);
+        gv.setLinkage(llvm::GlobalValue::InternalLinkage);
+      }
+    }
+    const std::string name = SingleFunctionName(*module);
+    if (!name.empty()) {
+      ++single_function_module_count;
+    }
+    llvm_modules.push_back({name, std::move(module)});
+  };
+  if (module_config.debug_options().xla_gpu_split_llvm_module_by_cost()) {
+    // The shards come in decreasing order of their estimated cost, so the
+    // thread pool below starts with the longest compilations.
+    SplitModuleByCost(*llvm_module, num_modules, add_module);
+  } else {
+    llvm::SplitModule(*llvm_module, num_modules, add_module,
+                      /*PreserveLocals=*/true, /*RoundRobin=*/true);
+  }
   VLOG(2) << "Single-function cacheable modules: "
           << single_function_module_count << " / " << llvm_modules.size();
 
@@ -2183,6 +2371,7 @@ absl::StatusOr<GpuCompiler::BackendCompileResult> GpuCompiler::CompileAndLink(
     if (!binaries_to_cache.empty()) {
       TF_RETURN_IF_ERROR(
           UpdateDiskKernelCache(resolved_path, /*do_append=*/cache_file_exists,
+                                GetKernelCacheTarget(gpu_version),
                                 current_cache, binaries_to_cache));
     }
   }
@@ -2467,6 +2656,13 @@ GpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
       target_config.has_value() ? target_config->device_description
                                 : options.executor()->GetDeviceDescription();
   for (const std::unique_ptr<HloModule>& module : modules) {
+    // The backend passes run in place, so every additional target starts from
+    // its own copy of the optimized module.
+    std::vector<std::unique_ptr<HloModule>> target_modules;
+    for (int i = 0; i < options.additional_target_configs().size(); ++i) {
+      target_modules.push_back(module->Clone(/*suffix=*/""));
+    }
+
     llvm::LLVMContext llvm_context;
     TF_ASSIGN_OR_RETURN(
         CompileResultWithMetadata res,
@@ -2475,11 +2671,53 @@ GpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
 
     // Create GpuThunkAotCompilationResult if thunk runtime is enabled.
     TF_ASSIGN_OR_RETURN(
-        results.emplace_back(),
+        std::unique_ptr<GpuThunkAotCompilationResult> result,
         GpuThunkAotCompilationResult::FromModule(
             module.get(), res.compile_module_results.buffer_assignment.get(),
             res.backend_result.asm_text, res.backend_result.binary,
             res.backend_result.dnn_compiled_graphs));
+
+    // The thunk sequence is re-emitted from the shared module and buffer
+    // assignment at load time, so an additional target can only be bundled if
+    // its backend passes produced the same module and allocations.
+    const std::string module_str = module->ToString();
+    for (int i = 0; i < target_modules.size(); ++i) {
+      const Compiler::TargetConfig& target =
+          options.additional_target_configs()[i];
+      HloModule* target_module = target_modules[i].get();
+      llvm::LLVMContext target_llvm_context;
+      TF_ASSIGN_OR_RETURN(
+          CompileResultWithMetadata target_res,
+          CompileToBackendResult(target_module, &target_llvm_context,
+                                 /*executor=*/nullptr,
+                                 {options.device_allocator()},
+                                 target.device_description));
+      const BufferAssignment& buffer_assignment =
+          *res.compile_module_results.buffer_assignment;
+      const BufferAssignment& target_buffer_assignment =
+          *target_res.compile_module_results.buffer_assignment;
+      bool compatible = target_module->ToString() == module_str &&
+                        target_buffer_assignment.Allocations().size() ==
+                            buffer_assignment.Allocations().size();
+      for (int j = 0; compatible && j < buffer_assignment.Allocations().size();
+           ++j) {
+        compatible = target_buffer_assignment.Allocations()[j].size() ==
+                     buffer_assignment.Allocations()[j].size();
+      }
+      if (!compatible) {
+        return FailedPrecondition(
+            "Module %s compiles to a different thunk sequence or buffer "
+            "assignment for target %s; compile it separately for that target.",
+            module->name(),
+            ComputeCapabilityToString(
+                target.device_description.gpu_compute_capability()));
+      }
+      result->AddTargetBinary(
+          target.device_description.gpu_compute_capability(),
+          target_res.backend_result.asm_text, target_res.backend_result.binary,
+          target_res.backend_result.dnn_compiled_graphs);
+    }
+    results.push_back(std::move(result));
   }
 
   return std::move(results);
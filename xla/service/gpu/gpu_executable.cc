@@ -27,6 +27,8 @@ limitations under the License.
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
@@ -37,6 +39,7 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "xla/debug_options_flags.h"
 #include "xla/executable_run_options.h"
 #include "xla/hlo/ir/hlo_input_output_alias_config.h"
 #include "xla/hlo/ir/hlo_instruction.h"
@@ -113,6 +116,15 @@ static absl::flat_hash_set<ExecutionStreamId> GetExecutionStreamIds(
   return stream_ids;
 }
 
+// GpuExecutables that may keep temp buffers alive across executions.
+static absl::Mutex persistent_temp_buffers_registry_mutex(absl::kConstInit);
+
+static absl::flat_hash_set<GpuExecutable*>& PersistentTempBuffersRegistry()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(persistent_temp_buffers_registry_mutex) {
+  static auto* registry = new absl::flat_hash_set<GpuExecutable*>();
+  return *registry;
+}
+
 absl::StatusOr<std::unique_ptr<GpuExecutable>> GpuExecutable::Create(
     Params params) {
   return std::unique_ptr<GpuExecutable>(new GpuExecutable(std::move(params)));
@@ -136,7 +148,11 @@ GpuExecutable::GpuExecutable(GpuExecutable::Params params)
           params.debug_buffer_assignment_show_max),
       constants_(std::move(params.constants)),
       output_info_(std::move(params.output_info)),
-      enable_debug_info_manager_(params.enable_debug_info_manager) {
+      enable_debug_info_manager_(params.enable_debug_info_manager),
+      enable_persistent_temp_buffers_(
+          has_module() && module_config()
+                              .debug_options()
+                              .xla_gpu_enable_persistent_temp_buffers()) {
 #if TENSORFLOW_USE_ROCM
   // ROCm uses hsaco hashes to distinguish between modules.
   // Bad things happen if multiple modules with identical code are loaded.
@@ -148,12 +164,20 @@ GpuExecutable::GpuExecutable(GpuExecutable::Params params)
     XlaDebugInfoManager::Get()->RegisterModule(shared_module(),
                                                buffer_assignment_->ToProto());
   }
+  if (enable_persistent_temp_buffers_) {
+    absl::MutexLock lock(&persistent_temp_buffers_registry_mutex);
+    PersistentTempBuffersRegistry().insert(this);
+  }
 }
 
 GpuExecutable::~GpuExecutable() {
   if (has_module() && enable_debug_info_manager_) {
     XlaDebugInfoManager::Get()->UnregisterModule(module().unique_id());
   }
+  if (enable_persistent_temp_buffers_) {
+    absl::MutexLock lock(&persistent_temp_buffers_registry_mutex);
+    PersistentTempBuffersRegistry().erase(this);
+  }
 }
 
 absl::Status GpuExecutable::CheckCompatibilityWithServiceExecutableRunOptions(
@@ -223,8 +247,12 @@ class ResourceRequests : public Thunk::ResourceRequests {
     return absl::OkStatus();
   }
 
+  // Acquires all requested cliques. If `parallel` is true, cliques of the same
+  // size that can't be created by splitting already acquired cliques are
+  // acquired concurrently, which hides the latency of NCCL communicator
+  // initialization when an executable uses many independent cliques.
   absl::StatusOr<Thunk::CollectiveCliques> AcquireCollectiveCliques(
-      const Thunk::CollectiveExecuteParams& params) {
+      const Thunk::CollectiveExecuteParams& params, bool parallel = false) {
     if (cliques_.empty()) return Thunk::CollectiveCliques();
 
     VLOG(2) << "Acquire " << cliques_.size()
@@ -233,7 +261,8 @@ class ResourceRequests : public Thunk::ResourceRequests {
             << "; run_id=" << params.run_id.ToInt()
             << "; max number of channels for collectives "
             << params.collective_max_nchannels
-            << "; max number of channels for p2p " << params.p2p_max_nchannels;
+            << "; max number of channels for p2p " << params.p2p_max_nchannels
+            << "; parallel=" << parallel;
 
     std::vector<CliqueRequest> ordered_cliques = GetOrderedCliqueRequests();
     for (size_t i = 0; i < ordered_cliques.size(); ++i) {
@@ -253,30 +282,30 @@ class ResourceRequests : public Thunk::ResourceRequests {
 
     NcclClique::AcquiredCliquesMap cliques_map;
 
-    for (const CliqueRequest& r : ordered_cliques) {
-      std::optional<int64_t> rank = r.key.rank(params.global_device_id);
+    // Cliques are ordered by size, so a clique can be split only from cliques
+    // acquired in one of the previous groups of larger (or same) size.
+    for (size_t begin = 0; begin < ordered_cliques.size();) {
+      size_t end = begin + 1;
+      while (end < ordered_cliques.size() &&
+             ordered_cliques[end].key.devices().size() ==
+                 ordered_cliques[begin].key.devices().size()) {
+        ++end;
+      }
+
+      absl::Span<const CliqueRequest> group =
+          absl::MakeSpan(ordered_cliques).subspan(begin, end - begin);
 
-      if (!rank.has_value()) {
-        return absl::InternalError(absl::StrCat(
-            "Can't find global device id ", params.global_device_id.value(),
-            " in clique key ", r.key.ToString()));
+      if (parallel && group.size() > 1 && !CanSplitAny(group, cliques_map)) {
+        TF_RETURN_IF_ERROR(AcquireInParallel(params, group, cliques_map));
+      } else {
+        for (const CliqueRequest& r : group) {
+          TF_ASSIGN_OR_RETURN(std::shared_ptr<NcclClique::Lock> clique,
+                              Acquire(params, r, cliques_map));
+          cliques_map[r.key] = std::move(clique);
+        }
       }
 
-      bool is_local = r.key.devices().size() == r.num_local_participants;
-      TF_ASSIGN_OR_RETURN(
-          const NcclCliqueIdCallback* clique_id_callback,
-          GetNcclCliqueIdCallback(params.nccl_clique_id_callback, is_local));
-
-      int64_t max_channels = r.key.stream_kind() == AsyncStreamKind::kCollective
-                                 ? params.collective_max_nchannels
-                                 : params.p2p_max_nchannels;
-      TF_ASSIGN_OR_RETURN(std::shared_ptr<NcclClique::Lock> clique,
-                          AcquireNcclClique(params.executor, params.run_id,
-                                            r.key, *clique_id_callback, *rank,
-                                            r.num_local_participants,
-                                            cliques_map, max_channels));
-
-      cliques_map[r.key] = std::move(clique);
+      begin = end;
     }
 
     auto end_micros = tsl::Env::Default()->NowMicros();
@@ -296,6 +325,80 @@ class ResourceRequests : public Thunk::ResourceRequests {
     int64_t id;
   };
 
+  static absl::StatusOr<std::shared_ptr<NcclClique::Lock>> Acquire(
+      const Thunk::CollectiveExecuteParams& params, const CliqueRequest& r,
+      const NcclClique::AcquiredCliquesMap& acquired_cliques) {
+    std::optional<int64_t> rank = r.key.rank(params.global_device_id);
+
+    if (!rank.has_value()) {
+      return absl::InternalError(absl::StrCat(
+          "Can't find global device id ", params.global_device_id.value(),
+          " in clique key ", r.key.ToString()));
+    }
+
+    bool is_local = r.key.devices().size() == r.num_local_participants;
+    TF_ASSIGN_OR_RETURN(
+        const NcclCliqueIdCallback* clique_id_callback,
+        GetNcclCliqueIdCallback(params.nccl_clique_id_callback, is_local));
+
+    int64_t max_channels = r.key.stream_kind() == AsyncStreamKind::kCollective
+                               ? params.collective_max_nchannels
+                               : params.p2p_max_nchannels;
+    return AcquireNcclClique(params.executor, params.run_id, r.key,
+                             *clique_id_callback, *rank,
+                             r.num_local_participants, acquired_cliques,
+                             max_channels);
+  }
+
+  // Returns true if any of the cliques in the `group` might be acquired by
+  // splitting an already acquired clique (including the cliques that come
+  // earlier in the same group). Communicator splitting is a collective
+  // operation on the parent communicator, and all ranks must split it in the
+  // same order, so such groups must be acquired sequentially.
+  static bool CanSplitAny(absl::Span<const CliqueRequest> group,
+                          const NcclClique::AcquiredCliquesMap& acquired) {
+    if (!GetDebugOptionsFromFlags().xla_gpu_enable_nccl_comm_splitting()) {
+      return false;
+    }
+    for (size_t i = 0; i < group.size(); ++i) {
+      for (const auto& [key, _] : acquired) {
+        if (group[i].key.IsSubsetOf(key)) return true;
+      }
+      for (size_t j = 0; j < i; ++j) {
+        if (group[i].key.IsSubsetOf(group[j].key)) return true;
+      }
+    }
+    return false;
+  }
+
+  // Acquires all cliques in the `group` concurrently. Cliques in the group are
+  // independent, and each clique does its own rendezvous with all of its
+  // participants, so the acquisition order doesn't matter.
+  static absl::Status AcquireInParallel(
+      const Thunk::CollectiveExecuteParams& params,
+      absl::Span<const CliqueRequest> group,
+      NcclClique::AcquiredCliquesMap& cliques_map) {
+    std::vector<absl::StatusOr<std::shared_ptr<NcclClique::Lock>>> results(
+        group.size());
+
+    {
+      std::vector<std::unique_ptr<tsl::Thread>> threads;
+      threads.reserve(group.size() - 1);
+      for (size_t i = 1; i < group.size(); ++i) {
+        threads.emplace_back(tsl::Env::Default()->StartThread(
+            tsl::ThreadOptions(), "xla_acquire_nccl_clique", [&, i] {
+              results[i] = Acquire(params, group[i], cliques_map);
+            }));
+      }
+      results[0] = Acquire(params, group[0], cliques_map);
+    }  // Joins all threads.
+
+    for (size_t i = 0; i < group.size(); ++i) {
+      TF_ASSIGN_OR_RETURN(cliques_map[group[i].key], std::move(results[i]));
+    }
+    return absl::OkStatus();
+  }
+
   // Return clique requests deterministically ordered using a comparison
   // function that produces identical ordering for all participating ranks.
   //
@@ -365,6 +468,10 @@ absl::Status ExecuteThunks(
       debug_options
           ? debug_options->xla_gpu_enable_highest_priority_async_stream()
           : false;
+  bool parallel_clique_acquisition =
+      debug_options
+          ? debug_options->xla_gpu_enable_parallel_nccl_clique_acquisition()
+          : false;
 
   se::Stream* main_stream = run_options->stream();
   se::StreamExecutor* executor = main_stream->parent();
@@ -445,7 +552,8 @@ absl::Status ExecuteThunks(
   if (!mock_collectives) {
     TF_ASSIGN_OR_RETURN(
         collective_cliques,
-        resource_requests.AcquireCollectiveCliques(collective_params));
+        resource_requests.AcquireCollectiveCliques(
+            collective_params, parallel_clique_acquisition));
   }
 
   {  // Initialize thunks using prepared resources before execution.
@@ -761,10 +869,50 @@ static absl::Status CheckAlignment(const BufferAllocation& allocation,
   return absl::OkStatus();
 }
 
+absl::StatusOr<se::DeviceMemoryBase> GpuExecutable::PersistentTempBuffer(
+    se::Stream* stream, const BufferAllocation& allocation,
+    se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal) {
+  if (allocation.size() == 0) {
+    return se::DeviceMemoryBase();
+  }
+  absl::MutexLock lock(&persistent_temp_buffers_mutex_);
+  se::OwningDeviceMemory& buffer =
+      persistent_temp_buffers_[{stream, allocation.index()}];
+  if (buffer.is_null() || buffer.allocator() != memory_allocator ||
+      buffer.device_ordinal() != device_ordinal) {
+    // Free the stale buffer first so that its memory can be reused.
+    buffer = se::OwningDeviceMemory();
+    TF_ASSIGN_OR_RETURN(
+        buffer, memory_allocator->Allocate(device_ordinal, allocation.size(),
+                                           /*retry_on_failure=*/true,
+                                           /*memory_space=*/allocation.color()));
+  }
+  return buffer.cref();
+}
+
+bool GpuExecutable::ReleasePersistentTempBuffers(
+    const GpuExecutable* executable, se::Stream* stream) {
+  bool released = false;
+  absl::MutexLock registry_lock(&persistent_temp_buffers_registry_mutex);
+  for (GpuExecutable* other : PersistentTempBuffersRegistry()) {
+    absl::MutexLock lock(&other->persistent_temp_buffers_mutex_);
+    absl::erase_if(other->persistent_temp_buffers_, [&](const auto& entry) {
+      if (other == executable && entry.first.first == stream) return false;
+      released |= !entry.second.is_null();
+      return true;
+    });
+  }
+  if (released) {
+    VLOG(1) << "Released persistent temp buffers after running out of memory";
+  }
+  return released;
+}
+
 absl::StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
     VariantArguments arguments,
     const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
-    se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal) {
+    se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
+    se::Stream* persistent_temp_stream) {
   tsl::profiler::TraceMe hlo_module_activity(
       [&] { return std::string("Build buffer allocations"); },
       tsl::profiler::TraceMeLevel::kInfo);
@@ -775,10 +923,22 @@ absl::StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
   buffers.reserve(num_buffers);
   for (int64_t i = 0; i < num_buffers; ++i) {
     const BufferAllocation& allocation = allocations[i];
-    TF_ASSIGN_OR_RETURN(
-        buffers.emplace_back(),
-        BufferForAllocation(arguments, globals, allocations[i],
-                            memory_allocator, device_ordinal, i));
+    auto buffer_for_allocation = [&]() -> absl::StatusOr<se::DeviceMemoryBase> {
+      if (persistent_temp_stream && allocation.IsPreallocatedTempBuffer()) {
+        return PersistentTempBuffer(persistent_temp_stream, allocation,
+                                    memory_allocator, device_ordinal);
+      }
+      return BufferForAllocation(arguments, globals, allocation,
+                                 memory_allocator, device_ordinal, i);
+    };
+    absl::StatusOr<se::DeviceMemoryBase> buffer = buffer_for_allocation();
+    // Persistent temp buffers are only kept as long as there is no memory
+    // pressure: release them and try again if we ran out of memory.
+    if (persistent_temp_stream && absl::IsResourceExhausted(buffer.status()) &&
+        ReleasePersistentTempBuffers(this, persistent_temp_stream)) {
+      buffer = buffer_for_allocation();
+    }
+    TF_ASSIGN_OR_RETURN(buffers.emplace_back(), std::move(buffer));
     TF_RETURN_IF_ERROR(CheckAlignment(allocation, buffers.back(), i));
   }
   return {{buffers, device_ordinal, memory_allocator}};
@@ -850,10 +1010,12 @@ absl::StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   ExecutionOutput result(/*on_device_shape=*/output_shape_, memory_allocator,
                          device_ordinal, executor->device_ordinal());
 
+  se::Stream* persistent_temp_stream =
+      enable_persistent_temp_buffers_ ? run_options->stream() : nullptr;
   TF_ASSIGN_OR_RETURN(
       BufferAllocations buffer_allocations,
       GenerateBufferAllocations(arguments, globals, memory_allocator,
-                                device_ordinal));
+                                device_ordinal, persistent_temp_stream));
   VLOG(3) << buffer_allocations.ToString();
   absl::Span<const BufferAllocation> allocations = GetAllocations();
 
@@ -1014,6 +1176,16 @@ absl::StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
         block_host_until_done, execution_stream_ids_));
   }
 
+  // Persistent temp buffers stay alive for the next execution on this stream.
+  if (persistent_temp_stream != nullptr) {
+    for (const BufferAllocation& allocation : allocations) {
+      if (allocation.IsPreallocatedTempBuffer()) {
+        buffers_in_result.insert(
+            buffer_allocations.GetDeviceAddress(allocation.index()));
+      }
+    }
+  }
+
   TF_RETURN_IF_ERROR(
       buffer_allocations.TearDown(buffers_in_result, GetAllocations()));
 
@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -49,6 +50,7 @@ limitations under the License.
 #include "xla/stream_executor/device_memory.h"
 #include "xla/stream_executor/device_memory_allocator.h"
 #include "xla/stream_executor/scoped_module_handle.h"
+#include "xla/stream_executor/stream.h"
 #include "xla/stream_executor/stream_executor.h"
 
 namespace xla {
@@ -194,10 +196,13 @@ class GpuExecutable : public Executable {
   absl::Status CheckCompatibilityWithServiceExecutableRunOptions(
       const ServiceExecutableRunOptions* run_options);
 
+  // Allocates device memory for all allocations. If `persistent_temp_stream`
+  // is not null, temp buffers are kept alive across executions on it.
   absl::StatusOr<BufferAllocations> GenerateBufferAllocations(
       VariantArguments arguments,
       const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
-      se::DeviceMemoryAllocator* memory_allocator, int device_ordinal);
+      se::DeviceMemoryAllocator* memory_allocator, int device_ordinal,
+      se::Stream* persistent_temp_stream);
 
   absl::StatusOr<se::DeviceMemoryBase> BufferForAllocation(
       VariantArguments arguments,
@@ -206,6 +211,18 @@ class GpuExecutable : public Executable {
       se::DeviceMemoryAllocator* memory_allocator, int device_ordinal,
       int64_t arg_idx);
 
+  // Returns the temp buffer for `allocation` that is kept alive across
+  // executions on `stream`, allocating it on first use.
+  absl::StatusOr<se::DeviceMemoryBase> PersistentTempBuffer(
+      se::Stream* stream, const BufferAllocation& allocation,
+      se::DeviceMemoryAllocator* memory_allocator, int device_ordinal);
+
+  // Releases the persistent temp buffers of all executables, except the ones
+  // `executable` uses on `stream`, which may be in use by the execution that
+  // ran out of memory. Returns true if any buffer was released.
+  static bool ReleasePersistentTempBuffers(const GpuExecutable* executable,
+                                           se::Stream* stream);
+
   // The LLVM IR, in string format, of the unoptimized module generated for
   // this GpuExecutable. We save a string instead of an llvm::Module* because
   // leaving llvm::Module* in a singleton can cause the heap checker to emit
@@ -283,6 +300,14 @@ class GpuExecutable : public Executable {
   std::vector<std::shared_ptr<se::DeviceMemoryBase>> shared_constants_;
   bool enable_debug_info_manager_;
 
+  // If true, temp buffers are kept alive across executions on the same stream
+  // (see xla_gpu_enable_persistent_temp_buffers).
+  const bool enable_persistent_temp_buffers_;
+  absl::Mutex persistent_temp_buffers_mutex_;
+  absl::flat_hash_map<std::pair<se::Stream*, BufferAllocation::Index>,
+                      se::OwningDeviceMemory>
+      persistent_temp_buffers_ ABSL_GUARDED_BY(persistent_temp_buffers_mutex_);
+
   GpuExecutable(const GpuExecutable&) = delete;
   GpuExecutable& operator=(const GpuExecutable&) = delete;
 };
@@ -756,7 +756,8 @@ FusionDecision FusionFitsInBudget(const HloInstruction& instr1,
                                   const HloInstruction& instr2,
                                   const se::DeviceDescription& device_info,
                                   bool is_consumer_producer_fusion,
-                                  FusionInfoCache* cache /*=nullptr*/) {
+                                  FusionInfoCache* cache /*=nullptr*/,
+                                  bool enforce_reduction_limit /*=true*/) {
   if (SharedMemoryUsage(instr1, cache) + SharedMemoryUsage(instr2, cache) >
       device_info.shared_memory_per_block()) {
     return FusionDecision::Forbid(
@@ -764,9 +765,10 @@ FusionDecision FusionFitsInBudget(const HloInstruction& instr1,
            << device_info.shared_memory_per_block() << "B";
   }
 
-  if (NumUnnestedReductions(instr1, cache) +
-          NumUnnestedReductions(instr2, cache) >
-      kMaxUnnestedReductionOutputsPerFusion) {
+  if (enforce_reduction_limit &&
+      NumUnnestedReductions(instr1, cache) +
+              NumUnnestedReductions(instr2, cache) >
+          kMaxUnnestedReductionOutputsPerFusion) {
     return FusionDecision::Forbid("over ")
            << kMaxUnnestedReductionOutputsPerFusion
            << " unnested reductions in fusion";
@@ -48,6 +48,7 @@ limitations under the License.
 #include "xla/service/gpu/backend_configs.pb.h"
 #include "xla/service/gpu/gpu_latency_hiding_scheduler.h"
 #include "xla/service/gpu/model/analytical_latency_estimator.h"
+#include "xla/service/gpu/model/gpu_collective_topology.h"
 #include "xla/service/gpu/transforms/pgle_accuracy_checker.h"
 #include "xla/service/gpu/transforms/schedule_postprocessing.h"
 #include "xla/service/gpu/transforms/scheduling_instruction_annotator.h"
@@ -457,8 +458,14 @@ absl::StatusOr<ScheduleMetadata> ScheduleGpuModule(
   }
 
   SchedulerConfig config = GetSchedulerConfig(memory_limit);
-  auto gpu_latency_estimator =
-      std::make_unique<GpuLatencyEstimator>(pointer_size);
+  TF_ASSIGN_OR_RETURN(std::optional<GpuCollectiveTopology> topology,
+                      GpuCollectiveTopology::FromDebugOptions(
+                          module->config().debug_options()));
+  if (topology.has_value()) {
+    VLOG(1) << "Using collective topology: " << topology->ToString();
+  }
+  auto gpu_latency_estimator = std::make_unique<GpuLatencyEstimator>(
+      pointer_size, GpuGetCanonicalAsyncOp, topology);
 
   std::unique_ptr<LatencyEstimator> latency_estimator;
   std::optional<tensorflow::profiler::ProfiledInstructionsProto> profile =
@@ -488,7 +495,7 @@ absl::StatusOr<ScheduleMetadata> ScheduleGpuModule(
         [input_pointer_size = pointer_size](const Shape& shape) {
           return GetSizeOfShape(shape, input_pointer_size);
         },
-        module->entry_computation());
+        module->entry_computation(), topology);
     LOG(INFO) << "Using analytical latency estimator";
   } else {
     latency_estimator = std::move(gpu_latency_estimator);
@@ -16,18 +16,21 @@ limitations under the License.
 #include "xla/service/gpu/gpu_latency_hiding_scheduler.h"
 
 #include <cstdint>
+#include <optional>
 #include <tuple>
 #include <utility>
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/hlo/utils/hlo_query.h"
 #include "xla/service/collective_ops_utils.h"
 #include "xla/service/gpu/backend_configs.pb.h"
 #include "xla/service/gpu/cublas_cudnn.h"
+#include "xla/service/gpu/model/gpu_collective_topology.h"
 #include "xla/service/latency_hiding_scheduler.h"
 #include "xla/shape.h"
 #include "xla/shape_util.h"
@@ -43,6 +46,25 @@ static constexpr int64_t kCostlyAllReduceThreshold = 30 * 1024 * 1024;
 // Multiplier which we apply to expand the base cost for the costly AR.
 static constexpr int64_t kCostlyAllReduceMultiplier = 4;
 
+// Returns true if collective `instr` is estimated to be slower on `topology`
+// than an intra-node all-reduce of `kCostlyAllReduceThreshold` bytes. Returns
+// nullopt if we can't estimate the collective.
+std::optional<bool> IsCostlyOnTopology(const HloInstruction& instr,
+                                       const GpuCollectiveTopology& topology,
+                                       int64_t pointer_size) {
+  auto shape_size = [&](const Shape& shape) {
+    return GetSizeOfShape(shape, pointer_size);
+  };
+  std::optional<absl::Duration> time =
+      EstimateCollectiveTime(instr, topology, shape_size);
+  if (!time.has_value()) return std::nullopt;
+
+  std::optional<absl::Duration> costly_time =
+      EstimateCollectiveTime(HloOpcode::kAllReduce, kCostlyAllReduceThreshold,
+                             topology.devices_per_node, topology);
+  return *time > *costly_time;
+}
+
 // Classifies `hlo` instruction as noop or not.
 bool IsNopInstruction(const HloInstruction& hlo) {
   HloOpcode op = hlo.opcode();
@@ -328,9 +350,12 @@ int64_t GpuAsyncTracker::GetNumResourcesPerInstruction(
 //===--------------------------------------------------------------------===//
 // GpuLatencyEstimator
 //===--------------------------------------------------------------------===//
-GpuLatencyEstimator::GpuLatencyEstimator(int64_t pointer_size,
-                                         GetCanonicalAsyncOpFunc func)
-    : ApproximateLatencyEstimator(func), pointer_size_(pointer_size) {}
+GpuLatencyEstimator::GpuLatencyEstimator(
+    int64_t pointer_size, GetCanonicalAsyncOpFunc func,
+    std::optional<GpuCollectiveTopology> topology)
+    : ApproximateLatencyEstimator(func),
+      pointer_size_(pointer_size),
+      topology_(std::move(topology)) {}
 
 ApproximateLatencyEstimator::TimeCost GpuLatencyEstimator::NodeCost(
     const HloInstruction* instr) const {
@@ -363,6 +388,16 @@ ApproximateLatencyEstimator::TimeCost GpuLatencyEstimator::GetLatencyBetween(
       return ApproximateLatencyEstimator::kHighLatency * 10;
     }
 
+    if (topology_.has_value()) {
+      std::optional<bool> is_costly =
+          IsCostlyOnTopology(from.GetInstr(), *topology_, pointer_size_);
+      if (is_costly.has_value()) {
+        return *is_costly ? ApproximateLatencyEstimator::kHighLatency *
+                                kCostlyAllReduceMultiplier
+                          : ApproximateLatencyEstimator::kHighLatency;
+      }
+    }
+
     bool enable_approx_collectives =
         from.GetInstr()
             .GetModule()
@@ -17,9 +17,11 @@ limitations under the License.
 #define XLA_SERVICE_GPU_GPU_LATENCY_HIDING_SCHEDULER_H_
 
 #include <cstdint>
+#include <optional>
 
 #include "absl/strings/string_view.h"
 #include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/service/gpu/model/gpu_collective_topology.h"
 #include "xla/service/latency_hiding_scheduler.h"
 #include "xla/service/profile_guided_latency_estimator.h"
 #include "xla/shape.h"
@@ -101,12 +103,16 @@ class GpuAsyncTracker : public GpuAsyncTrackerBase {
 };
 
 // GPU approximate latency estimator. It is a set of hardcoded heuristics
-// for every instruction and async instruction pairs.
+// for every instruction and async instruction pairs. If collective `topology`
+// is known, all-reduce, all-gather and reduce-scatter are considered costly
+// when they are estimated to be slower on the topology than a large
+// intra-node all-reduce.
 class GpuLatencyEstimator : public ApproximateLatencyEstimator {
  public:
   explicit GpuLatencyEstimator(
       int64_t pointer_size,
-      GetCanonicalAsyncOpFunc func = GpuGetCanonicalAsyncOp);
+      GetCanonicalAsyncOpFunc func = GpuGetCanonicalAsyncOp,
+      std::optional<GpuCollectiveTopology> topology = std::nullopt);
 
   // Uses the approximate node for an instruction `instr`.
   TimeCost NodeCost(const HloInstruction* instr) const override;
@@ -117,6 +123,7 @@ class GpuLatencyEstimator : public ApproximateLatencyEstimator {
 
  private:
   int64_t pointer_size_;
+  std::optional<GpuCollectiveTopology> topology_;
 };
 
 // GPU PGLE statistics tracker.
@@ -26,6 +26,7 @@ limitations under the license, the license you must see.
 #include "cub/device/device_scan.cuh"
 #include "cub/device/device_segmented_radix_sort.cuh"
 #include "cub/device/device_segmented_reduce.cuh"
+#include "cub/device/device_segmented_sort.cuh"
 #include "cub/device/device_select.cuh"
 #include "cub/iterator/counting_input_iterator.cuh"
 #include "cub/iterator/transform_input_iterator.cuh"
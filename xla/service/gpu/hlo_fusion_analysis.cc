@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/service/gpu/hlo_fusion_analysis.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -70,11 +71,16 @@ bool AllSliceInputsAreCompatible(
 // A root is compatible with the transpose hero if:
 //   * Either the root has a traspose hero with the same normalized dimensions
 //   * Or the root output shape is equal to the the transpose input shape
+//
+// The shared memory tiles of all transpose heroes also have to fit into the
+// shared memory of a block on `device_info`.
 std::optional<TransposeDescription> FindConsistentTransposeHero(
     const absl::InlinedVector<HloInstructionAdaptor, 2>& hlo_roots,
-    const absl::InlinedVector<HloInstructionAdaptor, 2>& heroes) {
+    const absl::InlinedVector<HloInstructionAdaptor, 2>& heroes,
+    const se::DeviceDescription* device_info) {
   std::optional<TransposeDescription> tiled_transpose_hero;
   std::vector<const HloInstruction*> non_transpose_roots;
+  int64_t shmem_usage = 0;
 
   for (auto [root, hero] : llvm::zip(hlo_roots, heroes)) {
     if (auto tr = GetDescriptionForTiledTransposeEmitter(hero.instruction())) {
@@ -85,6 +91,7 @@ std::optional<TransposeDescription> FindConsistentTransposeHero(
         // Transpose heroes have different shape.
         return std::nullopt;
       }
+      shmem_usage += GetTransposeTileSharedMemoryBytes(*tr);
     } else {
       non_transpose_roots.push_back(&root.instruction());
     }
@@ -92,6 +99,11 @@ std::optional<TransposeDescription> FindConsistentTransposeHero(
 
   if (!tiled_transpose_hero) return std::nullopt;
 
+  if (device_info != nullptr &&
+      shmem_usage > device_info->shared_memory_per_block()) {
+    return std::nullopt;
+  }
+
   for (auto* root : non_transpose_roots) {
     // Roots that don't have a transpose hero, should have a shape compatible
     // with the transpose input.
@@ -161,7 +173,7 @@ HloFusionAnalysis HloFusionAnalysis::Create(
   };
 
   std::optional<TransposeDescription> tiled_transpose_hero =
-      FindConsistentTransposeHero(roots, heroes);
+      FindConsistentTransposeHero(roots, heroes, device_info);
 
   return HloFusionAnalysis(std::move(backend_config), std::move(fusion),
                            std::move(roots), std::move(heroes), device_info,
@@ -233,7 +245,9 @@ HloFusionAnalysis::EmitterFusionKind HloFusionAnalysis::GetEmitterFusionKind()
   }
 
   if (fusion_backend_config_.kind() == kTritonFusionKind ||
-      fusion_backend_config_.kind() == kTritonGemmFusionKind) {
+      fusion_backend_config_.kind() == kTritonGemmFusionKind ||
+      fusion_backend_config_.kind() == kTritonAttentionFusionKind ||
+      fusion_backend_config_.kind() == kTritonGroupedGemmFusionKind) {
     return EmitterFusionKind::kTriton;
   }
 
@@ -60,6 +60,46 @@ TEST_F(HloFusionAnalysisTest, DoesNotPeekOutsideBoundary) {
             HloFusionAnalysis::EmitterFusionKind::kReduction);
 }
 
+TEST_F(HloFusionAnalysisTest, TransposeTilesExceedSharedMemory) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+    HloModule test_module
+
+    fused_computation {
+      %p0 = f32[32,48,8] parameter(0)
+      %p1 = f32[32,48,8] parameter(1)
+      %t0 = f32[48,32,8] transpose(%p0), dimensions={1,0,2}
+      %t1 = f32[48,32,8] transpose(%p1), dimensions={1,0,2}
+      ROOT %tuple = (f32[48,32,8], f32[48,32,8]) tuple(%t0, %t1)
+    }
+
+    ENTRY main {
+      %p0 = f32[32,48,8] parameter(0)
+      %p1 = f32[32,48,8] parameter(1)
+      ROOT %fusion = (f32[48,32,8], f32[48,32,8]) fusion(%p0, %p1),
+        kind=kInput, calls=fused_computation
+    })"));
+  module->mutable_config()
+      .mutable_debug_options()
+      .set_xla_gpu_mlir_emitter_level(3);
+
+  auto device_info = TestGpuDeviceInfo::RTXA6000DeviceInfo();
+
+  auto* root = module->entry_computation()->root_instruction();
+  auto single_transpose_analysis = HloFusionAnalysis::Create(
+      FusionBackendConfig::default_instance(),
+      HloFusionAdaptor::ForInstruction(
+          root->fused_instructions_computation()->GetInstructionWithName(
+              "t0")),
+      &device_info);
+  EXPECT_EQ(single_transpose_analysis.GetEmitterFusionKind(),
+            HloFusionAnalysis::EmitterFusionKind::kTranspose);
+
+  // Both 32x33 tiles of 32 byte elements do not fit into shared memory.
+  auto analysis = HloFusionAnalysis::Create(*root, device_info);
+  EXPECT_EQ(analysis.GetEmitterFusionKind(),
+            HloFusionAnalysis::EmitterFusionKind::kLoop);
+}
+
 TEST_F(HloFusionAnalysisTest, ReductionWithMultipleUsers) {
   TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
     HloModule test_module
@@ -598,6 +598,16 @@ std::optional<TransposeDescription> GetDescriptionForTiledTransposeEmitter(
   return std::nullopt;
 }
 
+int64_t GetTransposeTileSharedMemoryBytes(
+    const TransposeDescription& transpose) {
+  int64_t element_bytes =
+      primitive_util::ByteWidth(transpose.instr->shape().element_type());
+  if (transpose.permutation.back() == transpose.dimensions.size() - 1) {
+    element_bytes *= transpose.dimensions.back();
+  }
+  return WarpSize() * (WarpSize() + 1) * element_bytes;
+}
+
 bool IsIntermediate(const HloInstruction* instr, int allowed_operand_count) {
   // Number of operands should be in range [1, allowed_operand_count].
   if (instr->operand_count() == 0 ||
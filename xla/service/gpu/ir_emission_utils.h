@@ -57,8 +57,9 @@ inline constexpr int64_t kMinDimensionToTransposeTiled2 = 8;
 inline constexpr int64_t kMinTotalDimensionsToTransposeTiled = 64 * 128;
 // As the amount of shared memory is limited, we need to make sure that we don't
 // detect 102 transposes that would require too much bytes for the most minor
-// dimension.
-inline constexpr int64_t kMaxBytesInMostMinorDimension = 8;
+// dimension. Below one 32-byte memory sector, the untiled accesses to the most
+// minor dimension are not coalesced.
+inline constexpr int64_t kMaxBytesInMostMinorDimension = 32;
 
 // Matrix multiplication before the rewrite.
 bool IsMatrixMultiplication(const HloInstruction& dot);
@@ -78,6 +79,17 @@ inline constexpr absl::string_view kTritonFusionKind = "__triton";
 // Fusions that use Triton have FusionBackendConfig.kind equal to this string.
 inline constexpr absl::string_view kTritonGemmFusionKind = "__triton_gemm";
 
+// Fusions of an attention pattern (dot, softmax, dot) emitted as a flash
+// attention kernel with Triton have FusionBackendConfig.kind equal to this
+// string.
+inline constexpr absl::string_view kTritonAttentionFusionKind =
+    "__triton_attention";
+
+// Fusions of independent dots computed by a single Triton kernel have
+// FusionBackendConfig.kind equal to this string.
+inline constexpr absl::string_view kTritonGroupedGemmFusionKind =
+    "__triton_grouped_gemm";
+
 inline constexpr absl::string_view kCuDnnFusionKind = "__cudnn$fusion";
 
 inline constexpr absl::string_view kUncompilableFusion =
@@ -192,6 +204,12 @@ struct TransposeDescription {
 std::optional<TransposeDescription> GetDescriptionForTiledTransposeEmitter(
     const HloInstruction& hero);
 
+// Returns the number of bytes of shared memory that the tiled transpose emitter
+// uses for the tile of `transpose`. If the most minor dimension is not
+// transposed, it is part of every element of the tile.
+int64_t GetTransposeTileSharedMemoryBytes(
+    const TransposeDescription& transpose);
+
 // Checks if the instruction is elementwise.
 bool IsIntermediate(const HloInstruction* instr, int allowed_operand_count = 1);
 
@@ -115,13 +115,36 @@ ENTRY entry {
   EXPECT_EQ(result->permutation, InlinedVector({1, 0, 2}));
 }
 
+TEST_F(IrEmissionUtilsTest, FindTiledLogical102TransposeOneSector) {
+  const char* hlo = R"(
+HloModule module
+
+ENTRY entry {
+  p = f32[32,48,8]{2,1,0} parameter(0)
+  ROOT t = f32[48,32,8]{2,1,0} transpose(p), dimensions={1,0,2}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo));
+  auto& debug_options = module->mutable_config().mutable_debug_options();
+  debug_options.set_xla_gpu_mlir_emitter_level(3);
+
+  HloInstruction* tr = module->entry_computation()->root_instruction();
+
+  auto result = GetDescriptionForTiledTransposeEmitter(*tr);
+  EXPECT_TRUE(result.has_value());
+  EXPECT_EQ(result->dimensions, InlinedVector({48, 32, 8}));
+  EXPECT_EQ(result->permutation, InlinedVector({1, 0, 2}));
+  EXPECT_EQ(GetTransposeTileSharedMemoryBytes(*result), 32 * 33 * 4 * 8);
+}
+
 TEST_F(IrEmissionUtilsTest, FindTiledLogical102TransposeTooMuchMemoryRequired) {
   const char* hlo = R"(
 HloModule module
 
 ENTRY entry {
-  p = s8[32,48,9]{2,1,0} parameter(0)
-  ROOT t = s8[48,32,9]{2,1,0} transpose(p), dimensions={1,0,2}
+  p = s8[32,48,33]{2,1,0} parameter(0)
+  ROOT t = s8[48,32,33]{2,1,0} transpose(p), dimensions={1,0,2}
 }
 )";
   TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
@@ -25,6 +25,7 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -565,11 +566,13 @@ absl::Status IrEmitterUnnested::EmitCommandBufferThunk(
 
   // Maybe serialize all commands in a sequence by forcing barriers between all
   // recorded commands. This guarantees that we execute all device operations
-  // in the exact same order as a thunk sequence.
+  // in the exact same order as a thunk sequence. Otherwise we add dependency
+  // edges only between commands that access the same buffers, so independent
+  // commands can run concurrently.
   CommandBufferCmdSequence::SynchronizationMode synchronization_mode =
       ir_emitter_context_->debug_options()
               .xla_gpu_graph_enable_concurrent_region()
-          ? CommandBufferCmdSequence::SynchronizationMode::kAutomatic
+          ? CommandBufferCmdSequence::SynchronizationMode::kDependencies
           : CommandBufferCmdSequence::SynchronizationMode::kSerialize;
 
   TF_ASSIGN_OR_RETURN(
@@ -1344,8 +1347,10 @@ absl::Status IrEmitterUnnested::EmitTopKCustomCall(
       << "Expect only 1 operand for TopK custom call.";
   TF_RET_CHECK(shape.IsTuple())
       << "Expect TopK custom call to have tuple shape.";
-  TF_RET_CHECK(shape.tuple_shapes_size() == 2)
-      << "Expect TopK custom call shape to have exactly 2 sub-shapes.";
+  TF_RET_CHECK(shape.tuple_shapes_size() == 2 ||
+               shape.tuple_shapes_size() == 3)
+      << "Expect TopK custom call shape to have 2 sub-shapes and an optional "
+         "scratch buffer.";
 
   auto data_shape = operands[0]->shape();
   auto top_elements_shape = shape.tuple_shapes()[0];
@@ -1364,10 +1369,27 @@ absl::Status IrEmitterUnnested::EmitTopKCustomCall(
           : std::tuple<size_t, size_t, size_t>{
                 1, data_shape.dimensions(0), top_elements_shape.dimensions(0)};
 
-  // Load TopK custom kernel.
-  TF_ASSIGN_OR_RETURN(CustomKernel kernel,
-                      kernel::topk::GetTopKKernel(
-                          "topk", data_shape.element_type(), n, k, batch_size));
+  // Load TopK custom kernels. Large k is handled by a radix select, which
+  // splits every row into as many slices as the scratch buffer was sized for.
+  std::vector<CustomKernel> kernels;
+  if (k <= kernel::topk::kTopKMaxSmallK) {
+    TF_ASSIGN_OR_RETURN(CustomKernel kernel,
+                        kernel::topk::GetTopKKernel(
+                            "topk", data_shape.element_type(), n, k,
+                            batch_size));
+    kernels.push_back(std::move(kernel));
+  } else {
+    size_t num_slices = 1;
+    if (shape.tuple_shapes_size() == 3) {
+      num_slices = ShapeUtil::ByteSizeOf(shape.tuple_shapes(2)) /
+                   kernel::topk::GetTopKRadixSelectScratchSize(
+                       data_shape.element_type(), k, batch_size,
+                       /*num_slices=*/1);
+    }
+    TF_ASSIGN_OR_RETURN(kernels, kernel::topk::GetTopKRadixSelectKernels(
+                                     "topk", data_shape.element_type(), n, k,
+                                     batch_size, num_slices));
+  }
 
   // Prepare kernel arguments.
   TF_ASSIGN_OR_RETURN(
@@ -1375,9 +1397,20 @@ absl::Status IrEmitterUnnested::EmitTopKCustomCall(
       KernelArguments::Create(ir_emitter_context_->buffer_assignment(), instr,
                               operands));
 
-  auto thunk = std::make_unique<CustomKernelThunk>(
-      instr, std::move(kernel), std::move(kernel_arguments.args()));
-  AddThunkToThunkSequence(std::move(thunk));
+  ThunkSequence thunks;
+  for (CustomKernel& kernel : kernels) {
+    thunks.push_back(std::make_unique<CustomKernelThunk>(
+        instr, std::move(kernel), kernel_arguments.args()));
+  }
+  if (thunks.size() == 1) {
+    AddThunkToThunkSequence(std::move(thunks[0]));
+  } else {
+    auto thunk_info = Thunk::ThunkInfo::WithProfileAnnotation(instr);
+    // Don't repeat the annotation from inside thunks
+    thunk_info.profile_annotation = {};
+    AddThunkToThunkSequence(
+        std::make_unique<SequentialThunk>(thunk_info, std::move(thunks)));
+  }
 
   return absl::OkStatus();
 }
@@ -2138,10 +2171,20 @@ absl::Status IrEmitterUnnested::EmitNcclThunk(
     if (ir_emitter_context_->debug_options().xla_syntax_sugar_async_ops()) {
       thunk_info.profile_annotation = async_start->name();
     }
-    auto thunk = std::make_unique<NcclThunkType>(
-        thunk_info, NcclApi::Default(), inst,
-        /*buffers=*/std::move(buffers),
-        ir_emitter_context_->debug_options().xla_gpu_use_memcpy_local_p2p());
+    const DebugOptions& debug_options = ir_emitter_context_->debug_options();
+    std::unique_ptr<NcclThunkType> thunk;
+    if constexpr (std::is_same_v<NcclThunkType, NcclAllReduceStartThunk>) {
+      thunk = std::make_unique<NcclThunkType>(
+          thunk_info, NcclApi::Default(), inst,
+          /*buffers=*/std::move(buffers),
+          debug_options.xla_gpu_use_memcpy_local_p2p(),
+          debug_options.xla_gpu_one_shot_all_reduce_max_bytes());
+    } else {
+      thunk = std::make_unique<NcclThunkType>(
+          thunk_info, NcclApi::Default(), inst,
+          /*buffers=*/std::move(buffers),
+          debug_options.xla_gpu_use_memcpy_local_p2p());
+    }
     GetCollectivesAsyncEvents().insert({async_start, thunk->async_events()});
     AddThunkToThunkSequence(std::move(thunk));
     return absl::OkStatus();
@@ -17,6 +17,7 @@ limitations under the License.
 #include <functional>
 #include <string>
 #include <utility>
+#include <variant>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "xla/service/gpu/kernel_arguments.h"
 #include "xla/service/gpu/launch_dimensions.h"
 #include "xla/status_macros.h"
+#include "xla/stream_executor/device_description.h"
 #include "xla/stream_executor/launch_dim.h"
 #include "xla/util.h"
 #include "tsl/platform/env.h"
@@ -145,26 +147,49 @@ CompilationCacheProto KernelReuseCache::Export() const {
   return proto;
 }
 
+std::string GetKernelCacheTarget(const se::GpuComputeCapability& gpu_version) {
+  if (const auto* cuda_cc =
+          std::get_if<se::CudaComputeCapability>(&gpu_version)) {
+    return absl::StrCat("cuda ", cuda_cc->ToString());
+  }
+  return absl::StrCat(
+      "rocm ", std::get<se::RocmComputeCapability>(gpu_version).gfx_version());
+}
+
 absl::Status UpdateDiskKernelCache(
-    absl::string_view path, const bool do_append,
+    absl::string_view path, const bool do_append, absl::string_view target,
     const CompilationCacheProto& current_cache,
     absl::Span<const KernelReuseCache::NamedBinary> binaries_to_cache) {
+  tsl::Env* env = tsl::Env::Default();
   CompilationCacheProto disk_cache;
   if (do_append) {
     std::string serialized;
-    TF_RETURN_IF_ERROR(tsl::ReadFileToString(tsl::Env::Default(),
-                                             std::string(path), &serialized));
+    TF_RETURN_IF_ERROR(
+        tsl::ReadFileToString(env, std::string(path), &serialized));
     if (!disk_cache.ParseFromString(std::string(serialized))) {
       return Internal("Failed to parse serialized CompilationCacheProto.");
     }
+    if (disk_cache.target() != target) {
+      LOG(WARNING) << "Replacing the kernel cache file " << path
+                   << " compiled for '" << disk_cache.target() << "' with "
+                   << "kernels compiled for '" << target << "'.";
+      disk_cache.Clear();
+    }
   }
+  disk_cache.set_target(std::string(target));
   auto entries = disk_cache.mutable_entries();
   int stored_kernel_count = 0;
   for (const auto& [name, binary] : binaries_to_cache) {
     auto it_current = current_cache.entries().find(name);
     TF_RET_CHECK(it_current != current_cache.entries().end());
     auto [it_disk, inserted] = entries->insert({name, it_current->second});
-    TF_RET_CHECK(inserted);
+    if (!inserted) {
+      // Kernel names are unique within a compilation, so the entry was stored
+      // by a concurrent compilation sharing the file. Keep it: on the next
+      // load its fingerprint maps to its own binary.
+      VLOG(5) << "Kernel " << name << " is already cached.";
+      continue;
+    }
     TF_RET_CHECK(!binary.empty());
     it_disk->second.set_binary(reinterpret_cast<const char*>(binary.data()),
                                binary.size());
@@ -172,9 +197,14 @@ absl::Status UpdateDiskKernelCache(
     ++stored_kernel_count;
   }
   if (stored_kernel_count > 0) {
-    TF_RETURN_IF_ERROR(tsl::WriteStringToFile(tsl::Env::Default(),
-                                              std::string(path),
-                                              disk_cache.SerializeAsString()));
+    // Write to a temporary file next to the cache file and rename it, so that
+    // readers see either the old or the new file. Concurrent writers can still
+    // drop each other's new kernels, which only costs a recompilation.
+    std::string tmp_path = absl::StrCat(path, ".tmp.", env->GetProcessId(), ".",
+                                        env->NowMicros());
+    TF_RETURN_IF_ERROR(
+        tsl::WriteStringToFile(env, tmp_path, disk_cache.SerializeAsString()));
+    TF_RETURN_IF_ERROR(env->RenameFile(tmp_path, std::string(path)));
     VLOG(2) << "Stored " << stored_kernel_count << " / "
             << binaries_to_cache.size() << " kernels in the cache file.";
   }
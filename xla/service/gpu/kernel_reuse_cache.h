@@ -31,6 +31,7 @@ limitations under the License.
 #include "xla/service/gpu/executable.pb.h"
 #include "xla/service/gpu/kernel_arguments.h"
 #include "xla/service/gpu/launch_dimensions.h"
+#include "xla/stream_executor/device_description.h"
 #include "xla/stream_executor/launch_dim.h"
 
 namespace xla {
@@ -94,11 +95,19 @@ class KernelReuseCache {
   absl::flat_hash_set<std::string> hits_;
 };
 
+// Returns the identifier of the GPU that kernels compiled for `gpu_version`
+// run on. Cache files store it, so that binaries compiled for one GPU are never
+// linked into an executable for another one.
+std::string GetKernelCacheTarget(const se::GpuComputeCapability& gpu_version);
+
 // Add kernels to the cache file. Binaries are taken from binaries_to_cache,
 // all other kernel properties are taken from current_cache.
-// do_append makes an existing file be loaded first.
+// do_append makes an existing file be loaded first, unless it was written for
+// a different target, in which case it is replaced. The file is replaced
+// atomically, so concurrent compilations sharing it never read a partially
+// written file.
 absl::Status UpdateDiskKernelCache(
-    absl::string_view path, bool do_append,
+    absl::string_view path, bool do_append, absl::string_view target,
     const CompilationCacheProto& current_cache,
     absl::Span<const KernelReuseCache::NamedBinary> binaries_to_cache);
 
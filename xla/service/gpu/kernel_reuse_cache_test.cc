@@ -14,9 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "xla/service/gpu/kernel_reuse_cache.h"
 
+#include <string>
+
 #include <gtest/gtest.h>
 #include "absl/log/check.h"
 #include "xla/service/gpu/executable.pb.h"
+#include "xla/stream_executor/device_description.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tsl/platform/env.h"
 
@@ -54,7 +57,7 @@ TEST_F(KernelReuseTest, UpdatingDiskKernelCacheWorks) {
       return cache.Export();
     }("k1");
     TF_EXPECT_OK(UpdateDiskKernelCache(cache_file_path, /*do_append=*/false,
-                                       proto,
+                                       "target", proto,
                                        {{.name = "k1", .binary = {5, 6}}}));
   }
   {
@@ -66,7 +69,7 @@ TEST_F(KernelReuseTest, UpdatingDiskKernelCacheWorks) {
       return cache.Export();
     }("k2");
     TF_EXPECT_OK(UpdateDiskKernelCache(cache_file_path, /*do_append=*/true,
-                                       proto,
+                                       "target", proto,
                                        {{.name = "k2", .binary = {7, 8}}}));
   }
   std::string serialized;
@@ -75,6 +78,41 @@ TEST_F(KernelReuseTest, UpdatingDiskKernelCacheWorks) {
   CompilationCacheProto proto;
   EXPECT_TRUE(proto.ParseFromString(std::string(serialized)));
   EXPECT_EQ(proto.entries_size(), 2);
+  EXPECT_EQ(proto.target(), "target");
+}
+
+TEST_F(KernelReuseTest, DiskKernelCacheForAnotherTargetIsReplaced) {
+  std::string cache_file_path;
+  CHECK(tsl::Env::Default()->LocalTempFilename(&cache_file_path));
+  auto export_cache = [](std::string kernel_name) {
+    KernelReuseCache cache;
+    auto [result, was_cached] = cache.GetWithStatus(kernel_name, [&]() {
+      return KernelReuseCache::Entry{.kernel_name = kernel_name};
+    });
+    return cache.Export();
+  };
+  TF_EXPECT_OK(UpdateDiskKernelCache(cache_file_path, /*do_append=*/false,
+                                     "cuda 8.0", export_cache("k1"),
+                                     {{.name = "k1", .binary = {5, 6}}}));
+  TF_EXPECT_OK(UpdateDiskKernelCache(cache_file_path, /*do_append=*/true,
+                                     "cuda 9.0", export_cache("k2"),
+                                     {{.name = "k2", .binary = {7, 8}}}));
+  std::string serialized;
+  TF_EXPECT_OK(
+      tsl::ReadFileToString(tsl::Env::Default(), cache_file_path, &serialized));
+  CompilationCacheProto proto;
+  EXPECT_TRUE(proto.ParseFromString(std::string(serialized)));
+  EXPECT_EQ(proto.target(), "cuda 9.0");
+  ASSERT_EQ(proto.entries_size(), 1);
+  EXPECT_TRUE(proto.entries().contains("k2"));
+}
+
+TEST_F(KernelReuseTest, KernelCacheTargetsDifferByComputeCapability) {
+  EXPECT_EQ(GetKernelCacheTarget(se::CudaComputeCapability(8, 0)), "cuda 8.0");
+  EXPECT_NE(GetKernelCacheTarget(se::CudaComputeCapability(8, 0)),
+            GetKernelCacheTarget(se::CudaComputeCapability(9, 0)));
+  EXPECT_EQ(GetKernelCacheTarget(se::RocmComputeCapability("gfx90a")),
+            "rocm gfx90a");
 }
 
 }  // namespace
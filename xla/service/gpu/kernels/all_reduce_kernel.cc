@@ -0,0 +1,133 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/kernels/all_reduce_kernel.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xla/primitive_util.h"
+#include "xla/service/collective_ops_utils.h"
+#include "xla/service/gpu/kernels/all_reduce_kernel_common.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/kernel.h"
+#include "xla/stream_executor/launch_dim.h"
+#include "xla/stream_executor/stream.h"
+#include "xla/stream_executor/typed_kernel_factory.h"
+#include "xla/types.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::gpu {
+namespace {
+
+#if defined(GOOGLE_CUDA) || defined(TENSORFLOW_USE_ROCM)
+
+OneShotAllReduceOp ToOneShotAllReduceOp(ReductionKind reduction_kind) {
+  switch (reduction_kind) {
+    case ReductionKind::SUM:
+      return OneShotAllReduceOp::kSum;
+    case ReductionKind::PRODUCT:
+      return OneShotAllReduceOp::kProduct;
+    case ReductionKind::MIN:
+      return OneShotAllReduceOp::kMin;
+    case ReductionKind::MAX:
+      return OneShotAllReduceOp::kMax;
+  }
+}
+
+template <typename T>
+absl::Status TypedOneShotAllReduce(se::Stream* stream,
+                                   ReductionKind reduction_kind,
+                                   se::DeviceMemoryBase input,
+                                   se::DeviceMemoryBase output, int64_t count,
+                                   const OneShotAllReduceBuffers& buffers,
+                                   int32_t rank, int32_t num_ranks) {
+  // Launch dimensions depend only on the number of elements, so all peers
+  // launch the same grid.
+  int64_t num_blocks = std::clamp<int64_t>(
+      (count + kOneShotAllReduceThreadsPerBlock - 1) /
+          kOneShotAllReduceThreadsPerBlock,
+      1, kOneShotAllReduceMaxBlocks);
+
+  void* kernel_symbol =
+      GetOneShotAllReduceKernel<T>(ToOneShotAllReduceOp(reduction_kind));
+
+  TF_ASSIGN_OR_RETURN(
+      auto kernel,
+      (se::TypedKernelFactory<
+          se::DeviceMemory<T>, se::DeviceMemory<T>, int64_t,
+          se::DeviceMemoryBase, se::DeviceMemoryBase, se::DeviceMemoryBase,
+          int32_t, int32_t>::Create(stream->parent(), "one_shot_all_reduce",
+                                    kernel_symbol)));
+
+  return stream->ThenLaunch(
+      se::ThreadDim(kOneShotAllReduceThreadsPerBlock, 1, 1),
+      se::BlockDim(num_blocks, 1, 1), kernel, se::DeviceMemory<T>(input),
+      se::DeviceMemory<T>(output), count, buffers.peer_buffers,
+      buffers.peer_signals, buffers.epochs, rank, num_ranks);
+}
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace
+
+bool IsOneShotAllReduceSupported(PrimitiveType dtype,
+                                 ReductionKind reduction_kind) {
+  return dtype == PrimitiveType::F32 || dtype == PrimitiveType::BF16;
+}
+
+absl::Status RunOneShotAllReduce(se::Stream* stream, PrimitiveType dtype,
+                                 ReductionKind reduction_kind,
+                                 se::DeviceMemoryBase input,
+                                 se::DeviceMemoryBase output, int64_t count,
+                                 const OneShotAllReduceBuffers& buffers,
+                                 int32_t rank, int32_t num_ranks) {
+  VLOG(3) << "One-shot all-reduce: "
+          << primitive_util::LowercasePrimitiveTypeName(dtype)
+          << "; reduction=" << ReductionKindToString(reduction_kind)
+          << "; count=" << count << "; rank=" << rank
+          << "; num_ranks=" << num_ranks;
+
+  if (num_ranks < 1 || num_ranks > kOneShotAllReduceMaxPeers) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported number of one-shot all-reduce ranks: ",
+                     num_ranks, "; max=", kOneShotAllReduceMaxPeers));
+  }
+
+#if defined(GOOGLE_CUDA) || defined(TENSORFLOW_USE_ROCM)
+  switch (dtype) {
+    case PrimitiveType::F32:
+      return TypedOneShotAllReduce<float>(stream, reduction_kind, input, output,
+                                          count, buffers, rank, num_ranks);
+    case PrimitiveType::BF16:
+      return TypedOneShotAllReduce<bfloat16>(stream, reduction_kind, input,
+                                             output, count, buffers, rank,
+                                             num_ranks);
+    default:
+      return absl::UnimplementedError(absl::StrCat(
+          "One-shot all-reduce not implemented for ",
+          primitive_util::LowercasePrimitiveTypeName(dtype)));
+  }
+#else
+  return absl::InternalError("XLA compiled without GPU support");
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+}  // namespace xla::gpu
@@ -0,0 +1,154 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_KERNELS_ALL_REDUCE_KERNEL_CU_H_
+#define XLA_SERVICE_GPU_KERNELS_ALL_REDUCE_KERNEL_CU_H_
+
+// This file contains a one-shot all-reduce kernel for small messages on
+// devices that can directly access each other's memory (i.e. GPUs connected
+// with NVLink). Every device copies its input into a peer-mapped scratch
+// buffer, waits until all peers did the same, and then reads and reduces the
+// scratch buffers of all peers into its output. This trades the bandwidth
+// optimal ring and tree algorithms for a single round of synchronization,
+// which is a win when the latency dominates the data transfer.
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "xla/service/gpu/kernels/all_reduce_kernel_common.h"
+
+#if GOOGLE_CUDA
+#define FORCEINLINE __forceinline__
+#elif TENSORFLOW_USE_ROCM  // GOOGLE_CUDA
+#define FORCEINLINE __forceinline__
+#endif  // TENSORFLOW_USE_ROCM
+
+namespace xla::gpu {
+
+// Peer buffers are written by other devices, and we must not read them through
+// the (non-coherent) L1 cache.
+template <typename T>
+__device__ FORCEINLINE T LoadVolatile(const T* ptr) {
+  using Bits = std::conditional_t<sizeof(T) == 2, uint16_t, uint32_t>;
+  static_assert(sizeof(T) == sizeof(Bits), "unsupported element type");
+  Bits bits = *reinterpret_cast<const volatile Bits*>(ptr);
+  T value;
+  memcpy(&value, &bits, sizeof(T));
+  return value;
+}
+
+template <OneShotAllReduceOp op>
+__device__ FORCEINLINE float Reduce(float a, float b) {
+  if constexpr (op == OneShotAllReduceOp::kSum) {
+    return a + b;
+  } else if constexpr (op == OneShotAllReduceOp::kProduct) {
+    return a * b;
+  } else if constexpr (op == OneShotAllReduceOp::kMin) {
+    return fminf(a, b);
+  } else {
+    return fmaxf(a, b);
+  }
+}
+
+// Synchronizes the current block with the blocks with the same index on all
+// peers. The block signals `epoch` to all peers and waits until all peers
+// signaled the same epoch. All memory writes issued by the block before the
+// barrier are visible to the peers after the barrier.
+__device__ FORCEINLINE void PeerBarrier(uint64_t* const* peer_signals,
+                                        uint64_t epoch, int32_t rank,
+                                        int32_t num_ranks) {
+  __syncthreads();
+  if (threadIdx.x < num_ranks) {
+    int32_t peer = threadIdx.x;
+    int64_t slot = blockIdx.x * kOneShotAllReduceMaxPeers;
+
+    __threadfence_system();
+    volatile uint64_t* remote = peer_signals[peer] + slot + rank;
+    *remote = epoch;
+
+    volatile uint64_t* local = peer_signals[rank] + slot + peer;
+    while (*local < epoch) {
+    }
+    __threadfence_system();
+  }
+  __syncthreads();
+}
+
+template <typename T, OneShotAllReduceOp op>
+__launch_bounds__(kOneShotAllReduceThreadsPerBlock) __global__
+    void OneShotAllReduce(const T* input, T* output, int64_t count,
+                          T* const* peer_buffers,
+                          uint64_t* const* peer_signals, uint64_t* epochs,
+                          int32_t rank, int32_t num_ranks) {
+  // Epochs are kept in device memory (and not passed as kernel arguments), so
+  // that the kernel can be captured into command buffers.
+  const uint64_t epoch = epochs[blockIdx.x];
+
+  const int64_t offset =
+      static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  const int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+
+  // All devices launch the kernel with the same grid, so the block with the
+  // same index processes the same elements on all devices, and it's enough to
+  // synchronize blocks pairwise.
+  T* scratch = peer_buffers[rank];
+  for (int64_t i = offset; i < count; i += stride) {
+    scratch[i] = input[i];
+  }
+
+  PeerBarrier(peer_signals, epoch + 1, rank, num_ranks);
+
+  // Reduce in the rank order, so that all devices get bitwise equal results.
+  for (int64_t i = offset; i < count; i += stride) {
+    float acc = static_cast<float>(LoadVolatile(peer_buffers[0] + i));
+    for (int32_t peer = 1; peer < num_ranks; ++peer) {
+      float value = static_cast<float>(LoadVolatile(peer_buffers[peer] + i));
+      acc = Reduce<op>(acc, value);
+    }
+    output[i] = static_cast<T>(acc);
+  }
+
+  // Wait for all peers to finish reading our scratch buffer before the next
+  // all-reduce can overwrite it.
+  PeerBarrier(peer_signals, epoch + 2, rank, num_ranks);
+
+  if (threadIdx.x == 0) {
+    epochs[blockIdx.x] = epoch + 2;
+  }
+}
+
+template <typename T>
+void* GetOneShotAllReduceKernel(OneShotAllReduceOp op) {
+  switch (op) {
+    case OneShotAllReduceOp::kSum:
+      return reinterpret_cast<void*>(
+          &OneShotAllReduce<T, OneShotAllReduceOp::kSum>);
+    case OneShotAllReduceOp::kProduct:
+      return reinterpret_cast<void*>(
+          &OneShotAllReduce<T, OneShotAllReduceOp::kProduct>);
+    case OneShotAllReduceOp::kMin:
+      return reinterpret_cast<void*>(
+          &OneShotAllReduce<T, OneShotAllReduceOp::kMin>);
+    case OneShotAllReduceOp::kMax:
+      return reinterpret_cast<void*>(
+          &OneShotAllReduce<T, OneShotAllReduceOp::kMax>);
+  }
+  return nullptr;
+}
+
+}  // namespace xla::gpu
+
+#endif  // XLA_SERVICE_GPU_KERNELS_ALL_REDUCE_KERNEL_CU_H_
@@ -0,0 +1,65 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_KERNELS_ALL_REDUCE_KERNEL_H_
+#define XLA_SERVICE_GPU_KERNELS_ALL_REDUCE_KERNEL_H_
+
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "xla/service/collective_ops_utils.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/stream.h"
+#include "xla/xla_data.pb.h"
+
+namespace xla::gpu {
+
+// Peer-mapped buffers of a single participant of a one-shot all-reduce. All
+// buffers must be allocated once and reused for all all-reduce operations of
+// the same participants, as the kernel keeps synchronization state in them.
+struct OneShotAllReduceBuffers {
+  // Device array of `num_ranks` pointers to the scratch buffers of all peers,
+  // indexed by rank. Scratch buffers must be large enough for the largest
+  // all-reduce operand.
+  se::DeviceMemoryBase peer_buffers;
+
+  // Device array of `num_ranks` pointers to the signal buffers of all peers,
+  // indexed by rank. Each signal buffer is `kOneShotAllReduceSignalsSize`
+  // bytes and must be zero-initialized.
+  se::DeviceMemoryBase peer_signals;
+
+  // Zero-initialized epoch counters of the local device of
+  // `kOneShotAllReduceEpochsSize` bytes.
+  se::DeviceMemoryBase epochs;
+};
+
+// Returns true if one-shot all-reduce kernel supports the given element type
+// and reduction kind.
+bool IsOneShotAllReduceSupported(PrimitiveType dtype,
+                                 ReductionKind reduction_kind);
+
+// Launches a one-shot all-reduce of `count` elements from `input` into
+// `output` on `stream`. All `num_ranks` participants must launch the kernel
+// with the same `count`, as it synchronizes with all peers on device.
+absl::Status RunOneShotAllReduce(se::Stream* stream, PrimitiveType dtype,
+                                 ReductionKind reduction_kind,
+                                 se::DeviceMemoryBase input,
+                                 se::DeviceMemoryBase output, int64_t count,
+                                 const OneShotAllReduceBuffers& buffers,
+                                 int32_t rank, int32_t num_ranks);
+
+}  // namespace xla::gpu
+
+#endif  // XLA_SERVICE_GPU_KERNELS_ALL_REDUCE_KERNEL_H_
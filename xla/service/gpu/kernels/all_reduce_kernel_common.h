@@ -0,0 +1,62 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_KERNELS_ALL_REDUCE_KERNEL_COMMON_H_
+#define XLA_SERVICE_GPU_KERNELS_ALL_REDUCE_KERNEL_COMMON_H_
+
+#include <cstdint>
+
+// Contains shared declarations between all_reduce_kernel.cc and
+// all_reduce_kernel.cu.cc but avoids including ABSL, etc. which some CUDA
+// compilers cannot handle.
+
+namespace xla::gpu {
+
+// Maximum number of devices participating in a one-shot all-reduce.
+inline constexpr int64_t kOneShotAllReduceMaxPeers = 8;
+
+// Maximum number of thread blocks of a one-shot all-reduce kernel. Every block
+// synchronizes with the blocks with the same index on all peers, so all blocks
+// must be resident on the device at the same time.
+inline constexpr int64_t kOneShotAllReduceMaxBlocks = 64;
+
+inline constexpr int64_t kOneShotAllReduceThreadsPerBlock = 512;
+
+// Size of the signal buffer of a single device. Device `rank` stores the
+// current epoch of block `b` into `signals[b * kMaxPeers + rank]` of all
+// peers, and waits until all peers did the same.
+inline constexpr int64_t kOneShotAllReduceSignalsSize =
+    kOneShotAllReduceMaxBlocks * kOneShotAllReduceMaxPeers * sizeof(uint64_t);
+
+// Size of the per-block epoch counters of a single device.
+inline constexpr int64_t kOneShotAllReduceEpochsSize =
+    kOneShotAllReduceMaxBlocks * sizeof(uint64_t);
+
+enum class OneShotAllReduceOp { kSum, kProduct, kMin, kMax };
+
+// Kernel arguments:
+//
+//   const T* input, T* output, int64_t count,
+//   T* const* peer_buffers, uint64_t* const* peer_signals, uint64_t* epochs,
+//   int32_t rank, int32_t num_ranks
+//
+// `peer_buffers` and `peer_signals` are device arrays of `num_ranks` pointers
+// to the peer-mapped scratch and signal buffers of all participants.
+template <typename T>
+void* GetOneShotAllReduceKernel(OneShotAllReduceOp op);
+
+}  // namespace xla::gpu
+
+#endif  // XLA_SERVICE_GPU_KERNELS_ALL_REDUCE_KERNEL_COMMON_H_
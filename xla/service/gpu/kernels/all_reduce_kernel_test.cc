@@ -0,0 +1,159 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/kernels/all_reduce_kernel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "xla/service/collective_ops_utils.h"
+#include "xla/service/gpu/kernels/all_reduce_kernel_common.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/device_memory_handle.h"
+#include "xla/stream_executor/gpu/gpu_init.h"
+#include "xla/stream_executor/platform.h"
+#include "xla/stream_executor/platform_manager.h"
+#include "xla/stream_executor/stream.h"
+#include "xla/stream_executor/stream_executor.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace xla::gpu {
+namespace {
+
+// Peer-mapped buffers of a single test participant.
+struct Participant {
+  se::StreamExecutor* executor;
+  std::unique_ptr<se::Stream> stream;
+  se::DeviceMemoryHandle input;
+  se::DeviceMemoryHandle output;
+  se::DeviceMemoryHandle scratch;
+  se::DeviceMemoryHandle signals;
+  se::DeviceMemoryHandle epochs;
+  se::DeviceMemoryHandle peer_buffers;
+  se::DeviceMemoryHandle peer_signals;
+};
+
+// Returns executors for all devices that can access each other's memory.
+std::vector<se::StreamExecutor*> GetPeerExecutors() {
+  auto* platform =
+      se::PlatformManager::PlatformWithName(se::GpuPlatformName()).value();
+  int64_t num_devices =
+      std::min<int64_t>(platform->VisibleDeviceCount(),
+                        kOneShotAllReduceMaxPeers);
+
+  std::vector<se::StreamExecutor*> executors;
+  for (int64_t i = 0; i < num_devices; ++i) {
+    executors.push_back(platform->ExecutorForDevice(i).value());
+  }
+  for (se::StreamExecutor* executor : executors) {
+    for (se::StreamExecutor* peer : executors) {
+      if (executor == peer) continue;
+      if (!executor->CanEnablePeerAccessTo(peer)) return {};
+      if (!executor->EnablePeerAccessTo(peer).ok()) return {};
+    }
+  }
+  return executors;
+}
+
+TEST(AllReduceKernelTest, OneShotAllReduceF32Sum) {
+  std::vector<se::StreamExecutor*> executors = GetPeerExecutors();
+  if (executors.size() < 2) {
+    GTEST_SKIP() << "Test requires at least two GPUs with peer access";
+  }
+
+  const int32_t num_ranks = executors.size();
+  const int64_t count = 10000;
+  const int64_t num_bytes = count * sizeof(float);
+
+  std::vector<Participant> participants(num_ranks);
+  for (int32_t rank = 0; rank < num_ranks; ++rank) {
+    Participant& p = participants[rank];
+    p.executor = executors[rank];
+    TF_ASSERT_OK_AND_ASSIGN(p.stream, p.executor->CreateStream());
+    p.input =
+        se::DeviceMemoryHandle(p.executor, p.executor->Allocate(num_bytes));
+    p.output =
+        se::DeviceMemoryHandle(p.executor, p.executor->Allocate(num_bytes));
+    p.scratch =
+        se::DeviceMemoryHandle(p.executor, p.executor->Allocate(num_bytes));
+    p.signals = se::DeviceMemoryHandle(
+        p.executor, p.executor->Allocate(kOneShotAllReduceSignalsSize));
+    p.epochs = se::DeviceMemoryHandle(
+        p.executor, p.executor->Allocate(kOneShotAllReduceEpochsSize));
+    p.peer_buffers = se::DeviceMemoryHandle(
+        p.executor, p.executor->Allocate(num_ranks * sizeof(void*)));
+    p.peer_signals = se::DeviceMemoryHandle(
+        p.executor, p.executor->Allocate(num_ranks * sizeof(void*)));
+
+    TF_ASSERT_OK(p.stream->MemZero(p.signals.memory_ptr(),
+                                   kOneShotAllReduceSignalsSize));
+    TF_ASSERT_OK(
+        p.stream->MemZero(p.epochs.memory_ptr(), kOneShotAllReduceEpochsSize));
+
+    std::vector<float> input(count);
+    for (int64_t i = 0; i < count; ++i) input[i] = rank + i % 7;
+    TF_ASSERT_OK(p.stream->Memcpy(p.input.memory_ptr(), input.data(),
+                                  num_bytes));
+  }
+
+  std::vector<void*> scratch_ptrs, signal_ptrs;
+  for (Participant& p : participants) {
+    scratch_ptrs.push_back(p.scratch.memory().opaque());
+    signal_ptrs.push_back(p.signals.memory().opaque());
+  }
+  for (Participant& p : participants) {
+    TF_ASSERT_OK(p.stream->Memcpy(p.peer_buffers.memory_ptr(),
+                                  scratch_ptrs.data(),
+                                  num_ranks * sizeof(void*)));
+    TF_ASSERT_OK(p.stream->Memcpy(p.peer_signals.memory_ptr(),
+                                  signal_ptrs.data(),
+                                  num_ranks * sizeof(void*)));
+    TF_ASSERT_OK(p.stream->BlockHostUntilDone());
+  }
+
+  // Run all-reduce twice to check that synchronization state is reusable.
+  for (int iter = 0; iter < 2; ++iter) {
+    for (int32_t rank = 0; rank < num_ranks; ++rank) {
+      Participant& p = participants[rank];
+      OneShotAllReduceBuffers buffers = {p.peer_buffers.memory(),
+                                         p.peer_signals.memory(),
+                                         p.epochs.memory()};
+      TF_ASSERT_OK(RunOneShotAllReduce(
+          p.stream.get(), PrimitiveType::F32, ReductionKind::SUM,
+          p.input.memory(), p.output.memory(), count, buffers, rank,
+          num_ranks));
+    }
+
+    for (Participant& p : participants) {
+      std::vector<float> output(count);
+      TF_ASSERT_OK(
+          p.stream->Memcpy(output.data(), p.output.memory(), num_bytes));
+      TF_ASSERT_OK(p.stream->BlockHostUntilDone());
+
+      for (int64_t i = 0; i < count; ++i) {
+        float expected = num_ranks * (num_ranks - 1) / 2 + num_ranks * (i % 7);
+        ASSERT_EQ(output[i], expected) << "i=" << i;
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xla::gpu
@@ -21,11 +21,13 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/numeric/bits.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "xla/primitive_util.h"
 #include "xla/service/gpu/kernels/custom_kernel.h"
 #include "xla/stream_executor/device_memory.h"
 #include "xla/stream_executor/kernel.h"
@@ -117,6 +119,89 @@ absl::StatusOr<CustomKernel> GetTypedTopK(std::string name, size_t num_elements,
                       se::ThreadDim(num_threads, 1, 1), shmem_size);
 }
 
+// Returns the function creating packed arguments for one of the radix select
+// TopK kernels. With `num_slices` > 1, the first kernel writes candidates to
+// the scratch buffer, and the second one reads them and writes the results.
+template <typename T>
+KernelArgsPacking CreateRadixSelectArgsPacking(size_t num_elements, size_t k,
+                                               size_t batch_size,
+                                               size_t num_slices,
+                                               bool is_final) {
+  using Packed = absl::StatusOr<std::unique_ptr<se::KernelArgsPackedArrayBase>>;
+
+  return [=](const se::Kernel& kernel, const se::KernelArgs& args) -> Packed {
+    auto* mem_args = se::Cast<se::KernelArgsDeviceMemoryArray>(&args);
+
+    se::DeviceMemory<T> data(mem_args->device_memory_args()[0]);
+    se::DeviceMemory<T> top_elements(mem_args->device_memory_args()[1]);
+    se::DeviceMemory<uint32_t> top_indices(mem_args->device_memory_args()[2]);
+    if (num_slices == 1) {
+      return se::PackKernelArgs(
+          args.number_of_shared_bytes(), data, se::DeviceMemory<uint32_t>(),
+          static_cast<uint32_t>(num_elements), top_elements, top_indices,
+          static_cast<uint32_t>(k), /*sort_result=*/true);
+    }
+
+    // Candidate indices go first, as they are the most aligned.
+    se::DeviceMemoryBase scratch = mem_args->device_memory_args()[3];
+    size_t num_candidates = batch_size * num_slices * k;
+    se::DeviceMemory<uint32_t> candidate_indices(
+        scratch.GetByteSlice(0, num_candidates * sizeof(uint32_t)));
+    se::DeviceMemory<T> candidates(
+        scratch.GetByteSlice(num_candidates * sizeof(uint32_t),
+                             num_candidates * sizeof(T)));
+    if (!is_final) {
+      return se::PackKernelArgs(
+          args.number_of_shared_bytes(), data, se::DeviceMemory<uint32_t>(),
+          static_cast<uint32_t>(num_elements), candidates, candidate_indices,
+          static_cast<uint32_t>(k), /*sort_result=*/false);
+    }
+    return se::PackKernelArgs(args.number_of_shared_bytes(), candidates,
+                              candidate_indices,
+                              static_cast<uint32_t>(num_slices * k),
+                              top_elements, top_indices,
+                              static_cast<uint32_t>(k), /*sort_result=*/true);
+  };
+}
+
+template <typename T>
+absl::StatusOr<std::vector<CustomKernel>> GetTypedTopKRadixSelect(
+    std::string name, size_t num_elements, size_t k, size_t batch_size,
+    size_t num_slices) {
+  if (k > kTopKMaxRadixSelectK || k > num_elements || num_slices == 0) {
+    return absl::FailedPreconditionError(
+        "Invalid kernel parameters. This is likely a bug in the "
+        "TopkSpecializer.");
+  }
+  // The final kernel sorts the selected elements in shared memory.
+  int shmem_size = 2 * absl::bit_ceil(k) * sizeof(uint32_t);
+  void* kernel_symbol = GetTopKRadixSelectKernel<T>();
+
+  std::vector<CustomKernel> kernels;
+  if (num_slices > 1) {
+    std::string slices_name = absl::StrCat(name, "_slices");
+    se::MultiKernelLoaderSpec spec(
+        /*arity=*/7, CreateRadixSelectArgsPacking<T>(num_elements, k,
+                                                     batch_size, num_slices,
+                                                     /*is_final=*/false));
+    spec.AddInProcessSymbol(kernel_symbol, slices_name);
+    kernels.emplace_back(std::move(slices_name), std::move(spec),
+                         se::BlockDim(num_slices, batch_size, 1),
+                         se::ThreadDim(kTopKMaxThreadsPerBlock, 1, 1),
+                         /*shared_memory_bytes=*/0);
+  }
+  se::MultiKernelLoaderSpec spec(
+      /*arity=*/7,
+      CreateRadixSelectArgsPacking<T>(num_elements, k, batch_size, num_slices,
+                                      /*is_final=*/true));
+  spec.AddInProcessSymbol(kernel_symbol, name);
+  kernels.emplace_back(std::move(name), std::move(spec),
+                       se::BlockDim(1, batch_size, 1),
+                       se::ThreadDim(kTopKMaxThreadsPerBlock, 1, 1),
+                       shmem_size);
+  return kernels;
+}
+
 }  // namespace
 
 absl::StatusOr<CustomKernel> GetTopKKernel(std::string name,
@@ -135,6 +220,22 @@ absl::StatusOr<CustomKernel> GetTopKKernel(std::string name,
   }
 }
 
+absl::StatusOr<std::vector<CustomKernel>> GetTopKRadixSelectKernels(
+    std::string name, PrimitiveType dtype, size_t num_elements, size_t k,
+    size_t batch_size, size_t num_slices) {
+  switch (dtype) {
+    case PrimitiveType::F32:
+      return GetTypedTopKRadixSelect<float>(std::move(name), num_elements, k,
+                                            batch_size, num_slices);
+    case PrimitiveType::BF16:
+      return GetTypedTopKRadixSelect<bfloat16>(std::move(name), num_elements,
+                                               k, batch_size, num_slices);
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported GpuTopK data type: ", dtype));
+  }
+}
+
 #else
 
 // Fallback implementation of creating a CustomKernel for TopK operation.
@@ -145,6 +246,18 @@ absl::StatusOr<CustomKernel> GetTopKKernel(std::string name,
   return absl::InternalError("XLA compiled without CUDA support");
 }
 
+absl::StatusOr<std::vector<CustomKernel>> GetTopKRadixSelectKernels(
+    std::string name, PrimitiveType dtype, size_t num_elements, size_t k,
+    size_t batch_size, size_t num_slices) {
+  return absl::InternalError("XLA compiled without CUDA support");
+}
+
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+size_t GetTopKRadixSelectScratchSize(PrimitiveType dtype, size_t k,
+                                     size_t batch_size, size_t num_slices) {
+  return batch_size * num_slices * k *
+         (sizeof(uint32_t) + primitive_util::ByteWidth(dtype));
+}
+
 }  // namespace xla::gpu::kernel::topk
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <string>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "xla/service/gpu/kernels/custom_kernel.h"
@@ -25,12 +26,32 @@ limitations under the License.
 
 namespace xla::gpu::kernel::topk {
 
+// Largest `k` supported by GetTopKKernel.
+inline constexpr size_t kTopKMaxSmallK = 16;
+
+// Largest `k` supported by GetTopKRadixSelectKernels.
+inline constexpr size_t kTopKMaxRadixSelectK = 4096;
+
 // Creates a CustomKernel for TopK operation.
 absl::StatusOr<CustomKernel> GetTopKKernel(std::string name,
                                            PrimitiveType dtype,
                                            size_t num_elements, size_t k,
                                            size_t batch_size);
 
+// Returns the size of the scratch buffer needed by GetTopKRadixSelectKernels
+// for `num_slices` > 1.
+size_t GetTopKRadixSelectScratchSize(PrimitiveType dtype, size_t k,
+                                     size_t batch_size, size_t num_slices);
+
+// Creates the CustomKernels for a TopK operation with large `k`, based on radix
+// select. They take the same arguments as the kernel of GetTopKKernel, and
+// with `num_slices` > 1 also a scratch buffer. In that case every row is split
+// into `num_slices` slices selected by different blocks, and a second kernel
+// selects the final results from their candidates.
+absl::StatusOr<std::vector<CustomKernel>> GetTopKRadixSelectKernels(
+    std::string name, PrimitiveType dtype, size_t num_elements, size_t k,
+    size_t batch_size, size_t num_slices);
+
 }  // namespace xla::gpu::kernel::topk
 
 #endif  // XLA_SERVICE_GPU_KERNELS_TOPK_CUSTOM_KERNEL_H_
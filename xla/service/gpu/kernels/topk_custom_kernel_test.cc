@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/service/gpu/kernels/topk_custom_kernel.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <functional>
@@ -26,6 +27,7 @@ limitations under the License.
 #include "absl/random/random.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/substitute.h"
+#include "xla/service/gpu/kernels/custom_kernel.h"
 #include "xla/service/platform_util.h"
 #include "xla/stream_executor/kernel.h"
 #include "xla/stream_executor/platform.h"
@@ -202,4 +204,98 @@ INSTANTIATE_TEST_SUITE_P(TopKTests, TopKKernelTest,
                                std::get<3>(info.param));
                          });
 
+// Params:
+//  - n_kb: number of elements in kilobytes.
+//  - k: number of elements to return.
+//  - batch_size
+//  - num_slices
+using TopKRadixSelectKernelTest =
+    ::testing::TestWithParam<std::tuple<int, int, int, int>>;
+
+TEST_P(TopKRadixSelectKernelTest, TopKFloat) {
+  using T = float;
+
+  auto name =
+      absl::AsciiStrToUpper(PlatformUtil::CanonicalPlatformName("gpu").value());
+  se::Platform* platform = se::PlatformManager::PlatformWithName(name).value();
+  se::StreamExecutor* executor = platform->ExecutorForDevice(0).value();
+
+  auto stream = executor->CreateStream().value();
+
+  const auto [n_kb, k, batch_size, num_slices] = GetParam();
+  const size_t n = n_kb * 1024;
+  const size_t scratch_size = GetTopKRadixSelectScratchSize(
+      PrimitiveType::F32, k, batch_size, num_slices);
+
+  se::DeviceMemory<T> input_buffer =
+      executor->AllocateArray<T>(n * batch_size, 0);
+  se::DeviceMemory<T> output_values =
+      executor->AllocateArray<T>(k * batch_size, 0);
+  se::DeviceMemory<uint32_t> output_indices =
+      executor->AllocateArray<uint32_t>(k * batch_size, 0);
+  se::DeviceMemory<uint8_t> scratch =
+      executor->AllocateArray<uint8_t>(scratch_size, 0);
+
+  // Round to a small range of values to get plenty of ties. Avoid zeros, as
+  // the kernel orders -0 before +0.
+  auto source = RandomVecRange<T>(n * batch_size, -100, 100);
+  for (T& value : source) value = std::round(value) + 0.5f;
+  TF_ASSERT_OK(
+      stream->Memcpy(&input_buffer, source.data(), n * batch_size * sizeof(T)));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto custom_kernels,
+      GetTopKRadixSelectKernels("topk", PrimitiveType::F32, n, k, batch_size,
+                                num_slices));
+  ASSERT_EQ(custom_kernels.size(), num_slices > 1 ? 2 : 1);
+
+  for (const CustomKernel& custom_kernel : custom_kernels) {
+    TF_ASSERT_OK_AND_ASSIGN(auto kernel,
+                            executor->LoadKernel(custom_kernel.kernel_spec()));
+    se::KernelArgsDeviceMemoryArray arr(
+        std::vector<se::DeviceMemoryBase>(
+            {input_buffer, output_values, output_indices, scratch}),
+        custom_kernel.shared_memory_bytes());
+    TF_ASSERT_OK(stream->Launch(custom_kernel.thread_dims(),
+                                custom_kernel.block_dims(), *kernel, arr));
+  }
+
+  std::vector<T> got(k);
+  std::vector<uint32_t> got_indices(k);
+  ASSERT_TRUE(stream->BlockHostUntilDone().ok());
+  for (int i = 0; i < batch_size; i++) {
+    TF_ASSERT_OK(stream->Memcpy(got.data(), output_values.GetSlice(k * i, k),
+                                k * sizeof(T)));
+    TF_ASSERT_OK(stream->Memcpy(got_indices.data(),
+                                output_indices.GetSlice(k * i, k),
+                                k * sizeof(uint32_t)));
+    // Equal values come in the order of their indices.
+    std::vector<uint32_t> expected_indices(n);
+    for (size_t j = 0; j < n; ++j) expected_indices[j] = j;
+    const T* row = source.data() + n * i;
+    std::stable_sort(expected_indices.begin(), expected_indices.end(),
+                     [&](uint32_t a, uint32_t b) { return row[a] > row[b]; });
+    expected_indices.resize(k);
+    EXPECT_THAT(got_indices, ::testing::ElementsAreArray(expected_indices))
+        << " k=" << k << ", batch_size=" << batch_size << " i=" << i;
+    for (int j = 0; j < k; ++j) {
+      EXPECT_EQ(got[j], row[expected_indices[j]]);
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(TopKRadixSelectTests, TopKRadixSelectKernelTest,
+                         Combine(
+                             /*n_kb=*/Values(1, 12, 64),
+                             /*k=*/Values(17, 100, 1000),
+                             /*batch_size=*/Values(1, 16),
+                             /*num_slices=*/Values(1, 3, 8)),
+                         [](const auto& info) {
+                           return absl::Substitute(
+                               "n$0KiB_k$1_batch_size$2_num_slices$3",
+                               std::get<0>(info.param), std::get<1>(info.param),
+                               std::get<2>(info.param),
+                               std::get<3>(info.param));
+                         });
+
 }  // namespace xla::gpu::kernel::topk
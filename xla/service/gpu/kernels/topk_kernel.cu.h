@@ -23,6 +23,7 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <type_traits>
 
 #include "xla/service/gpu/kernels/topk_kernel_common.h"
 #include "xla/tsl/lib/math/math_util.h"
@@ -312,6 +313,233 @@ void* GetTopKKernelForK(int n) {
              : reinterpret_cast<void*>(&Run<K, T, uint32_t>);
 }
 
+// RadixSelectTopK implements TopK for large K (up to a few thousands), where
+// keeping the top elements in registers is not an option anymore.
+//
+// Keys are mapped to unsigned integers with the same order, and every block
+// finds the k-th largest key of its slice one 8-bit digit at a time: a pass
+// over the slice builds a histogram of the current digit for the keys that
+// match the digits found so far, and the digit holding the k-th largest key is
+// appended to the prefix. After sizeof(KT) passes the prefix is the k-th
+// largest key itself, and a final pass compacts all larger keys and as many
+// keys equal to it as needed, picking the smallest indices first. Like a
+// TOTALORDER comparison, this orders -0 before +0 and NaNs after infinities.
+//
+// Each row can be split into `gridDim.x` slices processed by different blocks.
+// Their unsorted candidates are written to `result`, k per slice, and a second
+// launch with a single slice per row and `data_idxs` pointing to the candidate
+// indices selects the final top k from them. With `sort_result`, the selected
+// elements are sorted in shared memory with a bitonic sort, which needs
+// 2 * bit_ceil(k) * sizeof(uint32_t) bytes of dynamic shared memory.
+
+// Candidates of slices with less than k elements are padded with the smallest
+// key in radix order and this index, so that the padding loses all ties.
+static constexpr uint32_t kRadixSelectPaddingIndex =
+    std::numeric_limits<uint32_t>::max();
+static constexpr uint32_t kRadixSelectDigitBits = 8;
+static constexpr uint32_t kRadixSelectNumDigits = 1 << kRadixSelectDigitBits;
+
+template <typename KT>
+using RadixSelectBits =
+    std::conditional_t<sizeof(KT) == sizeof(uint16_t), uint16_t, uint32_t>;
+
+template <typename KT>
+__device__ FORCEINLINE uint32_t ToRadixOrder(RadixSelectBits<KT> bits) {
+  constexpr uint32_t kSignBit = 1u << (sizeof(KT) * 8 - 1);
+  constexpr uint32_t kAllBits = kSignBit | (kSignBit - 1);
+  uint32_t value = bits;
+  return (value & kSignBit) ? (~value & kAllBits) : (value | kSignBit);
+}
+
+template <typename KT>
+__device__ FORCEINLINE RadixSelectBits<KT> FromRadixOrder(uint32_t value) {
+  constexpr uint32_t kSignBit = 1u << (sizeof(KT) * 8 - 1);
+  constexpr uint32_t kAllBits = kSignBit | (kSignBit - 1);
+  return (value & kSignBit) ? (value & ~kSignBit) : (~value & kAllBits);
+}
+
+// Returns the sum of `value` over all threads of the block before this one,
+// and the sum over the whole block in `total`. Must be called by all threads,
+// `warp_sums` needs one element per warp.
+__device__ FORCEINLINE uint32_t BlockExclusiveSum(uint32_t value,
+                                                  uint32_t* warp_sums,
+                                                  uint32_t& total) {
+  constexpr uint32_t WarpSize = WAVEFRONT_SIZE;
+  uint32_t lane_id = threadIdx.x % WarpSize;
+  uint32_t warp_id = threadIdx.x / WarpSize;
+  uint32_t inclusive = value;
+#pragma unroll
+  for (uint32_t offset = 1; offset < WarpSize; offset *= 2) {
+    uint32_t other = GpuShuffle<ShflType::kUp>(inclusive, offset);
+    if (lane_id >= offset) inclusive += other;
+  }
+  if (lane_id == WarpSize - 1) warp_sums[warp_id] = inclusive;
+  __syncthreads();
+  uint32_t warp_offset = 0;
+  total = 0;
+  for (uint32_t i = 0; i < blockDim.x / WarpSize; ++i) {
+    uint32_t sum = warp_sums[i];
+    warp_offset += i < warp_id ? sum : 0;
+    total += sum;
+  }
+  // Do not let the next call overwrite `warp_sums` before everyone read it.
+  __syncthreads();
+  return warp_offset + inclusive - value;
+}
+
+template <typename KT>
+__launch_bounds__(kTopKMaxThreadsPerBlock, 1) __global__
+    void RadixSelectTopK(const KT* data, const uint32_t* data_idxs, uint32_t n,
+                         KT* result, uint32_t* result_idxs, uint32_t k,
+                         bool sort_result) {
+  using Bits = RadixSelectBits<KT>;
+  constexpr uint32_t WarpSize = WAVEFRONT_SIZE;
+  constexpr int kKeyBits = sizeof(KT) * 8;
+
+  __shared__ uint32_t histogram[kRadixSelectNumDigits];
+  __shared__ uint32_t warp_sums[kTopKMaxThreadsPerBlock / WarpSize];
+  __shared__ uint32_t selected_prefix;
+  __shared__ uint32_t selected_remaining;
+
+  const uint32_t row = blockIdx.y;
+  const uint32_t slice = blockIdx.x;
+  const uint32_t slice_size = (n + gridDim.x - 1) / gridDim.x;
+  const uint32_t begin = min(n, slice * slice_size);
+  const uint32_t size = min(n, begin + slice_size) - begin;
+  const uint32_t num_selected = min(k, size);
+
+  const Bits* in = reinterpret_cast<const Bits*>(data) + row * n + begin;
+  const uint32_t* in_idxs =
+      data_idxs != nullptr ? data_idxs + row * n + begin : nullptr;
+  const uint32_t out_offset = (row * gridDim.x + slice) * k;
+  Bits* out = reinterpret_cast<Bits*>(result) + out_offset;
+  uint32_t* out_idxs = result_idxs + out_offset;
+
+  // Find the k-th largest key one digit at a time, starting from the most
+  // significant one.
+  if (threadIdx.x == 0) {
+    selected_prefix = 0;
+    selected_remaining = num_selected;
+  }
+  __syncthreads();
+  uint32_t prefix = 0;
+  uint32_t mask = 0;
+  for (int shift = kKeyBits - kRadixSelectDigitBits;
+       shift >= 0 && num_selected > 0; shift -= kRadixSelectDigitBits) {
+    for (uint32_t i = threadIdx.x; i < kRadixSelectNumDigits; i += blockDim.x) {
+      histogram[i] = 0;
+    }
+    __syncthreads();
+    uint32_t remaining = selected_remaining;
+    for (uint32_t i = threadIdx.x; i < size; i += blockDim.x) {
+      uint32_t key = ToRadixOrder<KT>(in[i]);
+      if ((key & mask) == prefix) {
+        atomicAdd(&histogram[(key >> shift) % kRadixSelectNumDigits], 1u);
+      }
+    }
+    __syncthreads();
+
+    // Count the keys with a larger digit, starting from the largest one.
+    uint32_t digit = kRadixSelectNumDigits - 1 - threadIdx.x;
+    uint32_t count =
+        threadIdx.x < kRadixSelectNumDigits ? histogram[digit] : 0;
+    uint32_t total;
+    uint32_t larger = BlockExclusiveSum(count, warp_sums, total);
+    if (threadIdx.x < kRadixSelectNumDigits && larger < remaining &&
+        remaining <= larger + count) {
+      selected_prefix = prefix | (digit << shift);
+      selected_remaining = remaining - larger;
+    }
+    __syncthreads();
+    prefix = selected_prefix;
+    mask |= (kRadixSelectNumDigits - 1) << shift;
+  }
+  const uint32_t threshold = prefix;
+  const uint32_t num_ties = selected_remaining;
+
+  uint32_t* sorted_keys = reinterpret_cast<uint32_t*>(shmem);
+  uint32_t sorted_size = 1;
+  while (sorted_size < k) sorted_size *= 2;
+  uint32_t* sorted_idxs = sorted_keys + sorted_size;
+
+  // Compact the selected elements, keeping their relative order so that the
+  // ties with the smallest indices win.
+  uint32_t num_larger_seen = 0;
+  uint32_t num_ties_seen = 0;
+  for (uint32_t base = 0; base < size; base += blockDim.x) {
+    uint32_t i = base + threadIdx.x;
+    uint32_t key = i < size ? ToRadixOrder<KT>(in[i]) : 0;
+    bool is_larger = i < size && key > threshold;
+    bool is_tie = i < size && key == threshold;
+    // Counts for the chunk fit into 16 bits, so we can scan both at once.
+    uint32_t total;
+    uint32_t before = BlockExclusiveSum(
+        (is_tie ? 1u << 16 : 0u) | (is_larger ? 1u : 0u), warp_sums, total);
+    uint32_t ties_before = num_ties_seen + (before >> 16);
+    if (is_larger || (is_tie && ties_before < num_ties)) {
+      uint32_t pos =
+          num_larger_seen + (before & 0xffff) + min(ties_before, num_ties);
+      uint32_t idx = in_idxs != nullptr ? in_idxs[i] : begin + i;
+      if (sort_result) {
+        sorted_keys[pos] = key;
+        sorted_idxs[pos] = idx;
+      } else {
+        out[pos] = FromRadixOrder<KT>(key);
+        out_idxs[pos] = idx;
+      }
+    }
+    num_larger_seen += total & 0xffff;
+    num_ties_seen += total >> 16;
+    if (num_larger_seen + min(num_ties_seen, num_ties) == num_selected) {
+      break;
+    }
+  }
+
+  if (!sort_result) {
+    for (uint32_t i = num_selected + threadIdx.x; i < k; i += blockDim.x) {
+      out[i] = FromRadixOrder<KT>(0);
+      out_idxs[i] = kRadixSelectPaddingIndex;
+    }
+    return;
+  }
+
+  for (uint32_t i = num_selected + threadIdx.x; i < sorted_size;
+       i += blockDim.x) {
+    sorted_keys[i] = 0;
+    sorted_idxs[i] = kRadixSelectPaddingIndex;
+  }
+  for (uint32_t merge_size = 2; merge_size <= sorted_size; merge_size *= 2) {
+    for (uint32_t stride = merge_size / 2; stride > 0; stride /= 2) {
+      __syncthreads();
+      for (uint32_t i = threadIdx.x; i < sorted_size; i += blockDim.x) {
+        uint32_t j = i ^ stride;
+        if (j <= i) continue;
+        bool in_order = sorted_keys[i] == sorted_keys[j]
+                            ? sorted_idxs[i] < sorted_idxs[j]
+                            : sorted_keys[i] > sorted_keys[j];
+        if (((i & merge_size) == 0) != in_order) {
+          uint32_t key = sorted_keys[i];
+          uint32_t idx = sorted_idxs[i];
+          sorted_keys[i] = sorted_keys[j];
+          sorted_idxs[i] = sorted_idxs[j];
+          sorted_keys[j] = key;
+          sorted_idxs[j] = idx;
+        }
+      }
+    }
+  }
+  __syncthreads();
+  for (uint32_t i = threadIdx.x; i < k; i += blockDim.x) {
+    out[i] = FromRadixOrder<KT>(sorted_keys[i]);
+    out_idxs[i] = sorted_idxs[i];
+  }
+}
+
+template <typename T>
+void* GetTopKRadixSelectKernel() {
+  return reinterpret_cast<void*>(&RadixSelectTopK<T>);
+}
+
 template <typename T>
 int32_t GetTopKWaveFrontSize() {
   return WAVEFRONT_SIZE;
@@ -25,5 +25,6 @@ template void* GetTopKKernelForK<bfloat16, 8>(int n);
 template void* GetTopKKernelForK<bfloat16, 16>(int n);
 
 template int32_t GetTopKWaveFrontSize<bfloat16>();
+template void* GetTopKRadixSelectKernel<bfloat16>();
 
 }  // namespace xla::gpu
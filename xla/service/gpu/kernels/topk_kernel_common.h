@@ -34,6 +34,10 @@ void* GetTopKKernelForK(int n);
 template <typename T>
 int32_t GetTopKWaveFrontSize();
 
+// Returns the radix select TopK kernel for large k, see RadixSelectTopK.
+template <typename T>
+void* GetTopKRadixSelectKernel();
+
 }  // namespace xla::gpu
 
 #endif  // XLA_SERVICE_GPU_KERNELS_TOPK_KERNEL_COMMON_H_
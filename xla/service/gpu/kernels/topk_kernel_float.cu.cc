@@ -24,5 +24,6 @@ template void* GetTopKKernelForK<float, 8>(int n);
 template void* GetTopKKernelForK<float, 16>(int n);
 
 template int32_t GetTopKWaveFrontSize<float>();
+template void* GetTopKRadixSelectKernel<float>();
 
 }  // namespace xla::gpu
@@ -27,6 +27,22 @@ limitations under the License.
 namespace xla {
 namespace gpu {
 
+int64_t GetPersistentGridNumBlocks(int64_t num_blocks,
+                                   int64_t threads_per_block,
+                                   const se::DeviceDescription& gpu_device_info,
+                                   int64_t min_waves) {
+  if (min_waves <= 0 || threads_per_block <= 0) {
+    return num_blocks;
+  }
+  int64_t blocks_per_core = std::max<int64_t>(
+      1, gpu_device_info.threads_per_core_limit() / threads_per_block);
+  int64_t blocks_per_wave = blocks_per_core * gpu_device_info.core_count();
+  if (num_blocks < min_waves * blocks_per_wave) {
+    return num_blocks;
+  }
+  return blocks_per_wave;
+}
+
 LaunchDimensions CalculateLaunchDimensions(
     const Shape& shape, const se::DeviceDescription& gpu_device_info,
     LaunchDimensionsConfig dim_config) {
@@ -39,7 +55,9 @@ LaunchDimensions CalculateLaunchDimensions(
   const int kWarpSchedulers = 4;
   int64_t threads_per_block = std::min<int64_t>(
       gpu_device_info.threads_per_warp() * kWarpSchedulers, num_elements);
-  int64_t num_blocks = CeilOfRatio(num_elements, threads_per_block);
+  int64_t num_blocks = GetPersistentGridNumBlocks(
+      CeilOfRatio(num_elements, threads_per_block), threads_per_block,
+      gpu_device_info, dim_config.persistent_grid_min_waves);
   return LaunchDimensions(se::BlockDim(num_blocks, 1, 1),
                           se::ThreadDim(threads_per_block, 1, 1));
 }
@@ -85,8 +85,26 @@ struct LaunchDimensionsConfig {
   // The kernel implementation will be unrolled if `unroll_factor` is
   // greater than one.
   int unroll_factor = 1;
+
+  // If positive, grids that would take at least this many waves of resident
+  // blocks are capped at a single wave, see GetPersistentGridNumBlocks. Only
+  // emitters whose indexing iterates over the remaining elements (e.g. via
+  // the chunk symbol of GetDefaultThreadIdIndexingMap) may set this.
+  int64_t persistent_grid_min_waves = 0;
 };
 
+// Returns the number of blocks to launch for a kernel that needs `num_blocks`
+// blocks of `threads_per_block` threads. If that would take at least
+// `min_waves` waves of blocks resident on all cores at once, returns the
+// number of blocks in one such wave: launching a persistent grid whose blocks
+// iterate over the remaining work avoids the block scheduling overhead and the
+// partially occupied last wave. Otherwise, or if `min_waves` is not positive,
+// returns `num_blocks`.
+int64_t GetPersistentGridNumBlocks(int64_t num_blocks,
+                                   int64_t threads_per_block,
+                                   const se::DeviceDescription& gpu_device_info,
+                                   int64_t min_waves);
+
 // Returns -1 if the shape doesn't allow the row vectorization code path.
 // If supported, return the number of threads to use in that case.
 int64_t ThreadsPerBlockRowVectorized(
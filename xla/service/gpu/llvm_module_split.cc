@@ -0,0 +1,187 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/llvm_module_split.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Constant.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalAlias.h"
+#include "llvm/IR/GlobalValue.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include "tsl/platform/logging.h"
+
+namespace xla::gpu {
+namespace {
+
+// Returns the global values directly referenced by the definition of `gv`,
+// looking through constant expressions and aggregates.
+std::vector<const llvm::GlobalValue*> ReferencedGlobals(
+    const llvm::GlobalValue& gv) {
+  llvm::SmallVector<const llvm::Constant*> worklist;
+  llvm::SmallPtrSet<const llvm::Constant*, 16> visited;
+  auto push = [&](const llvm::Value* value) {
+    const auto* constant = llvm::dyn_cast<llvm::Constant>(value);
+    if (constant != nullptr && visited.insert(constant).second) {
+      worklist.push_back(constant);
+    }
+  };
+  if (const auto* func = llvm::dyn_cast<llvm::Function>(&gv)) {
+    for (const llvm::BasicBlock& block : *func) {
+      for (const llvm::Instruction& instruction : block) {
+        for (const llvm::Value* operand : instruction.operands()) {
+          push(operand);
+        }
+      }
+    }
+  } else if (const auto* var = llvm::dyn_cast<llvm::GlobalVariable>(&gv)) {
+    if (var->hasInitializer()) {
+      push(var->getInitializer());
+    }
+  } else if (const auto* alias = llvm::dyn_cast<llvm::GlobalAlias>(&gv)) {
+    push(alias->getAliasee());
+  }
+
+  std::vector<const llvm::GlobalValue*> result;
+  while (!worklist.empty()) {
+    const llvm::Constant* constant = worklist.pop_back_val();
+    if (const auto* global = llvm::dyn_cast<llvm::GlobalValue>(constant)) {
+      result.push_back(global);
+      continue;
+    }
+    for (const llvm::Value* operand : constant->operands()) {
+      push(operand);
+    }
+  }
+  return result;
+}
+
+// Local definitions have to be cloned into every shard that uses them.
+// Appending globals like llvm.used are merged by the linker, so every shard
+// gets its own copy of them as well.
+bool IsClonedIntoEveryUser(const llvm::GlobalValue& gv) {
+  return gv.hasLocalLinkage() || gv.hasAppendingLinkage();
+}
+
+// A definition that has to be placed in a shard together with the local
+// definitions it transitively references.
+struct Definition {
+  std::vector<const llvm::GlobalValue*> globals;
+  int64_t cost = 0;
+};
+
+Definition GetDefinition(const llvm::GlobalValue& root) {
+  Definition definition;
+  definition.globals.push_back(&root);
+  absl::flat_hash_set<const llvm::GlobalValue*> seen = {&root};
+  for (int i = 0; i < definition.globals.size(); ++i) {
+    const llvm::GlobalValue* current = definition.globals[i];
+    if (const auto* func = llvm::dyn_cast<llvm::Function>(current)) {
+      definition.cost += func->getInstructionCount();
+    }
+    for (const llvm::GlobalValue* referenced : ReferencedGlobals(*current)) {
+      if (!referenced->isDeclaration() && IsClonedIntoEveryUser(*referenced) &&
+          seen.insert(referenced).second) {
+        definition.globals.push_back(referenced);
+      }
+    }
+  }
+  return definition;
+}
+
+struct Shard {
+  absl::flat_hash_set<const llvm::GlobalValue*> globals;
+  int64_t cost = 0;
+  int64_t num_definitions = 0;
+};
+
+}  // namespace
+
+void SplitModuleByCost(
+    const llvm::Module& module, int num_shards,
+    absl::FunctionRef<void(std::unique_ptr<llvm::Module>)> callback) {
+  std::vector<Definition> definitions;
+  std::vector<Definition> cloned_everywhere;
+  for (const llvm::GlobalValue& gv : module.global_values()) {
+    if (gv.isDeclaration()) {
+      continue;
+    }
+    if (gv.hasAppendingLinkage()) {
+      cloned_everywhere.push_back(GetDefinition(gv));
+    } else if (!gv.hasLocalLinkage()) {
+      definitions.push_back(GetDefinition(gv));
+    }
+  }
+  if (definitions.empty()) {
+    callback(llvm::CloneModule(module));
+    return;
+  }
+
+  // Longest processing time first: place the most expensive definitions
+  // first, each into the shard with the lowest cost so far. Ties go to the
+  // shard with fewer definitions so that zero-cost globals spread out too.
+  std::stable_sort(definitions.begin(), definitions.end(),
+                   [](const Definition& a, const Definition& b) {
+                     return a.cost > b.cost;
+                   });
+  num_shards = std::clamp<int>(num_shards, 1, definitions.size());
+  std::vector<Shard> shards(num_shards);
+  for (const Definition& definition : definitions) {
+    Shard& shard = *std::min_element(
+        shards.begin(), shards.end(), [](const Shard& a, const Shard& b) {
+          return a.cost != b.cost ? a.cost < b.cost
+                                  : a.num_definitions < b.num_definitions;
+        });
+    shard.globals.insert(definition.globals.begin(), definition.globals.end());
+    shard.cost += definition.cost;
+    ++shard.num_definitions;
+  }
+  std::stable_sort(
+      shards.begin(), shards.end(),
+      [](const Shard& a, const Shard& b) { return a.cost > b.cost; });
+
+  for (Shard& shard : shards) {
+    if (shard.num_definitions == 0) {
+      continue;
+    }
+    for (const Definition& definition : cloned_everywhere) {
+      shard.globals.insert(definition.globals.begin(),
+                           definition.globals.end());
+    }
+    VLOG(3) << "Module shard with " << shard.num_definitions
+            << " definitions and an estimated cost of " << shard.cost;
+    llvm::ValueToValueMapTy value_map;
+    callback(llvm::CloneModule(
+        module, value_map, [&shard](const llvm::GlobalValue* gv) {
+          return shard.globals.contains(gv);
+        }));
+  }
+}
+
+}  // namespace xla::gpu
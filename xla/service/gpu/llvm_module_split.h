@@ -0,0 +1,45 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_LLVM_MODULE_SPLIT_H_
+#define XLA_SERVICE_GPU_LLVM_MODULE_SPLIT_H_
+
+#include <memory>
+
+#include "absl/functional/function_ref.h"
+#include "llvm/IR/Module.h"
+
+namespace xla::gpu {
+
+// Splits `module` into at most `num_shards` modules that can be compiled
+// independently and linked afterwards. Every externally visible definition is
+// placed in exactly one shard, local definitions are cloned into every shard
+// that references them.
+//
+// Unlike llvm::SplitModule, which balances the number of definitions, the
+// externally visible definitions are distributed by their estimated compile
+// cost: the number of IR instructions of a function plus those of the local
+// functions it references. In decreasing order of cost, every definition goes
+// to the currently cheapest shard, so that a single huge kernel gets a shard of
+// its own instead of serializing the tail of a parallel compilation. The
+// shards are passed to `callback` in decreasing order of their total cost;
+// compiling them in this order starts the longest compilations first.
+void SplitModuleByCost(
+    const llvm::Module& module, int num_shards,
+    absl::FunctionRef<void(std::unique_ptr<llvm::Module>)> callback);
+
+}  // namespace xla::gpu
+
+#endif  // XLA_SERVICE_GPU_LLVM_MODULE_SPLIT_H_
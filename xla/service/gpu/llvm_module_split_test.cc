@@ -0,0 +1,117 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/llvm_module_split.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/SourceMgr.h"
+
+namespace xla::gpu {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+constexpr char kModule[] = R"(
+define internal float @helper(float %x) {
+  %y = fadd float %x, 1.0
+  ret float %y
+}
+
+define void @big(ptr %p) {
+  %a = load float, ptr %p
+  %b = call float @helper(float %a)
+  %c = fmul float %b, %b
+  %d = fmul float %c, %c
+  %e = fmul float %d, %d
+  %f = fmul float %e, %e
+  store float %f, ptr %p
+  ret void
+}
+
+define void @small1(ptr %p) {
+  %a = load float, ptr %p
+  %b = call float @helper(float %a)
+  store float %b, ptr %p
+  ret void
+}
+
+define void @small2(ptr %p) {
+  store float 0.0, ptr %p
+  ret void
+}
+
+define void @small3(ptr %p) {
+  store float 1.0, ptr %p
+  ret void
+})";
+
+class SplitModuleByCostTest : public ::testing::Test {
+ protected:
+  std::vector<std::vector<std::string>> Split(int num_shards) {
+    llvm::SMDiagnostic error;
+    std::unique_ptr<llvm::Module> module =
+        llvm::parseAssemblyString(kModule, error, context_);
+    EXPECT_NE(module, nullptr) << error.getMessage().str();
+    std::vector<std::vector<std::string>> shards;
+    SplitModuleByCost(*module, num_shards,
+                      [&](std::unique_ptr<llvm::Module> shard) {
+                        EXPECT_FALSE(llvm::verifyModule(*shard, &llvm::errs()));
+                        std::vector<std::string>& defined =
+                            shards.emplace_back();
+                        for (const llvm::Function& func : shard->functions()) {
+                          if (!func.isDeclaration()) {
+                            defined.push_back(func.getName().str());
+                          }
+                        }
+                      });
+    return shards;
+  }
+
+  llvm::LLVMContext context_;
+};
+
+TEST_F(SplitModuleByCostTest, ExpensiveFunctionGetsItsOwnShard) {
+  // @big costs as much as all the other kernels together.
+  EXPECT_THAT(Split(2),
+              ElementsAre(UnorderedElementsAre("helper", "big"),
+                          UnorderedElementsAre("helper", "small1", "small2",
+                                               "small3")));
+}
+
+TEST_F(SplitModuleByCostTest, ShardsAreOrderedByDecreasingCost) {
+  EXPECT_THAT(Split(10),
+              ElementsAre(UnorderedElementsAre("helper", "big"),
+                          UnorderedElementsAre("helper", "small1"),
+                          ElementsAre("small2"), ElementsAre("small3")));
+}
+
+TEST_F(SplitModuleByCostTest, SingleShardKeepsAllDefinitions) {
+  EXPECT_THAT(Split(1), ElementsAre(UnorderedElementsAre(
+                            "helper", "big", "small1", "small2", "small3")));
+}
+
+}  // namespace
+}  // namespace xla::gpu
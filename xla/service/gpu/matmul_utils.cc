@@ -32,6 +32,7 @@ limitations under the License.
 #include "absl/types/span.h"
 #include "xla/autotuning.pb.h"
 #include "xla/hlo/ir/hlo_casting_utils.h"
+#include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_instructions.h"
 #include "xla/hlo/ir/hlo_opcode.h"
@@ -828,10 +829,12 @@ absl::StatusOr<se::gpu::BlasLt::Epilogue> AsBlasLtEpilogue(
   TF_RET_CHECK(proto.num_stages() > 0);
   TF_RET_CHECK(proto.num_warps() > 0);
   TF_RET_CHECK(proto.num_ctas() > 0);
+  TF_RET_CHECK(!proto.atomic_split_k() || proto.split_k() > 1);
 
   return TritonGemmConfig(proto.block_m(), proto.block_n(), proto.block_k(),
                           proto.split_k(), proto.num_stages(),
-                          proto.num_warps(), proto.num_ctas());
+                          proto.num_warps(), proto.num_ctas(),
+                          proto.atomic_split_k());
 }
 
 AutotuneResult::TritonGemmKey TritonGemmConfig::ToProto() const {
@@ -843,6 +846,7 @@ AutotuneResult::TritonGemmKey TritonGemmConfig::ToProto() const {
   key.set_num_stages(num_stages);
   key.set_num_warps(num_warps);
   key.set_num_ctas(num_ctas);
+  key.set_atomic_split_k(atomic_split_k);
   return key;
 }
 
@@ -850,7 +854,8 @@ std::string TritonGemmConfig::ToString() const {
   return absl::StrCat("{block_m:", block_m, ",block_n:", block_n,
                       ",block_k:", block_k, ",split_k:", split_k,
                       ",num_stages:", num_stages, ",num_warps:", num_warps,
-                      ",num_ctas:", num_ctas, "}");
+                      ",num_ctas:", num_ctas,
+                      atomic_split_k ? ",atomic_split_k" : "", "}");
 }
 
 absl::StatusOr<bool> IsMatrixMultiplicationTooSmallForRewriting(
@@ -906,5 +911,12 @@ bool IsDotSupportedByClassicalEmitters(const HloInstruction& dot) {
   }
 }
 
+bool SupportsAtomicSplitK(const HloInstruction& dot) {
+  CHECK_EQ(dot.opcode(), HloOpcode::kDot);
+  return dot.shape().element_type() == F32 &&
+         dot.parent()->root_instruction() == &dot &&
+         Cast<HloDotInstruction>(&dot)->sparse_operands() == 0;
+}
+
 }  // namespace gpu
 }  // namespace xla
@@ -80,6 +80,12 @@ absl::StatusOr<bool> IsMatrixMultiplicationTooSmallForRewriting(
 // so we need to always use cuBLAS or Triton for those.
 bool IsDotSupportedByClassicalEmitters(const HloInstruction& dot);
 
+// Returns true if a Triton GEMM fusion computing `dot` can reduce split-K
+// partial results with atomic additions to its output: the dot has to be the
+// root of the fusion, as epilogues can't be applied to partial results, and
+// produce F32.
+bool SupportsAtomicSplitK(const HloInstruction& dot);
+
 // extending plain MatrixLayout struct with creator functions
 struct MatrixLayout : public se::gpu::MatrixLayout {
   // Returns the matrix layout for a logical shape (batch, rows, columns).
@@ -176,14 +182,16 @@ absl::StatusOr<se::gpu::BlasLt::Epilogue> AsBlasLtEpilogue(
 struct TritonGemmConfig {
   constexpr TritonGemmConfig() = default;
   constexpr TritonGemmConfig(int block_m, int block_n, int block_k, int split_k,
-                             int num_stages, int num_warps, int num_ctas = 1)
+                             int num_stages, int num_warps, int num_ctas = 1,
+                             bool atomic_split_k = false)
       : block_m(block_m),
         block_n(block_n),
         block_k(block_k),
         split_k(split_k),
         num_stages(num_stages),
         num_warps(num_warps),
-        num_ctas(num_ctas) {}
+        num_ctas(num_ctas),
+        atomic_split_k(atomic_split_k) {}
   int block_m = 0;
   int block_n = 0;
   int block_k = 0;
@@ -192,6 +200,9 @@ struct TritonGemmConfig {
   int num_warps = 0;
   // Number of blocks in a block cluster.
   int num_ctas = 0;
+  // If true, the GEMM fusion is not rewritten into split-K batch form, and the
+  // kernel adds its partial results atomically to the zero-initialized output.
+  bool atomic_split_k = false;
 
   // When adding new members, please update all methods, such as ToTuple,
   // FromProto, ToProto, ToString, etc. Updating ToTuple is not enough.
@@ -203,7 +214,7 @@ struct TritonGemmConfig {
  private:
   auto ToTuple() const {
     return std::make_tuple(block_m, block_n, block_k, split_k, num_stages,
-                           num_warps, num_ctas);
+                           num_warps, num_ctas, atomic_split_k);
   }
 
  public:
@@ -213,6 +224,10 @@ struct TritonGemmConfig {
       const AutotuneResult::TritonGemmKey& proto);
   AutotuneResult::TritonGemmKey ToProto() const;
 
+  // Returns true if the fusion has to be rewritten into the split-K batch
+  // form with a separate reduction.
+  bool NeedsSplitKRewrite() const { return split_k > 1 && !atomic_split_k; }
+
   std::string ToString() const;
 
   bool operator==(const TritonGemmConfig& other) const {
@@ -40,6 +40,13 @@ auto* xla_device_binary_size = tsl::monitoring::Gauge<int64_t, 0>::New(
     "/xla/service/gpu/xla_device_binary_size",
     "The size of the XLA binary loaded onto the GPU device.");
 
+auto* command_buffer_captured_instructions_count =
+    tsl::monitoring::Counter<1>::New(
+        "/xla/service/gpu/command_buffer_captured_instructions_count",
+        "Number of load-bearing instructions that were (or were not) captured "
+        "into command buffers.",
+        "captured");
+
 }  // namespace
 
 void RecordHloPassesDuration(const uint64_t time_usecs) {
@@ -93,4 +100,20 @@ void RecordXlaDeviceBinarySize(const int64_t size) {
   xla_device_binary_size->GetCell()->Set(size);
 }
 
+void RecordCommandBufferCapturedInstructions(const int64_t num_captured,
+                                             const int64_t num_total) {
+  static auto* captured_cell =
+      command_buffer_captured_instructions_count->GetCell("true");
+  static auto* not_captured_cell =
+      command_buffer_captured_instructions_count->GetCell("false");
+  captured_cell->IncrementBy(num_captured);
+  not_captured_cell->IncrementBy(num_total - num_captured);
+}
+
+int64_t GetCommandBufferCapturedInstructionsCount(bool captured) {
+  return command_buffer_captured_instructions_count
+      ->GetCell(captured ? "true" : "false")
+      ->value();
+}
+
 }  // namespace xla
@@ -52,6 +52,16 @@ int64_t GetCompiledProgramsCount();
 // Records the size of the XLA device binary in bytes.
 void RecordXlaDeviceBinarySize(int64_t size);
 
+// Records how many load-bearing instructions (instructions that launch work on
+// the device) of a compiled program were captured into command buffers, out of
+// `num_total` load-bearing instructions.
+void RecordCommandBufferCapturedInstructions(int64_t num_captured,
+                                             int64_t num_total);
+
+// Gets the number of instructions recorded as captured (or not captured) into
+// command buffers.
+int64_t GetCommandBufferCapturedInstructionsCount(bool captured);
+
 }  // namespace xla
 
 #endif  // XLA_SERVICE_GPU_METRICS_H_
@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/service/gpu/model/analytical_latency_estimator.h"
 
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include "absl/log/log.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/hlo/utils/hlo_query.h"
 #include "xla/service/gpu/model/gpu_collective_performance_model.h"
+#include "xla/service/gpu/model/gpu_collective_topology.h"
 #include "xla/service/gpu/model/gpu_hlo_cost_analysis.h"
 #include "xla/service/gpu/model/gpu_performance_model.h"
 #include "xla/service/gpu/model/gpu_performance_model_base.h"
@@ -45,7 +47,8 @@ LatencyEstimator::TimeCost AnalyticalLatencyEstimator::GetLatencyBetween(
   if (IsAsyncPair(from, target)) {
     double coll_time = absl::ToDoubleMicroseconds(
         GpuPerformanceWithCollectiveModel::ComputeCollectiveTime(
-            from.GetInstr(), &*cost_analysis_, gpu_info_));
+            from.GetInstr(), &*cost_analysis_, gpu_info_,
+            topology_.has_value() ? &*topology_ : nullptr));
     VLOG(10) << "Analytical estimator calculated latency between "
              << from.GetInstr().name() << " and " << target.GetInstr().name()
              << " to be: " << coll_time << " us.";
@@ -78,11 +81,12 @@ AnalyticalLatencyEstimator::AnalyticalLatencyEstimator(
     std::unique_ptr<LatencyEstimator> latency_estimator,
     const se::DeviceDescription& gpu_info,
     HloCostAnalysis::ShapeSizeFunction shape_size_function,
-    HloComputation* computation)
+    HloComputation* computation, std::optional<GpuCollectiveTopology> topology)
     : config_(config),
       gpu_info_(gpu_info),
       latency_estimator_(std::move(latency_estimator)),
-      shape_size_function_(shape_size_function) {
+      shape_size_function_(shape_size_function),
+      topology_(std::move(topology)) {
   cost_analysis_.emplace(
       GpuHloCostAnalysis::Options{shape_size_function_,
                                   /*per_second_rates=*/{},
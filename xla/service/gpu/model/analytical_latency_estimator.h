@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/service/gpu/model/gpu_collective_topology.h"
 #include "xla/service/gpu/model/gpu_hlo_cost_analysis.h"
 #include "xla/service/hlo_cost_analysis.h"
 #include "xla/service/latency_hiding_scheduler.h"
@@ -38,7 +39,8 @@ class AnalyticalLatencyEstimator : public LatencyEstimator {
       std::unique_ptr<LatencyEstimator> latency_estimator,
       const se::DeviceDescription& gpu_info,
       HloCostAnalysis::ShapeSizeFunction shape_size_function,
-      HloComputation* computation);
+      HloComputation* computation,
+      std::optional<GpuCollectiveTopology> topology = std::nullopt);
 
   TimeCost GetLatencyBetween(const HloGraphNode& from,
                              const HloGraphNode& target) const override;
@@ -56,6 +58,7 @@ class AnalyticalLatencyEstimator : public LatencyEstimator {
   std::optional<GpuHloCostAnalysis> cost_analysis_;
   std::unique_ptr<LatencyEstimator> latency_estimator_;
   HloCostAnalysis::ShapeSizeFunction shape_size_function_;
+  std::optional<GpuCollectiveTopology> topology_;
 };
 
 }  // namespace gpu
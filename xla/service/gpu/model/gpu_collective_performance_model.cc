@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <optional>
 #include <vector>
 
 #include "absl/log/check.h"
@@ -27,8 +28,10 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/service/gpu/backend_configs.pb.h"
+#include "xla/service/gpu/model/gpu_collective_topology.h"
 #include "xla/service/gpu/model/gpu_hlo_cost_analysis.h"
 #include "xla/service/hlo_dataflow_analysis.h"
+#include "xla/shape.h"
 #include "xla/stream_executor/device_description.h"
 #include "xla/util.h"
 
@@ -281,7 +284,8 @@ GpuPerformanceWithCollectiveModel::ComputeAllreduceTime(
 /*static*/ absl::Duration
 GpuPerformanceWithCollectiveModel::ComputeCollectiveTime(
     const HloInstruction& instr, const GpuHloCostAnalysis* cost_analysis,
-    const se::DeviceDescription& gpu_device_info) {
+    const se::DeviceDescription& gpu_device_info,
+    const GpuCollectiveTopology* topology) {
   if (cost_analysis->NumOfDevices(instr) == 1) {
     VLOG(8) << "Returning only kernel launch overhead for a single partition.";
     return kNcclKernelLaunchOverhead;
@@ -291,6 +295,17 @@ GpuPerformanceWithCollectiveModel::ComputeCollectiveTime(
     VLOG(8) << "Returning 0 cost for async done op " << instr.name();
     return absl::ZeroDuration();
   }
+
+  if (topology != nullptr) {
+    auto shape_size = [&](const Shape& shape) {
+      return cost_analysis->GetShapeSize(shape);
+    };
+    if (std::optional<absl::Duration> collective_time =
+            EstimateCollectiveTime(instr, *topology, shape_size)) {
+      return kNcclKernelLaunchOverhead + *collective_time;
+    }
+  }
+
   switch (instr.opcode()) {
     case HloOpcode::kAllReduce:
     case HloOpcode::kAllReduceStart:
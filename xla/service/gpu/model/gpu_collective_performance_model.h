@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "absl/time/time.h"
 #include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/service/gpu/model/gpu_collective_topology.h"
 #include "xla/service/gpu/model/gpu_hlo_cost_analysis.h"
 #include "xla/service/gpu/model/gpu_performance_model_base.h"
 #include "xla/stream_executor/device_description.h"
@@ -101,9 +102,13 @@ class GpuPerformanceWithCollectiveModel : public GpuPerformanceModelBase {
   static constexpr absl::Duration kNcclKernelLaunchOverhead =
       absl::Microseconds(5);
 
+  // Estimates the run time of a collective. If `topology` is not null,
+  // all-reduce, all-gather and reduce-scatter costs are estimated for the
+  // algorithm that is the fastest on the given topology.
   static absl::Duration ComputeCollectiveTime(
       const HloInstruction& instr, const GpuHloCostAnalysis* cost_analysis,
-      const se::DeviceDescription& gpu_device_info);
+      const se::DeviceDescription& gpu_device_info,
+      const GpuCollectiveTopology* topology = nullptr);
 
   // Returns NVLink bw in GB/s
   static float GetNvlinkBw(se::CudaComputeCapability compute_capability);
@@ -0,0 +1,379 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/model/gpu_collective_topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "xla/hlo/ir/hlo_casting_utils.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/service/collective_ops_utils.h"
+#include "xla/service/hlo_cost_analysis.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/xla.pb.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::gpu {
+namespace {
+
+// Combined collectives are limited to this range of sizes regardless of the
+// topology, to keep the memory overhead of combining under control.
+constexpr int64_t kMinCombineThresholdBytes = 1024 * 1024;
+constexpr int64_t kMaxCombineThresholdBytes = 256 * 1024 * 1024;
+
+// We consider latency amortized when the collective takes this many times
+// longer than a collective of an empty buffer.
+constexpr int64_t kCombineLatencyAmortization = 10;
+
+// A link that bounds the performance of a collective algorithm.
+struct Link {
+  double bandwidth;  // GB/s
+  absl::Duration latency;
+};
+
+int64_t NumNodes(int64_t num_devices, const GpuCollectiveTopology& topology) {
+  return (num_devices + topology.devices_per_node - 1) /
+         topology.devices_per_node;
+}
+
+// Ring algorithms proceed in lock step, so every step is as slow as the
+// slowest link of the ring.
+Link BottleneckLink(int64_t num_nodes, const GpuCollectiveTopology& topology) {
+  if (num_nodes == 1) {
+    return {topology.intra_node_bandwidth, topology.intra_node_latency};
+  }
+  return {std::min(topology.intra_node_bandwidth,
+                   topology.inter_node_bandwidth),
+          topology.inter_node_latency};
+}
+
+absl::Duration TransferTime(double bytes, double bandwidth) {
+  return absl::Seconds(bytes / (bandwidth * 1e9));
+}
+
+// Ring algorithm sends a `1 / num_devices` chunk of the buffer at each of the
+// `num_steps` steps.
+absl::Duration RingTime(int64_t bytes, int64_t num_devices, int64_t num_steps,
+                        const Link& link) {
+  return num_steps * link.latency +
+         TransferTime(static_cast<double>(bytes) * num_steps / num_devices,
+                      link.bandwidth);
+}
+
+// Tree all-reduce reduces data along a chain of devices within a node and
+// along a (double) binary tree across nodes, and then broadcasts the result
+// back. It has a logarithmic latency in the number of nodes, but every device
+// sends and receives the whole buffer.
+absl::Duration TreeAllReduceTime(int64_t bytes, int64_t num_devices,
+                                 const GpuCollectiveTopology& topology) {
+  int64_t num_nodes = NumNodes(num_devices, topology);
+  int64_t local_devices = std::min(num_devices, topology.devices_per_node);
+  int64_t tree_depth = std::ceil(std::log2(num_nodes));
+
+  absl::Duration latency =
+      2 * ((local_devices - 1) * topology.intra_node_latency +
+           tree_depth * topology.inter_node_latency);
+  Link link = BottleneckLink(num_nodes, topology);
+  return latency + TransferTime(2.0 * bytes, link.bandwidth);
+}
+
+// All-to-all sends a `1 / num_devices` chunk of the buffer to every peer with
+// concurrent point-to-point transfers, so chunks for local peers go over the
+// intra-node links while chunks for remote peers go over the network at the
+// same time. Unlike ring algorithms it pays the link latency only once, but
+// its network traffic does not shrink with the number of nodes.
+absl::Duration AllToAllTime(int64_t bytes, int64_t num_devices,
+                            const GpuCollectiveTopology& topology) {
+  int64_t local_devices = std::min(num_devices, topology.devices_per_node);
+  double chunk_bytes = static_cast<double>(bytes) / num_devices;
+
+  absl::Duration intra_node = TransferTime(chunk_bytes * (local_devices - 1),
+                                           topology.intra_node_bandwidth);
+  if (num_devices == local_devices) {
+    return topology.intra_node_latency + intra_node;
+  }
+  absl::Duration inter_node =
+      TransferTime(chunk_bytes * (num_devices - local_devices),
+                   topology.inter_node_bandwidth);
+  return topology.inter_node_latency + std::max(intra_node, inter_node);
+}
+
+// Returns the size of the full buffer of a collective: the larger of its
+// operands and results.
+int64_t CollectiveBufferBytes(
+    const HloInstruction& collective, const Shape& result_shape,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  int64_t operand_bytes = 0;
+  for (const HloInstruction* operand : collective.operands()) {
+    operand_bytes += shape_size(operand->shape());
+  }
+  int64_t result_bytes = 0;
+  ShapeUtil::ForEachSubshape(result_shape,
+                             [&](const Shape& subshape, const ShapeIndex&) {
+                               if (subshape.IsArray()) {
+                                 result_bytes += shape_size(subshape);
+                               }
+                             });
+  return std::max(operand_bytes, result_bytes);
+}
+
+}  // namespace
+
+absl::StatusOr<GpuCollectiveTopology> GpuCollectiveTopology::Parse(
+    absl::string_view spec) {
+  GpuCollectiveTopology topology;
+
+  for (absl::string_view entry : absl::StrSplit(spec, ',', absl::SkipEmpty())) {
+    std::pair<absl::string_view, absl::string_view> kv =
+        absl::StrSplit(entry, absl::MaxSplits('=', 1));
+    absl::string_view key = absl::StripAsciiWhitespace(kv.first);
+    absl::string_view value = absl::StripAsciiWhitespace(kv.second);
+
+    double number;
+    if (!absl::SimpleAtod(value, &number) || number <= 0) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Invalid value of collective topology property ", key, ": ", value));
+    }
+
+    if (key == "devices_per_node") {
+      topology.devices_per_node = static_cast<int64_t>(number);
+    } else if (key == "intra_node_bw") {
+      topology.intra_node_bandwidth = number;
+    } else if (key == "inter_node_bw") {
+      topology.inter_node_bandwidth = number;
+    } else if (key == "intra_node_latency_us") {
+      topology.intra_node_latency = absl::Microseconds(number);
+    } else if (key == "inter_node_latency_us") {
+      topology.inter_node_latency = absl::Microseconds(number);
+    } else {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown collective topology property: ", key));
+    }
+  }
+
+  if (topology.devices_per_node < 1 || topology.intra_node_bandwidth == 0 ||
+      topology.inter_node_bandwidth == 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Collective topology must specify intra_node_bw and inter_node_bw: ",
+        spec));
+  }
+
+  return topology;
+}
+
+absl::StatusOr<std::optional<GpuCollectiveTopology>>
+GpuCollectiveTopology::FromDebugOptions(const DebugOptions& debug_options) {
+  if (debug_options.xla_gpu_collective_topology().empty()) return std::nullopt;
+  TF_ASSIGN_OR_RETURN(
+      GpuCollectiveTopology topology,
+      Parse(debug_options.xla_gpu_collective_topology()));
+  return topology;
+}
+
+std::string GpuCollectiveTopology::ToString() const {
+  return absl::StrFormat(
+      "devices_per_node=%d,intra_node_bw=%g,inter_node_bw=%g,"
+      "intra_node_latency_us=%g,inter_node_latency_us=%g",
+      devices_per_node, intra_node_bandwidth, inter_node_bandwidth,
+      absl::ToDoubleMicroseconds(intra_node_latency),
+      absl::ToDoubleMicroseconds(inter_node_latency));
+}
+
+std::optional<absl::Duration> EstimateCollectiveTime(
+    HloOpcode opcode, int64_t bytes, int64_t num_devices,
+    const GpuCollectiveTopology& topology) {
+  if (num_devices <= 1) return absl::ZeroDuration();
+
+  int64_t num_nodes = NumNodes(num_devices, topology);
+  Link link = BottleneckLink(num_nodes, topology);
+
+  switch (opcode) {
+    case HloOpcode::kAllReduce: {
+      absl::Duration ring =
+          RingTime(bytes, num_devices, 2 * (num_devices - 1), link);
+      // NCCL uses tree algorithm only across multiple nodes.
+      if (num_nodes == 1) return ring;
+      absl::Duration tree = TreeAllReduceTime(bytes, num_devices, topology);
+      VLOG(8) << "All-reduce of " << bytes << " bytes over " << num_devices
+              << " devices: ring=" << ring << "; tree=" << tree;
+      return std::min(ring, tree);
+    }
+    case HloOpcode::kAllGather:
+    case HloOpcode::kReduceScatter:
+      return RingTime(bytes, num_devices, num_devices - 1, link);
+    case HloOpcode::kAllToAll:
+      return AllToAllTime(bytes, num_devices, topology);
+    default:
+      return std::nullopt;
+  }
+}
+
+std::optional<absl::Duration> EstimateCollectiveTime(
+    const HloInstruction& instr, const GpuCollectiveTopology& topology,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  const HloInstruction* collective = &instr;
+  if (instr.opcode() == HloOpcode::kAsyncStart) {
+    collective = instr.async_wrapped_instruction();
+  }
+
+  // Async start of all-gather returns a tuple of operands and results.
+  HloOpcode opcode = collective->opcode();
+  const Shape* result_shape = &collective->shape();
+  if (opcode == HloOpcode::kAllReduceStart) {
+    opcode = HloOpcode::kAllReduce;
+  } else if (opcode == HloOpcode::kAllGatherStart) {
+    opcode = HloOpcode::kAllGather;
+    result_shape = &collective->shape().tuple_shapes(1);
+  }
+
+  if (opcode != HloOpcode::kAllReduce && opcode != HloOpcode::kAllGather &&
+      opcode != HloOpcode::kReduceScatter && opcode != HloOpcode::kAllToAll) {
+    return std::nullopt;
+  }
+
+  absl::StatusOr<int64_t> num_devices = GetCollectiveNumDevices(*collective);
+  if (!num_devices.ok()) {
+    VLOG(8) << "Can't get the number of devices of " << instr.name() << ": "
+            << num_devices.status();
+    return std::nullopt;
+  }
+
+  return EstimateCollectiveTime(
+      opcode, CollectiveBufferBytes(*collective, *result_shape, shape_size),
+      *num_devices, topology);
+}
+
+absl::StatusOr<int64_t> GetCollectiveNumDevices(const HloInstruction& instr) {
+  auto* collective = DynCast<HloCollectiveInstruction>(&instr);
+  if (collective == nullptr) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Not a collective instruction: ", instr.name()));
+  }
+
+  std::optional<bool> use_global_device_ids;
+  if (auto* all_reduce = DynCast<HloAllReduceInstructionBase>(&instr)) {
+    use_global_device_ids = all_reduce->use_global_device_ids();
+  } else if (auto* all_gather = DynCast<HloAllGatherInstruction>(&instr)) {
+    use_global_device_ids = all_gather->use_global_device_ids();
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      CollectiveOpGroupMode group_mode,
+      GetCollectiveOpGroupMode(collective->channel_id().has_value(),
+                               use_global_device_ids));
+
+  const HloModuleConfig& config = instr.GetModule()->config();
+  TF_ASSIGN_OR_RETURN(
+      std::vector<int64_t> participant_counts,
+      GetPariticipantCountsForReplicaGroups(
+          config.replica_count(), config.num_partitions(),
+          collective->replica_groups(), group_mode));
+
+  int64_t num_devices = 1;
+  for (int64_t count : participant_counts) {
+    num_devices = std::max(num_devices, count);
+  }
+  return num_devices;
+}
+
+int64_t SuggestCombineThresholdBytes(HloOpcode opcode, int64_t num_devices,
+                                     const GpuCollectiveTopology& topology) {
+  std::optional<absl::Duration> latency =
+      EstimateCollectiveTime(opcode, /*bytes=*/0, num_devices, topology);
+  if (!latency.has_value() || *latency == absl::ZeroDuration()) {
+    return kMaxCombineThresholdBytes;
+  }
+
+  for (int64_t bytes = kMinCombineThresholdBytes;
+       bytes < kMaxCombineThresholdBytes; bytes *= 2) {
+    if (*EstimateCollectiveTime(opcode, bytes, num_devices, topology) >=
+        kCombineLatencyAmortization * *latency) {
+      return bytes;
+    }
+  }
+  return kMaxCombineThresholdBytes;
+}
+
+int64_t SuggestModuleCombineThresholdBytes(
+    const HloModule& module, HloOpcode opcode,
+    const GpuCollectiveTopology& topology,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  int64_t total_bytes = 0;
+  int64_t num_devices = 1;
+  for (const HloComputation* computation :
+       module.MakeNonfusionComputations()) {
+    for (const HloInstruction* instr : computation->instructions()) {
+      if (instr->opcode() != opcode) continue;
+      absl::StatusOr<int64_t> instr_num_devices =
+          GetCollectiveNumDevices(*instr);
+      if (!instr_num_devices.ok() || *instr_num_devices <= 1) continue;
+      total_bytes += CollectiveBufferBytes(*instr, instr->shape(), shape_size);
+      num_devices = std::max(num_devices, *instr_num_devices);
+    }
+  }
+
+  std::optional<absl::Duration> latency =
+      EstimateCollectiveTime(opcode, /*bytes=*/0, num_devices, topology);
+  if (total_bytes == 0 || !latency.has_value() ||
+      *latency == absl::ZeroDuration()) {
+    return kMaxCombineThresholdBytes;
+  }
+
+  // Estimate time per byte from the time of the largest bucket, so that it
+  // accounts for the algorithm that NCCL picks for large buffers.
+  absl::Duration max_bucket_time = *EstimateCollectiveTime(
+      opcode, kMaxCombineThresholdBytes, num_devices, topology);
+  double seconds_per_byte =
+      absl::ToDoubleSeconds(max_bucket_time - *latency) /
+      kMaxCombineThresholdBytes;
+
+  // Splitting `total_bytes` into buckets of `b` bytes costs `total_bytes / b`
+  // collective latencies, and the last bucket can't be overlapped with the
+  // compute that produces its operands, which exposes its transfer time
+  // `b * seconds_per_byte`. The sum is minimal when both terms are equal.
+  double bucket_bytes = std::sqrt(
+      total_bytes * absl::ToDoubleSeconds(*latency) / seconds_per_byte);
+  int64_t threshold_bytes = std::clamp<int64_t>(
+      bucket_bytes, kMinCombineThresholdBytes, kMaxCombineThresholdBytes);
+
+  VLOG(1) << "Suggested " << HloOpcodeString(opcode) << " combine threshold "
+          << threshold_bytes << " bytes for " << total_bytes
+          << " bytes of collectives over " << num_devices
+          << " devices; latency=" << *latency;
+  return threshold_bytes;
+}
+
+}  // namespace xla::gpu
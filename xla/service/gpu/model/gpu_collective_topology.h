@@ -0,0 +1,105 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_MODEL_GPU_COLLECTIVE_TOPOLOGY_H_
+#define XLA_SERVICE_GPU_MODEL_GPU_COLLECTIVE_TOPOLOGY_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/service/hlo_cost_analysis.h"
+#include "xla/xla.pb.h"
+
+namespace xla::gpu {
+
+// Description of a two-tier collective fabric: devices within a node are
+// connected with a fast interconnect (i.e. NVLink or PCIe), and nodes are
+// connected with a network (i.e. InfiniBand or RoCE). Bandwidths are per
+// device and unidirectional, for rail-optimized networks the inter-node
+// bandwidth is the bandwidth of the NICs attached to a single device.
+struct GpuCollectiveTopology {
+  int64_t devices_per_node = 8;
+
+  double intra_node_bandwidth = 0;  // GB/s
+  double inter_node_bandwidth = 0;  // GB/s
+
+  // Latency of a single algorithm step over a link.
+  absl::Duration intra_node_latency = absl::Microseconds(1);
+  absl::Duration inter_node_latency = absl::Microseconds(5);
+
+  // Parses a topology from a comma-separated list of `key=value` pairs:
+  //
+  //   devices_per_node=8,intra_node_bw=150,inter_node_bw=25,
+  //   intra_node_latency_us=1,inter_node_latency_us=5
+  //
+  // Bandwidths are in GB/s and required, all other keys are optional.
+  static absl::StatusOr<GpuCollectiveTopology> Parse(absl::string_view spec);
+
+  // Returns a topology specified by `xla_gpu_collective_topology` or nullopt
+  // if it's not set.
+  static absl::StatusOr<std::optional<GpuCollectiveTopology>>
+  FromDebugOptions(const DebugOptions& debug_options);
+
+  std::string ToString() const;
+};
+
+// Estimates the run time of the all-reduce, all-gather, reduce-scatter or
+// all-to-all `opcode` over `num_devices` devices using the fastest of the
+// algorithms NCCL could choose (ring or tree, all-to-all is always a set of
+// point-to-point transfers). `bytes` is the size of the full buffer, the
+// output of all-gather and the input of reduce-scatter. Devices are assumed to
+// be packed into nodes, so a collective spans `num_devices / devices_per_node`
+// nodes. Returns nullopt for unsupported opcodes.
+std::optional<absl::Duration> EstimateCollectiveTime(
+    HloOpcode opcode, int64_t bytes, int64_t num_devices,
+    const GpuCollectiveTopology& topology);
+
+// Estimates the run time of a collective instruction (or an async start of a
+// collective instruction) on a `topology`.
+std::optional<absl::Duration> EstimateCollectiveTime(
+    const HloInstruction& instr, const GpuCollectiveTopology& topology,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size);
+
+// Returns the number of devices in the largest replica group of a collective
+// `instr`.
+absl::StatusOr<int64_t> GetCollectiveNumDevices(const HloInstruction& instr);
+
+// Suggests a combiner threshold for `opcode` collectives over `num_devices`
+// devices: the smallest buffer size at which the per-collective latency is
+// amortized by the data transfer time, so combining beyond it brings little
+// benefit but delays the start of the combined collective.
+int64_t SuggestCombineThresholdBytes(HloOpcode opcode, int64_t num_devices,
+                                     const GpuCollectiveTopology& topology);
+
+// Suggests a combiner threshold for `opcode` collectives of a `module`. Larger
+// buckets pay the collective latency fewer times, but the last bucket of the
+// step can start only when all of its operands are ready and its transfer time
+// is not hidden behind compute. We pick the bucket size that minimizes the sum
+// of both costs for all collectives of the module.
+int64_t SuggestModuleCombineThresholdBytes(
+    const HloModule& module, HloOpcode opcode,
+    const GpuCollectiveTopology& topology,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size);
+
+}  // namespace xla::gpu
+
+#endif  // XLA_SERVICE_GPU_MODEL_GPU_COLLECTIVE_TOPOLOGY_H_
@@ -0,0 +1,241 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/model/gpu_collective_topology.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include <gtest/gtest.h>
+#include "absl/log/check.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/tests/hlo_test_base.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::gpu {
+namespace {
+
+using GpuCollectiveTopologyTest = HloTestBase;
+
+GpuCollectiveTopology TestTopology() {
+  GpuCollectiveTopology topology;
+  topology.devices_per_node = 8;
+  topology.intra_node_bandwidth = 150;
+  topology.inter_node_bandwidth = 25;
+  topology.intra_node_latency = absl::Microseconds(1);
+  topology.inter_node_latency = absl::Microseconds(5);
+  return topology;
+}
+
+TEST_F(GpuCollectiveTopologyTest, Parse) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      GpuCollectiveTopology topology,
+      GpuCollectiveTopology::Parse(
+          "devices_per_node=4, intra_node_bw=100,inter_node_bw=50,"
+          "inter_node_latency_us=10"));
+  EXPECT_EQ(topology.devices_per_node, 4);
+  EXPECT_EQ(topology.intra_node_bandwidth, 100);
+  EXPECT_EQ(topology.inter_node_bandwidth, 50);
+  EXPECT_EQ(topology.intra_node_latency, absl::Microseconds(1));
+  EXPECT_EQ(topology.inter_node_latency, absl::Microseconds(10));
+
+  TF_ASSERT_OK_AND_ASSIGN(GpuCollectiveTopology round_trip,
+                          GpuCollectiveTopology::Parse(topology.ToString()));
+  EXPECT_EQ(round_trip.ToString(), topology.ToString());
+}
+
+TEST_F(GpuCollectiveTopologyTest, ParseErrors) {
+  EXPECT_FALSE(GpuCollectiveTopology::Parse("intra_node_bw=100").ok());
+  EXPECT_FALSE(
+      GpuCollectiveTopology::Parse("intra_node_bw=100,inter_node_bw=x").ok());
+  EXPECT_FALSE(GpuCollectiveTopology::Parse(
+                   "intra_node_bw=100,inter_node_bw=50,num_rails=8")
+                   .ok());
+}
+
+TEST_F(GpuCollectiveTopologyTest, InterNodeCollectivesAreSlower) {
+  GpuCollectiveTopology topology = TestTopology();
+  const int64_t bytes = 64 * 1024 * 1024;
+
+  for (HloOpcode opcode : {HloOpcode::kAllReduce, HloOpcode::kAllGather,
+                           HloOpcode::kReduceScatter, HloOpcode::kAllToAll}) {
+    std::optional<absl::Duration> intra_node =
+        EstimateCollectiveTime(opcode, bytes, 8, topology);
+    std::optional<absl::Duration> inter_node =
+        EstimateCollectiveTime(opcode, bytes, 16, topology);
+    ASSERT_TRUE(intra_node.has_value() && inter_node.has_value());
+    EXPECT_GT(*inter_node, *intra_node) << HloOpcodeString(opcode);
+  }
+
+  EXPECT_FALSE(EstimateCollectiveTime(HloOpcode::kCollectivePermute, bytes, 8,
+                                      topology));
+}
+
+TEST_F(GpuCollectiveTopologyTest, AllToAllPaysLatencyOnce) {
+  GpuCollectiveTopology topology = TestTopology();
+
+  // Small all-to-all (i.e. MoE token dispatch) is latency bound, and unlike
+  // all-gather it doesn't pay the latency for every peer.
+  EXPECT_LT(*EstimateCollectiveTime(HloOpcode::kAllToAll, 1024, 64, topology),
+            *EstimateCollectiveTime(HloOpcode::kAllGather, 1024, 64, topology));
+
+  // Across nodes the network carries all but the local chunks of the buffer.
+  const int64_t bytes = 64 * 1024 * 1024;
+  absl::Duration time =
+      *EstimateCollectiveTime(HloOpcode::kAllToAll, bytes, 16, topology);
+  EXPECT_EQ(time, topology.inter_node_latency +
+                      absl::Seconds(bytes / 2 / (topology.inter_node_bandwidth *
+                                                 1e9)));
+}
+
+TEST_F(GpuCollectiveTopologyTest, EstimateAsyncAllToAll) {
+  absl::string_view kHloText = R"(
+  HloModule m, replica_count=8
+
+  ENTRY main {
+    p = f32[1024,1024] parameter(0)
+    start = ((f32[1024,1024]), f32[1024,1024]) all-to-all-start(p),
+      replica_groups={{0,1,2,3,4,5,6,7}}, dimensions={0}
+    ROOT done = f32[1024,1024] all-to-all-done(start)
+  })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloText));
+  HloInstruction* start = FindInstruction(module.get(), "start");
+
+  auto shape_size = [](const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/8);
+  };
+
+  GpuCollectiveTopology topology = TestTopology();
+  EXPECT_EQ(EstimateCollectiveTime(*start, topology, shape_size),
+            EstimateCollectiveTime(HloOpcode::kAllToAll, 4 * 1024 * 1024, 8,
+                                   topology));
+}
+
+TEST_F(GpuCollectiveTopologyTest, TreeAllReduceHasLowerLatencyAcrossNodes) {
+  GpuCollectiveTopology topology = TestTopology();
+
+  // With 64 nodes ring latency is 2 * 511 network steps, while tree latency is
+  // logarithmic in the number of nodes.
+  absl::Duration small =
+      *EstimateCollectiveTime(HloOpcode::kAllReduce, 1024, 512, topology);
+  EXPECT_LT(small, absl::Microseconds(100));
+}
+
+TEST_F(GpuCollectiveTopologyTest, CombineThresholdGrowsWithNetworkLatency) {
+  GpuCollectiveTopology topology = TestTopology();
+
+  int64_t intra_node =
+      SuggestCombineThresholdBytes(HloOpcode::kAllGather, 8, topology);
+  int64_t inter_node =
+      SuggestCombineThresholdBytes(HloOpcode::kAllGather, 64, topology);
+  EXPECT_LT(intra_node, inter_node);
+}
+
+TEST_F(GpuCollectiveTopologyTest, EstimateInstruction) {
+  absl::string_view kHloText = R"(
+  HloModule m, replica_count=16
+
+  add {
+    a = f32[] parameter(0)
+    b = f32[] parameter(1)
+    ROOT add = f32[] add(a, b)
+  }
+
+  ENTRY main {
+    p = f32[1024,1024] parameter(0)
+    ar-intra = f32[1024,1024] all-reduce(p), to_apply=add,
+      replica_groups={{0,1,2,3,4,5,6,7},{8,9,10,11,12,13,14,15}}
+    ROOT ar-inter = f32[1024,1024] all-reduce(ar-intra), to_apply=add,
+      replica_groups={}
+  })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloText));
+  HloInstruction* ar_intra = FindInstruction(module.get(), "ar-intra");
+  HloInstruction* ar_inter = FindInstruction(module.get(), "ar-inter");
+
+  TF_ASSERT_OK_AND_ASSIGN(int64_t num_devices_intra,
+                          GetCollectiveNumDevices(*ar_intra));
+  TF_ASSERT_OK_AND_ASSIGN(int64_t num_devices_inter,
+                          GetCollectiveNumDevices(*ar_inter));
+  EXPECT_EQ(num_devices_intra, 8);
+  EXPECT_EQ(num_devices_inter, 16);
+
+  auto shape_size = [](const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/8);
+  };
+
+  GpuCollectiveTopology topology = TestTopology();
+  EXPECT_EQ(EstimateCollectiveTime(*ar_intra, topology, shape_size),
+            EstimateCollectiveTime(HloOpcode::kAllReduce, 4 * 1024 * 1024, 8,
+                                   topology));
+  EXPECT_GT(*EstimateCollectiveTime(*ar_inter, topology, shape_size),
+            *EstimateCollectiveTime(*ar_intra, topology, shape_size));
+}
+
+TEST_F(GpuCollectiveTopologyTest, ModuleCombineThresholdGrowsWithBytes) {
+  absl::string_view kHloText = R"(
+  HloModule m, replica_count=16
+
+  add {
+    a = f32[] parameter(0)
+    b = f32[] parameter(1)
+    ROOT add = f32[] add(a, b)
+  }
+
+  ENTRY main {
+    p0 = f32[$rows,1024] parameter(0)
+    p1 = f32[$rows,1024] parameter(1)
+    p2 = f32[$rows,1024] parameter(2)
+    p3 = f32[$rows,1024] parameter(3)
+    ar0 = f32[$rows,1024] all-reduce(p0), to_apply=add, replica_groups={}
+    ar1 = f32[$rows,1024] all-reduce(p1), to_apply=add, replica_groups={}
+    ar2 = f32[$rows,1024] all-reduce(p2), to_apply=add, replica_groups={}
+    ar3 = f32[$rows,1024] all-reduce(p3), to_apply=add, replica_groups={}
+    ROOT tuple = tuple(ar0, ar1, ar2, ar3)
+  })";
+
+  auto shape_size = [](const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/8);
+  };
+
+  GpuCollectiveTopology topology = TestTopology();
+  auto suggest = [&](absl::string_view rows) -> int64_t {
+    auto module = ParseAndReturnVerifiedModule(
+        absl::StrReplaceAll(kHloText, {{"$rows", rows}}));
+    CHECK_OK(module.status());
+    return SuggestModuleCombineThresholdBytes(
+        **module, HloOpcode::kAllReduce, topology, shape_size);
+  };
+
+  int64_t small = suggest("1024");
+  int64_t large = suggest("16384");
+  EXPECT_GE(small, 1024 * 1024);
+  EXPECT_LT(small, large);
+  EXPECT_LE(large, 256 * 1024 * 1024);
+}
+
+}  // namespace
+}  // namespace xla::gpu
@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstdint>
 #include <optional>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/time/time.h"
@@ -114,12 +115,21 @@ GpuPerformanceModel::EstimateRunTimeForInstructionCached(
     }
   }
 
-  auto runtime_data =
-      EstimateRunTimeForInstruction(instr, device_info, cost_analysis, config);
+  std::optional<EstimateRunTimeData> persistent_result;
+  if (config.persistent_cache) {
+    persistent_result = config.persistent_cache->Get(*instr, config);
+  }
+  auto runtime_data = persistent_result.has_value()
+                          ? *persistent_result
+                          : EstimateRunTimeForInstruction(
+                                instr, device_info, cost_analysis, config);
 
   if (config.gpu_performance_model_cache) {
     config.gpu_performance_model_cache->Set(*instr, runtime_data);
   }
+  if (config.persistent_cache && !persistent_result.has_value()) {
+    config.persistent_cache->Set(*instr, config, runtime_data);
+  }
 
   return runtime_data;
 }
@@ -271,14 +281,25 @@ absl::Duration GpuPerformanceModel::EstimateRunTimeForFusionCached(
     }
   }
 
-  auto fusion_runtime = EstimateRunTimeForFusion(
-      producer, consumer, producer_runtime, consumer_runtime, device_info,
-      cost_analysis, config);
+  std::optional<absl::Duration> persistent_runtime;
+  if (config.persistent_cache) {
+    persistent_runtime =
+        config.persistent_cache->Get(*producer, *consumer, config);
+  }
+  auto fusion_runtime = persistent_runtime.has_value()
+                            ? *persistent_runtime
+                            : EstimateRunTimeForFusion(
+                                  producer, consumer, producer_runtime,
+                                  consumer_runtime, device_info,
+                                  cost_analysis, config);
 
   if (config.gpu_performance_model_cache) {
     config.gpu_performance_model_cache->Set(*producer, *consumer,
                                             fusion_runtime);
   }
+  if (config.persistent_cache && !persistent_runtime.has_value()) {
+    config.persistent_cache->Set(*producer, *consumer, config, fusion_runtime);
+  }
   return fusion_runtime;
 }
 
@@ -421,6 +442,68 @@ GpuPerformanceModel::RunTimes GpuPerformanceModel::EstimateRunTimes(
   return {time_unfused, time_fused};
 }
 
+/*static*/
+GpuPerformanceModel::RunTimes
+GpuPerformanceModel::EstimateRunTimesForSiblingFusion(
+    const HloInstruction* sibling1, const HloInstruction* sibling2,
+    const se::DeviceDescription& device_info,
+    const GpuHloCostAnalysis* cost_analysis,
+    const GpuPerformanceModelOptions& config) {
+  VLOG(8) << "Siblings: " << sibling1->name() << ", " << sibling2->name();
+  EstimateRunTimeData runtime1 = EstimateRunTimeForInstructionCached(
+      sibling1, device_info, cost_analysis, config);
+  EstimateRunTimeData runtime2 = EstimateRunTimeForInstructionCached(
+      sibling2, device_info, cost_analysis, config);
+
+  absl::Duration time_unfused =
+      2 * kKernelLaunchOverhead + runtime1.exec_time + runtime2.exec_time;
+
+  // Subtract the time `sibling2` spends reading the operands it shares with
+  // `sibling1`, computed the same way as in EstimateRunTimeForInstruction.
+  std::optional<HloFusionAnalysis> local_analysis;
+  if (!config.fusion_analysis_cache) {
+    local_analysis = HloFusionAnalysis::Create(*sibling2, device_info);
+  }
+  const auto& analysis2 = config.fusion_analysis_cache
+                              ? config.fusion_analysis_cache->Get(*sibling2)
+                              : local_analysis.value();
+  int64_t num_blocks2 =
+      EstimateFusionLaunchDimensions(analysis2).num_blocks();
+  CoalescingAnalysis coalescing_analysis(sibling2, sibling2->operands(),
+                                         analysis2);
+  absl::Duration shared_read_time;
+  absl::flat_hash_set<const HloInstruction*> operands1(
+      sibling1->operands().begin(), sibling1->operands().end());
+  absl::flat_hash_set<const HloInstruction*> seen;
+  for (const HloInstruction* operand : sibling2->operands()) {
+    if (!operands1.contains(operand) || !seen.insert(operand).second) continue;
+    int64_t operand_size = cost_analysis->GetShapeSize(operand->shape());
+    int64_t n_bytes_total =
+        GetOperandBytesAccessed(cost_analysis, sibling2, operand);
+    int64_t n_bytes_net = std::min(operand_size, n_bytes_total);
+    shared_read_time += ReadTimeWithDRAMHeuristic(
+        device_info, num_blocks2, n_bytes_net, n_bytes_total,
+        operand->shape().element_type(),
+        coalescing_analysis.IsReadCoalesced(operand));
+  }
+
+  absl::Duration read_time =
+      std::max(runtime1.read_time + runtime2.read_time - shared_read_time,
+               absl::ZeroDuration());
+  absl::Duration time_fused =
+      kKernelLaunchOverhead +
+      CombineComputeAndMemoryAccessTime(
+          runtime1.compute_time + runtime2.compute_time,
+          read_time + runtime1.write_time + runtime2.write_time, config);
+
+  if (VLOG_IS_ON(8)) {
+    LOG(INFO) << "Unfused time: " << time_unfused;
+    LOG(INFO) << "Fused time: " << time_fused;
+  }
+
+  return {time_unfused, time_fused};
+}
+
 /*static*/
 void GpuPerformanceModel::RecordEstimatedRunTime(
     HloInstruction* instruction, const se::DeviceDescription& device_info,
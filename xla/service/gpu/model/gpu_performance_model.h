@@ -86,6 +86,15 @@ class GpuPerformanceModel : public GpuPerformanceModelBase {
       absl::Span<const HloInstruction* const> fused_consumers = {},
       bool multi_output = false);
 
+  // Estimates the run time of two sibling fusions executed as separate kernels
+  // and merged into one multi-output fusion. Operands shared by the siblings
+  // are only read once by the merged fusion.
+  static RunTimes EstimateRunTimesForSiblingFusion(
+      const HloInstruction* sibling1, const HloInstruction* sibling2,
+      const se::DeviceDescription& device_info,
+      const GpuHloCostAnalysis* cost_analysis,
+      const GpuPerformanceModelOptions& config);
+
   // Writes estimated execution time to FusionBackendConfig.reification_cost.
   static void RecordEstimatedRunTime(HloInstruction* instruction,
                                      const se::DeviceDescription& device_info,
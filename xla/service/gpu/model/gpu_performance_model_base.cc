@@ -18,12 +18,22 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <limits>
+#include <memory>
 #include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "xla/hlo/ir/hlo_instruction.h"
@@ -36,10 +46,16 @@ limitations under the License.
 #include "xla/service/gpu/hlo_traversal.h"
 #include "xla/service/gpu/launch_dimensions.h"
 #include "xla/service/gpu/model/gpu_hlo_cost_analysis.h"
+#include "xla/service/gpu/model/gpu_performance_model_cache.pb.h"
+#include "xla/service/persistent_cache_file.h"
 #include "xla/shape_util.h"
 #include "xla/stream_executor/device_description.h"
+#include "xla/tsl/lib/strings/proto_serialization.h"
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/statusor.h"
 
 namespace xla {
 namespace gpu {
@@ -153,6 +169,240 @@ void GpuPerformanceModelCache::Invalidate(const HloInstruction& instruction) {
   }
 }
 
+namespace {
+
+// Durations are serialized in units of a quarter of a nanosecond, which is the
+// resolution of absl::Duration.
+constexpr int64_t kSerializedDurationUnitsPerNanosecond = 4;
+
+int64_t SerializeDuration(absl::Duration duration) {
+  if (duration == absl::InfiniteDuration()) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return absl::ToInt64Nanoseconds(duration *
+                                  kSerializedDurationUnitsPerNanosecond);
+}
+
+absl::Duration DeserializeDuration(int64_t duration) {
+  if (duration == std::numeric_limits<int64_t>::max()) {
+    return absl::InfiniteDuration();
+  }
+  return absl::Nanoseconds(duration) / kSerializedDurationUnitsPerNanosecond;
+}
+
+EstimateRunTimeDataProto EstimateRunTimeDataToProto(
+    const EstimateRunTimeData& data) {
+  EstimateRunTimeDataProto proto;
+  proto.set_flops(data.flops);
+  proto.set_bytes_read(data.bytes_read);
+  proto.set_bytes_written(data.bytes_written);
+  proto.set_read_time(SerializeDuration(data.read_time));
+  proto.set_write_time(SerializeDuration(data.write_time));
+  proto.set_compute_time(SerializeDuration(data.compute_time));
+  proto.set_exec_time(SerializeDuration(data.exec_time));
+  return proto;
+}
+
+EstimateRunTimeData EstimateRunTimeDataFromProto(
+    const EstimateRunTimeDataProto& proto) {
+  return EstimateRunTimeData{proto.flops(),
+                             proto.bytes_read(),
+                             proto.bytes_written(),
+                             DeserializeDuration(proto.read_time()),
+                             DeserializeDuration(proto.write_time()),
+                             DeserializeDuration(proto.compute_time()),
+                             DeserializeDuration(proto.exec_time())};
+}
+
+std::string FingerprintString(absl::string_view str) {
+  tsl::Fprint128 fingerprint = tsl::Fingerprint128(str);
+  return absl::StrFormat("%016x%016x", fingerprint.high64, fingerprint.low64);
+}
+
+std::string DeviceFingerprint(const se::DeviceDescription& device_info) {
+  std::string serialized_device_info;
+  tsl::SerializeToStringDeterministic(device_info.ToGpuProto(),
+                                      &serialized_device_info);
+  return FingerprintString(serialized_device_info);
+}
+
+// Returns a string that identifies the instruction and everything about its
+// operands that the performance model looks at: their shapes and which of them
+// are the same instruction.
+std::string CanonicalInstructionString(const HloInstruction& instruction) {
+  HloPrintOptions options = HloPrintOptions::Canonical();
+  options.set_print_backend_config(true);
+  options.set_sort_backend_config(true);
+  std::string result = instruction.ToString(options);
+  absl::StrAppend(&result, ";operands=");
+  for (const HloInstruction* operand : instruction.operands()) {
+    absl::StrAppend(&result, instruction.operand_index(operand), ",");
+  }
+  return result;
+}
+
+}  // namespace
+
+PersistentGpuPerformanceModelCache::PersistentGpuPerformanceModelCache(
+    const se::DeviceDescription& device_info)
+    : device_fingerprint_(DeviceFingerprint(device_info)) {}
+
+/*static*/ PersistentGpuPerformanceModelCache*
+PersistentGpuPerformanceModelCache::GetOrLoad(
+    absl::string_view path, const se::DeviceDescription& device_info) {
+  static absl::Mutex mutex(absl::kConstInit);
+  static auto* caches = new absl::flat_hash_map<
+      std::pair<std::string, std::string>,
+      std::unique_ptr<PersistentGpuPerformanceModelCache>>();
+
+  absl::MutexLock lock(&mutex);
+  auto [it, inserted] = caches->try_emplace(
+      std::make_pair(std::string(path), DeviceFingerprint(device_info)));
+  if (inserted) {
+    it->second =
+        std::make_unique<PersistentGpuPerformanceModelCache>(device_info);
+    if (absl::Status status = it->second->LoadFromFile(path); !status.ok()) {
+      LOG(WARNING) << "Failed to load GPU performance model cache from "
+                   << path << ": " << status;
+    }
+  }
+  return it->second.get();
+}
+
+std::string PersistentGpuPerformanceModelCache::InstructionKey(
+    const HloInstruction& instruction,
+    const GpuPerformanceModelOptions& config) const {
+  return FingerprintString(absl::StrCat(
+      device_fingerprint_, ";", config.memory_compute_parallelism, ";",
+      CanonicalInstructionString(instruction)));
+}
+
+std::string PersistentGpuPerformanceModelCache::FusionKey(
+    const HloInstruction& producer, const HloInstruction& consumer,
+    const GpuPerformanceModelOptions& config) const {
+  // The fused estimate also depends on which operands of the consumer are the
+  // producer or are shared with the producer.
+  std::string operands;
+  for (const HloInstruction* operand : consumer.operands()) {
+    if (operand == &producer) {
+      absl::StrAppend(&operands, "p,");
+    } else if (auto it = absl::c_find(producer.operands(), operand);
+               it != producer.operands().end()) {
+      absl::StrAppend(&operands, "s", it - producer.operands().begin(), ",");
+    } else {
+      absl::StrAppend(&operands, consumer.operand_index(operand), ",");
+    }
+  }
+  return FingerprintString(absl::StrCat(
+      device_fingerprint_, ";", config.memory_compute_parallelism, ";",
+      CanonicalInstructionString(producer), ";",
+      CanonicalInstructionString(consumer), ";", operands));
+}
+
+std::optional<EstimateRunTimeData> PersistentGpuPerformanceModelCache::Get(
+    const HloInstruction& instruction,
+    const GpuPerformanceModelOptions& config) {
+  std::string key = InstructionKey(instruction, config);
+  absl::MutexLock lock(&mutex_);
+  auto it = instruction_runtime_data_.find(key);
+  if (it != instruction_runtime_data_.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+std::optional<absl::Duration> PersistentGpuPerformanceModelCache::Get(
+    const HloInstruction& producer, const HloInstruction& consumer,
+    const GpuPerformanceModelOptions& config) {
+  std::string key = FusionKey(producer, consumer, config);
+  absl::MutexLock lock(&mutex_);
+  auto it = fusion_runtime_data_.find(key);
+  if (it != fusion_runtime_data_.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+void PersistentGpuPerformanceModelCache::Set(
+    const HloInstruction& instruction, const GpuPerformanceModelOptions& config,
+    const EstimateRunTimeData& runtime_data) {
+  std::string key = InstructionKey(instruction, config);
+  absl::MutexLock lock(&mutex_);
+  instruction_runtime_data_[key] = runtime_data;
+}
+
+void PersistentGpuPerformanceModelCache::Set(
+    const HloInstruction& producer, const HloInstruction& consumer,
+    const GpuPerformanceModelOptions& config, absl::Duration runtime) {
+  std::string key = FusionKey(producer, consumer, config);
+  absl::MutexLock lock(&mutex_);
+  fusion_runtime_data_[key] = runtime;
+}
+
+void PersistentGpuPerformanceModelCache::Merge(
+    const GpuPerformanceModelCacheProto& proto) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto& [key, data] : proto.instruction_runtime_data()) {
+    instruction_runtime_data_.try_emplace(key,
+                                          EstimateRunTimeDataFromProto(data));
+  }
+  for (const auto& [key, runtime] : proto.fusion_runtime_data()) {
+    fusion_runtime_data_.try_emplace(key, DeserializeDuration(runtime));
+  }
+}
+
+GpuPerformanceModelCacheProto PersistentGpuPerformanceModelCache::ToProto()
+    const {
+  GpuPerformanceModelCacheProto proto;
+  absl::MutexLock lock(&mutex_);
+  for (const auto& [key, data] : instruction_runtime_data_) {
+    (*proto.mutable_instruction_runtime_data())[key] =
+        EstimateRunTimeDataToProto(data);
+  }
+  for (const auto& [key, runtime] : fusion_runtime_data_) {
+    (*proto.mutable_fusion_runtime_data())[key] = SerializeDuration(runtime);
+  }
+  return proto;
+}
+
+absl::Status PersistentGpuPerformanceModelCache::LoadFromFile(
+    absl::string_view path) {
+  TF_ASSIGN_OR_RETURN(std::optional<std::string> serialized,
+                      ReadPersistentCacheFile(tsl::Env::Default(), path));
+  if (!serialized.has_value()) {
+    VLOG(1) << "GPU performance model cache " << path << " doesn't exist yet";
+    return absl::OkStatus();
+  }
+  GpuPerformanceModelCacheProto proto;
+  if (!proto.ParseFromString(*serialized)) {
+    return absl::DataLossError(
+        absl::StrCat("Failed to parse GPU performance model cache ", path));
+  }
+  VLOG(1) << "Loaded " << proto.instruction_runtime_data_size() << " + "
+          << proto.fusion_runtime_data_size()
+          << " GPU performance model cache entries from " << path;
+  Merge(proto);
+  return absl::OkStatus();
+}
+
+absl::Status PersistentGpuPerformanceModelCache::SaveToFile(
+    absl::string_view path) const {
+  // Other compilations might have written entries to the file since it was
+  // loaded, so merge them into what is written instead of dropping them.
+  GpuPerformanceModelCacheProto proto;
+  TF_ASSIGN_OR_RETURN(std::optional<std::string> serialized,
+                      ReadPersistentCacheFile(tsl::Env::Default(), path));
+  if (serialized.has_value() && !proto.ParseFromString(*serialized)) {
+    LOG(WARNING) << "Overwriting unparsable GPU performance model cache "
+                 << path;
+    proto.Clear();
+  }
+  // Map entries of the merged proto replace existing ones with the same key.
+  proto.MergeFrom(ToProto());
+  return WritePersistentCacheFile(tsl::Env::Default(), path,
+                                  proto.SerializeAsString());
+}
+
 /*static*/
 LaunchDimensions GpuPerformanceModelBase::EstimateFusionLaunchDimensions(
     const HloFusionAnalysis& fusion_analysis) {
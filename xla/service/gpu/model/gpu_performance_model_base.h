@@ -21,7 +21,11 @@ limitations under the License.
 #include <optional>
 #include <string>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "xla/hlo/ir/hlo_instruction.h"
@@ -29,6 +33,7 @@ limitations under the License.
 #include "xla/service/gpu/launch_dimensions.h"
 #include "xla/service/gpu/model/fusion_analysis_cache.h"
 #include "xla/service/gpu/model/gpu_hlo_cost_analysis.h"
+#include "xla/service/gpu/model/gpu_performance_model_cache.pb.h"
 #include "xla/stream_executor/device_description.h"
 #include "xla/xla_data.pb.h"
 
@@ -125,6 +130,8 @@ class GpuPerformanceModelCache {
       fusion_runtime_data_;
 };
 
+class PersistentGpuPerformanceModelCache;
+
 struct GpuPerformanceModelOptions {
   // Factor for how much parallelism between compute and memory accesses should
   // be assumed. If 1.0, assume perfect parallelism (the run time is the maximum
@@ -137,16 +144,22 @@ struct GpuPerformanceModelOptions {
 
   GpuPerformanceModelCache* gpu_performance_model_cache = nullptr;
 
+  // If present, estimates are also looked up in and added to this cache, which
+  // is shared across compilations.
+  PersistentGpuPerformanceModelCache* persistent_cache = nullptr;
+
   static GpuPerformanceModelOptions Default() {
     return GpuPerformanceModelOptions();
   }
 
   static GpuPerformanceModelOptions PriorityFusion(
       HloFusionAnalysisCache* fusion_analysis_cache = nullptr,
-      GpuPerformanceModelCache* gpu_performance_model_cache = nullptr) {
+      GpuPerformanceModelCache* gpu_performance_model_cache = nullptr,
+      PersistentGpuPerformanceModelCache* persistent_cache = nullptr) {
     GpuPerformanceModelOptions config;
     config.fusion_analysis_cache = fusion_analysis_cache;
     config.gpu_performance_model_cache = gpu_performance_model_cache;
+    config.persistent_cache = persistent_cache;
     // This constant was chosen empirically in early 2024, based on runtime
     // performance on a set of benchmarks internal to Google. Intuitively, we
     // expect it to be close to 1, but not quite 1 (i.e., sometimes, compute
@@ -163,6 +176,73 @@ struct GpuPerformanceModelOptions {
   }
 };
 
+// A cache of performance model estimates that, unlike GpuPerformanceModelCache,
+// is keyed by the contents of instructions instead of their identity. Entries
+// therefore stay valid across compilations and can be serialized, so that
+// compilations of many similar modules, e.g. in a hyperparameter sweep, reuse
+// the estimates computed for earlier modules. Keys include a fingerprint of the
+// device description and the performance model options, so one cache can hold
+// entries for several devices. Estimates also depend on the cost analysis
+// options, which are assumed to be the same for all users of a cache.
+//
+// This class is thread-safe.
+class PersistentGpuPerformanceModelCache {
+ public:
+  explicit PersistentGpuPerformanceModelCache(
+      const se::DeviceDescription& device_info);
+
+  // Returns the process-wide cache for `device_info` that is backed by the file
+  // at `path`. The file is read by the first call for a path and device, if it
+  // exists. Read failures are logged and result in an empty cache.
+  static PersistentGpuPerformanceModelCache* GetOrLoad(
+      absl::string_view path, const se::DeviceDescription& device_info);
+
+  // Returns cached runtime data for the instruction or producer-consumer pair.
+  // Returns nullopt if there is no data in cache.
+  std::optional<EstimateRunTimeData> Get(
+      const HloInstruction& instruction,
+      const GpuPerformanceModelOptions& config);
+  std::optional<absl::Duration> Get(const HloInstruction& producer,
+                                    const HloInstruction& consumer,
+                                    const GpuPerformanceModelOptions& config);
+
+  // Sets cache value for the instruction or producer-consumer pair.
+  void Set(const HloInstruction& instruction,
+           const GpuPerformanceModelOptions& config,
+           const EstimateRunTimeData& runtime_data);
+  void Set(const HloInstruction& producer, const HloInstruction& consumer,
+           const GpuPerformanceModelOptions& config, absl::Duration runtime);
+
+  // Adds all entries of `proto` to the cache. Existing entries are kept.
+  void Merge(const GpuPerformanceModelCacheProto& proto);
+  GpuPerformanceModelCacheProto ToProto() const;
+
+  // Merges the entries of the file at `path`. Does nothing if the file doesn't
+  // exist.
+  absl::Status LoadFromFile(absl::string_view path);
+
+  // Writes all entries to the file at `path`, keeping the entries that are
+  // already in the file. The file is replaced atomically, so concurrent readers
+  // never observe a partially written cache.
+  absl::Status SaveToFile(absl::string_view path) const;
+
+ private:
+  std::string InstructionKey(const HloInstruction& instruction,
+                             const GpuPerformanceModelOptions& config) const;
+  std::string FusionKey(const HloInstruction& producer,
+                        const HloInstruction& consumer,
+                        const GpuPerformanceModelOptions& config) const;
+
+  // Fingerprint of the device description that is part of all keys.
+  std::string device_fingerprint_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, EstimateRunTimeData>
+      instruction_runtime_data_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, absl::Duration> fusion_runtime_data_
+      ABSL_GUARDED_BY(mutex_);
+};
+
 class GpuPerformanceModelBase {
  public:
   struct RunTimes {
@@ -16,9 +16,11 @@ limitations under the License.
 #include "xla/service/gpu/model/gpu_performance_model_base.h"
 
 #include <cstdint>
+#include <string>
 
 #include <gtest/gtest.h>
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/service/gpu/backend_configs.pb.h"
@@ -30,7 +32,10 @@ limitations under the License.
 #include "xla/stream_executor/device_description.h"
 #include "xla/test_helpers.h"
 #include "xla/tests/hlo_test_base.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tsl/platform/path.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
 
 namespace xla {
 namespace gpu {
@@ -288,6 +293,79 @@ ENTRY e {
   EXPECT_EQ(launch_dimensions.num_threads_per_block(), 128);
 }
 
+TEST_F(GpuPerformanceModelBaseTest, PersistentCacheIsKeyedByContents) {
+  absl::string_view hlo_string = R"(
+HloModule m
+
+ENTRY entry_computation {
+  param_0 = f32[32] parameter(0)
+  log = f32[32] log(param_0)
+  ROOT add = f32[32] add(log, param_0)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module_0,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(auto module_1,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  const HloInstruction* add_0 =
+      module_0->entry_computation()->root_instruction();
+  const HloInstruction* log_0 = add_0->operand(0);
+  const HloInstruction* add_1 =
+      module_1->entry_computation()->root_instruction();
+  const HloInstruction* log_1 = add_1->operand(0);
+
+  auto config = GpuPerformanceModelOptions::PriorityFusion();
+  EstimateRunTimeData runtime_data{/*flops=*/32,
+                                   /*bytes_read=*/128,
+                                   /*bytes_written=*/128,
+                                   /*read_time=*/absl::Nanoseconds(1.25),
+                                   /*write_time=*/absl::Nanoseconds(2),
+                                   /*compute_time=*/absl::Nanoseconds(3),
+                                   /*exec_time=*/absl::InfiniteDuration()};
+
+  PersistentGpuPerformanceModelCache cache(device_info_);
+  cache.Set(*log_0, config, runtime_data);
+  cache.Set(*log_0, *add_0, config, absl::Nanoseconds(4.75));
+
+  // Entries are found for equal instructions of a different module.
+  auto cached_runtime_data = cache.Get(*log_1, config);
+  ASSERT_TRUE(cached_runtime_data.has_value());
+  EXPECT_EQ(cached_runtime_data->read_time, absl::Nanoseconds(1.25));
+  EXPECT_EQ(cache.Get(*log_1, *add_1, config), absl::Nanoseconds(4.75));
+  EXPECT_FALSE(cache.Get(*add_1, config).has_value());
+  EXPECT_FALSE(
+      cache.Get(*log_1, GpuPerformanceModelOptions::Default()).has_value());
+
+  // Entries survive a round trip through a file exactly.
+  std::string path = tsl::io::JoinPath(tsl::testing::TmpDir(),
+                                       "gpu_performance_model_cache.pb");
+  TF_ASSERT_OK(cache.SaveToFile(path));
+  PersistentGpuPerformanceModelCache loaded_cache(device_info_);
+  TF_ASSERT_OK(loaded_cache.LoadFromFile(path));
+  cached_runtime_data = loaded_cache.Get(*log_1, config);
+  ASSERT_TRUE(cached_runtime_data.has_value());
+  EXPECT_EQ(cached_runtime_data->read_time, absl::Nanoseconds(1.25));
+  EXPECT_EQ(cached_runtime_data->write_time, absl::Nanoseconds(2));
+  EXPECT_TRUE(cached_runtime_data->IsInfinite());
+  EXPECT_EQ(loaded_cache.Get(*log_1, *add_1, config), absl::Nanoseconds(4.75));
+
+  // Entries are not shared between devices.
+  PersistentGpuPerformanceModelCache other_device_cache(
+      TestGpuDeviceInfo::AMDMI210DeviceInfo());
+  TF_ASSERT_OK(other_device_cache.LoadFromFile(path));
+  EXPECT_FALSE(other_device_cache.Get(*log_1, config).has_value());
+
+  // Saving keeps the entries that other caches wrote to the file.
+  PersistentGpuPerformanceModelCache other_cache(device_info_);
+  other_cache.Set(*add_0, config, runtime_data);
+  TF_ASSERT_OK(other_cache.SaveToFile(path));
+  PersistentGpuPerformanceModelCache merged_cache(device_info_);
+  TF_ASSERT_OK(merged_cache.LoadFromFile(path));
+  EXPECT_TRUE(merged_cache.Get(*log_1, config).has_value());
+  EXPECT_TRUE(merged_cache.Get(*add_1, config).has_value());
+  EXPECT_EQ(merged_cache.Get(*log_1, *add_1, config), absl::Nanoseconds(4.75));
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
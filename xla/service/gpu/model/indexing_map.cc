@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <numeric>
@@ -29,11 +30,15 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/optimization.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/numeric/int128.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
@@ -1294,6 +1299,22 @@ bool IndexingMap::Verify(std::ostream& out) const {
   return true;
 }
 
+bool IndexingMap::Simplify() {
+  if (IsUndefined() || IsKnownEmpty()) return false;
+
+  IndexingMapCache* cache = IndexingMapCache::Get(GetMLIRContext());
+  if (cache == nullptr) return SimplifyImpl();
+
+  if (auto cached = cache->LookupSimplified(*this)) {
+    *this = std::move(cached->first);
+    return cached->second;
+  }
+  IndexingMap original = *this;
+  bool was_simplified = SimplifyImpl();
+  cache->InsertSimplified(original, *this, was_simplified);
+  return was_simplified;
+}
+
 // Simplification of IndexingMap has two main parts.
 // At first we optimized constraints to make the domain as small and simple as
 // possible. And only then we simplify the affine_map, because its
@@ -1307,7 +1328,7 @@ bool IndexingMap::Verify(std::ostream& out) const {
 // RangeEvaluator for every constraint. Note that we start with "expr"
 // simplification, because the ranges of constraints were already optimized once
 // when IndexingMap was constructed.
-bool IndexingMap::Simplify() {
+bool IndexingMap::SimplifyImpl() {
   if (IsUndefined() || IsKnownEmpty()) return false;
 
   // Simplify constraints to shrink the lower/upper bounds of dims and symbols.
@@ -1752,11 +1773,10 @@ bool IndexingMap::MergeModConstraints() {
   return did_simplify;
 }
 
-IndexingMap ComposeIndexingMaps(const IndexingMap& first,
-                                const IndexingMap& second) {
-  if (second.IsUndefined() || first.IsUndefined()) {
-    return IndexingMap::GetUndefined();
-  }
+namespace {
+
+IndexingMap ComposeIndexingMapsImpl(const IndexingMap& first,
+                                    const IndexingMap& second) {
   MLIRContext* mlir_context = first.GetMLIRContext();
   AffineMap producer_affine_map = second.GetAffineMap();
   AffineMap composed_map = producer_affine_map.compose(first.GetAffineMap());
@@ -1836,6 +1856,24 @@ IndexingMap ComposeIndexingMaps(const IndexingMap& first,
   return composed_indexing_map;
 }
 
+}  // namespace
+
+IndexingMap ComposeIndexingMaps(const IndexingMap& first,
+                                const IndexingMap& second) {
+  if (second.IsUndefined() || first.IsUndefined()) {
+    return IndexingMap::GetUndefined();
+  }
+  IndexingMapCache* cache = IndexingMapCache::Get(first.GetMLIRContext());
+  if (cache == nullptr) return ComposeIndexingMapsImpl(first, second);
+
+  if (auto cached = cache->LookupComposed(first, second)) {
+    return *std::move(cached);
+  }
+  IndexingMap composed = ComposeIndexingMapsImpl(first, second);
+  cache->InsertComposed(first, second, composed);
+  return composed;
+}
+
 bool IndexingMap::RescaleSymbols() {
   MergeModConstraints();
 
@@ -1941,5 +1979,102 @@ IndexingMap IndexingMap::ConvertSymbolsToDimensions() const {
   return new_indexing_map;
 }
 
+namespace {
+
+// Maximum number of entries in each table of the IndexingMapCache. The tables
+// are cleared when they grow beyond it to bound the memory usage of the cache.
+constexpr size_t kMaxIndexingMapCacheEntries = 1 << 16;
+
+absl::Mutex indexing_map_caches_mu(absl::kConstInit);
+
+absl::flat_hash_map<MLIRContext*, IndexingMapCache*>& IndexingMapCaches()
+    ABSL_SHARED_LOCKS_REQUIRED(indexing_map_caches_mu) {
+  static auto* caches =
+      new absl::flat_hash_map<MLIRContext*, IndexingMapCache*>();
+  return *caches;
+}
+
+bool VariableNamesEqual(const std::vector<IndexingMap::Variable>& lhs,
+                        const std::vector<IndexingMap::Variable>& rhs) {
+  return absl::c_equal(lhs, rhs,
+                       [](const IndexingMap::Variable& lhs_var,
+                          const IndexingMap::Variable& rhs_var) {
+                         return lhs_var.name == rhs_var.name;
+                       });
+}
+
+}  // namespace
+
+IndexingMapCache::IndexingMapCache(MLIRContext* mlir_context)
+    : mlir_context_(mlir_context) {
+  absl::MutexLock lock(&indexing_map_caches_mu);
+  bool inserted = IndexingMapCaches().emplace(mlir_context, this).second;
+  CHECK(inserted) << "IndexingMapCache is already registered for the context";
+}
+
+IndexingMapCache::~IndexingMapCache() {
+  absl::MutexLock lock(&indexing_map_caches_mu);
+  IndexingMapCaches().erase(mlir_context_);
+}
+
+IndexingMapCache* IndexingMapCache::Get(MLIRContext* mlir_context) {
+  absl::ReaderMutexLock lock(&indexing_map_caches_mu);
+  auto it = IndexingMapCaches().find(mlir_context);
+  return it == IndexingMapCaches().end() ? nullptr : it->second;
+}
+
+bool IndexingMapCache::MapEq::operator()(const IndexingMap& lhs,
+                                         const IndexingMap& rhs) const {
+  return lhs == rhs && lhs.IsKnownEmpty() == rhs.IsKnownEmpty() &&
+         VariableNamesEqual(lhs.GetDimVars(), rhs.GetDimVars()) &&
+         VariableNamesEqual(lhs.GetRangeVars(), rhs.GetRangeVars()) &&
+         VariableNamesEqual(lhs.GetRTVars(), rhs.GetRTVars());
+}
+
+bool IndexingMapCache::MapPairEq::operator()(
+    const std::pair<IndexingMap, IndexingMap>& lhs,
+    const std::pair<IndexingMap, IndexingMap>& rhs) const {
+  return MapEq()(lhs.first, rhs.first) && MapEq()(lhs.second, rhs.second);
+}
+
+std::optional<std::pair<IndexingMap, bool>> IndexingMapCache::LookupSimplified(
+    const IndexingMap& map) const {
+  absl::MutexLock lock(&mu_);
+  auto it = simplified_.find(map);
+  if (it == simplified_.end()) return std::nullopt;
+  ++num_hits_;
+  return it->second;
+}
+
+void IndexingMapCache::InsertSimplified(const IndexingMap& map,
+                                        IndexingMap simplified,
+                                        bool was_simplified) {
+  absl::MutexLock lock(&mu_);
+  if (simplified_.size() >= kMaxIndexingMapCacheEntries) simplified_.clear();
+  simplified_.try_emplace(map, std::move(simplified), was_simplified);
+}
+
+std::optional<IndexingMap> IndexingMapCache::LookupComposed(
+    const IndexingMap& first, const IndexingMap& second) const {
+  absl::MutexLock lock(&mu_);
+  auto it = composed_.find(std::make_pair(first, second));
+  if (it == composed_.end()) return std::nullopt;
+  ++num_hits_;
+  return it->second;
+}
+
+void IndexingMapCache::InsertComposed(const IndexingMap& first,
+                                      const IndexingMap& second,
+                                      IndexingMap composed) {
+  absl::MutexLock lock(&mu_);
+  if (composed_.size() >= kMaxIndexingMapCacheEntries) composed_.clear();
+  composed_.try_emplace(std::make_pair(first, second), std::move(composed));
+}
+
+int64_t IndexingMapCache::num_hits() const {
+  absl::MutexLock lock(&mu_);
+  return num_hits_;
+}
+
 }  // namespace gpu
 }  // namespace xla
@@ -26,6 +26,9 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Hashing.h"
@@ -380,6 +383,9 @@ class IndexingMap {
  private:
   IndexingMap() = default;
 
+  // Implements Simplify() without consulting the IndexingMapCache.
+  bool SimplifyImpl();
+
   // Merges "mod" constraints for the same AffineExpr.
   // Returns true if simplification was performed.
   bool MergeModConstraints();
@@ -469,6 +475,68 @@ H AbslHashValue(H h, const IndexingMap& indexing_map) {
   return h;
 }
 
+// Memoizes the results of IndexingMap::Simplify() and ComposeIndexingMaps()
+// for indexing maps of a single MLIRContext. Fusion analysis and emission
+// simplify and compose the same maps over and over, so the pass that owns the
+// MLIRContext can create a cache next to it and all indexing map operations in
+// that context will reuse previously computed results.
+//
+// The cache registers itself for the context on construction and unregisters
+// on destruction, so it must be destroyed before the MLIRContext. Cached maps
+// are only returned for inputs that are equal including variable names.
+//
+// This class is thread-safe.
+class IndexingMapCache {
+ public:
+  explicit IndexingMapCache(mlir::MLIRContext* mlir_context);
+  ~IndexingMapCache();
+
+  IndexingMapCache(const IndexingMapCache&) = delete;
+  IndexingMapCache& operator=(const IndexingMapCache&) = delete;
+
+  // Returns the cache registered for `mlir_context`, or nullptr if there is
+  // none.
+  static IndexingMapCache* Get(mlir::MLIRContext* mlir_context);
+
+  // Returns the result of `map.Simplify()` and the simplified map, if cached.
+  std::optional<std::pair<IndexingMap, bool>> LookupSimplified(
+      const IndexingMap& map) const;
+  void InsertSimplified(const IndexingMap& map, IndexingMap simplified,
+                        bool was_simplified);
+
+  // Returns the cached result of `ComposeIndexingMaps(first, second)`.
+  std::optional<IndexingMap> LookupComposed(const IndexingMap& first,
+                                            const IndexingMap& second) const;
+  void InsertComposed(const IndexingMap& first, const IndexingMap& second,
+                      IndexingMap composed);
+
+  // Returns the number of lookups that were served from the cache.
+  int64_t num_hits() const;
+
+ private:
+  // Compares indexing maps including the names of their variables, which are
+  // ignored by operator==, but are part of the result.
+  struct MapEq {
+    bool operator()(const IndexingMap& lhs, const IndexingMap& rhs) const;
+  };
+  struct MapPairEq {
+    bool operator()(const std::pair<IndexingMap, IndexingMap>& lhs,
+                    const std::pair<IndexingMap, IndexingMap>& rhs) const;
+  };
+
+  mlir::MLIRContext* mlir_context_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<IndexingMap, std::pair<IndexingMap, bool>,
+                      absl::Hash<IndexingMap>, MapEq>
+      simplified_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::pair<IndexingMap, IndexingMap>, IndexingMap,
+                      absl::Hash<std::pair<IndexingMap, IndexingMap>>,
+                      MapPairEq>
+      composed_ ABSL_GUARDED_BY(mu_);
+  mutable int64_t num_hits_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
 std::vector<IndexingMap::Variable> DimVarsFromTensorSizes(
     absl::Span<const int64_t> tensor_sizes);
 
@@ -261,6 +261,43 @@ TEST_F(IndexingMapTest, Composition_ProducerAndConsumerHaveConstraints) {
                         )"));
 }
 
+TEST_F(IndexingMapTest, CacheReusesComposedAndSimplifiedMaps) {
+  IndexingMap producer = Parse(R"(
+     (d0, d1)[s0, s1] -> (d1, d0, s1, s0),
+     domain:
+     d0 in [0, 49],
+     d1 in [0, 59],
+     s0 in [0, 69],
+     s1 in [0, 19],
+     d0 mod 8 in [0, 0],
+     s0 mod 3 in [1, 1]
+  )");
+  IndexingMap consumer = Parse(R"(
+     (d0)[s0] -> (d0, s0),
+     domain:
+     d0 in [0, 9],
+     s0 in [0, 7],
+     d0 + s0 in [0, 20],
+     s0 mod 4 in [0, 0]
+  )");
+  IndexingMap expected = ComposeIndexingMaps(consumer, producer);
+  IndexingMap expected_simplified = expected;
+  ASSERT_TRUE(expected_simplified.Simplify());
+
+  IndexingMapCache cache(&mlir_context_);
+  EXPECT_EQ(IndexingMapCache::Get(&mlir_context_), &cache);
+  for (int i = 0; i < 3; ++i) {
+    IndexingMap composed = ComposeIndexingMaps(consumer, producer);
+    EXPECT_EQ(composed, expected);
+    EXPECT_TRUE(composed.Simplify());
+    EXPECT_EQ(composed, expected_simplified);
+    // Simplifying a simplified map again is cached as well.
+    composed.Simplify();
+  }
+  // The first iteration populates the cache, the remaining ones only hit it.
+  EXPECT_EQ(cache.num_hits(), 6);
+}
+
 TEST_F(IndexingMapTest, Composition_RTVar) {
   std::vector<IndexingMap::Variable> rt_vars{
       IndexingMap::Variable{Interval{0, 0}},
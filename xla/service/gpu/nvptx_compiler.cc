@@ -21,6 +21,7 @@ limitations under the License.
 #include <fstream>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -82,6 +83,7 @@ limitations under the License.
 #include "xla/service/gpu/transforms/dot_sparsity_rewriter.h"
 #include "xla/service/gpu/transforms/gpusolver_rewriter.h"
 #include "xla/service/gpu/transforms/sort_rewriter.h"
+#include "xla/service/gpu/transforms/sparse_weight_compressor.h"
 #include "xla/service/gpu/transforms/triangular_solve_rewriter.h"
 #include "xla/service/hlo_constant_folding.h"
 #include "xla/service/hlo_cse.h"
@@ -90,6 +92,7 @@ limitations under the License.
 #include "xla/service/hlo_module_config.h"
 #include "xla/service/hlo_verifier.h"
 #include "xla/service/llvm_ir/llvm_util.h"
+#include "xla/service/persistent_cache_file.h"
 #include "xla/service/reshape_mover.h"
 #include "xla/service/tuple_simplifier.h"
 #include "xla/stream_executor/cuda/cuda_asm_compiler.h"
@@ -336,6 +339,15 @@ absl::Status NVPTXCompiler::OptimizeHloPostLayoutAssignment(
   }
 
   pre_pipeline.AddPass<DotDimensionMerger>();
+  // Sparse dots are only emitted by Triton, so weights are compressed only
+  // when the Triton GEMM path is available.
+  if (hlo_module->config()
+          .debug_options()
+          .xla_gpu_enable_sparse_weight_compression() &&
+      hlo_module->config().debug_options().xla_gpu_enable_triton_gemm() &&
+      cuda_compute_capability.IsAtLeastAmpere()) {
+    pre_pipeline.AddPass<SparseWeightCompressor>(cuda_compute_capability);
+  }
   pre_pipeline.AddPass<DotSparsityRewriter>();
 
   if (!hlo_module->config()
@@ -704,6 +716,78 @@ absl::StatusOr<PtxCompilationMethod> ChooseCompilationMethod(
   return compilation_methods.front();
 }
 
+// Returns the name and version of the PTX compiler used by `method`. Compilers
+// of different versions may produce different cubins, so this is part of the
+// key of the persistent cubin cache.
+static absl::StatusOr<std::string> GetPtxCompilerVersion(
+    PtxCompilationMethod method, const se::GpuAsmOpts& ptxas_config) {
+  switch (method) {
+    case PtxCompilationMethod::kNvJitLink: {
+      TF_ASSIGN_OR_RETURN(se::NvJitLinkVersion version,
+                          se::GetNvJitLinkVersion());
+      return absl::StrCat("nvjitlink ", std::get<0>(version), ".",
+                          std::get<1>(version));
+    }
+    case PtxCompilationMethod::kNvPtxCompiler: {
+      TF_ASSIGN_OR_RETURN(se::SemanticVersion version,
+                          se::GetLibNvPtxCompilerVersion());
+      return absl::StrCat("nvptxcompiler ", version.ToString());
+    }
+    case PtxCompilationMethod::kPtxas: {
+      TF_ASSIGN_OR_RETURN(
+          se::SemanticVersion version,
+          se::GetAsmCompilerVersion(ptxas_config.preferred_cuda_dir));
+      return absl::StrCat("ptxas ", version.ToString());
+    }
+  }
+  return absl::InternalError("Unknown PTX compilation method.");
+}
+
+// Returns the path of the persistent cache entry for the cubin compiled from
+// `ptx` with the given compiler and options. Entries are sharded by the first
+// characters of the key hash, like the per-fusion autotune cache.
+static absl::StatusOr<std::string> GetCubinCacheFilePath(
+    absl::string_view cache_dir, const std::string& ptx,
+    se::CudaComputeCapability cc, PtxCompilationMethod method,
+    const se::GpuAsmOpts& ptxas_config, bool cancel_if_reg_spill) {
+  TF_ASSIGN_OR_RETURN(std::string compiler_version,
+                      GetPtxCompilerVersion(method, ptxas_config));
+  std::string key = absl::StrCat(
+      compiler_version, "\n", cc.ToString(), "\n",
+      ptxas_config.disable_gpuasm_optimizations, "\n",
+      absl::StrJoin(ptxas_config.extra_flags, " "), "\n", cancel_if_reg_spill,
+      "\n", ptx);
+  TF_ASSIGN_OR_RETURN(std::string key_hash, GetBase64EncodedSha256Hash(key));
+  return tsl::io::JoinPath(cache_dir, key_hash.substr(0, 2),
+                           absl::StrCat(key_hash, ".cubin"));
+}
+
+// Returns the cubin at `file_path`, or nullopt if there is no such entry.
+static std::optional<std::vector<uint8_t>> ReadCubinFromCache(
+    const std::string& file_path) {
+  absl::StatusOr<std::optional<std::string>> cubin =
+      ReadPersistentCacheFile(tsl::Env::Default(), file_path);
+  if (!cubin.ok()) {
+    LOG(WARNING) << "Failed to read cubin cache entry " << file_path << ": "
+                 << cubin.status();
+    return std::nullopt;
+  }
+  if (!cubin->has_value()) {
+    return std::nullopt;
+  }
+  return std::vector<uint8_t>((*cubin)->begin(), (*cubin)->end());
+}
+
+// Writes `cubin` to `file_path` in the persistent cubin cache. Concurrent
+// writers of the same entry write the same cubin, so the last rename wins.
+static absl::Status WriteCubinToCache(const std::string& file_path,
+                                      absl::Span<const uint8_t> cubin) {
+  return WritePersistentCacheFile(
+      tsl::Env::Default(), file_path,
+      absl::string_view(reinterpret_cast<const char*>(cubin.data()),
+                        cubin.size()));
+}
+
 static absl::StatusOr<std::vector<uint8_t>> AssembleOptionsAndCompile(
     const std::string& ptx, se::CudaComputeCapability cc,
     const HloModuleConfig& hlo_module_config,
@@ -733,6 +817,26 @@ static absl::StatusOr<std::vector<uint8_t>> AssembleOptionsAndCompile(
 
   VLOG(2) << "Using compilation method: " << compilation_method;
 
+  const std::string& cache_dir =
+      hlo_module_config.debug_options().xla_gpu_cubin_cache_dir();
+  std::optional<std::string> cache_file_path;
+  if (!cache_dir.empty()) {
+    absl::StatusOr<std::string> file_path =
+        GetCubinCacheFilePath(cache_dir, ptx, cc, compilation_method,
+                              ptxas_config, cancel_if_reg_spill);
+    if (file_path.ok()) {
+      if (std::optional<std::vector<uint8_t>> cubin =
+              ReadCubinFromCache(*file_path)) {
+        VLOG(1) << "Found cubin in cache: " << *file_path;
+        return *std::move(cubin);
+      }
+      cache_file_path = *std::move(file_path);
+    } else {
+      LOG_FIRST_N(WARNING, 1)
+          << "Not using the cubin cache: " << file_path.status();
+    }
+  }
+
   absl::StatusOr<std::vector<uint8_t>> maybe_cubin = [&] {
     switch (compilation_method) {
       case PtxCompilationMethod::kNvJitLink:
@@ -764,6 +868,15 @@ static absl::StatusOr<std::vector<uint8_t>> AssembleOptionsAndCompile(
     VLOG(1) << "Compiled PTX size: " << ptx.size()
             << "bytes. CUBIN size: " << maybe_cubin.value().size() << "bytes.";
 
+    if (cache_file_path.has_value()) {
+      if (absl::Status status =
+              WriteCubinToCache(*cache_file_path, *maybe_cubin);
+          !status.ok()) {
+        LOG_FIRST_N(WARNING, 1) << "Failed to write cubin cache entry "
+                                << *cache_file_path << ": " << status;
+      }
+    }
+
     return maybe_cubin;
   }
 
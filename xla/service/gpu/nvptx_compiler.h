@@ -144,6 +144,9 @@ class NVPTXCompiler : public GpuCompiler {
   //
   // If compiling the ptx fails, we return an empty cubin, cross our fingers,
   // and leave compilation up to the driver.
+  //
+  // If `xla_gpu_cubin_cache_dir` is set, a miss in this cache first looks for
+  // the cubin in that directory, which persists across processes.
   struct CompilationCacheKey {
     CompilationCacheKey(std::string ptx, int cc_major, int cc_minor,
                         bool relocatable, CompilationCacheFlags flags)
@@ -19,6 +19,7 @@ limitations under the License.
 #include <string_view>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -50,6 +51,7 @@ limitations under the License.
 #include "xla/xla.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/path.h"
+#include "tsl/platform/status.h"
 #include "tsl/platform/status_matchers.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test.h"
@@ -262,6 +264,45 @@ TEST_P(NVPTXCompilationTests, CompileProgram) {
               tsl::testing::IsOkAndHolds(::testing::NotNull()));
 }
 
+TEST_P(NVPTXCompilationTests, ReusesCubinsFromCacheDir) {
+  PtxCompilationMethod compilation_method = std::get<1>(GetParam());
+  PtxLinkingMethod linking_method = std::get<2>(GetParam());
+  if (linking_method == PtxLinkingMethod::kDriver) {
+    GTEST_SKIP() << "Cubins compiled by the driver are not cached.";
+  }
+  std::string cache_dir;
+  ASSERT_TRUE(tsl::Env::Default()->LocalTempFilename(&cache_dir));
+
+  std::string_view hlo_text = GetHlo(std::get<0>(GetParam()));
+  auto compile = [&]() {
+    auto module = ParseAndReturnVerifiedModule(hlo_text).value();
+    HloModuleConfig hlo_module_config = module->config();
+    DebugOptions debug_options = hlo_module_config.debug_options();
+    SetDebugOptionsFromPtxSettings(&debug_options, compilation_method,
+                                   linking_method);
+    debug_options.set_xla_gpu_cubin_cache_dir(cache_dir);
+    hlo_module_config.set_debug_options(debug_options);
+    module->set_config(hlo_module_config);
+    return CompileExecutable(std::move(module));
+  };
+  auto cache_entries = [&]() {
+    std::vector<std::string> entries;
+    TF_CHECK_OK(tsl::Env::Default()->GetMatchingPaths(
+        tsl::io::JoinPath(cache_dir, "*", "*.cubin"), &entries));
+    return entries;
+  };
+
+  // Every compilation uses a new compiler, so the second one can only skip
+  // the PTX compilation through the cache directory.
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Executable> executable, compile());
+  std::vector<std::string> entries = cache_entries();
+  EXPECT_FALSE(entries.empty());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Executable> cached, compile());
+  EXPECT_EQ(cache_entries(), entries);
+  EXPECT_EQ(static_cast<GpuExecutable*>(cached.get())->binary(),
+            static_cast<GpuExecutable*>(executable.get())->binary());
+}
+
 MATCHER(MatchesSectionNameAndBinarySize, "") {
   return std::get<0>(arg).first == std::get<1>(arg).first &&
          std::get<0>(arg).second.size() == std::get<1>(arg).second.size();
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/service/gpu/runtime/command_buffer_cmd.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -213,7 +214,17 @@ void CommandBufferCmdSequence::Append(std::unique_ptr<CommandBufferCmd> cmd) {
 
   ExecutionStreamId execution_stream_id = cmd->execution_stream_id();
   CommandBufferCmd::BufferUsageVector buffers = cmd->buffers();
-  bool requires_barrier = HasConflicts(execution_stream_id, buffers);
+
+  // In kDependencies mode we track conflicts between individual commands.
+  std::vector<int64_t> dependencies;
+  if (synchronization_mode_ == SynchronizationMode::kDependencies) {
+    dependencies =
+        FindDependencies(execution_stream_id, buffers, commands_.size());
+  }
+
+  bool requires_barrier =
+      synchronization_mode_ != SynchronizationMode::kDependencies &&
+      HasConflicts(execution_stream_id, buffers);
 
   // Always add barriers between commands if we want to serialize execution.
   if (synchronization_mode_ == SynchronizationMode::kSerialize &&
@@ -230,7 +241,13 @@ void CommandBufferCmdSequence::Append(std::unique_ptr<CommandBufferCmd> cmd) {
 
   if (requires_barrier) ClearTrackedBuffers(execution_stream_id);
 
-  commands_.push_back({std::move(cmd), requires_barrier});
+  absl::InlinedVector<BufferAllocation::Index, 4> allocs_indices;
+  for (const CommandBufferCmd::BufferUsage& buffer : buffers) {
+    allocs_indices.push_back(buffer.slice.index());
+  }
+
+  commands_.push_back({std::move(cmd), requires_barrier,
+                       std::move(allocs_indices), std::move(dependencies)});
   TrackBuffers(execution_stream_id, buffers);
 }
 
@@ -295,6 +312,55 @@ void CommandBufferCmdSequence::ClearTrackedBuffers(
   read_write_sets_[execution_stream_id] = ReadWriteSet();
 }
 
+std::vector<int64_t> CommandBufferCmdSequence::FindDependencies(
+    ExecutionStreamId execution_stream_id,
+    const CommandBufferCmd::BufferUsageVector& buffers, int64_t index) {
+  auto& accesses = buffer_accesses_[execution_stream_id];
+
+  // Reads depend on previous overlapping writes, and writes depend on all
+  // previous overlapping accesses.
+  absl::flat_hash_set<int64_t> dependencies;
+  for (const CommandBufferCmd::BufferUsage& buffer : buffers) {
+    auto it = accesses.find(buffer.slice.index());
+    if (it == accesses.end()) continue;
+    for (const BufferAccess& access : it->second) {
+      if (access.command == index) continue;
+      if (buffer.access == MemoryAccess::kRead &&
+          access.access == MemoryAccess::kRead) {
+        continue;
+      }
+      if (access.slice.OverlapsWith(buffer.slice)) {
+        dependencies.insert(access.command);
+      }
+    }
+  }
+
+  for (const CommandBufferCmd::BufferUsage& buffer : buffers) {
+    std::vector<BufferAccess>& slice_accesses =
+        accesses[buffer.slice.index()];
+
+    // Accesses fully covered by a write are ordered before it, and all future
+    // conflicting commands will depend on them through the write.
+    if (buffer.access == MemoryAccess::kWrite) {
+      const BufferAllocation::Slice& slice = buffer.slice;
+      slice_accesses.erase(
+          std::remove_if(slice_accesses.begin(), slice_accesses.end(),
+                         [&](const BufferAccess& access) {
+                           return access.command != index &&
+                                  access.slice.offset() >= slice.offset() &&
+                                  access.slice.offset() + access.slice.size() <=
+                                      slice.offset() + slice.size();
+                         }),
+          slice_accesses.end());
+    }
+    slice_accesses.push_back({buffer.slice, buffer.access, index});
+  }
+
+  std::vector<int64_t> sorted(dependencies.begin(), dependencies.end());
+  absl::c_sort(sorted);
+  return sorted;
+}
+
 static std::string_view RecordModeString(
     CommandBufferCmdSequence::RecordMode mode) {
   switch (mode) {
@@ -305,10 +371,72 @@ static std::string_view RecordModeString(
   }
 }
 
+// Returns the number of commands recorded into the execution scope.
+static int64_t NumRecordedCommands(const se::CommandBuffer* command_buffer,
+                                   ExecutionScopeId execution_scope_id) {
+  se::CommandBuffer::Position position = command_buffer->position();
+  auto it = position.scopes.find(execution_scope_id);
+  return it == position.scopes.end() ? 0 : it->second.num_commands;
+}
+
+absl::Status CommandBufferCmdSequence::RecordCommand(
+    size_t index, const Thunk::ExecuteParams& execute_params,
+    const CommandBufferCmd::RecordParams& record_params,
+    se::CommandBuffer* command_buffer,
+    absl::flat_hash_map<ExecutionScopeId, int64_t>& num_recorded_commands,
+    std::vector<se::CommandBuffer::CommandRange>& ranges) {
+  CommandInfo& command = commands_[index];
+  ExecutionScopeId execution_scope_id =
+      command.cmd->GetExecutionScope(record_params);
+  std::optional<tsl::profiler::ScopedAnnotation> annotation =
+      GetKernelAnnotation(command.cmd->profile_annotation());
+
+  bool track_dependencies =
+      synchronization_mode_ == SynchronizationMode::kDependencies;
+
+  if (command.requires_barrier) {
+    VLOG(3) << "Add command buffer barrier after "
+            << num_recorded_commands[execution_scope_id]
+            << " recorded commands into the execution scope #"
+            << execution_scope_id.value();
+    TF_RETURN_IF_ERROR(command_buffer->Barrier(execution_scope_id));
+    num_recorded_commands.erase(execution_scope_id);
+
+  } else if (track_dependencies) {
+    // Dependencies are always recorded before the command, so they are
+    // guaranteed to have valid command ranges.
+    absl::InlinedVector<se::CommandBuffer::CommandRange, 4> dependencies;
+    for (int64_t dependency : command.dependencies) {
+      dependencies.push_back(ranges[dependency]);
+    }
+    VLOG(5) << "Add command buffer dependency barrier for "
+            << dependencies.size() << " commands into the execution scope #"
+            << execution_scope_id.value();
+    TF_RETURN_IF_ERROR(
+        command_buffer->DependencyBarrier(execution_scope_id, dependencies));
+  }
+  VLOG(5) << "Record command buffer with scope id "
+          << execution_scope_id.value();
+
+  int64_t begin = track_dependencies
+                      ? NumRecordedCommands(command_buffer, execution_scope_id)
+                      : 0;
+  TF_RETURN_IF_ERROR(
+      command.cmd->Record(execute_params, record_params, command_buffer));
+  ++num_recorded_commands[execution_scope_id];
+
+  if (track_dependencies) {
+    ranges[index] = {begin,
+                     NumRecordedCommands(command_buffer, execution_scope_id)};
+  }
+  return absl::OkStatus();
+}
+
 absl::Status CommandBufferCmdSequence::Record(
     const Thunk::ExecuteParams& execute_params,
     const CommandBufferCmd::RecordParams& record_params,
-    se::CommandBuffer* command_buffer, RecordMode mode) {
+    se::CommandBuffer* command_buffer, RecordMode mode,
+    RecordedPositions* positions) {
   VLOG(3) << "Record " << commands_.size() << " commands into command buffer"
           << "; mode=" << RecordModeString(mode);
   uint64_t start_micros = tsl::Env::Default()->NowMicros();
@@ -319,34 +447,25 @@ absl::Status CommandBufferCmdSequence::Record(
     }
   }
 
+  if (positions) {
+    positions->clear();
+    positions->reserve(commands_.size());
+  }
+
   // Track the number of commands recorded between barriers.
   absl::flat_hash_map<ExecutionScopeId, int64_t> num_recorded_commands;
 
-  for (CommandInfo& command : commands_) {
-    if (execute_params.mock_collectives &&
-        dynamic_cast<CollectiveCmd*>(command.cmd.get())) {
-      continue;
-    }
+  // Track command buffer commands recorded for each command in the sequence.
+  std::vector<se::CommandBuffer::CommandRange> ranges(commands_.size());
 
-    ExecutionScopeId execution_scope_id =
-        command.cmd->GetExecutionScope(record_params);
-    std::optional<tsl::profiler::ScopedAnnotation> annotation =
-        GetKernelAnnotation(command.cmd->profile_annotation());
-
-    if (command.requires_barrier) {
-      VLOG(3) << "Add command buffer barrier after "
-              << num_recorded_commands[execution_scope_id]
-              << " recorded commands into the execution scope #"
-              << execution_scope_id.value();
-      TF_RETURN_IF_ERROR(command_buffer->Barrier(execution_scope_id));
-      num_recorded_commands.erase(execution_scope_id);
+  for (size_t i = 0; i < commands_.size(); ++i) {
+    if (!execute_params.mock_collectives ||
+        !dynamic_cast<CollectiveCmd*>(commands_[i].cmd.get())) {
+      TF_RETURN_IF_ERROR(RecordCommand(i, execute_params, record_params,
+                                       command_buffer, num_recorded_commands,
+                                       ranges));
     }
-    VLOG(5) << "Record command buffer with scope id "
-            << execution_scope_id.value();
-
-    TF_RETURN_IF_ERROR(
-        command.cmd->Record(execute_params, record_params, command_buffer));
-    ++num_recorded_commands[execution_scope_id];
+    if (positions) positions->push_back(command_buffer->position());
   }
 
   if (mode == RecordMode::kExclusive) {
@@ -361,6 +480,74 @@ absl::Status CommandBufferCmdSequence::Record(
   return absl::OkStatus();
 }
 
+absl::StatusOr<int64_t> CommandBufferCmdSequence::Update(
+    const Thunk::ExecuteParams& execute_params,
+    const CommandBufferCmd::RecordParams& record_params,
+    se::CommandBuffer* command_buffer,
+    const absl::flat_hash_set<BufferAllocation::Index>& updated_allocs,
+    const RecordedPositions& positions) {
+  if (positions.size() != commands_.size()) {
+    return Internal(
+        "Command buffer positions do not match the number of commands: %d vs "
+        "%d",
+        positions.size(), commands_.size());
+  }
+
+  uint64_t start_micros = tsl::Env::Default()->NowMicros();
+  TF_RETURN_IF_ERROR(command_buffer->Update());
+
+  // Track the number of commands recorded between barriers.
+  absl::flat_hash_map<ExecutionScopeId, int64_t> num_recorded_commands;
+
+  // Command ranges are only used to construct dependency barriers, and at
+  // update time command buffer structure does not change.
+  std::vector<se::CommandBuffer::CommandRange> ranges(commands_.size());
+
+  // Index of the last skipped command. Before updating the next command we
+  // move the command buffer update position past all skipped commands.
+  std::optional<size_t> last_skipped;
+  int64_t num_updated = 0;
+
+  for (size_t i = 0; i < commands_.size(); ++i) {
+    CommandInfo& command = commands_[i];
+
+    bool requires_update =
+        command.cmd->force_update() ||
+        absl::c_any_of(command.allocs_indices,
+                       [&](BufferAllocation::Index index) {
+                         return updated_allocs.contains(index);
+                       });
+    if (!requires_update || (execute_params.mock_collectives &&
+                             dynamic_cast<CollectiveCmd*>(command.cmd.get()))) {
+      last_skipped = i;
+      continue;
+    }
+
+    if (last_skipped.has_value()) {
+      TF_RETURN_IF_ERROR(command_buffer->SkipUpdates(positions[*last_skipped]));
+      last_skipped.reset();
+    }
+
+    TF_RETURN_IF_ERROR(RecordCommand(i, execute_params, record_params,
+                                     command_buffer, num_recorded_commands,
+                                     ranges));
+    ++num_updated;
+  }
+
+  if (last_skipped.has_value()) {
+    TF_RETURN_IF_ERROR(command_buffer->SkipUpdates(positions[*last_skipped]));
+  }
+
+  TF_RETURN_IF_ERROR(command_buffer->Finalize());
+
+  uint64_t end_micros = tsl::Env::Default()->NowMicros();
+  VLOG(3) << "Updated " << num_updated << " out of " << commands_.size()
+          << " commands in command buffer in " << (end_micros - start_micros)
+          << " μs";
+
+  return num_updated;
+}
+
 const absl::flat_hash_set<CommandBufferCmd::BufferUsage>&
 CommandBufferCmdSequence::buffers() const {
   return buffers_;
@@ -378,6 +565,14 @@ std::vector<bool> CommandBufferCmdSequence::barriers() const {
   return barriers;
 }
 
+std::vector<std::vector<int64_t>> CommandBufferCmdSequence::dependencies()
+    const {
+  std::vector<std::vector<int64_t>> dependencies;
+  absl::c_transform(commands_, std::back_inserter(dependencies),
+                    [](auto& command) { return command.dependencies; });
+  return dependencies;
+}
+
 //===----------------------------------------------------------------------===//
 // TracedCommandBuffer
 //===----------------------------------------------------------------------===//
@@ -1203,25 +1398,26 @@ CublasLtCmd::CublasLtCmd(
       d_amax_buffer_(d_amax_buffer),
       workspace_buffer_(workspace_buffer) {}
 
-absl::StatusOr<se::gpu::BlasLt::MatmulPlan*> CublasLtCmd::GetMatmulPlan(
-    const stream_executor::Stream* stream) {
+absl::StatusOr<const se::gpu::BlasLt::MatmulPlan*>
+CublasLtCmd::GetMatmulPlan(const stream_executor::Stream* stream) {
   auto it = matmul_plans_cache_.find(stream);
-  if (it != matmul_plans_cache_.end()) return it->second.get();
-  TF_ASSIGN_OR_RETURN(auto plan, se::gpu::BlasLt::GetMatmulPlan(
+  if (it != matmul_plans_cache_.end()) return it->second;
+  TF_ASSIGN_OR_RETURN(auto plan, se::gpu::BlasLt::GetOrCreateMatmulPlan(
                                      stream, gemm_config_, epilogue_));
-  auto [it_insert, _] = matmul_plans_cache_.emplace(stream, std::move(plan));
-  return it_insert->second.get();
+  auto [it_insert, _] = matmul_plans_cache_.emplace(stream, plan);
+  return it_insert->second;
 }
 
 absl::StatusOr<se::gpu::BlasLt::MatmulAlgorithm>
-CublasLtCmd::GetMatmulAlgorithm(const se::gpu::BlasLt::MatmulPlan* plan,
+CublasLtCmd::GetMatmulAlgorithm(const stream_executor::Stream* stream,
+                                const se::gpu::BlasLt::MatmulPlan* plan,
                                 int64_t max_workspace) {
   auto it = matmul_algorithm_cache_.find(plan);
   if (it != matmul_algorithm_cache_.end()) return it->second;
-  TF_ASSIGN_OR_RETURN(
-      auto algorithms,
-      plan->GetAlgorithms(/*max_algorithm_count*/ 128,
-                          /*max_workspace_size*/ max_workspace));
+  TF_ASSIGN_OR_RETURN(auto algorithms,
+                      se::gpu::BlasLt::GetCachedAlgorithms(
+                          stream, plan, /*max_algorithm_count=*/128,
+                          /*max_workspace_size=*/max_workspace));
   TF_RET_CHECK(algorithm_idx_ >= 0 && algorithm_idx_ < algorithms.size());
   auto [it_insert, _] =
       matmul_algorithm_cache_.emplace(plan, algorithms[algorithm_idx_]);
@@ -1236,7 +1432,8 @@ absl::Status CublasLtCmd::Initialize(const Thunk::InitializeParams& params,
   // Populate plan and algorithm cache;
   TF_ASSIGN_OR_RETURN(auto plan, GetMatmulPlan(params.stream));
   TF_RETURN_IF_ERROR(
-      GetMatmulAlgorithm(plan, workspace_buffer_.size()).status());
+      GetMatmulAlgorithm(params.stream, plan, workspace_buffer_.size())
+          .status());
   return absl::OkStatus();
 }
 
@@ -1245,7 +1442,8 @@ absl::Status CublasLtCmd::Record(const Thunk::ExecuteParams& execute_params,
                                  se::CommandBuffer* command_buffer) {
   TF_ASSIGN_OR_RETURN(auto plan, GetMatmulPlan(execute_params.stream));
   TF_ASSIGN_OR_RETURN(auto algorithm,
-                      GetMatmulAlgorithm(plan, workspace_buffer_.size()));
+                      GetMatmulAlgorithm(execute_params.stream, plan,
+                                         workspace_buffer_.size()));
 
   const BufferAllocations& allocs = *execute_params.buffer_allocations;
 
@@ -1648,11 +1846,22 @@ AllReduceCmd::AllReduceCmd(
     ExecutionStreamId execution_stream_id,
     ExecutionStreamId async_from_stream_id, NcclApi* nccl_api,
     NcclCollectiveConfig config, ReductionKind reduction_kind,
-    absl::Span<const NcclCollectiveThunk::Buffer> buffers)
+    absl::Span<const NcclCollectiveThunk::Buffer> buffers,
+    std::shared_ptr<OneShotAllReduceResources> one_shot_resources)
     : CollectiveCmd(CommandBufferCmdType::kAllReduceCmd, execution_stream_id,
                     async_from_stream_id, nccl_api, std::move(config)),
       reduction_kind_(reduction_kind),
-      buffers_(buffers.begin(), buffers.end()) {}
+      buffers_(buffers.begin(), buffers.end()),
+      one_shot_resources_(std::move(one_shot_resources)) {}
+
+absl::Status AllReduceCmd::Initialize(const Thunk::InitializeParams& params,
+                                      StateManager& state) {
+  if (one_shot_resources_) {
+    TF_RETURN_IF_ERROR(one_shot_resources_->Initialize(
+        params, config(), nccl_stream_id(), GetAsyncStreamKind()));
+  }
+  return absl::OkStatus();
+}
 
 absl::Status AllReduceCmd::Record(const Thunk::ExecuteParams& execute_params,
                                   const RecordParams& record_params,
@@ -1694,8 +1903,16 @@ absl::Status AllReduceCmd::Record(const Thunk::ExecuteParams& execute_params,
                 execute_params.buffer_allocations->memory_allocator(),
                 execute_params.stream));
 
+  // One-shot all-reduce keeps its synchronization state in device memory, so
+  // it can be traced into a command buffer and replayed like any other kernel.
   return AddTracedCommandBuffer(
       execute_params, record_params, command_buffer, [&](se::Stream* stream) {
+        if (one_shot_resources_ &&
+            one_shot_resources_->IsSupported(stream->parent(),
+                                             device_buffers)) {
+          return one_shot_resources_->Run(reduction_kind_, device_buffers,
+                                          *stream);
+        }
         return RunAllReduce(nccl_api(), reduction_kind_, device_buffers,
                             *stream, comm);
       });
@@ -32,6 +32,7 @@ limitations under the License.
 #include "absl/container/inlined_vector.h"
 #include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
@@ -44,6 +45,7 @@ limitations under the License.
 #include "xla/service/gpu/launch_dimensions.h"
 #include "xla/service/gpu/matmul_utils.h"
 #include "xla/service/gpu/runtime/custom_call_thunk.h"
+#include "xla/service/gpu/runtime/nccl_all_reduce_thunk.h"
 #include "xla/service/gpu/runtime/nccl_api.h"
 #include "xla/service/gpu/runtime/nccl_clique_key.h"
 #include "xla/service/gpu/runtime/nccl_collective_thunk.h"
@@ -306,7 +308,16 @@ class CommandBufferCmdSequence {
     // that have read-write conflicts into the same buffers. Conflicts are
     // detected only between commands using the same stream id, and inter-stream
     // synchronization is a user responsibility.
-    kAutomatic
+    kAutomatic,
+
+    // Relies on buffer use analysis to find read-write conflicts between
+    // individual commands, and records explicit dependency edges only between
+    // conflicting commands (see `se::CommandBuffer::DependencyBarrier`). Unlike
+    // barriers in automatic mode, dependency edges do not serialize commands
+    // that do not conflict with each other, so independent commands recorded
+    // after a conflicting one still run concurrently. As in automatic mode
+    // inter-stream synchronization is a user responsibility.
+    kDependencies
   };
 
   enum class RecordMode {
@@ -342,11 +353,31 @@ class CommandBufferCmdSequence {
   absl::Status Initialize(const Thunk::InitializeParams& params,
                           CommandBufferCmd::StateManager& state);
 
-  // Records all commands added to a sequence into the given command buffer.
+  // Command buffer positions after recording each command in a sequence.
+  using RecordedPositions = std::vector<se::CommandBuffer::Position>;
+
+  // Records all commands added to a sequence into the given command buffer. If
+  // `positions` is not null, it is filled with command buffer positions after
+  // recording each command, which can be later used to update only a subset of
+  // recorded commands (see `Update` below).
   absl::Status Record(const Thunk::ExecuteParams& execute_params,
                       const CommandBufferCmd::RecordParams& record_params,
                       se::CommandBuffer* command_buffer,
-                      RecordMode mode = RecordMode::kExclusive);
+                      RecordMode mode = RecordMode::kExclusive,
+                      RecordedPositions* positions = nullptr);
+
+  // Updates a command buffer previously recorded from this sequence in the
+  // exclusive mode. Only commands that use at least one of `updated_allocs`, or
+  // that require an update on every call, are recorded again, all other
+  // commands are skipped and keep the parameters they were recorded with.
+  // `positions` must be the positions collected by the last `Record` into the
+  // same command buffer. Returns the number of updated commands.
+  absl::StatusOr<int64_t> Update(
+      const Thunk::ExecuteParams& execute_params,
+      const CommandBufferCmd::RecordParams& record_params,
+      se::CommandBuffer* command_buffer,
+      const absl::flat_hash_set<BufferAllocation::Index>& updated_allocs,
+      const RecordedPositions& positions);
 
   // Returns buffers referenced by commands in this sequence.
   const absl::flat_hash_set<CommandBufferCmd::BufferUsage>& buffers() const;
@@ -358,6 +389,10 @@ class CommandBufferCmdSequence {
   // barrier.
   std::vector<bool> barriers() const;
 
+  // Returns indices of commands that the command at the given index depends on
+  // (always empty if synchronization mode is not kDependencies).
+  std::vector<std::vector<int64_t>> dependencies() const;
+
   bool empty() const { return commands_.empty(); }
   size_t size() const { return commands_.size(); }
 
@@ -371,8 +406,26 @@ class CommandBufferCmdSequence {
   struct CommandInfo {
     std::unique_ptr<CommandBufferCmd> cmd;
     bool requires_barrier;
+
+    // Buffer allocations indices referenced by the command.
+    absl::InlinedVector<BufferAllocation::Index, 4> allocs_indices;
+
+    // Indices of commands that must complete before this command starts
+    // (only in kDependencies synchronization mode).
+    std::vector<int64_t> dependencies;
   };
 
+  // Records a command at the given index into the command buffer, and adds a
+  // barrier (or a dependency barrier) before it if required. Command buffer
+  // commands recorded for each command of a sequence are tracked in `ranges`.
+  absl::Status RecordCommand(
+      size_t index, const Thunk::ExecuteParams& execute_params,
+      const CommandBufferCmd::RecordParams& record_params,
+      se::CommandBuffer* command_buffer,
+      absl::flat_hash_map<se::CommandBuffer::ExecutionScopeId, int64_t>&
+          num_recorded_commands,
+      std::vector<se::CommandBuffer::CommandRange>& ranges);
+
   // Functions for tracking buffer usage of recorded commands and figuring out
   // when the next command requires a barrier for correctness.
   bool HasConflicts(ExecutionStreamId execution_stream_id,
@@ -381,6 +434,13 @@ class CommandBufferCmdSequence {
                     const CommandBufferCmd::BufferUsageVector& buffers);
   void ClearTrackedBuffers(ExecutionStreamId execution_stream_id);
 
+  // Returns indices of previously appended commands that have read-write
+  // conflicts with `buffers`, and tracks `buffers` as used by the command at
+  // `index`.
+  std::vector<int64_t> FindDependencies(
+      ExecutionStreamId execution_stream_id,
+      const CommandBufferCmd::BufferUsageVector& buffers, int64_t index);
+
   SynchronizationMode synchronization_mode_;
   std::vector<CommandInfo> commands_;
 
@@ -399,6 +459,20 @@ class CommandBufferCmdSequence {
   };
 
   absl::flat_hash_map<ExecutionStreamId, ReadWriteSet> read_write_sets_;
+
+  // In kDependencies mode we track all buffer accesses of commands that can
+  // still conflict with the next appended commands. Accesses are grouped by
+  // execution stream and buffer allocation index.
+  struct BufferAccess {
+    BufferAllocation::Slice slice;
+    CommandBufferCmd::MemoryAccess access;
+    int64_t command;
+  };
+
+  absl::flat_hash_map<
+      ExecutionStreamId,
+      absl::flat_hash_map<BufferAllocation::Index, std::vector<BufferAccess>>>
+      buffer_accesses_;
 };
 
 //===----------------------------------------------------------------------===//
@@ -813,14 +887,16 @@ class CublasLtCmd : public TracedCommandBufferCmd {
   bool IsNestedCommandBuffer() const final { return true; }
 
  private:
-  absl::StatusOr<se::gpu::BlasLt::MatmulPlan*> GetMatmulPlan(
+  absl::StatusOr<const se::gpu::BlasLt::MatmulPlan*> GetMatmulPlan(
       const stream_executor::Stream* stream);
 
   absl::StatusOr<se::gpu::BlasLt::MatmulAlgorithm> GetMatmulAlgorithm(
+      const stream_executor::Stream* stream,
       const se::gpu::BlasLt::MatmulPlan* plan, int64_t max_workspace);
 
+  // Plans are owned by the cache of the executor's BlasLt.
   absl::flat_hash_map<const stream_executor::Stream*,
-                      se::gpu::BlasLt::MatmulPlanPtr>
+                      const se::gpu::BlasLt::MatmulPlan*>
       matmul_plans_cache_;
 
   absl::flat_hash_map<const se::gpu::BlasLt::MatmulPlan*,
@@ -1031,7 +1107,12 @@ class AllReduceCmd : public CollectiveCmd {
   AllReduceCmd(ExecutionStreamId execution_stream_id,
                ExecutionStreamId async_from_stream_id, NcclApi* nccl_api,
                NcclCollectiveConfig config, ReductionKind reduction_kind,
-               absl::Span<const NcclCollectiveThunk::Buffer> buffers);
+               absl::Span<const NcclCollectiveThunk::Buffer> buffers,
+               std::shared_ptr<OneShotAllReduceResources> one_shot_resources =
+                   nullptr);
+
+  absl::Status Initialize(const Thunk::InitializeParams& params,
+                          StateManager& state) override;
 
   absl::Status Record(const Thunk::ExecuteParams& execute_params,
                       const RecordParams& record_params,
@@ -1046,6 +1127,7 @@ class AllReduceCmd : public CollectiveCmd {
  private:
   ReductionKind reduction_kind_;
   std::vector<NcclCollectiveThunk::Buffer> buffers_;
+  std::shared_ptr<OneShotAllReduceResources> one_shot_resources_;
 };
 
 //===----------------------------------------------------------------------===//
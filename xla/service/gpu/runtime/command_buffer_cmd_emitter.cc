@@ -163,7 +163,7 @@ static absl::StatusOr<Command> Convert(const NcclAllReduceStartThunk& thunk) {
   return std::make_unique<AllReduceCmd>(
       thunk.nccl_execution_stream_id(), thunk.execution_stream_id(),
       thunk.nccl_api(), thunk.config(), thunk.reduction_kind(),
-      thunk.buffers());
+      thunk.buffers(), thunk.one_shot_resources());
 }
 
 static absl::StatusOr<Command> Convert(
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/service/gpu/runtime/command_buffer_cmd.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <vector>
@@ -195,6 +196,38 @@ TEST(CommandBufferCmdTest, NoWriteConflictsAcrossStreams) {
   EXPECT_EQ(commands.barriers().at(1), false);
 }
 
+TEST(CommandBufferCmdTest, DependenciesBetweenConflictingCommands) {
+  BufferAllocation alloc0(/*index=*/0, /*size=*/1024, /*color=*/0);
+  BufferAllocation alloc1(/*index=*/1, /*size=*/1024, /*color=*/0);
+
+  auto slice0 = BufferAllocation::Slice(&alloc0, 0, 100);
+  auto slice1 = BufferAllocation::Slice(&alloc0, 50, 100);
+  auto slice2 = BufferAllocation::Slice(&alloc1, 0, 100);
+
+  // Command #2 conflicts only with command #0, and command #3 runs on a
+  // different execution stream. Command #4 writes into the same slice as
+  // command #0, and conflicts with its write and a read in command #2.
+  auto use0 = BufferUsage(slice0, MemoryAccess::kWrite);
+  auto use1 = BufferUsage(slice2, MemoryAccess::kWrite);
+  auto use2 = BufferUsage(slice1, MemoryAccess::kRead);
+  auto use3 = BufferUsage(slice1, MemoryAccess::kWrite);
+
+  CommandBufferCmdSequence commands(
+      CommandBufferCmdSequence::SynchronizationMode::kDependencies);
+  commands.Emplace<TestOnlyCommandBufferCmd>(s0, BufferUsageVector{use0});
+  commands.Emplace<TestOnlyCommandBufferCmd>(s0, BufferUsageVector{use1});
+  commands.Emplace<TestOnlyCommandBufferCmd>(s0, BufferUsageVector{use2});
+  commands.Emplace<TestOnlyCommandBufferCmd>(s1, BufferUsageVector{use3});
+  commands.Emplace<TestOnlyCommandBufferCmd>(s0, BufferUsageVector{use0});
+
+  // Dependencies do not require barriers.
+  EXPECT_EQ(commands.barriers(),
+            std::vector<bool>({false, false, false, false, false}));
+
+  std::vector<std::vector<int64_t>> expected = {{}, {}, {0}, {}, {0, 2}};
+  EXPECT_EQ(commands.dependencies(), expected);
+}
+
 TEST(CommandBufferCmdTest, MemcpyCmd) {
   se::StreamExecutor* executor = GpuExecutor();
 
@@ -389,6 +422,102 @@ TEST(CommandBufferCmdTest, LaunchCmd) {
   ASSERT_EQ(dst, std::vector<int32_t>(4, 42 + 42));
 }
 
+TEST(CommandBufferCmdTest, UpdateOnlyChangedCommands) {
+  se::StreamExecutor* executor = GpuExecutor();
+
+  auto stream = executor->CreateStream().value();
+  int64_t length = 4;
+  int64_t byte_length = sizeof(int32_t) * length;
+
+  // Prepare arguments: a=42, b=0, c=21, d=0
+  se::DeviceMemory<int32_t> a = executor->AllocateArray<int32_t>(length, 0);
+  se::DeviceMemory<int32_t> b = executor->AllocateArray<int32_t>(length, 0);
+  se::DeviceMemory<int32_t> c = executor->AllocateArray<int32_t>(length, 0);
+  se::DeviceMemory<int32_t> d = executor->AllocateArray<int32_t>(length, 0);
+
+  TF_ASSERT_OK(stream->Memset32(&a, 42, byte_length));
+  TF_ASSERT_OK(stream->MemZero(&b, byte_length));
+  TF_ASSERT_OK(stream->Memset32(&c, 21, byte_length));
+  TF_ASSERT_OK(stream->MemZero(&d, byte_length));
+
+  // Prepare buffer allocations for recording command buffer.
+  BufferAllocation alloc_a(/*index=*/0, byte_length, /*color=*/0);
+  BufferAllocation alloc_b(/*index=*/1, byte_length, /*color=*/0);
+  BufferAllocation alloc_c(/*index=*/2, byte_length, /*color=*/0);
+  BufferAllocation alloc_d(/*index=*/3, byte_length, /*color=*/0);
+
+  BufferAllocation::Slice slice_a(&alloc_a, 0, byte_length);
+  BufferAllocation::Slice slice_b(&alloc_b, 0, byte_length);
+  BufferAllocation::Slice slice_c(&alloc_c, 0, byte_length);
+  BufferAllocation::Slice slice_d(&alloc_d, 0, byte_length);
+
+  auto args = {slice_a, slice_a, slice_b};    // b = a + a
+  auto args_1 = {slice_c, slice_c, slice_d};  // d = c + c
+  auto args_access = {MemoryAccess::kRead, MemoryAccess::kRead,
+                      MemoryAccess::kWrite};
+
+  // Prepare commands sequence for constructing command buffer.
+  CommandBufferCmdSequence commands;
+  commands.Emplace<LaunchCmd>(s0, "AddI32", args, args_access,
+                              LaunchDimensions(1, 4),
+                              /*shmem_bytes=*/0);
+  commands.Emplace<LaunchCmd>(s0, "AddI32", args_1, args_access,
+                              LaunchDimensions(1, 4),
+                              /*shmem_bytes=*/0);
+
+  // Initialize command sequence and load device kernels.
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<uint8_t> fatbin,
+                          se::gpu::GetGpuTestKernelsFatbin());
+  Thunk::ExecutableSource source = {/*text=*/{},
+                                    /*binary=*/fatbin};
+
+  CommandBufferCmd::StateManager state;
+  TF_ASSERT_OK(commands.Initialize({executor, source}, state));
+
+  ServiceExecutableRunOptions run_options;
+  se::StreamExecutorMemoryAllocator allocator(executor);
+  BufferAllocations allocations({a, b, c, d}, 0, &allocator);
+
+  Thunk::ExecuteParams params = Thunk::ExecuteParams::Create(
+      run_options, allocations, stream.get(), stream.get(), nullptr, nullptr);
+
+  CommandBufferCmd::RecordParams record_params = {state};
+
+  auto command_buffer =
+      executor->CreateCommandBuffer(se::CommandBuffer::Mode::kPrimary).value();
+
+  CommandBufferCmdSequence::RecordedPositions positions;
+  TF_ASSERT_OK(commands.Record(params, record_params, command_buffer.get(),
+                               CommandBufferCmdSequence::RecordMode::kExclusive,
+                               &positions));
+  ASSERT_EQ(positions.size(), 2);
+
+  // Update buffer allocation #3 to buffer `e`.
+  se::DeviceMemory<int32_t> e = executor->AllocateArray<int32_t>(length, 0);
+  TF_ASSERT_OK(stream->MemZero(&e, byte_length));
+  TF_ASSERT_OK(stream->MemZero(&b, byte_length));
+  allocations = BufferAllocations({a, b, c, e}, 0, &allocator);
+
+  // Only the second command uses an updated allocation.
+  TF_ASSERT_OK_AND_ASSIGN(
+      int64_t num_updated,
+      commands.Update(params, record_params, command_buffer.get(),
+                      /*updated_allocs=*/{3}, positions));
+  EXPECT_EQ(num_updated, 1);
+
+  TF_ASSERT_OK(command_buffer->Submit(stream.get()));
+
+  // Skipped command still writes to `b`.
+  std::vector<int32_t> dst(4, 0);
+  TF_ASSERT_OK(stream->Memcpy(dst.data(), b, byte_length));
+  ASSERT_EQ(dst, std::vector<int32_t>(4, 42 + 42));
+
+  // Updated command writes to `e`.
+  std::fill(dst.begin(), dst.end(), 0);
+  TF_ASSERT_OK(stream->Memcpy(dst.data(), e, byte_length));
+  ASSERT_EQ(dst, std::vector<int32_t>(4, 21 + 21));
+}
+
 TEST(CommandBufferCmdStateManageTest, GetOrCreateState) {
   struct TestState : public CommandBufferCmd::State {
     int32_t value = 0;
@@ -90,6 +90,7 @@ bool CommandBufferThunk::ExecutorCommandBuffer::ShouldUpdateCommandBuffer(
 
   bool should_update = false;
   const BufferAllocations* allocs = params.buffer_allocations;
+  updated_allocs.clear();
 
   // We check only allocations referenced by commands in a cmd sequence, and
   // leave every other entry default initialized (nullptr device memory).
@@ -103,6 +104,7 @@ bool CommandBufferThunk::ExecutorCommandBuffer::ShouldUpdateCommandBuffer(
 
     if (!recorded_allocs[index].IsSameAs(alloc)) {
       recorded_allocs[index] = alloc;
+      updated_allocs.insert(index);
       should_update = true;
     }
   }
@@ -181,8 +183,10 @@ absl::Status CommandBufferThunk::Initialize(const InitializeParams& params) {
     uint64_t start_micros = tsl::Env::Default()->NowMicros();
 
     CommandBufferCmd::RecordParams record_params = {cmd_buffer->state};
-    TF_RETURN_IF_ERROR(commands_.Record(execute_params, record_params,
-                                        cmd_buffer->command_buffer.get()));
+    TF_RETURN_IF_ERROR(commands_.Record(
+        execute_params, record_params, cmd_buffer->command_buffer.get(),
+        CommandBufferCmdSequence::RecordMode::kExclusive,
+        &cmd_buffer->recorded_positions));
 
     uint64_t end_micros = tsl::Env::Default()->NowMicros();
     VLOG(3) << "Initialized command buffer on device #"
@@ -190,6 +194,7 @@ absl::Status CommandBufferThunk::Initialize(const InitializeParams& params) {
             << (end_micros - start_micros)
             << " μs; num_commands=" << commands_.size();
     cmd_buffer->num_executions = 0;
+    ++cmd_buffer->num_records;
   }
 
   return absl::OkStatus();
@@ -234,12 +239,37 @@ absl::Status CommandBufferThunk::ExecuteOnStream(const ExecuteParams& params) {
     uint64_t start_micros = tsl::Env::Default()->NowMicros();
 
     CommandBufferCmd::RecordParams record_params = {cmd_buffer->state};
-    TF_RETURN_IF_ERROR(commands_.Record(params, record_params,
-                                        cmd_buffer->command_buffer.get()));
+
+    // If command buffer was already recorded, we update only the commands that
+    // use updated allocations, otherwise we record all commands.
+    if (cmd_buffer->command_buffer->state() ==
+            se::CommandBuffer::State::kFinalized &&
+        cmd_buffer->recorded_positions.size() == commands_.size()) {
+      TF_ASSIGN_OR_RETURN(
+          int64_t num_updated_commands,
+          commands_.Update(params, record_params,
+                           cmd_buffer->command_buffer.get(),
+                           cmd_buffer->updated_allocs,
+                           cmd_buffer->recorded_positions));
+      ++cmd_buffer->num_updates;
+      cmd_buffer->num_updated_commands += num_updated_commands;
+      cmd_buffer->num_skipped_commands +=
+          commands_.size() - num_updated_commands;
+    } else {
+      TF_RETURN_IF_ERROR(commands_.Record(
+          params, record_params, cmd_buffer->command_buffer.get(),
+          CommandBufferCmdSequence::RecordMode::kExclusive,
+          &cmd_buffer->recorded_positions));
+      ++cmd_buffer->num_records;
+    }
 
     uint64_t end_micros = tsl::Env::Default()->NowMicros();
     VLOG(3) << "Updated command buffer in " << (end_micros - start_micros)
-            << " μs; num_commands=" << commands_.size();
+            << " μs; num_commands=" << commands_.size()
+            << "; num_records=" << cmd_buffer->num_records
+            << "; num_updates=" << cmd_buffer->num_updates
+            << "; num_updated_commands=" << cmd_buffer->num_updated_commands
+            << "; num_skipped_commands=" << cmd_buffer->num_skipped_commands;
     cmd_buffer->num_executions = 0;
   }
 
@@ -23,9 +23,11 @@ limitations under the License.
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "xla/service/buffer_assignment.h"
 #include "xla/service/gpu/runtime/command_buffer_cmd.h"
 #include "xla/service/gpu/runtime/sequential_thunk.h"
 #include "xla/service/gpu/runtime/thunk.h"
@@ -62,7 +64,9 @@ class CommandBufferThunk : public Thunk {
         std::unique_ptr<se::CommandBuffer> command_buffer);
 
     // Returns true if `commands` cmd sequence has to be recorded into
-    // `command_buffer` to update it (see `recorded_allocs` below).
+    // `command_buffer` to update it (see `recorded_allocs` below). Indices of
+    // allocations that changed since the last call are stored in
+    // `updated_allocs`.
     bool ShouldUpdateCommandBuffer(const CommandBufferCmdSequence& commands,
                                    const Thunk::ExecuteParams& params)
         ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex);
@@ -89,8 +93,28 @@ class CommandBufferThunk : public Thunk {
     // change.
     std::vector<se::DeviceMemoryBase> recorded_allocs ABSL_GUARDED_BY(mutex);
 
+    // Buffer allocations that changed since the last call to `Record` or
+    // `Update`. Only commands that use these allocations have to be updated.
+    absl::flat_hash_set<BufferAllocation::Index> updated_allocs
+        ABSL_GUARDED_BY(mutex);
+
+    // Command buffer positions after each command recorded by the last call to
+    // `commands_.Record(...)`. Once command buffer is recorded, we update only
+    // commands that use updated allocations and skip all other commands.
+    CommandBufferCmdSequence::RecordedPositions recorded_positions
+        ABSL_GUARDED_BY(mutex);
+
     // Number of command buffer executions since last update.
     int64_t num_executions ABSL_GUARDED_BY(mutex) = 0;
+
+    // Number of times all commands were recorded into the command buffer, and
+    // the number of incremental command buffer updates.
+    int64_t num_records ABSL_GUARDED_BY(mutex) = 0;
+    int64_t num_updates ABSL_GUARDED_BY(mutex) = 0;
+
+    // Total number of commands updated and skipped by incremental updates.
+    int64_t num_updated_commands ABSL_GUARDED_BY(mutex) = 0;
+    int64_t num_skipped_commands ABSL_GUARDED_BY(mutex) = 0;
   };
 
   // Command buffer thunk owns commands buffers instantiated on all executors.
@@ -22,6 +22,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -42,6 +43,7 @@ limitations under the License.
 #include "xla/stream_executor/stream.h"
 #include "xla/util.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "xla/stream_executor/gpu/gpu_stream.h"
@@ -54,6 +56,39 @@ using xla::ffi::CallFrame;
 using xla::ffi::CallFrameBuilder;
 using xla::ffi::CallOptions;
 
+// Builds a call frame for the given operands and results with placeholder
+// buffers, to be updated with device memory addresses at run time.
+static CallFrame BuildCallFrameTemplate(
+    const std::vector<std::optional<CustomCallThunk::Slice>>& operands,
+    const std::vector<std::optional<CustomCallThunk::Slice>>& results,
+    const CustomCallThunk::AttributesMap& attributes) {
+  CallFrameBuilder builder(operands.size(), results.size());
+
+  for (const std::optional<CustomCallThunk::Slice>& operand : operands) {
+    if (!operand.has_value()) {
+      builder.AddTokenArg();
+      continue;
+    }
+    builder.AddBufferArg(se::DeviceMemoryBase{}, operand->shape.element_type(),
+                         operand->shape.dimensions());
+  }
+
+  for (const std::optional<CustomCallThunk::Slice>& result : results) {
+    if (!result.has_value()) {
+      builder.AddTokenRet();
+      continue;
+    }
+    builder.AddBufferRet(se::DeviceMemoryBase{}, result->shape.element_type(),
+                         result->shape.dimensions());
+  }
+
+  CallFrameBuilder::AttributesBuilder attrs;
+  attrs.Append(attributes);
+
+  builder.AddAttributes(attrs.Build());
+  return builder.Build();
+}
+
 absl::StatusOr<std::unique_ptr<CustomCallThunk>> CustomCallThunk::Create(
     ThunkInfo thunk_info, CustomCallTarget call_target,
     std::vector<std::optional<Slice>> operands,
@@ -88,9 +123,11 @@ absl::StatusOr<std::unique_ptr<CustomCallThunk>> CustomCallThunk::Create(
                             XLA_FFI_ExecutionStage_INSTANTIATE));
   }
 
+  CallFrame call_frame = BuildCallFrameTemplate(operands, results, attributes);
+
   return absl::WrapUnique(new CustomCallThunk(
       thunk_info, bundle, std::move(operands), std::move(results),
-      std::move(attributes), std::move(execution_state), called_computation));
+      std::move(call_frame), std::move(execution_state), called_computation));
 }
 
 CustomCallThunk::CustomCallThunk(ThunkInfo thunk_info,
@@ -107,14 +144,15 @@ CustomCallThunk::CustomCallThunk(ThunkInfo thunk_info,
 CustomCallThunk::CustomCallThunk(
     ThunkInfo thunk_info, XLA_FFI_Handler_Bundle bundle,
     std::vector<std::optional<Slice>> operands,
-    std::vector<std::optional<Slice>> results, AttributesMap attributes,
+    std::vector<std::optional<Slice>> results, CallFrame call_frame,
     std::unique_ptr<ffi::ExecutionState> execution_state,
     const HloComputation* called_computation)
     : Thunk(Thunk::kCustomCall, thunk_info),
       operands_(std::move(operands)),
       results_(std::move(results)),
       bundle_(bundle),
-      attributes_(std::move(attributes)),
+      call_frames_(
+          std::make_unique<ffi::CallFramePool>(std::move(call_frame))),
       execution_state_(std::move(execution_state)),
       called_computation_(called_computation) {}
 
@@ -167,10 +205,6 @@ absl::Status CustomCallThunk::ExecuteFfiHandler(
     return absl::InternalError("buffer allocations and stream are required");
   }
 
-  // TODO(ezhulenev): This is not the most optimal approach, as we'll be doing
-  // a lot of extra allocation on every call. We have to keep attributes
-  // separate from arguments, as they do not change after thunk is constructed.
-  CallFrameBuilder builder(operands_.size(), results_.size());
   auto device_address =
       [buffer_allocations](
           BufferAllocation::Slice slice) -> se::DeviceMemoryBase {
@@ -178,39 +212,38 @@ absl::Status CustomCallThunk::ExecuteFfiHandler(
                               : se::DeviceMemoryBase{};
   };
 
+  // Attributes, types and dimensions are already in the call frame template,
+  // we only need to collect device memory addresses of arguments and results.
+  absl::InlinedVector<se::DeviceMemoryBase, 8> arguments;
+  arguments.reserve(operands_.size());
   for (auto& operand : operands_) {
     if (!operand.has_value()) {
-      builder.AddTokenArg();
+      arguments.emplace_back();
       continue;
     }
 
     if (!operand->slice.allocation())
       return Internal("custom call argument missing buffer allocation");
 
-    builder.AddBufferArg(device_address(operand->slice),
-                         operand->shape.element_type(),
-                         operand->shape.dimensions());
+    arguments.push_back(device_address(operand->slice));
   }
 
+  absl::InlinedVector<se::DeviceMemoryBase, 4> rets;
+  rets.reserve(results_.size());
   for (auto& result : results_) {
     if (!result.has_value()) {
-      builder.AddTokenRet();
+      rets.emplace_back();
       continue;
     }
 
     if (!result->slice.allocation())
       return Internal("custom call result missing buffer allocation");
 
-    builder.AddBufferRet(device_address(result->slice),
-                         result->shape.element_type(),
-                         result->shape.dimensions());
+    rets.push_back(device_address(result->slice));
   }
 
-  CallFrameBuilder::AttributesBuilder attrs;
-  attrs.Append(attributes_);
-
-  builder.AddAttributes(attrs.Build());
-  CallFrame call_frame = builder.Build();
+  TF_ASSIGN_OR_RETURN(ffi::CallFramePool::Ptr call_frame,
+                      call_frames_->BorrowCallFrame(arguments, rets));
 
   int32_t device_ordinal = -1;
   se::DeviceMemoryAllocator* allocator = nullptr;
@@ -222,7 +255,7 @@ absl::Status CustomCallThunk::ExecuteFfiHandler(
   CallOptions options = {
       device_ordinal, CallOptions::GpuOptions{stream, allocator},
       called_computation_, execution_context, execution_state_.get()};
-  return Call(handler, call_frame, options, stage);
+  return Call(handler, *call_frame, options, stage);
 }
 
 absl::Status CustomCallThunk::Prepare(const PrepareParams& params,
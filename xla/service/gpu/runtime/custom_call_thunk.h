@@ -38,6 +38,7 @@ limitations under the License.
 #include "xla/service/gpu/buffer_allocations.h"
 #include "xla/service/gpu/runtime/thunk.h"
 #include "xla/shape.h"
+#include "xla/stream_executor/device_memory.h"
 #include "xla/stream_executor/device_memory_allocator.h"
 #include "xla/stream_executor/stream.h"
 
@@ -112,7 +113,7 @@ class CustomCallThunk : public Thunk {
   CustomCallThunk(ThunkInfo thunk_info, XLA_FFI_Handler_Bundle bundle,
                   std::vector<std::optional<Slice>> operands,
                   std::vector<std::optional<Slice>> results,
-                  AttributesMap attributes,
+                  ffi::CallFrame call_frame,
                   std::unique_ptr<ffi::ExecutionState> execution_state,
                   const HloComputation* called_computation);
 
@@ -136,7 +137,11 @@ class CustomCallThunk : public Thunk {
   // functions with XLA runtime. It's under construction, and still misses
   // a lot of features. Long term it will replace legacy custom calls.
   std::optional<XLA_FFI_Handler_Bundle> bundle_;
-  AttributesMap attributes_;
+
+  // Call frame template built at thunk construction, with decoded attributes
+  // and placeholder buffers. Executions use copies of it that only patch the
+  // buffer pointers, reused across executions to avoid heap allocations.
+  std::unique_ptr<ffi::CallFramePool> call_frames_;
 
   // Execution state bound to the FFI handler. Optional.
   std::unique_ptr<ffi::ExecutionState> execution_state_;
@@ -67,9 +67,10 @@ absl::Status CublasLtMatmulThunk::ExecuteOnStream(const ExecuteParams& params) {
 
   TF_ASSIGN_OR_RETURN(
       auto algorithm,
-      GetMatmulAlgorithm(plan, workspace_buffer_.has_value()
-                                   ? workspace_buffer_.value().size()
-                                   : 0));
+      GetMatmulAlgorithm(params.stream, plan,
+                         workspace_buffer_.has_value()
+                             ? workspace_buffer_.value().size()
+                             : 0));
 
   VLOG(3) << "Running cublas_lt matmul thunk";
   const BufferAllocations& allocs = *params.buffer_allocations;
@@ -111,33 +112,34 @@ absl::Status CublasLtMatmulThunk::ExecuteOnStream(const ExecuteParams& params) {
       d_scale, d_amax, algorithm, workspace);
 }
 
-absl::StatusOr<se::gpu::BlasLt::MatmulPlan*> CublasLtMatmulThunk::GetMatmulPlan(
-    const stream_executor::Stream* stream) {
+absl::StatusOr<const se::gpu::BlasLt::MatmulPlan*>
+CublasLtMatmulThunk::GetMatmulPlan(const stream_executor::Stream* stream) {
   {
     absl::MutexLock lock(&matmul_plans_cache_mutex_);
     auto it = matmul_plans_cache_.find(stream);
-    if (it != matmul_plans_cache_.end()) return it->second.get();
+    if (it != matmul_plans_cache_.end()) return it->second;
   }
-  TF_ASSIGN_OR_RETURN(auto plan, se::gpu::BlasLt::GetMatmulPlan(
+  TF_ASSIGN_OR_RETURN(auto plan, se::gpu::BlasLt::GetOrCreateMatmulPlan(
                                      stream, gemm_config_, epilogue_));
 
   absl::MutexLock lock(&matmul_plans_cache_mutex_);
-  auto [it, _] = matmul_plans_cache_.emplace(stream, std::move(plan));
-  return it->second.get();
+  auto [it, _] = matmul_plans_cache_.emplace(stream, plan);
+  return it->second;
 }
 
 absl::StatusOr<se::gpu::BlasLt::MatmulAlgorithm>
-CublasLtMatmulThunk::GetMatmulAlgorithm(const se::gpu::BlasLt::MatmulPlan* plan,
-                                        int64_t max_workspace) {
+CublasLtMatmulThunk::GetMatmulAlgorithm(
+    const stream_executor::Stream* stream,
+    const se::gpu::BlasLt::MatmulPlan* plan, int64_t max_workspace) {
   {
     absl::MutexLock lock(&matmul_algorithm_cache_mutex_);
     auto it = matmul_algorithm_cache_.find(plan);
     if (it != matmul_algorithm_cache_.end()) return it->second;
   }
-  TF_ASSIGN_OR_RETURN(
-      auto algorithms,
-      plan->GetAlgorithms(/*max_algorithm_count*/ 128,
-                          /*max_workspace_size*/ max_workspace));
+  TF_ASSIGN_OR_RETURN(auto algorithms,
+                      se::gpu::BlasLt::GetCachedAlgorithms(
+                          stream, plan, /*max_algorithm_count=*/128,
+                          /*max_workspace_size=*/max_workspace));
   TF_RET_CHECK(algorithm_idx_ >= 0 && algorithm_idx_ < algorithms.size());
 
   absl::MutexLock lock(&matmul_algorithm_cache_mutex_);
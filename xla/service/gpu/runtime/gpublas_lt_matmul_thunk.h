@@ -71,14 +71,17 @@ class CublasLtMatmulThunk : public Thunk {
   }
 
  private:
-  absl::StatusOr<se::gpu::BlasLt::MatmulPlan*> GetMatmulPlan(
+  absl::StatusOr<const se::gpu::BlasLt::MatmulPlan*> GetMatmulPlan(
       const stream_executor::Stream* stream);
   absl::StatusOr<se::gpu::BlasLt::MatmulAlgorithm> GetMatmulAlgorithm(
+      const stream_executor::Stream* stream,
       const se::gpu::BlasLt::MatmulPlan* plan, int64_t max_workspace);
 
+  // Plans are owned by the cache of the executor's BlasLt and shared with
+  // other thunks using the same config; this only avoids the lookup.
   absl::Mutex matmul_plans_cache_mutex_;
   absl::flat_hash_map<const stream_executor::Stream*,
-                      se::gpu::BlasLt::MatmulPlanPtr>
+                      const se::gpu::BlasLt::MatmulPlan*>
       matmul_plans_cache_ ABSL_GUARDED_BY(matmul_plans_cache_mutex_);
 
   absl::Mutex matmul_algorithm_cache_mutex_;
@@ -15,25 +15,43 @@ limitations under the License.
 
 #include "xla/service/gpu/runtime/nccl_all_reduce_thunk.h"
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "mlir/IR/Block.h"
 #include "mlir/IR/Operation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/primitive_util.h"
 #include "xla/service/collective_ops_utils.h"
+#include "xla/service/global_device_id.h"
 #include "xla/service/gpu/backend_configs.pb.h"
+#include "xla/service/gpu/kernels/all_reduce_kernel.h"
+#include "xla/service/gpu/kernels/all_reduce_kernel_common.h"
 #include "xla/service/gpu/runtime/nccl_api.h"
+#include "xla/service/gpu/runtime/nccl_clique_key.h"
 #include "xla/service/gpu/runtime/nccl_collective_thunk.h"
 #include "xla/service/gpu/runtime/thunk.h"
+#include "xla/service/rendezvous.h"
 #include "xla/status_macros.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/device_memory_handle.h"
 #include "xla/stream_executor/stream.h"
+#include "xla/stream_executor/stream_executor.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
@@ -145,6 +163,200 @@ CollectiveOpGroupMode GetGroupModeInst(HloInstType* inst) {
 
 }  // namespace impl
 
+//===----------------------------------------------------------------------===//
+// OneShotAllReduceResources
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+// Peer-mapped buffers of a one-shot all-reduce participant.
+struct OneShotAllReduceParticipant {
+  int32_t rank;
+  se::StreamExecutor* executor;
+  void* scratch;
+  void* signals;
+};
+
+// Participants of a one-shot all-reduce ordered by rank.
+struct OneShotAllReducePeers {
+  bool peer_access = true;
+  std::vector<OneShotAllReduceParticipant> participants;
+};
+
+absl::StatusOr<se::DeviceMemoryHandle> AllocatePersistent(
+    se::StreamExecutor* executor, int64_t size) {
+  se::DeviceMemoryBase memory = executor->Allocate(size);
+  if (memory.is_null()) {
+    return absl::ResourceExhaustedError(absl::StrFormat(
+        "Failed to allocate %d bytes for one-shot all-reduce", size));
+  }
+  return se::DeviceMemoryHandle(executor, memory);
+}
+
+}  // namespace
+
+OneShotAllReduceResources::OneShotAllReduceResources(int64_t scratch_size)
+    : scratch_size_(scratch_size) {}
+
+OneShotAllReduceResources::DeviceResources*
+OneShotAllReduceResources::GetDeviceResources(se::StreamExecutor* executor) {
+  absl::MutexLock lock(&mu_);
+  auto it = resources_.find(executor);
+  return it == resources_.end() ? nullptr : it->second.get();
+}
+
+absl::Status OneShotAllReduceResources::Initialize(
+    const Thunk::InitializeParams& params, const NcclCollectiveConfig& config,
+    NcclStreamId stream_id, AsyncStreamKind stream_kind) {
+  se::StreamExecutor* executor = params.executor;
+  if (GetDeviceResources(executor) != nullptr) return absl::OkStatus();
+
+  TF_ASSIGN_OR_RETURN(
+      NcclCliqueKey clique_key,
+      GetNcclCliqueKey(*params.collective_params, config.replica_groups,
+                       config.group_mode, stream_id, stream_kind));
+  TF_ASSIGN_OR_RETURN(
+      size_t num_local_participants,
+      params.collective_cliques->num_communicators(clique_key));
+
+  GlobalDeviceId global_device_id = params.collective_params->global_device_id;
+  std::optional<int64_t> rank = clique_key.rank(global_device_id);
+  TF_RET_CHECK(rank.has_value()) << "Device is not a member of the clique";
+
+  auto resources = std::make_unique<DeviceResources>();
+  resources->rank = *rank;
+  resources->num_ranks = clique_key.devices().size();
+
+  // Peers exchange raw device pointers, so all of them must be in this
+  // process. All participants get the same answer from the clique key.
+  bool is_supported_clique =
+      static_cast<int64_t>(num_local_participants) == resources->num_ranks &&
+      resources->num_ranks > 1 &&
+      resources->num_ranks <= kOneShotAllReduceMaxPeers;
+
+  if (is_supported_clique) {
+    TF_ASSIGN_OR_RETURN(resources->scratch,
+                        AllocatePersistent(executor, scratch_size_));
+    TF_ASSIGN_OR_RETURN(
+        resources->signals,
+        AllocatePersistent(executor, kOneShotAllReduceSignalsSize));
+    TF_ASSIGN_OR_RETURN(
+        resources->epochs,
+        AllocatePersistent(executor, kOneShotAllReduceEpochsSize));
+
+    size_t pointers_size = resources->num_ranks * sizeof(void*);
+    TF_ASSIGN_OR_RETURN(resources->peer_buffers,
+                        AllocatePersistent(executor, pointers_size));
+    TF_ASSIGN_OR_RETURN(resources->peer_signals,
+                        AllocatePersistent(executor, pointers_size));
+
+    // Synchronization state must be initialized before any peer can signal.
+    TF_RETURN_IF_ERROR(params.stream->MemZero(resources->signals.memory_ptr(),
+                                              kOneShotAllReduceSignalsSize));
+    TF_RETURN_IF_ERROR(params.stream->MemZero(resources->epochs.memory_ptr(),
+                                              kOneShotAllReduceEpochsSize));
+    TF_RETURN_IF_ERROR(params.stream->BlockHostUntilDone());
+
+    OneShotAllReduceParticipant participant = {
+        resources->rank, executor, resources->scratch.memory().opaque(),
+        resources->signals.memory().opaque()};
+
+    // Collect participants and check that all of them can access each other's
+    // memory, so that all of them agree on using the one-shot kernel.
+    auto exchange =
+        [](absl::Span<const OneShotAllReduceParticipant* const> args) {
+          OneShotAllReducePeers peers;
+          for (const OneShotAllReduceParticipant* arg : args) {
+            peers.participants.push_back(*arg);
+          }
+          absl::c_sort(peers.participants, [](const auto& a, const auto& b) {
+            return a.rank < b.rank;
+          });
+          for (const auto& a : peers.participants) {
+            for (const auto& b : peers.participants) {
+              if (a.executor != b.executor &&
+                  !a.executor->CanEnablePeerAccessTo(b.executor)) {
+                peers.peer_access = false;
+              }
+            }
+          }
+          return peers;
+        };
+
+    auto rendezvous_key = std::make_tuple(params.collective_params->run_id,
+                                          clique_key, this);
+    auto rendezvous_name = absl::StrFormat(
+        "initialize one-shot all-reduce for rank %d; clique=%s; run_id=%d",
+        resources->rank, clique_key.ToString(),
+        params.collective_params->run_id.ToInt());
+
+    std::shared_ptr<OneShotAllReducePeers> peers =
+        RendezvousSingle<OneShotAllReducePeers>(
+            rendezvous_name, rendezvous_key, participant,
+            num_local_participants, exchange,
+            /*warn_stuck_timeout=*/absl::Seconds(20),
+            /*terminate_timeout=*/absl::Seconds(40));
+
+    if (peers->peer_access) {
+      std::vector<void*> peer_buffers, peer_signals;
+      for (const OneShotAllReduceParticipant& peer : peers->participants) {
+        if (peer.executor != executor) {
+          TF_RETURN_IF_ERROR(executor->EnablePeerAccessTo(peer.executor));
+        }
+        peer_buffers.push_back(peer.scratch);
+        peer_signals.push_back(peer.signals);
+      }
+      TF_RETURN_IF_ERROR(params.stream->Memcpy(
+          resources->peer_buffers.memory_ptr(), peer_buffers.data(),
+          pointers_size));
+      TF_RETURN_IF_ERROR(params.stream->Memcpy(
+          resources->peer_signals.memory_ptr(), peer_signals.data(),
+          pointers_size));
+      TF_RETURN_IF_ERROR(params.stream->BlockHostUntilDone());
+      resources->enabled = true;
+    }
+  }
+
+  VLOG(3) << "One-shot all-reduce for rank " << resources->rank << " of "
+          << resources->num_ranks << " in clique " << clique_key.ToString()
+          << (resources->enabled ? " enabled" : " disabled");
+
+  absl::MutexLock lock(&mu_);
+  resources_.try_emplace(executor, std::move(resources));
+  return absl::OkStatus();
+}
+
+bool OneShotAllReduceResources::IsSupported(
+    se::StreamExecutor* executor, absl::Span<const DeviceBufferPair> buffers) {
+  DeviceResources* resources = GetDeviceResources(executor);
+  if (resources == nullptr || !resources->enabled) return false;
+  return absl::c_all_of(buffers, [&](const DeviceBufferPair& buffer) {
+    return buffer.source_buffer.size() <= scratch_size_;
+  });
+}
+
+absl::Status OneShotAllReduceResources::Run(
+    ReductionKind reduction_kind, absl::Span<const DeviceBufferPair> buffers,
+    se::Stream& stream) {
+  DeviceResources* resources = GetDeviceResources(stream.parent());
+  TF_RET_CHECK(resources != nullptr && resources->enabled)
+      << "One-shot all-reduce resources are not initialized";
+
+  OneShotAllReduceBuffers kernel_buffers = {resources->peer_buffers.memory(),
+                                            resources->peer_signals.memory(),
+                                            resources->epochs.memory()};
+
+  for (const DeviceBufferPair& buffer : buffers) {
+    TF_RETURN_IF_ERROR(RunOneShotAllReduce(
+        &stream, buffer.element_type, reduction_kind, buffer.source_buffer,
+        buffer.destination_buffer, buffer.element_count, kernel_buffers,
+        resources->rank, resources->num_ranks));
+  }
+  return absl::OkStatus();
+}
+
+//===----------------------------------------------------------------------===//
+
 NcclAllReduceReduceScatterThunkBase::NcclAllReduceReduceScatterThunkBase(
     Thunk::Kind kind, ThunkInfo thunk_info, NcclApi* nccl_api,
     NcclAllReduceConfig config, std::vector<Buffer> buffers, bool is_sync)
@@ -157,11 +369,39 @@ NcclAllReduceReduceScatterThunkBase::NcclAllReduceReduceScatterThunkBase(
 NcclAllReduceStartThunk::NcclAllReduceStartThunk(
     ThunkInfo thunk_info, NcclApi* nccl_api,
     const HloAllReduceInstruction* inst, std::vector<Buffer> buffers,
-    bool p2p_memcpy_enabled)
+    bool p2p_memcpy_enabled, int64_t one_shot_max_bytes)
     : NcclAllReduceReduceScatterThunkBase(
           Thunk::kNcclAllReduceStart, thunk_info, nccl_api,
           impl::GetNcclAllReduceConfigInst(inst), std::move(buffers),
-          IsSyncCollective(inst)) {}
+          IsSyncCollective(inst)) {
+  if (one_shot_max_bytes <= 0) return;
+
+  // Use one-shot all-reduce only if all operands are small enough and of
+  // supported types. All participants make the same decision.
+  int64_t scratch_size = 0;
+  for (size_t i = 0; i < buffers_.size(); ++i) {
+    PrimitiveType element_type = config_.config.operand_element_type[i];
+    if (!IsOneShotAllReduceSupported(element_type, config_.reduction_kind)) {
+      return;
+    }
+    int64_t size = buffers_[i].element_count *
+                   primitive_util::ByteWidth(element_type);
+    if (size > one_shot_max_bytes) return;
+    scratch_size = std::max(scratch_size, size);
+  }
+  one_shot_resources_ =
+      std::make_shared<OneShotAllReduceResources>(scratch_size);
+}
+
+absl::Status NcclAllReduceStartThunk::Initialize(
+    const InitializeParams& params) {
+  TF_RETURN_IF_ERROR(NcclCollectiveThunk::Initialize(params));
+  if (one_shot_resources_) {
+    TF_RETURN_IF_ERROR(one_shot_resources_->Initialize(
+        params, config(), nccl_stream_id(), GetAsyncStreamKind()));
+  }
+  return absl::OkStatus();
+}
 
 absl::Status NcclAllReduceStartThunk::CheckImplementable(
     const HloAllReduceInstruction* inst, int64_t replica_count,
@@ -183,6 +423,11 @@ absl::Status NcclAllReduceStartThunk::RunNcclCollective(
       std::vector<DeviceBufferPair> device_buffers,
       ConvertToDeviceBuffers(params, buffers_,
                              config_.config.operand_element_type));
+  if (one_shot_resources_ &&
+      one_shot_resources_->IsSupported(stream.parent(), device_buffers)) {
+    return one_shot_resources_->Run(config_.reduction_kind, device_buffers,
+                                    stream);
+  }
   return ::xla::gpu::RunAllReduce(nccl_api(), config_.reduction_kind,
                                   device_buffers, stream,
                                   comm_wrapper.comm_handle);
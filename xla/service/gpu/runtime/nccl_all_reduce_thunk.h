@@ -17,15 +17,22 @@ limitations under the License.
 #define XLA_SERVICE_GPU_RUNTIME_NCCL_ALL_REDUCE_THUNK_H_
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xla/hlo/ir/hlo_instructions.h"
 #include "xla/service/collective_ops_utils.h"
 #include "xla/service/gpu/runtime/nccl_api.h"
 #include "xla/service/gpu/runtime/nccl_collective_thunk.h"
+#include "xla/service/gpu/runtime/thunk.h"
+#include "xla/stream_executor/device_memory_handle.h"
 #include "xla/stream_executor/stream.h"
+#include "xla/stream_executor/stream_executor.h"
 
 namespace xla {
 namespace gpu {
@@ -35,6 +42,60 @@ struct NcclAllReduceConfig {
   ReductionKind reduction_kind;
 };
 
+// Peer-mapped device buffers for running small all-reduce operations with the
+// one-shot all-reduce kernel instead of NCCL, which has a much lower latency
+// for small messages on devices connected with NVLink.
+//
+// The kernel requires all participants to be in the same process and to have
+// peer access to each other's memory, as peers exchange raw device pointers.
+// If the clique doesn't satisfy these requirements, all participants fall back
+// to NCCL, so the decision is always consistent across the clique.
+//
+// Resources are shared between all local devices executing the same all-reduce
+// operation, and between the thunk and the command buffer command for it.
+class OneShotAllReduceResources {
+ public:
+  // Scratch buffers fit all-reduce operands of up to `scratch_size` bytes.
+  explicit OneShotAllReduceResources(int64_t scratch_size);
+
+  // Allocates peer-mapped buffers on the executor of `params` and exchanges
+  // them with all participants of the clique. Does nothing if resources for
+  // the executor are already initialized.
+  absl::Status Initialize(const Thunk::InitializeParams& params,
+                          const NcclCollectiveConfig& config,
+                          NcclStreamId stream_id, AsyncStreamKind stream_kind);
+
+  // Returns true if the all-reduce of `buffers` can be executed with the
+  // one-shot kernel on `executor`.
+  bool IsSupported(se::StreamExecutor* executor,
+                   absl::Span<const DeviceBufferPair> buffers);
+
+  absl::Status Run(ReductionKind reduction_kind,
+                   absl::Span<const DeviceBufferPair> buffers,
+                   se::Stream& stream);
+
+ private:
+  struct DeviceResources {
+    bool enabled = false;
+    int32_t rank = 0;
+    int32_t num_ranks = 0;
+
+    se::DeviceMemoryHandle scratch;
+    se::DeviceMemoryHandle signals;
+    se::DeviceMemoryHandle epochs;
+    se::DeviceMemoryHandle peer_buffers;
+    se::DeviceMemoryHandle peer_signals;
+  };
+
+  DeviceResources* GetDeviceResources(se::StreamExecutor* executor);
+
+  const int64_t scratch_size_;
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<se::StreamExecutor*, std::unique_ptr<DeviceResources>>
+      resources_ ABSL_GUARDED_BY(mu_);
+};
+
 // Thunk that performs a NCCL-based All-Reduce or Reduce-Scatter among CUDA
 // GPU-based replicas.
 class NcclAllReduceReduceScatterThunkBase : public NcclCollectiveThunk {
@@ -64,7 +125,8 @@ class NcclAllReduceStartThunk : public NcclAllReduceReduceScatterThunkBase {
   NcclAllReduceStartThunk(ThunkInfo thunk_info, NcclApi* nccl_api,
                           const HloAllReduceInstruction* inst,
                           std::vector<Buffer> buffers,
-                          bool p2p_memcpy_enabled = false);
+                          bool p2p_memcpy_enabled = false,
+                          int64_t one_shot_max_bytes = 0);
 
   static const char* GetHloOpName() { return "all-reduce-start"; }
 
@@ -75,10 +137,21 @@ class NcclAllReduceStartThunk : public NcclAllReduceReduceScatterThunkBase {
   static CollectiveOpGroupMode GetGroupMode(
       const HloAllReduceInstruction* inst);
 
+  absl::Status Initialize(const InitializeParams& params) override;
+
+  // Returns resources for executing the all-reduce with the one-shot kernel,
+  // or nullptr if it's disabled.
+  std::shared_ptr<OneShotAllReduceResources> one_shot_resources() const {
+    return one_shot_resources_;
+  }
+
  protected:
   absl::Status RunNcclCollective(const ExecuteParams& params,
                                  se::Stream& stream,
                                  NcclCommHandleWrapper comm_wrapper) override;
+
+ private:
+  std::shared_ptr<OneShotAllReduceResources> one_shot_resources_;
 };
 
 // -----------------------------------------------------------------------------
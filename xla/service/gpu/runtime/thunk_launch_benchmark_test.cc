@@ -0,0 +1,415 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks for the host-side overhead of launching GPU thunks.
+//
+// All kernels launched by these benchmarks are empty, and we never wait for the
+// device inside the measured region, so the reported time is the host CPU time
+// spent in `Thunk::ExecuteOnStream` (argument packing, kernel launch, command
+// buffer update and launch). Command buffers on vs. off is measured by running
+// the same kernels as a `SequentialThunk` of `KernelThunk`s and as a
+// `CommandBufferThunk` of `LaunchCmd`s.
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xla/hlo/ir/hlo_casting_utils.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/parser/hlo_parser.h"
+#include "xla/service/buffer_assignment.h"
+#include "xla/service/gpu/buffer_allocations.h"
+#include "xla/service/gpu/gpu_constants.h"
+#include "xla/service/gpu/kernel_arguments.h"
+#include "xla/service/gpu/launch_dimensions.h"
+#include "xla/service/gpu/matmul_utils.h"
+#include "xla/service/gpu/runtime/command_buffer_cmd.h"
+#include "xla/service/gpu/runtime/command_buffer_thunk.h"
+#include "xla/service/gpu/runtime/gemm_thunk.h"
+#include "xla/service/gpu/runtime/kernel_thunk.h"
+#include "xla/service/gpu/runtime/sequential_thunk.h"
+#include "xla/service/gpu/runtime/thunk.h"
+#include "xla/service/hlo_ordering.h"
+#include "xla/service/platform_util.h"
+#include "xla/service/service_executable_run_options.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/blas.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/device_memory_allocator.h"
+#include "xla/stream_executor/platform.h"
+#include "xla/stream_executor/platform_manager.h"
+#include "xla/stream_executor/stream.h"
+#include "xla/stream_executor/stream_executor.h"
+#include "xla/stream_executor/stream_executor_memory_allocator.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+
+namespace xla::gpu {
+namespace {
+
+using MemoryAccess = CommandBufferCmd::MemoryAccess;
+
+// Wait for the device to catch up with the launched work every so many
+// iterations, to keep the stream launch queue from filling up.
+constexpr int64_t kSyncInterval = 256;
+
+se::StreamExecutor* GpuExecutor() {
+  auto name =
+      absl::AsciiStrToUpper(PlatformUtil::CanonicalPlatformName("gpu").value());
+  auto* platform = se::PlatformManager::PlatformWithName(name).value();
+  return platform->ExecutorForDevice(0).value();
+}
+
+// Returns PTX of an empty kernel named `noop` with `num_args` pointer
+// arguments.
+std::string NoopKernelPtx(int64_t num_args) {
+  std::vector<std::string> params;
+  for (int64_t i = 0; i < num_args; ++i) {
+    params.push_back(absl::StrCat("  .param .u64 arg", i));
+  }
+  return absl::StrCat(
+      ".version 6.0\n.target sm_50\n.address_size 64\n\n",
+      ".visible .entry noop(\n", absl::StrJoin(params, ",\n"), "\n)\n",
+      "{\n  ret;\n}\n");
+}
+
+// A loop fusion of `num_params` parameters together with the buffer assignment
+// and kernel arguments computed for it the same way as in the IR emitter.
+struct KernelFusion {
+  std::unique_ptr<HloModule> module;
+  std::unique_ptr<BufferAssignment> buffer_assignment;
+  const HloFusionInstruction* fusion = nullptr;
+  std::vector<KernelArgument> args;
+  std::vector<BufferAllocation::Slice> slices;
+  std::vector<MemoryAccess> accesses;
+};
+
+absl::StatusOr<KernelFusion> CreateKernelFusion(int64_t num_params) {
+  std::vector<std::string> params, operands;
+  for (int64_t i = 0; i < num_params; ++i) {
+    params.push_back(absl::StrCat("  p", i, " = f32[4] parameter(", i, ")"));
+    operands.push_back(absl::StrCat("p", i));
+  }
+
+  // Sum all parameters in the fused computation.
+  std::vector<std::string> fused_ops;
+  std::string sum = "p0";
+  for (int64_t i = 1; i < num_params; ++i) {
+    std::string next = absl::StrCat("add", i);
+    fused_ops.push_back(
+        absl::StrCat("  ", next, " = f32[4] add(", sum, ", p", i, ")"));
+    sum = std::move(next);
+  }
+  fused_ops.push_back(absl::StrCat("  ROOT neg = f32[4] negate(", sum, ")"));
+
+  std::string hlo = absl::StrCat(
+      "HloModule m\n\nfused {\n", absl::StrJoin(params, "\n"), "\n",
+      absl::StrJoin(fused_ops, "\n"), "\n}\n\nENTRY e {\n",
+      absl::StrJoin(params, "\n"), "\n  ROOT fusion = f32[4] fusion(",
+      absl::StrJoin(operands, ", "), "), kind=kLoop, calls=fused\n}\n");
+
+  KernelFusion kernel_fusion;
+  TF_ASSIGN_OR_RETURN(kernel_fusion.module,
+                      ParseAndReturnUnverifiedModule(hlo));
+
+  HloModule* module = kernel_fusion.module.get();
+  TF_ASSIGN_OR_RETURN(
+      kernel_fusion.buffer_assignment,
+      BufferAssigner::Run(
+          module, std::make_unique<DependencyHloOrdering>(module),
+          [](const BufferValue& buffer) {
+            return ShapeUtil::ByteSizeOf(buffer.shape(), sizeof(void*));
+          },
+          [](LogicalBuffer::Color) { return kXlaAllocatedBufferAlignBytes; }));
+
+  kernel_fusion.fusion = Cast<HloFusionInstruction>(
+      module->entry_computation()->root_instruction());
+
+  TF_ASSIGN_OR_RETURN(KernelArguments kernel_arguments,
+                      KernelArguments::Create(*kernel_fusion.buffer_assignment,
+                                              kernel_fusion.fusion));
+  kernel_fusion.args = kernel_arguments.args();
+
+  for (const KernelArgument& arg : kernel_fusion.args) {
+    kernel_fusion.slices.push_back(arg.slice());
+    kernel_fusion.accesses.push_back(arg.written() ? MemoryAccess::kWrite
+                                                   : MemoryAccess::kRead);
+  }
+
+  return kernel_fusion;
+}
+
+// Device memory used by a benchmark. All of it is freed when the benchmark is
+// done.
+class DeviceBuffers {
+ public:
+  explicit DeviceBuffers(se::StreamExecutor* executor)
+      : executor_(executor), allocator_(executor) {}
+
+  se::DeviceMemoryBase Allocate(int64_t size) {
+    return *owned_.emplace_back(
+        allocator_.Allocate(executor_->device_ordinal(), size).value());
+  }
+
+  se::DeviceMemoryAllocator* allocator() { return &allocator_; }
+
+ private:
+  se::StreamExecutor* executor_;
+  se::StreamExecutorMemoryAllocator allocator_;
+  std::vector<se::OwningDeviceMemory> owned_;
+};
+
+// Allocates device memory for all buffer allocations of `kernel_fusion`.
+std::vector<se::DeviceMemoryBase> AllocateBuffers(
+    DeviceBuffers& device_buffers, const KernelFusion& kernel_fusion) {
+  std::vector<se::DeviceMemoryBase> buffers;
+  for (const BufferAllocation& allocation :
+       kernel_fusion.buffer_assignment->Allocations()) {
+    buffers.push_back(device_buffers.Allocate(allocation.size()));
+  }
+  return buffers;
+}
+
+std::unique_ptr<KernelThunk> CreateKernelThunk(
+    const KernelFusion& kernel_fusion) {
+  return std::make_unique<KernelThunk>(
+      kernel_fusion.fusion, "noop", kernel_fusion.args, LaunchDimensions(1, 1),
+      /*cluster_dim=*/std::nullopt, /*shmem_bytes=*/0);
+}
+
+// Executes `thunk` in the benchmark loop, cycling through `params`.
+void RunThunk(benchmark::State& state, Thunk& thunk,
+              absl::Span<const Thunk::ExecuteParams> params,
+              se::Stream* stream) {
+  int64_t iteration = 0;
+  for (auto s : state) {
+    TF_CHECK_OK(thunk.ExecuteOnStream(params[iteration % params.size()]));
+
+    if (++iteration % kSyncInterval == 0) {
+      state.PauseTiming();
+      TF_CHECK_OK(stream->BlockHostUntilDone());
+      state.ResumeTiming();
+    }
+  }
+  TF_CHECK_OK(stream->BlockHostUntilDone());
+}
+
+}  // namespace
+
+// Launches a single kernel with `num_params` parameters and one result.
+static void BM_KernelThunk(benchmark::State& state) {
+  int64_t num_params = state.range(0);
+
+  se::StreamExecutor* executor = GpuExecutor();
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, executor->CreateStream());
+
+  TF_ASSERT_OK_AND_ASSIGN(KernelFusion kernel_fusion,
+                          CreateKernelFusion(num_params));
+  std::unique_ptr<KernelThunk> thunk = CreateKernelThunk(kernel_fusion);
+
+  DeviceBuffers device_buffers(executor);
+  BufferAllocations allocations(AllocateBuffers(device_buffers, kernel_fusion),
+                                0, device_buffers.allocator());
+
+  std::string ptx = NoopKernelPtx(kernel_fusion.args.size());
+  TF_ASSERT_OK(thunk->Initialize(
+      {executor, {ptx, /*binary=*/{}}, &allocations, stream.get()}));
+
+  ServiceExecutableRunOptions run_options;
+  Thunk::ExecuteParams params = Thunk::ExecuteParams::Create(
+      run_options, allocations, stream.get(), stream.get(), nullptr, nullptr);
+
+  RunThunk(state, *thunk, {params}, stream.get());
+}
+
+// Launches a small f32[2,4] x f32[4,3] GEMM.
+static void BM_GemmThunk(benchmark::State& state) {
+  se::StreamExecutor* executor = GpuExecutor();
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, executor->CreateStream());
+
+  int64_t lhs_length = sizeof(float) * 2 * 4;
+  int64_t rhs_length = sizeof(float) * 4 * 3;
+  int64_t out_length = sizeof(float) * 2 * 3;
+  int64_t workspace_length = 1024 * 1024;
+
+  BufferAllocation alloc_lhs(/*index=*/0, lhs_length, /*color=*/0);
+  BufferAllocation alloc_rhs(/*index=*/1, rhs_length, /*color=*/0);
+  BufferAllocation alloc_out(/*index=*/2, out_length, /*color=*/0);
+  BufferAllocation alloc_workspace(/*index=*/3, workspace_length, /*color=*/0);
+
+  BufferAllocation::Slice slice_lhs(&alloc_lhs, 0, lhs_length);
+  BufferAllocation::Slice slice_rhs(&alloc_rhs, 0, rhs_length);
+  BufferAllocation::Slice slice_out(&alloc_out, 0, out_length);
+  BufferAllocation::Slice slice_workspace(&alloc_workspace, 0,
+                                          workspace_length);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      GemmConfig config,
+      GemmConfig::For(ShapeUtil::MakeShape(PrimitiveType::F32, {2, 4}), {},
+                      {1}, ShapeUtil::MakeShape(PrimitiveType::F32, {4, 3}),
+                      {}, {0}, ShapeUtil::MakeShape(PrimitiveType::F32, {2, 3}),
+                      1.0, 0.0, 0.0, PrecisionConfig::ALG_UNSET, std::nullopt,
+                      se::blas::kDefaultComputePrecision, false, false));
+
+  GemmThunk thunk(Thunk::ThunkInfo(), config, slice_lhs, slice_rhs, slice_out,
+                  slice_workspace, /*deterministic=*/true);
+
+  DeviceBuffers device_buffers(executor);
+  BufferAllocations allocations(
+      {device_buffers.Allocate(lhs_length), device_buffers.Allocate(rhs_length),
+       device_buffers.Allocate(out_length),
+       device_buffers.Allocate(workspace_length)},
+      0, device_buffers.allocator());
+
+  TF_ASSERT_OK(thunk.Initialize(
+      {executor, {/*text=*/"", /*binary=*/{}}, &allocations, stream.get()}));
+
+  ServiceExecutableRunOptions run_options;
+  Thunk::ExecuteParams params = Thunk::ExecuteParams::Create(
+      run_options, allocations, stream.get(), stream.get(), nullptr, nullptr);
+
+  RunThunk(state, thunk, {params}, stream.get());
+}
+
+// Launches `num_kernels` kernels with `num_params` parameters each as a
+// sequence of kernel thunks (command buffers disabled).
+static void BM_SequentialThunk(benchmark::State& state) {
+  int64_t num_kernels = state.range(0);
+  int64_t num_params = state.range(1);
+
+  se::StreamExecutor* executor = GpuExecutor();
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, executor->CreateStream());
+
+  TF_ASSERT_OK_AND_ASSIGN(KernelFusion kernel_fusion,
+                          CreateKernelFusion(num_params));
+
+  ThunkSequence thunks;
+  for (int64_t i = 0; i < num_kernels; ++i) {
+    thunks.push_back(CreateKernelThunk(kernel_fusion));
+  }
+  SequentialThunk thunk(Thunk::ThunkInfo(), std::move(thunks));
+
+  DeviceBuffers device_buffers(executor);
+  BufferAllocations allocations(AllocateBuffers(device_buffers, kernel_fusion),
+                                0, device_buffers.allocator());
+
+  std::string ptx = NoopKernelPtx(kernel_fusion.args.size());
+  TF_ASSERT_OK(thunk.Initialize(
+      {executor, {ptx, /*binary=*/{}}, &allocations, stream.get()}));
+
+  ServiceExecutableRunOptions run_options;
+  Thunk::ExecuteParams params = Thunk::ExecuteParams::Create(
+      run_options, allocations, stream.get(), stream.get(), nullptr, nullptr);
+
+  RunThunk(state, thunk, {params}, stream.get());
+}
+
+// Launches `num_kernels` kernels with `num_params` parameters each as a single
+// command buffer (command buffers enabled). If `update` is true the result
+// buffer changes on every execution, and the command buffer must be updated
+// before it is launched.
+static void BM_CommandBufferThunk(benchmark::State& state) {
+  int64_t num_kernels = state.range(0);
+  int64_t num_params = state.range(1);
+  bool update = state.range(2);
+
+  se::StreamExecutor* executor = GpuExecutor();
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, executor->CreateStream());
+
+  TF_ASSERT_OK_AND_ASSIGN(KernelFusion kernel_fusion,
+                          CreateKernelFusion(num_params));
+
+  CommandBufferCmdSequence commands;
+  for (int64_t i = 0; i < num_kernels; ++i) {
+    commands.Emplace<LaunchCmd>(ExecutionStreamId(0), "noop",
+                                kernel_fusion.slices, kernel_fusion.accesses,
+                                LaunchDimensions(1, 1), /*shmem_bytes=*/0);
+  }
+  CommandBufferThunk thunk(std::move(commands), Thunk::ThunkInfo());
+
+  DeviceBuffers device_buffers(executor);
+  std::vector<se::DeviceMemoryBase> buffers =
+      AllocateBuffers(device_buffers, kernel_fusion);
+
+  // Same buffers as above, but with a different buffer for the result.
+  std::vector<se::DeviceMemoryBase> updated_buffers = buffers;
+  BufferAllocation::Index result = kernel_fusion.slices.back().index();
+  updated_buffers[result] = device_buffers.Allocate(buffers[result].size());
+
+  BufferAllocations allocations(buffers, 0, device_buffers.allocator());
+  BufferAllocations updated_allocations(updated_buffers, 0,
+                                        device_buffers.allocator());
+
+  std::string ptx = NoopKernelPtx(kernel_fusion.args.size());
+  TF_ASSERT_OK(thunk.Initialize(
+      {executor, {ptx, /*binary=*/{}}, &allocations, stream.get()}));
+
+  ServiceExecutableRunOptions run_options;
+  std::vector<Thunk::ExecuteParams> params = {Thunk::ExecuteParams::Create(
+      run_options, allocations, stream.get(), stream.get(), nullptr, nullptr)};
+  if (update) {
+    params.push_back(Thunk::ExecuteParams::Create(run_options,
+                                                  updated_allocations,
+                                                  stream.get(), stream.get(),
+                                                  nullptr, nullptr));
+  }
+
+  RunThunk(state, thunk, params, stream.get());
+}
+
+BENCHMARK(BM_KernelThunk)
+    ->MeasureProcessCPUTime()
+    ->ArgNames({"params"})
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->Arg(256);
+
+BENCHMARK(BM_GemmThunk)->MeasureProcessCPUTime();
+
+BENCHMARK(BM_SequentialThunk)
+    ->MeasureProcessCPUTime()
+    ->ArgNames({"kernels", "params"})
+    ->Args({1, 4})
+    ->Args({16, 4})
+    ->Args({128, 4})
+    ->Args({16, 64});
+
+BENCHMARK(BM_CommandBufferThunk)
+    ->MeasureProcessCPUTime()
+    ->ArgNames({"kernels", "params", "update"})
+    ->Args({1, 4, false})
+    ->Args({16, 4, false})
+    ->Args({128, 4, false})
+    ->Args({16, 64, false})
+    ->Args({1, 4, true})
+    ->Args({16, 4, true})
+    ->Args({128, 4, true})
+    ->Args({16, 64, true});
+
+}  // namespace xla::gpu
@@ -121,7 +121,7 @@ INSTANTIATE_TEST_SUITE_P(
     CubSort, CubSortKeysTest,
     ::testing::Combine(::testing::Values(F16, F32, F64, S8, S16, S32, S64, U8,
                                          U16, U32, U64),
-                       ::testing::Bool(), ::testing::Values(1, 10)),
+                       ::testing::Bool(), ::testing::Values(1, 10, 1000)),
     [](const ::testing::TestParamInfo<CubSortKeysTest::ParamType>& info) {
       return absl::StrCat(
           primitive_util::LowercasePrimitiveTypeName(std::get<0>(info.param)),
@@ -244,6 +244,20 @@ INSTANTIATE_TEST_SUITE_P(
           std::get<3>(info.param));
     });
 
+// Scores sorted together with their indices, e.g. for top-p sampling.
+INSTANTIATE_TEST_SUITE_P(
+    CubSortScores, CubSortPairsTest,
+    ::testing::Combine(::testing::Values(F16, F32, S32),
+                       ::testing::Values(S32, U32, F32), ::testing::Bool(),
+                       ::testing::Values(1, 10, 1000)),
+    [](const ::testing::TestParamInfo<CubSortPairsTest::ParamType>& info) {
+      return absl::StrCat(
+          primitive_util::LowercasePrimitiveTypeName(std::get<0>(info.param)),
+          primitive_util::LowercasePrimitiveTypeName(std::get<1>(info.param)),
+          std::get<2>(info.param) ? "_asc_" : "_desc_", "b",
+          std::get<3>(info.param));
+    });
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
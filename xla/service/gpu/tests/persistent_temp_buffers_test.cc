@@ -0,0 +1,78 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <memory>
+#include <utility>
+
+#include <gtest/gtest.h>
+#include "xla/array2d.h"
+#include "xla/error_spec.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/service/executable.h"
+#include "xla/tests/hlo_test_base.h"
+#include "xla/tests/literal_test_util.h"
+#include "xla/xla.pb.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::gpu {
+namespace {
+
+class PersistentTempBuffersTest : public HloTestBase {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_enable_persistent_temp_buffers(true);
+    return debug_options;
+  }
+};
+
+TEST_F(PersistentTempBuffersTest, ReusesTempBuffersAcrossExecutions) {
+  // The result of the dot is not live out, so it's assigned to the temp
+  // buffer.
+  const char* hlo_text = R"(
+  HloModule m
+
+  ENTRY main {
+    p0 = f32[16,16] parameter(0)
+    p1 = f32[16,16] parameter(1)
+    dot = f32[16,16] dot(p0, p1), lhs_contracting_dims={1},
+                                  rhs_contracting_dims={0}
+    ROOT exp = f32[16,16] exponential(dot)
+  })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> executable,
+      test_runner_.CreateExecutable(std::move(module),
+                                    /*run_hlo_passes=*/true));
+
+  Literal identity = LiteralUtil::MakeIdentityR2<float>(16);
+  for (float value : {0.0f, 0.5f, 1.0f}) {
+    Literal lhs =
+        LiteralUtil::CreateR2FromArray2D(Array2D<float>(16, 16, value));
+    TF_ASSERT_OK_AND_ASSIGN(
+        Literal result, test_runner_.ExecuteWithExecutable(
+                            executable.get(), {&lhs, &identity},
+                            /*profile=*/nullptr));
+    Literal expected = LiteralUtil::CreateR2FromArray2D(
+        Array2D<float>(16, 16, std::exp(value)));
+    EXPECT_TRUE(LiteralTestUtil::Near(expected, result, ErrorSpec{1e-5}));
+  }
+}
+
+}  // namespace
+}  // namespace xla::gpu
@@ -45,6 +45,7 @@ limitations under the License.
 #include "xla/service/gpu/hlo_fusion_analysis.h"
 #include "xla/service/gpu/hlo_traversal.h"
 #include "xla/service/gpu/ir_emission_utils.h"
+#include "xla/service/gpu/metrics.h"
 #include "xla/service/gpu/variant_visitor.h"
 #include "xla/shape.h"
 #include "xla/shape_util.h"
@@ -297,6 +298,32 @@ static bool IsCommand(const HloComputation* computation,
       });
 }
 
+// Returns the number of commands that a command instruction contributes to a
+// command buffer. While loops and conditionals are recorded as device-side
+// conditional nodes together with all of their nested computations, so they
+// account for all the commands in their bodies. This way a single loop with a
+// large body is not rejected by the minimum command buffer size check.
+static int64_t NumCommands(const HloInstruction* hlo,
+                           const CommandBufferConfig& config) {
+  if (hlo->opcode() != HloOpcode::kWhile &&
+      hlo->opcode() != HloOpcode::kConditional) {
+    return 1;
+  }
+
+  int64_t num_commands = 1;
+  for (const HloComputation* computation : hlo->called_computations()) {
+    for (const HloInstruction* inst : computation->instructions()) {
+      if (IsCommand(inst, config)) {
+        num_commands += NumCommands(inst, config);
+      } else if (IsAsyncStartCommand(inst, config) ||
+                 IsAsyncDoneCommand(inst, config)) {
+        num_commands++;
+      }
+    }
+  }
+  return num_commands;
+}
+
 //===----------------------------------------------------------------------===//
 
 static void RemoveTrailingNoOps(HloInstructionSequence& seq) {
@@ -408,7 +435,7 @@ CommandBufferScheduling::CollectCommandBufferSequences(
 
     // Synchronous commands always can be added to instruction sequence.
     if (IsCommand(inst, config)) {
-      num_commands_in_current_seq++;
+      num_commands_in_current_seq += NumCommands(inst, config);
       current_seq.push_back(inst);
       continue;
     }
@@ -791,6 +818,25 @@ absl::StatusOr<bool> CommandBufferScheduling::Run(
   std::reverse(order.begin(), order.end());
   absl::flat_hash_set<HloComputation*> processed_command_buffers;
 
+  // Number of load-bearing instructions in the module and how many of them were
+  // captured into command buffers. Every instruction is counted once, when its
+  // computation is processed. Computations nested in captured while loops and
+  // conditionals are not processed, so their instructions are accounted by
+  // NumCommands() of the captured instruction instead.
+  int64_t num_captured = 0;
+  int64_t num_total = 0;
+  auto num_load_bearing = [&](absl::Span<HloInstruction* const> insts,
+                              bool include_nested) {
+    int64_t num = 0;
+    for (const HloInstruction* inst : insts) {
+      if (IsNoOp(inst) || IsConstant(inst) || IsParameter(inst)) continue;
+      num += include_nested && IsCommand(inst, config)
+                 ? NumCommands(inst, config)
+                 : 1;
+    }
+    return num;
+  };
+
   auto changed = false;
   for (HloComputation* comp : order) {
     // Skip special computations that do not have lowering to thunks.
@@ -809,7 +855,18 @@ absl::StatusOr<bool> CommandBufferScheduling::Run(
             module->schedule().sequence(comp), config,
             debug_options.xla_gpu_graph_min_graph_size());
 
+    num_total += num_load_bearing(
+        module->schedule().sequence(comp).instructions(),
+        /*include_nested=*/false);
+
     for (const HloInstructionSequence& seq : sequences) {
+      int64_t num_seq_captured =
+          num_load_bearing(seq.instructions(), /*include_nested=*/true);
+      num_captured += num_seq_captured;
+      num_total += num_seq_captured -
+                   num_load_bearing(seq.instructions(),
+                                    /*include_nested=*/false);
+
       TF_ASSIGN_OR_RETURN(CommandBuffer command_buffer,
                           PrepareCommandBuffer(seq, comp->parent()));
       TF_ASSIGN_OR_RETURN(
@@ -827,6 +884,11 @@ absl::StatusOr<bool> CommandBufferScheduling::Run(
   }
   TF_RETURN_IF_ERROR(module->schedule().Update());
 
+  VLOG(1) << "Captured " << num_captured << " out of " << num_total
+          << " load-bearing instructions into command buffers in module "
+          << module->name();
+  RecordCommandBufferCapturedInstructions(num_captured, num_total);
+
   return changed;
 }
 
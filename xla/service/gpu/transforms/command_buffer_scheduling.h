@@ -69,6 +69,18 @@ namespace xla::gpu {
 // We currently do not have a command_buffer HLO operation, so we'll start with
 // a kCall op code with an attached HLO computation. We'll consider graduating
 // custom call to a first class operation later.
+//
+// While loops and conditionals are captured with all of their nested
+// computations (recursively) and executed as device-side conditional nodes, if
+// CONDITIONALS commands are enabled and supported by the gpu runtime, and all
+// nested computations consist only of commands. A captured while loop or
+// conditional counts all commands of its nested computations towards the
+// minimum command buffer size. Otherwise we fall back to capturing nested
+// computations as separate command buffers and the control flow operation
+// itself is executed on the host.
+//
+// The pass records how many load-bearing instructions of the module were
+// captured into command buffers (see metrics.h).
 class CommandBufferScheduling : public HloModulePass {
  public:
   struct CommandBufferConfig {
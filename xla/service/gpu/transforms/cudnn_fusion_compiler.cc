@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/service/gpu/transforms/cudnn_fusion_compiler.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -24,13 +25,19 @@ limitations under the License.
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "third_party/gpus/cudnn/cudnn_version.h"
 #include "xla/comparison_util.h"
 #include "xla/hlo/ir/dfs_hlo_visitor_with_default.h"
@@ -44,6 +51,7 @@ limitations under the License.
 #include "xla/hlo/utils/hlo_query.h"
 #include "xla/primitive_util.h"
 #include "xla/service/dump.h"
+#include "xla/service/gpu/autotuning/autotuner_util.h"
 #include "xla/service/gpu/backend_configs.pb.h"
 #include "xla/service/gpu/cudnn_support_utils.h"
 #include "xla/service/gpu/ir_emission_utils.h"
@@ -51,13 +59,16 @@ limitations under the License.
 #include "xla/service/gpu/matmul_utils.h"
 #include "xla/service/gpu/stream_executor_util.h"
 #include "xla/service/gpu/triton_fusion_analysis.h"
+#include "xla/service/persistent_cache_file.h"
 #include "xla/shape_util.h"
 #include "xla/stream_executor/cuda/cuda_dnn.h"
 #include "xla/stream_executor/cuda/cudnn_frontend_helpers.h"
 #include "xla/stream_executor/dnn.h"
 #include "xla/stream_executor/stream_executor.h"
 #include "xla/util.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
 #include "tsl/platform/statusor.h"
 
 namespace xla {
@@ -643,6 +654,159 @@ absl::StatusOr<se::gpu::CudnnGraph> PrepareGraph(
   return *graph;
 }
 
+// A cuDNN graph compiled for a fusion.
+struct CompiledGraph {
+  int64_t plan_id;
+  int64_t workspace_size;
+  std::string serialized_graph;
+};
+
+// Prepares the graph of `hlo` and builds the execution plan `plan_id`, or the
+// first plan that can be built if `plan_id` is negative.
+absl::StatusOr<CompiledGraph> CompileGraph(se::dnn::DnnSupport& dnn_support,
+                                           const HloFusionInstruction& hlo,
+                                           int64_t plan_id) {
+  TF_ASSIGN_OR_RETURN(se::gpu::CudnnGraph graph,
+                      PrepareGraph(dnn_support, hlo));
+
+  if (plan_id >= 0) {
+    // Build single plan with given ID.
+    if (plan_id >= graph.Graph().get_execution_plan_count()) {
+      return absl::InternalError("cuDNN graph plan does not exist.");
+    }
+    TF_RETURN_IF_ERROR(graph.Build(dnn_support, plan_id));
+  } else {
+    // Build plans one by one till first successful when no plan_id was
+    // provided.
+    for (plan_id = 0; plan_id < graph.Graph().get_execution_plan_count();
+         ++plan_id) {
+      VLOG(7) << "Trying plan ID " << plan_id;
+      if (graph.Build(dnn_support, plan_id).ok()) {
+        VLOG(7) << "Successfully built plan ID " << plan_id;
+        break;
+      }
+    }
+    if (plan_id == graph.Graph().get_execution_plan_count()) {
+      return absl::InternalError("No cuDNN plans can be built.");
+    }
+  }
+
+  std::vector<uint8_t> serialized_graph;
+  RETURN_IF_CUDNN_FRONTEND_ERROR(graph.Graph().serialize(serialized_graph));
+  return CompiledGraph{
+      plan_id, graph.Graph().get_workspace_size(),
+      std::string(reinterpret_cast<char*>(serialized_graph.data()),
+                  serialized_graph.size())};
+}
+
+// Graphs compiled by any executable in this process, keyed by the hash of
+// their cache key.
+ABSL_CONST_INIT absl::Mutex compiled_graphs_mu(absl::kConstInit);
+absl::flat_hash_map<std::string, CompiledGraph>& CompiledGraphs()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(compiled_graphs_mu) {
+  static auto* compiled_graphs =
+      new absl::flat_hash_map<std::string, CompiledGraph>();
+  return *compiled_graphs;
+}
+
+// Returns the path of the persistent cache entry with hash `key_hash`. Entries
+// are sharded by the first characters of the hash, like the cubin cache.
+std::string GetCompiledGraphFilePath(absl::string_view cache_dir,
+                                     absl::string_view key_hash) {
+  return tsl::io::JoinPath(cache_dir, key_hash.substr(0, 2),
+                           absl::StrCat(key_hash, ".cudnn_graph"));
+}
+
+// Reads the compiled graph at `file_path`, stored as "<plan id> <workspace
+// size>\n" followed by the serialized graph. Returns nullopt if there is no
+// such entry or it can't be parsed.
+std::optional<CompiledGraph> ReadCompiledGraphFromCache(
+    const std::string& file_path) {
+  absl::StatusOr<std::optional<std::string>> entry =
+      ReadPersistentCacheFile(tsl::Env::Default(), file_path);
+  if (!entry.ok()) {
+    LOG(WARNING) << "Failed to read cuDNN graph cache entry " << file_path
+                 << ": " << entry.status();
+    return std::nullopt;
+  }
+  if (!entry->has_value()) {
+    return std::nullopt;
+  }
+  const std::string& contents = **entry;
+  size_t header_end = contents.find('\n');
+  std::vector<absl::string_view> header = absl::StrSplit(
+      absl::string_view(contents).substr(0, header_end), ' ');
+  CompiledGraph graph;
+  if (header_end == std::string::npos || header.size() != 2 ||
+      !absl::SimpleAtoi(header[0], &graph.plan_id) ||
+      !absl::SimpleAtoi(header[1], &graph.workspace_size)) {
+    LOG(WARNING) << "Ignoring malformed cuDNN graph cache entry " << file_path;
+    return std::nullopt;
+  }
+  graph.serialized_graph = contents.substr(header_end + 1);
+  return graph;
+}
+
+// Writes `graph` to `file_path` in the persistent cache. Concurrent writers of
+// the same entry write equivalent graphs, so the last rename wins.
+absl::Status WriteCompiledGraphToCache(const std::string& file_path,
+                                       const CompiledGraph& graph) {
+  return WritePersistentCacheFile(
+      tsl::Env::Default(), file_path,
+      absl::StrCat(graph.plan_id, " ", graph.workspace_size, "\n",
+                   graph.serialized_graph));
+}
+
+// Like CompileGraph, but reuses graphs compiled earlier in this process or,
+// if `cache_dir` is set, by any process sharing that directory. `device_key`
+// identifies the device and cuDNN version; an empty key disables caching.
+absl::StatusOr<CompiledGraph> GetOrCompileGraph(
+    se::dnn::DnnSupport& dnn_support, const HloFusionInstruction& hlo,
+    int64_t plan_id, absl::string_view device_key,
+    absl::string_view cache_dir) {
+  if (device_key.empty()) {
+    return CompileGraph(dnn_support, hlo, plan_id);
+  }
+  TF_ASSIGN_OR_RETURN(
+      std::string key_hash,
+      GetBase64EncodedSha256Hash(absl::StrCat(
+          device_key, "\n", RequireDeterminism(hlo.GetModule()->config()),
+          "\n", plan_id, "\n",
+          GetComputationFingerprint(hlo.fused_instructions_computation(),
+                                    {}))));
+  {
+    absl::MutexLock lock(&compiled_graphs_mu);
+    auto it = CompiledGraphs().find(key_hash);
+    if (it != CompiledGraphs().end()) {
+      VLOG(4) << "Reusing cuDNN graph compiled by another executable.";
+      return it->second;
+    }
+  }
+
+  std::string file_path;
+  std::optional<CompiledGraph> graph;
+  if (!cache_dir.empty()) {
+    file_path = GetCompiledGraphFilePath(cache_dir, key_hash);
+    graph = ReadCompiledGraphFromCache(file_path);
+  }
+  if (graph.has_value()) {
+    VLOG(4) << "Loaded cuDNN graph from " << file_path;
+  } else {
+    TF_ASSIGN_OR_RETURN(graph, CompileGraph(dnn_support, hlo, plan_id));
+    if (!cache_dir.empty()) {
+      if (absl::Status status = WriteCompiledGraphToCache(file_path, *graph);
+          !status.ok()) {
+        LOG(WARNING) << "Failed to write cuDNN graph cache entry " << file_path
+                     << ": " << status;
+      }
+    }
+  }
+
+  absl::MutexLock lock(&compiled_graphs_mu);
+  CompiledGraphs().emplace(std::move(key_hash), *graph);
+  return *std::move(graph);
+}
+
 absl::StatusOr<HloInstruction*> AddWorkspace(HloInstruction& fusion,
                                              const int64_t workspace_size) {
   HloComputation* computation = fusion.fused_instructions_computation();
@@ -664,9 +828,11 @@ absl::StatusOr<HloInstruction*> AddWorkspace(HloInstruction& fusion,
 
 class CuDnnFusionVisitor : public DfsHloRewriteVisitor {
  public:
-  explicit CuDnnFusionVisitor(se::dnn::DnnSupport& dnn_support,
-                              BinaryMap& compilation_results)
-      : dnn_support_(dnn_support), compilation_results_(compilation_results) {}
+  CuDnnFusionVisitor(se::dnn::DnnSupport& dnn_support,
+                     BinaryMap& compilation_results, std::string device_key)
+      : dnn_support_(dnn_support),
+        compilation_results_(compilation_results),
+        device_key_(std::move(device_key)) {}
 
   absl::Status HandleFusion(HloInstruction* hlo) override {
     TF_ASSIGN_OR_RETURN(auto gpu_config,
@@ -696,43 +862,23 @@ class CuDnnFusionVisitor : public DfsHloRewriteVisitor {
         workspace_sizes_.find(fingerprint_without_workspace);
     if (workspace_size_it == workspace_sizes_.cend()) {
       TF_ASSIGN_OR_RETURN(
-          se::gpu::CudnnGraph graph,
-          PrepareGraph(dnn_support_, *DynCast<HloFusionInstruction>(hlo)));
+          CompiledGraph graph,
+          GetOrCompileGraph(dnn_support_, *DynCast<HloFusionInstruction>(hlo),
+                            plan_id, device_key_,
+                            hlo->GetModule()
+                                ->config()
+                                .debug_options()
+                                .xla_gpu_cudnn_graph_cache_dir()));
+      plan_id = graph.plan_id;
+      workspace_sizes_.insert(workspace_size_it, {fingerprint_without_workspace,
+                                                  graph.workspace_size});
+      TF_RETURN_IF_ERROR(add_workspace(graph.workspace_size));
 
-      if (plan_id >= 0) {
-        // Build single plan with given ID.
-        if (plan_id >= graph.Graph().get_execution_plan_count()) {
-          return absl::InternalError("cuDNN graph plan does not exist.");
-        }
-        TF_RETURN_IF_ERROR(graph.Build(dnn_support_, plan_id));
-      } else {
-        // Build plans one by one till first successful when no plan_id was
-        // provided.
-        for (plan_id = 0; plan_id < graph.Graph().get_execution_plan_count();
-             ++plan_id) {
-          VLOG(7) << "Trying plan ID " << plan_id;
-          if (graph.Build(dnn_support_, plan_id).ok()) {
-            VLOG(7) << "Successfully built plan ID " << plan_id;
-            break;
-          }
-        }
-        if (plan_id == graph.Graph().get_execution_plan_count()) {
-          return absl::InternalError("No cuDNN plans can be built.");
-        }
-      }
-      const int64_t workspace_size = graph.Graph().get_workspace_size();
-      workspace_sizes_.insert(workspace_size_it,
-                              {fingerprint_without_workspace, workspace_size});
-      TF_RETURN_IF_ERROR(add_workspace(workspace_size));
-
-      std::vector<uint8_t> serialized_graph;
-      RETURN_IF_CUDNN_FRONTEND_ERROR(graph.Graph().serialize(serialized_graph));
       // Compute a new fingerprint with a potential workspace for the
       // compilation results to match a fingerprint computed by the emitter.
       compilation_results_[GetComputationFingerprint(
           hlo->fused_instructions_computation(), {})] =
-          std::string(reinterpret_cast<char*>(serialized_graph.data()),
-                      serialized_graph.size());
+          std::move(graph.serialized_graph);
     } else {
       VLOG(4) << "Cache hit.";
       TF_RETURN_IF_ERROR(add_workspace(workspace_size_it->second));
@@ -750,6 +896,8 @@ class CuDnnFusionVisitor : public DfsHloRewriteVisitor {
   se::dnn::DnnSupport& dnn_support_;
   // <HLO computation fingerprint, serialized compiled cuDNN graph>.
   BinaryMap& compilation_results_;
+  // Identifies the device and cuDNN version in the cross-executable cache.
+  std::string device_key_;
   absl::flat_hash_map<std::string, int64_t> workspace_sizes_;
 };
 
@@ -759,7 +907,16 @@ absl::StatusOr<bool> CuDnnFusionCompiler::Run(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
   XLA_SCOPED_LOGGING_TIMER("cuDNN fusion compiler");
-  return CuDnnFusionVisitor(dnn_support_, compilation_results_)
+  // Compiled graphs are only reused if cuDNN reports its version.
+  std::string device_key;
+  if (absl::StatusOr<se::dnn::VersionInfo> version = dnn_support_.GetVersion();
+      version.ok()) {
+    device_key = absl::StrCat(device_description_, " cudnn ",
+                              version->major_version(), ".",
+                              version->minor_version(), ".", version->patch());
+  }
+  return CuDnnFusionVisitor(dnn_support_, compilation_results_,
+                            std::move(device_key))
       .RunOnModule(module, execution_threads);
 }
 
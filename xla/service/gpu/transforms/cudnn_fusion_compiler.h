@@ -16,13 +16,17 @@ limitations under the License.
 #ifndef XLA_SERVICE_GPU_TRANSFORMS_CUDNN_FUSION_COMPILER_H_
 #define XLA_SERVICE_GPU_TRANSFORMS_CUDNN_FUSION_COMPILER_H_
 
+#include <string>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "xla/hlo/ir/hlo_instructions.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/pass/hlo_pass_interface.h"
 #include "xla/service/gpu/ir_emission_utils.h"
+#include "xla/stream_executor/device_description.h"
 #include "xla/stream_executor/dnn.h"
 #include "xla/stream_executor/stream_executor.h"
 
@@ -36,7 +40,11 @@ class CuDnnFusionCompiler : public HloModulePass {
   explicit CuDnnFusionCompiler(se::StreamExecutor& stream_exec,
                                BinaryMap& compilation_results)
       : dnn_support_(*stream_exec.AsDnn()),
-        compilation_results_(compilation_results) {}
+        compilation_results_(compilation_results),
+        device_description_(absl::StrCat(
+            stream_exec.GetDeviceDescription().name(), " ",
+            stream_exec.GetDeviceDescription().cuda_compute_capability()
+                .ToString())) {}
 
   absl::string_view name() const override { return "cudnn-fusion-compiler"; }
 
@@ -51,6 +59,9 @@ class CuDnnFusionCompiler : public HloModulePass {
  private:
   se::dnn::DnnSupport& dnn_support_;
   BinaryMap& compilation_results_;
+  // Name and compute capability of the device. Graphs compiled by other
+  // executables are only reused on the same kind of device.
+  std::string device_description_;
 };
 
 }  // namespace gpu
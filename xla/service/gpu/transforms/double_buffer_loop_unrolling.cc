@@ -296,8 +296,12 @@ absl::Status HandleControlDependencies(
   return absl::OkStatus();
 }
 
-absl::StatusOr<bool> FullyUnroll(HloInstruction* while_instr,
-                                 HloModule* module) {
+// Unrolls the body of `while_instr` `unroll_factor` times, chaining the copies
+// through the root tuples, and divides the trip count by `unroll_factor`. The
+// trip count must be a multiple of `unroll_factor`.
+absl::StatusOr<bool> UnrollLoopBody(HloInstruction* while_instr,
+                                    HloModule* module, int64_t unroll_factor,
+                                    absl::string_view clone_suffix) {
   HloComputation* while_body = while_instr->while_body();
   bool changed = false;
   VLOG(2) << "Processing root " << while_body->root_instruction()->ToString();
@@ -308,10 +312,13 @@ absl::StatusOr<bool> FullyUnroll(HloInstruction* while_instr,
 
   absl::flat_hash_map<HloInstruction*, HloInstruction*> old_to_new_map;
   absl::flat_hash_set<HloInstruction*> skip_control_dep_injection;
-  std::string clone_suffix = "full_unroll_clone";
 
   TF_ASSIGN_OR_RETURN(WhileLoopBackendConfig config,
                       while_instr->backend_config<WhileLoopBackendConfig>());
+  const int64_t trip_count = config.known_trip_count().n();
+  TF_RET_CHECK(trip_count % unroll_factor == 0)
+      << "Trip count " << trip_count << " is not a multiple of the unroll "
+      << "factor " << unroll_factor;
   std::vector<HloInstruction*> ops_to_clone;
   ops_to_clone.reserve(while_body->MakeInstructionPostOrder().size());
 
@@ -327,8 +334,7 @@ absl::StatusOr<bool> FullyUnroll(HloInstruction* while_instr,
     seen_ops.insert(old_instr);
   }
 
-  int n = config.known_trip_count().n();
-  while (--n) {
+  for (int64_t i = 1; i < unroll_factor; ++i) {
     std::vector<HloInstruction*> new_ops_to_clone;
     old_to_new_map[old_input_parameter] = new_input_parameter;
     for (HloInstruction* old_instr : ops_to_clone) {
@@ -377,12 +383,20 @@ absl::StatusOr<bool> FullyUnroll(HloInstruction* while_instr,
   }
 
   WhileLoopBackendConfig new_config;
-  new_config.mutable_known_trip_count()->set_n(1);
+  new_config.mutable_known_trip_count()->set_n(trip_count / unroll_factor);
   TF_RETURN_IF_ERROR(while_instr->set_backend_config(new_config));
 
   return changed;
 }
 
+absl::StatusOr<bool> FullyUnroll(HloInstruction* while_instr,
+                                 HloModule* module) {
+  TF_ASSIGN_OR_RETURN(WhileLoopBackendConfig config,
+                      while_instr->backend_config<WhileLoopBackendConfig>());
+  return UnrollLoopBody(while_instr, module, config.known_trip_count().n(),
+                        "full_unroll_clone");
+}
+
 absl::Status PeelInstructionsForOddTripCount(HloModule* module,
                                              HloInstruction* while_instr) {
   std::string suffix = "peeled_double_buffer";
@@ -540,6 +554,68 @@ absl::StatusOr<bool> AutoUnroll(HloInstruction* while_instr,
   return false;  // IR not changed.
 }
 
+// Returns the number of instructions of `computation` that are likely to be
+// launched as separate kernels or thunks.
+int64_t CountLaunchedInstructions(const HloComputation* computation) {
+  return absl::c_count_if(
+      computation->instructions(), [](const HloInstruction* instr) {
+        return !HloPredicateIsOp<HloOpcode::kParameter,
+                                 HloOpcode::kGetTupleElement, HloOpcode::kTuple,
+                                 HloOpcode::kConstant, HloOpcode::kBitcast>(
+            instr);
+      });
+}
+
+// Function partially unrolls loops with small bodies, which are bound by the
+// per-iteration overhead of the while loop rather than by the work in the body.
+// The unroll factor is the largest one that keeps the unrolled body within a
+// budget of launched instructions, so larger bodies are unrolled less (and the
+// extra live temporaries of the unrolled copies stay bounded). The remainder
+// of iterations is peeled before the loop.
+absl::StatusOr<bool> PartiallyUnroll(HloInstruction* while_instr,
+                                     HloModule* module) {
+  // Upper bound of the unroll factor.
+  constexpr int64_t kMaxUnrollFactor = 8;
+  // Maximum number of launched instructions in the unrolled body.
+  constexpr int64_t kMaxUnrolledBodyInstructions = 64;
+
+  HloComputation* while_body = while_instr->while_body();
+  // Send-recv validation attributes are defined per iteration of the original
+  // loop, and are only rewritten for double buffering.
+  if (absl::c_any_of(while_body->instructions(), [](HloInstruction* instr) {
+        return instr->frontend_attributes().map().contains(
+            kSendRecvValidationAttr);
+      })) {
+    VLOG(2) << "Skipping partial unrolling of " << while_instr->name()
+            << " with send-recv validation attributes.";
+    return false;
+  }
+
+  TF_ASSIGN_OR_RETURN(WhileLoopBackendConfig config,
+                      while_instr->backend_config<WhileLoopBackendConfig>());
+  int64_t trip_count = config.known_trip_count().n();
+  int64_t body_instructions =
+      std::max<int64_t>(1, CountLaunchedInstructions(while_body));
+  int64_t unroll_factor =
+      std::min({kMaxUnrollFactor, trip_count,
+                kMaxUnrolledBodyInstructions / body_instructions});
+  VLOG(2) << "Loop " << while_instr->name() << " with " << body_instructions
+          << " launched instructions and trip count " << trip_count
+          << " has unroll factor " << unroll_factor;
+  if (unroll_factor < 2) {
+    return false;
+  }
+
+  for (int64_t i = 0; i < trip_count % unroll_factor; ++i) {
+    TF_RETURN_IF_ERROR(PeelInstructionsForOddTripCount(module, while_instr));
+  }
+  config.mutable_known_trip_count()->set_n(trip_count -
+                                           trip_count % unroll_factor);
+  TF_RETURN_IF_ERROR(while_instr->set_backend_config(config));
+  return UnrollLoopBody(while_instr, module, unroll_factor,
+                        "partial_unroll_clone");
+}
+
 }  // namespace
 
 absl::StatusOr<bool> DoubleBufferLoopUnrolling::Run(
@@ -574,6 +650,8 @@ absl::StatusOr<bool> DoubleBufferLoopUnrolling::Run(
       TF_ASSIGN_OR_RETURN(changed, DoubleBufferingUnroll(while_instr, module));
     } else if (unroll_strategy_ == UnrollStrategy::kAuto) {
       TF_ASSIGN_OR_RETURN(changed, AutoUnroll(while_instr, module));
+    } else if (unroll_strategy_ == UnrollStrategy::kPartialUnroll) {
+      TF_ASSIGN_OR_RETURN(changed, PartiallyUnroll(while_instr, module));
     } else {
       LOG(FATAL) << absl::StrCat("Unhandled unrolling strategy: ",
                                  unroll_strategy_);
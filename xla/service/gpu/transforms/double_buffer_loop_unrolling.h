@@ -43,11 +43,22 @@ namespace gpu {
 //   passes (like `WhileLoopSimplifier`) to simplify/get rid of the while loop
 //   eventually.
 //
+// With `kPartialUnroll` strategy:
+//   This pass unrolls loops with small bodies by a factor chosen from the
+//   number of instructions launched per iteration, to amortize the overhead of
+//   every iteration of the while loop. The remaining iterations are peeled
+//   outside of the while loop, and the trip count is divided by the factor.
+//
 // Note that this pass will flatten the call graph if any loop has been
 // unrolled.
 class DoubleBufferLoopUnrolling : public HloModulePass {
  public:
-  enum class UnrollStrategy { kDoubleBuffer, kFullUnroll, kAuto };
+  enum class UnrollStrategy {
+    kDoubleBuffer,
+    kFullUnroll,
+    kAuto,
+    kPartialUnroll
+  };
 
   explicit DoubleBufferLoopUnrolling(
       UnrollStrategy unroll_strategy = UnrollStrategy::kDoubleBuffer)
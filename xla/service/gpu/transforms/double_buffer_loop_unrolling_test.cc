@@ -279,6 +279,56 @@ ENTRY main {
   EXPECT_EQ(CountInstructions((*module), HloOpcode::kAllGatherStart), 10);
 }
 
+TEST_F(GpuLoopDoubleBufferTransformerTest,
+       PartialUnrollSmallBodyPeelsRemainderTest) {
+  const char* const kModuleString = R"(
+HloModule small_body
+condition {
+  input_tuple = (f32[1,128], s32[]) parameter(0)
+  cond = s32[] get-tuple-element(input_tuple), index=1
+  trip_count = s32[] constant(10)
+  ROOT done = pred[] compare(cond, trip_count), direction=LT
+}
+
+body {
+ input_tuple = (f32[1,128], s32[]) parameter(0)
+ param_0 = f32[1,128] get-tuple-element(input_tuple), index=0
+ cond = s32[] get-tuple-element(input_tuple), index=1
+ add = f32[1,128] add(param_0, param_0)
+ one = s32[] constant(1)
+ cond_plus_1 = s32[] add(cond, one)
+ ROOT output_tuple = (f32[1,128], s32[]) tuple(add, cond_plus_1)
+}
+
+ENTRY main {
+ param_0 = f32[1,128] parameter(0)
+ param_1 = s32[] constant(0)
+ tuple = (f32[1,128], s32[]) tuple(param_0, param_1)
+ ROOT while = (f32[1,128], s32[]) while(tuple), condition=condition, body=body, backend_config={"known_trip_count":{"n":"10"}}
+})";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xla::HloModule> module,
+                          ParseAndReturnVerifiedModule(kModuleString));
+  DoubleBufferLoopUnrolling double_buffer(
+      DoubleBufferLoopUnrolling::UnrollStrategy::kPartialUnroll);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, double_buffer.Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  HloInstruction* while_instruction = hlo_query::GetFirstInstructionWithOpcode(
+      *module->entry_computation(), HloOpcode::kWhile);
+  TF_ASSERT_OK_AND_ASSIGN(
+      WhileLoopBackendConfig config,
+      while_instruction->backend_config<WhileLoopBackendConfig>());
+  // Two launched instructions per iteration give an unroll factor of 8, and
+  // the remaining 2 iterations are peeled before the loop.
+  EXPECT_EQ(config.known_trip_count().n(), 1);
+  EXPECT_EQ(
+      CountInstructions((*while_instruction->while_body()), HloOpcode::kAdd),
+      16);
+  EXPECT_EQ(CountInstructions((*module->entry_computation()), HloOpcode::kAdd),
+            4);
+}
+
 TEST_F(GpuLoopDoubleBufferTransformerTest, UnrolledLoopEvenTripCount) {
   const char* const kModuleString = R"(
 HloModule all_gather_overlapping
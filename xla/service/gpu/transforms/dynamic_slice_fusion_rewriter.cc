@@ -331,6 +331,35 @@ std::optional<std::vector<Literal>> GetValues(const HloInstruction* idx) {
   return std::nullopt;
 }
 
+// Returns true if `idx` is an offset read through a page table, i.e. a single
+// integer element loaded from a device buffer with a dynamic-slice, optionally
+// scaled by a constant page size:
+//
+//   page = s32[1] dynamic-slice(page_table, i), dynamic_slice_sizes={1}
+//   idx = s32[] multiply(reshape(page), page_size)
+//
+// This is the addressing scheme of paged KV caches. The values of such offsets
+// are data dependent and cannot be computed at compile time, but they can be
+// evaluated on device outside of the fusion and transferred to the host by the
+// DynamicSliceThunk, so the sliced operand is read in place instead of being
+// gathered into a temporary buffer.
+bool IsPageTableOffset(const HloInstruction* idx) {
+  if (!ShapeUtil::IsScalar(idx->shape()) ||
+      !primitive_util::IsIntegralType(idx->shape().element_type())) {
+    return false;
+  }
+  const HloInstruction* page = idx;
+  Match(idx, m::MultiplyAnyOrder(m::Op(&page), m::ConstantScalar()));
+  const HloInstruction* lookup = nullptr;
+  if (!Match(page, m::AnyOf<HloInstruction>(m::Reshape(m::Op(&lookup)),
+                                            m::Bitcast(m::Op(&lookup))))) {
+    return false;
+  }
+  return lookup->opcode() == HloOpcode::kDynamicSlice &&
+         ShapeUtil::ElementsIn(lookup->shape()) == 1 &&
+         primitive_util::IsIntegralType(lookup->shape().element_type());
+}
+
 // This function takes a while operation and adds a loop iteration counter
 // variable as the last parameter in the loop. This is useful, especially
 // because the loop induction variable might not be 0,1,2,3... and we need a
@@ -446,7 +475,9 @@ std::unique_ptr<HloInstruction> GetAsConstantInstruction(
 // offsets. This only returns true if it can successfully find values
 // corresponding to all the offsets in the `matched_instrs`. If there is a
 // single offset for which we cannot find the values, then we do not add
-// anything to the value map, and return false.
+// anything to the value map, and return false. Offsets read through a page
+// table (see `IsPageTableOffset`) are accepted without values and are resolved
+// at run time.
 bool PopulateOffsetValueMap(const HloInstruction* matched_instr,
                             OffsetValueMap& value_map) {
   OffsetValueMap local_value_map;
@@ -457,7 +488,11 @@ bool PopulateOffsetValueMap(const HloInstruction* matched_instr,
       if (local_value_map.contains(indexop) || value_map.contains(indexop))
         continue;
       std::optional<std::vector<Literal>> values = GetValues(indexop);
-      if (values == std::nullopt) return false;
+      if (values == std::nullopt) {
+        // Page table lookups are left as device-computed offsets.
+        if (IsPageTableOffset(indexop)) continue;
+        return false;
+      }
       if (values->empty() || !primitive_util::IsIntegralType(
                                  values->at(0).shape().element_type())) {
         return false;
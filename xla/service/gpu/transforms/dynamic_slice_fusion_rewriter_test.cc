@@ -1264,6 +1264,88 @@ TEST_F(DynamicSliceFusionRewriterTest, DynamicSimpleGemm) {
   RunAndFilecheckHloRewrite(hlo, DynamicSliceFusionRewriter("gpu"), expected);
 }
 
+TEST_F(DynamicSliceFusionRewriterTest, DynamicSimpleGemmPageTableOffset) {
+  const char* hlo = R"(
+    HloModule test
+
+    Body {
+      p = (s32[], f16[16,8,8], f16[8,8], s32[4], f16[4,8,8]) parameter(0)
+      i = s32[] get-tuple-element(p), index=0
+      cache = f16[16,8,8] get-tuple-element(p), index=1
+      q = f16[8,8] get-tuple-element(p), index=2
+      page_table = s32[4] get-tuple-element(p), index=3
+      out = f16[4,8,8] get-tuple-element(p), index=4
+      c0 = s32[] constant(0)
+      c1 = s32[] constant(1)
+      lookup = s32[1] dynamic-slice(page_table, i), dynamic_slice_sizes={1}
+      page = s32[] reshape(lookup)
+      ds = f16[1,8,8] dynamic-slice(cache, page, c0, c0), dynamic_slice_sizes={1,8,8}
+      k = f16[8,8] bitcast(ds)
+      gemm = f16[8,8] custom-call(q, k),
+        custom_call_target="__cublas$gemm",
+        backend_config={"gemm_backend_config":{
+          "alpha_real":1,
+          "beta":0,
+          "dot_dimension_numbers":{
+            "lhs_contracting_dimensions":["1"],
+            "rhs_contracting_dimensions":["0"],
+            "lhs_batch_dimensions":[],
+            "rhs_batch_dimensions":[]
+          },
+          "alpha_imag":0,
+          "precision_config":{"operand_precision":["DEFAULT","DEFAULT"]},
+          "epilogue":"DEFAULT",
+          "lhs_stride":"64",
+          "rhs_stride":"64",
+          "grad_x":false,
+          "grad_y":false
+        }}
+      scores = f16[1,8,8] bitcast(gemm)
+      dus = f16[4,8,8] dynamic-update-slice(out, scores, i, c0, c0)
+      i_plus_one = s32[] add(i, c1)
+      ROOT tuple = tuple(i_plus_one, cache, q, page_table, dus)
+    }
+
+    Cond {
+      p = (s32[], f16[16,8,8], f16[8,8], s32[4], f16[4,8,8]) parameter(0)
+      i = s32[] get-tuple-element(p), index=0
+      c4 = s32[] constant(4)
+      ROOT compare = pred[] compare(i, c4), direction=LT
+    }
+
+    ENTRY main {
+      cache = f16[16,8,8] parameter(0)
+      q = f16[8,8] parameter(1)
+      page_table = s32[4] parameter(2)
+      out = f16[4,8,8] parameter(3)
+      c0 = s32[] constant(0)
+      tuple = tuple(c0, cache, q, page_table, out)
+      ROOT while = while(tuple), body=Body, condition=Cond,
+        backend_config={"known_trip_count":{"n":"4"}}
+    }
+  )";
+
+  // The page is looked up on device and passed to the fusion as a run time
+  // offset, while the loop iteration offset of the DUS is precomputed.
+  const char* expected = R"(
+    ; CHECK:     dynamic-slice-fusion{{.*}} {
+    ; CHECK-DAG:   [[CACHE:%[^ ]+]] = f16[16,8,8]{2,1,0} parameter
+    ; CHECK-DAG:   [[DS:%[^ ]+]] = f16[1,8,8]{2,1,0} dynamic-slice([[CACHE]], {{.+}})
+    ; CHECK-DAG:   [[K:%[^ ]+]] = f16[8,8]{1,0} bitcast([[DS]])
+    ; CHECK-DAG:   [[GEMM:%[^ ]+]] = f16[8,8]{1,0} custom-call({{.+}}, [[K]]),
+    ; CHECK-DAG:   {{.+}} = s32[4]{0} constant({0, 1, 2, 3})
+    ; CHECK:       ROOT {{.+}} = f16[4,8,8]{2,1,0} dynamic-update-slice
+    ; CHECK:     }
+    ; CHECK:     Body
+    ; CHECK:       [[LOOKUP:%[^ ]+]] = s32[1]{0} dynamic-slice
+    ; CHECK:       [[PAGE:%[^ ]+]] = s32[] reshape([[LOOKUP]])
+    ; CHECK:       fusion({{.*}}[[PAGE]]{{.*}}), kind=kCustom, calls=%dynamic-slice-fusion
+    ; CHECK-SAME:    "name":"dynamic_address_computation"
+  )";
+
+  RunAndFilecheckHloRewrite(hlo, DynamicSliceFusionRewriter("gpu"), expected);
+}
+
 TEST_F(DynamicSliceFusionRewriterTest, DynamicSimpleGemmWithWorkspace) {
   const char* hlo = R"(
     HloModule test
@@ -0,0 +1,216 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/transforms/grouped_gemm_fusion.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_dfs_reachability.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/service/gpu/backend_configs.pb.h"
+#include "xla/service/gpu/ir_emission_utils.h"
+#include "xla/service/gpu/matmul_utils.h"
+#include "xla/service/gpu/triton_grouped_gemm_analysis.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_description.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::gpu {
+namespace {
+
+// A dot is small if its output tiles of this size do not fill the GPU.
+constexpr int64_t kSmallGemmTileSize = 64;
+
+// Bounds the number of arguments and branches of the grouped kernels.
+constexpr int64_t kMaxGroupSize = 32;
+
+bool IsSmallGemm(const TritonGroupedGemmAnalysis::Gemm& gemm,
+                 const se::DeviceDescription& device_info) {
+  TritonGemmConfig tiling(kSmallGemmTileSize, kSmallGemmTileSize,
+                          kSmallGemmTileSize, /*split_k=*/1, /*num_stages=*/1,
+                          /*num_warps=*/4);
+  return gemm.NumTiles(tiling) < device_info.core_count();
+}
+
+bool IsCandidate(const HloInstruction& instr,
+                 const se::DeviceDescription& device_info) {
+  if (instr.opcode() != HloOpcode::kDot ||
+      !instr.control_predecessors().empty() ||
+      !instr.control_successors().empty()) {
+    return false;
+  }
+  absl::StatusOr<TritonGroupedGemmAnalysis::Gemm> gemm =
+      TritonGroupedGemmAnalysis::AnalyzeDot(instr);
+  if (!gemm.ok()) {
+    VLOG(5) << gemm.status();
+    return false;
+  }
+  return IsSmallGemm(*gemm, device_info);
+}
+
+// Groups the candidate dots of `computation` greedily in post order and
+// returns the first full group or else the largest one if it has at least two
+// dots. The dots of a group have the same types and none of them is reachable
+// from another.
+std::vector<HloInstruction*> FindGroup(
+    HloComputation* computation, const se::DeviceDescription& device_info) {
+  std::unique_ptr<HloDfsReachability> reachability =
+      HloDfsReachability::Build(computation);
+  // In order of creation, so that the result is deterministic.
+  std::vector<std::vector<HloInstruction*>> groups;
+  auto same_types = [](const HloInstruction& a, const HloInstruction& b) {
+    return a.operand(0)->shape().element_type() ==
+               b.operand(0)->shape().element_type() &&
+           a.shape().element_type() == b.shape().element_type();
+  };
+  for (HloInstruction* instr : computation->MakeInstructionPostOrder()) {
+    if (!IsCandidate(*instr, device_info)) {
+      continue;
+    }
+    auto group = absl::c_find_if(
+        groups, [&](const std::vector<HloInstruction*>& group) {
+          return group.size() < kMaxGroupSize &&
+                 same_types(*group.front(), *instr) &&
+                 absl::c_none_of(group, [&](const HloInstruction* member) {
+                   return reachability->IsConnected(member, instr);
+                 });
+        });
+    if (group == groups.end()) {
+      groups.push_back({instr});
+      continue;
+    }
+    group->push_back(instr);
+    if (group->size() == kMaxGroupSize) {
+      return *group;
+    }
+  }
+  std::vector<HloInstruction*> largest;
+  for (std::vector<HloInstruction*>& group : groups) {
+    if (group.size() > largest.size()) {
+      largest = std::move(group);
+    }
+  }
+  if (largest.size() < 2) {
+    return {};
+  }
+  return largest;
+}
+
+absl::Status FuseGroup(HloComputation* parent,
+                       absl::Span<HloInstruction* const> dots) {
+  HloComputation::Builder builder("grouped_gemm_computation");
+  // Fusion operand -> fused parameter. Operands shared by several dots, e.g.
+  // the input of per-head projections, are passed once.
+  absl::flat_hash_map<const HloInstruction*, HloInstruction*> parameters;
+  std::vector<HloInstruction*> fusion_operands;
+  std::vector<HloInstruction*> fused_dots;
+  std::vector<Shape> result_shapes;
+  for (HloInstruction* dot : dots) {
+    std::vector<HloInstruction*> new_operands;
+    for (HloInstruction* operand : dot->operands()) {
+      auto [it, inserted] = parameters.try_emplace(operand, nullptr);
+      if (inserted) {
+        it->second = builder.AddInstruction(HloInstruction::CreateParameter(
+            fusion_operands.size(), operand->shape(),
+            absl::StrCat("parameter_", fusion_operands.size())));
+        fusion_operands.push_back(operand);
+      }
+      new_operands.push_back(it->second);
+    }
+    fused_dots.push_back(builder.AddInstruction(
+        dot->CloneWithNewOperands(dot->shape(), new_operands)));
+    result_shapes.push_back(dot->shape());
+  }
+  builder.AddInstruction(HloInstruction::CreateTuple(fused_dots));
+
+  HloComputation* computation =
+      parent->parent()->AddComputationAndUnifyNamesAndIds(builder.Build(),
+                                                          /*is_entry=*/false);
+  TF_ASSIGN_OR_RETURN(auto analysis,
+                      TritonGroupedGemmAnalysis::Execute(*computation));
+  HloInstruction* fusion = parent->AddInstruction(HloInstruction::CreateFusion(
+      ShapeUtil::MakeTupleShape(result_shapes),
+      HloInstruction::FusionKind::kCustom, fusion_operands, computation));
+  parent->parent()->SetAndUniquifyInstrName(fusion, "grouped_gemm");
+
+  TF_ASSIGN_OR_RETURN(auto gpu_config,
+                      fusion->backend_config<GpuBackendConfig>());
+  FusionBackendConfig& backend_config =
+      *gpu_config.mutable_fusion_backend_config();
+  backend_config.set_kind(std::string(kTritonGroupedGemmFusionKind));
+  *backend_config.mutable_triton_gemm_config() =
+      analysis.DefaultConfig().ToProto();
+  TF_RETURN_IF_ERROR(fusion->set_backend_config(gpu_config));
+
+  for (int64_t i = 0; i < dots.size(); ++i) {
+    TF_RETURN_IF_ERROR(parent->ReplaceInstruction(
+        dots[i], parent->AddInstruction(
+                     HloInstruction::CreateGetTupleElement(fusion, i))));
+  }
+  VLOG(3) << "Grouped " << dots.size() << " dots into " << fusion->name();
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<bool> GroupedGemmFusion::RunOnComputation(
+    HloComputation* computation) {
+  bool changed = false;
+  // Fusing a group changes the dependencies between the remaining dots, so
+  // the groups are formed again after every fusion.
+  while (true) {
+    std::vector<HloInstruction*> group = FindGroup(computation, device_info_);
+    if (group.empty()) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(FuseGroup(computation, group));
+    changed = true;
+  }
+  return changed;
+}
+
+absl::StatusOr<bool> GroupedGemmFusion::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  bool changed = false;
+  for (HloComputation* computation :
+       module->MakeNonfusionComputations(execution_threads)) {
+    TF_ASSIGN_OR_RETURN(bool computation_changed,
+                        RunOnComputation(computation));
+    changed |= computation_changed;
+  }
+  return changed;
+}
+
+}  // namespace xla::gpu
@@ -0,0 +1,63 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_TRANSFORMS_GROUPED_GEMM_FUSION_H_
+#define XLA_SERVICE_GPU_TRANSFORMS_GROUPED_GEMM_FUSION_H_
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/pass/hlo_pass_interface.h"
+#include "xla/stream_executor/device_description.h"
+
+namespace xla::gpu {
+
+// Horizontally fuses small independent dots, e.g. the expert FFNs of a
+// mixture-of-experts layer or per-head projections, into custom fusions of
+// kind `kTritonGroupedGemmFusionKind`. Each fusion is emitted as one Triton
+// kernel computing all of its dots, instead of a cuBLAS call or Triton GEMM
+// kernel per dot, which reduces the number of kernel launches.
+//
+// Only dots whose output tiles do not fill the GPU on their own are grouped,
+// large ones are left to the regular GEMM rewriters. The dots of a group share
+// their operand and result types but can have different shapes. They must not
+// depend on each other, so that the fusion does not create cycles.
+//
+//   a = dot(x0, w0)         fusion = (a', b') fusion(x0, w0, x1, w1)
+//   b = dot(x1, w1)    =>   a = get-tuple-element(fusion), index=0
+//                           b = get-tuple-element(fusion), index=1
+class GroupedGemmFusion : public HloModulePass {
+ public:
+  explicit GroupedGemmFusion(const se::DeviceDescription& device_info)
+      : device_info_(device_info) {}
+
+  absl::string_view name() const override { return "grouped-gemm-fusion"; }
+
+  using HloPassInterface::Run;
+  absl::StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  absl::StatusOr<bool> RunOnComputation(HloComputation* computation);
+
+  const se::DeviceDescription& device_info_;
+};
+
+}  // namespace xla::gpu
+
+#endif  // XLA_SERVICE_GPU_TRANSFORMS_GROUPED_GEMM_FUSION_H_
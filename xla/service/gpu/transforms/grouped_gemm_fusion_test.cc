@@ -0,0 +1,170 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/transforms/grouped_gemm_fusion.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/hlo/utils/hlo_query.h"
+#include "xla/service/gpu/backend_configs.pb.h"
+#include "xla/service/gpu/gpu_device_info_for_tests.h"
+#include "xla/service/gpu/ir_emission_utils.h"
+#include "xla/service/pattern_matcher.h"
+#include "xla/service/pattern_matcher_gmock.h"
+#include "xla/stream_executor/device_description.h"
+#include "xla/tests/hlo_test_base.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::gpu {
+namespace {
+
+using ::tsl::testing::IsOkAndHolds;
+namespace m = ::xla::match;
+
+class GroupedGemmFusionTest : public HloTestBase {
+ protected:
+  const se::DeviceDescription device_info_ =
+      TestGpuDeviceInfo::RTXA6000DeviceInfo();
+};
+
+TEST_F(GroupedGemmFusionTest, GroupsIndependentDots) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY main {
+  x0 = bf16[64,128] parameter(0)
+  x1 = bf16[32,128] parameter(1)
+  x2 = bf16[48,128] parameter(2)
+  w0 = bf16[128,256] parameter(3)
+  w1 = bf16[128,256] parameter(4)
+  w2 = bf16[128,256] parameter(5)
+  d0 = bf16[64,256] dot(x0, w0), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+  d1 = bf16[32,256] dot(x1, w1), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+  d2 = bf16[48,256] dot(x2, w2), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+  ROOT tuple = (bf16[64,256], bf16[32,256], bf16[48,256]) tuple(d0, d1, d2)
+})"));
+
+  EXPECT_THAT(GroupedGemmFusion(device_info_).Run(module.get()),
+              IsOkAndHolds(true));
+  const HloInstruction* fusion;
+  ASSERT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Tuple(
+                  m::GetTupleElement(m::Fusion(&fusion), 0),
+                  m::GetTupleElement(m::Fusion(), 1),
+                  m::GetTupleElement(m::Fusion(), 2))));
+  EXPECT_EQ(fusion->operand_count(), 6);
+  EXPECT_EQ(hlo_query::CountInstructionsWithOpcode(
+                *fusion->fused_instructions_computation(), HloOpcode::kDot),
+            3);
+  TF_ASSERT_OK_AND_ASSIGN(auto gpu_config,
+                          fusion->backend_config<GpuBackendConfig>());
+  const FusionBackendConfig& backend_config =
+      gpu_config.fusion_backend_config();
+  EXPECT_EQ(backend_config.kind(), kTritonGroupedGemmFusionKind);
+  EXPECT_EQ(backend_config.triton_gemm_config().block_m(), 64);
+  EXPECT_EQ(backend_config.triton_gemm_config().block_n(), 64);
+  EXPECT_EQ(backend_config.triton_gemm_config().block_k(), 32);
+}
+
+TEST_F(GroupedGemmFusionTest, PassesSharedOperandsOnce) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY main {
+  x = f32[16,64] parameter(0)
+  wq = f32[64,64] parameter(1)
+  wk = f32[64,64] parameter(2)
+  wv = f32[64,64] parameter(3)
+  q = f32[16,64] dot(x, wq), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  k = f32[16,64] dot(x, wk), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  v = f32[16,64] dot(x, wv), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT tuple = (f32[16,64], f32[16,64], f32[16,64]) tuple(q, k, v)
+})"));
+
+  EXPECT_THAT(GroupedGemmFusion(device_info_).Run(module.get()),
+              IsOkAndHolds(true));
+  const HloInstruction* fusion;
+  ASSERT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Tuple(m::GetTupleElement(m::Fusion(&fusion), 0),
+                                  m::GetTupleElement(), m::GetTupleElement())));
+  EXPECT_THAT(fusion, GmockMatch(m::Fusion(m::Parameter(0), m::Parameter(1),
+                                           m::Parameter(2), m::Parameter(3))));
+}
+
+TEST_F(GroupedGemmFusionTest, DoesNotGroupDependentDots) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY main {
+  x = f32[16,64] parameter(0)
+  w0 = f32[64,64] parameter(1)
+  w1 = f32[64,64] parameter(2)
+  h = f32[16,64] dot(x, w0), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT y = f32[16,64] dot(h, w1), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})"));
+
+  EXPECT_THAT(GroupedGemmFusion(device_info_).Run(module.get()),
+              IsOkAndHolds(false));
+}
+
+TEST_F(GroupedGemmFusionTest, DoesNotGroupDotsOfDifferentTypes) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY main {
+  a0 = f32[16,64] parameter(0)
+  b0 = f32[64,64] parameter(1)
+  a1 = bf16[16,64] parameter(2)
+  b1 = bf16[64,64] parameter(3)
+  d0 = f32[16,64] dot(a0, b0), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+  d1 = bf16[16,64] dot(a1, b1), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+  ROOT tuple = (f32[16,64], bf16[16,64]) tuple(d0, d1)
+})"));
+
+  EXPECT_THAT(GroupedGemmFusion(device_info_).Run(module.get()),
+              IsOkAndHolds(false));
+}
+
+TEST_F(GroupedGemmFusionTest, DoesNotGroupLargeDots) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY main {
+  a0 = f16[2048,1024] parameter(0)
+  b0 = f16[1024,2048] parameter(1)
+  a1 = f16[2048,1024] parameter(2)
+  b1 = f16[1024,2048] parameter(3)
+  d0 = f16[2048,2048] dot(a0, b0), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+  d1 = f16[2048,2048] dot(a1, b1), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+  ROOT tuple = (f16[2048,2048], f16[2048,2048]) tuple(d0, d1)
+})"));
+
+  EXPECT_THAT(GroupedGemmFusion(device_info_).Run(module.get()),
+              IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace xla::gpu
@@ -0,0 +1,386 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/transforms/hierarchical_collective_decomposer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "xla/hlo/ir/collective_device_list.h"
+#include "xla/hlo/ir/hlo_casting_utils.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/hlo/utils/hlo_query.h"
+#include "xla/service/collective_ops_utils.h"
+#include "xla/service/computation_placer.h"
+#include "xla/service/global_device_id.h"
+#include "xla/service/hlo_creation_utils.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/status_macros.h"
+#include "xla/util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::gpu {
+namespace {
+
+// Replica groups of the two phases of a hierarchical collective.
+struct HierarchicalGroups {
+  // Devices of the same node, ordered as in the original replica group.
+  std::vector<ReplicaGroup> intra_node_groups;
+  // Devices with the same local index on every node.
+  std::vector<ReplicaGroup> inter_node_groups;
+
+  int64_t num_nodes;
+  int64_t num_local_devices;
+};
+
+// Returns the global device id for the given replica id, or nullopt if the
+// replica id can refer to multiple devices.
+std::optional<GlobalDeviceId> GetDeviceId(
+    int64_t replica_id, const DeviceAssignment& device_assignment,
+    CollectiveOpGroupMode group_mode) {
+  switch (group_mode) {
+    case CollectiveOpGroupMode::kCrossReplica:
+      if (device_assignment.computation_count() != 1) return std::nullopt;
+      return GlobalDeviceId{device_assignment(replica_id, 0)};
+    case CollectiveOpGroupMode::kFlattenedID: {
+      int64_t partition_count = device_assignment.computation_count();
+      return GlobalDeviceId{device_assignment(replica_id / partition_count,
+                                              replica_id % partition_count)};
+    }
+    default:
+      return std::nullopt;
+  }
+}
+
+absl::StatusOr<std::optional<HierarchicalGroups>> DecomposeReplicaGroups(
+    const HloCollectiveInstruction& collective, int64_t num_devices_per_node,
+    bool preserve_order) {
+  const DeviceAssignment& device_assignment =
+      collective.GetModule()->config().static_device_assignment();
+
+  TF_ASSIGN_OR_RETURN(
+      CollectiveOpGroupMode group_mode,
+      GetCollectiveOpGroupMode(collective.channel_id().has_value(),
+                               collective.use_global_device_ids()));
+
+  absl::Span<const ReplicaGroup> replica_groups = collective.replica_groups();
+  ReplicaGroup all_replicas;  // only populated if replica groups not present.
+  if (replica_groups.empty()) {
+    if (group_mode != CollectiveOpGroupMode::kCrossReplica) {
+      return {std::nullopt};
+    }
+    for (int64_t i = 0; i < device_assignment.replica_count(); ++i) {
+      all_replicas.add_replica_ids(i);
+    }
+    replica_groups = absl::MakeSpan(&all_replicas, 1);
+  }
+
+  HierarchicalGroups groups{{}, {}, 0, 0};
+  for (const ReplicaGroup& replica_group : replica_groups) {
+    TF_RET_CHECK(replica_group.replica_ids_size() > 0);
+
+    // Members of the replica group on every node, in the order of the first
+    // appearance of the node in the group.
+    absl::flat_hash_map<int64_t, int64_t> node_index;
+    std::vector<std::vector<int64_t>> node_members;
+    for (int64_t replica_id : replica_group.replica_ids()) {
+      std::optional<GlobalDeviceId> device_id =
+          GetDeviceId(replica_id, device_assignment, group_mode);
+      if (!device_id.has_value()) return {std::nullopt};
+      TF_RET_CHECK(device_id->value() >= 0);
+
+      int64_t node = device_id->value() / num_devices_per_node;
+      auto [it, inserted] = node_index.emplace(node, node_members.size());
+      if (inserted) node_members.emplace_back();
+      node_members[it->second].push_back(replica_id);
+    }
+
+    int64_t num_nodes = node_members.size();
+    int64_t num_local_devices = node_members.front().size();
+    if (num_nodes < 2 || num_local_devices < 2) return {std::nullopt};
+    if (!absl::c_all_of(node_members, [&](const auto& members) {
+          return members.size() == num_local_devices;
+        })) {
+      return {std::nullopt};
+    }
+
+    // All groups must be decomposed the same way to have the same shapes.
+    if (groups.num_nodes == 0) {
+      groups.num_nodes = num_nodes;
+      groups.num_local_devices = num_local_devices;
+    } else if (groups.num_nodes != num_nodes ||
+               groups.num_local_devices != num_local_devices) {
+      return {std::nullopt};
+    }
+
+    if (preserve_order) {
+      for (int64_t i = 0; i < replica_group.replica_ids_size(); ++i) {
+        if (node_members[i / num_local_devices][i % num_local_devices] !=
+            replica_group.replica_ids(i)) {
+          return {std::nullopt};
+        }
+      }
+    }
+
+    for (const std::vector<int64_t>& members : node_members) {
+      ReplicaGroup& group = groups.intra_node_groups.emplace_back();
+      for (int64_t replica_id : members) group.add_replica_ids(replica_id);
+    }
+    for (int64_t i = 0; i < num_local_devices; ++i) {
+      ReplicaGroup& group = groups.inter_node_groups.emplace_back();
+      for (const std::vector<int64_t>& members : node_members) {
+        group.add_replica_ids(members[i]);
+      }
+    }
+  }
+
+  return {std::move(groups)};
+}
+
+// Views dimension `dim` of `value` as `[outer, inner, rest]` blocks and
+// transposes them to `[inner, outer, rest]`.
+absl::StatusOr<HloInstruction*> TransposeBlocks(HloInstruction* value,
+                                                int64_t dim, int64_t outer,
+                                                int64_t inner) {
+  const Shape& shape = value->shape();
+  std::vector<int64_t> dims(shape.dimensions().begin(),
+                            shape.dimensions().end());
+  int64_t rest = dims[dim] / (outer * inner);
+  dims[dim] = rest;
+  dims.insert(dims.begin() + dim, {outer, inner});
+
+  std::vector<int64_t> permutation(dims.size());
+  absl::c_iota(permutation, 0);
+  std::swap(permutation[dim], permutation[dim + 1]);
+
+  TF_ASSIGN_OR_RETURN(HloInstruction * blocks, MakeReshapeHlo(dims, value));
+  TF_ASSIGN_OR_RETURN(HloInstruction * transposed,
+                      MakeTransposeHlo(blocks, permutation));
+  return MakeReshapeHlo(shape, transposed);
+}
+
+class Decomposer {
+ public:
+  Decomposer(HloCollectiveInstruction* collective, HierarchicalGroups groups)
+      : collective_(collective),
+        computation_(collective->parent()),
+        groups_(std::move(groups)),
+        next_channel_id_(hlo_query::NextChannelId(*collective->GetModule())) {}
+
+  // Returns the first collective and the result of the decomposition.
+  absl::StatusOr<std::pair<HloInstruction*, HloInstruction*>> Decompose() {
+    switch (collective_->opcode()) {
+      case HloOpcode::kAllReduce:
+        return DecomposeAllReduce();
+      case HloOpcode::kAllGather:
+        return DecomposeAllGather();
+      case HloOpcode::kReduceScatter:
+        return DecomposeReduceScatter();
+      default:
+        return Internal("Unexpected collective: %s", collective_->ToString());
+    }
+  }
+
+ private:
+  std::optional<int64_t> NextChannelId() {
+    if (!collective_->channel_id().has_value()) return std::nullopt;
+    return next_channel_id_++;
+  }
+
+  HloInstruction* ReduceScatter(const Shape& shape, HloInstruction* operand,
+                                const std::vector<ReplicaGroup>& groups,
+                                int64_t dim) {
+    return computation_->AddInstruction(HloInstruction::CreateReduceScatter(
+        shape, {operand}, collective_->to_apply(), CollectiveDeviceList(groups),
+        /*constrain_layout=*/false, NextChannelId(),
+        collective_->use_global_device_ids(), dim));
+  }
+
+  HloInstruction* AllGather(const Shape& shape, HloInstruction* operand,
+                            const std::vector<ReplicaGroup>& groups,
+                            int64_t dim) {
+    return computation_->AddInstruction(HloInstruction::CreateAllGather(
+        shape, {operand}, dim, CollectiveDeviceList(groups),
+        /*constrain_layout=*/false, NextChannelId(),
+        collective_->use_global_device_ids()));
+  }
+
+  absl::StatusOr<std::pair<HloInstruction*, HloInstruction*>>
+  DecomposeAllReduce() {
+    HloInstruction* operand = collective_->mutable_operand(0);
+    PrimitiveType type = operand->shape().element_type();
+    int64_t num_elements = ShapeUtil::ElementsIn(operand->shape());
+    Shape flat_shape = ShapeUtil::MakeShape(type, {num_elements});
+    Shape shard_shape = ShapeUtil::MakeShape(
+        type, {num_elements / groups_.num_local_devices});
+
+    TF_ASSIGN_OR_RETURN(HloInstruction * flat,
+                        MakeReshapeHlo(flat_shape, operand));
+    HloInstruction* reduce_scatter =
+        ReduceScatter(shard_shape, flat, groups_.intra_node_groups, 0);
+    HloInstruction* all_reduce =
+        computation_->AddInstruction(HloInstruction::CreateAllReduce(
+            shard_shape, {reduce_scatter}, collective_->to_apply(),
+            CollectiveDeviceList(groups_.inter_node_groups),
+            /*constrain_layout=*/false, NextChannelId(),
+            collective_->use_global_device_ids()));
+    HloInstruction* all_gather =
+        AllGather(flat_shape, all_reduce, groups_.intra_node_groups, 0);
+    TF_ASSIGN_OR_RETURN(HloInstruction * result,
+                        MakeReshapeHlo(collective_->shape(), all_gather));
+    return std::make_pair(reduce_scatter, result);
+  }
+
+  // The inter-node phase gathers `[node]` blocks, and the intra-node phase
+  // gathers `[local, node]` blocks that are transposed to the original order.
+  absl::StatusOr<std::pair<HloInstruction*, HloInstruction*>>
+  DecomposeAllGather() {
+    int64_t dim = Cast<HloAllGatherInstruction>(collective_)
+                      ->all_gather_dimension();
+    HloInstruction* operand = collective_->mutable_operand(0);
+    Shape inter_node_shape = operand->shape();
+    inter_node_shape.set_dimensions(
+        dim, inter_node_shape.dimensions(dim) * groups_.num_nodes);
+
+    HloInstruction* inter_node =
+        AllGather(inter_node_shape, operand, groups_.inter_node_groups, dim);
+    HloInstruction* intra_node = AllGather(collective_->shape(), inter_node,
+                                           groups_.intra_node_groups, dim);
+    TF_ASSIGN_OR_RETURN(HloInstruction * result,
+                        TransposeBlocks(intra_node, dim,
+                                        groups_.num_local_devices,
+                                        groups_.num_nodes));
+    return std::make_pair(inter_node, result);
+  }
+
+  // The operand is transposed from `[node, local]` to `[local, node]` blocks,
+  // so that the intra-node phase scatters `[node]` blocks to every device,
+  // and the inter-node phase scatters them between nodes.
+  absl::StatusOr<std::pair<HloInstruction*, HloInstruction*>>
+  DecomposeReduceScatter() {
+    int64_t dim =
+        Cast<HloReduceScatterInstruction>(collective_)->scatter_dimension();
+    HloInstruction* operand = collective_->mutable_operand(0);
+    TF_ASSIGN_OR_RETURN(HloInstruction * transposed,
+                        TransposeBlocks(operand, dim, groups_.num_nodes,
+                                        groups_.num_local_devices));
+
+    Shape intra_node_shape = collective_->shape();
+    intra_node_shape.set_dimensions(
+        dim, intra_node_shape.dimensions(dim) * groups_.num_nodes);
+    HloInstruction* intra_node = ReduceScatter(
+        intra_node_shape, transposed, groups_.intra_node_groups, dim);
+    HloInstruction* inter_node = ReduceScatter(
+        collective_->shape(), intra_node, groups_.inter_node_groups, dim);
+    return std::make_pair(intra_node, inter_node);
+  }
+
+  HloCollectiveInstruction* collective_;
+  HloComputation* computation_;
+  HierarchicalGroups groups_;
+  int64_t next_channel_id_;
+};
+
+bool IsCandidate(const HloInstruction* instr, int64_t min_bytes) {
+  if (instr->opcode() != HloOpcode::kAllReduce &&
+      instr->opcode() != HloOpcode::kAllGather &&
+      instr->opcode() != HloOpcode::kReduceScatter) {
+    return false;
+  }
+  const auto* collective = Cast<HloCollectiveInstruction>(instr);
+  if (collective->operand_count() != 1 || !collective->shape().IsArray() ||
+      collective->constrain_layout() || collective->has_sharding()) {
+    return false;
+  }
+  int64_t bytes =
+      std::max(ShapeUtil::ByteSizeOf(collective->shape()),
+               ShapeUtil::ByteSizeOf(collective->operand(0)->shape()));
+  return bytes >= min_bytes;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> HierarchicalCollectiveDecomposer::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  if (!module->config().has_static_device_assignment()) {
+    VLOG(1) << "Skip " << name()
+            << " because the module doesn't have static device assignment";
+    return false;
+  }
+
+  std::vector<HloCollectiveInstruction*> collectives;
+  for (HloComputation* computation :
+       module->MakeNonfusionComputations(execution_threads)) {
+    for (HloInstruction* instr : computation->instructions()) {
+      if (IsCandidate(instr, min_bytes_)) {
+        collectives.push_back(Cast<HloCollectiveInstruction>(instr));
+      }
+    }
+  }
+
+  bool changed = false;
+  for (HloCollectiveInstruction* collective : collectives) {
+    // The result of all-reduce doesn't depend on the order of devices.
+    bool preserve_order = collective->opcode() != HloOpcode::kAllReduce;
+    TF_ASSIGN_OR_RETURN(std::optional<HierarchicalGroups> groups,
+                        DecomposeReplicaGroups(*collective,
+                                               num_devices_per_node_,
+                                               preserve_order));
+    if (!groups.has_value()) continue;
+
+    if (collective->opcode() == HloOpcode::kAllReduce &&
+        ShapeUtil::ElementsIn(collective->shape()) %
+                groups->num_local_devices !=
+            0) {
+      continue;
+    }
+
+    VLOG(2) << "Decompose " << collective->name() << " into "
+            << groups->num_nodes << " nodes with "
+            << groups->num_local_devices << " devices";
+
+    TF_ASSIGN_OR_RETURN(auto decomposed,
+                        Decomposer(collective, *std::move(groups)).Decompose());
+    auto [first, result] = decomposed;
+
+    HloComputation* computation = collective->parent();
+    TF_RETURN_IF_ERROR(collective->CopyAllControlDepsTo(first, result));
+    TF_RETURN_IF_ERROR(collective->DropAllControlDeps());
+    TF_RETURN_IF_ERROR(computation->ReplaceInstruction(collective, result));
+    changed = true;
+  }
+
+  return changed;
+}
+
+}  // namespace xla::gpu
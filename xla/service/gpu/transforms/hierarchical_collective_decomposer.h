@@ -0,0 +1,75 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_TRANSFORMS_HIERARCHICAL_COLLECTIVE_DECOMPOSER_H_
+#define XLA_SERVICE_GPU_TRANSFORMS_HIERARCHICAL_COLLECTIVE_DECOMPOSER_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/pass/hlo_pass_interface.h"
+
+namespace xla::gpu {
+
+// Decomposes collectives spanning multiple nodes into an intra-node and an
+// inter-node phase, so that the network only carries the data each node has
+// to exchange with other nodes:
+//
+//   all-reduce:     intra-node reduce-scatter --> inter-node all-reduce -->
+//                   intra-node all-gather
+//   all-gather:     inter-node all-gather --> intra-node all-gather
+//   reduce-scatter: intra-node reduce-scatter --> inter-node reduce-scatter
+//
+// Inter-node collectives run between devices with the same local index on
+// every node (rails). Global device ids are mapped to nodes as
+// `device_id / num_devices_per_node`, and every replica group must have the
+// same number of devices (at least two) on each of at least two nodes. For
+// all-gather and reduce-scatter, whose results depend on the order of devices
+// in the replica group, devices of every node must also be contiguous in the
+// group; blocks of the data are transposed between the phases to preserve the
+// original order.
+//
+// Unlike AllReduceBlueConnect, which runs after fusion, this pass runs before
+// layout assignment so that the phases are scheduled as independent
+// collectives by the latency hiding scheduler, and the transposes get fused.
+class HierarchicalCollectiveDecomposer : public HloModulePass {
+ public:
+  HierarchicalCollectiveDecomposer(int64_t num_devices_per_node,
+                                   int64_t min_bytes)
+      : num_devices_per_node_(num_devices_per_node), min_bytes_(min_bytes) {}
+
+  absl::string_view name() const override {
+    return "hierarchical-collective-decomposer";
+  }
+
+  using HloPassInterface::Run;
+  absl::StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  int64_t num_devices_per_node_;
+
+  // Collectives with smaller operands are latency bound and keep a single
+  // phase.
+  int64_t min_bytes_;
+};
+
+}  // namespace xla::gpu
+
+#endif  // XLA_SERVICE_GPU_TRANSFORMS_HIERARCHICAL_COLLECTIVE_DECOMPOSER_H_
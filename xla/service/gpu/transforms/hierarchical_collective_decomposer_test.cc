@@ -0,0 +1,188 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/transforms/hierarchical_collective_decomposer.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/computation_placer.h"
+#include "xla/service/pattern_matcher.h"
+#include "xla/service/pattern_matcher_gmock.h"
+#include "xla/tests/hlo_test_base.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::gpu {
+namespace {
+
+using ::tsl::testing::IsOkAndHolds;
+namespace m = ::xla::match;
+
+class HierarchicalCollectiveDecomposerTest : public HloTestBase {
+ public:
+  absl::StatusOr<std::unique_ptr<VerifiedHloModule>> ParseModule(
+      absl::string_view hlo_string, int64_t replica_count) {
+    TF_ASSIGN_OR_RETURN(
+        auto module, ParseAndReturnVerifiedModule(hlo_string, replica_count));
+    DeviceAssignment device_assignment(replica_count,
+                                       /*computation_count=*/1);
+    device_assignment.FillIota(0);
+    module->mutable_config().set_static_device_assignment(device_assignment);
+    return module;
+  }
+};
+
+// clang-format off
+const std::vector<std::vector<int64_t>> kIntraNodeGroups = {
+    {0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9, 10, 11}, {12, 13, 14, 15}};
+const std::vector<std::vector<int64_t>> kInterNodeGroups = {
+    {0, 4, 8, 12}, {1, 5, 9, 13}, {2, 6, 10, 14}, {3, 7, 11, 15}};
+// clang-format on
+
+TEST_F(HierarchicalCollectiveDecomposerTest, AllReduce) {
+  constexpr absl::string_view hlo_string = R"(
+HloModule module
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  p0 = f32[8,16] parameter(0)
+  ROOT all-reduce = f32[8,16] all-reduce(p0), to_apply=add
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseModule(hlo_string, /*replica_count=*/16));
+
+  HierarchicalCollectiveDecomposer pass(/*num_devices_per_node=*/4,
+                                        /*min_bytes=*/0);
+  EXPECT_THAT(pass.Run(module.get()), IsOkAndHolds(true));
+
+  auto reduce_scatter =
+      m::ReduceScatter(m::Reshape(m::Parameter(0)).WithShape(F32, {128}))
+          .WithShape(F32, {32})
+          .WithReplicaGroups(kIntraNodeGroups);
+  auto all_reduce = m::AllReduce(reduce_scatter)
+                        .WithShape(F32, {32})
+                        .WithReplicaGroups(kInterNodeGroups);
+  auto all_gather = m::AllGather(all_reduce)
+                        .WithShape(F32, {128})
+                        .WithReplicaGroups(kIntraNodeGroups);
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Reshape(all_gather).WithShape(F32, {8, 16})));
+}
+
+TEST_F(HierarchicalCollectiveDecomposerTest, AllGather) {
+  constexpr absl::string_view hlo_string = R"(
+HloModule module
+
+ENTRY main {
+  p0 = f32[8,16] parameter(0)
+  ROOT all-gather = f32[8,256] all-gather(p0), dimensions={1}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseModule(hlo_string, /*replica_count=*/16));
+
+  HierarchicalCollectiveDecomposer pass(/*num_devices_per_node=*/4,
+                                        /*min_bytes=*/0);
+  EXPECT_THAT(pass.Run(module.get()), IsOkAndHolds(true));
+
+  auto inter_node = m::AllGather(m::Parameter(0))
+                        .WithShape(F32, {8, 64})
+                        .WithReplicaGroups(kInterNodeGroups);
+  auto intra_node = m::AllGather(inter_node)
+                        .WithShape(F32, {8, 256})
+                        .WithReplicaGroups(kIntraNodeGroups);
+  auto transpose =
+      m::Transpose(m::Reshape(intra_node).WithShape(F32, {8, 4, 4, 16}))
+          .WithShape(F32, {8, 4, 4, 16});
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Reshape(transpose).WithShape(F32, {8, 256})));
+}
+
+TEST_F(HierarchicalCollectiveDecomposerTest, ReduceScatter) {
+  constexpr absl::string_view hlo_string = R"(
+HloModule module
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  p0 = f32[128,16] parameter(0)
+  ROOT reduce-scatter = f32[8,16] reduce-scatter(p0), to_apply=add,
+    dimensions={0}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseModule(hlo_string, /*replica_count=*/16));
+
+  HierarchicalCollectiveDecomposer pass(/*num_devices_per_node=*/4,
+                                        /*min_bytes=*/0);
+  EXPECT_THAT(pass.Run(module.get()), IsOkAndHolds(true));
+
+  auto transpose =
+      m::Transpose(m::Reshape(m::Parameter(0)).WithShape(F32, {4, 4, 8, 16}));
+  auto intra_node = m::ReduceScatter(m::Reshape(transpose))
+                        .WithShape(F32, {32, 16})
+                        .WithReplicaGroups(kIntraNodeGroups);
+  auto inter_node = m::ReduceScatter(intra_node)
+                        .WithShape(F32, {8, 16})
+                        .WithReplicaGroups(kInterNodeGroups);
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(inter_node));
+}
+
+TEST_F(HierarchicalCollectiveDecomposerTest, KeepUnsupportedCollectives) {
+  constexpr absl::string_view hlo_string = R"(
+HloModule module
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  p0 = f32[64,16] parameter(0)
+  p1 = f32[8,16] parameter(1)
+  intra-node = f32[64,16] all-reduce(p0), to_apply=add,
+    replica_groups={{0,1,2,3},{4,5,6,7}}
+  interleaved = f32[64,16] all-gather(p1), dimensions={0},
+    replica_groups={{0,4,1,5,2,6,3,7}}
+  small = f32[8,16] all-reduce(p1), to_apply=add
+  ROOT tuple = (f32[64,16], f32[64,16], f32[8,16]) tuple(intra-node,
+    interleaved, small)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseModule(hlo_string, /*replica_count=*/8));
+
+  HierarchicalCollectiveDecomposer pass(/*num_devices_per_node=*/4,
+                                        /*min_bytes=*/1024);
+  EXPECT_THAT(pass.Run(module.get()), IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace xla::gpu
@@ -31,7 +31,6 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "xla/debug_options_flags.h"
 #include "xla/hlo/ir/hlo_casting_utils.h"
-#include "xla/hlo/ir/hlo_dfs_reachability.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_instructions.h"
 #include "xla/hlo/ir/hlo_opcode.h"
@@ -39,6 +38,7 @@ limitations under the License.
 #include "xla/service/gpu/model/gpu_hlo_cost_analysis.h"
 #include "xla/service/gpu/model/gpu_performance_model.h"
 #include "xla/service/gpu/model/gpu_performance_model_base.h"
+#include "xla/service/hlo_graph_cycles.h"
 #include "xla/service/hlo_graph_dumper.h"
 #include "xla/service/instruction_fusion.h"
 #include "xla/shape_util.h"
@@ -115,7 +115,8 @@ FusionDecision ParameterSlicesAreNonOverlapping(const HloInstruction& instr1,
 FusionDecision LegalToFuse(const HloInstruction& instr1,
                            const HloInstruction& instr2,
                            const se::DeviceDescription& device_info,
-                           FusionInfoCache* fusion_info_cache) {
+                           FusionInfoCache* fusion_info_cache,
+                           bool enforce_reduction_limit = true) {
   CHECK(instr1.opcode() == HloOpcode::kFusion);
 
   // The emitter only supports in-place DUS for fusions with a single DUS at the
@@ -133,7 +134,7 @@ FusionDecision LegalToFuse(const HloInstruction& instr1,
   // Do this check last, as it may be expensive.
   return FusionFitsInBudget(instr1, instr2, device_info,
                             /*is_consumer_producer_fusion=*/false,
-                            fusion_info_cache);
+                            fusion_info_cache, enforce_reduction_limit);
 }
 
 // We prefer multi-output fusions over other fusions over unfused ops, because
@@ -164,7 +165,7 @@ HloInstruction* SelectPreferredFusionCandidate(
 // reachable from the producer, this would create a cycle.
 FusionDecision OperandReachableFromProducer(
     const HloInstruction& producer, const HloInstruction& consumer,
-    const HloDfsReachability& reachability) {
+    const HloGraphCycles& reachability) {
   for (const auto* operand : consumer.operands()) {
     // If a get-tuple-element instruction is not in the reachability
     // map, it has been created by fusion in this pass. Simply move
@@ -186,7 +187,7 @@ FusionDecision OperandReachableFromProducer(
 
 FusionDecision ProducerCandidateIsFusible(
     const HloInstruction& producer, const HloInstruction& consumer,
-    const HloDfsReachability& reachability, FusionInfoCache* fusion_info_cache,
+    const HloGraphCycles& reachability, FusionInfoCache* fusion_info_cache,
     const se::DeviceDescription& device_info,
     GpuHloCostAnalysis* cost_analysis) {
   if (!IsFusibleAsMultiOutputFusionRoot(consumer)) {
@@ -221,7 +222,7 @@ FusionDecision ProducerCandidateIsFusible(
 }
 
 std::vector<HloInstruction*> GetProducerConsumerMultiOutputFusionCandidates(
-    const HloInstruction* producer, const HloDfsReachability& reachability,
+    const HloInstruction* producer, const HloGraphCycles& reachability,
     FusionInfoCache* fusion_info_cache,
     const se::DeviceDescription& device_info,
     GpuHloCostAnalysis* cost_analysis) {
@@ -279,12 +280,23 @@ bool IsSiblingFusionCandidate(const HloInstruction* instr) {
           }));
 }
 
+// Returns true if every non-scalar operand of `instr2` is also an operand of
+// `instr1`, i.e. fusing them does not add memory reads to `instr1`.
+bool ReadsOnlySharedOperands(const HloInstruction& instr1,
+                             const HloInstruction& instr2) {
+  return absl::c_all_of(instr2.operands(), [&](const HloInstruction* operand) {
+    return ShapeUtil::IsEffectiveScalar(operand->shape()) ||
+           absl::c_linear_search(instr1.operands(), operand);
+  });
+}
+
 FusionDecision CanFuseSiblings(const HloInstruction& sibling_consumer_1,
                                const HloInstruction& sibling_consumer_2,
                                const HloInstruction& common_producer,
-                               const HloDfsReachability& reachability,
+                               const HloGraphCycles& reachability,
                                FusionInfoCache* fusion_info_cache,
-                               const se::DeviceDescription& device_info) {
+                               const se::DeviceDescription& device_info,
+                               GpuHloCostAnalysis* cost_analysis) {
   if (reachability.IsConnected(&sibling_consumer_1, &sibling_consumer_2)) {
     return FusionDecision::Forbid(
         absl::StrCat(sibling_consumer_1.name(), " and ",
@@ -304,15 +316,33 @@ FusionDecision CanFuseSiblings(const HloInstruction& sibling_consumer_1,
       sibling_consumer_1, sibling_consumer_2, &common_producer));
 
   // This check should be last, as it may be expensive.
+  FusionDecision legal = LegalToFuse(sibling_consumer_1, sibling_consumer_2,
+                                     device_info, fusion_info_cache);
+  if (legal) return legal;
+
+  // The limit on unnested reductions is a heuristic. Sibling reductions that
+  // read no input besides those of the other sibling are still fused if the
+  // performance model estimates the merged kernel to be faster.
+  if (!ReadsOnlySharedOperands(sibling_consumer_1, sibling_consumer_2)) {
+    return legal;
+  }
   RETURN_IF_NOT_FUSIBLE(LegalToFuse(sibling_consumer_1, sibling_consumer_2,
-                                    device_info, fusion_info_cache));
+                                    device_info, fusion_info_cache,
+                                    /*enforce_reduction_limit=*/false));
+  GpuPerformanceModel::RunTimes t =
+      GpuPerformanceModel::EstimateRunTimesForSiblingFusion(
+          &sibling_consumer_1, &sibling_consumer_2, device_info, cost_analysis,
+          GpuPerformanceModelOptions::Default());
+  if (t.time_fused > t.time_unfused) {
+    return legal;
+  }
   return FusionDecision::Allow();
 }
 
 }  // namespace
 
 void MultiOutputFusion::RecomputeReachability() {
-  reachability_ = HloDfsReachability::Build(computation_);
+  reachability_ = HloGraphCycles::Build(computation_);
 }
 
 bool MultiOutputFusion::FuseSiblings(HloInstruction* parent,
@@ -347,8 +377,9 @@ bool MultiOutputFusion::FuseSiblings(HloInstruction* parent,
     for (auto j = i + 1; j != siblings.end();) {
       VLOG(3) << "Considering " << (*i)->name() << " and " << (*j)->name();
 
-      if (auto fusible = CanFuseSiblings(**i, **j, *parent, *reachability_,
-                                         fusion_info_cache, device_info_);
+      if (auto fusible =
+              CanFuseSiblings(**i, **j, *parent, *reachability_,
+                              fusion_info_cache, device_info_, cost_analysis);
           !fusible) {
         // We pick `j` arbitrarily as a consumer.
         if (dump_fusion) {
@@ -384,6 +415,7 @@ bool MultiOutputFusion::FuseSiblings(HloInstruction* parent,
                                    "| inside multi-output fusion"),
                       /*producer=*/fused);
 
+      reachability_->Merge(remaining, fused);
       if (fused->opcode() == HloOpcode::kFusion) {
         remaining->MergeFusionInstructionIntoMultiOutput(fused);
         if (fused->IsInputFusion()) {
@@ -400,7 +432,6 @@ bool MultiOutputFusion::FuseSiblings(HloInstruction* parent,
       TF_CHECK_OK(cost_analysis->RevisitInstruction(remaining));
       changed = true;
       siblings.erase(j);
-      RecomputeReachability();
     }
   }
   return changed;
@@ -474,6 +505,7 @@ absl::StatusOr<bool> MultiOutputFusion::DoMultiOutputFusion() {
               << input_fusion->name();
       TF_CHECK_OK(
           computation_->ReplaceInstruction(consumer_for_fusion, input_fusion));
+      reachability_->Replace(consumer_for_fusion, input_fusion);
     }
 
     DumpFusionState(*input_fusion,
@@ -482,6 +514,7 @@ absl::StatusOr<bool> MultiOutputFusion::DoMultiOutputFusion() {
                                  "| inside multi-output fusion"),
                     /*producer=*/producer);
 
+    reachability_->Merge(input_fusion, producer);
     if (producer->opcode() == HloOpcode::kFusion) {
       input_fusion->MergeFusionInstructionIntoMultiOutput(producer);
     } else {
@@ -494,7 +527,6 @@ absl::StatusOr<bool> MultiOutputFusion::DoMultiOutputFusion() {
     DumpFusionState(*input_fusion,
                     absl::StrCat("Fused into |", input_fusion->name(),
                                  "| inside multi-output fusion"));
-    RecomputeReachability();
   }
   return changed;
 }
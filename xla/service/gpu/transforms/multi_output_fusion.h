@@ -22,13 +22,13 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "xla/hlo/ir/hlo_computation.h"
-#include "xla/hlo/ir/hlo_dfs_reachability.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/pass/hlo_pass_interface.h"
 #include "xla/service/gpu/gpu_fusible.h"
 #include "xla/service/gpu/model/gpu_hlo_cost_analysis.h"
 #include "xla/service/hlo_cost_analysis.h"
+#include "xla/service/hlo_graph_cycles.h"
 #include "xla/stream_executor/device_description.h"
 
 namespace xla {
@@ -112,7 +112,8 @@ class MultiOutputFusion : public HloModulePass {
 
   absl::StatusOr<bool> DoMultiOutputFusion();
 
-  // Recompute reachability for the current computation.
+  // Recompute reachability for the current computation. Fusions performed by
+  // the pass update it incrementally afterwards.
   void RecomputeReachability();
 
   void DumpFusionState(const HloInstruction& consumer, absl::string_view label,
@@ -121,8 +122,8 @@ class MultiOutputFusion : public HloModulePass {
   // Computation for the pass.
   HloComputation* computation_;
 
-  // The reachability map of current computation.
-  std::unique_ptr<HloDfsReachability> reachability_;
+  // The reachability graph of current computation.
+  std::unique_ptr<HloGraphCycles> reachability_;
 
   se::DeviceDescription device_info_;
   HloCostAnalysis::ShapeSizeFunction shape_size_function_;
@@ -1316,6 +1316,109 @@ TEST_F(MultiOutputFusionTest, DoNotGroupTooManyReductions) {
   EXPECT_EQ(2, CountMultiOutputFusions(module.get()));
 }
 
+// Reductions that read the same inputs are fused beyond the limit on unnested
+// reductions if the performance model estimates the fusion to be profitable.
+TEST_F(MultiOutputFusionTest, GroupReductionsReadingSameInputs) {
+  auto module = ParseAndReturnVerifiedModule(absl::StrCat(kModulePrefix, R"(
+    fused_computation0 {
+      p0 = f32[64,64] parameter(0)
+      p1 = f32[64,64] parameter(1)
+      p2 = f32[] parameter(2)
+      add = f32[64,64] add(p0, p1)
+      ROOT reduce = f32[64] reduce(f32[64,64] add, f32[] p2), dimensions={1},
+        to_apply=scalar_add_computation
+    }
+    fused_computation1 {
+      p0 = f32[64,64] parameter(0)
+      p1 = f32[64,64] parameter(1)
+      p2 = f32[] parameter(2)
+      mul = f32[64,64] multiply(p0, p1)
+      ROOT reduce = f32[64] reduce(f32[64,64] mul, f32[] p2), dimensions={1},
+        to_apply=scalar_add_computation
+    }
+    fused_computation2 {
+      p0 = f32[64,64] parameter(0)
+      p1 = f32[64,64] parameter(1)
+      p2 = f32[] parameter(2)
+      add = f32[64,64] add(p0, p1)
+      ROOT reduce = f32[64] reduce(f32[64,64] add, f32[] p2), dimensions={1},
+        to_apply=scalar_add_computation
+    }
+    fused_computation3 {
+      p0 = f32[64,64] parameter(0)
+      p1 = f32[64,64] parameter(1)
+      p2 = f32[] parameter(2)
+      mul = f32[64,64] multiply(p0, p1)
+      ROOT reduce = f32[64] reduce(f32[64,64] mul, f32[] p2), dimensions={1},
+        to_apply=scalar_add_computation
+    }
+    fused_computation4 {
+      p0 = f32[64,64] parameter(0)
+      p1 = f32[64,64] parameter(1)
+      p2 = f32[] parameter(2)
+      add = f32[64,64] add(p0, p1)
+      ROOT reduce = f32[64] reduce(f32[64,64] add, f32[] p2), dimensions={1},
+        to_apply=scalar_add_computation
+    }
+    fused_computation5 {
+      p0 = f32[64,64] parameter(0)
+      p1 = f32[64,64] parameter(1)
+      p2 = f32[] parameter(2)
+      mul = f32[64,64] multiply(p0, p1)
+      ROOT reduce = f32[64] reduce(f32[64,64] mul, f32[] p2), dimensions={1},
+        to_apply=scalar_add_computation
+    }
+    fused_computation6 {
+      p0 = f32[64,64] parameter(0)
+      p1 = f32[64,64] parameter(1)
+      p2 = f32[] parameter(2)
+      add = f32[64,64] add(p0, p1)
+      ROOT reduce = f32[64] reduce(f32[64,64] add, f32[] p2), dimensions={1},
+        to_apply=scalar_add_computation
+    }
+    fused_computation7 {
+      p0 = f32[64,64] parameter(0)
+      p1 = f32[64,64] parameter(1)
+      p2 = f32[] parameter(2)
+      mul = f32[64,64] multiply(p0, p1)
+      ROOT reduce = f32[64] reduce(f32[64,64] mul, f32[] p2), dimensions={1},
+        to_apply=scalar_add_computation
+    }
+    fused_computation8 {
+      p0 = f32[64,64] parameter(0)
+      p1 = f32[64,64] parameter(1)
+      p2 = f32[] parameter(2)
+      add = f32[64,64] add(p0, p1)
+      ROOT reduce = f32[64] reduce(f32[64,64] add, f32[] p2), dimensions={1},
+        to_apply=scalar_add_computation
+    }
+
+    ENTRY entry {
+      zero = f32[] constant(0)
+      param0 = f32[64,64] parameter(0)
+      param1 = f32[64,64] parameter(1)
+      out0 = f32[64] fusion(param0, param1, zero), kind=kInput, calls=fused_computation0
+      out1 = f32[64] fusion(param0, param1, zero), kind=kInput, calls=fused_computation1
+      out2 = f32[64] fusion(param0, param1, zero), kind=kInput, calls=fused_computation2
+      out3 = f32[64] fusion(param0, param1, zero), kind=kInput, calls=fused_computation3
+      out4 = f32[64] fusion(param0, param1, zero), kind=kInput, calls=fused_computation4
+      out5 = f32[64] fusion(param0, param1, zero), kind=kInput, calls=fused_computation5
+      out6 = f32[64] fusion(param0, param1, zero), kind=kInput, calls=fused_computation6
+      out7 = f32[64] fusion(param0, param1, zero), kind=kInput, calls=fused_computation7
+      out8 = f32[64] fusion(param0, param1, zero), kind=kInput, calls=fused_computation8
+      ROOT out = (f32[64], f32[64], f32[64], f32[64], f32[64], f32[64], f32[64], f32[64], f32[64]) tuple(f32[64] out0, f32[64] out1, f32[64] out2, f32[64] out3, f32[64] out4, f32[64] out5, f32[64] out6, f32[64] out7, f32[64] out8)
+    }
+  )"))
+                    .value();
+  ASSERT_TRUE(mof_.Run(module.get()).value());
+
+  EXPECT_EQ(1, CountMultiOutputFusions(module.get()));
+  const HloInstruction* fusion =
+      module->entry_computation()->root_instruction()->operand(0)->operand(0);
+  ASSERT_EQ(fusion->opcode(), HloOpcode::kFusion);
+  EXPECT_EQ(fusion->shape().tuple_shapes_size(), 9);
+}
+
 TEST_F(MultiOutputFusionTest, NoFusionToAvoidUsingTooMuchSharedMemory) {
   auto module = ParseAndReturnVerifiedModule(R"(
   HloModule xla_computation_update_step.10931
@@ -15,10 +15,10 @@ limitations under the License.
 
 #include "xla/service/gpu/transforms/priority_fusion.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
-#include <iterator>
 #include <map>
 #include <memory>
 #include <string>
@@ -26,6 +26,7 @@ limitations under the License.
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -36,6 +37,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "llvm/ADT/STLExtras.h"
 #include "mlir/IR/MLIRContext.h"
 #include "xla/debug_options_flags.h"
@@ -149,6 +151,7 @@ class PriorityFusionQueue {
                       mlir::MLIRContext* mlir_context,
                       HloFusionAnalysisCache& fusion_analysis_cache,
                       FusionDeduplicationCache& fusion_deduplication_cache,
+                      PersistentGpuPerformanceModelCache* persistent_cache,
                       bool triton_softmax_priority_fusion_enabled)
       : computation_(computation),
         device_info_(device_info),
@@ -161,6 +164,7 @@ class PriorityFusionQueue {
         mlir_context_(mlir_context),
         fusion_analysis_cache_(fusion_analysis_cache),
         fusion_deduplication_cache_(fusion_deduplication_cache),
+        persistent_cache_(persistent_cache),
         triton_softmax_priority_fusion_enabled_(
             triton_softmax_priority_fusion_enabled) {
     VLOG(2) << "Running full HLO cost analysis for " << computation_->name();
@@ -238,32 +242,66 @@ class PriorityFusionQueue {
     return priorities;
   }
 
-  // Gets the next pair of (producer, consumers) from the queue for fusion.
-  // Returns true if there is the next producer to fuse, otherwise false. Stores
-  // the producer and consumers in `current_producer_` and `current_consumers_`.
-  bool DequeueNextProducer() {
-    current_producer_ = nullptr;
-    current_consumers_.clear();
-
-    while (!producer_priority_queue_.empty() && current_consumers_.empty()) {
-      auto next_it = std::prev(producer_priority_queue_.end());
-
-      current_producer_ = next_it->second;
-      producer_priority_queue_.erase(next_it);
-      reverse_map_.erase(current_producer_);
+  // A producer dequeued for fusion and the consumers to fuse it into.
+  struct FusionCandidate {
+    HloInstruction* producer;
+    std::vector<HloInstruction*> consumers;
+  };
+
+  // Dequeues up to `max_num_candidates` producers with the highest priorities
+  // for fusion. The first candidate is always the producer with the highest
+  // priority. Further candidates are only taken if their neighborhoods don't
+  // overlap with the neighborhoods of the candidates taken before them, so
+  // fusing one candidate neither invalidates the instructions referenced by the
+  // others nor changes their priorities. All candidates can then be fused in
+  // one round followed by a single priority update. Producers that were skipped
+  // stay in the queue. The result only depends on the queue order, so it is
+  // deterministic. Returns an empty vector if there is nothing left to fuse.
+  std::vector<FusionCandidate> DequeueNextCandidates(
+      int64_t max_num_candidates) {
+    std::vector<FusionCandidate> candidates;
+    absl::flat_hash_set<const HloInstruction*> claimed;
+
+    // Bounds the number of producers skipped per round, so that we don't scan
+    // the whole queue when the top producers all interfere with each other.
+    int64_t num_skipped = 0;
+    const int64_t max_num_skipped = 4 * max_num_candidates;
+
+    auto it = producer_priority_queue_.end();
+    while (it != producer_priority_queue_.begin() &&
+           candidates.size() < max_num_candidates &&
+           (candidates.empty() || num_skipped < max_num_skipped)) {
+      --it;
+      HloInstruction* producer = it->second;
+
+      std::vector<const HloInstruction*> neighborhood =
+          GetNeighborhood(producer);
+      if (!candidates.empty() &&
+          absl::c_any_of(neighborhood, [&](const HloInstruction* instr) {
+            return claimed.contains(instr);
+          })) {
+        ++num_skipped;
+        continue;
+      }
 
-      current_consumers_ = current_producer_->users();
+      it = producer_priority_queue_.erase(it);
+      reverse_map_.erase(producer);
 
-      if (current_producer_->opcode() == HloOpcode::kBitcast) {
+      std::vector<HloInstruction*> consumers = producer->users();
+      if (producer->opcode() == HloOpcode::kBitcast) {
         // We don't check if bitcasts can be fused with all consumers, so we
         // have to do it here.
-        llvm::erase_if(current_consumers_, [&](HloInstruction* consumer) {
-          return !CanFuseCached(current_producer_, consumer);
+        llvm::erase_if(consumers, [&](HloInstruction* consumer) {
+          return !CanFuseCached(producer, consumer);
         });
       }
+      if (consumers.empty()) continue;
+
+      claimed.insert(neighborhood.begin(), neighborhood.end());
+      candidates.push_back({producer, std::move(consumers)});
     }
 
-    return !current_consumers_.empty();
+    return candidates;
   }
 
   absl::Status UpdatePerformanceModelCache(HloInstruction* producer) {
@@ -283,8 +321,9 @@ class PriorityFusionQueue {
           gpu_indexing_performance_model_.EstimateRunTimeForTriton(producer));
     } else {
       auto config = GpuPerformanceModelOptions::PriorityFusion(
-          &fusion_analysis_cache_, &gpu_performance_model_cache_);
-      runtime_data = GpuPerformanceModel::EstimateRunTimeForInstruction(
+          &fusion_analysis_cache_, &gpu_performance_model_cache_,
+          persistent_cache_);
+      runtime_data = GpuPerformanceModel::EstimateRunTimeForInstructionCached(
           producer, *device_info_, &cost_analysis_, config);
     }
 
@@ -362,13 +401,17 @@ class PriorityFusionQueue {
     }
   }
 
-  // Prepare for incremental updates
-  void ComputeRuntimesOfRemovedConsumers() {
+  // Prepare for incremental updates after `producer` was fused into
+  // `consumers`.
+  void ComputeRuntimesOfRemovedConsumers(
+      HloInstruction* producer, absl::Span<HloInstruction* const> consumers) {
     for (const auto& pair : operands_to_new_consumers_) {
       auto operand = pair.first;
       // Checks if this producer's priority was calculated before. If so, we can
-      // do incremental update here.
-      if (!reverse_map_.contains(operand)) {
+      // do incremental update here. Operands of fusions of other candidates in
+      // the same round were already handled.
+      if (!reverse_map_.contains(operand) ||
+          operands_to_removed_consumers_runtimes_.contains(operand)) {
         continue;
       }
       // Get all of this producer's original consumers. Bitcast/constant have
@@ -379,10 +422,10 @@ class PriorityFusionQueue {
       const auto& original_consumers =
           gpu_performance_model_cache_.GetAllConsumers(*operand);
       GpuPerformanceModel::RunTimes runtimes;
-      for (auto consumer : current_consumers()) {
+      for (auto consumer : consumers) {
         UpdateRuntimes(runtimes, consumer, original_consumers);
       }
-      UpdateRuntimes(runtimes, current_producer(), original_consumers);
+      UpdateRuntimes(runtimes, producer, original_consumers);
       auto operand_cache_result = gpu_performance_model_cache_.Get(*operand);
       runtimes.time_unfused += (*operand_cache_result).exec_time +
                                GpuPerformanceModel::kKernelLaunchOverhead;
@@ -465,13 +508,23 @@ class PriorityFusionQueue {
     return it->second;
   }
 
-  HloInstruction* current_producer() { return current_producer_; }
-
-  const std::vector<HloInstruction*>& current_consumers() {
-    return current_consumers_;
+ private:
+  // Returns the instructions that are modified by fusing `producer` into its
+  // users, or whose state is used to compute the priority of `producer`: the
+  // producer itself, its users, and the operands of both.
+  std::vector<const HloInstruction*> GetNeighborhood(
+      const HloInstruction* producer) {
+    std::vector<const HloInstruction*> neighborhood = {producer};
+    neighborhood.insert(neighborhood.end(), producer->operands().begin(),
+                        producer->operands().end());
+    for (const HloInstruction* user : producer->users()) {
+      neighborhood.push_back(user);
+      neighborhood.insert(neighborhood.end(), user->operands().begin(),
+                          user->operands().end());
+    }
+    return neighborhood;
   }
 
- private:
   // Returns the priority of the producer based on its current operands and
   // users.
   Priority CalculateProducerPriority(HloInstruction* producer) {
@@ -511,7 +564,8 @@ class PriorityFusionQueue {
         GpuPerformanceModel::EstimateRunTimesForPriorityFusion(
             producer, *device_info_, &cost_analysis_,
             GpuPerformanceModelOptions::PriorityFusion(
-                &fusion_analysis_cache_, &gpu_performance_model_cache_),
+                &fusion_analysis_cache_, &gpu_performance_model_cache_,
+                persistent_cache_),
             fused_consumers);
     Priority current_priority;
     if (is_incremental_update) {
@@ -819,17 +873,11 @@ class PriorityFusionQueue {
   // A reverse map that helps find an instruction in the priority queue.
   absl::flat_hash_map<HloInstruction*, PriorityQueue::iterator> reverse_map_;
 
-  // The current producer being visited.
-  HloInstruction* current_producer_;
-
-  // The current consumers being visited.
-  std::vector<HloInstruction*> current_consumers_;
-
   // The set of producers whose priorities need to be updated. Their
   // priorities are changed because their neighbors got fused, but we delay
-  // the priority updates until current_consumers_ becomes empty. This is to
-  // avoid recomputing priorities multiple times before we dequeue a new
-  // producer.
+  // the priority updates until all candidates of the current round are fused.
+  // This is to avoid recomputing priorities multiple times before we dequeue
+  // new producers, and lets us compute all of them in parallel.
   absl::flat_hash_set<HloInstruction*> to_update_priority_;
   absl::flat_hash_map<HloInstruction*, std::vector<HloInstruction*>>
       operands_to_new_consumers_;
@@ -849,6 +897,10 @@ class PriorityFusionQueue {
   FusionDeduplicationCache& fusion_deduplication_cache_;
   absl::Mutex fusion_deduplication_cache_mutex_;
 
+  // Cache of performance model estimates shared across compilations. Can be
+  // null.
+  PersistentGpuPerformanceModelCache* persistent_cache_;
+
   // Caches result of can_fuse for a (producer, consumer) pair. A cache entry is
   // invalidated if producer or consumer is modified.
   absl::flat_hash_map<
@@ -949,6 +1001,24 @@ absl::StatusOr<bool> PriorityFusion::Run(
   FusionDeduplicationCache fusion_deduplication_cache =
       FusionDeduplicationCache::Create(*module);
 
+  const std::string& performance_model_cache_file =
+      module->config()
+          .debug_options()
+          .xla_gpu_experimental_performance_model_cache_file();
+  PersistentGpuPerformanceModelCache* persistent_cache =
+      performance_model_cache_file.empty()
+          ? nullptr
+          : PersistentGpuPerformanceModelCache::GetOrLoad(
+                performance_model_cache_file, device_info_);
+
+  // Number of non-interfering producers fused per round before priorities are
+  // recomputed. With a value of 1 every fusion is followed by a priority
+  // update, which is the exact greedy order.
+  int64_t max_num_candidates_per_round = std::max<int64_t>(
+      1, module->config()
+             .debug_options()
+             .xla_gpu_priority_fusion_max_candidates_per_round());
+
   int changed = false;
   for (auto* computation : fusible_computations) {
     CHECK(!computation->IsFusionComputation());
@@ -957,55 +1027,60 @@ absl::StatusOr<bool> PriorityFusion::Run(
         computation, cost_analysis_options_, &device_info_,
         fusion_process_dump_.get(), thread_pool_, &mlir_context_,
         fusion_analysis_cache_, fusion_deduplication_cache,
-        triton_softmax_priority_fusion_enabled);
+        persistent_cache, triton_softmax_priority_fusion_enabled);
+
+    while (true) {
+      std::vector<PriorityFusionQueue::FusionCandidate> candidates =
+          fusion_queue->DequeueNextCandidates(max_num_candidates_per_round);
+      if (candidates.empty()) break;
+
+      for (const auto& [producer, consumers] : candidates) {
+        absl::flat_hash_map<const HloInstruction*, BlockLevelParameters>
+            block_level_parameters_map =
+                fusion_queue->GetBlockLevelParametersMap(producer);
+
+        for (auto* consumer : consumers) {
+          // Don't fuse into single bitcasts. We ignore them in the check
+          // CanFuseWithAllNonBitcastUsers(), so we need to check it here.
+          if (consumer->opcode() == HloOpcode::kBitcast) {
+            continue;
+          }
+          if (!ConsumeFuel(producer, consumer)) continue;
+
+          VLOG(5) << "next: " << consumer->name() << "(" << consumer << ") + "
+                  << producer->name() << "(" << producer << ")";
+
+          int64_t consumer_operand_index = consumer->operand_index(producer);
+
+          fusion_queue->PreFusion(producer, consumer);
+          auto fusion_instruction = Fuse(producer, consumer);
+          fusion_deduplication_cache.UpdateFusedInstructionId(
+              *fusion_instruction, *producer, *consumer,
+              consumer_operand_index);
+          fusion_queue->OnFusingInstruction(fusion_instruction, producer,
+                                            consumer);
+
+          auto backend_config_it = block_level_parameters_map.find(consumer);
+          if (backend_config_it != block_level_parameters_map.end()) {
+            TF_RETURN_IF_ERROR(fusion_instruction->set_backend_config(
+                GetTritonGpuBackendConfig(backend_config_it->second)));
+          }
 
-    while (fusion_queue->DequeueNextProducer()) {
-      auto producer = fusion_queue->current_producer();
-
-      absl::flat_hash_map<const HloInstruction*, BlockLevelParameters>
-          block_level_parameters_map =
-              fusion_queue->GetBlockLevelParametersMap(producer);
-
-      for (auto* consumer : fusion_queue->current_consumers()) {
-        // Don't fuse into single bitcasts. We ignore them in the check
-        // CanFuseWithAllNonBitcastUsers(), so we need to check it here.
-        if (consumer->opcode() == HloOpcode::kBitcast) {
-          continue;
+          changed = true;
         }
-        if (!ConsumeFuel(producer, consumer)) continue;
 
-        VLOG(5) << "next: " << consumer->name() << "(" << consumer << ") + "
-                << producer->name() << "(" << producer << ")";
-
-        int64_t consumer_operand_index = consumer->operand_index(producer);
-
-        fusion_queue->PreFusion(producer, consumer);
-        auto fusion_instruction = Fuse(producer, consumer);
-        fusion_deduplication_cache.UpdateFusedInstructionId(
-            *fusion_instruction, *producer, *consumer, consumer_operand_index);
-        fusion_queue->OnFusingInstruction(fusion_instruction, producer,
-                                          consumer);
-
-        auto backend_config_it = block_level_parameters_map.find(consumer);
-        if (backend_config_it != block_level_parameters_map.end()) {
-          TF_RETURN_IF_ERROR(fusion_instruction->set_backend_config(
-              GetTritonGpuBackendConfig(backend_config_it->second)));
+        fusion_queue->ComputeRuntimesOfRemovedConsumers(producer, consumers);
+        if (producer->user_count() == 0) {
+          fusion_queue->InvalidateCaches(producer);
+          producer->DetachFromOperandsAndUsers();
+          fusion_queue->RemoveInstruction(producer);
+          // Remove from computation.
+          TF_RETURN_IF_ERROR(computation->RemoveInstruction(producer));
         }
 
-        changed = true;
-      }
-
-      fusion_queue->ComputeRuntimesOfRemovedConsumers();
-      if (producer->user_count() == 0) {
-        fusion_queue->InvalidateCaches(producer);
-        producer->DetachFromOperandsAndUsers();
-        fusion_queue->RemoveInstruction(producer);
-        // Remove from computation.
-        TF_RETURN_IF_ERROR(computation->RemoveInstruction(producer));
-      }
-
-      for (auto* consumer : fusion_queue->current_consumers()) {
-        fusion_queue->InvalidateCaches(consumer);
+        for (auto* consumer : consumers) {
+          fusion_queue->InvalidateCaches(consumer);
+        }
       }
       TF_RETURN_IF_ERROR(fusion_queue->UpdatePriorities());
     }
@@ -1038,6 +1113,15 @@ absl::StatusOr<bool> PriorityFusion::Run(
     }
   }
 
+  if (persistent_cache != nullptr) {
+    if (absl::Status status =
+            persistent_cache->SaveToFile(performance_model_cache_file);
+        !status.ok()) {
+      LOG(WARNING) << "Failed to write GPU performance model cache to "
+                   << performance_model_cache_file << ": " << status;
+    }
+  }
+
   // FusionAnalysis cache uses unique_id as key. IDs are only unique inside one
   // module. It's important to fully clear the cache if the same instance of the
   // pass will be called on a different module.
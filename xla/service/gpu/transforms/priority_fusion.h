@@ -31,6 +31,7 @@ limitations under the License.
 #include "xla/service/gpu/fusion_process_dump.pb.h"
 #include "xla/service/gpu/model/fusion_analysis_cache.h"
 #include "xla/service/gpu/model/gpu_hlo_cost_analysis.h"
+#include "xla/service/gpu/model/indexing_map.h"
 #include "xla/service/hlo_cost_analysis.h"
 #include "xla/stream_executor/device_description.h"
 #include "xla/xla_data.pb.h"
@@ -47,7 +48,8 @@ class PriorityFusion : public HloModulePass {
       : thread_pool_(thread_pool),
         device_info_(device),
         cost_analysis_options_(std::move(cost_analysis_options)),
-        fusion_analysis_cache_(device_info_) {}
+        fusion_analysis_cache_(device_info_),
+        indexing_map_cache_(&mlir_context_) {}
 
   absl::string_view name() const override { return "priority-fusion"; }
 
@@ -80,6 +82,10 @@ class PriorityFusion : public HloModulePass {
   HloFusionAnalysisCache fusion_analysis_cache_;
 
   mlir::MLIRContext mlir_context_;
+
+  // Memoizes indexing map simplifications for `mlir_context_`. Must be
+  // destroyed before the context.
+  IndexingMapCache indexing_map_cache_;
 };
 
 }  // namespace gpu
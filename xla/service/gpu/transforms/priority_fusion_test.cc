@@ -158,6 +158,33 @@ CHECK-NEXT: ROOT {{.*}} tuple(%[[FUSION_0]], %[[FUSION_1]])
   )");
 }
 
+TEST_F(PriorityFusionTest, FusesIndependentProducersInOneRound) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+    HloModule test_module
+
+    ENTRY main {
+      p0 = f32[16384]{0} parameter(0)
+      p1 = f32[16384]{0} parameter(1)
+      e0 = f32[16384]{0} exponential(p0)
+      l0 = f32[16384]{0} log(e0)
+      n0 = f32[16384]{0} negate(l0)
+      e1 = f32[16384]{0} exponential(p1)
+      l1 = f32[16384]{0} log(e1)
+      n1 = f32[16384]{0} negate(l1)
+      ROOT t = (f32[16384], f32[16384]) tuple(n0, n1)
+    })")
+                    .value();
+  module->mutable_config()
+      .mutable_debug_options()
+      .set_xla_gpu_priority_fusion_max_candidates_per_round(8);
+
+  EXPECT_THAT(priority_fusion_.Run(module.get()), IsOkAndHolds(true));
+
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, GmockMatch(m::Tuple(m::Fusion(m::Parameter(0)),
+                                        m::Fusion(m::Parameter(1)))));
+}
+
 TEST_F(PriorityFusionTest, FuseBroadcastIntoBitcastConsumers) {
   absl::string_view kHlo = R"(
     HloModule test_module
@@ -29,7 +29,8 @@ namespace gpu {
 
 // Rewrites sort operations into CustomCall HLOs that call into CUB.
 // Only a subset of shapes is supported - either a single tensor with a simple
-// compare function or a pair of tensors where keys are unsigned integers.
+// compare function or a pair of tensors where keys are unsigned integers, or
+// f16/f32/s32 with 32-bit values (e.g. scores sorted together with an iota).
 
 class SortRewriter : public HloModulePass {
  public:
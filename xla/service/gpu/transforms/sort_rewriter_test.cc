@@ -410,6 +410,37 @@ ENTRY %main {
                                   m::GetTupleElement(m::CustomCall(), 1))));
 }
 
+// Sort floating point scores together with their indices, like top-p
+// sampling does for every row of a batch.
+TEST_F(SortRewriterTest, SortPairsFloatKeysWithBatchDim) {
+  constexpr char kHlo[] = R"(
+HloModule TestModule
+
+%compare {
+  %lhs = f32[] parameter(0)
+  %rhs = f32[] parameter(1)
+  %lhs_index = s32[] parameter(2)
+  %rhs_index = s32[] parameter(3)
+  ROOT %gt = pred[] compare(%lhs, %rhs), direction=GT
+}
+
+ENTRY %main {
+  %scores = f32[100,256] parameter(0)
+  %iota = s32[100,256] iota(), iota_dimension=1
+  ROOT %sort = (f32[100,256], s32[100,256]) sort(%scores, %iota),
+      dimensions={1}, to_apply=%compare
+})";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  EXPECT_TRUE(RunModuleAndPass(module.get()));
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Tuple(m::GetTupleElement(m::CustomCall(), 0),
+                                  m::GetTupleElement(m::CustomCall(), 1))));
+  ExpectDirection(
+      module->entry_computation()->root_instruction()->operand(0)->operand(0),
+      /*descending=*/true);
+}
+
 // Sort a pair of tensors (values, indices generated by iota) with a complex
 // compare computation that matches the output of the StableSortExpander pass.
 TEST_F(SortRewriterTest, SortPairsIotaComparerLikeStableSortExpander) {
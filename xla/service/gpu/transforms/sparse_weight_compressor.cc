@@ -0,0 +1,235 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/transforms/sparse_weight_compressor.h"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/dfs_hlo_visitor_with_default.h"
+#include "xla/hlo/ir/hlo_casting_utils.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/layout_util.h"
+#include "xla/literal.h"
+#include "xla/service/gpu/fusions/triton/triton_support_legacy.h"
+#include "xla/service/hlo_creation_utils.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/stream_executor/device_description.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// 2:4 sparsity: two values are kept out of every group of four.
+constexpr int kGroupSize = 4;
+constexpr int kKeptPerGroup = 2;
+// Each u16 metadata element holds four 2+2 bit index pairs, i.e. it describes
+// 16 dense elements along the sparse dimension.
+constexpr int kDenseElementsPerMeta = 16;
+
+bool IsZero(uint16_t bits) {
+  // Both F16 and BF16 keep the sign in the top bit.
+  return (bits & 0x7fff) == 0;
+}
+
+// Returns the two sorted positions of the group that are kept, or false if the
+// group has more than two non-zero values. Groups with fewer non-zeros are
+// padded with the lowest zero positions.
+bool SelectGroup(const uint16_t* group, std::array<int, kKeptPerGroup>& kept) {
+  int num_kept = 0;
+  for (int i = 0; i < kGroupSize; ++i) {
+    if (!IsZero(group[i])) {
+      if (num_kept == kKeptPerGroup) return false;
+      kept[num_kept++] = i;
+    }
+  }
+  for (int i = 0; i < kGroupSize && num_kept < kKeptPerGroup; ++i) {
+    if (IsZero(group[i])) {
+      kept[num_kept++] = i;
+    }
+  }
+  if (kept[0] > kept[1]) std::swap(kept[0], kept[1]);
+  return true;
+}
+
+// Compresses a row-major [rows, cols] literal of 16-bit floats along its minor
+// dimension. Returns false if the literal is not 2:4 sparse.
+bool Compress(const Literal& dense, Literal& values, Literal& meta) {
+  const Shape& shape = dense.shape();
+  const int64_t rows = shape.dimensions(0);
+  const int64_t cols = shape.dimensions(1);
+  const auto* in = static_cast<const uint16_t*>(dense.untyped_data());
+  auto* out = static_cast<uint16_t*>(values.untyped_data());
+  auto* out_meta = static_cast<uint16_t*>(meta.untyped_data());
+
+  for (int64_t row = 0; row < rows; ++row) {
+    for (int64_t col = 0; col < cols; col += kDenseElementsPerMeta) {
+      uint16_t bits = 0;
+      for (int g = 0; g < kDenseElementsPerMeta / kGroupSize; ++g) {
+        const uint16_t* group = in + row * cols + col + g * kGroupSize;
+        std::array<int, kKeptPerGroup> kept;
+        if (!SelectGroup(group, kept)) return false;
+        bits |= (kept[0] | (kept[1] << 2)) << (g * 4);
+        *out++ = group[kept[0]];
+        *out++ = group[kept[1]];
+      }
+      *out_meta++ = bits;
+    }
+  }
+  return true;
+}
+
+class SparseWeightCompressorVisitor : public DfsHloRewriteVisitor {
+ public:
+  SparseWeightCompressorVisitor(
+      const se::GpuComputeCapability& compute_capability,
+      int64_t min_weight_elements)
+      : compute_capability_(compute_capability),
+        min_weight_elements_(min_weight_elements) {}
+
+  absl::Status HandleDot(HloInstruction* instr) override {
+    HloDotInstruction* dot = Cast<HloDotInstruction>(instr);
+    if (dot->sparse_operands() != 0) {
+      return absl::OkStatus();
+    }
+    // Weights are usually the RHS, so try it first.
+    for (int operand_index : {1, 0}) {
+      if (dot->operand(operand_index)->opcode() != HloOpcode::kConstant) {
+        continue;
+      }
+      absl::string_view reason = CheckCandidate(*dot, operand_index);
+      if (reason.empty()) {
+        TF_ASSIGN_OR_RETURN(bool compressed, TryCompress(dot, operand_index));
+        if (compressed) return absl::OkStatus();
+        reason = "constant is not 2:4 sparse";
+      }
+      VLOG(2) << "Not compressing operand " << operand_index << " of "
+              << dot->name() << ": " << reason;
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // Returns an empty string if the constant operand can be compressed into a
+  // sparse dot that the Triton GEMM emitter supports, or the reason why not.
+  absl::string_view CheckCandidate(const HloDotInstruction& dot,
+                                   int operand_index) {
+    const Shape& shape = dot.operand(operand_index)->shape();
+    const DotDimensionNumbers& dnums = dot.dot_dimension_numbers();
+    if (shape.element_type() != F16 && shape.element_type() != BF16) {
+      return "only F16 and BF16 weights are supported";
+    }
+    if (shape.rank() != 2 ||
+        dot.operand(1 - operand_index)->shape().rank() != 2 ||
+        dnums.lhs_batch_dimensions_size() != 0 ||
+        dnums.lhs_contracting_dimensions_size() != 1) {
+      return "only rank-2 dots without batch dimensions are supported";
+    }
+    int64_t contracting_dim = operand_index == 0
+                                  ? dnums.lhs_contracting_dimensions(0)
+                                  : dnums.rhs_contracting_dimensions(0);
+    if (contracting_dim != 1 ||
+        !LayoutUtil::IsMonotonicWithDim0Major(shape.layout())) {
+      return "contracting dimension is not the minor one";
+    }
+    if (shape.dimensions(1) % kDenseElementsPerMeta != 0) {
+      return "contracting dimension is not a multiple of 16";
+    }
+    if (ShapeUtil::ElementsIn(shape) < min_weight_elements_) {
+      return "weight is too small";
+    }
+    if (CodegenDecision decision =
+            legacy_triton::CanTritonHandleGEMM(dot, compute_capability_);
+        !decision) {
+      VLOG(3) << decision.Explain();
+      return "dot is not supported by Triton";
+    }
+    return "";
+  }
+
+  absl::StatusOr<bool> TryCompress(HloDotInstruction* dot, int operand_index) {
+    const HloInstruction* weight = dot->operand(operand_index);
+    const Shape& shape = weight->shape();
+    const int64_t rows = shape.dimensions(0);
+    const int64_t cols = shape.dimensions(1);
+
+    Literal values(ShapeUtil::MakeShapeWithDenseLayout(
+        shape.element_type(), {rows, cols * kKeptPerGroup / kGroupSize},
+        {1, 0}));
+    Literal meta(ShapeUtil::MakeShapeWithDenseLayout(
+        U16, {rows, cols / kDenseElementsPerMeta}, {1, 0}));
+    if (!Compress(weight->literal(), values, meta)) {
+      return false;
+    }
+
+    HloComputation* computation = dot->parent();
+    HloInstruction* values_hlo = computation->AddInstruction(
+        HloInstruction::CreateConstant(std::move(values)));
+    HloInstruction* meta_hlo = computation->AddInstruction(
+        HloInstruction::CreateConstant(std::move(meta)));
+
+    SparsityDescriptor sparsity;
+    sparsity.set_type(SparsityType::SPARSITY_STRUCTURED_N_M);
+    sparsity.set_index(operand_index);
+    sparsity.set_dimension(1);
+    sparsity.set_n(kKeptPerGroup);
+    sparsity.set_m(kGroupSize);
+
+    HloInstruction* lhs =
+        operand_index == 0 ? values_hlo : dot->mutable_operand(0);
+    HloInstruction* rhs =
+        operand_index == 1 ? values_hlo : dot->mutable_operand(1);
+    TF_ASSIGN_OR_RETURN(
+        HloInstruction * sparse_dot,
+        MakeDotHlo(lhs, rhs, dot->dot_dimension_numbers(),
+                   dot->precision_config(), dot->shape().element_type(),
+                   {std::move(sparsity)}, {meta_hlo}));
+    dot->SetupDerivedInstruction(sparse_dot);
+    *sparse_dot->mutable_shape() = dot->shape();
+
+    VLOG(2) << "Compressed operand " << operand_index << " of " << dot->name()
+            << " into 2:4 sparse format";
+    TF_RETURN_IF_ERROR(ReplaceInstruction(dot, sparse_dot));
+    return true;
+  }
+
+  se::GpuComputeCapability compute_capability_;
+  int64_t min_weight_elements_;
+};
+
+}  // namespace
+
+absl::StatusOr<bool> SparseWeightCompressor::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  return SparseWeightCompressorVisitor(compute_capability_,
+                                       min_weight_elements_)
+      .RunOnModule(module, execution_threads);
+}
+
+}  // namespace gpu
+}  // namespace xla
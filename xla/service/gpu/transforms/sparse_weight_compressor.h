@@ -0,0 +1,64 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_TRANSFORMS_SPARSE_WEIGHT_COMPRESSOR_H_
+#define XLA_SERVICE_GPU_TRANSFORMS_SPARSE_WEIGHT_COMPRESSOR_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/pass/hlo_pass_interface.h"
+#include "xla/stream_executor/device_description.h"
+
+namespace xla {
+namespace gpu {
+
+// Turns dense dots with a constant operand that happens to be 2:4 sparse along
+// the contracting dimension into sparse dots. The constant is replaced with its
+// compressed values and a u16 metadata constant, so that the dot takes the
+// Triton sparse GEMM path. Has to run before DotSparsityRewriter, which moves
+// a sparse RHS to the LHS.
+//
+// Only rank-2 F16/BF16 weights whose contracting dimension is the minor one are
+// compressed. The reason a candidate is skipped is logged at VLOG(2).
+class SparseWeightCompressor : public HloModulePass {
+ public:
+  // Weights with fewer elements than `min_weight_elements` are left dense: the
+  // metadata loads outweigh the saved math for small GEMMs.
+  explicit SparseWeightCompressor(
+      const se::GpuComputeCapability& compute_capability,
+      int64_t min_weight_elements = 64 * 1024)
+      : compute_capability_(compute_capability),
+        min_weight_elements_(min_weight_elements) {}
+
+  absl::string_view name() const override { return "sparse-weight-compressor"; }
+
+  using HloPassInterface::Run;
+  absl::StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  se::GpuComputeCapability compute_capability_;
+  int64_t min_weight_elements_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_GPU_TRANSFORMS_SPARSE_WEIGHT_COMPRESSOR_H_
@@ -0,0 +1,138 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/transforms/sparse_weight_compressor.h"
+
+#include <cstdint>
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "xla/hlo/ir/hlo_casting_utils.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/stream_executor/device_description.h"
+#include "xla/tests/hlo_test_base.h"
+#include "xla/types.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+using ::testing::ElementsAre;
+
+class SparseWeightCompressorTest : public HloTestBase {
+ public:
+  SparseWeightCompressorTest()
+      : HloTestBase(/*verifier_layout_sensitive=*/true) {}
+
+ protected:
+  SparseWeightCompressor MakePass() {
+    return SparseWeightCompressor(
+        se::CudaComputeCapability{se::CudaComputeCapability::AMPERE, 0},
+        /*min_weight_elements=*/0);
+  }
+};
+
+TEST_F(SparseWeightCompressorTest, CompressesSparseRhsConstant) {
+  const char* module_string = R"(
+HloModule m
+
+ENTRY e {
+  lhs = f16[4,16] parameter(0)
+  rhs = f16[2,16] constant({
+    {1, 0, 2, 0, 0, 0, 3, 4, 5, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}})
+  ROOT dot = f16[4,2] dot(lhs, rhs),
+    lhs_contracting_dims={1}, rhs_contracting_dims={1}
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool modified, MakePass().Run(module.get()));
+  EXPECT_TRUE(modified);
+
+  const HloDotInstruction* dot = DynCast<HloDotInstruction>(
+      module->entry_computation()->root_instruction());
+  ASSERT_TRUE(dot != nullptr);
+  ASSERT_EQ(dot->sparse_operands(), 1);
+  EXPECT_EQ(dot->sparsity().front().index(), 1);
+  EXPECT_EQ(dot->sparsity().front().dimension(), 1);
+  EXPECT_EQ(dot->sparsity().front().n(), 2);
+  EXPECT_EQ(dot->sparsity().front().m(), 4);
+
+  const HloInstruction* values = dot->operand(1);
+  ASSERT_EQ(values->opcode(), HloOpcode::kConstant);
+  EXPECT_THAT(values->shape().dimensions(), ElementsAre(2, 8));
+  EXPECT_EQ(values->literal().Get<half>({0, 3}), half(4));
+  EXPECT_EQ(values->literal().Get<half>({0, 4}), half(5));
+  EXPECT_EQ(values->literal().Get<half>({1, 1}), half(1));
+
+  // Index pairs per group of four: row 0 keeps (0,2), (2,3), (0,1) and (0,1),
+  // row 1 keeps (1,3) and then (0,1) for the all-zero groups.
+  const HloInstruction* meta = dot->operand(2);
+  ASSERT_EQ(meta->opcode(), HloOpcode::kConstant);
+  EXPECT_THAT(meta->shape().dimensions(), ElementsAre(2, 1));
+  EXPECT_EQ(meta->literal().Get<uint16_t>({0, 0}), 0x44e8);
+  EXPECT_EQ(meta->literal().Get<uint16_t>({1, 0}), 0x444d);
+}
+
+TEST_F(SparseWeightCompressorTest, SkipsDenseConstant) {
+  const char* module_string = R"(
+HloModule m
+
+ENTRY e {
+  lhs = f16[4,16] parameter(0)
+  rhs = f16[2,16] constant({
+    {1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}})
+  ROOT dot = f16[4,2] dot(lhs, rhs),
+    lhs_contracting_dims={1}, rhs_contracting_dims={1}
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool modified, MakePass().Run(module.get()));
+  EXPECT_FALSE(modified);
+}
+
+TEST_F(SparseWeightCompressorTest, SkipsMajorContractingDimension) {
+  const char* module_string = R"(
+HloModule m
+
+ENTRY e {
+  lhs = f16[4,16] parameter(0)
+  rhs = f16[16,2] constant({
+    {1, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0},
+    {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 1}})
+  ROOT dot = f16[4,2] dot(lhs, rhs),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool modified, MakePass().Run(module.get()));
+  EXPECT_FALSE(modified);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <initializer_list>
 #include <string>
 
@@ -33,19 +35,30 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_instructions.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/primitive_util.h"
+#include "xla/service/gpu/kernels/topk_custom_kernel.h"
 #include "xla/service/hlo.pb.h"
 #include "xla/service/tuple_util.h"
 #include "xla/shape.h"
+#include "xla/shape_util.h"
 #include "xla/status_macros.h"
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
+#include "tsl/platform/statusor.h"
 
 namespace xla {
 namespace gpu {
 
 namespace {
 
-absl::StatusOr<HloInstruction*> SmallBufferOptimization(
+struct TopkDimensions {
+  size_t batch_size;
+  size_t n;
+  size_t k;
+};
+
+// Returns the dimensions of a TopK that the GPU kernels can handle, given a
+// small enough `k`.
+absl::StatusOr<TopkDimensions> GetSupportedDimensions(
     HloCustomCallInstruction* topk) {
   Shape data_shape = topk->operand(0)->shape();
   auto supported_dtypes = {F32, BF16};
@@ -60,20 +73,24 @@ absl::StatusOr<HloInstruction*> SmallBufferOptimization(
                            data_shape.ToString());
   }
   bool has_batch = data_shape.dimensions_size() == 2;
-  constexpr size_t max_k = 16;
   constexpr size_t min_n = 1024;
   size_t n = data_shape.dimensions(has_batch ? 1 : 0);
   size_t k = topk->shape().tuple_shapes(0).dimensions(has_batch ? 1 : 0);
-  if (k > max_k) {
-    return InvalidArgument("k too large (%d), must be <= %d", k, max_k);
-  }
   if (n < min_n) {
     return InvalidArgument("Input too small (n=%d, min_n=%d)", n, min_n);
   }
+  return TopkDimensions{
+      static_cast<size_t>(has_batch ? data_shape.dimensions(0) : 1), n, k};
+}
+
+// Replaces `topk` with a call to the GPU kernels producing `shape`, whose
+// first two elements are the results of `topk`.
+HloInstruction* CreateGpuTopk(HloCustomCallInstruction* topk,
+                              const Shape& shape) {
   HloComputation* comp = topk->parent();
   HloInstruction* new_topk =
       comp->AddInstruction(HloInstruction::CreateCustomCall(
-          topk->shape(), topk->operands(),
+          shape, topk->operands(),
           // We don't need the original to_apply, but keeping it around allows
           // us to round-trip this CustomCall on tests.
           topk->to_apply(), "__gpu$TopK",
@@ -81,6 +98,53 @@ absl::StatusOr<HloInstruction*> SmallBufferOptimization(
   return TupleUtil::ExtractPrefix(new_topk, 2);
 }
 
+absl::StatusOr<HloInstruction*> SmallBufferOptimization(
+    HloCustomCallInstruction* topk) {
+  TF_ASSIGN_OR_RETURN(TopkDimensions dims, GetSupportedDimensions(topk));
+  constexpr size_t max_k = kernel::topk::kTopKMaxSmallK;
+  if (dims.k > max_k) {
+    return InvalidArgument("k too large (%d), must be <= %d", dims.k, max_k);
+  }
+  return CreateGpuTopk(topk, topk->shape());
+}
+
+// Every slice selected by its own block has at least this many elements, and
+// at least this many elements per selected one, so that the final selection
+// only has to look at a fraction of the input.
+constexpr size_t kRadixSelectMinSliceSize = 16 * 1024;
+constexpr size_t kRadixSelectMinSliceSizePerK = 8;
+// Rows are not split further once there are enough blocks to fill the GPU.
+constexpr size_t kRadixSelectMaxBlocks = 1024;
+
+absl::StatusOr<HloInstruction*> RadixSelectOptimization(
+    HloCustomCallInstruction* topk) {
+  TF_ASSIGN_OR_RETURN(TopkDimensions dims, GetSupportedDimensions(topk));
+  constexpr size_t max_k = kernel::topk::kTopKMaxRadixSelectK;
+  if (dims.k > max_k) {
+    return InvalidArgument("k too large (%d), must be <= %d", dims.k, max_k);
+  }
+  if (dims.k > dims.n) {
+    return InvalidArgument("k too large (%d), must be <= n (%d)", dims.k,
+                           dims.n);
+  }
+  size_t slice_size = std::max(kRadixSelectMinSliceSize,
+                               kRadixSelectMinSliceSizePerK * dims.k);
+  size_t num_slices = std::max<size_t>(
+      1, std::min(dims.n / slice_size,
+                  kRadixSelectMaxBlocks / dims.batch_size));
+  Shape shape = topk->shape();
+  if (num_slices > 1) {
+    // The candidates of all slices are passed to the final selection through
+    // a scratch buffer.
+    int64_t scratch_size = kernel::topk::GetTopKRadixSelectScratchSize(
+        topk->operand(0)->shape().element_type(), dims.k, dims.batch_size,
+        num_slices);
+    ShapeUtil::AppendShapeToTuple(ShapeUtil::MakeShape(U8, {scratch_size}),
+                                  &shape);
+  }
+  return CreateGpuTopk(topk, shape);
+}
+
 class SpecializeTopkVisitor : public DfsHloRewriteVisitor {
  public:
   absl::Status HandleCustomCall(HloInstruction* inst) override {
@@ -97,6 +161,13 @@ class SpecializeTopkVisitor : public DfsHloRewriteVisitor {
               << small_topk.status();
     }
 
+    if (auto radix_topk = RadixSelectOptimization(topk); radix_topk.ok()) {
+      return ReplaceInstruction(topk, *radix_topk);
+    } else {
+      VLOG(2) << "Radix select TopK optimization doesn't match: "
+              << radix_topk.status();
+    }
+
     return absl::OkStatus();
   }
 };
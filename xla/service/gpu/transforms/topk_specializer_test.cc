@@ -156,5 +156,20 @@ INSTANTIATE_TEST_SUITE_P(
                               std::get<2>(info.param), std::get<3>(info.param));
     });
 
+// Large k goes through the radix select kernels, which split large rows into
+// slices selected by different blocks.
+INSTANTIATE_TEST_SUITE_P(
+    TopkRadixSelectTests, TopkTest,
+    Combine(
+        /*n_kb=*/Values(1, 32, 1024),
+        /*k=*/Values(17, 100, 1024),
+        /*batch_size=*/Values(1, 16),
+        /*dtype=*/Values(absl::string_view("f32"), "bf16")),
+    [](const auto& info) {
+      return absl::Substitute("n$0KiB_k$1_batch_size$2_$3",
+                              std::get<0>(info.param), std::get<1>(info.param),
+                              std::get<2>(info.param), std::get<3>(info.param));
+    });
+
 }  // namespace
 }  // namespace xla
@@ -0,0 +1,152 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/transforms/triton_attention_rewriter.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/service/gpu/backend_configs.pb.h"
+#include "xla/service/gpu/ir_emission_utils.h"
+#include "xla/service/gpu/triton_attention_analysis.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::gpu {
+namespace {
+
+// Instructions that can be duplicated in the fusion if they have other users.
+bool IsCheapToDuplicate(const HloInstruction& instr) {
+  return instr.opcode() == HloOpcode::kConstant ||
+         instr.opcode() == HloOpcode::kIota ||
+         instr.opcode() == HloOpcode::kBroadcast;
+}
+
+// Checks that the results of the pattern other than its root are only used
+// inside of it, so that fusing it neither duplicates work nor creates cycles.
+bool IsFusible(const TritonAttentionAnalysis& analysis) {
+  for (const HloInstruction* instr : analysis.instructions()) {
+    if (instr == analysis.bmm2() || IsCheapToDuplicate(*instr)) {
+      continue;
+    }
+    if (!absl::c_all_of(instr->users(), [&](const HloInstruction* user) {
+          return analysis.Contains(user);
+        })) {
+      VLOG(5) << "Attention pattern not fused, " << instr->name()
+              << " has users outside of it";
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::Status FuseAttention(const TritonAttentionAnalysis& analysis,
+                           HloInstruction* bmm2) {
+  HloComputation::Builder builder("triton_attention_computation");
+  // Original instruction -> fused one.
+  absl::flat_hash_map<const HloInstruction*, HloInstruction*>
+      old_to_new_mapping;
+  std::vector<HloInstruction*> parameters;
+
+  std::function<HloInstruction*(HloInstruction*)> create_computation =
+      [&](HloInstruction* instr) -> HloInstruction* {
+    if (auto it = old_to_new_mapping.find(instr);
+        it != old_to_new_mapping.end()) {
+      return it->second;
+    }
+    HloInstruction* fused;
+    if (!analysis.Contains(instr)) {
+      fused = builder.AddInstruction(HloInstruction::CreateParameter(
+          parameters.size(), instr->shape(),
+          absl::StrCat("parameter_", parameters.size())));
+      parameters.push_back(instr);
+    } else {
+      std::vector<HloInstruction*> new_operands;
+      for (HloInstruction* operand : instr->mutable_operands()) {
+        new_operands.push_back(create_computation(operand));
+      }
+      fused = builder.AddInstruction(
+          instr->CloneWithNewOperands(instr->shape(), new_operands));
+    }
+    old_to_new_mapping[instr] = fused;
+    return fused;
+  };
+  create_computation(bmm2);
+
+  HloComputation* parent = bmm2->parent();
+  HloComputation* computation =
+      bmm2->GetModule()->AddComputationAndUnifyNamesAndIds(builder.Build(),
+                                                           /*is_entry=*/false);
+  HloInstruction* fusion =
+      parent->AddInstruction(HloInstruction::CreateFusion(
+          bmm2->shape(), HloInstruction::FusionKind::kCustom, parameters,
+          computation));
+  fusion->GetModule()->SetAndUniquifyInstrName(fusion, "triton_attention");
+
+  TF_ASSIGN_OR_RETURN(auto gpu_config,
+                      fusion->backend_config<GpuBackendConfig>());
+  FusionBackendConfig& backend_config =
+      *gpu_config.mutable_fusion_backend_config();
+  backend_config.set_kind(std::string(kTritonAttentionFusionKind));
+  *backend_config.mutable_triton_gemm_config() =
+      analysis.DefaultConfig().ToProto();
+  TF_RETURN_IF_ERROR(fusion->set_backend_config(gpu_config));
+  return parent->ReplaceInstruction(bmm2, fusion);
+}
+
+}  // namespace
+
+absl::StatusOr<bool> TritonAttentionRewriter::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  bool changed = false;
+  for (HloComputation* computation :
+       module->MakeNonfusionComputations(execution_threads)) {
+    // Fusing a pattern only removes instructions preceding its root, which
+    // have already been visited.
+    for (HloInstruction* instr : computation->MakeInstructionPostOrder()) {
+      if (instr->opcode() != HloOpcode::kDot) {
+        continue;
+      }
+      absl::StatusOr<TritonAttentionAnalysis> analysis =
+          TritonAttentionAnalysis::Execute(*instr);
+      if (!analysis.ok()) {
+        VLOG(5) << analysis.status();
+        continue;
+      }
+      if (!IsFusible(*analysis)) {
+        continue;
+      }
+      TF_RETURN_IF_ERROR(FuseAttention(*analysis, instr));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace xla::gpu
@@ -0,0 +1,54 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_TRANSFORMS_TRITON_ATTENTION_REWRITER_H_
+#define XLA_SERVICE_GPU_TRANSFORMS_TRITON_ATTENTION_REWRITER_H_
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/pass/hlo_pass_interface.h"
+
+namespace xla::gpu {
+
+// Rewrites the attention patterns matched by TritonAttentionAnalysis,
+//
+//   dot(softmax(f(dot(q, k), inputs...)), v)
+//
+// into custom fusions of kind `kTritonAttentionFusionKind`, which are emitted
+// as flash attention kernels with Triton: the scores and probabilities are
+// never written to memory. This covers the variants that
+// CudnnFusedMHARewriter leaves unfused, e.g. arbitrary masks and biases or
+// grouped-query attention, which otherwise run as separate memory-bound dot
+// and softmax kernels.
+//
+// Intermediate results of a pattern must not be used outside of it, except
+// for constants, iotas and broadcasts, which are duplicated in the fusion.
+class TritonAttentionRewriter : public HloModulePass {
+ public:
+  absl::string_view name() const override {
+    return "triton-attention-rewriter";
+  }
+
+  using HloPassInterface::Run;
+  absl::StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+};
+
+}  // namespace xla::gpu
+
+#endif  // XLA_SERVICE_GPU_TRANSFORMS_TRITON_ATTENTION_REWRITER_H_
@@ -0,0 +1,200 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/transforms/triton_attention_rewriter.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/hlo/utils/hlo_query.h"
+#include "xla/service/gpu/backend_configs.pb.h"
+#include "xla/service/gpu/ir_emission_utils.h"
+#include "xla/service/pattern_matcher.h"
+#include "xla/service/pattern_matcher_gmock.h"
+#include "xla/tests/hlo_test_base.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::gpu {
+namespace {
+
+using ::tsl::testing::IsOkAndHolds;
+namespace m = ::xla::match;
+
+using TritonAttentionRewriterTest = HloTestBase;
+
+constexpr absl::string_view kReducers = R"(
+HloModule m
+
+max_computation {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT r = f32[] maximum(a, b)
+}
+
+add_computation {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT r = f32[] add(a, b)
+}
+)";
+
+TEST_F(TritonAttentionRewriterTest, FusesAttentionWithScaleAndBias) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(
+                                            absl::StrCat(kReducers, R"(
+ENTRY main {
+  q = bf16[2,4,128,64] parameter(0)
+  k = bf16[2,4,256,64] parameter(1)
+  v = bf16[2,4,256,64] parameter(2)
+  bias = f32[128,256] parameter(3)
+  bmm1 = bf16[2,4,128,256] dot(q, k), lhs_batch_dims={0,1},
+    lhs_contracting_dims={3}, rhs_batch_dims={0,1}, rhs_contracting_dims={3}
+  scores_f32 = f32[2,4,128,256] convert(bmm1)
+  scale = f32[] constant(0.125)
+  scale_b = f32[2,4,128,256] broadcast(scale), dimensions={}
+  scaled = f32[2,4,128,256] multiply(scores_f32, scale_b)
+  bias_b = f32[2,4,128,256] broadcast(bias), dimensions={2,3}
+  scores = f32[2,4,128,256] add(scaled, bias_b)
+  min = f32[] constant(-inf)
+  max = f32[2,4,128] reduce(scores, min), dimensions={3},
+    to_apply=max_computation
+  max_b = f32[2,4,128,256] broadcast(max), dimensions={0,1,2}
+  sub = f32[2,4,128,256] subtract(scores, max_b)
+  exp = f32[2,4,128,256] exponential(sub)
+  zero = f32[] constant(0)
+  sum = f32[2,4,128] reduce(exp, zero), dimensions={3},
+    to_apply=add_computation
+  sum_b = f32[2,4,128,256] broadcast(sum), dimensions={0,1,2}
+  probs = f32[2,4,128,256] divide(exp, sum_b)
+  probs_bf16 = bf16[2,4,128,256] convert(probs)
+  ROOT out = bf16[2,4,128,64] dot(probs_bf16, v), lhs_batch_dims={0,1},
+    lhs_contracting_dims={3}, rhs_batch_dims={0,1}, rhs_contracting_dims={2}
+})")));
+
+  EXPECT_THAT(TritonAttentionRewriter().Run(module.get()), IsOkAndHolds(true));
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, GmockMatch(m::Fusion(m::Parameter(0), m::Parameter(1),
+                                         m::Parameter(3), m::Parameter(2))));
+  TF_ASSERT_OK_AND_ASSIGN(auto gpu_config,
+                          root->backend_config<GpuBackendConfig>());
+  const FusionBackendConfig& backend_config =
+      gpu_config.fusion_backend_config();
+  EXPECT_EQ(backend_config.kind(), kTritonAttentionFusionKind);
+  EXPECT_EQ(backend_config.triton_gemm_config().block_m(), 64);
+  EXPECT_EQ(backend_config.triton_gemm_config().block_n(), 64);
+  EXPECT_EQ(hlo_query::CountInstructionsWithOpcode(
+                *root->fused_instructions_computation(), HloOpcode::kDot),
+            2);
+  // Only the fusion and its parameters are left.
+  EXPECT_EQ(module->entry_computation()->instruction_count(), 5);
+}
+
+TEST_F(TritonAttentionRewriterTest, FusesGroupedQueryAttentionWithCausalMask) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(
+                                            absl::StrCat(kReducers, R"(
+ENTRY main {
+  q = f16[2,2,4,128,128] parameter(0)
+  k = f16[2,2,128,128] parameter(1)
+  v = f16[2,2,128,128] parameter(2)
+  k_b = f16[2,2,4,128,128] broadcast(k), dimensions={0,1,3,4}
+  v_b = f16[2,2,4,128,128] broadcast(v), dimensions={0,1,3,4}
+  bmm1 = f32[2,2,4,128,128] dot(q, k_b), lhs_batch_dims={0,1,2},
+    lhs_contracting_dims={4}, rhs_batch_dims={0,1,2}, rhs_contracting_dims={4}
+  query = s32[2,2,4,128,128] iota(), iota_dimension=3
+  key = s32[2,2,4,128,128] iota(), iota_dimension=4
+  causal = pred[2,2,4,128,128] compare(query, key), direction=GE
+  min = f32[] constant(-inf)
+  min_b = f32[2,2,4,128,128] broadcast(min), dimensions={}
+  scores = f32[2,2,4,128,128] select(causal, bmm1, min_b)
+  max = f32[2,2,4,128] reduce(scores, min), dimensions={4},
+    to_apply=max_computation
+  max_b = f32[2,2,4,128,128] broadcast(max), dimensions={0,1,2,3}
+  sub = f32[2,2,4,128,128] subtract(scores, max_b)
+  exp = f32[2,2,4,128,128] exponential(sub)
+  zero = f32[] constant(0)
+  sum = f32[2,2,4,128] reduce(exp, zero), dimensions={4},
+    to_apply=add_computation
+  sum_b = f32[2,2,4,128,128] broadcast(sum), dimensions={0,1,2,3}
+  probs = f32[2,2,4,128,128] divide(exp, sum_b)
+  probs_f16 = f16[2,2,4,128,128] convert(probs)
+  ROOT out = f16[2,2,4,128,128] dot(probs_f16, v_b), lhs_batch_dims={0,1,2},
+    lhs_contracting_dims={4}, rhs_batch_dims={0,1,2}, rhs_contracting_dims={3}
+})")));
+
+  EXPECT_THAT(TritonAttentionRewriter().Run(module.get()), IsOkAndHolds(true));
+  // The broadcasts of k and v along the query groups are fused, so that every
+  // head of k and v is read from memory directly.
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, GmockMatch(m::Fusion(m::Parameter(0), m::Parameter(1),
+                                         m::Parameter(2))));
+  TF_ASSERT_OK_AND_ASSIGN(auto gpu_config,
+                          root->backend_config<GpuBackendConfig>());
+  // Smaller blocks of keys for the larger head dimension.
+  EXPECT_EQ(gpu_config.fusion_backend_config().triton_gemm_config().block_n(),
+            32);
+}
+
+TEST_F(TritonAttentionRewriterTest, DoesNotFuseIfProbabilitiesAreUsed) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(
+                                            absl::StrCat(kReducers, R"(
+ENTRY main {
+  q = f32[4,128,64] parameter(0)
+  k = f32[4,128,64] parameter(1)
+  v = f32[4,128,64] parameter(2)
+  scores = f32[4,128,128] dot(q, k), lhs_batch_dims={0},
+    lhs_contracting_dims={2}, rhs_batch_dims={0}, rhs_contracting_dims={2}
+  min = f32[] constant(-inf)
+  max = f32[4,128] reduce(scores, min), dimensions={2},
+    to_apply=max_computation
+  max_b = f32[4,128,128] broadcast(max), dimensions={0,1}
+  sub = f32[4,128,128] subtract(scores, max_b)
+  exp = f32[4,128,128] exponential(sub)
+  zero = f32[] constant(0)
+  sum = f32[4,128] reduce(exp, zero), dimensions={2},
+    to_apply=add_computation
+  sum_b = f32[4,128,128] broadcast(sum), dimensions={0,1}
+  probs = f32[4,128,128] divide(exp, sum_b)
+  out = f32[4,128,64] dot(probs, v), lhs_batch_dims={0},
+    lhs_contracting_dims={2}, rhs_batch_dims={0}, rhs_contracting_dims={1}
+  ROOT tuple = (f32[4,128,64], f32[4,128,128]) tuple(out, probs)
+})")));
+
+  EXPECT_THAT(TritonAttentionRewriter().Run(module.get()), IsOkAndHolds(false));
+}
+
+TEST_F(TritonAttentionRewriterTest, DoesNotFuseDotsWithoutSoftmax) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY main {
+  q = f32[4,128,64] parameter(0)
+  k = f32[4,128,64] parameter(1)
+  v = f32[4,128,64] parameter(2)
+  scores = f32[4,128,128] dot(q, k), lhs_batch_dims={0},
+    lhs_contracting_dims={2}, rhs_batch_dims={0}, rhs_contracting_dims={2}
+  exp = f32[4,128,128] exponential(scores)
+  ROOT out = f32[4,128,64] dot(exp, v), lhs_batch_dims={0},
+    lhs_contracting_dims={2}, rhs_batch_dims={0}, rhs_contracting_dims={1}
+})"));
+
+  EXPECT_THAT(TritonAttentionRewriter().Run(module.get()), IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace xla::gpu
@@ -0,0 +1,416 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/triton_attention_analysis.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "llvm/Support/MathExtras.h"
+#include "xla/hlo/ir/hlo_casting_utils.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/hlo/utils/hlo_query.h"
+#include "xla/literal_util.h"
+#include "xla/primitive_util.h"
+#include "xla/service/gpu/backend_configs.pb.h"
+#include "xla/service/gpu/matmul_utils.h"
+#include "xla/service/pattern_matcher.h"
+#include "xla/shape.h"
+#include "xla/shape_util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace m = ::xla::match;
+
+// The head dimensions are held in registers in a single tile.
+constexpr int64_t kMaxHeadDim = 256;
+
+// Minimal size of a dimension of the operands of tt.dot.
+constexpr int64_t kMinTileSize = 16;
+
+absl::Status NotAttention(absl::string_view reason,
+                          const HloInstruction& instr) {
+  return absl::FailedPreconditionError(
+      absl::StrCat("Unsupported attention pattern, ", reason, ": ",
+                   instr.ToString()));
+}
+
+// Checks that `dot` multiplies [batch..., m, k] by [batch..., k, n] up to the
+// order of dimensions of the operands, and returns the number of batch
+// dimensions.
+absl::StatusOr<int64_t> GetNumBatchDims(const HloDotInstruction& dot) {
+  const DotDimensionNumbers& dims = dot.dot_dimension_numbers();
+  if (dot.sparse_operands() > 0) {
+    return NotAttention("sparse dot", dot);
+  }
+  if (dot.precision_config().algorithm() != PrecisionConfig::ALG_UNSET) {
+    return NotAttention("dot algorithm", dot);
+  }
+  if (dims.lhs_contracting_dimensions_size() != 1 ||
+      dims.rhs_contracting_dimensions_size() != 1) {
+    return NotAttention("more than one contracting dimension", dot);
+  }
+  const int64_t num_batch_dims = dims.lhs_batch_dimensions_size();
+  if (dot.operand(0)->shape().rank() != num_batch_dims + 2 ||
+      dot.operand(1)->shape().rank() != num_batch_dims + 2) {
+    return NotAttention("more than one non-contracting dimension", dot);
+  }
+  return num_batch_dims;
+}
+
+bool IsSupportedDotOperandType(PrimitiveType type) {
+  return type == F16 || type == BF16 || type == F32;
+}
+
+// Reduction over the minor dimension (the keys) with the given reducer.
+bool IsRowReduction(const HloInstruction& reduce, HloOpcode reducer) {
+  if (reduce.opcode() != HloOpcode::kReduce || reduce.operand_count() != 2 ||
+      reduce.dimensions().size() != 1 ||
+      reduce.dimensions(0) != reduce.operand(0)->shape().rank() - 1) {
+    return false;
+  }
+  const HloInstruction* root = reduce.to_apply()->root_instruction();
+  return root->opcode() == reducer &&
+         root->operand(0)->opcode() == HloOpcode::kParameter &&
+         root->operand(1)->opcode() == HloOpcode::kParameter;
+}
+
+// Broadcast of a row reduction back to the shape of its input.
+bool IsRowBroadcast(const HloInstruction& broadcast) {
+  const int64_t rank = broadcast.shape().rank();
+  if (broadcast.dimensions().size() != rank - 1) {
+    return false;
+  }
+  for (int64_t i = 0; i < rank - 1; ++i) {
+    if (broadcast.dimensions(i) != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Broadcast that only adds batch dimensions to the operand of a dot.
+bool IsBatchBroadcast(const HloInstruction& operand,
+                      absl::Span<const int64_t> batch_dims) {
+  if (operand.opcode() != HloOpcode::kBroadcast) {
+    return false;
+  }
+  for (int64_t dim = 0; dim < operand.shape().rank(); ++dim) {
+    if (!absl::c_linear_search(batch_dims, dim) &&
+        !absl::c_linear_search(operand.dimensions(), dim)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsSupportedScoreType(PrimitiveType type) {
+  switch (type) {
+    case PRED:
+    case S8:
+    case S16:
+    case S32:
+    case S64:
+    case F16:
+    case BF16:
+    case F32:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsSupportedScoreOp(const HloInstruction& instr) {
+  switch (instr.opcode()) {
+    case HloOpcode::kAbs:
+    case HloOpcode::kAdd:
+    case HloOpcode::kAnd:
+    case HloOpcode::kClamp:
+    case HloOpcode::kCompare:
+    case HloOpcode::kConvert:
+    case HloOpcode::kDivide:
+    case HloOpcode::kMaximum:
+    case HloOpcode::kMinimum:
+    case HloOpcode::kMultiply:
+    case HloOpcode::kNegate:
+    case HloOpcode::kNot:
+    case HloOpcode::kOr:
+    case HloOpcode::kSelect:
+    case HloOpcode::kSubtract:
+      return true;
+    case HloOpcode::kExp:
+    case HloOpcode::kLog:
+    case HloOpcode::kRsqrt:
+    case HloOpcode::kSqrt:
+    case HloOpcode::kTanh:
+      // Emitted as libdevice calls, which are only used for F32 here.
+      return instr.shape().element_type() == F32;
+    default:
+      return false;
+  }
+}
+
+// Collects the graph computing the scores from the first dot in post order.
+// Operands that are not supported are left out as inputs of the pattern.
+absl::Status CollectScoreInstructions(
+    const HloInstruction* instr, const Shape& scores_shape,
+    const HloInstruction*& bmm1,
+    absl::flat_hash_set<const HloInstruction*>& visited,
+    std::vector<const HloInstruction*>& post_order) {
+  if (!visited.insert(instr).second) {
+    return absl::OkStatus();
+  }
+  if (instr->opcode() == HloOpcode::kDot) {
+    if (bmm1 != nullptr) {
+      return NotAttention("more than one dot computing the scores", *instr);
+    }
+    bmm1 = instr;
+    return absl::OkStatus();
+  }
+  if (!ShapeUtil::SameDimensions(instr->shape(), scores_shape) ||
+      !IsSupportedScoreType(instr->shape().element_type())) {
+    return NotAttention("unsupported scores", *instr);
+  }
+  if (hlo_query::IsBroadcastOfScalarConstant(*instr)) {
+    post_order.push_back(instr->operand(0));
+    post_order.push_back(instr);
+    return absl::OkStatus();
+  }
+  if (instr->opcode() == HloOpcode::kBroadcast ||
+      instr->opcode() == HloOpcode::kIota) {
+    post_order.push_back(instr);
+    return absl::OkStatus();
+  }
+  if (!IsSupportedScoreOp(*instr)) {
+    // An input of the pattern.
+    return absl::OkStatus();
+  }
+  for (const HloInstruction* operand : instr->operands()) {
+    TF_RETURN_IF_ERROR(CollectScoreInstructions(operand, scores_shape, bmm1,
+                                                visited, post_order));
+  }
+  post_order.push_back(instr);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+/*static*/ absl::StatusOr<TritonAttentionAnalysis>
+TritonAttentionAnalysis::Execute(const HloInstruction& bmm2) {
+  if (bmm2.opcode() != HloOpcode::kDot) {
+    return NotAttention("not a dot", bmm2);
+  }
+  TritonAttentionAnalysis analysis;
+  analysis.bmm2_ = Cast<HloDotInstruction>(&bmm2);
+  TF_ASSIGN_OR_RETURN(analysis.num_batch_dims_,
+                      GetNumBatchDims(*analysis.bmm2_));
+  const int64_t num_batch_dims = analysis.num_batch_dims_;
+  const DotDimensionNumbers& bmm2_dims =
+      analysis.bmm2_->dot_dimension_numbers();
+  for (int64_t i = 0; i < num_batch_dims; ++i) {
+    if (bmm2_dims.lhs_batch_dimensions(i) != i) {
+      return NotAttention("probabilities are transposed", bmm2);
+    }
+  }
+  if (bmm2_dims.lhs_contracting_dimensions(0) != num_batch_dims + 1) {
+    return NotAttention("probabilities are transposed", bmm2);
+  }
+
+  // probs = exp(scores - max(scores)) / sum(exp(scores - max(scores)))
+  const HloInstruction* probs_convert = nullptr;
+  const HloInstruction* probs = bmm2.operand(0);
+  if (probs->opcode() == HloOpcode::kConvert) {
+    probs_convert = probs;
+    probs = probs->operand(0);
+  }
+  const HloInstruction *exp, *sub, *scores, *max, *max_init, *max_broadcast,
+      *sum, *sum_init, *sum_broadcast;
+  if (!Match(probs,
+             m::Divide(m::Exp(&exp, m::Subtract(&sub, m::Op(&scores),
+                                                m::Broadcast(&max_broadcast,
+                                                             m::Reduce(&max)))),
+                       m::Broadcast(&sum_broadcast, m::Reduce(&sum))))) {
+    return NotAttention("no softmax", bmm2);
+  }
+  max_init = max->operand(1);
+  sum_init = sum->operand(1);
+  const PrimitiveType probs_type = probs->shape().element_type();
+  if (!IsRowReduction(*max, HloOpcode::kMaximum) ||
+      max->operand(0) != scores || !IsRowBroadcast(*max_broadcast) ||
+      !hlo_query::IsScalarConstant(max_init) ||
+      max_init->literal() != LiteralUtil::MinValue(probs_type)) {
+    return NotAttention("no maximum of the scores", *probs);
+  }
+  if (!IsRowReduction(*sum, HloOpcode::kAdd) || sum->operand(0) != exp ||
+      !IsRowBroadcast(*sum_broadcast) ||
+      !hlo_query::IsScalarConstant(sum_init) ||
+      sum_init->literal() != LiteralUtil::Zero(probs_type)) {
+    return NotAttention("no sum of the exponentials", *probs);
+  }
+  if (!primitive_util::IsFloatingPointType(probs_type) ||
+      !IsSupportedDotOperandType(bmm2.operand(0)->shape().element_type()) ||
+      analysis.v()->shape().element_type() !=
+          bmm2.operand(0)->shape().element_type() ||
+      !IsSupportedDotOperandType(bmm2.shape().element_type())) {
+    return NotAttention("unsupported types", bmm2);
+  }
+  analysis.scores_ = scores;
+  analysis.probs_ = probs;
+
+  // scores = f(dot(q, k), inputs...)
+  const HloInstruction* bmm1 = nullptr;
+  absl::flat_hash_set<const HloInstruction*> visited;
+  TF_RETURN_IF_ERROR(CollectScoreInstructions(scores, scores->shape(), bmm1,
+                                              visited,
+                                              analysis.score_instructions_));
+  if (bmm1 == nullptr) {
+    return NotAttention("scores are not computed by a dot", *scores);
+  }
+  analysis.bmm1_ = Cast<HloDotInstruction>(bmm1);
+  TF_ASSIGN_OR_RETURN(int64_t bmm1_num_batch_dims,
+                      GetNumBatchDims(*analysis.bmm1_));
+  if (bmm1_num_batch_dims != num_batch_dims ||
+      !ShapeUtil::SameDimensions(bmm1->shape(), scores->shape())) {
+    return NotAttention("batch dimensions of the dots do not match", bmm2);
+  }
+  const PrimitiveType qk_type = analysis.q()->shape().element_type();
+  if (!IsSupportedDotOperandType(qk_type) ||
+      analysis.k()->shape().element_type() != qk_type ||
+      !IsSupportedDotOperandType(bmm1->shape().element_type())) {
+    return NotAttention("unsupported types", *bmm1);
+  }
+  if (analysis.qk_head_dim() > kMaxHeadDim ||
+      analysis.v_head_dim() > kMaxHeadDim) {
+    return NotAttention("head dimension is too large", bmm2);
+  }
+
+  // Post order of the whole pattern.
+  const DotDimensionNumbers& bmm1_dims =
+      analysis.bmm1_->dot_dimension_numbers();
+  auto add = [&](const HloInstruction* instr) {
+    if (analysis.instruction_set_.insert(instr).second) {
+      analysis.instructions_.push_back(instr);
+    }
+  };
+  auto add_dot_operand = [&](const HloInstruction* operand,
+                             absl::Span<const int64_t> batch_dims) {
+    if (IsBatchBroadcast(*operand, batch_dims)) {
+      add(operand);
+    }
+  };
+  add_dot_operand(analysis.q(), bmm1_dims.lhs_batch_dimensions());
+  add_dot_operand(analysis.k(), bmm1_dims.rhs_batch_dimensions());
+  add(bmm1);
+  for (const HloInstruction* instr : analysis.score_instructions_) {
+    add(instr);
+  }
+  for (const HloInstruction* instr :
+       {max_init, max, max_broadcast, sub, exp, sum_init, sum, sum_broadcast,
+        probs}) {
+    add(instr);
+  }
+  if (probs_convert != nullptr) {
+    add(probs_convert);
+  }
+  add_dot_operand(analysis.v(), bmm2_dims.rhs_batch_dimensions());
+  add(&bmm2);
+  return analysis;
+}
+
+std::vector<const HloInstruction*> TritonAttentionAnalysis::Inputs() const {
+  std::vector<const HloInstruction*> inputs;
+  absl::flat_hash_set<const HloInstruction*> seen;
+  for (const HloInstruction* instr : instructions_) {
+    for (const HloInstruction* operand : instr->operands()) {
+      if (!Contains(operand) && seen.insert(operand).second) {
+        inputs.push_back(operand);
+      }
+    }
+  }
+  return inputs;
+}
+
+int64_t TritonAttentionAnalysis::batch_size() const {
+  int64_t batch_size = 1;
+  for (int64_t i = 0; i < num_batch_dims_; ++i) {
+    batch_size *= scores_->shape().dimensions(i);
+  }
+  return batch_size;
+}
+
+int64_t TritonAttentionAnalysis::num_queries() const {
+  return scores_->shape().dimensions(num_batch_dims_);
+}
+
+int64_t TritonAttentionAnalysis::num_keys() const {
+  return scores_->shape().dimensions(num_batch_dims_ + 1);
+}
+
+int64_t TritonAttentionAnalysis::qk_head_dim() const {
+  return q()->shape().dimensions(
+      bmm1_->dot_dimension_numbers().lhs_contracting_dimensions(0));
+}
+
+int64_t TritonAttentionAnalysis::v_head_dim() const {
+  return bmm2_->shape().dimensions(num_batch_dims_ + 1);
+}
+
+TritonGemmConfig TritonAttentionAnalysis::DefaultConfig() const {
+  const int head_dim_tile = std::max<int64_t>(
+      kMinTileSize, llvm::PowerOf2Ceil(std::max(qk_head_dim(), v_head_dim())));
+  // Blocks of q, k, v and the accumulator are held in registers, so the tiles
+  // get smaller as the head dimension grows.
+  const int block_n = head_dim_tile <= 64 ? 64 : 32;
+  return TritonGemmConfig(/*block_m=*/64, block_n,
+                          /*block_k=*/head_dim_tile, /*split_k=*/1,
+                          /*num_stages=*/2, /*num_warps=*/4);
+}
+
+absl::StatusOr<TritonGemmConfig> GetTritonAttentionConfig(
+    const HloFusionInstruction& fusion) {
+  TF_ASSIGN_OR_RETURN(auto gpu_config,
+                      fusion.backend_config<GpuBackendConfig>());
+  const FusionBackendConfig& backend_config =
+      gpu_config.fusion_backend_config();
+  if (backend_config.has_triton_gemm_config()) {
+    return TritonGemmConfig::FromProto(backend_config.triton_gemm_config());
+  }
+  LOG(WARNING) << "Using fallback triton attention config for op "
+               << fusion.name();
+  TF_ASSIGN_OR_RETURN(
+      auto analysis,
+      TritonAttentionAnalysis::Execute(
+          *fusion.fused_instructions_computation()->root_instruction()));
+  return analysis.DefaultConfig();
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,112 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_TRITON_ATTENTION_ANALYSIS_H_
+#define XLA_SERVICE_GPU_TRITON_ATTENTION_ANALYSIS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/service/gpu/matmul_utils.h"
+
+namespace xla {
+namespace gpu {
+
+// Analysis of an attention pattern
+//
+//   scores = f(dot(q, k), inputs...)
+//   probs = exp(scores - max(scores)) / sum(exp(scores - max(scores)))
+//   output = dot(probs, v)
+//
+// where the maximum and the sum are taken over the keys, and `f` is a graph of
+// elementwise operations on the scores (scaling, biases, masks). Its other
+// operands can be broadcasts of scalar constants, iotas, or arbitrary inputs,
+// possibly broadcasted along some of the dimensions of the scores.
+//
+// The logical dimensions of the scores are [batch..., queries, keys]. Any
+// number of batch dimensions is supported, and q, k and v can be broadcasted
+// along them, which covers multi-query and grouped-query attention.
+class TritonAttentionAnalysis {
+ public:
+  // Analyzes the pattern ending with the `bmm2` dot.
+  static absl::StatusOr<TritonAttentionAnalysis> Execute(
+      const HloInstruction& bmm2);
+
+  const HloDotInstruction* bmm1() const { return bmm1_; }
+  const HloDotInstruction* bmm2() const { return bmm2_; }
+  const HloInstruction* scores() const { return scores_; }
+  const HloInstruction* probs() const { return probs_; }
+
+  // The operands of the dots, which are part of the pattern only if they are
+  // broadcasts along batch dimensions.
+  const HloInstruction* q() const { return bmm1_->operand(0); }
+  const HloInstruction* k() const { return bmm1_->operand(1); }
+  const HloInstruction* v() const { return bmm2_->operand(1); }
+
+  // All instructions of the pattern in post order, ending with `bmm2`.
+  const std::vector<const HloInstruction*>& instructions() const {
+    return instructions_;
+  }
+  bool Contains(const HloInstruction* instr) const {
+    return instruction_set_.contains(instr);
+  }
+
+  // Instructions of `f` in post order, starting after `bmm1` and ending with
+  // `scores`. Broadcasts, constants and iotas are included.
+  const std::vector<const HloInstruction*>& score_instructions() const {
+    return score_instructions_;
+  }
+
+  // Operands of the pattern's instructions that are not part of it.
+  std::vector<const HloInstruction*> Inputs() const;
+
+  int64_t num_batch_dims() const { return num_batch_dims_; }
+  int64_t batch_size() const;
+  int64_t num_queries() const;
+  int64_t num_keys() const;
+  int64_t qk_head_dim() const;
+  int64_t v_head_dim() const;
+
+  // Tiling for the attention emitter: `block_m` queries per program and
+  // `block_n` keys per iteration. The emitter always loads whole head
+  // dimensions; `block_k` only records their padded size.
+  TritonGemmConfig DefaultConfig() const;
+
+ private:
+  TritonAttentionAnalysis() = default;
+
+  const HloDotInstruction* bmm1_ = nullptr;
+  const HloDotInstruction* bmm2_ = nullptr;
+  const HloInstruction* scores_ = nullptr;
+  const HloInstruction* probs_ = nullptr;
+  int64_t num_batch_dims_ = 0;
+  std::vector<const HloInstruction*> instructions_;
+  std::vector<const HloInstruction*> score_instructions_;
+  absl::flat_hash_set<const HloInstruction*> instruction_set_;
+};
+
+// Returns the tiling of an attention fusion from its backend config, or the
+// default one of its analysis if it has none.
+absl::StatusOr<TritonGemmConfig> GetTritonAttentionConfig(
+    const HloFusionInstruction& fusion);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_GPU_TRITON_ATTENTION_ANALYSIS_H_
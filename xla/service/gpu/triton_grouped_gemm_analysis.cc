@@ -0,0 +1,207 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/triton_grouped_gemm_analysis.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "llvm/Support/MathExtras.h"
+#include "xla/hlo/ir/hlo_casting_utils.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/service/gpu/backend_configs.pb.h"
+#include "xla/service/gpu/matmul_utils.h"
+#include "xla/shape.h"
+#include "xla/util.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// Minimal size of a dimension of the operands of tt.dot.
+constexpr int64_t kMinTileSize = 16;
+
+absl::Status NotGroupedGemm(absl::string_view reason,
+                            const HloInstruction& instr) {
+  return absl::FailedPreconditionError(absl::StrCat(
+      "Unsupported grouped GEMM, ", reason, ": ", instr.ToString()));
+}
+
+bool IsSupportedType(PrimitiveType type) {
+  return type == F16 || type == BF16 || type == F32;
+}
+
+// The dimension of an operand that is neither a batch nor the contracting one.
+int64_t NonContractingDim(const Shape& shape,
+                          absl::Span<const int64_t> batch_dims,
+                          int64_t contracting_dim) {
+  for (int64_t dim = 0; dim < shape.rank(); ++dim) {
+    if (dim != contracting_dim && !absl::c_linear_search(batch_dims, dim)) {
+      return dim;
+    }
+  }
+  LOG(FATAL) << "No non-contracting dimension in " << shape.ToString();
+}
+
+int64_t TileSize(int64_t dim, int64_t max_tile_size) {
+  return std::clamp<int64_t>(llvm::PowerOf2Ceil(dim), kMinTileSize,
+                             max_tile_size);
+}
+
+}  // namespace
+
+int64_t TritonGroupedGemmAnalysis::Gemm::NumTiles(
+    const TritonGemmConfig& config) const {
+  return batch_size * CeilOfRatio<int64_t>(m, config.block_m) *
+         CeilOfRatio<int64_t>(n, config.block_n);
+}
+
+/*static*/ absl::StatusOr<TritonGroupedGemmAnalysis::Gemm>
+TritonGroupedGemmAnalysis::AnalyzeDot(const HloInstruction& instr) {
+  if (instr.opcode() != HloOpcode::kDot) {
+    return NotGroupedGemm("not a dot", instr);
+  }
+  const auto& dot = *Cast<HloDotInstruction>(&instr);
+  const DotDimensionNumbers& dims = dot.dot_dimension_numbers();
+  if (dot.sparse_operands() > 0) {
+    return NotGroupedGemm("sparse dot", dot);
+  }
+  if (dot.precision_config().algorithm() != PrecisionConfig::ALG_UNSET) {
+    return NotGroupedGemm("dot algorithm", dot);
+  }
+  const Shape& lhs_shape = dot.operand(0)->shape();
+  const Shape& rhs_shape = dot.operand(1)->shape();
+  if (!IsSupportedType(lhs_shape.element_type()) ||
+      rhs_shape.element_type() != lhs_shape.element_type() ||
+      !IsSupportedType(dot.shape().element_type())) {
+    return NotGroupedGemm("unsupported types", dot);
+  }
+  if (dims.lhs_contracting_dimensions_size() != 1 ||
+      dims.rhs_contracting_dimensions_size() != 1) {
+    return NotGroupedGemm("not exactly one contracting dimension", dot);
+  }
+  const int64_t num_batch_dims = dims.lhs_batch_dimensions_size();
+  if (lhs_shape.rank() != num_batch_dims + 2 ||
+      rhs_shape.rank() != num_batch_dims + 2) {
+    return NotGroupedGemm("not exactly one non-contracting dimension", dot);
+  }
+
+  Gemm gemm;
+  gemm.dot = &dot;
+  gemm.lhs_dims.assign(dims.lhs_batch_dimensions().begin(),
+                       dims.lhs_batch_dimensions().end());
+  gemm.lhs_dims.push_back(
+      NonContractingDim(lhs_shape, dims.lhs_batch_dimensions(),
+                        dims.lhs_contracting_dimensions(0)));
+  gemm.lhs_dims.push_back(dims.lhs_contracting_dimensions(0));
+  gemm.rhs_dims.assign(dims.rhs_batch_dimensions().begin(),
+                       dims.rhs_batch_dimensions().end());
+  gemm.rhs_dims.push_back(dims.rhs_contracting_dimensions(0));
+  gemm.rhs_dims.push_back(
+      NonContractingDim(rhs_shape, dims.rhs_batch_dimensions(),
+                        dims.rhs_contracting_dimensions(0)));
+  gemm.batch_size = 1;
+  for (int64_t i = 0; i < num_batch_dims; ++i) {
+    gemm.batch_size *= dot.shape().dimensions(i);
+  }
+  gemm.m = dot.shape().dimensions(num_batch_dims);
+  gemm.n = dot.shape().dimensions(num_batch_dims + 1);
+  gemm.k = lhs_shape.dimensions(dims.lhs_contracting_dimensions(0));
+  return gemm;
+}
+
+/*static*/ absl::StatusOr<TritonGroupedGemmAnalysis>
+TritonGroupedGemmAnalysis::Execute(const HloComputation& computation) {
+  const HloInstruction* root = computation.root_instruction();
+  if (root->opcode() != HloOpcode::kTuple) {
+    return NotGroupedGemm("root is not a tuple", *root);
+  }
+  TritonGroupedGemmAnalysis analysis;
+  for (const HloInstruction* operand : root->operands()) {
+    TF_ASSIGN_OR_RETURN(Gemm gemm, AnalyzeDot(*operand));
+    for (const HloInstruction* dot_operand : operand->operands()) {
+      if (dot_operand->opcode() != HloOpcode::kParameter) {
+        return NotGroupedGemm("operand is not a parameter", *operand);
+      }
+    }
+    if (!analysis.gemms_.empty()) {
+      const HloDotInstruction& first = *analysis.gemms_.front().dot;
+      if (operand->operand(0)->shape().element_type() !=
+              first.operand(0)->shape().element_type() ||
+          operand->shape().element_type() != first.shape().element_type()) {
+        return NotGroupedGemm("types differ within the group", *operand);
+      }
+    }
+    analysis.gemms_.push_back(std::move(gemm));
+  }
+  return analysis;
+}
+
+int64_t TritonGroupedGemmAnalysis::NumTiles(
+    const TritonGemmConfig& config) const {
+  int64_t num_tiles = 0;
+  for (const Gemm& gemm : gemms_) {
+    num_tiles += gemm.NumTiles(config);
+  }
+  return num_tiles;
+}
+
+TritonGemmConfig TritonGroupedGemmAnalysis::DefaultConfig() const {
+  int64_t max_m = 0, max_n = 0, max_k = 0;
+  for (const Gemm& gemm : gemms_) {
+    max_m = std::max(max_m, gemm.m);
+    max_n = std::max(max_n, gemm.n);
+    max_k = std::max(max_k, gemm.k);
+  }
+  // The dots are small by construction, so smaller tiles than for a single
+  // GEMM keep more programs busy.
+  return TritonGemmConfig(TileSize(max_m, 64), TileSize(max_n, 64),
+                          TileSize(max_k, 32), /*split_k=*/1,
+                          /*num_stages=*/2, /*num_warps=*/4);
+}
+
+absl::StatusOr<TritonGemmConfig> GetTritonGroupedGemmConfig(
+    const HloFusionInstruction& fusion) {
+  TF_ASSIGN_OR_RETURN(auto gpu_config,
+                      fusion.backend_config<GpuBackendConfig>());
+  const FusionBackendConfig& backend_config =
+      gpu_config.fusion_backend_config();
+  if (backend_config.has_triton_gemm_config()) {
+    return TritonGemmConfig::FromProto(backend_config.triton_gemm_config());
+  }
+  LOG(WARNING) << "Using fallback triton grouped GEMM config for op "
+               << fusion.name();
+  TF_ASSIGN_OR_RETURN(auto analysis,
+                      TritonGroupedGemmAnalysis::Execute(
+                          *fusion.fused_instructions_computation()));
+  return analysis.DefaultConfig();
+}
+
+}  // namespace gpu
+}  // namespace xla
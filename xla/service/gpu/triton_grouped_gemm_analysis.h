@@ -0,0 +1,91 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_TRITON_GROUPED_GEMM_ANALYSIS_H_
+#define XLA_SERVICE_GPU_TRITON_GROUPED_GEMM_ANALYSIS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_instructions.h"
+#include "xla/service/gpu/matmul_utils.h"
+
+namespace xla {
+namespace gpu {
+
+// Analysis of a grouped GEMM: independent dots
+//
+//   out_i [batch..., m_i, n_i] = lhs_i [batch..., m_i, k_i] x
+//                                rhs_i [batch..., k_i, n_i]
+//
+// up to the order of the dimensions of their operands, which are computed by a
+// single kernel with one program per output tile of any of them. The dots can
+// have different shapes but share their operand and result types.
+class TritonGroupedGemmAnalysis {
+ public:
+  // One dot of the group.
+  struct Gemm {
+    const HloDotInstruction* dot;
+    // Dimensions of the operands in logical order: [batch..., m, k] for the
+    // left-hand side and [batch..., k, n] for the right-hand side. The result
+    // is [batch..., m, n] per the semantics of dot.
+    std::vector<int64_t> lhs_dims;
+    std::vector<int64_t> rhs_dims;
+    int64_t batch_size;
+    int64_t m;
+    int64_t n;
+    int64_t k;
+
+    int64_t num_batch_dims() const { return lhs_dims.size() - 2; }
+    // Number of output tiles for the given tiling.
+    int64_t NumTiles(const TritonGemmConfig& config) const;
+  };
+
+  // Checks that `dot` can be part of a grouped GEMM.
+  static absl::StatusOr<Gemm> AnalyzeDot(const HloInstruction& dot);
+
+  // Analyzes a grouped GEMM fusion computation, whose root is a tuple of dots
+  // of parameters.
+  static absl::StatusOr<TritonGroupedGemmAnalysis> Execute(
+      const HloComputation& computation);
+
+  // In the order of the elements of the root tuple.
+  absl::Span<const Gemm> gemms() const { return gemms_; }
+
+  // Number of output tiles of all dots, i.e. of programs of the kernel.
+  int64_t NumTiles(const TritonGemmConfig& config) const;
+
+  // Tiling shared by all dots, which is large enough for the largest of them.
+  TritonGemmConfig DefaultConfig() const;
+
+ private:
+  TritonGroupedGemmAnalysis() = default;
+
+  std::vector<Gemm> gemms_;
+};
+
+// Returns the tiling of a grouped GEMM fusion from its backend config, or the
+// default one of its analysis if it has none.
+absl::StatusOr<TritonGemmConfig> GetTritonGroupedGemmConfig(
+    const HloFusionInstruction& fusion);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_GPU_TRITON_GROUPED_GEMM_ANALYSIS_H_
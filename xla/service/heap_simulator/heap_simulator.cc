@@ -785,46 +785,127 @@ void GlobalDecreasingSizeBestFitHeap<BufferType>::Free(const BufferType* buffer,
 
 using Chunk = HeapSimulator::Chunk;
 
+namespace {
+
+// Returns a well mixed priority for the n-th node added to a
+// BufferIntervalTree (SplitMix64). The priorities only need to look random to
+// keep the tree balanced, and are deterministic so that the shape of the tree
+// doesn't change between runs.
+uint64_t BufferIntervalTreeNodePriority(uint64_t n) {
+  uint64_t z = n + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// The key by which nodes are ordered in a BufferIntervalTree.
+std::tuple<int64_t, int64_t, int64_t> BufferIntervalTreeNodeKey(
+    int64_t start, int64_t end, const Chunk& chunk) {
+  return std::make_tuple(start, end, chunk.offset);
+}
+
+std::tuple<int64_t, int64_t, int64_t> BufferIntervalTreeNodeKey(
+    const BufferIntervalTreeNode& node) {
+  return BufferIntervalTreeNodeKey(node.start, node.end, node.chunk);
+}
+
+void UpdateSubtreeEnd(BufferIntervalTreeNode* node) {
+  node->subtree_end = node->end;
+  if (node->left) {
+    node->subtree_end = std::max(node->subtree_end, node->left->subtree_end);
+  }
+  if (node->right) {
+    node->subtree_end = std::max(node->subtree_end, node->right->subtree_end);
+  }
+}
+
+}  // namespace
+
+void BufferIntervalTree::RotateUp(BufferIntervalTreeNode* node) {
+  // Turn:
+  //        parent                 node
+  //        /    \                /    \
+  //     node     c     into     a    parent
+  //     /  \                         /    \
+  //    a    b                        b      c
+  //
+  // or its mirror image if node is the right child of parent.
+  BufferIntervalTreeNode* parent = node->parent;
+  BufferIntervalTreeNode* grandparent = parent->parent;
+  if (parent->left == node) {
+    parent->left = node->right;
+    if (node->right) {
+      node->right->parent = parent;
+    }
+    node->right = parent;
+  } else {
+    parent->right = node->left;
+    if (node->left) {
+      node->left->parent = parent;
+    }
+    node->left = parent;
+  }
+  parent->parent = node;
+  node->parent = grandparent;
+  if (grandparent == nullptr) {
+    root_ = node;
+  } else if (grandparent->left == parent) {
+    grandparent->left = node;
+  } else {
+    grandparent->right = node;
+  }
+  UpdateSubtreeEnd(parent);
+  UpdateSubtreeEnd(node);
+}
+
 void BufferIntervalTree::Add(int64_t start, int64_t end, const Chunk& chunk) {
   node_storage_.emplace_back(BufferIntervalTreeNode{
       start, end, end, chunk,
+      BufferIntervalTreeNodePriority(num_added_nodes_++),
       /*left=*/nullptr, /*right=*/nullptr, /*parent=*/nullptr});
+  BufferIntervalTreeNode* node = &node_storage_.back();
   if (root_ == nullptr) {
-    root_ = &node_storage_.back();
+    root_ = node;
     // This is root.
     return;
   }
 
+  // Insert the node as a leaf, then rotate it up until its parent has a higher
+  // priority.
+  const auto key = BufferIntervalTreeNodeKey(*node);
   BufferIntervalTreeNode* parent = root_;
   while (true) {
     parent->subtree_end = std::max(parent->subtree_end, end);
-    if (parent->start > start) {
+    if (key < BufferIntervalTreeNodeKey(*parent)) {
       if (parent->left == nullptr) {
-        parent->left = &node_storage_.back();
-        node_storage_.back().parent = parent;
-        return;
+        parent->left = node;
+        break;
       }
       parent = parent->left;
     } else {
       if (parent->right == nullptr) {
-        parent->right = &node_storage_.back();
-        node_storage_.back().parent = parent;
-        return;
+        parent->right = node;
+        break;
       }
       parent = parent->right;
     }
   }
+  node->parent = parent;
+  while (node->parent != nullptr && node->parent->priority < node->priority) {
+    RotateUp(node);
+  }
 }
 
 bool BufferIntervalTree::Remove(int64_t start, int64_t end,
                                 const Chunk& chunk) {
+  const auto key = BufferIntervalTreeNodeKey(start, end, chunk);
   BufferIntervalTreeNode* to_delete = root_;
   while (to_delete != nullptr) {
-    if (to_delete->start == start && to_delete->end == end &&
-        to_delete->chunk.offset == chunk.offset) {
+    const auto to_delete_key = BufferIntervalTreeNodeKey(*to_delete);
+    if (key == to_delete_key) {
       break;
     }
-    if (start < to_delete->start) {
+    if (key < to_delete_key) {
       to_delete = to_delete->left;
     } else {
       to_delete = to_delete->right;
@@ -834,111 +915,30 @@ bool BufferIntervalTree::Remove(int64_t start, int64_t end,
     // Nothing to delete.
     return false;
   }
-  // Found the node to be deleted, enter deletion sequence.
-
-  // Recursively traverse the parents of node and fix up the `subtree_end`
-  // invariant of a node. Recursive lambda need an explicit
-  // std::function declaration.
-  std::function<void(BufferIntervalTreeNode*)> fix_up =
-      [&](BufferIntervalTreeNode* node) {
-        if (node == nullptr) {
-          return;
-        }
-        node->subtree_end = node->end;
-        if (node->left) {
-          node->subtree_end =
-              std::max(node->subtree_end, node->left->subtree_end);
-        }
-        if (node->right) {
-          node->subtree_end =
-              std::max(node->subtree_end, node->right->subtree_end);
-        }
-        // Recursively go up.
-        fix_up(node->parent);
-      };
 
-  if (to_delete->right == nullptr) {
-    // to_delete has no right child, simply move up left child of to_delete if
-    // any.
-    //
-    // Turn:
-    //      parent
-    //       /
-    // to_delete
-    //  /      \
-    // left    nullptr
-    //
-    // Into:
-    //      parent
-    //      /
-    //    left
-    if (root_ == to_delete) {
-      // Deleting root is simply resetting root;
-      root_ = to_delete->left;
-      return true;
+  // Rotate the node down until it is a leaf, promoting the child with the
+  // higher priority to keep the heap order of the priorities.
+  while (to_delete->left != nullptr || to_delete->right != nullptr) {
+    if (to_delete->right == nullptr ||
+        (to_delete->left != nullptr &&
+         to_delete->left->priority > to_delete->right->priority)) {
+      RotateUp(to_delete->left);
+    } else {
+      RotateUp(to_delete->right);
     }
+  }
 
-    if (to_delete == to_delete->parent->left) {
-      // to_delete is left child of parent.
-      to_delete->parent->left = to_delete->left;
-    }
-    if (to_delete == to_delete->parent->right) {
-      // to_delete is right child of parent.
-      to_delete->parent->right = to_delete->left;
-    }
-    // Rewire parent to the node being moved up.
-    if (to_delete->left) {
-      to_delete->left->parent = to_delete->parent;
-    }
-    // Fix up starting from subroot.
-    fix_up(to_delete);
+  // Unlink the leaf and fix up the `subtree_end` of its ancestors.
+  BufferIntervalTreeNode* parent = to_delete->parent;
+  if (parent == nullptr) {
+    root_ = nullptr;
+  } else if (parent->left == to_delete) {
+    parent->left = nullptr;
   } else {
-    // 1. Find left-most node of the right subtree, promote it to the position
-    // of to_delete.
-    BufferIntervalTreeNode* to_promote = to_delete->right;
-    while (to_promote->left != nullptr) {
-      // Go to left-most subtree.
-      to_promote = to_promote->left;
-    }
-
-    // 2. Copy the content of `to_promote` to `to_delete`.
-    to_delete->start = to_promote->start;
-    to_delete->end = to_promote->end;
-    // This is incorrect but we will fix this up later in the `fix_up`
-    // procedure.
-    to_delete->subtree_end = to_promote->subtree_end;
-    to_delete->chunk = to_promote->chunk;
-    auto to_promote_parent = to_promote->parent;
-    // 3. Move the right child of `to_promote` up if there is any.
-    //
-    // Turn
-    //
-    // to_delete
-    //         \
-    //        to_promote_parent
-    //         /
-    //    to_promote
-    //          \
-    //          right
-    // into
-    //
-    // to_promote
-    //         \
-    //         to_promote_parent
-    //         /
-    //      right
-    if (to_promote_parent->left == to_promote) {
-      to_promote_parent->left = to_promote->right;
-    } else {
-      to_promote_parent->right = to_promote->right;
-    }
-    if (to_promote->right) {
-      // Set correct parent.
-      to_promote->right->parent = to_promote_parent;
-    }
-    // 4. Recursive fix up the `subtree_end` starting from
-    // `to_promote_parent`.
-    fix_up(to_promote_parent);
+    parent->right = nullptr;
+  }
+  for (; parent != nullptr; parent = parent->parent) {
+    UpdateSubtreeEnd(parent);
   }
   // Don't free the entry in node_storage_ until we free the entire tree.
   return true;
@@ -957,29 +957,26 @@ std::vector<Chunk> BufferIntervalTree::ChunksOverlappingInTime(
 std::vector<const BufferIntervalTreeNode*>
 BufferIntervalTree::NodesOverlappingInTime(int64_t start, int64_t end) const {
   std::vector<const BufferIntervalTreeNode*> result;
-  if (root_ == nullptr) {
-    return result;
-  }
+  // In-order traversal that skips subtrees without any nodes that end at or
+  // after `start`, and stops at the first node that starts after `end`.
   std::vector<const BufferIntervalTreeNode*> visiting_stack;
-  visiting_stack.push_back(root_);
-  while (!visiting_stack.empty()) {
-    const BufferIntervalTreeNode* top = visiting_stack.back();
-    visiting_stack.pop_back();
-    if (start > top->subtree_end) {
-      continue;
-    }
-    if (top->left != nullptr) {
-      visiting_stack.push_back(top->left);
+  const BufferIntervalTreeNode* node = root_;
+  while (true) {
+    for (; node != nullptr && node->subtree_end >= start; node = node->left) {
+      visiting_stack.push_back(node);
     }
-    if (top->start <= end && top->end >= start) {
-      result.push_back(top);
+    if (visiting_stack.empty()) {
+      break;
     }
-    if (end < top->start) {
-      continue;
+    node = visiting_stack.back();
+    visiting_stack.pop_back();
+    if (node->start > end) {
+      break;
     }
-    if (top->right != nullptr) {
-      visiting_stack.push_back(top->right);
+    if (node->end >= start) {
+      result.push_back(node);
     }
+    node = node->right;
   }
   return result;
 }
@@ -342,6 +342,9 @@ struct BufferIntervalTreeNode {
   int64_t subtree_end;
   // Allocated chunk for the buffer.
   HeapSimulator::Chunk chunk;
+  // Priority of the node in the treap. Parents have higher priorities than
+  // their children.
+  uint64_t priority;
   // Left child.
   BufferIntervalTreeNode* left;
   // Right child.
@@ -353,6 +356,13 @@ struct BufferIntervalTreeNode {
 };
 
 // An interval tree that can query buffers overlapping in time.
+//
+// The tree is a treap ordered by (alloc time, free time, chunk offset) with
+// pseudo-random but deterministic priorities, so it stays balanced in
+// expectation even if buffers are added in order of their alloc times, which is
+// common for buffers of the same size. Adding and removing buffers takes
+// O(log n) and querying the k buffers overlapping an interval takes
+// O((k + 1) log n) expected time.
 class BufferIntervalTree {
  public:
   using Chunk = HeapSimulator::Chunk;
@@ -364,7 +374,7 @@ class BufferIntervalTree {
   bool Remove(int64_t start, int64_t end, const Chunk& chunk);
 
   // Returns vector of allocated chunks that overlap with the given time
-  // interval.
+  // interval, ordered by their alloc times.
   std::vector<Chunk> ChunksOverlappingInTime(int64_t start, int64_t end) const;
 
   BufferIntervalTreeNode* GetRoot() { return root_; }
@@ -422,8 +432,13 @@ class BufferIntervalTree {
   std::vector<const BufferIntervalTreeNode*> NodesOverlappingInTime(
       int64_t start, int64_t end) const;
 
+  // Rotates `node` above its parent, preserving the order of the nodes.
+  void RotateUp(BufferIntervalTreeNode* node);
+
   BufferIntervalTreeNode* root_ = nullptr;
   std::list<BufferIntervalTreeNode> node_storage_;
+  // Number of nodes added so far, used to derive node priorities.
+  uint64_t num_added_nodes_ = 0;
 };
 
 // An iterator that is passed to
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "xla/service/heap_simulator/heap_simulator.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -38,6 +40,7 @@ limitations under the License.
 #include "xla/literal_util.h"
 #include "xla/service/buffer_value.h"
 #include "xla/service/heap_simulator/allocation_block.h"
+#include "xla/service/hlo.pb.h"
 #include "xla/service/hlo_alias_analysis.h"
 #include "xla/service/hlo_dataflow_analysis.h"
 #include "xla/service/hlo_module_config.h"
@@ -47,9 +50,11 @@ limitations under the License.
 #include "xla/tests/hlo_test_base.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "xla/xla_data.pb.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
 
 namespace xla {
 namespace {
@@ -2097,6 +2102,30 @@ TEST_F(IntervalTreeTest, BufferIntervalTreeHeapSize) {
   EXPECT_THAT(tree.HeapSizeInInterval(25, 26), 16);
 }
 
+TEST_F(IntervalTreeTest, ManyBuffersInOrderOfAllocTime) {
+  // Adding buffers in order of their alloc times would degenerate an
+  // unbalanced tree into a list.
+  constexpr int64_t kNumBuffers = 100000;
+  BufferIntervalTree tree;
+  for (int64_t i = 0; i < kNumBuffers; ++i) {
+    tree.Add(i, i + 10, HeapSimulator::Chunk::FromOffsetSize(i % 16, 1));
+  }
+  for (int64_t i = 0; i < kNumBuffers; i += 2) {
+    EXPECT_TRUE(tree.Remove(i, i + 10,
+                            HeapSimulator::Chunk::FromOffsetSize(i % 16, 1)));
+  }
+  EXPECT_EQ(tree.GetRoot()->subtree_end, kNumBuffers + 9);
+
+  // Buffers 41, 43, ..., 59 overlap with [50, 60], in order of alloc time.
+  std::vector<HeapSimulator::Chunk> chunks =
+      tree.ChunksOverlappingInTime(50, 60);
+  ASSERT_EQ(chunks.size(), 10);
+  for (int64_t i = 0; i < chunks.size(); ++i) {
+    EXPECT_EQ(chunks[i].offset, (41 + 2 * i) % 16);
+  }
+  EXPECT_EQ(tree.HeapSizeInInterval(50, 60), 16);
+}
+
 class SlicedBufferIntervalTest : public ::testing::Test {
  public:
   using HeapTy = GlobalDecreasingSizeBestFitHeap<HloValue>;
@@ -3771,5 +3800,95 @@ TEST_F(SliceTimePermutationIteratorTest, Repacks) {
   }
 }
 
+// Replays the heap simulator traces of a buffer assignment through
+// GlobalDecreasingSizeBestFitHeap. To replay a real buffer assignment, point
+// XLA_HEAP_SIMULATOR_BENCHMARK_HLO_PROTO at an HloProto dumped with
+// --xla_dump_hlo_as_proto that includes the buffer assignment. Otherwise a
+// synthetic trace of buffers with mixed sizes and lifetimes is used, with the
+// number of buffers given by the benchmark argument.
+BufferAssignmentProto GetBenchmarkBufferAssignment(int64_t num_buffers) {
+  if (const char* path = std::getenv("XLA_HEAP_SIMULATOR_BENCHMARK_HLO_PROTO")) {
+    HloProto hlo_proto;
+    TF_CHECK_OK(tsl::ReadBinaryProto(tsl::Env::Default(), path, &hlo_proto));
+    return hlo_proto.buffer_assignment();
+  }
+
+  BufferAssignmentProto buffer_assignment;
+  HeapSimulatorTrace* trace = buffer_assignment.add_heap_simulator_traces();
+  std::vector<std::vector<int64_t>> frees_by_time(2 * num_buffers);
+  for (int64_t id = 0; id < num_buffers; ++id) {
+    LogicalBufferProto* logical_buffer = buffer_assignment.add_logical_buffers();
+    logical_buffer->set_id(id);
+    // A few large and long-lived buffers among many small and short-lived ones.
+    logical_buffer->set_size(id % 97 == 0 ? 1 << 20 : 64 * (1 + id % 13));
+    int64_t lifetime = id % 89 == 0 ? num_buffers / 2 : 1 + id % 7;
+    frees_by_time[std::min(id + lifetime, 2 * num_buffers - 1)].push_back(id);
+
+    HeapSimulatorTrace::Event* alloc = trace->add_events();
+    alloc->set_kind(HeapSimulatorTrace::Event::ALLOC);
+    alloc->set_buffer_id(id);
+    for (int64_t free_id : frees_by_time[id]) {
+      HeapSimulatorTrace::Event* free = trace->add_events();
+      free->set_kind(HeapSimulatorTrace::Event::FREE);
+      free->set_buffer_id(free_id);
+    }
+  }
+  for (int64_t time = num_buffers; time < frees_by_time.size(); ++time) {
+    for (int64_t free_id : frees_by_time[time]) {
+      HeapSimulatorTrace::Event* free = trace->add_events();
+      free->set_kind(HeapSimulatorTrace::Event::FREE);
+      free->set_buffer_id(free_id);
+    }
+  }
+  return buffer_assignment;
+}
+
+void BM_ReplayBufferAssignment(::testing::benchmark::State& state) {
+  BufferAssignmentProto buffer_assignment =
+      GetBenchmarkBufferAssignment(state.range(0));
+  absl::flat_hash_map<int64_t, int64_t> buffer_sizes;
+  for (const LogicalBufferProto& logical_buffer :
+       buffer_assignment.logical_buffers()) {
+    buffer_sizes[logical_buffer.id()] = logical_buffer.size();
+  }
+
+  for (auto s : state) {
+    for (const HeapSimulatorTrace& trace :
+         buffer_assignment.heap_simulator_traces()) {
+      // The heap only uses the buffers as keys and for tie breaking.
+      absl::flat_hash_map<int64_t, std::unique_ptr<AllocationBlock>> buffers;
+      auto get_buffer = [&](int64_t id) {
+        std::unique_ptr<AllocationBlock>& buffer = buffers[id];
+        if (buffer == nullptr) {
+          buffer = std::make_unique<AllocationBlock>();
+          buffer->id = id;
+        }
+        return buffer.get();
+      };
+
+      GlobalDecreasingSizeBestFitHeap<AllocationBlock> heap(/*alignment=*/64);
+      for (const HeapSimulatorTrace::Event& event : trace.events()) {
+        int64_t size = buffer_sizes.at(event.buffer_id());
+        switch (event.kind()) {
+          case HeapSimulatorTrace::Event::ALLOC:
+            heap.Alloc(get_buffer(event.buffer_id()), size);
+            break;
+          case HeapSimulatorTrace::Event::FREE:
+            heap.Free(get_buffer(event.buffer_id()), size);
+            break;
+          case HeapSimulatorTrace::Event::SHARE_WITH:
+            heap.ShareWith(get_buffer(event.buffer_id()),
+                           get_buffer(event.share_with_canonical_id()), size);
+            break;
+          default:
+            break;
+        }
+      }
+      TF_CHECK_OK(heap.Finish().status());
+    }
+  }
+}
+BENCHMARK(BM_ReplayBufferAssignment)->Arg(1000)->Arg(10000)->Arg(100000);
+
 }  // namespace
 }  // namespace xla
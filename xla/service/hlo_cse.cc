@@ -120,7 +120,11 @@ struct CseKey {
   template <typename H>
   friend H AbslHashValue(H h, const CseKey& key) {
     auto instruction = key.hlo;
+    // Include the element type so that e.g. converts of one operand to
+    // different types don't collide and fall through to the much more
+    // expensive structural comparison.
     h = H::combine(std::move(h), instruction->opcode(),
+                   instruction->shape().element_type(),
                    instruction->shape().dimensions());
     auto window_hash = [](H h, const Window& window) {
       const auto& window_dims = window.dimensions();
@@ -213,6 +217,8 @@ struct CseKey {
         return H::combine(
             std::move(h),
             Cast<HloCompareInstruction>(instruction)->direction());
+      case HloOpcode::kCustomCall:
+        return H::combine(std::move(h), instruction->custom_call_target());
       default:
         return std::move(h);
     }
@@ -222,9 +228,11 @@ struct CseKey {
 
 }  // namespace
 
-absl::StatusOr<bool> HloCSE::Run(
-    HloModule* module,
-    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+bool HloCSE::ShouldRunOnComputation(const HloComputation* computation) const {
+  return !only_fusion_computations_ || computation->IsFusionComputation();
+}
+
+absl::StatusOr<bool> HloCSE::RunOnComputation(HloComputation* computation) {
   bool changed = false;
 
   const auto eq_instructions = [&](const HloInstruction* a,
@@ -251,94 +259,87 @@ absl::StatusOr<bool> HloCSE::Run(
         /*sharding_sensitive=*/true);
   };
 
-  for (auto* computation : module->computations(execution_threads)) {
-    if (only_fusion_computations_ && !computation->IsFusionComputation()) {
+  TF_ASSIGN_OR_RETURN(
+      bool combined,
+      is_layout_sensitive_
+          ? CombineConstants<true>(computation, only_scalars_)
+          : CombineConstants<false>(computation, only_scalars_));
+  changed |= combined;
+
+  // HLO instructions are grouped into equivalency classes by using the
+  // cse_equal predicate defined above. This set holds a representative
+  // instruction for each class.
+  absl::flat_hash_set<CseKey, absl::Hash<CseKey>, decltype(cse_equal)>
+      representatives(/*N=*/computation->instruction_count() + 1,
+                      absl::Hash<CseKey>{}, cse_equal);
+  for (auto instruction : computation->MakeInstructionPostOrder()) {
+    // If the instruction has zero operands (constants, parameters, etc.) skip
+    // over it.
+    if (instruction->operand_count() == 0 &&
+        instruction->opcode() != HloOpcode::kPartitionId &&
+        instruction->opcode() != HloOpcode::kReplicaId) {
+      continue;
+    }
+    // Skip instructions which have side effects.
+    if (instruction->HasSideEffect()) {
       continue;
     }
 
-    TF_ASSIGN_OR_RETURN(
-        bool combined,
-        is_layout_sensitive_
-            ? CombineConstants<true>(computation, only_scalars_)
-            : CombineConstants<false>(computation, only_scalars_));
-    changed |= combined;
-
-    // HLO instructions are grouped into equivalency classes by using the
-    // cse_equal predicate defined above. This set holds a representative
-    // instruction for each class.
-    absl::flat_hash_set<CseKey, absl::Hash<CseKey>, decltype(cse_equal)>
-        representatives(/*N=*/computation->instruction_count() + 1,
-                        absl::Hash<CseKey>{}, cse_equal);
-    for (auto instruction : computation->MakeInstructionPostOrder()) {
-      // If the instruction has zero operands (constants, parameters, etc.) skip
-      // over it.
-      if (instruction->operand_count() == 0 &&
-          instruction->opcode() != HloOpcode::kPartitionId &&
-          instruction->opcode() != HloOpcode::kReplicaId) {
-        continue;
-      }
-      // Skip instructions which have side effects.
-      if (instruction->HasSideEffect()) {
-        continue;
-      }
-
-      if (only_scalars_ && !ShapeUtil::IsScalar(instruction->shape())) {
-        continue;
-      }
+    if (only_scalars_ && !ShapeUtil::IsScalar(instruction->shape())) {
+      continue;
+    }
 
-      auto pair = representatives.insert(CseKey{instruction});
-      if (!pair.second) {
-        HloInstruction* equivalent_instruction = pair.first->hlo;
-        TF_RETURN_IF_ERROR(
-            instruction->ReplaceAllUsesWith(equivalent_instruction));
-        TF_RETURN_IF_ERROR(computation->RemoveInstructionAndUnusedOperands(
-            instruction, /*cleanup=*/std::nullopt,
-            ignore_control_dependencies_));
-        VLOG(4) << "Replaced " << instruction->name() << " with "
-                << equivalent_instruction->name();
-        changed = true;
+    auto pair = representatives.insert(CseKey{instruction});
+    if (!pair.second) {
+      HloInstruction* equivalent_instruction = pair.first->hlo;
+      TF_RETURN_IF_ERROR(
+          instruction->ReplaceAllUsesWith(equivalent_instruction));
+      TF_RETURN_IF_ERROR(computation->RemoveInstructionAndUnusedOperands(
+          instruction, /*cleanup=*/std::nullopt,
+          ignore_control_dependencies_));
+      VLOG(4) << "Replaced " << instruction->name() << " with "
+              << equivalent_instruction->name();
+      changed = true;
+      continue;
+    }
+    for (int64_t i = 0; i < instruction->operand_count(); ++i) {
+      HloInstruction* a = instruction->mutable_operand(i);
+      if (a->opcode() != HloOpcode::kIota) {
         continue;
       }
-      for (int64_t i = 0; i < instruction->operand_count(); ++i) {
-        HloInstruction* a = instruction->mutable_operand(i);
-        if (a->opcode() != HloOpcode::kIota) {
+      for (int64_t j = i + 1; j < instruction->operand_count(); ++j) {
+        HloInstruction* b = instruction->mutable_operand(j);
+        if (a == b || !eq_instructions(a, b)) {
           continue;
         }
-        for (int64_t j = i + 1; j < instruction->operand_count(); ++j) {
-          HloInstruction* b = instruction->mutable_operand(j);
-          if (a == b || !eq_instructions(a, b)) {
-            continue;
-          }
-          TF_RETURN_IF_ERROR(instruction->ReplaceOperandWith(j, a));
-          changed = true;
-          if (b->IsDead()) {
-            TF_RETURN_IF_ERROR(computation->RemoveInstruction(b));
-          }
+        TF_RETURN_IF_ERROR(instruction->ReplaceOperandWith(j, a));
+        changed = true;
+        if (b->IsDead()) {
+          TF_RETURN_IF_ERROR(computation->RemoveInstruction(b));
         }
       }
     }
-    if (auto fusion = computation->FusionInstruction()) {
-      if (fusion->IsMultiOutputFusion()) {
-        // Attach users to the representative instruction, thus making the
-        // duplicate fusion roots unused. HloDCE can then cleanup the unused
-        // fusion roots.
-        absl::flat_hash_map<const HloInstruction*, int64_t>
-            root_to_unique_index;
-        int64_t root_index = 0;
-        HloInstruction* root = computation->root_instruction();
-        for (const HloInstruction* hlo : root->operands()) {
-          if (root_to_unique_index.find(hlo) == root_to_unique_index.end()) {
-            root_to_unique_index[hlo] = root_to_unique_index[hlo] = root_index;
-          }
-          ++root_index;
+  }
+  if (auto fusion = computation->FusionInstruction()) {
+    if (fusion->IsMultiOutputFusion()) {
+      // Attach users to the representative instruction, thus making the
+      // duplicate fusion roots unused. HloDCE can then cleanup the unused
+      // fusion roots.
+      absl::flat_hash_map<const HloInstruction*, int64_t> root_to_unique_index;
+      int64_t root_index = 0;
+      HloInstruction* root = computation->root_instruction();
+      for (const HloInstruction* hlo : root->operands()) {
+        if (root_to_unique_index.find(hlo) == root_to_unique_index.end()) {
+          root_to_unique_index[hlo] = root_to_unique_index[hlo] = root_index;
         }
-        if (root_to_unique_index.size() < root->operand_count()) {
-          for (HloInstruction* user : fusion->users()) {
-            if (user->opcode() == HloOpcode::kGetTupleElement) {
-              const HloInstruction* fusion_root =
-                  root->operand(user->tuple_index());
-              user->set_tuple_index(root_to_unique_index[fusion_root]);
-            }
+        ++root_index;
+      }
+      if (root_to_unique_index.size() < root->operand_count()) {
+        for (HloInstruction* user : fusion->users()) {
+          if (user->opcode() == HloOpcode::kGetTupleElement) {
+            const HloInstruction* fusion_root =
+                root->operand(user->tuple_index());
+            user->set_tuple_index(root_to_unique_index[fusion_root]);
           }
         }
       }
@@ -16,7 +16,8 @@ limitations under the License.
 #ifndef XLA_SERVICE_HLO_CSE_H_
 #define XLA_SERVICE_HLO_CSE_H_
 
-#include "xla/hlo/ir/hlo_module.h"
+#include "absl/status/statusor.h"
+#include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/pass/hlo_pass_interface.h"
 
 namespace xla {
@@ -24,8 +25,10 @@ namespace xla {
 // A pass which performs common-subexpression elimination. Identical constants
 // and identical instructions with the same operands are commoned. The pass
 // iterates over the instructions in topological order which enables the pass to
-// find arbitrarily large common expressions.
-class HloCSE : public HloModulePass {
+// find arbitrarily large common expressions. Computations are processed
+// independently, so the pass can run on them concurrently (see
+// HloComputationPass).
+class HloCSE : public HloComputationPass {
  public:
   // If is_layout_sensitive is true, then the simplifier preserves layout during
   // transformation. Otherwise, layout is ignored.
@@ -42,12 +45,11 @@ class HloCSE : public HloModulePass {
   ~HloCSE() override = default;
   absl::string_view name() const override { return "cse"; }
 
-  // Run CSE on the given module. Returns whether the module was changed (common
-  // subexpressions were found and eliminated).
-  using HloPassInterface::Run;
-  absl::StatusOr<bool> Run(
-      HloModule* module,
-      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+  // Run CSE on the given computation. Returns whether the computation was
+  // changed (common subexpressions were found and eliminated).
+  absl::StatusOr<bool> RunOnComputation(HloComputation* computation) override;
+
+  bool ShouldRunOnComputation(const HloComputation* computation) const override;
 
  private:
   const bool is_layout_sensitive_;
@@ -29,13 +29,16 @@ limitations under the License.
 #include "xla/hlo/utils/hlo_matchers.h"
 #include "xla/layout_util.h"
 #include "xla/literal.h"
+#include "xla/service/hlo_module_config.h"
 #include "xla/service/pattern_matcher.h"
 #include "xla/service/pattern_matcher_gmock.h"
 #include "xla/shape_util.h"
+#include "xla/test_helpers.h"
 #include "xla/tests/hlo_test_base.h"
 #include "xla/tests/literal_test_util.h"
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
+#include "tsl/platform/test_benchmark.h"
 
 namespace xla {
 namespace {
@@ -949,6 +952,33 @@ TEST_F(HloCseTest, MultiOutputFusion) {
   EXPECT_EQ(add0, add1);
 }
 
+TEST_F(HloCseTest, ConvertsToDifferentTypes) {
+  const char* const hlo_string = R"(
+    HloModule m
+
+    ENTRY test {
+      p0 = f32[10] parameter(0)
+      c0 = bf16[10] convert(p0)
+      c1 = f16[10] convert(p0)
+      c2 = bf16[10] convert(p0)
+      ROOT t = (bf16[10], f16[10], bf16[10]) tuple(c0, c1, c2)
+    }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  ASSERT_TRUE(HloCSE(/*is_layout_sensitive=*/false).Run(module.get()).value());
+
+  const HloInstruction* c0;
+  const HloInstruction* c1;
+  const HloInstruction* c2;
+  ASSERT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Tuple(m::Convert(&c0, m::Parameter(0)),
+                                  m::Convert(&c1, m::Parameter(0)),
+                                  m::Convert(&c2, m::Parameter(0)))));
+  EXPECT_EQ(c0, c2);
+  EXPECT_NE(c0, c1);
+}
+
 class HloCseCommutativeOpTest
     : public HloCseTest,
       public ::testing::WithParamInterface<std::string /*op*/> {};
@@ -983,5 +1013,43 @@ INSTANTIATE_TEST_SUITE_P(AlgebraicSimplifierCanonicalizeCommutativeTestSuite,
                          ::testing::Values("add", "multiply", "and", "or",
                                            "xor", "minimum", "maximum"));
 
+// Builds two identical chains of `size` alternating converts and negates
+// hanging off one parameter; CSE folds the second chain into the first.
+std::unique_ptr<HloModule> MakeDuplicateChainsModule(int size) {
+  const Shape f32 = ShapeUtil::MakeShape(F32, {128});
+  const Shape bf16 = ShapeUtil::MakeShape(BF16, {128});
+  auto builder = HloComputation::Builder("duplicate_chains");
+  HloInstruction* param =
+      builder.AddInstruction(HloInstruction::CreateParameter(0, f32, "p"));
+  std::vector<HloInstruction*> chains = {param, param};
+  for (int i = 0; i < size; ++i) {
+    for (HloInstruction*& prev : chains) {
+      HloInstruction* convert = builder.AddInstruction(
+          HloInstruction::CreateConvert(bf16, prev));
+      HloInstruction* back = builder.AddInstruction(
+          HloInstruction::CreateConvert(f32, convert));
+      prev = builder.AddInstruction(
+          HloInstruction::CreateUnary(f32, HloOpcode::kNegate, back));
+    }
+  }
+  builder.AddInstruction(HloInstruction::CreateTuple(chains));
+  auto module =
+      std::make_unique<HloModule>("duplicate_chains", HloModuleConfig());
+  module->AddEntryComputation(builder.Build());
+  return module;
+}
+
+void BM_HloCSE(::testing::benchmark::State& state) {
+  const int size = state.range(0);
+  for (auto s : state) {
+    state.PauseTiming();
+    std::unique_ptr<HloModule> module = MakeDuplicateChainsModule(size);
+    state.ResumeTiming();
+    ASSERT_IS_OK(
+        HloCSE(/*is_layout_sensitive=*/false).Run(module.get()).status());
+  }
+}
+BENCHMARK(BM_HloCSE)->Range(64, 64 * 1024);
+
 }  // namespace
 }  // namespace xla
@@ -0,0 +1,137 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/hlo_graph_cycles.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+
+namespace xla {
+
+std::unique_ptr<HloGraphCycles> HloGraphCycles::Build(
+    const HloComputation* computation) {
+  auto result = std::make_unique<HloGraphCycles>();
+  std::vector<HloInstruction*> post_order =
+      computation->MakeInstructionPostOrder();
+  result->nodes_.reserve(post_order.size());
+
+  // Allocating nodes in post order makes the initial ranks a topological
+  // order, so none of the edges below requires reordering.
+  for (const HloInstruction* instruction : post_order) {
+    result->nodes_[instruction] = result->graph_.NewNode();
+  }
+  for (const HloInstruction* instruction : post_order) {
+    int32_t node = result->nodes_[instruction];
+    for (const HloInstruction* operand : instruction->operands()) {
+      result->graph_.InsertEdge(result->nodes_[operand], node);
+    }
+    for (const HloInstruction* predecessor :
+         instruction->control_predecessors()) {
+      result->graph_.InsertEdge(result->nodes_[predecessor], node);
+    }
+  }
+  return result;
+}
+
+std::optional<int32_t> HloGraphCycles::FindNode(
+    const HloInstruction* instruction) const {
+  auto it = nodes_.find(instruction);
+  if (it == nodes_.end() &&
+      instruction->opcode() == HloOpcode::kGetTupleElement) {
+    it = nodes_.find(instruction->operand(0));
+  }
+  if (it == nodes_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+int32_t HloGraphCycles::GetNode(const HloInstruction* instruction) const {
+  std::optional<int32_t> node = FindNode(instruction);
+  CHECK(node.has_value()) << "Instruction " << instruction->name()
+                          << " is not in the graph";
+  return *node;
+}
+
+bool HloGraphCycles::IsPresent(const HloInstruction* instruction) const {
+  return nodes_.contains(instruction);
+}
+
+bool HloGraphCycles::IsReachable(const HloInstruction* from,
+                                 const HloInstruction* to) const {
+  return graph_.IsReachableNonConst(GetNode(from), GetNode(to));
+}
+
+bool HloGraphCycles::IsConnected(const HloInstruction* a,
+                                 const HloInstruction* b) const {
+  return IsReachable(a, b) || IsReachable(b, a);
+}
+
+void HloGraphCycles::MergeNodes(int32_t into, int32_t from) {
+  graph_.RemoveEdge(from, into);
+  graph_.RemoveEdge(into, from);
+  for (int32_t predecessor : graph_.PredecessorsCopy(from)) {
+    bool inserted = graph_.InsertEdge(predecessor, into);
+    CHECK(inserted) << "Merging nodes introduced a cycle";
+  }
+  for (int32_t successor : graph_.SuccessorsCopy(from)) {
+    if (successor == into) continue;
+    bool inserted = graph_.InsertEdge(into, successor);
+    CHECK(inserted) << "Merging nodes introduced a cycle";
+  }
+  graph_.RemoveNode(from);
+}
+
+void HloGraphCycles::Merge(const HloInstruction* fusion,
+                           const HloInstruction* fused) {
+  int32_t into = GetNode(fusion);
+  auto it = nodes_.find(fused);
+  CHECK(it != nodes_.end()) << fused->name() << " is not in the graph";
+  int32_t from = it->second;
+  nodes_.erase(it);
+
+  // Merging a multi-output fusion replaces its get-tuple-element users with
+  // new ones reading from `fusion`.
+  if (fused->opcode() == HloOpcode::kFusion) {
+    for (const HloInstruction* user : fused->users()) {
+      auto user_it = nodes_.find(user);
+      if (user->opcode() == HloOpcode::kGetTupleElement &&
+          user_it != nodes_.end()) {
+        int32_t user_node = user_it->second;
+        nodes_.erase(user_it);
+        MergeNodes(into, user_node);
+      }
+    }
+  }
+  MergeNodes(into, from);
+}
+
+void HloGraphCycles::Replace(const HloInstruction* instruction,
+                             const HloInstruction* replacement) {
+  auto it = nodes_.find(instruction);
+  CHECK(it != nodes_.end()) << "Replaced instruction is not in the graph";
+  int32_t node = it->second;
+  nodes_.erase(it);
+  nodes_[replacement] = node;
+}
+
+}  // namespace xla
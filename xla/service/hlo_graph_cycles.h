@@ -0,0 +1,90 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_HLO_GRAPH_CYCLES_H_
+#define XLA_SERVICE_HLO_GRAPH_CYCLES_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "llvm/ADT/DenseMap.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/service/graphcycles/graphcycles.h"
+
+namespace xla {
+
+// Reachability between the instructions of a computation that is kept up to
+// date incrementally while the computation is being fused.
+//
+// HloDfsReachability and HloReachabilityMap are snapshots: after every fusion
+// they have to be rebuilt from scratch, which is quadratic in the number of
+// instructions for passes that fuse repeatedly. HloGraphCycles instead keeps a
+// GraphCycles graph with one node per instruction (edges are operands and
+// control predecessors) and lets the caller merge nodes as instructions are
+// fused together. GraphCycles maintains a topological rank for every node, so
+// reachability queries only visit nodes ranked between the two endpoints.
+//
+// Get-tuple-element instructions created by multi-output fusion after Build()
+// are not tracked; queries about them are answered for their operand instead.
+//
+// The class is not thread safe, including the const query methods.
+class HloGraphCycles {
+ public:
+  static std::unique_ptr<HloGraphCycles> Build(
+      const HloComputation* computation);
+
+  // Returns true iff the instruction has a node in the graph.
+  bool IsPresent(const HloInstruction* instruction) const;
+
+  // Returns true iff there is a path (with edges being users and control
+  // successors) from 'from' to 'to'.
+  bool IsReachable(const HloInstruction* from, const HloInstruction* to) const;
+
+  // Returns true iff either `a` is reachable from `b` or `b` is reachable from
+  // `a`.
+  bool IsConnected(const HloInstruction* a, const HloInstruction* b) const;
+
+  // Updates the graph for fusing `fused` into `fusion`, either as a producer or
+  // as a sibling. Must be called before the fusion is performed. All edges of
+  // `fused` are moved to `fusion` and `fused` is forgotten. If `fused` is a
+  // multi-output fusion, its get-tuple-element users are forgotten as well,
+  // since merging the fusions replaces them. The fusion must not introduce a
+  // cycle.
+  void Merge(const HloInstruction* fusion, const HloInstruction* fused);
+
+  // Makes `replacement` take over the node of `instruction`, e.g. when a newly
+  // created fusion instruction replaces its only fused instruction.
+  void Replace(const HloInstruction* instruction,
+               const HloInstruction* replacement);
+
+ private:
+  std::optional<int32_t> FindNode(const HloInstruction* instruction) const;
+  int32_t GetNode(const HloInstruction* instruction) const;
+
+  // Moves all edges of node `from` to node `into` and removes `from`.
+  void MergeNodes(int32_t into, int32_t from);
+
+  llvm::DenseMap<const HloInstruction*, int32_t> nodes_;
+
+  // Reachability queries on GraphCycles are fastest through the non-const
+  // API, which only uses internal scratch state.
+  mutable GraphCycles graph_;
+};
+
+}  // namespace xla
+
+#endif  // XLA_SERVICE_HLO_GRAPH_CYCLES_H_
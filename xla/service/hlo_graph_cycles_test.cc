@@ -0,0 +1,102 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/hlo_graph_cycles.h"
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/tests/hlo_test_base.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace {
+
+using HloGraphCyclesTest = HloTestBase;
+
+TEST_F(HloGraphCyclesTest, Reachability) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+    HloModule m
+
+    ENTRY e {
+      p0 = f32[] parameter(0)
+      a = f32[] negate(p0)
+      b = f32[] exponential(p0)
+      c = f32[] sqrt(a)
+      d = f32[] copy(p0), control-predecessors={c}
+      ROOT e = f32[] add(b, c)
+    })"));
+  auto graph = HloGraphCycles::Build(module->entry_computation());
+
+  HloInstruction* p0 = FindInstruction(module.get(), "p0");
+  HloInstruction* a = FindInstruction(module.get(), "a");
+  HloInstruction* b = FindInstruction(module.get(), "b");
+  HloInstruction* c = FindInstruction(module.get(), "c");
+  HloInstruction* d = FindInstruction(module.get(), "d");
+  HloInstruction* e = FindInstruction(module.get(), "e");
+
+  EXPECT_TRUE(graph->IsPresent(p0));
+  EXPECT_TRUE(graph->IsReachable(p0, e));
+  EXPECT_TRUE(graph->IsReachable(a, e));
+  EXPECT_FALSE(graph->IsReachable(e, a));
+  EXPECT_TRUE(graph->IsReachable(a, d));
+  EXPECT_FALSE(graph->IsConnected(b, c));
+  EXPECT_TRUE(graph->IsConnected(e, a));
+}
+
+TEST_F(HloGraphCyclesTest, MergeMovesEdgesToFusion) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+    HloModule m
+
+    ENTRY e {
+      p0 = f32[] parameter(0)
+      a = f32[] negate(p0)
+      b = f32[] exponential(p0)
+      c = f32[] sqrt(a)
+      d = f32[] tanh(b)
+      ROOT e = f32[] add(c, d)
+    })"));
+  auto graph = HloGraphCycles::Build(module->entry_computation());
+
+  HloInstruction* a = FindInstruction(module.get(), "a");
+  HloInstruction* b = FindInstruction(module.get(), "b");
+  HloInstruction* c = FindInstruction(module.get(), "c");
+  HloInstruction* d = FindInstruction(module.get(), "d");
+
+  EXPECT_FALSE(graph->IsConnected(a, b));
+  EXPECT_FALSE(graph->IsConnected(a, d));
+
+  // Fuse sibling `a` into `b`: `b` inherits the user `c`.
+  graph->Merge(b, a);
+  EXPECT_FALSE(graph->IsPresent(a));
+  EXPECT_TRUE(graph->IsReachable(b, c));
+  EXPECT_FALSE(graph->IsConnected(c, d));
+
+  // Fuse producer `b` into its consumer `d`, which is now connected to `c`.
+  graph->Merge(d, b);
+  EXPECT_FALSE(graph->IsPresent(b));
+  EXPECT_TRUE(graph->IsReachable(d, c));
+
+  // A replacement takes over the edges of the replaced instruction.
+  graph->Replace(d, a);
+  EXPECT_TRUE(graph->IsPresent(a));
+  EXPECT_FALSE(graph->IsPresent(d));
+  EXPECT_TRUE(graph->IsReachable(a, c));
+}
+
+}  // namespace
+}  // namespace xla
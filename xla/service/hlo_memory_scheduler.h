@@ -106,10 +106,25 @@ absl::StatusOr<HloInstructionSequence> PostOrderMemoryScheduler(
     const LogicalBuffer::SizeFunction& size_function,
     const MemorySchedulerPostprocessor& postprocessor, int64_t* peak_memory);
 
+// Beam search scheduler
+//
+// Keeps a few partial sequences at once, ranked by the peak memory under the
+// list scheduler's memory model, and extends each with its most promising
+// ready instructions. This avoids some of the list scheduler's greedy mistakes
+// at a small constant factor in compile time. Computations with more than a
+// thousand instructions are scheduled with the list scheduler instead.
+absl::StatusOr<HloInstructionSequence> BeamMemoryScheduler(
+    HloComputation* computation,
+    const TuplePointsToAnalysis& points_to_analysis,
+    const HloAliasAnalysis& alias_analysis,
+    const BufferValue::SizeFunction& size_function,
+    const MemorySchedulerPostprocessor& postprocessor, int64_t* peak_memory);
+
 // The default scheduling algorithm. Runs the list scheduler, the DFS scheduler,
-// and the post-order scheduler and chooses whichever returns a lower min-
-// memory, not accounting for fragmentation. peak_memory (may be nullptr) is set
-// to the peak memory of the resulting schedule according to the HeapSimulator.
+// the post-order scheduler and the beam search scheduler and chooses whichever
+// returns a lower min-memory, not accounting for fragmentation. peak_memory
+// (may be nullptr) is set to the peak memory of the resulting schedule
+// according to the HeapSimulator.
 absl::StatusOr<HloInstructionSequence> DefaultMemoryScheduler(
     HloComputation* computation,
     const TuplePointsToAnalysis& points_to_analysis,
@@ -117,6 +132,8 @@ absl::StatusOr<HloInstructionSequence> DefaultMemoryScheduler(
     const LogicalBuffer::SizeFunction& size_function,
     const MemorySchedulerPostprocessor& postprocessor, int64_t* peak_memory);
 
+// Module-level version of DefaultMemoryScheduler. The candidate schedulers are
+// run concurrently for large modules.
 absl::StatusOr<HloSchedule> DefaultModuleScheduler(
     const HloModule* module, const TuplePointsToAnalysis& points_to_analysis,
     const HloAliasAnalysis& alias_analysis,
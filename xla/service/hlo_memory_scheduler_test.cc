@@ -444,5 +444,64 @@ TEST_F(HloSchedulingTest, BFSScheduler) {
   EXPECT_TRUE(absl::c_is_sorted(indices));
 }
 
+TEST_F(HloSchedulingTest, BeamSchedulerBeatsGreedyListScheduler) {
+  // The counterexample from the list scheduler's comment: the list scheduler
+  // defers %b because its output is larger than its input, and ends up keeping
+  // it alive together with %f. Scheduling %b and %c first is better.
+  const char* const hlo_string = R"(
+    HloModule m
+
+    add {
+      p0 = f32[] parameter(0)
+      p1 = f32[] parameter(1)
+      ROOT add = f32[] add(p0, p1)
+    }
+
+    ENTRY e {
+      p = f32[1] parameter(0)
+      zero = f32[] constant(0)
+      a = f32[1] negate(p)
+      b = f32[4] concatenate(a, a, a, a), dimensions={0}
+      c = f32[] reduce(b, zero), dimensions={0}, to_apply=add
+      d = f32[1] exponential(a)
+      e = f32[1] abs(a)
+      f = f32[2] concatenate(d, e), dimensions={0}
+      ROOT g = f32[] reduce(f, c), dimensions={0}, to_apply=add
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  auto size_fn = [](const BufferValue& buffer) {
+    return ShapeUtil::ByteSizeOf(buffer.shape());
+  };
+
+  int64_t list_memory;
+  TF_ASSERT_OK(ScheduleModule(module.get(), size_fn,
+                              ComputationSchedulerToModuleScheduler(
+                                  ListMemoryScheduler),
+                              /*execution_threads=*/{}, &list_memory)
+                   .status());
+
+  int64_t beam_memory;
+  TF_ASSERT_OK_AND_ASSIGN(
+      HloSchedule schedule,
+      ScheduleModule(module.get(), size_fn,
+                     ComputationSchedulerToModuleScheduler(BeamMemoryScheduler),
+                     /*execution_threads=*/{}, &beam_memory));
+  TF_ASSERT_OK(schedule.Verify());
+  EXPECT_LT(beam_memory, list_memory);
+
+  SequentialHloOrdering ordering(schedule);
+  EXPECT_TRUE(ordering.ExecutesBefore(FindInstruction(module.get(), "c"),
+                                      FindInstruction(module.get(), "f")));
+
+  int64_t default_memory;
+  TF_ASSERT_OK(ScheduleModule(module.get(), size_fn, DefaultModuleScheduler,
+                              /*execution_threads=*/{}, &default_memory)
+                   .status());
+  EXPECT_LE(default_memory, beam_memory);
+}
+
 }  // namespace
 }  // namespace xla
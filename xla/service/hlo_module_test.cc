@@ -30,6 +30,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/utils/hlo_matchers.h"
 #include "xla/literal.h"
+#include "xla/literal_util.h"
 #include "xla/service/computation_placer.h"
 #include "xla/service/hlo_memory_scheduler.h"
 #include "xla/service/test_compilation_environment.pb.h"
@@ -350,6 +351,31 @@ TEST_F(HloModuleTest, LargeConstantToString) {
       module->ToString(HloPrintOptions().set_print_large_constants(true)));
 }
 
+TEST_F(HloModuleTest, Fingerprint128) {
+  // The constant is printed across several chunks of the fingerprint printer.
+  auto make_module = [&](float last_value) {
+    auto module = CreateNewVerifiedModule();
+    auto builder = HloComputation::Builder("Constant");
+    std::vector<float> values(10000, 42.0);
+    values.back() = last_value;
+    builder.AddInstruction(
+        HloInstruction::CreateConstant(LiteralUtil::CreateR1<float>(values)));
+    module->AddEntryComputation(builder.Build());
+    return module;
+  };
+  auto options = HloPrintOptions::ModuleFingerprint()
+                     .set_print_only_essential_constants(false)
+                     .set_print_large_constants(true);
+
+  auto module = make_module(1.0);
+  EXPECT_EQ(module->GetFingerprint128(options),
+            make_module(1.0)->GetFingerprint128(options));
+  EXPECT_EQ(module->GetFingerprint128(options),
+            module->Clone()->GetFingerprint128(options));
+  EXPECT_NE(module->GetFingerprint128(options),
+            make_module(2.0)->GetFingerprint128(options));
+}
+
 TEST_F(HloModuleTest, UniqueModuleId) {
   auto module_a = CreateNewVerifiedModule();
   auto module_b = CreateNewVerifiedModule();
@@ -377,6 +403,38 @@ ENTRY %axpy.v5 (alpha: f32[], x: f32[2,4], y: f32[2,4]) -> f32[2,4] {
   ASSERT_FALSE(module_copy->has_schedule());
 }
 
+TEST_F(HloModuleTest, ProtoSerializationConsumesConstants) {
+  const std::string text = R"(
+HloModule constant_module
+
+fused_computation {
+  p0 = f32[4]{0} parameter(0)
+  c0 = f32[4]{0} constant({1, 2, 3, 4})
+  ROOT add = f32[4]{0} add(p0, c0)
+}
+
+ENTRY entry {
+  p0 = f32[4]{0} parameter(0)
+  c1 = f32[4]{0} constant({5, 6, 7, 8})
+  fusion = f32[4]{0} fusion(p0), kind=kLoop, calls=fused_computation
+  ROOT multiply = f32[4]{0} multiply(fusion, c1)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(text));
+  HloModuleProto proto = module->ToProto();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module_copy,
+      HloModule::CreateFromProto(std::move(proto), module->config()));
+  EXPECT_EQ(module->ToString(), module_copy->ToString());
+
+  const HloInstruction* c0 = FindInstruction(module_copy.get(), "c0");
+  const HloInstruction* c1 = FindInstruction(module_copy.get(), "c1");
+  ASSERT_NE(c0, nullptr);
+  ASSERT_NE(c1, nullptr);
+  EXPECT_EQ(c0->literal(), LiteralUtil::CreateR1<float>({1, 2, 3, 4}));
+  EXPECT_EQ(c1->literal(), LiteralUtil::CreateR1<float>({5, 6, 7, 8}));
+}
+
 TEST_F(HloModuleTest, ProtoSerializationWithSchedule) {
   const std::string text = R"(
 HloModule axpy_module, is_scheduled=true
@@ -19,6 +19,7 @@ limitations under the License.
 #include <set>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/random/random.h"
 #include "xla/hlo/ir/hlo_instruction.h"
@@ -94,6 +95,42 @@ TEST_F(HloReachabilityTest, Reachability) {
   EXPECT_FALSE(reachability.SetReachabilityToUnion({b, c}, d));
 }
 
+TEST_F(HloReachabilityTest, ReachabilityAcrossWordBoundaries) {
+  // A chain of more than two words' worth of instructions, so that bit-sets of
+  // different lengths are unioned and compared.
+  constexpr int kLength = 150;
+  Shape r0f32 = ShapeUtil::MakeShape(F32, {});
+  auto builder = HloComputation::Builder(TestName());
+  std::vector<HloInstruction*> chain;
+  chain.push_back(builder.AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateR0<float>(1.0f))));
+  for (int i = 1; i < kLength; ++i) {
+    chain.push_back(builder.AddInstruction(
+        HloInstruction::CreateUnary(r0f32, HloOpcode::kExp, chain.back())));
+  }
+  auto module = CreateNewVerifiedModule();
+  HloComputation* computation =
+      module->AddEntryComputation(builder.Build(chain.back()));
+
+  auto reachability = HloReachabilityMap::Build(computation);
+  EXPECT_TRUE(reachability->IsReachable(chain.front(), chain.back()));
+  EXPECT_TRUE(reachability->IsReachable(chain[63], chain[64]));
+  EXPECT_FALSE(reachability->IsReachable(chain.back(), chain.front()));
+  EXPECT_FALSE(reachability->IsReachable(chain[64], chain[63]));
+
+  // Recomputing an unchanged set must not report a change, even though the
+  // union briefly copies the set.
+  EXPECT_FALSE(reachability->SetReachabilityToUnion({chain[99]}, chain[100]));
+
+  // Making the first instruction reachable from the last one extends a short
+  // set with bits from a long one.
+  EXPECT_TRUE(
+      reachability->SetReachabilityToUnion({chain.back()}, chain.front()));
+  EXPECT_TRUE(reachability->IsReachable(chain[kLength - 2], chain.front()));
+  EXPECT_FALSE(
+      reachability->SetReachabilityToUnion({chain.back()}, chain.front()));
+}
+
 TEST_F(HloReachabilityTest, NonTrivialReachability) {
   // Test reachability of a non-trivial computation:
   //
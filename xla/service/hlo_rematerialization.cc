@@ -41,6 +41,8 @@ limitations under the License.
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xla/hlo/ir/hlo_casting_utils.h"
 #include "xla/hlo/ir/hlo_clone_context.h"
@@ -2545,6 +2547,17 @@ absl::StatusOr<InstructionsAdded> RematerializeBestBlock(
     return num_instructions_added;
   }
 
+  // The rewrite below replaces operands of the users of `best_items` and might
+  // remove instructions, whose addresses can then be reused by new
+  // instructions. Their cached rematerializable status is dropped afterwards.
+  std::vector<const HloInstruction*> rewritten_instructions;
+  for (Item* item : best_items) {
+    rewritten_instructions.push_back(item->instruction);
+    for (const HloInstruction* user : item->instruction->users()) {
+      rewritten_instructions.push_back(user);
+    }
+  }
+
   if (best_strategy.kind == RematStrategy::kCompress) {
     CHECK(best_items.size() == 1)
         << "More than one instruction compressed simultaneously.";
@@ -2584,6 +2597,9 @@ absl::StatusOr<InstructionsAdded> RematerializeBestBlock(
                                   remat_move_instructions, instruction_list,
                                   schedule, rematerialization));
   }
+  for (const HloInstruction* instruction : rewritten_instructions) {
+    rematerializable_map->erase(instruction);
+  }
   return num_instructions_added;
 }
 }  // namespace
@@ -2666,9 +2682,6 @@ absl::StatusOr<bool> HloRematerialization::RematerializeComputation(
   // denylist.
   absl::flat_hash_set<const HloInstruction*> remat_move_instructions;
 
-  // The map from instructions to their rematerializable status.
-  absl::flat_hash_map<const HloInstruction*, bool> rematerializable_map;
-
   // The peak memory of the computation at any point in the instruction
   // sequence.
   int64_t peak_memory = memory_tracker.memory_usage();
@@ -2714,7 +2727,8 @@ absl::StatusOr<bool> HloRematerialization::RematerializeComputation(
       int64_t first_phase_effort = 0;
       int64_t second_phase_effort = 0;
       while (memory_tracker.memory_usage() + callee_usage >
-             memory_limit_bytes) {
+                 memory_limit_bytes &&
+             !BudgetExhausted()) {
         VLOG(2) << "Over memory limit at instruction " << instruction->name()
                 << ", using "
                 << HumanReadableNumBytes(memory_tracker.memory_usage() +
@@ -2725,8 +2739,9 @@ absl::StatusOr<bool> HloRematerialization::RematerializeComputation(
             InstructionsAdded instructions_added,
             RematerializeBestBlock(min_block_size, max_block_size,
                                    &memory_tracker, &instruction_list, schedule,
-                                   memory_limit_bytes, &rematerializable_map,
+                                   memory_limit_bytes, &rematerializable_map_,
                                    &remat_move_instructions, this));
+        effort_spent_ += instructions_added.effort;
         net_instructions_added += instructions_added.net_instructions_added;
         remat_count += instructions_added.remat_count;
         if (is_first_phase) {
@@ -2753,7 +2768,7 @@ absl::StatusOr<bool> HloRematerialization::RematerializeComputation(
           min_block_size = 1;
           max_block_size = 1;
         }
-        if (max_block_size > options_.block_size_limit ||
+        if (max_block_size > block_size_limit_ ||
             second_phase_effort >
                 options_.block_rematerialization_factor * first_phase_effort) {
           break;
@@ -2763,7 +2778,8 @@ absl::StatusOr<bool> HloRematerialization::RematerializeComputation(
     const CallSite* callsite = call_graph_node.GetCallSite(instruction);
     if (callsite != nullptr &&
         callsite->context() == CallContext::kControlFlow &&
-        memory_tracker.memory_usage() + callee_usage > memory_limit_bytes) {
+        memory_tracker.memory_usage() + callee_usage > memory_limit_bytes &&
+        !BudgetExhausted()) {
       // Memory usage exceeds the limit. Try to rematerialize any
       // subcomputation(s) that this instruction calls.
       VLOG(1) << "Memory usage still over the limit ("
@@ -2835,6 +2851,24 @@ absl::StatusOr<bool> HloRematerialization::RematerializeComputation(
   return changed;
 }
 
+bool HloRematerialization::BudgetExhausted() {
+  if (budget_exhausted_) {
+    return true;
+  }
+  if (options_.effort_budget >= 0 && effort_spent_ >= options_.effort_budget) {
+    LOG(WARNING) << "Rematerialization effort budget of "
+                 << options_.effort_budget
+                 << " exhausted; keeping the rematerializations found so far";
+    budget_exhausted_ = true;
+  } else if (deadline_ != absl::InfiniteFuture() && absl::Now() >= deadline_) {
+    LOG(WARNING) << "Rematerialization time budget of "
+                 << absl::FormatDuration(options_.time_budget)
+                 << " exhausted; keeping the rematerializations found so far";
+    budget_exhausted_ = true;
+  }
+  return budget_exhausted_;
+}
+
 absl::StatusOr<bool> HloRematerialization::Run(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
@@ -2862,6 +2896,10 @@ absl::StatusOr<bool> HloRematerialization::Run(
   rematerialized_computations_.clear();
   instructions_rematerialized_ = 0;
   net_instructions_added_ = 0;
+  effort_spent_ = 0;
+  deadline_ = absl::Now() + options_.time_budget;
+  budget_exhausted_ = false;
+  rematerializable_map_.clear();
 
   TF_RET_CHECK(module->has_schedule());
   TF_ASSIGN_OR_RETURN(points_to_analysis_, TuplePointsToAnalysis::Run(module));
@@ -2976,11 +3014,35 @@ absl::StatusOr<bool> HloRematerialization::Run(
 
   // Subcomputations called by the entry computation will also be
   // rematerialized.
+  block_size_limit_ =
+      options_.greedy_first_pass ? 1 : options_.block_size_limit;
   TF_ASSIGN_OR_RETURN(
       bool changed,
       RematerializeComputation(module->entry_computation(), &module->schedule(),
                                adjusted_memory_limit_bytes,
                                options_.min_remat_size, execution_threads));
+  if (block_size_limit_ < options_.block_size_limit &&
+      computation_peak_memory_.at(module->entry_computation()) >
+          adjusted_memory_limit_bytes &&
+      !BudgetExhausted()) {
+    VLOG(1) << "Still over the memory limit after rematerializing single "
+               "instructions; searching for blocks of up to "
+            << options_.block_size_limit << " instructions";
+    // The first pass added instructions to the module, so the analyses need to
+    // be recomputed before looking at the computations again.
+    rematerialized_computations_.clear();
+    TF_ASSIGN_OR_RETURN(points_to_analysis_,
+                        TuplePointsToAnalysis::Run(module));
+    call_graph_ = CallGraph::Build(module);
+    block_size_limit_ = options_.block_size_limit;
+    TF_ASSIGN_OR_RETURN(
+        bool blocks_changed,
+        RematerializeComputation(
+            module->entry_computation(), &module->schedule(),
+            adjusted_memory_limit_bytes, options_.min_remat_size,
+            execution_threads));
+    changed |= blocks_changed;
+  }
   // Rematerialization can introduce dead code. This occurs if all uses of an
   // instruction are replaced with rematerializations of the instruction.
 
@@ -25,6 +25,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_module.h"
@@ -153,6 +154,21 @@ class HloRematerialization : public HloModulePass {
     // Collection of async entry computations and their number of parallel
     // invocations.
     absl::flat_hash_map<HloComputation*, int64_t> async_computation_parallelism;
+
+    // Maximum number of rematerialization candidates to evaluate in the whole
+    // pass. Once the budget is exhausted, no more candidates are evaluated and
+    // the rematerializations found so far are kept. -1 means no limit.
+    int64_t effort_budget = -1;
+
+    // Maximum wall time to spend searching for rematerialization candidates.
+    // Works like effort_budget, but the result depends on the speed of the
+    // machine and thus isn't deterministic.
+    absl::Duration time_budget = absl::InfiniteDuration();
+
+    // If true, first only rematerializes single instructions for the whole
+    // module, and only searches for larger blocks of instructions if the module
+    // still exceeds the memory limit afterwards.
+    bool greedy_first_pass = false;
   };
 
   explicit HloRematerialization(Options options, RematerializationSizes& sizes)
@@ -205,6 +221,9 @@ class HloRematerialization : public HloModulePass {
       const HloInstruction* instruction,
       const absl::flat_hash_set<absl::string_view>& execution_threads) const;
 
+  // Returns whether the effort or time budget of the pass is exhausted.
+  bool BudgetExhausted();
+
   const Options options_;
 
   // Reference to data structure which records the peak memory usage of the HLO
@@ -243,6 +262,19 @@ class HloRematerialization : public HloModulePass {
   // Tracking available channel id numbers to use to apply to rematerialized
   // channel instructions
   int64_t next_channel_id_;
+
+  // Maximum number of consecutive instructions to consider for
+  // rematerialization in the current pass over the module.
+  int block_size_limit_ = 0;
+
+  // The effort spent so far and the time at which the time budget runs out.
+  int64_t effort_spent_ = 0;
+  absl::Time deadline_ = absl::InfiniteFuture();
+  bool budget_exhausted_ = false;
+
+  // The map from instructions to their rematerializable status, shared by all
+  // computations and passes over the module.
+  absl::flat_hash_map<const HloInstruction*, bool> rematerializable_map_;
 };
 
 }  // namespace xla
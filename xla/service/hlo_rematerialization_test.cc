@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -134,9 +135,10 @@ ENTRY %main {
 class RecomputeAndCompressHloRematerializationTest
     : public RematerializationTestBase {
  protected:
-  absl::StatusOr<bool> RunHloRematerialization(int64_t memory_limit_bytes,
-                                               HloModule* module,
-                                               int64_t min_remat_size = 0) {
+  absl::StatusOr<bool> RunHloRematerialization(
+      int64_t memory_limit_bytes, HloModule* module, int64_t min_remat_size = 0,
+      std::function<void(HloRematerialization::Options&)> update_options =
+          nullptr) {
     TF_EXPECT_OK(verifier().Run(module).status());
     if (!module->has_schedule()) {
       HloMemoryScheduler scheduler(
@@ -164,6 +166,9 @@ class RecomputeAndCompressHloRematerializationTest
         min_remat_size, /*compact_shape_function=*/nullptr,
         /*host_memory_offload_config=*/std::nullopt,
         /*async_threads=*/{});
+    if (update_options) {
+      update_options(options);
+    }
     HloRematerialization::RematerializationSizes sizes;
     HloRematerialization remat(options, sizes);
     absl::StatusOr<bool> result = remat.Run(module);
@@ -245,6 +250,49 @@ TEST_F(RecomputeAndCompressHloRematerializationTest, SingleComputation) {
       ::testing::UnitTest::GetInstance()->current_test_info()->name());
 }
 
+// Test that no rematerialization happens once the effort budget is exhausted.
+TEST_F(RecomputeAndCompressHloRematerializationTest,
+       SingleComputationExhaustedEffortBudget) {
+  auto module = CreateNewVerifiedModule();
+  HloComputation* computation =
+      module->AddEntryComputation(MakeRematerializableComputation());
+  const int64_t instruction_count = computation->instruction_count();
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      RunHloRematerialization(
+          /*memory_limit_bytes=*/14 * 1024, module.get(), /*min_remat_size=*/0,
+          [](HloRematerialization::Options& options) {
+            options.effort_budget = 0;
+          }));
+  EXPECT_FALSE(changed);
+  EXPECT_EQ(computation->instruction_count(), instruction_count);
+}
+
+// Test that the greedy first pass finds the same single instruction
+// rematerialization as the regular search.
+TEST_F(RecomputeAndCompressHloRematerializationTest,
+       SingleComputationGreedyFirstPass) {
+  auto module = CreateNewVerifiedModule();
+  HloComputation* computation =
+      module->AddEntryComputation(MakeRematerializableComputation());
+  const HloInstruction* slice = computation->root_instruction();
+  ASSERT_THAT(slice, op::Slice(op::Concatenate(op::Broadcast(_), _)));
+  const HloInstruction* concat = slice->operand(0);
+  const HloInstruction* bcast = concat->operand(0);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      RunHloRematerialization(
+          /*memory_limit_bytes=*/14 * 1024, module.get(), /*min_remat_size=*/0,
+          [](HloRematerialization::Options& options) {
+            options.block_size_limit = 4;
+            options.greedy_first_pass = true;
+          }));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(concat->operand(0), op::Broadcast(::testing::Ne(bcast)));
+}
+
 // Test rematerialization of a single computation that contains nodes that
 // doesn't contain node worth using remat.
 TEST_F(RecomputeAndCompressHloRematerializationTest,
@@ -82,7 +82,7 @@ HloRunnerInterface::ReadModuleFromModuleBinaryProtofile(
       HloModuleConfig module_config,
       HloModule::CreateModuleConfigFromProto(module_proto, debug_options));
 
-  return HloModule::CreateFromProto(module_proto, module_config);
+  return HloModule::CreateFromProto(std::move(module_proto), module_config);
 }
 
 absl::StatusOr<Literal> HloRunnerInterface::Execute(
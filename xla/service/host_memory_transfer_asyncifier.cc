@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "xla/service/host_memory_transfer_asyncifier.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
@@ -24,9 +26,14 @@ limitations under the License.
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "xla/hlo/ir/dfs_hlo_visitor_with_default.h"
+#include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/layout.h"
+#include "xla/layout_util.h"
+#include "xla/literal_util.h"
+#include "xla/shape.h"
 #include "xla/shape_util.h"
 #include "xla/util.h"
 #include "tsl/platform/errors.h"
@@ -195,16 +202,129 @@ class HostMemoryTransferAsyncifierVisitor : public DfsHloVisitorWithDefault {
   void MarkAsChanged() { changed_ = true; }
 };
 
+// Splits a host to device copy of more than `max_slice_bytes` bytes into host
+// to device dynamic-slices along its most major dimension and concatenates
+// them on the device. Slice users that only read from one chunk are rewritten
+// to read from that chunk directly.
+absl::StatusOr<bool> SliceHostToDeviceCopy(HloInstruction* copy,
+                                           int64_t host_memory_space_color,
+                                           int64_t max_slice_bytes) {
+  const HloInstruction* operand = copy->operand(0);
+  const Shape& shape = copy->shape();
+  if (!shape.IsArray() || shape.rank() == 0 || !shape.has_layout() ||
+      !operand->shape().has_layout() || copy->HasControlDependencies()) {
+    return false;
+  }
+  if (operand->shape().layout().memory_space() != host_memory_space_color ||
+      shape.layout().memory_space() != Layout::kDefaultMemorySpace) {
+    return false;
+  }
+  // Every chunk has to be contiguous in both memory spaces.
+  if (!Layout::Equal().IgnoreMemorySpace()(operand->shape().layout(),
+                                           shape.layout()) ||
+      !shape.layout().tiles().empty()) {
+    return false;
+  }
+  const int64_t byte_size = ShapeUtil::ByteSizeOf(shape);
+  if (byte_size <= max_slice_bytes) {
+    return false;
+  }
+  const int64_t dim = LayoutUtil::Major(shape.layout(), 0);
+  const int64_t dim_size = shape.dimensions(dim);
+  const int64_t num_chunks =
+      std::min(dim_size, CeilOfRatio(byte_size, max_slice_bytes));
+  if (num_chunks < 2) {
+    return false;
+  }
+  const int64_t chunk_size = CeilOfRatio(dim_size, num_chunks);
+
+  HloComputation* computation = copy->parent();
+  auto add_index = [&](int64_t value) {
+    return computation->AddInstruction(HloInstruction::CreateConstant(
+        LiteralUtil::CreateR0<int32_t>(static_cast<int32_t>(value))));
+  };
+  HloInstruction* zero = add_index(0);
+  std::vector<HloInstruction*> chunks;
+  for (int64_t start = 0; start < dim_size; start += chunk_size) {
+    Shape chunk_shape = shape;
+    chunk_shape.set_dimensions(dim, std::min(chunk_size, dim_size - start));
+    std::vector<HloInstruction*> start_indices(shape.rank(), zero);
+    start_indices[dim] = add_index(start);
+    chunks.push_back(
+        computation->AddInstruction(HloInstruction::CreateDynamicSlice(
+            chunk_shape, copy->mutable_operand(0), start_indices,
+            chunk_shape.dimensions())));
+  }
+  VLOG(1) << "Slicing copy \"" << copy->name() << "\" of " << byte_size
+          << " bytes from host memory into " << chunks.size() << " chunks";
+
+  const std::vector<HloInstruction*> users = copy->users();
+  for (HloInstruction* user : users) {
+    if (user->opcode() != HloOpcode::kSlice || user->slice_strides(dim) != 1) {
+      continue;
+    }
+    const int64_t chunk = user->slice_starts(dim) / chunk_size;
+    const int64_t chunk_start = chunk * chunk_size;
+    if (user->slice_limits(dim) >
+        chunk_start + chunks[chunk]->shape().dimensions(dim)) {
+      continue;
+    }
+    std::vector<int64_t> starts = user->slice_starts();
+    std::vector<int64_t> limits = user->slice_limits();
+    starts[dim] -= chunk_start;
+    limits[dim] -= chunk_start;
+    HloInstruction* slice =
+        computation->AddInstruction(HloInstruction::CreateSlice(
+            user->shape(), chunks[chunk], starts, limits,
+            user->slice_strides()));
+    TF_RETURN_IF_ERROR(computation->ReplaceInstruction(user, slice));
+  }
+
+  if (copy->IsDead()) {
+    TF_RETURN_IF_ERROR(computation->RemoveInstruction(copy));
+    for (HloInstruction* chunk : chunks) {
+      if (chunk->IsDead()) {
+        TF_RETURN_IF_ERROR(
+            computation->RemoveInstructionAndUnusedOperands(chunk));
+      }
+    }
+    return true;
+  }
+  HloInstruction* concatenate = computation->AddInstruction(
+      HloInstruction::CreateConcatenate(shape, chunks, dim));
+  TF_RETURN_IF_ERROR(computation->ReplaceInstruction(copy, concatenate));
+  return true;
+}
+
 }  // namespace
 
 absl::StatusOr<bool> HostMemoryTransferAsyncifier::Run(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  bool changed = false;
+  if (max_slice_bytes_ > 0) {
+    for (HloComputation* computation : module->MakeNonfusionComputations()) {
+      std::vector<HloInstruction*> copies;
+      for (HloInstruction* instruction : computation->instructions()) {
+        if (instruction->opcode() == HloOpcode::kCopy) {
+          copies.push_back(instruction);
+        }
+      }
+      for (HloInstruction* copy : copies) {
+        TF_ASSIGN_OR_RETURN(bool sliced,
+                            SliceHostToDeviceCopy(copy, kHostMemorySpaceColor,
+                                                  max_slice_bytes_));
+        changed |= sliced;
+      }
+    }
+  }
+  // The visitor turns the dynamic-slices of sliced copies into async
+  // transfers as well.
   HostMemoryTransferAsyncifierVisitor visitor(kHostMemorySpaceColor);
   for (HloComputation* computation : module->MakeNonfusionComputations()) {
     TF_RETURN_IF_ERROR(computation->Accept(&visitor));
   }
-  return visitor.Changed();
+  return changed || visitor.Changed();
 }
 
 }  // namespace xla
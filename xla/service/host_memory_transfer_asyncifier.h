@@ -33,11 +33,19 @@ them into the async ops. This includes, but is not limited to:
  - device to host DynamicSlice
  - host to device Copy
  - device to host Copy
+
+If `max_slice_bytes` is positive, host to device copies of more bytes than
+that are first split along their most major dimension into host to device
+DynamicSlices of at most that size, which become separate async transfers and
+are concatenated on the device. Slices of such a copy that fall into a single
+chunk read directly from that chunk, so they only wait for its transfer.
 */
 class HostMemoryTransferAsyncifier : public HloModulePass {
  public:
-  explicit HostMemoryTransferAsyncifier(int64_t host_memory_space_color)
-      : kHostMemorySpaceColor(host_memory_space_color) {}
+  explicit HostMemoryTransferAsyncifier(int64_t host_memory_space_color,
+                                        int64_t max_slice_bytes = 0)
+      : kHostMemorySpaceColor(host_memory_space_color),
+        max_slice_bytes_(max_slice_bytes) {}
   ~HostMemoryTransferAsyncifier() override = default;
 
   absl::string_view name() const override {
@@ -51,6 +59,7 @@ class HostMemoryTransferAsyncifier : public HloModulePass {
 
  private:
   const int64_t kHostMemorySpaceColor;
+  const int64_t max_slice_bytes_;
 };
 
 }  // namespace xla
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -46,13 +47,15 @@ class HostMemoryTransferAsyncifierTest : public HloTestBase {
     return changed;
   }
 
-  absl::StatusOr<bool> RunAsyncifier(HloModule* module) {
+  absl::StatusOr<bool> RunAsyncifier(HloModule* module,
+                                     int64_t max_slice_bytes = 0) {
     TF_EXPECT_OK(verifier().Run(module).status());
     if (module->has_schedule()) {
       return absl::InternalError("Expected a non-scheduled module");
     }
 
-    HostMemoryTransferAsyncifier asyncifier(kHostMemorySpaceColor);
+    HostMemoryTransferAsyncifier asyncifier(kHostMemorySpaceColor,
+                                            max_slice_bytes);
     return asyncifier.Run(module);
   }
 
@@ -417,6 +420,104 @@ ENTRY main {
                   0, m::Op(&copy_start).WithOpcode(HloOpcode::kCopyStart))));
 }
 
+// ===============================SlicedCopy====================================
+
+TEST_F(HostMemoryTransferAsyncifierTest, SlicedCopyFromHostToDevice) {
+  const std::string& hlo_string = R"(
+HloModule MyModule
+
+ENTRY main {
+  host_memory = f32[8,16]{1,0:S(5)} parameter(0)
+  ROOT copy = f32[8,16]{1,0} copy(host_memory)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  // 512 bytes split into chunks of at most 160 bytes: 4 chunks of 2 rows.
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunAsyncifier(module.get(), /*max_slice_bytes=*/160));
+
+  EXPECT_TRUE(changed);
+  TF_EXPECT_OK(verifier().Run(module.get()).status());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, GmockMatch(m::Concatenate()));
+  EXPECT_EQ(root->concatenate_dimension(), 0);
+  ASSERT_EQ(root->operand_count(), 4);
+  for (const HloInstruction* chunk : root->operands()) {
+    HloInstruction* start;
+    EXPECT_THAT(
+        chunk,
+        GmockMatch(
+            m::Op()
+                .WithOpcode(HloOpcode::kAsyncDone)
+                .WithOperand(
+                    0, m::Op(&start).WithOpcode(HloOpcode::kAsyncStart))));
+    EXPECT_THAT(start->async_wrapped_instruction(),
+                GmockMatch(m::DynamicSlice(m::Parameter(0), m::Constant(),
+                                           m::Constant())));
+    EXPECT_EQ(chunk->shape().dimensions(0), 2);
+  }
+}
+
+TEST_F(HostMemoryTransferAsyncifierTest, SliceOfSlicedCopyReadsOneChunk) {
+  const std::string& hlo_string = R"(
+HloModule MyModule
+
+ENTRY main {
+  host_memory = f32[8,16]{1,0:S(5)} parameter(0)
+  copy = f32[8,16]{1,0} copy(host_memory)
+  ROOT slice = f32[1,16]{1,0} slice(copy), slice={[3:4], [0:16]}
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunAsyncifier(module.get(), /*max_slice_bytes=*/160));
+
+  EXPECT_TRUE(changed);
+  // Only the chunk holding rows [2, 4) is transferred.
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  HloInstruction* start;
+  ASSERT_THAT(
+      root,
+      GmockMatch(m::Slice(
+          m::Op()
+              .WithOpcode(HloOpcode::kAsyncDone)
+              .WithOperand(
+                  0, m::Op(&start).WithOpcode(HloOpcode::kAsyncStart)))));
+  EXPECT_EQ(root->slice_starts(0), 1);
+  EXPECT_EQ(root->slice_limits(0), 2);
+  EXPECT_EQ(start->async_wrapped_instruction()->shape().dimensions(0), 2);
+  EXPECT_EQ(absl::c_count_if(module->entry_computation()->instructions(),
+                             [](const HloInstruction* instruction) {
+                               return instruction->opcode() ==
+                                      HloOpcode::kAsyncStart;
+                             }),
+            1);
+}
+
+TEST_F(HostMemoryTransferAsyncifierTest, SmallCopyFromHostToDeviceIsNotSliced) {
+  const std::string& hlo_string = R"(
+HloModule MyModule
+
+ENTRY main {
+  host_memory = f32[8,16]{1,0:S(5)} parameter(0)
+  ROOT copy = f32[8,16]{1,0} copy(host_memory)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunAsyncifier(module.get(), /*max_slice_bytes=*/512));
+
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              ::testing::Not(GmockMatch(m::Concatenate())));
+}
+
 // =============================================================================
 
 }  // namespace
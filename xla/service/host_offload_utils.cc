@@ -256,5 +256,17 @@ bool IsSynchronousCopyFromOrToHost(const HloInstruction* instruction) {
               Layout::kHostMemorySpace);
 }
 
+bool IsHostToDeviceDynamicSlice(const HloInstruction* instruction) {
+  if (instruction->opcode() != HloOpcode::kDynamicSlice) {
+    return false;
+  }
+  return instruction->shape().has_layout() &&
+         instruction->shape().layout().memory_space() ==
+             Layout::kDefaultMemorySpace &&
+         instruction->operand(0)->shape().has_layout() &&
+         instruction->operand(0)->shape().layout().memory_space() ==
+             Layout::kHostMemorySpace;
+}
+
 }  // namespace host_offload_utils
 }  // namespace xla
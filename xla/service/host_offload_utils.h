@@ -101,6 +101,10 @@ bool IsHostAsyncStart(const HloInstruction* instruction);
 // Returns true if the copy is from or to host memory space.
 bool IsSynchronousCopyFromOrToHost(const HloInstruction* instruction);
 
+// Returns true if the instruction is a dynamic-slice reading from host memory
+// space into device memory space.
+bool IsHostToDeviceDynamicSlice(const HloInstruction* instruction);
+
 }  // namespace host_offload_utils
 }  // namespace xla
 
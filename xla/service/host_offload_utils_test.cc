@@ -109,6 +109,33 @@ ENTRY main {
   EXPECT_EQ(pred, expected_pred);
 }
 
+TEST_F(HostOffloadUtilsTest, IsHostToDeviceDynamicSliceTest) {
+  const std::string& hlo_string = R"(
+HloModule my_module
+ENTRY main {
+  host_param = f32[4,8]{1,0:S(5)} parameter(0)
+  device_param = f32[4,8]{1,0} parameter(1)
+  index = s32[] parameter(2)
+  constant_s32_0 = s32[] constant(0)
+  from_host = f32[1,8]{1,0} dynamic-slice(host_param, index, constant_s32_0), dynamic_slice_sizes={1,8}
+  on_host = f32[1,8]{1,0:S(5)} dynamic-slice(host_param, index, constant_s32_0), dynamic_slice_sizes={1,8}
+  on_device = f32[1,8]{1,0} dynamic-slice(device_param, index, constant_s32_0), dynamic_slice_sizes={1,8}
+  ROOT tuple = (f32[1,8]{1,0}, f32[1,8]{1,0:S(5)}, f32[1,8]{1,0}) tuple(from_host, on_host, on_device)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  EXPECT_TRUE(
+      IsHostToDeviceDynamicSlice(FindInstruction(module.get(), "from_host")));
+  EXPECT_FALSE(
+      IsHostToDeviceDynamicSlice(FindInstruction(module.get(), "on_host")));
+  EXPECT_FALSE(
+      IsHostToDeviceDynamicSlice(FindInstruction(module.get(), "on_device")));
+  EXPECT_FALSE(
+      IsHostToDeviceDynamicSlice(FindInstruction(module.get(), "host_param")));
+}
+
 }  // namespace
 }  // namespace host_offload_utils
 }  // namespace xla
@@ -642,6 +642,8 @@ void MemoryPressureTracker::Initialize(
   pressure_state_ = MemoryPressureState{};
   output_buffers_.clear();
   defined_buffers_.clear();
+  buffer_dependents_.clear();
+  memory_pressure_difference_cache_.clear();
   live_buffers_set_.clear();
   for (auto* instruction : computation->instructions()) {
     auto& output_values = this->output_buffers_[instruction];
@@ -662,6 +664,23 @@ void MemoryPressureTracker::Initialize(
           }
         });
   }
+  auto add_dependent = [this](HloBuffer::Id id,
+                              const HloInstruction* instruction) {
+    auto& dependents = buffer_dependents_[id];
+    if (dependents.empty() || dependents.back() != instruction) {
+      dependents.push_back(instruction);
+    }
+  };
+  for (auto* instruction : computation->instructions()) {
+    for (auto* op : instruction->operands()) {
+      for (auto& info : output_buffers_[op]) {
+        add_dependent(info.first.value->id(), instruction);
+      }
+    }
+    for (auto& b : defined_buffers_[instruction]) {
+      add_dependent(b.value->id(), instruction);
+    }
+  }
   if (!initial_live_buffers.empty()) {
     for (HloBuffer::Id id : initial_live_buffers) {
       auto& buffer = buffer_tracker_.GetBufferInfo(id);
@@ -703,7 +722,7 @@ void MemoryPressureTracker::UpdateBuffers(const HloInstruction* instruction) {
         continue;
       }
       if (live_buffers_[info.first.value->id()] == 0) {
-        live_buffers_[info.first.value->id()] = 1;
+        MarkBufferLive(info.first.value->id());
         live_buffers_set_.insert(info.first.value->id());
         live_memory_usage_ += info.first.buffer_size;
       }
@@ -730,10 +749,32 @@ void MemoryPressureTracker::UpdateBuffers(const HloInstruction* instruction) {
   }
 }
 
+void MemoryPressureTracker::MarkBufferLive(HloBuffer::Id id) {
+  live_buffers_[id] = 1;
+  auto it = buffer_dependents_.find(id);
+  if (it == buffer_dependents_.end()) {
+    return;
+  }
+  for (const HloInstruction* dependent : it->second) {
+    memory_pressure_difference_cache_.erase(dependent);
+  }
+}
+
 // Return the memory pressure difference estimation if this instruction was
 // scheduled.
 std::pair<int64_t, int64_t> MemoryPressureTracker::MemoryPressureDifference(
     const HloInstruction* instruction) const {
+  auto [it, inserted] =
+      memory_pressure_difference_cache_.try_emplace(instruction);
+  if (inserted) {
+    it->second = ComputeMemoryPressureDifference(instruction);
+  }
+  return it->second;
+}
+
+std::pair<int64_t, int64_t>
+MemoryPressureTracker::ComputeMemoryPressureDifference(
+    const HloInstruction* instruction) const {
   int64_t increase = 0;
   int64_t peak = 0;
   // Compute peak increase produced by called computations.
@@ -798,24 +839,37 @@ DefaultSchedulerCore::ScheduleCandidate InitializeCandidate(
 
 namespace {
 
-// Find the num hops to the closest selective resource overlap in ready set that
-// provided node can be scheduled in between.
-int64_t GetNumHopsToClosestSelectiveOverlap(
-    const DefaultSchedulerCore::ReadyQueueSet& ready_set,
-    const HloGraphNode* node) {
-  int64_t num_hops_to_closest_selective_resource_occupier =
-      std::numeric_limits<int64_t>::max();
-  for (const HloGraphNode* n : ready_set) {
-    // Skip the node itself.
-    if (n == node) {
-      continue;
+// Finds the num hops to the closest selective resource overlap in a ready set
+// that a node can be scheduled in between. The ready set is scanned once, so
+// that queries for all nodes of the ready set take linear time in total.
+class ClosestSelectiveOverlapFinder {
+ public:
+  explicit ClosestSelectiveOverlapFinder(
+      const DefaultSchedulerCore::ReadyQueueSet& ready_set) {
+    for (const HloGraphNode* n : ready_set) {
+      const int64_t num_hops = n->GetNumHopsToClosestSelectiveResourceOccupier();
+      if (num_hops < closest_num_hops_) {
+        second_closest_num_hops_ = closest_num_hops_;
+        closest_num_hops_ = num_hops;
+        closest_node_ = n;
+      } else if (num_hops < second_closest_num_hops_) {
+        second_closest_num_hops_ = num_hops;
+      }
     }
-    num_hops_to_closest_selective_resource_occupier =
-        std::min(num_hops_to_closest_selective_resource_occupier,
-                 n->GetNumHopsToClosestSelectiveResourceOccupier());
   }
-  return num_hops_to_closest_selective_resource_occupier;
-}
+
+  // Returns the num hops to the closest selective resource overlap in the
+  // ready set, skipping the node itself.
+  int64_t GetNumHops(const HloGraphNode* node) const {
+    return node == closest_node_ ? second_closest_num_hops_
+                                 : closest_num_hops_;
+  }
+
+ private:
+  const HloGraphNode* closest_node_ = nullptr;
+  int64_t closest_num_hops_ = std::numeric_limits<int64_t>::max();
+  int64_t second_closest_num_hops_ = std::numeric_limits<int64_t>::max();
+};
 
 // Comparator for the ready set. This class represents the priority policies
 // for the nodes in the ready set. The policy can be whatever is appropriate to
@@ -1093,10 +1147,13 @@ class ReadySetLt {
     // that are valuable for selective overlaps.
     if (sched_state_.config.enable_selective_resources &&
         sched_state_.selective_resource_releasers.empty()) {
+      if (!closest_selective_overlap_finder_.has_value()) {
+        closest_selective_overlap_finder_.emplace(sched_state_.ready_set);
+      }
       int64_t distance_to_selective_overlap_for_a =
-          GetNumHopsToClosestSelectiveOverlap(sched_state_.ready_set, a.node);
+          closest_selective_overlap_finder_->GetNumHops(a.node);
       int64_t distance_to_selective_overlap_for_b =
-          GetNumHopsToClosestSelectiveOverlap(sched_state_.ready_set, b.node);
+          closest_selective_overlap_finder_->GetNumHops(b.node);
       // If a is valuable for selective overlap and there is a selective
       // overlap in the near future a can be scheduled inside, hold off
       // scheduling a and schedule b instead. Same logic applies in reverse.
@@ -1148,6 +1205,10 @@ class ReadySetLt {
   const DefaultSchedulerCore::SchedulingState& sched_state_;
   DefaultSchedulerCore::TargetSchedulingRule target_scheduling_rule_;
   DefaultSchedulerCore::TargetSchedulingRule early_target_scheduling_rule_;
+  // Computed on first use. The ready set doesn't change during the lifetime of
+  // the comparator.
+  mutable std::optional<ClosestSelectiveOverlapFinder>
+      closest_selective_overlap_finder_;
 
   int ReadyIfScheduled(const HloGraphNode& gn) const {
     int ready_nodes_if_scheduled = 0;
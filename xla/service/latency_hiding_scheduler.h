@@ -650,7 +650,8 @@ class MemoryPressureTracker {
   // other instructions.
   void UpdateBuffers(const HloInstruction* instruction);
   // Return the memory pressure difference estimation if this instruction was
-  // scheduled.
+  // scheduled. Results are cached and only recomputed after a buffer the
+  // instruction reads or defines becomes live.
   // Returns a pair of (increase, peak) values.
   // "increase" determines by how much the memory pressure increases or
   // decreases after this instruction is scheduled. "peak" determines what's the
@@ -704,6 +705,11 @@ class MemoryPressureTracker {
     }
     return false;
   }
+  std::pair<int64_t, int64_t> ComputeMemoryPressureDifference(
+      const HloInstruction* instruction) const;
+  // Marks the buffer as live and invalidates the cached memory pressure
+  // differences of the instructions that depend on its liveness.
+  void MarkBufferLive(HloBuffer::Id id);
   const HloAliasAnalysis* hlo_alias_analysis_;
   // Live buffer presence set. This is used to determine if a buffer is live or
   // not in a fast way. Because this is checked very often in the evaluation
@@ -724,6 +730,17 @@ class MemoryPressureTracker {
   absl::flat_hash_map<HloInstruction*,
                       std::vector<BufferInfoTracker::ValueInfo>>
       defined_buffers_;
+  // Instructions whose memory pressure difference depends on the liveness of
+  // the buffer, i.e. the users of the instructions that output the buffer and
+  // the instructions that define it.
+  absl::flat_hash_map<HloBuffer::Id, std::vector<const HloInstruction*>>
+      buffer_dependents_;
+  // Cache of MemoryPressureDifference() results. Scheduling an instruction
+  // only changes the liveness of a few buffers, so most entries stay valid
+  // from one scheduling step to the next.
+  mutable absl::flat_hash_map<const HloInstruction*,
+                              std::pair<int64_t, int64_t>>
+      memory_pressure_difference_cache_;
   // Map with pressure_state object for other computations. It's updated by
   // the user of this class.
   const absl::flat_hash_map<const HloComputation*, MemoryPressureState>&
@@ -32,11 +32,14 @@ limitations under the License.
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/hlo/ir/hlo_schedule.h"
+#include "xla/hlo/parser/hlo_parser.h"
 #include "xla/service/async_collective_creator.h"
 #include "xla/service/hlo_cost_analysis.h"
 #include "xla/shape.h"
@@ -44,6 +47,7 @@ limitations under the License.
 #include "xla/tests/hlo_test_base.h"
 #include "xla/util.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/test_benchmark.h"
 
 namespace xla {
 
@@ -3239,4 +3243,64 @@ ENTRY %module {
   EXPECT_LT(c2_index, ag_done_index);
 }
 
+// Builds a scheduled module with `num_chains` chains of `num_steps` adds each,
+// where every add also reads the previous value of the neighboring chain, so
+// the ready set stays about `num_chains` nodes wide. Every 8th value of every
+// chain is sent through a collective-permute that is consumed 4 steps later.
+std::string MakeLargeSchedulingBenchmarkHlo(int64_t num_chains,
+                                            int64_t num_steps) {
+  std::string hlo = "HloModule bm, is_scheduled=true\n\nENTRY e {\n";
+  auto value_name = [](int64_t step, int64_t chain) {
+    return absl::StrCat("v", step, "_", chain);
+  };
+  for (int64_t c = 0; c < num_chains; ++c) {
+    absl::StrAppend(&hlo, "  ", value_name(0, c), " = f32[128] parameter(", c,
+                    ")\n");
+  }
+  for (int64_t s = 1; s < num_steps; ++s) {
+    for (int64_t c = 0; c < num_chains; ++c) {
+      std::string lhs = value_name(s - 1, c);
+      if (s > 4 && (s - 4) % 8 == 0) {
+        lhs = absl::StrCat("cp", s - 4, "_", c);
+      }
+      absl::StrAppend(&hlo, "  ", value_name(s, c), " = f32[128] add(", lhs,
+                      ", ", value_name(s - 1, (c + 1) % num_chains), ")\n");
+      if (s % 8 == 0 && s + 4 < num_steps) {
+        absl::StrAppend(&hlo, "  cp", s, "_", c,
+                        " = f32[128] collective-permute(", value_name(s, c),
+                        "), source_target_pairs={{0,1},{1,0}}\n");
+      }
+    }
+  }
+  std::vector<std::string> roots;
+  for (int64_t c = 0; c < num_chains; ++c) {
+    roots.push_back(value_name(num_steps - 1, c));
+  }
+  absl::StrAppend(&hlo, "  ROOT t = (",
+                  absl::StrJoin(std::vector<std::string>(num_chains, "f32[128]"),
+                                ", "),
+                  ") tuple(", absl::StrJoin(roots, ", "), ")\n}\n");
+  return hlo;
+}
+
+void BM_ScheduleLargeGraph(::testing::benchmark::State& state) {
+  constexpr int64_t kNumChains = 64;
+  const int64_t num_steps = state.range(0) / kNumChains;
+  const std::string hlo = MakeLargeSchedulingBenchmarkHlo(kNumChains, num_steps);
+
+  for (auto s : state) {
+    state.PauseTiming();
+    auto module = ParseAndReturnUnverifiedModule(hlo).value();
+    state.ResumeTiming();
+    CHECK_OK(RunScheduler(module.get()).status());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ScheduleLargeGraph)
+    ->Arg(1 << 12)
+    ->Arg(1 << 14)
+    ->Arg(1 << 16)
+    ->Arg(1 << 18);
+
 }  // namespace xla
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "xla/service/layout_assignment.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <deque>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <set>
 #include <string>
@@ -248,6 +250,11 @@ bool LayoutAssignment::AnyOperandBufferForwarded(
   PointsToSet::BufferSet* output_buffers = GetBufferSet(instruction);
   PointsToSet::BufferSet* operand_buffers =
       GetBufferSet(instruction->operand(operand_no));
+  // Iterate over the smaller set, the output of a large tuple has a buffer per
+  // operand and is checked once for every one of them.
+  if (output_buffers->size() > operand_buffers->size()) {
+    std::swap(output_buffers, operand_buffers);
+  }
   return absl::c_any_of(*output_buffers, [&](const LogicalBuffer* b) {
     return operand_buffers->count(b) > 0;
   });
@@ -1679,8 +1686,13 @@ std::vector<std::pair<const HloInstruction*, int64_t>> GetArrayUsesOfBuffer(
     // result because the instruction produces an array.
     CHECK(buffer_alias.index().empty());
 
-    // Add all uses of the instruction's output.
+    // Add all uses of the instruction's output. Tuples forward their operand
+    // buffers, so they never get an operand constraint and we skip scanning
+    // their (possibly very many) operands.
     for (const HloInstruction* user : buffer_alias.instruction()->users()) {
+      if (user->opcode() == HloOpcode::kTuple) {
+        continue;
+      }
       for (int64_t operand_no :
            user->OperandIndices(buffer_alias.instruction())) {
         uses.emplace_back(user, operand_no);
@@ -2020,26 +2032,37 @@ absl::Status LayoutAssignment::PropagateBufferConstraintToUses(
     return absl::OkStatus();
   }
 
-  for (HloInstruction* user : buffer.instruction()->users()) {
-    if (user->parent()->root_instruction()->opcode() != HloOpcode::kTuple) {
-      continue;
-    }
-    if (user->parent()->root_instruction() == user) {
-      VLOG(3) << "Propagating layout through backedge"
-              << buffer_constraint.layout().ToString();
-      int64_t index = user->operand_index(buffer.instruction());
+  const HloInstruction* root =
+      buffer.instruction()->parent()->root_instruction();
+  if (root->opcode() != HloOpcode::kTuple) {
+    return absl::OkStatus();
+  }
 
-      const HloInstruction* inputs = user->parent()->parameter_instruction(0);
+  // Find the first operand of the root tuple that is the buffer's instruction
+  // from the buffer aliases, rather than by scanning the operands of the root,
+  // which is slow for loops with many loop-carried values.
+  std::optional<int64_t> index;
+  for (const BufferAlias& alias :
+       points_to_analysis_->GetBufferAliases(buffer)) {
+    if (alias.instruction() == root && !alias.index().empty() &&
+        root->operand(alias.index().front()) == buffer.instruction()) {
+      index = std::min(index.value_or(alias.index().front()),
+                       alias.index().front());
+    }
+  }
+  if (index.has_value()) {
+    VLOG(3) << "Propagating layout through backedge"
+            << buffer_constraint.layout().ToString();
+    const HloInstruction* inputs = root->parent()->parameter_instruction(0);
 
-      ShapeIndex used_index = buffer.index();
-      used_index.push_front(index);
+    ShapeIndex used_index = buffer.index();
+    used_index.push_front(*index);
 
-      TF_ASSIGN_OR_RETURN(auto buffer, points_to_analysis_->GetBufferDefinedAt(
-                                           inputs, used_index));
+    TF_ASSIGN_OR_RETURN(auto buffer, points_to_analysis_->GetBufferDefinedAt(
+                                         inputs, used_index));
 
-      TF_RETURN_IF_ERROR(SetBufferLayout(buffer_constraint.layout(), *buffer,
-                                         /*mandatory=*/false));
-    }
+    TF_RETURN_IF_ERROR(SetBufferLayout(buffer_constraint.layout(), *buffer,
+                                       /*mandatory=*/false));
   }
 
   return absl::OkStatus();
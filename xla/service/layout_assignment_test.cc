@@ -1171,6 +1171,56 @@ TEST_F(LayoutAssignmentTest, TupleCopyOnLayoutMismatch) {
                   m::Op().WithShape(m::Shape().WithLayoutEqualTo(&layout10)))));
 }
 
+TEST_F(LayoutAssignmentTest, BackedgeWithRepeatedLoopCarriedValue) {
+  const char* module_str = R"(
+    HloModule BackedgeWithRepeatedLoopCarriedValue
+
+    condition {
+      tup = (s32[], f32[64,128], f32[64,128]) parameter(0)
+      counter = s32[] get-tuple-element(tup), index=0
+      five = s32[] constant(5)
+      ROOT lt = pred[] compare(counter, five), direction=LT
+    }
+
+    body {
+      tup = (s32[], f32[64,128], f32[64,128]) parameter(0)
+      counter = s32[] get-tuple-element(tup), index=0
+      buf = f32[64,128] get-tuple-element(tup), index=1
+      one = s32[] constant(1)
+      next_counter = s32[] add(counter, one)
+      next_buf = f32[64,128] negate(buf)
+      ROOT next_tup = (s32[], f32[64,128], f32[64,128])
+        tuple(next_counter, next_buf, next_buf)
+    }
+
+    ENTRY main {
+      p = f32[64,128] parameter(0)
+      zero = s32[] constant(0)
+      init = (s32[], f32[64,128], f32[64,128]) tuple(zero, p, p)
+      loop = (s32[], f32[64,128], f32[64,128]) while(init),
+        condition=condition, body=body
+      ROOT result = f32[64,128] get-tuple-element(loop), index=2
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(module_str));
+  ComputationLayout computation_layout(
+      m->entry_computation()->ComputeProgramShape());
+  *computation_layout.mutable_parameter_layout(0) =
+      ShapeLayout(ShapeUtil::MakeShapeWithDenseLayout(F32, {64, 128}, {0, 1}));
+  *computation_layout.mutable_result_layout() =
+      ShapeLayout(ShapeUtil::MakeShapeWithDenseLayout(F32, {64, 128}, {0, 1}));
+  AssignLayouts(m.get(), &computation_layout);
+  SCOPED_TRACE(m->ToString());
+
+  // The body parameter and root must agree on the layouts of all loop-carried
+  // values, including the repeated one.
+  const HloComputation* body = FindComputation(m.get(), "body");
+  EXPECT_TRUE(ShapeUtil::Equal(body->parameter_instruction(0)->shape(),
+                               body->root_instruction()->shape()));
+}
+
 TEST_F(LayoutAssignmentTest, CustomCallNotLayoutConstrained) {
   const char* module_str = R"(
 HloModule CustomCallNotLayoutConstrained
@@ -1431,6 +1431,12 @@ void MsaAlgorithm::ColorColocatedIntervalsToAlternate(
     // Color all of the aliased reserved buffers here because reserved
     // alternate memory allocations will not have an entry in preset
     // allocations that is normally used for coloring.
+    if (positions_to_color_ != nullptr) {
+      positions_to_color_->insert(positions_to_color_->end(),
+                                  value->positions().begin(),
+                                  value->positions().end());
+      continue;
+    }
     for (auto& position : value->positions()) {
       VLOG(4) << "Coloring " << position.ToString();
       Shape* shape = ShapeUtil::GetMutableSubshape(
@@ -1493,13 +1499,36 @@ void MsaAlgorithm::CreateAllocationValuesForJointProcessedIntervals(
     }
 
     auto colocated_intervals = GetSortedColocatedIntervals(interval);
+    int64_t colocated_start = std::numeric_limits<int64_t>::max();
+    int64_t colocated_end = std::numeric_limits<int64_t>::min();
+    for (const MsaBufferInterval* colocated_interval : colocated_intervals) {
+      colocated_start = std::min(colocated_start, colocated_interval->start);
+      colocated_end = std::max(colocated_end, colocated_interval->end);
+    }
     if (AreIntervalsReservedInAlternateMemory(colocated_intervals)) {
+      // Reserved intervals are accounted for in every window, but only the
+      // window in which they start colors them.
+      if (allocation_window_.has_value() &&
+          (colocated_start < allocation_window_->first ||
+           colocated_start > allocation_window_->second)) {
+        continue;
+      }
       VLOG(3) << "Interval " << interval.buffer->ToShortString()
               << " is reserved in the alternate memory.";
       ColorColocatedIntervalsToAlternate(colocated_intervals);
       continue;
     }
 
+    if (allocation_window_.has_value() &&
+        (colocated_start < allocation_window_->first ||
+         colocated_end > allocation_window_->second)) {
+      VLOG(3) << "Skip " << interval.buffer->ToShortString()
+              << " because it is not contained in the allocation window ["
+              << allocation_window_->first << ", "
+              << allocation_window_->second << "].";
+      continue;
+    }
+
     if (!ConsumeFuel("memory_space_assignment", [&] {
           return absl::StrCat("Ran out of fuel at buffer: ",
                               colocated_intervals[0]->buffer->ToShortString());
@@ -3186,6 +3215,10 @@ void MsaAlgorithm::AllocateReservedScopedAllocations() {
   const auto& instruction_sequence =
       hlo_live_range_.flattened_instruction_sequence().instructions();
   for (int i = 0; i < instruction_sequence.size(); ++i) {
+    if (allocation_window_.has_value() &&
+        (i < allocation_window_->first || i > allocation_window_->second)) {
+      continue;
+    }
     const HloInstruction* instruction = instruction_sequence[i];
     int64_t reserved_scoped_memory =
         std::min(options_.reserved_scoped_memory_fn(
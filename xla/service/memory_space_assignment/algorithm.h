@@ -410,6 +410,22 @@ class MsaAlgorithm : public GlobalDecreasingSizeBestFitHeap<HloValue> {
 
   absl::StatusOr<HeapSimulator::Result<HloValue>> Finish() override;
 
+  // Restricts the allocation to the inclusive time window [start_time,
+  // end_time] of the flattened schedule. Only buffers whose colocated live
+  // ranges are contained in the window (and scoped memory of instructions in
+  // the window) are considered for alternate memory, so that algorithms for
+  // disjoint windows produce allocations that never overlap in time.
+  //
+  // Algorithms for different windows may run concurrently on the same module,
+  // so instead of coloring the positions of buffers reserved in alternate
+  // memory, the algorithm appends them to `positions_to_color`. The caller
+  // colors them once all windows are allocated.
+  void SetAllocationWindow(int64_t start_time, int64_t end_time,
+                           std::vector<HloPosition>* positions_to_color) {
+    allocation_window_ = {start_time, end_time};
+    positions_to_color_ = positions_to_color;
+  }
+
  protected:
   // Given a buffer interval, returns the colocated intervals. Unlike the
   // similar GlobalDecreasingSizeBestFitHeap::GetTransitiveColocations, it
@@ -1191,6 +1207,12 @@ class MsaAlgorithm : public GlobalDecreasingSizeBestFitHeap<HloValue> {
       required_assignments_;
   // Number of bytes reserved in alternate memory space.
   int64_t reserved_in_bytes_ = 0;
+  // The inclusive time window this algorithm allocates, if any. See
+  // SetAllocationWindow().
+  std::optional<std::pair<int64_t, int64_t>> allocation_window_;
+  // If not null, positions to color in alternate memory are collected here
+  // rather than colored. See SetAllocationWindow().
+  std::vector<HloPosition>* positions_to_color_ = nullptr;
   // A rough measure of the memory pressure of the model, in bytes. Note that
   // this is pressure for memory capacity (and not accessed bytes), and for
   // alternate memory (not default memory).
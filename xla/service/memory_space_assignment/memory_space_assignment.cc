@@ -37,6 +37,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "absl/types/span.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
@@ -400,6 +401,14 @@ MemorySpaceAssignment::RunMemorySpaceAssignment(
 absl::Status MemorySpaceAssignment::FindAllocationSequence(
     const HloLiveRange& hlo_live_range,
     const HloAliasAnalysis& alias_analysis) {
+  const int64_t num_times = hlo_live_range.schedule_end_time() + 1;
+  const int64_t num_windows =
+      std::min(options_.num_allocation_windows, num_times);
+  if (num_windows > 1) {
+    return FindAllocationSequenceInWindows(hlo_live_range, alias_analysis,
+                                           num_windows);
+  }
+
   auto algorithm = std::make_unique<MsaAlgorithm>(
       &allocations_, options_, alias_analysis, hlo_live_range);
 
@@ -414,6 +423,122 @@ absl::Status MemorySpaceAssignment::FindAllocationSequence(
   return absl::OkStatus();
 }
 
+absl::Status MemorySpaceAssignment::FindAllocationSequenceInWindows(
+    const HloLiveRange& hlo_live_range, const HloAliasAnalysis& alias_analysis,
+    int64_t num_windows) {
+  const int64_t num_times = hlo_live_range.schedule_end_time() + 1;
+  const bool parallel = options_.allocation_window_thread_pool != nullptr;
+  if (parallel && options_.create_allocation_window_objects_fn == nullptr) {
+    return InvalidArgument(
+        "Allocating memory space assignment windows in parallel requires "
+        "create_allocation_window_objects_fn.");
+  }
+  VLOG(1) << "Allocating " << num_windows << " windows"
+          << (parallel ? " in parallel" : "");
+
+  // Each window gets its own copy of the options, and in parallel mode its own
+  // instances of the stateful objects. Features that span the whole program
+  // are disabled.
+  // Every window has its own cost analysis cache for the objects that use
+  // one.
+  std::vector<AllocationWindowObjects> window_objects(num_windows);
+  std::vector<CostAnalysis::Cache> window_cost_analysis_caches(num_windows);
+  std::vector<Options> window_options(num_windows, options_);
+  for (int64_t w = 0; w < num_windows; ++w) {
+    Options& options = window_options[w];
+    if (parallel) {
+      window_objects[w] = options_.create_allocation_window_objects_fn(
+          &window_cost_analysis_caches[w]);
+      if (window_objects[w].prefetch_interval_picker != nullptr) {
+        options.prefetch_interval_picker =
+            window_objects[w].prefetch_interval_picker.get();
+      }
+      if (window_objects[w].repacker != nullptr) {
+        options.repacker = window_objects[w].repacker.get();
+      }
+      if (window_objects[w].buffer_interval_comparator != nullptr) {
+        options.buffer_interval_comparator =
+            window_objects[w].buffer_interval_comparator.get();
+      }
+    }
+    options.enable_cross_program_prefetch = false;
+    options.enable_sync_copy_replacement = false;
+    options.memory_bound_loop_optimizer_options.set_enabled(false);
+    if (options_.dump_fn != nullptr) {
+      options.dump_fn = [dump_fn = options_.dump_fn, w](
+                            absl::string_view name,
+                            absl::string_view contents) {
+        dump_fn(absl::StrCat(name, ".window", w), contents);
+      };
+    }
+  }
+
+  HeapSimulator::Options heap_simulator_options;
+  heap_simulator_options.may_reuse_operand_buffers = false;
+  heap_simulator_options.alloc_constants = true;
+
+  std::vector<AllocationSequence> window_allocations(num_windows);
+  std::vector<std::vector<HloPosition>> window_positions_to_color(num_windows);
+  std::vector<absl::Status> window_statuses(num_windows);
+  auto allocate_window = [&](int64_t w) {
+    // Windows are inclusive time ranges that cover the flattened schedule.
+    const int64_t start_time = w * num_times / num_windows;
+    const int64_t end_time = (w + 1) * num_times / num_windows - 1;
+    auto algorithm = std::make_unique<MsaAlgorithm>(
+        &window_allocations[w], window_options[w], alias_analysis,
+        hlo_live_range);
+    algorithm->SetAllocationWindow(start_time, end_time,
+                                   &window_positions_to_color[w]);
+    window_statuses[w] =
+        HeapSimulator::Run(std::move(algorithm), *module_, module_->schedule(),
+                           alias_analysis, options_.size_fn,
+                           heap_simulator_options)
+            .status();
+  };
+
+  if (parallel) {
+    absl::BlockingCounter counter(num_windows);
+    for (int64_t w = 0; w < num_windows; ++w) {
+      options_.allocation_window_thread_pool->Schedule([&, w] {
+        allocate_window(w);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  } else {
+    for (int64_t w = 0; w < num_windows; ++w) {
+      allocate_window(w);
+    }
+  }
+
+  for (int64_t w = 0; w < num_windows; ++w) {
+    TF_RETURN_IF_ERROR(window_statuses[w]);
+  }
+
+  // The windows read the shapes of the module while they run, so the buffers
+  // reserved in alternate memory are colored only now.
+  for (const std::vector<HloPosition>& positions : window_positions_to_color) {
+    for (const HloPosition& position : positions) {
+      VLOG(4) << "Coloring " << position.ToString();
+      Shape* shape = ShapeUtil::GetMutableSubshape(
+          position.instruction->mutable_shape(), position.index);
+      CHECK(shape->IsArray())
+          << "Coloring a shape that is not an array: " << position.ToString();
+      shape->mutable_layout()->set_memory_space(
+          options_.alternate_memory_space);
+    }
+  }
+
+  // Allocations of different windows never overlap in time, so they can share
+  // the alternate memory offsets chosen independently by each window.
+  for (int64_t w = 0; w < num_windows; ++w) {
+    allocations_.insert(allocations_.end(),
+                        std::make_move_iterator(window_allocations[w].begin()),
+                        std::make_move_iterator(window_allocations[w].end()));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status MemorySpaceAssignment::Process(
     const HloLiveRange& hlo_live_range) {
   VLOG(1) << "Processing assigned buffers...";
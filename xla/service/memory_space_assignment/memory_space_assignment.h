@@ -312,6 +312,13 @@ class MemorySpaceAssignment {
       const HloLiveRange& hlo_live_range,
       const HloAliasAnalysis& alias_analysis);
 
+  // Implements FindAllocationSequence() for Options::num_allocation_windows >
+  // 1 by running an MsaAlgorithm per time window, in parallel if
+  // Options::allocation_window_thread_pool is set.
+  absl::Status FindAllocationSequenceInWindows(
+      const HloLiveRange& hlo_live_range,
+      const HloAliasAnalysis& alias_analysis, int64_t num_windows);
+
   const Options& options() const { return options_; }
 
   MemorySpaceAssignment(HloModule* module, const Options& options,
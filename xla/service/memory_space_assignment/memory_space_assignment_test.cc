@@ -87,6 +87,7 @@ limitations under the License.
 #include "tsl/platform/status_matchers.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace memory_space_assignment {
@@ -570,6 +571,81 @@ TEST_F(MemorySpaceAssignmentTest, Simple) {
             preset_assignments->chunks()[1].second.offset);
 }
 
+// Builds a module with a chain of negates and a value `a` that is live across
+// the whole chain.
+std::unique_ptr<HloComputation> MakeChainWithLongLivedValue(
+    absl::string_view name, HloInstruction** a, HloInstruction** early,
+    HloInstruction** late, std::vector<HloInstruction*>& sequence) {
+  HloComputation::Builder builder(name);
+  Shape shape = ShapeUtil::MakeShape(F32, {2, 3});
+  HloInstruction* p0 =
+      builder.AddInstruction(HloInstruction::CreateParameter(0, shape, "p0"));
+  *a = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape, HloOpcode::kNegate, p0));
+  sequence = {p0, *a};
+  HloInstruction* prev = *a;
+  for (int i = 0; i < 8; ++i) {
+    prev = builder.AddInstruction(
+        HloInstruction::CreateUnary(shape, HloOpcode::kNegate, prev));
+    sequence.push_back(prev);
+    if (i == 0) *early = prev;
+    if (i == 5) *late = prev;
+  }
+  sequence.push_back(builder.AddInstruction(
+      HloInstruction::CreateBinary(shape, HloOpcode::kAdd, prev, *a)));
+  return builder.Build();
+}
+
+TEST_F(MemorySpaceAssignmentTest, AllocationWindows) {
+  HloInstruction *a, *early, *late;
+  std::vector<HloInstruction*> sequence;
+  auto module = CreateNewVerifiedModule();
+  HloComputation* computation = module->AddEntryComputation(
+      MakeChainWithLongLivedValue(TestName(), &a, &early, &late, sequence));
+  HloSchedule schedule(module.get());
+  schedule.set_sequence(computation, sequence);
+  TF_CHECK_OK(module->set_schedule(schedule));
+
+  Options options = DefaultMemorySpaceOptions();
+  options.num_allocation_windows = 2;
+  AssignMemorySpace(module.get(), options);
+
+  // The value that is live across the window boundary stays in default memory
+  // while the short-lived values of both windows are placed in alternate
+  // memory.
+  EXPECT_EQ(a->shape().layout().memory_space(), kDefaultMemorySpace);
+  EXPECT_EQ(early->shape().layout().memory_space(), kAlternateMemorySpace);
+  EXPECT_EQ(late->shape().layout().memory_space(), kAlternateMemorySpace);
+}
+
+TEST_F(MemorySpaceAssignmentTest, ParallelAllocationWindows) {
+  HloInstruction *a, *early, *late;
+  std::vector<HloInstruction*> sequence;
+  auto module = CreateNewVerifiedModule();
+  HloComputation* computation = module->AddEntryComputation(
+      MakeChainWithLongLivedValue(TestName(), &a, &early, &late, sequence));
+  HloSchedule schedule(module.get());
+  schedule.set_sequence(computation, sequence);
+  TF_CHECK_OK(module->set_schedule(schedule));
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "msa_windows", 2);
+  Options options = DefaultMemorySpaceOptions();
+  options.num_allocation_windows = 2;
+  options.allocation_window_thread_pool = &thread_pool;
+  options.create_allocation_window_objects_fn =
+      [](CostAnalysis::Cache* cost_analysis_cache) {
+        AllocationWindowObjects objects;
+        objects.prefetch_interval_picker =
+            std::make_unique<InstructionCountPrefetchIntervalPicker>(2, 10);
+        return objects;
+      };
+  AssignMemorySpace(module.get(), options);
+
+  EXPECT_EQ(a->shape().layout().memory_space(), kDefaultMemorySpace);
+  EXPECT_EQ(early->shape().layout().memory_space(), kAlternateMemorySpace);
+  EXPECT_EQ(late->shape().layout().memory_space(), kAlternateMemorySpace);
+}
+
 TEST_F(MemorySpaceAssignmentTest, NegateChain) {
   // The negate chain is long enough for asynchronous copy to be inserted
   // between p1 and add.
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -41,6 +42,7 @@ limitations under the License.
 #include "xla/shape.h"
 #include "xla/shape_util.h"
 #include "xla/util.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace memory_space_assignment {
@@ -64,6 +66,21 @@ using WindowPrefetchNotifyOperandAppendedFunction =
 using IsAsyncSliceImplementedFunction =
     std::function<bool(const HloInstruction*)>;
 
+// Per-window instances of the stateful objects in Options, used when
+// allocation windows are allocated in parallel. Null members fall back to the
+// objects in Options.
+struct AllocationWindowObjects {
+  std::unique_ptr<PrefetchIntervalPicker> prefetch_interval_picker;
+  std::unique_ptr<MemorySpaceAssignmentRepacker> repacker;
+  std::unique_ptr<BufferIntervalComparator> buffer_interval_comparator;
+};
+// Creates the objects of one window. Objects that memoize cost analysis
+// results must use `cost_analysis_cache`, which belongs to the window and
+// outlives them, rather than a cache shared between windows.
+using CreateAllocationWindowObjectsFunction =
+    std::function<AllocationWindowObjects(
+        CostAnalysis::Cache* cost_analysis_cache)>;
+
 // The different options to be passed to the Run() API.
 struct Options {
   // Backend-specific integer value that describes the alternate memory.
@@ -259,6 +276,23 @@ struct Options {
   // and gives MSA more flexibility in choosing the prefetch time and how much
   // data to prefetch.
   bool enable_window_prefetch = false;
+
+  // If greater than one, the flattened schedule is partitioned into this many
+  // time windows of equal length that are allocated independently. Buffers
+  // whose (colocated) live ranges cross a window boundary stay in default
+  // memory, so more windows trade allocation quality for compile time.
+  // Cross-program prefetching, sync copy replacement and the memory-bound
+  // loop optimizer are disabled when allocating in windows.
+  int64_t num_allocation_windows = 1;
+
+  // If not nullptr, allocation windows are allocated in parallel on this
+  // thread pool. Prefetch interval pickers, repackers and buffer interval
+  // comparators are not thread-safe, so create_allocation_window_objects_fn
+  // must create a fresh instance of each of them that is set, backed by the
+  // window's own cost analysis cache.
+  tsl::thread::ThreadPool* allocation_window_thread_pool = nullptr;
+  CreateAllocationWindowObjectsFunction create_allocation_window_objects_fn =
+      nullptr;
 };
 }  // namespace memory_space_assignment
 }  // namespace xla
@@ -53,6 +53,25 @@ const float kEvictionRetryMultiplier = 2.0;
 // hurt compilation time.
 const int kNumExploredDecreasingIntervals = 100;
 
+// Returns the smallest time in [start_time, end_time] for which `pred` is true,
+// or end_time + 1 if there is none. `pred` must be monotone, i.e. once it is
+// true for a time it must be true for all later times. Returns start_time if
+// the range is empty.
+template <typename Predicate>
+int64_t FindFirstTime(int64_t start_time, int64_t end_time, Predicate pred) {
+  int64_t lo = start_time;
+  int64_t hi = std::max(start_time, end_time + 1);
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (pred(mid)) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
 }  // namespace
 
 bool InstructionCountPrefetchIntervalPicker::CanAllocateInAlternateMemoryNoCopy(
@@ -241,17 +260,14 @@ int64_t CostAnalysisPrefetchIntervalPicker::PreferredEvictionEndTime(
     const Shape& shape, int64_t start_time, int64_t latest_end_time) const {
   float async_copy_elapsed = cost_analysis_.GetAsyncCopyElapsed(
       shape_override_ ? *shape_override_ : shape);
-  int64_t end_time;
-  for (end_time = start_time + 1; end_time <= latest_end_time; ++end_time) {
-    float logical_interval_elapsed =
-        GetLogicalIntervalElapsed(start_time, end_time);
-    if (logical_interval_elapsed >=
-        (1 + kEvictionRetryMultiplier * retry_number_) *
-            preferred_overlap_to_async_copy_ratio_ * async_copy_elapsed) {
-      break;
-    }
-  }
-  return end_time;
+  const float preferred_elapsed =
+      (1 + kEvictionRetryMultiplier * retry_number_) *
+      preferred_overlap_to_async_copy_ratio_ * async_copy_elapsed;
+  // The elapsed time of an interval grows monotonically with its end time.
+  return FindFirstTime(start_time + 1, latest_end_time, [&](int64_t end_time) {
+    return GetLogicalIntervalElapsed(start_time, end_time) >=
+           preferred_elapsed;
+  });
 }
 
 int64_t CostAnalysisPrefetchIntervalPicker::LatestPrefetchStartTime(
@@ -264,28 +280,27 @@ int64_t CostAnalysisPrefetchIntervalPicker::LatestPrefetchStartTime(
   // alternate memory.
   float inst_elapsed_reduction = 0.0f;
   if (use) {
-    float elapsed_time =
-        cost_analysis_.GetInstructionElapsed(*use->instruction);
-    float elapsed_time_in_alternate_mem =
-        cost_analysis_.GetInstructionElapsedInAlternateMemory(
-            *use->instruction,
-            /*operands_in_alternate_mem=*/
-            {std::make_pair(use->operand_number, use->operand_index)},
-            /*outputs_in_alternate_mem=*/{});
-    inst_elapsed_reduction = elapsed_time - elapsed_time_in_alternate_mem;
+    inst_elapsed_reduction = GetInstructionElapsedReduction(*use);
   }
   int end_nest_level = computation_nest_level_[end_time];
 
-  // Find the latest time we're allowed to start prefetching.
+  // Find the latest time we're allowed to start prefetching. The elapsed time
+  // until end_time shrinks monotonically as the prefetch time increases, so
+  // binary search for the latest time that overlaps enough and then look for
+  // an earlier time at the same nest level.
   float min_interval = min_overlap_to_async_copy_ratio_ * async_copy_elapsed;
-  int latest_prefetch_time;
-  for (latest_prefetch_time = end_time - 1;
-       latest_prefetch_time >= start_time &&
-       (computation_nest_level_[latest_prefetch_time] != end_nest_level ||
-        min_interval >
-            GetLogicalIntervalElapsed(latest_prefetch_time, end_time) +
-                inst_elapsed_reduction);
-       --latest_prefetch_time) {
+  int64_t latest_prefetch_time =
+      FindFirstTime(start_time, end_time - 1,
+                    [&](int64_t prefetch_time) {
+                      return min_interval >
+                             GetLogicalIntervalElapsed(prefetch_time,
+                                                       end_time) +
+                                 inst_elapsed_reduction;
+                    }) -
+      1;
+  while (latest_prefetch_time >= start_time &&
+         computation_nest_level_[latest_prefetch_time] != end_nest_level) {
+    --latest_prefetch_time;
   }
 
   return latest_prefetch_time;
@@ -304,17 +319,57 @@ int64_t CostAnalysisPrefetchIntervalPicker::PreferredPrefetchStartTime(
   float best_interval = GetLogicalIntervalElapsed(earliest_prefetch_start_time,
                                                   prefetch_end_time);
   int end_nest_level = computation_nest_level_[prefetch_end_time];
-  for (int64_t prefetch_start_time = earliest_prefetch_start_time + 1;
-       prefetch_start_time <= latest_prefetch_start_time;
-       ++prefetch_start_time) {
+  auto distance = [&](int64_t prefetch_start_time) {
+    return std::abs(
+        preferred_interval -
+        GetLogicalIntervalElapsed(prefetch_start_time, prefetch_end_time));
+  };
+  auto consider = [&](int64_t prefetch_start_time) {
     float interval =
         GetLogicalIntervalElapsed(prefetch_start_time, prefetch_end_time);
-    if (computation_nest_level_[prefetch_start_time] == end_nest_level &&
-        std::abs(preferred_interval - interval) <
-            std::abs(preferred_interval - best_interval)) {
+    if (std::abs(preferred_interval - interval) <
+        std::abs(preferred_interval - best_interval)) {
       best_interval = interval;
       preferred_prefetch_start_time = prefetch_start_time;
     }
+  };
+
+  // The elapsed time until the prefetch end time shrinks monotonically as the
+  // start time increases. Split the candidates where it drops below the
+  // preferred interval: the distance to the preferred interval shrinks towards
+  // the split on both sides, so the closest candidate at the end nest level is
+  // next to the split. Among candidates with equal distance, the earliest one
+  // is preferred.
+  const int64_t first_start_time = earliest_prefetch_start_time + 1;
+  const int64_t split_time = FindFirstTime(
+      first_start_time, latest_prefetch_start_time,
+      [&](int64_t prefetch_start_time) {
+        return GetLogicalIntervalElapsed(prefetch_start_time,
+                                         prefetch_end_time) < preferred_interval;
+      });
+  int64_t before_split = split_time - 1;
+  while (before_split >= first_start_time &&
+         computation_nest_level_[before_split] != end_nest_level) {
+    --before_split;
+  }
+  if (before_split >= first_start_time) {
+    const float before_split_distance = distance(before_split);
+    int64_t prefetch_start_time = FindFirstTime(
+        first_start_time, before_split, [&](int64_t prefetch_start_time) {
+          return distance(prefetch_start_time) <= before_split_distance;
+        });
+    while (computation_nest_level_[prefetch_start_time] != end_nest_level) {
+      ++prefetch_start_time;
+    }
+    consider(prefetch_start_time);
+  }
+  int64_t after_split = split_time;
+  while (after_split <= latest_prefetch_start_time &&
+         computation_nest_level_[after_split] != end_nest_level) {
+    ++after_split;
+  }
+  if (after_split <= latest_prefetch_start_time) {
+    consider(after_split);
   }
   return preferred_prefetch_start_time;
 }
@@ -338,15 +393,12 @@ int64_t CostAnalysisPrefetchIntervalPicker::EstimatedPrefetchEndTime(
     const Shape& shape, int64_t start_time, int64_t end_time) const {
   float async_copy_elapsed = cost_analysis_.GetAsyncCopyElapsed(
       shape_override_ ? *shape_override_ : shape);
-  int64_t estimated_end_time;
-  for (estimated_end_time = start_time + 1; estimated_end_time < end_time;
-       ++estimated_end_time) {
-    float interval = GetLogicalIntervalElapsed(start_time, estimated_end_time);
-    if (interval >= async_copy_elapsed) {
-      break;
-    }
-  }
-  return estimated_end_time;
+  // The elapsed time of an interval grows monotonically with its end time.
+  return FindFirstTime(
+      start_time + 1, end_time - 1, [&](int64_t estimated_end_time) {
+        return GetLogicalIntervalElapsed(start_time, estimated_end_time) >=
+               async_copy_elapsed;
+      });
 }
 
 void CostAnalysisPrefetchIntervalPicker::Begin(
@@ -358,13 +410,7 @@ void CostAnalysisPrefetchIntervalPicker::Begin(
   async_copy_elapsed_ = cost_analysis_.GetAsyncCopyElapsed(
       shape_override_ ? *shape_override_ : shape);
   // Estimate the time we would save by having this op in alternate memory.
-  float elapsed_time = cost_analysis_.GetInstructionElapsed(*use.instruction);
-  float elapsed_time_in_alternate_mem =
-      cost_analysis_.GetInstructionElapsedInAlternateMemory(
-          *use.instruction, /*operands_in_alternate_mem=*/
-          {std::make_pair(use.operand_number, use.operand_index)},
-          /*outputs_in_alternate_mem=*/{});
-  inst_elapsed_reduction_ = elapsed_time - elapsed_time_in_alternate_mem;
+  inst_elapsed_reduction_ = GetInstructionElapsedReduction(use);
   end_logical_time_ = end_time;
   int end_nest_level = computation_nest_level_[end_logical_time_];
 
@@ -373,14 +419,20 @@ void CostAnalysisPrefetchIntervalPicker::Begin(
   latest_prefetch_time_ =
       LatestPrefetchStartTime(shape, start_time, end_time, &use);
 
-  // Find the earliest time we're allowed to start prefetching.
+  // Find the earliest time we're allowed to start prefetching. As above,
+  // binary search for the earliest time that doesn't overlap too much and then
+  // look for a later time at the same nest level.
   float max_interval = GetMaxElapsedInAlternateMemory(async_copy_elapsed_);
-  for (earliest_prefetch_time_ = start_time;
-       earliest_prefetch_time_ < latest_prefetch_time_ &&
-       (computation_nest_level_[earliest_prefetch_time_] != end_nest_level ||
-        max_interval < GetLogicalIntervalElapsed(earliest_prefetch_time_,
-                                                 end_logical_time_));
-       ++earliest_prefetch_time_) {
+  earliest_prefetch_time_ =
+      FindFirstTime(start_time, latest_prefetch_time_ - 1,
+                    [&](int64_t prefetch_time) {
+                      return max_interval >=
+                             GetLogicalIntervalElapsed(prefetch_time,
+                                                       end_logical_time_);
+                    });
+  while (earliest_prefetch_time_ < latest_prefetch_time_ &&
+         computation_nest_level_[earliest_prefetch_time_] != end_nest_level) {
+    ++earliest_prefetch_time_;
   }
   if (earliest_prefetch_time_ > latest_prefetch_time_) {
     // There is no available prefetch interval for the given start and end
@@ -487,6 +539,21 @@ void CostAnalysisPrefetchIntervalPicker::SetRetryNumber(int retry_number) {
   retry_number_ = retry_number;
 }
 
+float CostAnalysisPrefetchIntervalPicker::GetInstructionElapsedReduction(
+    const HloUse& use) const {
+  auto [it, inserted] = instruction_elapsed_reduction_cache_.try_emplace(use);
+  if (inserted) {
+    float elapsed_time = cost_analysis_.GetInstructionElapsed(*use.instruction);
+    float elapsed_time_in_alternate_mem =
+        cost_analysis_.GetInstructionElapsedInAlternateMemory(
+            *use.instruction, /*operands_in_alternate_mem=*/
+            {std::make_pair(use.operand_number, use.operand_index)},
+            /*outputs_in_alternate_mem=*/{});
+    it->second = elapsed_time - elapsed_time_in_alternate_mem;
+  }
+  return it->second;
+}
+
 int CostAnalysisPrefetchIntervalPicker::GetMinWhileNestLevel(
     int64_t start_time, int64_t end_time) const {
   int min_nest_level =
@@ -252,6 +252,11 @@ class CostAnalysisPrefetchIntervalPicker : public PrefetchIntervalPicker {
   // Finds the minimum nest level in the given interval.
   int GetMinWhileNestLevel(int64_t start_time, int64_t end_time) const;
 
+  // Returns the elapsed time saved by placing the operand of the use in the
+  // alternate memory. Results are memoized as the same uses are queried for
+  // every prefetch attempt.
+  float GetInstructionElapsedReduction(const HloUse& use) const;
+
   // Given the elapsed time to copy this buffer to the alternate memory, returns
   // the longest time that this buffer may reside in the alternate memory space.
   float GetMaxElapsedInAlternateMemory(float async_copy_elapsed) const;
@@ -280,6 +285,8 @@ class CostAnalysisPrefetchIntervalPicker : public PrefetchIntervalPicker {
   int64_t decreasing_prefetch_time_iterator_;
 
   std::vector<float> while_execution_counts_;
+  mutable absl::flat_hash_map<HloUse, float>
+      instruction_elapsed_reduction_cache_;
   // Shape override is used to override the shape of the shape of the async copy
   // to treat all async copies the same duration. Having an override forces
   // prefetches to be scheduled roughly in FIFO order.
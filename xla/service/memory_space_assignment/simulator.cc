@@ -21,11 +21,12 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <utility>
+#include <vector>
 
-#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "absl/types/span.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
@@ -37,6 +38,7 @@ limitations under the License.
 #include "xla/service/memory_space_assignment/allocation.h"
 #include "xla/shape_util.h"
 #include "xla/util.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace memory_space_assignment {
@@ -165,6 +167,7 @@ const HloInstruction* RuntimeSimulator::RemoveBytesFromQueueIfNotEmpty(
     const HloInstruction* retired_instruction =
         async_copy_like_queue.front().copy_like_start_inst;
     async_copy_like_queue.pop_front();
+    outstanding_async_copy_likes_.erase(retired_instruction);
     return retired_instruction;
   }
   return nullptr;
@@ -191,11 +194,7 @@ float RuntimeSimulator::SimulateAsyncCopyLikeDone(
           ? outstanding_write_default_queue_
           : outstanding_read_default_queue_;
 
-  if (absl::c_find_if(same_direction_queue,
-                      [&](const OutstandingAsyncCopyLike& async_copy_like) {
-                        return async_copy_like.copy_like_start_inst ==
-                               copy_like_start_instruction;
-                      }) == same_direction_queue.end()) {
+  if (!outstanding_async_copy_likes_.contains(copy_like_start_instruction)) {
     // The copy has already finished; thus, the copy-done takes no time.
     return 0.0;
   }
@@ -237,21 +236,36 @@ float RuntimeSimulator::SimulateComputeInstruction(
     absl::Span<const std::pair<int64_t, ShapeIndex>>
         operands_in_alternate_memory,
     absl::Span<const ShapeIndex> outputs_in_alternate_memory) {
-  // Calculate the time in which the instruction does not access the default
-  // memory.
-  float default_memory_idle_time =
-      cost_analysis_->GetDefaultMemoryBandwidthIdleTime(
-          *instruction, operands_in_alternate_memory,
-          outputs_in_alternate_memory);
+  auto [inst_elapsed, default_memory_idle_time] =
+      GetElapsedAndDefaultMemoryIdleTime(*instruction,
+                                         operands_in_alternate_memory,
+                                         outputs_in_alternate_memory);
 
   // Execute the outstanding async copy likes in the idle time.
   ProcessAsyncCopyLikesInIdleTime(default_memory_idle_time);
-
-  float inst_elapsed = cost_analysis_->GetInstructionElapsedInAlternateMemory(
-      *instruction, operands_in_alternate_memory, outputs_in_alternate_memory);
   return inst_elapsed;
 }
 
+std::pair<float, float> RuntimeSimulator::GetElapsedAndDefaultMemoryIdleTime(
+    const HloInstruction& instruction,
+    absl::Span<const std::pair<int64_t, ShapeIndex>>
+        operands_in_alternate_memory,
+    absl::Span<const ShapeIndex> outputs_in_alternate_memory) const {
+  float elapsed = cost_analysis_->GetInstructionElapsedInAlternateMemory(
+      instruction, operands_in_alternate_memory, outputs_in_alternate_memory);
+  // Calculate the time in which the instruction does not access the default
+  // memory, like CostAnalysis::GetDefaultMemoryBandwidthIdleTime.
+  float default_memory_bytes_accessed =
+      cost_analysis_->base_costs().BytesAccessed(instruction) -
+      cost_analysis_->GetBytesAccessedFromAlternateMemory(
+          instruction, operands_in_alternate_memory,
+          outputs_in_alternate_memory);
+  float elapsed_due_to_default_mem =
+      default_memory_bytes_accessed /
+      cost_analysis_->base_costs().BytesPerSecond();
+  return {elapsed, elapsed - elapsed_due_to_default_mem};
+}
+
 void RuntimeSimulator::ProcessAsyncCopyLikesInIdleTime(float time) {
   if (time <= 0.0) {
     return;
@@ -292,14 +306,18 @@ void RuntimeSimulator::ProcessAsyncCopyLikesInIdleTime(float time) {
 
 float RuntimeSimulator::SimulateElapsedTime(
     const HloModule* hlo_module, const AllocationSequence& allocations) {
-  InitializeAlternateMemoryMap(allocations);
-
   std::unique_ptr<xla::HloAliasAnalysis> alias_analysis =
       HloAliasAnalysis::Run(hlo_module).value();
   std::unique_ptr<HloLiveRange> hlo_live_range =
       HloLiveRange::Run(hlo_module->schedule(), *alias_analysis,
                         hlo_module->entry_computation())
           .value();
+  return SimulateElapsedTime(*hlo_live_range, allocations);
+}
+
+float RuntimeSimulator::SimulateElapsedTime(
+    const HloLiveRange& hlo_live_range, const AllocationSequence& allocations) {
+  InitializeAlternateMemoryMap(allocations);
 
   // Cannot provide a valid result if the bandwidth is invalid.
   CHECK_GT(cost_analysis_->base_costs().BytesPerSecond(), 0.0);
@@ -307,7 +325,7 @@ float RuntimeSimulator::SimulateElapsedTime(
   float total_elapsed = 0.0;
 
   const auto& instruction_sequence =
-      hlo_live_range->flattened_instruction_sequence().instructions();
+      hlo_live_range.flattened_instruction_sequence().instructions();
   for (const HloInstruction* instruction : instruction_sequence) {
     float inst_elapsed = 0.0;
     if (instruction->opcode() == HloOpcode::kWhile) {
@@ -334,9 +352,11 @@ float RuntimeSimulator::SimulateElapsedTime(
       if (direction == MemoryTransferDirection::kDefaultToAlternate) {
         outstanding_read_default_queue_.push_back(
             OutstandingAsyncCopyLike{instruction, transfer_bytes});
+        outstanding_async_copy_likes_.insert(instruction);
       } else if (direction == MemoryTransferDirection::kAlternateToDefault) {
         outstanding_write_default_queue_.push_back(
             OutstandingAsyncCopyLike{instruction, transfer_bytes});
+        outstanding_async_copy_likes_.insert(instruction);
       } else {
         // The copy does not involve default memory.
       }
@@ -375,5 +395,33 @@ float RuntimeSimulator::SimulateElapsedTime(
   }
   return total_elapsed;
 }
+
+std::vector<float> SimulateElapsedTimes(
+    absl::Span<const SimulationCandidate> candidates,
+    int64_t alternate_memory_space, tsl::thread::ThreadPool* thread_pool) {
+  std::vector<float> elapsed_times(candidates.size());
+  auto simulate = [&](size_t i) {
+    const SimulationCandidate& candidate = candidates[i];
+    RuntimeSimulator simulator(candidate.cost_analysis, alternate_memory_space);
+    elapsed_times[i] = simulator.SimulateElapsedTime(*candidate.hlo_live_range,
+                                                     *candidate.allocations);
+  };
+
+  if (thread_pool == nullptr || candidates.size() <= 1) {
+    for (size_t i = 0; i < candidates.size(); ++i) simulate(i);
+    return elapsed_times;
+  }
+
+  absl::BlockingCounter counter(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    thread_pool->Schedule([&, i] {
+      simulate(i);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  return elapsed_times;
+}
+
 }  // namespace memory_space_assignment
 }  // namespace xla
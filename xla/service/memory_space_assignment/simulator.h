@@ -22,12 +22,14 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/types/span.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/utils/hlo_live_range.h"
 #include "xla/service/memory_space_assignment/allocation.h"
 #include "xla/service/memory_space_assignment/cost_analysis.h"
 #include "xla/shape_util.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace memory_space_assignment {
@@ -74,7 +76,16 @@ class RuntimeSimulator {
       : cost_analysis_(cost_analysis),
         alternate_memory_space_(alternate_memory_space),
         outstanding_read_default_queue_(outstanding_read_default_queue),
-        outstanding_write_default_queue_(outstanding_write_default_queue) {}
+        outstanding_write_default_queue_(outstanding_write_default_queue) {
+    for (const OutstandingAsyncCopyLike& async_copy_like :
+         outstanding_read_default_queue_) {
+      outstanding_async_copy_likes_.insert(async_copy_like.copy_like_start_inst);
+    }
+    for (const OutstandingAsyncCopyLike& async_copy_like :
+         outstanding_write_default_queue_) {
+      outstanding_async_copy_likes_.insert(async_copy_like.copy_like_start_inst);
+    }
+  }
 
   ~RuntimeSimulator() = default;
 
@@ -96,6 +107,14 @@ class RuntimeSimulator {
   float SimulateElapsedTime(const HloModule* hlo_module,
                             const AllocationSequence& allocations);
 
+  // Like above, but simulates the flattened instruction sequence of the given
+  // live range, which must be computed for the module after memory space
+  // assignment. Callers that evaluate many allocations, e.g. when tuning
+  // memory space assignment, can use it to avoid recomputing the alias
+  // analysis and the live range of the module for every simulation.
+  float SimulateElapsedTime(const HloLiveRange& hlo_live_range,
+                            const AllocationSequence& allocations);
+
   // This is an auxiliary function for simulating the execution
   // time for executing a copy-done instruction. It returns the
   // elapsed time (in seconds) for executing the copy-done instruction.
@@ -154,9 +173,24 @@ class RuntimeSimulator {
   // the queues is empty and the other is not, it gets the full bandwdith.
   void ProcessAsyncCopyLikesInIdleTime(float time);
 
+  // Returns the elapsed time of a compute instruction, and the part of it in
+  // which the instruction does not access the default memory. It is
+  // equivalent to calling GetInstructionElapsedInAlternateMemory and
+  // GetDefaultMemoryBandwidthIdleTime, but only estimates the elapsed time
+  // once.
+  std::pair<float, float> GetElapsedAndDefaultMemoryIdleTime(
+      const HloInstruction& instruction,
+      absl::Span<const std::pair<int64_t, ShapeIndex>>
+          operands_in_alternate_memory,
+      absl::Span<const ShapeIndex> outputs_in_alternate_memory) const;
+
   int64_t alternate_memory_space_;
   std::list<OutstandingAsyncCopyLike> outstanding_read_default_queue_;
   std::list<OutstandingAsyncCopyLike> outstanding_write_default_queue_;
+  // The start instructions of all async copy likes in the queues above, so
+  // that a done instruction finds out in constant time whether it still has
+  // to wait for its copy.
+  absl::flat_hash_set<const HloInstruction*> outstanding_async_copy_likes_;
   absl::flat_hash_map<const HloInstruction*, std::vector<ShapeIndex>>
       outputs_in_alternate_memory_map_;
   absl::flat_hash_map<const HloInstruction*,
@@ -164,6 +198,23 @@ class RuntimeSimulator {
       operands_in_alternate_memory_map_;
 };
 
+// A memory space assignment result evaluated by SimulateElapsedTimes.
+struct SimulationCandidate {
+  CostAnalysis* cost_analysis;
+  // The live range of the module after memory space assignment.
+  const HloLiveRange* hlo_live_range;
+  const AllocationSequence* allocations;
+};
+
+// Returns RuntimeSimulator::SimulateElapsedTime of every candidate, in the
+// order of `candidates`. Every candidate is simulated by a RuntimeSimulator of
+// its own, so candidates are independent and are simulated concurrently on
+// `thread_pool` if it is not null.
+std::vector<float> SimulateElapsedTimes(
+    absl::Span<const SimulationCandidate> candidates,
+    int64_t alternate_memory_space,
+    tsl::thread::ThreadPool* thread_pool = nullptr);
+
 }  // namespace memory_space_assignment
 }  // namespace xla
 #endif  // XLA_SERVICE_MEMORY_SPACE_ASSIGNMENT_SIMULATOR_H_
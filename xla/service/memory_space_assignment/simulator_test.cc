@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -41,7 +42,9 @@ limitations under the License.
 #include "xla/tests/hlo_test_base.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -49,6 +52,7 @@ namespace {
 using memory_space_assignment::CostAnalysis;
 using memory_space_assignment::CostAnalysisOptions;
 using memory_space_assignment::RuntimeSimulator;
+using memory_space_assignment::SimulationCandidate;
 
 using ::testing::ElementsAreArray;
 using ::testing::IsEmpty;
@@ -321,6 +325,46 @@ TEST_F(MemorySpaceAssignmentSimulatorTest,
       1024);
 }
 
+TEST_F(MemorySpaceAssignmentSimulatorTest, SimulateElapsedTimesInParallel) {
+  absl::string_view hlo_string =
+      R"(HloModule module, is_scheduled=true
+        ENTRY Entry {
+        param_0 = f32[2048] parameter(0)
+        param_1 = f32[64] parameter(1)
+        param_2 = f32[128] parameter(2)
+        slice-start = ((f32[2048]), f32[64]{0:S(1)}, s32[]) slice-start(f32[2048] param_0), slice={[0:64]}
+        copy-start = (f32[64]{0:S(1)}, f32[64], u32[]) copy-start(f32[64] param_1)
+        slice-done = f32[64]{0:S(1)} slice-done(((f32[2048]), f32[64]{0:S(1)}, s32[]) slice-start)
+        copy-done = f32[64]{0:S(1)} copy-done(copy-start)
+        copy-start-overlap = (f32[128]{0:S(1)}, f32[128], u32[]) copy-start(f32[128] param_2)
+        add = f32[64]{0:S(1)} add(slice-done, copy-done)
+        ROOT copy-done-overlap = f32[128]{0:S(1)} copy-done(copy-start-overlap)
+      }
+      )";
+  TF_ASSERT_OK(Initialize(hlo_string));
+
+  // Same elapsed times as in AsyncCopyAndAsyncSliceAndComputeOverhead, with
+  // and without the allocations in the alternate memory.
+  memory_space_assignment::AllocationSequence no_allocations;
+  std::vector<SimulationCandidate> candidates;
+  for (int i = 0; i < 4; ++i) {
+    candidates.push_back(SimulationCandidate{
+        cost_analysis_.get(), hlo_live_range_.get(),
+        i % 2 == 0 ? &allocations_ : &no_allocations});
+  }
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "simulator", 2);
+  std::vector<float> elapsed_times = memory_space_assignment::
+      SimulateElapsedTimes(candidates, kAlternateMemorySpace, &thread_pool);
+  ASSERT_EQ(elapsed_times.size(), 4);
+  EXPECT_EQ(elapsed_times[0], 1024);
+  EXPECT_EQ(elapsed_times[2], 1024);
+  EXPECT_EQ(elapsed_times[1], elapsed_times[3]);
+  EXPECT_EQ(elapsed_times,
+            memory_space_assignment::SimulateElapsedTimes(
+                candidates, kAlternateMemorySpace));
+}
+
 class SimulateAsyncCopyLikeDoneTest
     : public MemorySpaceAssignmentSimulatorTest {
  protected:
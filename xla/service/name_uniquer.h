@@ -18,9 +18,11 @@ limitations under the License.
 
 #include <string>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "xla/types.h"
 
 namespace xla {
@@ -30,6 +32,8 @@ namespace xla {
 // GetUniqueName are guaranteed to be distinct for this instance of the class.
 // Note that the names will be sanitized to match regexp
 // "[a-zA-Z_][a-zA-Z0-9_.-]*".
+//
+// This class is thread-safe.
 class NameUniquer {
  public:
   // The separator must contain allowed characters only: "[a-zA-Z0-9_.-]".
@@ -75,9 +79,12 @@ class NameUniquer {
   // integer value.
   std::string separator_;
 
+  absl::Mutex mu_;
+
   // Map from name prefix to the generator data structure which tracks used
   // identifiers and generates new ones.
-  absl::flat_hash_map<std::string, SequentialIdGenerator> generated_names_;
+  absl::flat_hash_map<std::string, SequentialIdGenerator> generated_names_
+      ABSL_GUARDED_BY(mu_);
 
   NameUniquer(const NameUniquer&) = delete;
   NameUniquer& operator=(const NameUniquer&) = delete;
@@ -14,7 +14,15 @@ limitations under the License.
 ==============================================================================*/
 
 #include "xla/service/name_uniquer.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -129,5 +137,31 @@ TEST_F(NameUniquerTest, DetectSeparator) {
   EXPECT_EQ(uniquer.GetUniqueName("a"), "a__2");
 }
 
+TEST_F(NameUniquerTest, ConcurrentUniquing) {
+  NameUniquer uniquer(".");
+  constexpr int kNumThreads = 8;
+  constexpr int kNamesPerThread = 1000;
+
+  absl::Mutex mu;
+  std::vector<std::string> names;
+  {
+    tsl::thread::ThreadPool pool(tsl::Env::Default(), "test", kNumThreads);
+    for (int i = 0; i < kNumThreads; ++i) {
+      pool.Schedule([&] {
+        std::vector<std::string> thread_names;
+        for (int j = 0; j < kNamesPerThread; ++j) {
+          thread_names.push_back(uniquer.GetUniqueName("foo"));
+        }
+        absl::MutexLock lock(&mu);
+        names.insert(names.end(), thread_names.begin(), thread_names.end());
+      });
+    }
+  }
+
+  absl::flat_hash_set<std::string> unique_names(names.begin(), names.end());
+  EXPECT_EQ(names.size(), kNumThreads * kNamesPerThread);
+  EXPECT_EQ(unique_names.size(), names.size());
+}
+
 }  // namespace
 }  // namespace xla
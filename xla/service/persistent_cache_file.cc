@@ -0,0 +1,58 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/persistent_cache_file.h"
+
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
+
+namespace xla {
+
+absl::StatusOr<std::optional<std::string>> ReadPersistentCacheFile(
+    tsl::Env* env, absl::string_view path) {
+  std::string file_path(path);
+  if (!env->FileExists(file_path).ok()) {
+    return std::nullopt;
+  }
+  std::string contents;
+  TF_RETURN_IF_ERROR(tsl::ReadFileToString(env, file_path, &contents));
+  return contents;
+}
+
+absl::Status WritePersistentCacheFile(tsl::Env* env, absl::string_view path,
+                                      absl::string_view contents) {
+  std::string dir(tsl::io::Dirname(path));
+  if (!dir.empty() && !env->IsDirectory(dir).ok()) {
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  }
+  // The temporary file is in the same directory as the entry, so the rename
+  // doesn't cross file systems. Its name includes the process id and a time
+  // stamp to avoid collisions between concurrent writers.
+  std::string tmp_file_path = absl::StrCat(
+      path, ".tmp.", env->GetProcessId(), ".", absl::GetCurrentTimeNanos());
+  TF_RETURN_IF_ERROR(tsl::WriteStringToFile(env, tmp_file_path, contents));
+  return env->RenameFile(tmp_file_path, std::string(path));
+}
+
+}  // namespace xla
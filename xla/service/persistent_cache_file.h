@@ -0,0 +1,48 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_PERSISTENT_CACHE_FILE_H_
+#define XLA_SERVICE_PERSISTENT_CACHE_FILE_H_
+
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tsl/platform/env.h"
+
+namespace xla {
+
+// Helpers for the entries of on-disk caches that are shared by concurrent
+// compilations, possibly in different processes.
+
+// Returns the contents of the cache entry at `path`, or nullopt if there is no
+// such entry. Entries are written with WritePersistentCacheFile, so the
+// returned contents are always complete.
+absl::StatusOr<std::optional<std::string>> ReadPersistentCacheFile(
+    tsl::Env* env, absl::string_view path);
+
+// Atomically writes `contents` to the cache entry at `path`, creating its
+// directory if needed. The contents are written to a uniquely named temporary
+// file in the same directory, which is then renamed to `path`, so readers
+// never observe partially written entries. If several writers write the same
+// entry concurrently, the last rename wins.
+absl::Status WritePersistentCacheFile(tsl::Env* env, absl::string_view path,
+                                      absl::string_view contents);
+
+}  // namespace xla
+
+#endif  // XLA_SERVICE_PERSISTENT_CACHE_FILE_H_
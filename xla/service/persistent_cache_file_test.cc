@@ -0,0 +1,63 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/persistent_cache_file.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+using ::tsl::testing::IsOkAndHolds;
+
+TEST(PersistentCacheFileTest, ReadMissingEntry) {
+  tsl::Env* env = tsl::Env::Default();
+  std::string path = tsl::io::JoinPath(tsl::testing::TmpDir(), "missing");
+  TF_ASSERT_OK_AND_ASSIGN(std::optional<std::string> contents,
+                          ReadPersistentCacheFile(env, path));
+  EXPECT_EQ(contents, std::nullopt);
+}
+
+TEST(PersistentCacheFileTest, WriteCreatesDirectoryAndOverwrites) {
+  tsl::Env* env = tsl::Env::Default();
+  std::string dir = tsl::io::JoinPath(tsl::testing::TmpDir(), "cache", "ab");
+  std::string path = tsl::io::JoinPath(dir, "entry");
+
+  TF_ASSERT_OK(WritePersistentCacheFile(env, path, "first"));
+  TF_ASSERT_OK(WritePersistentCacheFile(env, path, "second"));
+  EXPECT_THAT(ReadPersistentCacheFile(env, path),
+              IsOkAndHolds(Optional(std::string("second"))));
+
+  // Temporary files are renamed away, so only the entry is left.
+  std::vector<std::string> children;
+  TF_ASSERT_OK(env->GetChildren(dir, &children));
+  EXPECT_THAT(children, ElementsAre("entry"));
+}
+
+}  // namespace
+}  // namespace xla
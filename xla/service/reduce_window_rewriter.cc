@@ -522,7 +522,7 @@ absl::StatusOr<bool> ReduceWindowRewriter::Run(
          computation->MakeInstructionPostOrder()) {
       HloReduceWindowInstruction* reduce_window =
           DynCast<HloReduceWindowInstruction>(instruction);
-      if (!reduce_window) {
+      if (!reduce_window || skip_(reduce_window)) {
         continue;
       }
       TF_ASSIGN_OR_RETURN(bool made_change,
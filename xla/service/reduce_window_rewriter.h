@@ -17,6 +17,7 @@ limitations under the License.
 #define XLA_SERVICE_REDUCE_WINDOW_REWRITER_H_
 
 #include <cstdint>
+#include <utility>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
@@ -25,6 +26,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_instructions.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/pass/hlo_pass_interface.h"
+#include "xla/util.h"
 
 namespace xla {
 
@@ -43,12 +45,16 @@ namespace xla {
 // tree-reduction (see details in the implementation).
 // Note that this may itself generate R1 ReduceWindow ops, which means this pass
 // needs to be run to a fixed point.
+//
+// ReduceWindow ops matching `skip` are left untouched, e.g. scans that a
+// backend implements natively in linear time.
 class ReduceWindowRewriter : public HloModulePass {
  public:
   // `base_length` is a size of a reduce-window we are comfortable with
   // executing.
-  explicit ReduceWindowRewriter(int64_t base_length)
-      : base_length_(base_length) {}
+  explicit ReduceWindowRewriter(int64_t base_length,
+                                HloPredicate skip = HloPredicateFalse)
+      : base_length_(base_length), skip_(std::move(skip)) {}
 
   absl::string_view name() const override { return "reduce-window-rewriter"; }
 
@@ -65,6 +71,7 @@ class ReduceWindowRewriter : public HloModulePass {
       HloReduceWindowInstruction* reduce_window);
 
   int64_t base_length_;
+  HloPredicate skip_;
 };
 
 }  // namespace xla
@@ -19,6 +19,8 @@ limitations under the License.
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/test.h"
 #include "xla/tests/hlo_test_base.h"
 #include "xla/xla_data.pb.h"
@@ -180,5 +182,30 @@ ENTRY entry (arg_0: f32[46592], arg_1: f32[46592]) -> (f32[46592], f32[46592]) {
   )");
 }
 
+TEST_F(ReduceWindowRewriterTest, SkipsMatchingReduceWindows) {
+  const char* hlo = R"(
+%binary_add {
+  %a = f32[] parameter(0)
+  %b = f32[] parameter(1)
+  ROOT %add = f32[] add(f32[] %a, f32[] %b)
+}
+
+ENTRY %CumSum (input: f32[1024]) -> f32[1024] {
+  %input = f32[1024]{0} parameter(0)
+  %constant = f32[] constant(0)
+  ROOT %reduce-window = f32[1024]{0} reduce-window(f32[1024]{0} %input, f32[] %constant), window={size=1024 pad=1023_0}, to_apply=%binary_add
+}
+)";
+
+  RunAndFilecheckHloRewrite(
+      hlo,
+      ReduceWindowRewriter{128,
+                           [](const HloInstruction* instr) {
+                             return instr->opcode() ==
+                                    HloOpcode::kReduceWindow;
+                           }},
+      std::nullopt);
+}
+
 }  // namespace
 }  // namespace xla
@@ -26,13 +26,36 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "tsl/platform/logging.h"
 
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
 namespace xla {
 namespace internal {
 
+// Tells the CPU that we are in a spin-wait loop, so that it can save power and
+// yield pipeline resources to a sibling hyperthread.
+static void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
 void AwaitAndLogIfStuck(std::atomic<int32_t>& ack, absl::Notification& ready,
                         std::string_view name, size_t num_threads,
                         absl::Duration warn_stuck_timeout,
-                        absl::Duration terminate_timeout) {
+                        absl::Duration terminate_timeout,
+                        int64_t spin_iterations) {
+  // `HasBeenNotified` is an acquire load, so a result published by the leader
+  // is visible after a successful spin just like after a blocking wait.
+  for (int64_t i = 0; i < spin_iterations; ++i) {
+    if (ready.HasBeenNotified()) return;
+    CpuRelax();
+  }
+
+  // Park the thread. absl::Notification blocks on a futex on Linux.
   if (ready.WaitForNotificationWithTimeout(warn_stuck_timeout)) {
     return;
   }
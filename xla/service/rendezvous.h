@@ -71,6 +71,12 @@ struct RendezvousResult<absl::StatusOr<R>> {
 template <typename R>
 using RendezvousResultType = typename RendezvousResult<R>::Type;
 
+// Participants that arrive before the last one first spin on the rendezvous
+// state for `spin_iterations` iterations, which is cheaper than parking when
+// the others arrive within a few microseconds, and then park the thread. Call
+// sites that expect long waits can pass `0` to park right away.
+inline constexpr int64_t kRendezvousSpinIterations = 1024;
+
 // The group of threads identifies itself with a key that must be unique to
 // the the group. When all threads have arrived at the rendezvous, one thread
 // executes the given function with the values supplied by each thread, and
@@ -80,14 +86,16 @@ template <typename R, typename K, typename V, typename Fn>
 RendezvousResultType<R> RendezvousSingle(
     std::string_view name, const K& key, const V& value, size_t num_threads,
     Fn fn, absl::Duration warn_stuck_timeout = absl::InfiniteDuration(),
-    absl::Duration terminate_timeout = absl::InfiniteDuration());
+    absl::Duration terminate_timeout = absl::InfiniteDuration(),
+    int64_t spin_iterations = kRendezvousSpinIterations);
 
 // A rendezvous for a group of threads that do not have any value arguments.
 template <typename R, typename K, typename Fn>
 RendezvousResultType<R> RendezvousSingle(
     std::string_view name, const K& key, size_t num_threads, Fn fn,
     absl::Duration warn_stuck_timeout = absl::InfiniteDuration(),
-    absl::Duration terminate_timeout = absl::InfiniteDuration());
+    absl::Duration terminate_timeout = absl::InfiniteDuration(),
+    int64_t spin_iterations = kRendezvousSpinIterations);
 
 // A rendezvous for a group of threads that do not have any computation to run
 // and simply acts as a barrier for a group of thread.
@@ -95,7 +103,8 @@ template <typename K>
 void RendezvousSingle(
     std::string_view name, const K& key, size_t num_threads,
     absl::Duration warn_stuck_timeout = absl::InfiniteDuration(),
-    absl::Duration terminate_timeout = absl::InfiniteDuration());
+    absl::Duration terminate_timeout = absl::InfiniteDuration(),
+    int64_t spin_iterations = kRendezvousSpinIterations);
 
 // An `std::once_flag`-like primitive for executing RendezvousSingle operations.
 //
@@ -155,7 +164,8 @@ RendezvousResultType<R> RendezvousSingle(
     RendezvousSingleFlag& flag, std::string_view name, const K& key,
     size_t num_threads, Fn fn,
     absl::Duration warn_stuck_timeout = absl::InfiniteDuration(),
-    absl::Duration terminate_timeout = absl::InfiniteDuration());
+    absl::Duration terminate_timeout = absl::InfiniteDuration(),
+    int64_t spin_iterations = kRendezvousSpinIterations);
 
 // A rendezvous for a group of threads that will be executed only if the flag is
 // not in `completed` state and will switch it to `completed` after finishing a
@@ -165,7 +175,8 @@ void RendezvousSingle(
     RendezvousSingleFlag& flag, std::string_view name, const K& key,
     size_t num_threads,
     absl::Duration warn_stuck_timeout = absl::InfiniteDuration(),
-    absl::Duration terminate_timeout = absl::InfiniteDuration());
+    absl::Duration terminate_timeout = absl::InfiniteDuration(),
+    int64_t spin_iterations = kRendezvousSpinIterations);
 
 //===----------------------------------------------------------------------===//
 // Internal implementation details.
@@ -252,7 +263,8 @@ class RendezvousMap {
 void AwaitAndLogIfStuck(std::atomic<int32_t>& ack, absl::Notification& ready,
                         std::string_view name, size_t num_threads,
                         absl::Duration warn_stuck_timeout,
-                        absl::Duration terminate_timeout);
+                        absl::Duration terminate_timeout,
+                        int64_t spin_iterations);
 }  // namespace internal
 
 //===----------------------------------------------------------------------===//
@@ -264,7 +276,8 @@ RendezvousResultType<R> RendezvousSingle(std::string_view name, const K& key,
                                          const V& value, size_t num_threads,
                                          Fn fn,
                                          absl::Duration warn_stuck_timeout,
-                                         absl::Duration terminate_timeout) {
+                                         absl::Duration terminate_timeout,
+                                         int64_t spin_iterations) {
   // Check that `fn` is callable with a span of values and returns `R`.
   static_assert(std::is_invocable_r_v<R, Fn, absl::Span<const V*>>,
                 "invalid rendezvous function signature");
@@ -305,7 +318,8 @@ RendezvousResultType<R> RendezvousSingle(std::string_view name, const K& key,
     // Threads arriving before the last one wait for a result to be computed by
     // the last joining thread.
     internal::AwaitAndLogIfStuck(state->ack, state->ready, name, num_threads,
-                                 warn_stuck_timeout, terminate_timeout);
+                                 warn_stuck_timeout, terminate_timeout,
+                                 spin_iterations);
   } else {
     // Last thread to arrive executes the function and completes rendezvous by
     // making result available to all participants. All other participants will
@@ -323,19 +337,21 @@ template <typename R, typename K, typename Fn>
 RendezvousResultType<R> RendezvousSingle(std::string_view name, const K& key,
                                          size_t num_threads, Fn fn,
                                          absl::Duration warn_stuck_timeout,
-                                         absl::Duration terminate_timeout) {
+                                         absl::Duration terminate_timeout,
+                                         int64_t spin_iterations) {
   return RendezvousSingle<R, K, std::nullopt_t>(
       name, key, std::nullopt, num_threads, [fn](auto) { return fn(); },
-      warn_stuck_timeout, terminate_timeout);
+      warn_stuck_timeout, terminate_timeout, spin_iterations);
 }
 
 template <typename K>
 void RendezvousSingle(std::string_view name, const K& key, size_t num_threads,
                       absl::Duration warn_stuck_timeout,
-                      absl::Duration terminate_timeout) {
+                      absl::Duration terminate_timeout,
+                      int64_t spin_iterations) {
   RendezvousSingle<std::nullopt_t, K, std::nullopt_t>(
       name, key, std::nullopt, num_threads, [](auto) { return std::nullopt; },
-      warn_stuck_timeout, terminate_timeout);
+      warn_stuck_timeout, terminate_timeout, spin_iterations);
 }
 
 template <typename R, typename K, typename Fn>
@@ -343,10 +359,12 @@ RendezvousResultType<R> RendezvousSingle(RendezvousSingleFlag& flag,
                                          std::string_view name, const K& key,
                                          size_t num_threads, Fn fn,
                                          absl::Duration warn_stuck_timeout,
-                                         absl::Duration terminate_timeout) {
+                                         absl::Duration terminate_timeout,
+                                         int64_t spin_iterations) {
   if (auto in_flight_rendezvous = flag.TryJoin()) {
     return RendezvousSingle<K>(name, key, num_threads, std::move(fn),
-                               warn_stuck_timeout, terminate_timeout);
+                               warn_stuck_timeout, terminate_timeout,
+                               spin_iterations);
   } else {
     return RendezvousResult<R>::Empty();
   }
@@ -356,10 +374,11 @@ template <typename K>
 void RendezvousSingle(RendezvousSingleFlag& flag, std::string_view name,
                       const K& key, size_t num_threads,
                       absl::Duration warn_stuck_timeout,
-                      absl::Duration terminate_timeout) {
+                      absl::Duration terminate_timeout,
+                      int64_t spin_iterations) {
   if (auto in_flight_rendezvous = flag.TryJoin()) {
     RendezvousSingle<K>(name, key, num_threads, warn_stuck_timeout,
-                        terminate_timeout);
+                        terminate_timeout, spin_iterations);
   }
 }
 
@@ -68,6 +68,28 @@ TEST(RendezvousTest, TwoParticipants) {
   ASSERT_EQ(*results[1], 42);
 }
 
+TEST(RendezvousTest, TwoParticipantsWithoutSpinning) {
+  absl::BlockingCounter counter(2);
+  std::vector<std::shared_ptr<int32_t>> results(2);
+
+  auto task = [&](int32_t id) {
+    return [&, id] {
+      results[id] = RendezvousSingle<int32_t>(
+          "rendezvous_test", 0, 2, [] { return 42; }, Timeout(), Terminate(),
+          /*spin_iterations=*/0);
+      counter.DecrementCount();
+    };
+  };
+
+  auto thread_pool = CreateThreadPool(2);
+  thread_pool.Schedule(task(0));
+  thread_pool.Schedule(task(1));
+  counter.Wait();
+
+  ASSERT_EQ(*results[0], 42);
+  ASSERT_EQ(*results[1], 42);
+}
+
 TEST(RendezvousTest, TwoParticipantsWithValues) {
   absl::BlockingCounter counter(2);
   std::vector<std::shared_ptr<int32_t>> results(2);
@@ -265,6 +287,32 @@ static void BM_RendezvousWithValues(benchmark::State& state) {
   }
 }
 
+// Measures the latency of back to back rendezvous between long running
+// participants, which is the pattern of in-process collectives. The second
+// argument is the number of spin iterations before the participants park.
+static void BM_RendezvousLatency(benchmark::State& state) {
+  int64_t num_threads = state.range(0);
+  int64_t spin_iterations = state.range(1);
+  constexpr int64_t kNumRounds = 1000;
+  auto thread_pool = CreateThreadPool(num_threads);
+
+  for (auto _ : state) {
+    absl::BlockingCounter counter(num_threads);
+    for (int64_t i = 0; i < num_threads; ++i) {
+      thread_pool.Schedule([&] {
+        for (int64_t round = 0; round < kNumRounds; ++round) {
+          RendezvousSingle("rendezvous_test", 0, num_threads,
+                           absl::InfiniteDuration(), absl::InfiniteDuration(),
+                           spin_iterations);
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumRounds);
+}
+
 BENCHMARK(BM_Rendezvous)
     ->MeasureProcessCPUTime()
     ->Arg(2)
@@ -281,5 +329,14 @@ BENCHMARK(BM_RendezvousWithValues)
     ->Arg(16)
     ->Arg(32);
 
+BENCHMARK(BM_RendezvousLatency)
+    ->UseRealTime()
+    ->ArgPair(2, 0)
+    ->ArgPair(2, kRendezvousSpinIterations)
+    ->ArgPair(4, 0)
+    ->ArgPair(4, kRendezvousSpinIterations)
+    ->ArgPair(8, 0)
+    ->ArgPair(8, kRendezvousSpinIterations);
+
 }  // namespace
 }  // namespace xla
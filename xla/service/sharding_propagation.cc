@@ -2835,6 +2835,21 @@ absl::StatusOr<bool> ShardingPropagation::RunToFixPoint(
   absl::flat_hash_set<const HloInstruction*> already_inferred_from_users;
   bool changed_last_iter = true;
   const bool may_merge_partial = is_spmd_ && aggressiveness > 0;
+  // Propagation only updates shardings and never changes the graph, so each
+  // computation's post order is computed once and reused by every iteration.
+  // The size check recomputes it should the instruction set ever change.
+  absl::flat_hash_map<const HloComputation*, std::vector<HloInstruction*>>
+      post_orders;
+  // Computations that have been visited since the last time a cache entry of
+  // one of their instructions was invalidated. Revisiting them cannot infer
+  // anything new, so each iteration only walks the computations whose
+  // instructions neighbor a sharding change.
+  absl::flat_hash_set<const HloComputation*> settled_computations;
+  auto invalidate = [&](absl::flat_hash_set<const HloInstruction*>& cache,
+                        const HloInstruction* hlo) {
+    cache.erase(hlo);
+    settled_computations.erase(hlo->parent());
+  };
   while (changed_last_iter) {
     changed_last_iter = false;
     int64_t inferred_from_shard_group_counter = 0;
@@ -2845,29 +2860,35 @@ absl::StatusOr<bool> ShardingPropagation::RunToFixPoint(
     for (const HloComputation* computation :
          module->computations(execution_threads)) {
       VLOG(2) << "Consider computation: " << computation->name();
-      std::vector<HloInstruction*> instructions =
-          computation->MakeInstructionPostOrder();
+      std::vector<HloInstruction*>& instructions = post_orders[computation];
+      if (static_cast<int64_t>(instructions.size()) !=
+          computation->instruction_count()) {
+        instructions = computation->MakeInstructionPostOrder();
+      }
 
       instruction_counter += instructions.size();
       already_sharded_counter += absl::c_count_if(
           instructions,
           [](const HloInstruction* inst) { return inst->has_sharding(); });
+      if (!settled_computations.insert(computation).second) {
+        continue;
+      }
       auto clear_cache = [&](HloInstruction* hlo,
                              HloInstruction* hlo_for_users = nullptr) {
         for (auto operand : hlo->operands()) {
-          already_inferred_from_users.erase(operand);
+          invalidate(already_inferred_from_users, operand);
         }
         if (hlo_for_users == nullptr) {
           hlo_for_users = hlo;
         }
         for (auto user : hlo_for_users->users()) {
-          already_inferred_from_operands.erase(user);
+          invalidate(already_inferred_from_operands, user);
           // If the user has called computations, then the parameter
           // instructions of these called computations are also removed from
           // already_inferred_from_operands.
           for (auto c : user->called_computations()) {
             for (auto parameter : c->parameter_instructions()) {
-              already_inferred_from_operands.erase(parameter);
+              invalidate(already_inferred_from_operands, parameter);
             }
           }
         }
@@ -2879,7 +2900,7 @@ absl::StatusOr<bool> ShardingPropagation::RunToFixPoint(
                   : shard_group_id_to_shard_like_group.at(shard_group_id);
           for (HloInstruction* member : shard_group) {
             if (member != hlo) {
-              already_inferred_from_shard_group.erase(member);
+              invalidate(already_inferred_from_shard_group, member);
             }
           }
         }
@@ -2985,7 +3006,7 @@ absl::StatusOr<bool> ShardingPropagation::RunToFixPoint(
           // op before it. If the conversion op is removed from cache, the
           // sharding op should also be removed.
           if (!already_inferred_from_users.contains(*it)) {
-            already_inferred_from_users.erase((*it)->operand(0));
+            invalidate(already_inferred_from_users, (*it)->operand(0));
           }
         }
         if (already_inferred_from_users.contains(*it)) {
@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "xla/service/while_loop_invariant_code_motion.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -27,11 +29,13 @@ limitations under the License.
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/map_util.h"
 #include "xla/service/compile_time_cap.h"
+#include "xla/service/hlo_cost_analysis.h"
 #include "xla/service/hlo_dce.h"
 #include "xla/service/while_loop_analysis.h"
 #include "xla/service/while_util.h"
@@ -47,6 +51,20 @@ using absl::flat_hash_map;
 using absl::flat_hash_set;
 using absl::InlinedVector;
 
+// Returns the total size of the array subshapes of `shape`.
+static int64_t ArraySubshapesSize(
+    const Shape& shape,
+    const WhileLoopInvariantCodeMotion::ShapeSizeFunction& shape_size) {
+  int64_t size = 0;
+  ShapeUtil::ForEachSubshape(
+      shape, [&](const Shape& subshape, const ShapeIndex& /*index*/) {
+        if (subshape.IsArray()) {
+          size += shape_size(subshape);
+        }
+      });
+  return size;
+}
+
 // Copies `to_hoist` to the computation containing `while_instr`, hoisting its
 // operands as needed.  All of its transitive operands are expected to be either
 // in `hoisted_instructions` or `unhoisted_invariant_instructions`.  This
@@ -225,6 +243,11 @@ WhileLoopInvariantCodeMotion::TryHoistingInvariantInstructionsFromWhileBody(
   std::vector<HloInstruction*> instructions_to_replace;
   std::vector<HloInstruction*> replacement_instructions;
 
+  // With a memory budget, instructions worth hoisting are only collected here
+  // and hoisted after the scan, once they have been ranked against each other.
+  std::vector<HloInstruction*> hoisting_candidates;
+  flat_hash_set<HloInstruction*> hoisting_candidate_set;
+
   for (auto* instruction : while_body->MakeInstructionPostOrder()) {
     allowance->DeductCost(1);
     if (!allowance->ContinueAnalysis()) {
@@ -253,25 +276,13 @@ WhileLoopInvariantCodeMotion::TryHoistingInvariantInstructionsFromWhileBody(
       // platforms where memory is limited. This can be especially harmful if
       // the instruction has a significantly larger output than its input, e.g.
       // kIota, kBroadcast or kConstant.
-      int64_t input_size = 0, output_size = 0;
-
+      int64_t input_size = 0;
       for (auto* operand : instruction->operands()) {
-        ShapeUtil::ForEachSubshape(
-            operand->shape(), [&input_size, this](const Shape& subshape,
-                                                  const ShapeIndex& /*index*/) {
-              if (subshape.IsArray()) {
-                input_size += shape_size_function_(subshape);
-              }
-            });
+        input_size +=
+            ArraySubshapesSize(operand->shape(), shape_size_function_);
       }
-      ShapeUtil::ForEachSubshape(
-          instruction->shape(),
-          [&output_size, this](const Shape& subshape,
-                               const ShapeIndex& /*index*/) {
-            if (subshape.IsArray()) {
-              output_size += shape_size_function_(subshape);
-            }
-          });
+      int64_t output_size =
+          ArraySubshapesSize(instruction->shape(), shape_size_function_);
 
       if (output_size > input_size * *hoist_size_inflation_ratio_) {
         continue;
@@ -281,6 +292,7 @@ WhileLoopInvariantCodeMotion::TryHoistingInvariantInstructionsFromWhileBody(
     auto is_invariant = [&](HloInstruction* op) {
       return hoisted_instructions.find(op) != hoisted_instructions.end() ||
              unhoisted_invariant_instructions.contains(op) ||
+             hoisting_candidate_set.contains(op) ||
              op->opcode() == HloOpcode::kConstant;
     };
 
@@ -300,6 +312,12 @@ WhileLoopInvariantCodeMotion::TryHoistingInvariantInstructionsFromWhileBody(
       continue;
     }
 
+    if (hoist_memory_budget_) {
+      hoisting_candidates.push_back(instruction);
+      hoisting_candidate_set.insert(instruction);
+      continue;
+    }
+
     VLOG(2) << "Hoisting " << instruction->ToString(print_no_metadata);
 
     CreateLoopInvariantCopy(&hoisted_instructions,
@@ -311,6 +329,33 @@ WhileLoopInvariantCodeMotion::TryHoistingInvariantInstructionsFromWhileBody(
         FindOrDie(hoisted_instructions, instruction));
   }
 
+  if (!hoisting_candidates.empty()) {
+    TF_ASSIGN_OR_RETURN(
+        std::vector<HloInstruction*> selected,
+        SelectCandidatesWithinBudget(while_instr, maybe_upper_bound,
+                                     hoisting_candidates));
+    flat_hash_set<HloInstruction*> selected_set(selected.begin(),
+                                                selected.end());
+    // Candidates that are not hoisted themselves are still invariant, and may
+    // be hoisted as operands of selected candidates. Constants are invariant
+    // anyway and are kept out of the set, as above.
+    for (HloInstruction* candidate : hoisting_candidates) {
+      if (!selected_set.contains(candidate) &&
+          candidate->opcode() != HloOpcode::kConstant) {
+        InsertOrDie(&unhoisted_invariant_instructions, candidate);
+      }
+    }
+    for (HloInstruction* instruction : selected) {
+      VLOG(2) << "Hoisting " << instruction->ToString(print_no_metadata);
+      CreateLoopInvariantCopy(&hoisted_instructions,
+                              &unhoisted_invariant_instructions, while_instr,
+                              instruction);
+      instructions_to_replace.push_back(instruction);
+      replacement_instructions.push_back(
+          FindOrDie(hoisted_instructions, instruction));
+    }
+  }
+
   if (instructions_to_replace.empty()) {
     return false;
   }
@@ -337,6 +382,63 @@ WhileLoopInvariantCodeMotion::TryHoistingInvariantInstructionsFromWhileBody(
   return true;
 }
 
+absl::StatusOr<std::vector<HloInstruction*>>
+WhileLoopInvariantCodeMotion::SelectCandidatesWithinBudget(
+    HloInstruction* while_instr, std::optional<int64_t> trip_count_upper_bound,
+    absl::Span<HloInstruction* const> candidates) {
+  HloCostAnalysis cost_analysis([this](const Shape& shape) -> int64_t {
+    return shape.IsArray() ? shape_size_function_(shape) : 0;
+  });
+  TF_RETURN_IF_ERROR(while_instr->while_body()->Accept(&cost_analysis));
+
+  // Hoisting saves the cost of every iteration but the first one. Loops with
+  // an unknown trip count are assumed to run at least twice.
+  int64_t trip_count = trip_count_upper_bound.value_or(2);
+  int64_t saved_iterations = std::max<int64_t>(trip_count - 1, 1);
+
+  struct Candidate {
+    int64_t index;
+    int64_t live_bytes;
+    double saved_cost_per_byte;
+  };
+  std::vector<Candidate> ranked;
+  ranked.reserve(candidates.size());
+  for (int64_t i = 0; i < candidates.size(); ++i) {
+    const HloInstruction* candidate = candidates[i];
+    double cost = cost_analysis.flop_count(*candidate) +
+                  cost_analysis.transcendental_count(*candidate) +
+                  cost_analysis.bytes_accessed(*candidate);
+    int64_t live_bytes =
+        ArraySubshapesSize(candidate->shape(), shape_size_function_);
+    ranked.push_back(
+        {i, live_bytes,
+         cost * saved_iterations / std::max<int64_t>(live_bytes, 1)});
+  }
+  absl::c_stable_sort(ranked, [](const Candidate& a, const Candidate& b) {
+    return a.saved_cost_per_byte > b.saved_cost_per_byte;
+  });
+
+  std::vector<bool> is_selected(candidates.size(), false);
+  for (const Candidate& candidate : ranked) {
+    if (candidate.live_bytes > remaining_memory_budget_) {
+      VLOG(2) << "Not hoisting " << candidates[candidate.index]->name()
+              << " of " << candidate.live_bytes << " bytes, only "
+              << remaining_memory_budget_ << " bytes of budget are left.";
+      continue;
+    }
+    remaining_memory_budget_ -= candidate.live_bytes;
+    is_selected[candidate.index] = true;
+  }
+
+  std::vector<HloInstruction*> selected;
+  for (int64_t i = 0; i < candidates.size(); ++i) {
+    if (is_selected[i]) {
+      selected.push_back(candidates[i]);
+    }
+  }
+  return selected;
+}
+
 absl::StatusOr<bool> WhileLoopInvariantCodeMotion::Run(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
@@ -350,6 +452,7 @@ absl::StatusOr<bool> WhileLoopInvariantCodeMotion::Run(
                     HloPredicateIsOp<HloOpcode::kWhile>);
   }
   BoundNonLinearCompilerAnalysis allowance(module, name(), 10);
+  remaining_memory_budget_ = hoist_memory_budget_.value_or(0);
 
   for (HloInstruction* while_instr : while_instrs) {
     // Right now we only hoist computations from the while body, but
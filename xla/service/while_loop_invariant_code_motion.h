@@ -16,9 +16,15 @@ limitations under the License.
 #ifndef XLA_SERVICE_WHILE_LOOP_INVARIANT_CODE_MOTION_H_
 #define XLA_SERVICE_WHILE_LOOP_INVARIANT_CODE_MOTION_H_
 
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/pass/hlo_pass_interface.h"
@@ -56,16 +62,24 @@ class WhileLoopInvariantCodeMotion : public HloModulePass {
   // mid level HLO pipeline because the reshapes will often get fused with
   // consumer instructions, and won't cost anything if not hoisted. However,
   // any stand alone reshapes after fusion will benefit from hoisting.
+  //
+  // If provided, `hoist_memory_budget` bounds the total size in bytes of the
+  // values made live across while loops by hoisting in the module. Candidates
+  // of each loop are then ranked by the compute they save, as estimated by
+  // HloCostAnalysis and multiplied by the loop trip count, per byte they keep
+  // live, and are hoisted greedily while they fit in the remaining budget.
   explicit WhileLoopInvariantCodeMotion(
       bool hoist_constants = false, bool hoist_reshapes = false,
       bool hoist_other = true,
       std::optional<float> hoist_size_inflation_ratio = std::nullopt,
-      ShapeSizeFunction shape_size_function = ShapeUtil::ByteSizeOfElements)
+      ShapeSizeFunction shape_size_function = ShapeUtil::ByteSizeOfElements,
+      std::optional<int64_t> hoist_memory_budget = std::nullopt)
       : hoist_constants_(hoist_constants),
         hoist_reshapes_(hoist_reshapes),
         hoist_other_(hoist_other),
         hoist_size_inflation_ratio_(hoist_size_inflation_ratio),
-        shape_size_function_(shape_size_function) {}
+        shape_size_function_(shape_size_function),
+        hoist_memory_budget_(hoist_memory_budget) {}
   ~WhileLoopInvariantCodeMotion() override = default;
 
   absl::string_view name() const override {
@@ -78,6 +92,13 @@ class WhileLoopInvariantCodeMotion : public HloModulePass {
 
  private:
   bool NotWorthHoistingIndividually(const HloInstruction& instruction);
+  // Returns the subset of `candidates`, in their original order, that fits in
+  // the remaining memory budget, preferring the candidates that save the most
+  // compute per hoisted byte.
+  absl::StatusOr<std::vector<HloInstruction*>> SelectCandidatesWithinBudget(
+      HloInstruction* while_instr,
+      std::optional<int64_t> trip_count_upper_bound,
+      absl::Span<HloInstruction* const> candidates);
   absl::StatusOr<bool> TryHoistingInvariantInstructionsFromWhileBody(
       HloInstruction* while_instr, BoundNonLinearCompilerAnalysis* allowance);
 
@@ -86,6 +107,9 @@ class WhileLoopInvariantCodeMotion : public HloModulePass {
   bool hoist_other_;
   std::optional<float> hoist_size_inflation_ratio_;
   ShapeSizeFunction shape_size_function_;
+  std::optional<int64_t> hoist_memory_budget_;
+  // Part of `hoist_memory_budget_` not yet used by the current run.
+  int64_t remaining_memory_budget_ = 0;
 };
 }  // namespace xla
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "xla/service/while_loop_invariant_code_motion.h"
 
+#include <optional>
+
 #include "absl/log/log.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
@@ -639,6 +641,42 @@ TEST_F(WhileLoopInvariantCodeMotionTest, NoHoistInflating) {
   EXPECT_FALSE(simplified_loop);
 }
 
+TEST_F(WhileLoopInvariantCodeMotionTest, HoistsWithinMemoryBudget) {
+  auto m = ParseAndReturnVerifiedModule(kInflatingTestCase).value();
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool simplified_loop,
+      WhileLoopInvariantCodeMotion(
+          /*hoist_constants=*/true, /*hoist_reshapes=*/false,
+          /*hoist_other=*/true, /*hoist_size_inflation_ratio=*/std::nullopt,
+          ShapeUtil::ByteSizeOfElements, /*hoist_memory_budget=*/1024)
+          .Run(m.get()));
+  EXPECT_TRUE(simplified_loop);
+
+  // The reduce is hoisted together with its operands, but the large add does
+  // not fit in the budget and is not made live across the loop.
+  HloComputation* while_body = m->GetComputationWithName("wide.body");
+  ASSERT_NE(while_body, nullptr);
+  EXPECT_THAT(while_body->instructions(), Not(Contains(op::Reduce())));
+  for (const Shape& shape :
+       while_body->parameter_instruction(0)->shape().tuple_shapes()) {
+    EXPECT_LE(ShapeUtil::ByteSizeOf(shape), 1024);
+  }
+}
+
+TEST_F(WhileLoopInvariantCodeMotionTest, NoHoistOverMemoryBudget) {
+  auto m = ParseAndReturnVerifiedModule(kInflatingTestCase).value();
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool simplified_loop,
+      WhileLoopInvariantCodeMotion(
+          /*hoist_constants=*/true, /*hoist_reshapes=*/false,
+          /*hoist_other=*/true, /*hoist_size_inflation_ratio=*/std::nullopt,
+          ShapeUtil::ByteSizeOfElements, /*hoist_memory_budget=*/0)
+          .Run(m.get()));
+  EXPECT_FALSE(simplified_loop);
+}
+
 TEST_F(WhileLoopInvariantCodeMotionTest, DoesNotHoistSPMDFullToShardShape) {
   auto m = CreateNewVerifiedModule();
   auto array_s32 = ShapeUtil::MakeShape(S32, {4});
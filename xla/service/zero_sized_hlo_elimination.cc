@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/service/zero_sized_hlo_elimination.h"
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "xla/hlo/ir/hlo_computation.h"
@@ -30,34 +31,58 @@ limitations under the License.
 
 namespace xla {
 
+absl::StatusOr<bool> ZeroSizedHloElimination::RunOnComputation(
+    HloComputation* comp) {
+  bool changed = false;
+  for (HloInstruction* instruction : comp->MakeInstructionPostOrder()) {
+    if (instruction->HasSideEffect() || !instruction->shape().IsArray() ||
+        instruction->opcode() == HloOpcode::kConstant) {
+      continue;
+    }
+    if (comp->IsSafelyRemovable(instruction) &&
+        ShapeUtil::IsZeroElementArray(instruction->shape()) &&
+        instruction->shape().is_static()) {
+      // If the instruction doesn't have a layout, use a default layout for
+      // the literal.
+      Shape shape = instruction->shape();
+      if (!LayoutUtil::HasLayout(shape)) {
+        LayoutUtil::SetToDefaultLayout(&shape);
+      }
+      TF_RETURN_IF_ERROR(comp->ReplaceWithNewInstruction(
+          instruction,
+          HloInstruction::CreateConstant(Literal::CreateFromShape(shape))));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
 absl::StatusOr<bool> ZeroSizedHloElimination::Run(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
   bool changed = false;
   for (HloComputation* comp :
        module->MakeNonfusionComputations(execution_threads)) {
-    for (HloInstruction* instruction : comp->MakeInstructionPostOrder()) {
-      if (instruction->HasSideEffect() || !instruction->shape().IsArray() ||
-          instruction->opcode() == HloOpcode::kConstant) {
-        continue;
-      }
-      if (comp->IsSafelyRemovable(instruction) &&
-          ShapeUtil::IsZeroElementArray(instruction->shape()) &&
-          instruction->shape().is_static()) {
-        // If the instruction doesn't have a layout, use a default layout for
-        // the literal.
-        Shape shape = instruction->shape();
-        if (!LayoutUtil::HasLayout(shape)) {
-          LayoutUtil::SetToDefaultLayout(&shape);
-        }
-        TF_RETURN_IF_ERROR(comp->ReplaceWithNewInstruction(
-            instruction,
-            HloInstruction::CreateConstant(Literal::CreateFromShape(shape))));
-        changed = true;
-      }
-    }
+    TF_ASSIGN_OR_RETURN(bool comp_changed, RunOnComputation(comp));
+    changed |= comp_changed;
   }
   return changed;
 }
 
+absl::Status ZeroSizedHloElimination::RunOnChangedComputations(
+    HloModule* module, RunState* run_state,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  for (HloComputation* comp :
+       module->MakeNonfusionComputations(execution_threads)) {
+    if (!run_state->changed_last_iteration.contains(comp)) {
+      continue;
+    }
+    TF_ASSIGN_OR_RETURN(bool comp_changed, RunOnComputation(comp));
+    if (comp_changed) {
+      run_state->changed_this_iteration.insert(comp);
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace xla
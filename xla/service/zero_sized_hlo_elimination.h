@@ -17,8 +17,10 @@ limitations under the License.
 #define XLA_SERVICE_ZERO_SIZED_HLO_ELIMINATION_H_
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/pass/hlo_pass_interface.h"
 
@@ -30,9 +32,19 @@ class ZeroSizedHloElimination : public HloModulePass {
   absl::StatusOr<bool> Run(
       HloModule* module,
       const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+  absl::Status RunOnChangedComputations(
+      HloModule* module, RunState* run_state,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
   absl::string_view name() const override {
     return "zero_sized_hlo_elimination";
   }
+
+  // Every computation is rewritten on its own, and rewritten computations
+  // have no zero sized instructions left to replace.
+  bool IsComputationLocal() const override { return true; }
+
+ private:
+  static absl::StatusOr<bool> RunOnComputation(HloComputation* comp);
 };
 }  // namespace xla
 #endif  // XLA_SERVICE_ZERO_SIZED_HLO_ELIMINATION_H_
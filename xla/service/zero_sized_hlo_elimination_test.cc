@@ -18,14 +18,19 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/hlo/pass/hlo_pass_interface.h"
+#include "xla/hlo/pass/hlo_pass_pipeline.h"
 #include "xla/literal_util.h"
 #include "xla/shape.h"
 #include "xla/shape_util.h"
 #include "xla/test.h"
 #include "xla/tests/hlo_test_base.h"
+#include "xla/tsl/lib/core/status_test_util.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/statusor.h"
@@ -92,5 +97,57 @@ TEST_F(ZeroSizedHloEliminationTest, ZeroSizedInstructionWithoutLayoutFolded) {
   EXPECT_TRUE(changed);
 }
 
+constexpr char kModuleWithCall[] = R"(
+  HloModule m
+
+  f {
+    fp = f32[3,0] parameter(0)
+    ft = f32[3,0] tanh(fp)
+    ROOT fr = (f32[3,0]) tuple(ft)
+  }
+
+  ENTRY e {
+    ep = f32[3,0] parameter(0)
+    et = f32[3,0] tanh(ep)
+    c = (f32[3,0]) call(ep), to_apply=f
+    ROOT er = (f32[3,0], (f32[3,0])) tuple(et, c)
+  })";
+
+TEST_F(ZeroSizedHloEliminationTest, RunsOnlyOnChangedComputations) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleWithCall));
+  HloComputation* f = module->GetComputationWithName("f");
+  HloComputation* entry = module->entry_computation();
+
+  HloPassInterface::RunState run_state;
+  run_state.changed_last_iteration.insert(f);
+  TF_ASSERT_OK(ZeroSizedHloElimination{}.RunOnChangedComputations(
+      module.get(), &run_state, /*execution_threads=*/{}));
+  EXPECT_EQ(f->root_instruction()->operand(0)->opcode(), HloOpcode::kConstant);
+  EXPECT_EQ(entry->root_instruction()->operand(0)->opcode(), HloOpcode::kTanh);
+  EXPECT_EQ(run_state.changed_this_iteration,
+            absl::flat_hash_set<HloComputation*>({f}));
+}
+
+TEST_F(ZeroSizedHloEliminationTest, RunsIncrementallyInPipeline) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModuleWithCall));
+  HloPassPipeline pipeline("incremental");
+  pipeline.set_incremental(true);
+  pipeline.AddPass<ZeroSizedHloElimination>();
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_TRUE(changed);
+  for (const HloComputation* computation : module->computations()) {
+    EXPECT_EQ(computation->root_instruction()->operand(0)->opcode(),
+              HloOpcode::kConstant)
+        << computation->name();
+  }
+
+  // All computations were produced by the pass, so it doesn't run again.
+  TF_ASSERT_OK_AND_ASSIGN(changed, pipeline.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
 }  // namespace
 }  // namespace xla
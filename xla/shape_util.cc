@@ -1936,34 +1936,86 @@ struct ParallelState {
     absl::Span<const int64_t> count, absl::Span<const int64_t> incr,
     const ForEachParallelVisitorFunction& visitor_function) {
   ForEachState s(shape, base, count, incr);
-  ParallelState pstate(s.CalculateNumSteps());
   if (s.IsZeroElementArray()) {
-    return pstate.status;
+    return absl::OkStatus();
   }
-  // Allows handling R0 arrays, such that the visitor function will be called
-  // once with the proper empty indexes.
-  int64_t n = -1;
-  while (n < s.rank) {
-    auto indexes_copy = s.indexes;
-    pstate.pool->Schedule([indexes_copy, &visitor_function, &pstate] {
+  // Scheduling a task per index costs more than most visitors do. Hand out
+  // contiguous batches of steps instead, a few per thread, so that threads
+  // that finish early can still pick up work from slower ones.
+  constexpr int64_t kTasksPerThread = 4;
+  const int64_t num_steps = s.CalculateNumSteps();
+  const int64_t steps_per_task = CeilOfRatio<int64_t>(
+      num_steps, kTasksPerThread * GetForEachIndexParallelThreadCount());
+  const int64_t num_tasks = CeilOfRatio(num_steps, steps_per_task);
+  ParallelState pstate(num_tasks);
+  for (int64_t task = 0; task < num_tasks; ++task) {
+    pstate.pool->Schedule([&, task] {
       const int thread_id = pstate.pool->CurrentThreadId();
-      absl::StatusOr<bool> result = visitor_function(indexes_copy, thread_id);
-      if (!result.ok()) {
-        absl::MutexLock lock(&pstate.mu);
-        if (pstate.status.ok()) {
-          pstate.status = result.status();
+      const int64_t first_step = task * steps_per_task;
+      const int64_t last_step =
+          std::min(first_step + steps_per_task, num_steps);
+      ForEachState task_state(shape, base, count, incr);
+      task_state.SetToStep(first_step);
+      for (int64_t step = first_step; step < last_step; ++step) {
+        absl::StatusOr<bool> result =
+            visitor_function(task_state.indexes_span, thread_id);
+        if (!result.ok()) {
+          absl::MutexLock lock(&pstate.mu);
+          if (pstate.status.ok()) {
+            pstate.status = result.status();
+          }
+          break;
         }
+        task_state.IncrementDim();
       }
       pstate.TaskComplete();
     });
-    // Increments dimensions in minor to major order.
-    n = s.IncrementDim();
   }
 
   pstate.Wait();
   return pstate.status;
 }
 
+/* static */ absl::Status ShapeUtil::ForEachMinorDimensionSpanWithStatus(
+    const Shape& shape, const ForEachSpanVisitorFunction& visitor_function) {
+  if (shape.rank() == 0) {
+    return visitor_function({}, 1).status();
+  }
+  const int64_t minor_dim = LayoutUtil::Minor(shape.layout(), 0);
+  const int64_t span_length = shape.dimensions(minor_dim);
+  std::vector<int64_t> base(shape.rank(), 0);
+  std::vector<int64_t> count(shape.dimensions().begin(),
+                             shape.dimensions().end());
+  std::vector<int64_t> incr(shape.rank(), 1);
+  // A zero count pins the minor dimension to its base.
+  count[minor_dim] = 0;
+  return ForEachIndexWithStatus(
+      shape, base, count, incr, [&](absl::Span<const int64_t> index) {
+        return visitor_function(index, span_length);
+      });
+}
+
+/* static */ absl::Status
+ShapeUtil::ForEachMinorDimensionSpanParallelWithStatus(
+    const Shape& shape,
+    const ForEachParallelSpanVisitorFunction& visitor_function) {
+  if (shape.rank() == 0) {
+    return visitor_function({}, 1, /*thread_id=*/-1).status();
+  }
+  const int64_t minor_dim = LayoutUtil::Minor(shape.layout(), 0);
+  const int64_t span_length = shape.dimensions(minor_dim);
+  std::vector<int64_t> base(shape.rank(), 0);
+  std::vector<int64_t> count(shape.dimensions().begin(),
+                             shape.dimensions().end());
+  std::vector<int64_t> incr(shape.rank(), 1);
+  count[minor_dim] = 0;
+  return ForEachIndexParallelWithStatus(
+      shape, base, count, incr,
+      [&](absl::Span<const int64_t> index, int thread_id) {
+        return visitor_function(index, span_length, thread_id);
+      });
+}
+
 /* static */ int ShapeUtil::GetForEachIndexParallelThreadCount() {
   ParallelState pstate(/*task_count=*/0);
   return pstate.pool->NumThreads();
@@ -2090,6 +2142,18 @@ std::optional<absl::InlinedVector<int64_t, 4>> ShapeUtil::ByteStrides(
   return size * ByteSizeOfPrimitiveType(shape.element_type());
 }
 
+void ShapeUtil::ForEachState::SetToStep(int64_t step) {
+  // Steps enumerate the iteration space in minor to major order, see
+  // IncrementDim().
+  for (int64_t n = 0; n < rank; ++n) {
+    const int64_t dim = minor_to_major[n];
+    const int64_t dim_steps =
+        count[dim] == 0 ? 1 : 1 + (count[dim] - 1) / incr[dim];
+    indexes_ptr[dim] = base[dim] + (step % dim_steps) * incr[dim];
+    step /= dim_steps;
+  }
+}
+
 int64_t ShapeUtil::ForEachState::CalculateNumSteps() const {
   if (IsZeroElementArray()) return 0;
 
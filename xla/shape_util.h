@@ -1016,6 +1016,27 @@ class ShapeUtil {
       const Shape& shape,
       const ForEachParallelVisitorFunction& visitor_function);
 
+  using ForEachSpanVisitorFunction = absl::FunctionRef<absl::StatusOr<bool>(
+      absl::Span<const int64_t>, int64_t)>;
+
+  using ForEachParallelSpanVisitorFunction =
+      absl::FunctionRef<absl::StatusOr<bool>(absl::Span<const int64_t>,
+                                             int64_t, int)>;
+
+  // Iterates over every element of `shape` in runs along the most minor
+  // dimension of its layout. The visitor_function is called with the index of
+  // the first element of a run and the number of elements in it, so callers
+  // can process a run with a tight loop over consecutive elements in memory.
+  // A rank 0 shape is visited as a single run of length 1.
+  static absl::Status ForEachMinorDimensionSpanWithStatus(
+      const Shape& shape, const ForEachSpanVisitorFunction& visitor_function);
+
+  // A parallel version of ForEachMinorDimensionSpanWithStatus, with the same
+  // requirements on visitor_function as ForEachIndexParallel.
+  static absl::Status ForEachMinorDimensionSpanParallelWithStatus(
+      const Shape& shape,
+      const ForEachParallelSpanVisitorFunction& visitor_function);
+
   // Strips device-specific information, namely tiling and memory-space
   // information, from a shape.
   static Shape DeviceShapeToHostShape(Shape s);
@@ -1112,6 +1133,10 @@ class ShapeUtil {
     int64_t IncrementDim();
     bool IsZeroElementArray() const;
 
+    // Moves `indexes` to the index visited after `step` calls to
+    // IncrementDim() from the base.
+    void SetToStep(int64_t step);
+
     // Returns the number of visited elements assuming that the iteration will
     // not be interrupted.
     int64_t CalculateNumSteps() const;
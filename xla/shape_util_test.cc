@@ -42,6 +42,7 @@ limitations under the License.
 namespace xla {
 namespace {
 
+using ::testing::Each;
 using ::testing::ElementsAre;
 
 TEST(ShapeUtilTest, GetDimensionHelperCanNegativeIndex) {
@@ -856,6 +857,80 @@ TEST(ShapeUtilTest, ForEachIndexParallel_CalledFromMultipleThreads) {
   }
 }
 
+TEST(ShapeUtilTest, ForEachIndexParallel_ManyIndexesWithSkips) {
+  Shape shape = ShapeUtil::MakeShape(F32, {100, 1000});
+  std::vector<int64_t> output(100 * 1000, 0);
+  auto set_func = [&](absl::Span<const int64_t> indexes,
+                      int /*thread_id*/) -> absl::StatusOr<bool> {
+    output[indexes[0] * 1000 + indexes[1]]++;
+    return true;
+  };
+
+  ShapeUtil::ForEachIndexParallel(shape, /*base=*/{1, 2}, /*count=*/{99, 997},
+                                  /*incr=*/{3, 5}, set_func);
+
+  for (int i = 0; i < 100; ++i) {
+    for (int j = 0; j < 1000; ++j) {
+      const bool visited = i >= 1 && (i - 1) % 3 == 0 && j >= 2 && j < 999 &&
+                           (j - 2) % 5 == 0;
+      EXPECT_EQ(output[i * 1000 + j], visited ? 1 : 0) << i << ", " << j;
+    }
+  }
+}
+
+TEST(ShapeUtilTest, ForEachMinorDimensionSpan) {
+  Shape shape = ShapeUtil::MakeShapeWithDenseLayout(F32, {3, 4}, {0, 1});
+  using Span = std::pair<std::vector<int64_t>, int64_t>;
+  std::vector<Span> spans;
+  auto record_func = [&](absl::Span<const int64_t> index,
+                         int64_t length) -> absl::StatusOr<bool> {
+    spans.push_back({{index.begin(), index.end()}, length});
+    return true;
+  };
+
+  EXPECT_TRUE(
+      ShapeUtil::ForEachMinorDimensionSpanWithStatus(shape, record_func).ok());
+
+  EXPECT_THAT(spans, ElementsAre(Span{{0, 0}, 3}, Span{{0, 1}, 3},
+                                 Span{{0, 2}, 3}, Span{{0, 3}, 3}));
+}
+
+TEST(ShapeUtilTest, ForEachMinorDimensionSpan_Rank0) {
+  Shape shape = ShapeUtil::MakeShape(F32, {});
+  int64_t calls = 0;
+  auto count_func = [&](absl::Span<const int64_t> index,
+                        int64_t length) -> absl::StatusOr<bool> {
+    EXPECT_TRUE(index.empty());
+    EXPECT_EQ(length, 1);
+    ++calls;
+    return true;
+  };
+
+  EXPECT_TRUE(
+      ShapeUtil::ForEachMinorDimensionSpanWithStatus(shape, count_func).ok());
+
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ShapeUtilTest, ForEachMinorDimensionSpanParallel) {
+  Shape shape = ShapeUtil::MakeShape(F32, {10, 20, 30});
+  std::vector<int64_t> output(10 * 20 * 30, 0);
+  auto set_func = [&](absl::Span<const int64_t> index, int64_t length,
+                      int /*thread_id*/) -> absl::StatusOr<bool> {
+    EXPECT_EQ(index[2], 0);
+    for (int64_t k = 0; k < length; ++k) {
+      output[(index[0] * 20 + index[1]) * 30 + k]++;
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(
+      ShapeUtil::ForEachMinorDimensionSpanParallelWithStatus(shape, set_func)
+          .ok());
+
+  EXPECT_THAT(output, Each(1));
+}
+
 TEST(ShapeUtilTest, DimensionsUnmodifiedByReshape_1x1x1x1_to_1x1x1) {
   // All output dimensions should be unmodified. One of the input dimensions is
   // modified because the input rank is larger by one.
@@ -22,6 +22,7 @@ limitations under the License.
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/status/status.h"
 #include "absl/types/span.h"
@@ -179,6 +180,26 @@ class CommandBuffer {
   // Adds an execution barrier to the default execution scope.
   absl::Status Barrier() { return Barrier(kDefaulExecutionScope); }
 
+  // A range of commands [begin, end) recorded into an execution scope, where
+  // `begin` and `end` are the number of commands recorded into the execution
+  // scope before and after recording a range (see `Position` below).
+  struct CommandRange {
+    int64_t begin = 0;
+    int64_t end = 0;
+  };
+
+  // Adds a dependency barrier to a given execution scope: commands added after
+  // the barrier (until the next barrier) will start only after all commands in
+  // `dependencies` and all commands before the last regular barrier complete.
+  // Unlike a regular barrier it does not synchronize with any other commands
+  // added after the last regular barrier, which allows constructing command
+  // buffers with explicit dependency edges between commands instead of a chain
+  // of barriers. The next regular barrier synchronizes with all commands added
+  // since the previous regular one.
+  virtual absl::Status DependencyBarrier(
+      ExecutionScopeId execution_scope_id,
+      absl::Span<const CommandRange> dependencies) = 0;
+
   // Adds a kernel launch command.
   virtual absl::Status Launch(ExecutionScopeId execution_scope_id,
                               const ThreadDim& threads, const BlockDim& blocks,
@@ -350,6 +371,30 @@ class CommandBuffer {
   // Returns command buffer state.
   virtual State state() const = 0;
 
+  // Position of the command buffer construction: the number of commands,
+  // barriers and conditional commands recorded so far into each execution
+  // scope. In the update state it is the number of commands that were updated
+  // so far, as command buffer updates must replay all commands in the same
+  // order in which they were recorded.
+  struct Position {
+    struct ExecutionScopePosition {
+      int64_t num_commands = 0;
+      int64_t num_barriers = 0;
+      int64_t num_conditionals = 0;
+    };
+    absl::flat_hash_map<ExecutionScopeId, ExecutionScopePosition> scopes;
+  };
+
+  // Returns the current position of the command buffer construction or
+  // update.
+  virtual Position position() const = 0;
+
+  // Skips updating all commands between the current position and `position`,
+  // which must be a position previously returned when the command buffer was
+  // constructed. Skipped commands keep the parameters they had before the
+  // update. Command buffer must be in the update state.
+  virtual absl::Status SkipUpdates(const Position& position) = 0;
+
   //--------------------------------------------------------------------------//
   // Command buffer tracing API
   //--------------------------------------------------------------------------//
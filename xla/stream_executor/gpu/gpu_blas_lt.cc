@@ -16,12 +16,19 @@ limitations under the License.
 #include "xla/stream_executor/gpu/gpu_blas_lt.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "xla/primitive_util.h"
 #include "xla/service/algorithm_util.h"
 #include "xla/stream_executor/blas.h"
@@ -30,6 +37,7 @@ limitations under the License.
 #include "xla/tsl/protobuf/dnn.pb.h"
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
+#include "tsl/platform/statusor.h"
 #if GOOGLE_CUDA
 #include "tsl/platform/tensor_float_32_utils.h"
 #endif
@@ -212,6 +220,113 @@ bool MakeOutputColumnMajor(MatrixLayout& lhs, MatrixLayout& rhs,
   return blas->GetMatmulPlan(cfg, epilogue);
 }
 
+namespace {
+
+template <typename T>
+void AppendKeyBytes(std::string* key, const T& value) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+void AppendKeyBytes(std::string* key, const std::optional<T>& value) {
+  AppendKeyBytes(key, value.has_value());
+  if (value.has_value()) AppendKeyBytes(key, *value);
+}
+
+void AppendKeyBytes(std::string* key, const MatrixLayout& layout) {
+  AppendKeyBytes(key, layout.dtype);
+  AppendKeyBytes(key, layout.num_rows);
+  AppendKeyBytes(key, layout.num_cols);
+  AppendKeyBytes(key, layout.order);
+  AppendKeyBytes(key, layout.batch_size);
+  AppendKeyBytes(key, layout.leading_dim_stride);
+  AppendKeyBytes(key, layout.batch_stride);
+  AppendKeyBytes(key, layout.transpose);
+}
+
+// Returns a key that is equal for two (GemmConfig, Epilogue) pairs exactly
+// when they would produce equivalent matmul plans.
+std::string MatmulPlanKey(const GemmConfig& cfg, BlasLt::Epilogue epilogue) {
+  std::string key;
+  AppendKeyBytes(&key, cfg.lhs_layout);
+  AppendKeyBytes(&key, cfg.rhs_layout);
+  AppendKeyBytes(&key, cfg.c_layout);
+  AppendKeyBytes(&key, cfg.output_layout);
+  AppendKeyBytes(&key, cfg.alpha.real());
+  AppendKeyBytes(&key, cfg.alpha.imag());
+  AppendKeyBytes(&key, cfg.beta);
+  AppendKeyBytes(&key, cfg.compute_precision);
+  AppendKeyBytes(&key, cfg.precision_algorithm);
+  AppendKeyBytes(&key, cfg.algorithm);
+  AppendKeyBytes(&key, cfg.grad_x);
+  AppendKeyBytes(&key, cfg.grad_y);
+  AppendKeyBytes(&key, cfg.compute_type);
+  AppendKeyBytes(&key, epilogue);
+  return key;
+}
+
+}  // namespace
+
+auto BlasLt::GetOrCreateMatmulPlan(const GemmConfig& cfg, Epilogue epilogue)
+    -> absl::StatusOr<const MatmulPlan*> {
+  std::string key = MatmulPlanKey(cfg, epilogue);
+  {
+    absl::MutexLock lock(&cache_mutex_);
+    auto it = plan_cache_.find(key);
+    if (it != plan_cache_.end()) return it->second.get();
+  }
+  // Create the plan without holding the lock; if another thread wins the race
+  // its plan is kept and ours is dropped.
+  TF_ASSIGN_OR_RETURN(MatmulPlanPtr plan, GetMatmulPlan(cfg, epilogue));
+
+  absl::MutexLock lock(&cache_mutex_);
+  auto [it, _] = plan_cache_.emplace(std::move(key), std::move(plan));
+  return it->second.get();
+}
+
+/*static*/ auto BlasLt::GetOrCreateMatmulPlan(const Stream* stream,
+                                              const GemmConfig& cfg,
+                                              Epilogue epilogue)
+    -> absl::StatusOr<const MatmulPlan*> {
+  auto blas = Get(stream);
+  if (blas == nullptr) {
+    return xla::Internal("BlasLt is unavailable");
+  }
+  return blas->GetOrCreateMatmulPlan(cfg, epilogue);
+}
+
+auto BlasLt::GetCachedAlgorithms(const MatmulPlan* plan,
+                                 size_t max_algorithm_count,
+                                 size_t max_workspace_size)
+    -> absl::StatusOr<std::vector<MatmulAlgorithm>> {
+  auto key = std::make_tuple(plan, max_algorithm_count, max_workspace_size);
+  {
+    absl::MutexLock lock(&cache_mutex_);
+    auto it = algorithm_cache_.find(key);
+    if (it != algorithm_cache_.end()) return it->second;
+  }
+  TF_ASSIGN_OR_RETURN(
+      std::vector<MatmulAlgorithm> algorithms,
+      plan->GetAlgorithms(max_algorithm_count, max_workspace_size));
+
+  absl::MutexLock lock(&cache_mutex_);
+  auto [it, _] = algorithm_cache_.emplace(key, std::move(algorithms));
+  return it->second;
+}
+
+/*static*/ auto BlasLt::GetCachedAlgorithms(const Stream* stream,
+                                            const MatmulPlan* plan,
+                                            size_t max_algorithm_count,
+                                            size_t max_workspace_size)
+    -> absl::StatusOr<std::vector<MatmulAlgorithm>> {
+  auto blas = Get(stream);
+  if (blas == nullptr) {
+    return xla::Internal("BlasLt is unavailable");
+  }
+  return blas->GetCachedAlgorithms(plan, max_algorithm_count,
+                                   max_workspace_size);
+}
+
 /*static*/ BlasLt* BlasLt::Get(const Stream* stream) {
   auto blas = stream->parent()->AsBlas();
   return (blas != nullptr ? blas->GetBlasLt() : nullptr);
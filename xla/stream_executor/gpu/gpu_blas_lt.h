@@ -21,11 +21,16 @@ limitations under the License.
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xla/stream_executor/blas.h"
 #include "xla/stream_executor/device_memory.h"
 #include "xla/stream_executor/host_or_device_scalar.h"
@@ -338,7 +343,37 @@ struct BlasLt {
                                                      const GemmConfig& cfg,
                                                      Epilogue epilogue);
 
+  // Like GetMatmulPlan, but returns a plan owned by this BlasLt and cached by
+  // `cfg` and `epilogue`, so that executables sharing matmul shapes share
+  // plans. Plans are thread-safe and live as long as this BlasLt.
+  absl::StatusOr<const MatmulPlan*> GetOrCreateMatmulPlan(const GemmConfig& cfg,
+                                                          Epilogue epilogue);
+
+  // convenience function to get a cached MatmulPlan directly using stream
+  static absl::StatusOr<const MatmulPlan*> GetOrCreateMatmulPlan(
+      const Stream* stream, const GemmConfig& cfg, Epilogue epilogue);
+
+  // Returns plan->GetAlgorithms(max_algorithm_count, max_workspace_size) for a
+  // plan returned by GetOrCreateMatmulPlan on this BlasLt, running the
+  // heuristic query only once for every combination of arguments.
+  absl::StatusOr<std::vector<MatmulAlgorithm>> GetCachedAlgorithms(
+      const MatmulPlan* plan, size_t max_algorithm_count,
+      size_t max_workspace_size);
+
+  // convenience function to get cached algorithms directly using stream
+  static absl::StatusOr<std::vector<MatmulAlgorithm>> GetCachedAlgorithms(
+      const Stream* stream, const MatmulPlan* plan, size_t max_algorithm_count,
+      size_t max_workspace_size);
+
   virtual ~BlasLt() {}
+
+ private:
+  absl::Mutex cache_mutex_;
+  absl::flat_hash_map<std::string, MatmulPlanPtr> plan_cache_
+      ABSL_GUARDED_BY(cache_mutex_);
+  absl::flat_hash_map<std::tuple<const MatmulPlan*, size_t, size_t>,
+                      std::vector<MatmulAlgorithm>>
+      algorithm_cache_ ABSL_GUARDED_BY(cache_mutex_);
 };  // class BlasLt
 
 }  // namespace stream_executor::gpu
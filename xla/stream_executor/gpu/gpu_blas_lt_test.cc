@@ -0,0 +1,190 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/gpu/gpu_blas_lt.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xla/stream_executor/blas.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace stream_executor::gpu {
+namespace {
+
+class FakeMatmulPlan : public BlasLt::MatmulPlan {
+ public:
+  explicit FakeMatmulPlan(int* num_algorithm_queries)
+      : num_algorithm_queries_(num_algorithm_queries) {}
+
+  absl::Status ExecuteOnStream(
+      Stream* stream, DeviceMemoryBase a_buffer, DeviceMemoryBase b_buffer,
+      DeviceMemoryBase c_buffer, DeviceMemoryBase d_buffer,
+      DeviceMemoryBase bias_buffer, DeviceMemoryBase aux_buffer,
+      DeviceMemoryBase a_scale_buffer, DeviceMemoryBase b_scale_buffer,
+      DeviceMemoryBase c_scale_buffer, DeviceMemoryBase d_scale_buffer,
+      DeviceMemoryBase d_amax_buffer, const BlasLt::MatmulAlgorithm& algorithm,
+      std::optional<DeviceMemoryBase> workspace,
+      std::optional<ScratchAllocator*> scratch_allocator,
+      blas::ProfileResult* profile_result) const override {
+    return absl::UnimplementedError("ExecuteOnStream");
+  }
+
+  absl::StatusOr<std::vector<BlasLt::MatmulAlgorithm>> GetAlgorithms(
+      size_t max_algorithm_count, size_t max_workspace_size) const override {
+    ++*num_algorithm_queries_;
+    return std::vector<BlasLt::MatmulAlgorithm>(
+        1, BlasLt::MatmulAlgorithm{/*opaque_algo=*/{}, max_workspace_size});
+  }
+
+ protected:
+  absl::Status ValidateInputs(blas::DataType scale_type, bool alpha_on_device,
+                              bool beta_on_device, blas::DataType A_type,
+                              blas::DataType B_type, blas::DataType C_type,
+                              blas::DataType D_type) const override {
+    return absl::OkStatus();
+  }
+
+  absl::Status DoMatmul(Stream* stream, const void* alpha, DeviceMemoryBase a,
+                        DeviceMemoryBase b, const void* beta,
+                        DeviceMemoryBase c, DeviceMemoryBase d,
+                        const BlasLt::MatmulAlgorithm& algorithm,
+                        DeviceMemoryBase bias, DeviceMemoryBase aux,
+                        DeviceMemoryBase a_scale, DeviceMemoryBase b_scale,
+                        DeviceMemoryBase c_scale, DeviceMemoryBase d_scale,
+                        DeviceMemoryBase d_amax,
+                        std::optional<DeviceMemoryBase> workspace,
+                        std::optional<ScratchAllocator*> scratch_allocator,
+                        blas::ProfileResult* profile_result) const override {
+    return absl::UnimplementedError("DoMatmul");
+  }
+
+ private:
+  int* num_algorithm_queries_;
+};
+
+// Counts the plans it creates and the heuristic queries they run.
+class FakeBlasLt : public BlasLt {
+ public:
+  absl::Status Init() override { return absl::OkStatus(); }
+
+  absl::StatusOr<MatmulPlanPtr> GetMatmulPlan(
+      const GemmConfig& cfg, Epilogue epilogue) const override {
+    ++num_plans_;
+    return std::make_unique<FakeMatmulPlan>(&num_algorithm_queries_);
+  }
+
+  int num_plans() const { return num_plans_; }
+  int num_algorithm_queries() const { return num_algorithm_queries_; }
+
+ private:
+  mutable int num_plans_ = 0;
+  mutable int num_algorithm_queries_ = 0;
+};
+
+GemmConfig MakeGemmConfig(int64_t m, int64_t n, int64_t k) {
+  using Order = MatrixLayout::Order;
+  return GemmConfig{
+      MatrixLayout(xla::F32, m, k, Order::kRowMajor),
+      MatrixLayout(xla::F32, k, n, Order::kRowMajor),
+      MatrixLayout(xla::F32, m, n, Order::kRowMajor),
+      MatrixLayout(xla::F32, m, n, Order::kRowMajor),
+      /*alpha=*/1.0,
+      /*beta=*/0.0,
+      /*compute_precision=*/0,
+      /*precision_algorithm=*/xla::PrecisionConfig::ALG_UNSET,
+      /*algorithm=*/std::nullopt,
+      /*grad_x=*/false,
+      /*grad_y=*/false,
+      /*compute_type=*/std::nullopt};
+}
+
+TEST(GpuBlasLtTest, GetOrCreateMatmulPlanReusesPlans) {
+  FakeBlasLt blas_lt;
+  TF_ASSERT_OK_AND_ASSIGN(
+      const BlasLt::MatmulPlan* plan0,
+      blas_lt.GetOrCreateMatmulPlan(MakeGemmConfig(4, 8, 16),
+                                    BlasLt::Epilogue::kDefault));
+  TF_ASSERT_OK_AND_ASSIGN(
+      const BlasLt::MatmulPlan* plan1,
+      blas_lt.GetOrCreateMatmulPlan(MakeGemmConfig(4, 8, 16),
+                                    BlasLt::Epilogue::kDefault));
+  EXPECT_EQ(plan0, plan1);
+  EXPECT_EQ(blas_lt.num_plans(), 1);
+
+  // A different config or epilogue gets its own plan.
+  TF_ASSERT_OK_AND_ASSIGN(
+      const BlasLt::MatmulPlan* plan2,
+      blas_lt.GetOrCreateMatmulPlan(MakeGemmConfig(4, 8, 32),
+                                    BlasLt::Epilogue::kDefault));
+  TF_ASSERT_OK_AND_ASSIGN(
+      const BlasLt::MatmulPlan* plan3,
+      blas_lt.GetOrCreateMatmulPlan(MakeGemmConfig(4, 8, 16),
+                                    BlasLt::Epilogue::kReLU));
+  EXPECT_NE(plan2, plan0);
+  EXPECT_NE(plan3, plan0);
+  EXPECT_EQ(blas_lt.num_plans(), 3);
+}
+
+TEST(GpuBlasLtTest, PlanCachesArePerBlasLt) {
+  FakeBlasLt blas_lt0;
+  FakeBlasLt blas_lt1;
+  GemmConfig cfg = MakeGemmConfig(4, 8, 16);
+  TF_ASSERT_OK_AND_ASSIGN(
+      const BlasLt::MatmulPlan* plan0,
+      blas_lt0.GetOrCreateMatmulPlan(cfg, BlasLt::Epilogue::kDefault));
+  TF_ASSERT_OK_AND_ASSIGN(
+      const BlasLt::MatmulPlan* plan1,
+      blas_lt1.GetOrCreateMatmulPlan(cfg, BlasLt::Epilogue::kDefault));
+  EXPECT_NE(plan0, plan1);
+  EXPECT_EQ(blas_lt0.num_plans(), 1);
+  EXPECT_EQ(blas_lt1.num_plans(), 1);
+}
+
+TEST(GpuBlasLtTest, GetCachedAlgorithmsQueriesOnce) {
+  FakeBlasLt blas_lt;
+  TF_ASSERT_OK_AND_ASSIGN(
+      const BlasLt::MatmulPlan* plan,
+      blas_lt.GetOrCreateMatmulPlan(MakeGemmConfig(4, 8, 16),
+                                    BlasLt::Epilogue::kDefault));
+
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto algorithms,
+        blas_lt.GetCachedAlgorithms(plan, /*max_algorithm_count=*/128,
+                                    /*max_workspace_size=*/1024));
+    ASSERT_EQ(algorithms.size(), 1);
+    EXPECT_EQ(algorithms[0].workspace_size, 1024);
+  }
+  EXPECT_EQ(blas_lt.num_algorithm_queries(), 1);
+
+  // Different arguments run the query again.
+  TF_ASSERT_OK(blas_lt
+                   .GetCachedAlgorithms(plan, /*max_algorithm_count=*/128,
+                                        /*max_workspace_size=*/0)
+                   .status());
+  EXPECT_EQ(blas_lt.num_algorithm_queries(), 2);
+}
+
+}  // namespace
+}  // namespace stream_executor::gpu
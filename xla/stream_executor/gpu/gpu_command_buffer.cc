@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/stream_executor/gpu/gpu_command_buffer.h"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cstddef>
@@ -221,7 +222,9 @@ absl::Status GpuCommandBuffer::Trace(
 GpuCommandBuffer::Dependencies GpuCommandBuffer::GetBarrier(
     ExecutionScopeId execution_scope_id) {
   ExecutionScope& execution_scope = execution_scopes_[execution_scope_id];
-  return execution_scope.barriers.empty()
+  // Dependency barriers without dependencies do not have a node handle.
+  return execution_scope.barriers.empty() ||
+                 execution_scope.barriers.back().handle == nullptr
              ? Dependencies{}
              : Dependencies{execution_scope.barriers.back().handle};
 }
@@ -376,10 +379,19 @@ absl::Status GpuCommandBuffer::Barrier(ExecutionScopeId execution_scope_id) {
     Dependencies dependencies = GetBarrierDependencies(execution_scope_id);
 
     // If there are no new dependencies and we have an existing barrier simply
-    // copy information from the last barrier to a new one.
+    // copy information from the last barrier to a new one. If the last barrier
+    // is a dependency barrier we copy the regular barrier it refers to.
     if (dependencies.empty() && !execution_scope.barriers.empty()) {
-      execution_scope.barriers.push_back({execution_scope.barriers.back()});
-      return absl::OkStatus();
+      const GpuGraphBarrierInfo& last = execution_scope.barriers.back();
+      if (!last.is_dependency_barrier) {
+        execution_scope.barriers.push_back({last});
+        return absl::OkStatus();
+      }
+      if (last.regular_barrier != nullptr) {
+        execution_scope.barriers.push_back(
+            {last.regular_barrier, false, last.nodes_offset});
+        return absl::OkStatus();
+      }
     }
 
     // If we have only one node added after the last barrier simply reuse the
@@ -513,6 +525,76 @@ absl::Status GpuCommandBuffer::Barrier(ExecutionScopeId from_execution_scope_id,
   return UnsupportedStateError(state_);
 }
 
+absl::Status GpuCommandBuffer::DependencyBarrier(
+    ExecutionScopeId execution_scope_id,
+    absl::Span<const CommandRange> dependencies) {
+  ExecutionScope& execution_scope = execution_scopes_[execution_scope_id];
+
+  if (state_ == State::kCreate) {
+    // Find the last regular barrier and the offset of nodes it synchronizes.
+    GpuGraphNodeHandle regular_barrier = nullptr;
+    size_t nodes_offset = 0;
+    if (!execution_scope.barriers.empty()) {
+      const GpuGraphBarrierInfo& last = execution_scope.barriers.back();
+      regular_barrier =
+          last.is_dependency_barrier ? last.regular_barrier : last.handle;
+      nodes_offset = last.nodes_offset;
+    }
+
+    Dependencies barrier_dependencies;
+    if (regular_barrier != nullptr) {
+      barrier_dependencies.push_back(regular_barrier);
+    }
+
+    for (const CommandRange& range : dependencies) {
+      if (range.begin < 0 || range.begin > range.end ||
+          range.end > static_cast<int64_t>(execution_scope.nodes.size())) {
+        return absl::InternalError(absl::StrFormat(
+            "Execution scope %d dependency range [%d, %d) is out of range",
+            execution_scope_id.value(), range.begin, range.end));
+      }
+      // Nodes before the last regular barrier are already synchronized.
+      for (int64_t i = std::max<int64_t>(range.begin, nodes_offset);
+           i < range.end; ++i) {
+        barrier_dependencies.push_back(execution_scope.nodes[i].handle);
+      }
+    }
+
+    // Reuse a single dependency node as a barrier, or create a new empty node
+    // joining all dependencies.
+    GpuGraphBarrierInfo barrier;
+    barrier.is_barrier_node = false;
+    barrier.nodes_offset = nodes_offset;
+    barrier.is_dependency_barrier = true;
+    barrier.regular_barrier = regular_barrier;
+
+    if (barrier_dependencies.size() == 1) {
+      barrier.handle = barrier_dependencies.front();
+    } else if (barrier_dependencies.size() > 1) {
+      TF_ASSIGN_OR_RETURN(barrier.handle,
+                          CreateBarrierNode(barrier_dependencies));
+      barrier.is_barrier_node = true;
+    }
+
+    execution_scope.barriers.push_back(barrier);
+    return absl::OkStatus();
+  }
+
+  if (state_ == State::kUpdate) {
+    // Same as for regular barriers we can't change the structure of the gpu
+    // graph at update time.
+    if (execution_scope.update_state.barrier_idx++ >=
+        execution_scope.barriers.size()) {
+      return absl::InternalError(
+          absl::StrFormat("Execution scope %d barrier index out of range",
+                          execution_scope_id.value()));
+    }
+    return absl::OkStatus();
+  }
+
+  return UnsupportedStateError(state_);
+}
+
 absl::Status GpuCommandBuffer::LaunchWithPackedArgs(
     ExecutionScopeId execution_scope_id, const ThreadDim& threads,
     const BlockDim& blocks, const Kernel& kernel,
@@ -1094,6 +1176,63 @@ absl::Status GpuCommandBuffer::Update() {
   return absl::OkStatus();
 }
 
+CommandBuffer::Position GpuCommandBuffer::position() const {
+  Position position;
+  for (auto& [id, execution_scope] : execution_scopes_) {
+    Position::ExecutionScopePosition& scope = position.scopes[id];
+    if (state_ == State::kUpdate) {
+      scope.num_commands = execution_scope.update_state.node_idx;
+      scope.num_barriers = execution_scope.update_state.barrier_idx;
+      scope.num_conditionals = execution_scope.update_state.conditional_idx;
+    } else {
+      scope.num_commands = execution_scope.nodes.size();
+      scope.num_barriers = execution_scope.barriers.size();
+      scope.num_conditionals =
+          execution_scope.conditional_command_buffers.size();
+    }
+  }
+  return position;
+}
+
+absl::Status GpuCommandBuffer::SkipUpdates(const Position& position) {
+  if (state_ != State::kUpdate) {
+    return UnsupportedStateError(state_);
+  }
+
+  for (auto& [id, scope] : position.scopes) {
+    auto it = execution_scopes_.find(id);
+    if (it == execution_scopes_.end()) {
+      return absl::InternalError(absl::StrFormat(
+          "Execution scope %d not found in the command buffer", id.value()));
+    }
+
+    ExecutionScope& execution_scope = it->second;
+    ExecutionScope::UpdateState& update_state = execution_scope.update_state;
+
+    // We can only skip forward within the recorded commands.
+    if (scope.num_commands < update_state.node_idx ||
+        scope.num_commands >
+            static_cast<int64_t>(execution_scope.nodes.size()) ||
+        scope.num_barriers < update_state.barrier_idx ||
+        scope.num_barriers >
+            static_cast<int64_t>(execution_scope.barriers.size()) ||
+        scope.num_conditionals < update_state.conditional_idx ||
+        scope.num_conditionals >
+            static_cast<int64_t>(
+                execution_scope.conditional_command_buffers.size())) {
+      return absl::InternalError(absl::StrFormat(
+          "Execution scope %d can't skip updates to an invalid position",
+          id.value()));
+    }
+
+    update_state.node_idx = scope.num_commands;
+    update_state.barrier_idx = scope.num_barriers;
+    update_state.conditional_idx = scope.num_conditionals;
+  }
+
+  return absl::OkStatus();
+}
+
 absl::Span<const GpuCommandBuffer::GpuGraphNodeInfo> GpuCommandBuffer::nodes(
     ExecutionScopeId id) const {
   if (auto it = execution_scopes_.find(id); it != execution_scopes_.end())
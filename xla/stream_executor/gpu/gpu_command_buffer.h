@@ -70,6 +70,16 @@ class GpuCommandBuffer : public CommandBuffer {
     // barrier. We use this offset to find nodes added after the last barrier
     // that should be added as dependencies to the next barrier.
     size_t nodes_offset = 0;
+
+    // If `true` it means this barrier was created by `DependencyBarrier` and
+    // synchronizes only with a subset of nodes added after the last regular
+    // barrier (`nodes_offset` is inherited from the last regular barrier).
+    // `handle` can be nullptr if dependency barrier has no dependencies.
+    bool is_dependency_barrier = false;
+
+    // For dependency barriers a handle of the last regular barrier in the
+    // execution scope, or nullptr if there is none.
+    GpuGraphNodeHandle regular_barrier = nullptr;
   };
 
   GpuCommandBuffer(Mode mode, GpuExecutor* parent, GpuGraphHandle graph,
@@ -84,6 +94,10 @@ class GpuCommandBuffer : public CommandBuffer {
   absl::Status Barrier(ExecutionScopeId from_execution_scope_id,
                        ExecutionScopeId to_execution_scope_id) override;
 
+  absl::Status DependencyBarrier(
+      ExecutionScopeId execution_scope_id,
+      absl::Span<const CommandRange> dependencies) override;
+
   absl::Status Launch(ExecutionScopeId execution_scope_id,
                       const ThreadDim& threads, const BlockDim& blocks,
                       const Kernel& kernel, const KernelArgs& args) override;
@@ -130,6 +144,9 @@ class GpuCommandBuffer : public CommandBuffer {
   Mode mode() const override { return mode_; }
   State state() const override { return state_; }
 
+  Position position() const override;
+  absl::Status SkipUpdates(const Position& position) override;
+
   static GpuCommandBuffer* Cast(CommandBuffer* command_buffer) {
     return static_cast<GpuCommandBuffer*>(command_buffer);
   }
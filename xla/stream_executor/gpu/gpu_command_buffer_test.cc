@@ -455,6 +455,85 @@ TEST(GpuCommandBufferTest, Barriers) {
   ASSERT_EQ(transfer_buffers(), expected);
 }
 
+TEST(GpuCommandBufferTest, DependencyBarriers) {
+  Platform* platform = GpuPlatform();
+  StreamExecutor* executor = platform->ExecutorForDevice(0).value();
+
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, executor->CreateStream());
+
+  // Allocate device buffers for memset operations.
+  std::vector<DeviceMemory<int32_t>> buffers;
+  for (size_t i = 0; i < 5; ++i) {
+    buffers.push_back(executor->AllocateArray<int32_t>(1, 0));
+  }
+
+  // Transfer buffers data back to host.
+  auto transfer_buffers = [&]() -> std::vector<int32_t> {
+    std::vector<int32_t> dst(buffers.size(), 0);
+    for (size_t i = 0; i < buffers.size(); ++i) {
+      TF_CHECK_OK(stream->Memcpy(dst.data() + i, buffers[i], sizeof(int32_t)));
+    }
+    return dst;
+  };
+
+  using CommandRange = CommandBuffer::CommandRange;
+  auto scope = CommandBuffer::kDefaulExecutionScope;
+
+  auto record = [&](CommandBuffer* cmd_buffer, uint32_t bit_pattern) {
+    TF_RETURN_IF_ERROR(cmd_buffer->Memset(&buffers[0], bit_pattern + 0, 1));
+    TF_RETURN_IF_ERROR(cmd_buffer->Memset(&buffers[1], bit_pattern + 1, 1));
+    // Third memset depends only on the first one.
+    std::vector<CommandRange> deps = {{0, 1}};
+    TF_RETURN_IF_ERROR(cmd_buffer->DependencyBarrier(scope, deps));
+    TF_RETURN_IF_ERROR(cmd_buffer->Memset(&buffers[2], bit_pattern + 2, 1));
+    // Fourth memset does not have any dependencies.
+    TF_RETURN_IF_ERROR(cmd_buffer->DependencyBarrier(scope, {}));
+    TF_RETURN_IF_ERROR(cmd_buffer->Memset(&buffers[3], bit_pattern + 3, 1));
+    // Regular barrier synchronizes with all previous commands.
+    TF_RETURN_IF_ERROR(cmd_buffer->Barrier());
+    TF_RETURN_IF_ERROR(cmd_buffer->Memset(&buffers[4], bit_pattern + 4, 1));
+    return cmd_buffer->Finalize();
+  };
+
+  auto cmd_buffer = executor->CreateCommandBuffer(primary).value();
+  TF_ASSERT_OK(record(cmd_buffer.get(), 42));
+  TF_ASSERT_OK(cmd_buffer->Submit(stream.get()));
+
+  std::vector<int32_t> expected = {42, 43, 44, 45, 46};
+  ASSERT_EQ(transfer_buffers(), expected);
+
+  // Check the command buffer structure.
+  GpuCommandBuffer* gpu_cmd_buffer = GpuCommandBuffer::Cast(cmd_buffer.get());
+  ASSERT_EQ(gpu_cmd_buffer->nodes().size(), 5);
+  ASSERT_EQ(gpu_cmd_buffer->barriers().size(), 3);
+
+  auto nodes = gpu_cmd_buffer->nodes();
+  auto barriers = gpu_cmd_buffer->barriers();
+
+  // First dependency barrier reuses the first memset node.
+  EXPECT_TRUE(barriers[0].is_dependency_barrier);
+  EXPECT_EQ(barriers[0].handle, nodes[0].handle);
+  EXPECT_EQ(Deps(nodes[2]), ExpectedDeps(nodes[0]));
+
+  // Second dependency barrier is empty and fourth memset is a root node.
+  EXPECT_TRUE(barriers[1].is_dependency_barrier);
+  EXPECT_EQ(barriers[1].handle, nullptr);
+  EXPECT_TRUE(Deps(nodes[3]).empty());
+
+  // Regular barrier depends on all memset nodes.
+  EXPECT_TRUE(barriers[2].is_barrier_node);
+  EXPECT_EQ(Deps(barriers[2]),
+            ExpectedDeps(nodes[0], nodes[1], nodes[2], nodes[3]));
+
+  // Update command buffer to use a new bit pattern.
+  TF_ASSERT_OK(cmd_buffer->Update());
+  TF_ASSERT_OK(record(cmd_buffer.get(), 43));
+  TF_ASSERT_OK(cmd_buffer->Submit(stream.get()));
+
+  expected = {43, 44, 45, 46, 47};
+  ASSERT_EQ(transfer_buffers(), expected);
+}
+
 TEST(GpuCommandBufferTest, IndependentExecutionScopes) {
   Platform* platform = GpuPlatform();
   StreamExecutor* executor = platform->ExecutorForDevice(0).value();
@@ -29,6 +29,8 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "third_party/gpus/cuda/include/cuda.h"
 #include "xla/stream_executor/cuda/cuda_status.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
@@ -205,6 +207,8 @@ GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
                                           &release_threshold_64))
     LOG(FATAL) <<  // Crash OK.
         "Failed to set CUDA pool attribute: " << cuda::ToStatus(status);
+  release_threshold_ = release_threshold_64;
+  current_release_threshold_ = release_threshold_64;
 
   if (compute_stats) {
     stats_ = std::make_unique<tsl::AllocatorStats>();
@@ -384,6 +388,8 @@ void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
         std::max(stats_->peak_bytes_in_use, stats_->bytes_in_use);
     stats_->largest_alloc_size =
         std::max<std::size_t>(stats_->largest_alloc_size, num_bytes);
+    window_peak_bytes_in_use_ =
+        std::max(window_peak_bytes_in_use_, stats_->bytes_in_use);
     bool ptr_inserted = size_map_.emplace(ptr, num_bytes).second;
     DCHECK(ptr_inserted);
   }
@@ -429,11 +435,73 @@ void GpuCudaMallocAsyncAllocator::DeallocateRaw(void* ptr) {
     size_t size = size_map_[ptr];
     stats_->bytes_in_use -= size;
     size_map_.erase(ptr);
+    MaybeTrimPoolLocked();
   }
 
   VLOG(10) << Name() << " Freed ptr: " << ptr;
 }
 
+void GpuCudaMallocAsyncAllocator::SetPoolTrimPolicy(
+    const PoolTrimPolicy& policy) {
+  if (!stats_) {
+    LOG(WARNING) << Name()
+                 << " ignores the pool trim policy because stats are disabled";
+    return;
+  }
+  absl::MutexLock lock(&mutex_);
+  trim_policy_ = policy;
+  next_trim_evaluation_ = absl::Now() + policy.interval;
+}
+
+uint64_t GpuCudaMallocAsyncAllocator::current_release_threshold() const {
+  absl::MutexLock lock(&mutex_);
+  return current_release_threshold_;
+}
+
+void GpuCudaMallocAsyncAllocator::MaybeTrimPoolLocked() {
+  if (trim_policy_.interval == absl::ZeroDuration()) return;
+  absl::Time now = absl::Now();
+  if (now < next_trim_evaluation_) return;
+  next_trim_evaluation_ = now + trim_policy_.interval;
+
+  gpu::ScopedActivateContext scoped_activation{stream_exec_};
+  size_t free, total;
+  if (auto result = cuMemGetInfo(&free, &total)) {
+    VLOG(1) << Name() << " failed to query device memory: "
+            << cuda::ToStatus(result);
+    return;
+  }
+  bool under_pressure = free < trim_policy_.min_free_memory_fraction * total;
+
+  // Under memory pressure only keep the recent working set in the pool.
+  uint64_t release_threshold =
+      under_pressure
+          ? std::min<uint64_t>(release_threshold_, window_peak_bytes_in_use_)
+          : release_threshold_;
+  if (release_threshold != current_release_threshold_) {
+    if (auto status = cuMemPoolSetAttribute(cuda_state_->pool,
+                                            CU_MEMPOOL_ATTR_RELEASE_THRESHOLD,
+                                            &release_threshold)) {
+      LOG(WARNING) << "Failed to set CUDA pool attribute: "
+                   << cuda::ToStatus(status);
+    } else {
+      VLOG(1) << Name() << " set the pool release threshold to "
+              << release_threshold << " bytes";
+      current_release_threshold_ = release_threshold;
+    }
+  }
+  if (under_pressure) {
+    if (auto status =
+            cuMemPoolTrimTo(cuda_state_->pool, stats_->bytes_in_use)) {
+      LOG(WARNING) << "Failed to trim CUDA pool: " << cuda::ToStatus(status);
+    } else {
+      VLOG(1) << Name() << " trimmed the pool to " << stats_->bytes_in_use
+              << " bytes; free memory/total memory: " << free << "/" << total;
+    }
+  }
+  window_peak_bytes_in_use_ = stats_->bytes_in_use;
+}
+
 bool GpuCudaMallocAsyncAllocator::TracksAllocationSizes() const {
   return static_cast<bool>(stats_);
 }
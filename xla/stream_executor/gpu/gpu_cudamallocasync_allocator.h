@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -25,6 +26,7 @@ limitations under the License.
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "xla/stream_executor/stream_executor.h"
 #include "xla/tsl/framework/allocator.h"
 #include "xla/tsl/framework/device_id.h"
@@ -58,8 +60,24 @@ namespace stream_executor {
 // Here, the release_threshold isn't the absolute max as for [Gpu]BFCAllocator.
 // The pool can grow above that up to the total GPU memory.  But the
 // driver can return the excess memory to other processes.
+//
+// The release threshold can be made adaptive with a PoolTrimPolicy: when the
+// device runs low on free memory, the pool is trimmed to the memory in use and
+// its release threshold is lowered to the peak usage since the last
+// evaluation, so that the working set of consecutive executions is still
+// reused without synchronization. The configured threshold is restored once
+// the memory pressure goes away.
 class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
  public:
+  struct PoolTrimPolicy {
+    // How often the memory pressure is evaluated. Zero disables trimming.
+    absl::Duration interval = absl::ZeroDuration();
+
+    // The device is under memory pressure when less than this fraction of its
+    // memory is free.
+    double min_free_memory_fraction = 0.1;
+  };
+
   // API that uses the default memory pool for cuda malloc async
   explicit GpuCudaMallocAsyncAllocator(tsl::PlatformDeviceId platform_device_id,
                                        size_t release_threshold,
@@ -94,6 +112,13 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
 
   void SetStreamAndPreallocateMemory(void* stream) override;
 
+  // Sets the policy used to trim the memory pool. Trimming is evaluated on
+  // deallocation and requires stats to be computed.
+  void SetPoolTrimPolicy(const PoolTrimPolicy& policy);
+
+  // Returns the release threshold currently set on the memory pool.
+  uint64_t current_release_threshold() const;
+
   static int GetInstantiatedCountTestOnly() { return number_instantiated_; }
 
   tsl::AllocatorMemoryType GetMemoryType() const override {
@@ -103,6 +128,9 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
  private:
   void PrintAllocatorStatisticsNoLock() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Evaluates the pool trim policy if its interval has elapsed.
+  void MaybeTrimPoolLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   StreamExecutor* stream_exec_;  // Not owned.
   struct CudaState;
   std::unique_ptr<CudaState> cuda_state_;
@@ -129,6 +157,15 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
   mutable absl::Mutex mutex_;
   std::unique_ptr<tsl::AllocatorStats> stats_ ABSL_PT_GUARDED_BY(mutex_);
   absl::flat_hash_map<const void*, size_t> size_map_ ABSL_GUARDED_BY(mutex_);
+
+  // Pool trimming.
+  uint64_t release_threshold_ = 0;
+  uint64_t current_release_threshold_ ABSL_GUARDED_BY(mutex_) = 0;
+  PoolTrimPolicy trim_policy_ ABSL_GUARDED_BY(mutex_);
+  absl::Time next_trim_evaluation_ ABSL_GUARDED_BY(mutex_) =
+      absl::InfinitePast();
+  // Peak bytes in use since the trim policy was last evaluated.
+  int64_t window_peak_bytes_in_use_ ABSL_GUARDED_BY(mutex_) = 0;
 };
 
 }  // namespace stream_executor
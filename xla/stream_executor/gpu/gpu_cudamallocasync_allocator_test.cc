@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "absl/log/check.h"
 #include "absl/strings/ascii.h"
+#include "absl/time/time.h"
 #include "xla/service/platform_util.h"
 #include "xla/stream_executor/gpu/gpu_stream.h"
 #include "xla/stream_executor/platform.h"
@@ -134,4 +135,36 @@ TEST(GpuCudaMallocAsyncAllocator, SyncAddressAlignedNewPool) {
   EXPECT_TRUE(stream->ok());
 }
 
+TEST(GpuCudaMallocAsyncAllocator, TrimsPoolUnderMemoryPressure) {
+  se::StreamExecutor* executor = GpuExecutor();
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, executor->CreateStream());
+  auto allocator = GpuCudaMallocAsyncAllocator(
+      /*platform_device_id*/ tsl::PlatformDeviceId(executor->device_ordinal()),
+      /*create_new_pool*/ true,
+      /*new_pool_size*/ 64 << 20,
+      /*reserve_memory*/ false,
+      /*reserve_memory_size*/ 64 << 20,
+      /*sync_mode*/ false,
+      /*compute_stats*/ true);
+  allocator.SetStreamAndPreallocateMemory(
+      se::gpu::AsGpuStreamValue(stream.get()));
+  EXPECT_EQ(allocator.current_release_threshold(), 64 << 20);
+
+  // Every evaluation sees memory pressure, so the release threshold follows
+  // the peak usage since the previous evaluation.
+  allocator.SetPoolTrimPolicy({/*interval=*/absl::Nanoseconds(1),
+                               /*min_free_memory_fraction=*/1.0});
+  void* addr = allocator.AllocateRaw(128, 1 << 20);
+  allocator.DeallocateRaw(addr);
+  EXPECT_EQ(allocator.current_release_threshold(), 1 << 20);
+
+  // Without memory pressure the configured threshold is restored.
+  allocator.SetPoolTrimPolicy({/*interval=*/absl::Nanoseconds(1),
+                               /*min_free_memory_fraction=*/0.0});
+  addr = allocator.AllocateRaw(128, 1 << 20);
+  allocator.DeallocateRaw(addr);
+  EXPECT_EQ(allocator.current_release_threshold(), 64 << 20);
+  EXPECT_TRUE(stream->ok());
+}
+
 }  // namespace stream_executor
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/stream_executor/host/host_kernel.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -61,24 +62,32 @@ static absl::InlinedVector<SE_HOST_KernelArg, 8> ConvertBuffersToKernelArgs(
 }
 
 namespace {
-// Keep a state of an in-flight asynchronous kernel execution on a heap to keep
-// it alive until the last task is done.
+// Keep a state of an in-flight asynchronous kernel execution on a heap. It is
+// shared by all worker tasks to keep it alive until the last one is done.
+//
+// Workers claim chunks of consecutive kernel threads (tasks) from a shared
+// counter using guided self-scheduling: every claim takes a fraction of the
+// remaining tasks, so the first chunks are large (cheap to schedule), and the
+// last ones are small (good load balance). Workers never own more than the
+// chunk they are running, so a slow worker doesn't delay the whole launch.
 class HostKernelExecuteState {
  public:
   HostKernelExecuteState(HostKernel::TaskRunner task_runner,
                          SE_HOST_Kernel* kernel, ThreadDim thread_dims,
-                         absl::Span<const SE_HOST_KernelArg> args);
+                         absl::Span<const SE_HOST_KernelArg> args,
+                         size_t num_workers);
   ~HostKernelExecuteState();
 
-  // Notify of a completion of a host kernel task.
-  void Notify(absl::Status status);
+  // Notify of a completion of `count` host kernel tasks.
+  void Notify(absl::Status status, uint64_t count);
 
   // Calls a task with index `task_index` synchronously.
-  void CallSync(uint64_t task_index);
+  absl::Status CallSync(uint64_t task_index);
 
-  // Calls tasks in the [start_index, end_index) range asynchronously using task
-  // runner to schedule work. Executes a single task in the caller thread.
-  void CallAsync(uint64_t start_index, uint64_t end_index);
+  // Starts workers in the [start_index, end_index) range asynchronously using
+  // task runner to schedule work. Runs a single worker in the caller thread.
+  static void CallAsync(std::shared_ptr<HostKernelExecuteState> state,
+                        uint64_t start_index, uint64_t end_index);
 
   tsl::AsyncValueRef<LaunchEvent> event() const { return event_; }
 
@@ -92,17 +101,30 @@ class HostKernelExecuteState {
       64;
 #endif
 
+  // Every claimed chunk is 1 / (kChunksPerWorker * num_workers) of the
+  // remaining tasks.
+  static constexpr uint64_t kChunksPerWorker = 2;
+
+  // Claims tasks in the [start_index, end_index) range for the caller worker.
+  // Returns false if all tasks were already claimed.
+  bool Claim(uint64_t& start_index, uint64_t& end_index);
+
+  // Runs claimed chunks of tasks until all tasks are claimed.
+  void RunWorker();
+
   // Converts linear task index in [0, num_tasks) to (x, y, z) coordinate. We
   // assume that `x` is the fastest iterating dimension.
   SE_HOST_KernelThread Delinearize(uint64_t task_index);
 
   HostKernel::TaskRunner task_runner_;
   size_t num_tasks_;
+  size_t num_workers_;
 
   SE_HOST_Kernel* kernel_;
   SE_HOST_KernelThreadDim thread_dims_;
   absl::InlinedVector<SE_HOST_KernelArg, 8> args_;
 
+  alignas(kAtomicAlignment) std::atomic<uint64_t> next_task_;
   alignas(kAtomicAlignment) std::atomic<int64_t> counter_;
 
   alignas(kAtomicAlignment) std::atomic<bool> abort_;
@@ -170,38 +192,51 @@ tsl::AsyncValueRef<LaunchEvent> HostKernel::Launch(
 tsl::AsyncValueRef<LaunchEvent> HostKernel::Launch(
     const ThreadDim& thread_dims, absl::Span<const SE_HOST_KernelArg> args,
     TaskRunner task_runner) const {
+  // Without a hint about the parallelism available to the task runner, start
+  // one worker per task.
+  size_t num_tasks = thread_dims.x * thread_dims.y * thread_dims.z;
+  return Launch(thread_dims, args, std::move(task_runner), num_tasks);
+}
+
+tsl::AsyncValueRef<LaunchEvent> HostKernel::Launch(
+    const ThreadDim& thread_dims, absl::Span<const SE_HOST_KernelArg> args,
+    TaskRunner task_runner, size_t num_workers) const {
   size_t num_tasks = thread_dims.x * thread_dims.y * thread_dims.z;
   CHECK_GT(num_tasks, 0) << "Number of tasks must be positive";  // Crash Ok
 
-  // Short-circuit launch with a single task and run it in the caller thread.
-  if (ABSL_PREDICT_TRUE(num_tasks == 1)) {
+  // Short-circuit launch with a single task or worker and run it in the caller
+  // thread.
+  if (ABSL_PREDICT_TRUE(num_tasks == 1 || num_workers <= 1)) {
     absl::Status launched = Launch(thread_dims, args);
     return ABSL_PREDICT_TRUE(launched.ok())
                ? OkLaunchEvent()
                : tsl::MakeErrorAsyncValueRef(std::move(launched));
   }
 
-  // Create host kernel execute state on heap and kick-off execution.
-  auto state = std::make_unique<HostKernelExecuteState>(
-      std::move(task_runner), kernel_, thread_dims, args);
-  state->CallAsync(/*start_index=*/0, /*end_index=*/num_tasks);
-
-  // Move execute state to the execute event callback to ensure that it is kept
-  // alive while host kernel has pending tasks.
+  // Create host kernel execute state on heap and kick-off execution. Worker
+  // tasks share the ownership of the state to keep it alive while they are
+  // running, including the ones that start after all tasks are completed.
+  num_workers = std::min(num_workers, num_tasks);
+  auto state = std::make_shared<HostKernelExecuteState>(
+      std::move(task_runner), kernel_, thread_dims, args, num_workers);
   auto execute_event = state->event();
-  execute_event.AndThen([state = std::move(state)] {});
+  HostKernelExecuteState::CallAsync(std::move(state), /*start_index=*/0,
+                                    /*end_index=*/num_workers);
 
   return execute_event;
 }
 
 HostKernelExecuteState::HostKernelExecuteState(
     HostKernel::TaskRunner task_runner, SE_HOST_Kernel kernel,
-    ThreadDim thread_dims, absl::Span<const SE_HOST_KernelArg> args)
+    ThreadDim thread_dims, absl::Span<const SE_HOST_KernelArg> args,
+    size_t num_workers)
     : task_runner_(std::move(task_runner)),
       num_tasks_(thread_dims.x * thread_dims.y * thread_dims.z),
+      num_workers_(num_workers),
       kernel_(kernel),
       thread_dims_({thread_dims.x, thread_dims.y, thread_dims.z}),
       args_(args.begin(), args.end()),
+      next_task_(0),
       counter_(num_tasks_),
       abort_(false),
       event_(tsl::MakeConstructedAsyncValueRef<LaunchEvent>()) {}
@@ -212,7 +247,7 @@ HostKernelExecuteState::~HostKernelExecuteState() {
                        "tasks are completed";
 }
 
-void HostKernelExecuteState::Notify(absl::Status status) {
+void HostKernelExecuteState::Notify(absl::Status status, uint64_t count) {
   if (ABSL_PREDICT_FALSE(!status.ok())) {
     absl::MutexLock lock(&abort_mutex_);
     abort_.store(true, std::memory_order_relaxed);
@@ -220,7 +255,8 @@ void HostKernelExecuteState::Notify(absl::Status status) {
   }
 
   // Check if it was the last notification and kernel launch is done.
-  bool is_done = counter_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  int64_t n = static_cast<int64_t>(count);
+  bool is_done = counter_.fetch_sub(n, std::memory_order_acq_rel) == n;
   if (ABSL_PREDICT_TRUE(!is_done)) return;
 
   // In the unlikely event of a kernel error, forward it to the launch event.
@@ -235,14 +271,9 @@ void HostKernelExecuteState::Notify(absl::Status status) {
   }
 }
 
-void HostKernelExecuteState::CallSync(uint64_t task_index) {
+absl::Status HostKernelExecuteState::CallSync(uint64_t task_index) {
   CHECK_LT(task_index, num_tasks_) << "Task index out of range";  // Crash OK
 
-  if (ABSL_PREDICT_FALSE(abort_.load(std::memory_order_relaxed))) {
-    Notify(absl::OkStatus());
-    return;
-  }
-
   SE_HOST_KernelThread kernel_thread = Delinearize(task_index);
   SE_HOST_KernelCallFrame call_frame = {&thread_dims_, &kernel_thread,
                                         args_.size(), args_.data()};
@@ -250,25 +281,61 @@ void HostKernelExecuteState::CallSync(uint64_t task_index) {
   SE_HOST_KernelError* error = (*kernel_)(&call_frame);
 
   if (ABSL_PREDICT_TRUE(error == nullptr)) {
-    Notify(absl::OkStatus());
-  } else {
-    Notify(absl::InternalError(
-        absl::StrFormat("Failed to call host kernel: x=%d, y=%d, z=%d",
-                        kernel_thread.x, kernel_thread.y, kernel_thread.z)));
+    return absl::OkStatus();
   }
+  return absl::InternalError(
+      absl::StrFormat("Failed to call host kernel: x=%d, y=%d, z=%d",
+                      kernel_thread.x, kernel_thread.y, kernel_thread.z));
 }
 
-void HostKernelExecuteState::CallAsync(uint64_t start_index,
-                                       uint64_t end_index) {
-  CHECK_LT(start_index, end_index) << "Invalid task index range";  // Crash OK
+void HostKernelExecuteState::CallAsync(
+    std::shared_ptr<HostKernelExecuteState> state, uint64_t start_index,
+    uint64_t end_index) {
+  CHECK_LT(start_index, end_index) << "Invalid worker index range";  // Crash OK
   while (end_index - start_index > 1) {
+    // Don't start more workers if all tasks are already claimed: the launch
+    // might be completed, and the task runner must not be used anymore.
+    if (state->next_task_.load(std::memory_order_relaxed) >=
+        state->num_tasks_) {
+      return;
+    }
     uint64_t mid_index = (start_index + end_index) / 2;
-    task_runner_([self = this, mid_index, end_index] {
-      self->CallAsync(mid_index, end_index);
+    state->task_runner_([state, mid_index, end_index] {
+      CallAsync(state, mid_index, end_index);
     });
     end_index = mid_index;
   }
-  CallSync(start_index);
+  state->RunWorker();
+}
+
+bool HostKernelExecuteState::Claim(uint64_t& start_index,
+                                   uint64_t& end_index) {
+  uint64_t next = next_task_.load(std::memory_order_relaxed);
+  while (next < num_tasks_) {
+    uint64_t remaining = num_tasks_ - next;
+    uint64_t chunk =
+        std::max<uint64_t>(1, remaining / (kChunksPerWorker * num_workers_));
+    if (next_task_.compare_exchange_weak(next, next + chunk,
+                                         std::memory_order_relaxed)) {
+      start_index = next;
+      end_index = next + chunk;
+      return true;
+    }
+  }
+  return false;
+}
+
+void HostKernelExecuteState::RunWorker() {
+  uint64_t start_index, end_index;
+  while (Claim(start_index, end_index)) {
+    absl::Status status;
+    for (uint64_t i = start_index; i < end_index && status.ok(); ++i) {
+      // Skip remaining tasks if any of the tasks failed.
+      if (ABSL_PREDICT_FALSE(abort_.load(std::memory_order_relaxed))) break;
+      status = CallSync(i);
+    }
+    Notify(std::move(status), end_index - start_index);
+  }
 }
 
 SE_HOST_KernelThread HostKernelExecuteState::Delinearize(uint64_t task_index) {
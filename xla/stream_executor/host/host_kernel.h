@@ -106,6 +106,15 @@ class HostKernel : public Kernel {
       const ThreadDim& thread_dims, absl::Span<const SE_HOST_KernelArg> args,
       TaskRunner task_runner) const;
 
+  // Launches the kernel with at most `num_workers` tasks (including the caller
+  // thread) that claim chunks of consecutive threads from a shared counter.
+  // Chunks start large and shrink as the remaining work gets smaller, so that
+  // workers that fall behind (e.g. preempted ones) hold only a small part of
+  // the work, and workers that start late or finish early pick up the rest.
+  tsl::AsyncValueRef<LaunchEvent> Launch(
+      const ThreadDim& thread_dims, absl::Span<const SE_HOST_KernelArg> args,
+      TaskRunner task_runner, size_t num_workers) const;
+
   // For host platform, we assume that a core is a thread, and we can run at
   // most one instance of a kernel on a given thread.
   absl::StatusOr<int32_t> GetMaxOccupiedBlocksPerCore(ThreadDim,
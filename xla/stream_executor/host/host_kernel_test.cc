@@ -214,7 +214,8 @@ TEST(HostKernelTest, LaunchAsync) {
 
   tsl::BlockUntilReady(event);
   EXPECT_TRUE(event.IsConcrete());
-  EXPECT_EQ(num_tasks.load(std::memory_order_relaxed), 4 * 4 * 4 - 1);
+  // Workers are not started once all tasks are claimed.
+  EXPECT_LE(num_tasks.load(std::memory_order_relaxed), 4 * 4 * 4 - 1);
 }
 
 TEST(HostKernelTest, LaunchAsyncError) {
@@ -246,7 +247,48 @@ TEST(HostKernelTest, LaunchAsyncError) {
   ASSERT_TRUE(event.IsError());
   EXPECT_TRUE(absl::StrContains(event.GetError().message(),
                                 "Failed to call host kernel:"));
-  EXPECT_EQ(num_tasks.load(std::memory_order_relaxed), 4 * 4 * 4 - 1);
+  // Workers are not started once all tasks are claimed.
+  EXPECT_LE(num_tasks.load(std::memory_order_relaxed), 4 * 4 * 4 - 1);
+}
+
+TEST(HostKernelTest, LaunchAsyncWithWorkers) {
+  auto* count_calls = +[](const SE_HOST_KernelCallFrame* call_frame) {
+    auto* calls = reinterpret_cast<std::atomic<int32_t>*>(
+        call_frame->args[0].data);
+    const auto zstep = call_frame->thread_dims->x * call_frame->thread_dims->y;
+    const auto ystep = call_frame->thread_dims->x;
+    uint64_t i = call_frame->thread->x + call_frame->thread->y * ystep +
+                 call_frame->thread->z * zstep;
+    calls[i].fetch_add(1, std::memory_order_relaxed);
+    return static_cast<SE_HOST_KernelError*>(nullptr);
+  };
+
+  auto thread_pool = std::make_shared<tsl::thread::ThreadPool>(
+      tsl::Env::Default(), "benchmark", 4);
+
+  std::atomic<size_t> num_tasks = 0;
+
+  HostKernel::TaskRunner runner = [&](HostKernel::Task task) {
+    num_tasks.fetch_add(1, std::memory_order_relaxed);
+    thread_pool->Schedule(std::move(task));
+  };
+
+  std::vector<std::atomic<int32_t>> calls(8 * 8 * 8);
+  SE_HOST_KernelArg arg = {calls.data(),
+                           calls.size() * sizeof(std::atomic<int32_t>)};
+
+  HostKernel host_kernel(/*arity=*/1, count_calls);
+  auto event = host_kernel.Launch(ThreadDim(8, 8, 8),
+                                  absl::Span<const SE_HOST_KernelArg>(&arg, 1),
+                                  std::move(runner), /*num_workers=*/4);
+
+  tsl::BlockUntilReady(event);
+  EXPECT_TRUE(event.IsConcrete());
+
+  // Every kernel thread is called exactly once, and at most one task per
+  // worker (except the caller one) is scheduled.
+  for (auto& c : calls) EXPECT_EQ(c.load(std::memory_order_relaxed), 1);
+  EXPECT_LE(num_tasks.load(std::memory_order_relaxed), 3);
 }
 
 //===----------------------------------------------------------------------===//
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstdint>
 #include <memory>
+#include <string>
 
 #include "absl/base/casts.h"
 #include "absl/status/statusor.h"
@@ -125,5 +127,41 @@ TEST_F(RoundTripPackedLiteralTest, RoundTripsR2F32Size2x2Dim1Minor) {
   EXPECT_TRUE(LiteralTestUtil::Equal(round_tripped, actual));
 }
 
+TEST_F(RoundTripPackedLiteralTest, MapsR1F32AndR2S32) {
+  std::string data(sizeof(float) * 2 + sizeof(int32_t) * 4, 0);
+  absl::Span<float> floats(absl::bit_cast<float*>(data.data()), 2);
+  floats[0] = 42.0;
+  floats[1] = 24.0;
+  absl::Span<int32_t> ints(
+      absl::bit_cast<int32_t*>(data.data() + sizeof(float) * 2), 4);
+  ints[0] = 1;  // y=0,x=0
+  ints[1] = 2;  // y=0,x=1
+  ints[2] = 3;  // y=1,x=0
+  ints[3] = 4;  // y=1,x=1
+
+  std::string fname = tsl::testing::TmpDir() + "/MapsR1F32AndR2S32.data";
+  EXPECT_TRUE(tsl::WriteStringToFile(tsl::Env::Default(), fname, data).ok());
+
+  std::unique_ptr<MappedPackedLiteralReader> reader =
+      MappedPackedLiteralReader::Open(tsl::Env::Default(), fname).value();
+  BorrowingLiteral floats_literal =
+      reader->Read(ShapeUtil::MakeShape(F32, {2})).value();
+  EXPECT_FALSE(reader->IsExhausted());
+  BorrowingLiteral ints_literal =
+      reader->Read(ShapeUtil::MakeShape(S32, {2, 2})).value();
+  EXPECT_TRUE(reader->IsExhausted());
+  EXPECT_FALSE(reader->Read(ShapeUtil::MakeShape(F32, {1})).ok());
+
+  EXPECT_EQ(42.0f, floats_literal.Get<float>({0}));
+  EXPECT_EQ(24.0f, floats_literal.Get<float>({1}));
+  EXPECT_EQ(1, ints_literal.Get<int32_t>({0, 0}));
+  EXPECT_EQ(2, ints_literal.Get<int32_t>({0, 1}));
+  EXPECT_EQ(3, ints_literal.Get<int32_t>({1, 0}));
+  EXPECT_EQ(4, ints_literal.Get<int32_t>({1, 1}));
+
+  Literal round_tripped = RoundTripToServer(ints_literal.Clone());
+  EXPECT_TRUE(LiteralTestUtil::Equal(round_tripped, ints_literal));
+}
+
 }  // namespace
 }  // namespace xla
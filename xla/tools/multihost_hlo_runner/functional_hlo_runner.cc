@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/tools/multihost_hlo_runner/functional_hlo_runner.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -27,6 +28,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/btree_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -36,6 +38,8 @@ limitations under the License.
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xla/client/executable_build_options.h"
 #include "xla/client/xla_computation.h"
@@ -57,6 +61,7 @@ limitations under the License.
 #include "xla/service/computation_layout.h"
 #include "xla/service/computation_placer.h"
 #include "xla/service/hlo.pb.h"
+#include "xla/service/hlo_cost_analysis.h"
 #include "xla/service/hlo_module_config.h"
 #include "xla/shape_util.h"
 #include "xla/status_macros.h"
@@ -916,6 +921,51 @@ absl::Status EnsureSingleTupleForFlattening(const HloModule& module) {
   return absl::OkStatus();
 }
 
+// Completion times of pipelined repeats. Shared with the callbacks of the
+// execution futures, which may still be running when the runner returns.
+struct PipelinedRepeats {
+  explicit PipelinedRepeats(size_t num_repeats)
+      : completion_times(num_repeats) {}
+
+  absl::Mutex mu;
+  std::vector<absl::Time> completion_times ABSL_GUARDED_BY(mu);
+  size_t num_completed ABSL_GUARDED_BY(mu) = 0;
+};
+
+// Logs step time percentiles of pipelined repeats, and the FLOP/s and
+// bandwidth they achieved according to HloCostAnalysis.
+absl::Status LogPipelinedThroughput(
+    const HloModule& module, absl::Time start,
+    absl::Span<const absl::Time> completion_times) {
+  if (completion_times.empty()) return absl::OkStatus();
+  std::vector<absl::Duration> step_times;
+  step_times.reserve(completion_times.size());
+  absl::Time previous = start;
+  for (absl::Time completion : completion_times) {
+    step_times.push_back(completion - previous);
+    previous = completion;
+  }
+  absl::Duration average = (completion_times.back() - start) /
+                           static_cast<int64_t>(step_times.size());
+  absl::c_sort(step_times);
+  auto percentile = [&](size_t p) {
+    return step_times[std::min(step_times.size() - 1,
+                               step_times.size() * p / 100)];
+  };
+
+  HloCostAnalysis cost_analysis([](const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/sizeof(void*));
+  });
+  TF_RETURN_IF_ERROR(module.entry_computation()->Accept(&cost_analysis));
+  double seconds = absl::ToDoubleSeconds(average);
+  LOG(INFO) << "FunctionalHloRunner: pipelined " << step_times.size()
+            << " repeats, step time average " << average << ", p50 "
+            << percentile(50) << ", p99 " << percentile(99) << "; "
+            << cost_analysis.flop_count() / seconds << " FLOP/s, "
+            << cost_analysis.bytes_accessed() / seconds << " bytes/s";
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::StatusOr<FunctionalHloRunner::PerDeviceLiteralVecType>
@@ -1009,6 +1059,10 @@ FunctionalHloRunner::RunInternal(
   futures.emplace();
   std::vector<std::vector<std::unique_ptr<PjRtBuffer>>> device_buffers;
   std::vector<std::vector<PjRtBuffer*>> argument_ptrs;
+  auto pipelined_repeats =
+      std::make_shared<PipelinedRepeats>(running_options.num_repeats);
+  std::vector<PjRtFuture<>> pipelined_futures;
+  absl::Time pipeline_start = absl::Now();
   for (int repeat = 0; repeat < running_options.num_repeats; ++repeat) {
     VLOG(1) << "FunctionalHloRunner: ExecuteOnDevices started (repeat = "
             << repeat << ").";
@@ -1031,8 +1085,23 @@ FunctionalHloRunner::RunInternal(
     TF_ASSIGN_OR_RETURN(
         output_buffers,
         executable->Execute(argument_ptrs, execute_options, futures));
-    for (auto& future : *futures) {
-      TF_RETURN_IF_ERROR(future.Await());
+    if (running_options.pipeline_repeats) {
+      TF_RET_CHECK(!futures->empty());
+      // Devices run repeats in order, so the first device finishing a repeat
+      // marks its completion.
+      futures->front().OnReady(
+          [pipelined_repeats, repeat](const absl::Status&) {
+            absl::MutexLock lock(&pipelined_repeats->mu);
+            pipelined_repeats->completion_times[repeat] = absl::Now();
+            ++pipelined_repeats->num_completed;
+          });
+      for (auto& future : *futures) {
+        pipelined_futures.push_back(std::move(future));
+      }
+    } else {
+      for (auto& future : *futures) {
+        TF_RETURN_IF_ERROR(future.Await());
+      }
     }
     VLOG(1) << "FunctionalHloRunner: ExecuteOnDevices succeeded (repeat = "
             << repeat << ")";
@@ -1056,6 +1125,20 @@ FunctionalHloRunner::RunInternal(
     }
   }
 
+  if (running_options.pipeline_repeats) {
+    for (auto& future : pipelined_futures) {
+      TF_RETURN_IF_ERROR(future.Await());
+    }
+    absl::MutexLock lock(&pipelined_repeats->mu);
+    auto all_completed = [&]() {
+      pipelined_repeats->mu.AssertHeld();
+      return pipelined_repeats->num_completed == running_options.num_repeats;
+    };
+    pipelined_repeats->mu.Await(absl::Condition(&all_completed));
+    TF_RETURN_IF_ERROR(LogPipelinedThroughput(
+        module, pipeline_start, pipelined_repeats->completion_times));
+  }
+
   TF_ASSIGN_OR_RETURN(PerDeviceLiteralVecType results,
                       FetchAndLogOutput(client, output_buffers,
                                         running_options.module_output_mode,
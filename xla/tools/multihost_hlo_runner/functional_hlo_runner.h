@@ -196,6 +196,11 @@ class FunctionalHloRunner {
     // If true, we recreate the buffers between repeats to reset of effect of
     // buffer donation.
     bool recreate_buffers_between_repeats = false;
+    // If true, all repeats are enqueued back to back without waiting for the
+    // previous one, feeding aliased outputs into the next repeat. The step
+    // times between repeat completions are logged as percentiles together
+    // with the achieved FLOP/s and bandwidth of the module.
+    bool pipeline_repeats = false;
     // This indicates whether we log the inputs and outputs to stderr.
     LogOutputMode log_input_output_mode = LogOutputMode::kNotLogOutput;
     const MultiSliceConfig* multi_slice_config = nullptr;
@@ -96,6 +96,7 @@ struct HloRunnerConfig {
   int32_t while_execution_count = -1;
   bool remove_infeed_outfeed = true;
   int32_t num_repeats = 1;
+  bool pipeline_repeats = false;
   std::string execution_options_path = "";
   int64_t gpu_client_initialization_timeout_sec = 300;
 };
@@ -158,6 +159,7 @@ RunningOptionsFromFlags(const HloRunnerConfig& opts) {
   out.module_output_mode =
       FunctionalHloRunner::ModuleOutputMode::kReturnOutputs;
   out.num_repeats = static_cast<size_t>(opts.num_repeats);
+  out.pipeline_repeats = opts.pipeline_repeats;
   out.log_input_output_mode =
       opts.log_output ? FunctionalHloRunner::LogOutputMode::kLogOutput
                       : FunctionalHloRunner::LogOutputMode::kNotLogOutput;
@@ -307,6 +309,9 @@ int main(int argc, char** argv) {
                 "If set, we will remove all infeed and outfeed operations."),
       tsl::Flag("num_repeats", &opts.num_repeats,
                 "Repeatedly execute the HLO for this many times."),
+      tsl::Flag("pipeline_repeats", &opts.pipeline_repeats,
+                "If set, enqueue all repeats back to back and log step time "
+                "percentiles and achieved FLOP/s and bandwidth."),
       tsl::Flag("execution_options_path", &opts.execution_options_path,
                 "A path to a protobuf text file which stores the "
                 "ExecutionOptions message for this HLO module."),
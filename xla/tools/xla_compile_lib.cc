@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/tools/xla_compile_lib.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <optional>
@@ -58,6 +59,7 @@ limitations under the License.
 #include "xla/stream_executor/stream_executor_memory_allocator.h"
 #include "xla/tools/hlo_module_loader.h"
 #include "xla/util.h"
+#include "tsl/platform/cpu_info.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/env_time.h"
 #include "tsl/platform/errors.h"
@@ -66,6 +68,7 @@ limitations under the License.
 #include "tsl/platform/status.h"
 #include "tsl/platform/status_to_from_proto.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "xla/service/gpu/autotuning/autotuner_util.h"
@@ -157,6 +160,51 @@ absl::StatusOr<std::string> CompileExecutable(
                               result);
 }
 
+std::vector<absl::StatusOr<std::string>> CompileExecutables(
+    std::vector<std::unique_ptr<HloModule>> hlo_modules, BackendType backend,
+    std::optional<Compiler::TargetConfig> target_config,
+    std::vector<CompilationResult>& results, int max_parallelism) {
+  const int num_modules = hlo_modules.size();
+  std::vector<absl::StatusOr<std::string>> executables(
+      num_modules, absl::UnknownError("Module was not compiled"));
+  results.assign(num_modules, CompilationResult());
+  if (num_modules == 0) {
+    return executables;
+  }
+
+  if (max_parallelism <= 0) {
+    max_parallelism = tsl::port::MaxParallelism();
+  }
+  // Without a target config, GPU modules are compiled for the local device
+  // and autotuned on it. Concurrent autotuning on the same device would skew
+  // the measurements, so those modules are compiled one at a time.
+  const bool autotunes_on_device =
+      backend != BackendType::kCpu && !target_config.has_value();
+  const int num_threads =
+      autotunes_on_device ? 1 : std::min(max_parallelism, num_modules);
+  if (num_threads <= 1) {
+    for (int i = 0; i < num_modules; ++i) {
+      executables[i] = CompileExecutable(std::move(hlo_modules[i]), backend,
+                                         target_config, results[i]);
+    }
+    return executables;
+  }
+
+  {
+    // Every task writes only its own slots, and destroying the pool waits for
+    // all of them to finish.
+    tsl::thread::ThreadPool pool(tsl::Env::Default(), "xla_compile_lib",
+                                 num_threads);
+    for (int i = 0; i < num_modules; ++i) {
+      pool.Schedule([&, i] {
+        executables[i] = CompileExecutable(std::move(hlo_modules[i]), backend,
+                                           target_config, results[i]);
+      });
+    }
+  }
+  return executables;
+}
+
 absl::Status WriteResultFile(const absl::string_view result_output_file,
                              TimerStats& stats,
                              CompilationResult& compilation_result) {
@@ -215,7 +263,7 @@ absl::StatusOr<std::unique_ptr<HloModule>> LoadModule(
   DebugOptions debug_options = GetDebugOptionsFromFlags();
   HloModuleConfig config(shape);
   config.set_debug_options(debug_options);
-  return HloModule::CreateFromProto(hlo_module_proto, config);
+  return HloModule::CreateFromProto(std::move(hlo_module_proto), config);
 }
 
 static absl::StatusOr<std::unique_ptr<HloModuleAndMetadata>>
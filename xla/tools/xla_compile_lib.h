@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -43,6 +44,22 @@ absl::StatusOr<std::string> CompileExecutable(
     std::optional<Compiler::TargetConfig> target_config,
     CompilationResult& result);
 
+// Compiles a batch of independent modules for the same backend and target
+// concurrently, with at most `max_parallelism` compilations in flight (all
+// available cores if it is not positive). Returns one compiled executable per
+// module, in the order of `hlo_modules`; a failing module does not abort the
+// others. `results` is resized to the number of modules and filled like the
+// `result` argument of CompileExecutable.
+//
+// Compilations of the batch share the process-wide compiler caches (e.g. the
+// GPU autotuning results), so loading autotuning data once before the batch
+// starts is enough. GPU modules without a `target_config` are compiled for,
+// and autotuned on, the local device; they are compiled one at a time.
+std::vector<absl::StatusOr<std::string>> CompileExecutables(
+    std::vector<std::unique_ptr<HloModule>> hlo_modules, BackendType backend,
+    std::optional<Compiler::TargetConfig> target_config,
+    std::vector<CompilationResult>& results, int max_parallelism = 0);
+
 // Merges the measured duration into compilation_result and writes
 // compilation_result to result_output_file in the wire format.
 absl::Status WriteResultFile(absl::string_view result_output_file,
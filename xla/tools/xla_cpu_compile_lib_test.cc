@@ -17,10 +17,12 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "google/protobuf/duration.pb.h"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/service/platform_util.h"
@@ -73,6 +75,23 @@ TEST_F(XlaCompileLibTest, CompilesForCpu) {
               IsOkAndHolds(Not(IsEmpty())));
 }
 
+TEST_F(XlaCompileLibTest, CompilesBatchForCpu) {
+  std::vector<std::unique_ptr<HloModule>> modules;
+  for (int i = 0; i < 3; ++i) {
+    modules.push_back(module_->Clone());
+  }
+
+  std::vector<CompilationResult> results;
+  std::vector<absl::StatusOr<std::string>> executables =
+      CompileExecutables(std::move(modules), BackendType::kCpu, std::nullopt,
+                         results, /*max_parallelism=*/2);
+  ASSERT_EQ(executables.size(), 3);
+  EXPECT_EQ(results.size(), 3);
+  for (const auto& executable : executables) {
+    EXPECT_THAT(executable, IsOkAndHolds(Not(IsEmpty())));
+  }
+}
+
 TEST_F(XlaCompileLibTest, ErrorsOnUnexpectedPlatform) {
   XlaCompileOptions options;
   options.platform = "tpu";
@@ -19,8 +19,10 @@ limitations under the License.
 #include <cstdint>
 #include <cstdlib>
 #include <limits>
+#include <new>
 #include <utility>
 
+#include "absl/base/attributes.h"
 #include "absl/base/optimization.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/functional/any_invocable.h"
@@ -32,21 +34,74 @@ limitations under the License.
 
 namespace tsl {
 
-// This is a singly linked list of nodes waiting for notification, hanging off
-// of AsyncValue.  When the value becomes available or if an error occurs, the
-// callbacks are informed.
-class NotifierListNode {
- public:
-  explicit NotifierListNode(absl::AnyInvocable<void()> notification)
-      : next_(nullptr), notification_(std::move(notification)) {}
-
- private:
-  friend class AsyncValue;
-  // This is the next thing waiting on the AsyncValue.
-  NotifierListNode* next_;
-  absl::AnyInvocable<void()> notification_;
+namespace {
+
+// Per-thread cache of free NotifierListNode::kPooledSize byte blocks, linked
+// through their first word. Waiters are usually added on one thread and run on
+// another, so blocks migrate between the caches; each cache is bounded and
+// returns the excess to the system allocator.
+struct FreeNode {
+  FreeNode* next;
+};
+
+struct NodeCache {
+  static constexpr int32_t kMaxSize = 256;
+
+  FreeNode* head;
+  int32_t size;
+  bool registered;  // NodeCacheCleanup is registered for this thread
+  bool disabled;    // the thread is exiting and the cache is drained
 };
 
+ABSL_CONST_INIT thread_local NodeCache node_cache = {nullptr, 0, false, false};
+
+// Drains `node_cache` when the thread exits. The cache itself is trivially
+// destructible, so nodes freed by later thread local destructors still see it
+// and bypass it.
+struct NodeCacheCleanup {
+  ~NodeCacheCleanup() {
+    node_cache.disabled = true;
+    while (FreeNode* node = node_cache.head) {
+      node_cache.head = node->next;
+      ::operator delete(node);
+    }
+    node_cache.size = 0;
+  }
+};
+
+}  // namespace
+
+void* NotifierListNode::Allocate(size_t size) {
+  if (size <= kPooledSize) {
+    NodeCache& cache = node_cache;
+    if (FreeNode* node = cache.head) {
+      cache.head = node->next;
+      --cache.size;
+      return node;
+    }
+    size = kPooledSize;
+  }
+  return ::operator new(size);
+}
+
+void NotifierListNode::Deallocate(void* ptr, size_t size) {
+  if (size <= kPooledSize) {
+    NodeCache& cache = node_cache;
+    if (ABSL_PREDICT_FALSE(!cache.registered)) {
+      static thread_local NodeCacheCleanup cleanup;
+      (void)cleanup;
+      cache.registered = true;
+    }
+    if (ABSL_PREDICT_TRUE(!cache.disabled &&
+                          cache.size < NodeCache::kMaxSize)) {
+      cache.head = new (ptr) FreeNode{cache.head};
+      ++cache.size;
+      return;
+    }
+  }
+  ::operator delete(ptr);
+}
+
 uint16_t AsyncValue::CreateTypeInfoAndReturnTypeIdImpl(
     const TypeInfo& type_info) {
   size_t type_id = GetTypeInfoTableSingleton()->emplace_back(type_info) + 1;
@@ -87,21 +142,18 @@ void AsyncValue::NotifyAvailable(State available_state) {
 void AsyncValue::RunWaiters(NotifierListNode* list) {
   while (list) {
     NotifierListNode* node = list;
-    // TODO(chky): pass state into notification_ so that waiters do not need to
-    // check atomic state again.
-    node->notification_();
     list = node->next_;
-    delete node;
+    // TODO(chky): pass state into the waiter so that waiters do not need to
+    // check atomic state again.
+    node->RunAndDestroy();
   }
 }
 
 // If the value is available or becomes available, this calls the closure
 // immediately. Otherwise, the add closure to the waiter list where it will be
 // called when the value becomes available.
-void AsyncValue::EnqueueWaiter(absl::AnyInvocable<void()> waiter,
+void AsyncValue::EnqueueWaiter(NotifierListNode* node,
                                WaitersAndState old_value) {
-  // Create the node for our waiter.
-  auto* node = new NotifierListNode(std::move(waiter));
   auto old_state = old_value.state();
 
   // Swap the next link in. old_value.state() must be unavailable when
@@ -119,8 +171,7 @@ void AsyncValue::EnqueueWaiter(absl::AnyInvocable<void()> waiter,
     if (old_value.state() == State::kConcrete ||
         old_value.state() == State::kError) {
       DCHECK(old_value.waiter() == nullptr);
-      node->notification_();
-      delete node;
+      node->RunAndDestroy();
       return;
     }
     // Update the waiter list in new_value.
@@ -36,7 +36,71 @@ limitations under the License.
 
 namespace tsl {
 
-class NotifierListNode;
+// This is a singly linked list of nodes waiting for notification, hanging off
+// of AsyncValue. When the value becomes available or if an error occurs, the
+// callbacks are informed.
+//
+// The waiter callback is stored inline in the node, so adding a waiter costs a
+// single allocation, and nodes of up to `kPooledSize` bytes come from a small
+// per-thread pool, so in steady state it usually costs none.
+class NotifierListNode {
+ public:
+  static constexpr size_t kPooledSize = 64;
+
+  template <typename Waiter>
+  static NotifierListNode* Create(Waiter&& waiter);
+
+  // Runs the waiter callback and destroys the node.
+  void RunAndDestroy() { run_and_destroy_(this); }
+
+ protected:
+  using RunAndDestroyFn = void (*)(NotifierListNode*);
+
+  explicit NotifierListNode(RunAndDestroyFn run_and_destroy)
+      : run_and_destroy_(run_and_destroy) {}
+
+  static void* Allocate(size_t size);
+  static void Deallocate(void* ptr, size_t size);
+
+ private:
+  friend class AsyncValue;
+
+  template <typename Waiter>
+  class Node;
+
+  // This is the next thing waiting on the AsyncValue.
+  NotifierListNode* next_ = nullptr;
+  RunAndDestroyFn run_and_destroy_;
+};
+
+template <typename Waiter>
+class NotifierListNode::Node final : public NotifierListNode {
+ public:
+  template <typename W>
+  explicit Node(W&& waiter)
+      : NotifierListNode(&RunAndDestroy), waiter_(std::forward<W>(waiter)) {}
+
+ private:
+  static void RunAndDestroy(NotifierListNode* node) {
+    auto* self = static_cast<Node*>(node);
+    self->waiter_();
+    self->~Node();
+    Deallocate(self, sizeof(Node));
+  }
+
+  Waiter waiter_;
+};
+
+template <typename Waiter>
+NotifierListNode* NotifierListNode::Create(Waiter&& waiter) {
+  using NodeT = Node<std::decay_t<Waiter>>;
+  if constexpr (alignof(NodeT) > alignof(std::max_align_t)) {
+    // Over-aligned waiters are rare, let AnyInvocable deal with them.
+    return Create(absl::AnyInvocable<void()>(std::forward<Waiter>(waiter)));
+  } else {
+    return new (Allocate(sizeof(NodeT))) NodeT(std::forward<Waiter>(waiter));
+  }
+}
 
 namespace internal {
 
@@ -467,8 +531,7 @@ class AsyncValue {
     return (*type_info_table)[type_id_ - 1];
   }
 
-  void EnqueueWaiter(absl::AnyInvocable<void()> waiter,
-                     WaitersAndState old_value);
+  void EnqueueWaiter(NotifierListNode* node, WaitersAndState old_value);
 
   // This is a global counter of the number of AsyncValue instances currently
   // live in the process.  This is intended to be used for debugging only, and
@@ -992,7 +1055,8 @@ void AsyncValue::AndThen(Waiter&& waiter) {
     waiter();
     return;
   }
-  EnqueueWaiter(std::forward<Waiter>(waiter), old_value);
+  EnqueueWaiter(NotifierListNode::Create(std::forward<Waiter>(waiter)),
+                old_value);
 }
 
 template <typename Waiter>
@@ -1008,9 +1072,10 @@ void AsyncValue::AndThen(Executor& executor, Waiter&& waiter) {
     return;
   }
   EnqueueWaiter(
-      [&executor, waiter = std::forward<Waiter>(waiter)]() mutable {
-        executor.Execute(std::move(waiter));
-      },
+      NotifierListNode::Create(
+          [&executor, waiter = std::forward<Waiter>(waiter)]() mutable {
+            executor.Execute(std::move(waiter));
+          }),
       old_value);
 }
 
@@ -930,4 +930,18 @@ BENCHMARK(BM_MakeConstructed<64>);
 BENCHMARK(BM_MakeConstructed<128>);
 BENCHMARK(BM_MakeConstructed<256>);
 
+static void BM_AndThen(benchmark::State& state) {
+  int32_t counter = 0;
+  for (auto _ : state) {
+    auto ref = MakeConstructedAsyncValueRef<int32_t>(42);
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      ref.AndThen([&counter] { ++counter; });
+    }
+    ref.SetStateConcrete();
+  }
+  benchmark::DoNotOptimize(counter);
+}
+
+BENCHMARK(BM_AndThen)->Arg(1)->Arg(4)->Arg(16);
+
 }  // namespace tsl
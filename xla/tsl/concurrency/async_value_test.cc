@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "xla/tsl/concurrency/async_value.h"
 
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
@@ -181,4 +183,30 @@ TEST(AsyncValueTest, StackAllocatedAsyncValue) {
   EXPECT_EQ(2, counter);
 }
 
+TEST(AsyncValueTest, WaitersOfAllSizes) {
+  AsyncValue* value = MakeConstructedAsyncValueRef<int32_t>(123).release();
+
+  // Waiters that fit into a pooled node, larger waiters and over-aligned ones
+  // all run in the reverse order they were added, and are destroyed after.
+  std::vector<int32_t> order;
+  auto counter = std::make_shared<int32_t>(0);
+  std::array<int32_t, 64> large = {};
+  large[63] = 2;
+  struct alignas(64) OverAligned {
+    std::vector<int32_t>* order;
+    std::shared_ptr<int32_t> counter;
+    void operator()() { order->push_back(3); }
+  };
+
+  value->AndThen([&order, counter] { order.push_back(1); });
+  value->AndThen([&order, counter, large] { order.push_back(large[63]); });
+  value->AndThen(OverAligned{&order, counter});
+  EXPECT_EQ(counter.use_count(), 4);
+
+  value->SetStateConcrete();
+  EXPECT_EQ(order, std::vector<int32_t>({3, 2, 1}));
+  EXPECT_EQ(counter.use_count(), 1);
+  value->DropRef();
+}
+
 }  // namespace tsl
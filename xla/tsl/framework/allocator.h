@@ -93,6 +93,14 @@ struct AllocatorStats {
   std::optional<int64_t> pool_bytes;
   std::optional<int64_t> peak_pool_bytes;
 
+  // Fraction of the free pool memory that is not part of the largest free
+  // block, if the allocator holds a pool of memory.
+  std::optional<double> fragmentation;
+
+  // Number of allocations that could not be served immediately and had to wait
+  // for memory to be returned to the allocator.
+  int64_t num_alloc_retries;
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
@@ -100,7 +108,8 @@ struct AllocatorStats {
         largest_alloc_size(0),
         bytes_reserved(0),
         peak_bytes_reserved(0),
-        largest_free_block_bytes(0) {}
+        largest_free_block_bytes(0),
+        num_alloc_retries(0) {}
 
   std::string DebugString() const;
 };
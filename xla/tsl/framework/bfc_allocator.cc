@@ -34,6 +34,7 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/framework/allocator.h"
 #include "xla/tsl/framework/allocator_retry.h"
+#include "xla/tsl/framework/metrics.h"
 #include "xla/tsl/protobuf/bfc_memory_map.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/file_system.h"
@@ -257,6 +258,10 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   if (r != nullptr) {
     return r;
   } else {
+    {
+      absl::MutexLock l(&mutex_);
+      ++stats_.num_alloc_retries;
+    }
     static const int64_t kMaxMillisToWait = 10000;  // 10 seconds
     r = retry_helper_.AllocateRaw(
         [this, &allocation_attr](size_t a, size_t nb, bool v) {
@@ -526,6 +531,34 @@ double BFCAllocator::GetFragmentation() {
          bytes_available;
 }
 
+std::vector<BFCAllocator::RegionFragmentation>
+BFCAllocator::GetRegionFragmentation() {
+  absl::MutexLock l(&mutex_);
+  std::vector<RegionFragmentation> result;
+  result.reserve(region_manager_.regions().size());
+  for (const auto& region : region_manager_.regions()) {
+    RegionFragmentation info{region.ptr(), region.memory_size(), 0, 0, 0, 0.0};
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (c->in_use()) {
+        info.bytes_in_use += c->size;
+      } else {
+        info.free_bytes += c->size;
+        info.largest_free_chunk = std::max(info.largest_free_chunk, c->size);
+      }
+      h = c->next;
+    }
+    if (info.free_bytes > 0) {
+      info.fragmentation =
+          static_cast<double>(info.free_bytes - info.largest_free_chunk) /
+          info.free_bytes;
+    }
+    result.push_back(info);
+  }
+  return result;
+}
+
 void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr) {
   BFCAllocator::Chunk* chunk = ChunkFromHandle(region_manager_.get_handle(ptr));
   AddTraceMe(traceme_name, chunk->ptr, chunk->requested_size, chunk->size);
@@ -1222,7 +1255,17 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 std::optional<AllocatorStats> BFCAllocator::GetStats() {
   absl::MutexLock l(&mutex_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.largest_free_block_bytes = LargestFreeChunk();
+  stats.fragmentation = 0.0;
+  if (*stats_.pool_bytes > stats_.bytes_in_use) {
+    stats.fragmentation = GetFragmentation();
+    metrics::UpdateBfcAllocatorFragmentation(name_, *stats.fragmentation);
+  }
+  metrics::UpdateBfcAllocatorMemoryStats(
+      name_, stats.bytes_in_use, stats.peak_bytes_in_use,
+      stats.largest_free_block_bytes, stats.num_alloc_retries);
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
@@ -1230,6 +1273,7 @@ bool BFCAllocator::ClearStats() {
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
+  stats_.num_alloc_retries = 0;
   return true;
 }
 
@@ -112,6 +112,25 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Describes how fragmented the free memory of an allocation region is.
+  struct RegionFragmentation {
+    const void* ptr;
+    size_t memory_size;
+    size_t bytes_in_use;
+    size_t free_bytes;
+    size_t largest_free_chunk;
+
+    // Fraction of free bytes that are not part of the largest free chunk, i.e.
+    // 0 if the free memory is contiguous and close to 1 if it's scattered
+    // across many small chunks.
+    double fragmentation;
+  };
+
+  // Returns the fragmentation of every allocation region, ordered by address.
+  // Allocations in the most fragmented regions are the best candidates for
+  // relocation when defragmenting the allocator.
+  std::vector<RegionFragmentation> GetRegionFragmentation();
+
  private:
   struct Bin;
 
@@ -16,8 +16,10 @@ limitations under the License.
 #include "xla/tsl/framework/metrics.h"
 
 #include <cstdint>
+#include <string>
 
 #include "xla/tsl/lib/monitoring/counter.h"
+#include "xla/tsl/lib/monitoring/gauge.h"
 
 namespace tsl {
 namespace metrics {
@@ -28,6 +30,18 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* bfc_allocator_fragmentation = monitoring::Gauge<double, 1>::New(
+    "/tensorflow/core/bfc_allocator_fragmentation",
+    "Fraction of the free memory of the BFC allocator that is not part of its "
+    "largest free chunk.",
+    "allocator_name");
+
+auto* bfc_allocator_memory_stats = monitoring::Gauge<int64_t, 2>::New(
+    "/tensorflow/core/bfc_allocator_memory_stats",
+    "Memory usage stats of the BFC allocator: bytes in use, peak bytes in use, "
+    "bytes of the largest free chunk and number of retried allocations.",
+    "allocator_name", "stat");
+
 }  // namespace
 
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
@@ -37,5 +51,24 @@ void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
   }
 }
 
+void UpdateBfcAllocatorFragmentation(const std::string& allocator_name,
+                                     double fragmentation) {
+  bfc_allocator_fragmentation->GetCell(allocator_name)->Set(fragmentation);
+}
+
+void UpdateBfcAllocatorMemoryStats(const std::string& allocator_name,
+                                   int64_t bytes_in_use,
+                                   int64_t peak_bytes_in_use,
+                                   int64_t largest_free_block_bytes,
+                                   int64_t num_alloc_retries) {
+  auto set_stat = [&](const std::string& stat, int64_t value) {
+    bfc_allocator_memory_stats->GetCell(allocator_name, stat)->Set(value);
+  };
+  set_stat("bytes_in_use", bytes_in_use);
+  set_stat("peak_bytes_in_use", peak_bytes_in_use);
+  set_stat("largest_free_block_bytes", largest_free_block_bytes);
+  set_stat("num_alloc_retries", num_alloc_retries);
+}
+
 }  // namespace metrics
 }  // namespace tsl
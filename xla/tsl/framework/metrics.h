@@ -17,6 +17,7 @@ limitations under the License.
 #define XLA_TSL_FRAMEWORK_METRICS_H_
 
 #include <cstdint>
+#include <string>
 
 namespace tsl {
 namespace metrics {
@@ -24,6 +25,17 @@ namespace metrics {
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs);
 
+// Updates the fragmentation of the free memory of the named BFC allocator.
+void UpdateBfcAllocatorFragmentation(const std::string& allocator_name,
+                                     double fragmentation);
+
+// Updates the memory usage stats of the named BFC allocator.
+void UpdateBfcAllocatorMemoryStats(const std::string& allocator_name,
+                                   int64_t bytes_in_use,
+                                   int64_t peak_bytes_in_use,
+                                   int64_t largest_free_block_bytes,
+                                   int64_t num_alloc_retries);
+
 }  // namespace metrics
 }  // namespace tsl
 
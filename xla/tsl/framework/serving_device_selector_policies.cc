@@ -14,9 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "xla/tsl/framework/serving_device_selector_policies.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
 #include "xla/tsl/framework/serving_device_selector.h"
 
 namespace tsl {
@@ -28,4 +33,59 @@ int RoundRobinPolicy::SelectDevice(
   return ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
 }
 
+namespace {
+
+using ProgramInfo = ServingDeviceSelector::DeviceState::ProgramInfo;
+
+int64_t SumExecutionTimeNs(const std::deque<ProgramInfo>& programs) {
+  int64_t ns = 0;
+  for (const ProgramInfo& info : programs) {
+    // Scheduled programs may not know their fingerprint yet.
+    if (info.execution_info == nullptr) continue;
+    ns += info.execution_info->MaybeGetValidTime(info.prefetch_results);
+  }
+  return ns;
+}
+
+}  // namespace
+
+int EstimatedCompletionTimePolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  const int64_t now_ns = absl::GetCurrentTimeNanos();
+  int best_device = 0;
+  int64_t best_ns = 0;
+  size_t best_num_programs = 0;
+  for (int i = 0; i < device_states.states.size(); ++i) {
+    const ServingDeviceSelector::DeviceState& state = device_states.states[i];
+    int64_t enqueued_ns = 0;
+    int64_t scheduled_ns = 0;
+    size_t num_programs = 0;
+    for (const auto& programs : state.enqueued_programs) {
+      enqueued_ns += SumExecutionTimeNs(programs);
+      num_programs += programs.size();
+    }
+    for (const auto& programs : state.scheduled_programs) {
+      scheduled_ns += SumExecutionTimeNs(programs);
+      num_programs += programs.size();
+    }
+    if (enqueued_ns > 0) {
+      enqueued_ns = std::max<int64_t>(
+          0, enqueued_ns - (now_ns - state.last_started_ns));
+    }
+    int64_t estimate_ns = enqueued_ns + scheduled_ns;
+    if (!program_fingerprint.empty() &&
+        state.last_fingerprint == program_fingerprint) {
+      estimate_ns -= affinity_bonus_ns_;
+    }
+    if (i == 0 || estimate_ns < best_ns ||
+        (estimate_ns == best_ns && num_programs < best_num_programs)) {
+      best_device = i;
+      best_ns = estimate_ns;
+      best_num_programs = num_programs;
+    }
+  }
+  return best_device;
+}
+
 }  // namespace tsl
@@ -16,6 +16,7 @@ limitations under the License.
 #define XLA_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
 
 #include <atomic>
+#include <cstdint>
 
 #include "xla/tsl/framework/serving_device_selector.h"
 
@@ -23,6 +24,7 @@ namespace tsl {
 
 enum class ServingDeviceSelectorPolicy {
   kRoundRobin,
+  kEstimatedCompletionTime,
 };
 
 class RoundRobinPolicy : public ServingDeviceSelector::Policy {
@@ -37,6 +39,26 @@ class RoundRobinPolicy : public ServingDeviceSelector::Policy {
   std::atomic<uint64_t> ordinal_;
 };
 
+// Selects the device expected to drain its queues first. The pending work of
+// a device is the sum of the running average execution times of its enqueued
+// and scheduled programs, minus the time the program at the head of the queue
+// has already been running. A device whose last high priority program is the
+// requested one likely still holds its resident buffers, so its estimate is
+// lowered by `affinity_bonus_ns`. Ties go to the device with fewer pending
+// programs, then to the lowest index.
+class EstimatedCompletionTimePolicy : public ServingDeviceSelector::Policy {
+ public:
+  explicit EstimatedCompletionTimePolicy(int64_t affinity_bonus_ns = 0)
+      : affinity_bonus_ns_(affinity_bonus_ns) {}
+
+  int SelectDevice(
+      absl::string_view program_fingerprint,
+      const ServingDeviceSelector::DeviceStates& device_states) override;
+
+ private:
+  const int64_t affinity_bonus_ns_;
+};
+
 }  // namespace tsl
 
 #endif  // XLA_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
@@ -0,0 +1,94 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "xla/tsl/framework/serving_device_selector_policies.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "xla/tsl/framework/serving_device_selector.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace {
+
+using DeviceState = ServingDeviceSelector::DeviceState;
+
+void EnqueueProgram(DeviceState& state, const char* fingerprint,
+                    const ServingDeviceSelector::ExecutionInfo* info) {
+  DeviceState::ProgramInfo program;
+  program.fingerprint = fingerprint;
+  program.priority = 0;
+  program.execution_info = info;
+  program.prefetch_results = 0;
+  state.enqueued_programs[0].push_back(program);
+  state.last_fingerprint = fingerprint;
+  state.last_started_ns = absl::GetCurrentTimeNanos();
+}
+
+TEST(RoundRobinPolicyTest, CyclesThroughDevices) {
+  std::vector<DeviceState> states(3);
+  RoundRobinPolicy policy;
+  EXPECT_EQ(policy.SelectDevice("fp", {states}), 0);
+  EXPECT_EQ(policy.SelectDevice("fp", {states}), 1);
+  EXPECT_EQ(policy.SelectDevice("fp", {states}), 2);
+  EXPECT_EQ(policy.SelectDevice("fp", {states}), 0);
+}
+
+TEST(EstimatedCompletionTimePolicyTest, PrefersDeviceWithLessQueuedWork) {
+  ServingDeviceSelector::ExecutionInfo slow, fast;
+  slow.AddTime(/*value=*/int64_t{60} * 1000 * 1000 * 1000, /*result=*/0);
+  fast.AddTime(/*value=*/1000, /*result=*/0);
+
+  // Device 0 has fewer programs queued, but they take much longer.
+  std::vector<DeviceState> states(2);
+  EnqueueProgram(states[0], "slow", &slow);
+  EnqueueProgram(states[1], "fast", &fast);
+  EnqueueProgram(states[1], "fast", &fast);
+  EnqueueProgram(states[1], "fast", &fast);
+
+  EstimatedCompletionTimePolicy policy;
+  EXPECT_EQ(policy.SelectDevice("fast", {states}), 1);
+}
+
+TEST(EstimatedCompletionTimePolicyTest, BreaksTiesByQueueLength) {
+  // Without timing information all estimates are zero.
+  ServingDeviceSelector::ExecutionInfo unknown;
+  std::vector<DeviceState> states(3);
+  EnqueueProgram(states[0], "fp", &unknown);
+  EnqueueProgram(states[0], "fp", &unknown);
+  EnqueueProgram(states[2], "fp", &unknown);
+
+  EstimatedCompletionTimePolicy policy;
+  EXPECT_EQ(policy.SelectDevice("fp", {states}), 1);
+}
+
+TEST(EstimatedCompletionTimePolicyTest, PrefersDeviceHoldingTheProgram) {
+  ServingDeviceSelector::ExecutionInfo info;
+  info.AddTime(/*value=*/int64_t{60} * 1000 * 1000 * 1000, /*result=*/0);
+  std::vector<DeviceState> states(2);
+  EnqueueProgram(states[0], "other", &info);
+  EnqueueProgram(states[1], "fp", &info);
+
+  EstimatedCompletionTimePolicy no_affinity;
+  EXPECT_EQ(no_affinity.SelectDevice("fp", {states}), 0);
+
+  EstimatedCompletionTimePolicy affinity(
+      /*affinity_bonus_ns=*/int64_t{1000} * 1000 * 1000);
+  EXPECT_EQ(affinity.SelectDevice("fp", {states}), 1);
+}
+
+}  // namespace
+}  // namespace tsl
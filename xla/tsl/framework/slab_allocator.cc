@@ -0,0 +1,283 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/tsl/framework/slab_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/numeric/bits.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/tsl/framework/allocator.h"
+#include "tsl/platform/logging.h"
+
+namespace tsl {
+
+SlabAllocator::Slab::Slab(char* base, size_t size_class, size_t block_bytes,
+                          size_t num_blocks)
+    : base(base),
+      size_class(size_class),
+      block_bytes(block_bytes),
+      num_blocks(num_blocks),
+      free_blocks(new std::atomic<uint64_t>[(num_blocks + 63) / 64]),
+      num_words((num_blocks + 63) / 64) {
+  for (size_t i = 0; i < num_words; ++i) {
+    free_blocks[i].store(WordMask(i), std::memory_order_relaxed);
+  }
+}
+
+uint64_t SlabAllocator::Slab::WordMask(size_t i) const {
+  size_t blocks_in_word = std::min<size_t>(64, num_blocks - i * 64);
+  return blocks_in_word == 64 ? ~uint64_t{0}
+                              : (uint64_t{1} << blocks_in_word) - 1;
+}
+
+void* SlabAllocator::Slab::TryAllocate() {
+  for (size_t i = 0; i < num_words; ++i) {
+    uint64_t word = free_blocks[i].load(std::memory_order_relaxed);
+    while (word != 0) {
+      int bit = absl::countr_zero(word);
+      uint64_t allocated = word & ~(uint64_t{1} << bit);
+      if (free_blocks[i].compare_exchange_weak(word, allocated,
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+        num_allocated.fetch_add(1, std::memory_order_relaxed);
+        return base.load(std::memory_order_relaxed) +
+               (i * 64 + bit) * block_bytes;
+      }
+    }
+  }
+  return nullptr;
+}
+
+bool SlabAllocator::Slab::Deallocate(void* ptr) {
+  char* slab_base = base.load(std::memory_order_relaxed);
+  size_t block = (static_cast<char*>(ptr) - slab_base) / block_bytes;
+  DCHECK_EQ(static_cast<char*>(ptr), slab_base + block * block_bytes);
+  uint64_t mask = uint64_t{1} << (block % 64);
+  uint64_t word =
+      free_blocks[block / 64].fetch_or(mask, std::memory_order_release);
+  DCHECK_EQ(word & mask, 0) << "Double free of " << ptr;
+  return num_allocated.fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+
+bool SlabAllocator::Slab::TryRetire() {
+  for (size_t i = 0; i < num_words; ++i) {
+    uint64_t word = WordMask(i);
+    if (!free_blocks[i].compare_exchange_strong(word, 0,
+                                                std::memory_order_acquire,
+                                                std::memory_order_relaxed)) {
+      // A block is allocated. Nobody else modifies the words we already
+      // claimed, as none of their blocks is allocated, so we can free them.
+      for (size_t j = 0; j < i; ++j) {
+        free_blocks[j].store(WordMask(j), std::memory_order_release);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+void SlabAllocator::Slab::Reset(char* new_base) {
+  // Threads that allocate a block with an acquire CAS of a word stored below
+  // see the new base.
+  base.store(new_base, std::memory_order_relaxed);
+  for (size_t i = 0; i < num_words; ++i) {
+    free_blocks[i].store(WordMask(i), std::memory_order_release);
+  }
+}
+
+SlabAllocator::SlabAllocator(std::unique_ptr<Allocator> allocator,
+                             const Options& opts)
+    : allocator_(std::move(allocator)), opts_(opts) {
+  for (size_t block_bytes = kMinBlockBytes;
+       block_bytes <= opts_.max_slab_allocation_bytes &&
+       block_bytes <= opts_.slab_bytes;
+       block_bytes *= 2) {
+    auto size_class = std::make_unique<SizeClass>();
+    size_class->index = size_classes_.size();
+    size_class->block_bytes = block_bytes;
+    size_class->slabs.reset(new std::atomic<Slab*>[kMaxSlabsPerClass]);
+    size_classes_.push_back(std::move(size_class));
+  }
+}
+
+SlabAllocator::~SlabAllocator() {
+  absl::MutexLock lock(&slabs_mu_);
+  for (auto& [base, slab] : slabs_) {
+    allocator_->DeallocateRaw(reinterpret_cast<void*>(base));
+  }
+}
+
+SlabAllocator::SizeClass* SlabAllocator::FindSizeClass(size_t alignment,
+                                                       size_t num_bytes) {
+  // Slabs are aligned to kAllocatorAlignment, and so are their blocks.
+  if (num_bytes == 0 || alignment > Allocator::kAllocatorAlignment) {
+    return nullptr;
+  }
+  for (auto& size_class : size_classes_) {
+    if (num_bytes <= size_class->block_bytes) return size_class.get();
+  }
+  return nullptr;
+}
+
+void* SlabAllocator::TryAllocateFromSlabs(SizeClass& size_class,
+                                          size_t first) {
+  size_t num_slabs = size_class.num_slabs.load(std::memory_order_acquire);
+  for (size_t i = 0; i < num_slabs; ++i) {
+    size_t index = (first + i) % num_slabs;
+    Slab* slab = size_class.slabs[index].load(std::memory_order_acquire);
+    if (void* ptr = slab->TryAllocate()) {
+      size_class.next_slab.store(index, std::memory_order_relaxed);
+      return ptr;
+    }
+  }
+  return nullptr;
+}
+
+void* SlabAllocator::AllocateFromNewSlab(SizeClass& size_class) {
+  absl::MutexLock lock(&size_class.mu);
+
+  // Another thread might have added a slab while we were waiting for the lock.
+  if (void* ptr = TryAllocateFromSlabs(size_class, 0)) return ptr;
+
+  size_t num_slabs = size_class.num_slabs.load(std::memory_order_relaxed);
+  if (size_class.retired_slabs.empty() && num_slabs == kMaxSlabsPerClass) {
+    return nullptr;
+  }
+
+  void* base = allocator_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                       opts_.slab_bytes);
+  if (base == nullptr) return nullptr;
+  num_slab_allocs_.fetch_add(1, std::memory_order_relaxed);
+
+  // Reuse a retired slab if there is one, as it's already published.
+  if (!size_class.retired_slabs.empty()) {
+    Slab* slab = size_class.retired_slabs.back();
+    size_class.retired_slabs.pop_back();
+    // Register the slab before freeing its blocks, so that blocks allocated
+    // from it by other threads can be deallocated.
+    {
+      absl::MutexLock slabs_lock(&slabs_mu_);
+      slabs_.emplace(reinterpret_cast<uintptr_t>(base), slab);
+    }
+    slab->Reset(static_cast<char*>(base));
+    return slab->TryAllocate();
+  }
+
+  auto slab = std::make_unique<Slab>(static_cast<char*>(base), size_class.index,
+                                     size_class.block_bytes,
+                                     opts_.slab_bytes / size_class.block_bytes);
+  Slab* published = slab.get();
+  size_class.owned_slabs.push_back(std::move(slab));
+  void* ptr = published->TryAllocate();
+
+  // Register the slab before publishing it, so that blocks allocated from it
+  // by other threads can be deallocated.
+  {
+    absl::MutexLock slabs_lock(&slabs_mu_);
+    slabs_.emplace(reinterpret_cast<uintptr_t>(base), published);
+  }
+  size_class.slabs[num_slabs].store(published, std::memory_order_release);
+  size_class.num_slabs.store(num_slabs + 1, std::memory_order_release);
+  size_class.next_slab.store(num_slabs, std::memory_order_relaxed);
+  return ptr;
+}
+
+void SlabAllocator::MaybeRetireSlab(Slab& slab) {
+  SizeClass& size_class = *size_classes_[slab.size_class];
+  absl::MutexLock lock(&size_class.mu);
+
+  // Keep the last slab, so that allocating and freeing a single block doesn't
+  // allocate and free a slab every time.
+  size_t num_slabs = size_class.num_slabs.load(std::memory_order_relaxed);
+  if (num_slabs - size_class.retired_slabs.size() <= 1) return;
+
+  // Fails if a block was allocated in the meantime, or if another thread
+  // already retired the slab.
+  if (!slab.TryRetire()) return;
+
+  char* base = slab.base.load(std::memory_order_relaxed);
+  {
+    absl::MutexLock slabs_lock(&slabs_mu_);
+    slabs_.erase(reinterpret_cast<uintptr_t>(base));
+  }
+  allocator_->DeallocateRaw(base);
+  size_class.retired_slabs.push_back(&slab);
+}
+
+SlabAllocator::Slab* SlabAllocator::FindSlab(const void* ptr) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+  absl::ReaderMutexLock lock(&slabs_mu_);
+  auto it = slabs_.upper_bound(addr);
+  if (it == slabs_.begin()) return nullptr;
+  --it;
+  return addr < it->first + opts_.slab_bytes ? it->second : nullptr;
+}
+
+void* SlabAllocator::AllocateRaw(size_t alignment, size_t num_bytes,
+                                 const AllocationAttributes& allocation_attr) {
+  SizeClass* size_class = FindSizeClass(alignment, num_bytes);
+  if (size_class == nullptr) {
+    return allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+
+  void* ptr = TryAllocateFromSlabs(
+      *size_class, size_class->next_slab.load(std::memory_order_relaxed));
+  if (ptr == nullptr) ptr = AllocateFromNewSlab(*size_class);
+
+  // Fall back to the underlying allocator if we can't grow the slabs.
+  if (ptr == nullptr) {
+    return allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+
+  num_block_allocs_.fetch_add(1, std::memory_order_relaxed);
+  return ptr;
+}
+
+void SlabAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+
+  Slab* slab = FindSlab(ptr);
+  if (slab == nullptr) {
+    allocator_->DeallocateRaw(ptr);
+    return;
+  }
+
+  if (slab->Deallocate(ptr)) MaybeRetireSlab(*slab);
+}
+
+std::optional<AllocatorStats> SlabAllocator::GetStats() {
+  std::optional<AllocatorStats> stats = allocator_->GetStats();
+  if (!stats.has_value()) return stats;
+
+  stats->num_allocs += num_block_allocs_.load(std::memory_order_relaxed) -
+                       num_slab_allocs_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+bool SlabAllocator::ClearStats() {
+  if (!allocator_->ClearStats()) return false;
+  num_block_allocs_.store(0, std::memory_order_relaxed);
+  num_slab_allocs_.store(0, std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace tsl
@@ -0,0 +1,186 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_TSL_FRAMEWORK_SLAB_ALLOCATOR_H_
+#define XLA_TSL_FRAMEWORK_SLAB_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/tsl/framework/allocator.h"
+
+namespace tsl {
+
+// An allocator front-end that serves small allocations from slabs of fixed
+// size classes, and forwards all other allocations to an underlying allocator
+// (typically a BFCAllocator). Slabs are large allocations of the underlying
+// allocator carved into blocks of a single size class.
+//
+// Allocating a block from an existing slab is lock-free: every slab tracks its
+// free blocks in a bitmap of atomic words. A lock is taken only to add a slab
+// when all slabs of a size class are full. Deallocation looks up the slab of a
+// block under a reader lock, which only contends with adding and removing
+// slabs. When the last block of a slab is freed, the memory of the slab is
+// returned to the underlying allocator, unless it is the last slab of its size
+// class. The remaining slabs are returned when the slab allocator is destroyed.
+//
+// Blocks are aligned to Allocator::kAllocatorAlignment. Allocations with a
+// larger alignment are forwarded to the underlying allocator.
+//
+// The slab allocator only keeps track of memory on the host, so it works for
+// allocators of device memory.
+class SlabAllocator : public Allocator {
+ public:
+  struct Options {
+    // Allocations of up to this many bytes are served from slabs. Larger
+    // allocations are forwarded to the underlying allocator.
+    size_t max_slab_allocation_bytes = 4096;
+
+    // Size of the slabs allocated from the underlying allocator.
+    size_t slab_bytes = size_t{2} << 20;
+  };
+
+  SlabAllocator(std::unique_ptr<Allocator> allocator, const Options& opts);
+  ~SlabAllocator() override;
+
+  std::string Name() override { return allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+
+  void DeallocateRaw(void* ptr) override;
+
+  // Returns the stats of the underlying allocator, in which the memory of
+  // slabs is in use in full, as it can't be used for other allocations. The
+  // number of allocations counts the blocks allocated from slabs instead of
+  // the slabs themselves.
+  std::optional<AllocatorStats> GetStats() override;
+
+  bool ClearStats() override;
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return allocator_->GetMemoryType();
+  }
+
+ private:
+  // Size of the smallest size class.
+  static constexpr size_t kMinBlockBytes = 256;
+
+  // Maximum number of slabs per size class.
+  static constexpr size_t kMaxSlabsPerClass = 4096;
+
+  // A slab whose memory was returned to the underlying allocator is retired:
+  // all of its blocks are marked as allocated, so that threads still reading
+  // it never allocate from it, until it is reset with new memory.
+  struct Slab {
+    Slab(char* base, size_t size_class, size_t block_bytes, size_t num_blocks);
+
+    // Returns a free block, or nullptr if the slab is full.
+    void* TryAllocate();
+
+    // Returns true if `ptr` was the last allocated block of the slab.
+    bool Deallocate(void* ptr);
+
+    // Marks all blocks as allocated if all of them are free. Returns false if
+    // some block is allocated, in which case the slab is unchanged.
+    bool TryRetire();
+
+    // Makes a retired slab serve the blocks of the memory at `base`.
+    void Reset(char* base);
+
+    // Bits of the blocks in word `i` of `free_blocks`.
+    uint64_t WordMask(size_t i) const;
+
+    std::atomic<char*> base;
+    const size_t size_class;  // Index into `size_classes_`.
+    const size_t block_bytes;
+    const size_t num_blocks;
+
+    // Bit `i % 64` of word `i / 64` is set if block `i` is free.
+    std::unique_ptr<std::atomic<uint64_t>[]> free_blocks;
+    const size_t num_words;
+
+    // Number of allocated blocks. It only triggers retiring the slab, the
+    // bitmap is the source of truth for which blocks are free.
+    std::atomic<int64_t> num_allocated{0};
+  };
+
+  struct SizeClass {
+    size_t index = 0;  // Index into `size_classes_`.
+    size_t block_bytes = 0;
+
+    // Slabs of this size class, published with release stores, so that
+    // allocating threads can read them without a lock.
+    std::unique_ptr<std::atomic<Slab*>[]> slabs;
+    std::atomic<size_t> num_slabs{0};
+
+    // Index of the slab the last block was allocated from.
+    std::atomic<size_t> next_slab{0};
+
+    absl::Mutex mu;  // Serializes adding and retiring slabs.
+
+    // Owns all slabs of this size class, including the retired ones, as other
+    // threads might read them without a lock.
+    std::vector<std::unique_ptr<Slab>> owned_slabs ABSL_GUARDED_BY(mu);
+    std::vector<Slab*> retired_slabs ABSL_GUARDED_BY(mu);
+  };
+
+  // Returns the size class for `num_bytes`, or nullptr if the allocation
+  // must be forwarded to the underlying allocator.
+  SizeClass* FindSizeClass(size_t alignment, size_t num_bytes);
+
+  // Allocates a block from the existing slabs of `size_class`, starting from
+  // slab `first`.
+  void* TryAllocateFromSlabs(SizeClass& size_class, size_t first);
+
+  // Adds a slab to `size_class` and allocates a block from it.
+  void* AllocateFromNewSlab(SizeClass& size_class);
+
+  // Returns the memory of `slab` to the underlying allocator if all of its
+  // blocks are free and it isn't the last slab of its size class.
+  void MaybeRetireSlab(Slab& slab);
+
+  // Returns the slab that `ptr` was allocated from, or nullptr.
+  Slab* FindSlab(const void* ptr);
+
+  std::unique_ptr<Allocator> allocator_;
+  const Options opts_;
+
+  std::vector<std::unique_ptr<SizeClass>> size_classes_;
+
+  absl::Mutex slabs_mu_;
+  // Slabs that aren't retired keyed by their base address.
+  absl::btree_map<uintptr_t, Slab*> slabs_ ABSL_GUARDED_BY(slabs_mu_);
+
+  // Number of blocks and slabs allocated since the stats were last cleared.
+  std::atomic<int64_t> num_block_allocs_{0};
+  std::atomic<int64_t> num_slab_allocs_{0};
+};
+
+}  // namespace tsl
+
+#endif  // XLA_TSL_FRAMEWORK_SLAB_ALLOCATOR_H_
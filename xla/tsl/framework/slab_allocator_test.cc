@@ -0,0 +1,213 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/tsl/framework/slab_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/tsl/framework/allocator.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/mem.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace {
+
+// A thread-safe allocator that keeps track of its allocations.
+class TestAllocator : public Allocator {
+ public:
+  std::string Name() override { return "test"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    void* ptr = port::AlignedMalloc(num_bytes, alignment);
+    absl::MutexLock lock(&mu_);
+    sizes_[ptr] = num_bytes;
+    ++stats_.num_allocs;
+    stats_.bytes_in_use += num_bytes;
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    absl::MutexLock lock(&mu_);
+    auto it = sizes_.find(ptr);
+    CHECK(it != sizes_.end()) << "Unknown pointer " << ptr;
+    stats_.bytes_in_use -= it->second;
+    sizes_.erase(it);
+    port::AlignedFree(ptr);
+  }
+
+  std::optional<AllocatorStats> GetStats() override {
+    absl::MutexLock lock(&mu_);
+    return stats_;
+  }
+
+  bool ClearStats() override {
+    absl::MutexLock lock(&mu_);
+    stats_.num_allocs = 0;
+    return true;
+  }
+
+  int64_t num_live_allocations() {
+    absl::MutexLock lock(&mu_);
+    return sizes_.size();
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<void*, size_t> sizes_ ABSL_GUARDED_BY(mu_);
+  AllocatorStats stats_ ABSL_GUARDED_BY(mu_);
+};
+
+constexpr size_t kSlabBytes = 64 * 1024;
+
+SlabAllocator::Options TestOptions() {
+  SlabAllocator::Options opts;
+  opts.max_slab_allocation_bytes = 4096;
+  opts.slab_bytes = kSlabBytes;
+  return opts;
+}
+
+TEST(SlabAllocatorTest, SmallAllocationsShareSlabs) {
+  auto base = std::make_unique<TestAllocator>();
+  TestAllocator* test_allocator = base.get();
+  SlabAllocator allocator(std::move(base), TestOptions());
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    void* ptr = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 200);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % Allocator::kAllocatorAlignment,
+              0);
+    ptrs.push_back(ptr);
+  }
+  // 100 blocks of 256 bytes fit into a single slab.
+  EXPECT_EQ(test_allocator->num_live_allocations(), 1);
+  EXPECT_EQ(absl::flat_hash_set<void*>(ptrs.begin(), ptrs.end()).size(),
+            ptrs.size());
+
+  // The whole slab is in use, as it can't be used for other allocations.
+  std::optional<AllocatorStats> stats = allocator.GetStats();
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->num_allocs, 100);
+  EXPECT_EQ(stats->bytes_in_use, kSlabBytes);
+
+  for (void* ptr : ptrs) allocator.DeallocateRaw(ptr);
+  stats = allocator.GetStats();
+  EXPECT_EQ(stats->bytes_in_use, kSlabBytes);
+  // The last slab of a size class is kept until the allocator is destroyed.
+  EXPECT_EQ(test_allocator->num_live_allocations(), 1);
+}
+
+TEST(SlabAllocatorTest, FreedBlocksAreReused) {
+  SlabAllocator allocator(std::make_unique<TestAllocator>(), TestOptions());
+  void* a = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  allocator.DeallocateRaw(a);
+  void* b = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  EXPECT_EQ(a, b);
+  allocator.DeallocateRaw(b);
+}
+
+TEST(SlabAllocatorTest, GrowsWhenSlabIsFull) {
+  auto base = std::make_unique<TestAllocator>();
+  TestAllocator* test_allocator = base.get();
+  SlabAllocator allocator(std::move(base), TestOptions());
+
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < kSlabBytes / 4096 + 1; ++i) {
+    ptrs.push_back(allocator.AllocateRaw(Allocator::kAllocatorAlignment, 4096));
+  }
+  EXPECT_EQ(test_allocator->num_live_allocations(), 2);
+  for (void* ptr : ptrs) allocator.DeallocateRaw(ptr);
+}
+
+TEST(SlabAllocatorTest, ReturnsEmptySlabs) {
+  auto base = std::make_unique<TestAllocator>();
+  TestAllocator* test_allocator = base.get();
+  SlabAllocator allocator(std::move(base), TestOptions());
+
+  for (int round = 0; round < 2; ++round) {
+    std::vector<void*> ptrs;
+    for (size_t i = 0; i < 2 * kSlabBytes / 4096; ++i) {
+      ptrs.push_back(allocator.AllocateRaw(Allocator::kAllocatorAlignment, 4096));
+    }
+    EXPECT_EQ(test_allocator->num_live_allocations(), 2);
+
+    // Freeing the blocks of the first slab returns it, but the last slab of
+    // the size class is kept.
+    for (void* ptr : ptrs) allocator.DeallocateRaw(ptr);
+    EXPECT_EQ(test_allocator->num_live_allocations(), 1);
+    EXPECT_EQ(allocator.GetStats()->bytes_in_use, kSlabBytes);
+  }
+}
+
+TEST(SlabAllocatorTest, ForwardsLargeAndOverAlignedAllocations) {
+  auto base = std::make_unique<TestAllocator>();
+  TestAllocator* test_allocator = base.get();
+  SlabAllocator allocator(std::move(base), TestOptions());
+
+  void* large = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 8192);
+  // Slabs only guarantee kAllocatorAlignment.
+  constexpr size_t kAlignment = 2 * Allocator::kAllocatorAlignment;
+  void* aligned = allocator.AllocateRaw(kAlignment, 128);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % kAlignment, 0);
+  EXPECT_EQ(test_allocator->num_live_allocations(), 2);
+
+  allocator.DeallocateRaw(large);
+  allocator.DeallocateRaw(aligned);
+  EXPECT_EQ(test_allocator->num_live_allocations(), 0);
+}
+
+TEST(SlabAllocatorTest, ConcurrentAllocations) {
+  auto base = std::make_unique<TestAllocator>();
+  TestAllocator* test_allocator = base.get();
+  SlabAllocator allocator(std::move(base), TestOptions());
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&allocator, t] {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 1000; ++i) {
+          size_t size = 64 << ((t + i) % 7);
+          auto* ptr = static_cast<char*>(
+              allocator.AllocateRaw(Allocator::kAllocatorAlignment, size));
+          ptr[0] = ptr[size - 1] = static_cast<char>(t);
+          ptrs.push_back(ptr);
+          if (i % 3 == 0) {
+            allocator.DeallocateRaw(ptrs.front());
+            ptrs.erase(ptrs.begin());
+          }
+        }
+        for (void* ptr : ptrs) allocator.DeallocateRaw(ptr);
+      });
+    }
+  }
+  // Only the last slab of each of the 5 size classes is left.
+  EXPECT_LE(test_allocator->num_live_allocations(), 5);
+  EXPECT_EQ(allocator.GetStats()->bytes_in_use,
+            test_allocator->num_live_allocations() * kSlabBytes);
+}
+
+}  // namespace
+}  // namespace tsl
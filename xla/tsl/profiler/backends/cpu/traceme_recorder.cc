@@ -45,6 +45,7 @@ namespace internal {
 // included only on DLL exports.
 DECL_DLL_EXPORT std::atomic<int> g_trace_level(
     TraceMeRecorder::kTracingDisabled);
+DECL_DLL_EXPORT std::atomic<int> g_sampling_period(1);
 
 // g_trace_level implementation must be lock-free for faster execution of the
 // TraceMe API. This can be commented (if compilation is failing) but execution
@@ -117,7 +118,16 @@ class ThreadLocalRecorder {
   const TraceMeRecorder::ThreadInfo& Info() const { return info_; }
 
   // Record is only called from the producer thread.
-  void Record(TraceMeRecorder::Event&& event) { queue_.Push(std::move(event)); }
+  void Record(TraceMeRecorder::Event&& event) {
+    if (event.IsComplete()) {
+      int sampling_period =
+          internal::g_sampling_period.load(std::memory_order_relaxed);
+      if (sampling_period > 1 && num_complete_events_++ % sampling_period) {
+        return;
+      }
+    }
+    queue_.Push(std::move(event));
+  }
 
   // Clear is called from the control thread when tracing starts to remove any
   // elements added due to Record racing with Consume.
@@ -144,6 +154,9 @@ class ThreadLocalRecorder {
  private:
   TraceMeRecorder::ThreadInfo info_;
   LockFreeQueue<TraceMeRecorder::Event> queue_;
+  // Number of complete events seen by Record while sampling, accessed only by
+  // the producer thread.
+  uint64_t num_complete_events_ = 0;
 };
 
 }  // namespace
@@ -173,12 +186,14 @@ class ThreadLocalRecorder {
   return result;
 }
 
-/* static */ bool TraceMeRecorder::Start(int level) {
+/* static */ bool TraceMeRecorder::Start(int level, int sampling_period) {
   level = std::max(0, level);
   int expected = kTracingDisabled;
   bool started = internal::g_trace_level.compare_exchange_strong(
       expected, level, std::memory_order_acq_rel);
   if (started) {
+    internal::g_sampling_period.store(std::max(1, sampling_period),
+                                      std::memory_order_relaxed);
     // We may have old events in buffers because Record() raced with Stop().
     Clear();
   }
@@ -33,6 +33,10 @@ namespace internal {
 // Modified by TraceMeRecorder singleton when tracing starts/stops.
 TF_EXPORT extern std::atomic<int> g_trace_level;
 
+// Only one in g_sampling_period complete events of every thread is recorded.
+// Modified by TraceMeRecorder singleton when tracing starts.
+TF_EXPORT extern std::atomic<int> g_sampling_period;
+
 }  // namespace internal
 
 // TraceMeRecorder is a singleton repository of TraceMe events.
@@ -80,7 +84,10 @@ class TraceMeRecorder {
   // Starts recording of TraceMe().
   // Only traces <= level will be recorded.
   // Level must be >= 0. If level is 0, no traces will be recorded.
-  static bool Start(int level);
+  // If sampling_period is greater than 1, only one in sampling_period complete
+  // events of every thread will be recorded. Events of TraceMe::ActivityStart
+  // and TraceMe::ActivityEnd are always recorded, so that they can be paired.
+  static bool Start(int level, int sampling_period = 1);
 
   // Stops recording and returns events recorded since Start().
   // Events passed to Record after Stop has started will be dropped.
@@ -56,6 +56,25 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, SampledCompleteEvents) {
+  int64_t start_time = GetCurrentTimeNanos();
+  int64_t end_time = start_time + UniToNano(1);
+
+  TraceMeRecorder::Start(/*level=*/1, /*sampling_period=*/3);
+  for (int i = 0; i < 6; ++i) {
+    TraceMeRecorder::Record({"complete", start_time, end_time});
+  }
+  int64_t activity_id = TraceMeRecorder::NewActivityId();
+  TraceMeRecorder::Record({"split", start_time, -activity_id});
+  TraceMeRecorder::Record({"", -activity_id, end_time});
+  auto results = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events,
+              ElementsAre(Named("complete"), Named("complete"),
+                          Named("split")));
+}
+
 // Checks the functional behavior of the recorder, when used from several
 // unsynchronized threads.
 //